@@ -0,0 +1,162 @@
+/**********************************************************************
+    * bench.hpp -- the common harness of the benchmarks               *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Parsing the parameters of a benchmark run, timing the  *
+    *          simulation and reporting the throughput                *
+    *                                                                 *
+    * Usage:   <benchmark> <case> [tokens] [stages] [rate]            *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+/*! \file bench.hpp
+ * \brief The common harness of the benchmarks
+ *
+ *  Each benchmark is a separate program (like the examples) which builds
+ * one case, selected on the command line, as a chain of processes fed by
+ * a source and drained by a sink. It runs the simulation to completion
+ * and reports the wall-clock throughput as the tokens of a source per
+ * second and the average time of a process firing. The benchmarks are
+ * compiled like the examples, with the src folder and SystemC in the
+ * include path, e.g.:
+ *
+ *   g++ -O2 -std=c++17 -I$SYSTEMC_HOME/include -Isrc \
+ *       benchmarks/sy/main.cpp -L$SYSTEMC_HOME/lib -lsystemc -o sy_bench
+ *   ./sy_bench comb 1000000 8
+ *
+ *  When BENCH_RESULTS names a file, each run also appends a CSV record
+ * to it, labeled with BENCH_LABEL (e.g., the revision being measured).
+ * The Makefile in this folder uses them to keep a history of the runs
+ * and to compare a revision against a baseline (see compare/main.cpp).
+ */
+
+#include <forsyde.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fstream>
+
+namespace bench
+{
+
+using namespace sc_core;
+
+//! The parameters of a benchmark run
+struct params
+{
+    std::string kase;               ///< the selected case
+    unsigned long long tokens;      ///< tokens produced by the source
+    unsigned int stages;            ///< processes in the chain (or copies of a model)
+    unsigned int rate;              ///< tokens consumed and produced in each firing
+    std::string bench;              ///< the name of the benchmark program
+};
+
+//! Parses the command line of a benchmark
+/*! The case is required; the other parameters have defaults. The usage
+ * is printed and the program exits if the case is not one of the given
+ * ones.
+ */
+inline params parse(int argc, char** argv, const std::vector<std::string>& cases,
+                    unsigned long long tokens=1000000, unsigned int stages=8,
+                    unsigned int rate=1)
+{
+    std::string prog(argv[0]);
+    prog = prog.substr(prog.find_last_of('/')+1);
+    params p{argc > 1 ? argv[1] : "", tokens, stages, rate, prog};
+    if (argc > 2) p.tokens = std::strtoull(argv[2], NULL, 10);
+    if (argc > 3) p.stages = std::strtoul(argv[3], NULL, 10);
+    if (argc > 4) p.rate = std::strtoul(argv[4], NULL, 10);
+    for (auto& c : cases)
+        if (c == p.kase && p.stages > 0 && p.rate > 0) return p;
+    std::fprintf(stderr, "usage: %s <case> [tokens=%llu] [stages=%u] [rate=%u]\ncases:",
+                 argv[0], tokens, stages, rate);
+    for (auto& c : cases) std::fprintf(stderr, " %s", c.c_str());
+    std::fprintf(stderr, "\n");
+    std::exit(1);
+}
+
+//! Creates n signals of a given type
+template <class Sig>
+inline std::vector<Sig*> make_signals(size_t n)
+{
+    std::vector<Sig*> sigs(n);
+    for (auto& s : sigs) s = new Sig();
+    return sigs;
+}
+
+//! Measures the wall-clock time of the phases of a benchmark
+class stopwatch
+{
+public:
+    stopwatch() : last(std::chrono::steady_clock::now()) {}
+
+    //! Returns the seconds passed since the previous lap (or the construction)
+    double lap()
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const std::chrono::duration<double> secs = now - last;
+        last = now;
+        return secs.count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point last;
+};
+
+//! Returns the resident memory of the program in KiB (0 if it is unknown)
+inline unsigned long rss_kib()
+{
+    std::ifstream ifs("/proc/self/status");
+    std::string key;
+    unsigned long val;
+    while (ifs >> key)
+        if (key == "VmRSS:" && ifs >> val) return val;
+    return 0;
+}
+
+//! Runs the simulation and reports the throughput of a case
+/*! The simulation runs until it is starved, or for the given simulated
+ * time if it is non-zero (for the sources which do not stop). The
+ * number of firings is the total of all the processes of the case,
+ * including the source and the sink.
+ */
+inline int run(const params& p, unsigned long long firings,
+               const sc_time& duration=SC_ZERO_TIME)
+{
+    const auto start = std::chrono::steady_clock::now();
+    if (duration == SC_ZERO_TIME)
+        sc_start();
+    else
+        sc_start(duration);
+    const std::chrono::duration<double> secs = std::chrono::steady_clock::now() - start;
+    std::printf("%-16s tokens=%-10llu stages=%-4u rate=%-4u %14.0f tokens/s %10.1f ns/firing\n",
+                p.kase.c_str(), p.tokens, p.stages, p.rate,
+                p.tokens / secs.count(), secs.count() * 1e9 / firings);
+    if (const char* results = std::getenv("BENCH_RESULTS"))
+    {
+        // label,benchmark,case,tokens,stages,rate,seconds,tokens/s,ns/firing
+        const char* label = std::getenv("BENCH_LABEL");
+        std::ofstream ofs(results, std::ios::app);
+        if (!ofs.is_open())
+        {
+            std::fprintf(stderr, "%s could not be opened to write the results\n", results);
+            return 1;
+        }
+        ofs << (label ? label : "") << ',' << p.bench << ',' << p.kase << ','
+            << p.tokens << ',' << p.stages << ',' << p.rate << ','
+            << secs.count() << ',' << p.tokens / secs.count() << ','
+            << secs.count() * 1e9 / firings << std::endl;
+    }
+    return 0;
+}
+
+}
+
+#endif
@@ -0,0 +1,135 @@
+/**********************************************************************
+    * main.cpp -- compares the benchmark results of two revisions     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Reporting the throughput regressions of a revision     *
+    *          against a baseline from the history of the runs        *
+    *                                                                 *
+    * Usage:   compare <history> <label> [baseline] [threshold] [t]   *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*! \file main.cpp
+ * \brief Compares the benchmark results of two revisions
+ *
+ *  The history is the CSV file appended by the benchmarks when
+ * BENCH_RESULTS is set (see bench.hpp). The runs of each configuration
+ * (benchmark, case, tokens, stages and rate) with the given label are
+ * compared with the ones of the baseline, which is the last other label
+ * in the history if it is not given (or given as "-"). The throughput of a configuration
+ * has regressed if its mean dropped by more than the threshold (5% by
+ * default) and the drop is significant, i.e., Welch's t statistic of the
+ * repeated runs exceeds t (2 by default). A single run of either side
+ * is only compared against the threshold.
+ *
+ *  It does not depend on SystemC:
+ *
+ *   g++ -O2 -std=c++17 benchmarks/compare/main.cpp -o bench_compare
+ *
+ *  The exit status is 1 if any configuration has regressed.
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+//! The runs of a configuration with one label
+struct sample
+{
+    std::vector<double> vals;       ///< tokens per second of each run
+
+    double mean() const
+    {
+        double s = 0;
+        for (auto v : vals) s += v;
+        return vals.empty() ? 0 : s / vals.size();
+    }
+
+    //! The sample variance
+    double var() const
+    {
+        if (vals.size() < 2) return 0;
+        const double m = mean();
+        double s = 0;
+        for (auto v : vals) s += (v-m) * (v-m);
+        return s / (vals.size()-1);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "usage: %s <history> <label> [baseline] [threshold=0.05] [t=2]\n", argv[0]);
+        return 2;
+    }
+    const std::string label = argv[2];
+    std::string baseline = argc > 3 && std::string(argv[3]) != "-" ? argv[3] : "";
+    const bool last_baseline = baseline.empty();
+    const double threshold = argc > 4 ? std::atof(argv[4]) : 0.05;
+    const double t_min = argc > 5 ? std::atof(argv[5]) : 2;
+
+    std::ifstream ifs(argv[1]);
+    if (!ifs.is_open())
+    {
+        std::fprintf(stderr, "%s could not be opened\n", argv[1]);
+        return 2;
+    }
+    // label -> configuration -> runs, keeping the configurations in order
+    std::map<std::string,std::map<std::string,sample>> runs;
+    std::vector<std::string> configs;
+    std::string line;
+    while (std::getline(ifs, line))
+    {
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        for (std::string c; std::getline(ss, c, ',');) f.push_back(c);
+        if (f.size() < 9) continue;
+        const std::string config = f[1] + " " + f[2] + " tokens=" + f[3] +
+                                   " stages=" + f[4] + " rate=" + f[5];
+        if (f[0] != label && last_baseline) baseline = f[0];
+        auto& cfgs = runs[f[0]];
+        if (cfgs.find(config) == cfgs.end() && f[0] == label) configs.push_back(config);
+        cfgs[config].vals.push_back(std::atof(f[7].c_str()));
+    }
+    if (runs.find(label) == runs.end() || baseline.empty() || runs.find(baseline) == runs.end())
+    {
+        std::fprintf(stderr, "no runs of %s and a baseline in the history\n", label.c_str());
+        return 2;
+    }
+
+    std::printf("%s against %s (threshold %.1f%%, t %.1f)\n",
+                label.c_str(), baseline.c_str(), threshold*100, t_min);
+    int regressions = 0;
+    for (auto& config : configs)
+    {
+        auto it = runs[baseline].find(config);
+        if (it == runs[baseline].end()) continue;
+        const sample& b = it->second;
+        const sample& c = runs[label][config];
+        const double mb = b.mean(), mc = c.mean();
+        const double change = (mc - mb) / mb;
+        const double se = std::sqrt(b.var()/b.vals.size() + c.var()/c.vals.size());
+        const bool significant = b.vals.size() < 2 || c.vals.size() < 2 ||
+                                 (se > 0 && std::fabs(mc - mb) / se > t_min);
+        const char* verdict = "";
+        if (significant && change < -threshold)
+        {
+            verdict = "REGRESSION";
+            regressions++;
+        }
+        else if (significant && change > threshold)
+            verdict = "improvement";
+        std::printf("%-48s %14.0f %14.0f %+7.1f%% %s\n", config.c_str(), mb, mc,
+                    change*100, verdict);
+    }
+    std::printf("%d regression(s)\n", regressions);
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+/**********************************************************************
+    * echo.c -- the external model of the pipe wrapper benchmarks     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Echoing the tokens of SY::pipewrap and SY::pipewrap2   *
+    *          back without any computation                           *
+    *                                                                 *
+    * Usage:   echo <pipe prefix> text|binary [inputs]                *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*
+ *  The model creates the pipes <prefix>_inp and <prefix>_out if needed,
+ * where the prefix is the pipe folder followed by the name of the
+ * wrapper. It writes back the first value of each input line (text) or
+ * the first double of each group of inputs doubles of an input frame
+ * (binary), and exits when the wrapper closes the pipes.
+ *
+ *  The input pipe is opened for reading without blocking, since the
+ * wrapper only opens it for writing once there is a reader, and the
+ * output pipe is opened afterwards, which blocks until the wrapper
+ * opens it.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static int read_all(int fd, void* buf, size_t n)
+{
+    size_t got = 0;
+    while (got < n)
+    {
+        const ssize_t r = read(fd, (char*)buf + got, n - got);
+        if (r <= 0) return 0;
+        got += r;
+    }
+    return 1;
+}
+
+static int write_all(int fd, const void* buf, size_t n)
+{
+    size_t sent = 0;
+    while (sent < n)
+    {
+        const ssize_t w = write(fd, (const char*)buf + sent, n - sent);
+        if (w <= 0) return 0;
+        sent += w;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3 || (strcmp(argv[2], "text") && strcmp(argv[2], "binary")))
+    {
+        fprintf(stderr, "usage: %s <pipe prefix> text|binary [inputs]\n", argv[0]);
+        return 1;
+    }
+    const int binary = strcmp(argv[2], "binary") == 0;
+    const size_t inputs = argc > 3 ? strtoul(argv[3], NULL, 10) : 1;
+    char inp_path[4096], out_path[4096];
+    snprintf(inp_path, sizeof(inp_path), "%s_inp", argv[1]);
+    snprintf(out_path, sizeof(out_path), "%s_out", argv[1]);
+    mkfifo(inp_path, 0600);
+    mkfifo(out_path, 0600);
+
+    const int inp_fd = open(inp_path, O_RDONLY|O_NONBLOCK);
+    const int out_fd = open(out_path, O_WRONLY);
+    if (inp_fd < 0 || out_fd < 0)
+    {
+        perror("echo");
+        return 1;
+    }
+    fcntl(inp_fd, F_SETFL, fcntl(inp_fd, F_GETFL) & ~O_NONBLOCK);
+
+    if (!binary)
+    {
+        FILE* inp = fdopen(inp_fd, "r");
+        FILE* out = fdopen(out_fd, "w");
+        char line[4096];
+        while (fgets(line, sizeof(line), inp))
+        {
+            // the first value of the line
+            line[strcspn(line, " \n")] = '\0';
+            fprintf(out, "%s\n", line);
+            fflush(out);
+        }
+        return 0;
+    }
+
+    char* buf = NULL;
+    uint32_t cap = 0, len;
+    while (read_all(inp_fd, &len, sizeof(len)))
+    {
+        if (len > cap)
+        {
+            buf = realloc(buf, len);
+            cap = len;
+        }
+        if (!read_all(inp_fd, buf, len)) break;
+        // the first double of each group, in place
+        const size_t group = inputs * sizeof(double);
+        uint32_t out_len = 0;
+        for (uint32_t pos=0; pos+group<=len; pos+=group, out_len+=sizeof(double))
+            memmove(buf + out_len, buf + pos, sizeof(double));
+        if (!write_all(out_fd, &out_len, sizeof(out_len)) ||
+            !write_all(out_fd, buf, out_len))
+            break;
+    }
+    free(buf);
+    return 0;
+}
@@ -0,0 +1,247 @@
+/**********************************************************************
+    * main.cpp -- the co-simulation wrapper benchmarks                *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the startup, the round-trip time and the     *
+    *          throughput of the wrappers with trivial models         *
+    *                                                                 *
+    * Usage:   cosim_bench [wrapper=none|pipe|pipe2|gdb|shim|fmi]     *
+    *          [model=] [tokens=] [protocol=text|binary] [batch=]     *
+    *          [pipes=] [period=] [max_step=] [cold=0|1]              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*
+ *  A source feeds tokens to a wrapper of a model which does nothing,
+ * and a sink counts the outputs and stops the simulation after the
+ * last one. Hence the measured costs are the ones of the wrapper and
+ * its transport:
+ *
+ *   none   an identity SY::comb in place of the wrapper, the baseline
+ *   pipe   SY::pipewrap with the echo model (echo.c)
+ *   pipe2  SY::pipewrap2 with the echo model of two inputs
+ *   gdb    SY::gdbwrap in the GDBWRAP_DEBUG mode with the target
+ *          (target.c built with -g -O0), which requires an X display
+ *   shim   SY::gdbwrap in the GDBWRAP_SHIM mode with the target built
+ *          with gdbwrap_shim.h
+ *   fmi    CT::fmi2cswrap with the passthrough FMU (passthrough.c),
+ *          stepped every period seconds, or adaptively up to max_step
+ *
+ *  The model is the path of the echo program, the target or the FMU.
+ * The echo program is started by the benchmark with the pipes in the
+ * pipes folder, and the target by the wrapper. With cold=1 the FMU is
+ * unzipped into a fresh cache (see loadSharedFMU), otherwise a previous
+ * run may have unzipped it already.
+ *
+ *  The startup is the time from the start of the simulation, including
+ * starting the echo program, to the first output, i.e., opening the
+ * pipes, attaching GDB or unzipping and instantiating the FMU, plus the
+ * first transaction. The round-trip time is the average time of a token
+ * after the first one (a transaction of batch tokens takes batch times
+ * longer) and the throughput is its inverse. The run prints a key=value
+ * line and, when BENCH_RESULTS names a file, appends a CSV record to it,
+ * labeled with BENCH_LABEL:
+ *
+ *   label,wrapper,protocol,batch,cold,tokens,startup,rtt_us,
+ *   tokens_per_s,seconds
+ */
+
+#ifndef FORSYDE_COSIMULATION_WRAPPERS
+#define FORSYDE_COSIMULATION_WRAPPERS
+#endif
+
+#include "../bench.hpp"
+#include <chrono>
+#include <filesystem>
+#include <spawn.h>
+
+using namespace ForSyDe;
+
+extern char** environ;
+
+//! The parameters of a run
+struct cosim
+{
+    std::string wrapper = "none";   ///< the wrapper being measured
+    std::string model;              ///< the echo program, the target or the FMU
+    unsigned long long tokens = 10000;///< the number of tokens
+    std::string protocol = "text";  ///< the protocol of the pipe wrappers
+    unsigned int batch = 1;         ///< the tokens per transaction of the pipe wrappers
+    std::string pipes = ".";        ///< the folder of the pipes
+    double period = 1e-3;           ///< the (initial) step of the FMU in seconds
+    double max_step = 0;            ///< the maximum step of the adaptive FMU in seconds
+    bool cold = false;              ///< unzip the FMU into a fresh cache
+};
+
+//! Parses the key=value arguments of a run
+inline cosim parse(int argc, char** argv)
+{
+    cosim q;
+    for (int i=1; i<argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string val = eq == std::string::npos ? "" : arg.substr(eq+1);
+        if (key == "wrapper") q.wrapper = val;
+        else if (key == "model") q.model = val;
+        else if (key == "tokens") q.tokens = std::stoull(val);
+        else if (key == "protocol") q.protocol = val;
+        else if (key == "batch") q.batch = std::stoul(val);
+        else if (key == "pipes") q.pipes = val;
+        else if (key == "period") q.period = std::stod(val);
+        else if (key == "max_step") q.max_step = std::stod(val);
+        else if (key == "cold") q.cold = val != "0";
+        else
+        {
+            std::fprintf(stderr, "unknown parameter: %s\n", arg.c_str());
+            std::exit(1);
+        }
+    }
+    if ((q.wrapper != "none" && q.wrapper != "pipe" && q.wrapper != "pipe2" &&
+         q.wrapper != "gdb" && q.wrapper != "shim" && q.wrapper != "fmi") ||
+        (q.wrapper != "none" && q.model.empty()) ||
+        (q.protocol != "text" && q.protocol != "binary") ||
+        q.tokens < 2 || q.batch == 0 || q.period <= 0)
+    {
+        std::fprintf(stderr, "usage: %s [wrapper=none|pipe|pipe2|gdb|shim|fmi] [model=] "
+                     "[tokens=] [protocol=text|binary] [batch=] [pipes=] [period=] "
+                     "[max_step=] [cold=0|1]\n", argv[0]);
+        std::exit(1);
+    }
+    // whole transactions only
+    q.tokens = (q.tokens + q.batch - 1) / q.batch * q.batch;
+    return q;
+}
+
+//! The arrival times of the outputs
+struct arrivals
+{
+    unsigned long long count = 0, tokens;
+    std::chrono::steady_clock::time_point start;
+    double first = 0, last = 0;
+
+    //! Records an output and stops the simulation after the last one
+    void arrive()
+    {
+        const std::chrono::duration<double> t = std::chrono::steady_clock::now() - start;
+        if (++count == 1) first = t.count();
+        if (count == tokens)
+        {
+            last = t.count();
+            sc_stop();
+        }
+    }
+};
+
+SC_MODULE(testbench)
+{
+    SY::signal<double> src1, src2, out;
+    CT::signal ct_src, ct_out;
+
+    testbench(sc_module_name _name, const cosim& q, arrivals& arr) : sc_module(_name)
+    {
+        if (q.wrapper == "fmi")
+        {
+            const sc_time period(q.period, SC_SEC);
+            CT::make_source("source1",
+                [](CTTYPE& out, const sc_time& t) {out = t.to_seconds();},
+                period * double(q.tokens + 1), ct_src);
+            CT::make_fmi2cswrap("wrap1", q.model, 0, 1, period, ct_out, ct_src,
+                                sc_time(q.max_step, SC_SEC));
+            CT::make_sink("sink1", [&arr](const CTTYPE&) {arr.arrive();}, period, ct_out);
+            return;
+        }
+
+        const auto count = [](abst_ext<double>& out, const abst_ext<double>& prev)
+        {
+            out = abst_ext<double>(unsafe_from_abst_ext(prev) + 1);
+        };
+        SY::make_source("source1", count, abst_ext<double>(0), q.tokens, src1);
+        const pipe_protocol protocol = q.protocol == "binary" ? PIPE_BINARY : PIPE_TEXT;
+        if (q.wrapper == "none")
+            SY::make_comb("wrap1",
+                [](abst_ext<double>& out, const abst_ext<double>& inp) {out = inp;},
+                out, src1);
+        else if (q.wrapper == "pipe")
+            SY::make_pipewrap("wrap1", 0, q.pipes, out, src1, protocol, q.batch);
+        else if (q.wrapper == "pipe2")
+        {
+            SY::make_source("source2", count, abst_ext<double>(0), q.tokens, src2);
+            SY::make_pipewrap2("wrap1", 0, q.pipes, out, src1, src2, protocol, q.batch);
+        }
+        else
+            SY::make_gdbwrap("wrap1", q.model, out, src1,
+                             q.wrapper == "shim" ? SY::GDBWRAP_SHIM : SY::GDBWRAP_DEBUG);
+        SY::make_sink("sink1", [&arr](const abst_ext<double>&) {arr.arrive();}, out);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    const cosim q = parse(argc, argv);
+
+    std::string cache;
+    if (q.wrapper == "fmi" && q.cold)
+    {
+        cache = (std::filesystem::temp_directory_path() / "forsyde_cosim_XXXXXX").string();
+        if (!mkdtemp(&cache[0]))
+        {
+            std::fprintf(stderr, "the FMU cache could not be created\n");
+            return 1;
+        }
+        setenv("FORSYDE_FMU_CACHE", cache.c_str(), 1);
+    }
+
+    arrivals arr;
+    arr.tokens = q.tokens;
+    testbench tb("tb", q, arr);
+
+    arr.start = std::chrono::steady_clock::now();
+    pid_t echo = -1;
+    if (q.wrapper == "pipe" || q.wrapper == "pipe2")
+    {
+        const std::string prefix = q.pipes + "/wrap1";
+        const std::string inputs = q.wrapper == "pipe2" ? "2" : "1";
+        const char* args[] = {q.model.c_str(), prefix.c_str(), q.protocol.c_str(),
+                              inputs.c_str(), NULL};
+        if (posix_spawn(&echo, q.model.c_str(), NULL, NULL,
+                        const_cast<char**>(args), environ) != 0)
+        {
+            std::fprintf(stderr, "%s could not be started\n", q.model.c_str());
+            return 1;
+        }
+    }
+    sc_start();
+    const std::chrono::duration<double> secs = std::chrono::steady_clock::now() - arr.start;
+    // the pipes are closed at the end of the simulation
+    if (echo > 0) waitpid(echo, NULL, 0);
+    if (!cache.empty()) std::filesystem::remove_all(cache);
+
+    if (arr.count != q.tokens)
+    {
+        std::fprintf(stderr, "%llu of %llu tokens were received\n", arr.count, q.tokens);
+        return 1;
+    }
+    const double rtt = (arr.last - arr.first) / (q.tokens - 1);
+    std::printf("wrapper=%s protocol=%s batch=%u cold=%d tokens=%llu startup=%.6f "
+                "rtt_us=%.3f tokens_per_s=%.0f seconds=%.6f\n",
+                q.wrapper.c_str(), q.protocol.c_str(), q.batch, q.cold, q.tokens,
+                arr.first, rtt * 1e6, 1 / rtt, secs.count());
+    if (const char* results = std::getenv("BENCH_RESULTS"))
+    {
+        const char* label = std::getenv("BENCH_LABEL");
+        std::ofstream ofs(results, std::ios::app);
+        if (!ofs.is_open())
+        {
+            std::fprintf(stderr, "%s could not be opened to write the results\n", results);
+            return 1;
+        }
+        ofs << (label ? label : "") << ',' << q.wrapper << ',' << q.protocol << ','
+            << q.batch << ',' << q.cold << ',' << q.tokens << ',' << arr.first << ','
+            << rtt * 1e6 << ',' << 1 / rtt << ',' << secs.count() << std::endl;
+    }
+    return 0;
+}
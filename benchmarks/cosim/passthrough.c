@@ -0,0 +1,263 @@
+/**********************************************************************
+    * passthrough.c -- the FMU of the FMI wrapper benchmarks          *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: A co-simulation FMU whose output is its input, used to *
+    *          measure the costs of CT::fmi2cswrap itself             *
+    *                                                                 *
+    * Usage:   Built into passthrough.fmu with modelDescription.xml   *
+    *          by the Makefile of the benchmarks                      *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*
+ *  The model has the input u (value reference 0) and the output y
+ * (value reference 1), and y is set to u at the end of each step. It
+ * can save and restore its state, so that the adaptive mode of the
+ * wrapper can be measured as well. The functions of the model exchange
+ * interface and the derivatives are not supported.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "fmi2Functions.h"
+
+typedef struct
+{
+    fmi2Real u, y, time;
+} passthrough;
+
+const char* fmi2GetTypesPlatform(void) {return fmi2TypesPlatform;}
+
+const char* fmi2GetVersion(void) {return fmi2Version;}
+
+fmi2Status fmi2SetDebugLogging(fmi2Component c, fmi2Boolean on, size_t n,
+                               const fmi2String categories[])
+{
+    return fmi2OK;
+}
+
+fmi2Component fmi2Instantiate(fmi2String name, fmi2Type type, fmi2String guid,
+                              fmi2String resources, const fmi2CallbackFunctions* cb,
+                              fmi2Boolean visible, fmi2Boolean logging)
+{
+    if (type != fmi2CoSimulation) return NULL;
+    return calloc(1, sizeof(passthrough));
+}
+
+void fmi2FreeInstance(fmi2Component c) {free(c);}
+
+fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean tol_defined, fmi2Real tol,
+                               fmi2Real start, fmi2Boolean stop_defined, fmi2Real stop)
+{
+    ((passthrough*)c)->time = start;
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterInitializationMode(fmi2Component c) {return fmi2OK;}
+
+fmi2Status fmi2ExitInitializationMode(fmi2Component c) {return fmi2OK;}
+
+fmi2Status fmi2Terminate(fmi2Component c) {return fmi2OK;}
+
+fmi2Status fmi2Reset(fmi2Component c)
+{
+    memset(c, 0, sizeof(passthrough));
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                       fmi2Real value[])
+{
+    passthrough* m = (passthrough*)c;
+    for (size_t i=0; i<n; i++)
+    {
+        if (vr[i] > 1) return fmi2Error;
+        value[i] = vr[i] ? m->y : m->u;
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                       const fmi2Real value[])
+{
+    passthrough* m = (passthrough*)c;
+    for (size_t i=0; i<n; i++)
+    {
+        if (vr[i] != 0) return fmi2Error;
+        m->u = value[i];
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                          fmi2Integer value[])
+{
+    return n ? fmi2Error : fmi2OK;
+}
+
+fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                          fmi2Boolean value[])
+{
+    return n ? fmi2Error : fmi2OK;
+}
+
+fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                         fmi2String value[])
+{
+    return n ? fmi2Error : fmi2OK;
+}
+
+fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                          const fmi2Integer value[])
+{
+    return n ? fmi2Error : fmi2OK;
+}
+
+fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                          const fmi2Boolean value[])
+{
+    return n ? fmi2Error : fmi2OK;
+}
+
+fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t n,
+                         const fmi2String value[])
+{
+    return n ? fmi2Error : fmi2OK;
+}
+
+fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* state)
+{
+    if (!*state) *state = malloc(sizeof(passthrough));
+    if (!*state) return fmi2Error;
+    memcpy(*state, c, sizeof(passthrough));
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate state)
+{
+    memcpy(c, state, sizeof(passthrough));
+    return fmi2OK;
+}
+
+fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* state)
+{
+    free(*state);
+    *state = NULL;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate state, size_t* size)
+{
+    *size = sizeof(passthrough);
+    return fmi2OK;
+}
+
+fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate state, fmi2Byte bytes[],
+                                 size_t size)
+{
+    if (size < sizeof(passthrough)) return fmi2Error;
+    memcpy(bytes, state, sizeof(passthrough));
+    return fmi2OK;
+}
+
+fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte bytes[], size_t size,
+                                   fmi2FMUstate* state)
+{
+    if (size < sizeof(passthrough)) return fmi2Error;
+    if (!*state) *state = malloc(sizeof(passthrough));
+    if (!*state) return fmi2Error;
+    memcpy(*state, bytes, sizeof(passthrough));
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetDirectionalDerivative(fmi2Component c, const fmi2ValueReference unknown[],
+                                        size_t nu, const fmi2ValueReference known[], size_t nk,
+                                        const fmi2Real dknown[], fmi2Real dunknown[])
+{
+    return fmi2Error;
+}
+
+fmi2Status fmi2EnterEventMode(fmi2Component c) {return fmi2Error;}
+
+fmi2Status fmi2NewDiscreteStates(fmi2Component c, fmi2EventInfo* info) {return fmi2Error;}
+
+fmi2Status fmi2EnterContinuousTimeMode(fmi2Component c) {return fmi2Error;}
+
+fmi2Status fmi2CompletedIntegratorStep(fmi2Component c, fmi2Boolean no_prior,
+                                       fmi2Boolean* enter_event, fmi2Boolean* terminate)
+{
+    return fmi2Error;
+}
+
+fmi2Status fmi2SetTime(fmi2Component c, fmi2Real time) {return fmi2Error;}
+
+fmi2Status fmi2SetContinuousStates(fmi2Component c, const fmi2Real x[], size_t n)
+{
+    return fmi2Error;
+}
+
+fmi2Status fmi2GetDerivatives(fmi2Component c, fmi2Real dx[], size_t n) {return fmi2Error;}
+
+fmi2Status fmi2GetEventIndicators(fmi2Component c, fmi2Real z[], size_t n) {return fmi2Error;}
+
+fmi2Status fmi2GetContinuousStates(fmi2Component c, fmi2Real x[], size_t n) {return fmi2Error;}
+
+fmi2Status fmi2GetNominalsOfContinuousStates(fmi2Component c, fmi2Real x[], size_t n)
+{
+    return fmi2Error;
+}
+
+fmi2Status fmi2SetRealInputDerivatives(fmi2Component c, const fmi2ValueReference vr[],
+                                       size_t n, const fmi2Integer order[],
+                                       const fmi2Real value[])
+{
+    return fmi2Error;
+}
+
+fmi2Status fmi2GetRealOutputDerivatives(fmi2Component c, const fmi2ValueReference vr[],
+                                        size_t n, const fmi2Integer order[], fmi2Real value[])
+{
+    return fmi2Error;
+}
+
+fmi2Status fmi2DoStep(fmi2Component c, fmi2Real t, fmi2Real h, fmi2Boolean no_prior)
+{
+    passthrough* m = (passthrough*)c;
+    m->y = m->u;
+    m->time = t + h;
+    return fmi2OK;
+}
+
+fmi2Status fmi2CancelStep(fmi2Component c) {return fmi2Error;}
+
+fmi2Status fmi2GetStatus(fmi2Component c, const fmi2StatusKind s, fmi2Status* value)
+{
+    return fmi2Discard;
+}
+
+fmi2Status fmi2GetRealStatus(fmi2Component c, const fmi2StatusKind s, fmi2Real* value)
+{
+    if (s != fmi2LastSuccessfulTime) return fmi2Discard;
+    *value = ((passthrough*)c)->time;
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetIntegerStatus(fmi2Component c, const fmi2StatusKind s, fmi2Integer* value)
+{
+    return fmi2Discard;
+}
+
+fmi2Status fmi2GetBooleanStatus(fmi2Component c, const fmi2StatusKind s, fmi2Boolean* value)
+{
+    if (s != fmi2Terminated) return fmi2Discard;
+    *value = fmi2False;
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetStringStatus(fmi2Component c, const fmi2StatusKind s, fmi2String* value)
+{
+    return fmi2Discard;
+}
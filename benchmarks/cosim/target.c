@@ -0,0 +1,38 @@
+/**********************************************************************
+    * target.c -- the external model of the GDB wrapper benchmarks    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Copying the input of SY::gdbwrap to its output without *
+    *          any computation                                        *
+    *                                                                 *
+    * Usage:   Built with -g -O0 for the debug mode, and with         *
+    *          -DFORSYDE_SHIM for the shim mode                       *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifdef FORSYDE_SHIM
+#include "forsyde/gdbwrap_shim.h"
+#else
+double forsyde_read_in1()
+{
+    double a;
+}
+
+void forsyde_write_out(double a)
+{
+    double b;
+}
+#endif
+
+int main() {
+  double forsyde_in1, forsyde_out;
+  for (;;)
+  {
+    forsyde_in1 = forsyde_read_in1();
+    forsyde_out = forsyde_in1;
+    forsyde_write_out(forsyde_out);
+  }
+  return (0);
+}
@@ -0,0 +1,55 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the CT process constructors  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of chains of shift processes  *
+    *          and of filters                                         *
+    *                                                                 *
+    * Usage:   ct_bench <shift|filter> [tokens] [stages]              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+//! The length of the sub-signals produced by the source
+const sc_time period(1, SC_US);
+
+SC_MODULE(chain)
+{
+    std::vector<CT::signal*> sigs;
+
+    chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        sigs = bench::make_signals<CT::signal>(p.stages+1);
+
+        // a new sub-signal in each period
+        CT::make_gaussian("src1", 1.0, 0.0, period, *sigs[0]);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = p.kase + std::to_string(i+1);
+            if (p.kase == "shift")
+                CT::make_shift(n, period / 4, *sigs[i+1], *sigs[i]);
+            else
+                CT::make_filter(n, {1.0}, {1e-4, 1.0}, period, *sigs[i+1], *sigs[i]);
+        }
+
+        CT::make_sink("sink1", [](const CTTYPE&){}, period, *sigs[p.stages]);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"shift", "filter"}, 100000);
+
+    chain chain1("chain1", p);
+
+    // the filters (a sampler, a solver and a holder) take at least a step in each period
+    const unsigned int per_stage = p.kase == "shift" ? 1 : 3;
+
+    return bench::run(p, p.tokens * (per_stage * p.stages + 2), period * (double)p.tokens);
+}
@@ -0,0 +1,113 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the DDE process constructors *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of chains of zip processes    *
+    *          and of filters                                         *
+    *                                                                 *
+    * Usage:   dde_bench <zip|filter> [tokens] [stages]               *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+//! The period of the events of the sources
+const sc_time period(1, SC_US);
+
+//! Produces the next event of a source
+void next_event(ttn_event<double>& out, const ttn_event<double>& prev)
+{
+    out = ttn_event<double>(abst_ext<double>(unsafe_from_abst_ext(get_value(prev)) + 1),
+                            get_time(prev) + period);
+}
+
+//! A chain of zip processes, each one joining the previous stage with a source
+SC_MODULE(zip_chain)
+{
+    std::vector<DDE::signal<double>*> sigs, srcs;
+    std::vector<DDE::signal<std::tuple<abst_ext<double>,abst_ext<double>>>*> zipped;
+
+    zip_chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        sigs = bench::make_signals<DDE::signal<double>>(p.stages+1);
+        srcs = bench::make_signals<DDE::signal<double>>(p.stages);
+        zipped = bench::make_signals<DDE::signal<std::tuple<abst_ext<double>,abst_ext<double>>>>(p.stages);
+
+        const ttn_event<double> init(abst_ext<double>(0.0), SC_ZERO_TIME);
+        DDE::make_source("src0", next_event, init, p.tokens, *sigs[0]);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = std::to_string(i+1);
+            DDE::make_source("src" + n, next_event, init, p.tokens, *srcs[i]);
+            DDE::make_zip("zip" + n, *zipped[i], *sigs[i], *srcs[i]);
+            DDE::make_comb("add" + n,
+                [](abst_ext<double>& out,
+                   const std::tuple<abst_ext<double>,abst_ext<double>>& inp)
+                {
+                    out = abst_ext<double>(std::get<0>(inp).from_abst_ext(0) +
+                                           std::get<1>(inp).from_abst_ext(0));
+                }, *sigs[i+1], *zipped[i]);
+        }
+
+        DDE::make_sink("sink1", [](const ttn_event<double>&){}, *sigs[p.stages]);
+    }
+};
+
+//! Parallel filters sampling the same continuous-time input
+SC_MODULE(filter_bank)
+{
+    CT::signal src;
+    std::vector<CT::signal*> inps;
+    std::vector<DDE::signal<double>*> sigs, outs;
+    std::vector<DDE::signal<unsigned int>*> smps;
+
+    filter_bank(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        inps = bench::make_signals<CT::signal>(p.stages);
+        sigs = bench::make_signals<DDE::signal<double>>(p.stages);
+        outs = bench::make_signals<DDE::signal<double>>(p.stages);
+        smps = bench::make_signals<DDE::signal<unsigned int>>(p.stages);
+
+        auto src1 = CT::make_source("src1",
+            [](CTTYPE& out, const sc_time& t) {out = std::sin(2 * M_PI * 1e3 * t.to_seconds());},
+            period * (double)p.tokens, *inps[0]);
+        for (unsigned int i=1; i<p.stages; i++) src1->oport1(*inps[i]);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = std::to_string(i+1);
+            auto ct2dde = new CT2DDE<double>(("ct2dde" + n).c_str());
+            ct2dde->iport1(*inps[i]);
+            ct2dde->iport2(*smps[i]);
+            ct2dde->oport1(*sigs[i]);
+
+            auto filter = new DDE::filter<double>(("filter" + n).c_str(),
+                                                  {1.0}, {1e-4, 1.0}, period);
+            filter->iport1(*sigs[i]);
+            filter->oport1(*outs[i]);
+            filter->oport2(*smps[i]);
+
+            DDE::make_sink("sink" + n, [](const ttn_event<double>&){}, *outs[i]);
+        }
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"zip", "filter"}, 100000);
+
+    if (p.kase == "zip")
+    {
+        new zip_chain("zip_chain1", p);
+        return bench::run(p, p.tokens * (3 * p.stages + 2));
+    }
+
+    // the filters take at least a step in each period
+    new filter_bank("filter_bank1", p);
+    return bench::run(p, p.tokens * (3 * p.stages) + 1, period * (double)p.tokens);
+}
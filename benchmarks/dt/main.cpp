@@ -0,0 +1,59 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the DT process constructors  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of chains of mealy processes  *
+    *                                                                 *
+    * Usage:   dt_bench mealy [tokens] [stages] [rate]                *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+SC_MODULE(chain)
+{
+    std::vector<DT::signal<int>*> sigs;
+
+    chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        sigs = bench::make_signals<DT::signal<int>>(p.stages+1);
+
+        DT::make_source("src1",
+            [](abst_ext<int>& out, const abst_ext<int>& prev)
+            {
+                out = abst_ext<int>(unsafe_from_abst_ext(prev) + 1);
+            }, abst_ext<int>(0), p.tokens, *sigs[0]);
+
+        const size_t rate = p.rate;
+        for (unsigned int i=0; i<p.stages; i++)
+            DT::make_mealy("mealy" + std::to_string(i+1),
+                [rate](size_t& itoks, const int&) {itoks = rate;},
+                [](int& ns, const int& st, const std::vector<abst_ext<int>>& inp)
+                {
+                    ns = st;
+                    for (auto& v : inp) ns += v.from_abst_ext(0);
+                },
+                [](std::vector<abst_ext<int>>& out, const int& st,
+                   const std::vector<abst_ext<int>>& inp)
+                {
+                    out.resize(inp.size());
+                    for (size_t k=0; k<inp.size(); k++)
+                        out[k] = abst_ext<int>(st ^ inp[k].from_abst_ext(0));
+                }, 0, *sigs[i+1], *sigs[i], true);
+
+        DT::make_sink("sink1", [](const abst_ext<int>&){}, *sigs[p.stages]);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"mealy"});
+
+    chain chain1("chain1", p);
+
+    return bench::run(p, p.tokens * 2 + p.stages * (p.tokens / p.rate));
+}
@@ -0,0 +1,211 @@
+/**********************************************************************
+    * main.cpp -- the equivalence corpus built from the examples      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Checking that the optimized executors produce the same *
+    *          signals as the reference execution of the examples     *
+    *                                                                 *
+    * Usage:   equiv_bench <all|mulacc|toysdf|adders> [tokens]        *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*! \file main.cpp
+ * \brief The equivalence corpus built from the examples
+ *
+ *  Each case is an example (with longer input streams and silent sinks)
+ * simulated once by the reference SystemC execution and once per
+ * optimized executor which applies to its MoC, using run_equivalence.
+ * All the signals of the example are compared with the reference. It
+ * should be compiled with FORSYDE_SIGNAL_TRACE, and with
+ * FORSYDE_MULTITHREADED for the multi-threaded executors:
+ *
+ *   g++ -O2 -std=c++17 -DFORSYDE_SIGNAL_TRACE -DFORSYDE_MULTITHREADED \
+ *       -I$SYSTEMC_HOME/include -Isrc benchmarks/equiv/main.cpp \
+ *       -L$SYSTEMC_HOME/lib -lsystemc -pthread -o equiv_bench
+ *
+ *  The exit status is 1 if any mode of any case diverges or fails. The
+ * add function of the DDE adders example is defined here, since its
+ * header has the same include guard as the one of mulacc.
+ */
+
+#include "../bench.hpp"
+#include "../../examples/sy/mulacc/mulacc.hpp"
+#include "../../examples/sy/mulacc/siggen.hpp"
+#include "../../examples/sdf/toysdf/compAvg.hpp"
+#include "../../examples/sdf/toysdf/upSampler.hpp"
+#include "../../examples/sdf/toysdf/downSampler.hpp"
+#include "../../examples/sdf/toysdf/stimuli.hpp"
+#include "../../examples/dde/adders/inc.hpp"
+#include "../../examples/dde/adders/buf_add.hpp"
+
+using namespace ForSyDe;
+
+//! The mulacc example
+SC_MODULE(mulacc_top)
+{
+    SY::signal<int> srca, srcb, result;
+    mulacc* mulacc1;
+
+    mulacc_top(sc_module_name _name, unsigned long long tokens) : sc_module(_name)
+    {
+        SY::make_sconstant("constant1", 3, tokens, srca);
+        SY::make_ssource("siggen1", siggen_func, 1, tokens, srcb);
+
+        mulacc1 = new mulacc("mulacc1");
+        mulacc1->a(srca);
+        mulacc1->b(srcb);
+        mulacc1->result(result);
+
+        SY::make_ssink("report1", [](const int&){}, result);
+    }
+};
+
+//! The toysdf example
+SC_MODULE(toysdf_top)
+{
+    SDF::signal<double> src, upsrc, res, downres;
+    compAvg* compAvg1;
+
+    toysdf_top(sc_module_name _name, unsigned long long tokens) : sc_module(_name)
+    {
+        SDF::make_source("stimuli1", stimuli_func, 0.0, tokens, src);
+
+        SDF::make_comb("upSampler1", upSampler_func, 2, 1, upsrc, src);
+
+        compAvg1 = new compAvg("compAvg1");
+        compAvg1->iport1(upsrc);
+        compAvg1->oport1(res);
+
+        SDF::make_comb("downSampler1", downSampler_func, 2, 3, downres, res);
+
+        SDF::make_sink("report1", [](const double&){}, downres);
+    }
+};
+
+//! The adders example, whose feedback loop never stops
+SC_MODULE(adders_top)
+{
+    DDE::signal<int> srca, feedback, addi1, addi2, result, addi1p, addi2p, buf_result;
+    DDE::signal<std::tuple<abst_ext<int>,abst_ext<int>>> zip_result;
+
+    SC_CTOR(adders_top)
+    {
+        DDE::make_delay("delay1", abst_ext<int>(0), sc_time(10, SC_NS), srca, feedback);
+
+        auto inc1 = DDE::make_comb("inc1", inc_func, feedback, srca);
+        inc1->oport1(addi1);
+        inc1->oport1(addi1p);
+
+        auto const1 = DDE::make_vsource("const1",
+                std::vector<int>(1,7),
+                std::vector<sc_time>(1,sc_time(50,SC_NS)),
+                addi2
+        );
+        const1->oport1(addi2p);
+
+        DDE::make_comb2("add1",
+            [](abst_ext<int>& out1, const abst_ext<int>& inp1, const abst_ext<int>& inp2)
+            {
+                out1 = abst_ext<int>(from_abst_ext(inp1,0) + from_abst_ext(inp2,0));
+            }, result, addi1, addi2);
+
+        DDE::make_mealy2("buf_add1", buf_add_ns_func, buf_add_od_func,
+            std::make_tuple((int)0,(int)0),
+            sc_time(0,SC_NS),
+            buf_result, addi1p, addi2p);
+
+        DDE::make_zip("zip1", zip_result, result, buf_result);
+
+        DDE::make_sink("report1", [](ttn_event<std::tuple<abst_ext<int>,abst_ext<int>>>){},
+                       zip_result);
+    }
+};
+
+//! Checks the mulacc example with the SY executors
+int check_mulacc(unsigned long long tokens)
+{
+    std::vector<std::string> modes = {"reference", "cyclic", "fuse", "native"};
+#ifdef FORSYDE_MULTITHREADED
+    modes.push_back("parallel");
+#endif
+    auto res = run_equivalence(modes,
+        [tokens](const std::string& mode, equivalence_check& chk)
+        {
+            auto t = new mulacc_top("top", tokens);
+            chk.track(t->srca, "srca");
+            chk.track(t->srcb, "srcb");
+            chk.track(t->result, "result");
+            chk.track(t->mulacc1->addi1, "addi1");
+            chk.track(t->mulacc1->addi2, "addi2");
+            if (mode == "cyclic") new SY::cyclic_executive("cyclic", t);
+            if (mode == "fuse")
+                SY::make_fuse("fuse",
+                    dynamic_cast<SY::sy_process*>(sc_find_object("top.mulacc1.mul1")),
+                    dynamic_cast<SY::sy_process*>(sc_find_object("top.mulacc1.add1")));
+            if (mode == "native") new native_kernel("native", t);
+#ifdef FORSYDE_MULTITHREADED
+            if (mode == "parallel") new SY::parallel_executor("parallel", t);
+#endif
+        }, "equiv_mulacc.trc");
+    std::cout << "mulacc" << std::endl;
+    return print_equivalence(res);
+}
+
+//! Checks the toysdf example with the SDF executors
+int check_toysdf(unsigned long long tokens)
+{
+    std::vector<std::string> modes = {"reference", "static", "native"};
+#ifdef FORSYDE_MULTITHREADED
+    modes.push_back("hsdf");
+#endif
+    auto res = run_equivalence(modes,
+        [tokens](const std::string& mode, equivalence_check& chk)
+        {
+            auto t = new toysdf_top("top", tokens);
+            // the averages are the same up to the rounding
+            const tolerance tol(1e-12, 1e-12);
+            chk.track(t->src, "src", tol);
+            chk.track(t->upsrc, "upsrc", tol);
+            chk.track(t->res, "res", tol);
+            chk.track(t->downres, "downres", tol);
+            chk.track(t->compAvg1->din, "din", tol);
+            if (mode == "static") new SDF::static_scheduler("static", t);
+            if (mode == "native") new native_kernel("native", t);
+#ifdef FORSYDE_MULTITHREADED
+            if (mode == "hsdf") new SDF::hsdf_executor("hsdf", t);
+#endif
+        }, "equiv_toysdf.trc");
+    std::cout << "toysdf" << std::endl;
+    return print_equivalence(res);
+}
+
+//! Checks the adders example with the DDE executors
+int check_adders(unsigned long long tokens)
+{
+    auto res = run_equivalence({"reference", "native"},
+        [](const std::string& mode, equivalence_check& chk)
+        {
+            auto t = new adders_top("top");
+            chk.track(t->feedback, "feedback");
+            chk.track(t->result, "result");
+            chk.track(t->buf_result, "buf_result");
+            chk.track(t->zip_result, "zip_result");
+            if (mode == "native") new native_kernel("native", t);
+        }, "equiv_adders.trc", sc_time(10 * tokens, SC_NS));
+    std::cout << "adders" << std::endl;
+    return print_equivalence(res);
+}
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"all", "mulacc", "toysdf", "adders"}, 1000);
+
+    int failed = 0;
+    if (p.kase == "all" || p.kase == "mulacc") failed += check_mulacc(p.tokens);
+    if (p.kase == "all" || p.kase == "toysdf") failed += check_toysdf(p.tokens);
+    if (p.kase == "all" || p.kase == "adders") failed += check_adders(p.tokens);
+    std::cout << failed << " mode(s) failed" << std::endl;
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,95 @@
+/**********************************************************************
+    * main.cpp -- the macrobenchmarks built from the examples         *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of many copies of the mulacc  *
+    *          and toysdf examples processing long input streams      *
+    *                                                                 *
+    * Usage:   macro_bench <mulacc|toysdf> [tokens] [copies]          *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+#include "../../examples/sy/mulacc/mulacc.hpp"
+#include "../../examples/sdf/toysdf/compAvg.hpp"
+#include "../../examples/sdf/toysdf/upSampler.hpp"
+#include "../../examples/sdf/toysdf/downSampler.hpp"
+
+using namespace ForSyDe;
+
+//! Copies of the mulacc example, each one fed by its own sources
+SC_MODULE(mulaccs)
+{
+    std::vector<SY::signal<int>*> srca, srcb, result;
+
+    mulaccs(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        srca = bench::make_signals<SY::signal<int>>(p.stages);
+        srcb = bench::make_signals<SY::signal<int>>(p.stages);
+        result = bench::make_signals<SY::signal<int>>(p.stages);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = std::to_string(i+1);
+            SY::make_sconstant("constant" + n, 3, p.tokens, *srca[i]);
+            SY::make_ssource("siggen" + n, [](int& out, const int& prev) {out = prev + 1;},
+                             1, p.tokens, *srcb[i]);
+
+            auto mulacc1 = new mulacc(("mulacc" + n).c_str());
+            mulacc1->a(*srca[i]);
+            mulacc1->b(*srcb[i]);
+            mulacc1->result(*result[i]);
+
+            SY::make_ssink("report" + n, [](const int&){}, *result[i]);
+        }
+    }
+};
+
+//! Copies of the toysdf example, each one fed by its own source
+SC_MODULE(toysdfs)
+{
+    std::vector<SDF::signal<double>*> src, upsrc, res, downres;
+
+    toysdfs(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        src = bench::make_signals<SDF::signal<double>>(p.stages);
+        upsrc = bench::make_signals<SDF::signal<double>>(p.stages);
+        res = bench::make_signals<SDF::signal<double>>(p.stages);
+        downres = bench::make_signals<SDF::signal<double>>(p.stages);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = std::to_string(i+1);
+            SDF::make_source("stimuli" + n, [](double& out, const double& prev) {out = prev + 1;},
+                             0.0, p.tokens, *src[i]);
+
+            SDF::make_comb("upSampler" + n, upSampler_func, 2, 1, *upsrc[i], *src[i]);
+
+            auto compAvg1 = new compAvg(("compAvg" + n).c_str());
+            compAvg1->iport1(*upsrc[i]);
+            compAvg1->oport1(*res[i]);
+
+            SDF::make_comb("downSampler" + n, downSampler_func, 2, 3, *downres[i], *res[i]);
+
+            SDF::make_sink("report" + n, [](const double&){}, *downres[i]);
+        }
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"mulacc", "toysdf"}, 1000000, 16);
+
+    if (p.kase == "mulacc")
+    {
+        // two sources, mul, add, the accumulator and the sink per token
+        new mulaccs("mulaccs1", p);
+        return bench::run(p, p.tokens * p.stages * 6);
+    }
+
+    // 48 firings in each iteration of the schedule, which consumes 9 tokens
+    new toysdfs("toysdfs1", p);
+    return bench::run(p, p.tokens * p.stages * 48 / 9);
+}
@@ -0,0 +1,75 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the MoC interfaces           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of chains of round trips from *
+    *          the SY MoC to other MoCs                               *
+    *                                                                 *
+    * Usage:   mi_bench <sdf|ct|dde> [tokens] [stages] [rate]         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+//! The period of the SY signals when they are timed
+const sc_time period(1, SC_US);
+
+SC_MODULE(chain)
+{
+    std::vector<SY::signal<double>*> sigs;
+    std::vector<SDF::signal<double>*> sdf_sigs;
+    std::vector<CT::signal*> ct_sigs;
+    std::vector<DDE::signal<double>*> dde_sigs;
+
+    chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        sigs = bench::make_signals<SY::signal<double>>(p.stages+1);
+
+        SY::make_source("src1",
+            [](abst_ext<double>& out, const abst_ext<double>& prev)
+            {
+                out = abst_ext<double>(unsafe_from_abst_ext(prev) + 1);
+            }, abst_ext<double>(0.0), p.tokens, *sigs[0]);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = std::to_string(i+1);
+            if (p.kase == "sdf")
+            {
+                sdf_sigs.push_back(new SDF::signal<double>());
+                make_SY2SDF("sy2sdf" + n, p.rate, *sdf_sigs[i], *sigs[i]);
+                make_SDF2SY("sdf2sy" + n, p.rate, *sigs[i+1], *sdf_sigs[i]);
+            }
+            else if (p.kase == "ct")
+            {
+                ct_sigs.push_back(new CT::signal());
+                make_SY2CT("sy2ct" + n, period, HOLD, *ct_sigs[i], *sigs[i]);
+                make_CT2SY("ct2sy" + n, period, *sigs[i+1], *ct_sigs[i]);
+            }
+            else
+            {
+                dde_sigs.push_back(new DDE::signal<double>());
+                make_SY2DDE("sy2dde" + n, period, *dde_sigs[i], *sigs[i]);
+                make_DDE2SY("dde2sy" + n, period, *sigs[i+1], *dde_sigs[i]);
+            }
+        }
+
+        SY::make_sink("sink1", [](const abst_ext<double>&){}, *sigs[p.stages]);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"sdf", "ct", "dde"});
+
+    chain chain1("chain1", p);
+
+    // the SDF interfaces fire once for each block of rate tokens
+    const auto trip_firings = p.kase == "sdf" ? 2 * (p.tokens / p.rate) : 2 * p.tokens;
+
+    return bench::run(p, p.tokens * 2 + p.stages * trip_firings);
+}
@@ -0,0 +1,548 @@
+/**********************************************************************
+    * main.cpp -- the benchmarks of the parallel simulation           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the latency and the bandwidth of the sender  *
+    *          and receiver processes and the scaling of partitioned  *
+    *          pipelines and meshes over MPI ranks                    *
+    *                                                                 *
+    * Usage:   mpirun -np <ranks> mpi_bench case=latency|bandwidth|   *
+    *          pipeline|mesh [moc=sy|sdf] [scaling=strong|weak]       *
+    *          [tokens=] [size=] [stages=] [batch=] [depth=] [work=]  *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*
+ *  The cases are:
+ *
+ *   latency    ranks 0 and 1 pass a token of size bytes back and forth
+ *              tokens times; reports the round-trip time
+ *   bandwidth  rank 0 streams tokens tokens of size bytes to rank 1 in
+ *              batches of batch tokens; reports the bytes per second
+ *   pipeline   a chain of stages processes, each doing work iterations
+ *              per token, split into contiguous partitions of the ranks
+ *   mesh       the ranks form a grid, each receiving from its left and
+ *              upper neighbors and sending to its right and lower ones
+ *              through a partition of the stages
+ *
+ *  With scaling=strong the stages are divided among the ranks (the total
+ *  work is fixed), with scaling=weak each rank gets stages of them (the
+ *  work per rank is fixed). The program has to be linked with MPI, e.g.:
+ *
+ *   mpicxx -O2 -std=c++17 -I$SYSTEMC_HOME/include -Isrc \
+ *       benchmarks/mpi/main.cpp -L$SYSTEMC_HOME/lib -lsystemc -o mpi_bench
+ *   mpirun -np 16 ./mpi_bench case=pipeline scaling=weak stages=4 work=1000
+ *
+ *  The MPI_Test, MPI_Iprobe, MPI_Wait and MPI_Probe calls of the program
+ * are intercepted through the MPI profiling interface, hence the time
+ * the ranks spend polling and blocked in MPI is reported as a share of
+ * their simulation time, averaged over the ranks and for the worst one.
+ * Rank 0 prints one key=value line per run and, when BENCH_RESULTS names
+ * a file, appends a CSV record to it, labeled with BENCH_LABEL:
+ *
+ *   label,case,moc,scaling,ranks,tokens,size,stages,batch,depth,work,
+ *   seconds,tokens/s,bytes/s,round_trip_us,poll_calls,poll_share,
+ *   poll_share_max,wait_share
+ */
+
+#define FORSYDE_PARALLEL_SIM
+#include "../bench.hpp"
+#include <mpi.h>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+
+using namespace ForSyDe;
+
+//! The tokens exchanged by the benchmarks
+typedef std::vector<char> payload;
+
+//! The MPI time measured through the profiling interface
+namespace mpi_time
+{
+std::atomic<unsigned long long> poll_ns(0), poll_calls(0), wait_ns(0);
+
+inline unsigned long long since(double start)
+{
+    return static_cast<unsigned long long>((PMPI_Wtime() - start) * 1e9);
+}
+}
+
+int MPI_Test(MPI_Request* request, int* flag, MPI_Status* status)
+{
+    const double start = PMPI_Wtime();
+    const int res = PMPI_Test(request, flag, status);
+    mpi_time::poll_ns += mpi_time::since(start);
+    mpi_time::poll_calls++;
+    return res;
+}
+
+int MPI_Iprobe(int source, int tag, MPI_Comm comm, int* flag, MPI_Status* status)
+{
+    const double start = PMPI_Wtime();
+    const int res = PMPI_Iprobe(source, tag, comm, flag, status);
+    mpi_time::poll_ns += mpi_time::since(start);
+    mpi_time::poll_calls++;
+    return res;
+}
+
+int MPI_Wait(MPI_Request* request, MPI_Status* status)
+{
+    const double start = PMPI_Wtime();
+    const int res = PMPI_Wait(request, status);
+    mpi_time::wait_ns += mpi_time::since(start);
+    return res;
+}
+
+int MPI_Probe(int source, int tag, MPI_Comm comm, MPI_Status* status)
+{
+    const double start = PMPI_Wtime();
+    const int res = PMPI_Probe(source, tag, comm, status);
+    mpi_time::wait_ns += mpi_time::since(start);
+    return res;
+}
+
+//! The parameters of a run
+struct mpibench
+{
+    std::string kase;               ///< the selected case
+    std::string moc = "sy";         ///< the MoC of the processes
+    std::string scaling = "weak";   ///< how the stages are divided among the ranks
+    unsigned long long tokens = 10000;  ///< tokens passed through each rank
+    unsigned int size = 8;          ///< bytes in each token
+    unsigned int stages = 8;        ///< processes of the pipeline or the mesh
+    unsigned int batch = 1;         ///< tokens sent in each message
+    unsigned int depth = 2;         ///< messages in flight
+    unsigned int work = 100;        ///< iterations of work per token in each stage
+};
+
+//! Parses the key=value arguments of a run
+inline mpibench parse(int argc, char** argv)
+{
+    mpibench q;
+    for (int i=1; i<argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string val = eq == std::string::npos ? "" : arg.substr(eq+1);
+        if (key == "case") q.kase = val;
+        else if (key == "moc") q.moc = val;
+        else if (key == "scaling") q.scaling = val;
+        else if (key == "tokens") q.tokens = std::stoull(val);
+        else if (key == "size") q.size = std::stoul(val);
+        else if (key == "stages") q.stages = std::stoul(val);
+        else if (key == "batch") q.batch = std::stoul(val);
+        else if (key == "depth") q.depth = std::stoul(val);
+        else if (key == "work") q.work = std::stoul(val);
+        else q.kase.clear();
+    }
+    // a batch of the exchange could never be filled
+    if (q.kase == "latency") q.batch = 1;
+    if ((q.kase == "latency" || q.kase == "bandwidth" || q.kase == "pipeline" ||
+         q.kase == "mesh") && (q.moc == "sy" || q.moc == "sdf") &&
+        (q.scaling == "strong" || q.scaling == "weak") && q.tokens > 0 && q.batch > 0)
+        return q;
+    std::fprintf(stderr, "usage: %s case=latency|bandwidth|pipeline|mesh [moc=sy|sdf] "
+                 "[scaling=strong|weak] [tokens=] [size=] [stages=] [batch=] [depth=] "
+                 "[work=]\n", argv[0]);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+    return q;
+}
+
+//! Does some work on a token, which depends on its contents
+inline void burn(payload& v, unsigned int work)
+{
+    std::uint32_t x = v.empty() ? 1 : static_cast<unsigned char>(v[0]);
+    for (unsigned int i=0; i<work; i++) x = x * 1664525u + 1013904223u;
+    if (!v.empty()) v[0] = static_cast<char>(x);
+}
+
+//! The processes of the benchmarks in the SY MoC
+/*! Each process writing to outs is bound to all of them, i.e., its output
+ * is fanned out by the port itself.
+ */
+struct sy_procs
+{
+    typedef SY::signal<payload> sig;
+
+    static void source(const std::string& n, unsigned int size,
+                       unsigned long long tokens, const std::vector<sig*>& outs)
+    {
+        auto p = SY::make_source(n,
+            [](abst_ext<payload>& out, const abst_ext<payload>& prev)
+            {
+                out = prev;
+            }, abst_ext<payload>(payload(size, 1)), tokens, *outs[0]);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void stage(const std::string& n, unsigned int work,
+                      const std::vector<sig*>& outs, sig& in)
+    {
+        auto p = SY::make_comb(n,
+            [work](abst_ext<payload>& out, const abst_ext<payload>& inp)
+            {
+                payload v = unsafe_from_abst_ext(inp);
+                burn(v, work);
+                out = abst_ext<payload>(v);
+            }, *outs[0], in);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void join(const std::string& n, unsigned int work,
+                     const std::vector<sig*>& outs, sig& in1, sig& in2)
+    {
+        auto p = SY::make_comb2(n,
+            [work](abst_ext<payload>& out, const abst_ext<payload>& inp1,
+                   const abst_ext<payload>& inp2)
+            {
+                payload v = unsafe_from_abst_ext(inp1);
+                const payload& w = unsafe_from_abst_ext(inp2);
+                for (size_t i=0; i<v.size() && i<w.size(); i++) v[i] ^= w[i];
+                burn(v, work);
+                out = abst_ext<payload>(v);
+            }, *outs[0], in1, in2);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void delay(const std::string& n, unsigned int size,
+                      const std::vector<sig*>& outs, sig& in)
+    {
+        auto p = SY::make_delay(n, abst_ext<payload>(payload(size, 1)), *outs[0], in);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void sender(const std::string& n, int dest, int tag,
+                       const mpibench& q, sig& in)
+    {
+        SY::make_sender(n, dest, tag, in, q.batch, q.depth);
+    }
+
+    static void receiver(const std::string& n, int src, int tag,
+                         const mpibench& q, const std::vector<sig*>& outs)
+    {
+        auto p = SY::make_receiver(n, src, tag, *outs[0], q.batch, q.depth);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    //! Stops the simulation when it has consumed a number of tokens
+    static void counter(const std::string& n, unsigned long long tokens, sig& in)
+    {
+        SY::make_sink(n,
+            [tokens, count=0ull](const abst_ext<payload>&) mutable
+            {
+                if (++count == tokens) sc_stop();
+            }, in);
+    }
+};
+
+//! The processes of the benchmarks in the SDF MoC
+struct sdf_procs
+{
+    typedef SDF::signal<payload> sig;
+
+    static void source(const std::string& n, unsigned int size,
+                       unsigned long long tokens, const std::vector<sig*>& outs)
+    {
+        auto p = SDF::make_source(n,
+            [](payload& out, const payload& prev)
+            {
+                out = prev;
+            }, payload(size, 1), tokens, *outs[0]);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void stage(const std::string& n, unsigned int work,
+                      const std::vector<sig*>& outs, sig& in)
+    {
+        auto p = SDF::make_comb(n,
+            [work](std::vector<payload>& out, const std::vector<payload>& inp)
+            {
+                out[0] = inp[0];
+                burn(out[0], work);
+            }, 1, 1, *outs[0], in);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void join(const std::string& n, unsigned int work,
+                     const std::vector<sig*>& outs, sig& in1, sig& in2)
+    {
+        auto p = SDF::make_comb2(n,
+            [work](std::vector<payload>& out, const std::vector<payload>& inp1,
+                   const std::vector<payload>& inp2)
+            {
+                out[0] = inp1[0];
+                for (size_t i=0; i<out[0].size() && i<inp2[0].size(); i++)
+                    out[0][i] ^= inp2[0][i];
+                burn(out[0], work);
+            }, 1, 1, 1, *outs[0], in1, in2);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void delay(const std::string& n, unsigned int size,
+                      const std::vector<sig*>& outs, sig& in)
+    {
+        auto p = SDF::make_delay(n, payload(size, 1), *outs[0], in);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    static void sender(const std::string& n, int dest, int tag,
+                       const mpibench& q, sig& in)
+    {
+        SDF::make_sender(n, dest, tag, in, q.batch, q.depth);
+    }
+
+    static void receiver(const std::string& n, int src, int tag,
+                         const mpibench& q, const std::vector<sig*>& outs)
+    {
+        auto p = SDF::make_receiver(n, src, tag, *outs[0], q.batch, q.depth);
+        for (size_t i=1; i<outs.size(); i++) p->oport1(*outs[i]);
+    }
+
+    //! Stops the simulation when it has consumed a number of tokens
+    static void counter(const std::string& n, unsigned long long tokens, sig& in)
+    {
+        SDF::make_sink(n,
+            [tokens, count=0ull](const payload&) mutable
+            {
+                if (++count == tokens) sc_stop();
+            }, in);
+    }
+};
+
+//! The partition of a rank
+/*! Every rank which takes part in a case ends its simulation with a
+ * counter which stops it after the last token, since the receivers
+ * would otherwise wait for more messages forever.
+ */
+template <class P>
+SC_MODULE(partition)
+{
+    typedef typename P::sig sig;
+
+    std::vector<sig*> sigs;
+    bool active;
+
+    partition(sc_module_name _name, const mpibench& q, int rank, int ranks)
+        : sc_module(_name), active(false)
+    {
+        if (q.kase == "latency") latency(q, rank);
+        else if (q.kase == "bandwidth") bandwidth(q, rank);
+        else if (q.kase == "pipeline") pipeline(q, rank, ranks);
+        else mesh(q, rank, ranks);
+    }
+
+private:
+    sig* make_sig()
+    {
+        sigs.push_back(new sig());
+        return sigs.back();
+    }
+
+    //! The stages of a partition from in, returning their output
+    sig* chain(const mpibench& q, unsigned int n, sig* in)
+    {
+        for (unsigned int i=0; i<n; i++)
+        {
+            sig* out = make_sig();
+            P::stage("stage" + std::to_string(i+1), q.work, {out}, *in);
+            in = out;
+        }
+        return in;
+    }
+
+    //! The stages of a rank, which divide the total ones if scaling is strong
+    static unsigned int local_stages(const mpibench& q, int rank, int ranks)
+    {
+        if (q.scaling == "weak") return q.stages;
+        return (unsigned long long)q.stages * (rank+1) / ranks -
+               (unsigned long long)q.stages * rank / ranks;
+    }
+
+    void latency(const mpibench& q, int rank)
+    {
+        if (rank > 1) return;
+        active = true;
+        sig* recvd = make_sig();
+        sig* counted = make_sig();
+        if (rank == 0)
+        {
+            // the delay starts the exchange with the first token
+            sig* sent = make_sig();
+            P::receiver("receiver1", 1, 1, q, {recvd, counted});
+            P::delay("delay1", q.size, {sent}, *recvd);
+            P::sender("sender1", 1, 0, q, *sent);
+        }
+        else
+        {
+            P::receiver("receiver1", 0, 0, q, {recvd, counted});
+            P::sender("sender1", 0, 1, q, *recvd);
+        }
+        P::counter("counter1", q.tokens, *counted);
+    }
+
+    void bandwidth(const mpibench& q, int rank)
+    {
+        if (rank > 1) return;
+        active = true;
+        sig* counted = make_sig();
+        if (rank == 0)
+        {
+            sig* sent = make_sig();
+            P::source("source1", q.size, q.tokens, {sent, counted});
+            P::sender("sender1", 1, 0, q, *sent);
+        }
+        else
+            P::receiver("receiver1", 0, 0, q, {counted});
+        P::counter("counter1", q.tokens, *counted);
+    }
+
+    void pipeline(const mpibench& q, int rank, int ranks)
+    {
+        active = true;
+        sig* in = make_sig();
+        if (rank == 0)
+            P::source("source1", q.size, q.tokens, {in});
+        else
+            P::receiver("receiver1", rank-1, 0, q, {in});
+        sig* out = chain(q, local_stages(q, rank, ranks), in);
+        if (rank+1 < ranks)
+        {
+            // the output is fanned out to the sender and the counter
+            sig* sent = make_sig();
+            sig* counted = make_sig();
+            P::stage("tap1", 0, {sent, counted}, *out);
+            P::sender("sender1", rank+1, 0, q, *sent);
+            P::counter("counter1", q.tokens, *counted);
+        }
+        else
+            P::counter("counter1", q.tokens, *out);
+    }
+
+    void mesh(const mpibench& q, int rank, int ranks)
+    {
+        active = true;
+        // the most square grid of rows x cols ranks
+        int rows = static_cast<int>(std::sqrt(ranks));
+        while (ranks % rows) rows--;
+        const int cols = ranks / rows;
+        const int row = rank / cols, col = rank % cols;
+        std::vector<sig*> ins;
+        if (col > 0)
+        {
+            ins.push_back(make_sig());
+            P::receiver("receiver_left", rank-1, 0, q, {ins.back()});
+        }
+        if (row > 0)
+        {
+            ins.push_back(make_sig());
+            P::receiver("receiver_up", rank-cols, 1, q, {ins.back()});
+        }
+        sig* in = make_sig();
+        if (ins.empty())
+            P::source("source1", q.size, q.tokens, {in});
+        else if (ins.size() == 1)
+            in = ins[0];
+        else
+            P::join("join1", q.work, {in}, *ins[0], *ins[1]);
+        sig* out = chain(q, local_stages(q, rank, ranks), in);
+        std::vector<sig*> outs{make_sig()};
+        P::counter("counter1", q.tokens, *outs[0]);
+        if (col+1 < cols)
+        {
+            outs.push_back(make_sig());
+            P::sender("sender_right", rank+1, 0, q, *outs.back());
+        }
+        if (row+1 < rows)
+        {
+            outs.push_back(make_sig());
+            P::sender("sender_down", rank+cols, 1, q, *outs.back());
+        }
+        P::stage("tap1", 0, outs, *out);
+    }
+};
+
+//! Runs a case on all the ranks and reports it on rank 0
+template <class P>
+int run(const mpibench& q)
+{
+    int rank = 0, ranks = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+    if (ranks < 2)
+    {
+        if (rank == 0) std::fprintf(stderr, "the benchmarks need at least 2 ranks\n");
+        return 1;
+    }
+
+    partition<P> part("part", q, rank, ranks);
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    mpi_time::poll_ns = mpi_time::poll_calls = mpi_time::wait_ns = 0;
+    bench::stopwatch sw;
+    if (part.active) sc_start();
+    const double secs = sw.lap();
+
+    // the shares of the ranks taking part
+    const double n = part.active ? 1 : 0;
+    const double poll = secs > 0 ? mpi_time::poll_ns * 1e-9 / secs : 0;
+    const double wait = secs > 0 ? mpi_time::wait_ns * 1e-9 / secs : 0;
+    double local[3] = {n, n*poll, n*wait}, sums[3];
+    double maxs[2] = {secs, n*poll}, max_all[2];
+    unsigned long long calls = mpi_time::poll_calls, total_calls = 0;
+    MPI_Reduce(local, sums, 3, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(maxs, max_all, 2, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&calls, &total_calls, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    if (rank != 0) return 0;
+
+    const double elapsed = max_all[0];
+    const double tokens_s = q.tokens / elapsed;
+    const double bytes_s = tokens_s * q.size;
+    const double round_trip_us = q.kase == "latency" ? elapsed * 1e6 / q.tokens : 0;
+    const double poll_share = sums[1] / sums[0], wait_share = sums[2] / sums[0];
+    std::printf("case=%s moc=%s scaling=%s ranks=%d tokens=%llu size=%u stages=%u batch=%u "
+                "depth=%u work=%u seconds=%.6f tokens/s=%.0f bytes/s=%.0f round_trip=%.3fus "
+                "poll_calls=%llu poll_share=%.4f poll_share_max=%.4f wait_share=%.4f\n",
+                q.kase.c_str(), q.moc.c_str(), q.scaling.c_str(), ranks, q.tokens, q.size,
+                q.stages, q.batch, q.depth, q.work, elapsed, tokens_s, bytes_s,
+                round_trip_us, total_calls, poll_share, max_all[1], wait_share);
+    if (const char* results = std::getenv("BENCH_RESULTS"))
+    {
+        const char* label = std::getenv("BENCH_LABEL");
+        std::ofstream ofs(results, std::ios::app);
+        if (!ofs.is_open())
+        {
+            std::fprintf(stderr, "%s could not be opened to write the results\n", results);
+            return 1;
+        }
+        ofs << (label ? label : "") << ',' << q.kase << ',' << q.moc << ','
+            << q.scaling << ',' << ranks << ',' << q.tokens << ',' << q.size << ','
+            << q.stages << ',' << q.batch << ',' << q.depth << ',' << q.work << ','
+            << elapsed << ',' << tokens_s << ',' << bytes_s << ',' << round_trip_us << ','
+            << total_calls << ',' << poll_share << ',' << max_all[1] << ','
+            << wait_share << std::endl;
+    }
+    return 0;
+}
+
+int sc_main(int argc, char **argv)
+{
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+    mpi_init_threads(&argc, &argv);
+#else
+    MPI_Init(&argc, &argv);
+#endif
+    const mpibench q = parse(argc, argv);
+
+    const int res = q.moc == "sy" ? run<sy_procs>(q) : run<sdf_procs>(q);
+
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+    mpi_finalize_threads();
+#else
+    MPI_Finalize();
+#endif
+    return res;
+}
@@ -0,0 +1,73 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the SADF process constructors*
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of a chain of kernels all     *
+    *          controlled by one detector                             *
+    *                                                                 *
+    * Usage:   sadf_bench kernel [tokens] [stages] [rate]             *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+SC_MODULE(chain)
+{
+    SADF::signal<int> ctrl;
+    std::vector<SADF::signal<int>*> scens;
+    std::vector<SADF::signal<double>*> sigs;
+
+    chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        scens = bench::make_signals<SADF::signal<int>>(p.stages);
+        sigs = bench::make_signals<SADF::signal<double>>(p.stages+1);
+
+        // one scenario for each block of rate tokens
+        SDF::make_source("ctrl1", [](int& out, const int& prev) {out = prev + 1;},
+                         0, p.tokens / p.rate, ctrl);
+
+        auto detector1 = SADF::make_detector("detector1",
+            [](int& new_sc, const int& prev_sc, const std::vector<int>&)
+            {
+                new_sc = 1 - prev_sc;
+            },
+            [](std::vector<int>& out, const int& sc, const std::vector<int>&)
+            {
+                out[0] = sc;
+            }, {{0,1},{1,1}}, 1, 1, *scens[0], ctrl);
+        for (unsigned int i=1; i<p.stages; i++)
+            detector1->oport1(*scens[i]);
+
+        SDF::make_source("src1", [](double& out, const double& prev) {out = prev + 1;},
+                         0.0, p.tokens, *sigs[0]);
+
+        const size_t r = p.rate;
+        for (unsigned int i=0; i<p.stages; i++)
+            SADF::make_kernel("kernel" + std::to_string(i+1),
+                [](std::vector<double>& out, const int& sc, const std::vector<double>& inp)
+                {
+                    if (sc == 0)
+                        for (size_t k=0; k<inp.size(); k++) out[k] = inp[k] * 0.5;
+                    else
+                        for (size_t k=0; k<inp.size(); k++) out[k] = inp[k] + 0.5;
+                }, {{0,std::make_tuple(r,r)},{1,std::make_tuple(r,r)}},
+                *sigs[i+1], *scens[i], *sigs[i]);
+
+        SDF::make_sink("sink1", [](const double&){}, *sigs[p.stages]);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"kernel"});
+
+    chain chain1("chain1", p);
+
+    const auto blocks = p.tokens / p.rate;
+
+    return bench::run(p, p.tokens * 2 + blocks * (p.stages + 2));
+}
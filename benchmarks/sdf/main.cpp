@@ -0,0 +1,56 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the SDF process constructors *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of chains of comb actors at   *
+    *          different rates                                        *
+    *                                                                 *
+    * Usage:   sdf_bench <comb|delay> [tokens] [stages] [rate]        *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+SC_MODULE(chain)
+{
+    std::vector<SDF::signal<double>*> sigs;
+
+    chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        sigs = bench::make_signals<SDF::signal<double>>(p.stages+1);
+
+        SDF::make_source("src1",
+            [](double& out, const double& prev) {out = prev + 1;},
+            0.0, p.tokens, *sigs[0]);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = p.kase + std::to_string(i+1);
+            if (p.kase == "comb")
+                SDF::make_comb(n,
+                    [](std::vector<double>& out, const std::vector<double>& inp)
+                    {
+                        for (size_t k=0; k<inp.size(); k++) out[k] = inp[k] * 0.5;
+                    }, p.rate, p.rate, *sigs[i+1], *sigs[i]);
+            else
+                SDF::make_delayn(n, 0.0, p.rate, *sigs[i+1], *sigs[i]);
+        }
+
+        SDF::make_sink("sink1", [](const double&){}, *sigs[p.stages]);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"comb", "delay"});
+
+    chain chain1("chain1", p);
+
+    const auto stage_firings = p.kase == "comb" ? p.tokens / p.rate : p.tokens;
+
+    return bench::run(p, p.tokens * 2 + p.stages * stage_firings);
+}
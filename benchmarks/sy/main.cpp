@@ -0,0 +1,66 @@
+/**********************************************************************
+    * main.cpp -- the microbenchmarks of the SY process constructors  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the throughput of chains of comb, delay and  *
+    *          mealy processes                                        *
+    *                                                                 *
+    * Usage:   sy_bench <comb|delay|mealy> [tokens] [stages]          *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+SC_MODULE(chain)
+{
+    std::vector<SY::signal<int>*> sigs;
+
+    chain(sc_module_name _name, const bench::params& p) : sc_module(_name)
+    {
+        sigs = bench::make_signals<SY::signal<int>>(p.stages+1);
+
+        SY::make_source("src1",
+            [](abst_ext<int>& out, const abst_ext<int>& prev)
+            {
+                out = unsafe_from_abst_ext(prev) + 1;
+            }, abst_ext<int>(0), p.tokens, *sigs[0]);
+
+        for (unsigned int i=0; i<p.stages; i++)
+        {
+            const std::string n = p.kase + std::to_string(i+1);
+            if (p.kase == "comb")
+                SY::make_comb(n,
+                    [](abst_ext<int>& out, const abst_ext<int>& inp)
+                    {
+                        out = abst_ext<int>(unsafe_from_abst_ext(inp) + 1);
+                    }, *sigs[i+1], *sigs[i]);
+            else if (p.kase == "delay")
+                SY::make_delay(n, abst_ext<int>(0), *sigs[i+1], *sigs[i]);
+            else
+                SY::make_mealy(n,
+                    [](int& ns, const int& st, const abst_ext<int>& inp)
+                    {
+                        ns = st + unsafe_from_abst_ext(inp);
+                    },
+                    [](abst_ext<int>& out, const int& st, const abst_ext<int>& inp)
+                    {
+                        out = abst_ext<int>(st ^ unsafe_from_abst_ext(inp));
+                    }, 0, *sigs[i+1], *sigs[i]);
+        }
+
+        SY::make_sink("sink1", [](const abst_ext<int>&){}, *sigs[p.stages]);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    auto p = bench::parse(argc, argv, {"comb", "delay", "mealy"});
+
+    chain chain1("chain1", p);
+
+    return bench::run(p, p.tokens * (p.stages + 2));
+}
@@ -0,0 +1,373 @@
+/**********************************************************************
+    * main.cpp -- the generator of synthetic process networks         *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring how the phases of a simulation scale with    *
+    *          the size and the shape of the process network          *
+    *                                                                 *
+    * Usage:   synth_bench [moc=sy|sdf|dde] [shape=chain|tree|mesh|   *
+    *          dag] [width=] [depth=] [tokens=] [size=] [rate=]       *
+    *          [absent=] [seed=] [xml=0|1]                            *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include "../bench.hpp"
+
+using namespace ForSyDe;
+
+//! The tokens carried by the synthetic networks
+typedef std::vector<double> payload;
+
+//! The parameters of a synthetic network
+struct synth
+{
+    std::string moc = "sy";         ///< the MoC of the processes
+    std::string shape = "chain";    ///< the shape of the network
+    unsigned int width = 10;        ///< nodes in a layer (leaves of a tree)
+    unsigned int depth = 10;        ///< layers after the sources (unused by trees)
+    unsigned long long tokens = 1000;   ///< tokens produced by each source
+    unsigned int size = 1;          ///< elements in each token
+    unsigned int rate = 1;          ///< tokens consumed and produced by each SDF firing
+    double absent = 0;              ///< the ratio of absent SY tokens
+    std::uint64_t seed = 0;         ///< the seed of the random choices
+    bool xml = false;               ///< whether the model is exported to XML
+};
+
+//! Parses the key=value arguments of the generator
+inline synth parse(int argc, char** argv)
+{
+    synth q;
+    for (int i=1; i<argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string val = eq == std::string::npos ? "" : arg.substr(eq+1);
+        if (key == "moc") q.moc = val;
+        else if (key == "shape") q.shape = val;
+        else if (key == "width") q.width = std::stoul(val);
+        else if (key == "depth") q.depth = std::stoul(val);
+        else if (key == "tokens") q.tokens = std::stoull(val);
+        else if (key == "size") q.size = std::stoul(val);
+        else if (key == "rate") q.rate = std::stoul(val);
+        else if (key == "absent") q.absent = std::stod(val);
+        else if (key == "seed") q.seed = std::stoull(val);
+        else if (key == "xml") q.xml = val != "0";
+        else
+        {
+            std::fprintf(stderr, "unknown parameter: %s\n", arg.c_str());
+            std::exit(1);
+        }
+    }
+    if ((q.moc != "sy" && q.moc != "sdf" && q.moc != "dde") ||
+        (q.shape != "chain" && q.shape != "tree" && q.shape != "mesh" && q.shape != "dag") ||
+        q.width == 0 || q.rate == 0)
+    {
+        std::fprintf(stderr, "usage: %s [moc=sy|sdf|dde] [shape=chain|tree|mesh|dag] "
+                     "[width=] [depth=] [tokens=] [size=] [rate=] [absent=] [seed=] [xml=0|1]\n",
+                     argv[0]);
+        std::exit(1);
+    }
+    return q;
+}
+
+//! The topology of a network
+/*! It lists the nodes of each layer with the indices of their
+ * predecessors in the previous layer. The first layer holds the sources.
+ */
+typedef std::vector<std::vector<std::vector<unsigned int>>> topology;
+
+//! Builds the topology of a given shape
+/*! Chains are width independent pipelines. Trees reduce width leaves by
+ * pairs down to a root. In meshes each node joins two neighbours of the
+ * previous layer, and in random DAGs each node follows the node above it
+ * and possibly a random one of the previous layer.
+ */
+inline topology make_topology(const synth& q)
+{
+    counter_rng rng(q.seed);
+    topology topo(1, std::vector<std::vector<unsigned int>>(q.width));
+    if (q.shape == "tree")
+    {
+        for (size_t n=q.width; n>1; n=(n+1)/2)
+        {
+            topo.emplace_back((n+1)/2);
+            for (unsigned int j=0; j<(n+1)/2; j++)
+            {
+                topo.back()[j].push_back(2*j);
+                if (2*j+1 < n) topo.back()[j].push_back(2*j+1);
+            }
+        }
+        return topo;
+    }
+    for (unsigned int l=0; l<q.depth; l++)
+    {
+        topo.emplace_back(q.width);
+        for (unsigned int j=0; j<q.width; j++)
+        {
+            auto& preds = topo.back()[j];
+            preds.push_back(j);
+            if (q.width < 2 || q.shape == "chain") continue;
+            if (q.shape == "mesh")
+                preds.push_back((j+1) % q.width);
+            else if (rng.uniform() < 0.5)
+            {
+                const unsigned int k = rng.next() % (q.width-1);
+                preds.push_back(k < j ? k : k+1);
+            }
+        }
+    }
+    return topo;
+}
+
+//! Adds two tokens element-wise
+inline payload combine(const payload& a, const payload& b)
+{
+    payload res(a);
+    for (size_t k=0; k<res.size() && k<b.size(); k++) res[k] += b[k];
+    return res;
+}
+
+//! Joins two possibly absent tokens
+inline abst_ext<payload> combine(const abst_ext<payload>& a, const abst_ext<payload>& b)
+{
+    if (is_present(a) && is_present(b))
+        return abst_ext<payload>(combine(unsafe_from_abst_ext(a), unsafe_from_abst_ext(b)));
+    return is_present(a) ? a : b;
+}
+
+//! The process constructors of the SY networks
+struct sy_net
+{
+    typedef SY::signal<payload> sig;
+
+    static auto source(const std::string& n, const synth& q, unsigned int idx, sig& out)
+    {
+        const abst_ext<payload> val(payload(q.size, 1.0));
+        const double absent = q.absent;
+        return SY::make_source(n,
+            [rng=counter_rng(q.seed, idx+1), val, absent]
+            (abst_ext<payload>& out, const abst_ext<payload>&) mutable
+            {
+                out = rng.uniform() < absent ? abst_ext<payload>() : val;
+            }, val, q.tokens, out);
+    }
+
+    static auto node1(const std::string& n, const synth&, sig& out, sig& inp)
+    {
+        return SY::make_comb(n,
+            [](abst_ext<payload>& out, const abst_ext<payload>& inp) {out = inp;},
+            out, inp);
+    }
+
+    static auto node2(const std::string& n, const synth&, sig& out, sig& inp1, sig& inp2)
+    {
+        return SY::make_comb2(n,
+            [](abst_ext<payload>& out, const abst_ext<payload>& inp1,
+               const abst_ext<payload>& inp2)
+            {
+                out = combine(inp1, inp2);
+            }, out, inp1, inp2);
+    }
+
+    static auto sink(const std::string& n, sig& inp)
+    {
+        return SY::make_sink(n, [](const abst_ext<payload>&){}, inp);
+    }
+};
+
+//! The process constructors of the SDF networks
+struct sdf_net
+{
+    typedef SDF::signal<payload> sig;
+
+    static auto source(const std::string& n, const synth& q, unsigned int, sig& out)
+    {
+        return SDF::make_source(n, [](payload& out, const payload& prev) {out = prev;},
+                                payload(q.size, 1.0), q.tokens, out);
+    }
+
+    static auto node1(const std::string& n, const synth& q, sig& out, sig& inp)
+    {
+        return SDF::make_comb(n,
+            [](std::vector<payload>& out, const std::vector<payload>& inp) {out = inp;},
+            q.rate, q.rate, out, inp);
+    }
+
+    static auto node2(const std::string& n, const synth& q, sig& out, sig& inp1, sig& inp2)
+    {
+        return SDF::make_comb2(n,
+            [](std::vector<payload>& out, const std::vector<payload>& inp1,
+               const std::vector<payload>& inp2)
+            {
+                for (size_t k=0; k<out.size(); k++) out[k] = combine(inp1[k], inp2[k]);
+            }, q.rate, q.rate, q.rate, out, inp1, inp2);
+    }
+
+    static auto sink(const std::string& n, sig& inp)
+    {
+        return SDF::make_sink(n, [](const payload&){}, inp);
+    }
+};
+
+//! The process constructors of the DDE networks
+struct dde_net
+{
+    typedef DDE::signal<payload> sig;
+
+    static auto source(const std::string& n, const synth& q, unsigned int, sig& out)
+    {
+        return DDE::make_source(n,
+            [](ttn_event<payload>& out, const ttn_event<payload>& prev)
+            {
+                out = ttn_event<payload>(get_value(prev), get_time(prev) + sc_time(1, SC_NS));
+            }, ttn_event<payload>(abst_ext<payload>(payload(q.size, 1.0)), SC_ZERO_TIME),
+            q.tokens, out);
+    }
+
+    static auto node1(const std::string& n, const synth&, sig& out, sig& inp)
+    {
+        return DDE::make_comb(n,
+            [](abst_ext<payload>& out, const payload& inp) {out = abst_ext<payload>(inp);},
+            out, inp);
+    }
+
+    static auto node2(const std::string& n, const synth&, sig& out, sig& inp1, sig& inp2)
+    {
+        return DDE::make_comb2(n,
+            [](abst_ext<payload>& out, const abst_ext<payload>& inp1,
+               const abst_ext<payload>& inp2)
+            {
+                out = combine(inp1, inp2);
+            }, out, inp1, inp2);
+    }
+
+    static auto sink(const std::string& n, sig& inp)
+    {
+        return DDE::make_sink(n, [](const ttn_event<payload>&){}, inp);
+    }
+};
+
+//! A synthetic network of a given topology
+/*! The network owns the processes and the signals it creates, so that
+ * deleting it measures the teardown of the whole model.
+ */
+template <class Net>
+class network : public sc_module
+{
+public:
+    typedef typename Net::sig sig;
+
+    network(sc_module_name _name, const synth& q, const topology& topo) : sc_module(_name)
+    {
+        // the signals from each node to its successors and from its predecessors
+        std::vector<std::vector<std::vector<sig*>>> outs(topo.size()), inps(topo.size());
+        for (size_t l=0; l<topo.size(); l++)
+        {
+            outs[l].resize(topo[l].size());
+            inps[l].resize(topo[l].size());
+            if (l == 0) continue;
+            for (size_t j=0; j<topo[l].size(); j++)
+                for (auto p : topo[l][j])
+                {
+                    sigs.push_back(new sig());
+                    outs[l-1][p].push_back(sigs.back());
+                    inps[l][j].push_back(sigs.back());
+                }
+        }
+
+        for (size_t l=0; l<topo.size(); l++)
+            for (size_t j=0; j<topo[l].size(); j++)
+            {
+                auto& o = outs[l][j];
+                auto& i = inps[l][j];
+                const std::string n = std::to_string(l) + "_" + std::to_string(j);
+                // the nodes without successors are drained by sinks
+                if (o.empty())
+                {
+                    sigs.push_back(new sig());
+                    o.push_back(sigs.back());
+                    procs.push_back(Net::sink("sink" + n, *o[0]));
+                }
+                if (l == 0)
+                    add(Net::source("src" + n, q, j, *o[0]), o);
+                else if (i.size() == 1)
+                    add(Net::node1("node" + n, q, *o[0], *i[0]), o);
+                else
+                    add(Net::node2("node" + n, q, *o[0], *i[0], *i[1]), o);
+            }
+    }
+
+    ~network()
+    {
+        for (auto p : procs) delete p;
+        for (auto s : sigs) delete s;
+    }
+
+    //! The number of processes in the network
+    size_t processes() const {return procs.size();}
+
+    //! The number of signals in the network
+    size_t signals() const {return sigs.size();}
+
+private:
+    std::vector<sc_object*> procs;
+    std::vector<sig*> sigs;
+
+    //! Keeps a process and binds its output to the rest of its successors
+    template <class P>
+    void add(P* p, const std::vector<sig*>& o)
+    {
+        for (size_t k=1; k<o.size(); k++) p->oport1(*o[k]);
+        procs.push_back(p);
+    }
+};
+
+//! Builds the network, runs it and reports the time of each phase
+template <class Net>
+int run(const synth& q)
+{
+    bench::stopwatch sw;
+    const auto topo = make_topology(q);
+    auto net = new network<Net>("net", q, topo);
+    const double t_construct = sw.lap();
+    // the SystemC elaboration (e.g., binding) and initialization
+    sc_start(SC_ZERO_TIME);
+    const double t_elaborate = sw.lap();
+    double t_xml = 0;
+#ifdef FORSYDE_INTROSPECTION
+    if (q.xml)
+    {
+        ForSyDe::XMLExport dumper("gen/");
+        dumper.traverse(net);
+        t_xml = sw.lap();
+    }
+#endif
+    const unsigned long rss_elaborated = bench::rss_kib();
+    sw.lap();
+    sc_start();
+    const double t_simulate = sw.lap();
+    const unsigned long rss_simulated = bench::rss_kib();
+    const size_t processes = net->processes(), signals = net->signals();
+    delete net;
+    const double t_teardown = sw.lap();
+
+    std::printf("moc=%s shape=%s width=%u depth=%u tokens=%llu size=%u rate=%u absent=%g "
+                "processes=%zu signals=%zu construct=%.3fs elaborate=%.3fs xml=%.3fs "
+                "simulate=%.3fs teardown=%.3fs rss_elaborated=%luKiB rss_simulated=%luKiB\n",
+                q.moc.c_str(), q.shape.c_str(), q.width, q.depth, q.tokens, q.size,
+                q.rate, q.absent, processes, signals, t_construct, t_elaborate, t_xml,
+                t_simulate, t_teardown, rss_elaborated, rss_simulated);
+    return 0;
+}
+
+int sc_main(int argc, char **argv)
+{
+    const synth q = parse(argc, argv);
+
+    if (q.moc == "sy") return run<sy_net>(q);
+    if (q.moc == "sdf") return run<sdf_net>(q);
+    return run<dde_net>(q);
+}
@@ -0,0 +1,294 @@
+/**********************************************************************
+    * main.cpp -- the work-precision benchmark of the CT solvers      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Measuring the accuracy of the filters, integrators and *
+    *          PI controllers against their cost on reference systems *
+    *          with analytic solutions                                *
+    *                                                                 *
+    * Usage:   workprec_bench [system=decay|oscillator|stiff|third|   *
+    *          integrator|pif] [process=filter|filterf]               *
+    *          [solver=rk4|bs|dp|ros] [tol=] [min_step=] [period=]    *
+    *          [duration=]                                            *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*
+ *  The reference systems are driven by a step (decay, oscillator, stiff
+ * and third) or by a cosine (integrator and pif) and their outputs are
+ * known in closed form:
+ *
+ *   decay       1/(s+1), non-stiff of order 1
+ *   oscillator  w^2/(s^2+2zws+w^2) with w = 2 pi and z = 0.1, of order 2
+ *   stiff       1000/((s+1)(s+1000)), stiff of order 2
+ *   third       1/(s+1)^3, non-stiff of order 3
+ *   integrator  the integrator (1/s) of cos(2 pi t)
+ *   pif         the PI controller with kp = 2 and ki = 5 of cos(2 pi t)
+ *
+ *  The process is the adaptive filter (or integrator) with the given
+ * solver, tolerated error tol and minimum step min_step (in seconds), or
+ * the fixed-step filterf (or integratorf) with the step period (in
+ * seconds), which is also the maximum step of the adaptive ones. The PI
+ * controller is always a fixed-step one. The solvers are the values of
+ * DDE::ode_solver, and a new solver should be added to the solvers table
+ * below to be covered.
+ *
+ *  The output is compared with the solution at the start of each of its
+ * sub-signals, where the held output of a step is the solution of the
+ * solver. The run prints a key=value line with the error norms (the
+ * maximum and the RMS of the absolute errors), the wall-clock time, the
+ * accepted and rejected steps, the evaluations of the derivative and the
+ * output sub-signals (tokens). When BENCH_RESULTS names a file, it also
+ * appends a CSV record to it, labeled with BENCH_LABEL:
+ *
+ *   label,system,process,solver,tol,min_step,period,duration,seconds,
+ *   max_error,rms_error,accepted,rejected,min_step_hits,rhs_evals,tokens
+ *
+ * which can be plotted as work-precision diagrams, e.g., the errors
+ * against the seconds or the evaluations of each solver.
+ */
+
+#include "../bench.hpp"
+#include <cmath>
+#include <functional>
+
+using namespace ForSyDe;
+
+//! The parameters of a run
+struct workprec
+{
+    std::string system = "decay";   ///< the reference system
+    std::string process = "filter"; ///< the adaptive or the fixed-step process
+    std::string solver = "rk4";     ///< the solver of the adaptive process
+    double tol = 1e-5;              ///< the tolerated error
+    double min_step = 0.05e-9;      ///< the minimum step in seconds
+    double period = 1e-2;           ///< the (maximum) step in seconds
+    double duration = 5;            ///< the simulated time in seconds
+};
+
+//! The names of the solvers of the adaptive filters
+const std::vector<std::pair<std::string,DDE::ode_solver>> solvers = {
+    {"rk4", DDE::RK4},
+    {"bs", DDE::BOGACKI_SHAMPINE},
+    {"dp", DDE::DORMAND_PRINCE},
+    {"ros", DDE::ROSENBROCK}
+};
+
+//! Parses the key=value arguments of a run
+inline workprec parse(int argc, char** argv)
+{
+    workprec q;
+    bool valid = true;
+    for (int i=1; i<argc; i++)
+    {
+        const std::string arg = argv[i];
+        const size_t eq = arg.find('=');
+        const std::string key = arg.substr(0, eq);
+        const std::string val = eq == std::string::npos ? "" : arg.substr(eq+1);
+        if (key == "system") q.system = val;
+        else if (key == "process") q.process = val;
+        else if (key == "solver") q.solver = val;
+        else if (key == "tol") q.tol = std::stod(val);
+        else if (key == "min_step") q.min_step = std::stod(val);
+        else if (key == "period") q.period = std::stod(val);
+        else if (key == "duration") q.duration = std::stod(val);
+        else valid = false;
+    }
+    bool known = false;
+    for (auto& s : solvers) known = known || s.first == q.solver;
+    valid = valid && known && (q.process == "filter" || q.process == "filterf") &&
+            q.period > 0 && q.duration > 0 &&
+            (q.system == "decay" || q.system == "oscillator" || q.system == "stiff" ||
+             q.system == "third" || q.system == "integrator" || q.system == "pif");
+    if (valid) return q;
+    std::fprintf(stderr, "usage: %s [system=decay|oscillator|stiff|third|integrator|pif] "
+                 "[process=filter|filterf] [solver=", argv[0]);
+    for (size_t i=0; i<solvers.size(); i++)
+        std::fprintf(stderr, "%s%s", i ? "|" : "", solvers[i].first.c_str());
+    std::fprintf(stderr, "] [tol=] [min_step=] [period=] [duration=]\n");
+    std::exit(1);
+}
+
+//! A reference system: its transfer function, its input and its output
+struct reference
+{
+    std::vector<CTTYPE> num, den;
+    std::function<double(double)> input, output;
+};
+
+inline reference make_reference(const std::string& system)
+{
+    const double pi = std::acos(-1.0);
+    const auto step = [](double) {return 1.0;};
+    const auto wave = [pi](double t) {return std::cos(2*pi*t);};
+    if (system == "decay")
+        return {{1}, {1, 1}, step, [](double t) {return 1 - std::exp(-t);}};
+    if (system == "oscillator")
+    {
+        const double w = 2*pi, z = 0.1, wd = w * std::sqrt(1-z*z);
+        return {{w*w}, {1, 2*z*w, w*w}, step,
+                [=](double t)
+                {
+                    return 1 - std::exp(-z*w*t) *
+                               (std::cos(wd*t) + z / std::sqrt(1-z*z) * std::sin(wd*t));
+                }};
+    }
+    if (system == "stiff")
+        return {{1000}, {1, 1001, 1000}, step,
+                [](double t) {return 1 - (1000*std::exp(-t) - std::exp(-1000*t)) / 999;}};
+    if (system == "third")
+        return {{1}, {1, 3, 3, 1}, step,
+                [](double t) {return 1 - std::exp(-t) * (1 + t + t*t/2);}};
+    if (system == "integrator")
+        return {{1}, {1, 0}, wave, [pi](double t) {return std::sin(2*pi*t) / (2*pi);}};
+    // the PI controller with kp = 2 and ki = 5
+    return {{2, 5}, {1, 0}, wave,
+            [pi](double t) {return 2*std::cos(2*pi*t) + 5*std::sin(2*pi*t) / (2*pi);}};
+}
+
+//! Compares the output sub-signals with the solution at their start
+class probe : public CT::ct_process
+{
+public:
+    CT::CT_in iport1;       ///< port for the input channel
+
+    probe(sc_module_name _name, std::function<double(double)> exact, sc_time horizon)
+        : ct_process(_name), iport1("iport1"), exact(exact), horizon(horizon),
+          tokens(0), samples(0), max_error(0), sq_error(0) {}
+
+    std::string forsyde_kind() const {return "CT::probe";}
+
+    unsigned long long tokens, samples;
+    double max_error, sq_error;
+
+private:
+    std::function<double(double)> exact;
+    sc_time horizon;
+    CT::sub_signal val;
+
+    void init() {}
+
+    void prep()
+    {
+        val = iport1.read();
+    }
+
+    void exec()
+    {
+        tokens++;
+        const sc_time t = get_start_time(val);
+        if (t >= horizon) return;
+        const double err = std::abs(val(t) - exact(t.to_seconds()));
+        max_error = std::max(max_error, err);
+        sq_error += err * err;
+        samples++;
+    }
+
+    void prod() {}
+
+    void clean() {}
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! The statistics of the solver of a filter
+template <class F>
+inline const solver_stats& statistics(const F& f)
+{
+#ifdef FORSYDE_CT_NATIVE_FILTERS
+    return f.statistics();
+#else
+    return f.filter1.statistics();
+#endif
+}
+
+SC_MODULE(testbench)
+{
+    CT::signal src, out;
+    probe* probe1;
+    std::function<const solver_stats&()> stats;
+
+    testbench(sc_module_name _name, const workprec& q) : sc_module(_name)
+    {
+        const reference ref = make_reference(q.system);
+        const sc_time duration(q.duration, SC_SEC), period(q.period, SC_SEC);
+        const auto input = ref.input;
+        CT::make_source("source1",
+            [input](CTTYPE& out, const sc_time& t)
+            {
+                out = input(t.to_seconds());
+            }, duration, src);
+
+        DDE::ode_solver solver = DDE::RK4;
+        for (auto& s : solvers) if (s.first == q.solver) solver = s.second;
+        if (q.system == "pif")
+        {
+            auto p = CT::make_pif("pif1", ref.num[0], ref.num[1], period, out, src);
+            stats = [p]() -> const solver_stats& {return statistics(p->integrator1);};
+        }
+        else if (q.process == "filterf")
+        {
+            auto p = CT::make_filterf("filterf1", ref.num, ref.den, period, out, src);
+            stats = [p]() -> const solver_stats& {return statistics(*p);};
+        }
+        else
+        {
+            auto p = new CT::filter("filter1", ref.num, ref.den, period,
+                                    sc_time(q.min_step, SC_SEC), q.tol, solver);
+            p->iport1(src);
+            p->oport1(out);
+            stats = [p]() -> const solver_stats& {return statistics(*p);};
+        }
+
+        probe1 = new probe("probe1", ref.output, duration);
+        probe1->iport1(out);
+    }
+};
+
+int sc_main(int argc, char **argv)
+{
+    const workprec q = parse(argc, argv);
+
+    testbench tb("tb", q);
+
+    bench::stopwatch sw;
+    sc_start(sc_time(q.duration, SC_SEC));
+    const double secs = sw.lap();
+
+    const solver_stats& st = tb.stats();
+    const probe& pr = *tb.probe1;
+    const double rms = pr.samples ? std::sqrt(pr.sq_error / pr.samples) : 0;
+    // the fixed-step processes have no solver, tolerance or minimum step
+    const bool fixed = q.process == "filterf" || q.system == "pif";
+    const std::string solver = fixed ? "rk4" : q.solver;
+    std::printf("system=%s process=%s solver=%s tol=%g min_step=%g period=%g duration=%g "
+                "seconds=%.6f max_error=%.3e rms_error=%.3e accepted=%llu rejected=%llu "
+                "min_step_hits=%llu rhs_evals=%llu tokens=%llu\n",
+                q.system.c_str(), fixed ? "filterf" : "filter", solver.c_str(), q.tol,
+                q.min_step, q.period, q.duration, secs, pr.max_error, rms, st.accepted,
+                st.rejected, st.min_step_hits, st.rhs_evals, pr.tokens);
+    if (const char* results = std::getenv("BENCH_RESULTS"))
+    {
+        const char* label = std::getenv("BENCH_LABEL");
+        std::ofstream ofs(results, std::ios::app);
+        if (!ofs.is_open())
+        {
+            std::fprintf(stderr, "%s could not be opened to write the results\n", results);
+            return 1;
+        }
+        ofs << (label ? label : "") << ',' << q.system << ','
+            << (fixed ? "filterf" : "filter") << ',' << solver << ',' << q.tol << ','
+            << q.min_step << ',' << q.period << ',' << q.duration << ',' << secs << ','
+            << pr.max_error << ',' << rms << ',' << st.accepted << ',' << st.rejected << ','
+            << st.min_step_hits << ',' << st.rhs_evals << ',' << pr.tokens << std::endl;
+    }
+    return 0;
+}
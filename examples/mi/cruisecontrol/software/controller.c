@@ -1,6 +1,9 @@
 
 double inp, pinp, out, pout;
 
+#ifdef FORSYDE_SHIM
+#include "forsyde/gdbwrap_shim.h"
+#else
 double forsyde_read_in1()
 {
     double a;
@@ -10,6 +13,7 @@ void forsyde_write_out(double a)
 {
     double b;
 }
+#endif
 
 int main() {
   double forsyde_in1, forsyde_out;
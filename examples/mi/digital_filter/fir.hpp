@@ -26,30 +26,32 @@ SC_MODULE(fir)
     SY_in<double> iport1;
     SY_out<double> oport1;
     
-    std::vector<SY2SY<double>> del_line;
+    SY2SY<double> del_in;
     std::vector<SY2SY<double>> coef_line;
     std::vector<SY2SY<double>> coef_src_line;
     std::vector<SY2SY<double>> mac_line;
     std::vector<SY2SY<double>> res_line;
     
-    SC_CTOR(fir): del_line(TAPS-1),
-                  coef_line(TAPS),
+    SC_CTOR(fir): coef_line(TAPS),
                   coef_src_line(TAPS),
                   mac_line(TAPS-1),
                   res_line(TAPS-1)
     
     {
-        auto fo = make_fanout("fo", del_line[0], iport1);
+        auto fo = make_fanout("fo", del_in, iport1);
         fo->oport1(coef_line[0]);
         
         SY::make_constant("coef0", abst_ext<double>(coefs[0]), 0, coef_src_line[0]);
         
         SY::make_comb2("mul0", mul_func, res_line[0], coef_line[0], coef_src_line[0]);
         
+        std::array<unsigned int,TAPS-1> taps;
+        for (int i=0; i<TAPS-1; i++) taps[i] = i+1;
+        auto del = SY::make_delayline("del_line", abst_ext<double>(0), taps, del_in);
+        
         for (int i=0; i<TAPS-1; i++)
         {
-            auto del = SY::make_delay("del_line"+std::to_string(i), abst_ext<double>(0), coef_line[i+1], del_line[i]);
-            if (i<TAPS-1-1) del->oport1(del_line[i+1]);
+            del->oport[i](coef_line[i+1]);
             
             SY::make_constant("coef"+std::to_string(i+1), abst_ext<double>(coefs[i+1]), 0, coef_src_line[i+1]);
             
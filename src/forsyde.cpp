@@ -0,0 +1,26 @@
+/**********************************************************************
+    * forsyde.cpp -- the compiled part of the ForSyDe-SystemC library *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Compiling the instances of the common token types once *
+    *                                                                 *
+    * Usage:   Compile it with the same FORSYDE_* macros as the model *
+    *          and link it with the models which are compiled with    *
+    *          FORSYDE_EXTERN_TEMPLATES                               *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+/*! \file forsyde.cpp
+ * \brief Compiles the instances declared in forsyde/instances.hpp
+ *
+ *  The library remains usable as header-only. This file is only needed
+ * by the models compiled with FORSYDE_EXTERN_TEMPLATES, e.g.:
+ *
+ *     g++ -c -O2 -I$SYSTEMC_HOME/include -Isrc src/forsyde.cpp
+ *     ar rcs libforsyde.a forsyde.o
+ */
+
+#define FORSYDE_INSTANTIATE_TEMPLATES
+#include "forsyde.hpp"
@@ -52,6 +52,7 @@
  *
  *     - Synchronous MoC in ForSyDe::SY
  *     - Untimed MoC in ForSyDe::UT and its Synchronous Dataflow variant in ForSyDe::SDF
+ *     - Cyclo-Static Dataflow, an extension of SDF, in ForSyDe::CSDF
  *     - Two timed MoCs Distributed Discrete-Event in ForSyDe::DDE and Discrete-Time in ForSyDe::DT
  *     - Continuous-Time MoC in ForSyDe::CT
  */
@@ -67,6 +68,12 @@
 #include "forsyde/prettyprint.hpp"
 
 // include the main SystemC library
+// (the parallel simulation spawns the threads of the split signals and
+// the checkpoints the ones which write the restored tokens)
+#if (defined(FORSYDE_PARALLEL_SIM) || defined(FORSYDE_CHECKPOINT)) && \
+    !defined(SC_INCLUDE_DYNAMIC_PROCESSES)
+#define SC_INCLUDE_DYNAMIC_PROCESSES
+#endif
 #include <systemc>
 
 #ifdef FORSYDE_INTROSPECTION
@@ -75,42 +82,161 @@
 
 // include the abstract semantics
 #include "forsyde/abssemantics.hpp"
+#include "forsyde/shared_token.hpp"
+#include "forsyde/ensemble.hpp"
 
 // include different MoCs
+// (a MoC can be left out with FORSYDE_NO_<MoC> to reduce the compile time
+// of the models which do not use it)
+#if defined(FORSYDE_NO_DDE) && !defined(FORSYDE_NO_CT)
+#error "the CT MoC requires the DDE MoC, define FORSYDE_NO_CT as well"
+#endif
+#if defined(FORSYDE_PARALLEL_SIM) && (defined(FORSYDE_NO_SDF) || defined(FORSYDE_NO_DDE))
+#error "the parallel simulation requires the SDF and DDE MoCs"
+#endif
+#if defined(FORSYDE_MPI_PROGRESS_THREAD) && !defined(FORSYDE_PARALLEL_SIM)
+#error "the MPI communication thread requires FORSYDE_PARALLEL_SIM"
+#endif
+#if defined(FORSYDE_PERF_COUNTERS) && !defined(FORSYDE_PROFILE)
+#error "the hardware performance counters require FORSYDE_PROFILE"
+#endif
+#if defined(FORSYDE_PROFILE_DB) && !defined(FORSYDE_PROFILE)
+#error "the profile database requires FORSYDE_PROFILE"
+#endif
+#if defined(FORSYDE_METRICS) && !(defined(FORSYDE_PROFILE) && defined(FORSYDE_INTROSPECTION))
+#error "the live metrics require FORSYDE_PROFILE and FORSYDE_INTROSPECTION"
+#endif
+
 #include "forsyde/ut_moc.hpp"
 
 #include "forsyde/sy_moc.hpp"
 #include "forsyde/sy_lib.hpp"
 
+#ifndef FORSYDE_NO_SDF
 #include "forsyde/sdf_moc.hpp"
+#include "forsyde/sdf_lib.hpp"
+#include "forsyde/csdf_moc.hpp"
+#endif
 
+#ifndef FORSYDE_NO_SADF
 #include "forsyde/sadf_moc.hpp"
+#endif
 
+#ifndef FORSYDE_NO_DDE
 #include "forsyde/dde_moc.hpp"
+#endif
 
+#ifndef FORSYDE_NO_DT
 #include "forsyde/dt_moc.hpp"
+#endif
 
+#ifndef FORSYDE_NO_CT
 #include "forsyde/ct_moc.hpp"
 #include "forsyde/ct_lib.hpp"
+#endif
 
 // include MoC interfaces
 #include "forsyde/mis.hpp"
 #include "forsyde/mi_helpers.hpp"
 
 #include "forsyde/adaptivity.hpp"
+#include "forsyde/elab_optimizer.hpp"
+#include "forsyde/zip_fusion.hpp"
+#include "forsyde/native_kernel.hpp"
 
 #ifdef FORSYDE_INTROSPECTION
 #include "forsyde/xml.hpp"
+#include "forsyde/process_graph.hpp"
+#include "forsyde/codegen.hpp"
+#include "forsyde/model_loader.hpp"
+#ifdef FORSYDE_SIGNAL_STATS
+#include "forsyde/signal_stats.hpp"
+#endif
+#ifdef FORSYDE_MEMORY_REPORT
+#include "forsyde/memory_report.hpp"
+#endif
+#ifdef FORSYDE_METRICS
+#include "forsyde/metrics.hpp"
+#endif
+#ifndef FORSYDE_NO_SDF
+#include "forsyde/sdf_buffers.hpp"
+#ifdef FORSYDE_PROFILE
+#include "forsyde/bottleneck.hpp"
+#endif
+#endif
 #endif
 
 #ifdef FORSYDE_PARALLEL_SIM
 #include "forsyde/parallel_sim_helpers.hpp"
+#include "forsyde/partitioner.hpp"
+#endif
+
+#ifdef FORSYDE_MULTITHREADED
+#include "forsyde/sy_parallel_executor.hpp"
+#ifndef FORSYDE_NO_SDF
+#include "forsyde/sdf_hsdf_executor.hpp"
+#endif
+#ifndef FORSYDE_NO_SADF
+#include "forsyde/sadf_parallel_executor.hpp"
+#endif
+#endif
+
+#ifdef FORSYDE_OFFLOAD
+#include "forsyde/sy_offload.hpp"
+#endif
+
+#ifdef FORSYDE_SIGNAL_TRACE
+#include "forsyde/trace_recorder.hpp"
+#include "forsyde/sweep.hpp"
+#include "forsyde/process_bench.hpp"
+#include "forsyde/equivalence.hpp"
+#ifdef FORSYDE_INTROSPECTION
+#include "forsyde/incremental.hpp"
+#endif
+#endif
+
+#ifdef FORSYDE_CHECKPOINT
+#include "forsyde/checkpoint.hpp"
+#ifdef FORSYDE_PARALLEL_SIM
+#include "forsyde/sy_rebalance.hpp"
+#ifndef FORSYDE_NO_DDE
+#include "forsyde/dde_time_warp.hpp"
+#endif
+#endif
+#endif
+
+#ifdef FORSYDE_RESET
+#include "forsyde/reset.hpp"
+#include "forsyde/sim_server.hpp"
+#endif
+
+#ifdef FORSYDE_REALTIME
+#include "forsyde/realtime.hpp"
+#endif
+
+#ifdef FORSYDE_UDP_IO
+#include "forsyde/udp_io_helpers.hpp"
+#endif
+
+#ifdef FORSYDE_TLM
+#include "forsyde/tlm_bridge.hpp"
+#endif
+
+#ifdef FORSYDE_NUMA
+#include "forsyde/numa_placement.hpp"
 #endif
 
 #ifdef FORSYDE_COSIMULATION_WRAPPERS
 #include "forsyde/sy_wrappers.hpp"
+#ifndef FORSYDE_NO_CT
 #include "forsyde/ct_wrappers.hpp"
 #endif
+#endif
+
+// the instances of the common token types are compiled in forsyde.cpp
+#if defined(FORSYDE_EXTERN_TEMPLATES) || defined(FORSYDE_INSTANTIATE_TEMPLATES)
+#include "forsyde/instances.hpp"
+#endif
 
 
 #endif
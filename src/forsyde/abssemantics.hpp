@@ -30,6 +30,65 @@
 
 #include <sstream>
 #include <fstream>
+#include <vector>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <climits>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <memory>
+
+#include "spsc_fifo.hpp"
+#include "span_fifo.hpp"
+#ifdef FORSYDE_SPILL_FIFO
+#include "spill_fifo.hpp"
+#endif
+#include "abst_ext.hpp"
+#ifdef FORSYDE_PROFILE
+#include "profiler.hpp"
+#endif
+#ifdef FORSYDE_PROFILE_DB
+#include "profile_db.hpp"
+#endif
+#ifdef FORSYDE_TIMELINE
+#include "timeline.hpp"
+#endif
+#ifdef FORSYDE_SAMPLING_PROFILE
+#include "sampler.hpp"
+#endif
+#ifdef FORSYDE_ALLOC_TRACKER
+#include "alloc_tracker.hpp"
+#endif
+#ifdef FORSYDE_METRICS
+#include <atomic>
+#endif
+#ifdef FORSYDE_PARALLEL_SIM
+#include <memory>
+#include "mpi_transport.hpp"
+#endif
+#ifdef FORSYDE_CHECKPOINT
+#include "serializer.hpp"
+#endif
+#ifdef FORSYDE_NUMA
+#include "numa.hpp"
+#endif
+#ifdef FORSYDE_ARENA
+#include "arena.hpp"
+#endif
+#ifdef FORSYDE_TOKEN_POOL
+#include "token_pool.hpp"
+#endif
+#ifdef FORSYDE_COROUTINES
+#if __cplusplus < 202002L
+#error "the coroutine processes require C++20"
+#endif
+#include <coroutine>
+#include <deque>
+#include <memory>
+#endif
 
 
 namespace ForSyDe
@@ -37,18 +96,166 @@ namespace ForSyDe
 
 using namespace sc_core;
 
+//! Checks if a port can write a token to all its channels at once
+template <typename If, typename = void>
+struct has_write_all : std::false_type {};
+
+template <typename If>
+struct has_write_all<If, std::void_t<decltype(&If::write_all)>> : std::true_type {};
+
+//! Checks if a FIFO channel can change its capacity, keeping its tokens
+template <typename Fifo, typename = void>
+struct has_set_capacity : std::false_type {};
+
+template <typename Fifo>
+struct has_set_capacity<Fifo, std::void_t<decltype(std::declval<Fifo&>().set_capacity(1))>>
+    : std::true_type {};
+
+//! Set if the protected members of sc_fifo have the layout relied upon by the signals
+/*! It is the case in SystemC 2.3 and 3.0, where the buffer is m_buf and
+ * buf_init() allocates it and resets its indices.
+ */
+#if defined(SC_VERSION_MAJOR) && ((SC_VERSION_MAJOR == 2 && SC_VERSION_MINOR == 3) || \
+                                  (SC_VERSION_MAJOR == 3 && SC_VERSION_MINOR == 0))
+#define FORSYDE_SC_FIFO_INTERNALS 1
+#else
+#define FORSYDE_SC_FIFO_INTERNALS 0
+#endif
+
 // Auxilliary Macro definitions
 template<typename T, typename If>
 void inline write_multiport(If& PORT, const T& VAL)  {
-    for (int WMPi=0;WMPi<PORT.size();WMPi++)
-        PORT[WMPi]->write(VAL);
+    // the ForSyDe ports write to their channels directly
+    if constexpr (has_write_all<If>::value)
+        PORT.write_all(VAL);
+    else
+        for (int WMPi=0;WMPi<PORT.size();WMPi++)
+            PORT[WMPi]->write(VAL);
+}
+
+#ifdef FORSYDE_RESET
+//! The kernel time at which the model was last reset
+inline sc_time& model_epoch()
+{
+    static sc_time epoch = SC_ZERO_TIME;
+    return epoch;
+}
+#endif
+
+//! The simulated time of the model
+/*! It is the kernel time, counted from the last reset of the model with
+ * FORSYDE_RESET, since the kernel time can not be rewound. The timed
+ * processes use it instead of sc_time_stamp().
+ */
+inline sc_time model_time()
+{
+#ifdef FORSYDE_RESET
+    return sc_time_stamp() - model_epoch();
+#else
+    return sc_time_stamp();
+#endif
+}
+
+#ifdef FORSYDE_CHECKPOINT
+//! The interface of the channels which keep track of a blocked writer
+/*! The tokens which the writer is blocked writing are saved with the
+ * contents of the channel when a checkpoint is made.
+ */
+template <typename TokenType>
+class pending_channel
+{
+public:
+    //! Announces the tokens to be written, the first one with a blocking write
+    virtual void set_pending(const TokenType* first, size_t n) = 0;
+};
+#endif
+
+//! Writes a range of tokens to a channel
+/*! The tokens are written in chunks which fit in the free space of the
+ * channel, so that the writer only blocks when the channel is full. The
+ * range should be contiguous.
+ */
+template<typename Chan, typename It>
+void inline write_range(Chan* CHAN, It FIRST, size_t N)  {
+    while (N>0)
+    {
+        size_t k = CHAN->num_free();
+        if (k==0)
+        {
+#ifdef FORSYDE_CHECKPOINT
+            typedef typename std::iterator_traits<It>::value_type V;
+            if (auto pc = dynamic_cast<pending_channel<V>*>(CHAN))
+                pc->set_pending(&*FIRST, N);
+#endif
+            // block until some space is freed
+            CHAN->write(*FIRST);
+            ++FIRST; N--;
+            continue;
+        }
+        for (k = std::min(k,N); k>0; k--, N--, ++FIRST)
+            CHAN->write(*FIRST);
+    }
+}
+
+//! Reads a token from a channel into the position of an iterator
+/*! With FORSYDE_TOKEN_POOL, the heap-backed tokens are read into the
+ * storage which is already there instead of replacing it.
+ */
+template<typename Chan, typename It>
+void inline read_at(Chan* CHAN, It POS)  {
+#ifdef FORSYDE_TOKEN_POOL
+    typedef typename std::iterator_traits<It>::value_type V;
+    if constexpr (is_pooled_token<V>::value)
+        CHAN->read(*POS);
+    else
+#endif
+    *POS = CHAN->read();
+}
+
+//! Reads a range of tokens from a channel
+/*! All the available tokens are taken without blocking, and the reader
+ * only blocks when the channel is empty.
+ */
+template<typename Chan, typename It>
+void inline read_range(Chan* CHAN, It FIRST, size_t N)  {
+    while (N>0)
+    {
+        size_t k = CHAN->num_available();
+        if (k==0)
+        {
+            // block until a new token arrives
+            read_at(CHAN, FIRST);
+            ++FIRST; N--;
+            continue;
+        }
+        for (k = std::min(k,N); k>0; k--, N--, ++FIRST)
+            read_at(CHAN, FIRST);
+    }
 }
 
 template<typename T, typename If>
 void inline write_vec_multiport(If& PORT, const std::vector<T>& VEC)  {
     for (int WMPi=0;WMPi<PORT.size();WMPi++)
-        for (auto WMPit=VEC.begin();WMPit!=VEC.end();WMPit++)
-            PORT[WMPi]->write(*WMPit);
+        write_range(PORT[WMPi], VEC.begin(), VEC.size());
+}
+
+//! Writes a number of absent tokens of type abst_ext<T> to a port
+/*! With FORSYDE_ABSENT_RLE, they are written as a single record which is
+ * expanded by the signal when it is read.
+ */
+template<typename T, typename If>
+void inline write_absents_multiport(If& PORT, size_t N)  {
+#ifdef FORSYDE_ABSENT_RLE
+    while (N>0)
+    {
+        const unsigned int k = N < abst_ext<T>::max_run ? N : abst_ext<T>::max_run;
+        write_multiport(PORT, abst_ext<T>::absent_run(k));
+        N -= k;
+    }
+#else
+    for (; N>0; N--)
+        write_multiport(PORT, abst_ext<T>());
+#endif
 }
 
 //! Type of the object bound to a port
@@ -61,6 +268,9 @@ public:
     //! Name of the tokens in the channels
     virtual const char* token_type() const = 0;
     
+    //! The interned ID of the token type (see get_type_id)
+    virtual unsigned token_type_id() const = 0;
+    
     // TODO: remove if proved not to be needed
     //~ //! Size of the tokens in the channels
     //~ virtual unsigned token_size() const = 0;
@@ -68,183 +278,2227 @@ public:
     //! To which MoC does the signal belong
     virtual std::string moc() const = 0;
     
+#ifdef FORSYDE_INTROSPECTION
+    //! The interned ID of the MoC, which is looked up only once
+    unsigned moc_id() const
+    {
+        if (moc_idx == UINT_MAX) moc_idx = moc_names().intern(moc());
+        return moc_idx;
+    }
+#endif
+    
     //! Input port to which a channel is bound
     sc_object* iport;
     
     //! Output port to which a channel is bound
     sc_object* oport;
+
+private:
+    mutable unsigned moc_idx = UINT_MAX;
 };
 
-//! A ForSyDe signal is used to inter-connect processes
-template <typename T, typename TokenType>
-class signal: public sc_fifo<TokenType>
-#ifdef FORSYDE_INTROSPECTION
-            , public ForSyDe::introspective_channel
-#endif
+//! A helper class used by executors which take over the buffering of channels
+/*! When both the writer and the reader of a channel are executed by the
+ * same (statically scheduled) thread, the executor can switch the
+ * channel to a plain ring buffer which bypasses the kernel events of
+ * the sc_fifo.
+ */
+class static_channel
 {
 public:
-    signal() : sc_fifo<TokenType>() {}
-    signal(sc_module_name name, unsigned size) : sc_fifo<TokenType>(name, size) {}
-#ifdef FORSYDE_INTROSPECTION
-    typedef T type;
+    //! Switches the channel to a plain ring buffer of the given capacity
+    virtual void set_static_buffer(size_t capacity) = 0;
     
-    // TODO: remove if proved not to be needed
-    //~ //! Returns only the size of the token type
-    //~ virtual unsigned token_size() const
-    //~ {
-        //~ return sizeof(T);
-    //~ }
+    //! Checks if the channel is using a plain ring buffer
+    virtual bool is_static_buffer() const = 0;
     
-    // TODO: remove if proved not to be needed
-    //! Returns the name of the token type
-    virtual const char* token_type() const
+    //! Switches the channel to a ring buffer placed in a shared arena
+    /*! The arena should be made by make_arena() of a channel with the
+     * same token type. The ring buffer takes the given number of slots
+     * from the offset, which may also be used by other channels as long
+     * as they never hold tokens at the same time.
+     */
+    virtual void set_shared_buffer(std::shared_ptr<void> arena,
+                                   size_t offset, size_t capacity) = 0;
+    
+    //! Allocates an arena of tokens of the type carried by the channel
+    virtual std::shared_ptr<void> make_arena(size_t slots) const = 0;
+    
+    //! The type of the tokens carried by the channel
+    virtual const std::type_info& token_type() const = 0;
+    
+    //! Number of tokens available for reading
+    virtual int num_available() const = 0;
+    
+    //! Number of free slots for writing
+    virtual int num_free() const = 0;
+    
+    //! The event notified when tokens are written to the channel
+    virtual const sc_event& data_written_event() const = 0;
+    
+    //! The event notified when tokens are read from the channel
+    virtual const sc_event& data_read_event() const = 0;
+};
+
+//! The slots of the plain ring buffer of a statically scheduled channel
+/*! They are either owned by the channel or a range of an arena shared
+ * with the channels whose tokens are never alive at the same time (see
+ * SDF::static_scheduler::set_buffer_sharing()).
+ */
+template <typename TokenType>
+class static_slots
+{
+public:
+    bool empty() const {return n == 0;}
+    
+    size_t size() const {return n;}
+    
+    //! The number of slots owned by the channel
+    size_t capacity() const {return own.capacity() + node_slots;}
+    
+    TokenType& operator[](size_t i) {return ptr[i];}
+    
+    const TokenType& operator[](size_t i) const {return ptr[i];}
+    
+    TokenType* begin() {return ptr;}
+    
+    //! Makes the channel own the given number of slots
+    /*! With FORSYDE_NUMA, the slots are allocated on the node of the
+     * numa_scope active on the calling thread, if any.
+     */
+    void resize(size_t slots)
     {
-        return get_type_name<T>();
+#ifdef FORSYDE_NUMA
+        const numa_target& t = numa_scope::current();
+        if (t.node >= 0 && slots > 0)
+        {
+            share(numa_make_array<TokenType>(slots, t.node, t.huge), 0, slots);
+            node_slots = slots;
+            return;
+        }
+#endif
+        own.resize(slots);
+        shared.reset();
+        ptr = own.data();
+        n = slots;
+        node_slots = 0;
     }
     
-    virtual std::string moc() const = 0;
+    //! Takes a number of slots of an arena from the given offset
+    void share(std::shared_ptr<TokenType> arena, size_t offset, size_t slots)
+    {
+        std::vector<TokenType>().swap(own);
+        shared = arena;
+        ptr = arena.get() + offset;
+        n = slots;
+        node_slots = 0;
+    }
+    
+private:
+    std::vector<TokenType> own;
+    std::shared_ptr<TokenType> shared;
+    TokenType* ptr = NULL;
+    size_t n = 0;
+    // the slots owned by the channel on a NUMA node
+    size_t node_slots = 0;
+};
+
+//! The interface of the channels whose capacity can be changed
+/*! It is used by the analyses which size the buffers of a model after
+ * the elaboration phase.
+ */
+class resizable_channel
+{
+public:
+    //! Changes the capacity of the channel before the simulation starts
+    virtual void set_capacity(size_t capacity) = 0;
+};
+
+#ifdef FORSYDE_PROFILE_DB
+//! Sets the capacities of the signals below a module after their peak occupancy
+/*! Each signal in the profile database gets room for its peak occupancy
+ * times the slack, and at least one token. It should be called after the
+ * elaboration and before the simulation starts, and returns the number
+ * of the resized signals.
+ */
+inline size_t apply_fifo_sizes(sc_object* root, double slack=1.5)
+{
+    size_t res = 0;
+    for (auto c : root->get_child_objects())
+    {
+        res += apply_fifo_sizes(c, slack);
+        auto ch = dynamic_cast<resizable_channel*>(c);
+        auto e = profile_db::get().channel_profile(c->name());
+        if (ch == NULL || e == NULL || e->peak == 0) continue;
+        ch->set_capacity(std::max<size_t>(std::ceil(e->peak * slack), 1));
+        res++;
+    }
+    return res;
+}
 #endif
+
+#ifdef FORSYDE_ADAPTIVE_FIFO
+//! The bounds and thresholds of a signal which adapts its capacity
+/*! The writes to the signal are observed in windows of a fixed number
+ * of writes. The capacity is doubled as soon as the writes which found
+ * the signal full in the current window exceed the given fraction of
+ * the window, and halved at the end of a window without any such write
+ * in which the occupancy has stayed at most the given fraction of the
+ * capacity. It always stays within the given bounds.
+ */
+struct fifo_policy
+{
+    size_t min_capacity = 1;        ///< the smallest capacity
+    size_t max_capacity = 1024;     ///< the largest capacity
+    unsigned window = 64;           ///< the writes of an observation window
+    double grow_blocking = 0.1;     ///< the fraction of blocked writes which grows it
+    double shrink_occupancy = 0.25; ///< the fraction of the capacity below which it shrinks
 };
 
-//! This type is used in the process base class to store structural information
-struct PortInfo
+//! The interface of the channels which can adapt their capacity at run time
+class adaptive_channel
 {
-    sc_object* port;
-    // TODO: remove if proved not to be needed
-    //~ unsigned toks;
-    std::string portType;
+public:
+    //! Lets the channel adapt its capacity with the given policy
+    virtual void set_adaptive(const fifo_policy& policy) = 0;
+    
+    //! The current capacity of the channel
+    virtual size_t adaptive_capacity() const = 0;
+    
+    //! The number of times the capacity has grown and shrunk
+    virtual unsigned long long adaptive_resizes() const = 0;
 };
+#endif
 
-//! A helper class used to provide introspective ports
-class introspective_port
+//! The interface of the channels which can wait for a number of tokens
+/*! It is used by the processes to wait for a whole partition of their
+ * input with a single blocking wait, instead of one per token.
+ */
+class prefetch_channel
 {
 public:
-    //! To which port it is bound (used for binding ports of composite processes in the hierarchy)
-    sc_object* bound_port;
+    //! Blocks until n tokens are available or the channel is full
+    virtual void wait_tokens(size_t n) = 0;
+};
+
+#ifdef FORSYDE_SIGNAL_STATS
+//! The occupancy and back-pressure statistics of a channel
+/*! The occupancy is the number of records buffered in the channel, where
+ * a run of absent tokens is a single record. Its average is weighted by
+ * the simulated time, or by the delta cycles if the simulated time has
+ * not advanced (e.g., in the untimed models).
+ */
+struct signal_stats
+{
+    unsigned long long tokens = 0;          ///< records written to the channel
+    size_t high_water = 0;                  ///< the maximum occupancy
+    double mean_occupancy = 0;              ///< the time-weighted average occupancy
+    size_t capacity = 0;                    ///< the current capacity of the channel
+    unsigned long long blocked_writes = 0;  ///< writes which found the channel full
+    unsigned long long blocked_reads = 0;   ///< reads which found the channel empty
+};
+
+//! The interface of the channels which collect occupancy statistics
+class stats_channel
+{
+public:
+    //! Returns the statistics collected up to the current time
+    virtual signal_stats stats() const = 0;
     
-    //! Name of the tokens of the port
-    virtual const char* token_type() const = 0;
+#ifdef FORSYDE_METRICS
+    //! The current occupancy, which can be read by other threads
+    virtual size_t live_occupancy() const = 0;
+#endif
+};
+#endif
 
-    //! To which MoC does the signal belong
-    virtual std::string moc() const = 0;
+#ifdef FORSYDE_MEMORY_REPORT
+//! The interface of the channels which report their memory footprint
+class footprint_channel
+{
+public:
+    //! The size of the channel object in bytes
+    virtual size_t object_bytes() const = 0;
+    
+    //! The bytes allocated for the buffer of the channel
+    /*! The tokens are counted by their size, without the memory they
+     * own (e.g., the elements of a vector token).
+     */
+    virtual size_t buffer_bytes() const = 0;
 };
+#endif
 
-//! The in_port port is used for input ports of ForSyDe processes
-template <typename T, typename TokenType, typename ChanType>
-class in_port: public sc_fifo_in<TokenType>
-#ifdef FORSYDE_INTROSPECTION
-            , public ForSyDe::introspective_port
+#ifdef FORSYDE_PARALLEL_SIM
+//! The interface of the channels which can be split between MPI ranks
+/*! It is used to connect a process to its peer process on another rank
+ * without binding any extra ports to the channel. The forwarding
+ * functions never return and should be run in their own SystemC thread.
+ */
+class remote_channel
+{
+public:
+    //! Sends the tokens written to the channel to another rank
+    virtual void forward_to(int destination, int tag, unsigned batch, unsigned depth) = 0;
+    
+    //! Writes the tokens received from another rank to the channel
+    virtual void forward_from(int source, int tag, unsigned batch, unsigned depth) = 0;
+    
+    //! Flushes the outstanding tokens at the end of the simulation
+    virtual void finish_forwarding() = 0;
+};
 #endif
+
+#ifdef FORSYDE_ABSENT_RLE
+//! The interface of the channels which carry runs of absent tokens
+/*! A run of absent tokens is written as a single record and is expanded
+ * in the channel when it is read, so that the readers which only need
+ * the present tokens can skip the rest of the run at once.
+ */
+class absent_run_channel
 {
 public:
-    in_port() : sc_fifo_in<TokenType>(){}
-    in_port(const char* name) : sc_fifo_in<TokenType>(name){}
+    //! Consumes up to max absent tokens from the run being read, if any
+    virtual size_t skip_absent_run(size_t max) = 0;
+    
+    //! The number of absent tokens left in the run being read
+    virtual size_t absent_run_left() const = 0;
+};
+#endif
+
+#ifdef FORSYDE_SIGNAL_TRACE
+//! The interface of the observers of the tokens written to a signal
+/*! It is used by the trace recorder to record the tokens of a signal
+ * without connecting any process to it.
+ */
+template <typename TokenType>
+class signal_observer
+{
+public:
+    //! Called for each token written to the observed signal
+    virtual void observe(const TokenType& tok) = 0;
+};
+#endif
+
+#ifdef FORSYDE_CHECKPOINT
+//! The interface of the channels whose contents can be checkpointed
+/*! The contents are saved while the simulation is paused (i.e., between
+ * two calls to sc_start) and restored before the simulation of a new
+ * instance of the same model starts.
+ */
+class checkpoint_channel
+{
+public:
+    //! Appends the tokens in the channel to a buffer, keeping them in the channel
+    virtual void save_contents(std::vector<char>& buf) = 0;
+    
+    //! Writes the tokens saved by save_contents() to the channel
+    virtual void restore_contents(const char*& pos) = 0;
+    
+    //! Replaces the tokens of a static buffer with the ones saved by save_contents()
+    /*! Unlike restore_contents(), the tokens are written immediately. It
+     * is used by the executors which roll their channels back during the
+     * simulation.
+     */
+    virtual void reload_contents(const char*& pos) = 0;
+};
+#endif
+
+#ifdef FORSYDE_RESET
+//! A helper class used to empty the channels when the model is reset
+class reset_channel
+{
+public:
+    //! Discards the tokens in the channel
+    virtual void clear_contents() = 0;
+};
+#endif
+
+#ifdef FORSYDE_FANOUT_BYPASS
+//! The untyped interface of the channels which can pass their tokens on
+/*! It is used by the passes which do not know the token types of the
+ * channels (e.g., the elaboration optimizer).
+ */
+class forwarding_link
+{
+public:
+    //! Writes the tokens written from now on to the given channels instead
+    /*! It fails if the channels do not have the same token type.
+     */
+    virtual bool forward_to(const std::vector<sc_interface*>& dests) = 0;
+};
+
+//! The interface of the channels which can pass their tokens on when written
+/*! It is used to bypass the fanout processes, whose input channel then
+ * writes the tokens directly to the output channels of the fanout.
+ */
+template <typename TokenType>
+class forwarding_channel : public forwarding_link
+{
+public:
+    //! Writes the tokens written from now on to the given channels instead
+    /*! It fails if the channel is not empty or is a static buffer.
+     */
+    virtual bool forward_writes(const std::vector<sc_fifo_out_if<TokenType>*>& dests) = 0;
+
+    bool forward_to(const std::vector<sc_interface*>& dests)
+    {
+        std::vector<sc_fifo_out_if<TokenType>*> outs;
+        for (auto d : dests)
+        {
+            auto o = dynamic_cast<sc_fifo_out_if<TokenType>*>(d);
+            if (o == NULL) return false;
+            outs.push_back(o);
+        }
+        return forward_writes(outs);
+    }
+};
+#endif
+
+//! The interface of the processes which produce the same tokens in every cycle
+/*! It is implemented by the constant process constructors, so that the
+ * analyses can find them without knowing their token types.
+ */
+class constant_source
+{
+public:
+    //! Checks if the process produces its tokens forever
+    virtual bool is_endless() const = 0;
+};
+
+//! A helper class used by executors to find the channels bound to the ports
+class channel_port
+{
+public:
+    //! Returns all the channels bound to the port
+    virtual std::vector<sc_interface*> bound_channels() = 0;
+};
+
+//! The channel used as the base of the ForSyDe signals by default
+/*! Defining FORSYDE_SPSC_SIGNALS switches all signals to the ring
+ * buffer based spsc_fifo channel.
+ */
+#ifdef FORSYDE_SPSC_SIGNALS
+template <typename TokenType>
+using default_fifo = spsc_fifo<TokenType>;
+#else
+template <typename TokenType>
+using default_fifo = sc_fifo<TokenType>;
+#endif
+
+//! A ForSyDe signal is used to inter-connect processes
+/*! The underlying channel is selected by FifoType, which should
+ * implement the sc_fifo interfaces (e.g., sc_fifo or spsc_fifo).
+ */
+template <typename T, typename TokenType,
+          template <class> class FifoType = default_fifo>
+class signal: public FifoType<TokenType>, public ForSyDe::static_channel,
+              public ForSyDe::prefetch_channel, public ForSyDe::resizable_channel
+#ifdef FORSYDE_ADAPTIVE_FIFO
+            , public ForSyDe::adaptive_channel
+#endif
+#ifdef FORSYDE_ABSENT_RLE
+            , public ForSyDe::absent_run_channel
+#endif
+#ifdef FORSYDE_PARALLEL_SIM
+            , public ForSyDe::remote_channel
+#endif
+#ifdef FORSYDE_CHECKPOINT
+            , public ForSyDe::checkpoint_channel
+            , public ForSyDe::pending_channel<TokenType>
+#endif
+#ifdef FORSYDE_RESET
+            , public ForSyDe::reset_channel
+#endif
+#ifdef FORSYDE_FANOUT_BYPASS
+            , public ForSyDe::forwarding_channel<TokenType>
+#endif
 #ifdef FORSYDE_INTROSPECTION
-    typedef T type;
+            , public ForSyDe::introspective_channel
+#endif
+#ifdef FORSYDE_SIGNAL_STATS
+            , public ForSyDe::stats_channel
+#endif
+#ifdef FORSYDE_MEMORY_REPORT
+            , public ForSyDe::footprint_channel
+#endif
+{
+public:
+    signal() : FifoType<TokenType>() {}
+    signal(sc_module_name name, unsigned size) : FifoType<TokenType>(name, size) {}
+    
+    //! Switches the channel to a plain ring buffer of the given capacity
+    /*! It should be called only when both ends of the channel are
+     * executed by the same executor, since reads and writes on the ring
+     * buffer never block. The tokens which are already in the channel
+     * are moved to the ring buffer, which is enlarged if needed.
+     */
+    void set_static_buffer(size_t capacity)
+    {
+        std::vector<TokenType> toks;
+        TokenType tok;
+        while (FifoType<TokenType>::nb_read(tok)) toks.push_back(tok);
+#ifdef FORSYDE_CHECKPOINT
+        // including the restored tokens which are not written yet
+        toks.insert(toks.end(), restored.begin()+restored_next, restored.end());
+        std::vector<TokenType>().swap(restored);
+        restored_next = 0;
+#endif
+        sbuf.resize(std::max(capacity, toks.size()));
+        std::copy(toks.begin(), toks.end(), sbuf.begin());
+        shead = 0;
+        stail = toks.size();
+    }
+    
+    //! Checks if the channel is using a plain ring buffer
+    bool is_static_buffer() const {return !sbuf.empty();}
+    
+    //! Switches the channel to a ring buffer placed in a shared arena
+    /*! The channel should be empty, which is the case before the
+     * processes write their initial tokens.
+     */
+    void set_shared_buffer(std::shared_ptr<void> arena, size_t offset, size_t capacity)
+    {
+        if (FifoType<TokenType>::num_available() > 0)
+            SC_REPORT_ERROR(this->name(), "only an empty channel can share its buffer");
+        sbuf.share(std::static_pointer_cast<TokenType>(arena), offset, capacity);
+        shead = 0;
+        stail = 0;
+    }
+    
+    //! Allocates an arena of tokens of the type carried by the channel
+    std::shared_ptr<void> make_arena(size_t slots) const
+    {
+        return std::shared_ptr<TokenType>(new TokenType[slots],
+                                          std::default_delete<TokenType[]>());
+    }
+    
+    //! The type of the tokens carried by the channel
+    const std::type_info& token_type() const {return typeid(TokenType);}
+    
+    //! Changes the capacity of the channel before the simulation starts
+    /*! The channel should be empty, which is the case before the
+     * processes write their initial tokens. The FIFOs with a resizing
+     * interface (e.g., spsc_fifo) are resized through it. sc_fifo has
+     * none, hence its buffer is replaced through its protected members,
+     * only in the SystemC versions where their layout is known (see
+     * FORSYDE_SC_FIFO_INTERNALS): the buffer and its indices are
+     * reallocated, while the bound ports and the counters of the delta
+     * cycle, which are all zero before the simulation, are kept. With
+     * other versions, the signals should be given their sizes when they
+     * are constructed, or use a resizable FifoType.
+     */
+    void set_capacity(size_t capacity)
+    {
+        if (FifoType<TokenType>::num_available() > 0)
+            SC_REPORT_ERROR(this->name(), "only an empty channel can be resized");
+        if (sc_is_running())
+            SC_REPORT_ERROR(this->name(), "the channel can only be resized before the simulation starts");
+        if constexpr (has_set_capacity<FifoType<TokenType>>::value)
+            FifoType<TokenType>::set_capacity(std::max<size_t>(capacity, 1));
+        else if constexpr (std::is_same<FifoType<TokenType>,sc_fifo<TokenType>>::value &&
+                           FORSYDE_SC_FIFO_INTERNALS)
+        {
+            delete [] this->m_buf;
+            this->buf_init(std::max<size_t>(capacity, 1));
+        }
+        else
+            SC_REPORT_ERROR(this->name(), "the FIFO of the channel can not be resized in this SystemC version, use a resizable FifoType (e.g., FORSYDE_SPSC_SIGNALS)");
+    }
+
+    //! Returns the k-th token of the static buffer without reading it
+    const TokenType& peek(size_t k) const
+    {
+        if (k >= scount())
+            SC_REPORT_ERROR(this->name(),"peeking beyond the tokens of the static buffer");
+        return sbuf[(shead+k) % sbuf.size()];
+    }
+
+    TokenType read()
+    {
+#ifdef FORSYDE_ABSENT_RLE
+        if constexpr (is_abst_ext<TokenType>::value)
+        {
+            TokenType tmp;
+            read(tmp);
+            return tmp;
+        }
+#endif
+#ifndef FORSYDE_SIGNAL_STATS
+        if (sbuf.empty()) return FifoType<TokenType>::read();
+#endif
+        TokenType tmp;
+        read(tmp);
+        return tmp;
+    }
+    
+    void read(TokenType& val)
+    {
+        if (take_run(val)) return;
+        if (sbuf.empty())
+        {
+            note_read_block(FifoType<TokenType>::num_available() == 0);
+            FifoType<TokenType>::read(val);
+        }
+        else
+        {
+            if (scount()==0)
+                SC_REPORT_ERROR(this->name(),"reading from an empty static buffer");
+            const size_t h = shead.load(std::memory_order_relaxed);
+            val = sbuf[h % sbuf.size()];
+            shead.store(h+1, std::memory_order_release);
+        }
+        note_occupancy(-1);
+        start_run(val);
+    }
+    
+    bool nb_read(TokenType& val)
+    {
+        if (take_run(val)) return true;
+        if (sbuf.empty())
+        {
+            if (!FifoType<TokenType>::nb_read(val)) return false;
+            note_occupancy(-1);
+            start_run(val);
+            return true;
+        }
+        if (scount()==0) return false;
+        read(val);
+        return true;
+    }
+    
+    int num_available() const
+    {
+        if (sbuf.empty()) return FifoType<TokenType>::num_available() + run_left;
+        return scount() + run_left;
+    }
+    
+    //! Blocks until n tokens are available or the channel is full
+    /*! The writer can not proceed when the channel is full, hence the
+     * reader should then take the available tokens first. With a static
+     * buffer the tokens should already be there.
+     */
+    void wait_tokens(size_t n)
+    {
+        if (!sbuf.empty())
+        {
+            if (scount() + run_left < n)
+                SC_REPORT_ERROR(this->name(),"reading from an empty static buffer");
+            return;
+        }
+        note_read_block((size_t)num_available() < n && FifoType<TokenType>::num_free() > 0);
+        while ((size_t)num_available() < n && FifoType<TokenType>::num_free() > 0)
+            if constexpr (std::is_same<FifoType<TokenType>,spsc_fifo<TokenType>>::value)
+                FifoType<TokenType>::wait_data_written();
+            else
+                sc_core::wait(FifoType<TokenType>::data_written_event());
+    }
+    
+#ifdef FORSYDE_ABSENT_RLE
+    //! Consumes up to max absent tokens from the run being read, if any
+    size_t skip_absent_run(size_t max)
+    {
+        const size_t k = run_left < max ? run_left : max;
+        run_left -= k;
+        return k;
+    }
+    
+    //! The number of absent tokens left in the run being read
+    size_t absent_run_left() const {return run_left;}
+#endif
+    
+    void write(const TokenType& val)
+    {
+#ifdef FORSYDE_SIGNAL_TRACE
+        if (observer) observer->observe(val);
+#endif
+#ifdef FORSYDE_FANOUT_BYPASS
+        if (!fwd.empty())
+        {
+            for (auto d : fwd) d->write(val);
+            return;
+        }
+#endif
+        if (sbuf.empty())
+        {
+#ifdef FORSYDE_ADAPTIVE_FIFO
+            if (adapt.window > 0) adapt_capacity();
+#endif
+#ifdef FORSYDE_CHECKPOINT
+            note_write_block(FifoType<TokenType>::num_free() == 0 || !restored.empty());
+#else
+            note_write_block(FifoType<TokenType>::num_free() == 0);
+#endif
+#ifdef FORSYDE_CHECKPOINT
+            // the restored tokens precede the new ones
+            while (!restored.empty()) sc_core::wait(restored_written);
+            // the token belongs to the channel while the writer is blocked
+            if (pending != &val)
+            {
+                pending = &val;
+                pending_n = 1;
+            }
+            FifoType<TokenType>::write(val);
+            pending = NULL;
+            pending_n = 0;
+#else
+            FifoType<TokenType>::write(val);
+#endif
+        }
+        else
+        {
+            if (scount()==sbuf.size())
+                SC_REPORT_ERROR(this->name(),"writing to a full static buffer");
+            const size_t t = stail.load(std::memory_order_relaxed);
+            sbuf[t % sbuf.size()] = val;
+            stail.store(t+1, std::memory_order_release);
+        }
+        note_occupancy(+1);
+    }
+    
+    bool nb_write(const TokenType& val)
+    {
+#ifdef FORSYDE_FANOUT_BYPASS
+        if (!fwd.empty())
+        {
+            if (num_free() == 0) return false;
+            write(val);
+            return true;
+        }
+#endif
+        if (sbuf.empty())
+        {
+#ifdef FORSYDE_CHECKPOINT
+            if (!restored.empty()) return false;
+#endif
+            if (!FifoType<TokenType>::nb_write(val)) return false;
+            note_occupancy(+1);
+#ifdef FORSYDE_SIGNAL_TRACE
+            if (observer) observer->observe(val);
+#endif
+            return true;
+        }
+        if (scount()==sbuf.size()) return false;
+        write(val);
+        return true;
+    }
+    
+#ifdef FORSYDE_SIGNAL_TRACE
+    //! Sets the observer of the tokens written to the signal
+    /*! Setting it to NULL detaches the observer.
+     */
+    void set_observer(signal_observer<TokenType>* obs) {observer = obs;}
+#endif
+    
+#ifdef FORSYDE_ADAPTIVE_FIFO
+    //! Lets the FIFO grow when its writer blocks often and shrink when it stays empty
+    /*! The capacity is changed by the writer, before a write, hence it
+     * should be used with the blocking writes of a single writer. The
+     * current capacity is first brought within the bounds of the policy,
+     * as long as the tokens in the FIFO fit. The channels switched to a
+     * static buffer are not adapted. The FifoType of the signal should be
+     * resizable during the simulation (e.g., spsc_fifo), since sc_fifo can
+     * not change its capacity while processes are blocked on it.
+     */
+    void set_adaptive(const fifo_policy& policy)
+    {
+        if constexpr (!has_set_capacity<FifoType<TokenType>>::value)
+            SC_REPORT_ERROR(this->name(), "adaptive FIFOs require a resizable FifoType (e.g., FORSYDE_SPSC_SIGNALS)");
+        if (policy.window == 0 || policy.min_capacity == 0 ||
+            policy.max_capacity < policy.min_capacity)
+            SC_REPORT_ERROR(this->name(), "invalid adaptive FIFO policy");
+        adapt = policy;
+        adapt_writes = adapt_blocked = 0;
+        adapt_peak = 0;
+        const size_t cap = adaptive_capacity();
+        if (cap < adapt.min_capacity) resize_fifo(adapt.min_capacity);
+        else if (cap > adapt.max_capacity) resize_fifo(adapt.max_capacity);
+    }
+    
+    //! The current capacity of the FIFO
+    size_t adaptive_capacity() const
+    {
+        return FifoType<TokenType>::num_available() + FifoType<TokenType>::num_free();
+    }
+    
+    //! The number of times the capacity has grown and shrunk
+    unsigned long long adaptive_resizes() const {return adapt_resizes;}
+#endif
+    
+#ifdef FORSYDE_SIGNAL_STATS
+    //! Returns the occupancy statistics collected up to the current time
+    signal_stats stats() const
+    {
+        signal_stats res = st;
+        const double span = sc_time_stamp().value();
+        const double deltas = sc_delta_count();
+        const double area_time = st_area_time + st_occ * (span - st_last_time);
+        const double area_deltas = st_area_deltas + st_occ * (deltas - st_last_delta);
+        if (span > 0)
+            res.mean_occupancy = area_time / span;
+        else if (deltas > 0)
+            res.mean_occupancy = area_deltas / deltas;
+        res.capacity = sbuf.empty() ? FifoType<TokenType>::num_available() +
+                                      FifoType<TokenType>::num_free()
+                                    : sbuf.size();
+        return res;
+    }
+    
+#ifdef FORSYDE_METRICS
+    //! The current occupancy, which can be read by other threads
+    size_t live_occupancy() const {return st_fill.load(std::memory_order_relaxed);}
+#endif
+#endif
+    
+#ifdef FORSYDE_MEMORY_REPORT
+    //! The size of the channel object in bytes
+    size_t object_bytes() const {return sizeof(*this);}
+    
+    //! The bytes allocated for the buffer of the channel
+    size_t buffer_bytes() const
+    {
+        // the slots shared with other channels are not counted
+        size_t slots = sbuf.capacity();
+        // the FIFO keeps its buffer when it is switched to a static one
+        slots += FifoType<TokenType>::num_available() + FifoType<TokenType>::num_free();
+#ifdef FORSYDE_CHECKPOINT
+        slots += restored.capacity();
+#endif
+        return slots * sizeof(TokenType);
+    }
+#endif
+    
+    int num_free() const
+    {
+#ifdef FORSYDE_FANOUT_BYPASS
+        if (!fwd.empty()) return fullest()->num_free();
+#endif
+        if (sbuf.empty()) return FifoType<TokenType>::num_free();
+        return sbuf.size() - scount();
+    }
+    
+    //! The event notified when tokens are written
+    /*! spsc_fifo only notifies its events for the blocked accesses of its
+     * own, hence the notification is requested here for the callers which
+     * wait for the event (e.g., with next_trigger or in an event list).
+     * The event should be waited for right after it is taken.
+     */
+    const sc_event& data_written_event() const
+    {
+        if constexpr (std::is_same<FifoType<TokenType>,spsc_fifo<TokenType>>::value)
+            const_cast<signal*>(this)->FifoType<TokenType>::arm_data_written();
+        return FifoType<TokenType>::data_written_event();
+    }
+    
+    //! The event notified when tokens are read
+    /*! The notification of spsc_fifo is requested as for data_written_event().
+     */
+    const sc_event& data_read_event() const
+    {
+#ifdef FORSYDE_FANOUT_BYPASS
+        // the writer waits for the fullest of the channels it writes to
+        if (!fwd.empty()) return fullest()->data_read_event();
+#endif
+        if constexpr (std::is_same<FifoType<TokenType>,spsc_fifo<TokenType>>::value)
+            const_cast<signal*>(this)->FifoType<TokenType>::arm_data_read();
+        return FifoType<TokenType>::data_read_event();
+    }
+    
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Writes the tokens written from now on to the given channels instead
+    bool forward_writes(const std::vector<sc_fifo_out_if<TokenType>*>& dests)
+    {
+        if (dests.empty() || !sbuf.empty() || num_available() > 0) return false;
+#ifdef FORSYDE_CHECKPOINT
+        if (!restored.empty()) return false;
+#endif
+        fwd = dests;
+        return true;
+    }
+#endif
+    
+#ifdef FORSYDE_CHECKPOINT
+    //! Appends the tokens in the channel to a buffer
+    /*! The tokens are taken out of the channel and written back, hence
+     * it should only be called while the simulation is paused. The
+     * tokens which the writer is blocked writing are saved after them.
+     */
+    void save_contents(std::vector<char>& buf)
+    {
+        std::vector<TokenType> toks;
+        if (sbuf.empty())
+        {
+            TokenType tok;
+            while (FifoType<TokenType>::nb_read(tok)) toks.push_back(tok);
+            for (auto& t : toks) FifoType<TokenType>::nb_write(t);
+            toks.insert(toks.end(), restored.begin()+restored_next, restored.end());
+            toks.insert(toks.end(), pending, pending+pending_n);
+        }
+        else
+            for (size_t i=0; i<scount(); i++) toks.push_back(sbuf[(shead+i) % sbuf.size()]);
+        serializer<std::uint64_t>::write(buf, run_left);
+        serializer<std::uint64_t>::write(buf, toks.size());
+        if (toks.empty()) return;
+        if constexpr (is_serializable<TokenType>::value)
+            for (auto& t : toks) serializer<TokenType>::write(buf, t);
+        else
+            SC_REPORT_ERROR(this->name(), "the token type of the signal is not serializable");
+    }
+    
+    //! Restores the saved tokens
+    /*! Since they may not fit in the channel, they are written by a
+     * separate thread when the simulation starts, and the writer of the
+     * signal waits for them.
+     */
+    void restore_contents(const char*& pos)
+    {
+        std::uint64_t run, n;
+        serializer<std::uint64_t>::read(pos, run);
+        serializer<std::uint64_t>::read(pos, n);
+        run_left = run;
+        if (n == 0) return;
+        if constexpr (is_serializable<TokenType>::value)
+        {
+            restored.resize(n);
+            for (auto& t : restored) serializer<TokenType>::read(pos, t);
+            restored_next = 0;
+            sc_spawn([this]
+                {
+                    for (; restored_next<restored.size(); restored_next++)
+                    {
+                        FifoType<TokenType>::write(restored[restored_next]);
+                        note_occupancy(+1);
+                    }
+                    std::vector<TokenType>().swap(restored);
+                    restored_next = 0;
+                    restored_written.notify();
+                });
+        }
+        else
+            SC_REPORT_ERROR(this->name(), "the token type of the signal is not serializable");
+    }
+    
+    //! Replaces the tokens of the static buffer with the saved ones
+    void reload_contents(const char*& pos)
+    {
+        std::uint64_t run, n;
+        serializer<std::uint64_t>::read(pos, run);
+        serializer<std::uint64_t>::read(pos, n);
+        if (sbuf.empty() || n > sbuf.size())
+            SC_REPORT_ERROR(this->name(), "only a static buffer which can hold the saved tokens can be reloaded");
+        run_left = run;
+        if constexpr (is_serializable<TokenType>::value)
+            for (size_t i=0; i<n; i++) serializer<TokenType>::read(pos, sbuf[i]);
+        else
+            SC_REPORT_ERROR(this->name(), "the token type of the signal is not serializable");
+        shead = 0;
+        stail = n;
+    }
+    
+    void set_pending(const TokenType* first, size_t n)
+    {
+#ifdef FORSYDE_FANOUT_BYPASS
+        // the tokens are kept by the channels they are forwarded to
+        if (!fwd.empty())
+        {
+            for (auto d : fwd)
+                if (auto pc = dynamic_cast<pending_channel<TokenType>*>(d))
+                    pc->set_pending(first, n);
+            return;
+        }
+#endif
+        pending = first;
+        pending_n = n;
+    }
+#endif
+
+#ifdef FORSYDE_RESET
+    //! Discards the tokens in the channel
+    /*! It should only be called while the simulation is paused, before
+     * the processes are reset. The statistics of the signal are kept.
+     */
+    void clear_contents()
+    {
+        TokenType tok;
+        while (FifoType<TokenType>::nb_read(tok)) note_occupancy(-1);
+        shead = stail = 0;
+        run_left = 0;
+#ifdef FORSYDE_CHECKPOINT
+        std::vector<TokenType>().swap(restored);
+        restored_next = 0;
+        pending = NULL;
+        pending_n = 0;
+#endif
+    }
+#endif
+    
+#ifdef FORSYDE_PARALLEL_SIM
+    void forward_to(int destination, int tag, unsigned batch, unsigned depth)
+    {
+        if constexpr (is_serializable<TokenType>::value)
+        {
+            fwd_sender.reset(new mpi_batch_sender<TokenType>(destination, tag, batch, depth));
+            while (1) fwd_sender->push(read());
+        }
+        else
+            SC_REPORT_ERROR(this->name(), "the token type of the signal is not serializable");
+    }
+    
+    void forward_from(int source, int tag, unsigned batch, unsigned depth)
+    {
+        if constexpr (is_serializable<TokenType>::value)
+        {
+            fwd_receiver.reset(new mpi_batch_receiver<TokenType>(source, tag, batch, depth));
+            fwd_receiver->start();
+            TokenType tok;
+            while (1)
+            {
+                fwd_receiver->pop(tok);
+                write(tok);
+            }
+        }
+        else
+            SC_REPORT_ERROR(this->name(), "the token type of the signal is not serializable");
+    }
+    
+    void finish_forwarding()
+    {
+        if (fwd_sender) fwd_sender->finish();
+        if (fwd_receiver) fwd_receiver->finish();
+    }
+#endif
+    
+protected:
+    //! Checks if the tokens are kept by the FIFO itself
+    /*! It is not the case when the channel uses a static buffer, forwards
+     * its tokens, or has restored tokens which are not written yet. The
+     * derived channels can then access the FIFO directly.
+     */
+    bool fifo_direct() const
+    {
+        if (!sbuf.empty()) return false;
+#ifdef FORSYDE_FANOUT_BYPASS
+        if (!fwd.empty()) return false;
+#endif
+#ifdef FORSYDE_CHECKPOINT
+        if (!restored.empty()) return false;
+#endif
+        return true;
+    }
+    
+    //! Records a token written directly to the FIFO
+    void note_written(const TokenType& val)
+    {
+#ifdef FORSYDE_SIGNAL_TRACE
+        if (observer) observer->observe(val);
+#endif
+        note_occupancy(+1);
+    }
+    
+    //! Records a token read directly from the FIFO
+    void note_taken() {note_occupancy(-1);}
+    
+private:
+    // The plain ring buffer used when the channel is statically scheduled,
+    // with free-running indices as in spsc_fifo, so that its reader and
+    // writer may run on different OS threads (see SDF::hsdf_executor)
+    static_slots<TokenType> sbuf;
+    std::atomic<size_t> shead{0}, stail{0};
+    
+    //! The number of tokens in the static buffer
+    size_t scount() const
+    {
+        return stail.load(std::memory_order_acquire) -
+               shead.load(std::memory_order_acquire);
+    }
+    // The absent tokens left from the run being read
+    size_t run_left = 0;
+#ifdef FORSYDE_SIGNAL_TRACE
+    // The observer of the written tokens, if any
+    signal_observer<TokenType>* observer = NULL;
+#endif
+#ifdef FORSYDE_FANOUT_BYPASS
+    // The channels the written tokens are forwarded to, if any
+    std::vector<sc_fifo_out_if<TokenType>*> fwd;
+    
+    //! The forwarded channel with the least free space
+    sc_fifo_out_if<TokenType>* fullest() const
+    {
+        auto res = fwd[0];
+        for (auto d : fwd)
+            if (d->num_free() < res->num_free()) res = d;
+        return res;
+    }
+#endif
+#ifdef FORSYDE_SIGNAL_STATS
+    // The statistics, the current occupancy and its integrals over the
+    // simulated time and the delta cycles up to the last change
+    signal_stats st;
+    size_t st_occ = 0;
+    double st_area_time = 0, st_area_deltas = 0;
+    std::uint64_t st_last_time = 0;
+    unsigned long long st_last_delta = 0;
+#ifdef FORSYDE_METRICS
+    // The occupancy published to the metrics exporter
+    std::atomic<size_t> st_fill{0};
+#endif
+#endif
+#ifdef FORSYDE_CHECKPOINT
+    // The tokens being written, while the writer may be blocked
+    const TokenType* pending = NULL;
+    size_t pending_n = 0;
+    // The restored tokens, which are written when the simulation starts
+    std::vector<TokenType> restored;
+    size_t restored_next = 0;
+    sc_event restored_written;
+#endif
+    
+    //! Takes an absent token from the run being read
+    bool take_run(TokenType& val)
+    {
+#ifdef FORSYDE_ABSENT_RLE
+        if constexpr (is_abst_ext<TokenType>::value)
+            if (run_left > 0)
+            {
+                run_left--;
+                val.set_abst();
+                return true;
+            }
+#endif
+        return false;
+    }
+    
+    //! Starts expanding a token if it is a run of absent tokens
+    void start_run(TokenType& val)
+    {
+#ifdef FORSYDE_ABSENT_RLE
+        if constexpr (is_abst_ext<TokenType>::value)
+            if (val.run_length() > 1)
+            {
+                run_left = val.run_length() - 1;
+                val.set_abst();
+            }
+#endif
+    }
+    
+    //! Records a change of the occupancy by a written (+1) or read (-1) record
+    void note_occupancy(int d)
+    {
+#ifdef FORSYDE_SIGNAL_STATS
+        const std::uint64_t now = sc_time_stamp().value();
+        const unsigned long long delta = sc_delta_count();
+        st_area_time += double(st_occ) * (now - st_last_time);
+        st_area_deltas += double(st_occ) * (delta - st_last_delta);
+        st_last_time = now;
+        st_last_delta = delta;
+        if (d > 0)
+        {
+            st.tokens++;
+            if (++st_occ > st.high_water) st.high_water = st_occ;
+        }
+        else if (st_occ > 0)
+            st_occ--;
+#ifdef FORSYDE_METRICS
+        st_fill.store(st_occ, std::memory_order_relaxed);
+#endif
+#endif
+    }
+    
+    //! Counts a read which blocks because the channel is empty
+    void note_read_block(bool blocked)
+    {
+#ifdef FORSYDE_SIGNAL_STATS
+        if (blocked) st.blocked_reads++;
+#endif
+    }
+    
+#ifdef FORSYDE_ADAPTIVE_FIFO
+    // The policy of the adaptive capacity, disabled with an empty window,
+    // and the writes, the blocked ones and the peak occupancy of the
+    // current window
+    fifo_policy adapt{1, 1, 0};
+    unsigned adapt_writes = 0, adapt_blocked = 0;
+    size_t adapt_peak = 0;
+    unsigned long long adapt_resizes = 0;
+    
+    //! Grows or shrinks the FIFO before a write, as the policy requires
+    void adapt_capacity()
+    {
+        const size_t cap = adaptive_capacity();
+        const size_t occ = FifoType<TokenType>::num_available();
+        adapt_writes++;
+        if (FifoType<TokenType>::num_free() == 0 && ++adapt_blocked >
+            adapt.grow_blocking * adapt.window && cap < adapt.max_capacity)
+        {
+            // growing now saves the context switch of this write
+            resize_fifo(std::min(2 * cap, adapt.max_capacity));
+            adapt_writes = adapt_blocked = 0;
+            adapt_peak = 0;
+            return;
+        }
+        adapt_peak = std::max(adapt_peak, occ + 1);
+        if (adapt_writes < adapt.window) return;
+        if (adapt_blocked == 0 && cap > adapt.min_capacity &&
+            adapt_peak <= adapt.shrink_occupancy * cap)
+            resize_fifo(std::max({cap / 2, adapt.min_capacity, occ + 1}));
+        adapt_writes = adapt_blocked = 0;
+        adapt_peak = 0;
+    }
+    
+    //! Changes the capacity of the FIFO during the simulation, keeping its tokens
+    void resize_fifo(size_t capacity)
+    {
+        if constexpr (has_set_capacity<FifoType<TokenType>>::value)
+        {
+            if (capacity == adaptive_capacity()) return;
+            FifoType<TokenType>::set_capacity(capacity);
+            adapt_resizes++;
+        }
+    }
+#endif
+    
+    //! Counts a write which blocks because the channel is full
+    void note_write_block(bool blocked)
+    {
+#ifdef FORSYDE_SIGNAL_STATS
+        if (blocked) st.blocked_writes++;
+#endif
+    }
+#ifdef FORSYDE_PARALLEL_SIM
+    // The transport used when the channel is split between two ranks
+    std::unique_ptr<mpi_batch_sender<TokenType>> fwd_sender;
+    std::unique_ptr<mpi_batch_receiver<TokenType>> fwd_receiver;
+#endif
+public:
+#ifdef FORSYDE_INTROSPECTION
+    typedef T type;
+    
+    // TODO: remove if proved not to be needed
+    //~ //! Returns only the size of the token type
+    //~ virtual unsigned token_size() const
+    //~ {
+        //~ return sizeof(T);
+    //~ }
+    
+    // TODO: remove if proved not to be needed
+    //! Returns the name of the token type
+    virtual const char* token_type() const
+    {
+        return get_type_name<T>();
+    }
+    
+    virtual unsigned token_type_id() const
+    {
+        return get_type_id<T>();
+    }
+    
+    virtual std::string moc() const = 0;
+#endif
+};
+
+#ifdef FORSYDE_INTROSPECTION
+//! The value of a process constructor argument
+/*! It holds either a string, or a formatter which is only called when the
+ * value is first read (e.g., by an exporter), so that recording the
+ * arguments does not cost formatting during the elaboration.
+ */
+class arg_value
+{
+public:
+    arg_value(const std::string& val) : val(val) {}
+    arg_value(const char* val) : val(val) {}
+    template <typename F, typename = typename std::enable_if<
+                  std::is_convertible<decltype(std::declval<F&>()()),std::string>::value>::type>
+    arg_value(F fmt) : fmt(fmt) {}
+
+    //! The value as a string
+    const std::string& str() const
+    {
+        if (fmt)
+        {
+            val = fmt();
+            fmt = nullptr;
+        }
+        return val;
+    }
+
+    const char* c_str() const {return str().c_str();}
+
+    operator const std::string&() const {return str();}
+
+#ifdef FORSYDE_MEMORY_REPORT
+    //! The bytes allocated for the value, if it is already formatted
+    size_t bytes() const {return fmt ? 0 : val.capacity();}
+#endif
+
+private:
+    mutable std::string val;
+    mutable std::function<std::string()> fmt;
+};
+#endif
+
+//! This type is used in the process base class to store structural information
+struct PortInfo
+{
+    sc_object* port;
+    // TODO: remove if proved not to be needed
+    //~ unsigned toks;
+    std::string portType;
+};
+
+#ifdef FORSYDE_INTROSPECTION
+//! The structural information of a process used by the introspection
+/*! It is only read at the end of the elaboration and by the exporters,
+ * hence it is allocated apart from the process, which keeps the process
+ * objects touched in each firing small.
+ */
+struct process_introspection
+{
+    std::vector<PortInfo> in_chans;                         ///< see process::boundInChans
+    std::vector<PortInfo> out_chans;                        ///< see process::boundOutChans
+    std::vector<std::tuple<std::string,arg_value>> args;    ///< see process::arg_vec
+};
+#endif
+
+//! A helper class used to provide introspective ports
+class introspective_port
+{
+public:
+    //! To which port it is bound (used for binding ports of composite processes in the hierarchy)
+    sc_object* bound_port;
+    
+    //! Name of the tokens of the port
+    virtual const char* token_type() const = 0;
+    
+    //! The interned ID of the token type (see get_type_id)
+    virtual unsigned token_type_id() const = 0;
+
+    //! To which MoC does the signal belong
+    virtual std::string moc() const = 0;
+    
+#ifdef FORSYDE_INTROSPECTION
+    //! The interned ID of the MoC, which is looked up only once
+    unsigned moc_id() const
+    {
+        if (moc_idx == UINT_MAX) moc_idx = moc_names().intern(moc());
+        return moc_idx;
+    }
+#endif
+
+private:
+    mutable unsigned moc_idx = UINT_MAX;
+};
+
+//! The in_port port is used for input ports of ForSyDe processes
+template <typename T, typename TokenType, typename ChanType>
+class in_port: public sc_fifo_in<TokenType>, public ForSyDe::channel_port
+#ifdef FORSYDE_INTROSPECTION
+            , public ForSyDe::introspective_port
+#endif
+{
+public:
+    in_port() : sc_fifo_in<TokenType>(){}
+    in_port(const char* name) : sc_fifo_in<TokenType>(name){}
+    
+    //! Reads a token from the bound channel
+    /*! After the elaboration, the channel is called directly, without
+     * the port indirection and, if it is a ChanType, without a virtual
+     * call.
+     */
+    TokenType read()
+    {
+#ifdef FORSYDE_TOKEN_POOL
+        // the token is read into a recycled buffer
+        if constexpr (is_pooled_token<TokenType>::value)
+        {
+            TokenType tmp = token_pool<TokenType>::instance().acquire();
+            read(tmp);
+            return tmp;
+        }
+#endif
+        if (direct) return direct->ChanType::read();
+        return channel()->read();
+    }
+    
+    //! Reads a token from the bound channel
+    void read(TokenType& val)
+    {
+        if (direct)
+            direct->ChanType::read(val);
+        else
+            channel()->read(val);
+    }
+    
+    //! The bound channel
+    sc_fifo_in_if<TokenType>* channel()
+    {
+        return chan ? chan : (*this)[0];
+    }
+    
+    //! Waits for n tokens (e.g., a whole firing) in the bound channel
+    /*! A single blocking wait is used if the channel supports it. The
+     * tokens are not read.
+     */
+    void wait_tokens(size_t n)
+    {
+        if (!prefetch_checked)
+        {
+            prefetch = dynamic_cast<prefetch_channel*>(channel());
+            prefetch_checked = true;
+        }
+        if (prefetch && n>1) prefetch->wait_tokens(n);
+    }
+    
+    //! Reads n tokens (e.g., a whole firing) into a vector
+    /*! It waits for the whole partition once, and then only blocks when
+     * the bound channel runs empty.
+     */
+    void read_n(std::vector<TokenType>& vals, size_t n)
+    {
+        if (vals.size() != n) vals.resize(n);
+        wait_tokens(n);
+        read_range(channel(), vals.begin(), n);
+    }
+    
+    //! Reads n tokens into a buffer
+    void read_n(TokenType* vals, size_t n)
+    {
+        wait_tokens(n);
+        read_range(channel(), vals, n);
+    }
+    
+    //! Reads n absent-extended tokens and appends the present values
+    /*! With FORSYDE_ABSENT_RLE, the runs of absent tokens are skipped at
+     * once.
+     */
+    template <typename V>
+    void read_present(V& vals, size_t n)
+    {
+        auto chan = channel();
+#ifdef FORSYDE_ABSENT_RLE
+        auto runs = dynamic_cast<absent_run_channel*>(chan);
+#endif
+        wait_tokens(n);
+        while (n>0)
+        {
+#ifdef FORSYDE_ABSENT_RLE
+            if (runs)
+            {
+                n -= runs->skip_absent_run(n);
+                if (n==0) break;
+            }
+#endif
+            TokenType tmp = chan->read();
+            n--;
+            if (is_present(tmp)) vals.push_back(unsafe_from_abst_ext(std::move(tmp)));
+        }
+    }
+    
+    //! Reads absent-extended tokens until n present values are appended
+    /*! At most max tokens are read, and the number of the read tokens is
+     * returned.
+     */
+    template <typename V>
+    size_t read_present_until(V& vals, size_t n, size_t max=SIZE_MAX)
+    {
+        auto chan = channel();
+#ifdef FORSYDE_ABSENT_RLE
+        auto runs = dynamic_cast<absent_run_channel*>(chan);
+#endif
+        size_t found = 0, taken = 0;
+        while (found<n && taken<max)
+        {
+#ifdef FORSYDE_ABSENT_RLE
+            if (runs)
+            {
+                taken += runs->skip_absent_run(max-taken);
+                if (taken==max) break;
+            }
+#endif
+            TokenType tmp = chan->read();
+            taken++;
+            if (is_present(tmp))
+            {
+                vals.push_back(unsafe_from_abst_ext(std::move(tmp)));
+                found++;
+            }
+        }
+        return taken;
+    }
+    
+    //! Returns all the channels bound to the port
+    std::vector<sc_interface*> bound_channels()
+    {
+        std::vector<sc_interface*> res;
+        for (int i=0; i<this->size(); i++) res.push_back((*this)[i]);
+        return res;
+    }
+#ifdef FORSYDE_INTROSPECTION
+    typedef T type;
+    
+    // NOTE: The following member functions could be overriden easier if
+    //       bind() was declared virtual in the sc_port base classes.
+    //       This will happen in SystemC 2.3, so adapt these accordingly.
+    //! Record the bounded channels
+    void operator()(sc_fifo_in_if<TokenType>& i)
+    {
+        sc_fifo_in<TokenType>::operator()(i);
+        dynamic_cast<introspective_channel&>(i).iport = this;
+    }
+    
+    //! Record the bounded ports
+    void operator()(in_port<T,TokenType,ChanType>& p)
+    {
+        sc_fifo_in<TokenType>::operator()(p);
+        p.bound_port = this;
+    }
+    
+    //! Returns the plain name of the token type
+    virtual const char* token_type() const
+    {
+        return get_type_name<T>();
+    }
+    
+    virtual unsigned token_type_id() const
+    {
+        return get_type_id<T>();
+    }
+
+    virtual std::string moc() const = 0;
+#endif
+protected:
+    //! Looks up the bound channel once the binding is complete
+    void end_of_elaboration()
+    {
+        sc_fifo_in<TokenType>::end_of_elaboration();
+        if (this->size() == 0) return;
+        chan = (*this)[0];
+        if (typeid(*chan) == typeid(ChanType))
+            direct = dynamic_cast<ChanType*>(chan);
+    }
+    
+private:
+    // The bound channel, if it can wait for a number of tokens
+    prefetch_channel* prefetch = NULL;
+    bool prefetch_checked = false;
+    // The bound channel, and the same if its type is exactly ChanType
+    sc_fifo_in_if<TokenType>* chan = NULL;
+    ChanType* direct = NULL;
+};
+
+//! The UT_out port is used for output ports of UT processes
+template <typename T, typename TokenType, typename ChanType>
+class out_port: public sc_fifo_out<TokenType>, public ForSyDe::channel_port
+#ifdef FORSYDE_INTROSPECTION
+            , public ForSyDe::introspective_port
+#endif
+{
+public:
+    out_port() : sc_fifo_out<TokenType>(){}
+    out_port(const char* name) : sc_fifo_out<TokenType>(name){}
+    
+    //! Writes a token to all the bound channels
+    /*! After the elaboration, the channels are called directly, without
+     * the port indirection and, if they are all ChanTypes, without a
+     * virtual call. It is used by write_multiport.
+     */
+    void write_all(const TokenType& val)
+    {
+        if (!cached)
+            for (int i=0; i<this->size(); i++) (*this)[i]->write(val);
+        else if (!direct.empty())
+            for (auto c : direct) c->ChanType::write(val);
+        else
+            for (auto c : chans) c->write(val);
+    }
+    
+    //! Writes n tokens to all the bound channels
+    /*! It only blocks when a bound channel becomes full.
+     */
+    void write_n(const TokenType* vals, size_t n)
+    {
+        for (int i=0; i<this->size(); i++)
+            write_range((*this)[i], vals, n);
+    }
+    
+    //! Writes a vector of tokens to all the bound channels
+    void write_n(const std::vector<TokenType>& vals)
+    {
+        write_vec_multiport(*this, vals);
+    }
+    
+    //! Returns all the channels bound to the port
+    std::vector<sc_interface*> bound_channels()
+    {
+        std::vector<sc_interface*> res;
+        for (int i=0; i<this->size(); i++) res.push_back((*this)[i]);
+        return res;
+    }
+#ifdef FORSYDE_INTROSPECTION
+    typedef T type;
+    
+    // NOTE: The following member functions could be overriden easier if
+    //       bind() was declared virtual in the sc_port base classes.
+    //       This will happen in SystemC 2.3, so adapt these accordingly.
+    //! Record the bounded channels
+    void operator()(sc_fifo_out_if<TokenType>& i)
+    {
+        sc_fifo_out<TokenType>::operator()(i);
+        // Register the port-to-port binding
+        dynamic_cast<introspective_channel&>(i).oport = this;
+    }
+    
+    //! Record the bounded ports
+    void operator()(out_port<T,TokenType,ChanType>& p)
+    {
+        sc_fifo_out<TokenType>::operator()(p);
+        // Register the port-to-port binding
+        p.bound_port = this;
+    }
+    
+    //! Returns the name of the actual type (not abst_ext version)
+    virtual const char* token_type() const
+    {
+        return get_type_name<T>();
+    }
+    
+    virtual unsigned token_type_id() const
+    {
+        return get_type_id<T>();
+    }
+
+    virtual std::string moc() const = 0;
+#endif
+protected:
+    //! Looks up the bound channels once the binding is complete
+    void end_of_elaboration()
+    {
+        sc_fifo_out<TokenType>::end_of_elaboration();
+        for (int i=0; i<this->size(); i++) chans.push_back((*this)[i]);
+        for (auto c : chans)
+            if (typeid(*c) == typeid(ChanType))
+                direct.push_back(dynamic_cast<ChanType*>(c));
+        if (direct.size() != chans.size()) direct.clear();
+        cached = true;
+    }
+    
+private:
+    // The bound channels, and the same if their types are all exactly ChanType
+    std::vector<sc_fifo_out_if<TokenType>*> chans;
+    std::vector<ChanType*> direct;
+    bool cached = false;
+};
+
+//! The stack size of the threads of the processes in bytes
+/*! Zero keeps the default stack size of the SystemC kernel. It can also
+ * be changed at run time with process::stack_size() before the processes
+ * are constructed.
+ */
+#ifndef FORSYDE_STACK_SIZE
+#define FORSYDE_STACK_SIZE 0
+#endif
+
+#ifdef FORSYDE_COROUTINES
+//! The stackless coroutine which runs the firings of a process
+class process_task
+{
+public:
+    struct promise_type
+    {
+        process_task get_return_object()
+        {
+            return process_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept {return {};}
+        std::suspend_always final_suspend() noexcept {return {};}
+        void return_void() {}
+        void unhandled_exception() {throw;}
+    };
+
+    process_task() {}
+    explicit process_task(std::coroutine_handle<promise_type> h) : h(h) {}
+    process_task(process_task&& other) : h(std::exchange(other.h, nullptr)) {}
+    process_task& operator=(process_task&& other)
+    {
+        if (h) h.destroy();
+        h = std::exchange(other.h, nullptr);
+        return *this;
+    }
+    ~process_task() {if (h) h.destroy();}
+
+    //! The handle used to resume the coroutine
+    std::coroutine_handle<> handle() const {return h;}
+
+private:
+    std::coroutine_handle<promise_type> h;
+};
+
+//! The ready queue of the processes running as coroutines
+/*! A single SC_METHOD resumes the coroutines in the order they become
+ * ready. A coroutine suspends on a channel until it has the tokens to
+ * read or the space to write, and the method is triggered by the events
+ * of the channels the coroutines wait for. Firing a process then costs
+ * resuming a coroutine frame instead of switching a thread stack.
+ */
+class coroutine_scheduler
+{
+public:
+    //! Returns the scheduler
+    static coroutine_scheduler& get()
+    {
+        static coroutine_scheduler sched;
+        return sched;
+    }
+
+    //! Queues a coroutine which starts with the simulation
+    void add(std::coroutine_handle<> h)
+    {
+        ready.push_back(h);
+        if (spawned) return;
+        spawned = true;
+        sc_spawn_options opts;
+        opts.spawn_method();
+        sc_spawn([this]{run();}, "forsyde_coroutines", &opts);
+    }
+
+    //! Suspends a coroutine until a channel has some tokens or free slots
+    struct channel_wait
+    {
+        static_channel* chan;
+        size_t toks;
+        bool space;             ///< waits for free slots instead of tokens
+
+        bool satisfied() const
+        {
+            return (size_t)(space ? chan->num_free() : chan->num_available()) >= toks;
+        }
+        const sc_event& event() const
+        {
+            return space ? chan->data_read_event() : chan->data_written_event();
+        }
+        bool await_ready() const {return satisfied();}
+        void await_suspend(std::coroutine_handle<> h) {get().waiting.push_back({h, this});}
+        void await_resume() const {}
+    };
+
+private:
+    std::deque<std::coroutine_handle<>> ready;
+    std::vector<std::pair<std::coroutine_handle<>,const channel_wait*>> waiting;
+    std::unique_ptr<sc_event_or_list> events;
+    bool spawned = false;
+
+    coroutine_scheduler() {}
+
+    //! Moves the coroutines whose conditions hold to the ready queue
+    bool wake()
+    {
+        size_t k = 0;
+        for (auto& w : waiting)
+            if (w.second->satisfied()) ready.push_back(w.first);
+            else waiting[k++] = w;
+        const bool woken = k < waiting.size();
+        waiting.resize(k);
+        return woken;
+    }
+
+    //! The body of the method, run when a channel being waited for changes
+    void run()
+    {
+        // the channels which update immediately can wake others in the same delta
+        do
+        {
+            while (!ready.empty())
+            {
+                auto h = ready.front();
+                ready.pop_front();
+                h.resume();
+            }
+        } while (wake());
+        if (waiting.empty()) return;
+        events.reset(new sc_event_or_list);
+        for (auto& w : waiting) *events |= w.second->event();
+        next_trigger(*events);
+    }
+};
+#endif
+
+#ifdef FORSYDE_LAZY
+//! The condition which starts the processes of a lazy composite
+/*! The gate opens when the first token arrives at an input port of the
+ * composite, and stays open. The processes of the composite run their
+ * init stage only then (see make_lazy()). A composite without input
+ * ports, or whose inputs are not ForSyDe signals, is open from the
+ * start.
+ */
+class lazy_gate
+{
+public:
+    //! The constructor requires the composite module
+    explicit lazy_gate(sc_module* composite) : composite(composite), open(false), bound(false) {}
+
+    //! Checks if a token has arrived, looking up the input channels at first
+    bool is_open()
+    {
+        if (open) return true;
+        if (!bound) bind();
+        for (auto ch : chans)
+            if (ch->num_available() > 0) open = true;
+        return open;
+    }
+
+    //! Suspends the calling thread until the gate opens
+    void wait_open()
+    {
+        while (!is_open()) sc_core::wait(input_events());
+    }
+
+    //! The events of the input channels, to trigger a method waiting for the gate
+    /*! Taking the events requests their notification from the SPSC
+     * signals (see signal::data_written_event()), hence it should be
+     * called before each wait.
+     */
+    const sc_event_or_list& input_events()
+    {
+        for (auto ch : chans) ch->data_written_event();
+        return *events;
+    }
+
+private:
+    sc_module* composite;
+    std::vector<static_channel*> chans;
+    std::unique_ptr<sc_event_or_list> events;
+    bool open, bound;
+
+    //! Looks up the channels bound to the input ports of the composite
+    void bind()
+    {
+        bound = true;
+        for (auto c : composite->get_child_objects())
+        {
+            if (c->kind() != std::string("sc_fifo_in")) continue;
+            channel_port* port = dynamic_cast<channel_port*>(c);
+            if (port == NULL) continue;
+            for (auto ch : port->bound_channels())
+            {
+                auto sc = dynamic_cast<static_channel*>(ch);
+                if (sc == NULL)
+                {
+                    SC_REPORT_WARNING(composite->name(), "a lazy composite requires ForSyDe signals at its inputs; it starts eagerly");
+                    open = true;
+                    return;
+                }
+                chans.push_back(sc);
+            }
+        }
+        if (chans.empty())
+        {
+            open = true;
+            return;
+        }
+        events.reset(new sc_event_or_list);
+        for (auto ch : chans) *events |= ch->data_written_event();
+    }
+};
+#endif
+
+//! The process constructor which defines the abstract semantics of execution
+/*! This class defines a set of methods and their execution order which
+ * together define the abstract execution semantics of the processes in
+ * ForSyDe-SystemC.
+ * In each MoC, process constructors implement the these methods 
+ * according to its own semantics. 
+ * Additionally, this class contains members which are used to collect
+ * and store information about the structure of the models which is used
+ * for introspection in the elaboration phase.
+ * 
+ * Note that this is an abstract class and can not be directly
+ * instantiated.
+ * The designer uses the process constructors which implement the
+ * abstract methods in a specific MoC.
+ */
+class process : public sc_module
+{
+private:
+    //! 
+    SC_HAS_PROCESS(process);
+
+    //! Set when the process is driven by an external executor
+    bool ext_driven;
+    
+    //! Set once the init stage has run
+    bool initialized;
+    
+    //! Set when the process may run as a method instead of a thread
+    bool method_driven;
+    
+    //! The channels of the firing rule in the method mode and their tokens
+    std::vector<std::pair<static_channel*,size_t>> rule_ins, rule_outs;
+    
+#ifdef FORSYDE_LAZY
+    //! The gate of the lazy composite of the process, if any
+    std::shared_ptr<lazy_gate> gate;
+#endif
+    
+#ifdef FORSYDE_COROUTINES
+    //! Set when the process runs as a coroutine
+    bool coroutine_driven;
+    
+    //! The coroutine of the process in the coroutine mode
+    process_task task;
+    
+    //! The execution coroutine of the module in the coroutine mode
+    /*! Before each firing it suspends until the channels of the firing
+     * rule have the tokens to read and the space to write, so that the
+     * stages never block. The rule is looked up once if it is static, or
+     * before each firing otherwise.
+     */
+    process_task co_worker()
+    {
+        if (ext_driven) co_return;
+        std::vector<firing_port> ins, outs;
+        const bool is_static = firing_rule(ins, outs);
+        begin();
+        if (is_static) bind_firing_rule();
+        while (1)
+        {
+            if (!is_static)
+            {
+                ins.clear(); outs.clear();
+                rule_ins.clear(); rule_outs.clear();
+                dynamic_firing_rule(ins, outs);
+                bind_channels(ins, rule_ins);
+                bind_channels(outs, rule_outs);
+            }
+            for (auto& c : rule_ins)
+                co_await coroutine_scheduler::channel_wait{c.first, c.second, false};
+            for (auto& c : rule_outs)
+                co_await coroutine_scheduler::channel_wait{c.first, c.second, true};
+            fire();
+        }
+    }
+#endif
+    
+    //! The main and only execution thread of the module
+    void worker()
+    {
+        // An external executor (e.g., a static scheduler) runs the stages
+        if (ext_driven) return;
+#ifdef FORSYDE_LAZY
+        if (gate) gate->wait_open();
+#endif
+        //  We run the init stage here and not in the constructor to
+        // force running it after the elaboration phase.
+        begin();
+        while (1) fire();
+    }
+
+    //! Runs the init stage, or the reset stage if the process is reset
+    void begin()
+    {
+#ifdef FORSYDE_RESET
+        handle = sc_get_current_process_handle();
+        if (reset_pending)
+        {
+            reset_pending = false;
+#ifdef FORSYDE_CHECKPOINT
+            restored = false;
+#endif
+            reset();
+            return;
+        }
+#endif
+        initialized = true;
+        start();
+    }
+    
+    //! Creates the thread of the module
+    void create_thread()
+    {
+        SC_THREAD(worker);
+        if (stack_size() > 0) set_stack_size(stack_size());
+#ifdef FORSYDE_MEMORY_REPORT
+        stack_bytes = stack_size() > 0 ? stack_size() : SC_DEFAULT_STACK_SIZE;
+#endif
+    }
+    
+    //! The execution method of the module in the method mode
+    /*! It fires the process as long as the firing rule is satisfied and
+     * then waits for the first channel which blocks the next firing. The
+     * stages never block, since the tokens to read and the space to
+     * write are already there.
+     */
+    void method_worker()
+    {
+        if (ext_driven) return;
+        if (!initialized)
+        {
+#ifdef FORSYDE_LAZY
+            if (gate && !gate->is_open())
+            {
+                next_trigger(gate->input_events());
+                return;
+            }
+#endif
+            bind_firing_rule();
+            begin();
+        }
+#ifdef FORSYDE_RESET
+        else if (reset_pending)
+            begin();
+#endif
+        while (1)
+        {
+            for (auto& c : rule_ins)
+                if ((size_t)c.first->num_available() < c.second)
+                {
+                    next_trigger(c.first->data_written_event());
+                    return;
+                }
+            for (auto& c : rule_outs)
+                if ((size_t)c.first->num_free() < c.second)
+                {
+                    next_trigger(c.first->data_read_event());
+                    return;
+                }
+            fire();
+        }
+    }
+    
+    //! Looks up the channels of the firing rule
+    void bind_firing_rule()
+    {
+        std::vector<firing_port> ins, outs;
+        firing_rule(ins, outs);
+        bind_channels(ins, rule_ins);
+        bind_channels(outs, rule_outs);
+        if (rule_ins.empty() && rule_outs.empty())
+            SC_REPORT_ERROR(name(), "the method mode requires a process with bound ports");
+    }
+    
+    //! Looks up the channels of the ports of a firing rule
+    void bind_channels(std::vector<firing_port>& ports,
+                       std::vector<std::pair<static_channel*,size_t>>& chans)
+    {
+        for (auto& p : ports)
+            for (auto ch : p.channels())
+            {
+                auto sc = dynamic_cast<static_channel*>(ch);
+                if (sc == NULL)
+                    SC_REPORT_ERROR(name(), "the method mode requires ForSyDe signals");
+                chans.push_back({sc, p.toks});
+            }
+    }
+    
+    //! Runs the init stage, or resumes the process from a checkpoint
+    void start()
+    {
+#ifdef FORSYDE_SAMPLING_PROFILE
+        sampling_profiler::get().start();
+#endif
+#ifdef FORSYDE_CHECKPOINT
+        init();
+        if (restored) resume();
+        started = true;
+#else
+        init();
+#endif
+    }
+    
+    //! Runs one evaluation cycle
+    inline void fire()
+    {
+        fire_prep();
+        fire_exec();
+        fire_prod();
+#ifdef FORSYDE_PROFILE
+        prof.firings++;
+#endif
+#ifdef FORSYDE_METRICS
+        live.publish(prof);
+#endif
+    }
+    
+    //! Runs the preparation stage of a cycle
+    inline void fire_prep()
+    {
+#ifdef FORSYDE_TIMELINE
+        timeline_stage span(tl_track, timeline_span::PREP);
+#endif
+#ifdef FORSYDE_SAMPLING_PROFILE
+        sampled_stage smp(smp_id, 0);
+#endif
+#ifdef FORSYDE_ALLOC_TRACKER
+        alloc_stage alc(allocs, alloc_info::PREP);
+#endif
+#ifdef FORSYDE_PROFILE
+        const sc_time t0 = sc_time_stamp();
+        const unsigned long long d0 = sc_delta_count();
+#ifdef FORSYDE_INTROSPECTION
+        mark_empty_inputs();
+#endif
+        prep();     // The preparaion stage
+        const sc_time bt = sc_time_stamp() - t0;
+        const unsigned long long bd = sc_delta_count() - d0;
+        prof.read_blocked_time += bt;
+        prof.read_blocked_deltas += bd;
+#ifdef FORSYDE_INTROSPECTION
+        charge_blocking(prof.in_ports, bt, bd);
+#endif
+#else
+        prep();     // The preparaion stage
+#endif
+    }
+    
+    //! Runs the execution stage of a cycle
+    inline void fire_exec()
+    {
+#ifdef FORSYDE_TIMELINE
+        timeline_stage span(tl_track, timeline_span::EXEC);
+#endif
+#ifdef FORSYDE_SAMPLING_PROFILE
+        sampled_stage smp(smp_id, 1);
+#endif
+#ifdef FORSYDE_ALLOC_TRACKER
+        alloc_stage alc(allocs, alloc_info::EXEC);
+#endif
+#ifdef FORSYDE_PROFILE
+        auto w0 = std::chrono::steady_clock::now();
+#ifdef FORSYDE_PERF_COUNTERS
+        {
+            perf_scope counters(prof.perf, prof.firings);
+            exec();     // The execution stage
+        }
+#else
+        exec();     // The execution stage
+#endif
+        prof.exec_time += std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - w0).count();
+#else
+        exec();     // The execution stage
+#endif
+    }
+    
+    //! Runs the production stage of a cycle
+    inline void fire_prod()
+    {
+#ifdef FORSYDE_TIMELINE
+        timeline_stage span(tl_track, timeline_span::PROD);
+#endif
+#ifdef FORSYDE_SAMPLING_PROFILE
+        sampled_stage smp(smp_id, 2);
+#endif
+#ifdef FORSYDE_ALLOC_TRACKER
+        alloc_stage alc(allocs, alloc_info::PROD);
+#endif
+#ifdef FORSYDE_PROFILE
+        const sc_time t0 = sc_time_stamp();
+        const unsigned long long d0 = sc_delta_count();
+#ifdef FORSYDE_INTROSPECTION
+        mark_full_outputs();
+#endif
+        prod();     // The production stage
+        const sc_time bt = sc_time_stamp() - t0;
+        const unsigned long long bd = sc_delta_count() - d0;
+        prof.write_blocked_time += bt;
+        prof.write_blocked_deltas += bd;
+#ifdef FORSYDE_INTROSPECTION
+        charge_blocking(prof.out_ports, bt, bd);
+        sample_occupancy();
+#endif
+#else
+        prod();     // The production stage
+#endif
+    }
     
-    // NOTE: The following member functions could be overriden easier if
-    //       bind() was declared virtual in the sc_port base classes.
-    //       This will happen in SystemC 2.3, so adapt these accordingly.
-    //! Record the bounded channels
-    void operator()(sc_fifo_in_if<TokenType>& i)
+#if defined(FORSYDE_PROFILE) && defined(FORSYDE_INTROSPECTION)
+    //! Finds the ForSyDe signals bound to the ports for the per-port profiling
+    void bind_port_profiles()
     {
-        sc_fifo_in<TokenType>::operator()(i);
-        static_cast<ChanType&>(i).iport = this;
+        auto chan_of = [](sc_object* port) -> static_channel*
+        {
+            channel_port* cp = dynamic_cast<channel_port*>(port);
+            if (cp == NULL) return NULL;
+            std::vector<sc_interface*> chans = cp->bound_channels();
+            return chans.empty() ? NULL : dynamic_cast<static_channel*>(chans[0]);
+        };
+        prof.in_ports.resize(boundInChans.size());
+        for (size_t i=0; i<boundInChans.size(); i++)
+            prof.in_ports[i].chan = chan_of(boundInChans[i].port);
+        prof.out_ports.resize(boundOutChans.size());
+        for (size_t i=0; i<boundOutChans.size(); i++)
+            prof.out_ports[i].chan = chan_of(boundOutChans[i].port);
     }
     
-    //! Record the bounded ports
-    void operator()(in_port<T,TokenType,ChanType>& p)
+    //! Marks the inputs which are empty when the prep stage starts
+    void mark_empty_inputs()
     {
-        sc_fifo_in<TokenType>::operator()(p);
-        p.bound_port = this;
+        for (auto& pp : prof.in_ports)
+            pp.blocking = pp.chan != NULL && pp.chan->num_available() == 0;
     }
     
-    //! Returns the plain name of the token type
-    virtual const char* token_type() const
+    //! Marks the outputs with the least free space when the prod stage starts
+    void mark_full_outputs()
     {
-        return get_type_name<T>();
+        int least = INT_MAX;
+        for (auto& pp : prof.out_ports)
+            if (pp.chan != NULL) least = std::min(least, pp.chan->num_free());
+        for (auto& pp : prof.out_ports)
+            pp.blocking = pp.chan != NULL && pp.chan->num_free() == least;
     }
-
-    virtual std::string moc() const = 0;
-#endif
-};
-
-//! The UT_out port is used for output ports of UT processes
-template <typename T, typename TokenType, typename ChanType>
-class out_port: public sc_fifo_out<TokenType>
-#ifdef FORSYDE_INTROSPECTION
-            , public ForSyDe::introspective_port
-#endif
-{
-public:
-    out_port() : sc_fifo_out<TokenType>(){}
-    out_port(const char* name) : sc_fifo_out<TokenType>(name){}
-#ifdef FORSYDE_INTROSPECTION
-    typedef T type;
     
-    // NOTE: The following member functions could be overriden easier if
-    //       bind() was declared virtual in the sc_port base classes.
-    //       This will happen in SystemC 2.3, so adapt these accordingly.
-    //! Record the bounded channels
-    void operator()(sc_fifo_out_if<TokenType>& i)
+    //! Charges the time the process was blocked in a stage to the marked ports
+    static void charge_blocking(std::vector<port_profile>& ports,
+                                const sc_time& bt, unsigned long long bd)
     {
-        sc_fifo_out<TokenType>::operator()(i);
-        // Register the port-to-port binding
-        static_cast<ChanType&>(i).oport = this;
+        if (bd == 0 && bt == SC_ZERO_TIME) return;
+        for (auto& pp : ports)
+            if (pp.blocking)
+            {
+                pp.blocked_time += bt;
+                pp.blocked_deltas += bd;
+            }
     }
     
-    //! Record the bounded ports
-    void operator()(out_port<T,TokenType,ChanType>& p)
+    //! Samples the occupancy of the outputs after the prod stage
+    void sample_occupancy()
     {
-        sc_fifo_out<TokenType>::operator()(p);
-        // Register the port-to-port binding
-        p.bound_port = this;
+        for (auto& pp : prof.out_ports)
+        {
+            if (pp.chan == NULL) continue;
+            const size_t n = pp.chan->num_available();
+            if (pp.occupancy.size() <= n) pp.occupancy.resize(n+1, 0);
+            pp.occupancy[n]++;
+        }
     }
+#endif
     
-    //! Returns the name of the actual type (not abst_ext version)
-    virtual const char* token_type() const
+#ifdef FORSYDE_CHECKPOINT
+    //! Set once the init stage has completed
+    bool started;
+    
+    //! Set when the process is restored from a checkpoint
+    bool restored;
+    
+    //! The state of the process in the checkpoint
+    std::vector<char> saved_state;
+    
+    //! Restores the saved state after the init stage
+    void resume()
     {
-        return get_type_name<T>();
+        const char* pos = saved_state.data();
+        restore_state(pos);
+        if (pos != saved_state.data() + saved_state.size())
+            SC_REPORT_ERROR(name(), "the checkpoint does not match the state of the process");
+        std::vector<char>().swap(saved_state);
     }
-
-    virtual std::string moc() const = 0;
 #endif
-};
 
-//! The process constructor which defines the abstract semantics of execution
-/*! This class defines a set of methods and their execution order which
- * together define the abstract execution semantics of the processes in
- * ForSyDe-SystemC.
- * In each MoC, process constructors implement the these methods 
- * according to its own semantics. 
- * Additionally, this class contains members which are used to collect
- * and store information about the structure of the models which is used
- * for introspection in the elaboration phase.
- * 
- * Note that this is an abstract class and can not be directly
- * instantiated.
- * The designer uses the process constructors which implement the
- * abstract methods in a specific MoC.
- */
-class process : public sc_module
-{
-private:
-    //! 
-    SC_HAS_PROCESS(process);
+#ifdef FORSYDE_RESET
+    //! Set when the process runs its reset stage once it is restarted
+    bool reset_pending;
 
-    //! The main and only execution thread of the module
-    void worker()
-    {
-        //  We run the init stage here and not in the constructor to
-        // force running it after the elaboration phase.
-        init();
-        while (1)
-        {
-            prep();     // The preparaion stage
-            exec();     // The execution stage
-            prod();     // The production stage
-        }
-    }
+    //! The thread or the method of the process
+    sc_process_handle handle;
+#endif
 
 protected:
     //! The init stage
@@ -277,12 +2531,97 @@ protected:
      * cleaning jobs such as deallocation of the allocated memories, etc.
      */
     virtual void clean() = 0;
-    
+
+#ifdef FORSYDE_RESET
+    //! The reset stage
+    /*! This stage is executed instead of the init stage when the model
+     * is reset (see reset_model()) and should bring the process to the
+     * state right after its init stage, including writing its initial
+     * tokens. The default runs the clean and init stages again. The
+     * processes with costly init stages (e.g., the FMU wrappers) override
+     * it to keep their resources.
+     */
+    virtual void reset()
+    {
+        clean();
+        init();
+    }
+#endif
+
     //! This hook is used to run the clean stage
     void end_of_simulation()
     {
-        clean();
+        // processes which never started (e.g., the ones mapped to other
+        // MPI ranks) have nothing to clean
+        if (initialized) clean();
+#ifdef FORSYDE_PROFILE
+#ifdef FORSYDE_PROFILE_DB
+        profile_db& db = profile_db::get();
+        db.record_process(name(), forsyde_kind(), prof.firings, prof.exec_time);
+#ifdef FORSYDE_INTROSPECTION
+        for (auto& op : prof.out_ports)
+            if (auto ch = dynamic_cast<sc_object*>(op.chan))
+                db.record_channel(ch->name(), op.occupancy);
+#endif
+        if (profiler::get().report(name(), forsyde_kind(), prof)) db.save();
+#else
+        profiler::get().report(name(), forsyde_kind(), prof);
+#endif
+#endif
+#ifdef FORSYDE_TIMELINE
+        timeline::get().report();
+#endif
+#ifdef FORSYDE_SAMPLING_PROFILE
+        sampling_profiler::get().report(smp_id, name(), forsyde_kind());
+#endif
+#ifdef FORSYDE_ALLOC_TRACKER
+        alloc_tracker::get().report(name(), forsyde_kind(), allocs);
+#endif
+    }
+    
+#ifdef FORSYDE_CHECKPOINT
+    //! Appends the internal state of the process to a buffer
+    /*! The process constructors with an internal state (e.g., the
+     * current state of a state machine) override this together with
+     * restore_state(). A restored process continues with a new
+     * evaluation cycle, hence only the state carried between the cycles
+     * is saved. The outputs which a process is blocked writing are saved
+     * by the signals. Stateless processes save nothing.
+     */
+    virtual void save_state(std::vector<char>& buf) {}
+    
+    //! Restores the internal state saved by save_state()
+    virtual void restore_state(const char*& pos) {}
+    
+    //! Checks if the process resumes from a checkpoint
+    /*! The init stage should then skip producing its initial tokens,
+     * which are restored together with the contents of the signals.
+     */
+    bool is_restored() const {return restored;}
+    
+    //! Saves a number of variables using their serializers
+    template <typename... Ts>
+    void save_values(std::vector<char>& buf, const Ts&... vals)
+    {
+        if constexpr ((is_serializable<Ts>::value && ...))
+            (serializer<Ts>::write(buf, vals), ...);
+        else
+            SC_REPORT_ERROR(name(), "the state of the process is not serializable");
+    }
+    
+    //! Restores a number of variables saved by save_values()
+    template <typename... Ts>
+    void restore_values(const char*& pos, Ts&... vals)
+    {
+        if constexpr ((is_serializable<Ts>::value && ...))
+            (serializer<Ts>::read(pos, vals), ...);
+        else
+            SC_REPORT_ERROR(name(), "the state of the process is not serializable");
     }
+#else
+    //! Checks if the process resumes from a checkpoint
+    bool is_restored() const {return false;}
+#endif
     
 #ifdef FORSYDE_INTROSPECTION
 
@@ -290,6 +2629,9 @@ protected:
     void end_of_elaboration()
     {
         bindInfo();
+#ifdef FORSYDE_PROFILE
+        bind_port_profiles();
+#endif
     }
 
     //! This method is called during end_of_elaboration to gather binded channels information
@@ -303,13 +2645,246 @@ protected:
 public:
 
 #ifdef FORSYDE_INTROSPECTION
+private:
+    //! The introspection data, allocated apart from the process object
+    std::unique_ptr<process_introspection> intro;
+    
+public:
     //! Pointers to the input ports and their bound channels
-    std::vector<PortInfo> boundInChans;
+    std::vector<PortInfo>& boundInChans;
     //! Pointers to the output ports and their bound channels
-    std::vector<PortInfo> boundOutChans;
+    std::vector<PortInfo>& boundOutChans;
     
     //! Vector holding a list of argument/value tuples passed to the process constructor
-    std::vector<std::tuple<std::string,std::string>> arg_vec;
+    std::vector<std::tuple<std::string,arg_value>>& arg_vec;
+
+    //! Records an argument passed to the process constructor
+    /*! The value is copied and only formatted when it is exported.
+     */
+    template <typename T>
+    void add_arg(const char* name, const T& val)
+    {
+        arg_vec.emplace_back(name, arg_value([val]()
+        {
+            std::stringstream ss;
+            ss << val;
+            return ss.str();
+        }));
+    }
+
+    //! Records a function argument, named after the process and the suffix
+    void add_func_arg(const char* name, const char* suffix)
+    {
+        arg_vec.emplace_back(name, arg_value([this, suffix]()
+        {
+            std::string func_name = std::string(basename());
+            func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
+            return func_name + suffix;
+        }));
+    }
+#endif
+
+#ifdef FORSYDE_PROFILE
+    //! The profiling information of the process
+    profile_info prof;
+#endif
+
+#ifdef FORSYDE_TIMELINE
+    //! The track of the process in the timeline
+    std::uint32_t tl_track;
+#endif
+
+#ifdef FORSYDE_SAMPLING_PROFILE
+    //! The number of the process in the sampling profiler
+    std::uint32_t smp_id;
+#endif
+
+#ifdef FORSYDE_ALLOC_TRACKER
+    //! The heap allocations of the stages of the process
+    alloc_info allocs;
+#endif
+
+#ifdef FORSYDE_METRICS
+    //! The profiling counters published to the metrics exporter
+    live_counters live;
+#endif
+
+#if defined(FORSYDE_MEMORY_REPORT) || defined(FORSYDE_ARENA)
+    //! Records the size of the processes allocated by new
+    /*! With FORSYDE_ARENA, they are allocated in the current elaboration
+     * arena, if any.
+     */
+    static void* operator new(size_t size)
+    {
+#ifdef FORSYDE_MEMORY_REPORT
+        last_alloc() = size;
+#endif
+#ifdef FORSYDE_ARENA
+        return elab_arena::allocate_object(size);
+#else
+        return ::operator new(size);
+#endif
+    }
+    
+    static void* operator new(size_t, void* where) {return where;}
+    
+#ifdef FORSYDE_ARENA
+    static void operator delete(void* p) {elab_arena::free_object(p);}
+#else
+    static void operator delete(void* p) {::operator delete(p);}
+#endif
+#endif
+
+#ifdef FORSYDE_MEMORY_REPORT
+    //! The size of the process object if it is allocated by new, zero otherwise
+    size_t alloc_bytes;
+    
+    //! The stack size of the thread of the process
+    size_t stack_bytes;
+    
+    //! The bytes allocated by the process for its buffers on the heap
+    /*! The process constructors which keep their inputs and outputs in
+     * vectors (e.g., the SDF ones) override it.
+     */
+    virtual size_t buffer_bytes() const {return 0;}
+    
+    //! The bytes allocated for a number of vectors
+    template <typename... Vs>
+    static size_t vector_bytes(const Vs&... vs)
+    {
+        return (0 + ... + (vs.capacity() * sizeof(typename Vs::value_type)));
+    }
+#endif
+    
+    //! The stack size of the threads of the processes created from now on
+    static size_t& stack_size()
+    {
+        static size_t size = FORSYDE_STACK_SIZE;
+        return size;
+    }
+    
+    //! Enables the method mode for the processes created from now on
+    /*! In the method mode, the processes with a static firing rule run as
+     * SC_METHODs instead of SC_THREADs (see firing_rule()). They need no
+     * stack and no context switches. The other processes keep their
+     * threads.
+     */
+    static bool& method_mode()
+    {
+#ifdef FORSYDE_METHOD_PROCESSES
+        static bool mode = true;
+#else
+        static bool mode = false;
+#endif
+        return mode;
+    }
+    
+#ifdef FORSYDE_COROUTINES
+    //! Enables the coroutine mode for the processes created from now on
+    /*! In the coroutine mode, the processes with a static or a dynamic
+     * firing rule (see firing_rule() and dynamic_firing_rule()) run as
+     * stackless coroutines resumed by the coroutine_scheduler, and the
+     * other processes keep their threads. It takes precedence over the
+     * method mode.
+     */
+    static bool& coroutine_mode()
+    {
+        static bool mode = true;
+        return mode;
+    }
+#endif
+    
+    //! A port in a firing rule with the tokens it reads or writes per firing
+    struct firing_port
+    {
+        //! Returns the channels bound to the port (valid after elaboration)
+        std::function<std::vector<sc_interface*>()> channels;
+        size_t toks;                ///< the tokens per firing
+    };
+    
+    //! Makes an entry of a firing rule for a port
+    template <class PortType>
+    static firing_port rule_port(PortType& port, size_t toks)
+    {
+        return {[&port]()
+        {
+            std::vector<sc_interface*> chans;
+            for (int i=0; i<port.size(); i++) chans.push_back(port[i]);
+            return chans;
+        }, toks};
+    }
+    
+    //! The static firing rule of the process, if it has one
+    /*! The process constructors which always read and write the same
+     * number of tokens on each port, and whose stages never wait for
+     * anything else, override it to fill the input and output ports with
+     * their tokens per firing and return true. Such processes can run in
+     * the method mode. Their initial tokens should fit in the channels.
+     */
+    virtual bool firing_rule(std::vector<firing_port>& ins,
+                             std::vector<firing_port>& outs)
+    {
+        return false;
+    }
+    
+#ifdef FORSYDE_COROUTINES
+    //! Checks if the process has a firing rule which changes between firings
+    virtual bool has_dynamic_firing_rule() const {return false;}
+    
+    //! The firing rule of the next firing, if it depends on the state
+    /*! The process constructors whose rates depend on their state (e.g.,
+     * through a partitioning function) override it together with
+     * has_dynamic_firing_rule() to fill the ports with the tokens of the
+     * next firing. It is called after the previous firing and the stages
+     * of the next firing should not block. Such processes can run in the
+     * coroutine mode.
+     */
+    virtual void dynamic_firing_rule(std::vector<firing_port>& ins,
+                                     std::vector<firing_port>& outs) {}
+#endif
+    
+    //! This hook is used to create the execution method or thread
+    void before_end_of_elaboration()
+    {
+#ifdef FORSYDE_COROUTINES
+        if (coroutine_driven)
+        {
+            std::vector<firing_port> ins, outs;
+            // the lazy processes wait for their gate in a thread
+#ifdef FORSYDE_LAZY
+            if (!gate && (firing_rule(ins, outs) || has_dynamic_firing_rule()))
+#else
+            if (firing_rule(ins, outs) || has_dynamic_firing_rule())
+#endif
+            {
+                task = co_worker();
+                coroutine_scheduler::get().add(task.handle());
+            }
+            else
+            {
+                coroutine_driven = false;
+                create_thread();
+            }
+            return;
+        }
+#endif
+        if (!method_driven) return;
+        std::vector<firing_port> ins, outs;
+        if (firing_rule(ins, outs))
+            SC_METHOD(method_worker);
+        else
+        {
+            method_driven = false;
+            create_thread();
+        }
+    }
+    
+    //! Checks if the process runs as a method
+    bool is_method_driven() const {return method_driven;}
+    
+#ifdef FORSYDE_COROUTINES
+    //! Checks if the process runs as a coroutine
+    bool is_coroutine_driven() const {return coroutine_driven;}
 #endif
  
     //! The constructor requires the module name
@@ -317,16 +2892,214 @@ public:
      * processes them and writes the results using the output port.
      */
     process(sc_module_name _name    ///< The name of the ForSyDe process
-            ): sc_module(_name)
+            ): sc_module(_name), ext_driven(false), initialized(false)
+#ifdef FORSYDE_CHECKPOINT
+             , started(false), restored(false)
+#endif
+#ifdef FORSYDE_RESET
+             , reset_pending(false)
+#endif
+#ifdef FORSYDE_INTROSPECTION
+             , intro(new process_introspection), boundInChans(intro->in_chans),
+               boundOutChans(intro->out_chans), arg_vec(intro->args)
+#endif
     {
-        SC_THREAD(worker);
+#ifdef FORSYDE_MEMORY_REPORT
+        alloc_bytes = last_alloc();
+        last_alloc() = 0;
+        stack_bytes = 0;
+#endif
+#ifdef FORSYDE_ARENA
+        elab_arena::adopt_pending(this);
+#endif
+        // the method or the thread of a process which may run as a method
+        // is created once its firing rule is known
+#ifdef FORSYDE_COROUTINES
+        coroutine_driven = coroutine_mode();
+        method_driven = !coroutine_driven && method_mode();
+        if (!method_driven && !coroutine_driven) create_thread();
+#else
+        method_driven = method_mode();
+        if (!method_driven) create_thread();
+#endif
+#ifdef FORSYDE_PROFILE
+        profiler::get().enroll();
+#endif
+#ifdef FORSYDE_TIMELINE
+        tl_track = timeline::get().add_track(this);
+#endif
+#ifdef FORSYDE_SAMPLING_PROFILE
+        smp_id = sampling_profiler::get().enroll();
+#endif
+#ifdef FORSYDE_ALLOC_TRACKER
+        alloc_tracker::get().enroll();
+#endif
     }
     
     //! The ForSyDe process type represented by the current module
     virtual std::string forsyde_kind() const = 0;
     
+    //! Hands over the execution of the process to an external executor
+    /*! It should be called before the simulation starts. The thread of
+     * the process terminates immediately and the executor becomes
+     * responsible for calling ext_init() once and ext_fire() repeatedly.
+     */
+    void set_ext_driven() {ext_driven = true;}
+    
+    //! Checks if the process is driven by an external executor
+    bool is_ext_driven() const {return ext_driven;}
+
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Lets the writer of the input of a fanout write to its outputs directly
+    /*! The fanout processes call it before the simulation starts. If the
+     * process is not driven by an executor and its input is an empty
+     * ForSyDe signal, the signal forwards the tokens written to it to the
+     * output channels and the thread of the process terminates
+     * immediately. The fanout then costs neither a context switch nor a
+     * copy per token.
+     */
+    template <typename T, typename TokenType, typename ChanType>
+    void bypass_fanout(in_port<T,TokenType,ChanType>& iport,
+                       out_port<T,TokenType,ChanType>& oport)
+    {
+        if (ext_driven || iport.size() != 1) return;
+        auto chan = dynamic_cast<forwarding_channel<TokenType>*>(iport[0]);
+        if (chan == NULL) return;
+        std::vector<sc_fifo_out_if<TokenType>*> dests;
+        for (int i=0; i<oport.size(); i++) dests.push_back(oport[i]);
+        if (chan->forward_writes(dests)) ext_driven = true;
+    }
+#endif
+    
+#ifdef FORSYDE_LAZY
+    //! Defers the init stage of the process until a gate opens
+    /*! It should be called before the simulation starts, usually through
+     * make_lazy(). It has no effect on the processes driven by an
+     * executor, which runs their init stage itself.
+     */
+    void set_lazy(const std::shared_ptr<lazy_gate>& g) {gate = g;}
+    
+    //! Checks if the process has not run its init stage yet
+    bool is_dormant() const {return !initialized;}
+#endif
+    
+    //! Runs the init stage on behalf of an external executor
+    void ext_init() {initialized = true; start();}
+    
+#ifdef FORSYDE_CHECKPOINT
+    //! Appends the state of the process to a checkpoint
+    /*! The first byte tells if the init stage has completed. Otherwise
+     * nothing else is saved and the process starts over when it is
+     * restored.
+     */
+    void save_checkpoint(std::vector<char>& buf)
+    {
+        buf.push_back(started ? 1 : 0);
+        if (started) save_state(buf);
+    }
+    
+    //! Loads the state of the process from a checkpoint
+    /*! It should be called before the simulation starts. The state is
+     * applied right after the init stage.
+     */
+    void load_checkpoint(const char* data, size_t size)
+    {
+        if (size == 0)
+            SC_REPORT_ERROR(name(), "the checkpoint does not match the state of the process");
+        restored = size > 0 && data[0] != 0;
+        if (restored) saved_state.assign(data+1, data+size);
+    }
+#endif
+    
+#ifdef FORSYDE_RESET
+    //! Restarts the process with its reset stage
+    /*! It should be called while the simulation is paused and after the
+     * signals are emptied (see reset_model()). The processes which have
+     * not started yet run their init stage as usual.
+     */
+    void restart()
+    {
+        if (!initialized) return;
+        if (ext_driven)
+            return SC_REPORT_ERROR(name(), "the processes driven by an executor can not be reset");
+#ifdef FORSYDE_COROUTINES
+        if (coroutine_driven)
+            return SC_REPORT_ERROR(name(), "the processes running as coroutines can not be reset");
+#endif
+        reset_pending = true;
+        handle.reset();
+    }
+#endif
+
+    //! Runs one evaluation cycle on behalf of an external executor
+    void ext_fire() {fire();}
+    
+    //! Repeats the production stage of the last cycle on behalf of an executor
+    /*! It writes the results of the last execution stage again, hence it
+     * can replace whole cycles of the processes whose inputs never
+     * change (e.g., the combinational processes fed by constants).
+     */
+    void ext_replay() {fire_prod();}
+    
+    //! Runs the preparation stage of a cycle on behalf of an executor
+    /*! The stages of a cycle can be run separately, e.g., to time the
+     * execution stage alone, by calling ext_prep(), ext_exec() and
+     * ext_prod() in this order.
+     */
+    void ext_prep() {fire_prep();}
+    
+    //! Runs the execution stage of a cycle on behalf of an executor
+    void ext_exec() {fire_exec();}
+    
+    //! Runs the production stage of a cycle on behalf of an executor
+    void ext_prod() {fire_prod();}
+    
+#ifdef FORSYDE_CHECKPOINT
+    //! Saves the state of the process on behalf of an executor
+    /*! It is used by the executors which move the processes between the
+     * MPI ranks during the simulation.
+     */
+    void ext_save_state(std::vector<char>& buf) {save_state(buf);}
+    
+    //! Restores a state saved by ext_save_state()
+    void ext_restore_state(const char*& pos) {restore_state(pos);}
+#endif
+    
+private:
+#ifdef FORSYDE_MEMORY_REPORT
+    // The size of the last process allocated by the calling thread
+    static size_t& last_alloc()
+    {
+        thread_local size_t size = 0;
+        return size;
+    }
+#endif
 };
 
+#ifdef FORSYDE_LAZY
+//! Makes a composite process lazy
+/*! All the processes below the composite in the hierarchy run their init
+ * stage (e.g., loading an FMU, opening a pipe or allocating their
+ * buffers) only when the first token arrives at an input port of the
+ * composite. The composites which run only in rare scenarios (e.g., the
+ * kernels of an SADF model) then cost nothing until they are used. It
+ * should be called before the simulation starts, after the processes of
+ * the composite are created.
+ */
+inline void make_lazy(sc_module* composite)
+{
+    auto gate = std::make_shared<lazy_gate>(composite);
+    std::function<void(sc_object*)> mark = [&](sc_object* obj)
+    {
+        if (auto p = dynamic_cast<process*>(obj))
+            p->set_lazy(gate);
+        else
+            for (auto c : obj->get_child_objects()) mark(c);
+    };
+    mark(composite);
+}
+#endif
+
 }
 
 #endif
@@ -0,0 +1,267 @@
+/**********************************************************************
+    * abst_array.hpp -- Arrays of absent-extended values              *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Storing the values and the presence of an array of     *
+    *          absent-extended values separately                      *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ABST_ARRAY_HPP
+#define ABST_ARRAY_HPP
+
+/*! \file abst_array.hpp
+ * \brief Implements the arrays of absent-extended values
+ *
+ *  An std::array<abst_ext<T>,N> interleaves the presence flags with the
+ * values, which doubles its size for the arithmetic types and prevents
+ * the loops over the values from being vectorized. An abst_array<T,N>
+ * keeps the values in a contiguous aligned array and the presence in a
+ * bit mask. It can be used instead of std::array<abst_ext<T>,N> with the
+ * data-parallel SY process constructors (combX, zipX and unzipX):
+ *
+ *     SY::combX<float,float,64,abst_array<float,64>> layer("layer",
+ *         [](abst_ext<float>& out, const abst_array<float,64>& inp)
+ *         {
+ *             out = masked_reduce<SY::vadd_op>(inp, 0.0f);
+ *         });
+ *
+ *  The absent values are kept as default-constructed values of T, so
+ *  that the masked kernels below can run over all the values at full
+ *  vector width and only use the mask to select the results.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <bitset>
+#include <iostream>
+
+#include "abst_ext.hpp"
+
+namespace ForSyDe
+{
+
+//! The alignment of the arrays of the vectorized process constructors
+#ifndef FORSYDE_SIMD_ALIGN
+#define FORSYDE_SIMD_ALIGN 64
+#endif
+
+//! An array of absent-extended values stored as values and a presence mask
+template <typename T, std::size_t N>
+class abst_array
+{
+public:
+    //! The number of 64-bit words of the presence mask
+    static constexpr std::size_t words = (N+63)/64;
+
+    //! A reference to an element, which reads and writes it as an abst_ext<T>
+    class reference
+    {
+    public:
+        reference(abst_array& arr, std::size_t i) : arr(arr), i(i) {}
+
+        operator abst_ext<T>() const {return arr.get(i);}
+
+        reference& operator=(const abst_ext<T>& val)
+        {
+            arr.set(i, val);
+            return *this;
+        }
+
+        reference& operator=(const reference& ref)
+        {
+            arr.set(i, ref.arr.get(ref.i));
+            return *this;
+        }
+
+        bool is_present() const {return arr.is_present(i);}
+        bool is_absent() const {return !arr.is_present(i);}
+
+    private:
+        abst_array& arr;
+        std::size_t i;
+    };
+
+    //! The default constructor, with all the elements absent
+    abst_array() : vals(), mask() {}
+
+    //! Converts an array of absent-extended values
+    abst_array(const std::array<abst_ext<T>,N>& arr) : abst_array()
+    {
+        for (std::size_t i=0; i<N; i++) set(i, arr[i]);
+    }
+
+    //! Converts to an array of absent-extended values
+    operator std::array<abst_ext<T>,N>() const
+    {
+        std::array<abst_ext<T>,N> res;
+        for (std::size_t i=0; i<N; i++) res[i] = get(i);
+        return res;
+    }
+
+    //! The number of elements
+    static constexpr std::size_t size() {return N;}
+
+    //! Checks for the presence of an element
+    bool is_present(std::size_t i) const
+    {
+        return (mask[i/64] >> (i%64)) & 1;
+    }
+
+    //! Reads an element
+    abst_ext<T> get(std::size_t i) const
+    {
+        return is_present(i) ? abst_ext<T>(vals[i]) : abst_ext<T>();
+    }
+
+    //! Writes an element
+    void set(std::size_t i, const abst_ext<T>& val)
+    {
+        if (val.is_present())
+            set_val(i, val.unsafe_from_abst_ext());
+        else
+            set_abst(i);
+    }
+
+    //! Writes a present value to an element
+    void set_val(std::size_t i, const T& val)
+    {
+        vals[i] = val;
+        mask[i/64] |= std::uint64_t(1) << (i%64);
+    }
+
+    //! Sets an element absent
+    void set_abst(std::size_t i)
+    {
+        vals[i] = T();
+        mask[i/64] &= ~(std::uint64_t(1) << (i%64));
+    }
+
+    //! Reads an element
+    abst_ext<T> operator[](std::size_t i) const {return get(i);}
+
+    //! Accesses an element
+    reference operator[](std::size_t i) {return reference(*this, i);}
+
+    //! Sets all the elements to the same value
+    void fill(const abst_ext<T>& val)
+    {
+        for (std::size_t i=0; i<N; i++) set(i, val);
+    }
+
+    //! The number of present elements
+    std::size_t count() const
+    {
+        std::size_t n = 0;
+        for (auto w : mask) n += std::bitset<64>(w).count();
+        return n;
+    }
+
+    //! Checks if all the elements are present
+    bool all_present() const {return count() == N;}
+
+    //! Checks if all the elements are absent
+    bool all_absent() const
+    {
+        for (auto w : mask) if (w) return false;
+        return true;
+    }
+
+    //! The values, where the absent elements are default-constructed values
+    const T* data() const {return vals.data();}
+
+    //! The values, which should only be written where the elements are present
+    T* data() {return vals.data();}
+
+    //! The presence mask, bit i%64 of word i/64 for element i
+    const std::array<std::uint64_t,words>& presence() const {return mask;}
+
+    //! Copies the presence mask of another array
+    template <typename T1>
+    void copy_presence(const abst_array<T1,N>& arr)
+    {
+        mask = arr.presence();
+        for (std::size_t i=0; i<N; i++)
+            if (!is_present(i)) vals[i] = T();
+    }
+
+    //! Checks for the equivalence of two arrays
+    bool operator==(const abst_array& rs) const
+    {
+        if (mask != rs.mask) return false;
+        for (std::size_t i=0; i<N; i++)
+            if (is_present(i) && !(vals[i] == rs.vals[i])) return false;
+        return true;
+    }
+
+    //! Overload the streaming operator to enable SystemC communiation
+    friend std::ostream& operator<<(std::ostream& os, const abst_array& arr)
+    {
+        os << "[";
+        for (std::size_t i=0; i<N; i++)
+            os << (i ? "," : "") << arr.get(i);
+        os << "]";
+        return os;
+    }
+
+private:
+    alignas(FORSYDE_SIMD_ALIGN) std::array<T,N> vals;
+    std::array<std::uint64_t,words> mask;
+};
+
+//! Applies a function to all the values of an array at full vector width
+/*! The function is also applied to the (default-constructed) values of
+ * the absent elements, which keep absent in the result. It should hence
+ * have no side effects.
+ */
+template <typename T0, typename T1, std::size_t N, typename F>
+inline void masked_map(abst_array<T0,N>& out, const abst_array<T1,N>& in, F f)
+{
+    T0* o = out.data();
+    const T1* x = in.data();
+    for (std::size_t i=0; i<N; i++) o[i] = f(x[i]);
+    out.copy_presence(in);
+}
+
+//! Reduces the present values of an array with an operation
+/*! The operation is given as a class with a static apply function (e.g.,
+ * SY::vadd_op or SY::vmax_op), and identity is its identity element,
+ * which is returned if all the elements are absent. The values are
+ * accumulated in 8 independent lanes, which lets the compiler vectorize
+ * the loop, hence the operation should be associative. The runs of 64
+ * elements which are all present are reduced without looking at the
+ * mask.
+ */
+template <typename Op, typename T, std::size_t N>
+inline T masked_reduce(const abst_array<T,N>& in, const T& identity)
+{
+    const std::size_t L = 8;
+    const T* x = in.data();
+    const auto& mask = in.presence();
+    T acc[L];
+    for (std::size_t k=0; k<L; k++) acc[k] = identity;
+    for (std::size_t w=0; w<abst_array<T,N>::words; w++)
+    {
+        const std::uint64_t m = mask[w];
+        const std::size_t begin = w*64;
+        if (m == 0) continue;
+        if (m == ~std::uint64_t(0))
+            for (std::size_t i=begin; i<begin+64; i+=L)
+                for (std::size_t k=0; k<L; k++)
+                    acc[k] = Op::apply(acc[k], x[i+k]);
+        else
+            for (std::size_t i=begin; i<N && i<begin+64; i++)
+                acc[i%L] = Op::apply(acc[i%L], (m >> (i-begin)) & 1 ? x[i] : identity);
+    }
+    for (std::size_t k=1; k<L; k++) acc[0] = Op::apply(acc[0], acc[k]);
+    return acc[0];
+}
+
+}
+
+#endif
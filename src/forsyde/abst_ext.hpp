@@ -18,74 +18,258 @@
  * \brief Implements the Absent-extended values
  */
 
+#include <utility>
+#include <type_traits>
+#include <limits>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
 namespace ForSyDe
 {
 
 using namespace sc_core;
 
+//! The niche of a type, i.e., the values which can encode the absent values
+/*! By default, an absent-extended value stores a flag next to the value.
+ * If a type has values which are never used as present values, a
+ * specialization of this template can set value to true and encode the
+ * absent values (and the runs of absent values with FORSYDE_ABSENT_RLE)
+ * in them, so that abst_ext<T> has the size of T:
+ *
+ *     template <>
+ *     struct ForSyDe::abst_niche<mode>
+ *     {
+ *         static constexpr bool value = true;
+ *         static constexpr unsigned int max_run = 1;
+ *         static mode absent(unsigned int run) {return mode::none;}
+ *         static bool is_absent(const mode& v) {return v == mode::none;}
+ *         static unsigned int run_length(const mode& v) {return 1;}
+ *     };
+ *
+ *  where max_run is the longest run of absent values which can be
+ * encoded in a single value. With FORSYDE_COMPACT_ABST_EXT, the floating
+ * point types use the signalling NaNs, which arithmetic never produces,
+ * and the pointers use the null pointer. A present value which falls in
+ * the niche reads as absent.
+ */
+template <typename T, typename = void>
+struct abst_niche
+{
+    static constexpr bool value = false;
+};
+
+#ifdef FORSYDE_COMPACT_ABST_EXT
+//! The signalling NaNs of the floating point types encode the absent values
+/*! The run of absent values is stored in the payload of the NaN.
+ */
+template <typename T>
+struct abst_niche<T, typename std::enable_if<std::is_floating_point<T>::value &&
+                                             std::numeric_limits<T>::is_iec559 &&
+                                             (sizeof(T) == 4 || sizeof(T) == 8)>::type>
+{
+    typedef typename std::conditional<sizeof(T) == 4, std::uint32_t, std::uint64_t>::type bits_t;
+    static constexpr int mant_bits = std::numeric_limits<T>::digits - 1;
+    static constexpr bits_t quiet = bits_t(1) << (mant_bits - 1);
+    static constexpr bits_t exponent = (~bits_t(0) >> 1) & ~((bits_t(1) << mant_bits) - 1);
+    
+    static constexpr bool value = true;
+    static constexpr unsigned int max_run = quiet - 1 < UINT_MAX ? quiet - 1 : UINT_MAX;
+    
+    static T absent(unsigned int run)
+    {
+        const bits_t b = exponent | bits_t(run);
+        T v;
+        std::memcpy(&v, &b, sizeof(T));
+        return v;
+    }
+    
+    static bool is_absent(const T& v)
+    {
+        bits_t b;
+        std::memcpy(&b, &v, sizeof(T));
+        return (b & exponent) == exponent && (b & quiet) == 0 && (b & (quiet - 1)) != 0;
+    }
+    
+    static unsigned int run_length(const T& v)
+    {
+        bits_t b;
+        std::memcpy(&b, &v, sizeof(T));
+        return b & (quiet - 1);
+    }
+};
+
+//! The null pointer encodes the absent values
+template <typename T>
+struct abst_niche<T*>
+{
+    static constexpr bool value = true;
+    static constexpr unsigned int max_run = 1;
+    static T* absent(unsigned int) {return nullptr;}
+    static bool is_absent(T* const& v) {return v == nullptr;}
+    static unsigned int run_length(T* const&) {return 1;}
+};
+#endif
+
+//! The storage of an absent-extended value with a presence flag
+template <typename T, bool Niche = abst_niche<T>::value>
+struct abst_storage
+{
+    static constexpr unsigned int max_run = UINT_MAX;
+    
+    abst_storage() : present(false) {}
+    abst_storage(const T& val) : present(true), value(val) {}
+    abst_storage(T&& val) : present(true), value(std::move(val)) {}
+    
+    bool has_value() const {return present;}
+    void set(const T& val) {present=true;value=val;}
+    void set(T&& val) {present=true;value=std::move(val);}
+    void clear(unsigned int n)
+    {
+        present=false;
+#ifdef FORSYDE_ABSENT_RLE
+        run=n;
+#endif
+    }
+#ifdef FORSYDE_ABSENT_RLE
+    unsigned int run_length() const {return present ? 1 : run;}
+#endif
+    
+    bool present;
+#ifdef FORSYDE_ABSENT_RLE
+    unsigned int run = 1;
+#endif
+    T value;
+};
+
+//! The storage of an absent-extended value encoded in the niche of T
+template <typename T>
+struct abst_storage<T,true>
+{
+    static constexpr unsigned int max_run = abst_niche<T>::max_run;
+    
+    abst_storage() : value(abst_niche<T>::absent(1)) {}
+    abst_storage(const T& val) : value(val) {}
+    abst_storage(T&& val) : value(std::move(val)) {}
+    
+    bool has_value() const {return !abst_niche<T>::is_absent(value);}
+    void set(const T& val) {value=val;}
+    void set(T&& val) {value=std::move(val);}
+    void clear(unsigned int n) {value=abst_niche<T>::absent(n);}
+#ifdef FORSYDE_ABSENT_RLE
+    unsigned int run_length() const
+    {
+        return has_value() ? 1 : abst_niche<T>::run_length(value);
+    }
+#endif
+    
+    T value;
+};
+
 //! Absent-extended data types
 /*! This template class extends a type T to its absent-extended version.
  * Values of this type could be either absent, or present with a specific
- * value.
+ * value. The types with a niche (see abst_niche) encode the absent
+ * values in the value itself.
  */
 template <typename T>
 class abst_ext
 {
 public:
     //! The constructor with a present value
-    abst_ext(const T& val) : present(true), value(val) {}
+    abst_ext(const T& val) : st(val) {}
+    
+    //! The constructor with a present value which is moved in
+    abst_ext(T&& val) : st(std::move(val)) {}
     
     //! The constructor with an absent value
-    abst_ext() : present(false) {}
+    abst_ext() {}
+    
+    //! The copy constructor
+    abst_ext(const abst_ext&) = default;
+    
+    //! The move constructor
+    abst_ext(abst_ext&&)
+        noexcept(std::is_nothrow_move_constructible<T>::value) = default;
+    
+    //! The copy assignment operator
+    abst_ext& operator=(const abst_ext&) = default;
+    
+    //! The move assignment operator
+    abst_ext& operator=(abst_ext&&)
+        noexcept(std::is_nothrow_move_assignable<T>::value) = default;
     
     //! Converts a value from an extended value, returning a default value if absent
-    T from_abst_ext (const T& defval) const
+    T from_abst_ext (const T& defval) const &
+    {
+        if (st.has_value()) return st.value; else return defval;
+    }
+    
+    //! Converts a value from an expiring extended value, moving it out if present
+    T from_abst_ext (const T& defval) &&
     {
-        if (present) return value; else return defval;
+        if (st.has_value()) return std::move(st.value); else return defval;
     }
     
     //! Converts a value from an extended value, returning a default value if absent
     inline friend T from_abst_ext (const abst_ext& absval, const T& defval)
     {
-        if (absval.present) return absval.value; else return defval;
+        if (absval.st.has_value()) return absval.st.value; else return defval;
     }
     
-    //! Unsafely converts a value from an extended value assuming it is present
-    T unsafe_from_abst_ext () const {return value;}
+    //! Unsafely accesses the value of an extended value assuming it is present
+    const T& unsafe_from_abst_ext () const & {return st.value;}
     
-    //! Unsafely converts a value from an extended value assuming it is present
-    inline friend T unsafe_from_abst_ext(const abst_ext& absval)
+    //! Unsafely moves the value out of an expiring extended value assuming it is present
+    T unsafe_from_abst_ext () && {return std::move(st.value);}
+    
+    //! Unsafely accesses the value of an extended value assuming it is present
+    inline friend const T& unsafe_from_abst_ext(const abst_ext& absval)
     {
-        return absval.value;
+        return absval.st.value;
+    }
+    
+    //! Unsafely moves the value out of an expiring extended value assuming it is present
+    inline friend T unsafe_from_abst_ext(abst_ext&& absval)
+    {
+        return std::move(absval.st.value);
     }
     
     //! Sets absent
-    void set_abst() {present=false;}
+    void set_abst() {st.clear(1);}
     
     //! Sets absent
-    inline friend void set_abst(abst_ext& absval) {absval.present=false;}
+    inline friend void set_abst(abst_ext& absval) {absval.set_abst();}
     
     //! Sets the value
-    void set_val(const T& val) {present=true;value=val;}
+    void set_val(const T& val) {st.set(val);}
+    
+    //! Sets the value by moving it in
+    void set_val(T&& val) {st.set(std::move(val));}
     
     //! Sets the value
     inline friend void set_val(abst_ext& absval, const T& val)
     {
-        absval.present=true;
-        absval.value=val;
+        absval.st.set(val);
+    }
+    
+    //! Sets the value by moving it in
+    inline friend void set_val(abst_ext& absval, T&& val)
+    {
+        absval.st.set(std::move(val));
     }
     
     //! Checks for the absence of a value
-    bool is_absent() const {return !present;}
+    bool is_absent() const {return !st.has_value();}
     
     //! Checks for the absence of a value
-    inline friend bool is_absent(const abst_ext& absval) {return !absval.present;}
+    inline friend bool is_absent(const abst_ext& absval) {return !absval.st.has_value();}
     
     //! Checks for the presence of a value
-    bool is_present() const {return present;}
+    bool is_present() const {return st.has_value();}
     
     //! Checks for the presence of a value
-    inline friend bool is_present(const abst_ext& absval) {return absval.present;}
+    inline friend bool is_present(const abst_ext& absval) {return absval.st.has_value();}
     
     //! Checks for the equivalence of two absent-extended values
     bool operator== (const abst_ext& rs) const
@@ -105,11 +289,35 @@ public:
             os << "_";
         return os;
     }
+#ifdef FORSYDE_ABSENT_RLE
+    //! The longest run of absent values in a single record
+    static constexpr unsigned int max_run = abst_storage<T>::max_run;
+    
+    //! Constructs a record of a number of consecutive absent values
+    /*! Such records are only used inside the signals, which expand them
+     * when they are read. The number should not exceed max_run.
+     */
+    static abst_ext absent_run(unsigned int n)
+    {
+        abst_ext res;
+        res.st.clear(n);
+        return res;
+    }
+    
+    //! The number of values represented by the record
+    unsigned int run_length() const {return st.run_length();}
+#endif
 private:
-    bool present;
-    T value;
+    abst_storage<T> st;
 };
 
+//! Checks if a type is an absent-extended type
+template <typename T>
+struct is_abst_ext : std::false_type {};
+
+template <typename T>
+struct is_abst_ext<abst_ext<T>> : std::true_type {};
+
 //! Check for presence in run time
 /*! This macro is used mainly in the strict version of synchronous
  * processes to ensure that the received inputs are not absent.
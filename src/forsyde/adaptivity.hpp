@@ -22,7 +22,13 @@
  */
 
 #include "sy_moc.hpp"
+#ifndef FORSYDE_NO_SDF
+#include "sdf_moc.hpp"
+#endif
 #include <functional>
+#include <vector>
+#include <memory>
+#include <cmath>
 
 namespace ForSyDe
 {
@@ -82,6 +88,119 @@ private:
     }
 };
 
+//! Process constructor for an adaptive process with a sparse function signal
+/*! Similar to apply, but an absent token on the function port keeps
+ * the current function, which is replaced (by move) only when a new one
+ * arrives. Hence the cost of an unchanged function is only reading an
+ * absent token. Until the first function arrives the output is absent,
+ * unless an initial function is given.
+ */
+template <class ITYP, class OTYP>
+class apply_sparse : public sc_module
+{
+public:
+    SY_in<ITYP>  iport;        ///< port for the input channel
+    SY_out<OTYP> oport;        ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<abst_ext<OTYP>(const abst_ext<ITYP>&)> functype;
+    SY_in<functype> fport;     ///< port for the (sparse) function channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the current function to it and writes the results using
+     * the output port
+     */
+    apply_sparse(sc_module_name _name,          // module name
+                 const functype& init_f=functype()  // the initial function
+                ) : sc_module(_name), cur_f(init_f)
+    {
+        SC_THREAD(worker);
+    }
+private:
+    SC_HAS_PROCESS(apply_sparse);
+    
+    functype cur_f;
+
+    //! The main and only execution thread of the module
+    void worker()
+    {
+        abst_ext<ITYP> in_val;
+        abst_ext<OTYP> out_val;
+        abst_ext<functype> f_tok;
+        while (1)
+        {
+            in_val = iport.read();  // read from input
+            f_tok = fport.read();   // read the function, if changed
+            if (is_present(f_tok))
+                cur_f = unsafe_from_abst_ext(std::move(f_tok));
+            out_val = cur_f ? cur_f(in_val) : abst_ext<OTYP>();
+            write_multiport(oport,out_val);    // write to the output
+        }
+    }
+};
+
+//! Process constructor for an adaptive process selecting from a function table
+/*! The functions are registered in the constructor, and a sparse
+ * control signal carries the index of the function to be applied. An
+ * absent control token keeps the current function, and a reconfiguration
+ * only changes the index, i.e., no function object is copied.
+ */
+template <class ITYP, class OTYP>
+class apply_select : public sc_module
+{
+public:
+    SY_in<ITYP>  iport;        ///< port for the input channel
+    SY_out<OTYP> oport;        ///< port for the output channel
+    SY_in<size_t> cport;       ///< port for the (sparse) function index
+    
+    //! Type of the functions to be passed to the process constructor
+    typedef std::function<abst_ext<OTYP>(const abst_ext<ITYP>&)> functype;
+
+    //! The constructor requires the module name and the function table
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the selected function to it and writes the results using
+     * the output port
+     */
+    apply_select(sc_module_name _name,                 // module name
+                 const std::vector<functype>& funcs,   // the function table
+                 size_t init_idx=0                     // the initial function
+                ) : sc_module(_name), funcs(funcs), init_idx(init_idx)
+    {
+        if (init_idx >= funcs.size())
+            SC_REPORT_ERROR(name(), "the initial function index is out of the function table");
+        SC_THREAD(worker);
+    }
+private:
+    SC_HAS_PROCESS(apply_select);
+    
+    std::vector<functype> funcs;
+    size_t init_idx;
+
+    //! The main and only execution thread of the module
+    void worker()
+    {
+        abst_ext<ITYP> in_val;
+        abst_ext<OTYP> out_val;
+        abst_ext<size_t> c_tok;
+        const functype* cur_f = &funcs[init_idx];
+        while (1)
+        {
+            in_val = iport.read();  // read from input
+            c_tok = cport.read();   // read the function index, if changed
+            if (is_present(c_tok))
+            {
+                const size_t idx = unsafe_from_abst_ext(c_tok);
+                if (idx >= funcs.size())
+                    SC_REPORT_ERROR(name(), "the function index is out of the function table");
+                cur_f = &funcs[idx];
+            }
+            out_val = (*cur_f)(in_val);// do the calculation
+            write_multiport(oport,out_val);    // write to the output
+        }
+    }
+};
+
 //! Helper function to construct a comb process
 /*! This function is used to construct a process (SystemC module) and
  * connect its output and output signals.
@@ -107,7 +226,414 @@ inline apply<T0,T1>* make_apply(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct an apply_sparse process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+                    template <class> class FIf>
+inline apply_sparse<T1,T0>* make_apply_sparse(const std::string& pName,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    FIf<typename apply_sparse<T1,T0>::functype>& fS
+    )
+{
+    auto p = new apply_sparse<T1,T0>(pName.c_str());
+    
+    (*p).iport(inp1S);
+    (*p).oport(outS);
+    (*p).fport(fS);
+    
+    return p;
 }
+
+//! Helper function to construct an apply_select process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+                    template <class> class CIf>
+inline apply_select<T1,T0>* make_apply_select(const std::string& pName,
+    const std::vector<typename apply_select<T1,T0>::functype>& funcs,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    CIf<size_t>& cS
+    )
+{
+    auto p = new apply_select<T1,T0>(pName.c_str(), funcs);
+    
+    (*p).iport(inp1S);
+    (*p).oport(outS);
+    (*p).cport(cS);
+    
+    return p;
+}
+
+
+//! Process constructor for switching a subsystem between two fidelities at runtime
+/*! The process encloses two implementations of the same subsystem with
+ * one input and one output: a high-fidelity one (HIGH_FIDELITY) and a
+ * cheaper surrogate (SURROGATE), e.g., a detailed model of a component
+ * and a lookup table or a reduced-order model of it. The implementations
+ * are bound to the internal signals of the process (see input_of() and
+ * output_of()) and, in each cycle, only the active one receives the
+ * input token and produces the output one. The inactive implementation
+ * stays blocked on its input, so it costs no simulation time.
+ *
+ *  In each cycle a criterion is evaluated on the input token, the
+ * previous output token and the active implementation, and returns the
+ * implementation which should be active, e.g., the surrogate once the
+ * subsystem reaches a steady state (see steady_state_criterion). On a
+ * switch, the handover function is called before the input is delivered,
+ * so that it can transfer the state of the processes of one
+ * implementation to the other ones.
+ *
+ * The implementations should only be driven by their input, i.e., they
+ * should not contain sources or feedback loops which produce tokens on
+ * their own.
+ */
+template <class ITYP, class OTYP>
+class multi_fidelity : public sy_process
+{
+public:
+    SY_in<ITYP>  iport1;        ///< port for the input channel
+    SY_out<OTYP> oport1;        ///< port for the output channel
+
+    //! The index of the high-fidelity implementation
+    static const size_t HIGH_FIDELITY = 0;
+    //! The index of the surrogate implementation
+    static const size_t SURROGATE = 1;
+
+    //! Type of the criterion selecting the active implementation
+    /*! It receives the input token, the previous output token and the
+     * active implementation, and returns the implementation to be used.
+     */
+    typedef std::function<size_t(const abst_ext<ITYP>&, const abst_ext<OTYP>&, size_t)> criterion_type;
+
+    //! Type of the function handing over the state from one implementation to the other
+    typedef std::function<void(size_t, size_t)> handover_type;
+
+    //! The constructor requires the module name, the criterion and the handover function
+    /*! It creates an SC_THREAD which reads the input, selects the active
+     * implementation, feeds it with the input and writes its output
+     * using the output port
+     */
+    multi_fidelity(const sc_module_name& _name,     ///< process name
+                   const criterion_type& _crit,     ///< the selection criterion
+                   const handover_type& _handover=handover_type(), ///< the state handover
+                   size_t init_active=HIGH_FIDELITY ///< the initially active implementation
+                  ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+                      vin{{"hi_in", 1}, {"lo_in", 1}},
+                      vout{{"hi_out", 1}, {"lo_out", 1}},
+                      _crit(_crit), _handover(_handover), init_active(init_active)
+    {
+        if (init_active > SURROGATE)
+            SC_REPORT_ERROR(name(), "the initially active implementation is out of range");
+        for (size_t i=0; i<2; i++)
+        {
+            vport_out[i](vin[i]);
+            vport_in[i](vout[i]);
+        }
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_crit", "_crit");
+        add_arg("init_active", init_active);
+#endif
+    }
+
+    //! The signal to which the input of an implementation is bound
+    SY2SY<ITYP>& input_of(size_t impl) {return vin[impl];}
+
+    //! The signal to which the output of an implementation is bound
+    SY2SY<OTYP>& output_of(size_t impl) {return vout[impl];}
+
+    //! The implementation active in the current cycle
+    size_t active() const {return cur;}
+
+    //! The number of cycles evaluated by an implementation
+    unsigned long long cycles(size_t impl) const {return ncycles[impl];}
+
+    //! The number of switches between the implementations
+    unsigned long long switches() const {return nswitches;}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::multi_fidelity";}
+
+private:
+    // the signals and the ports connecting the implementations
+    SY2SY<ITYP> vin[2];
+    SY2SY<OTYP> vout[2];
+    SY_out<ITYP> vport_out[2];
+    SY_in<OTYP> vport_in[2];
+
+    // Inputs and output variables
+    abst_ext<ITYP> ival1;
+    abst_ext<OTYP> oval;
+
+    //! The criterion and the handover passed to the process constructor
+    criterion_type _crit;
+    handover_type _handover;
+
+    size_t init_active, cur;
+    unsigned long long ncycles[2], nswitches;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        cur = init_active;
+        oval = abst_ext<OTYP>();
+        ncycles[0] = ncycles[1] = nswitches = 0;
+    }
+
+    void prep()
+    {
+        iport1.read(ival1);
+    }
+
+    void exec()
+    {
+        const size_t next = _crit(ival1, oval, cur);
+        if (next > SURROGATE)
+            SC_REPORT_ERROR(name(), "the criterion selected an unknown implementation");
+        if (next != cur)
+        {
+            if (_handover) _handover(cur, next);
+            cur = next;
+            nswitches++;
+        }
+        ncycles[cur]++;
+    }
+
+    void prod()
+    {
+        vport_out[cur]->write(ival1);
+        vport_in[cur]->read(oval);
+        write_multiport(oport1, oval);
+    }
+
+    void clean()
+    {
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! A criterion switching to the surrogate in a steady state
+/*! The surrogate is selected once neither the input nor the output
+ * has changed by more than tol for the given number of cycles, and the
+ * high-fidelity implementation is selected again as soon as the input
+ * changes by more than tol. The tokens should be numeric. Each criterion
+ * keeps its own history, hence it should be passed to a single process.
+ */
+template <class ITYP, class OTYP>
+inline typename multi_fidelity<ITYP,OTYP>::criterion_type steady_state_criterion(
+    double tol,         ///< the largest change in a steady state
+    size_t cycles       ///< the cycles in a steady state before switching
+    )
+{
+    struct history
+    {
+        abst_ext<ITYP> in;
+        abst_ext<OTYP> out;
+        size_t calm = 0;
+    };
+    auto h = std::make_shared<history>();
+    return [h, tol, cycles](const abst_ext<ITYP>& in, const abst_ext<OTYP>& out,
+                            size_t active) -> size_t
+    {
+        auto near = [tol](const auto& a, const auto& b)
+        {
+            if (is_absent(a) || is_absent(b)) return is_absent(a) && is_absent(b);
+            return std::abs(double(unsafe_from_abst_ext(a) - unsafe_from_abst_ext(b))) <= tol;
+        };
+        const bool in_calm = near(in, h->in);
+        const bool out_calm = near(out, h->out);
+        h->in = in;
+        h->out = out;
+        if (!in_calm)
+        {
+            h->calm = 0;
+            return multi_fidelity<ITYP,OTYP>::HIGH_FIDELITY;
+        }
+        if (active == multi_fidelity<ITYP,OTYP>::SURROGATE) return active;
+        h->calm = out_calm ? h->calm+1 : 0;
+        return h->calm >= cycles ? multi_fidelity<ITYP,OTYP>::SURROGATE : active;
+    };
+}
+
+//! Helper function to construct a multi_fidelity process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline multi_fidelity<T1,T0>* make_multi_fidelity(const std::string& pName,
+    const typename multi_fidelity<T1,T0>::criterion_type& crit,
+    const typename multi_fidelity<T1,T0>::handover_type& handover,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S
+    )
+{
+    auto p = new multi_fidelity<T1,T0>(pName.c_str(), crit, handover);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+}
+
+#ifndef FORSYDE_NO_SDF
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! Process constructor for an adaptive actor selecting from a function table
+/*! This class is used to build an SDF actor with one data input and one
+ * output whose function is selected, in each firing, from a table
+ * registered in the constructor by an index token read from the control
+ * input. Switching the function only changes the index, hence the
+ * actor can be reconfigured in every firing at no extra cost. It
+ * registers its port rates, so that it can be scheduled statically.
+ */
+template <typename T0, typename T1>
+class apply_select : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+    SDF_in<size_t> cport1;    ///< port for the function index channel
+    SDF_out<T0> oport1;       ///< port for the output channel
+    
+    //! Type of the functions to be passed to the process constructor
+    typedef std::function<void(std::vector<T0>&,
+                               const std::vector<T1>&)> functype;
+
+    //! The constructor requires the module name, the function table and the rates
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the selected function to it and writes the results using
+     * the output port
+     */
+    apply_select(sc_module_name _name,              ///< process name
+                 const std::vector<functype>& funcs,///< the function table
+                 unsigned int o1toks,               ///< production rate for the first output
+                 unsigned int i1toks                ///< consumption rate for the first input
+                ) : sdf_process(_name), iport1("iport1"), cport1("cport1"),
+                    oport1("oport1"), o1toks(o1toks), i1toks(i1toks), funcs(funcs)
+    {
+        add_in_rate(iport1, i1toks);
+        add_in_rate(cport1, 1);
+        add_out_rate(oport1, o1toks);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("funcs", funcs.size());
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::apply_select";}
+
+private:
+    // consumption rates
+    unsigned int o1toks, i1toks;
+    
+    // Inputs and output variables
+    std::vector<T0> o1vals;
+    std::vector<T1> i1vals;
+    size_t idx;
+    
+    //! The function table passed to the process constructor
+    std::vector<functype> funcs;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        o1vals.resize(o1toks);
+        i1vals.resize(i1toks);
+    }
+    
+    void prep()
+    {
+        idx = cport1.read();
+        if (idx >= funcs.size())
+            SC_REPORT_ERROR(name(), "the function index is out of the function table");
+        iport1.read_n(i1vals, i1vals.size());
+    }
+    
+    void exec()
+    {
+        funcs[idx](o1vals, i1vals);
+    }
+    
+    void prod()
+    {
+        write_vec_multiport(oport1, o1vals);
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &cport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct an apply_select actor
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+                    template <class> class CIf>
+inline apply_select<T0,T1>* make_apply_select(const std::string& pName,
+    const std::vector<typename apply_select<T0,T1>::functype>& funcs,
+    unsigned int o1toks,
+    unsigned int i1toks,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    CIf<size_t>& cS
+    )
+{
+    auto p = new apply_select<T0,T1>(pName.c_str(), funcs, o1toks, i1toks);
+    
+    (*p).iport1(inp1S);
+    (*p).cport1(cS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+}
+#endif
 }
 
 #endif
@@ -0,0 +1,290 @@
+/**********************************************************************
+    * alloc_tracker.hpp -- Heap allocations of the process stages     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Counting the allocations made by the prep, exec and    *
+    *          prod stages of each process                            *
+    *                                                                 *
+    * Usage:   Define FORSYDE_ALLOC_TRACKER to enable it              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+/*! \file alloc_tracker.hpp
+ * \brief Implements the tracking of the heap allocations of the processes
+ *
+ *  The hidden allocations of a firing (copies of std::function objects,
+ * growing vectors, temporaries of the matrix types, ...) are often the
+ * largest cost of the light processes. This file replaces the global
+ * operator new and operator delete with versions which count, besides
+ * allocating with malloc, the allocations and their bytes and the
+ * deallocations into the record of the stage running on the calling
+ * thread. Each stage of a firing sets the running stage like the
+ * timeline does.
+ *
+ *  The records are written at the end of the simulation as a CSV file
+ * with one row per process. The allocations made after the first firing
+ * of a process are also counted separately, which should be zero for a
+ * process without any steady-state allocation. The allocations made
+ * outside the stages (e.g., by the elaboration or the SystemC kernel)
+ * are reported in a row named [outside].
+ *
+ *  The replacement operators are defined in this header, hence in a
+ * program of several translation units including ForSyDe, all except one
+ * of them should define FORSYDE_ALLOC_TRACKER_NO_HOOKS.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+//! The output file of the allocation tracker
+#ifndef FORSYDE_ALLOC_FILE
+#define FORSYDE_ALLOC_FILE "forsyde_allocs.csv"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The heap allocations of the stages of a process
+struct alloc_info
+{
+    //! The stages of a firing
+    enum stage_kind : std::uint8_t {PREP, EXEC, PROD};
+
+    //! The firings which have started
+    unsigned long long firings = 0;
+    //! The allocations made by each stage
+    std::uint64_t allocs[3] = {0, 0, 0};
+    //! The bytes allocated by each stage
+    std::uint64_t bytes[3] = {0, 0, 0};
+    //! The deallocations made by each stage
+    std::uint64_t frees[3] = {0, 0, 0};
+    //! The allocations made after the first firing
+    std::uint64_t steady_allocs = 0;
+    //! The bytes allocated after the first firing
+    std::uint64_t steady_bytes = 0;
+
+    //! The allocations made by all the stages
+    std::uint64_t total_allocs() const {return allocs[0] + allocs[1] + allocs[2];}
+};
+
+//! The stage running on the calling OS thread
+struct alloc_site
+{
+    alloc_info* info;               ///< the record of the running process
+    alloc_info::stage_kind stage;   ///< the running stage
+};
+
+//! Returns the stage running on the calling thread, or a NULL record outside the stages
+/*! A trivially initialized thread-local variable, so that it can be read
+ * by operator new before any other initialization.
+ */
+inline alloc_site& current_alloc_site()
+{
+    static thread_local alloc_site site = {NULL, alloc_info::PREP};
+    return site;
+}
+
+//! The allocations made outside the stages, by all the threads
+struct outside_allocs
+{
+    std::atomic<std::uint64_t> allocs{0};
+    std::atomic<std::uint64_t> bytes{0};
+    std::atomic<std::uint64_t> frees{0};
+};
+
+//! Returns the counters of the allocations made outside the stages
+inline outside_allocs& outside_alloc_counts()
+{
+    // constant initialized, hence usable by the allocations of the static
+    // initialization
+    static outside_allocs counts;
+    return counts;
+}
+
+//! Counts an allocation in the running stage
+inline void count_alloc(std::size_t size)
+{
+    const alloc_site& s = current_alloc_site();
+    if (s.info == NULL)
+    {
+        outside_allocs& o = outside_alloc_counts();
+        o.allocs.fetch_add(1, std::memory_order_relaxed);
+        o.bytes.fetch_add(size, std::memory_order_relaxed);
+        return;
+    }
+    s.info->allocs[s.stage]++;
+    s.info->bytes[s.stage] += size;
+    if (s.info->firings > 1)
+    {
+        s.info->steady_allocs++;
+        s.info->steady_bytes += size;
+    }
+}
+
+//! Counts a deallocation in the running stage
+inline void count_free()
+{
+    const alloc_site& s = current_alloc_site();
+    if (s.info == NULL)
+        outside_alloc_counts().frees.fetch_add(1, std::memory_order_relaxed);
+    else
+        s.info->frees[s.stage]++;
+}
+
+//! Marks a stage of a firing as running from its construction to its destruction
+/*! The previous stage is restored at the end, hence a process fired by
+ * another one is charged for its own allocations only.
+ */
+class alloc_stage
+{
+public:
+    alloc_stage(alloc_info& info, alloc_info::stage_kind stage)
+        : prev(current_alloc_site())
+    {
+        if (stage == alloc_info::PREP) info.firings++;
+        current_alloc_site() = alloc_site{&info, stage};
+    }
+
+    ~alloc_stage() {current_alloc_site() = prev;}
+
+private:
+    alloc_site prev;
+};
+
+//! Collects the allocation records of all the processes
+/*! Each process enrolls in the constructor and reports its record at the
+ * end of the simulation. The output file is written once all the
+ * enrolled processes have reported.
+ */
+class alloc_tracker
+{
+public:
+    //! Returns the single instance of the tracker
+    static alloc_tracker& get()
+    {
+        static alloc_tracker at;
+        return at;
+    }
+
+    //! Sets the output file
+    void set_output(const std::string& file_name) {out_file = file_name;}
+
+    //! Registers a process which will report at the end of the simulation
+    void enroll() {enrolled++;}
+
+    //! Reports the record of a process
+    void report(const std::string& name, const std::string& kind,
+                const alloc_info& info)
+    {
+        rows.push_back(row{name, kind, info});
+        if (rows.size() == enrolled) write();
+    }
+
+private:
+    struct row
+    {
+        std::string name, kind;
+        alloc_info info;
+    };
+
+    std::string out_file;
+    size_t enrolled;
+    std::vector<row> rows;
+
+    alloc_tracker() : out_file(FORSYDE_ALLOC_FILE), enrolled(0) {}
+
+    void write()
+    {
+        std::ofstream ofs(out_file);
+        if (!ofs.is_open())
+        {
+            SC_REPORT_ERROR(out_file.c_str(), "file could not be opened to write the allocations");
+            return;
+        }
+        ofs << "process,kind,firings,prep_allocs,prep_bytes,prep_frees,"
+            << "exec_allocs,exec_bytes,exec_frees,prod_allocs,prod_bytes,prod_frees,"
+            << "steady_allocs,steady_bytes" << std::endl;
+        for (auto& r : rows)
+        {
+            ofs << r.name << "," << r.kind << "," << r.info.firings;
+            for (int s=0; s<3; s++)
+                ofs << "," << r.info.allocs[s] << "," << r.info.bytes[s]
+                    << "," << r.info.frees[s];
+            ofs << "," << r.info.steady_allocs << "," << r.info.steady_bytes << std::endl;
+        }
+        const outside_allocs& o = outside_alloc_counts();
+        ofs << "[outside],,0," << o.allocs.load(std::memory_order_relaxed) << ","
+            << o.bytes.load(std::memory_order_relaxed) << ","
+            << o.frees.load(std::memory_order_relaxed) << ",0,0,0,0,0,0,0,0" << std::endl;
+    }
+};
+
+}
+
+#ifndef FORSYDE_ALLOC_TRACKER_NO_HOOKS
+
+//! Allocates with malloc and counts the allocation
+inline void* forsyde_tracked_alloc(std::size_t size)
+{
+    ForSyDe::count_alloc(size);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+//! Allocates an aligned block and counts the allocation
+inline void* forsyde_tracked_alloc(std::size_t size, std::align_val_t al)
+{
+    ForSyDe::count_alloc(size);
+    const std::size_t a = static_cast<std::size_t>(al);
+    // aligned_alloc requires a multiple of the alignment
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a + (size ? 0 : a))) return p;
+    throw std::bad_alloc();
+}
+
+//! Counts the deallocation and frees the block
+inline void forsyde_tracked_free(void* p) noexcept
+{
+    if (p == NULL) return;
+    ForSyDe::count_free();
+    std::free(p);
+}
+
+void* operator new(std::size_t size) {return forsyde_tracked_alloc(size);}
+void* operator new[](std::size_t size) {return forsyde_tracked_alloc(size);}
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {return forsyde_tracked_alloc(size);} catch (...) {return NULL;}
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept
+{
+    try {return forsyde_tracked_alloc(size);} catch (...) {return NULL;}
+}
+void* operator new(std::size_t size, std::align_val_t al) {return forsyde_tracked_alloc(size, al);}
+void* operator new[](std::size_t size, std::align_val_t al) {return forsyde_tracked_alloc(size, al);}
+
+void operator delete(void* p) noexcept {forsyde_tracked_free(p);}
+void operator delete[](void* p) noexcept {forsyde_tracked_free(p);}
+void operator delete(void* p, std::size_t) noexcept {forsyde_tracked_free(p);}
+void operator delete[](void* p, std::size_t) noexcept {forsyde_tracked_free(p);}
+void operator delete(void* p, const std::nothrow_t&) noexcept {forsyde_tracked_free(p);}
+void operator delete[](void* p, const std::nothrow_t&) noexcept {forsyde_tracked_free(p);}
+void operator delete(void* p, std::align_val_t) noexcept {forsyde_tracked_free(p);}
+void operator delete[](void* p, std::align_val_t) noexcept {forsyde_tracked_free(p);}
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept {forsyde_tracked_free(p);}
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept {forsyde_tracked_free(p);}
+
+#endif
+
+#endif
@@ -0,0 +1,351 @@
+/**********************************************************************
+    * arena.hpp -- An arena for the objects of a model                *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Allocating the processes and the signal buffers of a   *
+    *          model contiguously and releasing them at once          *
+    *                                                                 *
+    * Usage:   Define FORSYDE_ARENA to enable it                      *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ARENA_HPP
+#define ARENA_HPP
+
+/*! \file arena.hpp
+ * \brief Implements the elaboration arena
+ *
+ *  This file includes a monotonic arena in which the processes created
+ * during the elaboration (e.g., by the make_* helpers) and the buffers
+ * of the spsc_fifo signals are allocated, in the order of their
+ * creation, while an arena_scope is active:
+ *
+ *     int sc_main(int argc, char** argv)
+ *     {
+ *         ForSyDe::elab_arena arena;
+ *         top* t;
+ *         {
+ *             ForSyDe::arena_scope scope(arena);
+ *             t = new top("top");
+ *         }
+ *         sc_start();
+ *         ...
+ *
+ *  The arena releases the processes allocated in it when it is released
+ * or destroyed, which destructs them in the reverse order of their
+ * creation and frees the memory in a few large blocks instead of one
+ * object at a time. The arena should therefore outlive the signals and
+ * the modules which use its objects, e.g., by declaring it first.
+ */
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <algorithm>
+#ifdef FORSYDE_NUMA
+#include "numa.hpp"
+#endif
+
+//! The size of the blocks allocated by the arenas in bytes
+#ifndef FORSYDE_ARENA_BLOCK
+#define FORSYDE_ARENA_BLOCK (1 << 20)
+#endif
+
+namespace ForSyDe
+{
+
+//! A monotonic arena for the objects of a model
+/*! The memory is taken from large blocks by bumping a pointer and is
+ * only returned when the whole arena is released. The objects adopted by
+ * the arena are destructed at that point.
+ */
+class elab_arena
+{
+public:
+    //! The constructor takes the size of the blocks
+    explicit elab_arena(size_t block_size=FORSYDE_ARENA_BLOCK)
+        : block_size(block_size), pos(NULL), end(NULL), used_bytes(0)
+    {
+        arenas().push_back(this);
+    }
+
+    elab_arena(const elab_arena&) = delete;
+    elab_arena& operator=(const elab_arena&) = delete;
+
+    ~elab_arena()
+    {
+        release();
+        auto& all = arenas();
+        all.erase(std::remove(all.begin(), all.end(), this), all.end());
+        if (current() == this) current() = NULL;
+    }
+
+    //! Allocates a number of bytes with the given alignment
+    void* allocate(size_t size, size_t align=alignof(std::max_align_t))
+    {
+        std::uintptr_t p = (reinterpret_cast<std::uintptr_t>(pos) + align - 1) & ~(align - 1);
+        if (pos == NULL || p + size > reinterpret_cast<std::uintptr_t>(end))
+        {
+            // objects larger than a block get a block of their own
+            const size_t bytes = std::max(block_size, size + align);
+            char* block = static_cast<char*>(new_block(bytes));
+            blocks.push_back({block, bytes});
+            pos = block;
+            end = block + bytes;
+            p = (reinterpret_cast<std::uintptr_t>(pos) + align - 1) & ~(align - 1);
+        }
+        pos = reinterpret_cast<char*>(p + size);
+        used_bytes += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    //! Makes the arena responsible for destructing an object allocated in it
+    template <typename T>
+    void adopt(void* mem, T* obj)
+    {
+        owned.push_back({mem, obj, [](void* o) {static_cast<T*>(o)->~T();}});
+    }
+
+    //! Stops destructing an object, e.g., when it is deleted explicitly
+    void disown(void* mem)
+    {
+        for (auto it=owned.rbegin(); it!=owned.rend(); ++it)
+            if (it->mem == mem)
+            {
+                owned.erase(std::next(it).base());
+                return;
+            }
+    }
+
+    //! Destructs the adopted objects and frees all the memory
+    void release()
+    {
+        // the objects are destructed in the reverse order of creation
+        while (!owned.empty())
+        {
+            entry e = owned.back();
+            owned.pop_back();
+            e.destroy(e.obj);
+        }
+        for (auto& b : blocks) free_block(b.first);
+        blocks.clear();
+        pos = end = NULL;
+        used_bytes = 0;
+    }
+
+#ifdef FORSYDE_NUMA
+    //! Places the blocks allocated afterwards on a NUMA node
+    /*! A negative node returns to the heap. The blocks already allocated
+     * stay where they are.
+     */
+    void set_node(int n, huge_pages h=TRANSPARENT_HUGE_PAGES)
+    {
+        node = n;
+        huge = h;
+        pos = end = NULL;
+    }
+#endif
+
+    //! Checks if an address is in the memory of the arena
+    bool owns(const void* p) const
+    {
+        const char* c = static_cast<const char*>(p);
+        for (auto& b : blocks)
+            if (c >= b.first && c < b.first + b.second) return true;
+        return false;
+    }
+
+    //! The number of bytes allocated in the arena
+    size_t used() const {return used_bytes;}
+
+    //! The number of bytes reserved by the arena
+    size_t reserved() const
+    {
+        size_t res = 0;
+        for (auto& b : blocks) res += b.second;
+        return res;
+    }
+
+    //! Allocates an object in the current arena, or on the heap without one
+    /*! It is called by the operator new of the classes allocated in the
+     * arenas, whose constructors then call adopt_pending().
+     */
+    static void* allocate_object(size_t size)
+    {
+        elab_arena* a = current();
+        if (a == NULL) return ::operator new(size);
+        void* mem = a->allocate(size);
+        pending() = {a, static_cast<char*>(mem), size};
+        return mem;
+    }
+
+    //! Adopts an object being constructed in the memory of allocate_object()
+    /*! The object may be a base class subobject of the allocated one.
+     */
+    template <typename T>
+    static void adopt_pending(T* obj)
+    {
+        pending_alloc& p = pending();
+        const char* c = reinterpret_cast<const char*>(obj);
+        if (p.arena && c >= p.mem && c < p.mem + p.size)
+            p.arena->adopt(p.mem, obj);
+        p.arena = NULL;
+    }
+
+    //! Frees an object allocated by allocate_object()
+    static void free_object(void* mem)
+    {
+        if (elab_arena* a = owner(mem))
+            a->disown(mem);
+        else
+            ::operator delete(mem);
+    }
+
+    //! The arena in which the objects are currently allocated, if any
+    static elab_arena*& current()
+    {
+        thread_local elab_arena* arena = NULL;
+        return arena;
+    }
+
+    //! Returns the arena which owns an address, if any
+    static elab_arena* owner(const void* p)
+    {
+        for (auto a : arenas())
+            if (a->owns(p)) return a;
+        return NULL;
+    }
+
+private:
+    struct entry
+    {
+        void* mem;
+        void* obj;
+        void (*destroy)(void*);
+    };
+
+    size_t block_size;
+    std::vector<std::pair<char*,size_t>> blocks;
+    char* pos;
+    char* end;
+    size_t used_bytes;
+    std::vector<entry> owned;
+#ifdef FORSYDE_NUMA
+    int node = -1;
+    huge_pages huge = NO_HUGE_PAGES;
+    // the blocks allocated on a node
+    std::vector<char*> node_blocks;
+#endif
+
+    //! Allocates a block from the heap, or on the node of the arena
+    void* new_block(size_t bytes)
+    {
+#ifdef FORSYDE_NUMA
+        if (node >= 0)
+        {
+            void* b = numa_alloc(bytes, node, huge);
+            if (b == NULL) throw std::bad_alloc();
+            node_blocks.push_back(static_cast<char*>(b));
+            return b;
+        }
+#endif
+        return ::operator new(bytes);
+    }
+
+    void free_block(char* b)
+    {
+#ifdef FORSYDE_NUMA
+        auto it = std::find(node_blocks.begin(), node_blocks.end(), b);
+        if (it != node_blocks.end())
+        {
+            node_blocks.erase(it);
+            numa_free(b);
+            return;
+        }
+#endif
+        ::operator delete(b);
+    }
+
+    // the last allocation of the calling thread, which is not yet adopted
+    struct pending_alloc
+    {
+        elab_arena* arena;
+        char* mem;
+        size_t size;
+    };
+
+    static pending_alloc& pending()
+    {
+        thread_local pending_alloc p = {NULL, NULL, 0};
+        return p;
+    }
+
+    static std::vector<elab_arena*>& arenas()
+    {
+        static std::vector<elab_arena*> all;
+        return all;
+    }
+};
+
+//! Makes an arena the current one during its lifetime
+class arena_scope
+{
+public:
+    explicit arena_scope(elab_arena& arena) : prev(elab_arena::current())
+    {
+        elab_arena::current() = &arena;
+    }
+
+    ~arena_scope() {elab_arena::current() = prev;}
+
+    arena_scope(const arena_scope&) = delete;
+    arena_scope& operator=(const arena_scope&) = delete;
+
+private:
+    elab_arena* prev;
+};
+
+//! An allocator which takes the memory from the arena current at its construction
+/*! Without a current arena it uses the heap. The memory allocated in an
+ * arena is not returned before the arena is released.
+ */
+template <typename T>
+class arena_allocator
+{
+public:
+    typedef T value_type;
+
+    arena_allocator() : arena(elab_arena::current()) {}
+
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) : arena(other.arena) {}
+
+    T* allocate(size_t n)
+    {
+        if (arena) return static_cast<T*>(arena->allocate(n*sizeof(T), alignof(T)));
+        return static_cast<T*>(::operator new(n*sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t)
+    {
+        if (arena == NULL) ::operator delete(p);
+    }
+
+    template <typename U>
+    bool operator==(const arena_allocator<U>& other) const {return arena == other.arena;}
+
+    template <typename U>
+    bool operator!=(const arena_allocator<U>& other) const {return arena != other.arena;}
+
+private:
+    elab_arena* arena;
+
+    template <typename U> friend class arena_allocator;
+};
+
+}
+
+#endif
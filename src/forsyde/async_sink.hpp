@@ -0,0 +1,244 @@
+/**********************************************************************
+    * async_sink.hpp -- Running the functions of sinks in background  *
+    *                   threads                                       *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Keeping slow sink functions (logging, statistics,      *
+    *          publishing) off the simulation thread                  *
+    *                                                                 *
+    * Usage:   Included by the process constructors of the sinks      *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ASYNC_SINK_HPP
+#define ASYNC_SINK_HPP
+
+/*! \file async_sink.hpp
+ * \brief Implements the background consumers of the asynchronous sinks
+ *
+ *  A sink normally calls its function on the simulation thread, so a
+ * function which writes a log, updates statistics or publishes the
+ * tokens on a socket stalls the whole kernel. After set_async() is
+ * called on a sink (SY, SDF, DDE, DT or UT), its tokens are pushed into
+ * a bounded lock-free queue and the function runs on a worker thread of
+ * its own:
+ *
+ *     auto snk = SY::make_sink("log", log_func, sig);
+ *     snk->set_async(4096, ASYNC_DROP);
+ *
+ * When the queue is full the simulation thread waits for the worker
+ * (ASYNC_BLOCK), drops the token (ASYNC_DROP) or keeps only the latest
+ * token until there is room again (ASYNC_COALESCE). The queue is flushed
+ * by the clean stage of the sink, i.e., at the end of the simulation and
+ * when the model is reset. The function should not access the model,
+ * since it runs concurrently with the simulation.
+ */
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <exception>
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! What a sink does with a token when its queue is full
+enum async_backpressure
+{
+    ASYNC_BLOCK,        ///< the simulation thread waits for room in the queue
+    ASYNC_DROP,         ///< the token is dropped
+    ASYNC_COALESCE      ///< the token replaces the one waiting for room, if any
+};
+
+//! A bounded queue of tokens consumed by a function in a worker thread
+/*! The queue is a single-producer single-consumer ring buffer whose
+ * capacity is rounded up to a power of two, hence a push only costs a
+ * copy and two atomic accesses. The worker spins briefly when the queue
+ * is empty and then sleeps until the producer wakes it.
+ */
+template <typename T>
+class async_consumer
+{
+public:
+    async_consumer(const std::string& name,             ///< the name used in the reports
+                   const std::function<void(const T&)>& func,
+                   size_t capacity,                     ///< the capacity of the queue
+                   async_backpressure policy            ///< the policy of a full queue
+                   )
+        : name(name), func(func), policy(policy)
+    {
+        size_t cap = 2;
+        while (cap < capacity) cap <<= 1;
+        buf.resize(cap);
+        mask = cap - 1;
+        worker = std::thread(&async_consumer::run, this);
+    }
+
+    //! Drains the queue and stops the worker
+    ~async_consumer()
+    {
+        drain();
+        stop.store(true, std::memory_order_release);
+        wake();
+        worker.join();
+    }
+
+    async_consumer(const async_consumer&) = delete;
+    async_consumer& operator=(const async_consumer&) = delete;
+
+    //! Passes a token to the worker, applying the policy if the queue is full
+    void push(const T& tok)
+    {
+        if (held)
+        {
+            if (!try_push(*held))
+            {
+                // the waiting token is replaced by the newer one
+                *held = tok;
+                coalesced++;
+                return;
+            }
+            held.reset();
+        }
+        if (try_push(tok)) return;
+        switch (policy)
+        {
+        case ASYNC_BLOCK:
+            while (!try_push(tok)) std::this_thread::yield();
+            break;
+        case ASYNC_DROP:
+            dropped++;
+            break;
+        case ASYNC_COALESCE:
+            held.reset(new T(tok));
+            break;
+        }
+    }
+
+    //! Waits until the worker has consumed all the pushed tokens
+    /*! The errors thrown by the function meanwhile are reported here, on
+     * the simulation thread.
+     */
+    void flush()
+    {
+        drain();
+        std::string err;
+        {
+            std::lock_guard<std::mutex> lk(m);
+            err.swap(error);
+        }
+        if (!err.empty()) SC_REPORT_ERROR(name.c_str(), err.c_str());
+    }
+
+    //! The number of tokens dropped because the queue was full
+    size_t dropped_tokens() const {return dropped;}
+
+    //! The number of tokens replaced by newer ones because the queue was full
+    size_t coalesced_tokens() const {return coalesced;}
+
+private:
+    std::string name;
+    std::function<void(const T&)> func;
+    async_backpressure policy;
+
+    std::vector<T> buf;
+    size_t mask;
+    // the next slot to read, the next slot to write and the consumed tokens
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) std::atomic<size_t> done{0};
+    std::atomic<bool> sleeping{false}, stop{false};
+
+    std::unique_ptr<T> held;
+    size_t dropped = 0, coalesced = 0;
+
+    std::thread worker;
+    std::mutex m;
+    std::condition_variable cv;
+    std::string error;
+
+    //! Pushes the waiting token and waits until the worker has consumed all the tokens
+    void drain()
+    {
+        if (held)
+        {
+            while (!try_push(*held)) std::this_thread::yield();
+            held.reset();
+        }
+        while (done.load(std::memory_order_acquire) != tail.load(std::memory_order_relaxed))
+        {
+            wake();
+            std::this_thread::yield();
+        }
+    }
+
+    bool try_push(const T& tok)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) > mask) return false;
+        buf[t & mask] = tok;
+        tail.store(t+1, std::memory_order_release);
+        if (sleeping.load(std::memory_order_acquire)) wake();
+        return true;
+    }
+
+    void wake()
+    {
+        std::lock_guard<std::mutex> lk(m);
+        cv.notify_one();
+    }
+
+    //! The main loop of the worker
+    void run()
+    {
+        unsigned idle = 0;
+        while (true)
+        {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if (h == tail.load(std::memory_order_acquire))
+            {
+                if (stop.load(std::memory_order_acquire)) return;
+                if (++idle < 1024)
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                // the timeout bounds the delay of a missed wake-up
+                std::unique_lock<std::mutex> lk(m);
+                sleeping.store(true, std::memory_order_release);
+                if (h == tail.load(std::memory_order_acquire) &&
+                    !stop.load(std::memory_order_acquire))
+                    cv.wait_for(lk, std::chrono::milliseconds(1));
+                sleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            idle = 0;
+            const T tok = buf[h & mask];
+            head.store(h+1, std::memory_order_release);
+            try
+            {
+                func(tok);
+            }
+            catch (const std::exception& e)
+            {
+                std::lock_guard<std::mutex> lk(m);
+                if (error.empty()) error = e.what();
+            }
+            done.store(h+1, std::memory_order_release);
+        }
+    }
+};
+
+}
+
+#endif
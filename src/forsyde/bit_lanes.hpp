@@ -0,0 +1,276 @@
+/**********************************************************************
+    * bit_lanes.hpp -- Bit-packed boolean tokens                      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Storing many absent-extended booleans in machine       *
+    *          words and evaluating logic over all of them at once    *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef BIT_LANES_HPP
+#define BIT_LANES_HPP
+
+/*! \file bit_lanes.hpp
+ * \brief Implements the bit-packed boolean tokens and their logic
+ *
+ *  A digital model with a signal per wire passes an abst_ext<bool>
+ * through a FIFO per wire and tick. A bit_lanes<N> token packs N
+ * absent-extended booleans, called lanes, into the bits of 64-bit words,
+ * with a separate presence mask. The lanes can be N wires of a bus, or N
+ * ticks of a single wire, or N copies of a circuit with different
+ * stimuli. The logic below evaluates 64 lanes per word operation.
+ *
+ *  A lane of a result is present only if the lanes it depends on are
+ * present, and the absent lanes always hold a zero bit. A multi-bit
+ * unsigned number per lane is stored bit-sliced as bit_planes<N,W>, an
+ * array of W bit_lanes with the least significant plane first, which
+ * the comparisons and multiplexers below handle one plane at a time.
+ */
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <bitset>
+#include <iostream>
+
+#include "abst_ext.hpp"
+
+namespace ForSyDe
+{
+
+//! N absent-extended booleans packed in 64-bit words
+template <std::size_t N=64>
+class bit_lanes
+{
+public:
+    //! The number of 64-bit words of the bits and of the presence mask
+    static constexpr std::size_t words = (N+63)/64;
+
+    //! The default constructor, with all the lanes absent
+    bit_lanes() : bits(), mask() {}
+
+    //! Sets all the lanes present with the same value
+    explicit bit_lanes(bool val) : bit_lanes()
+    {
+        for (std::size_t w=0; w<words; w++)
+        {
+            mask[w] = valid(w);
+            bits[w] = val ? mask[w] : 0;
+        }
+    }
+
+    //! The number of lanes
+    static constexpr std::size_t size() {return N;}
+
+    //! The bits of the lanes which exist in a word
+    static constexpr std::uint64_t valid(std::size_t w)
+    {
+        return w+1 < words || N%64 == 0 ? ~std::uint64_t(0)
+                                        : (std::uint64_t(1) << (N%64)) - 1;
+    }
+
+    //! Checks for the presence of a lane
+    bool is_present(std::size_t i) const
+    {
+        return (mask[i/64] >> (i%64)) & 1;
+    }
+
+    //! Reads a lane
+    abst_ext<bool> get(std::size_t i) const
+    {
+        return is_present(i) ? abst_ext<bool>((bits[i/64] >> (i%64)) & 1)
+                             : abst_ext<bool>();
+    }
+
+    //! Writes a lane
+    void set(std::size_t i, const abst_ext<bool>& val)
+    {
+        const std::uint64_t b = std::uint64_t(1) << (i%64);
+        if (val.is_present())
+        {
+            mask[i/64] |= b;
+            if (val.unsafe_from_abst_ext()) bits[i/64] |= b;
+            else bits[i/64] &= ~b;
+        }
+        else
+        {
+            mask[i/64] &= ~b;
+            bits[i/64] &= ~b;
+        }
+    }
+
+    //! Reads a lane
+    abst_ext<bool> operator[](std::size_t i) const {return get(i);}
+
+    //! The number of present lanes
+    std::size_t count() const
+    {
+        std::size_t n = 0;
+        for (auto w : mask) n += std::bitset<64>(w).count();
+        return n;
+    }
+
+    //! The number of present lanes which are true
+    std::size_t count_true() const
+    {
+        std::size_t n = 0;
+        for (auto w : bits) n += std::bitset<64>(w).count();
+        return n;
+    }
+
+    //! Checks if all the lanes are absent
+    bool all_absent() const
+    {
+        for (auto w : mask) if (w) return false;
+        return true;
+    }
+
+    //! The words of the bits, bit i%64 of word i/64 for lane i
+    const std::array<std::uint64_t,words>& value() const {return bits;}
+
+    //! The words of the presence mask
+    const std::array<std::uint64_t,words>& presence() const {return mask;}
+
+    //! Writes a word of bits and presence, clearing the absent bits
+    void set_word(std::size_t w, std::uint64_t b, std::uint64_t m)
+    {
+        mask[w] = m & valid(w);
+        bits[w] = b & mask[w];
+    }
+
+    //! Checks for the equivalence of two tokens
+    bool operator==(const bit_lanes& rs) const
+    {
+        return mask == rs.mask && bits == rs.bits;
+    }
+
+    //! Overload the streaming operator to enable SystemC communiation
+    friend std::ostream& operator<<(std::ostream& os, const bit_lanes& bl)
+    {
+        os << "[";
+        for (std::size_t i=0; i<N; i++)
+            os << (!bl.is_present(i) ? '-' : bl.get(i).unsafe_from_abst_ext() ? '1' : '0');
+        os << "]";
+        return os;
+    }
+
+private:
+    std::array<std::uint64_t,words> bits;
+    std::array<std::uint64_t,words> mask;
+};
+
+//! W-bit unsigned numbers in N lanes, stored bit-sliced
+template <std::size_t N, std::size_t W>
+using bit_planes = std::array<bit_lanes<N>,W>;
+
+//! The two-input logic operations of the bit-parallel gates
+enum class bit_op {AND, OR, XOR, NAND, NOR, XNOR};
+
+//! Applies a two-input logic operation to all the lanes
+template <std::size_t N>
+inline bit_lanes<N> bit_apply(bit_op op, const bit_lanes<N>& a, const bit_lanes<N>& b)
+{
+    bit_lanes<N> res;
+    for (std::size_t w=0; w<bit_lanes<N>::words; w++)
+    {
+        const std::uint64_t x = a.value()[w], y = b.value()[w];
+        std::uint64_t r = 0;
+        switch (op)
+        {
+            case bit_op::AND:  r = x & y; break;
+            case bit_op::OR:   r = x | y; break;
+            case bit_op::XOR:  r = x ^ y; break;
+            case bit_op::NAND: r = ~(x & y); break;
+            case bit_op::NOR:  r = ~(x | y); break;
+            case bit_op::XNOR: r = ~(x ^ y); break;
+        }
+        res.set_word(w, r, a.presence()[w] & b.presence()[w]);
+    }
+    return res;
+}
+
+template <std::size_t N>
+inline bit_lanes<N> operator&(const bit_lanes<N>& a, const bit_lanes<N>& b)
+{
+    return bit_apply(bit_op::AND, a, b);
+}
+
+template <std::size_t N>
+inline bit_lanes<N> operator|(const bit_lanes<N>& a, const bit_lanes<N>& b)
+{
+    return bit_apply(bit_op::OR, a, b);
+}
+
+template <std::size_t N>
+inline bit_lanes<N> operator^(const bit_lanes<N>& a, const bit_lanes<N>& b)
+{
+    return bit_apply(bit_op::XOR, a, b);
+}
+
+//! Negates all the present lanes
+template <std::size_t N>
+inline bit_lanes<N> operator~(const bit_lanes<N>& a)
+{
+    bit_lanes<N> res;
+    for (std::size_t w=0; w<bit_lanes<N>::words; w++)
+        res.set_word(w, ~a.value()[w], a.presence()[w]);
+    return res;
+}
+
+//! Selects the lanes of a where sel is true and of b where it is false
+template <std::size_t N>
+inline bit_lanes<N> bit_mux(const bit_lanes<N>& sel, const bit_lanes<N>& a,
+                            const bit_lanes<N>& b)
+{
+    bit_lanes<N> res;
+    for (std::size_t w=0; w<bit_lanes<N>::words; w++)
+    {
+        const std::uint64_t s = sel.value()[w];
+        res.set_word(w, (s & a.value()[w]) | (~s & b.value()[w]),
+                     sel.presence()[w] & ((s & a.presence()[w]) | (~s & b.presence()[w])));
+    }
+    return res;
+}
+
+//! Selects the numbers of a where sel is true and of b where it is false
+template <std::size_t N, std::size_t W>
+inline bit_planes<N,W> bit_mux(const bit_lanes<N>& sel, const bit_planes<N,W>& a,
+                               const bit_planes<N,W>& b)
+{
+    bit_planes<N,W> res;
+    for (std::size_t k=0; k<W; k++) res[k] = bit_mux(sel, a[k], b[k]);
+    return res;
+}
+
+//! Compares the unsigned numbers of two bit-sliced operands in all the lanes
+/*! The lanes of gt are true where a > b and the lanes of eq where
+ * a == b. The planes are scanned from the most significant one, and a
+ * lane is only present if all the planes of both operands are present
+ * in it.
+ */
+template <std::size_t N, std::size_t W>
+inline void bit_compare(const bit_planes<N,W>& a, const bit_planes<N,W>& b,
+                        bit_lanes<N>& gt, bit_lanes<N>& eq)
+{
+    for (std::size_t w=0; w<bit_lanes<N>::words; w++)
+    {
+        std::uint64_t g = 0, e = ~std::uint64_t(0), m = ~std::uint64_t(0);
+        for (std::size_t k=W; k-->0;)
+        {
+            const std::uint64_t x = a[k].value()[w], y = b[k].value()[w];
+            g |= e & x & ~y;
+            e &= ~(x ^ y);
+            m &= a[k].presence()[w] & b[k].presence()[w];
+        }
+        gt.set_word(w, g, m);
+        eq.set_word(w, e, m);
+    }
+}
+
+}
+
+#endif
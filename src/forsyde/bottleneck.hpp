@@ -0,0 +1,364 @@
+/**********************************************************************
+    * bottleneck.hpp -- Critical-path and bottleneck analysis         *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Reporting the critical cycle, the occupancy of the     *
+    *          signals and the blocking processes after a simulation  *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION and FORSYDE_PROFILE to    *
+    *          use it                                                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef BOTTLENECK_HPP
+#define BOTTLENECK_HPP
+
+/*! \file bottleneck.hpp
+ * \brief Implements the runtime bottleneck analysis of a model
+ *
+ *  This file includes an analysis which combines the process graph with
+ * the profiling information collected during the simulation. It reports
+ * the critical cycle of the model (the maximum cycle mean), the
+ * occupancy histograms of the signals and the processes which block the
+ * others most, in an XML file next to the introspection output, e.g.:
+ *
+ *     bottleneck_monitor monitor("monitor", "gen/");
+ */
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <functional>
+#include <cstdlib>
+
+#include "process_graph.hpp"
+#include "sdf_buffers.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The bottleneck analysis of a simulated model
+/*! The critical cycle is computed on the signals with fixed rates (SY
+ * and SDF), where each process is weighted by its repetitions in a graph
+ * iteration times its mean execution time per firing, and each signal
+ * by its initial tokens (the SY delays have one, or n for delayn). The
+ * maximum cycle mean is the execution time of the slowest cycle per
+ * graph iteration, which bounds the throughput of the model.
+ *
+ * The time a process is blocked reading an empty signal is charged to
+ * the producer of the signal (starvation), and the time it is blocked
+ * writing a full signal to its consumer (back-pressure). These apply to
+ * all the MoCs, including SADF.
+ */
+class bottleneck_report
+{
+public:
+    //! The bottleneck information of a process
+    struct process_entry
+    {
+        size_t node;                ///< the node in the process graph
+        unsigned long long firings; ///< the completed evaluation cycles
+        double exec_time;           ///< mean wall-clock time per firing
+        //! Time the other processes were blocked by this process
+        sc_time blocking_time;
+        //! Delta cycles the other processes were blocked by this process
+        unsigned long long blocking_deltas;
+    };
+
+    //! The bottleneck information of a signal
+    struct signal_entry
+    {
+        size_t edge;                ///< the edge in the process graph
+        //! Time the consumer was blocked waiting for the producer
+        sc_time starved_time;
+        unsigned long long starved_deltas;
+        //! Time the producer was blocked waiting for the consumer
+        sc_time backpressure_time;
+        unsigned long long backpressure_deltas;
+        //! Histogram of the occupancy after each production
+        std::vector<unsigned long long> occupancy;
+    };
+
+    //! Builds the report from a process graph after the simulation
+    explicit bottleneck_report(const process_graph& g) : g(g), mcm(0), zero_delay(false)
+    {
+        for (size_t n=0; n<g.nodes().size(); n++)
+        {
+            const profile_info& p = g.nodes()[n].proc->prof;
+            procs.push_back({n, p.firings, p.firings ? p.exec_time/p.firings : 0,
+                             SC_ZERO_TIME, 0});
+        }
+        for (size_t e=0; e<g.edges().size(); e++)
+        {
+            auto& ed = g.edges()[e];
+            signal_entry se{e, SC_ZERO_TIME, 0, SC_ZERO_TIME, 0, {}};
+            if (const port_profile* pp = find_port(ed.dst, ed.dst_port, false))
+            {
+                se.starved_time = pp->blocked_time;
+                se.starved_deltas = pp->blocked_deltas;
+                if (ed.src != process_graph::npos)
+                {
+                    procs[ed.src].blocking_time += pp->blocked_time;
+                    procs[ed.src].blocking_deltas += pp->blocked_deltas;
+                }
+            }
+            if (const port_profile* pp = find_port(ed.src, ed.src_port, true))
+            {
+                se.backpressure_time = pp->blocked_time;
+                se.backpressure_deltas = pp->blocked_deltas;
+                se.occupancy = pp->occupancy;
+                if (ed.dst != process_graph::npos)
+                {
+                    procs[ed.dst].blocking_time += pp->blocked_time;
+                    procs[ed.dst].blocking_deltas += pp->blocked_deltas;
+                }
+            }
+            sigs.push_back(se);
+        }
+        max_cycle_mean();
+    }
+
+    //! The processes, sorted by the time they blocked the others
+    std::vector<process_entry> blocking_processes() const
+    {
+        std::vector<process_entry> res(procs);
+        std::stable_sort(res.begin(), res.end(),
+            [](const process_entry& a, const process_entry& b)
+            {
+                if (a.blocking_time != b.blocking_time)
+                    return a.blocking_time > b.blocking_time;
+                return a.blocking_deltas > b.blocking_deltas;
+            });
+        return res;
+    }
+
+    //! The signals
+    const std::vector<signal_entry>& signals() const {return sigs;}
+
+    //! The nodes on the critical cycle, empty if there is no cycle
+    const std::vector<size_t>& critical_cycle() const {return cycle;}
+
+    //! The maximum cycle mean in seconds of execution time per graph iteration
+    double cycle_mean() const {return mcm;}
+
+    //! Checks if the fixed-rate signals have a cycle without initial tokens
+    bool has_zero_delay_cycle() const {return zero_delay;}
+
+    //! Writes the report to path + "bottlenecks.xml"
+    void write_xml(const std::string& path) const
+    {
+        const std::string file_name = path + "bottlenecks.xml";
+        std::ofstream out(file_name);
+        if (!out.is_open())
+        {
+            SC_REPORT_ERROR(file_name.c_str(), "file could not be opened to write the bottleneck report. Does the path exists?");
+            return;
+        }
+        out << "<?xml version=\"1.0\" ?>\n<bottlenecks>\n";
+        if (zero_delay)
+            out << "\t<critical_cycle zero_delay=\"true\"/>\n";
+        else if (!cycle.empty())
+        {
+            out << "\t<critical_cycle cycle_mean=\"" << mcm << "\">\n";
+            for (auto n : cycle)
+                out << "\t\t<process name=\"" << g.nodes()[n].name << "\"/>\n";
+            out << "\t</critical_cycle>\n";
+        }
+        for (auto& p : blocking_processes())
+            out << "\t<process name=\"" << g.nodes()[p.node].name
+                << "\" kind=\"" << g.nodes()[p.node].kind
+                << "\" firings=\"" << p.firings
+                << "\" exec_time=\"" << p.exec_time
+                << "\" blocking_time=\"" << p.blocking_time.to_seconds()
+                << "\" blocking_deltas=\"" << p.blocking_deltas << "\"/>\n";
+        for (auto& s : sigs)
+        {
+            auto& ed = g.edges()[s.edge];
+            auto obj = dynamic_cast<sc_object*>(ed.chan);
+            unsigned long long samples = 0, total = 0;
+            for (size_t k=0; k<s.occupancy.size(); k++)
+            {
+                samples += s.occupancy[k];
+                total += k * s.occupancy[k];
+            }
+            out << "\t<signal name=\"" << (obj ? obj->name() : "")
+                << "\" source=\"" << (ed.src != process_graph::npos ? g.nodes()[ed.src].name : "")
+                << "\" target=\"" << (ed.dst != process_graph::npos ? g.nodes()[ed.dst].name : "")
+                << "\" starved_time=\"" << s.starved_time.to_seconds()
+                << "\" starved_deltas=\"" << s.starved_deltas
+                << "\" backpressure_time=\"" << s.backpressure_time.to_seconds()
+                << "\" backpressure_deltas=\"" << s.backpressure_deltas
+                << "\" max_occupancy=\"" << (s.occupancy.empty() ? 0 : s.occupancy.size()-1)
+                << "\" mean_occupancy=\"" << (samples ? double(total)/samples : 0.0)
+                << "\" histogram=\"";
+            for (size_t k=0; k<s.occupancy.size(); k++)
+                out << (k>0 ? " " : "") << s.occupancy[k];
+            out << "\"/>\n";
+        }
+        out << "</bottlenecks>\n";
+    }
+
+private:
+    const process_graph& g;
+    std::vector<process_entry> procs;
+    std::vector<signal_entry> sigs;
+    std::vector<size_t> cycle;
+    double mcm;
+    bool zero_delay;
+
+    //! The profile of the port of a node bound to an edge
+    const port_profile* find_port(size_t n, const sc_object* port, bool out) const
+    {
+        if (n == process_graph::npos) return NULL;
+        const ForSyDe::process* p = g.nodes()[n].proc;
+        auto& infos = out ? p->boundOutChans : p->boundInChans;
+        auto& profs = out ? p->prof.out_ports : p->prof.in_ports;
+        for (size_t i=0; i<infos.size() && i<profs.size(); i++)
+            if (infos[i].port == port) return &profs[i];
+        return NULL;
+    }
+
+    //! The initial tokens of a fixed-rate edge
+    size_t initial_tokens(const process_graph::edge& ed) const
+    {
+        if (ed.init_toks > 0) return ed.init_toks;
+        auto& src = g.nodes()[ed.src];
+        // the shortest tap of a delay line, conservatively
+        if (src.kind == "SY::delay" || src.kind == "SY::sdelay" ||
+            src.kind == "SY::delayline") return 1;
+        if (src.kind == "SY::delayn" || src.kind == "SY::sdelayn")
+        {
+            for (auto& a : src.args())
+                if (std::get<0>(a) == "n") return std::strtoul(std::get<1>(a).c_str(), NULL, 10);
+            return 1;
+        }
+        return 0;
+    }
+
+    //! Computes the maximum cycle mean by a parametric search
+    /*! For a candidate mean l, each edge is weighted by the weight of its
+     * source minus l times its delay, and a positive cycle exists iff
+     * some cycle has a larger mean than l.
+     */
+    void max_cycle_mean()
+    {
+        const size_t n = g.nodes().size();
+        std::vector<double> w(n, 0);
+        SDF::buffer_analysis ba(g);
+        for (size_t a=0; a<n; a++)
+            w[a] = procs[a].exec_time * std::max<size_t>(ba.repetitions(a), 1);
+        struct arc {size_t src, dst; double delay;};
+        std::vector<arc> arcs;
+        for (auto& ed : g.edges())
+        {
+            if (ed.src == process_graph::npos || ed.dst == process_graph::npos ||
+                ed.prod == 0 || ed.cons == 0) continue;
+            const size_t q = std::max<size_t>(ba.repetitions(ed.dst), 1);
+            arcs.push_back({ed.src, ed.dst, double(initial_tokens(ed)) / (q*ed.cons)});
+        }
+        if (arcs.empty()) return;
+        // a cycle without initial tokens never completes an iteration
+        std::vector<std::vector<size_t>> zadj(n);
+        for (auto& a : arcs)
+            if (a.delay == 0) zadj[a.src].push_back(a.dst);
+        std::vector<int> color(n, 0);
+        std::function<bool(size_t)> dfs = [&](size_t v)
+        {
+            color[v] = 1;
+            for (auto u : zadj[v])
+                if (color[u] == 1 || (color[u] == 0 && dfs(u))) return true;
+            color[v] = 2;
+            return false;
+        };
+        for (size_t v=0; v<n && !zero_delay; v++)
+            if (color[v] == 0 && dfs(v)) zero_delay = true;
+        if (zero_delay) return;
+
+        double total = 0, min_delay = 0;
+        for (auto x : w) total += x;
+        for (auto& a : arcs)
+            if (a.delay > 0 && (min_delay == 0 || a.delay < min_delay)) min_delay = a.delay;
+        std::vector<size_t> found;
+        if (!positive_cycle(arcs, w, 0, found)) return;     // acyclic
+        double lo = 0, hi = total / min_delay + 1;
+        cycle = found;
+        for (int it=0; it<100 && hi-lo > 1e-12*hi; it++)
+        {
+            const double mid = (lo + hi) / 2;
+            if (positive_cycle(arcs, w, mid, found))
+            {
+                lo = mid;
+                cycle = found;
+            }
+            else
+                hi = mid;
+        }
+        mcm = lo;
+    }
+
+    //! Finds a cycle with a positive weight using Bellman-Ford
+    template <typename Arcs>
+    static bool positive_cycle(const Arcs& arcs, const std::vector<double>& w,
+                               double l, std::vector<size_t>& found)
+    {
+        const size_t n = w.size();
+        std::vector<double> dist(n, 0);
+        std::vector<size_t> pred(n, process_graph::npos);
+        size_t last = process_graph::npos;
+        for (size_t it=0; it<n; it++)
+        {
+            last = process_graph::npos;
+            for (auto& a : arcs)
+            {
+                const double d = dist[a.src] + w[a.src] - l*a.delay;
+                if (d > dist[a.dst] + 1e-15)
+                {
+                    dist[a.dst] = d;
+                    pred[a.dst] = a.src;
+                    last = a.dst;
+                }
+            }
+            if (last == process_graph::npos) return false;
+        }
+        // walk back into the cycle and collect it
+        for (size_t k=0; k<n; k++) last = pred[last];
+        found.clear();
+        size_t v = last;
+        do
+        {
+            found.push_back(v);
+            v = pred[v];
+        } while (v != last && found.size() <= n);
+        std::reverse(found.begin(), found.end());
+        return true;
+    }
+};
+
+//! Writes the bottleneck report of the model at the end of the simulation
+/*! The report is written to path + "bottlenecks.xml", e.g., next to the
+ * XML files of XMLExport.
+ */
+class bottleneck_monitor : public sc_module
+{
+public:
+    bottleneck_monitor(sc_module_name _name,    ///< The module name
+                       const std::string& path  ///< The output path
+                      ) : sc_module(_name), path(path) {}
+
+    void end_of_simulation()
+    {
+        bottleneck_report(model_graph()).write_xml(path);
+    }
+
+private:
+    std::string path;
+};
+
+}
+
+#endif
@@ -0,0 +1,229 @@
+/**********************************************************************
+    * checkpoint.hpp -- Checkpointing and restoring complete models   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Saving the state of the processes and the contents of  *
+    *          the signals into a snapshot file and resuming a new    *
+    *          simulation of the same model from it                   *
+    *                                                                 *
+    * Usage:   Define FORSYDE_CHECKPOINT to use it                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+/*! \file checkpoint.hpp
+ * \brief Implements the checkpoints of the models
+ *
+ *  This file includes the functions which save the complete state of a
+ * model into a snapshot file and restore it. A checkpoint is made while
+ * the simulation is paused, i.e., after sc_start returns:
+ *
+ *     sc_start(warmup);
+ *     ForSyDe::save_checkpoint("warm.ckpt");
+ *
+ * and a new instance of the same model (e.g., another run of the same
+ * executable with different parameters) is resumed from it by restoring
+ * the checkpoint after the elaboration and before the simulation:
+ *
+ *     top t("top");
+ *     ForSyDe::restore_checkpoint("warm.ckpt");
+ *     sc_start();
+ *
+ *  The states of the processes and the signals are matched by their
+ * hierarchical names, hence the structure of the model should not
+ * change. Each process saves its own state using process::save_state()
+ * and the stage in which its thread is suspended. A restored process runs
+ * its init stage, which skips producing the initial tokens, and then
+ * takes over the saved state. The tokens of the signals are saved using
+ * their serializers, hence their types should be serializable.
+ *
+ *  The simulated time of the restored model starts from zero. The timed
+ * processes resume waiting for the absolute time tags of their events,
+ * which are restored as well. A process which consumed only a part of
+ * its inputs (e.g., it waits for its second input) loses the tokens
+ * already read, hence the checkpoints should be made when the processes
+ * with several inputs have either all or none of them available. The
+ * token a process is blocked writing is kept by the signal, but the
+ * rest of the tokens of the same evaluation cycle (e.g., to the other
+ * outputs) are lost. The processes suspended in their init stage start
+ * over. The CT signals carry sub-signals, which are not serializable,
+ * hence only the state of the CT wrappers (e.g., the FMU) is saved and
+ * their signals should be empty.
+ *
+ *  The file starts with the eight characters "FSDCKP01", the simulated
+ * time of the checkpoint in seconds as a float64 and the number of the
+ * records as a uint64. Each record consists of a one-character kind, 'P'
+ * for a process and 'S' for a signal, the name of the object and the
+ * saved data, the last two each as a uint64 length followed by the bytes.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "abssemantics.hpp"
+#include "serializer.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Helper functions of the checkpoints
+namespace checkpoint_detail
+{
+
+//! Calls a function for all the processes and checkpointed signals of the model
+template <typename PF, typename SF>
+void for_each_object(const std::vector<sc_object*>& objs, PF&& pf, SF&& sf)
+{
+    for (auto obj : objs)
+    {
+        if (auto p = dynamic_cast<process*>(obj))
+            pf(p);
+        else if (auto c = dynamic_cast<checkpoint_channel*>(obj))
+            sf(obj, c);
+        for_each_object(obj->get_child_objects(), pf, sf);
+    }
+}
+
+inline void put_string(std::vector<char>& buf, const std::string& s)
+{
+    serializer<std::uint64_t>::write(buf, s.size());
+    buf.insert(buf.end(), s.begin(), s.end());
+}
+
+inline bool get_string(const char*& pos, const char* end, std::string& s)
+{
+    std::uint64_t len;
+    if (end - pos < (std::ptrdiff_t)sizeof(len)) return false;
+    serializer<std::uint64_t>::read(pos, len);
+    if (len > std::uint64_t(end - pos)) return false;
+    s.assign(pos, len);
+    pos += len;
+    return true;
+}
+
+}
+
+//! Saves the state of the model into a checkpoint file
+/*! It should be called while the simulation is paused. It returns false
+ * if the file can not be written.
+ */
+inline bool save_checkpoint(const std::string& file_name)
+{
+    using namespace checkpoint_detail;
+    std::vector<char> buf, data;
+    std::uint64_t count = 0;
+    buf.insert(buf.end(), "FSDCKP01", "FSDCKP01"+8);
+    serializer<double>::write(buf, sc_time_stamp().to_seconds());
+    const size_t count_pos = buf.size();
+    serializer<std::uint64_t>::write(buf, 0);
+    auto record = [&](char kind, const char* name)
+    {
+        buf.push_back(kind);
+        put_string(buf, name);
+        put_string(buf, std::string(data.begin(), data.end()));
+        data.clear();
+        count++;
+    };
+    for_each_object(sc_get_top_level_objects(),
+        [&](process* p)
+        {
+            p->save_checkpoint(data);
+            record('P', p->name());
+        },
+        [&](sc_object* obj, checkpoint_channel* c)
+        {
+            c->save_contents(data);
+            record('S', obj->name());
+        }
+    );
+    std::memcpy(buf.data()+count_pos, &count, sizeof(count));
+
+    std::FILE* f = std::fopen(file_name.c_str(), "wb");
+    if (f == NULL) return false;
+    const bool ok = std::fwrite(buf.data(), 1, buf.size(), f) == buf.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+//! Restores the state of the model from a checkpoint file
+/*! It should be called after the model is built and before the
+ * simulation starts. It returns false if the file can not be read, and
+ * reports an error if it does not match the model.
+ */
+inline bool restore_checkpoint(const std::string& file_name)
+{
+    using namespace checkpoint_detail;
+    std::FILE* f = std::fopen(file_name.c_str(), "rb");
+    if (f == NULL) return false;
+    std::vector<char> buf;
+    char chunk[1<<16];
+    size_t n;
+    while ((n = std::fread(chunk, 1, sizeof(chunk), f)) > 0)
+        buf.insert(buf.end(), chunk, chunk+n);
+    std::fclose(f);
+
+    const char* pos = buf.data();
+    const char* end = pos + buf.size();
+    const size_t header = 8 + sizeof(double) + sizeof(std::uint64_t);
+    if (buf.size() < header || std::memcmp(pos, "FSDCKP01", 8) != 0)
+    {
+        SC_REPORT_ERROR(file_name.c_str(), "not a ForSyDe checkpoint file");
+        return false;
+    }
+    pos += 8 + sizeof(double);
+    std::uint64_t count;
+    serializer<std::uint64_t>::read(pos, count);
+    std::map<std::string,std::string> procs, sigs;
+    for (std::uint64_t i=0; i<count; i++)
+    {
+        std::string name, data;
+        if (pos == end) break;
+        const char kind = *pos++;
+        if (!get_string(pos, end, name) || !get_string(pos, end, data)) break;
+        (kind == 'P' ? procs : sigs)[name] = std::move(data);
+    }
+    if (pos != end)
+    {
+        SC_REPORT_ERROR(file_name.c_str(), "the checkpoint file is corrupted");
+        return false;
+    }
+
+    size_t found = 0;
+    for_each_object(sc_get_top_level_objects(),
+        [&](process* p)
+        {
+            auto it = procs.find(p->name());
+            if (it == procs.end())
+                return SC_REPORT_ERROR(p->name(), "the process is not in the checkpoint");
+            p->load_checkpoint(it->second.data(), it->second.size());
+            found++;
+        },
+        [&](sc_object* obj, checkpoint_channel* c)
+        {
+            auto it = sigs.find(obj->name());
+            if (it == sigs.end())
+                return SC_REPORT_ERROR(obj->name(), "the signal is not in the checkpoint");
+            const char* p = it->second.data();
+            c->restore_contents(p);
+            if (p != it->second.data() + it->second.size())
+                SC_REPORT_ERROR(obj->name(), "the checkpoint does not match the signal");
+            found++;
+        }
+    );
+    if (found != procs.size() + sigs.size())
+        SC_REPORT_ERROR(file_name.c_str(), "the checkpoint does not match the model");
+    return true;
+}
+
+}
+
+#endif
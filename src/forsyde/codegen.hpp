@@ -0,0 +1,634 @@
+/**********************************************************************
+    * codegen.hpp -- Generates standalone C++ code from a model       *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Compiling the SY and SDF process networks to native    *
+    *          programs without SystemC                               *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION to use it                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CODEGEN_HPP
+#define CODEGEN_HPP
+
+/*! \file codegen.hpp
+ * \brief Generates a standalone C++ program from an SY or SDF model
+ *
+ *  This file includes a code generator which uses the introspection
+ * information of a process network (the process constructors, their
+ * arguments and the token types of the signals) to emit a single C++
+ * file which executes the network using a static schedule and
+ * statically sized buffers, without SystemC. The functions passed to
+ * the process constructors are copied from the source files where they
+ * are marked by the ForSyDe pragmas:
+ *
+ *     void mul_func(abst_ext<double>& out1, const abst_ext<double>& a,
+ *                   const abst_ext<double>& b)
+ *     {
+ *     #pragma ForSyDe begin mul_func
+ *         ...
+ *     #pragma ForSyDe end
+ *     }
+ *
+ * and the generator is run after the elaboration phase, e.g., in the
+ * start_of_simulation callback of the top module:
+ *
+ *     void start_of_simulation()
+ *     {
+ *         CodeGen gen("gen/");
+ *         gen.add_prelude("#define NN_NUM_INPUTS 2");
+ *         gen.add_source("nn_inner_layer.hpp");
+ *         gen.generate(this);
+ *     }
+ *
+ * The generated program includes abst_ext.hpp, hence the ForSyDe source
+ * directory should be on its include path.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <numeric>
+#include <algorithm>
+#ifdef __GNUG__
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+#include "process_graph.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Generates a standalone C++ program from a process network
+/*! The leaf processes below the top module should be built by the SY and
+ * SDF process constructors comb, comb2, comb3, comb4, delay, delayn,
+ * constant, source, vsource, sink and fanout, or by the SY combX. The
+ * generator computes the repetitions of the processes in an iteration
+ * of the network from the rates of the signals (one for the SY signals),
+ * and simulates an iteration to find a single-appearance-friendly
+ * schedule and the largest occupancy of each signal, which becomes the
+ * size of its ring buffer.
+ *
+ *  The program runs the number of iterations given as its first argument.
+ * The sources which produce a limited number of tokens (take or the
+ * length of the test vector) limit the iterations, and the argument is
+ * optional if there is such a source. The values of the initial tokens
+ * and of the test vectors are emitted as they are printed, hence they
+ * should be valid C++ initializers of the token types.
+ */
+class CodeGen
+{
+public:
+    //! The constructor takes the generation path
+    CodeGen(std::string path) : path(path) {}
+
+    //! Copies the marked functions of a source file to the generated code
+    /*! The whole definition of a function whose body contains a
+     * "#pragma ForSyDe begin NAME" line is copied under NAME, except for
+     * the pragma lines themselves.
+     */
+    void add_source(const std::string& file)
+    {
+        std::ifstream in(file);
+        if (!in)
+        {
+            SC_REPORT_WARNING(file.c_str(), "cannot open the source file");
+            return;
+        }
+        std::stringstream ss;
+        ss << in.rdbuf();
+        const std::string text = ss.str();
+        const std::string marker = "#pragma ForSyDe begin";
+        for (size_t pos = text.find(marker); pos != std::string::npos;
+             pos = text.find(marker, pos+1))
+        {
+            std::istringstream ls(text.substr(pos+marker.size(),
+                                  text.find('\n', pos) - pos - marker.size()));
+            std::string name;
+            ls >> name;
+            std::string def;
+            if (name.empty() || !extract(text, pos, def))
+            {
+                SC_REPORT_WARNING(file.c_str(), "cannot find the function of a ForSyDe pragma");
+                continue;
+            }
+            if (functions.count(name) == 0) functions[name] = def;
+        }
+    }
+
+    //! Adds code to the beginning of the program (e.g., the definitions the functions use)
+    void add_prelude(const std::string& code) {preludes.push_back(code);}
+
+    //! Generates the program of the processes below a module
+    /*! The program is written to the file named after the module in the
+     * generation path. It should be called after the elaboration phase.
+     */
+    void generate(sc_module* top)
+    {
+        g.build({top});
+        analyze();
+        schedule();
+        std::ofstream out(path + top->basename() + ".cpp");
+        emit(out, top->name());
+    }
+
+private:
+    //! A process with its signals ordered by its ports
+    struct actor
+    {
+        std::string moc, pc, func;
+        std::vector<size_t> ins;                    // the edge of each input port
+        std::vector<std::vector<size_t>> outs;      // the edges of each output port
+        size_t reps;                                // the repetitions in an iteration
+        bool limited;                               // if it is a source with limited tokens
+        unsigned long long bound;                   // the number of the tokens of a limited source
+    };
+
+    std::string path;
+    std::vector<std::string> preludes;
+    std::map<std::string,std::string> functions;
+    process_graph g;
+    std::vector<actor> actors;
+    std::vector<size_t> init_toks, capacity;
+    std::vector<std::pair<size_t,size_t>> sched;    // (actor, firings) runs
+    bool limited;                                   // if some source limits the iterations
+    unsigned long long max_iters;
+
+    //! Finds the definition of the function enclosing a position
+    static bool extract(const std::string& text, size_t pos, std::string& def)
+    {
+        // the opening brace of the body
+        size_t open = pos;
+        int depth = 0;
+        while (open-- > 0)
+        {
+            if (text[open] == '}') depth++;
+            else if (text[open] == '{' && depth-- == 0) break;
+        }
+        if (open == std::string::npos) return false;
+        // the end of the previous declaration
+        size_t start = open;
+        int parens = 0;
+        while (start-- > 0)
+        {
+            const char c = text[start];
+            if (c == ')') parens++;
+            else if (c == '(') parens--;
+            else if (parens == 0 && (c == ';' || c == '{' || c == '}')) break;
+        }
+        start = start == std::string::npos ? 0 : start+1;
+        // the closing brace of the body
+        size_t close = open;
+        depth = 0;
+        for (; close < text.size(); close++)
+        {
+            if (text[close] == '{') depth++;
+            else if (text[close] == '}' && --depth == 0) break;
+        }
+        if (close == text.size()) return false;
+        // drop the preprocessor lines before the signature and the pragmas
+        std::istringstream ls(text.substr(start, close+1-start));
+        std::string line;
+        bool signature = false;
+        while (std::getline(ls, line))
+        {
+            const size_t f = line.find_first_not_of(" \t\r");
+            if (f == std::string::npos)
+            {
+                if (signature) def += "\n";
+                continue;
+            }
+            if (line.compare(f, 15, "#pragma ForSyDe") == 0 ||
+                (!signature && line[f] == '#'))
+                continue;
+            signature = true;
+            def += line + "\n";
+        }
+        return true;
+    }
+
+    //! The value of an argument of a process, or an empty string
+    static std::string arg(const process_graph::node& n, const std::string& name)
+    {
+        for (auto& a : n.args())
+            if (std::get<0>(a) == name) return std::get<1>(a).str();
+        return "";
+    }
+
+    //! The name of the type of the values of a signal
+    std::string value_type(size_t e) const
+    {
+        std::string name = g.edges()[e].token_type;
+#ifdef __GNUG__
+        int status = 0;
+        char* dem = abi::__cxa_demangle(name.c_str(), NULL, NULL, &status);
+        if (status == 0 && dem != NULL) name = dem;
+        std::free(dem);
+#endif
+        return name;
+    }
+
+    //! The name of the type of the tokens of a signal
+    std::string token_type(size_t e) const
+    {
+        const std::string t = value_type(e);
+        return actors[g.edges()[e].src].moc == "SY" ? "abst_ext<" + t + ">" : t;
+    }
+
+    //! Converts a printed value to an initializer of a type
+    static std::string literal(const std::string& type, std::string s)
+    {
+        s = trim(s);
+        for (auto& c : s)
+            if (c == '[') c = '{';
+            else if (c == ']') c = '}';
+        return !s.empty() && s[0] == '{' ? type + s : type + "(" + s + ")";
+    }
+
+    //! Converts a printed value to an initializer of a token
+    static std::string token_literal(const std::string& moc, const std::string& type,
+                                     const std::string& s)
+    {
+        if (moc != "SY") return literal(type, s);
+        if (trim(s) == "_") return "abst_ext<" + type + ">()";
+        return "abst_ext<" + type + ">(" + literal(type, s) + ")";
+    }
+
+    //! Splits a printed vector into its elements
+    static std::vector<std::string> elements(const std::string& s)
+    {
+        std::vector<std::string> res;
+        const std::string t = trim(s);
+        if (t.size() < 2) return res;
+        int depth = 0;
+        std::string cur;
+        for (size_t i=1; i+1<t.size(); i++)
+        {
+            const char c = t[i];
+            if (c == '[' || c == '{' || c == '(') depth++;
+            else if (c == ']' || c == '}' || c == ')') depth--;
+            if (c == ',' && depth == 0)
+            {
+                res.push_back(cur);
+                cur.clear();
+            }
+            else
+                cur += c;
+        }
+        if (!trim(cur).empty()) res.push_back(cur);
+        return res;
+    }
+
+    static std::string trim(const std::string& s)
+    {
+        const size_t b = s.find_first_not_of(" \t\r\n");
+        if (b == std::string::npos) return "";
+        return s.substr(b, s.find_last_not_of(" \t\r\n")-b+1);
+    }
+
+    //! Collects the actors and checks that the network is supported
+    void analyze()
+    {
+        static const std::set<std::string> supported = {
+            "comb", "comb2", "comb3", "comb4", "delay", "delayn", "constant",
+            "source", "vsource", "sink", "fanout"};
+        const size_t n = g.nodes().size();
+        actors.assign(n, actor());
+        init_toks.assign(g.edges().size(), 0);
+        for (size_t i=0; i<n; i++)
+        {
+            auto& nd = g.nodes()[i];
+            actor& a = actors[i];
+            a.moc = nd.kind.substr(0, nd.kind.find(':'));
+            a.pc = nd.kind.substr(nd.kind.rfind(':')+1);
+            if ((a.moc != "SY" && a.moc != "SDF") ||
+                (supported.count(a.pc) == 0 && !(a.moc == "SY" && a.pc == "combX")))
+                SC_REPORT_ERROR(nd.name.c_str(), ("the process constructor " + nd.kind +
+                                " is not supported by the code generator").c_str());
+            a.func = arg(nd, "_func");
+            for (auto& pi : nd.proc->boundInChans)
+            {
+                size_t e = process_graph::npos;
+                for (auto ie : nd.in_edges)
+                    if (g.edges()[ie].dst_port == pi.port) e = ie;
+                if (e == process_graph::npos || g.edges()[e].src == process_graph::npos)
+                    SC_REPORT_ERROR(nd.name.c_str(), "an input of the process is not driven by a process of the network");
+                a.ins.push_back(e);
+            }
+            for (auto& pi : nd.proc->boundOutChans)
+            {
+                a.outs.emplace_back();
+                for (auto oe : nd.out_edges)
+                    if (g.edges()[oe].src_port == pi.port &&
+                        g.edges()[oe].dst != process_graph::npos)
+                        a.outs.back().push_back(oe);
+            }
+            a.bound = 0;
+            if (a.pc == "constant" || a.pc == "source")
+                a.bound = std::stoull("0" + trim(arg(nd, "take")));
+            else if (a.pc == "vsource")
+                a.bound = elements(arg(nd, "in_vec")).size();
+            a.limited = a.bound > 0 || a.pc == "vsource";
+            if (a.pc == "delay" || a.pc == "delayn")
+                for (auto e : a.outs[0])
+                    init_toks[e] = a.pc == "delay" ? 1 : std::stoul("0" + trim(arg(nd, "n")));
+        }
+        for (auto& e : g.edges())
+            if (e.src != process_graph::npos && e.dst != process_graph::npos &&
+                (e.prod == 0 || e.cons == 0))
+                SC_REPORT_ERROR(g.nodes()[e.src].name.c_str(), "the rates of a signal are not fixed");
+    }
+
+    //! Solves the balance equations and simulates an iteration
+    void schedule()
+    {
+        const size_t n = actors.size();
+        const auto& edges = g.edges();
+        auto internal = [&](size_t e)
+        {
+            return edges[e].src != process_graph::npos && edges[e].dst != process_graph::npos;
+        };
+        // the repetitions, as fractions propagated along the signals
+        std::vector<size_t> num(n, 0), den(n, 1);
+        for (size_t s=0; s<n; s++)
+        {
+            if (num[s] != 0) continue;
+            std::vector<size_t> comp, stack(1, s);
+            num[s] = 1;
+            while (!stack.empty())
+            {
+                const size_t a = stack.back(); stack.pop_back();
+                comp.push_back(a);
+                std::vector<size_t> es(g.nodes()[a].in_edges);
+                es.insert(es.end(), g.nodes()[a].out_edges.begin(), g.nodes()[a].out_edges.end());
+                for (auto e : es)
+                {
+                    if (!internal(e)) continue;
+                    auto& ed = edges[e];
+                    const bool fwd = ed.src == a;
+                    const size_t b = fwd ? ed.dst : ed.src;
+                    size_t bn = num[a] * (fwd ? ed.prod : ed.cons);
+                    size_t bd = den[a] * (fwd ? ed.cons : ed.prod);
+                    const size_t gc = std::gcd(bn, bd);
+                    bn /= gc; bd /= gc;
+                    if (num[b] == 0)
+                    {
+                        num[b] = bn; den[b] = bd;
+                        stack.push_back(b);
+                    }
+                    else if (num[b] != bn || den[b] != bd)
+                        SC_REPORT_ERROR(g.nodes()[b].name.c_str(), "inconsistent rates: the network has no static schedule");
+                }
+            }
+            size_t l = 1, gc = 0;
+            for (auto a : comp) l = std::lcm(l, den[a]);
+            for (auto a : comp)
+            {
+                num[a] *= l / den[a];
+                den[a] = 1;
+                gc = std::gcd(gc, num[a]);
+            }
+            for (auto a : comp) num[a] /= gc;
+        }
+        limited = false;
+        max_iters = 0;
+        for (size_t a=0; a<n; a++)
+        {
+            actors[a].reps = num[a];
+            if (!actors[a].limited) continue;
+            const unsigned long long it = actors[a].bound / num[a];
+            max_iters = limited ? std::min(max_iters, it) : it;
+            limited = true;
+        }
+        // fire the ready actors as many times as possible, in the order of the graph
+        std::vector<size_t> toks(init_toks), rem(num);
+        capacity = init_toks;
+        sched.clear();
+        size_t left = std::accumulate(rem.begin(), rem.end(), size_t(0));
+        while (left > 0)
+        {
+            bool fired = false;
+            for (size_t a=0; a<n; a++)
+            {
+                size_t k = 0;
+                while (rem[a] > 0)
+                {
+                    bool ready = true;
+                    for (auto e : actors[a].ins) ready &= toks[e] >= edges[e].cons;
+                    if (!ready) break;
+                    for (auto e : actors[a].ins) toks[e] -= edges[e].cons;
+                    for (auto& es : actors[a].outs)
+                        for (auto e : es)
+                        {
+                            toks[e] += edges[e].prod;
+                            capacity[e] = std::max(capacity[e], toks[e]);
+                        }
+                    rem[a]--;
+                    left--;
+                    k++;
+                }
+                if (k == 0) continue;
+                fired = true;
+                if (!sched.empty() && sched.back().first == a) sched.back().second += k;
+                else sched.emplace_back(a, k);
+            }
+            if (!fired)
+                SC_REPORT_ERROR("CodeGen", "the network deadlocks: insufficient initial tokens in a cycle");
+        }
+    }
+
+    //! The signature of the function of an actor, used if its definition is not given
+    std::string prototype(const actor& a) const
+    {
+        auto val = [&](size_t e) {return value_type(e);};
+        auto tok = [&](size_t e) {return a.moc == "SY" ? "abst_ext<" + val(e) + ">" : val(e);};
+        auto cont = [&](size_t e) {return a.moc == "SY" ? tok(e) : "std::vector<" + val(e) + ">";};
+        std::string ps;
+        if (a.pc == "sink")
+            ps = "const " + tok(a.ins[0]) + "&";
+        else if (a.pc == "source")
+            ps = tok(a.outs[0][0]) + "&, const " + tok(a.outs[0][0]) + "&";
+        else if (a.pc == "combX")
+            ps = cont(a.outs[0][0]) + "&, const std::array<" + tok(a.ins[0]) + "," +
+                 std::to_string(a.ins.size()) + ">&";
+        else
+        {
+            ps = cont(a.outs[0][0]) + "&";
+            for (auto e : a.ins) ps += ", const " + cont(e) + "&";
+        }
+        return "void " + a.func + "(" + ps + ");\n";
+    }
+
+    //! Writes a value to all the signals of an output port
+    static std::string write(const std::vector<size_t>& es, const std::string& v)
+    {
+        std::string s;
+        for (auto e : es) s += (s.empty() ? "b" : " b") + std::to_string(e) + ".push(" + v + ");";
+        return s;
+    }
+
+    //! Emits the firing function of an actor
+    void emit_actor(std::ostream& os, size_t i) const
+    {
+        const actor& a = actors[i];
+        auto& nd = g.nodes()[i];
+        auto in = [](size_t e) {return "b" + std::to_string(e) + ".pop()";};
+        const std::vector<size_t> none;
+        const std::vector<size_t>& out = a.outs.empty() ? none : a.outs[0];
+        os << "// " << nd.name << " (" << nd.kind << ")\n";
+        os << "static void fire_" << i << "()\n{\n";
+        if (a.pc == "delay" || a.pc == "delayn" || a.pc == "fanout")
+            os << "    auto v = " << in(a.ins[0]) << ";\n    " << write(out, "v") << "\n";
+        else if (a.pc == "constant")
+        {
+            const std::string t = out.empty() ? "" : value_type(out[0]);
+            os << "    " << write(out, token_literal(a.moc, t, arg(nd, "init_val"))) << "\n";
+        }
+        else if (a.pc == "source")
+        {
+            const std::string t = value_type(out[0]);
+            os << "    static " << (a.moc == "SY" ? "abst_ext<" + t + ">" : t) << " st = "
+               << token_literal(a.moc, t, arg(nd, "init_val")) << ";\n"
+               << "    static bool first = true;\n"
+               << "    if (!first) " << a.func << "(st, st);\n"
+               << "    first = false;\n"
+               << "    " << write(out, "st") << "\n";
+        }
+        else if (a.pc == "vsource")
+        {
+            const std::string t = value_type(out[0]);
+            os << "    static const " << (a.moc == "SY" ? "abst_ext<" + t + ">" : t) << " vals[] = {";
+            const auto el = elements(arg(nd, "in_vec"));
+            for (size_t k=0; k<el.size(); k++)
+                os << (k ? ", " : "") << token_literal(a.moc, t, el[k]);
+            os << "};\n    static size_t k = 0;\n    " << write(out, "vals[k++]") << "\n";
+        }
+        else if (a.pc == "sink")
+            os << "    " << a.func << "(" << in(a.ins[0]) << ");\n";
+        else if (a.moc == "SY" && a.pc == "combX")
+        {
+            os << "    static std::array<abst_ext<" << value_type(a.ins[0]) << ">,"
+               << a.ins.size() << "> i1;\n";
+            for (size_t k=0; k<a.ins.size(); k++)
+                os << "    i1[" << k << "] = " << in(a.ins[k]) << ";\n";
+            os << "    static abst_ext<" << value_type(out[0]) << "> o1;\n"
+               << "    " << a.func << "(o1, i1);\n    " << write(out, "o1") << "\n";
+        }
+        else if (a.moc == "SY")
+        {
+            std::string args = "o1", absent;
+            for (size_t k=0; k<a.ins.size(); k++)
+            {
+                const std::string v = "i" + std::to_string(k+1);
+                os << "    abst_ext<" << value_type(a.ins[k]) << "> " << v << " = "
+                   << in(a.ins[k]) << ";\n";
+                args += ", " + v;
+                absent += (k ? " && " : "") + v + ".is_absent()";
+            }
+            const std::string t = "abst_ext<" + value_type(out[0]) + ">";
+            os << "    static " << t << " o1;\n";
+            auto sk = dynamic_cast<const absent_skipping*>(nd.proc);
+            if (sk != NULL && sk->skips_absent())
+                os << "    if (" << absent << ") o1 = " << t << "();\n    else ";
+            else
+                os << "    ";
+            os << a.func << "(" << args << ");\n    " << write(out, "o1") << "\n";
+        }
+        else
+        {
+            std::string args = "o1";
+            for (size_t k=0; k<a.ins.size(); k++)
+            {
+                const std::string v = "i" + std::to_string(k+1);
+                os << "    static std::vector<" << value_type(a.ins[k]) << "> " << v << "("
+                   << g.edges()[a.ins[k]].cons << ");\n"
+                   << "    for (auto& v : " << v << ") v = " << in(a.ins[k]) << ";\n";
+                args += ", " + v;
+            }
+            const size_t rate = out.empty() ? 0 : g.edges()[out[0]].prod;
+            os << "    static std::vector<" << value_type(out[0]) << "> o1(" << rate << ");\n"
+               << "    " << a.func << "(" << args << ");\n"
+               << "    for (auto& v : o1) {" << write(out, "v") << "}\n";
+        }
+        os << "}\n\n";
+    }
+
+    //! Emits the whole program
+    void emit(std::ostream& os, const std::string& top) const
+    {
+        os << "// The standalone program of " << top << ", generated by ForSyDe-SystemC\n\n"
+           << "#include <iostream>\n#include <vector>\n#include <array>\n"
+           << "#include <cstddef>\n#include <cstdlib>\n#include <utility>\n\n"
+           << "namespace sc_core {}\n#include \"abst_ext.hpp\"\n\n"
+           << "using namespace ForSyDe;\n\n";
+        for (auto& p : preludes) os << p << "\n\n";
+        os << "//! A statically sized ring buffer\n"
+           << "template <typename T, std::size_t N>\n"
+           << "struct fifo\n{\n"
+           << "    T buf[N];\n    std::size_t head = 0, tail = 0;\n"
+           << "    void push(const T& v) {buf[tail] = v; tail = tail+1 == N ? 0 : tail+1;}\n"
+           << "    T pop() {T v = std::move(buf[head]); head = head+1 == N ? 0 : head+1; return v;}\n"
+           << "};\n\n";
+        // the functions
+        std::set<std::string> done;
+        for (auto& a : actors)
+        {
+            if (a.func.empty() || !done.insert(a.func).second) continue;
+            auto it = functions.find(a.func);
+            os << (it != functions.end() ? it->second : prototype(a)) << "\n";
+        }
+        // the buffers
+        for (size_t e=0; e<g.edges().size(); e++)
+        {
+            auto& ed = g.edges()[e];
+            if (ed.src == process_graph::npos || ed.dst == process_graph::npos) continue;
+            os << "static fifo<" << token_type(e) << "," << std::max<size_t>(capacity[e], 1)
+               << "> b" << e << ";    // " << dynamic_cast<sc_object*>(ed.chan)->name() << "\n";
+        }
+        os << "\n";
+        for (size_t i=0; i<actors.size(); i++) emit_actor(os, i);
+        // the main loop
+        os << "int main(int argc, char* argv[])\n{\n";
+        if (limited)
+            os << "    unsigned long long iterations = " << max_iters << "ULL;\n"
+               << "    if (argc > 1) iterations = std::min(iterations, std::strtoull(argv[1], NULL, 10));\n";
+        else
+            os << "    if (argc < 2)\n    {\n"
+               << "        std::cerr << \"usage: \" << argv[0] << \" iterations\" << std::endl;\n"
+               << "        return 1;\n    }\n"
+               << "    unsigned long long iterations = std::strtoull(argv[1], NULL, 10);\n";
+        for (size_t i=0; i<actors.size(); i++)
+        {
+            if (actors[i].pc != "delay" && actors[i].pc != "delayn") continue;
+            auto& out = actors[i].outs[0];
+            if (out.empty()) continue;
+            const std::string v = token_literal(actors[i].moc, value_type(out[0]),
+                                                arg(g.nodes()[i], "init_val"));
+            os << "    for (size_t k=0; k<" << init_toks[out[0]] << "; k++) {"
+               << write(out, v) << "}\n";
+        }
+        os << "    for (unsigned long long it=0; it<iterations; it++)\n    {\n";
+        for (auto& s : sched)
+        {
+            if (s.second == 1)
+                os << "        fire_" << s.first << "();\n";
+            else
+                os << "        for (size_t k=0; k<" << s.second << "; k++) fire_"
+                   << s.first << "();\n";
+        }
+        os << "    }\n    return 0;\n}\n";
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,145 @@
+/**********************************************************************
+    * csdf_helpers.hpp -- Helper primitives in the CSDF MoC           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing helper primitives for modeling in the CSDF   *
+    *          MoC                                                    *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CSDF_HELPERS_HPP
+#define CSDF_HELPERS_HPP
+
+/*! \file csdf_helpers.hpp
+ * \brief Implements helper primitives for modeling in the CSDF MoC
+ * 
+ *  This file includes helper functions which facilliate construction of
+ * processes in the CSDF MoC
+ */
+
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include "csdf_process_constructors.hpp"
+
+namespace ForSyDe
+{
+
+namespace CSDF
+{
+
+using namespace sc_core;
+
+//! Helper function to construct a comb process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline comb<T0,T1>* make_comb(std::string pName,    ///< process name
+    typename comb<T0,T1>::functype _func,          ///< function to be passed
+    const std::vector<unsigned int>& o1toks,        ///< production rates of the phases
+    const std::vector<unsigned int>& i1toks,        ///< consumption rates of the phases
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S                                  ///< the first input signal
+    )
+{
+    auto p = new comb<T0,T1>(pName.c_str(), _func, o1toks, i1toks);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a delay process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline delay<T>* make_delay(std::string pName,
+    T initval,
+    const std::vector<unsigned int>& toks,
+    unsigned int ntoks,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new delay<T>(pName.c_str(), initval, toks, ntoks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a zip process
+/*! This function is used to construct a zip process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          template <class> class OIf>
+inline zip<T1,T2>* make_zip(std::string pName,
+    const std::vector<unsigned int>& i1toks,
+    const std::vector<unsigned int>& i2toks,
+    OIf<std::tuple<std::vector<T1>,std::vector<T2>>>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S
+    )
+{
+    auto p = new zip<T1,T2>(pName.c_str(), i1toks, i2toks);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct an unzip process
+/*! This function is used to construct an unzip process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <class T1, template <class> class O1If,
+          class T2, template <class> class O2If,
+          template <class> class IIf>
+inline unzip<T1,T2>* make_unzip(std::string pName,
+    IIf<std::tuple<std::vector<T1>,std::vector<T2>>>& inpS,
+    const std::vector<unsigned int>& o1toks,
+    const std::vector<unsigned int>& o2toks,
+    O1If<T1>& out1S,
+    O2If<T2>& out2S
+    )
+{
+    auto p = new unzip<T1,T2>(pName.c_str(), o1toks, o2toks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(out1S);
+    (*p).oport2(out2S);
+    
+    return p;
+}
+
+}
+}
+
+#endif
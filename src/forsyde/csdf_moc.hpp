@@ -0,0 +1,45 @@
+/**********************************************************************
+    * csdf_moc.hpp -- The cyclo-static dataflow model of computation  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing promitive element required for modeling      *
+    *          cyclo-static dataflow systems in ForSyDe-SystemC       *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CSDF_MOC_HPP
+#define CSDF_MOC_HPP
+
+/*! \file csdf_moc.hpp
+ * \brief Implements the Cyclo-Static Dataflow (CSDF) Model of Computation
+ * 
+ *  This file includes the basic process constructors and other
+ * facilities used for modeling in the cyclo-static dataflow model of
+ * computation. The CSDF processes are SDF processes whose rates change
+ * periodically, hence they are connected with the SDF signals and can be
+ * mixed with the SDF processes in the statically scheduled graphs.
+ */
+
+#include "csdf_process.hpp"
+#include "csdf_process_constructors.hpp"
+#include "csdf_helpers.hpp"
+
+namespace ForSyDe
+{
+
+//! The namespace for cyclo-static dataflow MoC
+/*! This namespace includes constructs used for building models in the
+ * cyclo-static dataflow MoC.
+ */
+namespace CSDF
+{
+
+
+}
+}
+
+#endif
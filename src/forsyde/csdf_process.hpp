@@ -0,0 +1,108 @@
+/**********************************************************************
+    * csdf_process.hpp -- The abstract process in the CSDF MoC        *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing the base of the cyclo-static dataflow        *
+    *          processes with their phases                            *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CSDF_PROCESS_HPP
+#define CSDF_PROCESS_HPP
+
+/*! \file csdf_process.hpp
+ * \brief Implements the abstract process in the CSDF Model of Computation
+ * 
+ *  This file provides the abstract base process of the cyclo-static
+ * dataflow (CSDF) MoC. The CSDF processes use the SDF signals and ports
+ * and are SDF processes whose ports have a rate per phase.
+ */
+
+#include <vector>
+
+#include "sdf_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace CSDF
+{
+
+using namespace sc_core;
+
+//! The CSDF processes are inter-connected with the SDF signals
+template <typename T>
+using signal = SDF::SDF2SDF<T>;
+
+//! The CSDF::in_port is an alias for SDF::SDF_in
+template <typename T>
+using in_port = SDF::SDF_in<T>;
+
+//! The CSDF::out_port is an alias for SDF::SDF_out
+template <typename T>
+using out_port = SDF::SDF_out<T>;
+
+//! Abstract semantics of a process in the CSDF MoC
+/*! A CSDF process cycles through a fixed number of phases, and each
+ * firing of a phase consumes and produces the tokens given by the rates
+ * of the phase (see sdf_process::add_in_rate). The static scheduler
+ * (SDF::static_scheduler) and the buffer analysis (SDF::buffer_analysis)
+ * fire such processes phase by phase, hence a cycle needs no buffers for
+ * its tokens at once.
+ */
+class csdf_process : public SDF::sdf_process
+{
+public:
+    //! The constructor only passes the name to the base process
+    csdf_process(sc_module_name _name) : sdf_process(_name) {}
+    
+    //! The phase of the next firing
+    size_t phase() const {return cur_phase;}
+    
+protected:
+    //! Checks the number of phases of the rates of a port
+    void check_phases(const std::vector<unsigned int>& toks, size_t n, const char* what)
+    {
+        if (toks.size() != n)
+            SC_REPORT_ERROR(name(), (std::string("the rates of ") + what +
+                                     " should have one entry per phase").c_str());
+    }
+    
+    //! Starts from the first phase, called by the init stage
+    void reset_phase()
+    {
+        cur_phase = 0;
+        nphases = phases();
+    }
+    
+    //! Moves to the next phase, called at the end of the prod stage
+    void next_phase()
+    {
+        if (++cur_phase == nphases) cur_phase = 0;
+    }
+    
+#ifdef FORSYDE_COROUTINES
+    //! The rates change between the firings of the phases
+    bool has_dynamic_firing_rule() const {return true;}
+    
+    //! The firing rule of the phase of the next firing
+    void dynamic_firing_rule(std::vector<firing_port>& ins,
+                             std::vector<firing_port>& outs)
+    {
+        for (auto& r : in_rates) ins.push_back({r.channels, r.at(cur_phase)});
+        for (auto& r : out_rates) outs.push_back({r.channels, r.at(cur_phase)});
+    }
+#endif
+    
+private:
+    size_t cur_phase = 0, nphases = 1;
+};
+
+}
+}
+
+#endif
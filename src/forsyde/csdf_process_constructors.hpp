@@ -0,0 +1,390 @@
+/**********************************************************************
+    * csdf_process_constructors.hpp -- Process constructors in CSDF   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing basic process constructors for modeling      *
+    *          cyclo-static dataflow systems in ForSyDe-SystemC       *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CSDF_PROCESS_CONSTRUCTORS_HPP
+#define CSDF_PROCESS_CONSTRUCTORS_HPP
+
+/*! \file csdf_process_constructors.hpp
+ * \brief Implements the basic process constructors in the CSDF MoC
+ * 
+ *  This file includes the basic process constructors used for modeling
+ * in the cyclo-static dataflow model of computation. Their rates are
+ * given as vectors with one entry per phase, e.g., a decimator by three
+ * which reads a token in each of three phases and writes one in the
+ * last phase has the input rates {1,1,1} and the output rates {0,0,1}.
+ */
+
+#include <functional>
+#include <tuple>
+#include <vector>
+
+#include "csdf_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace CSDF
+{
+
+using namespace sc_core;
+using SDF::SDF_in;
+using SDF::SDF_out;
+
+//! Process constructor for a combinational cyclo-static actor with one input and one output
+/*! This class is used to build combinational processes with one input
+ * and one output whose rates change periodically. In each firing the
+ * function gets the input tokens of the current phase and the phase,
+ * and produces the output tokens of the phase. The class is
+ * parameterized for input and output data-types.
+ */
+template <typename T0, typename T1>
+class comb : public csdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+    SDF_out<T0> oport1;       ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(std::vector<T0>&, const std::vector<T1>&,
+                               size_t)> functype;
+
+    //! The constructor requires the module name and the rates of the phases
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    comb(sc_module_name _name,                  ///< process name
+         functype _func,                        ///< function to be passed
+         const std::vector<unsigned int>& o1toks,///< production rates of the phases
+         const std::vector<unsigned int>& i1toks ///< consumption rates of the phases
+         ) : csdf_process(_name), iport1("iport1"), oport1("oport1"),
+             o1toks(o1toks), i1toks(i1toks), _func(_func)
+    {
+        if (i1toks.empty())
+            SC_REPORT_ERROR(name(), "a cyclo-static process requires at least one phase");
+        check_phases(o1toks, i1toks.size(), "the output");
+        add_in_rate(iport1, i1toks);
+        add_out_rate(oport1, o1toks);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CSDF::comb";}
+
+private:
+    // production and consumption rates
+    std::vector<unsigned int> o1toks, i1toks;
+    
+    // Inputs and output variables
+    std::vector<T0> o1vals;
+    std::vector<T1> i1vals;
+    
+    //! The function passed to the process constructor
+    functype _func;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        reset_phase();
+    }
+    
+    void prep()
+    {
+        i1vals.resize(i1toks[phase()]);
+        iport1.read_n(i1vals, i1vals.size());
+    }
+    
+    void exec()
+    {
+        o1vals.resize(o1toks[phase()]);
+        _func(o1vals, i1vals, phase());
+        if (o1vals.size() != o1toks[phase()])
+            SC_REPORT_ERROR(name(), "the function produced a wrong number of tokens");
+    }
+    
+    void prod()
+    {
+        write_vec_multiport(oport1, o1vals);
+        next_phase();
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a cyclo-static delay element
+/*! It inserts a number of initial tokens with the given value at the
+ * beginning of the output stream and passes its inputs to its output
+ * untouched, forwarding the tokens of each phase in the same phase.
+ * Given the rates of its consumer, it lets the scheduler interleave the
+ * delay with the phases of the consumer.
+ * 
+ * It is mandatory to include at least one delay element in all feedback
+ * loops since combinational loops are forbidden in ForSyDe.
+ */
+template <class T>
+class delay : public csdf_process
+{
+public:
+    SDF_in<T>  iport1;       ///< port for the input channel
+    SDF_out<T> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name, the initial value and the rates
+    /*! It creates an SC_THREAD which inserts the initial elements, reads
+     * data from its input port, and writes them using the output port.
+     */
+    delay(sc_module_name _name,                 ///< process name
+          T init_val,                           ///< initial value
+          const std::vector<unsigned int>& toks={1},///< the tokens forwarded in the phases
+          unsigned int ntoks=1                  ///< the number of initial tokens
+          ) : csdf_process(_name), iport1("iport1"), oport1("oport1"),
+              init_val(init_val), toks(toks), ntoks(ntoks)
+    {
+        if (toks.empty())
+            SC_REPORT_ERROR(name(), "a cyclo-static process requires at least one phase");
+        add_in_rate(iport1, toks);
+        add_out_rate(oport1, toks, ntoks);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("init_val", init_val);
+        add_arg("toks", toks);
+        add_arg("ntoks", ntoks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CSDF::delay";}
+    
+private:
+    // Initial value
+    T init_val;
+    // the rates of the phases and the initial tokens
+    std::vector<unsigned int> toks;
+    unsigned int ntoks;
+    
+    // Inputs and output variables
+    std::vector<T> vals;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        reset_phase();
+        // the initial tokens are restored with the signal
+        if (!is_restored())
+            for (unsigned int i=0; i<ntoks; i++) write_multiport(oport1, init_val);
+    }
+    
+    void prep()
+    {
+        vals.resize(toks[phase()]);
+        iport1.read_n(vals, vals.size());
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_vec_multiport(oport1, vals);
+        next_phase();
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The cyclo-static zip process with two inputs and one output
+/*! In each phase, this process "zips" the tokens of the phase from the
+ * two incoming signals into one token of the outgoing signal of tuples.
+ */
+template <class T1, class T2>
+class zip : public csdf_process
+{
+public:
+    SDF_in<T1> iport1;        ///< port for the input channel 1
+    SDF_in<T2> iport2;        ///< port for the input channel 2
+    SDF_out<std::tuple<std::vector<T1>,std::vector<T2>>> oport1;///< port for the output channel
+
+    //! The constructor requires the module name and the rates of the phases
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * zips them together and writes the results using the output port
+     */
+    zip(sc_module_name _name,                   ///< process name
+        const std::vector<unsigned int>& i1toks,///< consumption rates of the first input
+        const std::vector<unsigned int>& i2toks ///< consumption rates of the second input
+    ) : csdf_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1"),
+        i1toks(i1toks), i2toks(i2toks)
+    {
+        if (i1toks.empty())
+            SC_REPORT_ERROR(name(), "a cyclo-static process requires at least one phase");
+        check_phases(i2toks, i1toks.size(), "the second input");
+        add_in_rate(iport1, i1toks);
+        add_in_rate(iport2, i2toks);
+        add_out_rate(oport1, std::vector<unsigned int>(i1toks.size(), 1));
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CSDF::zip";}
+    
+private:
+    std::vector<unsigned int> i1toks, i2toks;
+    
+    // intermediate values
+    std::vector<T1> ival1;
+    std::vector<T2> ival2;
+    
+    void init()
+    {
+        reset_phase();
+    }
+    
+    void prep()
+    {
+        ival1.resize(i1toks[phase()]);
+        ival2.resize(i2toks[phase()]);
+        iport1.read_n(ival1, ival1.size());
+        iport2.read_n(ival2, ival2.size());
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1,std::make_tuple(ival1,ival2));  // write to the output
+        next_phase();
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The cyclo-static unzip process with one input and two outputs
+/*! In each phase, this process "unzips" a token of tuples into the
+ * tokens of the phase of two separate signals.
+ */
+template <class T1, class T2>
+class unzip : public csdf_process
+{
+public:
+    SDF_in<std::tuple<std::vector<T1>,std::vector<T2>>> iport1;///< port for the input channel
+    SDF_out<T1> oport1;        ///< port for the output channel 1
+    SDF_out<T2> oport2;        ///< port for the output channel 2
+
+    //! The constructor requires the module name and the rates of the phases
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * unzips them and writes the results using the output ports
+     */
+    unzip(sc_module_name _name,
+          const std::vector<unsigned int>& o1toks,  ///< production rates of the first output
+          const std::vector<unsigned int>& o2toks   ///< production rates of the second output
+          )
+         :csdf_process(_name), iport1("iport1"), oport1("oport1"), oport2("oport2"),
+          o1toks(o1toks), o2toks(o2toks)
+    {
+        if (o1toks.empty())
+            SC_REPORT_ERROR(name(), "a cyclo-static process requires at least one phase");
+        check_phases(o2toks, o1toks.size(), "the second output");
+        add_in_rate(iport1, std::vector<unsigned int>(o1toks.size(), 1));
+        add_out_rate(oport1, o1toks);
+        add_out_rate(oport2, o2toks);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("o1toks", o1toks);
+        add_arg("o2toks", o2toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CSDF::unzip";}
+private:
+    // production rates
+    std::vector<unsigned int> o1toks, o2toks;
+    
+    // intermediate values
+    std::tuple<std::vector<T1>,std::vector<T2>> in_val;
+    
+    void init()
+    {
+        reset_phase();
+    }
+    
+    void prep()
+    {
+        in_val = iport1.read();
+    }
+    
+    void exec()
+    {
+        if (std::get<0>(in_val).size() != o1toks[phase()] ||
+            std::get<1>(in_val).size() != o2toks[phase()])
+            SC_REPORT_ERROR(name(), "the input token does not match the rates of the phase");
+    }
+    
+    void prod()
+    {
+        write_vec_multiport(oport1,std::get<0>(in_val));  // write to the output 1
+        write_vec_multiport(oport2,std::get<1>(in_val));  // write to the output 2
+        next_phase();
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(2);    // two output ports
+        boundOutChans[0].port = &oport1;
+        boundOutChans[1].port = &oport2;
+    }
+#endif
+};
+
+}
+}
+
+#endif
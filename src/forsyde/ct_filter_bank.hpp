@@ -0,0 +1,200 @@
+/**********************************************************************
+    * ct_filter_bank.hpp -- Batched integration of CT filters         *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Solving the steps of many fixed-step linear filters of *
+    *          the same order together, in vectorizable loops         *
+    *                                                                 *
+    * Usage:   Used by the elaboration optimizer                      *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef CT_FILTER_BANK_HPP
+#define CT_FILTER_BANK_HPP
+
+/*! \file ct_filter_bank.hpp
+ * \brief Implements the batched integration of the native CT filters
+ *
+ *  The mixed-signal models (e.g., the IR-UWB radar) often contain many
+ * fixed-step filters of the same order and with the same sampling
+ * period, each solving its own RK4 steps with small ublas matrices in
+ * its own thread. A filter bank takes over a group of such filters and
+ * solves the steps of all of them in a single thread, with the models
+ * and the states stored by lane (structure of arrays), so that the inner
+ * loops of the solver run over the filters and can be vectorized.
+ *
+ *  The filters keep their ports, signals and outputs. The elaboration
+ * optimizer groups the compatible native_filterf processes into banks
+ * automatically (see elab_optimizer).
+ */
+
+#include <vector>
+#include <string>
+
+#include "ct_lib.hpp"
+
+namespace ForSyDe
+{
+
+namespace CT
+{
+
+using namespace sc_core;
+
+//! A bank of fixed-step linear filters solved together
+/*! All the filters should have the same order and the same sampling
+ * period, hence they are sampled at the same times. In each step the
+ * bank samples the inputs of all the filters, solves one RK4 step for
+ * all of them with the same arithmetic as a single filter, and writes
+ * their outputs.
+ */
+template <typename T>
+class filterf_bank
+{
+public:
+    typedef typename basic_native_filterf<T>::S S;
+
+    //! Adds a filter to the bank if it is compatible with the others
+    /*! It should be called before the simulation starts, and returns
+     * false if the order or the sampling period of the filter differ from
+     * the ones of the bank.
+     */
+    bool add(basic_native_filterf<T>* f)
+    {
+        const size_t order = DDE::tf2ss_cached(f->numerators, f->denominators)->a.size1();
+        if (!filters.empty() &&
+            (order != n || f->sample_period != filters[0]->sample_period))
+            return false;
+        n = order;
+        filters.push_back(f);
+        return true;
+    }
+
+    //! The filters of the bank
+    const std::vector<basic_native_filterf<T>*>& members() const {return filters;}
+
+    //! The number of filters in the bank
+    size_t size() const {return filters.size();}
+
+    //! Hands over the execution of the filters to the bank
+    void take_over()
+    {
+        for (auto f : filters) f->set_ext_driven();
+    }
+
+    //! Runs the filters, in a SystemC thread
+    void run()
+    {
+        if (filters.empty()) return;
+        for (auto f : filters) f->ext_init();
+        load();
+        while (1)
+        {
+            for (auto f : filters) f->ext_prep();
+            auto f0 = filters[0];
+            const S h = S(in_seconds(f0->t - f0->t_1));
+            for (size_t k=0; k<K; k++)
+            {
+                u[k] = filters[k]->u;
+                u_1[k] = filters[k]->u_1;
+            }
+            step(h);
+            for (size_t k=0; k<K; k++)
+            {
+                filters[k]->y = y[k];
+                filters[k]->emit();
+                filters[k]->advance();
+            }
+            if (f0->t > model_time()) wait(f0->t - model_time());
+        }
+    }
+
+private:
+    std::vector<basic_native_filterf<T>*> filters;
+    size_t n = 0, K = 0;
+    bool companion = true;
+
+    // the models and the states by lane: element i (or i,j) of filter k
+    // is at index i*K+k (or (i*n+j)*K+k)
+    std::vector<S> a, b, c, d, x, xe, k1, k2, k3, k4, u, u_1, u_m, y, acc;
+
+    //! Copies the models of the initialized filters to the lanes
+    void load()
+    {
+        K = filters.size();
+        for (auto* v : {&b, &c, &x, &xe, &k1, &k2, &k3, &k4}) v->assign(n*K, S());
+        for (auto* v : {&d, &u, &u_1, &u_m, &y, &acc}) v->assign(K, S());
+        a.assign(n*n*K, S());
+        for (size_t k=0; k<K; k++)
+        {
+            auto f = filters[k];
+            companion = companion && f->companion;
+            for (size_t i=0; i<n; i++)
+            {
+                for (size_t j=0; j<n; j++) a[(i*n+j)*K+k] = f->a(i,j);
+                b[i*K+k] = f->b(i,0);
+                c[i*K+k] = f->c(0,i);
+                x[i*K+k] = f->x_1(i,0);
+            }
+            d[k] = f->d(0,0);
+        }
+    }
+
+    //! Evaluates a stage of all the filters: k = a*(x + s*kp) + b*uin
+    void stage(std::vector<S>& kk, const std::vector<S>* kp, S s, const std::vector<S>& uin)
+    {
+        if (kp)
+            for (size_t i=0; i<n*K; i++) xe[i] = x[i] + s*(*kp)[i];
+        const std::vector<S>& xs = kp ? xe : x;
+        if (companion && n > 0)
+        {
+            for (size_t k=0; k<K; k++) acc[k] = uin[k];
+            for (size_t j=0; j<n; j++)
+            {
+                const S* ar = &a[((n-1)*n+j)*K];
+                const S* xr = &xs[j*K];
+                for (size_t k=0; k<K; k++) acc[k] += ar[k] * xr[k];
+            }
+            for (size_t i=0; i+1<n; i++)
+                for (size_t k=0; k<K; k++) kk[i*K+k] = xs[(i+1)*K+k];
+            for (size_t k=0; k<K; k++) kk[(n-1)*K+k] = acc[k];
+            return;
+        }
+        for (size_t i=0; i<n; i++)
+        {
+            for (size_t k=0; k<K; k++) acc[k] = b[i*K+k] * uin[k];
+            for (size_t j=0; j<n; j++)
+            {
+                const S* ar = &a[(i*n+j)*K];
+                const S* xr = &xs[j*K];
+                for (size_t k=0; k<K; k++) acc[k] += ar[k] * xr[k];
+            }
+            for (size_t k=0; k<K; k++) kk[i*K+k] = acc[k];
+        }
+    }
+
+    //! Solves one RK4 step of all the filters, as DDE::rk4_step
+    void step(S h)
+    {
+        for (size_t k=0; k<K; k++) u_m[k] = (u_1[k] + u[k]) * 0.5;
+        stage(k1, NULL, 0, u_1);
+        stage(k2, &k1, h/2.0, u_m);
+        stage(k3, &k2, h/2.0, u_m);
+        stage(k4, &k3, h, u);
+        for (size_t k=0; k<K; k++) y[k] = d[k] * u[k];
+        for (size_t i=0; i<n; i++)
+            for (size_t k=0; k<K; k++)
+            {
+                const size_t e = i*K+k;
+                x[e] = x[e] + (k1[e] + 2.0*k2[e] + 2.0*k3[e] + k4[e]) * (h/6.0);
+                y[k] += c[e] * x[e];
+            }
+    }
+};
+
+}
+}
+
+#endif
@@ -67,10 +67,11 @@ inline comb2* make_comb2(std::string pName,
     typename comb2::functype _func,
     OIf& outS,
     I1If& inp1S,
-    I2If& inp2S
+    I2If& inp2S,
+    const sc_time& grid=SC_ZERO_TIME
     )
 {
-    auto p = new comb2(pName.c_str(), _func);
+    auto p = new comb2(pName.c_str(), _func, grid);
     
     (*p).iport1(inp1S);
     (*p).iport2(inp2S);
@@ -90,10 +91,11 @@ template <class OIf, class IIf, std::size_t N>
 inline combX<N>* make_combX(std::string pName,
     typename combX<N>::functype _func,
     OIf& outS,
-    std::array<IIf,N>& inpS
+    std::array<IIf,N>& inpS,
+    const sc_time& grid=SC_ZERO_TIME
     )
 {
-    auto p = new combX<N>(pName.c_str(), _func);
+    auto p = new combX<N>(pName.c_str(), _func, grid);
     
     for (int i=0;i<N;i++)
     	(*p).iport[i](inpS[i]);
@@ -219,16 +221,42 @@ inline sink* make_sink(std::string pName,
 template <class IIf>
 inline traceSig* make_traceSig(std::string pName,
     sc_time sampling_period,
-    IIf& inpS
+    IIf& inpS,
+    trace_format format=TRACE_TEXT,
+    unsigned decimation=1
     )
 {
-    auto p = new traceSig(pName.c_str(), sampling_period);
+    auto p = new traceSig(pName.c_str(), sampling_period, format, decimation);
     
     (*p).iport1(inpS);
     
     return p;
 }
 
+//! Helper function to construct a traceSigs process
+/*! This function is used to construct a traceSigs (SystemC module) and
+ * connect its input signals, which are traced in the given order.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <class IIf>
+inline traceSigs* make_traceSigs(std::string pName,
+    sc_time sampling_period,
+    const std::vector<IIf*>& inpS,
+    trace_format format=TRACE_TEXT,
+    unsigned decimation=1,
+    const std::vector<std::string>& names={}
+    )
+{
+    auto p = new traceSigs(pName.c_str(), sampling_period, format,
+                           decimation, names);
+    
+    for (auto s : inpS) (*p).iport(*s);
+    
+    return p;
+}
+
 //! Helper function to construct a fanout process
 /*! This function is used to construct a fanout process (SystemC module) and
  * connect its input and output signals.
@@ -250,6 +278,99 @@ inline fanout* make_fanout(std::string pName,
     return p;
 }
 
+//! Helper function to construct a coalesce process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class IIf, class OIf>
+inline coalesce* make_coalesce(std::string pName,
+    const sc_time& grid,
+    OIf& outS,
+    IIf& inpS
+    )
+{
+    auto p = new coalesce(pName.c_str(), grid);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+
+//! Helper function to construct a vcomb process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its vector-valued input and output signals, whose numbers of
+ * channels are inferred from the signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t M, std::size_t N>
+inline vcomb<N,M>* make_vcomb(std::string pName,
+    typename vcomb<N,M>::functype _func,
+    vsignal<M>& outS,
+    vsignal<N>& inp1S
+    )
+{
+    auto p = new vcomb<N,M>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a vcomb2 process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its vector-valued input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N>
+inline vcomb2<N>* make_vcomb2(std::string pName,
+    typename vcomb2<N>::functype _func,
+    vsignal<N>& outS,
+    vsignal<N>& inp1S,
+    vsignal<N>& inp2S
+    )
+{
+    auto p = new vcomb2<N>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a vtraceSig process
+/*! This function is used to construct a vtraceSig (SystemC module) and
+ * connect its vector-valued input signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <std::size_t N>
+inline vtraceSig<N>* make_vtraceSig(std::string pName,
+    sc_time sampling_period,
+    vsignal<N>& inpS,
+    trace_format format=TRACE_TEXT,
+    unsigned decimation=1,
+    const std::vector<std::string>& names={}
+    )
+{
+    auto p = new vtraceSig<N>(pName.c_str(), sampling_period, format,
+                              decimation, names);
+    
+    (*p).iport1(inpS);
+    
+    return p;
+}
 
 }
 }
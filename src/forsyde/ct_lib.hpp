@@ -16,6 +16,9 @@
 #include "ct_moc.hpp"
 #include "dde_moc.hpp"
 #include "mis.hpp"
+#include "random.hpp"
+
+#include <deque>
 
 /*! \file ct_lib.hpp
  * \brief Implements extra facilities on top of the CT MoC
@@ -166,20 +169,34 @@ inline square* make_square(std::string pName,
  * and one output. By passing a constant value to the constructor, the
  * process scales the inputs using it.
  */
-class scale : public comb
+template <typename T>
+class basic_scale : public basic_comb<T>
 {
 public:
-    scale(sc_module_name name_,             ///< The Process name
-           const CTTYPE& scaling_factor    ///< The scaling factor
-           ) : comb(name_, [=](CTTYPE& out1, const CTTYPE& inp1)
+    basic_scale(sc_module_name name_,       ///< The Process name
+           const T& scaling_factor         ///< The scaling factor
+           ) : basic_comb<T>(name_, [=](T& out1, const T& inp1)
                              {
                                 out1 = scaling_factor * inp1;
-                             }) {}
+                             }), scaling_factor(scaling_factor) {}
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::scale";}
+
+protected:
+    //! Scales the closed-form segments directly
+    basic_sub_signal<T> transform(const basic_sub_signal<T>& iv1)
+    {
+        return iv1 * scaling_factor;
+    }
+
+private:
+    T scaling_factor;
 };
 
+//! The scale process constructor of CTTYPE values
+typedef basic_scale<CTTYPE> scale;
+
 //! Helper function to construct a scale process
 /*! This function is used to construct a scale source and connect its
  * input and output signals.
@@ -206,19 +223,33 @@ inline scale* make_scale(std::string pName,
 /*! This class is used to build continuous-time processes with two inputs
  * and one output. The process adds its two inputs and produces the output.
  */
-class add : public comb2
+template <typename T>
+class basic_add : public basic_comb2<T>
 {
 public:
-    add(sc_module_name name_        ///< The Process name
-        ) : comb2(name_, [=](CTTYPE& out1, const CTTYPE& inp1, const CTTYPE& inp2)
+    basic_add(sc_module_name name_  ///< The Process name
+        ) : basic_comb2<T>(name_, [=](T& out1, const T& inp1, const T& inp2)
                              {
                                 out1 = inp1 + inp2;
                              }) {}
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::add";}
+
+protected:
+    //! Combines the closed-form segments directly
+    basic_sub_signal<T> combine(const basic_sub_signal<T>& iv1, const basic_sub_signal<T>& iv2,
+                                const sc_time& st, const sc_time& et)
+    {
+        basic_sub_signal<T> res = iv1 + iv2;
+        set_range(res, st, et);
+        return res;
+    }
 };
 
+//! The add process constructor of CTTYPE values
+typedef basic_add<CTTYPE> add;
+
 //! Helper function to construct an add process
 /*! This function is used to construct an adder and connect its
  * input and output signals.
@@ -258,6 +289,16 @@ public:
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::sub";}
+
+protected:
+    //! Combines the closed-form segments directly
+    sub_signal combine(const sub_signal& iv1, const sub_signal& iv2,
+                       const sc_time& st, const sc_time& et)
+    {
+        sub_signal res = iv1 - iv2;
+        set_range(res, st, et);
+        return res;
+    }
 };
 
 //! Helper function to construct a sub process
@@ -298,6 +339,16 @@ public:
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::mul";}
+
+protected:
+    //! Combines the closed-form segments directly
+    sub_signal combine(const sub_signal& iv1, const sub_signal& iv2,
+                       const sc_time& st, const sc_time& et)
+    {
+        sub_signal res = iv1 * iv2;
+        set_range(res, st, et);
+        return res;
+    }
 };
 
 //! Helper function to construct a mul process
@@ -323,6 +374,207 @@ inline mul* make_mul(std::string pName,
     return p;
 }
 
+//! Process constructor for a continuous-time process which scales a vector-valued input
+/*! This class is used to build continuous-time processes with one input
+ * and one output with N channels, which scales all the channels of the
+ * input using a constant value.
+ */
+template <std::size_t N>
+class vscale : public vcomb<N>
+{
+public:
+    vscale(sc_module_name name_,            ///< The Process name
+           const CTTYPE& scaling_factor     ///< The scaling factor
+           ) : vcomb<N>(name_, [=](ct_vector<N>& out1, const ct_vector<N>& inp1)
+                             {
+                                out1 = scaling_factor * inp1;
+                             }), scaling_factor(scaling_factor) {}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::vscale";}
+
+protected:
+    //! Scales the closed-form segments directly
+    vsub_signal<N> transform(const vsub_signal<N>& iv1)
+    {
+        return iv1 * scaling_factor;
+    }
+
+private:
+    CTTYPE scaling_factor;
+};
+
+//! Helper function to construct a vscale process
+/*! This function is used to construct a vscale process and connect its
+ * input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N>
+inline vscale<N>* make_vscale(std::string pName,
+    const CTTYPE& scaling_factor,       ///< The scaling factor
+    vsignal<N>& outS,
+    vsignal<N>& inpS
+    )
+{
+    auto p = new vscale<N>(pName.c_str(), scaling_factor);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Process constructor for a continuous-time process which adds its vector-valued inputs
+/*! This class is used to build continuous-time processes with two inputs
+ * and one output with N channels. The process adds its two inputs
+ * channel by channel and produces the output.
+ */
+template <std::size_t N>
+class vadd : public vcomb2<N>
+{
+public:
+    vadd(sc_module_name name_       ///< The Process name
+         ) : vcomb2<N>(name_, [=](ct_vector<N>& out1, const ct_vector<N>& inp1,
+                                  const ct_vector<N>& inp2)
+                             {
+                                out1 = inp1 + inp2;
+                             }) {}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::vadd";}
+
+protected:
+    //! Combines the closed-form segments directly
+    vsub_signal<N> combine(const vsub_signal<N>& iv1, const vsub_signal<N>& iv2,
+                           const sc_time& st, const sc_time& et)
+    {
+        vsub_signal<N> res = iv1 + iv2;
+        set_range(res, st, et);
+        return res;
+    }
+};
+
+//! Helper function to construct a vadd process
+/*! This function is used to construct a vector adder and connect its
+ * input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N>
+inline vadd<N>* make_vadd(std::string pName,
+    vsignal<N>& outS,
+    vsignal<N>& inp1S,
+    vsignal<N>& inp2S
+    )
+{
+    auto p = new vadd<N>(pName.c_str());
+
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+#ifdef FORSYDE_COUNTER_RNG
+//! Process constructor for a Gaussian randome wave generator
+/*! This class is used to create a continuous-time signal source which
+ * produces a Random signal based on the Gaussian distribution. The
+ * signal holds each sample for a sampling period. With
+ * FORSYDE_COUNTER_RNG, the samples are generated in blocks by a
+ * counter-based generator whose stream is derived from the process name.
+ */
+class gaussian : public ct_process
+{
+public:
+    CT_out oport1;          ///< port for the output channel
+
+    //! The constructor requires the module name and the generator parameters
+    /*!
+     */
+    gaussian(const sc_module_name& _name,   ///< Process name
+             const double& gaussVar,        ///< The variance
+             const double& gaussMean,       ///< The mean value
+             sc_time sample_period,         ///< sampling period
+             std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+            ) : ct_process(_name), oport1("oport1"),
+                dist{gaussMean, std::sqrt(gaussVar)},
+                rng(seed, counter_rng::stream_of(name())),
+                sample_period(sample_period)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("gaussVar", gaussVar);
+        add_arg("gaussMean", gaussMean);
+        add_arg("sample_period", sample_period);
+        add_arg("seed", seed);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::gaussian";}
+
+    //! The generator of the random stream, e.g., to reseed it or jump ahead
+    counter_rng& generator() {return rng;}
+
+private:
+    normal_dist dist;
+    counter_rng rng;
+    sc_time sample_period;
+
+    // the current block of samples and the next one to be produced
+    std::vector<CTTYPE> blk;
+    size_t idx;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        blk.resize(FORSYDE_RNG_BLOCK);
+        idx = blk.size();
+    }
+
+    void prep() {}
+
+    void exec()
+    {
+        if (idx < blk.size()) return;
+        dist.fill(rng, blk.data(), blk.size());
+        idx = 0;
+    }
+
+    void prod()
+    {
+        const sc_time st = model_time();
+        write_multiport(oport1,
+                        sub_signal::constant(st, st+sample_period, blk[idx++]));
+        wait(sample_period);
+    }
+
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, blk, idx, rng.position());
+    }
+
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t n;
+        restore_values(pos, blk, idx, n);
+        rng.discard(n - rng.position());
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+#else
 //! Process constructor for a Gaussian randome wave generator
 /*! This class is used to create a continuous-time signal source which
  * produces a Random signal based on the Gaussian distribution
@@ -352,6 +604,7 @@ SC_MODULE(gaussian)
         sy2ct1.oport1(oport1);
     }
 };
+#endif
 
 //! Helper function to construct a gaussian process
 /*! This function is used to construct a gaussian signal generator and
@@ -375,35 +628,528 @@ inline gaussian* make_gaussian(std::string pName,
     return p;
 }
 
+//! The value type of the solvers of the CT filters with values of type T
+/*! The floating-point types are solved in their own precision, e.g.,
+ * the filters of float signals run the solvers on float matrices. The
+ * other types, e.g., sc_fixed, are solved in CTTYPE and the outputs of
+ * the filters are quantized to T.
+ */
+template <typename T>
+using solver_type = typename std::conditional<std::is_floating_point<T>::value,
+                                              T, CTTYPE>::type;
+
+//! Reads the samples of a CT input which are requested out of order
+/*! The sub-signals are read as far as the requested instants need them
+ * and kept until they are released, since the adaptive solvers request
+ * the samples of a rejected step again.
+ */
+template <typename T>
+class ct_sampler
+{
+public:
+    //! Returns the value of the input at an instant
+    template <class Port>
+    T sample(Port& port, const sc_time& t)
+    {
+        while (segs.empty() || t >= get_end_time(segs.back()))
+            segs.push_back(port.read());
+        for (auto& s : segs)
+            if (t >= get_start_time(s) && t < get_end_time(s)) return s(t);
+        SC_REPORT_ERROR(port.name(), "the input is sampled before its released sub-signals");
+        return T();
+    }
+
+    //! Releases the sub-signals which end before an instant
+    void release(const sc_time& t)
+    {
+        while (!segs.empty() && get_end_time(segs.front()) <= t) segs.pop_front();
+    }
+
+    //! Drops all the sub-signals
+    void clear() {segs.clear();}
+
+private:
+    std::deque<basic_sub_signal<T>> segs;
+};
+
+//! Process constructor for implementing a linear filter natively in CT
+/*! This class is used to build a process which computes the same
+ * solution as the filter composite (CT2DDE, DDE::filter and DDE2CT),
+ * step by step and with the same step size control, but as a single CT
+ * process: the input samples of a step are taken from the input
+ * sub-signals directly, and the output is written as one sub-signal per
+ * accepted step, without the events and the sampling requests between
+ * the parts of the composite.
+ *
+ *  The output sub-signal of an accepted step holds the output of the
+ * previous step (HOLD), as DDE2CT does, or interpolates it linearly
+ * towards the new one (LINEAR).
+ *
+ *  With FORSYDE_CT_NATIVE_FILTERS defined, filter, filterf and the
+ * processes built on them (e.g., the integrators and pif) are native.
+ *
+ * The values are of type T, which is CTTYPE for native_filter.
+ */
+template <typename T>
+class basic_native_filter : public ct_process
+{
+public:
+    typedef solver_type<T> S;
+    typedef boost::numeric::ublas::matrix<S> MatrixDouble;
+
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel;
+
+    //! The constructor requires the module name and the filter parameters
+    /*! It creates an SC_THREAD which reads the input sub-signals, solves
+     * the filter and writes the output sub-signals.
+     */
+    basic_native_filter(sc_module_name _name,   ///< Process name
+           std::vector<T> numerators,           ///< Numerator constants
+           std::vector<T> denominators,         ///< Denominator constants
+           sc_time sample_period,               ///< sampling period (the maximum step)
+           sc_time min_step=sc_time(0.05,SC_NS),///< Minimum time step
+           double tol_error=1e-5,               ///< Tolerated error
+           DDE::ode_solver solver=DDE::RK4,     ///< The solver
+           A2DMode op_mode=HOLD                 ///< The output interpolation
+          ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
+              numerators(numerators.begin(), numerators.end()),
+              denominators(denominators.begin(), denominators.end()),
+              max_step(sample_period), min_step(min_step), tol_error(tol_error),
+              solver(solver), op_mode(op_mode)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("numerators", numerators);
+        add_arg("denominators", denominators);
+        add_arg("sample_period", sample_period);
+        add_arg("min_step", min_step);
+        add_arg("tol_error", tol_error);
+        add_arg("solver", solver);
+        add_arg("op_mode", op_mode);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::native_filter";}
+
+    //! The statistics of the solver since the start of the simulation
+    const solver_stats& statistics() const {return stats;}
+
+private:
+    // Constructor parameters
+    std::vector<S> numerators, denominators;
+    sc_time max_step, min_step;
+    S tol_error;
+    DDE::ode_solver solver;
+    A2DMode op_mode;
+
+    // The state-space model
+    MatrixDouble a, b, c, d;
+    bool companion;
+    // the state, the trial states and the stages of the solvers
+    MatrixDouble x, x0, x1, x2, k1, k2, k3, k4, w;
+    std::array<MatrixDouble,7> ks;
+    bool k0_valid;
+    std::vector<size_t> piv;
+    // the last committed input and time, and the samples of the step
+    S u_1, u1, u0;
+    sc_time t_1, t, t2, step, samplingTimeTag;
+    // the accepted output of the step, and the one held since prevT
+    bool accepted;
+    S y_acc;
+    sc_time t_acc, prevT;
+    T prevVal;
+    basic_sub_signal<T> out_ss;
+    ct_sampler<T> in;
+    // The statistics of the solver
+    solver_stats stats;
+    // to prevent rounding error
+    const double roundingFactor = 1.0001;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        auto model = DDE::tf2ss_cached(numerators, denominators);
+        a = model->a;
+        b = model->b;
+        c = model->c;
+        d = model->d;
+        companion = model->companion;
+        const size_t n = a.size1();
+        x = x0 = x1 = x2 = boost::numeric::ublas::zero_matrix<S>(n,1);
+        k1 = k2 = k3 = k4 = MatrixDouble(n,1);
+        for (auto& k : ks) k = MatrixDouble(n,1);
+        k0_valid = false;
+        w = MatrixDouble(n,n);
+        piv.resize(n);
+        step = max_step;
+        samplingTimeTag = SC_ZERO_TIME;
+        stats = solver_stats();
+        in.clear();
+        // the initial output at zero is not held by the output, as in DDE2CT
+        u_1 = S(in.sample(iport1, SC_ZERO_TIME));
+        t_1 = SC_ZERO_TIME;
+        prevT = SC_ZERO_TIME;
+        prevVal = T();
+    }
+
+    void prep()
+    {
+        // the samples in the middle and at the end of the step
+        t = samplingTimeTag + step/2;
+        t2 = samplingTimeTag + step;
+        u1 = S(in.sample(iport1, t));
+        u0 = S(in.sample(iport1, t2));
+    }
+
+    void exec()
+    {
+        accepted = false;
+        if (solver == DDE::RK4) exec_rk4();
+        else exec_embedded();
+        if (!accepted) return;
+        // the output sub-signal up to the accepted output
+        if (op_mode == HOLD)
+            out_ss = basic_sub_signal<T>::constant(prevT, t_acc, prevVal);
+        else
+            out_ss = basic_sub_signal<T>::linear(prevT, t_acc, prevVal,
+                        (T(y_acc) - prevVal)/in_seconds(t_acc - prevT));
+    }
+
+    void prod()
+    {
+        if (!accepted) return;
+        in.release(samplingTimeTag);
+        write_multiport(oport1, out_ss);
+        if (t_acc > model_time()) wait(t_acc - model_time());
+        prevT = t_acc;
+        prevVal = T(y_acc);
+    }
+
+    void clean()
+    {
+#ifdef FORSYDE_PROFILE
+        prof.solver = stats;
+#endif
+    }
+
+    //! A step of the RK4 solver with the step doubling error estimate
+    /*! The step size is not adapted, as in DDE::filter.
+     */
+    void exec_rk4()
+    {
+        S y0, y1, y2;
+        const sc_time h = t2 - t_1;
+        DDE::rk4_step(a, b, c, d, u1, u_1, x, S(in_seconds(t - t_1)), k1, k2, k3, k4, x1, y1, companion);
+        DDE::rk4_step(a, b, c, d, u0, u_1, x, S(in_seconds(h)), k1, k2, k3, k4, x0, y0, companion);
+        DDE::rk4_step(a, b, c, d, u0, u1, x1, S(in_seconds(h/2)), k1, k2, k3, k4, x2, y2, companion);
+        stats.rhs_evals += 12;
+        const double err_est = (double) std::abs(y2-y0)/in_seconds(h);
+        if (err_est < tol_error || h <= roundingFactor*min_step)
+        {
+            x = x0;
+            samplingTimeTag = t;
+            accept_step(y0, t);
+            stats.accept(in_seconds(h), in_seconds(max_step));
+            if (err_est >= tol_error) report_min_step(stats, name());
+        }
+        else
+            // the same step would be rejected again
+            SC_REPORT_ERROR(name(), "the error of the RK4 solver is not tolerated with the maximum step");
+    }
+
+    //! A step of the solvers with embedded error estimates
+    void exec_embedded()
+    {
+        const sc_time h = t2 - t_1;
+        const S hs = in_seconds(h);
+        const S us[3] = {u_1, u1, u0};
+        S yn, err;
+        unsigned order;
+        // the first stage is reused from the last step
+        const unsigned reused = k0_valid;
+        switch (solver)
+        {
+        case DDE::BOGACKI_SHAMPINE:
+            DDE::erk_step(DDE::bogacki_shampine_tableau(), a, b, c, d, us, x, hs, ks, k0_valid, x0, yn, err, companion);
+            order = DDE::bogacki_shampine_tableau().order;
+            stats.rhs_evals += 4 - reused;
+            break;
+        case DDE::DORMAND_PRINCE:
+            DDE::erk_step(DDE::dormand_prince_tableau(), a, b, c, d, us, x, hs, ks, k0_valid, x0, yn, err, companion);
+            order = DDE::dormand_prince_tableau().order;
+            stats.rhs_evals += 7 - reused;
+            break;
+        default:
+            if (!DDE::ros2_step(a, b, c, d, us, x, hs, w, piv, ks[0], ks[1], x1, x0, yn, err, companion))
+                SC_REPORT_ERROR(name(), "singular iteration matrix in the Rosenbrock solver");
+            order = 2;
+            stats.rhs_evals += 2;
+        }
+
+        const double err_est = (double) err/hs;
+        const bool at_min = h <= roundingFactor*min_step;
+        if (err_est < tol_error || at_min)
+        {
+            x = x0;
+            // the last stage is the first one of the next step (FSAL)
+            if (solver == DDE::BOGACKI_SHAMPINE) ks[0].swap(ks[3]);
+            if (solver == DDE::DORMAND_PRINCE) ks[0].swap(ks[6]);
+            samplingTimeTag = t2;
+            accept_step(yn, t2);
+            stats.accept(hs, in_seconds(max_step));
+            if (err_est >= tol_error) report_min_step(stats, name());
+        }
+        else
+            stats.rejected++;
+
+        // step size control
+        double fac = err_est > 0 ? 0.9*std::pow(tol_error/err_est, 1.0/order) : 5.0;
+        fac = std::min(5.0, std::max(0.2, fac));
+        step = std::min(max_step, std::max(min_step, h*fac));
+    }
+
+    //! Commits the input of an accepted step and records its output
+    void accept_step(S y, const sc_time& ty)
+    {
+        u_1 = u0;
+        t_1 = ty;
+        y_acc = y;
+        t_acc = ty;
+        accepted = true;
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The native linear filter of CTTYPE values
+typedef basic_native_filter<CTTYPE> native_filter;
+
+//! Process constructor for implementing a linear filter with fixed step natively in CT
+/*! This class is used to build a process which computes the same
+ * solution as the filterf composite (CT2DDEf, DDE::filterf and DDE2CT)
+ * as a single CT process, which samples its input sub-signals once per
+ * period and writes one output sub-signal per period.
+ *
+ * The values are of type T, which is CTTYPE for native_filterf.
+ */
+template <typename T>
+class basic_native_filterf : public ct_process
+{
+public:
+    typedef solver_type<T> S;
+    typedef boost::numeric::ublas::matrix<S> MatrixDouble;
+
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel;
+
+    //! The constructor requires the module name and the filter parameters
+    /*! It creates an SC_THREAD which reads the input sub-signals, solves
+     * the filter and writes the output sub-signals.
+     */
+    basic_native_filterf(sc_module_name _name,  ///< Process name
+           std::vector<T> numerators,           ///< Numerator constants
+           std::vector<T> denominators,         ///< Denominator constants
+           sc_time sample_period,               ///< sampling period
+           A2DMode op_mode=HOLD                 ///< The output interpolation
+          ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
+              numerators(numerators.begin(), numerators.end()),
+              denominators(denominators.begin(), denominators.end()),
+              sample_period(sample_period), op_mode(op_mode)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("numerators", numerators);
+        add_arg("denominators", denominators);
+        add_arg("sample_period", sample_period);
+        add_arg("op_mode", op_mode);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::native_filterf";}
+
+    //! The statistics of the solver since the start of the simulation
+    const solver_stats& statistics() const {return stats;}
+
+private:
+    // Constructor parameters
+    std::vector<S> numerators, denominators;
+    sc_time sample_period;
+    A2DMode op_mode;
+
+    // The state-space model
+    MatrixDouble a, b, c, d;
+    bool companion;
+    // the state and the stages of the solver
+    MatrixDouble x, x_1, k1, k2, k3, k4;
+    // the previous input and its time, and the current sample
+    S u, u_1, y;
+    sc_time t, t_1;
+    // the output held since t_1
+    T prevVal;
+    basic_sub_signal<T> out_ss;
+    ct_sampler<T> in;
+    // The statistics of the solver
+    solver_stats stats;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        auto model = DDE::tf2ss_cached(numerators, denominators);
+        a = model->a;
+        b = model->b;
+        c = model->c;
+        d = model->d;
+        companion = model->companion;
+        const size_t n = a.size1();
+        x = x_1 = boost::numeric::ublas::zero_matrix<S>(n,1);
+        k1 = k2 = k3 = k4 = MatrixDouble(n,1);
+        stats = solver_stats();
+        in.clear();
+        // the initial output at zero is not held by the output, as in DDE2CT
+        u_1 = S(in.sample(iport1, SC_ZERO_TIME));
+        t_1 = SC_ZERO_TIME;
+        prevVal = T();
+    }
+
+    void prep()
+    {
+        t = t_1 + sample_period;
+        in.release(t_1);
+        u = S(in.sample(iport1, t));
+    }
+
+    void exec()
+    {
+        DDE::rk4_step(a, b, c, d, u, u_1, x_1, S(in_seconds(t - t_1)), k1, k2, k3, k4, x, y, companion);
+        emit();
+    }
+
+    void prod()
+    {
+        advance();
+        if (t > model_time()) wait(t - model_time());
+    }
+
+    // The parts of a step around the solver, also used by filterf_bank
+    // which solves the steps of many filters at once
+    void emit()
+    {
+        stats.accept(in_seconds(sample_period), in_seconds(sample_period));
+        stats.rhs_evals += 4;
+        if (op_mode == HOLD)
+            out_ss = basic_sub_signal<T>::constant(t_1, t, prevVal);
+        else
+            out_ss = basic_sub_signal<T>::linear(t_1, t, prevVal,
+                        (T(y) - prevVal)/in_seconds(t - t_1));
+    }
+
+    void advance()
+    {
+        x_1 = x;
+        u_1 = u;
+        t_1 = t;
+        prevVal = T(y);
+        write_multiport(oport1, out_ss);
+    }
+
+    template <typename> friend class filterf_bank;
+
+    void clean()
+    {
+#ifdef FORSYDE_PROFILE
+        prof.solver = stats;
+#endif
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The native linear filter with fixed step of CTTYPE values
+typedef basic_native_filterf<CTTYPE> native_filterf;
+
+//! Helper function to construct a native linear filter
+/*! This function is used to construct a native CT filter and connect
+ * its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_native_filter<T>* make_native_filter(std::string pName,
+    const std::vector<T> numerators,        ///< Numerator constants
+    const std::vector<T> denominators,      ///< Denominator constants
+    const sc_time sample_period,            ///< sampling period
+    OIf& outS,
+    I1If& inp1S,
+    DDE::ode_solver solver=DDE::RK4,        ///< The solver
+    A2DMode op_mode=HOLD                    ///< The output interpolation
+    )
+{
+    auto p = new basic_native_filter<T>(pName.c_str(), numerators, denominators, sample_period,
+                                        sc_time(0.05,SC_NS), 1e-5, solver, op_mode);
+
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+#ifndef FORSYDE_CT_NATIVE_FILTERS
+
 //! Process constructor for implementing a linear filter
 /*! This class is used to build a process which implements a linear
  * in the CT MoC filter based on the numerator and denominator constants.
  * It internally uses a DDE filter together with CT2DDE and DDE2CT MoC
  * interfaces.
+ *
+ * The values are of type T, which is CTTYPE for filter.
  */
-SC_MODULE(filter)
+template <typename T>
+struct basic_filter : public sc_module
 {
-    CT_in iport1;           ///< port for the input channel
-    CT_out oport1;          ///< port for the output channel;
+    typedef solver_type<T> S;
 
-    CT2DDE<CTTYPE> ct2de1;
-    DDE::filter<CTTYPE> filter1;
-    DDE2CT<CTTYPE> de2ct1;
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel;
 
-    DDE::DDE2DDE<CTTYPE> inp_sig, out_sig;
+    CT2DDE<S,T> ct2de1;
+    DDE::filter<S> filter1;
+    DDE2CT<S,T> de2ct1;
+
+    DDE::DDE2DDE<S> inp_sig, out_sig;
     DDE::DDE2DDE<unsigned int> smp_sig;
 
     //! The constructor requires the module name and the filter parameters
     /*!
      */
-    filter(sc_module_name _name,            ///< Process name
-           std::vector<CTTYPE> numerators,  ///< Numerator constants
-           std::vector<CTTYPE> denominators,///< Denominator constants
+    basic_filter(sc_module_name _name,      ///< Process name
+           std::vector<T> numerators,       ///< Numerator constants
+           std::vector<T> denominators,     ///< Denominator constants
            sc_time sample_period,           ///< sampling period
            sc_time min_step=sc_time(0.05,SC_NS),///< Minimum time step
-           double tol_error=1e-5            ///< Tolerated error
+           double tol_error=1e-5,           ///< Tolerated error
+           DDE::ode_solver solver=DDE::RK4  ///< The solver
           ) : sc_module(_name), ct2de1("ct2de1"),
-              filter1("filter1", numerators, denominators, sample_period, min_step, tol_error),
+              filter1("filter1", std::vector<S>(numerators.begin(), numerators.end()),
+                      std::vector<S>(denominators.begin(), denominators.end()),
+                      sample_period, min_step, tol_error, solver),
               de2ct1("de2ct1", HOLD)
     {
         ct2de1.iport1(iport1);
@@ -419,6 +1165,17 @@ SC_MODULE(filter)
     }
 };
 
+#else
+
+//! The linear filters are the native ones
+template <typename T>
+using basic_filter = basic_native_filter<T>;
+
+#endif
+
+//! The linear filter of CTTYPE values
+typedef basic_filter<CTTYPE> filter;
+
 //! Helper function to construct a linear process
 /*! This function is used to construct a CT filter and connect its
  * input and output signals.
@@ -426,16 +1183,18 @@ SC_MODULE(filter)
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class I1If>
-inline filter* make_filter(std::string pName,
-    const std::vector<CTTYPE> numerators,  ///< Numerator constants
-    const std::vector<CTTYPE> denominators,///< Denominator constants
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_filter<T>* make_filter(std::string pName,
+    const std::vector<T> numerators,        ///< Numerator constants
+    const std::vector<T> denominators,      ///< Denominator constants
     const sc_time sample_period,            ///< sampling period
     OIf& outS,
-    I1If& inp1S
+    I1If& inp1S,
+    DDE::ode_solver solver=DDE::RK4         ///< The solver
     )
 {
-    auto p = new filter(pName.c_str(), numerators, denominators, sample_period);
+    auto p = new basic_filter<T>(pName.c_str(), numerators, denominators, sample_period,
+                                 sc_time(0.05,SC_NS), 1e-5, solver);
 
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -443,33 +1202,128 @@ inline filter* make_filter(std::string pName,
     return p;
 }
 
+//! Process constructor for implementing a linear filter given its state-space model
+/*! This class is used to build a process similar to filter, where the
+ * filter is given by the matrices of a single-input single-output
+ * state-space model. It internally uses a DDE ss_filter together with
+ * CT2DDE and DDE2CT MoC interfaces.
+ *
+ * The values are of type T, which is CTTYPE for ss_filter.
+ */
+template <typename T>
+struct basic_ss_filter : public sc_module
+{
+    typedef solver_type<T> S;
+
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel;
+
+    CT2DDE<S,T> ct2de1;
+    DDE::ss_filter<S> filter1;
+    DDE2CT<S,T> de2ct1;
+
+    DDE::DDE2DDE<S> inp_sig, out_sig;
+    DDE::DDE2DDE<unsigned int> smp_sig;
+
+    //! The constructor requires the module name and the filter parameters
+    /*!
+     */
+    basic_ss_filter(sc_module_name _name,   ///< Process name
+           const boost::numeric::ublas::matrix<T>& a, ///< The state matrix
+           const boost::numeric::ublas::matrix<T>& b, ///< The input matrix
+           const boost::numeric::ublas::matrix<T>& c, ///< The output matrix
+           const boost::numeric::ublas::matrix<T>& d, ///< The feedthrough matrix
+           sc_time sample_period,           ///< sampling period
+           sc_time min_step=sc_time(0.05,SC_NS),///< Minimum time step
+           double tol_error=1e-5,           ///< Tolerated error
+           DDE::ode_solver solver=DDE::RK4  ///< The solver
+          ) : sc_module(_name), ct2de1("ct2de1"),
+              filter1("filter1", boost::numeric::ublas::matrix<S>(a),
+                      boost::numeric::ublas::matrix<S>(b),
+                      boost::numeric::ublas::matrix<S>(c),
+                      boost::numeric::ublas::matrix<S>(d),
+                      sample_period, min_step, tol_error, solver),
+              de2ct1("de2ct1", HOLD)
+    {
+        ct2de1.iport1(iport1);
+        ct2de1.iport2(smp_sig);
+        ct2de1.oport1(inp_sig);
+
+        filter1.iport1(inp_sig);
+        filter1.oport1(out_sig);
+        filter1.oport2(smp_sig);
+
+        de2ct1.iport1(out_sig);
+        de2ct1.oport1(oport1);
+    }
+};
+
+//! The state-space filter of CTTYPE values
+typedef basic_ss_filter<CTTYPE> ss_filter;
+
+//! Helper function to construct a state-space filter process
+/*! This function is used to construct a CT state-space filter and
+ * connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_ss_filter<T>* make_ss_filter(std::string pName,
+    const boost::numeric::ublas::matrix<T>& a, ///< The state matrix
+    const boost::numeric::ublas::matrix<T>& b, ///< The input matrix
+    const boost::numeric::ublas::matrix<T>& c, ///< The output matrix
+    const boost::numeric::ublas::matrix<T>& d, ///< The feedthrough matrix
+    const sc_time sample_period,            ///< sampling period
+    OIf& outS,
+    I1If& inp1S,
+    DDE::ode_solver solver=DDE::RK4         ///< The solver
+    )
+{
+    auto p = new basic_ss_filter<T>(pName.c_str(), a, b, c, d, sample_period,
+                                    sc_time(0.05,SC_NS), 1e-5, solver);
+
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+#ifndef FORSYDE_CT_NATIVE_FILTERS
+
 //! Process constructor for implementing a linear filter with fixed step
 /*! This class is used to build a process which implements a linear
  * in the CT MoC filter with fixed step based on the numerator and
  * denominator constants.
  * It internally uses a DDE filter together with CT2DDEf and DDE2CT
  * MoC interfaces.
+ *
+ * The values are of type T, which is CTTYPE for filterf.
  */
-SC_MODULE(filterf)
+template <typename T>
+struct basic_filterf : public sc_module
 {
-    CT_in iport1;           ///< port for the input channel
-    CT_out oport1;          ///< port for the output channel;
+    typedef solver_type<T> S;
+
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel;
 
-    CT2DDEf<CTTYPE> ct2de1;
-    DDE::filterf<CTTYPE> filter1;
-    DDE2CT<CTTYPE> de2ct1;
+    CT2DDEf<S,T> ct2de1;
+    DDE::filterf<S> filter1;
+    DDE2CT<S,T> de2ct1;
 
-    DDE::DDE2DDE<CTTYPE> inp_sig, out_sig;
+    DDE::DDE2DDE<S> inp_sig, out_sig;
 
     //! The constructor requires the module name and the filter parameters
     /*!
      */
-    filterf(sc_module_name _name,            ///< Process name
-           std::vector<CTTYPE> numerators,  ///< Numerator constants
-           std::vector<CTTYPE> denominators,///< Denominator constants
+    basic_filterf(sc_module_name _name,     ///< Process name
+           std::vector<T> numerators,       ///< Numerator constants
+           std::vector<T> denominators,     ///< Denominator constants
            sc_time sample_period             ///< sampling period
           ) : sc_module(_name), ct2de1("ct2de1", sample_period),
-              filter1("filter1", numerators, denominators),
+              filter1("filter1", std::vector<S>(numerators.begin(), numerators.end()),
+                      std::vector<S>(denominators.begin(), denominators.end())),
               de2ct1("de2ct1", HOLD)
     {
         ct2de1.iport1(iport1);
@@ -483,6 +1337,17 @@ SC_MODULE(filterf)
     }
 };
 
+#else
+
+//! The linear filters with fixed step are the native ones
+template <typename T>
+using basic_filterf = basic_native_filterf<T>;
+
+#endif
+
+//! The linear filter with fixed step of CTTYPE values
+typedef basic_filterf<CTTYPE> filterf;
+
 //! Helper function to construct a linear process with fixed step size
 /*! This function is used to construct a CT filter and connect its
  * input and output signals.
@@ -490,16 +1355,16 @@ SC_MODULE(filterf)
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class I1If>
-inline filterf* make_filterf(std::string pName,
-    const std::vector<CTTYPE> numerators,  ///< Numerator constants
-    const std::vector<CTTYPE> denominators,///< Denominator constants
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_filterf<T>* make_filterf(std::string pName,
+    const std::vector<T> numerators,        ///< Numerator constants
+    const std::vector<T> denominators,      ///< Denominator constants
     const sc_time sample_period,            ///< sampling period
     OIf& outS,
     I1If& inp1S
     )
 {
-    auto p = new filterf(pName.c_str(), numerators, denominators, sample_period);
+    auto p = new basic_filterf<T>(pName.c_str(), numerators, denominators, sample_period);
 
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -509,22 +1374,23 @@ inline filterf* make_filterf(std::string pName,
 
 //! Helper function to construct an integrator
 /*! This function is used to construct a CT integrator and connect its
- * input and output signals.
+ * input and output signals. The value type T is CTTYPE unless it is
+ * given.
  * It provides a more functional style definition of a ForSyDe process.
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class I1If>
-inline filter* make_integrator(std::string pName,
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_filter<T>* make_integrator(std::string pName,
     const sc_time sample_period,            ///< sampling period
     OIf& outS,
     I1If& inp1S
     )
 {
-    std::vector<CTTYPE> numerators = {1.0};
-    std::vector<CTTYPE> denominators = {1.0, 0.0};
+    std::vector<T> numerators = {T(1.0)};
+    std::vector<T> denominators = {T(1.0), T(0.0)};
 
-    auto p = new filter(pName.c_str(), numerators, denominators, sample_period);
+    auto p = new basic_filter<T>(pName.c_str(), numerators, denominators, sample_period);
 
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -534,22 +1400,23 @@ inline filter* make_integrator(std::string pName,
 
 //! Helper function to construct an integrator with fixed step size
 /*! This function is used to construct a CT integrator with fixed step
- * size and connect its input and output signals.
+ * size and connect its input and output signals. The value type T is
+ * CTTYPE unless it is given.
  * It provides a more functional style definition of a ForSyDe process.
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class I1If>
-inline filterf* make_integratorf(std::string pName,
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_filterf<T>* make_integratorf(std::string pName,
     const sc_time sample_period,            ///< sampling period
     OIf& outS,
     I1If& inp1S
     )
 {
-    std::vector<CTTYPE> numerators = {1.0};
-    std::vector<CTTYPE> denominators = {1.0, 0.0};
+    std::vector<T> numerators = {T(1.0)};
+    std::vector<T> denominators = {T(1.0), T(0.0)};
 
-    auto p = new filterf(pName.c_str(), numerators, denominators, sample_period);
+    auto p = new basic_filterf<T>(pName.c_str(), numerators, denominators, sample_period);
 
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -561,28 +1428,33 @@ inline filterf* make_integratorf(std::string pName,
 /*! This class is used to build a PI controller with fixed step size
  * based on the proportional and integral gain parameters.
  * It internally uses a scale, an integrator and an adder.
+ *
+ * The values are of type T, which is CTTYPE for pif.
  */
-SC_MODULE(pif)
+template <typename T>
+struct basic_pif : public sc_module
 {
-    CT_in iport1;           ///< port for the input channel
-    CT_out oport1;          ///< port for the output channel;
+    typedef T value_type;
 
-    fanout fanout1;
-    scale scale1;
-    filterf integrator1;
-    add add1;
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel;
 
-    signal fan2p, fan2i, p2add, i2add;
+    basic_fanout<T> fanout1;
+    basic_scale<T> scale1;
+    basic_filterf<T> integrator1;
+    basic_add<T> add1;
+
+    typename ct_types<T>::signal fan2p, fan2i, p2add, i2add;
 
     //! The constructor requires the module name and the gains
     /*!
      */
-    pif(sc_module_name _name,       ///< Process name
-           const CTTYPE& kp,        ///< Numerator constants
-           const CTTYPE& ki,        ///< Denominator constants
+    basic_pif(sc_module_name _name, ///< Process name
+           const T& kp,             ///< Numerator constants
+           const T& ki,             ///< Denominator constants
            sc_time sample_period    ///< sampling period
           ) : sc_module(_name), fanout1("fanout1"), scale1("scale1", kp),
-              integrator1("integrator1", {ki}, {1,0}, sample_period),
+              integrator1("integrator1", {ki}, {T(1),T(0)}, sample_period),
               add1("add1")
     {
         fanout1.iport1(iport1);
@@ -601,23 +1473,27 @@ SC_MODULE(pif)
     }
 };
 
+//! The PI controller with fixed step of CTTYPE values
+typedef basic_pif<CTTYPE> pif;
+
 //! Helper function to construct a PI controller with fixed step size
 /*! This function is used to construct a PI controller with fixed step
- * size and connect its input and output signals.
+ * size and connect its input and output signals. The value type T is
+ * CTTYPE unless it is given.
  * It provides a more functional style definition of a ForSyDe process.
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class I1If>
-inline pif* make_pif(std::string pName,
-    const CTTYPE& kp,
-    const CTTYPE& ki,
+template <class T=CTTYPE, class OIf, class I1If>
+inline basic_pif<T>* make_pif(std::string pName,
+    const typename basic_pif<T>::value_type& kp,
+    const typename basic_pif<T>::value_type& ki,
     const sc_time sample_period,
     OIf& outS,
     I1If& inp1S
     )
 {
-    auto p = new pif(pName.c_str(), kp, ki, sample_period);
+    auto p = new basic_pif<T>(pName.c_str(), kp, ki, sample_period);
 
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -85,6 +85,102 @@ public:
 //! The CT::out_port is an alias for CT::CT_out
 using out_port = CT_out;
 
+//! The signal used to inter-connect CT processes with values of type T
+/*! The value type of CT2CT is CTTYPE, while other types (e.g., float or
+ * sc_fixed) can be used to simulate signal chains with the precision or
+ * the numerics of the hardware.
+ */
+template <typename T>
+class basic_CT2CT: public ForSyDe::signal<T,basic_sub_signal<T>>
+{
+public:
+    basic_CT2CT() : ForSyDe::signal<T,basic_sub_signal<T>>() {}
+    basic_CT2CT(sc_module_name name, unsigned size) : ForSyDe::signal<T,basic_sub_signal<T>>(name, size) {}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "CT";
+    }
+#endif
+};
+
+//! The basic_CT_in port is used for input ports of CT processes with values of type T
+template <typename T>
+class basic_CT_in: public ForSyDe::in_port<T,basic_sub_signal<T>,basic_CT2CT<T>>
+{
+public:
+    basic_CT_in() : ForSyDe::in_port<T,basic_sub_signal<T>,basic_CT2CT<T>>(){}
+    basic_CT_in(const char* name) : ForSyDe::in_port<T,basic_sub_signal<T>,basic_CT2CT<T>>(name){}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "CT";
+    }
+#endif
+};
+
+//! The basic_CT_out port is used for output ports of CT processes with values of type T
+template <typename T>
+class basic_CT_out: public ForSyDe::out_port<T,basic_sub_signal<T>,basic_CT2CT<T>>
+{
+public:
+    basic_CT_out() : ForSyDe::out_port<T,basic_sub_signal<T>,basic_CT2CT<T>>(){}
+    basic_CT_out(const char* name) : ForSyDe::out_port<T,basic_sub_signal<T>,basic_CT2CT<T>>(name){}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "CT";
+    }
+#endif
+};
+
+//! The signal and ports of the CT MoC with values of type T
+/*! The ones of CTTYPE are CT2CT, CT_in and CT_out, so that the processes
+ * which are templated on the value type connect to the other CT
+ * processes when they are used with CTTYPE.
+ */
+template <typename T>
+struct ct_types
+{
+    typedef basic_CT2CT<T> signal;
+    typedef basic_CT_in<T> in_port;
+    typedef basic_CT_out<T> out_port;
+};
+
+template <>
+struct ct_types<CTTYPE>
+{
+    typedef CT2CT signal;
+    typedef CT_in in_port;
+    typedef CT_out out_port;
+};
+
+//! The CT::tsignal is the signal of CT processes with values of type T
+template <typename T>
+using tsignal = typename ct_types<T>::signal;
+
+//! The signal used to inter-connect CT processes with N-channel vector values
+/*! A vector-valued signal carries one sub-signal per step for all its
+ * channels, instead of N scalar signals.
+ */
+template <std::size_t N>
+using CT2CTv = basic_CT2CT<ct_vector<N>>;
+
+//! The CT::vsignal is an alias for CT::CT2CTv
+template <std::size_t N>
+using vsignal = CT2CTv<N>;
+
+//! The CT_vin port is used for vector-valued input ports of CT processes
+template <std::size_t N>
+using CT_vin = basic_CT_in<ct_vector<N>>;
+
+//! The CT_vout port is used for vector-valued output ports of CT processes
+template <std::size_t N>
+using CT_vout = basic_CT_out<ct_vector<N>>;
+
 //! Abstract semantics of a process in the CT MoC
 typedef ForSyDe::process ct_process;
 
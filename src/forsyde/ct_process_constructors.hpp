@@ -28,6 +28,10 @@
 
 #include "sub_signal.hpp"
 #include "ct_process.hpp"
+#include "trace_writer.hpp"
+#ifdef FORSYDE_MULTITHREADED
+#include "data_parallel_pool.hpp"
+#endif
 
 namespace ForSyDe
 {
@@ -42,39 +46,56 @@ using namespace sc_core;
  * and one output. The class is parameterized for input and output
  * data-types.
  */
-class comb : public ct_process
+template <typename T>
+class basic_comb : public ct_process
 {
 public:
-    CT_in  iport1;       ///< port for the input channel
-    CT_out oport1;       ///< port for the output channel
+    typename ct_types<T>::in_port  iport1;  ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(CTTYPE&,const CTTYPE&)> functype;
+    typedef std::function<void(T&,const T&)> functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
      * applies the user-imlpemented function to it and writes the
      * results using the output port
      */
-    comb(sc_module_name _name,      ///< process name
-         const functype& _func      ///< function to be passed
-         ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
-             _func(_func)
+    basic_comb(sc_module_name _name,      ///< process name
+               const functype& _func      ///< function to be passed
+               ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
+                   _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::comb";}
 
+protected:
+    //! Computes the output sub-signal from an input sub-signal
+    /*! The default implementation applies the function to the samples
+     * of the input. The derived process constructors can override it to
+     * produce closed-form sub-signals.
+     */
+    virtual basic_sub_signal<T> transform(const basic_sub_signal<T>& iv1)
+    {
+        return basic_sub_signal<T>(get_start_time(iv1), get_end_time(iv1),
+                    [this,iv1](const sc_time& t)
+                    {
+                        T res;
+                        _func(res, iv1(t));
+                        return res;
+                    }
+               );
+    }
+
 private:
     // Inputs and output variables
-    sub_signal oval;
-    sub_signal ival1;
+    basic_sub_signal<T> oval;
+    basic_sub_signal<T> ival1;
     
     //! The function passed to the process constructor
     functype _func;
@@ -89,21 +110,13 @@ private:
     
     void exec()
     {
-        sub_signal iv1 = ival1;
-        oval = sub_signal(get_start_time(ival1), get_end_time(ival1),
-                    [this,iv1](const sc_time& t)
-                    {
-                        CTTYPE res;
-                        _func(res, iv1(t));
-                        return res;
-                    }
-               );
+        oval = transform(ival1);
     }
     
     void prod()
     {
         write_multiport(oport1, oval);
-        wait(get_end_time(oval) - sc_time_stamp());
+        wait(get_end_time(oval) - model_time());
     }
     
     void clean(){}
@@ -119,44 +132,74 @@ private:
 #endif
 };
 
+//! The comb process constructor of CTTYPE values
+typedef basic_comb<CTTYPE> comb;
+
 //! Process constructor for a combinational process with two inputs and one output
 /*! similar to comb with two inputs
  */
-class comb2 : public ct_process
+template <typename T>
+class basic_comb2 : public ct_process
 {
 public:
-    CT_in iport1;        ///< port for the input channel 1
-    CT_in iport2;        ///< port for the input channel 2
-    CT_out oport1;        ///< port for the output channel
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel 1
+    typename ct_types<T>::in_port iport2;   ///< port for the input channel 2
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(CTTYPE&, const CTTYPE&,
-                                              const CTTYPE&)> functype;
+    typedef std::function<void(T&, const T&,
+                                              const T&)> functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
      * applies the user-imlpemented function to them and writes the
-     * results using the output port
+     * results using the output port.
+     *
+     * The output sub-signals range over the intersections of the ranges
+     * of the inputs, which fragments the output if the inputs have
+     * different step sizes. With a non-zero grid, the output sub-signals
+     * are aligned to the multiples of the grid instead, as with coalesce.
      */
-    comb2(sc_module_name _name,      ///< process name
-          const functype& _func      ///< function to be passed
-          ) : ct_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1"),
-              _func(_func)
+    basic_comb2(sc_module_name _name,      ///< process name
+                const functype& _func,     ///< function to be passed
+                const sc_time& grid=SC_ZERO_TIME ///< breakpoint grid of the output
+                ) : ct_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1"),
+                    _func(_func), aligner(grid)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
+        if (grid != SC_ZERO_TIME) add_arg("grid", grid);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::comb2";}
-private:    
+
+protected:
+    //! Computes the output sub-signal over a range from the input sub-signals
+    /*! The default implementation applies the function to the samples
+     * of the inputs. The derived process constructors can override it to
+     * produce closed-form sub-signals.
+     */
+    virtual basic_sub_signal<T> combine(const basic_sub_signal<T>& iv1,
+                                        const basic_sub_signal<T>& iv2,
+                                        const sc_time& st, const sc_time& et)
+    {
+        return basic_sub_signal<T>(st, et,
+                             [iv1,iv2,this](const sc_time& t)
+                             {
+                                 T res;
+                                 _func(res, iv1(t), iv2(t));
+                                 return res;
+                             }
+               );
+    }
+
+private:
     // Inputs and output sub-signals
-    sub_signal oss;
-    sub_signal iss1;
-    sub_signal iss2;
+    basic_sub_signal<T> oss;
+    basic_sub_signal<T> iss1;
+    basic_sub_signal<T> iss2;
     
     // the current time (local time) and the next time
     sc_time tl, tn;
@@ -167,6 +210,9 @@ private:
     //! The function passed to the process constructor
     functype _func;
 
+    // aligns the output to the breakpoint grid
+    segment_aligner<T> aligner;
+
     //Implementing the abstract semantics
     void init()
     {
@@ -194,23 +240,14 @@ private:
     
     void exec()
     {
-        sub_signal iv1 = iss1;
-        sub_signal iv2 = iss2;
-        oss = sub_signal(tl, tn, 
-                             [iv1,iv2,this](const sc_time& t)
-                             {
-                                 CTTYPE res;
-                                 _func(res, iv1(t), iv2(t));
-                                 return res;
-                             }
-               );
+        oss = combine(iss1, iss2, tl, tn);
         tl = tn;
     }
     
     void prod()
     {
-        write_multiport(oport1, oss);
-        wait(tl - sc_time_stamp());
+        if (aligner.push(oss, oss)) write_multiport(oport1, oss);
+        wait(tl - model_time());
     }
     
     void clean(){}
@@ -227,6 +264,9 @@ private:
 #endif
 };
 
+//! The comb2 process constructor of CTTYPE values
+typedef basic_comb2<CTTYPE> comb2;
+
 //! Process constructor for a combinational process with an array of inputs and one output
 /*! similar to comb but with an array of inputs
  */
@@ -243,16 +283,17 @@ public:
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
      * applies the user-imlpemented function to them and writes the
-     * results using the output port
+     * results using the output port. With a non-zero grid, the output
+     * sub-signals are aligned to the multiples of the grid, as with comb2.
      */
     combX(sc_module_name _name,      ///< process name
-          const functype& _func      ///< function to be passed
-          ) : ct_process(_name), oport1("oport1"), _func(_func)
+          const functype& _func,     ///< function to be passed
+          const sc_time& grid=SC_ZERO_TIME ///< breakpoint grid of the output
+          ) : ct_process(_name), oport1("oport1"), _func(_func), aligner(grid)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
+        if (grid != SC_ZERO_TIME) add_arg("grid", grid);
 #endif
     }
     
@@ -272,6 +313,9 @@ private:
     //! The function passed to the process constructor
     functype _func;
 
+    // aligns the output to the breakpoint grid
+    segment_aligner<CTTYPE> aligner;
+
     //Implementing the abstract semantics
     void init()
     {
@@ -313,8 +357,8 @@ private:
     
     void prod()
     {
-        write_multiport(oport1, oss);
-        wait(tl - sc_time_stamp());
+        if (aligner.push(oss, oss)) write_multiport(oport1, oss);
+        wait(tl - model_time());
     }
     
     void clean(){}
@@ -331,6 +375,97 @@ private:
 #endif
 };
 
+//! Process constructor for a segment coalescing process
+/*! This class is used to build a process which re-segments a CT signal
+ * on a grid of breakpoints without changing its values. The input
+ * sub-signals are gathered until the input passes a multiple of the
+ * grid period and then written as a single sub-signal, merging the
+ * compatible closed-form pieces (e.g., consecutive pieces of a ramp).
+ *
+ * It bounds the number of tokens of a signal fragmented by the
+ * intersections of the inputs of comb2 or combX processes, or by the
+ * small steps of a source, by the number of grid periods. The output
+ * lags behind the input until the next grid point, hence in a feedback
+ * loop the delays should not be shorter than the grid period.
+ */
+template <typename T>
+class basic_coalesce : public ct_process
+{
+public:
+    typename ct_types<T>::in_port  iport1;  ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * gathers it up to the grid points and writes the results using the
+     * output port
+     */
+    basic_coalesce(sc_module_name _name,    ///< process name
+                   const sc_time& grid      ///< breakpoint grid of the output
+                   ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
+                       grid(grid), aligner(grid)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("grid", grid);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::coalesce";}
+    
+private:
+    sc_time grid;
+    
+    // Inputs and output variables
+    basic_sub_signal<T> ival;
+    basic_sub_signal<T> oval;
+    bool ready;
+    
+    // gathers the input up to the grid points
+    segment_aligner<T> aligner;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (grid == SC_ZERO_TIME)
+            SC_REPORT_ERROR(name(), "the grid period should be positive");
+        ready = false;
+    }
+    
+    void prep()
+    {
+        ival = iport1.read();
+    }
+    
+    void exec()
+    {
+        ready = aligner.push(ival, oval);
+    }
+    
+    void prod()
+    {
+        if (!ready) return;
+        write_multiport(oport1, oval);
+        if (get_end_time(oval) > model_time())
+            wait(get_end_time(oval) - model_time());
+    }
+    
+    void clean(){}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The coalesce process constructor of CTTYPE values
+typedef basic_coalesce<CTTYPE> coalesce;
+
 //! Process constructor for a delay element
 /*! This class is used to build a process which delays the input CT signal.
  * It operates by adding the specified delay value to the start and end
@@ -355,9 +490,7 @@ public:
               delay_time(delay_time)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << delay_time;
-        arg_vec.push_back(std::make_tuple("delay_time", ss.str()));
+        add_arg("delay_time", delay_time);
 #endif
     }
     
@@ -377,9 +510,7 @@ private:
         if (delay_time > SC_ZERO_TIME)
         {
             write_multiport(oport1, 
-                sub_signal(SC_ZERO_TIME, delay_time, 
-                    [](const sc_time& t){return 0;}
-                )
+                sub_signal::constant(SC_ZERO_TIME, delay_time, 0)
             );
             wait(delay_time);
         }
@@ -399,7 +530,7 @@ private:
     void prod()
     {
         write_multiport(oport1, val);
-        wait(get_end_time(val) - sc_time_stamp());
+        wait(get_end_time(val) - model_time());
     }
     
     void clean(){}
@@ -436,9 +567,7 @@ public:
               delay_time(delay_time)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << delay_time;
-        arg_vec.push_back(std::make_tuple("delay_time", ss.str()));
+        add_arg("delay_time", delay_time);
 #endif
     }
     
@@ -458,9 +587,7 @@ private:
         if (delay_time > SC_ZERO_TIME)
         {
             write_multiport(oport1, 
-                sub_signal(SC_ZERO_TIME, delay_time, 
-                    [](const sc_time& t){return 0;}
-                )
+                sub_signal::constant(SC_ZERO_TIME, delay_time, 0)
             );
             wait(delay_time);
         }
@@ -473,19 +600,13 @@ private:
     
     void exec()
     {
-        set_range(val, get_start_time(val)+delay_time,
-                       get_end_time(val)+delay_time);
-        sub_signal v = val;
-        set_function(val, [v,this](const sc_time& t){
-                return get_function(v)(t-delay_time);
-            }
-        );
+        shift_time(val, delay_time);
     }
     
     void prod()
     {
         write_multiport(oport1, val);
-        wait(get_end_time(val) - sc_time_stamp());
+        wait(get_end_time(val) - model_time());
     }
     
     void clean() {}
@@ -524,12 +645,8 @@ public:
                  
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << end_time;
-        arg_vec.push_back(std::make_tuple("end_time", ss.str()));
+        add_arg("init_val", init_val);
+        add_arg("end_time", end_time);
 #endif
     }
     
@@ -543,11 +660,9 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        auto ss = sub_signal(sc_time(0,SC_NS), end_time, 
-                        [this](const sc_time& t){return init_val;}
-                  );
+        auto ss = sub_signal::constant(sc_time(0,SC_NS), end_time, init_val);
         write_multiport(oport1, ss);
-        wait(get_end_time(ss) - sc_time_stamp());
+        wait(get_end_time(ss) - model_time());
     }
     
     void prep() {}
@@ -596,12 +711,8 @@ public:
               _func(_func), end_time(end_time)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << end_time;
-        arg_vec.push_back(std::make_tuple("end_time", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("end_time", end_time);
 #endif
     }
     
@@ -626,7 +737,7 @@ private:
                                 }
                             );
         write_multiport(oport1, ss);
-        wait(get_end_time(ss) - sc_time_stamp());
+        wait(get_end_time(ss) - model_time());
     }
     
     void prep() {}
@@ -674,9 +785,7 @@ public:
             
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -728,7 +837,10 @@ private:
  * Its main purpose is to be used in test-benches.
  * 
  * The resulting process prints the sampled data as a trace in an output
- * ".dat" file which can be plotted using gaw or gwave.
+ * ".dat" file which can be plotted using gaw or gwave. In the binary
+ * format the output file is named ".trc" instead. The output is written
+ * in blocks and can be decimated using the min/max values of a number of
+ * samples (see trace_writer).
  */
 class traceSig : public ct_process
 {
@@ -740,14 +852,18 @@ public:
      * in each cycle.
      */
     traceSig(sc_module_name _name,          ///< Process name
-             const sc_time& sample_period   ///< Sampling time
+             const sc_time& sample_period,  ///< Sampling time
+             trace_format format=TRACE_TEXT,///< The output file format
+             unsigned decimation=1          ///< Samples summarized in a row
              ) : ct_process(_name), iport1("iport1"),
-                 sample_period(sample_period)
+                 sample_period(sample_period), format(format),
+                 decimation(decimation)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << sample_period;
-        arg_vec.push_back(std::make_tuple("sample_period", ss.str()));
+        add_arg("sample_period", sample_period);
+        arg_vec.push_back(std::make_tuple("format",
+                          format==TRACE_BINARY ? "binary" : "text"));
+        add_arg("decimation", decimation);
 #endif        
     }
     
@@ -756,19 +872,21 @@ public:
 
 private:
     sc_time sample_period;
+    trace_format format;
+    unsigned decimation;
     
     // The internal variables
-    std::ofstream outFile;
+    trace_writer writer;
     sub_signal in_val;
+    std::vector<double> vals;
     sc_time curTime;
     
     //Implementing the abstract semantics
     void init()
     {
-        outFile.open(name()+std::string(".dat"));
-        if (!outFile.is_open())
+        if (!writer.open(name()+std::string(format==TRACE_BINARY?".trc":".dat"),
+                         {name()}, format, decimation))
             SC_REPORT_ERROR(name(),"file could not be opened");
-        outFile << "#time " << name() << std::endl;
         in_val = iport1.read();
         curTime = get_start_time(in_val);
     }
@@ -782,14 +900,19 @@ private:
     
     void prod()
     {
-        outFile << curTime.to_seconds() << " " << in_val(curTime)
-                << std::endl;
-        curTime += sample_period;
+        // all the samples in the range of the input sub-signal at once
+        vals.resize(in_val.count_samples(curTime, sample_period));
+        in_val.sample_uniform(curTime, sample_period, vals.size(), vals.data());
+        for (const double& val : vals)
+        {
+            writer.sample(in_seconds(curTime), &val);
+            curTime += sample_period;
+        }
     }
     
     void clean()
     {
-        if (outFile.is_open()) outFile.close();
+        writer.close();
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -801,6 +924,154 @@ private:
 #endif
 };
 
+//! Samples several sub-signals periodically
+/*! The n samples of each sub-signal starting from t0 are written in its
+ * column. The values of a CT signal are computed only when they are
+ * sampled, by evaluating the functions of the processes which produced
+ * it, hence sampling the signals of independent branches (e.g., parallel
+ * filters) involves disjoint computations. With FORSYDE_MULTITHREADED
+ * defined, the columns are sampled concurrently on the data-parallel pool
+ * if there are at least FORSYDE_DP_THRESHOLD samples in total. The
+ * functions passed to the CT processes should then be free of side
+ * effects, which is the case in the CT MoC.
+ */
+template <typename V>
+inline void sample_signals(const std::vector<basic_sub_signal<V>>& sss,
+                           const sc_time& t0, const sc_time& dt, size_t n,
+                           std::vector<std::vector<V>>& columns)
+{
+    columns.resize(sss.size());
+    for (auto& col : columns) col.resize(n);
+    auto body = [&](size_t begin, size_t end, unsigned)
+    {
+        for (size_t i=begin; i<end; i++)
+            sss[i].sample_uniform(t0, dt, n, columns[i].data());
+    };
+#ifdef FORSYDE_MULTITHREADED
+    if (sss.size() > 1 && n * sss.size() >= FORSYDE_DP_THRESHOLD)
+    {
+        data_parallel_pool::get().parallel_for(sss.size(), body);
+        return;
+    }
+#endif
+    body(0, sss.size(), 0);
+}
+
+//! Process constructor for a multi-input trace process
+/*! This class is used to build a sink process which has a multi-port
+ * input. Its main purpose is to be used in test-benches.
+ * 
+ * The resulting process samples all the signals bound to its input port
+ * at the same time instants and records them as the columns of a single
+ * trace file, similar to traceSig. The signals are sampled in batches up
+ * to the end of the shortest input sub-signal, concurrently if they are
+ * many (see sample_signals).
+ */
+class traceSigs : public ct_process
+{
+public:
+    CT_in  iport;        ///< multi-port for the input channels
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which samples the inputs in each cycle.
+     * The columns are named after the process and the index of the
+     * input, unless the names are given.
+     */
+    traceSigs(sc_module_name _name,         ///< Process name
+              const sc_time& sample_period, ///< Sampling time
+              trace_format format=TRACE_TEXT,///< The output file format
+              unsigned decimation=1,        ///< Samples summarized in a row
+              const std::vector<std::string>& names={} ///< Names of the signals
+              ) : ct_process(_name), iport("iport"),
+                  sample_period(sample_period), format(format),
+                  decimation(decimation), names(names)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("sample_period", sample_period);
+        arg_vec.push_back(std::make_tuple("format",
+                          format==TRACE_BINARY ? "binary" : "text"));
+        add_arg("decimation", decimation);
+#endif        
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::traceSigs";}
+
+private:
+    sc_time sample_period;
+    trace_format format;
+    unsigned decimation;
+    std::vector<std::string> names;
+    
+    // The internal variables
+    trace_writer writer;
+    std::vector<sub_signal> in_vals;
+    std::vector<double> samples;
+    std::vector<std::vector<double>> columns;
+    size_t nrows;
+    sc_time curTime;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        const size_t n = iport.size();
+        for (size_t i=names.size(); i<n; i++)
+            names.push_back(std::string(name())+"("+std::to_string(i)+")");
+        names.resize(n);
+        if (!writer.open(name()+std::string(format==TRACE_BINARY?".trc":".dat"),
+                         names, format, decimation))
+            SC_REPORT_ERROR(name(),"file could not be opened");
+        in_vals.resize(n);
+        samples.resize(n);
+        curTime = SC_ZERO_TIME;
+        for (size_t i=0; i<n; i++)
+        {
+            in_vals[i] = iport[i]->read();
+            curTime = std::max(curTime, get_start_time(in_vals[i]));
+        }
+    }
+    
+    void prep()
+    {
+        for (size_t i=0; i<in_vals.size(); i++)
+            while (curTime >= get_end_time(in_vals[i]))
+                in_vals[i] = iport[i]->read();
+    }
+    
+    void exec()
+    {
+        // the samples up to the end of the shortest input sub-signal
+        nrows = size_t(-1);
+        for (auto& in_val : in_vals)
+            nrows = std::min(nrows, in_val.count_samples(curTime, sample_period));
+        if (in_vals.empty()) nrows = 0;
+        sample_signals(in_vals, curTime, sample_period, nrows, columns);
+    }
+    
+    void prod()
+    {
+        for (size_t r=0; r<nrows; r++)
+        {
+            for (size_t i=0; i<in_vals.size(); i++) samples[i] = columns[i][r];
+            writer.sample(in_seconds(curTime), samples.data());
+            curTime += sample_period;
+        }
+    }
+    
+    void clean()
+    {
+        writer.close();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport;
+    }
+#endif
+};
+
 //! Process constructor for a fan-out process with one input and one output
 /*! This class is used to build a fanout processes with one input
  * and one output. The class is parameterized for input and output
@@ -811,30 +1082,36 @@ private:
  * designs). It will be used when it is needed to connect an input
  * port of a module to the input channels of multiple processes (modules).
  */
-class fanout : public ct_process
+template <typename T>
+class basic_fanout : public ct_process
 {
 public:
-    CT_in iport1;        ///< port for the input channel
-    CT_out oport1;       ///< port for the output channel
+    typename ct_types<T>::in_port iport1;   ///< port for the input channel
+    typename ct_types<T>::out_port oport1;  ///< port for the output channel
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
      * applies and writes the results using the output port
      */
-    fanout(sc_module_name _name)  // module name
+    basic_fanout(sc_module_name _name)  // module name
          : ct_process(_name) { }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "CT::fanout";}
     
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Passes the input tokens on to the outputs without running the process
+    void start_of_simulation() {bypass_fanout(iport1, oport1);}
+#endif
+    
 private:
     // Inputs and output variables
-    sub_signal* val;
+    basic_sub_signal<T>* val;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new sub_signal;
+        val = new basic_sub_signal<T>;
     }
     
     void prep()
@@ -847,7 +1124,7 @@ private:
     void prod()
     {
         write_multiport(oport1, *val);
-        wait(get_end_time(*val) - sc_time_stamp());
+        wait(get_end_time(*val) - model_time());
     }
     
     void clean()
@@ -865,6 +1142,313 @@ private:
 #endif
 };
 
+//! The fanout process constructor of CTTYPE values
+typedef basic_fanout<CTTYPE> fanout;
+
+//! Process constructor for a combinational process on vector-valued signals
+/*! This class is used to build combinational processes with one input
+ * with N channels and one output with M channels, such that a whole
+ * vector is computed per sample instead of one process per channel.
+ */
+template <std::size_t N, std::size_t M=N>
+class vcomb : public ct_process
+{
+public:
+    CT_vin<N>  iport1;       ///< port for the input channel
+    CT_vout<M> oport1;       ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(ct_vector<M>&,const ct_vector<N>&)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    vcomb(sc_module_name _name,     ///< process name
+          const functype& _func     ///< function to be passed
+          ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
+              _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::vcomb";}
+
+protected:
+    //! Computes the output sub-signal from an input sub-signal
+    /*! The default implementation applies the function to the samples
+     * of the input. The derived process constructors can override it to
+     * produce closed-form sub-signals.
+     */
+    virtual vsub_signal<M> transform(const vsub_signal<N>& iv1)
+    {
+        return vsub_signal<M>(get_start_time(iv1), get_end_time(iv1),
+                    [this,iv1](const sc_time& t)
+                    {
+                        ct_vector<M> res;
+                        _func(res, iv1(t));
+                        return res;
+                    }
+               );
+    }
+
+private:
+    // Inputs and output variables
+    vsub_signal<M> oval;
+    vsub_signal<N> ival1;
+    
+    //! The function passed to the process constructor
+    functype _func;
+    
+    //Implementing the abstract semantics
+    void init() {}
+    
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+    
+    void exec()
+    {
+        oval = transform(ival1);
+    }
+    
+    void prod()
+    {
+        write_multiport(oport1, oval);
+        wait(get_end_time(oval) - model_time());
+    }
+    
+    void clean(){}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a combinational process with two vector-valued inputs
+/*! similar to comb2 on vector-valued signals with N channels
+ */
+template <std::size_t N>
+class vcomb2 : public ct_process
+{
+public:
+    CT_vin<N> iport1;       ///< port for the input channel 1
+    CT_vin<N> iport2;       ///< port for the input channel 2
+    CT_vout<N> oport1;      ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(ct_vector<N>&, const ct_vector<N>&,
+                                              const ct_vector<N>&)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the user-imlpemented function to them and writes the
+     * results using the output port
+     */
+    vcomb2(sc_module_name _name,     ///< process name
+           const functype& _func     ///< function to be passed
+           ) : ct_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1"),
+               _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::vcomb2";}
+
+protected:
+    //! Computes the output sub-signal over a range from the input sub-signals
+    /*! The default implementation applies the function to the samples
+     * of the inputs. The derived process constructors can override it to
+     * produce closed-form sub-signals.
+     */
+    virtual vsub_signal<N> combine(const vsub_signal<N>& iv1, const vsub_signal<N>& iv2,
+                                   const sc_time& st, const sc_time& et)
+    {
+        return vsub_signal<N>(st, et,
+                             [iv1,iv2,this](const sc_time& t)
+                             {
+                                 ct_vector<N> res;
+                                 _func(res, iv1(t), iv2(t));
+                                 return res;
+                             }
+               );
+    }
+
+private:
+    // Inputs and output sub-signals
+    vsub_signal<N> oss;
+    vsub_signal<N> iss1;
+    vsub_signal<N> iss2;
+    
+    // the current time (local time) and the next time
+    sc_time tl, tn;
+    
+    // clocks of the input ports (channel times)
+    sc_time in1T, in2T;
+    
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        in1T = in2T = tl = tn = SC_ZERO_TIME;
+        set_range(iss1, SC_ZERO_TIME, SC_ZERO_TIME);
+        set_range(iss2, SC_ZERO_TIME, SC_ZERO_TIME);
+    }
+    
+    void prep()
+    {
+        if (in1T == tl)
+        {
+            iss1 = iport1.read();
+            in1T = get_end_time(iss1);
+        }
+        if (in2T == tl)
+        {
+            iss2 = iport2.read();
+            in2T = get_end_time(iss2);
+        }
+        
+        // update the next local clock
+        tn = std::min(in1T, in2T);
+    }
+    
+    void exec()
+    {
+        oss = combine(iss1, iss2, tl, tn);
+        tl = tn;
+    }
+    
+    void prod()
+    {
+        write_multiport(oport1, oss);
+        wait(tl - model_time());
+    }
+    
+    void clean(){}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a trace process of a vector-valued signal
+/*! This class is used to build a sink process which only has an input.
+ * Its main purpose is to be used in test-benches.
+ * 
+ * The resulting process records the N channels of the sampled input as
+ * the columns of a single trace file, similar to traceSigs.
+ */
+template <std::size_t N>
+class vtraceSig : public ct_process
+{
+public:
+    CT_vin<N> iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which samples the input in each cycle.
+     * The columns are named after the process and the index of the
+     * channel, unless the names are given.
+     */
+    vtraceSig(sc_module_name _name,         ///< Process name
+              const sc_time& sample_period, ///< Sampling time
+              trace_format format=TRACE_TEXT,///< The output file format
+              unsigned decimation=1,        ///< Samples summarized in a row
+              const std::vector<std::string>& names={} ///< Names of the channels
+              ) : ct_process(_name), iport1("iport1"),
+                  sample_period(sample_period), format(format),
+                  decimation(decimation), names(names)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("sample_period", sample_period);
+        arg_vec.push_back(std::make_tuple("format",
+                          format==TRACE_BINARY ? "binary" : "text"));
+        add_arg("decimation", decimation);
+#endif        
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::vtraceSig";}
+
+private:
+    sc_time sample_period;
+    trace_format format;
+    unsigned decimation;
+    std::vector<std::string> names;
+    
+    // The internal variables
+    trace_writer writer;
+    vsub_signal<N> in_val;
+    std::vector<ct_vector<N>> vals;
+    sc_time curTime;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        for (size_t i=names.size(); i<N; i++)
+            names.push_back(std::string(name())+"("+std::to_string(i)+")");
+        names.resize(N);
+        if (!writer.open(name()+std::string(format==TRACE_BINARY?".trc":".dat"),
+                         names, format, decimation))
+            SC_REPORT_ERROR(name(),"file could not be opened");
+        in_val = iport1.read();
+        curTime = get_start_time(in_val);
+    }
+    
+    void prep()
+    {
+        while (curTime >= get_end_time(in_val)) in_val = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        vals.resize(in_val.count_samples(curTime, sample_period));
+        in_val.sample_uniform(curTime, sample_period, vals.size(), vals.data());
+        for (const ct_vector<N>& val : vals)
+        {
+            writer.sample(in_seconds(curTime), val.data());
+            curTime += sample_period;
+        }
+    }
+    
+    void clean()
+    {
+        writer.close();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
 }
 }
 
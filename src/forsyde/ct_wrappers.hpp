@@ -23,11 +23,28 @@
  * ForSyDe.
  */
 
+#include <vector>
+#include <array>
+#include <map>
+#include <memory>
+#include <cmath>
+
+// included before fmi2.h, which defines a min macro
+#include "dde_process_constructors.hpp"
+
 #include "fmi2/fmi2.h"
 #include "fmi2/sim_support.h"
 
 #include "sub_signal.hpp"
 #include "ct_process.hpp"
+#include "shm_ring.hpp"
+#ifdef FORSYDE_MULTITHREADED
+#include "data_parallel_pool.hpp"
+#endif
+#ifdef FORSYDE_WRAPPER_REPLAY
+#include "serializer.hpp"
+#include "replay_log.hpp"
+#endif
 
 namespace ForSyDe
 {
@@ -37,11 +54,82 @@ namespace CT
 
 using namespace sc_core;
 
+class fmi2cs_master;
+
+#ifdef FORSYDE_CHECKPOINT
+//! Appends the serialized state of an FMU instance to a buffer
+/*! It returns false if the FMU can not save its state.
+ */
+inline bool save_fmu_state(FMU& fmu, fmi2Component c, std::vector<char>& buf)
+{
+    fmi2FMUstate s = NULL;
+    size_t size = 0;
+    if (fmu.getFMUstate(c, &s) > fmi2Warning) return false;
+    std::vector<char> data;
+    bool ok = fmu.serializedFMUstateSize(c, s, &size) <= fmi2Warning;
+    if (ok)
+    {
+        data.resize(size);
+        ok = fmu.serializeFMUstate(c, s, data.data(), size) <= fmi2Warning;
+    }
+    fmu.freeFMUstate(c, &s);
+    if (ok) serializer<std::vector<char>>::write(buf, data);
+    return ok;
+}
+
+//! Sets the state of an FMU instance saved by save_fmu_state
+inline bool restore_fmu_state(FMU& fmu, fmi2Component c, const char*& pos)
+{
+    std::vector<char> data;
+    serializer<std::vector<char>>::read(pos, data);
+    fmi2FMUstate s = NULL;
+    if (fmu.deSerializeFMUstate(c, data.data(), data.size(), &s) > fmi2Warning)
+        return false;
+    const bool ok = fmu.setFMUstate(c, s) <= fmi2Warning;
+    fmu.freeFMUstate(c, &s);
+    return ok;
+}
+#endif
+
+#ifdef FORSYDE_RESET
+//! Resets an FMU instance with fmi2Reset and initializes it again
+/*! It returns false if any of the steps fails.
+ */
+inline bool reset_fmu(FMU& fmu, fmi2Component c,
+                      fmi2Boolean toleranceDefined=fmi2False, fmi2Real tolerance=0)
+{
+    return fmu.reset(c) <= fmi2Warning &&
+           fmu.setupExperiment(c, toleranceDefined, tolerance, 0, fmi2False, 0) <= fmi2Warning &&
+           fmu.enterInitializationMode(c) <= fmi2Warning &&
+           fmu.exitInitializationMode(c) <= fmi2Warning;
+}
+#endif
+
 //! Process constructor for a co-simulation FMU wrapper with one input and one output
 /*! This class is used to build an FMI wrapper with one input and one
  * output. It uses the Functional Mock-up Interface (FMI 2.0) in
  * co-simulation mode to communicate with a Functional Mock-up Unit (FMU)
  * which includes a numeric solver or interfaces to a solver tool.
+ *
+ * The FMU is stepped with a fixed communication step, unless a maximum
+ * step larger than the sampling period is given. In the adaptive mode
+ * the sampling period is the initial step, which is doubled (up to the
+ * maximum step) while the output changes less than a quarter of the
+ * tolerance per step, and is halved (down to the minimum step) when it
+ * changes more than the tolerance. The step is also limited to the end
+ * of the current input sub-signal if it is constant, and to the sampling
+ * period otherwise. If the FMU supports getting and setting its state,
+ * a step which changes the output too much or is discarded by the FMU is
+ * rejected and retried with a smaller step.
+ *
+ * With FORSYDE_WRAPPER_REPLAY the input value of each step is recorded
+ * together with the accepted step and the output, which are replayed in
+ * the later runs without loading the FMU (see replay_log).
+ *
+ * The FMU is loaded through the FMU cache (see loadSharedFMU), hence it
+ * is unzipped only in the first run and the instances of the same FMU
+ * share its dll. The fixed-step wrappers can be stepped concurrently by
+ * an fmi2cs_master.
  */
 class fmi2cswrap : public ct_process
 {
@@ -58,22 +146,23 @@ public:
          const std::string& fmu_file,   ///< The FMU file name
          const unsigned int& input_index,///< The index of input variable
          const unsigned int& output_index,///< The index of output variable
-         const sc_time& sample_period   ///< The fixed sampling period
+         const sc_time& sample_period,  ///< The fixed (initial) sampling period
+         const sc_time& max_step=SC_ZERO_TIME,///< The maximum step in the adaptive mode
+         const sc_time& min_step=sc_time(0.05,SC_NS),///< The minimum step in the adaptive mode
+         double tol_error=1e-3          ///< The tolerated output change per step
          ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
              fmuFileName(fmu_file), input_index(input_index),
-             output_index(output_index), h(sample_period)
+             output_index(output_index), h(sample_period),
+             max_step(max_step), min_step(min_step), tol_error(tol_error)
     {
 #ifdef FORSYDE_INTROSPECTION
         arg_vec.push_back(std::make_tuple("fmuFileName",fmuFileName));
-        std::stringstream ss;
-        ss << input_index;
-        arg_vec.push_back(std::make_tuple("input_index", ss.str()));
-        ss.str("");
-        ss << output_index;
-        arg_vec.push_back(std::make_tuple("output_index", ss.str()));
-        ss.str("");
-        ss << sample_period;
-        arg_vec.push_back(std::make_tuple("sample_period", ss.str()));
+        add_arg("input_index", input_index);
+        add_arg("output_index", output_index);
+        add_arg("sample_period", sample_period);
+        add_arg("max_step", max_step);
+        add_arg("min_step", min_step);
+        add_arg("tol_error", tol_error);
 #endif
     }
     
@@ -81,6 +170,13 @@ public:
     std::string forsyde_kind() const {return "CT::fmi2cswrap";}
 
 private:
+    friend class fmi2cs_master;
+    
+    // the master stepping the wrapper together with the others, if any
+    fmi2cs_master* master = NULL;
+    // the FMU can be instantiated only once per process
+    bool exclusive = false;
+
     // Inputs and output variables
     sub_signal oval;
     sub_signal ival1;
@@ -88,9 +184,16 @@ private:
     //! The function passed to the process constructor
     std::string fmuFileName;
     unsigned int input_index, output_index;
-    sc_time h;
+    sc_time h, max_step, min_step;
+    double tol_error;
     
     sc_time time;
+    sc_time cur_h, step;            // the adaptive step and the current step
+    fmi2FMUstate state;             // the state saved before a step
+    bool can_restore;               // the FMU state can be saved and restored
+    bool has_prev;                  // an output is already computed
+    fmi2Real prev_res;              // the last output
+    fmi2Real res;                   // the current output
     FMU fmu;                        // the fmu to simulate
     const char *guid;               // global unique id of the fmu
     const char *instanceName;       // instance name
@@ -104,20 +207,35 @@ private:
     fmi2Real tolerance;             // used in setting up the experiment
     ValueStatus vs;
     Element *defaultExp;
+#ifdef FORSYDE_WRAPPER_REPLAY
+    replay_log replay;
+    std::vector<char> rec;
+#endif
     
     //Implementing the abstract semantics
     void init()
     {
         time = SC_ZERO_TIME;
-        fmuResourceLocation = getTempResourcesLocation();
+        cur_h = step = h;
+        state = NULL;
+        can_restore = adaptive();
+        has_prev = false;
+#ifdef FORSYDE_WRAPPER_REPLAY
+        if (replay.open(name()))
+        {
+            ival1 = iport1.read();
+            return;
+        }
+#endif
         visible = fmi2False;
         //~ callbacks = {fmuLogger, calloc, free, NULL, fmu};
         toleranceDefined = fmi2False;
         tolerance = 0;
         //~ vs = 0;
         
-        // load the FMU
-        loadFMU(fmuFileName.c_str(), &fmu);
+        // load the FMU, or share it with the other instances
+        loadSharedFMU(fmuFileName.c_str(), &fmu, fmi2CoSimulation);
+        fmuResourceLocation = getSharedResourcesLocation(&fmu);
         
         // run the simulation
         // instantiate the fmu   
@@ -125,6 +243,9 @@ private:
         guid = getAttributeValue((Element *)md, att_guid);
         instanceName = getAttributeValue((Element *)getCoSimulation(md),
             att_modelIdentifier);
+        const char* once = getAttributeValue((Element *)getCoSimulation(md),
+            att_canBeInstantiatedOnlyOncePerProcess);
+        exclusive = once && strcmp(once, "true") == 0;
         c = fmu.instantiate(instanceName, fmi2CoSimulation, guid,
             fmuResourceLocation, &callbacks, visible, fmi2False/*logging off*/);
         free(fmuResourceLocation);
@@ -136,7 +257,7 @@ private:
             toleranceDefined = fmi2True;
         }
         
-        fmi2Flag = fmu.setupExperiment(c, toleranceDefined, tolerance, 0, fmi2True, 1000/* FIXME */);
+        fmi2Flag = fmu.setupExperiment(c, toleranceDefined, tolerance, 0, fmi2False, 0);
         if (fmi2Flag > fmi2Warning) {
             return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI setup experiment");
         }
@@ -162,19 +283,37 @@ private:
                //~ );
         //~ write_multiport(oport1, oval)
         //~ time += h;
-        //~ wait(time - sc_time_stamp());
+        //~ wait(time - model_time());
         ival1 = iport1.read();
     }
     
     void prep()
     {
         while (time >= get_end_time(ival1)) ival1 = iport1.read();
-        setRealInput(&fmu, c, input_index, ival1(time));
+        CTTYPE u;
+        ival1.sample(&time, &u, 1);
+#ifdef FORSYDE_WRAPPER_REPLAY
+        rec.clear();
+        serializer<sc_time>::write(rec, time);
+        serializer<CTTYPE>::write(rec, u);
+        if (!replay.send(std::string(rec.begin(), rec.end()))) return;
+#endif
+        setRealInput(&fmu, c, input_index, u);
+        if (!adaptive()) return;
+        // do not step over a change of the input
+        const sc_time limit = ival1.get_kind() == sub_signal::CONSTANT ?
+                              get_end_time(ival1) - time : h;
+        step = cur_h < limit ? cur_h : limit;
     }
     
     void exec()
     {
-        fmi2Flag = fmu.doStep(c, time.to_seconds(), h.to_seconds(), fmi2True);
+#ifdef FORSYDE_WRAPPER_REPLAY
+        if (replay.replaying()) return replay_step();
+#endif
+        if (adaptive()) return exec_adaptive();
+        if (master) master_step();
+        else do_step();
         if (fmi2Flag == fmi2Discard) {
             fmi2Boolean b;
             // check if model requests to end simulation
@@ -190,37 +329,164 @@ private:
             return SC_REPORT_ERROR(name(),"could not complete simulation of the model");
         
         // FIXME: res = outputRow(fmu, c, time, file, separator, fmi2False); // output values for this step
-        auto res = getRealOutput(&fmu, c, output_index);
-        oval = sub_signal(time, time+h,
-                    [this,res](const sc_time& t)
-                    {
-                        return res;
-                    }
-               );
+        res = getRealOutput(&fmu, c, output_index);
+        oval = sub_signal::constant(time, time+h, res);
     }
     
     void prod()
     {
+#ifdef FORSYDE_WRAPPER_REPLAY
+        if (!replay.replaying())
+        {
+            rec.clear();
+            save_step(rec);
+            replay.record(std::string(rec.begin(), rec.end()));
+        }
+#endif
+        // the time is advanced before writing, since the sub-signal of a
+        // blocked write is kept by the signal
+        time += adaptive() ? step : h;
         write_multiport(oport1, oval)
-        time += h;
-        wait(time - sc_time_stamp());
+        wait(time - model_time());
     }
     
     void clean()
     {
+#ifdef FORSYDE_WRAPPER_REPLAY
+        // the FMU is not loaded while replaying
+        const bool replayed = replay.replaying();
+        replay.close();
+        if (replayed) return;
+#endif
         // end simulation
+        if (state) fmu.freeFMUstate(c, &state);
         fmu.terminate(c);
         fmu.freeInstance(c);
+        releaseSharedFMU(&fmu);
+    }
+
+#ifdef FORSYDE_RESET
+    //! Resets the FMU instance instead of loading it again
+    void reset()
+    {
+#ifdef FORSYDE_WRAPPER_REPLAY
+        // each run is recorded or replayed from the beginning
+        process::reset();
+#else
+        if (state) fmu.freeFMUstate(c, &state);
+        time = SC_ZERO_TIME;
+        cur_h = step = h;
+        state = NULL;
+        can_restore = adaptive();
+        has_prev = false;
+        if (!reset_fmu(fmu, c, toleranceDefined, tolerance))
+            return SC_REPORT_ERROR(name(),"could not reset the model");
+        ival1 = iport1.read();
+#endif
+    }
+#endif
+
+    bool adaptive() const {return max_step > h;}
     
-        #ifdef _MSC_VER
-            FreeLibrary(fmu.dllHandle);
-        #else
-            dlclose(fmu.dllHandle);
-        #endif
-        freeModelDescription(fmu.modelDescription);
-        deleteUnzippedFiles();
+    //! Performs a fixed step, possibly in a thread of the master
+    void do_step()
+    {
+        fmi2Flag = fmu.doStep(c, in_seconds(time), in_seconds(h), fmi2True);
     }
     
+    //! Performs the step together with the other wrappers of the master
+    void master_step();
+    
+    // fmi2.h defines a min macro, hence std::min is not used
+    sc_time halved(const sc_time& t) const {return t/2 > min_step ? t/2 : min_step;}
+    
+    //! Performs a step with the adaptive step size
+    void exec_adaptive()
+    {
+        while (true)
+        {
+            if (can_restore && fmu.getFMUstate(c, &state) > fmi2Warning)
+                can_restore = false;
+            const bool retry = can_restore && step > min_step;
+            fmi2Flag = fmu.doStep(c, in_seconds(time), in_seconds(step), fmi2True);
+            if (fmi2Flag == fmi2Discard) {
+                fmi2Boolean b;
+                // check if model requests to end simulation
+                if (fmi2OK != fmu.getBooleanStatus(c, fmi2Terminated, &b)) {
+                    return SC_REPORT_ERROR(name(),"could not complete simulation of the model. getBooleanStatus return other than fmi2OK");
+                }
+                if (b == fmi2True) {
+                    return SC_REPORT_ERROR(name(),"the model requested to end the simulation");
+                }
+                if (retry && fmu.setFMUstate(c, state) <= fmi2Warning)
+                {
+                    step = cur_h = halved(step);
+                    continue;
+                }
+                return SC_REPORT_ERROR(name(),"could not complete simulation of the model");
+            }
+            if (fmi2Flag != fmi2OK)
+                return SC_REPORT_ERROR(name(),"could not complete simulation of the model");
+            
+            res = getRealOutput(&fmu, c, output_index);
+            if (!has_prev) break;
+            // control the change of the output in a step
+            const double change = std::fabs(res - prev_res);
+            const double bound = tol_error * (1 + std::fabs(prev_res));
+            if (change > bound && retry && fmu.setFMUstate(c, state) <= fmi2Warning)
+            {
+                step = cur_h = halved(step);
+                continue;
+            }
+            if (change > bound)
+                cur_h = halved(step);
+            else if (change < bound/4)
+                cur_h = cur_h*2 < max_step ? cur_h*2 : max_step;
+            break;
+        }
+        prev_res = res;
+        has_prev = true;
+        oval = sub_signal::constant(time, time+step, res);
+    }
+    
+#ifdef FORSYDE_WRAPPER_REPLAY
+    //! Appends the accepted step and the output of the FMU to a buffer
+    void save_step(std::vector<char>& buf)
+    {
+        serializer<sc_time>::write(buf, step);
+        serializer<sc_time>::write(buf, cur_h);
+        serializer<fmi2Real>::write(buf, res);
+    }
+    
+    //! Takes the step and the output of the FMU from the recording
+    void replay_step()
+    {
+        const std::string vals = replay.replay();
+        const char* pos = vals.data();
+        serializer<sc_time>::read(pos, step);
+        serializer<sc_time>::read(pos, cur_h);
+        serializer<fmi2Real>::read(pos, res);
+        prev_res = res;
+        has_prev = true;
+        oval = sub_signal::constant(time, time+(adaptive() ? step : h), res);
+    }
+#endif
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, time, cur_h, step, has_prev, prev_res);
+        if (!save_fmu_state(fmu, c, buf))
+            SC_REPORT_ERROR(name(), "the state of the FMU can not be saved");
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        restore_values(pos, time, cur_h, step, has_prev, prev_res);
+        if (!restore_fmu_state(fmu, c, pos))
+            SC_REPORT_ERROR(name(), "the state of the FMU can not be restored");
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -232,6 +498,310 @@ private:
 #endif
 };
 
+//! A co-simulation master stepping the FMU wrappers concurrently
+/*! The fixed-step fmi2cswrap processes added to the master which share
+ * the same sampling period form a group. In each communication step,
+ * the wrappers of a group set their inputs from the signals, and the
+ * doStep calls of all of them are performed at once on the data-parallel
+ * pool when FORSYDE_MULTITHREADED is defined. Then each wrapper gets its
+ * output and writes it to its signal.
+ *
+ *  The first wrapper of a group reaching the step waits for the others
+ * as long as any other process can run at the current time. Hence a
+ * wrapper whose input depends on the output of another one in the same
+ * step is stepped in a later batch instead of blocking the group. The
+ * FMUs which can be instantiated only once per process are stepped one
+ * after the other in the SystemC thread, since they may keep a global
+ * state. The adaptive wrappers are not grouped.
+ */
+class fmi2cs_master
+{
+public:
+    //! Adds a wrapper to the group of its sampling period
+    void add(fmi2cswrap* w)
+    {
+        if (w->adaptive()) return;
+        w->master = this;
+        groups[w->h].size++;
+    }
+
+private:
+    friend class fmi2cswrap;
+    
+    //! The wrappers sharing a step grid
+    struct group
+    {
+        size_t size = 0;
+        std::vector<fmi2cswrap*> pending;   // the wrappers waiting for the step
+        sc_event done;
+    };
+    std::map<sc_time,group> groups;
+    
+    //! Performs the step of a wrapper together with the rest of its group
+    void step(fmi2cswrap* w)
+    {
+        group& g = groups[w->h];
+        g.pending.push_back(w);
+        if (g.pending.size() > 1)
+        {
+            wait(g.done);
+            return;
+        }
+        while (g.pending.size() < g.size && sc_pending_activity_at_current_time())
+            wait(SC_ZERO_TIME);
+        std::vector<fmi2cswrap*> batch, exclusive;
+        for (auto p : g.pending) (p->exclusive ? exclusive : batch).push_back(p);
+        g.pending.clear();
+#ifdef FORSYDE_MULTITHREADED
+        data_parallel_pool::get().parallel_for(batch.size(),
+            [&batch](size_t begin, size_t end, unsigned)
+            {
+                for (size_t i=begin; i<end; i++) batch[i]->do_step();
+            });
+#else
+        for (auto p : batch) p->do_step();
+#endif
+        for (auto p : exclusive) p->do_step();
+        g.done.notify();
+    }
+};
+
+inline void fmi2cswrap::master_step() {master->step(this);}
+
+//! Process constructor for a co-simulation FMU wrapper with multiple inputs and outputs
+/*! This class is used to build an FMI wrapper similar to fmi2cswrap,
+ * where an arbitrary number of the FMU variables are bound to the input
+ * and output ports of the process. Hence a single FMU instance serves
+ * all the signals connected to it.
+ *
+ * The value references of the variables are resolved once, and all the
+ * inputs (outputs) are transferred using a single call to fmi2SetReal
+ * (fmi2GetReal) in each step. One sub-signal is produced per output in
+ * each step.
+ */
+class fmi2cswrapMN : public ct_process
+{
+public:
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * performs a co-simulation step of the FMU and writes the outputs
+     * using the output ports
+     */
+    fmi2cswrapMN(sc_module_name _name,  ///< process name
+         const std::string& fmu_file,   ///< The FMU file name
+         const std::vector<unsigned int>& input_indices,///< The indices of input variables
+         const std::vector<unsigned int>& output_indices,///< The indices of output variables
+         const sc_time& sample_period   ///< The fixed sampling period
+         ) : ct_process(_name), fmuFileName(fmu_file),
+             input_indices(input_indices), output_indices(output_indices),
+             h(sample_period)
+    {
+        for (size_t i=0; i<input_indices.size(); i++)
+            iports.emplace_back(new CT_in(("iport"+std::to_string(i+1)).c_str()));
+        for (size_t i=0; i<output_indices.size(); i++)
+            oports.emplace_back(new CT_out(("oport"+std::to_string(i+1)).c_str()));
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("fmuFileName",fmuFileName));
+        arg_vec.emplace_back("input_indices", arg_value([this]()
+        {
+            std::stringstream ss;
+            ss << "{";
+            for (size_t i=0; i<this->input_indices.size(); i++)
+                ss << (i>0?",":"") << this->input_indices[i];
+            ss << "}";
+            return ss.str();
+        }));
+        arg_vec.emplace_back("output_indices", arg_value([this]()
+        {
+            std::stringstream ss;
+            ss << "{";
+            for (size_t i=0; i<this->output_indices.size(); i++)
+                ss << (i>0?",":"") << this->output_indices[i];
+            ss << "}";
+            return ss.str();
+        }));
+        add_arg("sample_period", sample_period);
+#endif
+    }
+    
+    //! The input port bound to the i-th input variable
+    CT_in& iport(size_t i) {return *iports[i];}
+    
+    //! The output port bound to the i-th output variable
+    CT_out& oport(size_t i) {return *oports[i];}
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::fmi2cswrapMN";}
+
+private:
+    std::vector<std::unique_ptr<CT_in>> iports;
+    std::vector<std::unique_ptr<CT_out>> oports;
+    
+    // Inputs and output variables
+    std::vector<sub_signal> ivals;
+    std::vector<fmi2Real> iprims, oprims;
+    std::vector<fmi2ValueReference> ivrs, ovrs;
+    
+    std::string fmuFileName;
+    std::vector<unsigned int> input_indices, output_indices;
+    sc_time h;
+    
+    sc_time time;
+    FMU fmu;                        // the fmu to simulate
+    const char *guid;               // global unique id of the fmu
+    const char *instanceName;       // instance name
+    fmi2Component c;                // instance of the fmu
+    fmi2Status fmi2Flag;            // return code of the fmu functions
+    char *fmuResourceLocation;      // path to the fmu resources as URL
+    fmi2CallbackFunctions callbacks = {fmuLogger, calloc, free, NULL, &fmu};// called by the model during simulation
+    ModelDescription* md;           // handle to the parsed XML file
+    fmi2Boolean toleranceDefined;   // true if model description define tolerance
+    fmi2Real tolerance;             // used in setting up the experiment
+    ValueStatus vs;
+    Element *defaultExp;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        time = SC_ZERO_TIME;
+        toleranceDefined = fmi2False;
+        tolerance = 0;
+        
+        // load the FMU, or share it with the other instances
+        loadSharedFMU(fmuFileName.c_str(), &fmu, fmi2CoSimulation);
+        fmuResourceLocation = getSharedResourcesLocation(&fmu);
+        
+        // instantiate the fmu
+        md = fmu.modelDescription;
+        guid = getAttributeValue((Element *)md, att_guid);
+        instanceName = getAttributeValue((Element *)getCoSimulation(md),
+            att_modelIdentifier);
+        c = fmu.instantiate(instanceName, fmi2CoSimulation, guid,
+            fmuResourceLocation, &callbacks, fmi2False, fmi2False/*logging off*/);
+        free(fmuResourceLocation);
+        if (!c) return SC_REPORT_ERROR(name(),"could not instantiate model");
+        
+        defaultExp = getDefaultExperiment(md);
+        if (defaultExp) tolerance = getAttributeDouble(defaultExp, att_tolerance, &vs);
+        if (vs == valueDefined) {
+            toleranceDefined = fmi2True;
+        }
+        
+        fmi2Flag = fmu.setupExperiment(c, toleranceDefined, tolerance, 0, fmi2False, 0);
+        if (fmi2Flag > fmi2Warning) {
+            return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI setup experiment");
+        }
+        
+        fmi2Flag = fmu.enterInitializationMode(c);
+        if (fmi2Flag > fmi2Warning) {
+            return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI enter initialization mode");
+        }
+        
+        fmi2Flag = fmu.exitInitializationMode(c);
+        if (fmi2Flag > fmi2Warning) {
+            return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI exit initialization mode");
+        }
+        
+        // resolve the value references once
+        for (auto k : input_indices) ivrs.push_back(getRealValueReference(&fmu, k));
+        for (auto k : output_indices) ovrs.push_back(getRealValueReference(&fmu, k));
+        iprims.resize(ivrs.size());
+        oprims.resize(ovrs.size());
+        
+        ivals.resize(iports.size());
+        for (size_t i=0; i<iports.size(); i++) ivals[i] = iports[i]->read();
+    }
+    
+    void prep()
+    {
+        for (size_t i=0; i<iports.size(); i++)
+        {
+            while (time >= get_end_time(ivals[i])) ivals[i] = iports[i]->read();
+            iprims[i] = ivals[i](time);
+        }
+        if (!ivrs.empty())
+            fmu.setReal(c, ivrs.data(), ivrs.size(), iprims.data());
+    }
+    
+    void exec()
+    {
+        fmi2Flag = fmu.doStep(c, in_seconds(time), in_seconds(h), fmi2True);
+        if (fmi2Flag == fmi2Discard) {
+            fmi2Boolean b;
+            // check if model requests to end simulation
+            if (fmi2OK != fmu.getBooleanStatus(c, fmi2Terminated, &b)) {
+                return SC_REPORT_ERROR(name(),"could not complete simulation of the model. getBooleanStatus return other than fmi2OK");
+            }
+            if (b == fmi2True) {
+                return SC_REPORT_ERROR(name(),"the model requested to end the simulation");
+            }
+            return SC_REPORT_ERROR(name(),"could not complete simulation of the model");
+        }
+        if (fmi2Flag != fmi2OK)
+            return SC_REPORT_ERROR(name(),"could not complete simulation of the model");
+        
+        if (!ovrs.empty())
+            fmu.getReal(c, ovrs.data(), ovrs.size(), oprims.data());
+    }
+    
+    void prod()
+    {
+        for (size_t i=0; i<oports.size(); i++)
+        {
+            CT_out& op = *oports[i];
+            write_multiport(op, sub_signal::constant(time, time+h, oprims[i]));
+        }
+        time += h;
+        wait(time - model_time());
+    }
+    
+    void clean()
+    {
+        // end simulation
+        fmu.terminate(c);
+        fmu.freeInstance(c);
+        releaseSharedFMU(&fmu);
+    }
+
+#ifdef FORSYDE_RESET
+    //! Resets the FMU instance instead of loading it again
+    void reset()
+    {
+        time = SC_ZERO_TIME;
+        if (!reset_fmu(fmu, c, toleranceDefined, tolerance))
+            return SC_REPORT_ERROR(name(),"could not reset the model");
+        for (size_t i=0; i<iports.size(); i++) ivals[i] = iports[i]->read();
+    }
+#endif
+
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, time);
+        if (!save_fmu_state(fmu, c, buf))
+            SC_REPORT_ERROR(name(), "the state of the FMU can not be saved");
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        restore_values(pos, time);
+        if (!restore_fmu_state(fmu, c, pos))
+            SC_REPORT_ERROR(name(), "the state of the FMU can not be restored");
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(iports.size());
+        for (size_t i=0; i<iports.size(); i++)
+            boundInChans[i].port = iports[i].get();
+        boundOutChans.resize(oports.size());
+        for (size_t i=0; i<oports.size(); i++)
+            boundOutChans[i].port = oports[i].get();
+    }
+#endif
+};
+
 //! Helper function to construct a pipewrap process
 /*! This function is used to construct a pipe wrapper process (SystemC
  * module) and connect its input and output signals.
@@ -246,10 +816,606 @@ inline fmi2cswrap* make_fmi2cswrap(const std::string& pName,
     const unsigned& output_index,
     const sc_time& sample_period,
     OIf& outS,
-    I1If& inp1S
+    I1If& inp1S,
+    const sc_time& max_step=SC_ZERO_TIME,
+    const sc_time& min_step=sc_time(0.05,SC_NS),
+    double tol_error=1e-3
+    )
+{
+    auto p = new fmi2cswrap(pName.c_str(), fmu_file, input_index, output_index,
+                            sample_period, max_step, min_step, tol_error);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a multi-input multi-output FMI wrapper
+/*! This function is used to construct an FMI wrapper process (SystemC
+ * module) and connect its input and output signals, in the order of
+ * the given variable indices.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class OIf, class IIf>
+inline fmi2cswrapMN* make_fmi2cswrapMN(const std::string& pName,
+    const std::string& fmu_file,
+    const std::vector<unsigned>& input_indices,
+    const std::vector<unsigned>& output_indices,
+    const sc_time& sample_period,
+    const std::vector<OIf*>& outS,
+    const std::vector<IIf*>& inpS
+    )
+{
+    auto p = new fmi2cswrapMN(pName.c_str(), fmu_file, input_indices,
+                              output_indices, sample_period);
+    
+    for (size_t i=0; i<inpS.size(); i++) (*p).iport(i)(*inpS[i]);
+    for (size_t i=0; i<outS.size(); i++) (*p).oport(i)(*outS[i]);
+    
+    return p;
+}
+
+//! An FMU integrated by fmi2mewrap and its variables bound to the ports
+struct fmi2me_unit
+{
+    std::string fmu_file;                   ///< The FMU file name
+    std::vector<unsigned int> input_indices; ///< The indices of input variables
+    std::vector<unsigned int> output_indices;///< The indices of output variables
+};
+
+//! A direct connection from an output of an FMU to an input of another one
+struct fmi2me_link
+{
+    size_t src_unit;            ///< The index of the source FMU
+    unsigned int src_index;     ///< The index of the source variable
+    size_t dst_unit;            ///< The index of the destination FMU
+    unsigned int dst_index;     ///< The index of the destination variable
+};
+
+//! Process constructor for a model-exchange FMU wrapper
+/*! This class is used to build an FMI wrapper which integrates one or
+ * more Functional Mock-up Units (FMUs) in model-exchange mode, i.e.,
+ * the FMUs only provide the derivatives of their continuous states and
+ * the numerical integration is performed by the wrapper. All the FMUs
+ * share a single solver and step-size controller, and their states form
+ * a single state vector. Hence tightly coupled models, connected using
+ * the links, are integrated together without a communication delay.
+ *
+ * The variables of each FMU listed in its input (output) indices are
+ * bound to the input (output) ports of the process, in the order of the
+ * FMUs. The inputs are sampled and held at each sampling period, and
+ * the outputs at the end of each sampling period are written as constant
+ * sub-signals. The links are evaluated in the given order whenever the
+ * derivatives are computed, and algebraic loops are not resolved.
+ *
+ * The embedded explicit solvers of DDE::filter (Bogacki-Shampine or
+ * Dormand-Prince) are used with adaptive steps. The time events
+ * requested by the FMUs limit the steps, and the state events are
+ * located by bisection of the step on the sign changes of the event
+ * indicators, down to the minimum step.
+ */
+class fmi2mewrap : public ct_process
+{
+public:
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * integrates the FMUs over a sampling period and writes the outputs
+     * using the output ports
+     */
+    fmi2mewrap(sc_module_name _name,    ///< process name
+         const std::vector<fmi2me_unit>& units, ///< The FMUs
+         const std::vector<fmi2me_link>& links, ///< The connections between the FMUs
+         const sc_time& sample_period,  ///< The sampling period
+         DDE::ode_solver solver=DDE::DORMAND_PRINCE,///< The solver
+         double tol_error=1e-6,         ///< The tolerated error
+         const sc_time& min_step=sc_time(0.05,SC_NS) ///< The minimum step
+         ) : ct_process(_name), units(units), links(links),
+             h(sample_period), solver(solver), tol_error(tol_error),
+             min_step(min_step)
+    {
+        if (solver != DDE::BOGACKI_SHAMPINE && solver != DDE::DORMAND_PRINCE)
+            SC_REPORT_ERROR(name(), "only the embedded explicit solvers are supported");
+        size_t ni = 0, no = 0;
+        for (auto& u : units)
+        {
+            ni += u.input_indices.size();
+            no += u.output_indices.size();
+        }
+        for (size_t i=0; i<ni; i++)
+            iports.emplace_back(new CT_in(("iport"+std::to_string(i+1)).c_str()));
+        for (size_t i=0; i<no; i++)
+            oports.emplace_back(new CT_out(("oport"+std::to_string(i+1)).c_str()));
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.emplace_back("fmuFileNames", arg_value([this]()
+        {
+            std::stringstream ss;
+            ss << "{";
+            for (size_t i=0; i<this->units.size(); i++)
+                ss << (i>0?",":"") << this->units[i].fmu_file;
+            ss << "}";
+            return ss.str();
+        }));
+        add_arg("sample_period", sample_period);
+        add_arg("solver", solver);
+        add_arg("tol_error", tol_error);
+#endif
+    }
+    
+    //! The input port bound to the i-th input variable
+    CT_in& iport(size_t i) {return *iports[i];}
+    
+    //! The output port bound to the i-th output variable
+    CT_out& oport(size_t i) {return *oports[i];}
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::fmi2mewrap";}
+
+private:
+    std::vector<std::unique_ptr<CT_in>> iports;
+    std::vector<std::unique_ptr<CT_out>> oports;
+    
+    std::vector<fmi2me_unit> units;
+    std::vector<fmi2me_link> links;
+    sc_time h;
+    DDE::ode_solver solver;
+    double tol_error;
+    sc_time min_step;
+    
+    //! A loaded FMU and its part of the state
+    struct instance
+    {
+        FMU fmu;
+        fmi2Component c;
+        fmi2CallbackFunctions callbacks = {fmuLogger, calloc, free, NULL, &fmu};
+        size_t nx, nz, xoff;        // states, event indicators, state offset
+        std::vector<fmi2ValueReference> ivrs, ovrs;
+        std::vector<fmi2Real> iprims, oprims, z;
+        fmi2EventInfo info;
+    };
+    std::vector<std::unique_ptr<instance>> insts;
+    
+    //! A link with the resolved value references
+    struct resolved_link
+    {
+        instance *src, *dst;
+        fmi2ValueReference src_vr, dst_vr;
+    };
+    std::vector<resolved_link> rlinks;
+    
+    // Inputs and output variables
+    std::vector<sub_signal> ivals;
+    
+    sc_time time;
+    std::vector<double> x, x_;      // the state vector and the new state
+    std::array<std::vector<double>,7> ks;// the stages of the solver
+    bool k0_valid;
+    double hcur;                    // the current step size in seconds
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        time = SC_ZERO_TIME;
+        size_t nx = 0;
+        for (auto& u : units)
+        {
+            insts.emplace_back(new instance());
+            instance& in = *insts.back();
+            loadSharedFMU(u.fmu_file.c_str(), &in.fmu, fmi2ModelExchange);
+            
+            ModelDescription* md = in.fmu.modelDescription;
+            const char* guid = getAttributeValue((Element *)md, att_guid);
+            const char* instanceName = getAttributeValue((Element *)getModelExchange(md),
+                att_modelIdentifier);
+            char* fmuResourceLocation = getSharedResourcesLocation(&in.fmu);
+            in.c = in.fmu.instantiate(instanceName, fmi2ModelExchange, guid,
+                fmuResourceLocation, &in.callbacks, fmi2False, fmi2False/*logging off*/);
+            free(fmuResourceLocation);
+            if (!in.c) return SC_REPORT_ERROR(name(),"could not instantiate model");
+            
+            ValueStatus vs = valueMissing;
+            in.nx = getDerivativesSize(getModelStructure(md));
+            in.nz = getAttributeInt((Element *)md, att_numberOfEventIndicators, &vs);
+            in.xoff = nx;
+            nx += in.nx;
+            
+            if (in.fmu.setupExperiment(in.c, fmi2False, 0, 0, fmi2False, 0) > fmi2Warning)
+                return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI setup experiment");
+            if (in.fmu.enterInitializationMode(in.c) > fmi2Warning)
+                return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI enter initialization mode");
+            if (in.fmu.exitInitializationMode(in.c) > fmi2Warning)
+                return SC_REPORT_ERROR(name(),"could not initialize model; failed FMI exit initialization mode");
+            
+            for (auto k : u.input_indices) in.ivrs.push_back(getRealValueReference(&in.fmu, k));
+            for (auto k : u.output_indices) in.ovrs.push_back(getRealValueReference(&in.fmu, k));
+            in.iprims.resize(in.ivrs.size());
+            in.oprims.resize(in.ovrs.size());
+            in.z.resize(in.nz);
+        }
+        for (auto& l : links)
+        {
+            if (l.src_unit >= insts.size() || l.dst_unit >= insts.size())
+                return SC_REPORT_ERROR(name(),"invalid FMU index in a link");
+            rlinks.push_back(resolved_link{insts[l.src_unit].get(), insts[l.dst_unit].get(),
+                getRealValueReference(&insts[l.src_unit]->fmu, l.src_index),
+                getRealValueReference(&insts[l.dst_unit]->fmu, l.dst_index)});
+        }
+        x.assign(nx, 0);
+        start_instances();
+    }
+    
+    //! Runs the initial event iteration and reads the first inputs
+    void start_instances()
+    {
+        for (auto& in : insts)
+        {
+            in->info.newDiscreteStatesNeeded = fmi2True;
+            in->info.terminateSimulation = fmi2False;
+            while (in->info.newDiscreteStatesNeeded && !in->info.terminateSimulation)
+                in->fmu.newDiscreteStates(in->c, &in->info);
+            if (in->info.terminateSimulation)
+                return SC_REPORT_ERROR(name(),"the model requested to end the simulation");
+            in->fmu.enterContinuousTimeMode(in->c);
+            if (in->nx > 0) in->fmu.getContinuousStates(in->c, x.data()+in->xoff, in->nx);
+            if (in->nz > 0) in->fmu.getEventIndicators(in->c, in->z.data(), in->nz);
+        }
+        k0_valid = false;
+        hcur = in_seconds(h);
+        
+        ivals.resize(iports.size());
+        for (size_t i=0; i<iports.size(); i++) ivals[i] = iports[i]->read();
+    }
+
+#ifdef FORSYDE_RESET
+    //! Resets the FMU instances instead of loading them again
+    void reset()
+    {
+        time = SC_ZERO_TIME;
+        for (auto& in : insts)
+            if (!reset_fmu(in->fmu, in->c))
+                return SC_REPORT_ERROR(name(),"could not reset the model");
+        x.assign(x.size(), 0);
+        start_instances();
+    }
+#endif
+    
+    void prep()
+    {
+        size_t p = 0;
+        for (auto& in : insts)
+        {
+            for (size_t i=0; i<in->ivrs.size(); i++, p++)
+            {
+                while (time >= get_end_time(ivals[p])) ivals[p] = iports[p]->read();
+                in->iprims[i] = ivals[p](time);
+            }
+            if (!in->ivrs.empty())
+                in->fmu.setReal(in->c, in->ivrs.data(), in->ivrs.size(), in->iprims.data());
+        }
+        // the derivatives depend on the new inputs
+        k0_valid = false;
+    }
+    
+    void exec()
+    {
+        if (solver == DDE::BOGACKI_SHAMPINE)
+            integrate(DDE::bogacki_shampine_tableau());
+        else
+            integrate(DDE::dormand_prince_tableau());
+        for (auto& in : insts)
+            if (!in->ovrs.empty())
+                in->fmu.getReal(in->c, in->ovrs.data(), in->ovrs.size(), in->oprims.data());
+    }
+    
+    void prod()
+    {
+        size_t p = 0;
+        for (auto& in : insts)
+            for (size_t i=0; i<in->ovrs.size(); i++, p++)
+            {
+                CT_out& op = *oports[p];
+                write_multiport(op, sub_signal::constant(time, time+h, in->oprims[i]));
+            }
+        time += h;
+        wait(time - model_time());
+    }
+    
+    void clean()
+    {
+        for (auto& in : insts)
+        {
+            in->fmu.terminate(in->c);
+            in->fmu.freeInstance(in->c);
+            releaseSharedFMU(&in->fmu);
+        }
+    }
+    
+    //! Sets the time and the states of all the FMUs and propagates the links
+    void set_states(double t, const std::vector<double>& xs)
+    {
+        for (auto& in : insts)
+        {
+            in->fmu.setTime(in->c, t);
+            if (in->nx > 0) in->fmu.setContinuousStates(in->c, xs.data()+in->xoff, in->nx);
+        }
+        for (auto& l : rlinks)
+        {
+            fmi2Real v;
+            l.src->fmu.getReal(l.src->c, &l.src_vr, 1, &v);
+            l.dst->fmu.setReal(l.dst->c, &l.dst_vr, 1, &v);
+        }
+    }
+    
+    //! Computes the derivative of the composite state vector
+    void derivatives(double t, const std::vector<double>& xs, std::vector<double>& dx)
+    {
+        set_states(t, xs);
+        for (auto& in : insts)
+            if (in->nx > 0) in->fmu.getDerivatives(in->c, dx.data()+in->xoff, in->nx);
+    }
+    
+    //! Checks if an event indicator changes its sign at the current states
+    bool state_event()
+    {
+        bool crossed = false;
+        for (auto& in : insts)
+        {
+            if (in->nz == 0) continue;
+            std::vector<fmi2Real> zn(in->nz);
+            in->fmu.getEventIndicators(in->c, zn.data(), in->nz);
+            for (size_t i=0; i<in->nz; i++)
+                if ((in->z[i] > 0) != (zn[i] > 0)) crossed = true;
+        }
+        return crossed;
+    }
+    
+    //! Handles the events of all the FMUs at the current time and states
+    void handle_events()
+    {
+        for (auto& in : insts)
+        {
+            in->fmu.enterEventMode(in->c);
+            in->info.newDiscreteStatesNeeded = fmi2True;
+            in->info.terminateSimulation = fmi2False;
+            while (in->info.newDiscreteStatesNeeded && !in->info.terminateSimulation)
+                in->fmu.newDiscreteStates(in->c, &in->info);
+            if (in->info.terminateSimulation)
+                return SC_REPORT_ERROR(name(),"the model requested to end the simulation");
+            in->fmu.enterContinuousTimeMode(in->c);
+            if (in->nx > 0) in->fmu.getContinuousStates(in->c, x.data()+in->xoff, in->nx);
+            if (in->nz > 0) in->fmu.getEventIndicators(in->c, in->z.data(), in->nz);
+        }
+        k0_valid = false;
+    }
+    
+    //! The earliest time event requested by the FMUs, or a negative value
+    double next_time_event() const
+    {
+        double te = -1;
+        for (auto& in : insts)
+            if (in->info.nextEventTimeDefined && (te < 0 || in->info.nextEventTime < te))
+                te = in->info.nextEventTime;
+        return te;
+    }
+    
+    //! Integrates the FMUs over a sampling period
+    template <unsigned S>
+    void integrate(const DDE::rk_tableau<S>& tb)
+    {
+        auto f = [this](double t, const std::vector<double>& xs, std::vector<double>& dx)
+                 {derivatives(t, xs, dx);};
+        const double hmin = in_seconds(min_step);
+        double t = in_seconds(time);
+        const double tend = in_seconds(time + h);
+        while (tend - t > hmin/2)
+        {
+            double hs = hcur < tend - t ? hcur : tend - t;
+            const double te = next_time_event();
+            const bool at_time_event = te > t && te <= t + hs;
+            if (at_time_event) hs = te - t;
+            const double err = DDE::erk_step_f(tb, f, t, x, hs, ks, k0_valid, x_);
+            // step size control
+            double fac = err > 0 ? 0.9*std::pow(tol_error/err, 1.0/tb.order) : 5.0;
+            fac = fac < 0.2 ? 0.2 : fac > 5.0 ? 5.0 : fac;
+            if (err > tol_error && hs > hmin)
+            {
+                hcur = hs*fac > hmin ? hs*fac : hmin;
+                continue;
+            }
+            // the FMUs are at the end of the step
+            if (state_event())
+            {
+                // locate the event by bisection of the step
+                double lo = 0, hi = hs;
+                while (hi - lo > hmin)
+                {
+                    const double mid = (lo + hi) / 2;
+                    DDE::erk_step_f(tb, f, t, x, mid, ks, k0_valid, x_);
+                    if (state_event()) hi = mid; else lo = mid;
+                }
+                DDE::erk_step_f(tb, f, t, x, hi, ks, k0_valid, x_);
+                t += hi;
+                x.swap(x_);
+                handle_events();
+                continue;
+            }
+            t += hs;
+            x.swap(x_);
+            // the last stage is the first one of the next step (FSAL)
+            ks[0].swap(ks[S-1]);
+            bool enter_event = false;
+            for (auto& in : insts)
+            {
+                fmi2Boolean ev = fmi2False, term = fmi2False;
+                in->fmu.completedIntegratorStep(in->c, fmi2True, &ev, &term);
+                if (term) return SC_REPORT_ERROR(name(),"the model requested to end the simulation");
+                if (ev) enter_event = true;
+                if (in->nz > 0) in->fmu.getEventIndicators(in->c, in->z.data(), in->nz);
+            }
+            if (enter_event || at_time_event) handle_events();
+            hcur = hs*fac > hmin ? hs*fac : hmin;
+        }
+        set_states(t, x);
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(iports.size());
+        for (size_t i=0; i<iports.size(); i++)
+            boundInChans[i].port = iports[i].get();
+        boundOutChans.resize(oports.size());
+        for (size_t i=0; i<oports.size(); i++)
+            boundOutChans[i].port = oports[i].get();
+    }
+#endif
+};
+
+//! Helper function to construct a model-exchange FMI wrapper
+/*! This function is used to construct an FMI wrapper process (SystemC
+ * module) and connect its input and output signals, in the order of
+ * the FMUs and their variable indices.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class OIf, class IIf>
+inline fmi2mewrap* make_fmi2mewrap(const std::string& pName,
+    const std::vector<fmi2me_unit>& units,
+    const std::vector<fmi2me_link>& links,
+    const sc_time& sample_period,
+    const std::vector<OIf*>& outS,
+    const std::vector<IIf*>& inpS,
+    DDE::ode_solver solver=DDE::DORMAND_PRINCE,
+    double tol_error=1e-6
+    )
+{
+    auto p = new fmi2mewrap(pName.c_str(), units, links, sample_period,
+                            solver, tol_error);
+    
+    for (size_t i=0; i<inpS.size(); i++) (*p).iport(i)(*inpS[i]);
+    for (size_t i=0; i<outS.size(); i++) (*p).oport(i)(*outS[i]);
+    
+    return p;
+}
+
+//! Process constructor for a shared memory wrapper with one input and one output
+/*! This class is used to build a wrapper with one input and one output
+ * which exchanges samples with an external simulator using two shared
+ * memory rings, as SY::shmwrap. In each sampling period, the value of
+ * the input at the beginning of the period is sent to the model as a
+ * double, and the value received from the model is held for the period.
+ * An empty message from the model means it has terminated.
+ */
+class shmwrap : public ct_process
+{
+public:
+    CT_in  iport1;       ///< port for the input channel
+    CT_out oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which samples its input port, provides
+     * the samples to the external model, collects the produced outputs
+     * and writes them using the output port
+     */
+    shmwrap(sc_module_name _name,       ///< process name
+         const std::string& shm_prefix, ///< the prefix of the names of the shared memory segments (starting with '/')
+         const sc_time& sample_period   ///< The sampling period
+         ) : ct_process(_name), iport1("iport1"), oport1("oport1"),
+             shm_prefix(shm_prefix), h(sample_period)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("shm_prefix", shm_prefix));
+        add_arg("sample_period", sample_period);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "CT::shmwrap";}
+
+private:
+    // Inputs and output variables
+    sub_signal ival1;
+    double res;
+    std::vector<char> obuf;
+    
+    //! The prefix of the names of the segments
+    std::string shm_prefix;
+    sc_time h;
+    sc_time time;
+    
+    // Communication rings
+    std::unique_ptr<shm_ring> inp_ring;  // Input (to the external model) ring
+    std::unique_ptr<shm_ring> out_ring;  // Output (from the external model) ring
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        time = SC_ZERO_TIME;
+        const std::string base = shm_prefix + "_" + basename();
+        inp_ring.reset(new shm_ring(base + "_inp", true));
+        out_ring.reset(new shm_ring(base + "_out", true));
+        ival1 = iport1.read();
+    }
+    
+    void prep()
+    {
+        while (time >= get_end_time(ival1)) ival1 = iport1.read();
+        const double sample = ival1(time);
+        shm_write_wait(*inp_ring, reinterpret_cast<const char*>(&sample), sizeof(sample));
+    }
+    
+    void exec()
+    {
+        shm_read_wait(*out_ring, obuf);
+        if (obuf.empty()) wait(); // The model has terminated
+        if (obuf.size() != sizeof(res))
+            return SC_REPORT_ERROR(name(),"Malformed message from the output ring.");
+        std::memcpy(&res, obuf.data(), sizeof(res));
+    }
+    
+    void prod()
+    {
+        write_multiport(oport1, sub_signal::constant(time, time+h, res))
+        time += h;
+        wait(time - model_time());
+    }
+    
+    void clean()
+    {
+        inp_ring.reset();
+        out_ring.reset();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a shmwrap process
+/*! This function is used to construct a shared memory wrapper process
+ * (SystemC module) and connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class OIf, class IIf>
+inline shmwrap* make_shmwrap(const std::string& pName,
+    const std::string& shm_prefix,
+    const sc_time& sample_period,
+    OIf& outS,
+    IIf& inp1S
     )
 {
-    auto p = new fmi2cswrap(pName.c_str(), fmu_file, input_index, output_index, sample_period);
+    auto p = new shmwrap(pName.c_str(), shm_prefix, sample_period);
     
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -0,0 +1,185 @@
+/**********************************************************************
+    * data_parallel_pool.hpp -- A thread pool for data-parallel loops *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a persistent thread pool which executes the  *
+    *          loops of the data-parallel process constructors        *
+    *                                                                 *
+    * Usage:   Define FORSYDE_MULTITHREADED to use it                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef DATA_PARALLEL_POOL_HPP
+#define DATA_PARALLEL_POOL_HPP
+
+/*! \file data_parallel_pool.hpp
+ * \brief Implements a thread pool for the data-parallel loops
+ *
+ *  This file includes a thread pool with static scheduling used by the
+ * data-parallel process constructors (sdpmap, sdpreduce and sdpscan).
+ * The worker threads are created once and are reused in all the
+ * evaluation cycles of all the processes.
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#include <algorithm>
+
+//! The number of threads of the data-parallel pool
+/*! The number of hardware threads is used if it is zero.
+ */
+#ifndef FORSYDE_DP_THREADS
+#define FORSYDE_DP_THREADS 0
+#endif
+
+//! The default size below which the data-parallel loops run serially
+#ifndef FORSYDE_DP_THRESHOLD
+#define FORSYDE_DP_THRESHOLD 4096
+#endif
+
+namespace ForSyDe
+{
+
+//! A thread pool executing loops with chunked static scheduling
+/*! A loop of n iterations is divided into one contiguous chunk per
+ * thread, where the calling thread executes the first chunk and the
+ * worker threads the rest. The workers spin for a short while before
+ * sleeping, so that the loops of consecutive evaluation cycles do not
+ * pay for waking them up.
+ *
+ * Only one loop runs at a time. A loop started while another one is
+ * running (e.g., from the threads of a parallel executor) is executed
+ * serially by its calling thread.
+ */
+class data_parallel_pool
+{
+public:
+    //! The type of the loop body, called with a chunk and its index
+    typedef std::function<void(size_t, size_t, unsigned)> chunk_body;
+
+    //! Returns the single instance of the pool
+    static data_parallel_pool& get()
+    {
+        static data_parallel_pool pool(FORSYDE_DP_THREADS);
+        return pool;
+    }
+
+    //! The number of threads, including the calling thread
+    unsigned size() const {return threads.size()+1;}
+
+    //! The first iteration of a chunk
+    static size_t chunk_begin(size_t n, unsigned chunks, unsigned c)
+    {
+        return n * c / chunks;
+    }
+
+    //! Runs a loop and waits for all of its chunks to finish
+    /*! The body is called with the range [begin,end) and the index of
+     * each chunk. It returns the number of chunks, which is at most
+     * size().
+     */
+    unsigned parallel_for(size_t n, const chunk_body& _body)
+    {
+        std::unique_lock<std::mutex> busy(run_m, std::try_to_lock);
+        const unsigned chunks = busy.owns_lock() ?
+                                std::min<size_t>(size(), n) : 1;
+        if (chunks <= 1)
+        {
+            _body(0, n, 0);
+            return 1;
+        }
+        {
+            std::lock_guard<std::mutex> lk(m);
+            body = &_body;
+            iters = n;
+            nchunks = chunks;
+            pending.store(chunks-1, std::memory_order_relaxed);
+            epoch.store(epoch.load(std::memory_order_relaxed)+1,
+                        std::memory_order_release);
+        }
+        start_cv.notify_all();
+        _body(0, chunk_begin(n, chunks, 1), 0);
+        for (unsigned k=0; pending.load(std::memory_order_acquire)>0; k++)
+            if (k >= spin_count)
+            {
+                std::unique_lock<std::mutex> lk(m);
+                done_cv.wait(lk, [this]{return pending.load(std::memory_order_acquire)==0;});
+            }
+        return chunks;
+    }
+
+private:
+    std::vector<std::thread> threads;
+
+    std::mutex run_m, m;
+    std::condition_variable start_cv, done_cv;
+    std::atomic<size_t> epoch;
+    bool stop;
+
+    std::atomic<unsigned> pending;
+    const chunk_body* body;
+    size_t iters;
+    unsigned nchunks;
+
+    //! The number of polls before a thread goes to sleep
+    static const unsigned spin_count = 4096;
+
+    explicit data_parallel_pool(unsigned nthreads) : epoch(0), stop(false),
+        pending(0), body(NULL), iters(0), nchunks(0)
+    {
+        if (nthreads == 0) nthreads = std::thread::hardware_concurrency();
+        if (nthreads == 0) nthreads = 1;
+        for (unsigned i=1; i<nthreads; i++)
+            threads.emplace_back(&data_parallel_pool::worker, this, i);
+    }
+
+    ~data_parallel_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        start_cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    //! The main loop of a worker thread, which executes chunk c
+    void worker(unsigned c)
+    {
+        size_t seen = 0;
+        while (true)
+        {
+            for (unsigned k=0; k<spin_count; k++)
+                if (epoch.load(std::memory_order_acquire) != seen) break;
+            const chunk_body* b;
+            size_t n;
+            unsigned chunks;
+            {
+                std::unique_lock<std::mutex> lk(m);
+                start_cv.wait(lk, [&]{return stop || epoch.load(std::memory_order_relaxed)!=seen;});
+                if (stop) return;
+                seen = epoch.load(std::memory_order_relaxed);
+                b = body;
+                n = iters;
+                chunks = nchunks;
+            }
+            if (c >= chunks) continue;
+            (*b)(chunk_begin(n, chunks, c), chunk_begin(n, chunks, c+1), c);
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                std::lock_guard<std::mutex> lk(m);
+                done_cv.notify_all();
+            }
+        }
+    }
+};
+
+}
+
+#endif
@@ -204,6 +204,25 @@ inline vsource<T>* make_vsource(std::string pName,  ///< the module name
     return p;
 }
 
+//! Helper function to construct a stream source process
+/*! This function is used to construct a source (SystemC module) which
+ * reads a token_stream and connect its output signal. It is used as
+ * make_vsource, with a stream (e.g., from make_generator_stream or
+ * make_file_stream) instead of a vector.
+ */
+template <class T, template <class> class OIf>
+inline stream_source<T>* make_vsource(const std::string& pName,
+    std::shared_ptr<token_stream<std::tuple<sc_time,T>>> stream,
+    OIf<T>& outS
+    )
+{
+    auto p = new stream_source<T>(pName.c_str(), stream);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a sink process
 /*! This function is used to construct a sink (SystemC module) and
  * connect its output and output signals.
@@ -270,6 +289,26 @@ inline zipX<T1,N>* make_zipX(std::string pName,
     return p;
 }
 
+//! Helper function to construct a zipN process
+/*! This function is used to construct a zipN process (SystemC module) and
+ * connect its output signal.
+ * The user binds the inputs manually.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <template <class> class OIf, class... Ts>
+inline zipN<Ts...>* make_zipN(const std::string& pName,
+    OIf<std::tuple<abst_ext<Ts>...>>& outS
+    )
+{
+    auto p = new zipN<Ts...>(pName.c_str());
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct an unzip process
 /*! This function is used to construct an unzip process (SystemC module) and
  * connect its output and output signals.
@@ -316,6 +355,26 @@ inline unzipX<T1,N>* make_unzipX(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct an unzipN process
+/*! This function is used to construct an unzipN process (SystemC module) and
+ * connect its input signal.
+ * The user binds the outputs manually.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <template <class> class IIf, class... Ts>
+inline unzipN<Ts...>* make_unzipN(const std::string& pName,
+    IIf<std::tuple<abst_ext<Ts>...>>& inpS
+    )
+{
+    auto p = new unzipN<Ts...>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    
+    return p;
+}
+
 //! Helper function to construct a fanout process
 /*! This function is used to construct a fanout process (SystemC module) and
  * connect its output and output signals.
@@ -30,6 +30,7 @@
 #include "dde_process.hpp"
 #include "dde_process_constructors.hpp"
 #include "dde_helpers.hpp"
+#include "dde_scheduler.hpp"
 
 namespace ForSyDe
 {
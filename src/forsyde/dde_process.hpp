@@ -20,6 +20,9 @@
  * abstract base process used in the distributed discrete-event MoC.
  */
 
+#include <vector>
+#include <cmath>
+
 #include "tt_event.hpp"
 #include "abssemantics.hpp"
 
@@ -31,13 +34,31 @@ namespace DDE
 
 using namespace sc_core;
 
+//! The interface of the DDE signals used by the event scheduler
+/*! It gives the time tag of the next event of a signal whose both ends
+ * are executed by the event scheduler.
+ */
+class timed_channel
+{
+public:
+    //! Gets the time tag of the first event, if the static buffer has any
+    virtual bool head_time(sc_time& t) const = 0;
+};
+
 //! The DDE2DDE signal used to inter-connect DDE processes
 template <typename T>
-class DDE2DDE: public ForSyDe::signal<T,ttn_event<T>>
+class DDE2DDE: public ForSyDe::signal<T,ttn_event<T>>, public timed_channel
 {
 public:
     DDE2DDE() : ForSyDe::signal<T,ttn_event<T>>() {}
     DDE2DDE(sc_module_name name, unsigned size) : ForSyDe::signal<T,ttn_event<T>>(name, size) {}
+    
+    bool head_time(sc_time& t) const
+    {
+        if (!this->is_static_buffer() || this->num_available() == 0) return false;
+        t = get_time(this->peek(0));
+        return true;
+    }
 #ifdef FORSYDE_INTROSPECTION
     
     virtual std::string moc() const
@@ -51,6 +72,32 @@ public:
 template <typename T>
 using signal = DDE2DDE<T>;
 
+//! A DDE signal based on the single-producer single-consumer ring buffer
+/*! It can be used instead of DDE::signal for signals with exactly one
+ * writer and one reader to avoid the sc_fifo overheads.
+ */
+template <typename T>
+class spsc_signal: public ForSyDe::signal<T,ttn_event<T>,spsc_fifo>, public timed_channel
+{
+public:
+    spsc_signal() : ForSyDe::signal<T,ttn_event<T>,spsc_fifo>() {}
+    spsc_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,ttn_event<T>,spsc_fifo>(name, size) {}
+    
+    bool head_time(sc_time& t) const
+    {
+        if (!this->is_static_buffer() || this->num_available() == 0) return false;
+        t = get_time(this->peek(0));
+        return true;
+    }
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "DDE";
+    }
+#endif
+};
+
 //! The DDE_in port is used for input ports of DDE processes
 template <typename T>
 class DDE_in: public ForSyDe::in_port<T,ttn_event<T>,signal<T>>
@@ -92,7 +139,160 @@ template <typename T>
 using out_port = DDE_out<T>;
 
 //! Abstract semantics of a process in the DDE MoC
-typedef ForSyDe::process dde_process;
+/*! The DDE processes synchronize with the kernel time after producing
+ * their events using sync(), and stop using halt(). When they are
+ * executed by the event scheduler these only record the local time of
+ * the process, and the scheduler decides when to synchronize.
+ *
+ * With a local time quantum, a process only waits for the kernel when
+ * its local time reaches the next multiple of the quantum, as in the
+ * temporal decoupling of TLM-2.0, hence a chain of processes with
+ * delays runs ahead of the kernel time with fewer context switches. It
+ * keeps the semantics, since the events carry their time tags, but the
+ * processes which use the kernel time (e.g., the MoC interfaces to the
+ * timed MoCs and the realtime pacers) should not be given a quantum.
+ */
+class dde_process : public ForSyDe::process
+{
+public:
+    //! The constructor requires the module name
+    dde_process(sc_module_name _name    ///< The name of the ForSyDe process
+                ) : ForSyDe::process(_name), local(SC_ZERO_TIME),
+                    event_driven(false), halted(false) {}
+    
+    //! Hands over the execution of the process to the event scheduler
+    /*! The input channels are used by the default inputs_ready().
+     */
+    void set_event_driven(const std::vector<static_channel*>& ins)
+    {
+        in_chans = ins;
+        event_driven = true;
+        set_ext_driven();
+    }
+    
+    //! The local time of the process, i.e., the last time it synchronized to
+    const sc_time& local_time() const {return local;}
+    
+    //! Lets the process run ahead of the kernel time within a quantum
+    /*! A zero quantum, the default, synchronizes on every event.
+     */
+    void set_quantum(const sc_time& q)
+    {
+        quantum = q;
+        next_sync = SC_ZERO_TIME;
+    }
+    
+    //! The local time quantum of the process
+    const sc_time& get_quantum() const {return quantum;}
+    
+    //! Checks if the process has stopped producing events
+    bool is_halted() const {return halted;}
+    
+    //! Checks if the next evaluation cycle reads its inputs without blocking
+    /*! The default is for the processes which read one event from each
+     * input in every cycle. The ones which merge their inputs by time
+     * only need the inputs whose clocks are equal to their local time.
+     */
+    virtual bool inputs_ready() const
+    {
+        for (auto c : in_chans)
+            if (c->num_available() == 0) return false;
+        return true;
+    }
+    
+#ifdef FORSYDE_CHECKPOINT
+    //! Saves the state of the process, including its local time
+    /*! It is used by the executors which roll the processes back during
+     * the simulation (see time_warp).
+     */
+    void save_snapshot(std::vector<char>& buf)
+    {
+        save_values(buf, local, halted);
+        save_state(buf);
+    }
+    
+    //! Rolls the process back to a state saved by save_snapshot()
+    void restore_snapshot(const char*& pos)
+    {
+        restore_values(pos, local, halted);
+        restore_state(pos);
+        next_sync = SC_ZERO_TIME;
+    }
+#endif
+    
+protected:
+    //! Synchronizes the process with the kernel at a time
+    void sync(const sc_time& t)
+    {
+        local = t;
+        if (event_driven) return;
+        if (quantum == SC_ZERO_TIME)
+        {
+            wait(t - model_time());
+            return;
+        }
+        if (t < next_sync) return;
+        // the events read from the processes running ahead may be late
+        if (t > model_time()) wait(t - model_time());
+        next_sync = quantum * (std::floor(t / quantum) + 1);
+    }
+    
+    //! Stops the process for the rest of the simulation
+    void halt()
+    {
+        halted = true;
+        if (!event_driven) wait();
+    }
+
+#ifdef FORSYDE_RESET
+    //! Restarts the local time as well
+    void reset()
+    {
+        local = SC_ZERO_TIME;
+        next_sync = SC_ZERO_TIME;
+        halted = false;
+        ForSyDe::process::reset();
+    }
+#endif
+
+private:
+    sc_time local;
+    // the local time quantum and the next time to synchronize at
+    sc_time quantum, next_sync;
+    bool event_driven;
+    bool halted;
+    std::vector<static_channel*> in_chans;
+};
+
+//! The interface of the processes whose side effects can be held back
+/*! An executor which rolls the processes back (see time_warp) asks these
+ * processes to keep the effects of their firings, e.g., the calls of the
+ * function of a sink, until the firings can no longer be undone.
+ */
+class deferred_effects
+{
+public:
+    virtual ~deferred_effects() {}
+
+    //! Keeps the effects from now on instead of performing them
+    virtual void defer_effects() = 0;
+
+    //! Performs the kept effects of the events before a time
+    virtual void commit_effects(const sc_time& t) = 0;
+
+    //! Drops the kept effects of the events at or after a time
+    virtual void discard_effects(const sc_time& t) = 0;
+};
+
+//! Sets the local time quantum of all the DDE processes in a region of the model
+/*! The region is a module and all the modules below it. It should be
+ * called before the simulation starts.
+ */
+inline void set_quantum(sc_object& region, const sc_time& q)
+{
+    if (auto p = dynamic_cast<dde_process*>(&region)) p->set_quantum(q);
+    for (auto child : region.get_child_objects()) set_quantum(*child, q);
+}
 
 }
 }
@@ -26,10 +26,23 @@
 #include <algorithm>
 #include <tuple>
 #include <deque>
+#include <array>
+#include <vector>
+#include <utility>
+#include <cmath>
+#include <map>
+#include <memory>
 #include <boost/numeric/ublas/matrix.hpp>
+#include <boost/numeric/ublas/io.hpp>
 
 #include "tt_event.hpp"
+#include "time_ticks.hpp"
 #include "dde_process.hpp"
+#include "token_stream.hpp"
+#include "solver_stats.hpp"
+#include "matrix_kernel.hpp"
+#include "async_sink.hpp"
+#include "prefetch.hpp"
 
 namespace ForSyDe
 {
@@ -66,9 +79,7 @@ public:
              _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
@@ -108,7 +119,7 @@ private:
         auto oev = ttn_event<T0>(*oval, get_time(*iev1));
         write_multiport(oport1, oev);
         // synchronization with kernel time
-        wait(get_time(oev) - sc_time_stamp());
+        sync(get_time(oev));
     }
 
     void clean()
@@ -153,14 +164,19 @@ public:
               _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::comb2";}
+
+    //! Only the inputs whose clocks are equal to the local time are read
+    bool inputs_ready() const
+    {
+        return (in1T != tl || iport1.num_available() > 0) &&
+               (in2T != tl || iport2.num_available() > 0);
+    }
 private:
     // Inputs and output variables
     abst_ext<T0>* oval;
@@ -227,7 +243,7 @@ private:
     void prod()
     {
         write_multiport(oport1, ttn_event<T0>(*oval,tl));
-        wait(tl - sc_time_stamp());
+        sync(tl);
     }
 
     void clean()
@@ -238,6 +254,11 @@ private:
         delete cur_ival1;
         delete cur_ival2;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *next_iev1, *next_iev2, tl, in1T, in2T);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *next_iev1, *next_iev2, tl, in1T, in2T);}
+#endif
 
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -279,12 +300,8 @@ public:
               init_val(init_val), delay_time(delay_time)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << delay_time;
-        arg_vec.push_back(std::make_tuple("delay_time", ss.str()));
+        add_arg("init_val", init_val);
+        add_arg("delay_time", delay_time);
 #endif
     }
 
@@ -304,7 +321,8 @@ private:
     {
         ev = new ttn_event<T>;
         auto oev = ttn_event<T>(init_val, SC_ZERO_TIME);
-        write_multiport(oport1, oev);
+        // the initial event is restored with the signal
+        if (!is_restored()) write_multiport(oport1, oev);
         wait(SC_ZERO_TIME);
     }
 
@@ -321,7 +339,7 @@ private:
     void prod()
     {
         write_multiport(oport1, *ev);
-        wait(get_time(*ev) - sc_time_stamp());
+        sync(get_time(*ev));
     }
 
     void clean()
@@ -371,16 +389,10 @@ public:
               init_st(init_st), delay_time(delay_time)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
-        ss.str("");
-        ss << delay_time;
-        arg_vec.push_back(std::make_tuple("delay_time",ss.str()));
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+        add_arg("delay_time", delay_time);
 #endif
     }
 
@@ -437,6 +449,11 @@ private:
         delete nsval;
         delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -481,22 +498,23 @@ public:
               init_st(init_st), delay_time(delay_time)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
-        ss.str("");
-        ss << delay_time;
-        arg_vec.push_back(std::make_tuple("delay_time",ss.str()));
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+        add_arg("delay_time", delay_time);
 #endif
     }
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const{return "DDE::mealy2";}
 
+    //! Only the inputs whose clocks are equal to the local time are read
+    bool inputs_ready() const
+    {
+        return (in1T != tl || iport1.num_available() > 0) &&
+               (in2T != tl || iport2.num_available() > 0);
+    }
+
 private:
     //! The functions passed to the process constructor
     ns_functype _ns_func;
@@ -578,7 +596,7 @@ private:
     void prod()
     {
         write_multiport(oport1, ttn_event<OT>(*oval,tl+delay_time));
-        wait(tl - sc_time_stamp());
+        sync(tl);
     }
 
     void clean()
@@ -591,6 +609,11 @@ private:
         delete nsval;
         delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval, *next_iev1, *next_iev2, tl, in1T, in2T);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval, *next_iev1, *next_iev2, tl, in1T, in2T);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -603,6 +626,451 @@ private:
 #endif
 };
 
+//! Obtains the state space matrices of a transfer function
+/*! The matrices are in the controllable canonical (companion) form and
+ * are resized to the order of the denominator. It is assumed that there
+ * are non-zero leading coefficients in num and denom.
+ */
+template <class T>
+inline int tf2ss(std::vector<T> num_, std::vector<T> den_, matrix<T> & a,
+      matrix<T> & b, matrix<T> & c, matrix<T> & d)
+{
+    std::vector<T> num, den;
+    // sizes checking
+    int nn = num_.size(), nd = den_.size();
+    if(nn >= nd)
+    {
+        std::cerr << "ERROR: " << "degree(num) = " << nn
+        << " >= degree(denom) = " << nd << std::endl;
+        abort();
+    }
+    a = matrix<T>(nd-1,nd-1);
+    b = matrix<T>(nd-1,1);
+    c = matrix<T>(1,nd-1);
+    d = matrix<T>(1,1);
+    T dCoef1 = den_.at(0);
+    if(nd==1)
+    {
+        //~ a = NULL, b = NULL, c = NULL;
+        d = matrix<T>(1,1);
+        d(0,0) = num_.at(0)/dCoef1;
+    }
+    else
+    {
+        if ((nd - nn) > 0)
+        {
+            // Pad num so that degree(num) == degree(denom)
+            for(int i=0; i<nd; i++)
+            {
+                if(i<(nd-nn))
+                    num.push_back(0.0);
+                else
+                    num.push_back(num_.at(i-nd+nn));
+            }
+        }
+
+        // Normalizing w.r.t the leading coefficient of denominator
+        for(unsigned int i=0; i<num.size(); i++)
+            num.at(i) /= dCoef1;
+        for(unsigned int i=0; i<den_.size(); i++)
+            den_.at(i) /= dCoef1;
+        for(unsigned int i=0; i<(den_.size()-1); i++)
+            den.push_back(den_.at(i+1));
+
+        // Form A (nd-1)*(nd-1)
+        a = zero_matrix<T> (a.size1(), a.size2());
+        if(nd > 2)
+        {
+            // The eyes (up-right corner) are set to '1'
+            for(int i=0; i<(nd-2); i++)
+                for(int j=0; j<(nd-1); j++)
+                    if((j-i)==1) a(i,j) = 1.0;
+            // The lower row(s)
+            for(int j=0; j<(nd-1); j++)
+                a(nd-2,j) = 0-den.at(nd-2-j);
+        }
+        else
+            a(0,0) = 0-den.at(0);
+        //
+        // Form B (nd-1)*1
+        b = zero_matrix<T> (b.size1(), b.size2());
+        b(nd-2,0) = 1.0;
+        //
+        // Form C 1*(nd-1)
+        for(int j=0; j< nd-1; j++)
+            c(0,nd-2-j) = num.at(j+1) - num.at(0)*den.at(j);
+        //
+        // Form D 1*1
+        d(0,0) = num.at(0);
+    }
+
+    return 0;
+}
+
+//! A single-input single-output state-space model
+template <class T>
+struct ss_model
+{
+    matrix<T> a, b, c, d;
+    //! The model is in the companion form produced by tf2ss
+    bool companion;
+};
+
+//! Checks if a state-space model is in the companion form
+/*! In this form, a has ones on its super-diagonal and zeros elsewhere
+ * except in the last row, and b is the last unit vector. The products
+ * with such matrices need O(n) instead of O(n^2) operations.
+ */
+template <class T>
+inline bool is_companion(const matrix<T>& a, const matrix<T>& b)
+{
+    const size_t n = a.size1();
+    for (size_t i=0; i+1<n; i++)
+    {
+        if (b(i,0) != 0) return false;
+        for (size_t j=0; j<n; j++)
+            if (a(i,j) != (j==i+1 ? 1 : 0)) return false;
+    }
+    return n == 0 || b(n-1,0) == 1;
+}
+
+//! Returns the state-space model of a transfer function
+/*! The conversions are cached by the coefficients, so that identical
+ * filters share a single model. It is meant to be called during the
+ * elaboration or the initialization, which are single-threaded.
+ */
+template <class T>
+inline std::shared_ptr<const ss_model<T>> tf2ss_cached(const std::vector<T>& num,
+                                                       const std::vector<T>& den)
+{
+    static std::map<std::pair<std::vector<T>,std::vector<T>>,
+                    std::shared_ptr<const ss_model<T>>> cache;
+    auto& m = cache[std::make_pair(num, den)];
+    if (!m)
+    {
+        auto res = std::make_shared<ss_model<T>>();
+        tf2ss(num, den, res->a, res->b, res->c, res->d);
+        res->companion = is_companion(res->a, res->b);
+        m = res;
+    }
+    return m;
+}
+
+//! Performs a Runge-Kutta step of a single-input single-output state-space system
+/*! The system is defined by the matrices a (n*n), b (n*1), c (1*n) and
+ * d (1*1), and the input is interpolated linearly between u_k_1 and
+ * u_k over the step. The stage vectors k1..k4 (n*1) are passed by the
+ * caller and reused, hence no matrices are allocated. The new state x_
+ * may be the same object as the current state x.
+ */
+template <class T>
+inline void rk4_step(const matrix<T>& a, const matrix<T>& b,
+                     const matrix<T>& c, const matrix<T>& d,
+                     T u_k, T u_k_1, const matrix<T>& x, T h,
+                     matrix<T>& k1, matrix<T>& k2, matrix<T>& k3, matrix<T>& k4,
+                     matrix<T>& x_, T& y, bool companion=false)
+{
+    const size_t n = a.size1();
+    const T u_m = (u_k_1 + u_k) * 0.5;
+    // k = a*(x + s*kp) + b*u
+    auto stage = [&](matrix<T>& k, const matrix<T>* kp, T s, T u)
+    {
+        auto xe = [&](size_t j) {return kp ? x(j,0) + s*(*kp)(j,0) : x(j,0);};
+        if (companion && n > 0)
+        {
+            T acc = u;
+            for (size_t j=0; j<n; j++) acc += a(n-1,j) * xe(j);
+            for (size_t i=0; i+1<n; i++) k(i,0) = xe(i+1);
+            k(n-1,0) = acc;
+            return;
+        }
+        for (size_t i=0; i<n; i++)
+        {
+            T acc = b(i,0) * u;
+            for (size_t j=0; j<n; j++)
+                acc += a(i,j) * xe(j);
+            k(i,0) = acc;
+        }
+    };
+    stage(k1, NULL, 0, u_k_1);
+    stage(k2, &k1, h/2.0, u_m);
+    stage(k3, &k2, h/2.0, u_m);
+    stage(k4, &k3, h, u_k);
+    y = d(0,0) * u_k;
+    for (size_t i=0; i<n; i++)
+    {
+        x_(i,0) = x(i,0) + (k1(i,0) + 2.0*k2(i,0) + 2.0*k3(i,0) + k4(i,0)) * (h/6.0);
+        y += c(0,i) * x_(i,0);
+    }
+}
+
+//! The solvers of the adaptive linear filter
+/*! RK4 estimates the error by step doubling (three RK4 solutions per
+ * step). The other solvers estimate it from an embedded lower-order
+ * solution: BOGACKI_SHAMPINE is a 3(2) pair and DORMAND_PRINCE a 5(4)
+ * pair, both reusing the last stage of an accepted step as the first
+ * one of the next (FSAL). ROSENBROCK is the linearly implicit ROS2
+ * method, which is L-stable and suited to stiff filters.
+ */
+enum ode_solver {RK4, BOGACKI_SHAMPINE, DORMAND_PRINCE, ROSENBROCK};
+
+//! The Butcher tableau of an explicit embedded Runge-Kutta pair with the FSAL property
+/*! The last stage is evaluated at the solution, i.e., the last row of
+ * a holds the weights of the solution. The error weights e are the
+ * differences of the weights of the solution and the embedded one.
+ */
+template <unsigned S>
+struct rk_tableau
+{
+    static constexpr unsigned stages = S;
+    double c[S];
+    double a[S][S];
+    double e[S];
+    //! The exponent used in the step size control
+    unsigned order;
+};
+
+//! The Bogacki-Shampine 3(2) pair
+inline const rk_tableau<4>& bogacki_shampine_tableau()
+{
+    static const rk_tableau<4> tb = {
+        {0, 1.0/2, 3.0/4, 1},
+        {{0}, {1.0/2}, {0, 3.0/4}, {2.0/9, 1.0/3, 4.0/9}},
+        {2.0/9-7.0/24, 1.0/3-1.0/4, 4.0/9-1.0/3, -1.0/8},
+        3
+    };
+    return tb;
+}
+
+//! The Dormand-Prince 5(4) pair
+inline const rk_tableau<7>& dormand_prince_tableau()
+{
+    static const rk_tableau<7> tb = {
+        {0, 1.0/5, 3.0/10, 4.0/5, 8.0/9, 1, 1},
+        {{0},
+         {1.0/5},
+         {3.0/40, 9.0/40},
+         {44.0/45, -56.0/15, 32.0/9},
+         {19372.0/6561, -25360.0/2187, 64448.0/6561, -212.0/729},
+         {9017.0/3168, -355.0/33, 46732.0/5247, 49.0/176, -5103.0/18656},
+         {35.0/384, 0, 500.0/1113, 125.0/192, -2187.0/6784, 11.0/84}},
+        {35.0/384-5179.0/57600, 0, 500.0/1113-7571.0/16695,
+         125.0/192-393.0/640, -2187.0/6784+92097.0/339200,
+         11.0/84-187.0/2100, -1.0/40},
+        5
+    };
+    return tb;
+}
+
+//! Interpolates the input over a step
+/*! The input is quadratic through the samples at the start, the middle
+ * and the end of the step, and theta is the position in the step.
+ */
+template <class T>
+inline T interp_input(const T u[3], double theta)
+{
+    return u[0]*(2*theta-1)*(theta-1) + u[1]*4*theta*(1-theta) +
+           u[2]*theta*(2*theta-1);
+}
+
+//! Computes the derivative k = a*x + b*u of the state
+/*! The structure of the companion form is used if it is indicated.
+ */
+template <class T>
+inline void state_derivative(const matrix<T>& a, const matrix<T>& b,
+                             const matrix<T>& x, T u, matrix<T>& k,
+                             bool companion=false)
+{
+    const size_t n = a.size1();
+    if (companion && n > 0)
+    {
+        T acc = u;
+        for (size_t j=0; j<n; j++) acc += a(n-1,j) * x(j,0);
+        for (size_t i=0; i+1<n; i++) k(i,0) = x(i+1,0);
+        k(n-1,0) = acc;
+        return;
+    }
+    for (size_t i=0; i<n; i++) k(i,0) = b(i,0) * u;
+    ForSyDe::gemv(n, n, T(1), a.data().begin(), n, x.data().begin(), T(1),
+                  k.data().begin());
+}
+
+//! Computes the output y = c*x + d*u of a state-space system
+/*! The products are computed in place on the row-major storage of the
+ * matrices, without the temporaries of the ublas expressions.
+ */
+template <class T>
+inline void state_output(const matrix<T>& c, const matrix<T>& d,
+                         const matrix<T>& x, const matrix<T>& u, matrix<T>& y)
+{
+    ForSyDe::gemv(c.size1(), c.size2(), T(1), c.data().begin(), c.size2(),
+                  x.data().begin(), T(), y.data().begin());
+    ForSyDe::gemv(d.size1(), d.size2(), T(1), d.data().begin(), d.size2(),
+                  u.data().begin(), T(1), y.data().begin());
+}
+
+//! Performs a step of an embedded Runge-Kutta pair
+/*! The stage vectors k are reused and the first one is only computed if
+ * k0_valid is false, otherwise it is the last stage of the previous
+ * accepted step (or the first stage of a rejected attempt). The output
+ * error estimate err is the absolute difference of the outputs of the
+ * two solutions.
+ */
+template <class T, unsigned S>
+inline void erk_step(const rk_tableau<S>& tb,
+                     const matrix<T>& a, const matrix<T>& b,
+                     const matrix<T>& c, const matrix<T>& d,
+                     const T u[3], const matrix<T>& x, T h,
+                     std::array<matrix<T>,7>& k, bool& k0_valid,
+                     matrix<T>& x_, T& y, T& err, bool companion=false)
+{
+    const size_t n = a.size1();
+    if (!k0_valid) state_derivative(a, b, x, u[0], k[0], companion);
+    k0_valid = true;
+    for (unsigned s=1; s<S; s++)
+    {
+        for (size_t i=0; i<n; i++)
+        {
+            T acc = x(i,0);
+            for (unsigned j=0; j<s; j++) acc += h * tb.a[s][j] * k[j](i,0);
+            x_(i,0) = acc;
+        }
+        state_derivative(a, b, x_, interp_input(u, tb.c[s]), k[s], companion);
+    }
+    // the state of the last stage is the solution
+    y = d(0,0) * u[2];
+    err = 0;
+    for (size_t i=0; i<n; i++)
+    {
+        y += c(0,i) * x_(i,0);
+        T e = 0;
+        for (unsigned s=0; s<S; s++) e += tb.e[s] * k[s](i,0);
+        err += c(0,i) * h * e;
+    }
+    err = std::abs(err);
+}
+
+//! Performs a step of an embedded Runge-Kutta pair for a nonlinear system
+/*! The derivative of the state vector is computed by f(t, x, dx). The
+ * stage vectors k are reused as in erk_step, including the first stage
+ * if k0_valid is true. The new state is written to x_ and the returned
+ * error estimate is the largest difference of the two solutions relative
+ * to the magnitude of the state.
+ */
+template <unsigned S, class F>
+inline double erk_step_f(const rk_tableau<S>& tb, F&& f, double t,
+                         const std::vector<double>& x, double h,
+                         std::array<std::vector<double>,7>& k, bool& k0_valid,
+                         std::vector<double>& x_)
+{
+    const size_t n = x.size();
+    for (unsigned s=0; s<S; s++) k[s].resize(n);
+    x_.resize(n);
+    if (!k0_valid) f(t, x, k[0]);
+    k0_valid = true;
+    for (unsigned s=1; s<S; s++)
+    {
+        for (size_t i=0; i<n; i++)
+        {
+            double acc = x[i];
+            for (unsigned j=0; j<s; j++) acc += h * tb.a[s][j] * k[j][i];
+            x_[i] = acc;
+        }
+        f(t + tb.c[s]*h, x_, k[s]);
+    }
+    // the state of the last stage is the solution
+    double err = 0;
+    for (size_t i=0; i<n; i++)
+    {
+        double e = 0;
+        for (unsigned s=0; s<S; s++) e += tb.e[s] * k[s][i];
+        err = std::max(err, std::abs(h * e) / (1 + std::abs(x_[i])));
+    }
+    return err;
+}
+
+//! Factorizes a square matrix in place using Gaussian elimination with partial pivoting
+template <class T>
+inline bool lu_factorize(matrix<T>& w, std::vector<size_t>& piv)
+{
+    const size_t n = w.size1();
+    for (size_t col=0; col<n; col++)
+    {
+        size_t p = col;
+        for (size_t i=col+1; i<n; i++)
+            if (std::abs(w(i,col)) > std::abs(w(p,col))) p = i;
+        if (w(p,col) == 0) return false;
+        piv[col] = p;
+        if (p != col)
+            for (size_t j=0; j<n; j++) std::swap(w(p,j), w(col,j));
+        for (size_t i=col+1; i<n; i++)
+        {
+            w(i,col) /= w(col,col);
+            for (size_t j=col+1; j<n; j++) w(i,j) -= w(i,col) * w(col,j);
+        }
+    }
+    return true;
+}
+
+//! Solves a linear system in place using a matrix factorized by lu_factorize
+template <class T>
+inline void lu_substitute(const matrix<T>& w, const std::vector<size_t>& piv,
+                          matrix<T>& v)
+{
+    const size_t n = w.size1();
+    for (size_t i=0; i<n; i++)
+    {
+        std::swap(v(i,0), v(piv[i],0));
+        for (size_t j=0; j<i; j++) v(i,0) -= w(i,j) * v(j,0);
+    }
+    for (size_t i=n; i-->0;)
+    {
+        for (size_t j=i+1; j<n; j++) v(i,0) -= w(i,j) * v(j,0);
+        v(i,0) /= w(i,i);
+    }
+}
+
+//! Performs a step of the second-order Rosenbrock method ROS2
+/*! The embedded solution is the linearly implicit Euler method. The
+ * matrix w (n*n) and the vectors k1, k2 and xs (n*1) are reused.
+ * It returns false if the iteration matrix is singular.
+ */
+template <class T>
+inline bool ros2_step(const matrix<T>& a, const matrix<T>& b,
+                      const matrix<T>& c, const matrix<T>& d,
+                      const T u[3], const matrix<T>& x, T h,
+                      matrix<T>& w, std::vector<size_t>& piv,
+                      matrix<T>& k1, matrix<T>& k2, matrix<T>& xs,
+                      matrix<T>& x_, T& y, T& err, bool companion=false)
+{
+    const size_t n = a.size1();
+    const T gamma = 1 + 1/std::sqrt(2.0);
+    for (size_t i=0; i<n; i++)
+        for (size_t j=0; j<n; j++)
+            w(i,j) = (i==j ? 1 : 0) - gamma * h * a(i,j);
+    if (!lu_factorize(w, piv)) return false;
+    // the time derivative of the input at the start of the step
+    const T ut = (-3*u[0] + 4*u[1] - u[2]) / h;
+    state_derivative(a, b, x, u[0], k1, companion);
+    for (size_t i=0; i<n; i++) k1(i,0) += gamma * h * b(i,0) * ut;
+    lu_substitute(w, piv, k1);
+    for (size_t i=0; i<n; i++) xs(i,0) = x(i,0) + h * k1(i,0);
+    state_derivative(a, b, xs, u[2], k2, companion);
+    for (size_t i=0; i<n; i++)
+        k2(i,0) -= 2 * k1(i,0) + gamma * h * b(i,0) * ut;
+    lu_substitute(w, piv, k2);
+    y = d(0,0) * u[2];
+    err = 0;
+    for (size_t i=0; i<n; i++)
+    {
+        x_(i,0) = x(i,0) + h * (1.5 * k1(i,0) + 0.5 * k2(i,0));
+        y += c(0,i) * x_(i,0);
+        err += c(0,i) * 0.5 * h * (k1(i,0) + k2(i,0));
+    }
+    err = std::abs(err);
+    return true;
+}
+
 //! Process constructor for implementing a linear filter
 /*! This class is used to build a process which implements a linear filter
  * based on the numerator and denominator constants.
@@ -627,38 +1095,91 @@ public:
             std::vector<T> denominators,     ///< Denominator constants
             sc_time max_step,                ///< Maximum time step
             sc_time min_step=sc_time(0.05,SC_NS),///< Minimum time step
-            T tol_error=1e-5                 ///< Tolerated error
+            T tol_error=1e-5,                ///< Tolerated error
+            ode_solver solver=RK4            ///< The solver
           ) : dde_process(_name), iport1("iport1"), oport1("oport1"),
               numerators(numerators), denominators(denominators),
-              max_step(max_step), min_step(min_step), tol_error(tol_error)
+              max_step(max_step), min_step(min_step), tol_error(tol_error),
+              solver(solver)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << numerators;
-        arg_vec.push_back(std::make_tuple("numerators", ss.str()));
-        ss.str("");
-        ss << denominators;
-        arg_vec.push_back(std::make_tuple("denominators", ss.str()));
-        ss.str("");
-        ss << max_step;
-        arg_vec.push_back(std::make_tuple("max_step", ss.str()));
-        ss.str("");
-        ss << min_step;
-        arg_vec.push_back(std::make_tuple("min_step", ss.str()));
-        ss.str("");
-        ss << tol_error;
-        arg_vec.push_back(std::make_tuple("tol_error", ss.str()));
+        add_arg("numerators", numerators);
+        add_arg("denominators", denominators);
+        add_arg("max_step", max_step);
+        add_arg("min_step", min_step);
+        add_arg("tol_error", tol_error);
+        add_arg("solver", solver);
 #endif
     }
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::filter";}
 
+    //! Checks if the next evaluation cycle reads its inputs without blocking
+    /*! Each cycle reads the two samples of a step.
+     */
+    bool inputs_ready() const {return iport1.num_available() >= 2;}
+
+    //! The statistics of the solver since the start of the simulation
+    const solver_stats& statistics() const {return stats;}
+
+    //! Changes the coefficients of the transfer function
+    /*! It can be called while the simulation is paused, e.g., in a branch
+     * of a parameter sweep. The order of the filter should not change and
+     * its state is kept.
+     */
+    void set_coefficients(const std::vector<T>& nums,  ///< Numerator coefficients
+                          const std::vector<T>& dens   ///< Denominator coefficients
+                         )
+    {
+        auto m = tf2ss_cached(nums, dens);
+        if (model && m->a.size1() != model->a.size1())
+            return SC_REPORT_ERROR(name(), "the order of the filter can not be changed");
+        numerators = nums;
+        denominators = dens;
+        model = m;
+        a = model->a;
+        b = model->b;
+        c = model->c;
+        d = model->d;
+        companion = model->companion;
+        // the saved first stage belongs to the old model
+        k0_valid = false;
+    }
+
+protected:
+    //! The constructor used by the filters defined by a state-space model
+    filter(sc_module_name _name,             ///< process name
+           std::shared_ptr<const ss_model<T>> model, ///< the state-space model
+           sc_time max_step,                 ///< Maximum time step
+           sc_time min_step,                 ///< Minimum time step
+           T tol_error,                      ///< Tolerated error
+           ode_solver solver                 ///< The solver
+          ) : dde_process(_name), iport1("iport1"), oport1("oport1"),
+              max_step(max_step), min_step(min_step), tol_error(tol_error),
+              solver(solver), model(model)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("a", model->a);
+        add_arg("b", model->b);
+        add_arg("c", model->c);
+        add_arg("d", model->d);
+        add_arg("max_step", max_step);
+        add_arg("min_step", min_step);
+        add_arg("tol_error", tol_error);
+        add_arg("solver", solver);
+#endif
+    }
+
 private:
     // Constructor parameters
     std::vector<T> numerators, denominators;
     sc_time max_step, min_step;
     T tol_error;
+    ode_solver solver;
+    //! The state-space model, shared among the identical filters
+    std::shared_ptr<const ss_model<T>> model;
+    bool companion;
 
     // Internal variables
     sc_time step;
@@ -675,6 +1196,13 @@ private:
     MatrixDouble k1,k2,k3,k4;
     // to prevent rounding error
     double roundingFactor;
+    // The stages of the embedded solvers and the matrices of ROS2
+    std::array<MatrixDouble,7> ks;
+    bool k0_valid;
+    MatrixDouble w;
+    std::vector<size_t> piv;
+    // The statistics of the solver
+    solver_stats stats;
 
     // Output event
     ttn_event<T>* out_ev;
@@ -685,13 +1213,13 @@ private:
         out_ev = new ttn_event<T>;
 
         step = max_step;
-        int /*nn = nums.size(),*/ nd = denominators.size();
-        a = MatrixDouble(nd-1,nd-1);
-        b = MatrixDouble(nd-1,1);
-        c = MatrixDouble(1,nd-1);
-        d = MatrixDouble(1,1);
-
-        tf2ss(numerators,denominators,a,b,c,d);
+        stats = solver_stats();
+        if (!model) model = tf2ss_cached(numerators, denominators);
+        a = model->a;
+        b = model->b;
+        c = model->c;
+        d = model->d;
+        companion = model->companion;
 
         // State number
         int numState = a.size1();
@@ -700,12 +1228,20 @@ private:
         x = zero_matrix<T>(numState,1);
         u = MatrixDouble(1,1), u_1 = MatrixDouble(1,1);
         u0 = u1 = MatrixDouble(1,1);
-        y1 = MatrixDouble(1,1);
+        x0 = x1 = x2 = zero_matrix<T>(numState,1);
+        y0 = y1 = y2 = MatrixDouble(1,1);
         k1 = MatrixDouble(numState,1);
         k2 = MatrixDouble(numState,1);
         k3 = MatrixDouble(numState,1);
         k4 = MatrixDouble(numState,1);
+        for (auto& k : ks) k = MatrixDouble(numState,1);
+        k0_valid = false;
+        w = MatrixDouble(numState,numState);
+        piv.resize(numState);
+        roundingFactor = 1.0001;
 
+        // the initial outputs are restored with the signals
+        if (is_restored()) return;
         // initial sampling time tag
         write_multiport(oport2,ttn_event<unsigned int>(0, samplingTimeTag));
         // read initial input
@@ -713,7 +1249,7 @@ private:
         u(0,0) = unsafe_from_abst_ext(get_value(in_ev)); // FIXME: assumes non-null inputs
         t = get_time(in_ev);
         // calculate and write initial output
-        y1 = boost::numeric::ublas::prod(c,x) + boost::numeric::ublas::prod(d,u);
+        state_output(c, d, x, u, y1);
         *out_ev = ttn_event<T>(y1(0,0), t);
         write_multiport(oport1, *out_ev);
         // step signal
@@ -721,7 +1257,6 @@ private:
         write_multiport(oport2, ttn_event<unsigned int>(0, samplingTimeTag+step));
         u_1(0,0) = u(0,0);
         t_1 = t;
-        roundingFactor = 1.0001;
     }
 
     void prep()
@@ -737,21 +1272,29 @@ private:
 
     void exec()
     {
+        if (solver != RK4)
+        {
+            exec_embedded();
+            return;
+        }
         // 1st step error estimation
         h = t - t_1;
-        rkSolver(a, b, c, d, u1, u_1, x, h.to_seconds(), x1, y1);
+        rkSolver(a, b, c, d, u1, u_1, x, in_seconds(h), x1, y1);
 
         // regular RK
         h = t2 - t_1;
-        rkSolver(a, b, c, d, u0, u_1, x, h.to_seconds(), x0, y0);
+        rkSolver(a, b, c, d, u0, u_1, x, in_seconds(h), x0, y0);
 
         // 2nd step error estimation
-        rkSolver(a, b, c, d, u0, u1, x1, (h/2).to_seconds(), x2, y2);
+        rkSolver(a, b, c, d, u0, u1, x1, in_seconds(h/2), x2, y2);
+
+        stats.rhs_evals += 12;
 
         // error estimation
-        double err_est = (double) std::abs(y2(0,0)-y0(0,0))/(h.to_seconds());
+        double err_est = (double) std::abs(y2(0,0)-y0(0,0))/(in_seconds(h));
         if( (err_est < tol_error) || (h<=roundingFactor*min_step)) {
           x = x0;
+          stats.accept(in_seconds(h), in_seconds(max_step));
           samplingTimeTag = t;
           // TODO: move the following line to the prod stage
           write_multiport(oport2, ttn_event<unsigned int>(1, samplingTimeTag)); // commitment
@@ -760,10 +1303,71 @@ private:
           u(0,0) = u0(0,0);
           u_1(0,0) = u(0,0);
           t_1 = t;
-          if(h==min_step)
-            std::cout << "Step accepted due to minimum step size. "
-             << "However, err_tol is not met." << std::endl;
+          if (err_est >= tol_error) report_min_step(stats, name());
         }
+        else
+          stats.rejected++;
+    }
+
+    //! Performs a step of the solvers with embedded error estimates
+    /*! A step from the last committed time to the end of the requested
+     * interval is accepted if the estimated error is tolerated. The next
+     * step size grows or shrinks based on the error, and the samples of
+     * a rejected step are requested again with the smaller step.
+     */
+    void exec_embedded()
+    {
+        h = t2 - t_1;
+        const T hs = in_seconds(h);
+        const T us[3] = {u_1(0,0), u1(0,0), u0(0,0)};
+        T yn, err;
+        unsigned order;
+        // the first stage is reused from the last step
+        const unsigned reused = k0_valid;
+        switch (solver)
+        {
+        case BOGACKI_SHAMPINE:
+            erk_step(bogacki_shampine_tableau(), a, b, c, d, us, x, hs, ks, k0_valid, x0, yn, err, companion);
+            order = bogacki_shampine_tableau().order;
+            stats.rhs_evals += 4 - reused;
+            break;
+        case DORMAND_PRINCE:
+            erk_step(dormand_prince_tableau(), a, b, c, d, us, x, hs, ks, k0_valid, x0, yn, err, companion);
+            order = dormand_prince_tableau().order;
+            stats.rhs_evals += 7 - reused;
+            break;
+        default:
+            if (!ros2_step(a, b, c, d, us, x, hs, w, piv, ks[0], ks[1], x1, x0, yn, err, companion))
+                SC_REPORT_ERROR(name(), "singular iteration matrix in the Rosenbrock solver");
+            order = 2;
+            stats.rhs_evals += 2;
+        }
+
+        const double err_est = (double) err/hs;
+        const bool at_min = h <= roundingFactor*min_step;
+        if (err_est < tol_error || at_min)
+        {
+            x = x0;
+            // the last stage is the first one of the next step (FSAL)
+            if (solver == BOGACKI_SHAMPINE) ks[0].swap(ks[3]);
+            if (solver == DORMAND_PRINCE) ks[0].swap(ks[6]);
+            samplingTimeTag = t2;
+            write_multiport(oport2, ttn_event<unsigned int>(1, samplingTimeTag)); // commitment
+            *out_ev = ttn_event<T>(yn, t2);
+            write_multiport(oport1, *out_ev);
+            u(0,0) = u0(0,0);
+            u_1(0,0) = u(0,0);
+            t_1 = t2;
+            stats.accept(hs, in_seconds(max_step));
+            if (err_est >= tol_error) report_min_step(stats, name());
+        }
+        else
+            stats.rejected++;
+
+        // step size control
+        double fac = err_est > 0 ? 0.9*std::pow(tol_error/err_est, 1.0/order) : 5.0;
+        fac = std::min(5.0, std::max(0.2, fac));
+        step = std::min(max_step, std::max(min_step, h*fac));
     }
 
     void prod()
@@ -775,95 +1379,37 @@ private:
     void clean()
     {
         delete out_ev;
+#ifdef FORSYDE_PROFILE
+        prof.solver = stats;
+#endif
     }
 
-    // To obtain state space matrices from transfer function.
-    // We assume there are non-zero leading coefficients in num and denom.
-    int tf2ss(std::vector<T> & num_, std::vector<T> & den_, MatrixDouble & a,
-          MatrixDouble & b, MatrixDouble & c, MatrixDouble & d)
+    // The system matrices and the stage vectors are passed by reference
+    // and the results are written in place, so no matrices are allocated.
+    void rkSolver(const MatrixDouble& a, const MatrixDouble& b, const MatrixDouble& c,
+                  const MatrixDouble& d, const MatrixDouble& u_k, const MatrixDouble& u_k_1,
+                  const MatrixDouble& x, T h, MatrixDouble &x_, MatrixDouble &y)
     {
-        std::vector<T> num, den;
-        // sizes checking
-        int nn = num_.size(), nd = den_.size();
-        if(nn >= nd)
-        {
-            std::cerr << "ERROR: " << "degree(num) = " << nn
-            << " >= degree(denom) = " << nd << std::endl;
-            abort();
-        }
-        T dCoef1 = den_.at(0);
-        if(nd==1)
-        {
-            //~ a = NULL, b = NULL, c = NULL;
-            d = MatrixDouble(1,1);
-            d(0,0) = num_.at(0)/dCoef1;
-        }
-        else
-        {
-            if ((nd - nn) > 0)
-            {
-                // Pad num so that degree(num) == degree(denom)
-                for(int i=0; i<nd; i++)
-                {
-                    if(i<(nd-nn))
-                        num.push_back(0.0);
-                    else
-                        num.push_back(num_.at(i-nd+nn));
-                }
-            }
-
-            // Normalizing w.r.t the leading coefficient of denominator
-            for(unsigned int i=0; i<num.size(); i++)
-                num.at(i) /= dCoef1;
-            for(unsigned int i=0; i<den_.size(); i++)
-                den_.at(i) /= dCoef1;
-            for(unsigned int i=0; i<(den_.size()-1); i++)
-                den.push_back(den_.at(i+1));
-
-            // Form A (nd-1)*(nd-1)
-            a = zero_matrix<T> (a.size1(), a.size2());
-            if(nd > 2)
-            {
-                // The eyes (up-right corner) are set to '1'
-                for(int i=0; i<(nd-2); i++)
-                    for(int j=0; j<(nd-1); j++)
-                        if((j-i)==1) a(i,j) = 1.0;
-                // The lower row(s)
-                for(int j=0; j<(nd-1); j++)
-                    a(nd-2,j) = 0-den.at(nd-2-j);
-            }
-            else
-                a(0,0) = 0-den.at(0);
-            //
-            // Form B (nd-1)*1
-            b = zero_matrix<T> (b.size1(), b.size2());
-            b(nd-2,0) = 1.0;
-            //
-            // Form C 1*(nd-1)
-            for(int j=0; j< nd-1; j++)
-                c(0,nd-2-j) = num.at(j+1) - num.at(0)*den.at(j);
-            //
-            // Form D 1*1
-            d(0,0) = num.at(0);
-        }
-
-        return 0;
+        rk4_step(a, b, c, d, u_k(0,0), u_k_1(0,0), x, h, k1, k2, k3, k4, x_, y(0,0), companion);
     }
 
-    void rkSolver(MatrixDouble a, MatrixDouble b, MatrixDouble c,
-                  MatrixDouble d, MatrixDouble u_k, MatrixDouble u_k_1,
-                  MatrixDouble x, T h, MatrixDouble &x_, MatrixDouble &y)
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
     {
-        // Some helper matrices used in RK solver
-        MatrixDouble k1,k2,k3,k4;
-        k1 = boost::numeric::ublas::prod(a,x) + boost::numeric::ublas::prod(b,u_k_1);
-        k2 = boost::numeric::ublas::prod(a,(x+k1*(h/2.0))) + boost::numeric::ublas::prod(b,(u_k_1 + u_k)) * 0.5;
-        k3 = boost::numeric::ublas::prod(a,(x+k2*(h/2.0))) + boost::numeric::ublas::prod(b,(u_k_1 + u_k)) * 0.5;
-        k4 = boost::numeric::ublas::prod(a,(x+k3*h)) + boost::numeric::ublas::prod(b,u_k);
-        x_ = x + (k1 + 2.0*k2 + 2.0*k3 + k4) * (h/6.0);
-        y = boost::numeric::ublas::prod(c,x_) + boost::numeric::ublas::prod(d,u_k);
+        save_values(buf, step, samplingTimeTag, u(0,0), u_1(0,0), t_1, k0_valid);
+        for (size_t i=0; i<x.size1(); i++) save_values(buf, x(i,0));
+        for (auto& k : ks)
+            for (size_t i=0; i<k.size1(); i++) save_values(buf, k(i,0));
     }
-
+    
+    void restore_state(const char*& pos)
+    {
+        restore_values(pos, step, samplingTimeTag, u(0,0), u_1(0,0), t_1, k0_valid);
+        for (size_t i=0; i<x.size1(); i++) restore_values(pos, x(i,0));
+        for (auto& k : ks)
+            for (size_t i=0; i<k.size1(); i++) restore_values(pos, k(i,0));
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -876,6 +1422,55 @@ private:
 #endif
 };
 
+//! Process constructor for implementing a linear filter given its state-space model
+/*! This class is used to build a process similar to filter, where the
+ * single-input single-output system is given by the matrices a (n*n),
+ * b (n*1), c (1*n) and d (1*1) instead of a transfer function.
+ */
+template <class T>
+class ss_filter : public filter<T>
+{
+public:
+    typedef matrix<T> MatrixDouble;
+
+    //! The constructor requires the module name and the model
+    /*! It creates an SC_THREAD which inserts the initial element, reads
+     * data from its input port, and writes the results using the output
+     * port.
+     */
+    ss_filter(sc_module_name _name,          ///< process name
+              const MatrixDouble& a,         ///< The state matrix
+              const MatrixDouble& b,         ///< The input matrix
+              const MatrixDouble& c,         ///< The output matrix
+              const MatrixDouble& d,         ///< The feedthrough matrix
+              sc_time max_step,              ///< Maximum time step
+              sc_time min_step=sc_time(0.05,SC_NS),///< Minimum time step
+              T tol_error=1e-5,              ///< Tolerated error
+              ode_solver solver=RK4          ///< The solver
+             ) : filter<T>(_name, make_model(a, b, c, d), max_step, min_step,
+                           tol_error, solver) {}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::ss_filter";}
+
+private:
+    static std::shared_ptr<const ss_model<T>> make_model(const MatrixDouble& a,
+        const MatrixDouble& b, const MatrixDouble& c, const MatrixDouble& d)
+    {
+        const size_t n = a.size1();
+        if (a.size2() != n || b.size1() != n || b.size2() != 1 ||
+            c.size1() != 1 || c.size2() != n || d.size1() != 1 || d.size2() != 1)
+            SC_REPORT_ERROR("DDE::ss_filter", "the matrices of the state-space model should be n*n, n*1, 1*n and 1*1");
+        auto res = std::make_shared<ss_model<T>>();
+        res->a = a;
+        res->b = b;
+        res->c = c;
+        res->d = d;
+        res->companion = is_companion(a, b);
+        return res;
+    }
+};
+
 //! Process constructor for implementing a linear filter with fixed step size
 /*! This class is used to build a process which implements a linear filter
  * with fixed step size based on the numerator and denominator constants.
@@ -901,24 +1496,24 @@ public:
               numerators(numerators), denominators(denominators)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << numerators;
-        arg_vec.push_back(std::make_tuple("numerators", ss.str()));
-        ss.str("");
-        ss << denominators;
-        arg_vec.push_back(std::make_tuple("denominators", ss.str()));
+        add_arg("numerators", numerators);
+        add_arg("denominators", denominators);
 #endif
     }
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::filterf";}
 
+    //! The statistics of the solver since the start of the simulation
+    const solver_stats& statistics() const {return stats;}
+
 private:
     // Constructor parameters
     std::vector<T> numerators, denominators;
 
     // Internal variables
     MatrixDouble a, b, c, d;
+    bool companion;
     // states
     MatrixDouble x, x_1;
     // current and previous input/time.
@@ -928,6 +1523,8 @@ private:
     MatrixDouble y;
     // Some helper matrices used in RK solver
     MatrixDouble k1,k2,k3,k4;
+    // The statistics of the solver
+    solver_stats stats;
 
     // Output event
     ttn_event<T>* out_ev;
@@ -936,14 +1533,14 @@ private:
     void init()
     {
         out_ev = new ttn_event<T>;
+        stats = solver_stats();
 
-        int /*nn = nums.size(),*/ nd = denominators.size();
-        a = MatrixDouble(nd-1,nd-1);
-        b = MatrixDouble(nd-1,1);
-        c = MatrixDouble(1,nd-1);
-        d = MatrixDouble(1,1);
-
-        tf2ss(numerators,denominators,a,b,c,d);
+        auto model = tf2ss_cached(numerators, denominators);
+        a = model->a;
+        b = model->b;
+        c = model->c;
+        d = model->d;
+        companion = model->companion;
 
         // State number
         int numState = a.size1();
@@ -956,15 +1553,17 @@ private:
         k3 = MatrixDouble(numState,1);
         k4 = MatrixDouble(numState,1);
 
+        // the initial output is restored with the signal
+        if (is_restored()) return;
         // read initial input
         auto in_ev = iport1.read();
         u(0,0) = unsafe_from_abst_ext(get_value(in_ev)); // FIXME: assumes non-absent inputs
         t = get_time(in_ev);
         // calculate and write initial output
-        y = boost::numeric::ublas::prod(c,x) + boost::numeric::ublas::prod(d,u);
+        state_output(c, d, x, u, y);
         *out_ev = ttn_event<T>(y(0,0), t);
         write_multiport(oport1, *out_ev);
-        wait(t - sc_time_stamp());
+        sync(t);
         u_1(0,0) = u(0,0);
         t_1 = t;
     }
@@ -980,111 +1579,54 @@ private:
     {
         // 1st step error estimation
         h = t - t_1;
-        rkSolver(a, b, c, d, u, u_1, x_1, h.to_seconds(), x, y);
+        rkSolver(a, b, c, d, u, u_1, x_1, in_seconds(h), x, y);
         *out_ev = ttn_event<T>(y(0,0), t);
+        // the steps have the fixed size
+        stats.accept(in_seconds(h), in_seconds(h));
+        stats.rhs_evals += 4;
     }
 
     void prod()
     {
-        write_multiport(oport1, *out_ev);
-        wait(t - sc_time_stamp());
+        // the state is updated before writing, since the event of a
+        // blocked write is kept by the signal
         x_1 = x;
         u_1(0,0) = u(0,0);
         t_1 = t;
+        write_multiport(oport1, *out_ev);
+        sync(t);
     }
 
     void clean()
     {
         delete out_ev;
+#ifdef FORSYDE_PROFILE
+        prof.solver = stats;
+#endif
     }
 
-    // To obtain state space matrices from transfer function.
-    // We assume there are non-zero leading coefficients in num and denom.
-    int tf2ss(std::vector<T> & num_, std::vector<T> & den_, MatrixDouble & a,
-          MatrixDouble & b, MatrixDouble & c, MatrixDouble & d)
+    // The system matrices and the stage vectors are passed by reference
+    // and the results are written in place, so no matrices are allocated.
+    void rkSolver(const MatrixDouble& a, const MatrixDouble& b, const MatrixDouble& c,
+                  const MatrixDouble& d, const MatrixDouble& u_k, const MatrixDouble& u_k_1,
+                  const MatrixDouble& x, T h, MatrixDouble &x_, MatrixDouble &y)
     {
-        std::vector<T> num, den;
-        // sizes checking
-        int nn = num_.size(), nd = den_.size();
-        if(nn >= nd)
-        {
-            std::cerr << "ERROR: " << "degree(num) = " << nn
-            << " >= degree(denom) = " << nd << std::endl;
-            abort();
-        }
-        T dCoef1 = den_.at(0);
-        if(nd==1)
-        {
-            //~ a = NULL, b = NULL, c = NULL;
-            d = MatrixDouble(1,1);
-            d(0,0) = num_.at(0)/dCoef1;
-        }
-        else
-        {
-            if ((nd - nn) > 0)
-            {
-                // Pad num so that degree(num) == degree(denom)
-                for(int i=0; i<nd; i++)
-                {
-                    if(i<(nd-nn))
-                        num.push_back(0.0);
-                    else
-                        num.push_back(num_.at(i-nd+nn));
-                }
-            }
-
-            // Normalizing w.r.t the leading coefficient of denominator
-            for(unsigned int i=0; i<num.size(); i++)
-                num.at(i) /= dCoef1;
-            for(unsigned int i=0; i<den_.size(); i++)
-                den_.at(i) /= dCoef1;
-            for(unsigned int i=0; i<(den_.size()-1); i++)
-                den.push_back(den_.at(i+1));
-
-            // Form A (nd-1)*(nd-1)
-            a = zero_matrix<T> (a.size1(), a.size2());
-            if(nd > 2)
-            {
-                // The eyes (up-right corner) are set to '1'
-                for(int i=0; i<(nd-2); i++)
-                    for(int j=0; j<(nd-1); j++)
-                        if((j-i)==1) a(i,j) = 1.0;
-                // The lower row(s)
-                for(int j=0; j<(nd-1); j++)
-                    a(nd-2,j) = 0-den.at(nd-2-j);
-            }
-            else
-                a(0,0) = 0-den.at(0);
-            //
-            // Form B (nd-1)*1
-            b = zero_matrix<T> (b.size1(), b.size2());
-            b(nd-2,0) = 1.0;
-            //
-            // Form C 1*(nd-1)
-            for(int j=0; j< nd-1; j++)
-                c(0,nd-2-j) = num.at(j+1) - num.at(0)*den.at(j);
-            //
-            // Form D 1*1
-            d(0,0) = num.at(0);
-        }
-
-        return 0;
+        rk4_step(a, b, c, d, u_k(0,0), u_k_1(0,0), x, h, k1, k2, k3, k4, x_, y(0,0), companion);
     }
 
-    void rkSolver(MatrixDouble a, MatrixDouble b, MatrixDouble c,
-                  MatrixDouble d, MatrixDouble u_k, MatrixDouble u_k_1,
-                  MatrixDouble x, T h, MatrixDouble &x_, MatrixDouble &y)
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
     {
-        // Some helper matrices used in RK solver
-        MatrixDouble k1,k2,k3,k4;
-        k1 = boost::numeric::ublas::prod(a,x) + boost::numeric::ublas::prod(b,u_k_1);
-        k2 = boost::numeric::ublas::prod(a,(x+k1*(h/2.0))) + boost::numeric::ublas::prod(b,(u_k_1 + u_k)) * 0.5;
-        k3 = boost::numeric::ublas::prod(a,(x+k2*(h/2.0))) + boost::numeric::ublas::prod(b,(u_k_1 + u_k)) * 0.5;
-        k4 = boost::numeric::ublas::prod(a,(x+k3*h)) + boost::numeric::ublas::prod(b,u_k);
-        x_ = x + (k1 + 2.0*k2 + 2.0*k3 + k4) * (h/6.0);
-        y = boost::numeric::ublas::prod(c,x_) + boost::numeric::ublas::prod(d,u_k);
+        save_values(buf, u_1(0,0), t_1);
+        for (size_t i=0; i<x_1.size1(); i++) save_values(buf, x_1(i,0));
     }
-
+    
+    void restore_state(const char*& pos)
+    {
+        restore_values(pos, u_1(0,0), t_1);
+        for (size_t i=0; i<x_1.size1(); i++) restore_values(pos, x_1(i,0));
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1123,18 +1665,18 @@ public:
               init_st(init_st), take(take), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("init_st", init_st);
+        add_arg("take", take);
 #endif
     }
 
+    //! Computes the next states in blocks in a background thread
+    /*! The function should only depend on the state (see
+     * state_prefetcher). It should be called before the simulation starts.
+     */
+    void set_prefetch(size_t block=256) {pf_block = block;}
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::source";}
 
@@ -1149,13 +1691,20 @@ private:
     //! The function passed to the process constructor
     functype _func;
 
+    // the block size and the generator of the prefetched states, if any
+    size_t pf_block = 0;
+    std::unique_ptr<state_prefetcher<ttn_event<T>>> pf;
+
     //Implementing the abstract semantics
     void init()
     {
         cur_st = new ttn_event<T>;
         *cur_st = init_st;
-        write_multiport(oport1, *cur_st);
-        wait(get_time(*cur_st) - sc_time_stamp());
+        if (!is_restored())
+        {
+            write_multiport(oport1, *cur_st);
+            sync(get_time(*cur_st));
+        }
         if (take==0) infinite = true;
         tok_cnt = 1;
     }
@@ -1164,7 +1713,15 @@ private:
 
     void exec()
     {
-        _func(*cur_st, *cur_st);
+        if (pf_block == 0)
+        {
+            _func(*cur_st, *cur_st);
+            return;
+        }
+        if (!pf)
+            pf.reset(new state_prefetcher<ttn_event<T>>(_func, *cur_st, pf_block,
+                                                        take == 0 ? 0 : take - tok_cnt + 1));
+        pf->next(*cur_st);
     }
 
     void prod()
@@ -1172,16 +1729,22 @@ private:
         if (tok_cnt++ < take || infinite)
         {
             write_multiport(oport1, *cur_st);
-            wait(get_time(*cur_st) - sc_time_stamp());
+            sync(get_time(*cur_st));
         }
-        else wait();
+        else halt();
     }
 
     void clean()
     {
+        pf.reset();
         delete cur_st;
     }
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *cur_st, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *cur_st, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1216,12 +1779,8 @@ public:
         if (values.size()<offsets.size())
             SC_REPORT_ERROR(name(),"Error matching values and offsets vectors!");
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << values;
-        arg_vec.push_back(std::make_tuple("values", ss.str()));
-        ss.str("");
-        ss << offsets;
-        arg_vec.push_back(std::make_tuple("offsets", ss.str()));
+        add_arg("values", values);
+        add_arg("offsets", offsets);
 #endif
     }
 
@@ -1244,19 +1803,124 @@ private:
 
     void prod()
     {
-        write_multiport(oport1, ttn_event<T>(abst_ext<T>(values[iter]), offsets[iter]));
-        wait(offsets[iter] - sc_time_stamp());
-        iter++;
-        if (iter == values.size())
+        // the state is updated before writing, since the event of a
+        // blocked write is kept by the signal
+        if (iter < values.size())
+        {
+            const size_t i = iter++;
+            write_multiport(oport1, ttn_event<T>(abst_ext<T>(values[i]), offsets[i]));
+            sync(offsets[i]);
+        }
+        else
         {
             // Promise no more values
-            write_multiport(oport1, ttn_event<T>(abst_ext<T>(), sc_max_time()));
-            wait();
+            if (iter++ == values.size())
+                write_multiport(oport1, ttn_event<T>(abst_ext<T>(), sc_max_time()));
+            halt();
         }
     }
 
     void clean() {}
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, iter);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, iter);}
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+        boundOutChans[0].portType = typeid(T).name();
+    }
+#endif
+};
+
+//! Process constructor for a source process with streamed input
+/*! This class is used to build a souce process which only has an output.
+ * It outputs the events of a token_stream of (offset, value) pairs, like
+ * vsource does for the values and the offsets of two vectors. The events
+ * are pulled from the stream in chunks, hence the stimulus is never kept
+ * in the memory as a whole.
+ */
+template <class T>
+class stream_source : public dde_process
+{
+public:
+    DDE_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the result using the output
+     * port.
+     */
+    stream_source(sc_module_name _name,                                     ///< the module name
+                  std::shared_ptr<token_stream<std::tuple<sc_time,T>>> stream  ///< the (offset, value) stream
+                  ) : dde_process(_name), oport1("oport1"), reader(stream)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("stream", reader.describe()));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::stream_source";}
+private:
+    stream_reader<std::tuple<sc_time,T>> reader;
+    bool promised;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!reader.good())
+            SC_REPORT_ERROR(name(),"cannot read the stream.");
+        if (!reader.seek(0))
+            SC_REPORT_ERROR(name(),"the stream can not be rewound.");
+        promised = false;
+    }
+    
+    void prep() {}
+    
+    void exec() {}
+    
+    void prod()
+    {
+        // the state is updated before writing, since the event of a
+        // blocked write is kept by the signal
+        if (auto ev = reader.next())
+        {
+            const sc_time offset = std::get<0>(*ev);
+            write_multiport(oport1, ttn_event<T>(abst_ext<T>(std::get<1>(*ev)), offset));
+            sync(offset);
+        }
+        else
+        {
+            // Promise no more values
+            if (!promised)
+            {
+                promised = true;
+                write_multiport(oport1, ttn_event<T>(abst_ext<T>(), sc_max_time()));
+            }
+            halt();
+        }
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, std::uint64_t(reader.position()), promised);
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t i;
+        restore_values(pos, i, promised);
+        if (!reader.seek(i))
+            SC_REPORT_ERROR(name(),"the stream can not be moved to the checkpoint.");
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1273,7 +1937,7 @@ private:
  * applies a given function to the current input.
  */
 template <class T>
-class sink : public dde_process
+class sink : public dde_process, public deferred_effects
 {
 public:
     DDE_in<T> iport1;         ///< port for the input channel
@@ -1291,25 +1955,65 @@ public:
 
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
+    //! Runs the function in a background thread instead of the simulation thread
+    /*! The tokens are passed to the thread through a bounded queue with
+     * the given capacity and policy (see async_consumer). It should be
+     * called before the simulation starts.
+     */
+    void set_async(size_t capacity=1024, async_backpressure policy=ASYNC_BLOCK)
+    {
+        async.reset(new async_consumer<ttn_event<T>>(this->name(), _func, capacity, policy));
+    }
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::sink";}
 
+    void defer_effects() {deferred = true;}
+
+    void commit_effects(const sc_time& t)
+    {
+        while (!held.empty() && get_time(held.front()) < t)
+        {
+            consume(held.front());
+            held.pop_front();
+        }
+    }
+
+    void discard_effects(const sc_time& t)
+    {
+        while (!held.empty() && get_time(held.back()) >= t) held.pop_back();
+    }
+
 private:
     ttn_event<T>* val;         // The current state of the process
 
     //! The function passed to the process constructor
     functype _func;
 
+    // the background consumer of the tokens, if any
+    std::unique_ptr<async_consumer<ttn_event<T>>> async;
+
+    // the events whose function calls are held back by the executor
+    bool deferred = false;
+    std::deque<ttn_event<T>> held;
+
+    void consume(const ttn_event<T>& ev)
+    {
+        if (async)
+            async->push(ev);
+        else
+            _func(ev);
+    }
+
     //Implementing the abstract semantics
     void init()
     {
         val = new ttn_event<T>;
+        held.clear();
     }
 
     void prep()
@@ -1319,13 +2023,17 @@ private:
 
     void exec()
     {
-        _func(*val);
+        if (deferred)
+            held.push_back(*val);
+        else
+            consume(*val);
     }
 
     void prod() {}
 
     void clean()
     {
+        if (async) async->flush();
         delete val;
     }
 
@@ -1360,6 +2068,13 @@ public:
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::zip";}
 
+    //! Only the inputs whose clocks are equal to the local time are read
+    bool inputs_ready() const
+    {
+        return (in1T != tl || iport1.num_available() > 0) &&
+               (in2T != tl || iport2.num_available() > 0);
+    }
+
 private:
     // inputs and output variables
     ttn_event<T1> *next_iev1;
@@ -1425,7 +2140,7 @@ private:
     {
         auto temp_event = ttn_event<std::tuple<abst_ext<T1>,abst_ext<T2>>>(*oval,tl);
         write_multiport(oport1,temp_event);
-        wait(tl - sc_time_stamp());
+        sync(tl);
     }
 
     void clean()
@@ -1436,6 +2151,11 @@ private:
         delete cur_ival2;
         delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *next_iev1, *next_iev2, tl, in1T, in2T);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *next_iev1, *next_iev2, tl, in1T, in2T);}
+#endif
 
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -1452,9 +2172,63 @@ private:
 #endif
 };
 
+//! The clocks of the input ports of the merging processes
+/*! A min-heap of the times of the next events of the ports which are
+ * not consumed in the current cycle. The ports with the earliest time
+ * are taken out of the heap and pushed back once they are re-read, so
+ * merging N inputs costs O(log N) per event instead of a scan of the N
+ * ports.
+ */
+class port_clocks
+{
+public:
+    //! Empties the heap and reserves it for a number of ports
+    void reset(size_t n)
+    {
+        heap.clear();
+        heap.reserve(n);
+    }
+    
+    //! Adds the clock of a port
+    void push(const sc_time& t, size_t port)
+    {
+        heap.emplace_back(t, port);
+        std::push_heap(heap.begin(), heap.end(), later);
+    }
+    
+    //! Checks if all the ports are taken out
+    bool empty() const {return heap.empty();}
+    
+    //! The earliest clock
+    const sc_time& earliest() const {return heap.front().first;}
+    
+    //! Takes out the ports with the earliest clock and appends them to a list
+    void pop_earliest(std::vector<size_t>& ports)
+    {
+        const sc_time t = earliest();
+        while (!heap.empty() && heap.front().first == t)
+        {
+            std::pop_heap(heap.begin(), heap.end(), later);
+            ports.push_back(heap.back().second);
+            heap.pop_back();
+        }
+    }
+    
+private:
+    typedef std::pair<sc_time,size_t> entry;
+    
+    static bool later(const entry& a, const entry& b) {return a.first > b.first;}
+    
+    std::vector<entry> heap;
+};
+
 //! The zipX process with a vector of inputs and one output
 /*! This process "zips" a vector of incoming signals into one signal of
  * vector type.
+ *
+ * The clocks of the inputs are kept in a heap. When a single port has
+ * consecutive earliest events, they are merged without touching the
+ * heap.
  */
 template <class T1, std::size_t N>
 class zipX : public dde_process
@@ -1474,6 +2248,14 @@ public:
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::zipX";}
 
+    //! Only the inputs whose clocks are equal to the local time are read
+    bool inputs_ready() const
+    {
+        for (auto i : fired)
+            if (iport[i].num_available() == 0) return false;
+        return true;
+    }
+
 private:
     // inputs and output variables
     std::array<ttn_event<T1>,N> next_ievs;
@@ -1483,40 +2265,57 @@ private:
     // the current time (local time)
     sc_time tl;
 
-    // clocks of the input ports (channel times)
-    std::array<sc_time,N> insT;
+    // clocks of the input ports (channel times) which are ahead of tl
+    port_clocks clocks;
+    
+    // the ports whose events are at tl
+    std::vector<size_t> fired;
 
     void init()
     {
-        insT.fill(SC_ZERO_TIME);
         tl = SC_ZERO_TIME;
+        clocks.reset(N);
+        fired.clear();
+        for (size_t i=0;i<N;i++) fired.push_back(i);
         oval = new abst_ext< std::array<abst_ext<T1>,N> >();
     }
 
     void prep()
     {
-        for (size_t i=0;i<N;i++)
-            if (insT[i] == tl)
+        for (auto i : fired) cur_ivals[i] = abst_ext<T1>();
+        // a single port which stays ahead of the others bypasses the heap
+        if (fired.size() == 1)
+        {
+            const size_t i = fired[0];
+            next_ievs[i] = iport[i].read();
+            const sc_time& t = get_time(next_ievs[i]);
+            if (clocks.empty() || t < clocks.earliest())
+            {
+                tl = t;
+                cur_ivals[i] = get_value(next_ievs[i]);
+                return;
+            }
+            clocks.push(t, i);
+        }
+        else
+            for (auto i : fired)
             {
                 next_ievs[i] = iport[i].read();
-                insT[i] = get_time(next_ievs[i]);
+                clocks.push(get_time(next_ievs[i]), i);
             }
 
-        // update channel clocks and the local clock
-        tl = *std::min_element(insT.begin(), insT.end());
-
-        // update current values
-        for (size_t i=0;i<N;i++)
-            if (get_time(next_ievs[i]) == tl)
-                cur_ivals[i] = get_value(next_ievs[i]);
-            else
-                cur_ivals[i] = abst_ext<T1>();
+        // update the local clock and the current values
+        tl = clocks.earliest();
+        fired.clear();
+        clocks.pop_earliest(fired);
+        for (auto i : fired) cur_ivals[i] = get_value(next_ievs[i]);
     }
 
     void exec()
     {
-        if (std::all_of(cur_ivals.begin(), cur_ivals.end(), [](abst_ext<T1> el){
-            return is_absent(el);
+        // the lanes which are not fired are absent
+        if (std::all_of(fired.begin(), fired.end(), [&](size_t i){
+            return is_absent(cur_ivals[i]);
         }))
             oval->set_abst();
         else
@@ -1527,7 +2326,7 @@ private:
     {
         auto temp_event = ttn_event<std::array<abst_ext<T1>,N>>(*oval,tl);
         write_multiport(oport1,temp_event);
-        wait(tl - sc_time_stamp());
+        sync(tl);
     }
 
     void clean()
@@ -1547,6 +2346,159 @@ private:
 #endif
 };
 
+//! The zip process with variable number of inputs and one output
+/*! This process "zips" the incoming signals into one signal of tuples.
+ * Similar to zipX, the clocks of the inputs are kept in a heap.
+ */
+template <class... Ts>
+class zipN : public dde_process
+{
+public:
+    std::tuple<DDE_in<Ts>...> iport;///< tuple of ports for the input channels
+    DDE_out<std::tuple<abst_ext<Ts>...>> oport1;///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * zips them together and writes the results using the output port
+     */
+    zipN(sc_module_name _name)
+         :dde_process(_name), oport1("oport1")
+    { }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::zipN";}
+
+    //! Only the inputs whose clocks are equal to the local time are read
+    bool inputs_ready() const
+    {
+        for (auto i : fired)
+            if (!(this->*lanes()[i].ready)()) return false;
+        return true;
+    }
+
+private:
+    // inputs and output variables
+    std::tuple<ttn_event<Ts>...> next_ievs;
+    std::tuple<abst_ext<Ts>...> cur_ivals;
+
+    // the current time (local time)
+    sc_time tl;
+
+    // clocks of the input ports (channel times) which are ahead of tl
+    port_clocks clocks;
+    
+    // the ports whose events are at tl
+    std::vector<size_t> fired;
+
+    // the operations on the port and the values of an input
+    template <size_t I>
+    sc_time read_lane()
+    {
+        std::get<I>(next_ievs) = std::get<I>(iport).read();
+        return get_time(std::get<I>(next_ievs));
+    }
+    
+    template <size_t I>
+    void take_lane() {std::get<I>(cur_ivals) = get_value(std::get<I>(next_ievs));}
+    
+    template <size_t I>
+    void clear_lane() {std::get<I>(cur_ivals).set_abst();}
+    
+    template <size_t I>
+    bool lane_ready() const {return std::get<I>(iport).num_available() > 0;}
+
+    //! The operations of an input, looked up by its index
+    struct lane_ops
+    {
+        sc_time (zipN::*read)();
+        void (zipN::*take)();
+        void (zipN::*clear)();
+        bool (zipN::*ready)() const;
+    };
+    
+    template <size_t... Is>
+    static std::array<lane_ops,sizeof...(Ts)> make_lanes(std::index_sequence<Is...>)
+    {
+        return {{ {&zipN::read_lane<Is>, &zipN::take_lane<Is>,
+                   &zipN::clear_lane<Is>, &zipN::lane_ready<Is>}... }};
+    }
+    
+    static const std::array<lane_ops,sizeof...(Ts)>& lanes()
+    {
+        static const auto ops = make_lanes(std::index_sequence_for<Ts...>());
+        return ops;
+    }
+
+    void init()
+    {
+        tl = SC_ZERO_TIME;
+        clocks.reset(sizeof...(Ts));
+        fired.clear();
+        for (size_t i=0;i<sizeof...(Ts);i++) fired.push_back(i);
+    }
+
+    void prep()
+    {
+        auto& ops = lanes();
+        for (auto i : fired) (this->*ops[i].clear)();
+        // a single port which stays ahead of the others bypasses the heap
+        if (fired.size() == 1)
+        {
+            const size_t i = fired[0];
+            const sc_time t = (this->*ops[i].read)();
+            if (clocks.empty() || t < clocks.earliest())
+            {
+                tl = t;
+                (this->*ops[i].take)();
+                return;
+            }
+            clocks.push(t, i);
+        }
+        else
+            for (auto i : fired)
+                clocks.push((this->*ops[i].read)(), i);
+
+        // update the local clock and the current values
+        tl = clocks.earliest();
+        fired.clear();
+        clocks.pop_earliest(fired);
+        for (auto i : fired) (this->*ops[i].take)();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        bool all_absent = true;
+        std::apply([&](const auto&... val) {
+            ((all_absent = all_absent && is_absent(val)), ...);
+        }, cur_ivals);
+        typedef abst_ext<std::tuple<abst_ext<Ts>...>> out_type;
+        write_multiport(oport1, ttn_event<std::tuple<abst_ext<Ts>...>>(
+            all_absent ? out_type() : out_type(cur_ivals), tl));
+        sync(tl);
+    }
+
+    void clean() {}
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(sizeof...(Ts));     // input ports
+        std::apply
+        (
+            [&](auto&... ports)
+            {
+                std::size_t n{0};
+                ((boundInChans[n++].port = &ports),...);
+            }, iport
+        );
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
 //! The unzip process with one input and two outputs
 /*! This process "unzips" a signal of tuples into two separate signals
  */
@@ -1690,7 +2642,7 @@ private:
     {
         for (size_t i=0; i<N; i++)
             write_multiport(oport[i],oevs[i]);  // write to the output i
-        wait(tl - sc_time_stamp());
+        sync(tl);
     }
 
     void clean()
@@ -1711,6 +2663,78 @@ private:
 };
 
 
+//! The unzip process with one input and variable number of outputs
+/*! This process "unzips" a signal of tuples into a tuple of signals.
+ */
+template <class... Ts>
+class unzipN : public dde_process
+{
+public:
+    DDE_in<std::tuple<abst_ext<Ts>...>> iport1;///< port for the input channel
+    std::tuple<DDE_out<Ts>...> oport;///< tuple of ports for the output channels
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * unzips it and writes the results using the output ports
+     */
+    unzipN(sc_module_name _name)
+         :dde_process(_name), iport1("iport1")
+    { }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::unzipN";}
+
+private:
+    // intermediate values
+    ttn_event<std::tuple<abst_ext<Ts>...>> in_ev;
+
+    void init() {}
+
+    void prep()
+    {
+        in_ev = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_lanes(std::index_sequence_for<Ts...>());
+        sync(get_time(in_ev));
+    }
+
+    template <size_t... Is>
+    void write_lanes(std::index_sequence<Is...>)
+    {
+        const sc_time& te = get_time(in_ev);
+        const auto& val = get_value(in_ev);
+        if (is_absent(val))
+            (write_multiport(std::get<Is>(oport), ttn_event<Ts>(abst_ext<Ts>(), te)), ...);
+        else
+            (write_multiport(std::get<Is>(oport),
+                ttn_event<Ts>(std::get<Is>(unsafe_from_abst_ext(val)), te)), ...);
+    }
+
+    void clean() {}
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(sizeof...(Ts));    // output ports
+        std::apply
+        (
+            [&](auto&... ports)
+            {
+                std::size_t n{0};
+                ((boundOutChans[n++].port = &ports),...);
+            }, oport
+        );
+    }
+#endif
+};
+
 //! Process constructor for a fan-out process with one input and one output
 /*! This class is used to build a fanout processes with one input
  * and one output. The class is parameterized for input and output
@@ -1737,6 +2761,11 @@ public:
 
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DDE::fanout";}
+    
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Passes the input tokens on to the outputs without running the process
+    void start_of_simulation() {bypass_fanout(iport1, oport1);}
+#endif
 
 private:
     // Inputs and output variables
@@ -0,0 +1,519 @@
+/**********************************************************************
+    * dde_scheduler.hpp -- Event scheduling of DDE process networks   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a single-threaded executor which fires the   *
+    *          processes of a DDE process network in time-tag order   *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef DDE_SCHEDULER_HPP
+#define DDE_SCHEDULER_HPP
+
+/*! \file dde_scheduler.hpp
+ * \brief Implements an event scheduler for DDE process networks
+ *
+ *  This file includes an opt-in executor which keeps the pending
+ * firings of a DDE process network in a calendar queue keyed by the
+ * time tags of the events and runs them in a single thread, instead of
+ * one thread per process which waits for the kernel after every event.
+ */
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <algorithm>
+
+#include "dde_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace DDE
+{
+
+using namespace sc_core;
+
+//! A calendar queue of items keyed by time
+/*! The queue is an array of buckets (days), each holding the items of a
+ * time interval of the bucket width in a sorted list. An item goes to
+ * the bucket of its day modulo the number of buckets, and the items are
+ * dequeued by scanning the buckets from the current day on, which takes
+ * a constant expected time when the width matches the density of the
+ * keys. The number of buckets and their width are adapted as the queue
+ * grows and shrinks.
+ *
+ * The items with the same key are dequeued in the order they were
+ * pushed. The keys smaller than the key of the last dequeued item are
+ * moved to it, since the past is not revisited.
+ */
+template <typename T>
+class calendar_queue
+{
+public:
+    typedef sc_dt::uint64 key_type;
+
+    calendar_queue() : days(2), width(1), day(0), count(0), last(0) {}
+
+    //! Inserts an item
+    void push(key_type key, const T& item)
+    {
+        insert(std::max(key, last), item);
+        if (++count > 2*days.size()) resize(2*days.size());
+    }
+
+    //! Removes the item with the smallest key, the queue should not be empty
+    std::pair<key_type,T> pop()
+    {
+        return take(first_day());
+    }
+
+    //! The smallest key, the queue should not be empty
+    key_type top_key()
+    {
+        return first_day().front().first;
+    }
+
+    //! Checks if the queue is empty
+    bool empty() const {return count == 0;}
+
+    //! The number of items in the queue
+    size_t size() const {return count;}
+
+private:
+    typedef std::pair<key_type,T> entry;
+    std::vector<std::deque<entry>> days;
+    key_type width;     // the time interval of a bucket
+    key_type day;       // the current day, i.e., the key divided by width
+    size_t count;
+    key_type last;      // the key of the last dequeued item
+
+    void insert(key_type key, const T& item)
+    {
+        auto& d = days[(key / width) % days.size()];
+        auto it = std::upper_bound(d.begin(), d.end(), key,
+                    [](key_type k, const entry& e) {return k < e.first;});
+        d.insert(it, entry(key, item));
+    }
+
+    //! Moves the current day to the bucket of the smallest key and returns it
+    std::deque<entry>& first_day()
+    {
+        const size_t n = days.size();
+        for (size_t i=0; i<n; i++, day++)
+        {
+            auto& d = days[day % n];
+            if (!d.empty() && d.front().first / width <= day) return d;
+        }
+        // sparse keys, jump to the bucket of the smallest one
+        size_t best = n;
+        for (size_t i=0; i<n; i++)
+            if (!days[i].empty() &&
+                (best == n || days[i].front().first < days[best].front().first))
+                best = i;
+        day = days[best].front().first / width;
+        return days[best];
+    }
+
+    entry take(std::deque<entry>& d)
+    {
+        entry e = d.front();
+        d.pop_front();
+        last = e.first;
+        if (--count < days.size()/2 && days.size() > 2) resize(days.size()/2);
+        return e;
+    }
+
+    //! Rebuilds the buckets with a width of three times the mean separation of the next keys
+    void resize(size_t n)
+    {
+        std::vector<entry> all;
+        all.reserve(count);
+        for (auto& d : days)
+            all.insert(all.end(), d.begin(), d.end());
+        std::stable_sort(all.begin(), all.end(),
+            [](const entry& a, const entry& b) {return a.first < b.first;});
+        const size_t m = std::min<size_t>(all.size(), 25);
+        if (m > 1 && all[m-1].first > all[0].first)
+            width = std::max<key_type>(3 * ((all[m-1].first - all[0].first) / (m-1)), 1);
+        days.assign(n, std::deque<entry>());
+        for (auto& e : all) insert(e.first, e.second);
+        day = last / width;
+    }
+};
+
+//! An executor which fires the processes of a DDE region in time-tag order
+/*! This module collects the DDE processes below a given module in the
+ * hierarchy (or the ones explicitly added) and executes them in a single
+ * SC_THREAD. The threads of the scheduled processes are disabled and
+ * the channels whose both ends are scheduled are switched to plain ring
+ * buffers with the capacity of the original channels.
+ *
+ * A process can fire when its next evaluation cycle reads its inputs and
+ * writes its outputs without blocking. The firings are kept in a
+ * calendar queue keyed by the time tag of the first input event of the
+ * process (or the local time of the process, if it is larger or the
+ * process has no scheduled inputs) and fired in this order. Instead of
+ * waiting for the kernel after each event, the scheduler synchronizes
+ * with the kernel time only before firing:
+ *  - a process connected to the rest of the model (e.g., through a MoC
+ *    interface), such that the events leave the region at their time;
+ *  - any process, when its time is more than the quantum ahead of the
+ *    kernel time.
+ * With a zero quantum there is a single timed wait per time tag of the
+ * region instead of one per event and process. Larger quanta let the
+ * region run ahead of the kernel, but a region without connections to
+ * the rest of the model and an unlimited source then never returns the
+ * control to the kernel.
+ *
+ *  The firings with the same time tag are executed as a single wave:
+ * they are all taken from the calendar queue at once, the scheduler
+ * synchronizes at most once for them, and they are fired in the
+ * topological order of the region (writers before readers, with the
+ * cycles broken at an arbitrary process). The processes enabled by the
+ * wave at the same time tag join it in this order, hence a process fed
+ * by several simultaneous events usually fires after all of them have
+ * been written, instead of being queued, dequeued and found blocked
+ * again for each of them.
+ *
+ * When nothing can fire, the scheduler waits for the boundary channels
+ * to be written or read, and stops if the region has no boundaries. The
+ * filters, which read their inputs in the init stage, and the processes
+ * of the parallel simulation are not supported.
+ */
+class event_scheduler : public sc_module
+{
+public:
+    //! The constructor requires the module name and the root of the region
+    /*! All the DDE processes below the root module in the hierarchy are
+     * scheduled, unless some processes are added explicitly using add().
+     */
+    event_scheduler(sc_module_name _name,               ///< The module name
+                    sc_module* root=NULL,               ///< The root of the region
+                    const sc_time& quantum=SC_ZERO_TIME ///< The run-ahead of the kernel time
+                    ) : sc_module(_name), root(root), quantum(quantum),
+                        in_wave(false), wave_key(0),
+                        nfirings(0), nsyncs(0), nwaves(0)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the list of the scheduled processes
+    void add(dde_process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! The number of firings executed by the scheduler
+    unsigned long long firings() const {return nfirings;}
+
+    //! The number of timed waits of the scheduler for the kernel time
+    unsigned long long syncs() const {return nsyncs;}
+
+    //! The number of distinct time tags (waves of firings) executed by the scheduler
+    unsigned long long waves() const {return nwaves;}
+
+    //! The scheduler is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_event_scheduler";}
+
+private:
+    SC_HAS_PROCESS(event_scheduler);
+
+    //! A scheduled process
+    struct actor
+    {
+        dde_process* proc;
+        std::vector<static_channel*> outs;
+        std::vector<timed_channel*> timed_ins;  // the scheduled inputs
+        std::vector<size_t> neighbors;          // writers of the inputs and readers of the outputs
+        bool boundary;                          // connected to the rest of the model
+        bool queued;
+        size_t rank;                            // the position in the topological order
+    };
+
+    sc_module* root;
+    sc_time quantum;
+    std::vector<dde_process*> procs;
+    std::vector<actor> actors;
+    std::vector<const sc_event*> boundary_events;
+    // the boundary channels, and if the region writes to them
+    std::vector<std::pair<static_channel*,bool>> boundary_chans;
+    calendar_queue<size_t> queue;
+    // the firings of the current time tag by their ranks
+    std::set<std::pair<size_t,size_t>> wave;
+    bool in_wave;
+    calendar_queue<size_t>::key_type wave_key;
+    unsigned long long nfirings, nsyncs, nwaves;
+
+    //! Collects the DDE processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        std::vector<sc_object*> children = obj->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+        {
+            dde_process* p = dynamic_cast<dde_process*>(*it);
+            if (p != NULL)
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(*it) != NULL)
+                collect(*it);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        std::vector<sc_object*> children = p->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+            if ((*it)->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(*it);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! The ForSyDe signal of a channel
+    static_channel* signal_of(sc_interface* c)
+    {
+        static_channel* sc = dynamic_cast<static_channel*>(c);
+        if (sc == NULL)
+            SC_REPORT_ERROR(name(), "the event scheduler only supports ForSyDe signals");
+        return sc;
+    }
+
+    //! Builds the graph of the region and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        if (procs.empty()) return;
+        const std::set<std::string> unsupported = {"DDE::filter", "DDE::ss_filter",
+            "DDE::filterf", "DDE::sender", "DDE::receiver"};
+        // writers and readers of the channels
+        std::map<sc_interface*, size_t> writer, reader;
+        std::vector<std::vector<sc_interface*>> ins(procs.size()), outs(procs.size());
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            if (unsupported.count(procs[i]->forsyde_kind()))
+                SC_REPORT_ERROR(name(), (procs[i]->forsyde_kind() + " processes are not supported by the event scheduler").c_str());
+            ins[i] = channels(procs[i], "sc_fifo_in");
+            outs[i] = channels(procs[i], "sc_fifo_out");
+            for (auto c : ins[i]) reader[c] = i;
+            for (auto c : outs[i]) writer[c] = i;
+        }
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            actor a{procs[i], {}, {}, {}, false, false, 0};
+            std::vector<static_channel*> in_chans;
+            for (auto c : ins[i])
+            {
+                static_channel* sc = signal_of(c);
+                in_chans.push_back(sc);
+                auto w = writer.find(c);
+                if (w != writer.end())
+                {
+                    a.timed_ins.push_back(dynamic_cast<timed_channel*>(c));
+                    a.neighbors.push_back(w->second);
+                }
+                else
+                {
+                    a.boundary = true;
+                    boundary_events.push_back(&sc->data_written_event());
+                    boundary_chans.push_back({sc, false});
+                }
+            }
+            for (auto c : outs[i])
+            {
+                static_channel* sc = signal_of(c);
+                a.outs.push_back(sc);
+                auto r = reader.find(c);
+                if (r != reader.end())
+                    a.neighbors.push_back(r->second);
+                else
+                {
+                    a.boundary = true;
+                    boundary_events.push_back(&sc->data_read_event());
+                    boundary_chans.push_back({sc, true});
+                }
+            }
+            std::sort(a.neighbors.begin(), a.neighbors.end());
+            a.neighbors.erase(std::unique(a.neighbors.begin(), a.neighbors.end()),
+                              a.neighbors.end());
+            actors.push_back(a);
+            procs[i]->set_event_driven(in_chans);
+        }
+        rank_actors(writer, reader);
+        // switch the internal channels to plain ring buffers
+        for (auto& w : writer)
+            if (reader.count(w.first))
+            {
+                static_channel* sc = signal_of(w.first);
+                const int cap = sc->num_available() + sc->num_free();
+                sc->set_static_buffer(std::max(cap, 1));
+            }
+    }
+
+    //! Ranks the processes in the topological order of the internal channels
+    /*! When only cycles are left, the remaining process with the smallest
+     * index is taken first.
+     */
+    void rank_actors(const std::map<sc_interface*, size_t>& writer,
+                     const std::map<sc_interface*, size_t>& reader)
+    {
+        const size_t n = actors.size();
+        std::vector<std::vector<size_t>> succs(n);
+        std::vector<size_t> indeg(n, 0);
+        for (auto& w : writer)
+        {
+            auto r = reader.find(w.first);
+            if (r == reader.end()) continue;
+            succs[w.second].push_back(r->second);
+            indeg[r->second]++;
+        }
+        std::vector<bool> done(n, false);
+        std::set<size_t> avail;
+        for (size_t i=0; i<n; i++)
+            if (indeg[i] == 0) avail.insert(i);
+        for (size_t rank=0, next=0; rank<n; rank++)
+        {
+            size_t i;
+            if (!avail.empty())
+            {
+                i = *avail.begin();
+                avail.erase(avail.begin());
+            }
+            else
+            {
+                while (done[next]) next++;
+                i = next;
+            }
+            done[i] = true;
+            actors[i].rank = rank;
+            for (auto s : succs[i])
+                if (!done[s] && --indeg[s] == 0) avail.insert(s);
+        }
+    }
+
+    //! Checks if a process can fire without blocking
+    static bool ready(const actor& a)
+    {
+        if (a.proc->is_halted()) return false;
+        for (auto c : a.outs)
+            if (c->num_free() == 0) return false;
+        return a.proc->inputs_ready();
+    }
+
+    //! The time of the next firing of a process
+    static sc_time firing_time(const actor& a)
+    {
+        sc_time t = sc_max_time(), h;
+        bool found = false;
+        for (auto c : a.timed_ins)
+            if (c != NULL && c->head_time(h))
+            {
+                t = std::min(t, h);
+                found = true;
+            }
+        return found ? std::max(t, a.proc->local_time()) : a.proc->local_time();
+    }
+
+    //! Queues a process if it can fire and is not queued yet
+    /*! A firing at the time tag of the current wave joins the wave.
+     */
+    void schedule(size_t i)
+    {
+        actor& a = actors[i];
+        if (a.queued || !ready(a)) return;
+        const auto key = firing_time(a).value();
+        if (in_wave && key <= wave_key)
+            wave.insert(std::make_pair(a.rank, i));
+        else
+            queue.push(key, i);
+        a.queued = true;
+    }
+
+    //! Queues the processes connected to the rest of the model
+    void schedule_boundaries()
+    {
+        for (size_t i=0; i<actors.size(); i++)
+            if (actors[i].boundary) schedule(i);
+    }
+
+    //! Requests the notifications of the events of the boundary channels
+    /*! The SPSC signals only notify the waiters which asked for it (see
+     * signal::data_written_event()), hence it is called before each wait.
+     */
+    void arm_boundaries()
+    {
+        for (auto& b : boundary_chans)
+            if (b.second)
+                b.first->data_read_event();
+            else
+                b.first->data_written_event();
+    }
+
+    //! The main and only execution thread of the scheduler
+    void worker()
+    {
+        for (auto& a : actors) a.proc->ext_init();
+        if (actors.empty()) return;
+        sc_event_or_list boundary_changed;
+        for (auto e : boundary_events) boundary_changed |= *e;
+        for (size_t i=0; i<actors.size(); i++) schedule(i);
+        while (1)
+        {
+            if (queue.empty())
+            {
+                // the region has finished, or deadlocks
+                if (boundary_events.empty()) return;
+                arm_boundaries();
+                wait(boundary_changed);
+                schedule_boundaries();
+                continue;
+            }
+            // take all the firings of the next time tag
+            wave_key = queue.top_key();
+            bool boundary = false;
+            while (!queue.empty() && queue.top_key() == wave_key)
+            {
+                const size_t i = queue.pop().second;
+                wave.insert(std::make_pair(actors[i].rank, i));
+                boundary = boundary || actors[i].boundary;
+            }
+            in_wave = true;
+            const sc_time t = sc_time::from_value(wave_key);
+            if (t > model_time() && (boundary || t - model_time() > quantum))
+            {
+                wait(t - model_time());
+                nsyncs++;
+                schedule_boundaries();
+            }
+            while (!wave.empty())
+            {
+                const size_t i = wave.begin()->second;
+                wave.erase(wave.begin());
+                actor& a = actors[i];
+                a.queued = false;
+                if (!ready(a)) continue;
+                a.proc->ext_fire();
+                nfirings++;
+                schedule(i);
+                for (auto n : a.neighbors) schedule(n);
+            }
+            in_wave = false;
+            nwaves++;
+        }
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,842 @@
+/**********************************************************************
+    * dde_time_warp.hpp -- Optimistic distributed simulation of DDE   *
+    *                      process networks                           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Letting the ranks of a distributed DDE model process   *
+    *          their events speculatively and roll back on stragglers *
+    *                                                                 *
+    * Usage:   Define FORSYDE_PARALLEL_SIM and FORSYDE_CHECKPOINT to   *
+    *          use it                                                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef DDE_TIME_WARP_HPP
+#define DDE_TIME_WARP_HPP
+
+/*! \file dde_time_warp.hpp
+ * \brief Implements the Time Warp executor for distributed DDE models
+ *
+ *  The DDE sender and receiver of the parallel simulation synchronize
+ * the ranks conservatively, which stalls them when the lookahead is
+ * small. This file includes an optimistic alternative: an executor which
+ * processes the events of its rank speculatively, saves the states of
+ * the processes and the signals which changed, and rolls them back when
+ * an event (a straggler) arrives in their past, together with the links
+ * which cancel the messages sent in the undone future (anti-messages).
+ * The global virtual time (GVT), below which nothing can be rolled back,
+ * is used to free the old states and records (fossil collection).
+ *
+ *     // rank 0                           // rank 1
+ *     DDE::make_tw_sender("s", 1, 0, x);  DDE::make_tw_receiver("r", 0, 0, y);
+ *     DDE::time_warp tw("tw", &top, sc_time(1,SC_MS));
+ *     sc_start();
+ *
+ *  The states are saved using process::save_state() and the signal
+ * serializers of the checkpoints, hence the states of the processes and
+ * the tokens of the signals should be serializable.
+ */
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <mpi.h>
+
+#include "dde_process.hpp"
+#include "mpi_transport.hpp"
+
+namespace ForSyDe
+{
+
+namespace DDE
+{
+
+using namespace sc_core;
+
+//! The kinds of the messages exchanged by the optimistic links
+enum tw_message_kind : char {TW_EVENT_MSG=0, TW_ANTI_MSG=1};
+
+//! The interface of the optimistic links used by the Time Warp executor
+class tw_link
+{
+public:
+    //! Receives the pending messages
+    /*! It returns the time of the earliest event which was delivered
+     * although it should not have been, i.e., the time the executor
+     * should roll back to, or sc_max_time() if there is none.
+     */
+    virtual sc_time poll() = 0;
+
+    //! The time of the next event to be delivered, or sc_max_time()
+    virtual sc_time next_time() const = 0;
+
+    //! Drops the records which can not be rolled back anymore
+    virtual void fossil_collect(const sc_time& gvt) = 0;
+
+    //! The number of messages sent minus the number of messages received
+    virtual long long in_transit() const = 0;
+};
+
+//! Process constructor for the sending end of an optimistic link
+/*! This class is used to build a process with one input which transmits
+ * the time-tagged events it reads to a tw_receiver using MPI messages.
+ * It keeps a record of the messages it has sent, and when it is rolled
+ * back it sends an anti-message for each message sent in the undone
+ * future, which cancels it in the receiver.
+ */
+template <typename T1>
+class tw_sender : public dde_process, public tw_link
+{
+public:
+    DDE_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * sends it to the destination rank.
+     */
+    tw_sender(sc_module_name _name,     ///< process name
+              int destination,          ///< MPI rank of the destination process
+              int tag                   ///< MPI tag of the message
+             ) : dde_process(_name), iport1("iport1"),
+                 destination(destination), tag(tag), nsent(0)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("destination", destination);
+        add_arg("tag", tag);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::tw_sender";}
+
+    sc_time poll() {return sc_max_time();}
+
+    sc_time next_time() const {return sc_max_time();}
+
+    void fossil_collect(const sc_time& gvt)
+    {
+        while (!log.empty() && log.front().second < gvt) log.pop_front();
+    }
+
+    long long in_transit() const {return nsent;}
+
+private:
+    int destination;
+    int tag;
+
+    // Inputs and output variables
+    ttn_event<T1> ival1;
+    // the sequence number of the next message
+    std::uint64_t seq;
+    // the sequence numbers and the time tags of the messages which may be cancelled
+    std::deque<std::pair<std::uint64_t,sc_time>> log;
+    long long nsent;
+    std::vector<char> buf;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        seq = 0;
+    }
+
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        send(TW_EVENT_MSG, seq, get_time(ival1));
+        log.push_back({seq++, get_time(ival1)});
+        sync(get_time(ival1));
+    }
+
+    void clean() {}
+
+    void send(tw_message_kind kind, std::uint64_t id, const sc_time& t)
+    {
+        buf.clear();
+        buf.push_back(kind);
+        serializer<std::uint64_t>::write(buf, id);
+        serializer<std::uint64_t>::write(buf, t.value());
+        if (kind == TW_EVENT_MSG)
+            serializer<abst_ext<T1>>::write(buf, get_value(ival1));
+        MPI_Request request;
+        MPI_Status status;
+        MPI_Isend(buf.data(), buf.size(), MPI_BYTE, destination, tag,
+                  MPI_COMM_WORLD, &request);
+        mpi_wait(request, status);
+        nsent++;
+    }
+
+    void save_state(std::vector<char>& buf) {save_values(buf, seq);}
+
+    //! Cancels the messages sent after the saved state
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t s;
+        restore_values(pos, s);
+        while (!log.empty() && log.back().first >= s)
+        {
+            send(TW_ANTI_MSG, log.back().first, log.back().second);
+            log.pop_back();
+        }
+        seq = s;
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for the receiving end of an optimistic link
+/*! This class is used to build a process with one output which delivers
+ * the events received from a tw_sender in the order of their time tags.
+ * The received events are kept until the GVT passes them. An event which
+ * arrives before an already delivered one, or the anti-message of an
+ * already delivered event, makes the executor roll back to its time.
+ */
+template <typename T0>
+class tw_receiver : public dde_process, public tw_link
+{
+public:
+    DDE_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the received events to its
+     * output port.
+     */
+    tw_receiver(sc_module_name _name,     ///< process name
+                int source,               ///< MPI rank of the source process
+                int tag                   ///< MPI tag of the message
+               ) : dde_process(_name), oport1("oport1"),
+                   source(source), tag(tag), next(0), nreceived(0)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("source", source);
+        add_arg("tag", tag);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::tw_receiver";}
+
+    bool inputs_ready() const {return next < events.size();}
+
+    sc_time poll()
+    {
+        sc_time rollback = sc_max_time();
+        while (true)
+        {
+            MPI_Status status;
+            int flag = 0;
+            MPI_Iprobe(source, tag, MPI_COMM_WORLD, &flag, &status);
+            if (!flag) break;
+            int bytes = 0;
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            buf.resize(bytes);
+            MPI_Recv(buf.data(), bytes, MPI_BYTE, source, tag, MPI_COMM_WORLD,
+                     &status);
+            nreceived++;
+            const char* pos = buf.data();
+            const char kind = *pos++;
+            entry e;
+            std::uint64_t t;
+            serializer<std::uint64_t>::read(pos, e.seq);
+            serializer<std::uint64_t>::read(pos, t);
+            e.t = sc_time::from_value(t);
+            auto it = std::upper_bound(events.begin(), events.end(), e);
+            size_t idx = it - events.begin();
+            if (kind == TW_EVENT_MSG)
+            {
+                serializer<abst_ext<T0>>::read(pos, e.val);
+                events.insert(it, std::move(e));
+            }
+            else
+            {
+                // the cancelled event is right before its upper bound
+                if (idx == 0 || events[idx-1].seq != e.seq)
+                    SC_REPORT_ERROR(name(), "received the anti-message of an unknown event");
+                events.erase(events.begin() + --idx);
+            }
+            if (idx < next)
+            {
+                rollback = std::min(rollback, e.t);
+                if (kind == TW_EVENT_MSG) next++; else next--;
+            }
+        }
+        return rollback;
+    }
+
+    sc_time next_time() const
+    {
+        return next < events.size() ? events[next].t : sc_max_time();
+    }
+
+    void fossil_collect(const sc_time& gvt)
+    {
+        size_t n = 0;
+        while (n < next && events[n].t < gvt) n++;
+        events.erase(events.begin(), events.begin()+n);
+        next -= n;
+    }
+
+    long long in_transit() const {return -nreceived;}
+
+private:
+    int source;
+    int tag;
+
+    //! A received event, ordered by its time tag and sequence number
+    struct entry
+    {
+        sc_time t;
+        std::uint64_t seq;
+        abst_ext<T0> val;
+
+        bool operator<(const entry& rs) const
+        {
+            return t < rs.t || (t == rs.t && seq < rs.seq);
+        }
+    };
+
+    // the received events and the number of the delivered ones
+    std::deque<entry> events;
+    size_t next;
+    long long nreceived;
+    std::vector<char> buf;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep() {}
+
+    void exec() {}
+
+    void prod()
+    {
+        const entry& e = events[next++];
+        write_multiport(oport1, ttn_event<T0>(e.val, e.t));
+        sync(e.t);
+    }
+
+    void clean() {}
+
+    //! Saves the key of the last delivered event
+    void save_state(std::vector<char>& buf)
+    {
+        const bool any = next > 0;
+        save_values(buf, any);
+        if (any) save_values(buf, events[next-1].t, events[next-1].seq);
+    }
+
+    //! Delivers again the events after the saved key
+    void restore_state(const char*& pos)
+    {
+        bool any;
+        restore_values(pos, any);
+        if (!any)
+        {
+            next = 0;
+            return;
+        }
+        entry key;
+        restore_values(pos, key.t, key.seq);
+        next = std::upper_bound(events.begin(), events.end(), key) - events.begin();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! An optimistic (Time Warp) executor for the DDE processes of a rank
+/*! This module collects the DDE processes below a given module in the
+ * hierarchy (or the ones explicitly added) and executes them in a single
+ * SC_THREAD in the order of the time tags of their events, as the event
+ * scheduler does, but without waiting for the kernel time or for the
+ * other ranks. The events of the other ranks arrive through the
+ * tw_receiver processes and are delivered as soon as they are received.
+ *
+ *  After every given number of firings, at the next time tag, the states
+ * of the processes which fired since the last snapshot and of their
+ * signals are saved (incremental state saving). When a straggler or the
+ * anti-message of a delivered event arrives, the processes and the
+ * signals which changed after the latest snapshot before its time are
+ * restored, the tw_senders among them send the anti-messages of their
+ * undone messages, and the execution continues from there.
+ *
+ *  Every few firings, and whenever the rank is idle, the ranks compute
+ * the GVT with a non-blocking reduction of the earliest time tags they
+ * may still produce events at. A round is only accepted when no message
+ * is in transit, which is checked by counting the messages. The
+ * snapshots and the link records older than the GVT are then freed, and
+ * the executors stop once the GVT reaches the end time. Hence all ranks
+ * should run a time_warp executor and start a simulation which lets it
+ * finish.
+ *
+ *  The region should be closed, apart from the links: the events leaving
+ * it through other channels could not be rolled back. The function calls
+ * of the sinks (and the other processes with deferred_effects) are held
+ * back and performed once the GVT passes their time tags, hence a sink
+ * sees each event once, in order, and never an undone one. The functions
+ * of the other processes run speculatively and should have no side
+ * effects. The filters, which read their first input in the init stage,
+ * are initialized once their first input arrives. The DDE::ss_filter,
+ * DDE::filterf and the conservative links are not supported.
+ */
+class time_warp : public sc_module
+{
+public:
+    //! The constructor requires the module name, the root and the end time
+    /*! All the DDE processes below the root module in the hierarchy are
+     * executed, unless some processes are added explicitly using add().
+     */
+    time_warp(sc_module_name _name,             ///< The module name
+              sc_module* root,                  ///< The root of the region
+              const sc_time& end_time,          ///< The events from this time on are not processed
+              unsigned snapshot_interval=64,    ///< The firings between two snapshots
+              unsigned gvt_interval=1024        ///< The firings between two GVT rounds
+              ) : sc_module(_name), root(root), end_time(end_time),
+                  snapshot_interval(std::max(snapshot_interval, 1u)),
+                  gvt_interval(std::max(gvt_interval, 1u)),
+                  nfirings(0), nrollbacks(0), nundone(0), gvt_time(SC_ZERO_TIME)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the list of the executed processes
+    void add(dde_process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! The number of firings executed, including the undone ones
+    unsigned long long firings() const {return nfirings;}
+
+    //! The number of rollbacks
+    unsigned long long rollbacks() const {return nrollbacks;}
+
+    //! The number of firings undone by the rollbacks
+    unsigned long long undone() const {return nundone;}
+
+    //! The last computed GVT
+    const sc_time& gvt() const {return gvt_time;}
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_time_warp";}
+
+private:
+    SC_HAS_PROCESS(time_warp);
+
+    //! An executed process
+    struct actor
+    {
+        dde_process* proc;
+        tw_link* link;                          // if it is a link
+        std::vector<static_channel*> outs;
+        std::vector<timed_channel*> timed_ins;
+        std::vector<size_t> chans;              // the indices of its signals
+        std::vector<size_t> neighbors;          // writers of the inputs and readers of the outputs
+        bool lazy;                              // initialized when its first input arrives
+        bool started;
+        size_t min_free;                        // free slots needed in each output
+    };
+
+    //! The saved states of the processes and the signals which changed
+    struct snapshot
+    {
+        sc_time time;                           // all the earlier firings are done
+        unsigned long long firing;              // the number of firings done
+        std::map<size_t,std::vector<char>> procs, chans;
+    };
+
+    sc_module* root;
+    sc_time end_time;
+    unsigned snapshot_interval, gvt_interval;
+    std::vector<dde_process*> procs;
+    std::vector<actor> actors;
+    std::vector<static_channel*> chans;
+    std::vector<tw_link*> links;
+    std::vector<deferred_effects*> effects;
+    std::set<std::pair<sc_dt::uint64,size_t>> queue;
+    std::vector<char> queued;
+    std::deque<snapshot> snaps;
+    std::set<size_t> dirty;                     // actors fired since the last snapshot
+    unsigned long long nfirings, nrollbacks, nundone;
+    sc_time gvt_time, lvt;
+
+    //! Collects the DDE processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        for (auto c : obj->get_child_objects())
+        {
+            if (auto p = dynamic_cast<dde_process*>(c))
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(c) != NULL)
+                collect(c);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        for (auto c : p->get_child_objects())
+            if (c->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! Builds the graph of the region and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        if (procs.empty()) return;
+        const std::set<std::string> unsupported = {"DDE::ss_filter",
+            "DDE::filterf", "DDE::sender", "DDE::receiver"};
+        std::map<sc_interface*, size_t> writer, reader, index;
+        std::vector<std::vector<sc_interface*>> ins(procs.size()), outs(procs.size());
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            if (unsupported.count(procs[i]->forsyde_kind()))
+                SC_REPORT_ERROR(name(), (procs[i]->forsyde_kind() + " processes are not supported by the Time Warp executor").c_str());
+            ins[i] = channels(procs[i], "sc_fifo_in");
+            outs[i] = channels(procs[i], "sc_fifo_out");
+            for (auto c : ins[i]) reader[c] = i;
+            for (auto c : outs[i]) writer[c] = i;
+        }
+        for (auto& w : writer)
+            if (!reader.count(w.first))
+                SC_REPORT_ERROR(name(), "the Time Warp executor requires a closed region: a signal has no reader in the region");
+        for (auto& r : reader)
+        {
+            if (!writer.count(r.first))
+                SC_REPORT_ERROR(name(), "the Time Warp executor requires a closed region: a signal has no writer in the region");
+            static_channel* sc = dynamic_cast<static_channel*>(r.first);
+            if (sc == NULL || dynamic_cast<checkpoint_channel*>(r.first) == NULL)
+                SC_REPORT_ERROR(name(), "only ForSyDe signals are supported by the Time Warp executor");
+            index[r.first] = chans.size();
+            chans.push_back(sc);
+        }
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            const bool filter = procs[i]->forsyde_kind() == "DDE::filter";
+            actor a{procs[i], dynamic_cast<tw_link*>(procs[i]), {}, {}, {}, {},
+                    filter, false, filter ? 3u : 1u};
+            if (a.link) links.push_back(a.link);
+            if (auto e = dynamic_cast<deferred_effects*>(procs[i]))
+            {
+                e->defer_effects();
+                effects.push_back(e);
+            }
+            std::vector<static_channel*> in_chans;
+            for (auto c : ins[i])
+            {
+                in_chans.push_back(chans[index[c]]);
+                a.timed_ins.push_back(dynamic_cast<timed_channel*>(c));
+                a.chans.push_back(index[c]);
+                a.neighbors.push_back(writer[c]);
+            }
+            for (auto c : outs[i])
+            {
+                a.outs.push_back(chans[index[c]]);
+                a.chans.push_back(index[c]);
+                a.neighbors.push_back(reader[c]);
+            }
+            std::sort(a.neighbors.begin(), a.neighbors.end());
+            a.neighbors.erase(std::unique(a.neighbors.begin(), a.neighbors.end()),
+                              a.neighbors.end());
+            actors.push_back(a);
+            procs[i]->set_event_driven(in_chans);
+        }
+        // switch the channels to plain ring buffers
+        for (auto sc : chans)
+            sc->set_static_buffer(std::max(sc->num_available() + sc->num_free(), 1));
+        queued.assign(actors.size(), 0);
+    }
+
+    //! Checks if a process can fire without blocking
+    static bool ready(const actor& a)
+    {
+        if (a.proc->is_halted()) return false;
+        for (auto c : a.outs)
+            if ((size_t)c->num_free() < a.min_free) return false;
+        if (!a.started)
+        {
+            for (auto c : a.timed_ins)
+                if (dynamic_cast<static_channel*>(c)->num_available() == 0) return false;
+            return true;
+        }
+        return a.proc->inputs_ready();
+    }
+
+    //! The time of the next firing of a process
+    static sc_time firing_time(const actor& a)
+    {
+        if (a.link) return std::max(a.link->next_time(), a.proc->local_time());
+        sc_time t = sc_max_time(), h;
+        bool found = false;
+        for (auto c : a.timed_ins)
+            if (c != NULL && c->head_time(h))
+            {
+                t = std::min(t, h);
+                found = true;
+            }
+        return found ? std::max(t, a.proc->local_time()) : a.proc->local_time();
+    }
+
+    //! Queues a process if it can fire and is not queued yet
+    void schedule(size_t i)
+    {
+        actor& a = actors[i];
+        if (queued[i] || !ready(a)) return;
+        queue.insert({firing_time(a).value(), i});
+        queued[i] = 1;
+    }
+
+    //! Saves the states of the processes which fired since the last snapshot
+    void take_snapshot(const sc_time& t)
+    {
+        snapshot s{t, nfirings, {}, {}};
+        std::set<size_t> cs;
+        for (auto i : dirty)
+        {
+            auto& buf = s.procs[i];
+            buf.push_back(actors[i].started ? 1 : 0);
+            if (actors[i].started) actors[i].proc->save_snapshot(buf);
+            cs.insert(actors[i].chans.begin(), actors[i].chans.end());
+        }
+        for (auto c : cs)
+            dynamic_cast<checkpoint_channel*>(chans[c])->save_contents(s.chans[c]);
+        snaps.push_back(std::move(s));
+        dirty.clear();
+    }
+
+    //! Restores the latest snapshot at or before a time
+    void rollback(const sc_time& t)
+    {
+        if (t < gvt_time)
+            SC_REPORT_ERROR(name(), "a straggler arrived before the GVT");
+        size_t k = snaps.size()-1;
+        while (k > 0 && snaps[k].time > t) k--;
+        // the processes and the signals which changed after the snapshot
+        std::set<size_t> ps(dirty), cs;
+        for (size_t j=k+1; j<snaps.size(); j++)
+        {
+            for (auto& p : snaps[j].procs) ps.insert(p.first);
+            for (auto& c : snaps[j].chans) cs.insert(c.first);
+        }
+        for (auto i : ps) cs.insert(actors[i].chans.begin(), actors[i].chans.end());
+        auto latest = [&](size_t i, bool proc) -> const std::vector<char>&
+        {
+            for (size_t j=k+1; j-- > 0; )
+            {
+                auto& m = proc ? snaps[j].procs : snaps[j].chans;
+                auto it = m.find(i);
+                if (it != m.end()) return it->second;
+            }
+            SC_REPORT_ERROR(name(), "the state to roll back to is missing");
+            static const std::vector<char> none;
+            return none;
+        };
+        for (auto i : ps)
+        {
+            const char* pos = latest(i, true).data();
+            actors[i].started = *pos++ != 0;
+            if (actors[i].started) actors[i].proc->restore_snapshot(pos);
+        }
+        for (auto c : cs)
+        {
+            const char* pos = latest(c, false).data();
+            dynamic_cast<checkpoint_channel*>(chans[c])->reload_contents(pos);
+        }
+        // the effects of the undone firings
+        for (auto e : effects) e->discard_effects(snaps[k].time);
+        nundone += nfirings - snaps[k].firing;
+        nrollbacks++;
+        lvt = snaps[k].time;
+        snaps.erase(snaps.begin()+k+1, snaps.end());
+        dirty.clear();
+        queue.clear();
+        std::fill(queued.begin(), queued.end(), 0);
+        for (size_t i=0; i<actors.size(); i++) schedule(i);
+    }
+
+    //! Frees the snapshots and the records older than the GVT
+    /*! The effects of the events before the oldest kept snapshot, which
+     * can no longer be rolled back, are performed.
+     */
+    void fossil_collect()
+    {
+        size_t k = 0;
+        while (k+1 < snaps.size() && snaps[k+1].time <= gvt_time) k++;
+        if (k == 0) return;
+        // the kept snapshot takes over the older states it does not have
+        for (size_t j=0; j<k; j++)
+        {
+            snaps[k].procs.insert(snaps[j].procs.begin(), snaps[j].procs.end());
+            snaps[k].chans.insert(snaps[j].chans.begin(), snaps[j].chans.end());
+        }
+        snaps.erase(snaps.begin(), snaps.begin()+k);
+        for (auto l : links) l->fossil_collect(gvt_time);
+        for (auto e : effects) e->commit_effects(snaps.front().time);
+    }
+
+    //! The earliest time at which the rank may still produce an event
+    sc_time local_bound() const
+    {
+        sc_time t = sc_max_time();
+        if (!queue.empty()) t = sc_time::from_value(queue.begin()->first);
+        for (auto& a : actors)
+        {
+            if (a.proc->is_halted()) continue;
+            sc_time h;
+            for (auto c : a.timed_ins)
+                if (c != NULL && c->head_time(h)) t = std::min(t, h);
+            if (a.link) t = std::min(t, a.link->next_time());
+        }
+        return t;
+    }
+
+    //! The main and only execution thread of the executor
+    void worker()
+    {
+        if (actors.empty()) return;
+        for (auto& a : actors)
+            if (!a.lazy)
+            {
+                a.proc->ext_init();
+                a.started = true;
+            }
+        for (size_t i=0; i<actors.size(); i++) dirty.insert(i);
+        lvt = SC_ZERO_TIME;
+        take_snapshot(SC_ZERO_TIME);
+        for (size_t i=0; i<actors.size(); i++) schedule(i);
+        // the state of the GVT reduction
+        MPI_Request reqs[2] = {MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+        sc_dt::uint64 bound, gbound;
+        long long transit, gtransit;
+        unsigned long long since_gvt = 0, since_snapshot = 0;
+        while (1)
+        {
+            // deliver the received messages and roll back on stragglers
+            sc_time rb = sc_max_time();
+            for (auto l : links) rb = std::min(rb, l->poll());
+            if (rb != sc_max_time()) rollback(rb);
+            for (size_t i=0; i<actors.size(); i++)
+                if (actors[i].link) schedule(i);
+            const bool idle = queue.empty() ||
+                sc_time::from_value(queue.begin()->first) >= end_time;
+            // advance the GVT
+            if (reqs[0] == MPI_REQUEST_NULL && (idle || since_gvt >= gvt_interval))
+            {
+                bound = std::min(local_bound(), end_time).value();
+                transit = 0;
+                for (auto l : links) transit += l->in_transit();
+                MPI_Iallreduce(&bound, &gbound, 1, MPI_UINT64_T, MPI_MIN,
+                               MPI_COMM_WORLD, &reqs[0]);
+                MPI_Iallreduce(&transit, &gtransit, 1, MPI_LONG_LONG, MPI_SUM,
+                               MPI_COMM_WORLD, &reqs[1]);
+                since_gvt = 0;
+            }
+            if (reqs[0] != MPI_REQUEST_NULL)
+            {
+                int done = 0;
+                MPI_Testall(2, reqs, &done, MPI_STATUSES_IGNORE);
+                if (done && gtransit == 0)
+                {
+                    gvt_time = sc_time::from_value(gbound);
+                    if (gvt_time >= end_time)
+                    {
+                        for (auto e : effects) e->commit_effects(end_time);
+                        return;
+                    }
+                    fossil_collect();
+                }
+            }
+            if (idle) continue;
+            auto next = *queue.begin();
+            queue.erase(queue.begin());
+            queued[next.second] = 0;
+            actor& a = actors[next.second];
+            if (!ready(a)) continue;
+            const sc_time t = sc_time::from_value(next.first);
+            if (t > lvt && since_snapshot >= snapshot_interval)
+            {
+                take_snapshot(t);
+                since_snapshot = 0;
+            }
+            if (a.started)
+                a.proc->ext_fire();
+            else
+            {
+                a.proc->ext_init();
+                a.started = true;
+            }
+            lvt = std::max(lvt, t);
+            dirty.insert(next.second);
+            nfirings++;
+            since_gvt++;
+            since_snapshot++;
+            schedule(next.second);
+            for (auto n : a.neighbors) schedule(n);
+        }
+    }
+};
+
+//! Helper function to construct the sending end of an optimistic link
+template <class T1, template <class> class IIf>
+inline tw_sender<T1>* make_tw_sender(const std::string& pName,
+    int destination,            ///< MPI rank of the destination process
+    int tag,                    ///< MPI tag of the message
+    IIf<T1>& inp1
+    )
+{
+    auto p = new tw_sender<T1>(pName.c_str(), destination, tag);
+
+    (*p).iport1(inp1);
+
+    return p;
+}
+
+//! Helper function to construct the receiving end of an optimistic link
+template <class T0, template <class> class OIf>
+inline tw_receiver<T0>* make_tw_receiver(const std::string& pName,
+    int source,                 ///< MPI rank of the source process
+    int tag,                    ///< MPI tag of the message
+    OIf<T0>& outS
+    )
+{
+    auto p = new tw_receiver<T0>(pName.c_str(), source, tag);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+}
+}
+
+#endif
@@ -60,18 +60,97 @@ std::string toString(Signal<T> & signal) {
 
 
 #include <deque>
+#include <functional>
 
 namespace ForSyDe {
 namespace DiscreteEvent {
 
 template <typename O>
 struct tuple {
+	tuple() : time(), value() {}
 	tuple(const sc_core::sc_time & time, const O value) : time(time), value(value) {}
 
 	sc_core::sc_time time;
 	O value;
 };
 
+/* The pending events of a delayed output, kept in a ring buffer.
+ * The events landing on the same time are merged by the combiner, or
+ * the last one wins. Once a later time is pushed, the merged event of
+ * the previous time is dropped if it would not change the value of the
+ * output, so an output which chatters wakes up its method about once
+ * per distinct value and time. The last event is kept even if it is
+ * unchanged, since the combiner may still merge events into it. The
+ * ring only grows when more events are pending than its capacity. */
+template <typename O>
+class Pending {
+public:
+	typedef std::function<O(const O &, const O &)> Combiner;
+
+	explicit Pending(size_t capacity = 16) : ring(capacity > 0 ? capacity : 1), head(0), count(0), written(), has_written(false) {}
+
+	void setCombiner(const Combiner & combiner) {
+		this->combiner = combiner;
+	}
+
+	/* Schedules a value at a time, which is not before the pending
+	 * ones. Returns true if it became the first pending event. */
+	bool push(const sc_core::sc_time & time, const O & value) {
+		if (this->count > 0 && this->back().time == time) {
+			tuple<O> & last = this->back();
+			last.value = this->combiner ? this->combiner(last.value, value) : value;
+			return false;
+		}
+		// the time of the last event is closed
+		if (this->count > 0 && this->unchanged(this->count-1, this->back().value)) --this->count;
+		if (this->count == this->ring.size()) this->grow();
+		this->ring[(this->head + this->count) % this->ring.size()] = tuple<O>(time,value);
+		return ++this->count == 1;
+	}
+
+	bool empty() const {
+		return this->count == 0;
+	}
+
+	const sc_core::sc_time & frontTime() const {
+		return this->ring[this->head].time;
+	}
+
+	/* Takes the value of the first pending event. */
+	const O & pop() {
+		this->written = this->ring[this->head].value;
+		this->has_written = true;
+		this->head = (this->head + 1) % this->ring.size();
+		--this->count;
+		return this->written;
+	}
+
+private:
+	std::vector<tuple<O> > ring;
+	size_t head, count;
+	O written;
+	bool has_written;
+	Combiner combiner;
+
+	tuple<O> & back() {
+		return this->ring[(this->head + this->count - 1) % this->ring.size()];
+	}
+
+	/* Checks if the k-th pending value equals the one before it. */
+	bool unchanged(size_t k, const O & value) const {
+		if (k > 0) return this->ring[(this->head + k - 1) % this->ring.size()].value == value;
+		return this->has_written && this->written == value;
+	}
+
+	void grow() {
+		std::vector<tuple<O> > bigger(2 * this->ring.size());
+		for (size_t i = 0; i < this->count; ++i)
+			bigger[i] = this->ring[(this->head + i) % this->ring.size()];
+		this->ring.swap(bigger);
+		this->head = 0;
+	}
+};
+
 template <class O1>
 class Out1 : public sc_core::sc_module {
 public:
@@ -85,28 +164,32 @@ public:
 
 protected:
 	void delayOutput(const O1 & o1) {
-		this->f1.push_back(tuple<O1>(sc_core::sc_time_stamp() + this->delay1,o1));
-		this->next_event();
+		if (this->f1.push(sc_core::sc_time_stamp() + this->delay1,o1))
+			this->next_event();
+	}
+
+	/* Merges the events of output 1 landing on the same time, instead
+	 * of keeping the last one. */
+	void setCombiner1(const typename Pending<O1>::Combiner & combiner) {
+		this->f1.setCombiner(combiner);
 	}
 
 private:
-	std::deque<tuple<O1> > f1;
+	Pending<O1> f1;
 	sc_core::sc_event action1;
 	sc_core::sc_time delay1;
 	
 	SC_HAS_PROCESS(Out1);
 	
 	void delay1_method() {
-		if (!f1.empty()) {
-			o1 = f1.front().value;
-			f1.pop_front();
-			this->next_event();
-		}
+		if (!f1.empty() && f1.frontTime() <= sc_core::sc_time_stamp())
+			o1 = f1.pop();
+		this->next_event();
 	}
 
 	void next_event() {
 		if (!f1.empty()) {
-			const sc_core::sc_time t1 = f1.front().time;
+			const sc_core::sc_time t1 = f1.frontTime();
 			this->action1.notify(t1 - sc_core::sc_time_stamp());
 		}
 	}
@@ -129,46 +212,54 @@ public:
 	
 protected:
 	void delayOutput(const O1 & o1, const O2 & o2) {
-		this->f1.push_back(tuple<O1>(sc_core::sc_time_stamp() + this->delay1,o1));
-		this->next_event1();
-		this->f2.push_back(tuple<O2>(sc_core::sc_time_stamp() + this->delay2,o2));
-		this->next_event2();
+		if (this->f1.push(sc_core::sc_time_stamp() + this->delay1,o1))
+			this->next_event1();
+		if (this->f2.push(sc_core::sc_time_stamp() + this->delay2,o2))
+			this->next_event2();
+	}
+
+	/* Merges the events of output 1 landing on the same time, instead
+	 * of keeping the last one. */
+	void setCombiner1(const typename Pending<O1>::Combiner & combiner) {
+		this->f1.setCombiner(combiner);
+	}
+
+	/* Merges the events of output 2 landing on the same time, instead
+	 * of keeping the last one. */
+	void setCombiner2(const typename Pending<O2>::Combiner & combiner) {
+		this->f2.setCombiner(combiner);
 	}
 	
 private:
-	std::deque<tuple<O1> > f1;
-	std::deque<tuple<O2> > f2;
+	Pending<O1> f1;
+	Pending<O2> f2;
 	sc_core::sc_event action1, action2;
 	sc_core::sc_time delay1, delay2;
 	
 	SC_HAS_PROCESS(Out2);
 	
 	void delay1_method() {
-		if (!f1.empty()) {
-			o1 = f1.front().value;
-			f1.pop_front();
-			this->next_event1();
-		}
+		if (!f1.empty() && f1.frontTime() <= sc_core::sc_time_stamp())
+			o1 = f1.pop();
+		this->next_event1();
 	}
 	
 	void delay2_method() {
-		if (!f2.empty()) {
-			o2 = f2.front().value;
-			f2.pop_front();
-			this->next_event2();
-		}
+		if (!f2.empty() && f2.frontTime() <= sc_core::sc_time_stamp())
+			o2 = f2.pop();
+		this->next_event2();
 	}
 
 	void next_event1() {
 		if (!f1.empty()) {
-			const sc_core::sc_time t1 = f1.front().time;
+			const sc_core::sc_time t1 = f1.frontTime();
 			this->action1.notify(t1 - sc_core::sc_time_stamp());
 		}
 	}
 
 	void next_event2() {
 		if (!f2.empty()) {
-			const sc_core::sc_time t2 = f2.front().time;
+			const sc_core::sc_time t2 = f2.frontTime();
 			this->action2.notify(t2 - sc_core::sc_time_stamp());
 		}
 	}
@@ -195,64 +286,76 @@ public:
 	
 protected:
 	void delayOutput(const O1 & o1, const O2 & o2, const O3 & o3) {
-		this->f1.push_back(tuple<O1>(sc_core::sc_time_stamp() + this->delay1,o1));
-		this->next_event1();
-		this->f2.push_back(tuple<O2>(sc_core::sc_time_stamp() + this->delay2,o2));
-		this->next_event2();
-		this->f3.push_back(tuple<O3>(sc_core::sc_time_stamp() + this->delay3,o3));
-		this->next_event3();
+		if (this->f1.push(sc_core::sc_time_stamp() + this->delay1,o1))
+			this->next_event1();
+		if (this->f2.push(sc_core::sc_time_stamp() + this->delay2,o2))
+			this->next_event2();
+		if (this->f3.push(sc_core::sc_time_stamp() + this->delay3,o3))
+			this->next_event3();
+	}
+
+	/* Merges the events of output 1 landing on the same time, instead
+	 * of keeping the last one. */
+	void setCombiner1(const typename Pending<O1>::Combiner & combiner) {
+		this->f1.setCombiner(combiner);
+	}
+
+	/* Merges the events of output 2 landing on the same time, instead
+	 * of keeping the last one. */
+	void setCombiner2(const typename Pending<O2>::Combiner & combiner) {
+		this->f2.setCombiner(combiner);
+	}
+
+	/* Merges the events of output 3 landing on the same time, instead
+	 * of keeping the last one. */
+	void setCombiner3(const typename Pending<O3>::Combiner & combiner) {
+		this->f3.setCombiner(combiner);
 	}
 	
 private:
-	std::deque<tuple<O1> > f1;
-	std::deque<tuple<O2> > f2;
-	std::deque<tuple<O3> > f3;
+	Pending<O1> f1;
+	Pending<O2> f2;
+	Pending<O3> f3;
 	sc_core::sc_event action1, action2, action3;
 	sc_core::sc_time delay1, delay2, delay3;
 	
 	SC_HAS_PROCESS(Out3);
 	
 	void delay1_method() {
-		if (!f1.empty()) {
-			o1 = f1.front().value;
-			f1.pop_front();
-			this->next_event1();
-		}
+		if (!f1.empty() && f1.frontTime() <= sc_core::sc_time_stamp())
+			o1 = f1.pop();
+		this->next_event1();
 	}
 	
 	void delay2_method() {
-		if (!f2.empty()) {
-			o2 = f2.front().value;
-			f2.pop_front();
-			this->next_event2();
-		}
+		if (!f2.empty() && f2.frontTime() <= sc_core::sc_time_stamp())
+			o2 = f2.pop();
+		this->next_event2();
 	}
 
 	void delay3_method() {
-		if (!f3.empty()) {
-			o3 = f3.front().value;
-			f3.pop_front();
-			this->next_event3();
-		}
+		if (!f3.empty() && f3.frontTime() <= sc_core::sc_time_stamp())
+			o3 = f3.pop();
+		this->next_event3();
 	}
 
 	void next_event1() {
 		if (!f1.empty()) {
-			const sc_core::sc_time t1 = f1.front().time;
+			const sc_core::sc_time t1 = f1.frontTime();
 			this->action1.notify(t1 - sc_core::sc_time_stamp());
 		}
 	}
 
 	void next_event2() {
 		if (!f2.empty()) {
-			const sc_core::sc_time t2 = f2.front().time;
+			const sc_core::sc_time t2 = f2.frontTime();
 			this->action2.notify(t2 - sc_core::sc_time_stamp());
 		}
 	}
 
 	void next_event3() {
 		if (!f3.empty()) {
-			const sc_core::sc_time t3 = f3.front().time;
+			const sc_core::sc_time t3 = f3.frontTime();
 			this->action3.notify(t3 - sc_core::sc_time_stamp());
 		}
 	}
@@ -73,10 +73,36 @@ inline mealy<IT,ST,OT>* make_mealy(std::string pName,
     typename mealy<IT,ST,OT>::od_functype _od_func,
     ST init_st,
     OIf<OT>& outS,
-    IIf<IT>& inpS
+    IIf<IT>& inpS,
+    bool const_rate=false
     )
 {
-    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_func, _od_func, init_st);
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_func, _od_func, init_st, const_rate);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a mealy process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(std::string pName,
+    typename mealy<IT,ST,OT>::gamma_functype gamma,
+    typename mealy<IT,ST,OT>::ns_inplace_functype _ns_inplace,
+    typename mealy<IT,ST,OT>::od_functype _od_func,
+    ST init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS,
+    bool const_rate=false
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_inplace, _od_func, init_st, const_rate);
     
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -147,6 +173,25 @@ inline vsource<T>* make_vsource(std::string pName,
     return p;
 }
 
+//! Helper function to construct a stream source process
+/*! This function is used to construct a source (SystemC module) which
+ * reads a token_stream and connect its output signal. It is used as
+ * make_vsource, with a stream (e.g., from make_generator_stream or
+ * make_file_stream) instead of a vector.
+ */
+template <class T, template <class> class OIf>
+inline stream_source<T>* make_vsource(const std::string& pName,
+    std::shared_ptr<token_stream<std::tuple<size_t,T>>> stream,
+    OIf<T>& outS
+    )
+{
+    auto p = new stream_source<T>(pName.c_str(), stream);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a sink process
 /*! This function is used to construct a sink (SystemC module) and
  * connect its output and output signals.
@@ -318,10 +363,36 @@ inline mealy<IT,ST,OT>* make_mealy(std::string pName,
     typename mealy<IT,ST,OT>::od_functype _od_func,
     ST init_st,
     OIf<OT>& outS,
-    IIf<IT>& inpS
+    IIf<IT>& inpS,
+    bool const_rate=false
     )
 {
-    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_func, _od_func, init_st);
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_func, _od_func, init_st, const_rate);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a mealy process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(std::string pName,
+    typename mealy<IT,ST,OT>::gamma_functype gamma,
+    typename mealy<IT,ST,OT>::ns_inplace_functype _ns_inplace,
+    typename mealy<IT,ST,OT>::od_functype _od_func,
+    ST init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS,
+    bool const_rate=false
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_inplace, _od_func, init_st, const_rate);
     
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -361,6 +432,30 @@ inline mealy<IT,ST,OT>* make_mealy(std::string pName,
     return p;
 }
 
+//! Helper function to construct a mealy process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(std::string pName,
+    typename mealy<IT,ST,OT>::gamma_functype gamma,
+    typename mealy<IT,ST,OT>::ns_inplace_functype _ns_inplace,
+    typename mealy<IT,ST,OT>::od_functype _od_func,
+    ST init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_inplace, _od_func, init_st);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 }
 
 namespace T
@@ -393,6 +488,30 @@ inline mealy<IT,ST,OT>* make_mealy(std::string pName,
     return p;
 }
 
+//! Helper function to construct a mealy process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(std::string pName,
+    typename mealy<IT,ST,OT>::gamma_functype gamma,
+    typename mealy<IT,ST,OT>::ns_inplace_functype _ns_inplace,
+    typename mealy<IT,ST,OT>::od_functype _od_func,
+    ST init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), gamma, _ns_inplace, _od_func, init_st);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 }
 
 }
@@ -20,6 +20,9 @@
  * abstract base process used in the discrete-time MoC.
  */
 
+#include <algorithm>
+#include <cstdint>
+
 #include "abst_ext.hpp"
 #include "abssemantics.hpp"
 
@@ -94,6 +97,30 @@ using out_port = DT_out<T>;
 //! Abstract semantics of a process in the DT MoC
 typedef ForSyDe::process dt_process;
 
+//! Consumes the absent tokens following the current one on all the ports
+/*! The DT processes which only forward the absent events (e.g., delay
+ * and fanout) use it to advance their local time over a gap at once.
+ * With FORSYDE_ABSENT_RLE, it returns the length of the shortest absent
+ * run being read from the channels bound to the ports, which is then
+ * forwarded as a single run. Otherwise it returns zero.
+ */
+template <class... Ports>
+inline size_t skip_absent_runs(Ports&... ports)
+{
+#ifdef FORSYDE_ABSENT_RLE
+    size_t k = SIZE_MAX;
+    absent_run_channel* runs[] = {dynamic_cast<absent_run_channel*>(ports[0])...};
+    for (auto r : runs)
+        k = r == NULL ? 0 : std::min(k, r->absent_run_left());
+    if (k == 0) return 0;
+    for (auto r : runs) r->skip_absent_run(k);
+    return k;
+#else
+    ((void)ports, ...);
+    return 0;
+#endif
+}
+
 }
 }
 
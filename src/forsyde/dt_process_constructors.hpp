@@ -24,9 +24,12 @@
 
 #include <functional>
 #include <tuple>
+#include <optional>
 
 #include "abst_ext.hpp"
 #include "dt_process.hpp"
+#include "token_stream.hpp"
+#include "async_sink.hpp"
 
 namespace ForSyDe
 {
@@ -64,9 +67,7 @@ public:
               init_val(init_val)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
+        add_arg("init_val", init_val);
 #endif
     }
     
@@ -79,24 +80,31 @@ private:
     
     // Inputs and output variables
     abst_ext<T>* val;
+    size_t skipped;
     
     //Implementing the abstract semantics
     void init()
     {
         val = new abst_ext<T>;
-        write_multiport(oport1, init_val);
+        // the initial token is restored with the signal
+        if (!is_restored()) write_multiport(oport1, init_val);
     }
     
     void prep()
     {
         *val = iport1.read();
+        // the rest of an absent run is forwarded at once
+        skipped = val->is_absent() ? skip_absent_runs(iport1) : 0;
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        if (skipped > 0)
+            write_absents_multiport<T>(oport1, skipped+1);
+        else
+            write_multiport(oport1, *val);
     }
     
     void clean()
@@ -141,10 +149,8 @@ public:
               init_val(init_val), ns(ns)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("ns", std::to_string(ns)));
+        add_arg("init_val", init_val);
+        add_arg("ns", ns);
 #endif
     }
     
@@ -158,25 +164,30 @@ private:
     
     // Inputs and output variables
     abst_ext<T>* val;
+    size_t skipped;
     
     //Implementing the abstract semantics
     void init()
     {
         val = new abst_ext<T>;
-        for (unsigned int i=0; i<ns; i++)
-            write_multiport(oport1, abst_ext<T>());
+        if (!is_restored()) write_absents_multiport<T>(oport1, ns);
     }
     
     void prep()
     {
         *val = iport1.read();
+        // the rest of an absent run is forwarded at once
+        skipped = val->is_absent() ? skip_absent_runs(iport1) : 0;
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        if (skipped > 0)
+            write_absents_multiport<T>(oport1, skipped+1);
+        else
+            write_multiport(oport1, *val);
     }
     
     void clean()
@@ -214,6 +225,10 @@ public:
                                 const ST&,
                                 const std::vector<abst_ext<IT>>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&,
+                                const std::vector<abst_ext<IT>>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::vector<abst_ext<OT>>&, 
                                 const ST&,
@@ -228,19 +243,40 @@ public:
            gamma_functype gamma,    ///< The input partitioning function
            ns_functype _ns_func,    ///< The next_state function
            od_functype _od_func,    ///< The output-decoding function
-           ST init_st               ///< Initial state
+           ST init_st,              ///< Initial state
+           bool const_rate=false    ///< Whether gamma always gives the same rate
           ) : dt_process(_name), gamma(gamma), _ns_func(_ns_func),
-              _od_func(_od_func), init_st(init_st)
+              _od_func(_od_func), init_st(init_st),
+              const_rate(const_rate)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("gamma",func_name+std::string("_gamma")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("gamma", "_gamma");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding function
+     * is applied before the update.
+     */
+    mealy(sc_module_name _name,    ///< The module name
+           gamma_functype gamma,    ///< The input partitioning function
+           ns_inplace_functype _ns_inplace,  ///< The in-place next_state function
+           od_functype _od_func,    ///< The output-decoding function
+           ST init_st,              ///< Initial state
+           bool const_rate=false    ///< Whether gamma always gives the same rate
+          ) : dt_process(_name), gamma(gamma), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st),
+              const_rate(const_rate)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("gamma", "_gamma");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -251,11 +287,15 @@ private:
     //! The functions passed to the process constructor
     gamma_functype gamma;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     
     // Initial value
     ST init_st;
     
+    // Whether the number of tokens to read is evaluated only once
+    bool const_rate;
+    
     // Input, output, current state, and next state variables
     std::vector<abst_ext<IT>> ivals;
     ST* stval;
@@ -278,26 +318,35 @@ private:
         tin = tout = k = 0;
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
+        // A constant partitioning is looked ahead once
+        if (const_rate) gamma(itoks, *stval);
     }
     
     void prep()
     {
         // Determine the number of event to be read
-        gamma(itoks, *stval);
-        // Read the input events
-        ivals.resize(itoks);
-        for (size_t i=0; i<itoks; i++)
-            ivals[i] = iport1.read();
+        if (!const_rate) gamma(itoks, *stval);
+        // Read the input events at once
+        iport1.read_n(ivals, itoks);
         // Update tin with the number of tokens read
         tin += itoks;
     }
     
     void exec()
     {
-        _ns_func(*nsval, *stval, ivals);
-        _od_func(ovals, *stval, ivals);
-        *stval = *nsval;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stval, ivals);
+            _ns_inplace(*stval, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsval, *stval, ivals);
+            _od_func(ovals, *stval, ivals);
+            std::swap(stval, nsval);
+        }
     }
     
     void prod()
@@ -306,8 +355,7 @@ private:
         k = std::max((int)tin-(int)tout-1, 0);
 
         // First write the required absent events to ensure casaulity
-        for (size_t i=0; i<k; i++)
-            write_multiport(oport1, abst_ext<OT>());
+        write_absents_multiport<OT>(oport1, k);
 
         // Then write out the result
         write_vec_multiport(oport1, ovals);
@@ -315,8 +363,8 @@ private:
         // Update tout with the total number of written tokens
         tout += (k+ovals.size());
         
-        // clean up the input and output vectors
-        ivals.clear();
+        // clean up the output vector, keeping its capacity
+        // (the input vector is resized in the next prep)
         ovals.clear();
     }
     
@@ -325,6 +373,11 @@ private:
         delete stval;
         delete nsval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval, tin, tout);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval, tin, tout);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -359,6 +412,10 @@ public:
                                 const TS&,
                                 const std::tuple<std::vector<abst_ext<TIs>>...>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(TS&,
+                                const std::tuple<std::vector<abst_ext<TIs>>...>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::tuple<std::vector<abst_ext<TOs>>...>&,
                                 const TS&,
@@ -378,14 +435,31 @@ public:
               _od_func(_od_func), init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding function
+     * is applied before the update.
+     */
+    mealyMN(const sc_module_name& _name,        ///< The module name
+            const gamma_functype& _gamma_func,  ///< The partitioning function
+            const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+            const od_functype& _od_func,        ///< The output-decoding function
+            const TS& init_st   ///< Initial state
+            ) : dt_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -396,6 +470,7 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     // Initial value
     TS init_st;
@@ -403,10 +478,14 @@ private:
     size_t itoks;
     
     // Input, output, current state, and next state variables
-    std::tuple<std::vector<abst_ext<TOs>>...>* ovals;
+    std::tuple<std::vector<abst_ext<TOs>>...> ovals;
     TS* stvals;
     TS* nsvals;
-    std::tuple<std::vector<abst_ext<TIs>>...>* ivals;
+    std::tuple<std::vector<abst_ext<TIs>>...> ivals;
+    // The storage of the states (the next state is only kept for a
+    // next-state function which is not in-place)
+    TS stbuf;
+    std::optional<TS> nsbuf;
 
     // The current input/output time
     std::array<size_t, sizeof...(TOs)> ks;
@@ -419,11 +498,9 @@ private:
         tin = 0;
         std::fill_n(touts.begin(), sizeof...(TOs), 0);
         std::fill_n(ks.begin(), sizeof...(TOs), 0);
-        ovals = new std::tuple<std::vector<abst_ext<TOs>>...>;
-        stvals = new TS;
+        stvals = &stbuf;
         *stvals = init_st;
-        nsvals = new TS;
-        ivals = new std::tuple<std::vector<abst_ext<TIs>>...>;
+        nsvals = _ns_inplace ? NULL : &nsbuf.emplace();
     }
     
     void prep()
@@ -433,7 +510,7 @@ private:
         // Size the input and output buffers
         std::apply([&](auto&... ival) {
             (ival.resize(itoks), ...);
-        }, *ivals);
+        }, ivals);
         // Read the input tokens
         std::apply([&](auto&... inport) {
             std::apply([&](auto&... ival) {
@@ -443,7 +520,7 @@ private:
                             *it = inport.read();
                     }()
                 , ...);
-            }, *ivals);
+            }, ivals);
         }, iport);
         // update tin with the number of tokens read
         tin += itoks;
@@ -451,9 +528,18 @@ private:
     
     void exec()
     {
-        _ns_func(*nsvals, *stvals, *ivals);
-        _od_func(*ovals, *stvals, *ivals);
-        *stvals = *nsvals;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stvals, ivals);
+            _ns_inplace(*stvals, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsvals, *stvals, ivals);
+            _od_func(ovals, *stvals, ivals);
+            std::swap(stvals, nsvals);
+        }
     }
     
     void prod()
@@ -463,44 +549,31 @@ private:
             ks[i] = std::max((int)tin-(int)touts[i]-1, 0);
 
         // First write the required absent events to ensure casaulity
-        std::apply([&](auto&... oport) {
-            std::apply([&](auto&&... val){
-                size_t n{0};
-                (
-                    [&oport,&val,&n,this](){
-                        for (size_t i=0;i<ks[n];i++)
-                        {   
-                            using T = std::decay_t<decltype(val[0])>;
-                            write_multiport(oport, T());
-                        }
-                        n++;
-                    }()
-                , ...);
-            }, *ovals);
+        std::apply([&](auto&... port) {
+            size_t n{0};
+            (write_absents_multiport<TOs>(port, ks[n++]), ...);
         }, oport);
         // Then write out the result
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
                 (write_vec_multiport(port, val), ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
 
         // Update tout with the total number of written tokens
         std::apply([&](auto&&... val){
             size_t n{0};
-            ((touts[n] += (ks[n]+val.size())), ...);
-            n++;
+            ((touts[n] += ks[n]+val.size(), n++), ...);
             (val.clear(), ...);
-        }, *ovals);
+        }, ovals);
     }
     
-    void clean()
-    {
-        delete ivals;
-        delete ovals;
-        delete stvals;
-        delete nsvals;
-    }
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stvals, tin, touts);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stvals, tin, touts);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -543,7 +616,7 @@ private:
  * This class can directly be instantiated to build a process.
  */
 template <class T>
-class constant : public dt_process
+class constant : public dt_process, public constant_source
 {
 public:
     DT_out<T> oport1;            ///< port for the output channel
@@ -560,17 +633,16 @@ public:
                  
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DT::constant";}
+
+    //! Checks if the process produces its tokens forever
+    bool is_endless() const {return take == 0;}
     
 private:
     abst_ext<T> init_val;
@@ -599,6 +671,11 @@ private:
     
     void clean() {}
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -636,15 +713,9 @@ public:
               init_st(init_val), take(take), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
@@ -667,7 +738,7 @@ private:
     {
         cur_st = new abst_ext<T>;
         *cur_st = init_st;
-        write_multiport(oport1, *cur_st);
+        if (!is_restored()) write_multiport(oport1, *cur_st);
         if (take==0) infinite = true;
         tok_cnt = 1;
     }
@@ -691,6 +762,11 @@ private:
         delete cur_st;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *cur_st, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *cur_st, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -722,9 +798,7 @@ public:
             ) : dt_process(_name), in_vec(in_vec)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << in_vec;
-        arg_vec.push_back(std::make_tuple("in_vec", ss.str()));
+        add_arg("in_vec", in_vec);
 #endif
     }
     
@@ -750,19 +824,127 @@ private:
     
     void prod()
     {
-        if (std::get<0>(*it) > local_time)
-            write_multiport(oport1, abst_ext<T>());
-        else
+        // the state is updated before writing, since the token of a
+        // blocked write is kept by the signal
+        if (it == in_vec.end())
         {
-            write_multiport(oport1, std::get<1>(*it));
-            if (it != in_vec.end()-1) it++; else wait();
+            wait();
+            return;
         }
-            
-        local_time++;
+        // the gap up to the next value is written at once
+        const size_t gap = std::get<0>(*it) > local_time ?
+                           std::get<0>(*it) - local_time : 0;
+        const T& val = std::get<1>(*it++);
+        local_time += gap+1;
+        write_absents_multiport<T>(oport1, gap);
+        write_multiport(oport1, val);
+        if (it == in_vec.end()) wait();
     }
     
     void clean() {}
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, std::uint64_t(it - in_vec.begin()), local_time);
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t i;
+        restore_values(pos, i, local_time);
+        it = in_vec.begin() + i;
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a source process with streamed input
+/*! This class is used to build a souce process which only has an output.
+ * It outputs the (time, value) pairs of a token_stream, like vsource does
+ * for the pairs of a vector. The pairs are pulled from the stream in
+ * chunks, hence the stimulus is never kept in the memory as a whole.
+ */
+template <class T>
+class stream_source : public dt_process
+{
+public:
+    DT_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the result using the output
+     * port.
+     */
+    stream_source(sc_module_name _name,                                    ///< The module name
+                  std::shared_ptr<token_stream<std::tuple<size_t,T>>> stream  ///< the (time, value) stream
+                  ) : dt_process(_name), reader(stream)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("stream", reader.describe()));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DT::stream_source";}
+    
+private:
+    stream_reader<std::tuple<size_t,T>> reader;
+    size_t local_time;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!reader.good())
+            SC_REPORT_ERROR(name(),"cannot read the stream.");
+        if (!reader.seek(0))
+            SC_REPORT_ERROR(name(),"the stream can not be rewound.");
+        local_time = 0;
+    }
+    
+    void prep() {}
+    
+    void exec() {}
+    
+    void prod()
+    {
+        // the state is updated before writing, since the token of a
+        // blocked write is kept by the signal
+        auto next = reader.next();
+        if (!next)
+        {
+            wait();
+            return;
+        }
+        // the gap up to the next value is written at once
+        const size_t gap = std::get<0>(*next) > local_time ?
+                           std::get<0>(*next) - local_time : 0;
+        local_time += gap+1;
+        write_absents_multiport<T>(oport1, gap);
+        write_multiport(oport1, std::get<1>(*next));
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, std::uint64_t(reader.position()), local_time);
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t i;
+        restore_values(pos, i, local_time);
+        if (!reader.seek(i))
+            SC_REPORT_ERROR(name(),"the stream can not be moved to the checkpoint.");
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -796,12 +978,20 @@ public:
             
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
+    //! Runs the function in a background thread instead of the simulation thread
+    /*! The tokens are passed to the thread through a bounded queue with
+     * the given capacity and policy (see async_consumer). It should be
+     * called before the simulation starts.
+     */
+    void set_async(size_t capacity=1024, async_backpressure policy=ASYNC_BLOCK)
+    {
+        async.reset(new async_consumer<abst_ext<T>>(this->name(), _func, capacity, policy));
+    }
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DT::sink";}
     
@@ -810,6 +1000,9 @@ private:
 
     //! The function passed to the process constructor
     functype _func;
+
+    // the background consumer of the tokens, if any
+    std::unique_ptr<async_consumer<abst_ext<T>>> async;
     
     //Implementing the abstract semantics
     void init()
@@ -824,13 +1017,17 @@ private:
     
     void exec()
     {
-        _func(*val);
+        if (async)
+            async->push(*val);
+        else
+            _func(*val);
     }
     
     void prod() {}
     
     void clean()
     {
+        if (async) async->flush();
         delete val;
     }
     
@@ -942,10 +1139,8 @@ private:
     void prod()
     {
         // write sufficient absent events to the output to ensure causality
-        for (size_t i=0;i<itoks-1;i++)
-            write_multiport(oport1,
-                abst_ext<std::tuple<std::vector<abst_ext<T1>>,std::vector<abst_ext<T2>>>>()
-            );
+        write_absents_multiport<std::tuple<std::vector<abst_ext<T1>>,std::vector<abst_ext<T2>>>>(
+            oport1, itoks-1);
         
         // Write the zipped output
         write_multiport(oport1,std::make_tuple(ival1,ival2));
@@ -994,9 +1189,7 @@ public:
         iport2("iport2"), iport3("iport3"), oport1("oport1"), gamma(gamma)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("gamma",func_name+std::string("_gamma")));
+        add_func_arg("gamma", "_gamma");
 #endif
     }
     
@@ -1046,10 +1239,8 @@ private:
     void prod()
     {
         // write sufficient absent events to the output to ensure causality
-        for (size_t i=0;i<itoks-1;i++)
-            write_multiport(oport1,
-                abst_ext<std::tuple<std::vector<abst_ext<T1>>,std::vector<abst_ext<T2>>>>()
-            );
+        write_absents_multiport<std::tuple<std::vector<abst_ext<T1>>,std::vector<abst_ext<T2>>>>(
+            oport1, itoks-1);
         // Write the zipped output
         write_multiport(oport1,std::make_tuple(ival1,ival2));
     }
@@ -1097,9 +1288,7 @@ public:
     ):  dt_process(_name), gamma(gamma), iport2("iport2"), oport1("oport1")
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("gamma",func_name+std::string("_gamma")));
+        add_func_arg("gamma", "_gamma");
 #endif
     }
 
@@ -1199,6 +1388,7 @@ public:
 private:
     // intermediate values
     abst_ext<std::tuple<abst_ext<T1>,abst_ext<T2>>>* in_val;
+    size_t skipped;
     
     void init()
     {
@@ -1208,6 +1398,8 @@ private:
     void prep()
     {
         *in_val = iport1.read();
+        // the rest of an absent run is forwarded at once
+        skipped = in_val->is_absent() ? skip_absent_runs(iport1) : 0;
     }
     
     void exec() {}
@@ -1216,8 +1408,8 @@ private:
     {
         if (in_val->is_absent())
         {
-            write_multiport(oport1,abst_ext<T1>());  // write to the output 1
-            write_multiport(oport2,abst_ext<T2>());  // write to the output 2
+            write_absents_multiport<T1>(oport1, skipped+1);  // write to the output 1
+            write_absents_multiport<T2>(oport2, skipped+1);  // write to the output 2
         }
         else
         {
@@ -1395,9 +1587,15 @@ public:
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "DT::fanout";}
     
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Passes the input tokens on to the outputs without running the process
+    void start_of_simulation() {bypass_fanout(iport1, oport1);}
+#endif
+    
 private:
     // Inputs and output variables
     abst_ext<T>* val;
+    size_t skipped;
     
     //Implementing the abstract semantics
     void init()
@@ -1408,13 +1606,18 @@ private:
     void prep()
     {
         *val = iport1.read();
+        // the rest of an absent run is forwarded at once
+        skipped = val->is_absent() ? skip_absent_runs(iport1) : 0;
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        if (skipped > 0)
+            write_absents_multiport<T>(oport1, skipped+1);
+        else
+            write_multiport(oport1, *val);
     }
     
     void clean()
@@ -24,6 +24,7 @@
 
 #include <functional>
 #include <tuple>
+#include <optional>
 
 #include "abst_ext.hpp"
 #include "dt_process.hpp"
@@ -59,6 +60,10 @@ public:
                                 const ST&,
                                 const std::vector<IT>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&,
+                                const std::vector<IT>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::vector<OT>&, 
                                 const ST&,
@@ -73,19 +78,40 @@ public:
            gamma_functype gamma,    ///< The input partitioning function
            ns_functype _ns_func,    ///< The next_state function
            od_functype _od_func,    ///< The output-decoding function
-           ST init_st               ///< Initial state
+           ST init_st,              ///< Initial state
+           bool const_rate=false    ///< Whether gamma always gives the same rate
           ) : dt_process(_name), gamma(gamma), _ns_func(_ns_func),
-              _od_func(_od_func), init_st(init_st)
+              _od_func(_od_func), init_st(init_st),
+              const_rate(const_rate)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("gamma", "_gamma");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding function
+     * is applied before the update.
+     */
+    mealy(sc_module_name _name,    ///< The module name
+           gamma_functype gamma,    ///< The input partitioning function
+           ns_inplace_functype _ns_inplace,  ///< The in-place next_state function
+           od_functype _od_func,    ///< The output-decoding function
+           ST init_st,              ///< Initial state
+           bool const_rate=false    ///< Whether gamma always gives the same rate
+          ) : dt_process(_name), gamma(gamma), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st),
+              const_rate(const_rate)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("gamma",func_name+std::string("_gamma")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("gamma", "_gamma");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -96,11 +122,15 @@ private:
     //! The functions passed to the process constructor
     gamma_functype gamma;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     
     // Initial value
     ST init_st;
     
+    // Whether the number of tokens to read is evaluated only once
+    bool const_rate;
+    
     // Input, output, current state, and next state variables
     std::vector<IT> ivals;
     ST* stval;
@@ -123,30 +153,36 @@ private:
         tin = tout = k = 0;
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
+        // A constant partitioning is looked ahead once
+        if (const_rate) gamma(itoks, *stval);
     }
     
     void prep()
     {
         // Determine the number of event to be read
-        gamma(itoks, *stval);
+        if (!const_rate) gamma(itoks, *stval);
         // Read the input events
         ivals.clear();
-        for (size_t i=0; i<itoks; i++)
-        {
-            auto tmp = iport1.read();
-            if (is_present(tmp))
-                ivals.push_back(unsafe_from_abst_ext(tmp));
-        }
+        iport1.read_present(ivals, itoks);
         // Update tin with the number of tokens read
         tin += itoks;
     }
     
     void exec()
     {
-        _ns_func(*nsval, *stval, ivals);
-        _od_func(ovals, *stval, ivals);
-        *stval = *nsval;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stval, ivals);
+            _ns_inplace(*stval, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsval, *stval, ivals);
+            _od_func(ovals, *stval, ivals);
+            std::swap(stval, nsval);
+        }
     }
     
     void prod()
@@ -155,8 +191,7 @@ private:
         k = std::max((int)tin-(int)tout-1, 0);
 
         // First write the required absent events to ensure casaulity
-        for (size_t i=0; i<k; i++)
-            write_multiport(oport1, abst_ext<OT>());
+        write_absents_multiport<OT>(oport1, k);
 
         // Then write out the result
         write_vec_multiport(oport1, ovals);
@@ -164,8 +199,8 @@ private:
         // Update tout with the total number of written tokens
         tout += (k+ovals.size());
         
-        // clean up the input and output vectors
-        ivals.clear();
+        // clean up the output vector, keeping its capacity
+        // (the input vector is cleared in the next prep)
         ovals.clear();
     }
     
@@ -174,6 +209,11 @@ private:
         delete stval;
         delete nsval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval, tin, tout);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval, tin, tout);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -208,6 +248,10 @@ public:
                                 const TS&,
                                 const std::tuple<std::vector<TIs>...>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(TS&,
+                                const std::tuple<std::vector<TIs>...>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::tuple<std::vector<TOs>...>&,
                                 const TS&,
@@ -227,14 +271,31 @@ public:
               _od_func(_od_func), init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding function
+     * is applied before the update.
+     */
+    mealyMN(const sc_module_name& _name,        ///< The module name
+            const gamma_functype& _gamma_func,  ///< The partitioning function
+            const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+            const od_functype& _od_func,        ///< The output-decoding function
+            const TS& init_st                   ///< Initial state
+            ) : dt_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -245,6 +306,7 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     // Initial value
     TS init_st;
@@ -252,10 +314,14 @@ private:
     size_t itoks;
     
     // Input, output, current state, and next state variables
-    std::tuple<std::vector<TOs>...>* ovals;
+    std::tuple<std::vector<TOs>...> ovals;
     TS* stvals;
     TS* nsvals;
-    std::tuple<std::vector<TIs>...>* ivals;
+    std::tuple<std::vector<TIs>...> ivals;
+    // The storage of the states (the next state is only kept for a
+    // next-state function which is not in-place)
+    TS stbuf;
+    std::optional<TS> nsbuf;
 
     // The current input/output time
     std::array<size_t, sizeof...(TOs)> ks;
@@ -268,11 +334,9 @@ private:
         tin = 0;
         std::fill_n(touts.begin(), sizeof...(TOs), 0);
         std::fill_n(ks.begin(), sizeof...(TOs), 0);
-        ovals = new std::tuple<std::vector<TOs>...>;
-        stvals = new TS;
+        stvals = &stbuf;
         *stvals = init_st;
-        nsvals = new TS;
-        ivals = new std::tuple<std::vector<TIs>...>;
+        nsvals = _ns_inplace ? NULL : &nsbuf.emplace();
     }
     
     void prep()
@@ -282,21 +346,16 @@ private:
         // Size the input and output buffers
         std::apply([&](auto&... ival) {
             (ival.clear(), ...);
-        }, *ivals);
+        }, ivals);
         // Read the input tokens
         std::apply([&](auto&... inport) {
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport,this](){
-                        for (size_t i=0; i<itoks; i++)
-                        {
-                            auto tmp = inport.read();
-                            if (is_present(tmp))
-                                ival.push_back(unsafe_from_abst_ext(tmp));
-                        }
+                        inport.read_present(ival, itoks);
                     }()
                 , ...);
-            }, *ivals);
+            }, ivals);
         }, iport);
         // update tin with the number of tokens read
         tin += itoks;
@@ -304,9 +363,18 @@ private:
     
     void exec()
     {
-        _ns_func(*nsvals, *stvals, *ivals);
-        _od_func(*ovals, *stvals, *ivals);
-        *stvals = *nsvals;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stvals, ivals);
+            _ns_inplace(*stvals, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsvals, *stvals, ivals);
+            _od_func(ovals, *stvals, ivals);
+            std::swap(stvals, nsvals);
+        }
     }
     
     void prod()
@@ -321,40 +389,35 @@ private:
                 size_t n{0};
                 (
                     [&oport,&val,&n,this](){
-                        for (size_t i=0;i<ks[n];i++)
-                        {   
-                            using T = std::decay_t<decltype(val[0])>;
-                            write_multiport(oport, abst_ext<T>());
-                        }
+                        using T = std::decay_t<decltype(val[0])>;
+                        write_absents_multiport<T>(oport, ks[n]);
                         n++;
                     }()
                 , ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
         
         // Then write out the result
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
                 (write_vec_multiport(port, val), ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
 
         // Update tout with the total number of written tokens
         std::apply([&](auto&&... val){
             size_t n{0};
-            ((touts[n] += (ks[n]+val.size())), ...);
-            n++;
+            ((touts[n] += ks[n]+val.size(), n++), ...);
             (val.clear(), ...);
-        }, *ovals);
+        }, ovals);
     }
     
-    void clean()
-    {
-        delete ivals;
-        delete ovals;
-        delete stvals;
-        delete nsvals;
-    }
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stvals, tin, touts);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stvals, tin, touts);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -12,8 +12,8 @@
     * License: BSD3                                                   *
     *******************************************************************/
 
-#ifndef DT_PROCESS_CONSTRUCTORS_P_HPP
-#define DT_PROCESS_CONSTRUCTORS_P_HPP
+#ifndef DT_PROCESS_CONSTRUCTORS_T_HPP
+#define DT_PROCESS_CONSTRUCTORS_T_HPP
 
 /*! \file dt_process_constructors.hpp
  * \brief Implements the basic process constructors in the DT MoC with event count and timeout
@@ -34,7 +34,7 @@ namespace ForSyDe
 namespace DT
 {
 
-namespace S
+namespace T
 {
 
 using namespace sc_core;
@@ -59,6 +59,10 @@ public:
                                 const ST&,
                                 const std::vector<IT>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&,
+                                const std::vector<IT>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::vector<OT>&, 
                                 const ST&,
@@ -78,14 +82,31 @@ public:
               _od_func(_od_func), init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("gamma",func_name+std::string("_gamma")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("gamma", "_gamma");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding function
+     * is applied before the update.
+     */
+    mealy(sc_module_name _name,    ///< The module name
+           gamma_functype gamma,    ///< The input partitioning function
+           ns_inplace_functype _ns_inplace,  ///< The in-place next_state function
+           od_functype _od_func,    ///< The output-decoding function
+           ST init_st               ///< Initial state
+          ) : dt_process(_name), gamma(gamma), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("gamma", "_gamma");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -96,6 +117,7 @@ private:
     //! The functions passed to the process constructor
     gamma_functype gamma;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     
     // Initial value
@@ -124,7 +146,7 @@ private:
         tin = tout = k = 0;
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
     }
     
     void prep()
@@ -133,23 +155,27 @@ private:
         gamma(itoks, timeout, *stval);
         // Read the input events
         ivals.clear();
-        for (size_t i=0; i<itoks && i<timeout; i++)
-        {
-            auto tmp = iport1.read();
-            if (is_present(tmp))
-                ivals.push_back(unsafe_from_abst_ext(tmp));
-            else
-                itoks++;    // read one more token for each absent event
-        }
+        // read one more token for each absent event
+        const size_t taken = iport1.read_present_until(ivals, itoks, timeout);
+        itoks += taken - ivals.size();
         // Update tin with the number of tokens read
         tin += itoks;
     }
     
     void exec()
     {
-        _ns_func(*nsval, *stval, ivals);
-        _od_func(ovals, *stval, ivals);
-        *stval = *nsval;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stval, ivals);
+            _ns_inplace(*stval, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsval, *stval, ivals);
+            _od_func(ovals, *stval, ivals);
+            std::swap(stval, nsval);
+        }
     }
     
     void prod()
@@ -158,8 +184,7 @@ private:
         k = std::max((int)tin-(int)tout-1, 0);
 
         // First write the required absent events to ensure casaulity
-        for (size_t i=0; i<k; i++)
-            write_multiport(oport1, abst_ext<OT>());
+        write_absents_multiport<OT>(oport1, k);
 
         // Then write out the result
         write_vec_multiport(oport1, ovals);
@@ -167,8 +192,8 @@ private:
         // Update tout with the total number of written tokens
         tout += (k+ovals.size());
         
-        // clean up the input and output vectors
-        ivals.clear();
+        // clean up the output vector, keeping its capacity
+        // (the input vector is cleared in the next prep)
         ovals.clear();
     }
     
@@ -177,6 +202,11 @@ private:
         delete stval;
         delete nsval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval, tin, tout);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval, tin, tout);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -0,0 +1,529 @@
+/**********************************************************************
+    * elab_optimizer.hpp -- Simplifying process networks after the    *
+    *                       elaboration                               *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Removing the processes whose results are never used    *
+    *          and folding the constant computations before the       *
+    *          simulation starts                                      *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ELAB_OPTIMIZER_HPP
+#define ELAB_OPTIMIZER_HPP
+
+/*! \file elab_optimizer.hpp
+ * \brief Implements an optimizer of the elaborated process networks
+ *
+ *  The models generated by tools often contain constants feeding
+ * combinational processes and sinks with empty functions which only
+ * terminate the unused signals. This file includes an opt-in pass which
+ * simplifies such a network once it is elaborated:
+ *
+ *     elab_optimizer opt("opt", &top);
+ *     opt.mark_pure(scale);       // its function has no side effects
+ *     opt.mark_pure(drop);        // an empty sink
+ *     opt.mark_identity(pass);    // copies its input to its output
+ *
+ *  The processes stay in the module hierarchy, so that the introspection
+ * backends still report the original structure, but the optimized ones
+ * are never executed by their own threads.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <iostream>
+
+#include "abssemantics.hpp"
+#include "sdf_process.hpp"
+#ifndef FORSYDE_NO_CT
+#include "ct_filter_bank.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! An optimizer which simplifies a process network after the elaboration
+/*! This module collects the ForSyDe processes below a given module in
+ * the hierarchy (or the ones explicitly added) and applies three passes
+ * to them at the end of the elaboration:
+ *  - Dead-process elimination: a connected part of the network which
+ *    only consists of side-effect free processes is never executed. The
+ *    constants, delays, fanouts, zips and unzips are free of side effects
+ *    and the rest of the processes (e.g., the sinks with empty functions)
+ *    should be marked using mark_pure.
+ *  - Constant folding: a pure combinational process (comb, comb2, ..
+ *    and their strict versions in SY, comb, .., comb4 in SDF) whose
+ *    inputs are all produced by endless constants or by other folded
+ *    processes is executed once, and afterwards only repeats its outputs.
+ *    The constants and the processes feeding only the folded ones are
+ *    executed as many times as needed for the first firings.
+ *  - Identity collapse: the input signal of a process marked using
+ *    mark_identity writes its tokens directly to the outputs of the
+ *    process, as in the fanout bypass. It requires FORSYDE_FANOUT_BYPASS,
+ *    otherwise the identity processes are kept.
+ *  - Filter batching: the native fixed-step CT filters (native_filterf)
+ *    of the same order and sampling period, none of which depends on
+ *    the outputs of another, are solved together by a CT::filterf_bank
+ *    in a single thread.
+ *
+ * The folding and the identity collapse are only sound if the marked
+ * functions are pure, i.e., their outputs only depend on their current
+ * inputs. The optimized processes should not be driven by other
+ * executors, reset, or checkpointed.
+ */
+class elab_optimizer : public sc_module
+{
+public:
+    //! The constructor requires the module name and the root of the network
+    /*! All the ForSyDe processes below the root module in the hierarchy
+     * are considered, unless some processes are added explicitly using
+     * add().
+     */
+    elab_optimizer(sc_module_name _name,       ///< The module name
+                   sc_module* root=NULL        ///< The root of the network
+                   ) : sc_module(_name), root(root)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the optimized network
+    void add(ForSyDe::process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! Declares that the function of a process has no side effects
+    void mark_pure(ForSyDe::process* p)
+    {
+        pure.insert(p);
+    }
+
+    //! Declares that a pure process copies its only input to its outputs
+    void mark_identity(ForSyDe::process* p)
+    {
+        pure.insert(p);
+        identity.insert(p);
+    }
+
+    //! The processes which are never executed
+    const std::vector<ForSyDe::process*>& removed() const {return dead;}
+
+    //! The processes which are executed once and then repeat their outputs
+    const std::vector<ForSyDe::process*>& folded() const {return replayed;}
+
+    //! The processes which are executed a fixed number of times at the start
+    const std::vector<ForSyDe::process*>& consumed() const {return once;}
+
+    //! The identity processes whose inputs are passed to their outputs
+    const std::vector<ForSyDe::process*>& collapsed() const {return bypassed;}
+
+#ifndef FORSYDE_NO_CT
+    //! The groups of filters which are solved together
+    const std::vector<std::unique_ptr<CT::filterf_bank<CTTYPE>>>& filter_banks() const {return banks;}
+#endif
+
+    //! Prints the outcome of the passes
+    void print_report(std::ostream& os=std::cout) const
+    {
+        os << "Elaboration optimizer " << name() << ": " << procs.size()
+           << " processes, " << dead.size() << " removed, "
+           << replayed.size() + once.size() << " folded, "
+           << bypassed.size() << " collapsed";
+#ifndef FORSYDE_NO_CT
+        os << ", " << banks.size() << " filter banks";
+#endif
+        os << std::endl;
+        for (auto p : dead) os << "  removed   " << p->name() << std::endl;
+        for (auto p : once) os << "  folded    " << p->name() << std::endl;
+        for (auto p : replayed) os << "  replayed  " << p->name() << std::endl;
+        for (auto p : bypassed) os << "  collapsed " << p->name() << std::endl;
+#ifndef FORSYDE_NO_CT
+        for (size_t i=0; i<banks.size(); i++)
+            for (auto f : banks[i]->members())
+                os << "  bank " << i << "    " << f->name() << std::endl;
+#endif
+    }
+
+    //! The optimizer is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_elab_optimizer";}
+
+private:
+    SC_HAS_PROCESS(elab_optimizer);
+
+    sc_module* root;
+    std::vector<ForSyDe::process*> procs;
+    std::set<ForSyDe::process*> pure, identity;
+
+    // The outcome of the passes
+    std::vector<ForSyDe::process*> dead, replayed, once, bypassed;
+    // The firings of the folded processes before they repeat their outputs
+    std::map<ForSyDe::process*,size_t> firings;
+
+    // The input and output channels of the processes and their ends
+    std::map<ForSyDe::process*,std::vector<sc_interface*>> ins, outs;
+    std::map<sc_interface*,ForSyDe::process*> writer;
+    std::map<sc_interface*,std::vector<ForSyDe::process*>> readers;
+#ifndef FORSYDE_NO_CT
+    std::vector<std::unique_ptr<CT::filterf_bank<CTTYPE>>> banks;
+#endif
+
+    //! Collects the ForSyDe processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        for (auto c : obj->get_child_objects())
+        {
+            if (auto p = dynamic_cast<ForSyDe::process*>(c))
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(c) != NULL)
+                collect(c);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        for (auto c : p->get_child_objects())
+            if (c->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! The tokens read or written by a process on a channel in each firing
+    static size_t rate_of(ForSyDe::process* p, sc_interface* ch, bool out)
+    {
+        if (auto sp = dynamic_cast<SDF::sdf_process*>(p))
+            for (auto& r : out ? sp->out_rates : sp->in_rates)
+                for (auto c : r.channels())
+                    if (c == ch) return r.toks;
+        return 1;
+    }
+
+    //! The name of the process constructor without the MoC
+    static std::string base_kind(ForSyDe::process* p)
+    {
+        const std::string kind = p->forsyde_kind();
+        const size_t sep = kind.find("::");
+        return sep == std::string::npos ? kind : kind.substr(sep+2);
+    }
+
+    //! Checks if a process is free of side effects
+    bool is_pure(ForSyDe::process* p) const
+    {
+        static const std::set<std::string> kinds = {"constant", "sconstant",
+            "delay", "delayn", "delayline", "sdelay", "sdelayn", "fanout",
+            "zip", "zipN", "zipX", "zips", "szip", "szipN", "szipX",
+            "unzip", "unzipN", "unzipX", "sunzip", "sunzipN", "sunzipX"};
+        return pure.count(p) || kinds.count(base_kind(p));
+    }
+
+    //! Checks if a process can be folded when its inputs are constant
+    bool is_foldable(ForSyDe::process* p) const
+    {
+        static const std::set<std::string> kinds = {"SY::comb", "SY::comb2",
+            "SY::comb3", "SY::memo_comb", "SY::scomb", "SY::scomb2",
+            "SY::scomb3", "SDF::comb", "SDF::comb2", "SDF::comb3",
+            "SDF::comb4", "SDF::memo_comb"};
+        return pure.count(p) && kinds.count(p->forsyde_kind());
+    }
+
+    //! Removes the connected parts of the network which have no side effects
+    void eliminate_dead(std::set<ForSyDe::process*>& gone)
+    {
+        // the connected parts, by a union-find over the channels
+        std::map<ForSyDe::process*,ForSyDe::process*> parent;
+        std::function<ForSyDe::process*(ForSyDe::process*)> find =
+            [&](ForSyDe::process* p)
+            {
+                while (parent[p] != p) p = parent[p] = parent[parent[p]];
+                return p;
+            };
+        for (auto p : procs) parent[p] = p;
+        std::set<ForSyDe::process*> open;
+        auto join = [&](sc_interface* ch, ForSyDe::process* p)
+        {
+            auto w = writer.find(ch);
+            auto r = readers.find(ch);
+            // a channel with an end outside of the network keeps its part
+            if (w == writer.end() || r == readers.end()) open.insert(p);
+            if (w != writer.end()) parent[find(p)] = find(w->second);
+            if (r != readers.end())
+                for (auto q : r->second) parent[find(p)] = find(q);
+        };
+        for (auto p : procs)
+        {
+            for (auto ch : ins[p]) join(ch, p);
+            for (auto ch : outs[p]) join(ch, p);
+        }
+        std::set<ForSyDe::process*> alive;
+        for (auto p : procs)
+            if (!is_pure(p) || open.count(p)) alive.insert(find(p));
+        for (auto p : procs)
+            if (!alive.count(find(p)))
+            {
+                dead.push_back(p);
+                gone.insert(p);
+                p->set_ext_driven();
+            }
+    }
+
+    //! Folds the pure processes whose inputs are constant
+    void fold_constants(std::set<ForSyDe::process*>& gone)
+    {
+        std::set<ForSyDe::process*> consts, fold;
+        for (auto p : procs)
+            if (auto c = dynamic_cast<constant_source*>(p))
+                if (c->is_endless() && !gone.count(p)) consts.insert(p);
+        auto is_const = [&](ForSyDe::process* p)
+        {
+            return consts.count(p) || fold.count(p);
+        };
+        auto fed_by_consts = [&](ForSyDe::process* p)
+        {
+            for (auto ch : ins[p])
+            {
+                auto w = writer.find(ch);
+                if (w == writer.end() || !is_const(w->second)) return false;
+            }
+            return !ins[p].empty();
+        };
+        // the candidates, added after their producers
+        std::vector<ForSyDe::process*> order;
+        for (bool changed = true; changed; )
+        {
+            changed = false;
+            for (auto p : procs)
+                if (!gone.count(p) && !fold.count(p) && is_foldable(p) && fed_by_consts(p))
+                {
+                    fold.insert(p);
+                    order.push_back(p);
+                    changed = true;
+                }
+        }
+        // a producer whose tokens are read by both folded and other
+        // processes would block on the channels of the folded ones
+        auto mixed = [&](ForSyDe::process* w)
+        {
+            bool in = false, out = false;
+            for (auto ch : outs[w])
+                for (auto r : readers[ch])
+                    (fold.count(r) ? in : out) = true;
+            return in && out;
+        };
+        for (bool changed = true; changed; )
+        {
+            changed = false;
+            for (auto p : order)
+            {
+                if (!fold.count(p)) continue;
+                bool keep = fed_by_consts(p);
+                for (auto ch : ins[p])
+                    if (keep && mixed(writer[ch])) keep = false;
+                if (!keep)
+                {
+                    fold.erase(p);
+                    changed = true;
+                }
+            }
+        }
+        order.erase(std::remove_if(order.begin(), order.end(),
+                        [&](ForSyDe::process* p){return !fold.count(p);}),
+                    order.end());
+        if (order.empty()) return;
+        // the firings of each process needed by the first firings of its readers
+        for (auto it=order.rbegin(); it!=order.rend(); it++)
+        {
+            ForSyDe::process* p = *it;
+            size_t& n = firings[p];
+            n = std::max<size_t>(n, 1);
+            for (auto ch : ins[p])
+            {
+                ForSyDe::process* w = writer[ch];
+                const size_t need = n * rate_of(p, ch, false);
+                const size_t prod = std::max<size_t>(rate_of(w, ch, true), 1);
+                firings[w] = std::max(firings[w], (need + prod - 1) / prod);
+            }
+        }
+        // the processes which only feed the folded ones are executed a
+        // fixed number of times and the rest repeat their outputs
+        std::vector<ForSyDe::process*> feeders;
+        for (auto p : consts)
+            if (firings.count(p)) feeders.push_back(p);
+        feeders.insert(feeders.end(), order.begin(), order.end());
+        for (auto p : feeders)
+        {
+            bool internal = true;
+            for (auto ch : outs[p])
+                for (auto r : readers[ch])
+                    if (!fold.count(r)) internal = false;
+            (internal ? once : replayed).push_back(p);
+            gone.insert(p);
+            p->set_ext_driven();
+            // the internal channels hold all the tokens of the first firings
+            for (auto ch : outs[p])
+                if (internal)
+                    if (auto sc = dynamic_cast<static_channel*>(ch))
+                        sc->set_static_buffer(std::max<size_t>(firings[p] * rate_of(p, ch, true), 1));
+        }
+    }
+
+#ifndef FORSYDE_NO_CT
+    //! Groups the compatible fixed-step filters into banks
+    void batch_filters(std::set<ForSyDe::process*>& gone)
+    {
+        // the processes reached from the outputs of each filter
+        std::map<ForSyDe::process*,std::set<ForSyDe::process*>> reach;
+        std::vector<CT::basic_native_filterf<CTTYPE>*> cands;
+        for (auto p : procs)
+        {
+            if (gone.count(p) || p->forsyde_kind() != "CT::native_filterf") continue;
+            auto f = dynamic_cast<CT::basic_native_filterf<CTTYPE>*>(p);
+            if (f == NULL) continue;
+            cands.push_back(f);
+            std::set<ForSyDe::process*>& r = reach[p];
+            std::vector<ForSyDe::process*> stack(1, p);
+            while (!stack.empty())
+            {
+                auto q = stack.back();
+                stack.pop_back();
+                for (auto ch : outs[q])
+                    for (auto rd : readers[ch])
+                        if (r.insert(rd).second) stack.push_back(rd);
+            }
+        }
+        // a filter joins the first bank where it fits and does not
+        // depend on, or feed, the other filters, which would deadlock the
+        // thread of the bank
+        std::vector<std::unique_ptr<CT::filterf_bank<CTTYPE>>> groups;
+        for (auto f : cands)
+        {
+            bool placed = false;
+            for (auto& g : groups)
+            {
+                bool independent = true;
+                for (auto m : g->members())
+                    if (reach[f].count(m) || reach[m].count(f)) independent = false;
+                if (independent && g->add(f))
+                {
+                    placed = true;
+                    break;
+                }
+            }
+            if (!placed)
+            {
+                groups.emplace_back(new CT::filterf_bank<CTTYPE>);
+                groups.back()->add(f);
+            }
+        }
+        for (auto& g : groups)
+        {
+            if (g->size() < 2) continue;
+            g->take_over();
+            for (auto m : g->members()) gone.insert(m);
+            banks.push_back(std::move(g));
+        }
+    }
+#endif
+
+    //! Classifies the processes and applies the passes
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        for (auto p : procs)
+        {
+            ins[p] = channels(p, "sc_fifo_in");
+            outs[p] = channels(p, "sc_fifo_out");
+            for (auto ch : ins[p]) readers[ch].push_back(p);
+            for (auto ch : outs[p]) writer[ch] = p;
+        }
+        std::set<ForSyDe::process*> gone;
+        eliminate_dead(gone);
+        fold_constants(gone);
+#ifndef FORSYDE_NO_CT
+        batch_filters(gone);
+#endif
+        // the identity processes are collapsed when the simulation starts
+        for (auto p : procs)
+            if (identity.count(p) && !gone.count(p) && ins[p].size() != 1)
+                SC_REPORT_WARNING(name(), (std::string(p->name())
+                    + " is not collapsed since it does not have exactly one input").c_str());
+    }
+
+    //! Lets the inputs of the identity processes write to their outputs
+    void start_of_simulation()
+    {
+#ifdef FORSYDE_FANOUT_BYPASS
+        for (auto p : procs)
+        {
+            if (!identity.count(p) || p->is_ext_driven() || ins[p].size() != 1)
+                continue;
+            auto link = dynamic_cast<forwarding_link*>(ins[p][0]);
+            if (link != NULL && link->forward_to(outs[p]))
+            {
+                p->set_ext_driven();
+                bypassed.push_back(p);
+            }
+        }
+#endif
+    }
+
+    //! Runs the first firings of the folded processes
+    /*! The processes which feed other processes are then repeated by
+     * threads of their own, so that a blocked output does not hold the
+     * others back.
+     */
+    void worker()
+    {
+        std::vector<ForSyDe::process*> all(once);
+        all.insert(all.end(), replayed.begin(), replayed.end());
+        // the constants come first and the folded processes follow their
+        // producers, in both lists
+        std::stable_partition(all.begin(), all.end(), [](ForSyDe::process* p)
+        {
+            return dynamic_cast<constant_source*>(p) != NULL;
+        });
+        for (auto p : all) p->ext_init();
+        for (auto p : all)
+            for (size_t i=0; i<firings[p]; i++) p->ext_fire();
+        for (auto p : replayed)
+            sc_spawn([p]{while (1) p->ext_replay();});
+#ifndef FORSYDE_NO_CT
+        for (auto& b : banks)
+        {
+            auto bank = b.get();
+            sc_spawn([bank]{bank->run();});
+        }
+#endif
+    }
+};
+
+//! Helper function to construct an elaboration optimizer for a network
+/*! The processes are marked pure after the optimizer is constructed.
+ */
+inline elab_optimizer* make_elab_optimizer(const std::string& pName,  ///< the optimizer name
+    sc_module* root                                 ///< the root of the network
+    )
+{
+    return new elab_optimizer(pName.c_str(), root);
+}
+
+}
+
+#endif
@@ -0,0 +1,293 @@
+/**********************************************************************
+    * ensemble.hpp -- Ensembles of model instances in vector lanes    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Simulating many independent instances of a model in a  *
+    *          single elaborated process network                      *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ENSEMBLE_HPP
+#define ENSEMBLE_HPP
+
+/*! \file ensemble.hpp
+ * \brief Implements the lane vectors used to simulate model ensembles
+ *
+ *  A Monte-Carlo study simulates the same process network many times,
+ * with different seeds or parameters. Instead, the network can be
+ * elaborated once with the lane vector lanes<T,K> as the token type
+ * wherever it used T, so that each token carries the values of K
+ * independent instances of the model. The arithmetic operators of the
+ * lane vectors work lane by lane, hence the process functions written
+ * generically over their value types run over all the lanes in each
+ * firing, in loops which the compiler can vectorize:
+ *
+ *     auto gain = [](auto& out, const auto& inp)
+ *     {
+ *         out = inp * 0.5 + 1.0;
+ *     };
+ *     SY::make_scomb("gain", gain, outS, inpS);   // with lanes<double,8>
+ *
+ *  The functions with data-dependent control flow (e.g., the next-state
+ * functions of the Mealy machines) are lifted with per_lane, which calls
+ * the scalar function once for each lane. The lanes of a token share its
+ * presence, since all the instances run in the same evaluation cycles.
+ * The random sources of the ensembles (e.g., SY::ensemble_gaussian) give
+ * each lane the stream which a single-instance model with the seed of
+ * the lane would get, with the counter-based sources (see
+ * FORSYDE_COUNTER_RNG).
+ */
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+#include "abst_ext.hpp"
+
+namespace ForSyDe
+{
+
+//! The alignment of the arrays of the vectorized process constructors
+#ifndef FORSYDE_SIMD_ALIGN
+#define FORSYDE_SIMD_ALIGN 64
+#endif
+
+//! The values of K independent instances of a model
+/*! The arithmetic operators, with lane vectors or with scalars which
+ * are used in all the lanes, are applied lane by lane.
+ */
+template <typename T, std::size_t K>
+struct alignas(FORSYDE_SIMD_ALIGN) lanes
+{
+    typedef T value_type;
+
+    std::array<T,K> v;
+
+    //! The default constructor, with default-constructed values
+    lanes() : v() {}
+
+    //! Uses the same value in all the lanes
+    lanes(const T& val) {v.fill(val);}
+
+    //! Builds the vector from the values of the lanes
+    lanes(const std::array<T,K>& vals) : v(vals) {}
+
+    //! The number of lanes
+    static constexpr std::size_t size() {return K;}
+
+    T& operator[](std::size_t k) {return v[k];}
+    const T& operator[](std::size_t k) const {return v[k];}
+
+    T* begin() {return v.data();}
+    T* end() {return v.data()+K;}
+    const T* begin() const {return v.data();}
+    const T* end() const {return v.data()+K;}
+
+#define FORSYDE_LANES_COMPOUND(OP)                                          \
+    lanes& operator OP##=(const lanes& rs)                                  \
+    {                                                                       \
+        for (std::size_t k=0; k<K; k++) v[k] OP##= rs.v[k];                 \
+        return *this;                                                       \
+    }                                                                       \
+    lanes& operator OP##=(const T& rs)                                      \
+    {                                                                       \
+        for (std::size_t k=0; k<K; k++) v[k] OP##= rs;                      \
+        return *this;                                                       \
+    }
+    FORSYDE_LANES_COMPOUND(+)
+    FORSYDE_LANES_COMPOUND(-)
+    FORSYDE_LANES_COMPOUND(*)
+    FORSYDE_LANES_COMPOUND(/)
+#undef FORSYDE_LANES_COMPOUND
+
+    lanes operator-() const
+    {
+        lanes res;
+        for (std::size_t k=0; k<K; k++) res.v[k] = -v[k];
+        return res;
+    }
+
+    //! Two vectors are equal if all of their lanes are equal
+    bool operator==(const lanes& rs) const {return v == rs.v;}
+    bool operator!=(const lanes& rs) const {return v != rs.v;}
+
+    //! Overload the streaming operator to enable SystemC communiation
+    friend std::ostream& operator<<(std::ostream& os, const lanes& l)
+    {
+        os << "<";
+        for (std::size_t k=0; k<K; k++) os << (k ? "," : "") << l.v[k];
+        os << ">";
+        return os;
+    }
+};
+
+#define FORSYDE_LANES_BINARY(OP)                                            \
+template <typename T, std::size_t K>                                        \
+inline lanes<T,K> operator OP(const lanes<T,K>& ls, const lanes<T,K>& rs)   \
+{                                                                           \
+    lanes<T,K> res(ls);                                                     \
+    return res OP##= rs;                                                    \
+}                                                                           \
+template <typename T, std::size_t K>                                        \
+inline lanes<T,K> operator OP(const lanes<T,K>& ls, const T& rs)            \
+{                                                                           \
+    lanes<T,K> res(ls);                                                     \
+    return res OP##= rs;                                                    \
+}                                                                           \
+template <typename T, std::size_t K>                                        \
+inline lanes<T,K> operator OP(const T& ls, const lanes<T,K>& rs)            \
+{                                                                           \
+    lanes<T,K> res;                                                         \
+    for (std::size_t k=0; k<K; k++) res.v[k] = ls OP rs.v[k];               \
+    return res;                                                             \
+}
+FORSYDE_LANES_BINARY(+)
+FORSYDE_LANES_BINARY(-)
+FORSYDE_LANES_BINARY(*)
+FORSYDE_LANES_BINARY(/)
+#undef FORSYDE_LANES_BINARY
+
+//! Applies a function to the values of the same lane of several vectors
+/*! It is used for the operations which are not covered by the operators
+ * of the lane vectors, such as the mathematical functions or the
+ * branch-free selections:
+ *
+ *     y = lane_map([](double a, double b){return a > b ? a : b;}, y, lim);
+ */
+template <typename F, typename T, std::size_t K, typename... Ts>
+inline auto lane_map(F f, const lanes<T,K>& a, const lanes<Ts,K>&... as)
+    -> lanes<decltype(f(a[0], as[0]...)),K>
+{
+    lanes<decltype(f(a[0], as[0]...)),K> res;
+    for (std::size_t k=0; k<K; k++) res.v[k] = f(a.v[k], as.v[k]...);
+    return res;
+}
+
+//! Accessing the lanes of the arguments of the process functions
+/*! The lane vectors, the absent-extended lane vectors and the vectors of
+ * them (i.e., the arguments of the SY and SDF process functions) give
+ * the value of a single lane, and all the other types are used as is in
+ * all the lanes.
+ */
+template <typename A>
+struct lane_access
+{
+    static constexpr bool is_lane = false;
+    static const A& get(const A& a, std::size_t) {return a;}
+};
+
+template <typename T, std::size_t K>
+struct lane_access<lanes<T,K>>
+{
+    static constexpr bool is_lane = true;
+    static constexpr std::size_t width = K;
+    static T get(const lanes<T,K>& a, std::size_t k) {return a.v[k];}
+    static void put(lanes<T,K>& a, std::size_t k, const T& val) {a.v[k] = val;}
+};
+
+template <typename T, std::size_t K>
+struct lane_access<abst_ext<lanes<T,K>>>
+{
+    static constexpr bool is_lane = true;
+    static constexpr std::size_t width = K;
+    static abst_ext<T> get(const abst_ext<lanes<T,K>>& a, std::size_t k)
+    {
+        return a.is_present() ? abst_ext<T>(a.unsafe_from_abst_ext().v[k])
+                              : abst_ext<T>();
+    }
+    //! Writes a lane, the first one deciding the presence of the token
+    static void put(abst_ext<lanes<T,K>>& a, std::size_t k, const abst_ext<T>& val)
+    {
+        if (k == 0)
+        {
+            if (val.is_present())
+            {
+                lanes<T,K> vals = a.is_present() ? a.unsafe_from_abst_ext()
+                                                 : lanes<T,K>();
+                vals.v[0] = val.unsafe_from_abst_ext();
+                a = abst_ext<lanes<T,K>>(vals);
+            }
+            else
+                a = abst_ext<lanes<T,K>>();
+        }
+        else if (val.is_present())
+        {
+            lanes<T,K> vals = a.unsafe_from_abst_ext();
+            vals.v[k] = val.unsafe_from_abst_ext();
+            a = abst_ext<lanes<T,K>>(vals);
+        }
+    }
+};
+
+template <typename T, std::size_t K>
+struct lane_access<std::vector<lanes<T,K>>>
+{
+    static constexpr bool is_lane = true;
+    static constexpr std::size_t width = K;
+    static std::vector<T> get(const std::vector<lanes<T,K>>& a, std::size_t k)
+    {
+        std::vector<T> res(a.size());
+        for (std::size_t i=0; i<a.size(); i++) res[i] = a[i].v[k];
+        return res;
+    }
+    static void put(std::vector<lanes<T,K>>& a, std::size_t k, const std::vector<T>& val)
+    {
+        a.resize(val.size());
+        for (std::size_t i=0; i<val.size(); i++) a[i].v[k] = val[i];
+    }
+};
+
+//! Checks the presence of a lane against the first lane, if it applies
+template <typename A, typename V>
+inline bool check_lane(const A&, const V&) {return true;}
+
+template <typename T, std::size_t K>
+inline bool check_lane(const abst_ext<lanes<T,K>>& a, const abst_ext<T>& val)
+{
+    return a.is_present() == val.is_present();
+}
+
+//! Lifts a scalar process function to a function over the lane vectors
+/*! The result calls the given function once for each lane, with the
+ * values of the lane of its output (the first argument) and of its
+ * inputs, and writes back the output of the lane. It is the fallback for
+ * the functions whose control flow depends on the data (e.g., the
+ * next-state functions of the Mealy machines with data-dependent state),
+ * which can not run over all the lanes at once:
+ *
+ *     auto ns = per_lane([](int& st, const int& s, const abst_ext<double>& inp)
+ *     {
+ *         st = is_present(inp) && unsafe_from_abst_ext(inp) > 1.0 ? s+1 : 0;
+ *     });
+ *
+ *  The lanes of an absent-extended output should agree on its presence,
+ * which is checked.
+ */
+template <typename F>
+inline auto per_lane(F f)
+{
+    return [f](auto& out, const auto&... ins)
+    {
+        typedef lane_access<std::decay_t<decltype(out)>> acc;
+        static_assert(acc::is_lane, "the output of per_lane should be a lane vector");
+        for (std::size_t k=0; k<acc::width; k++)
+        {
+            auto o = acc::get(out, k);
+            f(o, lane_access<std::decay_t<decltype(ins)>>::get(ins, k)...);
+            if (k > 0 && !check_lane(out, o))
+                SC_REPORT_ERROR("per_lane", "the lanes of an output token differ in presence");
+            acc::put(out, k, o);
+        }
+    };
+}
+
+}
+
+#endif
@@ -0,0 +1,566 @@
+/**********************************************************************
+    * equivalence.hpp -- Equivalence of the optimized executions      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Checking that the optimized executors produce the same *
+    *          signals as the reference SystemC execution             *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SIGNAL_TRACE to use it                  *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef EQUIVALENCE_HPP
+#define EQUIVALENCE_HPP
+
+/*! \file equivalence.hpp
+ * \brief Implements the equivalence checks of the optimized executions
+ *
+ *  The executors and elaboration passes which take over the processes
+ * of a model (e.g., SDF::static_scheduler, SY::parallel_executor,
+ * SY::fuse, zip_fusion and native_kernel) should not change any token
+ * of any signal. This file includes a checker which records a number of
+ * signals in a reference run and, in the other runs, compares every
+ * token written to them with the reference as soon as it is written,
+ * and a driver which runs the same model once per execution mode, each
+ * in a child process forked before the elaboration:
+ *
+ *     auto res = run_equivalence({"reference", "static", "native"},
+ *         [](const std::string& mode, equivalence_check& chk)
+ *         {
+ *             auto t = new top("top");
+ *             chk.track(t->out, "out", tolerance(1e-12));
+ *             if (mode == "static") new SDF::static_scheduler("sched", t);
+ *             if (mode == "native") new native_kernel("native", t);
+ *         }, "top.trc");
+ *
+ *  The first mode is the reference one. A divergence is reported with
+ * the signal, the index of the token, the simulated time when it is
+ * written (and its time tag in the timed MoCs), the expected and the
+ * actual values, and the processes which write and read the signal. The
+ * checker can also be used directly, e.g., to compare the programs built
+ * with different compile-time options against the same reference trace.
+ */
+
+#include <string>
+#include <vector>
+#include <array>
+#include <tuple>
+#include <complex>
+#include <utility>
+#include <algorithm>
+#include <memory>
+#include <sstream>
+#include <iostream>
+#include <functional>
+#include <type_traits>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "abssemantics.hpp"
+#include "trace_recorder.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The tolerance of the floating point values compared with a reference
+/*! Two values a and b are the same if |a-b| <= abs + rel*max(|a|,|b|).
+ * The default tolerance requires identical values.
+ */
+struct tolerance
+{
+    double abs;     ///< the absolute tolerance
+    double rel;     ///< the relative tolerance
+
+    tolerance(double abs=0, double rel=0) : abs(abs), rel(rel) {}
+};
+
+//! Compares two values of a signal within a tolerance
+/*! The floating point numbers, and the ones inside the absent-extended
+ * values, complex numbers, vectors, arrays and tuples, are compared
+ * within the tolerance, and the rest of the values using operator==.
+ */
+template <typename T, typename Enable=void>
+struct approx_equal
+{
+    static bool equal(const T& a, const T& b, const tolerance&) {return a == b;}
+};
+
+template <typename T>
+struct approx_equal<T, typename std::enable_if<std::is_floating_point<T>::value>::type>
+{
+    static bool equal(const T& a, const T& b, const tolerance& tol)
+    {
+        if (a == b) return true;
+        if (std::isnan(a) || std::isnan(b)) return std::isnan(a) && std::isnan(b);
+        const double d = std::fabs(double(a) - double(b));
+        return d <= tol.abs + tol.rel * std::max(std::fabs(double(a)), std::fabs(double(b)));
+    }
+};
+
+template <typename T>
+struct approx_equal<std::complex<T>>
+{
+    static bool equal(const std::complex<T>& a, const std::complex<T>& b, const tolerance& tol)
+    {
+        return approx_equal<T>::equal(a.real(), b.real(), tol) &&
+               approx_equal<T>::equal(a.imag(), b.imag(), tol);
+    }
+};
+
+template <typename T>
+struct approx_equal<abst_ext<T>>
+{
+    static bool equal(const abst_ext<T>& a, const abst_ext<T>& b, const tolerance& tol)
+    {
+        if (a.is_absent() || b.is_absent()) return a.is_absent() && b.is_absent();
+        return approx_equal<T>::equal(a.unsafe_from_abst_ext(), b.unsafe_from_abst_ext(), tol);
+    }
+};
+
+template <typename T, typename A>
+struct approx_equal<std::vector<T,A>>
+{
+    static bool equal(const std::vector<T,A>& a, const std::vector<T,A>& b, const tolerance& tol)
+    {
+        if (a.size() != b.size()) return false;
+        for (size_t i=0; i<a.size(); i++)
+            if (!approx_equal<T>::equal(a[i], b[i], tol)) return false;
+        return true;
+    }
+};
+
+template <typename T, size_t N>
+struct approx_equal<std::array<T,N>>
+{
+    static bool equal(const std::array<T,N>& a, const std::array<T,N>& b, const tolerance& tol)
+    {
+        for (size_t i=0; i<N; i++)
+            if (!approx_equal<T>::equal(a[i], b[i], tol)) return false;
+        return true;
+    }
+};
+
+template <typename... Ts>
+struct approx_equal<std::tuple<Ts...>>
+{
+    static bool equal(const std::tuple<Ts...>& a, const std::tuple<Ts...>& b, const tolerance& tol)
+    {
+        return equal(a, b, tol, std::index_sequence_for<Ts...>());
+    }
+
+private:
+    template <size_t... Is>
+    static bool equal(const std::tuple<Ts...>& a, const std::tuple<Ts...>& b,
+                      const tolerance& tol, std::index_sequence<Is...>)
+    {
+        return (approx_equal<Ts>::equal(std::get<Is>(a), std::get<Is>(b), tol) && ...);
+    }
+};
+
+//! Prints a value of a signal, if it has an output operator
+template <typename T, typename Enable=void>
+struct value_printer
+{
+    static std::string print(const T&) {return "<unprintable>";}
+};
+
+template <typename T>
+struct value_printer<T, decltype(void(std::declval<std::ostream&>() << std::declval<const T&>()))>
+{
+    static std::string print(const T& v)
+    {
+        std::ostringstream oss;
+        oss.precision(17);
+        oss << v;
+        return oss.str();
+    }
+};
+
+//! The first token of a signal which differs from the reference
+struct divergence
+{
+    std::string signal;         ///< the name of the signal in the trace
+    size_t index;               ///< the index of the token
+    sc_time time;               ///< the simulated time when it is written
+    bool timed;                 ///< if the tokens have time tags
+    double tag, expected_tag;   ///< the time tags in seconds, if timed
+    std::string expected;       ///< the reference value, or <none> for an extra token
+    std::string actual;         ///< the written value, or <missing> for a missing token
+    std::string writers;        ///< the processes which write the signal
+    std::string readers;        ///< the processes which read the signal
+};
+
+//! Records signals in a reference run or compares them with the reference
+/*! A run is a recording run if the checker is constructed with record
+ * set. Otherwise, the reference trace is loaded at the end of the
+ * elaboration and each token written to a tracked signal is compared
+ * with the reference. The tokens missing at the end of the simulation
+ * are also reported. The comparison does not stop the simulation.
+ */
+class equivalence_check : public sc_module
+{
+public:
+    //! The constructor requires the module name and the reference trace
+    equivalence_check(sc_module_name _name,        ///< The module name
+                      const std::string& reference, ///< The trace of the reference run
+                      bool record=false            ///< Records the reference run
+                      ) : sc_module(_name), reference(reference), recording(record),
+                          finished(false) {}
+
+    //! Tracks a signal, which is recorded or compared with the reference
+    template <typename T, typename TokenType, template <class> class FifoType>
+    void track(ForSyDe::signal<T,TokenType,FifoType>& sig,  ///< the signal
+               const std::string& sig_name,                 ///< its name in the trace
+               const tolerance& tol=tolerance()             ///< the tolerance of its values
+               )
+    {
+        sigs.emplace_back(new tracked<T,TokenType,FifoType>(sig, sig_name, tol));
+    }
+
+    //! Checks if the run records the reference
+    bool is_recording() const {return recording;}
+
+    //! Closes the trace of a recording run or reports the missing tokens
+    /*! It is called at the end of the simulation, and should be called
+     * explicitly if the simulation is not stopped by sc_stop.
+     */
+    void finish()
+    {
+        if (finished) return;
+        finished = true;
+        if (is_recording())
+            rec.close();
+        else
+            for (auto& s : sigs) s->finish();
+    }
+
+    //! Checks if all the tokens written so far are the same as in the reference
+    bool passed() const
+    {
+        for (auto& s : sigs)
+            if (s->diverged) return false;
+        return true;
+    }
+
+    //! The earliest divergence in the simulated time, if any
+    const divergence* first_divergence() const
+    {
+        const divergence* res = NULL;
+        for (auto& s : sigs)
+            if (s->diverged && (res == NULL || s->first.time < res->time ||
+                (s->first.time == res->time && s->first.timed && res->timed &&
+                 s->first.tag < res->tag)))
+                res = &s->first;
+        return res;
+    }
+
+    //! The tokens compared with the reference
+    unsigned long long compared_tokens() const
+    {
+        unsigned long long n = 0;
+        for (auto& s : sigs) n += s->count;
+        return n;
+    }
+
+    //! Prints the outcome of the check with the context of the first divergence
+    void print_report(std::ostream& os=std::cout) const
+    {
+        if (is_recording())
+        {
+            os << "Equivalence check " << name() << ": " << sigs.size()
+               << " signals recorded to " << reference << std::endl;
+            return;
+        }
+        const divergence* d = first_divergence();
+        if (d == NULL)
+        {
+            os << "Equivalence check " << name() << ": " << compared_tokens()
+               << " tokens of " << sigs.size() << " signals same as " << reference
+               << std::endl;
+            return;
+        }
+        os << "Equivalence check " << name() << ": " << d->signal << " diverges from "
+           << reference << " at token " << d->index << std::endl
+           << "  at time    " << d->time;
+        if (d->timed)
+            os << " (tag " << d->tag << " s, expected " << d->expected_tag << " s)";
+        os << std::endl
+           << "  expected   " << d->expected << std::endl
+           << "  actual     " << d->actual << std::endl
+           << "  written by " << d->writers << std::endl
+           << "  read by    " << d->readers << std::endl;
+        for (auto& s : sigs)
+            if (s->diverged && &s->first != d)
+                os << "  also " << s->name << " from token " << s->first.index
+                   << " at " << s->first.time << std::endl;
+    }
+
+    //! The checker is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_equivalence_check";}
+
+private:
+    //! A tracked signal, independent of its token type
+    struct tracked_base
+    {
+        tracked_base(const std::string& name, sc_interface* chan)
+            : name(name), chan(chan), count(0), diverged(false) {}
+        virtual ~tracked_base() {}
+
+        //! Attaches the signal to the recorder
+        virtual void record(trace_recorder& rec) = 0;
+        //! Loads the reference tokens and starts comparing
+        virtual void compare(const trace_reader& rd) = 0;
+        //! Reports the reference tokens which are not written
+        virtual void finish() = 0;
+
+        std::string name;
+        sc_interface* chan;
+        size_t count;
+        bool diverged;
+        divergence first;
+    };
+
+    template <typename T, typename TokenType, template <class> class FifoType>
+    struct tracked : public tracked_base, public signal_observer<TokenType>
+    {
+        typedef trace_token<TokenType> traits;
+        typedef typename traits::value_type V;
+
+        tracked(ForSyDe::signal<T,TokenType,FifoType>& sig, const std::string& name,
+                const tolerance& tol)
+            : tracked_base(name, &sig), sig(sig), tol(tol) {}
+
+        void record(trace_recorder& rec) {rec.record(sig, name);}
+
+        void compare(const trace_reader& rd)
+        {
+            base = rd.values<V>(name);
+            if (traits::timed) times = rd.times(name);
+            sig.set_observer(this);
+        }
+
+        void observe(const TokenType& tok)
+        {
+            const size_t i = count++;
+            if (diverged) return;
+            const double res = sc_get_time_resolution().to_seconds();
+            const double tag = traits::timed ? traits::time(tok) * res : 0;
+            bool same = i < base.size() && approx_equal<V>::equal(base[i], traits::value(tok), tol);
+            if (same && traits::timed) same = std::fabs(tag - times[i]) < res / 2;
+            if (same) return;
+            diverge(i, i < base.size() ? value_printer<V>::print(base[i]) : "<none>",
+                    value_printer<V>::print(traits::value(tok)), tag);
+        }
+
+        void finish()
+        {
+            if (!diverged && count < base.size())
+                diverge(count, value_printer<V>::print(base[count]), "<missing>", 0);
+        }
+
+        void diverge(size_t i, const std::string& expected, const std::string& actual,
+                     double tag)
+        {
+            diverged = true;
+            first.signal = name;
+            first.index = i;
+            first.time = sc_time_stamp();
+            first.timed = traits::timed;
+            first.tag = tag;
+            first.expected_tag = traits::timed && i < times.size() ? times[i] : 0;
+            first.expected = expected;
+            first.actual = actual;
+        }
+
+        ForSyDe::signal<T,TokenType,FifoType>& sig;
+        tolerance tol;
+        std::vector<V> base;
+        std::vector<double> times;
+    };
+
+    std::string reference;
+    bool recording, finished;
+    std::vector<std::unique_ptr<tracked_base>> sigs;
+    trace_recorder rec;
+
+    //! Collects the ForSyDe processes below an object recursively
+    static void collect(sc_object* obj, std::vector<ForSyDe::process*>& procs)
+    {
+        for (auto c : obj->get_child_objects())
+        {
+            if (auto p = dynamic_cast<ForSyDe::process*>(c))
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(c) != NULL)
+                collect(c, procs);
+        }
+    }
+
+    //! The names of the processes with a port of the given kind bound to a channel
+    static std::string bound_processes(const std::vector<ForSyDe::process*>& procs,
+                                       sc_interface* ch, const char* port_kind)
+    {
+        std::string res;
+        for (auto p : procs)
+            for (auto c : p->get_child_objects())
+            {
+                if (c->kind() != std::string(port_kind)) continue;
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                for (auto b : port->bound_channels())
+                    if (b == ch)
+                        res += (res.empty() ? "" : ", ") + std::string(p->name());
+            }
+        return res.empty() ? "<none>" : res;
+    }
+
+    //! Opens the trace of a recording run or loads the reference
+    void end_of_elaboration()
+    {
+        if (is_recording())
+        {
+            if (!rec.open(reference))
+                SC_REPORT_ERROR(name(), ("the trace file " + reference + " could not be written").c_str());
+            for (auto& s : sigs) s->record(rec);
+            return;
+        }
+        trace_reader rd;
+        if (!rd.open(reference))
+            SC_REPORT_ERROR(name(), ("the reference trace " + reference + " could not be loaded").c_str());
+        std::vector<ForSyDe::process*> procs;
+        for (auto top : sc_get_top_level_objects()) collect(top, procs);
+        for (auto& s : sigs)
+        {
+            if (!rd.has_signal(s->name))
+                SC_REPORT_ERROR(name(), ("the signal " + s->name + " is not in the reference trace").c_str());
+            s->first.writers = bound_processes(procs, s->chan, "sc_fifo_out");
+            s->first.readers = bound_processes(procs, s->chan, "sc_fifo_in");
+            s->compare(rd);
+        }
+    }
+
+    void end_of_simulation() {finish();}
+};
+
+//! The outcome of a mode of an equivalence run
+struct equivalence_result
+{
+    std::string mode;           ///< the name of the mode
+    //! The exit status of the child
+    /*! It is zero if the signals are the same as in the reference (or
+     * they are recorded in the reference mode), one if they diverge, two
+     * if the simulation is stopped by an error, and -1 if the child could
+     * not be started, is killed, or is not run because the reference has
+     * failed.
+     */
+    int status;
+    std::string report;         ///< the report of the checker, or the error
+};
+
+//! Runs a model once per execution mode and compares the modes with the first one
+/*! For each mode, in order, a child process is forked which constructs
+ * a checker, calls the build function with the mode and the checker to
+ * elaborate the model, tracks its signals and sets up the executors of
+ * the mode, and simulates the given time, or until the end if it is
+ * zero. The first mode records the reference trace and the others are
+ * compared with it. It should be called before any module is
+ * constructed in the calling process, and returns when all the modes
+ * have run, with their reports.
+ */
+inline std::vector<equivalence_result> run_equivalence(
+        const std::vector<std::string>& modes,      ///< the reference mode followed by the rest
+        const std::function<void(const std::string&,equivalence_check&)>& build, ///< builds a mode
+        const std::string& reference="equivalence.trc", ///< the reference trace file
+        const sc_time& run_time=SC_ZERO_TIME        ///< the simulated time
+        )
+{
+    std::vector<equivalence_result> res;
+    // otherwise the buffered output is written by all the children
+    std::fflush(NULL);
+    for (size_t i=0; i<modes.size(); i++)
+    {
+        res.push_back(equivalence_result{modes[i], -1, ""});
+        if (i > 0 && res[0].status != 0) continue;
+        int fds[2];
+        if (pipe(fds) != 0)
+        {
+            SC_REPORT_WARNING("run_equivalence", "could not create a pipe");
+            break;
+        }
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            SC_REPORT_WARNING("run_equivalence", "could not fork the simulation");
+            close(fds[0]);
+            close(fds[1]);
+            break;
+        }
+        if (pid == 0)
+        {
+            close(fds[0]);
+            int code = 0;
+            std::ostringstream oss;
+            try
+            {
+                equivalence_check chk("equivalence", reference, i == 0);
+                build(modes[i], chk);
+                if (run_time == SC_ZERO_TIME) sc_start(); else sc_start(run_time);
+                chk.finish();
+                chk.print_report(oss);
+                code = chk.passed() ? 0 : 1;
+            }
+            catch (const std::exception& e)
+            {
+                oss << e.what() << std::endl;
+                code = 2;
+            }
+            const std::string rep = oss.str();
+            for (size_t n=0; n<rep.size();)
+            {
+                const ssize_t w = write(fds[1], rep.data()+n, rep.size()-n);
+                if (w <= 0) break;
+                n += w;
+            }
+            close(fds[1]);
+            std::fflush(NULL);
+            // the state of the model belongs to the child only
+            std::_Exit(code);
+        }
+        close(fds[1]);
+        char buf[4096];
+        ssize_t n;
+        while ((n = read(fds[0], buf, sizeof(buf))) > 0)
+            res[i].report.append(buf, n);
+        close(fds[0]);
+        int st;
+        if (waitpid(pid, &st, 0) == pid && WIFEXITED(st))
+            res[i].status = WEXITSTATUS(st);
+    }
+    return res;
+}
+
+//! Prints the outcomes of an equivalence run and returns the number of failed modes
+inline int print_equivalence(const std::vector<equivalence_result>& res,
+                             std::ostream& os=std::cout)
+{
+    int failed = 0;
+    for (auto& r : res)
+    {
+        const char* verdict = r.status == 0 ? "ok" : r.status == 1 ? "DIVERGED" :
+                              r.status == 2 ? "ERROR" : "NOT RUN";
+        os << "[" << verdict << "] " << r.mode << std::endl << r.report;
+        if (r.status != 0) failed++;
+    }
+    return failed;
+}
+
+}
+
+#endif
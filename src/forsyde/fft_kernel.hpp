@@ -0,0 +1,289 @@
+/**********************************************************************
+    * fft_kernel.hpp -- The plans of the FFT processes                *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing the discrete Fourier transforms of the       *
+    *          spectral processes with plans computed once            *
+    *                                                                 *
+    * Usage:   This file is included automatically, define            *
+    *          FORSYDE_FFTW to use the FFTW library                   *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef FFT_KERNEL_HPP
+#define FFT_KERNEL_HPP
+
+/*! \file fft_kernel.hpp
+ * \brief Implements the plans of the discrete Fourier transforms
+ *
+ *  This file includes the plans used by the spectral process
+ * constructors (e.g., SDF::fft and SDF::autocorr). A plan of a size is
+ * computed once, cached and shared by all the processes transforming
+ * blocks of that size, and it is immutable afterwards, hence the
+ * processes can use it from different threads. Each process transforms
+ * its own aligned buffer in place.
+ *
+ *  The built-in backend uses an iterative radix-2 transform with
+ * precomputed twiddle factors for the powers of two and Bluestein's
+ * algorithm for the other sizes. With FORSYDE_FFTW defined, the
+ * transforms of float and double values are planned and executed by the
+ * FFTW library instead (linked with -lfftw3 -lfftw3f).
+ */
+
+#include <complex>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#ifdef FORSYDE_FFTW
+#include <fftw3.h>
+#endif
+
+//! The alignment of the buffers of the transforms
+#ifndef FORSYDE_SIMD_ALIGN
+#define FORSYDE_SIMD_ALIGN 64
+#endif
+
+namespace ForSyDe
+{
+
+//! The real type of a real or complex value type
+template <typename T>
+struct fft_real {typedef T type;};
+
+template <typename R>
+struct fft_real<std::complex<R>> {typedef R type;};
+
+//! Frees a buffer allocated by fft_alloc
+struct fft_free
+{
+    void operator()(void* p) const
+    {
+#ifdef FORSYDE_FFTW
+        fftw_free(p);
+#else
+        ::operator delete(p, std::align_val_t(FORSYDE_SIMD_ALIGN));
+#endif
+    }
+};
+
+//! An aligned buffer of complex values transformed by the plans
+template <typename R>
+using fft_buffer = std::unique_ptr<std::complex<R>[], fft_free>;
+
+//! Allocates an aligned buffer of n complex values, set to zero
+template <typename R>
+inline fft_buffer<R> fft_alloc(size_t n)
+{
+    const size_t bytes = std::max<size_t>(n, 1) * sizeof(std::complex<R>);
+#ifdef FORSYDE_FFTW
+    void* p = fftw_malloc(bytes);
+    if (!p) throw std::bad_alloc();
+#else
+    void* p = ::operator new(bytes, std::align_val_t(FORSYDE_SIMD_ALIGN));
+#endif
+    auto res = static_cast<std::complex<R>*>(p);
+    for (size_t i=0; i<n; i++) new (res+i) std::complex<R>();
+    return fft_buffer<R>(res);
+}
+
+//! The plan of the discrete Fourier transforms of a size
+/*! The forward transform computes X[k] = sum x[j] exp(-2 pi i jk/n) and
+ * the inverse one the same sum with a positive exponent, without
+ * scaling.
+ */
+template <typename R>
+class fft_plan
+{
+public:
+    typedef std::complex<R> complex_type;
+
+    //! Returns the cached plan of a size, computing it if needed
+    static std::shared_ptr<const fft_plan> get(size_t n)
+    {
+        std::lock_guard<std::mutex> lk(cache_mutex());
+        auto& p = cache()[n];
+        if (!p) p.reset(new fft_plan(n));
+        return p;
+    }
+
+    //! The size of the transforms
+    size_t size() const {return n;}
+
+    //! Transforms an aligned buffer of size() values in place
+    void transform(complex_type* data, bool inverse=false) const
+    {
+#ifdef FORSYDE_FFTW
+        if constexpr (std::is_same<R,double>::value)
+        {
+            auto d = reinterpret_cast<fftw_complex*>(data);
+            fftw_execute_dft(inverse ? (fftw_plan)bwd : (fftw_plan)fwd, d, d);
+            return;
+        }
+        else if constexpr (std::is_same<R,float>::value)
+        {
+            auto d = reinterpret_cast<fftwf_complex*>(data);
+            fftwf_execute_dft(inverse ? (fftwf_plan)bwd : (fftwf_plan)fwd, d, d);
+            return;
+        }
+#endif
+        if (n <= 1) return;
+        if (bluestein) transform_bluestein(data, inverse);
+        else transform_radix2(data, inverse);
+    }
+
+    ~fft_plan()
+    {
+#ifdef FORSYDE_FFTW
+        if constexpr (std::is_same<R,double>::value)
+        {
+            fftw_destroy_plan((fftw_plan)fwd);
+            fftw_destroy_plan((fftw_plan)bwd);
+        }
+        else if constexpr (std::is_same<R,float>::value)
+        {
+            fftwf_destroy_plan((fftwf_plan)fwd);
+            fftwf_destroy_plan((fftwf_plan)bwd);
+        }
+#endif
+    }
+
+private:
+    size_t n;
+    bool bluestein;
+    // the twiddle factors exp(-2 pi i k/n) and the bit-reversal permutation
+    std::vector<complex_type> twiddles;
+    std::vector<size_t> bitrev;
+    // the chirp, the transform of its filter and the plan of the padded size
+    std::vector<complex_type> chirp;
+    fft_buffer<R> chirp_fft;
+    std::shared_ptr<const fft_plan> padded;
+#ifdef FORSYDE_FFTW
+    void* fwd = nullptr;
+    void* bwd = nullptr;
+#endif
+
+    explicit fft_plan(size_t n) : n(n), bluestein((n & (n-1)) != 0)
+    {
+#ifdef FORSYDE_FFTW
+        if constexpr (std::is_same<R,double>::value || std::is_same<R,float>::value)
+        {
+            // the plans are computed on an aligned buffer and executed on
+            // the buffers of the processes, which are aligned the same way
+            fft_buffer<R> tmp = fft_alloc<R>(n);
+            if constexpr (std::is_same<R,double>::value)
+            {
+                auto d = reinterpret_cast<fftw_complex*>(tmp.get());
+                fwd = fftw_plan_dft_1d(n, d, d, FFTW_FORWARD, FFTW_MEASURE);
+                bwd = fftw_plan_dft_1d(n, d, d, FFTW_BACKWARD, FFTW_MEASURE);
+            }
+            else
+            {
+                auto d = reinterpret_cast<fftwf_complex*>(tmp.get());
+                fwd = fftwf_plan_dft_1d(n, d, d, FFTW_FORWARD, FFTW_MEASURE);
+                bwd = fftwf_plan_dft_1d(n, d, d, FFTW_BACKWARD, FFTW_MEASURE);
+            }
+            return;
+        }
+#endif
+        if (n <= 1) return;
+        const R pi = std::acos(R(-1));
+        if (!bluestein)
+        {
+            twiddles.resize(n/2);
+            for (size_t k=0; k<n/2; k++)
+                twiddles[k] = std::polar(R(1), R(-2) * pi * R(k) / R(n));
+            bitrev.resize(n);
+            size_t bits = 0;
+            while ((size_t(1) << bits) < n) bits++;
+            for (size_t i=0; i<n; i++)
+            {
+                size_t r = 0;
+                for (size_t b=0; b<bits; b++)
+                    if (i & (size_t(1) << b)) r |= size_t(1) << (bits-1-b);
+                bitrev[i] = r;
+            }
+            return;
+        }
+        // Bluestein: a convolution with a chirp using a power of two plan
+        size_t m = 1;
+        while (m < 2*n-1) m <<= 1;
+        chirp.resize(n);
+        for (size_t k=0; k<n; k++)
+        {
+            // k^2 mod 2n keeps the argument of the exponential small
+            const size_t k2 = (k * k) % (2 * n);
+            chirp[k] = std::polar(R(1), -pi * R(k2) / R(n));
+        }
+        padded.reset(new fft_plan(m));
+        chirp_fft = fft_alloc<R>(m);
+        chirp_fft[0] = std::conj(chirp[0]);
+        for (size_t k=1; k<n; k++)
+            chirp_fft[k] = chirp_fft[m-k] = std::conj(chirp[k]);
+        padded->transform(chirp_fft.get());
+    }
+
+    void transform_radix2(complex_type* data, bool inverse) const
+    {
+        for (size_t i=0; i<n; i++)
+            if (i < bitrev[i]) std::swap(data[i], data[bitrev[i]]);
+        for (size_t len=2; len<=n; len<<=1)
+        {
+            const size_t half = len/2, step = n/len;
+            for (size_t i=0; i<n; i+=len)
+                for (size_t j=0; j<half; j++)
+                {
+                    const complex_type w = inverse ? std::conj(twiddles[j*step])
+                                                   : twiddles[j*step];
+                    const complex_type t = w * data[i+j+half];
+                    data[i+j+half] = data[i+j] - t;
+                    data[i+j] += t;
+                }
+        }
+    }
+
+    void transform_bluestein(complex_type* data, bool inverse) const
+    {
+        const size_t m = padded->size();
+        // the scratch buffer of the padded transforms of each thread
+        thread_local std::vector<complex_type> scratch;
+        scratch.assign(m, complex_type());
+        // the inverse transform is the conjugate of the forward transform
+        // of the conjugate
+        for (size_t k=0; k<n; k++)
+            scratch[k] = (inverse ? std::conj(data[k]) : data[k]) * chirp[k];
+        padded->transform(scratch.data());
+        for (size_t k=0; k<m; k++) scratch[k] *= chirp_fft[k];
+        padded->transform(scratch.data(), true);
+        const R scale = R(1) / m;
+        for (size_t k=0; k<n; k++)
+        {
+            const complex_type x = scratch[k] * chirp[k] * scale;
+            data[k] = inverse ? std::conj(x) : x;
+        }
+    }
+
+    static std::map<size_t,std::shared_ptr<const fft_plan>>& cache()
+    {
+        static std::map<size_t,std::shared_ptr<const fft_plan>> plans;
+        return plans;
+    }
+
+    static std::mutex& cache_mutex()
+    {
+        static std::mutex m;
+        return m;
+    }
+};
+
+}
+
+#endif
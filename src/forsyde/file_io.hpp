@@ -0,0 +1,229 @@
+/**********************************************************************
+    * file_io.hpp -- Mapped input and asynchronous output files       *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Reading large stimulus files and writing large result  *
+    *          files with a low overhead                              *
+    *                                                                 *
+    * Usage:   Used by the file sources and sinks of the SY and SDF   *
+    *          MoCs                                                   *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef FILE_IO_HPP
+#define FILE_IO_HPP
+
+/*! \file file_io.hpp
+ * \brief Implements the file access of the file sources and sinks
+ *
+ *  This file includes a read-only memory mapping of an input file,
+ * which lets the binary sources take the tokens directly from the file
+ * contents, and a double-buffered writer which writes the output of the
+ * sinks in a separate thread while the simulation fills the other
+ * buffer.
+ */
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstdio>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+//! The size of the buffers of the file sources and sinks in bytes
+#ifndef FORSYDE_FILE_BUFFER
+#define FORSYDE_FILE_BUFFER (1<<20)
+#endif
+
+namespace ForSyDe
+{
+
+//! A read-only memory mapping of a whole file
+class mapped_file
+{
+public:
+    mapped_file() : addr(NULL), len(0) {}
+
+    ~mapped_file() {close();}
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    //! Maps a file, returning false if it can not be opened
+    bool open(const std::string& file_name)
+    {
+        close();
+        const int fd = ::open(file_name.c_str(), O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) < 0)
+        {
+            ::close(fd);
+            return false;
+        }
+        len = st.st_size;
+        if (len > 0)
+        {
+            addr = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (addr == MAP_FAILED)
+            {
+                addr = NULL;
+                len = 0;
+                ::close(fd);
+                return false;
+            }
+            // the file is normally read once from the beginning to the end
+            madvise(addr, len, MADV_SEQUENTIAL);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    //! The contents of the file, which are page aligned
+    const char* data() const {return static_cast<const char*>(addr);}
+
+    //! The size of the file in bytes
+    size_t size() const {return len;}
+
+    //! Drops the whole pages of a range of the file from the memory
+    /*! It is used by the sequential readers to keep the resident part of
+     * a large file bounded. The pages are read again from the file if
+     * they are accessed later.
+     */
+    void release(size_t from, size_t to)
+    {
+        const size_t page = sysconf(_SC_PAGESIZE);
+        from = (from + page - 1) / page * page;
+        to = std::min(to, len) / page * page;
+        if (addr != NULL && to > from)
+            madvise(static_cast<char*>(addr) + from, to - from, MADV_DONTNEED);
+    }
+
+    //! Unmaps the file
+    void close()
+    {
+        if (addr != NULL) munmap(addr, len);
+        addr = NULL;
+        len = 0;
+    }
+
+private:
+    void* addr;
+    size_t len;
+};
+
+//! A writer which writes the output file in a separate thread
+/*! The data is appended to a front buffer. When it is full, it is
+ * swapped with the back buffer which is written to the file by the
+ * writer thread, hence the caller only waits if the disk is slower than
+ * the simulation.
+ */
+class async_file_writer
+{
+public:
+    async_file_writer() : file(NULL), stop(false) {}
+
+    ~async_file_writer() {close();}
+
+    async_file_writer(const async_file_writer&) = delete;
+    async_file_writer& operator=(const async_file_writer&) = delete;
+
+    //! Opens the output file and starts the writer thread
+    bool open(const std::string& file_name)
+    {
+        close();
+        file = std::fopen(file_name.c_str(), "wb");
+        if (file == NULL) return false;
+        front.reserve(FORSYDE_FILE_BUFFER);
+        back.reserve(FORSYDE_FILE_BUFFER);
+        stop = false;
+        failed = false;
+        writer = std::thread(&async_file_writer::run, this);
+        return true;
+    }
+
+    //! Appends data to the file
+    void write(const void* data, size_t size)
+    {
+        const char* p = static_cast<const char*>(data);
+        front.insert(front.end(), p, p+size);
+        if (front.size() >= FORSYDE_FILE_BUFFER) hand_over();
+    }
+
+    //! Appends a line to the file
+    void write_line(const std::string& line)
+    {
+        front.insert(front.end(), line.begin(), line.end());
+        front.push_back('\n');
+        if (front.size() >= FORSYDE_FILE_BUFFER) hand_over();
+    }
+
+    //! Checks if writing to the file has failed
+    bool has_failed() const
+    {
+        std::lock_guard<std::mutex> lk(m);
+        return failed;
+    }
+
+    //! Writes the remaining data, stops the writer and closes the file
+    void close()
+    {
+        if (file == NULL) return;
+        hand_over();
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        cv.notify_all();
+        writer.join();
+        std::fclose(file);
+        file = NULL;
+    }
+
+private:
+    std::FILE* file;
+    std::vector<char> front, back;
+    std::thread writer;
+    mutable std::mutex m;
+    std::condition_variable cv;
+    bool stop, failed;
+
+    //! Gives the front buffer to the writer thread
+    void hand_over()
+    {
+        std::unique_lock<std::mutex> lk(m);
+        // wait for the previous buffer to be written
+        cv.wait(lk, [this]{return back.empty();});
+        front.swap(back);
+        lk.unlock();
+        cv.notify_all();
+    }
+
+    //! The main loop of the writer thread
+    void run()
+    {
+        std::unique_lock<std::mutex> lk(m);
+        while (true)
+        {
+            cv.wait(lk, [this]{return stop || !back.empty();});
+            if (back.empty()) return;
+            lk.unlock();
+            const bool ok = std::fwrite(back.data(), 1, back.size(), file) == back.size();
+            lk.lock();
+            if (!ok) failed = true;
+            back.clear();
+            cv.notify_all();
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,171 @@
+/**********************************************************************
+    * fir_kernel.hpp -- The kernels of the FIR filter processes       *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing vectorizable inner products and the sample   *
+    *          history shared by the FIR filters of different MoCs    *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef FIR_KERNEL_HPP
+#define FIR_KERNEL_HPP
+
+/*! \file fir_kernel.hpp
+ * \brief Implements the kernels of the FIR filter processes
+ *
+ *  This file includes the inner product and the sample history used by
+ * the SY and SDF FIR filter, decimator and resampler process
+ * constructors.
+ */
+
+#include <vector>
+#include <algorithm>
+
+//! The number of independent accumulators used by the reduction kernels
+#ifndef FORSYDE_SIMD_LANES
+#define FORSYDE_SIMD_LANES 16
+#endif
+
+namespace ForSyDe
+{
+
+//! A vectorizable inner product of two arrays of n elements
+/*! The products are accumulated in FORSYDE_SIMD_LANES independent
+ * lanes, which lets the compiler use vector instructions without
+ * reassociating floating-point operations itself.
+ */
+template <typename T>
+inline T fir_dot(const T* a, const T* b, size_t n)
+{
+    const size_t L = FORSYDE_SIMD_LANES;
+    T acc[L];
+    for (size_t k=0; k<L; k++) acc[k] = T();
+    size_t i = 0;
+    for (; i+L<=n; i+=L)
+        for (size_t k=0; k<L; k++)
+            acc[k] += a[i+k] * b[i+k];
+    T res = T();
+    for (size_t k=0; k<L; k++) res += acc[k];
+    for (; i<n; i++) res += a[i] * b[i];
+    return res;
+}
+
+//! The state of an FIR filter
+/*! It keeps the coefficients in reverse order, and the history of the
+ * filter followed by the current block of inputs in a linear buffer,
+ * so that each output is the inner product of the coefficients with a
+ * contiguous window of the buffer. The history is moved to the front of
+ * the buffer once per block.
+ */
+template <typename T>
+class fir_state
+{
+public:
+    //! The constructor requires the coefficients and the block size
+    fir_state(const std::vector<T>& coefs, size_t block)
+        : rcoefs(coefs.rbegin(), coefs.rend()), block(block),
+          buf(std::max(coefs.size(), size_t(1)) - 1 + block, T()) {}
+
+    //! Clears the history
+    void reset() {std::fill(buf.begin(), buf.end(), T());}
+
+    //! The place of the next block of inputs in the buffer
+    T* inputs() {return buf.data() + rcoefs.size() - 1;}
+
+    //! Filters the block of inputs and advances the history
+    void filter(T* out)
+    {
+        const size_t n = rcoefs.size();
+        for (size_t i=0; i<block; i++)
+            out[i] = fir_dot(rcoefs.data(), buf.data()+i, n);
+        std::copy(buf.end()-(n-1), buf.end(), buf.begin());
+    }
+
+    //! Filters the block of inputs keeping every factor-th output
+    /*! The outputs at the indices 0, factor, 2*factor, ... of the block
+     * are computed, hence the block size should be a multiple of the
+     * factor.
+     */
+    void decimate(T* out, size_t factor)
+    {
+        const size_t n = rcoefs.size();
+        for (size_t i=0; i<block; i+=factor)
+            out[i/factor] = fir_dot(rcoefs.data(), buf.data()+i, n);
+        std::copy(buf.end()-(n-1), buf.end(), buf.begin());
+    }
+
+    //! The history of the filter (the last inputs, the oldest first)
+    const std::vector<T>& history() const {return buf;}
+
+    //! Restores a saved history
+    void set_history(const std::vector<T>& h) {buf = h;}
+
+private:
+    std::vector<T> rcoefs;
+    size_t block;
+    std::vector<T> buf;
+};
+
+//! The state of a polyphase rational resampler
+/*! It converts the rate of a signal by L/M, i.e., it upsamples the
+ * input by L, filters it with the given coefficients (at the upsampled
+ * rate) and downsamples the result by M, without computing the products
+ * with the inserted zeros or the filtered samples which are dropped.
+ * The coefficients are split into the L phases h[p], h[p+L], ..., each
+ * stored in reverse order and padded to the same length, so that each
+ * output is the inner product of one phase with a contiguous window of
+ * the history followed by the current block of M inputs, which produces
+ * L outputs.
+ */
+template <typename T>
+class polyphase_state
+{
+public:
+    //! The constructor requires the coefficients and the (coprime) factors
+    polyphase_state(const std::vector<T>& coefs, size_t L, size_t M)
+        : L(L), M(M), K(std::max<size_t>((coefs.size() + L - 1) / L, 1)),
+          phases(L*K, T()), buf(K - 1 + M, T())
+    {
+        for (size_t p=0; p<L; p++)
+            for (size_t j=0; j<K; j++)
+                if (p + j*L < coefs.size()) phases[p*K + K-1-j] = coefs[p + j*L];
+    }
+
+    //! Clears the history
+    void reset() {std::fill(buf.begin(), buf.end(), T());}
+
+    //! The place of the next block of M inputs in the buffer
+    T* inputs() {return buf.data() + K - 1;}
+
+    //! Computes the L outputs of the block of inputs and advances the history
+    void resample(T* out)
+    {
+        for (size_t m=0; m<L; m++)
+        {
+            // output m is sample m*M of the upsampled signal, whose
+            // phase selects the coefficients applied to the input m*M/L
+            const size_t n = m * M;
+            out[m] = fir_dot(phases.data() + (n % L)*K, buf.data() + n / L, K);
+        }
+        std::copy(buf.end()-(K-1), buf.end(), buf.begin());
+    }
+
+    //! The history of the resampler (the last inputs, the oldest first)
+    const std::vector<T>& history() const {return buf;}
+
+    //! Restores a saved history
+    void set_history(const std::vector<T>& h) {buf = h;}
+
+private:
+    size_t L, M, K;
+    std::vector<T> phases;
+    std::vector<T> buf;
+};
+
+}
+
+#endif
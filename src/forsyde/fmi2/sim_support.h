@@ -19,6 +19,9 @@
 #include <string.h>
 #include <assert.h>
 #include <stdarg.h>
+#include <map>
+#include <string>
+#include <mutex>
 #include "fmi2.h"
 
 #ifndef _MSC_VER
@@ -90,12 +93,22 @@
 #define SEVEN_ZIP_OUT_OF_MEMORY 8
 #define SEVEN_ZIP_STOPPED_BY_USER 255
 
+// the kind of FMUs loaded by default; the wrappers give it explicitly
+#ifdef FMI_COSIMULATION
+#define FMI_DEFAULT_TYPE fmi2CoSimulation
+#else
+#define FMI_DEFAULT_TYPE fmi2ModelExchange
+#endif
+
 void fmuLogger(fmi2Component c, fmi2String instanceName, fmi2Status status, fmi2String category, fmi2String message, ...);
 int unzip(const char *zipPath, const char *outPath);
 //~ void parseArguments(int argc, char *argv[], const char **fmuFileName, double *tEnd, double *h,
         //~ int *loggingOn, char *csv_separator, int *nCategories, /*const*/ fmi2String *logCategories[]);
-void loadFMU(const char *fmuFileName, FMU* fmu);
+void loadFMU(const char *fmuFileName, FMU* fmu, fmi2Type type=FMI_DEFAULT_TYPE);
 void deleteUnzippedFiles();
+void loadSharedFMU(const char *fmuFileName, FMU* fmu, fmi2Type type=FMI_DEFAULT_TYPE);
+void releaseSharedFMU(FMU* fmu);
+char *getSharedResourcesLocation(const FMU* fmu); // caller has to free the result
 void outputRow(FMU *fmu, fmi2Component c, double time, FILE* file, char separator, fmi2Boolean header);
 int error(const char *message);
 //~ void printHelp(const char *fmusim);
@@ -270,7 +283,7 @@ static void *getAdr(int *success, HMODULE dllHandle, const char *functionName) {
 
 // Load the given dll and set function pointers in fmu
 // Return 0 to indicate failure
-static int loadDll(const char* dllPath, FMU *fmu) {
+static int loadDll(const char* dllPath, FMU *fmu, fmi2Type type) {
     int s = 1;
 #ifdef _MSC_VER
     HMODULE h = LoadLibrary(dllPath);
@@ -313,7 +326,7 @@ static int loadDll(const char* dllPath, FMU *fmu) {
     fmu->serializeFMUstate         = (fmi2SerializeFMUstateTYPE *)     getAdr(&s, h, "fmi2SerializeFMUstate");
     fmu->deSerializeFMUstate       = (fmi2DeSerializeFMUstateTYPE *)   getAdr(&s, h, "fmi2DeSerializeFMUstate");
     fmu->getDirectionalDerivative  = (fmi2GetDirectionalDerivativeTYPE *) getAdr(&s, h, "fmi2GetDirectionalDerivative");
-#ifdef FMI_COSIMULATION
+    if (type == fmi2CoSimulation) {
     fmu->setRealInputDerivatives   = (fmi2SetRealInputDerivativesTYPE *) getAdr(&s, h, "fmi2SetRealInputDerivatives");
     fmu->getRealOutputDerivatives  = (fmi2GetRealOutputDerivativesTYPE *) getAdr(&s, h, "fmi2GetRealOutputDerivatives");
     fmu->doStep                    = (fmi2DoStepTYPE *)                getAdr(&s, h, "fmi2DoStep");
@@ -323,7 +336,7 @@ static int loadDll(const char* dllPath, FMU *fmu) {
     fmu->getIntegerStatus          = (fmi2GetIntegerStatusTYPE *)      getAdr(&s, h, "fmi2GetIntegerStatus");
     fmu->getBooleanStatus          = (fmi2GetBooleanStatusTYPE *)      getAdr(&s, h, "fmi2GetBooleanStatus");
     fmu->getStringStatus           = (fmi2GetStringStatusTYPE *)       getAdr(&s, h, "fmi2GetStringStatus");
-#else // FMI2 for Model Exchange
+    } else { // FMI2 for Model Exchange
     fmu->enterEventMode            = (fmi2EnterEventModeTYPE *)        getAdr(&s, h, "fmi2EnterEventMode");
     fmu->newDiscreteStates         = (fmi2NewDiscreteStatesTYPE *)     getAdr(&s, h, "fmi2NewDiscreteStates");
     fmu->enterContinuousTimeMode   = (fmi2EnterContinuousTimeModeTYPE *) getAdr(&s, h, "fmi2EnterContinuousTimeMode");
@@ -334,7 +347,7 @@ static int loadDll(const char* dllPath, FMU *fmu) {
     fmu->getEventIndicators        = (fmi2GetEventIndicatorsTYPE *)    getAdr(&s, h, "fmi2GetEventIndicators");
     fmu->getContinuousStates       = (fmi2GetContinuousStatesTYPE *)   getAdr(&s, h, "fmi2GetContinuousStates");
     fmu->getNominalsOfContinuousStates = (fmi2GetNominalsOfContinuousStatesTYPE *) getAdr(&s, h, "fmi2GetNominalsOfContinuousStates");
-#endif
+    }
 
     if (fmu->getVersion == NULL && fmu->instantiate == NULL) {
         printf("warning: Functions from FMI 2.0 could not be found in %s\n", dllPath);
@@ -364,7 +377,7 @@ static int loadDll(const char* dllPath, FMU *fmu) {
         fmu->serializeFMUstate         = (fmi2SerializeFMUstateTYPE *)     getAdr(&s, h, "fmiSerializeFMUstate");
         fmu->deSerializeFMUstate       = (fmi2DeSerializeFMUstateTYPE *)   getAdr(&s, h, "fmiDeSerializeFMUstate");
         fmu->getDirectionalDerivative  = (fmi2GetDirectionalDerivativeTYPE *) getAdr(&s, h, "fmiGetDirectionalDerivative");
-    #ifdef FMI_COSIMULATION
+        if (type == fmi2CoSimulation) {
         fmu->setRealInputDerivatives   = (fmi2SetRealInputDerivativesTYPE *) getAdr(&s, h, "fmiSetRealInputDerivatives");
         fmu->getRealOutputDerivatives  = (fmi2GetRealOutputDerivativesTYPE *) getAdr(&s, h, "fmiGetRealOutputDerivatives");
         fmu->doStep                    = (fmi2DoStepTYPE *)                getAdr(&s, h, "fmiDoStep");
@@ -374,7 +387,7 @@ static int loadDll(const char* dllPath, FMU *fmu) {
         fmu->getIntegerStatus          = (fmi2GetIntegerStatusTYPE *)      getAdr(&s, h, "fmiGetIntegerStatus");
         fmu->getBooleanStatus          = (fmi2GetBooleanStatusTYPE *)      getAdr(&s, h, "fmiGetBooleanStatus");
         fmu->getStringStatus           = (fmi2GetStringStatusTYPE *)       getAdr(&s, h, "fmiGetStringStatus");
-    #else // FMI2 for Model Exchange
+        } else { // FMI2 for Model Exchange
         fmu->enterEventMode            = (fmi2EnterEventModeTYPE *)        getAdr(&s, h, "fmiEnterEventMode");
         fmu->newDiscreteStates         = (fmi2NewDiscreteStatesTYPE *)     getAdr(&s, h, "fmiNewDiscreteStates");
         fmu->enterContinuousTimeMode   = (fmi2EnterContinuousTimeModeTYPE *) getAdr(&s, h, "fmiEnterContinuousTimeMode");
@@ -385,12 +398,12 @@ static int loadDll(const char* dllPath, FMU *fmu) {
         fmu->getEventIndicators        = (fmi2GetEventIndicatorsTYPE *)    getAdr(&s, h, "fmiGetEventIndicators");
         fmu->getContinuousStates       = (fmi2GetContinuousStatesTYPE *)   getAdr(&s, h, "fmiGetContinuousStates");
         fmu->getNominalsOfContinuousStates = (fmi2GetNominalsOfContinuousStatesTYPE *) getAdr(&s, h, "fmiGetNominalsOfContinuousStates");
-    #endif
+        }
     }
     return s;
 }
 
-static void printModelDescription(ModelDescription* md){
+static void printModelDescription(ModelDescription* md, fmi2Type type){
     Element* e = (Element*)md;
     int i;
     int n; // number of attributes
@@ -407,19 +420,19 @@ static void printModelDescription(ModelDescription* md){
     }
     free((void *)attributes);
 
-#ifdef FMI_COSIMULATION
+    if (type == fmi2CoSimulation) {
     component = getCoSimulation(md);
     if (!component) {
         printf("error: No CoSimulation element found in model description. This FMU is not for Co-Simulation.\n");
         exit(EXIT_FAILURE);
     }
-#else // FMI_MODEL_EXCHANGE
+    } else { // FMI_MODEL_EXCHANGE
     component = getModelExchange(md);
     if (!component) {
         printf("error: No ModelExchange element found in model description. This FMU is not for Model Exchange.\n");
         exit(EXIT_FAILURE);
     }
-#endif
+    }
     printf("%s\n", getElementTypeName((Element *)component));
     attributes = getAttributesAsArray((Element *)component, &n);
     if (!attributes) {
@@ -433,46 +446,51 @@ static void printModelDescription(ModelDescription* md){
     free((void *)attributes);
 }
 
-void loadFMU(const char* fmuFileName, FMU *fmu) {
-    char* fmuPath;
-    char* tmpPath;
+// Parse the model description of an unzipped FMU and load its dll
+static void loadUnzippedFMU(const char* tmpPath, FMU *fmu, fmi2Type type) {
     char* xmlPath;
     char* dllPath;
     const char *modelId;
 
-    // get absolute path to FMU, NULL if not found
-    fmuPath = getFmuPath(fmuFileName);
-    if (!fmuPath) exit(EXIT_FAILURE);
-
-    // unzip the FMU to the tmpPath directory
-    tmpPath = getTmpPath();
-    if (!unzip(fmuPath, tmpPath)) exit(EXIT_FAILURE);
-
     // parse tmpPath\modelDescription.xml
     xmlPath = static_cast<char*>(calloc(sizeof(char), strlen(tmpPath) + strlen(XML_FILE) + 1));
     sprintf(xmlPath, "%s%s", tmpPath, XML_FILE);
     fmu->modelDescription = parse(xmlPath);
     free(xmlPath);
     if (!fmu->modelDescription) exit(EXIT_FAILURE);
-    printModelDescription(fmu->modelDescription);
-#ifdef FMI_COSIMULATION
-    modelId = getAttributeValue((Element *)getCoSimulation(fmu->modelDescription), att_modelIdentifier);
-#else // FMI_MODEL_EXCHANGE
-    modelId = getAttributeValue((Element *)getModelExchange(fmu->modelDescription), att_modelIdentifier);
-#endif
+    printModelDescription(fmu->modelDescription, type);
+    if (type == fmi2CoSimulation)
+        modelId = getAttributeValue((Element *)getCoSimulation(fmu->modelDescription), att_modelIdentifier);
+    else // FMI_MODEL_EXCHANGE
+        modelId = getAttributeValue((Element *)getModelExchange(fmu->modelDescription), att_modelIdentifier);
     // load the FMU dll
     dllPath = static_cast<char*>(calloc(sizeof(char), strlen(tmpPath) + strlen(DLL_DIR)
             + strlen(modelId) +  strlen(DLL_SUFFIX) + 1));
     sprintf(dllPath,"%s%s%s%s", tmpPath, DLL_DIR, modelId, DLL_SUFFIX);
-    if (!loadDll(dllPath, fmu)) {
+    if (!loadDll(dllPath, fmu, type)) {
         free(dllPath);
         // try the alternative directory and suffix
         dllPath = static_cast<char*>(calloc(sizeof(char), strlen(tmpPath) + strlen(DLL_DIR2) 
                 + strlen(modelId) +  strlen(DLL_SUFFIX2) + 1));
         sprintf(dllPath,"%s%s%s%s", tmpPath, DLL_DIR2, modelId, DLL_SUFFIX2);
-        if (!loadDll(dllPath, fmu)) exit(EXIT_FAILURE); 
+        if (!loadDll(dllPath, fmu, type)) exit(EXIT_FAILURE); 
     }
     free(dllPath);
+}
+
+void loadFMU(const char* fmuFileName, FMU *fmu, fmi2Type type) {
+    char* fmuPath;
+    char* tmpPath;
+
+    // get absolute path to FMU, NULL if not found
+    fmuPath = getFmuPath(fmuFileName);
+    if (!fmuPath) exit(EXIT_FAILURE);
+
+    // unzip the FMU to the tmpPath directory
+    tmpPath = getTmpPath();
+    if (!unzip(fmuPath, tmpPath)) exit(EXIT_FAILURE);
+
+    loadUnzippedFMU(tmpPath, fmu, type);
     free(fmuPath);
     free(tmpPath);
 }
@@ -490,6 +508,171 @@ void deleteUnzippedFiles() {
     free(cmd);
 }
 
+/* -------------------------------------------------------------------------
+ * A process-wide cache of the loaded FMUs. An FMU is unzipped once into a
+ * directory named after the hash of the archive, which is kept and reused
+ * by the later runs. Its dll and model description are shared by all of
+ * its instances in the process, each instance calling fmi2Instantiate.
+ * The cache directory is given by the FORSYDE_FMU_CACHE environment
+ * variable, or is the temporary directory of the system by default.
+ * The FMUs which can be instantiated only once per process are loaded
+ * again from a private copy for every further instance.
+ * -------------------------------------------------------------------------*/
+
+typedef struct {
+    FMU fmu;
+    std::string dir;     // the unzipped FMU, ending with a separator
+    int users;
+    int onlyOnce;        // canBeInstantiatedOnlyOncePerProcess
+} FMUCacheEntry;
+
+static std::map<std::pair<unsigned long long,int>, FMUCacheEntry>& getFMUCache() {
+    static std::map<std::pair<unsigned long long,int>, FMUCacheEntry> cache;
+    return cache;
+}
+
+static std::mutex& getFMUCacheMutex() {
+    static std::mutex m;
+    return m;
+}
+
+// FNV-1a hash of the contents of a file
+// Return 0 to indicate failure
+static int hashFile(const char* path, unsigned long long* hash) {
+    unsigned char buf[BUFSIZE];
+    size_t n;
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        printf("error: Could not open %s\n", path);
+        return 0;
+    }
+    *hash = 14695981039346656037ULL;
+    while ((n = fread(buf, 1, BUFSIZE, file)) > 0)
+        for (size_t i = 0; i < n; i++) {
+            *hash ^= buf[i];
+            *hash *= 1099511628211ULL;
+        }
+    fclose(file);
+    return 1;
+}
+
+static std::string getFMUCacheRoot() {
+    const char* root = getenv("FORSYDE_FMU_CACHE");
+#if WINDOWS
+    char tmpPath[BUFSIZE];
+    if (!root && GetTempPath(BUFSIZE, tmpPath)) root = tmpPath;
+    return std::string(root ? root : ".") + "\\";
+#else
+    if (!root) root = getenv("TMPDIR");
+    return std::string(root ? root : "/tmp") + "/";
+#endif
+}
+
+// Unzip an FMU into its cache directory unless a previous run did it
+// Return 0 to indicate failure
+static int unzipCached(const char* fmuPath, unsigned long long hash, std::string& dir) {
+    char name[32];
+    sprintf(name, "forsydeFmu%016llx", hash);
+    const std::string root = getFMUCacheRoot();
+    dir = root + name;
+    FILE* xml = fopen((dir + "/" XML_FILE).c_str(), "r");
+    if (xml) {
+        fclose(xml);
+        dir += "/";
+        return 1;
+    }
+    // unzip to a fresh directory which is then renamed atomically, so that
+    // concurrent runs never see a partially unzipped FMU
+#if WINDOWS
+    char* tmp = getTmpPath();
+    if (!tmp || !unzip(fmuPath, tmp)) return 0;
+    std::string tmpDir(tmp);
+    free(tmp);
+    tmpDir.resize(tmpDir.size()-1);
+    const int moved = MoveFile(tmpDir.c_str(), dir.c_str());
+#else
+    std::string tmpDir = root + "forsydeFmuXXXXXX";
+    if (!mkdtemp(&tmpDir[0])) {
+        fprintf(stderr, "Couldn't create temporary directory\n");
+        return 0;
+    }
+    if (!unzip(fmuPath, (tmpDir + "/").c_str())) return 0;
+    const int moved = rename(tmpDir.c_str(), dir.c_str()) == 0;
+#endif
+    if (!moved) {
+        // another run unzipped the same FMU meanwhile
+        std::string cmd = std::string(WINDOWS ? "rmdir /S /Q " : "rm -rf ") + tmpDir;
+        system(cmd.c_str());
+        xml = fopen((dir + "/" XML_FILE).c_str(), "r");
+        if (!xml) return 0;
+        fclose(xml);
+    }
+    dir += WINDOWS ? "\\" : "/";
+    return 1;
+}
+
+// Load an FMU through the cache; release it with releaseSharedFMU
+void loadSharedFMU(const char* fmuFileName, FMU* fmu, fmi2Type type) {
+    std::lock_guard<std::mutex> lock(getFMUCacheMutex());
+    char* fmuPath = getFmuPath(fmuFileName);
+    unsigned long long hash;
+    if (!fmuPath || !hashFile(fmuPath, &hash)) exit(EXIT_FAILURE);
+    auto key = std::make_pair(hash, (int)type);
+    auto it = getFMUCache().find(key);
+    if (it != getFMUCache().end()) {
+        free(fmuPath);
+        if (it->second.onlyOnce) {
+            // a private copy of the dll for this instance
+            loadFMU(fmuFileName, fmu, type);
+            return;
+        }
+        it->second.users++;
+        *fmu = it->second.fmu;
+        return;
+    }
+    FMUCacheEntry entry;
+    if (!unzipCached(fmuPath, hash, entry.dir)) exit(EXIT_FAILURE);
+    free(fmuPath);
+    loadUnzippedFMU(entry.dir.c_str(), &entry.fmu, type);
+    Element* kind = type == fmi2CoSimulation ?
+        (Element *)getCoSimulation(entry.fmu.modelDescription) :
+        (Element *)getModelExchange(entry.fmu.modelDescription);
+    const char* once = getAttributeValue(kind, att_canBeInstantiatedOnlyOncePerProcess);
+    entry.onlyOnce = once && strcmp(once, "true") == 0;
+    entry.users = 1;
+    *fmu = entry.fmu;
+    getFMUCache().insert(std::make_pair(key, entry));
+}
+
+// The URI of the resources of an FMU; caller has to free the result
+char* getSharedResourcesLocation(const FMU* fmu) {
+    std::lock_guard<std::mutex> lock(getFMUCacheMutex());
+    for (auto& e : getFMUCache())
+        if (e.second.fmu.dllHandle == fmu->dllHandle) {
+            std::string uri = "file://" + std::string(WINDOWS ? "/" : "") + e.second.dir
+                              + (WINDOWS ? "resources\\" : "resources/");
+            return strdup(uri.c_str());
+        }
+    return getTempResourcesLocation();
+}
+
+// Release an FMU loaded by loadSharedFMU, unloading it after its last instance
+void releaseSharedFMU(FMU* fmu) {
+    std::lock_guard<std::mutex> lock(getFMUCacheMutex());
+    for (auto it = getFMUCache().begin(); it != getFMUCache().end(); ++it)
+        if (it->second.fmu.dllHandle == fmu->dllHandle) {
+            if (--it->second.users > 0) return;
+            getFMUCache().erase(it);
+            break;
+        }
+#ifdef _MSC_VER
+    FreeLibrary(fmu->dllHandle);
+#else
+    dlclose(fmu->dllHandle);
+#endif
+    freeModelDescription(fmu->modelDescription);
+}
+
 static void doubleToCommaString(char* buffer, double r){
     char* comma;
     sprintf(buffer, "%.16g", r);
@@ -523,6 +706,15 @@ void setRealInput(FMU *fmu, fmi2Component c, int k, fmi2Real r) {
     }
 }
 
+// returns the value reference of the k-th scalar variable, which must be of Real type.
+// used to resolve the references once and transfer many values in one call.
+fmi2ValueReference getRealValueReference(FMU *fmu, int k) {
+    ScalarVariable *sv = getScalarVariable(fmu->modelDescription, k);
+    if (!sv || getElementType(getTypeSpec(sv)) != elm_Real)
+        SC_REPORT_ERROR("","Not a Real type");
+    return sv ? getValueReference(sv) : 0;
+}
+
 // output time and all variables in CSV format
 // if separator is ',', columns are separated by ',' and '.' is used for floating-point numbers.
 // otherwise, the given separator (e.g. ';' or '\t') is to separate columns, and ',' is used 
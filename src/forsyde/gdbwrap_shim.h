@@ -0,0 +1,243 @@
+/**********************************************************************
+    * gdbwrap_shim.h -- The target side of the fast gdbwrap mode      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Implementing the hook functions of a software model    *
+    *          wrapped by SY::gdbwrap using shared memory rings       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SHIM_IN_TYPE/FORSYDE_SHIM_OUT_TYPE if   *
+    *          needed and include it in one C file of the target      *
+    *          instead of defining the hook functions                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef GDBWRAP_SHIM_H
+#define GDBWRAP_SHIM_H
+
+/*! \file gdbwrap_shim.h
+ * \brief Implements the hook functions of the gdbwrap targets
+ *
+ *  This file is compiled into the embedded software wrapped by
+ * SY::gdbwrap. It defines forsyde_read_in1() and forsyde_write_out(),
+ * which exchange the values with the wrapper through the two shared
+ * memory rings created by the wrapper in the GDBWRAP_SHIM mode, whose
+ * common prefix is passed in the FORSYDE_SHM_PREFIX environment
+ * variable. The layout of the rings is the same as ForSyDe::shm_ring.
+ *
+ *  If the variable is not defined (e.g., the target is started on its
+ * own), the hooks do nothing. The GDBWRAP_DEBUG mode steps out of the
+ * hooks expecting empty bodies, hence the target should be built with
+ * its own empty hooks for debugging. It is plain C99 with C11 atomics.
+ */
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+//! The type of the values read by forsyde_read_in1()
+#ifndef FORSYDE_SHIM_IN_TYPE
+#define FORSYDE_SHIM_IN_TYPE double
+#endif
+
+//! The type of the values written by forsyde_write_out()
+#ifndef FORSYDE_SHIM_OUT_TYPE
+#define FORSYDE_SHIM_OUT_TYPE double
+#endif
+
+//! The number of polls of a ring before the target sleeps
+#ifndef FORSYDE_SHM_SPIN
+#define FORSYDE_SHM_SPIN 4096
+#endif
+
+//! The header of a ring, as in ForSyDe::shm_ring
+struct forsyde_shim_header
+{
+    _Atomic uint64_t head;
+    char pad1[64-sizeof(uint64_t)];
+    _Atomic uint64_t tail;
+    char pad2[64-sizeof(uint64_t)];
+    _Atomic uint32_t seq;
+    _Atomic uint32_t sleepers;
+    char pad3[64-2*sizeof(uint32_t)];
+};
+
+//! A mapped ring
+struct forsyde_shim_ring
+{
+    struct forsyde_shim_header* hdr;
+    char* data;
+    size_t cap;
+};
+
+static struct forsyde_shim_ring forsyde_shim_inp, forsyde_shim_out;
+static int forsyde_shim_state = 0;   // 0: not initialized, 1: active, -1: disabled
+
+//! Maps a ring, retrying until the wrapper has created it
+static int forsyde_shim_open(struct forsyde_shim_ring* r, const char* name)
+{
+    int fd;
+    struct stat st;
+    void* m;
+    const struct timespec ts = {0, 1000000};
+    while ((fd = shm_open(name, O_RDWR, 0600)) < 0) nanosleep(&ts, NULL);
+    // the wrapper creates the segment and then sets its size
+    while (fstat(fd, &st) == 0 && (size_t)st.st_size <= sizeof(struct forsyde_shim_header))
+        nanosleep(&ts, NULL);
+    m = mmap(NULL, st.st_size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return 0;
+    r->hdr = (struct forsyde_shim_header*)m;
+    r->data = (char*)m + sizeof(struct forsyde_shim_header);
+    r->cap = st.st_size - sizeof(struct forsyde_shim_header);
+    return 1;
+}
+
+static void forsyde_shim_notify(struct forsyde_shim_ring* r)
+{
+    atomic_fetch_add(&r->hdr->seq, 1);
+#ifdef __linux__
+    if (atomic_load(&r->hdr->sleepers) > 0)
+        syscall(SYS_futex, (uint32_t*)&r->hdr->seq, FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+}
+
+//! Waits for the wrapper to access a ring after a given version
+static void forsyde_shim_wait(struct forsyde_shim_ring* r, uint32_t seen)
+{
+    static long spins = -1;
+    long k;
+    if (spins < 0) spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? FORSYDE_SHM_SPIN : 0;
+    for (k=0; k<spins; k++)
+        if (atomic_load(&r->hdr->seq) != seen) return;
+    atomic_fetch_add(&r->hdr->sleepers, 1);
+    if (atomic_load(&r->hdr->seq) == seen)
+    {
+#ifdef __linux__
+        const struct timespec ts = {0, 1000000};
+        syscall(SYS_futex, (uint32_t*)&r->hdr->seq, FUTEX_WAIT, seen, &ts, NULL, 0);
+#else
+        sched_yield();
+#endif
+    }
+    atomic_fetch_sub(&r->hdr->sleepers, 1);
+}
+
+//! Appends a message to a ring, waiting while it is full
+static void forsyde_shim_write(struct forsyde_shim_ring* r, const void* msg, uint64_t len)
+{
+    const uint64_t need = sizeof(uint64_t) + (len + 7) / 8 * 8;
+    while (1)
+    {
+        const uint32_t v = atomic_load(&r->hdr->seq);
+        const uint64_t tail = atomic_load_explicit(&r->hdr->tail, memory_order_relaxed);
+        const uint64_t head = atomic_load_explicit(&r->hdr->head, memory_order_acquire);
+        const uint64_t off = tail % r->cap;
+        const uint64_t skip = off + need > r->cap ? r->cap - off : 0;
+        if (r->cap - (tail - head) >= skip + need)
+        {
+            uint64_t pos;
+            if (skip > 0)
+            {
+                const uint64_t mark = ~(uint64_t)0;
+                memcpy(r->data+off, &mark, sizeof(mark));
+            }
+            pos = (tail + skip) % r->cap;
+            memcpy(r->data+pos, &len, sizeof(len));
+            memcpy(r->data+pos+sizeof(len), msg, len);
+            atomic_store_explicit(&r->hdr->tail, tail + skip + need, memory_order_release);
+            forsyde_shim_notify(r);
+            return;
+        }
+        forsyde_shim_wait(r, v);
+    }
+}
+
+//! Takes the next message of a ring, waiting while it is empty
+/*! It copies at most size bytes and returns the length of the message.
+ */
+static uint64_t forsyde_shim_read(struct forsyde_shim_ring* r, void* msg, uint64_t size)
+{
+    while (1)
+    {
+        const uint32_t v = atomic_load(&r->hdr->seq);
+        uint64_t head = atomic_load_explicit(&r->hdr->head, memory_order_relaxed);
+        const uint64_t tail = atomic_load_explicit(&r->hdr->tail, memory_order_acquire);
+        if (head != tail)
+        {
+            uint64_t l;
+            memcpy(&l, r->data + head%r->cap, sizeof(l));
+            if (l == ~(uint64_t)0)
+            {
+                head += r->cap - head%r->cap;
+                memcpy(&l, r->data + head%r->cap, sizeof(l));
+            }
+            memcpy(msg, r->data + head%r->cap + sizeof(l), l < size ? l : size);
+            atomic_store_explicit(&r->hdr->head, head + sizeof(l) + (l + 7) / 8 * 8,
+                                  memory_order_release);
+            forsyde_shim_notify(r);
+            return l;
+        }
+        forsyde_shim_wait(r, v);
+    }
+}
+
+//! Tells the wrapper that the target has terminated
+static void forsyde_shim_exit(void)
+{
+    if (forsyde_shim_state == 1) forsyde_shim_write(&forsyde_shim_out, "", 0);
+}
+
+//! Connects to the wrapper on the first call of a hook
+static int forsyde_shim_active(void)
+{
+    if (forsyde_shim_state == 0)
+    {
+        const char* prefix = getenv("FORSYDE_SHM_PREFIX");
+        forsyde_shim_state = -1;
+        if (prefix != NULL && strlen(prefix) < 200)
+        {
+            char name[256];
+            strcpy(name, prefix);
+            strcat(name, "_inp");
+            if (!forsyde_shim_open(&forsyde_shim_inp, name)) return 0;
+            strcpy(name, prefix);
+            strcat(name, "_out");
+            if (!forsyde_shim_open(&forsyde_shim_out, name)) return 0;
+            forsyde_shim_state = 1;
+            atexit(forsyde_shim_exit);
+        }
+    }
+    return forsyde_shim_state == 1;
+}
+
+//! Reads the next input of the target from the wrapper
+FORSYDE_SHIM_IN_TYPE forsyde_read_in1(void)
+{
+    FORSYDE_SHIM_IN_TYPE a;
+    memset(&a, 0, sizeof(a));
+    if (forsyde_shim_active())
+        forsyde_shim_read(&forsyde_shim_inp, &a, sizeof(a));
+    return a;
+}
+
+//! Writes the next output of the target to the wrapper
+void forsyde_write_out(FORSYDE_SHIM_OUT_TYPE a)
+{
+    if (forsyde_shim_active())
+        forsyde_shim_write(&forsyde_shim_out, &a, sizeof(a));
+}
+
+#endif
@@ -0,0 +1,374 @@
+/**********************************************************************
+    * incremental.hpp -- Re-simulating only the affected processes    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Simulating the downstream cone of the modified         *
+    *          processes of a model against a recorded baseline       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SIGNAL_TRACE and FORSYDE_INTROSPECTION  *
+    *          to use it                                              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef INCREMENTAL_HPP
+#define INCREMENTAL_HPP
+
+/*! \file incremental.hpp
+ * \brief Implements the incremental re-simulation of a model
+ *
+ *  When the function or the parameters of a few processes of a large
+ * model are changed, only the processes downstream of them can produce
+ * different tokens. This file includes a driver which records the
+ * tracked signals of a baseline run, and in the later runs simulates
+ * only the cone of the modified processes, feeding the signals entering
+ * the cone from the baseline trace:
+ *
+ *     top t("top");
+ *     incremental_sim inc("inc", "baseline.trc");
+ *     inc.track(t.s1, "s1");              // all the signals of interest
+ *     inc.track(t.s2, "s2");
+ *     if (tweaked) inc.modify(t.filter1);  // otherwise a baseline run
+ *     inc.converge_after(1000);           // optional early exit
+ *     sc_start();
+ *     inc.print_report();
+ *
+ *  The cone is computed from the process graph (see model_graph) and
+ * the other processes are never executed. Every signal from a process
+ * outside the cone to one inside it should be tracked, since its tokens
+ * are replayed from the trace. The tracked signals written by the cone
+ * are compared with the baseline, and with converge_after(n) the
+ * simulation stops once the last n tokens of each of them match the
+ * baseline, which assumes that the cone then has the same state as in
+ * the baseline run.
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <deque>
+#include <cmath>
+#include <iostream>
+
+#include "abssemantics.hpp"
+#include "trace_recorder.hpp"
+#include "process_graph.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Records a baseline run or simulates the cone of the modified processes
+/*! A run without any modified process is a baseline run, which records
+ * the tracked signals into the trace file. Otherwise the trace is loaded
+ * and the run is incremental. The driver should be created, and the
+ * signals tracked, before the simulation starts. The processes should
+ * not be driven by other executors in an incremental run.
+ */
+class incremental_sim : public sc_module
+{
+public:
+    //! The index of a token which is not found
+    static constexpr size_t npos = size_t(-1);
+
+    //! The constructor requires the module name and the trace file
+    incremental_sim(sc_module_name _name,       ///< The module name
+                    const std::string& trace    ///< The trace of the baseline
+                    ) : sc_module(_name), trace(trace), window(0), converged(false)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Tracks a signal, which is recorded or replayed and compared
+    template <typename T, typename TokenType, template <class> class FifoType>
+    void track(ForSyDe::signal<T,TokenType,FifoType>& sig,  ///< the signal
+               const std::string& sig_name                  ///< its name in the trace
+               )
+    {
+        sigs.emplace_back(new tracked<T,TokenType,FifoType>(this, sig, sig_name));
+    }
+
+    //! Marks a process as modified since the baseline run
+    void modify(ForSyDe::process* p) {modified.push_back(p->name());}
+
+    //! Marks a process as modified by its hierarchical name
+    void modify(const std::string& proc_name) {modified.push_back(proc_name);}
+
+    //! Stops the simulation once n tokens of each cone output match the baseline
+    /*! Zero, the default, never stops the simulation early.
+     */
+    void converge_after(size_t n) {window = n;}
+
+    //! Checks if the run records the baseline
+    bool is_baseline() const {return modified.empty();}
+
+    //! The processes which are simulated in an incremental run
+    const std::vector<std::string>& cone() const {return cone_procs;}
+
+    //! Checks if an incremental run has stopped early
+    bool has_converged() const {return converged;}
+
+    //! The simulated time at which an incremental run has stopped early
+    const sc_time& converged_at() const {return stop_time;}
+
+    //! The index of the first token of a tracked signal differing from the baseline
+    /*! It returns npos if the tokens written so far (or replayed) are the
+     * same as in the baseline.
+     */
+    size_t first_difference(const std::string& sig_name) const
+    {
+        for (auto& s : sigs)
+            if (s->name == sig_name) return s->first_diff;
+        SC_REPORT_ERROR(name(), ("no tracked signal named " + sig_name).c_str());
+        return npos;
+    }
+
+    //! Prints the cone, the replayed signals and the compared ones
+    void print_report(std::ostream& os=std::cout) const
+    {
+        if (is_baseline())
+        {
+            os << "Incremental simulation " << name() << ": baseline of "
+               << sigs.size() << " signals recorded to " << trace << std::endl;
+            return;
+        }
+        os << "Incremental simulation " << name() << ": " << cone_procs.size()
+           << " of " << total << " processes simulated";
+        if (converged) os << ", converged at " << stop_time;
+        os << std::endl;
+        for (auto& p : cone_procs) os << "  simulated " << p << std::endl;
+        for (auto& s : sigs)
+        {
+            if (s->role == tracked_base::REPLAYED)
+                os << "  replayed  " << s->name << " (" << s->count << " tokens)" << std::endl;
+            else if (s->role == tracked_base::COMPARED)
+            {
+                os << "  compared  " << s->name << " (" << s->count << " tokens, ";
+                if (s->first_diff == npos) os << "same as the baseline)";
+                else os << "differs from token " << s->first_diff << ")";
+                os << std::endl;
+            }
+        }
+    }
+
+    //! The driver is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_incremental_sim";}
+
+private:
+    SC_HAS_PROCESS(incremental_sim);
+
+    //! A tracked signal, independent of its token type
+    struct tracked_base
+    {
+        enum role_type {IDLE, REPLAYED, COMPARED};
+
+        tracked_base(const std::string& name, sc_interface* chan)
+            : name(name), chan(chan), role(IDLE), count(0), run(0), first_diff(npos) {}
+        virtual ~tracked_base() {}
+
+        //! Attaches the signal to the recorder of the baseline
+        virtual void record(trace_recorder& rec) = 0;
+        //! Loads the baseline tokens of the signal
+        virtual void load(const trace_reader& rd) = 0;
+        //! Starts comparing the written tokens with the baseline
+        virtual void compare() = 0;
+        //! Writes the baseline tokens to the signal
+        virtual void feed() = 0;
+
+        std::string name;
+        sc_interface* chan;
+        role_type role;
+        // the tokens written or replayed, and the matching ones since the
+        // last difference
+        size_t count, run, first_diff;
+    };
+
+    template <typename T, typename TokenType, template <class> class FifoType>
+    struct tracked : public tracked_base, public signal_observer<TokenType>
+    {
+        typedef trace_token<TokenType> traits;
+        typedef typename traits::value_type V;
+
+        tracked(incremental_sim* inc, ForSyDe::signal<T,TokenType,FifoType>& sig,
+                const std::string& name) : tracked_base(name, &sig), inc(inc), sig(sig) {}
+
+        void record(trace_recorder& rec) {rec.record(sig, name);}
+
+        void load(const trace_reader& rd)
+        {
+            base = rd.values<V>(name);
+            if (traits::timed) times = rd.times(name);
+        }
+
+        void compare()
+        {
+            role = COMPARED;
+            sig.set_observer(this);
+        }
+
+        void feed()
+        {
+            role = REPLAYED;
+            for (size_t i=0; i<base.size(); i++)
+            {
+                sig.write(traits::make(base[i], traits::timed ? times[i] : 0));
+                count++;
+            }
+        }
+
+        void observe(const TokenType& tok)
+        {
+            const size_t i = count++;
+            bool same = i < base.size() && traits::value(tok) == base[i];
+            if (same && traits::timed)
+            {
+                const double res = sc_get_time_resolution().to_seconds();
+                same = std::abs(traits::time(tok) * res - times[i]) < res / 2;
+            }
+            if (same)
+                run++;
+            else
+            {
+                run = 0;
+                if (first_diff == npos) first_diff = i;
+            }
+            inc->check_convergence();
+        }
+
+        incremental_sim* inc;
+        ForSyDe::signal<T,TokenType,FifoType>& sig;
+        std::vector<V> base;
+        std::vector<double> times;
+    };
+
+    std::string trace;
+    size_t window;
+    std::vector<std::unique_ptr<tracked_base>> sigs;
+    std::vector<std::string> modified;
+
+    trace_recorder rec;
+    std::vector<std::string> cone_procs;
+    size_t total = 0;
+    bool converged;
+    sc_time stop_time;
+
+    //! Opens the trace of a baseline run
+    void end_of_elaboration()
+    {
+        if (!is_baseline()) return;
+        if (!rec.open(trace))
+            SC_REPORT_ERROR(name(), ("the trace file " + trace + " could not be written").c_str());
+        for (auto& s : sigs) s->record(rec);
+    }
+
+    //! Computes the cone, stops the other processes and attaches the signals
+    void start_of_simulation()
+    {
+        if (is_baseline()) return;
+        trace_reader rd;
+        if (!rd.open(trace))
+            SC_REPORT_ERROR(name(), ("the baseline trace " + trace + " could not be loaded").c_str());
+        const process_graph& g = model_graph();
+        total = g.nodes().size();
+        // the cone, by a breadth-first search from the modified processes
+        std::vector<bool> in_cone(g.nodes().size(), false);
+        std::deque<size_t> queue;
+        for (auto& m : modified)
+        {
+            const size_t n = g.find(m);
+            if (n == process_graph::npos)
+                SC_REPORT_ERROR(name(), ("no process named " + m).c_str());
+            else if (!in_cone[n])
+            {
+                in_cone[n] = true;
+                queue.push_back(n);
+            }
+        }
+        while (!queue.empty())
+        {
+            const size_t n = queue.front();
+            queue.pop_front();
+            for (auto s : g.successors(n))
+                if (!in_cone[s])
+                {
+                    in_cone[s] = true;
+                    queue.push_back(s);
+                }
+        }
+        for (size_t n=0; n<g.nodes().size(); n++)
+            if (in_cone[n])
+                cone_procs.push_back(g.nodes()[n].name);
+            else
+                g.nodes()[n].proc->set_ext_driven();
+        // the signals entering the cone are replayed and the ones written
+        // by the cone are compared
+        std::vector<bool> fed(g.edges().size(), false);
+        for (auto& s : sigs)
+        {
+            const size_t e = g.find_edge(s->chan);
+            if (e == process_graph::npos) continue;
+            const process_graph::edge& ed = g.edges()[e];
+            const bool from_cone = ed.src != process_graph::npos && in_cone[ed.src];
+            const bool into_cone = ed.dst != process_graph::npos && in_cone[ed.dst];
+            if (!from_cone && !into_cone) continue;
+            if (!rd.has_signal(s->name))
+                SC_REPORT_ERROR(name(), ("the signal " + s->name + " is not in the baseline trace").c_str());
+            s->load(rd);
+            if (from_cone)
+                s->compare();
+            else if (ed.src != process_graph::npos)
+            {
+                s->role = tracked_base::REPLAYED;
+                fed[e] = true;
+            }
+        }
+        for (size_t e=0; e<g.edges().size(); e++)
+        {
+            const process_graph::edge& ed = g.edges()[e];
+            if (ed.src != process_graph::npos && !in_cone[ed.src] &&
+                ed.dst != process_graph::npos && in_cone[ed.dst] && !fed[e])
+                SC_REPORT_ERROR(name(), ("the signal from " + g.nodes()[ed.src].name + " to "
+                    + g.nodes()[ed.dst].name + " enters the cone but is not tracked").c_str());
+        }
+    }
+
+    //! Closes the trace of a baseline run
+    void end_of_simulation()
+    {
+        if (is_baseline()) rec.close();
+    }
+
+    //! Stops the simulation once all the compared signals have converged
+    void check_convergence()
+    {
+        if (window == 0 || converged) return;
+        bool any = false;
+        for (auto& s : sigs)
+            if (s->role == tracked_base::COMPARED)
+            {
+                if (s->run < window) return;
+                any = true;
+            }
+        if (!any) return;
+        converged = true;
+        stop_time = sc_time_stamp();
+        sc_stop();
+    }
+
+    //! Replays the signals entering the cone, each by a thread of its own
+    void worker()
+    {
+        for (auto& s : sigs)
+            if (s->role == tracked_base::REPLAYED)
+            {
+                tracked_base* t = s.get();
+                sc_spawn([t]{t->feed();});
+            }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/**********************************************************************
+    * instances.hpp -- Instances of the library for common types      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Compiling the signals and ports of the common token    *
+    *          types once, instead of in every translation unit       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_EXTERN_TEMPLATES to use it              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef INSTANCES_HPP
+#define INSTANCES_HPP
+
+/*! \file instances.hpp
+ * \brief Declares the instances of the library for common token types
+ *
+ *  The signals and ports of the MoCs are class templates which are
+ * instantiated, together with the SystemC FIFOs they are built on, in
+ * every translation unit of a model. If FORSYDE_EXTERN_TEMPLATES is
+ * defined, the instances for the common token types (double, float, int
+ * and, for CT, CTTYPE) are declared extern here, and are compiled once in
+ * src/forsyde.cpp, which should be compiled (e.g., into a library) with
+ * the same FORSYDE_* macros as the model and linked with it.
+ */
+
+//! The instances are defined in src/forsyde.cpp and declared elsewhere
+#ifdef FORSYDE_INSTANTIATE_TEMPLATES
+#define FORSYDE_TEMPLATE template
+#else
+#define FORSYDE_TEMPLATE extern template
+#endif
+
+//! The FIFO, the signal and the ports of a token type
+#define FORSYDE_SIGNAL_INSTANCES(T, TokenType, ChanType) \
+    FORSYDE_TEMPLATE class sc_core::sc_fifo<TokenType>; \
+    FORSYDE_TEMPLATE class sc_core::sc_fifo_in<TokenType>; \
+    FORSYDE_TEMPLATE class sc_core::sc_fifo_out<TokenType>; \
+    FORSYDE_TEMPLATE class ForSyDe::signal<T,TokenType>; \
+    FORSYDE_TEMPLATE class ForSyDe::in_port<T,TokenType,ChanType>; \
+    FORSYDE_TEMPLATE class ForSyDe::out_port<T,TokenType,ChanType>;
+
+//! The instances of all the MoCs for a value type
+#define FORSYDE_MOC_INSTANCES(T) \
+    FORSYDE_SIGNAL_INSTANCES(T, ForSyDe::abst_ext<T>, ForSyDe::SY::SY2SY<T>) \
+    FORSYDE_TEMPLATE class ForSyDe::SY::SY2SY<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::SY::SY_in<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::SY::SY_out<T>; \
+    FORSYDE_SIGNAL_INSTANCES(T, T, ForSyDe::UT::UT2UT<T>) \
+    FORSYDE_TEMPLATE class ForSyDe::UT::UT2UT<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::UT::UT_in<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::UT::UT_out<T>; \
+    FORSYDE_SDF_INSTANCES(T) \
+    FORSYDE_DDE_INSTANCES(T) \
+    FORSYDE_DT_INSTANCES(T)
+
+#ifndef FORSYDE_NO_SDF
+#define FORSYDE_SDF_INSTANCES(T) \
+    FORSYDE_TEMPLATE class ForSyDe::SDF::SDF2SDF<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::SDF::SDF_in<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::SDF::SDF_out<T>;
+#else
+#define FORSYDE_SDF_INSTANCES(T)
+#endif
+
+#ifndef FORSYDE_NO_DDE
+#define FORSYDE_DDE_INSTANCES(T) \
+    FORSYDE_SIGNAL_INSTANCES(T, ForSyDe::ttn_event<T>, ForSyDe::DDE::DDE2DDE<T>) \
+    FORSYDE_TEMPLATE class ForSyDe::DDE::DDE2DDE<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::DDE::DDE_in<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::DDE::DDE_out<T>;
+#else
+#define FORSYDE_DDE_INSTANCES(T)
+#endif
+
+// the DT signals share the FIFO and the signal base with the SY ones
+#ifndef FORSYDE_NO_DT
+#define FORSYDE_DT_INSTANCES(T) \
+    FORSYDE_TEMPLATE class ForSyDe::in_port<T,ForSyDe::abst_ext<T>,ForSyDe::DT::DT2DT<T>>; \
+    FORSYDE_TEMPLATE class ForSyDe::out_port<T,ForSyDe::abst_ext<T>,ForSyDe::DT::DT2DT<T>>; \
+    FORSYDE_TEMPLATE class ForSyDe::DT::DT2DT<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::DT::DT_in<T>; \
+    FORSYDE_TEMPLATE class ForSyDe::DT::DT_out<T>;
+#else
+#define FORSYDE_DT_INSTANCES(T)
+#endif
+
+FORSYDE_MOC_INSTANCES(double)
+FORSYDE_MOC_INSTANCES(float)
+FORSYDE_MOC_INSTANCES(int)
+
+// the CT signals are not templates, only their bases are instantiated
+#ifndef FORSYDE_NO_CT
+FORSYDE_SIGNAL_INSTANCES(ForSyDe::CTTYPE, ForSyDe::sub_signal, ForSyDe::CT::CT2CT)
+#endif
+
+#undef FORSYDE_MOC_INSTANCES
+#undef FORSYDE_SIGNAL_INSTANCES
+#undef FORSYDE_SDF_INSTANCES
+#undef FORSYDE_DDE_INSTANCES
+#undef FORSYDE_DT_INSTANCES
+#undef FORSYDE_TEMPLATE
+
+#endif
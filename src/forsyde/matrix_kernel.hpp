@@ -0,0 +1,291 @@
+/**********************************************************************
+    * matrix_kernel.hpp -- Matrix tokens and their product kernels    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing matrix-valued tokens and allocation-free     *
+    *          products shared by the matrix processes and filters    *
+    *                                                                 *
+    * Usage:   This file is included automatically, define            *
+    *          FORSYDE_BLAS to use a CBLAS library                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef MATRIX_KERNEL_HPP
+#define MATRIX_KERNEL_HPP
+
+/*! \file matrix_kernel.hpp
+ * \brief Implements the matrix tokens and the matrix product kernels
+ *
+ *  This file includes two matrix token types: dense_matrix, whose size
+ * is given at run time, and fixed_matrix, whose size is a part of its
+ * type and which is trivially copyable for trivially copyable elements.
+ * Both are stored in the row-major order.
+ *
+ *  The products are computed by the kernels gemv and gemm, which write
+ * their results into storage given by the caller and hence never
+ * allocate. The products of the fixed-size matrices have compile-time
+ * bounds, which the compiler unrolls. With FORSYDE_BLAS defined, the
+ * products of float and double matrices with at least
+ * FORSYDE_BLAS_THRESHOLD multiply-adds are computed by the CBLAS library
+ * instead (e.g., OpenBLAS, linked with -lopenblas).
+ */
+
+#include <vector>
+#include <array>
+#include <initializer_list>
+#include <ostream>
+#include <cstddef>
+#include <type_traits>
+
+#ifdef FORSYDE_BLAS
+#include <cblas.h>
+#endif
+
+//! The number of multiply-adds from which the products are computed by BLAS
+#ifndef FORSYDE_BLAS_THRESHOLD
+#define FORSYDE_BLAS_THRESHOLD 4096
+#endif
+
+namespace ForSyDe
+{
+
+//! Computes y = alpha*A*x + beta*y for a row-major m*n matrix A
+/*! The leading dimension lda is the distance between the rows of A.
+ * When beta is zero, y is not read.
+ */
+template <typename T>
+inline void gemv(size_t m, size_t n, T alpha, const T* A, size_t lda,
+                 const T* x, T beta, T* y)
+{
+#ifdef FORSYDE_BLAS
+    if (m*n >= FORSYDE_BLAS_THRESHOLD)
+    {
+        if constexpr (std::is_same<T,double>::value)
+        {
+            cblas_dgemv(CblasRowMajor, CblasNoTrans, m, n, alpha, A, lda, x, 1, beta, y, 1);
+            return;
+        }
+        else if constexpr (std::is_same<T,float>::value)
+        {
+            cblas_sgemv(CblasRowMajor, CblasNoTrans, m, n, alpha, A, lda, x, 1, beta, y, 1);
+            return;
+        }
+    }
+#endif
+    for (size_t i=0; i<m; i++)
+    {
+        const T* row = A + i*lda;
+        T acc = T();
+        for (size_t j=0; j<n; j++) acc += row[j] * x[j];
+        y[i] = beta == T() ? alpha * acc : alpha * acc + beta * y[i];
+    }
+}
+
+//! Computes C = alpha*A*B + beta*C for row-major m*k, k*n and m*n matrices
+/*! When beta is zero, C is not read. The loops are ordered so that the
+ * innermost one runs over the contiguous rows of B and C, which lets
+ * the compiler vectorize it.
+ */
+template <typename T>
+inline void gemm(size_t m, size_t n, size_t k, T alpha, const T* A, size_t lda,
+                 const T* B, size_t ldb, T beta, T* C, size_t ldc)
+{
+#ifdef FORSYDE_BLAS
+    if (m*n*k >= FORSYDE_BLAS_THRESHOLD)
+    {
+        if constexpr (std::is_same<T,double>::value)
+        {
+            cblas_dgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k,
+                        alpha, A, lda, B, ldb, beta, C, ldc);
+            return;
+        }
+        else if constexpr (std::is_same<T,float>::value)
+        {
+            cblas_sgemm(CblasRowMajor, CblasNoTrans, CblasNoTrans, m, n, k,
+                        alpha, A, lda, B, ldb, beta, C, ldc);
+            return;
+        }
+    }
+#endif
+    for (size_t i=0; i<m; i++)
+    {
+        T* crow = C + i*ldc;
+        for (size_t j=0; j<n; j++) crow[j] = beta == T() ? T() : beta * crow[j];
+        for (size_t p=0; p<k; p++)
+        {
+            const T a = alpha * A[i*lda+p];
+            const T* brow = B + p*ldb;
+            for (size_t j=0; j<n; j++) crow[j] += a * brow[j];
+        }
+    }
+}
+
+//! A matrix token whose size is given at run time
+template <typename T>
+class dense_matrix
+{
+public:
+    typedef T value_type;
+
+    dense_matrix() : nrows(0), ncols(0) {}
+
+    dense_matrix(size_t rows, size_t cols, const T& val=T())
+        : nrows(rows), ncols(cols), vals(rows*cols, val) {}
+
+    //! Builds a matrix from its rows
+    dense_matrix(std::initializer_list<std::initializer_list<T>> rows)
+        : nrows(rows.size()), ncols(rows.size() ? rows.begin()->size() : 0)
+    {
+        vals.reserve(nrows*ncols);
+        for (auto& r : rows) vals.insert(vals.end(), r.begin(), r.end());
+    }
+
+    size_t rows() const {return nrows;}
+    size_t cols() const {return ncols;}
+
+    //! Changes the size, keeping the storage if it is large enough
+    void resize(size_t rows, size_t cols)
+    {
+        nrows = rows;
+        ncols = cols;
+        vals.resize(rows*cols);
+    }
+
+    T& operator()(size_t i, size_t j) {return vals[i*ncols+j];}
+    const T& operator()(size_t i, size_t j) const {return vals[i*ncols+j];}
+
+    T* data() {return vals.data();}
+    const T* data() const {return vals.data();}
+
+    bool operator==(const dense_matrix& rhs) const
+    {
+        return nrows == rhs.nrows && ncols == rhs.ncols && vals == rhs.vals;
+    }
+
+private:
+    size_t nrows, ncols;
+    std::vector<T> vals;
+};
+
+//! A matrix token whose size is a part of its type
+template <typename T, size_t R, size_t C>
+struct fixed_matrix
+{
+    typedef T value_type;
+
+    std::array<T,R*C> vals;
+
+    static constexpr size_t rows() {return R;}
+    static constexpr size_t cols() {return C;}
+
+    T& operator()(size_t i, size_t j) {return vals[i*C+j];}
+    const T& operator()(size_t i, size_t j) const {return vals[i*C+j];}
+
+    T* data() {return vals.data();}
+    const T* data() const {return vals.data();}
+
+    bool operator==(const fixed_matrix& rhs) const {return vals == rhs.vals;}
+};
+
+//! Prints a matrix row by row
+template <typename M>
+inline auto print_matrix(std::ostream& os, const M& m) -> std::ostream&
+{
+    os << "[";
+    for (size_t i=0; i<m.rows(); i++)
+    {
+        os << (i ? ";" : "");
+        for (size_t j=0; j<m.cols(); j++) os << (j ? " " : "") << m(i,j);
+    }
+    return os << "]";
+}
+
+template <typename T>
+inline std::ostream& operator<<(std::ostream& os, const dense_matrix<T>& m)
+{
+    return print_matrix(os, m);
+}
+
+template <typename T, size_t R, size_t C>
+inline std::ostream& operator<<(std::ostream& os, const fixed_matrix<T,R,C>& m)
+{
+    return print_matrix(os, m);
+}
+
+//! Computes the product c = a*b of two dense matrices
+/*! The result is resized, which only allocates if it grows.
+ */
+template <typename T>
+inline bool matmul(dense_matrix<T>& c, const dense_matrix<T>& a, const dense_matrix<T>& b)
+{
+    if (a.cols() != b.rows()) return false;
+    c.resize(a.rows(), b.cols());
+    gemm(a.rows(), b.cols(), a.cols(), T(1), a.data(), a.cols(),
+         b.data(), b.cols(), T(), c.data(), c.cols());
+    return true;
+}
+
+//! Computes the product c = a*b of two fixed-size matrices
+/*! The loops have compile-time bounds.
+ */
+template <typename T, size_t R, size_t K, size_t C>
+inline bool matmul(fixed_matrix<T,R,C>& c, const fixed_matrix<T,R,K>& a,
+                   const fixed_matrix<T,K,C>& b)
+{
+    for (size_t i=0; i<R; i++)
+    {
+        for (size_t j=0; j<C; j++) c(i,j) = T();
+        for (size_t p=0; p<K; p++)
+            for (size_t j=0; j<C; j++) c(i,j) += a(i,p) * b(p,j);
+    }
+    return true;
+}
+
+//! Computes y = a*x of a dense matrix and a vector
+/*! The result is resized, which only allocates if it grows.
+ */
+template <typename T>
+inline bool matvec(std::vector<T>& y, const dense_matrix<T>& a, const std::vector<T>& x)
+{
+    if (a.cols() != x.size()) return false;
+    y.resize(a.rows());
+    gemv(a.rows(), a.cols(), T(1), a.data(), a.cols(), x.data(), T(), y.data());
+    return true;
+}
+
+//! Computes y = a*x of a fixed-size matrix and an array
+template <typename T, size_t R, size_t C>
+inline bool matvec(std::array<T,R>& y, const fixed_matrix<T,R,C>& a, const std::array<T,C>& x)
+{
+    for (size_t i=0; i<R; i++)
+    {
+        T acc = T();
+        for (size_t j=0; j<C; j++) acc += a(i,j) * x[j];
+        y[i] = acc;
+    }
+    return true;
+}
+
+//! The vector types multiplied by a matrix type
+template <typename M>
+struct matrix_vectors;
+
+template <typename T>
+struct matrix_vectors<dense_matrix<T>>
+{
+    typedef std::vector<T> in_type;
+    typedef std::vector<T> out_type;
+};
+
+template <typename T, size_t R, size_t C>
+struct matrix_vectors<fixed_matrix<T,R,C>>
+{
+    typedef std::array<T,C> in_type;
+    typedef std::array<T,R> out_type;
+};
+
+}
+
+#endif
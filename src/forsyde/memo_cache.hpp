@@ -0,0 +1,160 @@
+/**********************************************************************
+    * memo_cache.hpp -- A bounded cache for memoizing pure functions  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Caching the results of the functions passed to the     *
+    *          memoizing process constructors                         *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef MEMO_CACHE_HPP
+#define MEMO_CACHE_HPP
+
+/*! \file memo_cache.hpp
+ * \brief Implements a bounded cache of function results
+ *
+ *  This file includes the cache used by the memoizing process
+ * constructors (SY::memo_comb and SDF::memo_comb) to map the inputs of
+ * their functions to the outputs. It has a fixed capacity and evicts the
+ * entries with the CLOCK (second chance) policy, which approximates LRU
+ * without reordering the entries on every hit.
+ */
+
+#include <vector>
+#include <functional>
+#include <unordered_map>
+
+#include "abst_ext.hpp"
+
+//! The default number of entries of the memoizing caches
+#ifndef FORSYDE_MEMO_CAPACITY
+#define FORSYDE_MEMO_CAPACITY 1024
+#endif
+
+namespace ForSyDe
+{
+
+//! The hash function of the keys of the memoizing caches
+/*! It defaults to std::hash and is specialized for the absent-extended
+ * values and the vectors of tokens. It can be specialized for the user
+ * types, or another hash function can be given to the cache.
+ */
+template <typename T>
+struct memo_hash : std::hash<T> {};
+
+template <typename T>
+struct memo_hash<abst_ext<T>>
+{
+    size_t operator()(const abst_ext<T>& val) const
+    {
+        return is_absent(val) ? 0 : memo_hash<T>()(unsafe_from_abst_ext(val)) * 31 + 1;
+    }
+};
+
+template <typename T, typename A>
+struct memo_hash<std::vector<T,A>>
+{
+    size_t operator()(const std::vector<T,A>& vec) const
+    {
+        size_t h = vec.size();
+        for (auto& val : vec)
+            h ^= memo_hash<T>()(val) + 0x9e3779b97f4a7c15ULL + (h << 6) + (h >> 2);
+        return h;
+    }
+};
+
+//! A bounded cache from keys to values with the CLOCK eviction policy
+/*! The entries are stored in a ring whose slots are reused, hence no
+ * memory is allocated once the cache is full, except for the copies of
+ * the keys and values with dynamic sizes.
+ */
+template <typename K, typename V, typename Hash = memo_hash<K>>
+class memo_cache
+{
+public:
+    //! The constructor takes the maximum number of entries
+    explicit memo_cache(size_t capacity=FORSYDE_MEMO_CAPACITY)
+        : capacity(capacity > 0 ? capacity : 1), hand(0), hit_count(0), miss_count(0)
+    {
+        slots.reserve(this->capacity);
+        index.reserve(this->capacity);
+    }
+
+    //! Looks up a key and returns its value, or NULL if it is not cached
+    const V* find(const K& key)
+    {
+        auto it = index.find(key);
+        if (it == index.end())
+        {
+            miss_count++;
+            return NULL;
+        }
+        hit_count++;
+        slots[it->second].referenced = true;
+        return &slots[it->second].val;
+    }
+
+    //! Adds a key and its value, evicting an entry if the cache is full
+    void insert(const K& key, const V& val)
+    {
+        size_t s;
+        if (slots.size() < capacity)
+        {
+            s = slots.size();
+            slots.push_back(slot{key, val, false});
+        }
+        else
+        {
+            // the referenced entries get a second chance
+            while (slots[hand].referenced)
+            {
+                slots[hand].referenced = false;
+                hand = (hand + 1) % capacity;
+            }
+            s = hand;
+            hand = (hand + 1) % capacity;
+            index.erase(slots[s].key);
+            slots[s].key = key;
+            slots[s].val = val;
+            slots[s].referenced = false;
+        }
+        index.emplace(slots[s].key, s);
+    }
+
+    //! Removes all the entries
+    void clear()
+    {
+        slots.clear();
+        index.clear();
+        hand = 0;
+    }
+
+    //! The number of lookups which found their key
+    unsigned long long hits() const {return hit_count;}
+
+    //! The number of lookups which did not find their key
+    unsigned long long misses() const {return miss_count;}
+
+private:
+    struct slot
+    {
+        K key;
+        V val;
+        bool referenced;
+    };
+
+    size_t capacity;
+    std::vector<slot> slots;
+    std::unordered_map<K, size_t, Hash> index;
+    // the next slot considered for eviction
+    size_t hand;
+    unsigned long long hit_count, miss_count;
+};
+
+}
+
+#endif
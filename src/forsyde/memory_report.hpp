@@ -0,0 +1,179 @@
+/**********************************************************************
+    * memory_report.hpp -- Memory footprint of processes and signals  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Estimating the memory used by each process and signal  *
+    *          of an elaborated model                                 *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION and FORSYDE_MEMORY_REPORT *
+    *          to use it                                              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef MEMORY_REPORT_HPP
+#define MEMORY_REPORT_HPP
+
+/*! \file memory_report.hpp
+ * \brief Implements the report of the memory footprint of a model
+ *
+ *  This file includes an estimate of the bytes used by each leaf process
+ * (the stack of its thread, the process object, the buffers it allocates
+ * and its introspection information) and each signal (the channel object
+ * and its buffer), which are written in an XML file next to the
+ * introspection output, e.g.:
+ *
+ *     memory_monitor monitor("monitor", "gen/");
+ *
+ *  The size of a process object is only known if it is allocated by new
+ * (e.g., by the make_* helpers), otherwise the size of the process base
+ * class is reported. The data structures of the SystemC kernel (the
+ * thread objects, the ports and the events) and the memory owned by the
+ * tokens are not included. The stack size of the threads can be reduced
+ * with FORSYDE_STACK_SIZE or process::stack_size().
+ */
+
+#include <string>
+#include <fstream>
+
+#include "process_graph.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The estimated memory footprint of a process in bytes
+struct process_memory
+{
+    size_t stack = 0;           ///< the stack of the thread
+    size_t object = 0;          ///< the process object
+    size_t buffers = 0;         ///< the buffers allocated by the process
+    size_t introspection = 0;   ///< the arguments and the bound ports
+
+    size_t total() const {return stack + object + buffers + introspection;}
+};
+
+//! The estimated memory footprint of a signal in bytes
+struct signal_memory
+{
+    size_t object = 0;          ///< the channel object
+    size_t buffer = 0;          ///< the buffer of the tokens
+
+    size_t total() const {return object + buffer;}
+};
+
+//! Estimates the memory footprint of a process
+inline process_memory memory_of(const ForSyDe::process* p)
+{
+    process_memory m;
+    m.stack = p->stack_bytes;
+    m.object = p->alloc_bytes ? p->alloc_bytes : sizeof(ForSyDe::process);
+    m.buffers = p->buffer_bytes();
+    m.introspection = p->arg_vec.capacity() * sizeof(p->arg_vec[0]) +
+                      (p->boundInChans.capacity() + p->boundOutChans.capacity()) * sizeof(PortInfo);
+    for (auto& a : p->arg_vec)
+        m.introspection += std::get<0>(a).capacity() + std::get<1>(a).bytes();
+    return m;
+}
+
+//! Estimates the memory footprint of a signal
+inline signal_memory memory_of(const sc_interface* chan)
+{
+    signal_memory m;
+    if (auto fc = dynamic_cast<const footprint_channel*>(chan))
+    {
+        m.object = fc->object_bytes();
+        m.buffer = fc->buffer_bytes();
+    }
+    return m;
+}
+
+//! Writes the memory footprint of a graph to path + "memory.xml"
+/*! The totals of the model come first, followed by the processes and
+ * the signals.
+ */
+inline void write_memory_report(const process_graph& g, const std::string& path)
+{
+    const std::string file_name = path + "memory.xml";
+    std::ofstream out(file_name);
+    if (!out.is_open())
+    {
+        SC_REPORT_ERROR(file_name.c_str(), "file could not be opened to write the memory report. Does the path exists?");
+        return;
+    }
+    process_memory ptot;
+    signal_memory stot;
+    for (auto& n : g.nodes())
+    {
+        const process_memory m = memory_of(n.proc);
+        ptot.stack += m.stack;
+        ptot.object += m.object;
+        ptot.buffers += m.buffers;
+        ptot.introspection += m.introspection;
+    }
+    for (auto& ed : g.edges())
+    {
+        const signal_memory m = memory_of(ed.chan);
+        stot.object += m.object;
+        stot.buffer += m.buffer;
+    }
+    out << "<?xml version=\"1.0\" ?>\n<memory total=\"" << ptot.total() + stot.total() << "\">\n"
+        << "\t<processes count=\"" << g.nodes().size()
+        << "\" stack=\"" << ptot.stack
+        << "\" object=\"" << ptot.object
+        << "\" buffers=\"" << ptot.buffers
+        << "\" introspection=\"" << ptot.introspection
+        << "\" total=\"" << ptot.total() << "\"/>\n"
+        << "\t<signals count=\"" << g.edges().size()
+        << "\" object=\"" << stot.object
+        << "\" buffer=\"" << stot.buffer
+        << "\" total=\"" << stot.total() << "\"/>\n";
+    for (auto& n : g.nodes())
+    {
+        const process_memory m = memory_of(n.proc);
+        out << "\t<process name=\"" << n.name
+            << "\" kind=\"" << n.kind
+            << "\" stack=\"" << m.stack
+            << "\" object=\"" << m.object
+            << "\" buffers=\"" << m.buffers
+            << "\" introspection=\"" << m.introspection
+            << "\" total=\"" << m.total() << "\"/>\n";
+    }
+    for (auto& ed : g.edges())
+    {
+        auto obj = dynamic_cast<sc_object*>(ed.chan);
+        const signal_memory m = memory_of(ed.chan);
+        out << "\t<signal name=\"" << (obj ? obj->name() : "")
+            << "\" type=\"" << ed.token_type
+            << "\" object=\"" << m.object
+            << "\" buffer=\"" << m.buffer
+            << "\" total=\"" << m.total() << "\"/>\n";
+    }
+    out << "</memory>\n";
+}
+
+//! Writes the memory footprint of the model at the end of the simulation
+/*! The report is written to path + "memory.xml", e.g., next to the XML
+ * files of XMLExport, once the init stages have allocated the buffers.
+ */
+class memory_monitor : public sc_module
+{
+public:
+    memory_monitor(sc_module_name _name,    ///< The module name
+                   const std::string& path  ///< The output path
+                  ) : sc_module(_name), path(path) {}
+
+    void end_of_simulation()
+    {
+        write_memory_report(model_graph(), path);
+    }
+
+private:
+    std::string path;
+};
+
+}
+
+#endif
@@ -0,0 +1,326 @@
+/**********************************************************************
+    * metrics.hpp -- Live metrics of a running simulation             *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Publishing the progress of a long simulation while it  *
+    *          is running, in the Prometheus text format              *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION, FORSYDE_PROFILE and      *
+    *          FORSYDE_METRICS to use it                              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+/*! \file metrics.hpp
+ * \brief Implements an exporter of the live metrics of a simulation
+ *
+ *  This file includes a module which starts a thread when the simulation
+ * starts and periodically publishes the simulated time, its ratio to the
+ * wall-clock time, the firings and firing rates of each MoC, the hottest
+ * processes (by the time spent in their exec stages) and, when
+ * FORSYDE_SIGNAL_STATS is defined, the fill levels of the fullest
+ * signals, e.g.:
+ *
+ *     metrics_exporter metrics("metrics", "metrics.prom", 9464);
+ *
+ *  The metrics are written in the Prometheus text format to a file,
+ * which is replaced atomically, and/or served over HTTP on a port for
+ * scraping. The thread only reads the counters which the processes and
+ * the signals publish with relaxed atomic stores, hence it takes no locks
+ * and does not perturb the simulation.
+ */
+
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef __unix__
+#include <unistd.h>
+#include <poll.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include "process_graph.hpp"
+
+//! The period of publishing the metrics in milliseconds
+#ifndef FORSYDE_METRICS_PERIOD
+#define FORSYDE_METRICS_PERIOD 1000
+#endif
+
+//! The number of the hottest processes and the fullest signals published
+#ifndef FORSYDE_METRICS_TOP
+#define FORSYDE_METRICS_TOP 10
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Publishes the live metrics of the simulation from a separate thread
+class metrics_exporter : public sc_module
+{
+public:
+    //! The constructor takes the output file and the HTTP port
+    /*! An empty file name or a zero port disables the corresponding
+     * output.
+     */
+    metrics_exporter(sc_module_name _name,          ///< The module name
+                     const std::string& file,       ///< The output file
+                     unsigned port=0,               ///< The HTTP port
+                     unsigned period=FORSYDE_METRICS_PERIOD  ///< The period in ms
+                    ) : sc_module(_name), file(file), port(port), period(period),
+                        stop(false), listen_fd(-1), res_s(0), last_wall(0) {}
+
+    ~metrics_exporter() {finish();}
+
+    void start_of_simulation()
+    {
+        const process_graph& g = model_graph();
+        for (auto& n : g.nodes())
+        {
+            const std::string moc = n.kind.substr(0, n.kind.find(':'));
+            auto it = std::find(mocs.begin(), mocs.end(), moc);
+            if (it == mocs.end()) it = mocs.insert(mocs.end(), moc);
+            procs.push_back({n.proc, n.name, size_t(it - mocs.begin())});
+        }
+#ifdef FORSYDE_SIGNAL_STATS
+        for (auto& ed : g.edges())
+            if (auto sc = dynamic_cast<const stats_channel*>(ed.chan))
+                sigs.push_back({sc, dynamic_cast<sc_object*>(ed.chan)->name()});
+#endif
+        last_firings.assign(mocs.size(), 0);
+        res_s = sc_get_time_resolution().to_seconds();
+        origin = std::chrono::steady_clock::now();
+        open_port();
+        worker = std::thread([this] {run();});
+    }
+
+    void end_of_simulation()
+    {
+        finish();
+        if (!file.empty()) write_file(snapshot());
+    }
+
+private:
+    struct proc_entry
+    {
+        const ForSyDe::process* proc;
+        std::string name;
+        size_t moc;
+    };
+
+#ifdef FORSYDE_SIGNAL_STATS
+    struct signal_entry
+    {
+        const stats_channel* chan;
+        std::string name;
+    };
+    std::vector<signal_entry> sigs;
+#endif
+
+    std::string file;
+    unsigned port, period;
+    std::vector<std::string> mocs;
+    std::vector<proc_entry> procs;
+    std::thread worker;
+    std::atomic<bool> stop;
+    int listen_fd;
+    double res_s;           // the time resolution in seconds
+    std::chrono::steady_clock::time_point origin;
+    // the firings of each MoC and the wall-clock time of the last snapshot
+    std::vector<unsigned long long> last_firings;
+    double last_wall;
+
+    //! Stops the thread
+    void finish()
+    {
+        stop = true;
+        if (worker.joinable()) worker.join();
+#ifdef __unix__
+        if (listen_fd >= 0) close(listen_fd);
+#endif
+        listen_fd = -1;
+    }
+
+    //! Starts listening on the HTTP port
+    void open_port()
+    {
+#ifdef __unix__
+        if (port == 0) return;
+        listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+        const int one = 1;
+        setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_ANY);
+        addr.sin_port = htons(port);
+        if (listen_fd < 0 || bind(listen_fd, (sockaddr*)&addr, sizeof(addr)) < 0 ||
+            listen(listen_fd, 4) < 0)
+        {
+            SC_REPORT_WARNING(name(), "the metrics port could not be opened");
+            if (listen_fd >= 0) close(listen_fd);
+            listen_fd = -1;
+        }
+#else
+        if (port != 0)
+            SC_REPORT_WARNING(name(), "serving the metrics over HTTP is not supported");
+#endif
+    }
+
+    //! The body of the exporter thread
+    void run()
+    {
+        auto next = std::chrono::steady_clock::now();
+        while (!stop)
+        {
+            next += std::chrono::milliseconds(period);
+            // serve the requests until the next snapshot is due
+            while (!stop && std::chrono::steady_clock::now() < next)
+            {
+                const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                      next - std::chrono::steady_clock::now()).count();
+                // wake up regularly to notice the end of the simulation
+                const int wait_ms = (int)std::max<long long>(0, std::min<long long>(left, 100));
+#ifdef __unix__
+                if (listen_fd >= 0)
+                {
+                    pollfd pfd{listen_fd, POLLIN, 0};
+                    if (poll(&pfd, 1, wait_ms) > 0) serve();
+                    continue;
+                }
+#endif
+                std::this_thread::sleep_for(std::chrono::milliseconds(wait_ms));
+            }
+            if (!stop && !file.empty()) write_file(snapshot());
+        }
+    }
+
+    //! Answers an HTTP request with the current metrics
+    void serve()
+    {
+#ifdef __unix__
+        const int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) return;
+        char req[1024];
+        if (read(fd, req, sizeof(req)) >= 0)
+        {
+            const std::string body = snapshot();
+            const std::string head = "HTTP/1.0 200 OK\r\n"
+                "Content-Type: text/plain; version=0.0.4\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+            const std::string msg = head + body;
+            for (size_t sent = 0; sent < msg.size();)
+            {
+                const ssize_t k = write(fd, msg.data() + sent, msg.size() - sent);
+                if (k <= 0) break;
+                sent += k;
+            }
+        }
+        close(fd);
+#endif
+    }
+
+    //! Writes the metrics to a temporary file and renames it to the output
+    void write_file(const std::string& body)
+    {
+        const std::string tmp = file + ".tmp";
+        {
+            std::ofstream ofs(tmp);
+            if (!ofs.is_open()) return;
+            ofs << body;
+        }
+        std::rename(tmp.c_str(), file.c_str());
+    }
+
+    //! Writes a label value escaped for the Prometheus text format
+    static std::string label(const std::string& s)
+    {
+        std::string res;
+        for (char c : s)
+            if (c == '"' || c == '\\') {res += '\\'; res += c;}
+            else res += c;
+        return res;
+    }
+
+    //! Formats the current values of the counters
+    /*! It is called by the exporter thread, and by the simulation once it
+     * has ended.
+     */
+    std::string snapshot()
+    {
+        const double wall = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - origin).count();
+        std::uint64_t sim = 0;
+        std::vector<unsigned long long> firings(mocs.size(), 0);
+        std::vector<std::pair<std::uint64_t,size_t>> hot;
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            const live_counters& c = procs[i].proc->live;
+            sim = std::max(sim, c.sim_time.load(std::memory_order_relaxed));
+            firings[procs[i].moc] += c.firings.load(std::memory_order_relaxed);
+            hot.push_back({c.exec_ns.load(std::memory_order_relaxed), i});
+        }
+        const size_t top = std::min<size_t>(hot.size(), FORSYDE_METRICS_TOP);
+        std::partial_sort(hot.begin(), hot.begin()+top, hot.end(),
+                          [](const std::pair<std::uint64_t,size_t>& a,
+                             const std::pair<std::uint64_t,size_t>& b) {return a.first > b.first;});
+        std::ostringstream out;
+        out << "# TYPE forsyde_sim_time_seconds gauge\n"
+            << "forsyde_sim_time_seconds " << sim * res_s << "\n"
+            << "# TYPE forsyde_wall_time_seconds gauge\n"
+            << "forsyde_wall_time_seconds " << wall << "\n"
+            << "# TYPE forsyde_sim_wall_ratio gauge\n"
+            << "forsyde_sim_wall_ratio " << (wall > 0 ? sim * res_s / wall : 0) << "\n"
+            << "# TYPE forsyde_firings_total counter\n";
+        for (size_t m=0; m<mocs.size(); m++)
+            out << "forsyde_firings_total{moc=\"" << label(mocs[m]) << "\"} " << firings[m] << "\n";
+        out << "# TYPE forsyde_firing_rate gauge\n";
+        const double dt = wall - last_wall;
+        for (size_t m=0; m<mocs.size(); m++)
+            out << "forsyde_firing_rate{moc=\"" << label(mocs[m]) << "\"} "
+                << (dt > 0 ? (firings[m] - last_firings[m]) / dt : 0) << "\n";
+        last_firings = firings;
+        last_wall = wall;
+        out << "# TYPE forsyde_process_exec_seconds_total counter\n";
+        for (size_t k=0; k<top; k++)
+            out << "forsyde_process_exec_seconds_total{process=\"" << label(procs[hot[k].second].name)
+                << "\"} " << hot[k].first * 1e-9 << "\n";
+        out << "# TYPE forsyde_process_firings_total counter\n";
+        for (size_t k=0; k<top; k++)
+            out << "forsyde_process_firings_total{process=\"" << label(procs[hot[k].second].name)
+                << "\"} " << procs[hot[k].second].proc->live.firings.load(std::memory_order_relaxed)
+                << "\n";
+#ifdef FORSYDE_SIGNAL_STATS
+        std::vector<std::pair<size_t,size_t>> full;
+        for (size_t i=0; i<sigs.size(); i++)
+            full.push_back({sigs[i].chan->live_occupancy(), i});
+        const size_t stop_sig = std::min<size_t>(full.size(), FORSYDE_METRICS_TOP);
+        std::partial_sort(full.begin(), full.begin()+stop_sig, full.end(),
+                          [](const std::pair<size_t,size_t>& a,
+                             const std::pair<size_t,size_t>& b) {return a.first > b.first;});
+        out << "# TYPE forsyde_signal_fill gauge\n";
+        for (size_t k=0; k<stop_sig; k++)
+            out << "forsyde_signal_fill{signal=\"" << label(sigs[full[k].second].name)
+                << "\"} " << full[k].first << "\n";
+#endif
+        return out.str();
+    }
+};
+
+}
+
+#endif
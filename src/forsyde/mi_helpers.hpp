@@ -29,23 +29,25 @@ namespace ForSyDe
 
 using namespace sc_core;
 
+#ifndef FORSYDE_NO_CT
 //! Helper function to construct an SY2CT MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the synchronous to the continuous-time MoC and connect its input
- * and output signals.
+ * and output signals. The value type T is CTTYPE unless it is given.
  * It provides a more functional style definition of a ForSyDe MI.
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class IIf>
-inline SY2CT* make_SY2CT(std::string pName,
+template <class T=CTTYPE, class OIf, class IIf>
+inline basic_SY2CT<T>* make_SY2CT(std::string pName,
     sc_time sample_period,     ///< The sampling period
     A2DMode op_mode,          ///< The operation mode
     OIf& outS,
-    IIf& inpS
+    IIf& inpS,
+    unsigned block = 1        ///< The samples per output sub-signal
     )
 {
-    auto p = new SY2CT(pName.c_str(), sample_period, op_mode);
+    auto p = new basic_SY2CT<T>(pName.c_str(), sample_period, op_mode, block);
     
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -56,19 +58,42 @@ inline SY2CT* make_SY2CT(std::string pName,
 //! Helper function to construct an CT2SY MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the continuous-time to the synchronous MoC and connect its input
- * and output signals.
+ * and output signals. The value type T is CTTYPE unless it is given.
  * It provides a more functional style definition of a ForSyDe MI.
  * It also removes bilerplate code by using type-inference feature of
  * C++ and automatic binding to the input and output FIFOs.
  */
-template <class OIf, class IIf>
-inline CT2SY* make_CT2SY(std::string pName,
+template <class T=CTTYPE, class OIf, class IIf>
+inline basic_CT2SY<T>* make_CT2SY(std::string pName,
     sc_time sample_period,     ///< The sampling period
     OIf& outS,
     IIf& inpS
     )
 {
-    auto p = new CT2SY(pName.c_str(), sample_period);
+    auto p = new basic_CT2SY<T>(pName.c_str(), sample_period);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a CT2SYv MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the continuous-time to the synchronous MoC for vector-valued
+ * signals and connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class OIf, std::size_t N>
+inline CT2SYv<N>* make_CT2SYv(std::string pName,
+    sc_time sample_period,     ///< The sampling period
+    OIf& outS,
+    CT::vsignal<N>& inpS
+    )
+{
+    auto p = new CT2SYv<N>(pName.c_str(), sample_period);
     
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -76,6 +101,31 @@ inline CT2SY* make_CT2SY(std::string pName,
     return p;
 }
 
+//! Helper function to construct a multi-rate CT2SY MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the continuous-time to the synchronous MoC and connect its input
+ * and output signals, where the i-th output signal is sampled with the
+ * i-th sampling period.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class OIf, class IIf>
+inline CT2SY_multirate* make_CT2SY_multirate(std::string pName,
+    const std::vector<sc_time>& sample_periods, ///< The sampling periods
+    const std::vector<OIf*>& outS,
+    IIf& inpS
+    )
+{
+    auto p = new CT2SY_multirate(pName.c_str(), sample_periods);
+    
+    (*p).iport1(inpS);
+    for (size_t i=0; i<outS.size(); i++)
+        (*p).oport(i)(*outS[i]);
+    
+    return p;
+}
+
 //! Helper function to construct an CT2DDE MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the continuous-time to the discrete-event MoC and connect its
@@ -123,6 +173,31 @@ inline CT2DDEf<T>* make_CT2DDEf(std::string pName,
     return p;
 }
 
+//! Helper function to construct a CT2DDE_crossing MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the continuous-time to the discrete-event MoC which detects the
+ * level crossings of its input, and connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T, template <class> class OIf, class IIf>
+inline CT2DDE_crossing<T>* make_CT2DDE_crossing(std::string pName,
+    CTTYPE level,
+    crossing_mode mode,
+    sc_time tolerance,
+    OIf<T>& outS,
+    IIf& inpS
+    )
+{
+    auto p = new CT2DDE_crossing<T>(pName.c_str(), level, mode, tolerance);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct an DDE2CT MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the discrete-event MoC to the continuous-time and connect its
@@ -146,6 +221,9 @@ inline DDE2CT<T>* make_DDE2CT(std::string pName,
     return p;
 }
 
+#endif
+
+#ifndef FORSYDE_NO_SDF
 //! Helper function to construct an SY2SDF MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the synchronous to synchronous dataflow MoC and connect its
@@ -168,6 +246,24 @@ inline SY2SDF<T>* make_SY2SDF(std::string pName,
     return p;
 }
 
+//! Helper function to construct an SY2SDF MoC interface with a rate
+/*! The interface packs o1toks present SY tokens into each SDF firing.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline SY2SDF<T>* make_SY2SDF(std::string pName,
+    unsigned int o1toks,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new SY2SDF<T>(pName.c_str(), o1toks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct an SDF2SY MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the synchronous dataflow MoC to the synchronous and connect its
@@ -190,6 +286,27 @@ inline SDF2SY<T>* make_SDF2SY(std::string pName,
     return p;
 }
 
+//! Helper function to construct an SDF2SY MoC interface with a rate
+/*! The interface unpacks i1toks SDF tokens in each firing.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline SDF2SY<T>* make_SDF2SY(std::string pName,
+    unsigned int i1toks,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new SDF2SY<T>(pName.c_str(), i1toks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+#endif
+
+#ifndef FORSYDE_NO_DDE
 //! Helper function to construct an SY2DDE MoC interface
 /*! This function is used to construct a MoC interface (SystemC module)
  * from the synchronous to discrete-event MoC and connect its
@@ -236,6 +353,156 @@ inline DDE2SY<T>* make_DDE2SY(std::string pName,
     return p;
 }
 
+#endif
+
+#if !defined(FORSYDE_NO_SDF) && !defined(FORSYDE_NO_DDE)
+//! Helper function to construct an SDF2DDE MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the synchronous dataflow to the discrete-event MoC and connect its input
+ * and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline SDF2DDE<T>* make_SDF2DDE(std::string pName,
+    sc_time sample_period,    ///< The unified period length
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new SDF2DDE<T>(pName.c_str(), sample_period);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct an DDE2SDF MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the discrete-event to the synchronous dataflow MoC and connect its input
+ * and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline DDE2SDF<T>* make_DDE2SDF(std::string pName,
+    sc_time sample_period,    ///< The unified period length
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new DDE2SDF<T>(pName.c_str(), sample_period);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+#endif
+
+#ifndef FORSYDE_NO_DT
+//! Helper function to construct an SY2DT MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the synchronous to the discrete-time MoC and connect its input
+ * and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline SY2DT<T>* make_SY2DT(std::string pName,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new SY2DT<T>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct an DT2SY MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the discrete-time to the synchronous MoC and connect its input
+ * and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline DT2SY<T>* make_DT2SY(std::string pName,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new DT2SY<T>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+#ifndef FORSYDE_NO_DDE
+//! Helper function to construct an DT2DDE MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the discrete-time to the discrete-event MoC and connect its input
+ * and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T, template <class> class OIf, template <class> class IIf>
+inline DT2DDE<T>* make_DT2DDE(std::string pName,
+    sc_time sample_period,    ///< The length of a time step
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new DT2DDE<T>(pName.c_str(), sample_period);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+#endif
+
+#ifndef FORSYDE_NO_CT
+//! Helper function to construct an CT2DT MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the continuous-time to the discrete-time MoC and connect its input
+ * and output signals.
+ * It provides a more functional style definition of a ForSyDe MI.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class OIf, class IIf>
+inline CT2DT* make_CT2DT(std::string pName,
+    sc_time sample_period,    ///< The sampling period
+    OIf& outS,
+    IIf& inpS
+    )
+{
+    auto p = new CT2DT(pName.c_str(), sample_period);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+#endif
+
+#endif
+
 }
 
 #endif
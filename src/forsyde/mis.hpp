@@ -22,6 +22,18 @@
  * facilities used for creating MoC interfaces between different MoCs.
  */
 
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+//! The maximum number of samples produced by CT2SY in one cycle
+/*! All the samples which fall in an input sub-signal are produced in
+ * one cycle, up to this number.
+ */
+#ifndef FORSYDE_CT2SY_BATCH
+#define FORSYDE_CT2SY_BATCH 1024
+#endif
+
 namespace ForSyDe
 {
 using namespace sc_core;
@@ -29,6 +41,10 @@ using namespace sc_core;
 //! Operation modes for the SY2CT converter
 enum A2DMode {LINEAR, HOLD};
 
+//! The directions of the crossings detected by CT2DDE_crossing
+enum crossing_mode {CROSS_RISING, CROSS_FALLING, CROSS_BOTH};
+
+#ifndef FORSYDE_NO_CT
 //! Process constructor for a SY2CT MoC interfaces
 /*! This class is used to build a MoC interface which converts an SY 
  * signal to a CT one. It can be used to implement digital-to-analog
@@ -36,31 +52,41 @@ enum A2DMode {LINEAR, HOLD};
  * the initial values of the constructor:
  * - sample and hold
  * - linear interpolation
+ *
+ *  In the block mode, the converter reads a block of samples in each
+ * evaluation cycle and produces a single sub-signal covering their
+ * periods, which interpolates or holds a table of the samples. Hence the
+ * fast converters cost one output sub-signal and one timed wait per block
+ * instead of per sample, and the samplers downstream evaluate the blocks
+ * in batches. The output is the same, but it is produced a block at a
+ * time.
+ *
+ * The values are of type T, which is CTTYPE for SY2CT.
  */
-class SY2CT : public process
+template <class T>
+class basic_SY2CT : public process
 {
 public:
-    SY::SY_in<CTTYPE> iport1;      ///< port for the input channel
-	CT::CT_out oport1;              ///< port for the output channel
+    SY::SY_in<T> iport1;           ///< port for the input channel
+    typename CT::ct_types<T>::out_port oport1; ///< port for the output channel
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
      * applies the user-imlpemented function to it and writes the
      * results using the output port
      */
-    SY2CT(sc_module_name _name,      ///< process name
+    basic_SY2CT(sc_module_name _name,      ///< process name
           sc_time sample_period,     ///< The sampling period
-          A2DMode op_mode = HOLD    ///< The operation mode
+          A2DMode op_mode = HOLD,    ///< The operation mode
+          unsigned block = 1         ///< The samples per output sub-signal
           ) : process(_name), iport1("iport1"), oport1("oport1"),
-              sample_period(sample_period), op_mode(op_mode)
+              sample_period(sample_period), op_mode(op_mode),
+              block(std::max(block, 1u))
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << sample_period;
-        arg_vec.push_back(std::make_tuple("sample_period", ss.str()));
-        ss.str("");
-        ss << op_mode;
-        arg_vec.push_back(std::make_tuple("op_mode", ss.str()));
+        add_arg("sample_period", sample_period);
+        add_arg("op_mode", op_mode);
+        add_arg("block", block);
 #endif
     }
     
@@ -70,54 +96,56 @@ public:
 private:
     sc_time sample_period;
 	A2DMode op_mode;
+    unsigned block;
     
     // Internal variables
-    CTTYPE previousVal, currentVal;
-    sub_signal subsig;
+    T previousVal, currentVal;
+    basic_sub_signal<T> subsig;
     unsigned long iter;
+    // The input tokens of a block
+    std::vector<abst_ext<T>> toks;
     
     //Implementing the abstract semantics
     void init()
     {
-        currentVal = previousVal = 0;
+        currentVal = previousVal = T();
         iter = 0;
     }
     
     void prep()
     {
-        currentVal = (CTTYPE)from_abst_ext(iport1.read(), previousVal);
+        if (block > 1)
+            iport1.read_n(toks, block);
+        else
+            currentVal = (T)from_abst_ext(iport1.read(), previousVal);
     }
     
     void exec()
     {
-        set_range(subsig, sample_period*iter, sample_period*(iter+1));
-        if(op_mode==HOLD)
+        const sc_time st = scale_time(sample_period, iter);
+        if (block > 1)
         {
-            CTTYPE pv = previousVal;
-            set_function(subsig,[pv](const sc_time& t)
-                                {
-                                    return pv;
-                                }
-            );
-        }
-        else 
-        {
-            CTTYPE dv = currentVal - previousVal;
-            CTTYPE pv = previousVal;
-            unsigned long itr = iter;
-            sc_time sp = sample_period;
-            set_function(subsig,[pv,itr,sp,dv](const sc_time& t)
-            {
-                return (t-itr*sp)/sp*dv + pv;
-            });
+            // the sample of each period is interpolated towards the next one
+            std::vector<T> samples(block+1);
+            samples[0] = previousVal;
+            for (unsigned i=0; i<block; i++)
+                samples[i+1] = (T)from_abst_ext(toks[i], samples[i]);
+            currentVal = samples[block];
+            subsig = basic_sub_signal<T>::table(st, st+scale_time(sample_period, block),
+                        sample_period, std::move(samples), op_mode==HOLD);
         }
+        else if(op_mode==HOLD)
+            subsig = basic_sub_signal<T>::constant(st, st+sample_period, previousVal);
+        else
+            subsig = basic_sub_signal<T>::linear(st, st+sample_period, previousVal,
+                        (currentVal - previousVal)/in_seconds(sample_period));
     }
     
     void prod()
     {
         write_multiport(oport1, subsig);
-        wait(get_end_time(subsig) - sc_time_stamp());
-        iter++;
+        wait(get_end_time(subsig) - model_time());
+        iter += block;
         previousVal = currentVal;
     }
     
@@ -134,31 +162,64 @@ private:
 #endif
 };
 
+//! The SY2CT converter of CTTYPE values
+typedef basic_SY2CT<CTTYPE> SY2CT;
+
+//! Samples a sub-signal periodically until its end
+/*! The samples start from the sampling time, which is advanced past
+ * the produced samples. The time of the last sample is stored in
+ * last_time if any sample is produced.
+ */
+template <typename V>
+inline void sample_segment(const basic_sub_signal<V>& ss, const sc_time& end_time,
+                           const sc_time& period, sc_time& sampling_time,
+                           sc_time& last_time,
+                           std::vector<abst_ext<V>>& vals)
+{
+    vals.clear();
+    if (sampling_time >= end_time) return;
+    const size_t n = std::min({ss.count_samples(sampling_time, period),
+        size_t((to_ticks(end_time) - to_ticks(sampling_time) - 1) / to_ticks(period) + 1),
+        size_t(FORSYDE_CT2SY_BATCH)});
+    if (n == 0) return;
+    thread_local std::vector<V> buf;
+    buf.resize(n);
+    ss.sample_uniform(sampling_time, period, n, buf.data());
+    vals.assign(buf.begin(), buf.end());
+    last_time = sampling_time + scale_time(period, n-1);
+    sampling_time = last_time + period;
+}
+
 //! Process constructor for a CT2SY MoC interface
 /*! This class is used to build a MoC interface which converts an CT 
  * signal to a SY one with fixed sampling rate. It can be used to implement 
  * analog-to-digital converters.
+ *
+ * All the samples which fall in the range of an input sub-signal are
+ * produced in one evaluation cycle (up to FORSYDE_CT2SY_BATCH samples),
+ * using the batch sampling of the sub-signals.
+ *
+ * The values are of type T, which is CTTYPE for CT2SY.
  */
-class CT2SY : public process
+template <class T>
+class basic_CT2SY : public process
 {
 public:
-    CT::CT_in iport1;           ///< port for the input channel
-    SY::SY_out<CTTYPE> oport1; ///< port for the output channel
+    typename CT::ct_types<T>::in_port iport1; ///< port for the input channel
+    SY::SY_out<T> oport1;       ///< port for the output channel
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
      * applies the user-imlpemented function to it and writes the
      * results using the output port
      */
-    CT2SY(sc_module_name _name,      ///< process name
+    basic_CT2SY(sc_module_name _name,      ///< process name
           sc_time sample_period      ///< The sampling period
           ) : process(_name), iport1("iport1"), oport1("oport1"),
               sample_period(sample_period)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << sample_period;
-        arg_vec.push_back(std::make_tuple("sample_period", ss.str()));
+        add_arg("sample_period", sample_period);
 #endif
     }
     
@@ -169,14 +230,15 @@ private:
     sc_time sample_period;
     
     // Internal variables
-    sub_signal in_ss;
-    CTTYPE out_val;
-    sc_time local_time, sampling_time;
+    basic_sub_signal<T> in_ss;
+    std::vector<abst_ext<T>> out_vals;
+    sc_time local_time, sampling_time, last_time;
     
     //Implementing the abstract semantics
     void init()
     {
         local_time = sampling_time = SC_ZERO_TIME;
+        out_vals.reserve(FORSYDE_CT2SY_BATCH);
     }
     
     void prep()
@@ -190,14 +252,15 @@ private:
     
     void exec()
     {
-        out_val = in_ss(sampling_time);
+        last_time = sampling_time;
+        sample_segment(in_ss, local_time, sample_period, sampling_time,
+                       last_time, out_vals);
     }
     
     void prod()
     {
-        write_multiport(oport1, out_val);
-        wait(sampling_time - sc_time_stamp());
-        sampling_time += sample_period;
+        write_vec_multiport(oport1, out_vals);
+        wait(last_time - model_time());
     }
     
     void clean() {}
@@ -213,16 +276,134 @@ private:
 #endif
 };
 
+//! The CT2SY converter of CTTYPE values
+typedef basic_CT2SY<CTTYPE> CT2SY;
+
+//! The CT2SY converter of vector-valued signals
+/*! It samples all the N channels of a vector-valued CT signal at once
+ * and produces an SY signal of vectors.
+ */
+template <std::size_t N>
+using CT2SYv = basic_CT2SY<ct_vector<N>>;
+
+//! Process constructor for a multi-rate CT2SY MoC interface
+/*! This class is used to build a MoC interface which samples a CT
+ * signal with several sampling periods, each one producing an SY signal
+ * on a separate output port. It is equivalent to a fan-out followed by
+ * a CT2SY per sampling period, but the input sub-signals are read only
+ * once.
+ */
+class CT2SY_multirate : public process
+{
+public:
+    CT::CT_in iport1;           ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * and writes the samples of each sampling period to the
+     * corresponding output port
+     */
+    CT2SY_multirate(sc_module_name _name,   ///< process name
+          const std::vector<sc_time>& sample_periods ///< The sampling periods
+          ) : process(_name), iport1("iport1"), sample_periods(sample_periods)
+    {
+        for (size_t i=0; i<sample_periods.size(); i++)
+            oports.emplace_back(new SY::SY_out<CTTYPE>(
+                ("oport"+std::to_string(i+1)).c_str()));
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.emplace_back("sample_periods", arg_value([this]()
+        {
+            std::stringstream ss;
+            ss << "{";
+            for (size_t i=0; i<this->sample_periods.size(); i++)
+                ss << (i>0?",":"") << this->sample_periods[i];
+            ss << "}";
+            return ss.str();
+        }));
+#endif
+    }
+    
+    //! The output port of a sampling period
+    SY::SY_out<CTTYPE>& oport(size_t i) {return *oports[i];}
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::CT2SY_multirate";}
+
+private:
+    std::vector<sc_time> sample_periods;
+    std::vector<std::unique_ptr<SY::SY_out<CTTYPE>>> oports;
+    
+    // Internal variables
+    sub_signal in_ss;
+    std::vector<std::vector<abst_ext<CTTYPE>>> out_vals;
+    sc_time local_time, last_time;
+    std::vector<sc_time> sampling_times;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        local_time = SC_ZERO_TIME;
+        sampling_times.assign(sample_periods.size(), SC_ZERO_TIME);
+        out_vals.resize(sample_periods.size());
+    }
+    
+    void prep()
+    {
+        if (sampling_times.empty()) wait();
+        const sc_time next = *std::min_element(sampling_times.begin(),
+                                               sampling_times.end());
+        while (next >= local_time)
+        {
+            in_ss = iport1.read();
+            local_time = get_end_time(in_ss);
+        }
+    }
+    
+    void exec()
+    {
+        last_time = model_time();
+        for (size_t i=0; i<sample_periods.size(); i++)
+        {
+            sc_time last = SC_ZERO_TIME;
+            sample_segment(in_ss, local_time, sample_periods[i],
+                           sampling_times[i], last, out_vals[i]);
+            if (!out_vals[i].empty()) last_time = std::max(last_time, last);
+        }
+    }
+    
+    void prod()
+    {
+        for (size_t i=0; i<oports.size(); i++)
+            write_vec_multiport(*oports[i], out_vals[i]);
+        wait(last_time - model_time());
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(oports.size());
+        for (size_t i=0; i<oports.size(); i++)
+            boundOutChans[i].port = oports[i].get();
+    }
+#endif
+};
+
 //! Process constructor for a CT2DDE MoC interface
 /*! This class is used to build a MoC interface which converts an CT 
  * signal to a DDE one with adaptive sampling rate. It can be used to
  * implement analog-to-digital converters with adaptive sampling rates.
+ *
+ * The values of the CT signal are of type V and converted to T.
  */
-template<class T>
+template<class T, class V=CTTYPE>
 class CT2DDE : public process
 {
 public:
-    CT::CT_in iport1;               ///< port for the input channel
+    typename CT::ct_types<V>::in_port iport1; ///< port for the input channel
     DDE::DDE_in<unsigned int> iport2; ///< port for the sampling channel
     DDE::DDE_out<T> oport1;           ///< port for the output channel
 
@@ -240,8 +421,8 @@ public:
 
 private:    
     // Internal variables
-    sub_signal f;
-    std::vector<sub_signal > vecCTsignal; // a queue to be committed
+    basic_sub_signal<V> f;
+    std::vector<basic_sub_signal<V>> vecCTsignal; // a queue to be committed
     //~ sub_signal in_val;
     abst_ext<T> out_val;
     sc_time samplingT;
@@ -280,8 +461,8 @@ private:
             }
             if((samplingT >= get_start_time(f)) && (samplingT < get_end_time(f)))
             {
-                write_multiport(oport1,ttn_event<T>(f(samplingT), samplingT));
-                wait(samplingT - sc_time_stamp());
+                write_multiport(oport1,ttn_event<T>(T(f(samplingT)), samplingT));
+                wait(samplingT - model_time());
             }
             else if(samplingT >= get_end_time(f))
             {
@@ -290,8 +471,8 @@ private:
                     vecCTsignal.push_back(f);
                 if ((samplingT >= get_start_time(f)) && (samplingT < get_end_time(f)))
                 {
-                    write_multiport(oport1,ttn_event<T>(f(samplingT), samplingT));
-                    wait(samplingT - sc_time_stamp());
+                    write_multiport(oport1,ttn_event<T>(T(f(samplingT)), samplingT));
+                    wait(samplingT - model_time());
                 }
                 else
                 {
@@ -301,8 +482,8 @@ private:
                         if(samplingType==0)
                             vecCTsignal.push_back(f);
                     }
-                    write_multiport(oport1,ttn_event<T>(f(samplingT), samplingT));
-                    wait(samplingT - sc_time_stamp());
+                    write_multiport(oport1,ttn_event<T>(T(f(samplingT)), samplingT));
+                    wait(samplingT - model_time());
                 }
             }
             else
@@ -314,8 +495,8 @@ private:
                         vecCTsignal.erase(vecCTsignal.begin());
                     else
                     {
-                        write_multiport(oport1,ttn_event<T>(vecCTsignal.front()(samplingT), samplingT));
-                        wait(samplingT - sc_time_stamp());
+                        write_multiport(oport1,ttn_event<T>(T(vecCTsignal.front()(samplingT)), samplingT));
+                        wait(samplingT - model_time());
                         break;
                     }
                 }
@@ -357,12 +538,14 @@ private:
 /*! This class is used to build a MoC interface which converts a CT 
  * signal to a DDE one with fixed sampling rate. It can be used to
  * implement analog-to-digital converters with fixed sampling rates.
+ *
+ * The values of the CT signal are of type V and converted to T.
  */
-template<class T>
+template<class T, class V=CTTYPE>
 class CT2DDEf : public process
 {
 public:
-    CT::CT_in iport1;               ///< port for the input channel
+    typename CT::ct_types<V>::in_port iport1; ///< port for the input channel
     DDE::DDE_out<T> oport1;           ///< port for the output channel
 
     //! The constructor requires the module name
@@ -383,7 +566,7 @@ private:
     sc_time samp_period;
     abst_ext<T> out_val;
     sc_time local_time, sampling_time;
-    sub_signal in_ss;
+    basic_sub_signal<V> in_ss;
     
     //Implementing the abstract semantics
     void init()
@@ -402,13 +585,13 @@ private:
     
     void exec()
     {
-        out_val = abst_ext<T>(in_ss(sampling_time));
+        out_val = abst_ext<T>(T(in_ss(sampling_time)));
     }
     
     void prod()
     {
         write_multiport(oport1,ttn_event<T>(out_val, sampling_time));
-        wait(sampling_time - sc_time_stamp());
+        wait(sampling_time - model_time());
         sampling_time += samp_period;
     }
     
@@ -425,6 +608,163 @@ private:
 #endif
 };
 
+//! Process constructor for a level-crossing CT2DDE MoC interface
+/*! This class is used to build a MoC interface which detects the
+ * instants where a CT signal crosses a given level, and emits a DDE
+ * event only at those instants. The value of the event is the value of
+ * the signal at the detected instant.
+ *
+ * The signal is checked at the start of each input sub-signal and, for
+ * the sub-signals which are neither constant nor linear, every scan step
+ * in between. A change of side between two consecutive points is then
+ * located using the Illinois (modified regula falsi) method until the
+ * bracket is smaller than the tolerance. The reported instant is the end
+ * of the final bracket, i.e., the first instant known to be after the
+ * crossing. Hence the work is proportional to the number of the input
+ * sub-signals and the detected crossings, rather than to a fine sampling
+ * rate. Crossings which happen and are undone between two checked points
+ * are not detected.
+ */
+template<class T>
+class CT2DDE_crossing : public process
+{
+public:
+    CT::CT_in iport1;               ///< port for the input channel
+    DDE::DDE_out<T> oport1;           ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * detects the crossings and writes them using the output port
+     */
+    CT2DDE_crossing(sc_module_name _name,    ///< process name
+           CTTYPE level,                     ///< the level to be crossed
+           crossing_mode mode=CROSS_BOTH,    ///< the detected directions
+           sc_time tolerance=sc_time(1,SC_NS),///< the tolerated time error
+           sc_time scan_step=SC_ZERO_TIME    ///< the scan step inside sub-signals
+          ) : process(_name), iport1("iport1"), oport1("oport1"),
+              level(level), mode(mode), tolerance(tolerance),
+              scan_step(scan_step)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("level", level);
+        add_arg("mode", mode);
+        add_arg("tolerance", tolerance);
+        add_arg("scan_step", scan_step);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::CT2DDE_crossing";}
+
+private:
+    CTTYPE level;
+    crossing_mode mode;
+    sc_time tolerance, scan_step;
+    
+    // Internal variables
+    sub_signal in_ss, prev_ss;
+    bool has_prev;
+    sc_time prev_t;
+    CTTYPE prev_g;
+    std::vector<ttn_event<T>> out_events;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        has_prev = false;
+    }
+    
+    void prep()
+    {
+        in_ss = iport1.read();
+    }
+    
+    void exec()
+    {
+        out_events.clear();
+        const sc_time st = get_start_time(in_ss), et = get_end_time(in_ss);
+        const bool scan = scan_step != SC_ZERO_TIME &&
+                          in_ss.get_kind() != sub_signal::CONSTANT &&
+                          in_ss.get_kind() != sub_signal::LINEAR;
+        for (sc_time t=st; t<et; t = scan ? t+scan_step : et)
+        {
+            const CTTYPE g = in_ss(t) - level;
+            if (has_prev && crosses(prev_g, g))
+                locate(prev_t, prev_g, t, g);
+            prev_t = t;
+            prev_g = g;
+            has_prev = true;
+        }
+        prev_ss = in_ss;
+    }
+    
+    void prod()
+    {
+        for (auto& ev : out_events)
+        {
+            if (get_time(ev) > model_time())
+                wait(get_time(ev) - model_time());
+            write_multiport(oport1, ev);
+        }
+    }
+    
+    void clean() {}
+
+    bool above(CTTYPE g) const {return g >= 0;}
+
+    bool crosses(CTTYPE g0, CTTYPE g1) const
+    {
+        if (above(g0) == above(g1)) return false;
+        return mode == CROSS_BOTH || (mode == CROSS_RISING) == above(g1);
+    }
+
+    //! The distance from the level, where the bracket may span two sub-signals
+    CTTYPE distance(const sc_time& t) const
+    {
+        return (t < get_start_time(in_ss) ? prev_ss(t) : in_ss(t)) - level;
+    }
+
+    //! Locates a crossing in the bracket [a,b] using the Illinois method
+    void locate(const sc_time& a, CTTYPE ga, const sc_time& b, CTTYPE gb)
+    {
+        const double tol = in_seconds(tolerance);
+        double x0 = 0, x1 = in_seconds(b - a);
+        CTTYPE f0 = ga, f1 = gb;
+        int side = 0;
+        for (int iter=0; iter<100 && x1-x0>tol && f1!=0; iter++)
+        {
+            double x = x1 - f1*(x1-x0)/(f1-f0);
+            if (!(x > x0 && x < x1)) x = (x0 + x1) / 2;
+            const CTTYPE fx = distance(a + sc_time(x, SC_SEC));
+            if (above(fx) == above(f1))
+            {
+                x1 = x; f1 = fx;
+                if (side == 1) f0 /= 2;
+                side = 1;
+            }
+            else
+            {
+                x0 = x; f0 = fx;
+                if (side == -1) f1 /= 2;
+                side = -1;
+            }
+        }
+        sc_time tc = a + sc_time(x1, SC_SEC);
+        if (tc > b) tc = b;
+        out_events.push_back(ttn_event<T>(abst_ext<T>(T(distance(tc) + level)), tc));
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
 //! Process constructor for a DDE2CT MoC interfaces
 /*! This class is used to build a MoC interfaces which converts a DDE 
  * signal to a CT one. It can be used to implement digital-to-analog
@@ -432,13 +772,15 @@ private:
  * the initial values of the constructor:
  * - sample and hold
  * - linear interpolation
+ *
+ * The values of the CT signal are of type V and converted from T.
  */
-template<class T>
+template<class T, class V=CTTYPE>
 class DDE2CT : public process
 {
 public:
     DDE::DDE_in<T> iport1;        ///< port for the input channel
-	CT::CT_out oport1;          ///< port for the output channel
+    typename CT::ct_types<V>::out_port oport1; ///< port for the output channel
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -451,9 +793,7 @@ public:
               op_mode(op_mode)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << op_mode;
-        arg_vec.push_back(std::make_tuple("op_mode", ss.str()));
+        add_arg("op_mode", op_mode);
 #endif
     }
     
@@ -464,14 +804,14 @@ private:
 	A2DMode op_mode;
     
     // Internal variables
-    CTTYPE previousVal, currentVal;
+    V previousVal, currentVal;
     sc_time previousT, currentT;
-    sub_signal subsig;
+    basic_sub_signal<V> subsig;
     
     //Implementing the abstract semantics
     void init()
     {
-        previousVal = currentVal = 0;
+        previousVal = currentVal = V();
         previousT = currentT = SC_ZERO_TIME;
     }
     
@@ -480,37 +820,24 @@ private:
         while (currentT <= previousT)
         {
             auto in_ev = iport1.read();
-            currentVal = (double)from_abst_ext(get_value(in_ev), previousVal);
+            currentVal = V(from_abst_ext(get_value(in_ev), T(previousVal)));
             currentT = get_time(in_ev);
         }
     }
     
     void exec()
     {
-        set_range(subsig, previousT, currentT);
         if(op_mode==HOLD)
-        {
-            CTTYPE pv = previousVal;
-            set_function(subsig,[=](sc_time t){
-						return pv;
-						});
-        }
-        else 
-        {
-            CTTYPE dv = currentVal - previousVal;
-            sc_time dt = currentT - previousT;
-            sc_time pt = previousT;
-            CTTYPE pv = previousVal;
-            set_function(subsig,[=](sc_time t)->CTTYPE{
-                    return ((t-pt)/dt*dv + pv);
-            });
-        }
+            subsig = basic_sub_signal<V>::constant(previousT, currentT, previousVal);
+        else
+            subsig = basic_sub_signal<V>::linear(previousT, currentT, previousVal,
+                        (currentVal - previousVal)/in_seconds(currentT - previousT));
     }
     
     void prod()
     {
         write_multiport(oport1, subsig);
-        wait(get_end_time(subsig) - sc_time_stamp());
+        wait(get_end_time(subsig) - model_time());
         previousVal = currentVal;
         previousT = currentT;
     }
@@ -528,12 +855,19 @@ private:
 #endif
 };
 
+#endif
+
+#ifndef FORSYDE_NO_SDF
 //! Process constructor for a SY2SDF MoC interfaces
 /*! This class is used to build a MoC interface which converts an SY 
- * signal to an SDF one.
+ * signal to an SDF one. In each firing it packs a number of present SY
+ * tokens into the tokens of one SDF firing, skipping the absent ones,
+ * and writes them at once. It registers its port rates, hence it can be
+ * scheduled together with the SDF processes it feeds by the static
+ * scheduler.
  */
 template<class T>
-class SY2SDF : public process
+class SY2SDF : public SDF::sdf_process
 {
 public:
     SY::SY_in<T> iport1;        ///< port for the input channel
@@ -544,13 +878,14 @@ public:
      * applies the user-imlpemented function to it and writes the
      * results using the output port
      */
-    SY2SDF(sc_module_name _name     ///< process name
-          ) : process(_name), iport1("iport1"), oport1("oport1")
+    SY2SDF(sc_module_name _name,    ///< process name
+           unsigned int o1toks=1    ///< present SY tokens packed in each firing
+          ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+              o1toks(o1toks)
     {
+        add_out_rate(oport1, o1toks);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << 1;
-        arg_vec.push_back(std::make_tuple("o1toks", ss.str()));
+        add_arg("o1toks", o1toks);
 #endif
     }
     
@@ -558,35 +893,32 @@ public:
     std::string forsyde_kind() const {return "MI::SY2SDF";}
 
 private:
+    // production rate
+    unsigned int o1toks;
     
     // Internal variables
-    T* val;
+    std::vector<T> vals;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new T;
+        vals.reserve(o1toks);
     }
     
     void prep()
     {
-        auto tok = iport1.read();
-        while (is_absent(tok))
-            tok = iport1.read();
-        *val = unsafe_from_abst_ext(tok);
+        vals.clear();
+        iport1.read_present_until(vals, o1toks);
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        write_vec_multiport(oport1, vals);
     }
     
-    void clean()
-    {
-        delete val;
-    }
+    void clean() {}
     
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -601,10 +933,13 @@ private:
 
 //! Process constructor for a SDF2SY MoC interface
 /*! This class is used to build a MoC interface which converts an SDF 
- * signal to a SY one.
+ * signal to a SY one. In each firing it reads the tokens of one SDF
+ * firing at once and unpacks them into as many present SY tokens. It
+ * registers its port rate, hence it can be scheduled together with the
+ * SDF processes which feed it by the static scheduler.
  */
 template<class T>
-class SDF2SY : public process
+class SDF2SY : public SDF::sdf_process
 {
 public:
     SDF::SDF_in<T> iport1;  ///< port for the input channel
@@ -615,13 +950,14 @@ public:
      * applies the user-imlpemented function to it and writes the
      * results using the output port
      */
-    SDF2SY(sc_module_name _name     ///< process name
-          ) : process(_name), iport1("iport1"), oport1("oport1")
+    SDF2SY(sc_module_name _name,    ///< process name
+           unsigned int i1toks=1    ///< SDF tokens unpacked in each firing
+          ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+              i1toks(i1toks)
     {
+        add_in_rate(iport1, i1toks);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << 1;
-        arg_vec.push_back(std::make_tuple("i1toks", ss.str()));
+        add_arg("i1toks", i1toks);
 #endif
     }
     
@@ -629,26 +965,34 @@ public:
     std::string forsyde_kind() const {return "MI::SDF2SY";}
 
 private:
+    // consumption rate
+    unsigned int i1toks;
     
     // Internal variables
-    T* val;
+    std::vector<T> ivals;
+    std::vector<abst_ext<T>> ovals;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new T;
+        ivals.resize(i1toks);
+        ovals.resize(i1toks);
     }
     
     void prep()
     {
-        *val = iport1.read();
+        iport1.read_n(ivals, i1toks);
     }
     
-    void exec() {}
+    void exec()
+    {
+        for (size_t i=0; i<i1toks; i++)
+            ovals[i] = abst_ext<T>(std::move(ivals[i]));
+    }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<T>(*val));
+        write_vec_multiport(oport1, ovals);
     }
     
     void clean() {}
@@ -664,6 +1008,9 @@ private:
 #endif
 };
 
+#endif
+
+#ifndef FORSYDE_NO_DDE
 //! Process constructor for a SY2DDE MoC interfaces
 /*! This class is used to build a MoC interface which converts an SY 
  * signal to a DDE one.
@@ -686,9 +1033,7 @@ public:
               sample_period(sample_period)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << sample_period;
-        arg_vec.push_back(std::make_tuple("sample_period", ss.str()));
+        add_arg("sample_period", sample_period);
 #endif
     }
     
@@ -723,7 +1068,7 @@ private:
     void prod()
     {
         write_multiport(oport1, tt_event<T>(*val,cur_time));
-        wait(cur_time - sc_time_stamp());
+        wait(cur_time - model_time());
         cur_time += sample_period;
     }
     
@@ -766,9 +1111,7 @@ public:
               sample_period(sample_period)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << sample_period;
-        arg_vec.push_back(std::make_tuple("sample_period", ss.str()));
+        add_arg("sample_period", sample_period);
 #endif
     }
     
@@ -822,6 +1165,436 @@ private:
 #endif
 };
 
+#endif
+
+#if !defined(FORSYDE_NO_SDF) && !defined(FORSYDE_NO_DDE)
+//! Process constructor for a SDF2DDE MoC interface
+/*! This class is used to build a MoC interface which converts an SDF 
+ * signal to a DDE one. The tokens are emitted as events one sample
+ * period apart, starting at time zero, similar to an SY2DDE fed by an
+ * SDF2SY but without the intermediate signal.
+ */
+template<class T>
+class SDF2DDE : public process
+{
+public:
+    SDF::SDF_in<T> iport1;      ///< port for the input channel
+    DDE::DDE_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    SDF2DDE(sc_module_name _name,    ///< process name
+            sc_time sample_period    ///< The unified period length
+           ) : process(_name), iport1("iport1"), oport1("oport1"),
+               sample_period(sample_period)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("sample_period", sample_period);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::SDF2DDE";}
+
+private:
+    sc_time sample_period;
+    
+    // Internal variables
+    T val;
+    sc_time cur_time;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        cur_time = SC_ZERO_TIME;
+    }
+    
+    void prep()
+    {
+        val = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, tt_event<T>(val,cur_time));
+        wait(cur_time - model_time());
+        cur_time += sample_period;
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a DDE2SDF MoC interface
+/*! This class is used to build a MoC interface which converts a DDE 
+ * signal to an SDF one by sampling it once per sample period, starting
+ * at time zero, similar to a DDE2SY followed by an SY2SDF but without
+ * the intermediate signal. It registers its output rate, hence it can
+ * be scheduled together with the SDF processes it feeds by the static
+ * scheduler.
+ */
+template<class T>
+class DDE2SDF : public SDF::sdf_process
+{
+public:
+    DDE::DDE_in<T> iport1;      ///< port for the input channel
+    SDF::SDF_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    DDE2SDF(sc_module_name _name,    ///< process name
+            sc_time sample_period    ///< The unified period length
+           ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+               sample_period(sample_period)
+    {
+        add_out_rate(oport1, 1);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("sample_period", sample_period);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::DDE2SDF";}
+
+private:
+    sc_time sample_period;
+    
+    // Internal variables
+    tt_event<T> tok;
+    T prev_val;
+    sc_time cur_time;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        prev_val = T();
+        cur_time = SC_ZERO_TIME;
+        tok = iport1.read();
+    }
+    
+    void prep()
+    {
+        while (get_time(tok) <= cur_time)
+        {
+            prev_val = get_value(tok);
+            tok = iport1.read();
+        }
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, prev_val);
+        cur_time += sample_period;
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+#endif
+
+#ifndef FORSYDE_NO_DT
+//! Process constructor for a SY2DT MoC interface
+/*! This class is used to build a MoC interface which converts an SY 
+ * signal to a DT one. Each evaluation cycle is mapped to one discrete
+ * time step and the absent tokens are preserved.
+ */
+template<class T>
+class SY2DT : public process
+{
+public:
+    SY::SY_in<T> iport1;        ///< port for the input channel
+    DT::DT_out<T> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    SY2DT(sc_module_name _name       ///< process name
+         ) : process(_name), iport1("iport1"), oport1("oport1") {}
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::SY2DT";}
+
+private:
+    // Internal variables
+    abst_ext<T> tok;
+    
+    //Implementing the abstract semantics
+    void init() {}
+    
+    void prep()
+    {
+        tok = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, tok);
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a DT2SY MoC interface
+/*! This class is used to build a MoC interface which converts a DT 
+ * signal to an SY one. Each discrete time step is mapped to one
+ * evaluation cycle and the absent tokens are preserved.
+ */
+template<class T>
+class DT2SY : public process
+{
+public:
+    DT::DT_in<T> iport1;        ///< port for the input channel
+    SY::SY_out<T> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    DT2SY(sc_module_name _name       ///< process name
+         ) : process(_name), iport1("iport1"), oport1("oport1") {}
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::DT2SY";}
+
+private:
+    // Internal variables
+    abst_ext<T> tok;
+    
+    //Implementing the abstract semantics
+    void init() {}
+    
+    void prep()
+    {
+        tok = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, tok);
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+#ifndef FORSYDE_NO_DDE
+//! Process constructor for a DT2DDE MoC interface
+/*! This class is used to build a MoC interface which converts a DT 
+ * signal to a DDE one. The discrete time step k is mapped to the time
+ * k times the sample period, and only the present tokens are emitted
+ * as events.
+ */
+template<class T>
+class DT2DDE : public process
+{
+public:
+    DT::DT_in<T> iport1;        ///< port for the input channel
+    DDE::DDE_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    DT2DDE(sc_module_name _name,     ///< process name
+           sc_time sample_period     ///< The length of a time step
+          ) : process(_name), iport1("iport1"), oport1("oport1"),
+              sample_period(sample_period)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("sample_period", sample_period);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::DT2DDE";}
+
+private:
+    sc_time sample_period;
+    
+    // Internal variables
+    abst_ext<T> tok;
+    sc_time cur_time;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        cur_time = SC_ZERO_TIME;
+    }
+    
+    void prep()
+    {
+        tok = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        if (is_present(tok))
+        {
+            write_multiport(oport1, tt_event<T>(unsafe_from_abst_ext(tok),cur_time));
+            wait(cur_time - model_time());
+        }
+        cur_time += sample_period;
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+#endif
+
+#ifndef FORSYDE_NO_CT
+//! Process constructor for a CT2DT MoC interface
+/*! This class is used to build a MoC interface which converts a CT 
+ * signal to a DT one with a fixed sampling period, i.e., each sample is
+ * a discrete time step. It samples the input like CT2SY: all the samples
+ * which fall in the range of an input sub-signal are produced at once
+ * (up to FORSYDE_CT2SY_BATCH samples).
+ */
+class CT2DT : public process
+{
+public:
+    CT::CT_in iport1;           ///< port for the input channel
+    DT::DT_out<CTTYPE> oport1;  ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    CT2DT(sc_module_name _name,      ///< process name
+          sc_time sample_period      ///< The sampling period
+          ) : process(_name), iport1("iport1"), oport1("oport1"),
+              sample_period(sample_period)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("sample_period", sample_period);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::CT2DT";}
+
+private:
+    sc_time sample_period;
+    
+    // Internal variables
+    sub_signal in_ss;
+    std::vector<abst_ext<CTTYPE>> out_vals;
+    sc_time local_time, sampling_time, last_time;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        local_time = sampling_time = SC_ZERO_TIME;
+        out_vals.reserve(FORSYDE_CT2SY_BATCH);
+    }
+    
+    void prep()
+    {
+        while (sampling_time >= local_time)
+        {
+            in_ss = iport1.read();
+            local_time = get_end_time(in_ss);
+        }
+    }
+    
+    void exec()
+    {
+        last_time = sampling_time;
+        sample_segment(in_ss, local_time, sample_period, sampling_time,
+                       last_time, out_vals);
+    }
+    
+    void prod()
+    {
+        write_vec_multiport(oport1, out_vals);
+        wait(last_time - model_time());
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+#endif
+
+#endif
+
 }
 
 #endif
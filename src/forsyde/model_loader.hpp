@@ -0,0 +1,728 @@
+/**********************************************************************
+    * model_loader.hpp -- Instantiates a model from its XML files     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Building process networks at run time from the XML     *
+    *          format of the introspection                            *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION to use it                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef MODEL_LOADER_HPP
+#define MODEL_LOADER_HPP
+
+/*! \file model_loader.hpp
+ * \brief Instantiates a process network from the XML files of XMLExport
+ *
+ *  This file includes a loader which reads the XML files written by
+ * XMLExport and builds the process network they describe, so that the
+ * topology of a model can be changed without recompiling it. The
+ * process constructors, the signal types and the functions which may
+ * appear in the files are registered once in the binary:
+ *
+ *     model_registry reg;
+ *     reg.add_signal_type<int>();
+ *     reg.add_process<SY::comb2<int,int,int>>();
+ *     reg.add_process<SY::sink<int>>();
+ *     reg.add_function("add_func", add_func);
+ *     reg.add_function("report_func", report_func);
+ *     auto top = new loaded_module("top", reg, "gen/", "top");
+ *
+ * The files of the composite processes are read from the same path,
+ * named after their components, as XMLExport writes them.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <any>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+#include "rapidxml.hpp"
+#include "abssemantics.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Parses the value of an argument, as it is printed in the XML files
+template <typename T>
+struct arg_parser
+{
+    static T parse(const std::string& s)
+    {
+        std::istringstream is(s);
+        T val;
+        is >> val;
+        if (is.fail())
+            SC_REPORT_ERROR("model_loader", ("cannot parse the argument value " + s).c_str());
+        return val;
+    }
+};
+
+template <>
+struct arg_parser<std::string>
+{
+    static std::string parse(const std::string& s) {return s;}
+};
+
+//! The absent values are printed as "_"
+template <typename T>
+struct arg_parser<abst_ext<T>>
+{
+    static abst_ext<T> parse(const std::string& s)
+    {
+        const size_t b = s.find_first_not_of(" \t");
+        if (b != std::string::npos && s[b] == '_' &&
+            s.find_first_not_of(" \t", b+1) == std::string::npos)
+            return abst_ext<T>();
+        return abst_ext<T>(arg_parser<T>::parse(s));
+    }
+};
+
+//! The vectors are printed as "[a, b, c]"
+template <typename T>
+struct arg_parser<std::vector<T>>
+{
+    static std::vector<T> parse(const std::string& s)
+    {
+        std::vector<T> res;
+        const size_t b = s.find('['), e = s.rfind(']');
+        if (b == std::string::npos || e == std::string::npos || e < b)
+            SC_REPORT_ERROR("model_loader", ("cannot parse the vector argument " + s).c_str());
+        std::string cur;
+        int depth = 0;
+        for (size_t i=b+1; i<e; i++)
+        {
+            const char c = s[i];
+            if (c == '[' || c == '(' || c == '{') depth++;
+            else if (c == ']' || c == ')' || c == '}') depth--;
+            if (c == ',' && depth == 0)
+            {
+                res.push_back(arg_parser<T>::parse(cur));
+                cur.clear();
+            }
+            else
+                cur += c;
+        }
+        if (cur.find_first_not_of(" \t") != std::string::npos)
+            res.push_back(arg_parser<T>::parse(cur));
+        return res;
+    }
+};
+
+class model_registry;
+
+//! The arguments of a leaf process read from an XML file
+class arg_list
+{
+public:
+    arg_list(const model_registry& reg, const std::string& process)
+        : reg(reg), process(process) {}
+
+    //! Adds an argument
+    void add(const std::string& name, const std::string& value) {args[name] = value;}
+
+    //! Checks if an argument is given
+    bool has(const std::string& name) const {return args.count(name) > 0;}
+
+    //! The printed value of an argument
+    const std::string& str(const std::string& name) const
+    {
+        auto it = args.find(name);
+        if (it == args.end())
+            SC_REPORT_ERROR(process.c_str(), ("the argument " + name + " is missing").c_str());
+        return it->second;
+    }
+
+    //! The value of an argument
+    template <typename T>
+    T get(const std::string& name) const {return arg_parser<T>::parse(str(name));}
+
+    //! The value of an optional argument
+    template <typename T>
+    T get(const std::string& name, const T& def) const
+    {
+        return has(name) ? get<T>(name) : def;
+    }
+
+    //! The registered function named by an argument
+    template <typename F>
+    F func(const std::string& name) const;
+
+private:
+    const model_registry& reg;
+    std::string process;
+    std::map<std::string,std::string> args;
+};
+
+//! Builds the processes of a process constructor from their arguments
+/*! It is specialized for the supported process constructors, providing
+ * the kind of the processes, the types of their ports (the inputs and
+ * then the outputs, as XMLExport lists them) and a creation function.
+ */
+template <class PC>
+struct process_factory;
+
+//! Holds the process constructors, signals and functions a model may use
+class model_registry
+{
+public:
+    //! Creates a leaf process from its name and arguments
+    typedef std::function<sc_module*(const char*, const arg_list&)> factory;
+
+    //! The operations on a signal type
+    struct signal_ops
+    {
+        std::function<sc_interface*(const char*)> create;
+        std::function<sc_object*(const char*, bool)> create_port;
+        //! Binds a port of a process to a channel
+        std::function<void(sc_object*, sc_interface*, bool)> bind;
+        //! Binds a port of a process to a port of its parent
+        std::function<void(sc_object*, sc_object*, bool)> bind_port;
+    };
+
+    //! Registers a process constructor
+    void add_constructor(const std::string& kind,
+                         const std::vector<std::string>& port_types,
+                         const factory& f)
+    {
+        factories[key(kind, port_types)] = f;
+    }
+
+    //! Registers a process constructor specialized by process_factory
+    template <class PC>
+    void add_process()
+    {
+        add_constructor(process_factory<PC>::kind(), process_factory<PC>::port_types(),
+            [](const char* name, const arg_list& args) -> sc_module*
+            {
+                return process_factory<PC>::create(name, args);
+            });
+    }
+
+    //! Registers a function which may be passed to the process constructors
+    /*! The function can be a function pointer or a function object of the
+     * type expected by the process constructors.
+     */
+    template <typename F>
+    void add_function(const std::string& name, F f) {functions[name] = f;}
+
+    //! Registers a signal type of a MoC, as its name appears in the XML files
+    template <typename T, class Chan, class InPort, class OutPort>
+    void add_signal(const std::string& moc)
+    {
+        signal_ops ops;
+        ops.create = [](const char* name) -> sc_interface*
+        {
+            return new Chan(name, 16);
+        };
+        ops.create_port = [](const char* name, bool out) -> sc_object*
+        {
+            if (out) return new OutPort(name);
+            return new InPort(name);
+        };
+        ops.bind = [](sc_object* port, sc_interface* chan, bool out)
+        {
+            Chan& ch = *dynamic_cast<Chan*>(chan);
+            if (out) (*dynamic_cast<OutPort*>(port))(ch);
+            else (*dynamic_cast<InPort*>(port))(ch);
+        };
+        ops.bind_port = [](sc_object* inner, sc_object* outer, bool out)
+        {
+            if (out) (*dynamic_cast<OutPort*>(inner))(*dynamic_cast<OutPort*>(outer));
+            else (*dynamic_cast<InPort*>(inner))(*dynamic_cast<InPort*>(outer));
+        };
+        signals[moc + ":" + get_type_name<T>()] = ops;
+    }
+
+    //! Registers the SY and SDF signals of a token type
+    template <typename T>
+    void add_signal_type()
+    {
+        add_signal<T, SY::SY2SY<T>, SY::SY_in<T>, SY::SY_out<T>>("sy");
+#ifndef FORSYDE_NO_SDF
+        add_signal<T, SDF::SDF2SDF<T>, SDF::SDF_in<T>, SDF::SDF_out<T>>("sdf");
+#endif
+    }
+
+    //! Finds the factory of a process constructor
+    const factory* find_constructor(const std::string& kind,
+                                    const std::vector<std::string>& port_types) const
+    {
+        auto it = factories.find(key(kind, port_types));
+        return it == factories.end() ? NULL : &it->second;
+    }
+
+    //! Finds the operations of a signal type
+    const signal_ops* find_signal(const std::string& moc, const std::string& type) const
+    {
+        auto it = signals.find(moc + ":" + type);
+        return it == signals.end() ? NULL : &it->second;
+    }
+
+    //! Finds a function
+    const std::any* find_function(const std::string& name) const
+    {
+        auto it = functions.find(name);
+        return it == functions.end() ? NULL : &it->second;
+    }
+
+private:
+    std::map<std::string,factory> factories;
+    std::map<std::string,signal_ops> signals;
+    std::map<std::string,std::any> functions;
+
+    static std::string key(const std::string& kind, const std::vector<std::string>& types)
+    {
+        std::string k = kind + "(";
+        for (size_t i=0; i<types.size(); i++) k += (i ? "," : "") + types[i];
+        return k + ")";
+    }
+};
+
+//! The function pointer type of a std::function, or void
+template <typename F>
+struct function_pointer {typedef void type;};
+
+template <typename R, typename... Args>
+struct function_pointer<std::function<R(Args...)>> {typedef R(*type)(Args...);};
+
+template <typename F>
+F arg_list::func(const std::string& name) const
+{
+    const std::string& fname = str(name);
+    const std::any* f = reg.find_function(fname);
+    if (f != NULL)
+    {
+        if (auto p = std::any_cast<F>(f)) return *p;
+        typedef typename function_pointer<F>::type fptr;
+        if constexpr (!std::is_void<fptr>::value)
+            if (auto p = std::any_cast<fptr>(f)) return *p;
+        SC_REPORT_ERROR(process.c_str(), ("the function " + fname + " has a different type").c_str());
+    }
+    else
+        SC_REPORT_ERROR(process.c_str(), ("the function " + fname + " is not registered").c_str());
+    return F();
+}
+
+//! A composite process instantiated from an XML file
+/*! The constructor reads the file of a component and builds its ports,
+ * its leaf and composite processes and its signals, and binds the ports
+ * of the children to the signals and to its own ports.
+ */
+class loaded_module : public sc_module
+{
+public:
+    loaded_module(sc_module_name _name,            ///< the module name
+                  const model_registry& reg,       ///< the registered constructors
+                  const std::string& path,         ///< the path of the XML files
+                  const std::string& component     ///< the component name
+                  ) : sc_module(_name), reg(reg), path(path)
+    {
+        const std::string file = path + component + ".xml";
+        std::ifstream in(file);
+        if (!in) SC_REPORT_ERROR(file.c_str(), "cannot open the XML file");
+        std::stringstream ss;
+        ss << in.rdbuf();
+        const std::string str = ss.str();
+        std::vector<char> text(str.begin(), str.end());
+        text.push_back('\0');
+        rapidxml::xml_document<> doc;
+        doc.parse<0>(text.data());
+        auto pn = doc.first_node("process_network");
+        if (pn == NULL) SC_REPORT_ERROR(file.c_str(), "no process network in the XML file");
+        build(pn);
+    }
+
+    //! Finds a child object by its base name
+    static sc_object* find_child(sc_object* parent, const std::string& name)
+    {
+        for (auto c : parent->get_child_objects())
+            if (name == c->basename()) return c;
+        return NULL;
+    }
+
+private:
+    const model_registry& reg;
+    std::string path;
+
+    static std::string attr(rapidxml::xml_node<>* n, const char* name)
+    {
+        auto a = n->first_attribute(name);
+        return a ? std::string(a->value(), a->value_size()) : std::string();
+    }
+
+    static std::string upper(std::string s)
+    {
+        for (auto& c : s) c = std::toupper(c);
+        return s;
+    }
+
+    const model_registry::signal_ops& signal_ops(const std::string& moc, const std::string& type)
+    {
+        auto ops = reg.find_signal(moc, type);
+        if (ops == NULL)
+            SC_REPORT_ERROR(name(), ("the " + moc + " signal type " + type + " is not registered").c_str());
+        return *ops;
+    }
+
+    sc_object* child_port(const std::string& proc, const std::string& port)
+    {
+        sc_object* p = find_child(this, proc);
+        sc_object* res = p ? find_child(p, port) : NULL;
+        if (res == NULL)
+            SC_REPORT_ERROR(name(), ("cannot find the port " + proc + "." + port).c_str());
+        return res;
+    }
+
+    void build(rapidxml::xml_node<>* pn)
+    {
+        // the ports bound to the ports of the children
+        std::vector<rapidxml::xml_node<>*> ports;
+        for (auto n = pn->first_node(); n; n = n->next_sibling())
+        {
+            const std::string tag(n->name(), n->name_size());
+            if (tag == "port")
+            {
+                signal_ops(attr(n, "moc"), attr(n, "type")).create_port(
+                    attr(n, "name").c_str(), attr(n, "direction") == "out");
+                ports.push_back(n);
+            }
+            else if (tag == "leaf_process")
+                add_leaf(n);
+            else if (tag == "composite_process")
+                new loaded_module(attr(n, "name").c_str(), reg, path, attr(n, "component_name"));
+        }
+        for (auto n = pn->first_node("signal"); n; n = n->next_sibling("signal"))
+        {
+            auto& ops = signal_ops(attr(n, "moc"), attr(n, "type"));
+            sc_interface* ch = ops.create(attr(n, "name").c_str());
+            ops.bind(child_port(attr(n, "source"), attr(n, "source_port")), ch, true);
+            ops.bind(child_port(attr(n, "target"), attr(n, "target_port")), ch, false);
+        }
+        for (auto n : ports)
+        {
+            if (attr(n, "bound_process").empty()) continue;
+            signal_ops(attr(n, "moc"), attr(n, "type")).bind_port(
+                child_port(attr(n, "bound_process"), attr(n, "bound_port")),
+                find_child(this, attr(n, "name")), attr(n, "direction") == "out");
+        }
+    }
+
+    void add_leaf(rapidxml::xml_node<>* n)
+    {
+        const std::string pname = attr(n, "name");
+        std::vector<std::string> types;
+        for (auto p = n->first_node("port"); p; p = p->next_sibling("port"))
+            types.push_back(attr(p, "type"));
+        auto pc = n->first_node("process_constructor");
+        if (pc == NULL)
+            SC_REPORT_ERROR(pname.c_str(), "the leaf process has no process constructor");
+        const std::string kind = upper(attr(pc, "moc")) + "::" + attr(pc, "name");
+        arg_list args(reg, pname);
+        for (auto a = pc->first_node("argument"); a; a = a->next_sibling("argument"))
+            args.add(attr(a, "name"), attr(a, "value"));
+        auto f = reg.find_constructor(kind, types);
+        if (f == NULL)
+            SC_REPORT_ERROR(pname.c_str(), ("the process constructor " + kind +
+                            " is not registered for the types of its ports").c_str());
+        (*f)(pname.c_str(), args);
+    }
+};
+
+//! The SY process constructors
+
+template <typename T0, typename T1>
+struct process_factory<SY::comb<T0,T1>>
+{
+    typedef SY::comb<T0,T1> PC;
+    static std::string kind() {return "SY::comb";}
+    static std::vector<std::string> port_types() {return {get_type_name<T1>(), get_type_name<T0>()};}
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"));
+    }
+};
+
+template <typename T0, typename T1, typename T2>
+struct process_factory<SY::comb2<T0,T1,T2>>
+{
+    typedef SY::comb2<T0,T1,T2> PC;
+    static std::string kind() {return "SY::comb2";}
+    static std::vector<std::string> port_types()
+    {
+        return {get_type_name<T1>(), get_type_name<T2>(), get_type_name<T0>()};
+    }
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"));
+    }
+};
+
+template <typename T0, typename T1, typename T2, typename T3>
+struct process_factory<SY::comb3<T0,T1,T2,T3>>
+{
+    typedef SY::comb3<T0,T1,T2,T3> PC;
+    static std::string kind() {return "SY::comb3";}
+    static std::vector<std::string> port_types()
+    {
+        return {get_type_name<T1>(), get_type_name<T2>(), get_type_name<T3>(),
+                get_type_name<T0>()};
+    }
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"));
+    }
+};
+
+template <typename T0, typename T1, typename T2, typename T3, typename T4>
+struct process_factory<SY::comb4<T0,T1,T2,T3,T4>>
+{
+    typedef SY::comb4<T0,T1,T2,T3,T4> PC;
+    static std::string kind() {return "SY::comb4";}
+    static std::vector<std::string> port_types()
+    {
+        return {get_type_name<T1>(), get_type_name<T2>(), get_type_name<T3>(),
+                get_type_name<T4>(), get_type_name<T0>()};
+    }
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::delay<T>>
+{
+    static std::string kind() {return "SY::delay";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>(), get_type_name<T>()};}
+    static SY::delay<T>* create(const char* n, const arg_list& a)
+    {
+        return new SY::delay<T>(n, a.get<abst_ext<T>>("init_val"));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::delayn<T>>
+{
+    static std::string kind() {return "SY::delayn";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>(), get_type_name<T>()};}
+    static SY::delayn<T>* create(const char* n, const arg_list& a)
+    {
+        return new SY::delayn<T>(n, a.get<abst_ext<T>>("init_val"), a.get<unsigned int>("n"));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::constant<T>>
+{
+    static std::string kind() {return "SY::constant";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static SY::constant<T>* create(const char* n, const arg_list& a)
+    {
+        return new SY::constant<T>(n, a.get<abst_ext<T>>("init_val"),
+                                   a.get<unsigned long long>("take", 0));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::source<T>>
+{
+    typedef SY::source<T> PC;
+    static std::string kind() {return "SY::source";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"),
+                      a.get<abst_ext<T>>("init_val"), a.get<unsigned long long>("take", 0));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::vsource<T>>
+{
+    static std::string kind() {return "SY::vsource";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static SY::vsource<T>* create(const char* n, const arg_list& a)
+    {
+        return new SY::vsource<T>(n, a.get<std::vector<abst_ext<T>>>("in_vec"));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::sink<T>>
+{
+    typedef SY::sink<T> PC;
+    static std::string kind() {return "SY::sink";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"));
+    }
+};
+
+template <typename T>
+struct process_factory<SY::fanout<T>>
+{
+    static std::string kind() {return "SY::fanout";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>(), get_type_name<T>()};}
+    static SY::fanout<T>* create(const char* n, const arg_list&) {return new SY::fanout<T>(n);}
+};
+
+#ifndef FORSYDE_NO_SDF
+//! The SDF process constructors
+
+template <typename T0, typename T1>
+struct process_factory<SDF::comb<T0,T1>>
+{
+    typedef SDF::comb<T0,T1> PC;
+    static std::string kind() {return "SDF::comb";}
+    static std::vector<std::string> port_types() {return {get_type_name<T1>(), get_type_name<T0>()};}
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"),
+                      a.get<unsigned int>("o1toks"), a.get<unsigned int>("i1toks"));
+    }
+};
+
+template <typename T0, typename T1, typename T2>
+struct process_factory<SDF::comb2<T0,T1,T2>>
+{
+    typedef SDF::comb2<T0,T1,T2> PC;
+    static std::string kind() {return "SDF::comb2";}
+    static std::vector<std::string> port_types()
+    {
+        return {get_type_name<T1>(), get_type_name<T2>(), get_type_name<T0>()};
+    }
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"), a.get<unsigned int>("o1toks"),
+                      a.get<unsigned int>("i1toks"), a.get<unsigned int>("i2toks"));
+    }
+};
+
+template <typename T0, typename T1, typename T2, typename T3>
+struct process_factory<SDF::comb3<T0,T1,T2,T3>>
+{
+    typedef SDF::comb3<T0,T1,T2,T3> PC;
+    static std::string kind() {return "SDF::comb3";}
+    static std::vector<std::string> port_types()
+    {
+        return {get_type_name<T1>(), get_type_name<T2>(), get_type_name<T3>(),
+                get_type_name<T0>()};
+    }
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"), a.get<unsigned int>("o1toks"),
+                      a.get<unsigned int>("i1toks"), a.get<unsigned int>("i2toks"),
+                      a.get<unsigned int>("i3toks"));
+    }
+};
+
+template <typename T0, typename T1, typename T2, typename T3, typename T4>
+struct process_factory<SDF::comb4<T0,T1,T2,T3,T4>>
+{
+    typedef SDF::comb4<T0,T1,T2,T3,T4> PC;
+    static std::string kind() {return "SDF::comb4";}
+    static std::vector<std::string> port_types()
+    {
+        return {get_type_name<T1>(), get_type_name<T2>(), get_type_name<T3>(),
+                get_type_name<T4>(), get_type_name<T0>()};
+    }
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"), a.get<unsigned int>("o1toks"),
+                      a.get<unsigned int>("i1toks"), a.get<unsigned int>("i2toks"),
+                      a.get<unsigned int>("i3toks"), a.get<unsigned int>("i4toks"));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::delay<T>>
+{
+    static std::string kind() {return "SDF::delay";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>(), get_type_name<T>()};}
+    static SDF::delay<T>* create(const char* n, const arg_list& a)
+    {
+        return new SDF::delay<T>(n, a.get<T>("init_val"));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::delayn<T>>
+{
+    static std::string kind() {return "SDF::delayn";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>(), get_type_name<T>()};}
+    static SDF::delayn<T>* create(const char* n, const arg_list& a)
+    {
+        return new SDF::delayn<T>(n, a.get<T>("init_val"), a.get<unsigned int>("n"));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::constant<T>>
+{
+    static std::string kind() {return "SDF::constant";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static SDF::constant<T>* create(const char* n, const arg_list& a)
+    {
+        return new SDF::constant<T>(n, a.get<T>("init_val"), a.get<unsigned long long>("take", 0));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::source<T>>
+{
+    typedef SDF::source<T> PC;
+    static std::string kind() {return "SDF::source";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"),
+                      a.get<T>("init_val"), a.get<unsigned long long>("take", 0));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::vsource<T>>
+{
+    static std::string kind() {return "SDF::vsource";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static SDF::vsource<T>* create(const char* n, const arg_list& a)
+    {
+        return new SDF::vsource<T>(n, a.get<std::vector<T>>("in_vec"));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::sink<T>>
+{
+    typedef SDF::sink<T> PC;
+    static std::string kind() {return "SDF::sink";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>()};}
+    static PC* create(const char* n, const arg_list& a)
+    {
+        return new PC(n, a.func<typename PC::functype>("_func"));
+    }
+};
+
+template <typename T>
+struct process_factory<SDF::fanout<T>>
+{
+    static std::string kind() {return "SDF::fanout";}
+    static std::vector<std::string> port_types() {return {get_type_name<T>(), get_type_name<T>()};}
+    static SDF::fanout<T>* create(const char* n, const arg_list&) {return new SDF::fanout<T>(n);}
+};
+#endif
+
+}
+
+#endif
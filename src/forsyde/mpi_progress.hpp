@@ -0,0 +1,225 @@
+/**********************************************************************
+    * mpi_progress.hpp -- A dedicated thread progressing MPI          *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Completing the MPI requests of the parallel simulation *
+    *          outside the simulation threads                         *
+    *                                                                 *
+    * Usage:   Define FORSYDE_MPI_PROGRESS_THREAD to use it            *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef MPI_PROGRESS_HPP
+#define MPI_PROGRESS_HPP
+
+/*! \file mpi_progress.hpp
+ * \brief Implements the communication thread of the hybrid simulations
+ *
+ *  In a hybrid simulation each MPI rank runs the partition of a whole
+ * node, and the processes of the partition are executed by the parallel
+ * executors (e.g., SY::parallel_executor or SDF::hsdf_executor) on a
+ * thread pool. Only the signals between the nodes use the sender and
+ * receiver processes, which are then a part of the executed region: the
+ * receivers are sources and the senders are sinks.
+ *
+ *  With FORSYDE_MPI_PROGRESS_THREAD defined, the waits and the probes of
+ * the transport are completed by a dedicated communication thread, hence
+ * the simulation threads only post the non-blocking operations and never
+ * test them. A kernel thread waiting for a request keeps running the
+ * other SystemC processes meanwhile, and a thread of a pool blocks until
+ * the communication thread signals the completion. MPI should be
+ * initialized with mpi_init_threads() and finalized with
+ * mpi_finalize_threads():
+ *
+ *     int sc_main(int argc, char** argv)
+ *     {
+ *         mpi_init_threads(&argc, &argv);
+ *         // elaborate the partition of the node, with the parallel
+ *         // executor and the senders and receivers of the node
+ *         sc_start();
+ *         mpi_finalize_threads();
+ *         return 0;
+ *     }
+ */
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <mpi.h>
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The communication thread which completes the MPI requests
+/*! A single instance is created by mpi_init_threads(), whose calling
+ * thread is considered the thread of the SystemC kernel. The thread
+ * tests the requests and probes waited for by the simulation threads,
+ * and drives the progress of the rest of the outstanding operations
+ * (e.g., the sends which are not waited for yet) when it is idle.
+ */
+class mpi_progress
+{
+public:
+    //! Returns the communication thread, starting it if needed
+    static mpi_progress& instance()
+    {
+        static mpi_progress engine;
+        return engine;
+    }
+
+    //! Waits for a request to complete
+    void wait(MPI_Request& request, MPI_Status& status)
+    {
+        job j{false, &request, 0, 0, &status};
+        await(j);
+    }
+
+    //! Waits for a message to arrive, without receiving it
+    void probe(int source, int tag, MPI_Status& status)
+    {
+        job j{true, NULL, source, tag, &status};
+        await(j);
+    }
+
+    //! Checks if the calling thread is the one of the SystemC kernel
+    bool on_kernel_thread() const
+    {
+        return std::this_thread::get_id() == kernel;
+    }
+
+    //! Stops the communication thread
+    /*! It should be called before MPI is finalized.
+     */
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            if (stopped) return;
+            stopped = true;
+        }
+        work_cv.notify_all();
+        if (thread.joinable()) thread.join();
+    }
+
+    ~mpi_progress() {stop();}
+
+private:
+    //! A wait or a probe handed over to the communication thread
+    struct job
+    {
+        bool is_probe;
+        MPI_Request* request;
+        int source, tag;
+        MPI_Status* status;
+        std::atomic<bool> done{false};
+
+        job(bool is_probe, MPI_Request* request, int source, int tag, MPI_Status* status)
+            : is_probe(is_probe), request(request), source(source), tag(tag),
+              status(status) {}
+    };
+
+    std::mutex m;
+    std::condition_variable work_cv, done_cv;
+    std::vector<job*> jobs;
+    bool stopped;
+    std::thread::id kernel;
+    std::thread thread;
+
+    mpi_progress() : stopped(false), kernel(std::this_thread::get_id())
+    {
+        thread = std::thread(&mpi_progress::loop, this);
+    }
+
+    //! Hands a job over to the communication thread and waits for it
+    void await(job& j)
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            jobs.push_back(&j);
+        }
+        work_cv.notify_one();
+        const bool can_yield = on_kernel_thread();
+        while (!j.done.load(std::memory_order_acquire))
+        {
+            if (can_yield && sc_pending_activity_at_current_time())
+                sc_core::wait(SC_ZERO_TIME);
+            else
+            {
+                std::unique_lock<std::mutex> lk(m);
+                done_cv.wait(lk, [&j]{return j.done.load(std::memory_order_acquire);});
+            }
+        }
+    }
+
+    //! The body of the communication thread
+    void loop()
+    {
+        std::vector<job*> current;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lk(m);
+                work_cv.wait_for(lk, std::chrono::microseconds(100),
+                                 [this]{return stopped || !jobs.empty();});
+                if (stopped) return;
+                current = jobs;
+            }
+            if (current.empty())
+            {
+                // let the outstanding operations progress
+                int flag = 0;
+                MPI_Iprobe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &flag,
+                           MPI_STATUS_IGNORE);
+                continue;
+            }
+            bool completed = false;
+            for (auto j : current)
+            {
+                int flag = 0;
+                if (j->is_probe)
+                    MPI_Iprobe(j->source, j->tag, MPI_COMM_WORLD, &flag, j->status);
+                else
+                    MPI_Test(j->request, &flag, j->status);
+                if (!flag) continue;
+                {
+                    std::lock_guard<std::mutex> lk(m);
+                    jobs.erase(std::find(jobs.begin(), jobs.end(), j));
+                    j->done.store(true, std::memory_order_release);
+                }
+                completed = true;
+            }
+            if (completed) done_cv.notify_all();
+        }
+    }
+};
+
+//! Initializes MPI for a hybrid simulation and starts the communication thread
+/*! It should be called from the thread which runs the simulation.
+ */
+inline void mpi_init_threads(int* argc, char*** argv)
+{
+    int provided = 0;
+    MPI_Init_thread(argc, argv, MPI_THREAD_MULTIPLE, &provided);
+    if (provided < MPI_THREAD_MULTIPLE)
+        SC_REPORT_ERROR("mpi_init_threads", "the MPI library does not support MPI_THREAD_MULTIPLE");
+    mpi_progress::instance();
+}
+
+//! Stops the communication thread and finalizes MPI
+inline void mpi_finalize_threads()
+{
+    mpi_progress::instance().stop();
+    MPI_Finalize();
+}
+
+}
+
+#endif
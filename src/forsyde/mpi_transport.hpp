@@ -0,0 +1,683 @@
+/**********************************************************************
+    * mpi_transport.hpp -- Transfer of tokens between MPI ranks       *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing the batched MPI transport used by the        *
+    *          parallel simulation primitives                         *
+    *                                                                 *
+    * Usage:   Included by the parallel simulation primitives         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef MPI_TRANSPORT_HPP
+#define MPI_TRANSPORT_HPP
+
+/*! \file mpi_transport.hpp
+ * \brief Implements the transfer of tokens between MPI ranks
+ *
+ *  This file includes the helpers which send and receive serialized
+ * tokens in batches without spinning the simulation kernel, to a single
+ * destination or along a multicast tree to several ones. When
+ * FORSYDE_SHM_TRANSPORT is defined, the ranks running on the same host
+ * exchange the batches through shared memory instead of MPI messages.
+ * The batches of a sender and receiver pair can be compressed (see
+ * payload_codec.hpp).
+ */
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <mpi.h>
+
+#include "serializer.hpp"
+#include "payload_codec.hpp"
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+#include "mpi_progress.hpp"
+#endif
+#ifdef FORSYDE_SHM_TRANSPORT
+#include <memory>
+#include <thread>
+#include "shm_ring.hpp"
+#endif
+#ifdef FORSYDE_TIMELINE
+#include "timeline_mpi.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Waits for an MPI request to complete without spinning delta cycles
+/*! As long as other processes can run at the current time, the request
+ * is tested once per delta cycle. Otherwise the simulation kernel has
+ * nothing else to do and the rank blocks in MPI_Wait. With
+ * FORSYDE_MPI_PROGRESS_THREAD, the request is completed by the
+ * communication thread instead (see mpi_progress).
+ */
+inline void mpi_wait(MPI_Request& request, MPI_Status& status)
+{
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+    mpi_progress::instance().wait(request, status);
+    return;
+#endif
+    int flag = 0;
+    while (true)
+    {
+        MPI_Test(&request, &flag, &status);
+        if (flag) return;
+        if (sc_pending_activity_at_current_time())
+            wait(SC_ZERO_TIME);
+        else
+        {
+            MPI_Wait(&request, &status);
+            return;
+        }
+    }
+}
+
+//! Waits for a message to arrive without spinning delta cycles
+/*! It works similar to mpi_wait() but probes for a message instead.
+ */
+inline void mpi_probe(int source, int tag, MPI_Status& status)
+{
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+    mpi_progress::instance().probe(source, tag, status);
+    return;
+#endif
+    int flag = 0;
+    while (true)
+    {
+        MPI_Iprobe(source, tag, MPI_COMM_WORLD, &flag, &status);
+        if (flag) return;
+        if (sc_pending_activity_at_current_time())
+            wait(SC_ZERO_TIME);
+        else
+        {
+            MPI_Probe(source, tag, MPI_COMM_WORLD, &status);
+            return;
+        }
+    }
+}
+
+#ifdef FORSYDE_SHM_TRANSPORT
+//! Waits for a shared memory ring without spinning delta cycles
+/*! It yields to the other processes which can run at the current time,
+ * and otherwise to the other threads of the host. It is called between
+ * the failed attempts of accessing the ring.
+ */
+inline void shm_backoff(unsigned& attempts, bool can_wait=true)
+{
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+    // the threads of the executors can not yield to the kernel
+    can_wait = can_wait && mpi_progress::instance().on_kernel_thread();
+#endif
+    if (can_wait && sc_pending_activity_at_current_time())
+        wait(SC_ZERO_TIME);
+    else if (++attempts > 64)
+        std::this_thread::yield();
+}
+
+//! The name of the shared memory segment of a pair of ranks and a tag
+inline std::string shm_name(int source, int destination, int tag)
+{
+    return "/forsyde_" + std::to_string(source) + "_" +
+           std::to_string(destination) + "_" + std::to_string(tag);
+}
+
+//! Returns the name of the host of this rank
+inline std::string mpi_host()
+{
+    char host[MPI_MAX_PROCESSOR_NAME];
+    int len = 0;
+    MPI_Get_processor_name(host, &len);
+    return std::string(host, len);
+}
+#endif
+
+//! Accumulates tokens and sends them in batches using MPI
+/*! The tokens are serialized using serializer<T> and sent as one message
+ * per batch. Up to depth batches can be in flight while the next one is
+ * being filled, which lets the sender run ahead of the receiver (e.g.,
+ * a pipeline stage by depth evaluation cycles) before it blocks.
+ *
+ * With FORSYDE_SHM_TRANSPORT, the receiver tells its host in the first
+ * message and, if it is the same host, the batches are written to a
+ * shared memory ring created by the receiver.
+ *
+ * With a compression, each batch starts with a header byte telling its
+ * codec, and the batches which are large enough are compressed.
+ */
+template <typename T>
+class mpi_batch_sender
+{
+public:
+    //! The constructor requires the destination, the tag and the batch size
+    mpi_batch_sender(int destination, int tag, unsigned batch, unsigned depth=2,
+                     const transport_compression& comp=transport_compression())
+        : destination(destination), tag(tag), batch(batch==0 ? 1 : batch),
+          bufs(depth<2 ? 2 : depth), requests(bufs.size(), MPI_REQUEST_NULL),
+          cur(0), count(0), comp(comp), wire(comp.enabled() ? bufs.size() : 0)
+    {
+        word = comp.word ? comp.word : serializer<T>::max_size ? serializer<T>::max_size : 8;
+#ifndef FORSYDE_LZ4
+        if (comp.codec == CODEC_LZ4)
+            SC_REPORT_WARNING("ForSyDe::mpi_batch_sender", "LZ4 requires FORSYDE_LZ4; the batches are not compressed");
+#endif
+#ifndef FORSYDE_ZSTD
+        if (comp.codec == CODEC_ZSTD)
+            SC_REPORT_WARNING("ForSyDe::mpi_batch_sender", "ZSTD requires FORSYDE_ZSTD; the batches are not compressed");
+#endif
+        for (size_t i=0; i<bufs.size(); i++)
+        {
+            if (serializer<T>::max_size > 0)
+                bufs[i].reserve(this->batch * serializer<T>::max_size + 1);
+            reset(i);
+        }
+    }
+
+    //! Adds a token to the current batch and sends it if full
+    void push(const T& val)
+    {
+        serializer<T>::write(bufs[cur], val);
+        if (++count == batch) flush();
+    }
+
+    //! Sends the tokens of the current batch and switches the buffers
+    void flush()
+    {
+        if (count == 0) return;
+#ifdef FORSYDE_SHM_TRANSPORT
+        if (!handshaken) handshake(true);
+        if (ring)
+        {
+            ring_send(true);
+            return;
+        }
+#endif
+        send();
+        cur = (cur + 1) % bufs.size();
+        // the next buffer can only be refilled once its message is sent
+        if (requests[cur] != MPI_REQUEST_NULL)
+        {
+            MPI_Status status;
+            mpi_wait(requests[cur], status);
+            requests[cur] = MPI_REQUEST_NULL;
+        }
+        reset(cur);
+    }
+
+    //! Sends the remaining tokens and waits for all the messages
+    /*! It does not interact with the simulation kernel and can be called
+     * at the end of the simulation.
+     */
+    void finish()
+    {
+#ifdef FORSYDE_SHM_TRANSPORT
+        if (!handshaken && count > 0) handshake(false);
+        if (ring)
+        {
+            if (count > 0) ring_send(false);
+            ring.reset();
+            return;
+        }
+#endif
+        if (count > 0) send();
+        for (size_t i=0; i<bufs.size(); i++)
+            if (requests[i] != MPI_REQUEST_NULL)
+            {
+                MPI_Status status;
+                MPI_Wait(&requests[i], &status);
+                requests[i] = MPI_REQUEST_NULL;
+            }
+        for (size_t i=0; i<bufs.size(); i++) reset(i);
+    }
+
+private:
+    int destination;
+    int tag;
+    unsigned batch;
+    std::vector<std::vector<char>> bufs;
+    std::vector<MPI_Request> requests;
+    size_t cur;
+    unsigned count;         // number of tokens in the current batch
+    transport_compression comp;
+    std::vector<std::vector<char>> wire;    // the compressed batches
+    size_t word;            // the size of a sample for XOR_DELTA
+
+    //! Empties a buffer, leaving the header of an uncompressed batch
+    void reset(size_t i)
+    {
+        bufs[i].clear();
+        if (comp.enabled()) bufs[i].push_back(CODEC_NONE);
+    }
+
+    //! The message of the current batch, compressed if it pays off
+    const std::vector<char>& message()
+    {
+        if (comp.enabled() &&
+            encode_payload(comp, word, bufs[cur].data()+1, bufs[cur].size()-1, wire[cur]))
+            return wire[cur];
+        return bufs[cur];
+    }
+
+    void send()
+    {
+        const std::vector<char>& msg = message();
+        MPI_Isend(msg.data(), msg.size(), MPI_BYTE,
+                  destination, tag, MPI_COMM_WORLD, &requests[cur]);
+#ifdef FORSYDE_TIMELINE
+        timeline_message(true, destination, tag);
+#endif
+        count = 0;
+    }
+
+#ifdef FORSYDE_SHM_TRANSPORT
+    bool handshaken = false;
+    std::unique_ptr<shm_ring> ring;
+
+    //! Compares the hosts and replies with the chosen transport
+    void handshake(bool can_wait)
+    {
+        char peer[MPI_MAX_PROCESSOR_NAME];
+        MPI_Request request;
+        MPI_Status status;
+        MPI_Irecv(peer, MPI_MAX_PROCESSOR_NAME, MPI_BYTE, destination, tag,
+                  MPI_COMM_WORLD, &request);
+        if (can_wait) mpi_wait(request, status);
+        else MPI_Wait(&request, &status);
+        int len = 0;
+        MPI_Get_count(&status, MPI_BYTE, &len);
+        char local = std::string(peer, len) == mpi_host();
+        if (local)
+        {
+            int rank = 0;
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            ring.reset(new shm_ring(shm_name(rank, destination, tag), false));
+        }
+        MPI_Send(&local, 1, MPI_BYTE, destination, tag, MPI_COMM_WORLD);
+        handshaken = true;
+    }
+
+    void ring_send(bool can_wait)
+    {
+        unsigned attempts = 0;
+        const std::vector<char>& msg = message();
+        while (!ring->try_write(msg.data(), msg.size()))
+            shm_backoff(attempts, can_wait);
+#ifdef FORSYDE_TIMELINE
+        timeline_message(true, destination, tag);
+#endif
+        reset(cur);
+        count = 0;
+    }
+#endif
+};
+
+//! Receives batches of tokens using MPI and unpacks them
+/*! The tokens are deserialized using serializer<T>. If the size of the
+ * serialized tokens is bounded, the receives of the next depth-1 batches
+ * are kept posted while the current one is consumed, so that a bounded
+ * queue of batches can build up when the sender runs ahead. Otherwise,
+ * the size of each batch is probed before receiving it. Batches with
+ * less tokens than the batch size are accepted. The compression should
+ * be the one of the sender.
+ */
+template <typename T>
+class mpi_batch_receiver
+{
+public:
+    //! The constructor requires the source, the tag and the batch size
+    mpi_batch_receiver(int source, int tag, unsigned batch, unsigned depth=2,
+                       const transport_compression& comp=transport_compression())
+        : source(source), tag(tag), batch(batch==0 ? 1 : batch),
+          bufs(depth<2 ? 2 : depth), requests(bufs.size(), MPI_REQUEST_NULL),
+          next(0), ready(bufs.size()-1), pos(NULL), end(NULL), comp(comp)
+    {
+        word = comp.word ? comp.word : serializer<T>::max_size ? serializer<T>::max_size : 8;
+        // a compressed batch is smaller than the uncompressed one
+        if (bounded())
+            for (auto& b : bufs)
+                b.resize(this->batch * serializer<T>::max_size + (comp.enabled() ? 1 : 0));
+    }
+
+    //! Posts the receive of the first batch
+    /*! With FORSYDE_SHM_TRANSPORT, it creates the shared memory ring and
+     * sends the host name to the sender instead.
+     */
+    void start()
+    {
+#ifdef FORSYDE_SHM_TRANSPORT
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        ring.reset(new shm_ring(shm_name(source, rank, tag), true));
+        const std::string host = mpi_host();
+        MPI_Send(host.data(), host.size(), MPI_BYTE, source, tag, MPI_COMM_WORLD);
+        return;
+#endif
+        if (bounded()) post_all();
+    }
+
+    //! Returns the next token, waiting for a new batch if needed
+    void pop(T& val)
+    {
+        if (pos == end) receive();
+        serializer<T>::read(pos, val);
+    }
+
+    //! Cancels the outstanding receive
+    void finish()
+    {
+#ifdef FORSYDE_SHM_TRANSPORT
+        ring.reset();
+#endif
+        for (auto& request : requests)
+        {
+            if (request == MPI_REQUEST_NULL) continue;
+            MPI_Status status;
+            MPI_Cancel(&request);
+            MPI_Wait(&request, &status);
+            request = MPI_REQUEST_NULL;
+        }
+    }
+
+private:
+    int source;
+    int tag;
+    unsigned batch;
+    std::vector<std::vector<char>> bufs;
+    std::vector<MPI_Request> requests;
+    size_t next;            // the buffer of the oldest outstanding receive
+    size_t ready;           // the buffer of the current batch
+    const char* pos;        // the read position in the current batch
+    const char* end;        // the end of the current batch
+    transport_compression comp;
+    size_t word;            // the size of a sample for XOR_DELTA
+    std::vector<char> plain;    // the decompressed batch
+
+    //! Skips the header of the current batch, decompressing it if needed
+    void unpack()
+    {
+        if (!comp.enabled()) return;
+        if (pos != end && *pos == CODEC_NONE)
+        {
+            pos++;
+            return;
+        }
+        if (pos == end || !decode_payload(word, pos, end - pos, plain))
+            SC_REPORT_ERROR("ForSyDe::mpi_batch_receiver", "a compressed batch is malformed or its codec is not available");
+        pos = plain.data();
+        end = pos + plain.size();
+    }
+
+    static constexpr bool bounded() {return serializer<T>::max_size > 0;}
+
+    void post(size_t i)
+    {
+        MPI_Irecv(bufs[i].data(), bufs[i].size(), MPI_BYTE, source,
+                  tag, MPI_COMM_WORLD, &requests[i]);
+    }
+
+    //! Posts the receives into all the buffers but the current one
+    void post_all()
+    {
+        for (size_t i=0; i+1<bufs.size(); i++) post(i);
+    }
+
+#ifdef FORSYDE_SHM_TRANSPORT
+    bool handshaken = false;
+    std::unique_ptr<shm_ring> ring;
+
+    //! Waits for the transport chosen by the sender
+    void handshake()
+    {
+        char local = 0;
+        MPI_Request req;
+        MPI_Status status;
+        MPI_Irecv(&local, 1, MPI_BYTE, source, tag, MPI_COMM_WORLD, &req);
+        mpi_wait(req, status);
+        handshaken = true;
+        if (!local)
+        {
+            ring.reset();
+            if (bounded()) post_all();
+        }
+    }
+#endif
+
+    void receive()
+    {
+        MPI_Status status;
+        int bytes = 0;
+#ifdef FORSYDE_SHM_TRANSPORT
+        if (!handshaken) handshake();
+        if (ring)
+        {
+            unsigned attempts = 0;
+            while (!ring->try_read(bufs[0])) shm_backoff(attempts);
+#ifdef FORSYDE_TIMELINE
+            timeline_message(false, source, tag);
+#endif
+            pos = bufs[0].data();
+            end = pos + bufs[0].size();
+            unpack();
+            return;
+        }
+#endif
+        if (bounded())
+        {
+            // the consumed buffer receives the batch after the posted ones
+            post(ready);
+            mpi_wait(requests[next], status);
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            ready = next;
+            next = (next + 1) % bufs.size();
+        }
+        else
+        {
+            mpi_probe(source, tag, status);
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            bufs[0].resize(bytes);
+            MPI_Recv(bufs[0].data(), bytes, MPI_BYTE, source, tag,
+                     MPI_COMM_WORLD, &status);
+            ready = 0;
+        }
+#ifdef FORSYDE_TIMELINE
+        timeline_message(false, source, tag);
+#endif
+        pos = bufs[ready].data();
+        end = pos + bytes;
+        unpack();
+    }
+};
+
+//! The neighbors of a rank in the tree of a multicast
+/*! The source and the destinations of a multicast form a binomial tree
+ * over their positions in the list of ranks, the source being at
+ * position 0. The position i>0 receives from i-2^k, where 2^k is the
+ * highest power of two not above i, and forwards to the positions i+2^j
+ * with 2^j>i. Hence a batch reaches n destinations in log2(n+1) steps,
+ * and no rank sends more than log2(n+1) copies of it.
+ */
+struct multicast_tree
+{
+    int parent;                 ///< The rank to receive from, or MPI_PROC_NULL
+    std::vector<int> children;  ///< The ranks to forward to
+
+    //! The constructor requires the source, the destinations and the rank
+    multicast_tree(int source, const std::vector<int>& destinations, int rank)
+        : parent(MPI_PROC_NULL)
+    {
+        std::vector<int> ranks(1, source);
+        ranks.insert(ranks.end(), destinations.begin(), destinations.end());
+        const size_t pos = std::find(ranks.begin(), ranks.end(), rank) - ranks.begin();
+        if (pos == ranks.size())
+            SC_REPORT_ERROR("multicast_tree", "the rank is not a member of the multicast");
+        size_t high = 1;
+        while (high*2 <= pos) high *= 2;
+        if (pos > 0) parent = ranks[pos-high];
+        for (size_t step = pos==0 ? 1 : high*2; pos+step < ranks.size(); step *= 2)
+            children.push_back(ranks[pos+step]);
+    }
+};
+
+//! Sends batches of tokens to the children of a rank in a multicast tree
+/*! It works similar to mpi_batch_sender, but each batch is sent to all
+ * the children, and the batches received from the parent can be
+ * forwarded as they are. A buffer is refilled once all of its messages
+ * are sent.
+ */
+template <typename T>
+class mpi_batch_multicaster
+{
+public:
+    //! The constructor requires the children, the tag and the batch size
+    mpi_batch_multicaster(const std::vector<int>& children, int tag,
+                          unsigned batch, unsigned depth=2)
+        : children(children), tag(tag), batch(batch==0 ? 1 : batch),
+          bufs(depth<2 ? 2 : depth),
+          requests(bufs.size(), std::vector<MPI_Request>(children.size(), MPI_REQUEST_NULL)),
+          cur(0), count(0)
+    {
+        if (serializer<T>::max_size > 0)
+            for (auto& b : bufs) b.reserve(this->batch * serializer<T>::max_size);
+    }
+
+    //! Adds a token to the current batch and sends it if full
+    void push(const T& val)
+    {
+        serializer<T>::write(bufs[cur], val);
+        if (++count == batch) flush();
+    }
+
+    //! Sends the tokens of the current batch and switches the buffers
+    void flush()
+    {
+        if (count == 0) return;
+        send();
+        advance();
+    }
+
+    //! Sends a batch received from the parent to the children
+    void forward(const char* data, size_t size)
+    {
+        if (children.empty()) return;
+        bufs[cur].assign(data, data+size);
+        send();
+        advance();
+    }
+
+    //! Sends the remaining tokens and waits for all the messages
+    /*! It does not interact with the simulation kernel and can be called
+     * at the end of the simulation.
+     */
+    void finish()
+    {
+        if (count > 0) send();
+        for (auto& rs : requests)
+            for (auto& request : rs)
+                if (request != MPI_REQUEST_NULL)
+                {
+                    MPI_Status status;
+                    MPI_Wait(&request, &status);
+                    request = MPI_REQUEST_NULL;
+                }
+        for (auto& b : bufs) b.clear();
+    }
+
+private:
+    std::vector<int> children;
+    int tag;
+    unsigned batch;
+    std::vector<std::vector<char>> bufs;
+    std::vector<std::vector<MPI_Request>> requests;
+    size_t cur;
+    unsigned count;         // number of tokens in the current batch
+
+    void send()
+    {
+        for (size_t i=0; i<children.size(); i++)
+        {
+            MPI_Isend(bufs[cur].data(), bufs[cur].size(), MPI_BYTE,
+                      children[i], tag, MPI_COMM_WORLD, &requests[cur][i]);
+#ifdef FORSYDE_TIMELINE
+            timeline_message(true, children[i], tag);
+#endif
+        }
+        count = 0;
+    }
+
+    //! Switches to the next buffer once its messages are sent
+    void advance()
+    {
+        cur = (cur + 1) % bufs.size();
+        for (auto& request : requests[cur])
+            if (request != MPI_REQUEST_NULL)
+            {
+                MPI_Status status;
+                mpi_wait(request, status);
+                request = MPI_REQUEST_NULL;
+            }
+        bufs[cur].clear();
+    }
+};
+
+//! Receives the batches of a multicast and forwards them down the tree
+/*! The batches are received from the parent of the rank in the tree and
+ * sent to its children before they are unpacked, hence a rank forwards
+ * the batches as fast as it consumes their tokens.
+ */
+template <typename T>
+class mpi_multicast_receiver
+{
+public:
+    //! The constructor requires the tree, the tag and the batch size
+    mpi_multicast_receiver(const multicast_tree& tree, int tag,
+                           unsigned batch, unsigned depth=2)
+        : parent(tree.parent), tag(tag), fwd(tree.children, tag, batch, depth),
+          pos(NULL), end(NULL) {}
+
+    //! Returns the next token, waiting for a new batch if needed
+    void pop(T& val)
+    {
+        if (pos == end) receive();
+        serializer<T>::read(pos, val);
+    }
+
+    //! Waits for the forwarded messages
+    void finish()
+    {
+        fwd.finish();
+    }
+
+private:
+    int parent;
+    int tag;
+    mpi_batch_multicaster<T> fwd;
+    std::vector<char> buf;
+    const char* pos;        // the read position in the current batch
+    const char* end;        // the end of the current batch
+
+    void receive()
+    {
+        MPI_Status status;
+        int bytes = 0;
+        mpi_probe(parent, tag, status);
+        MPI_Get_count(&status, MPI_BYTE, &bytes);
+        buf.resize(bytes);
+        MPI_Recv(buf.data(), bytes, MPI_BYTE, parent, tag, MPI_COMM_WORLD,
+                 &status);
+#ifdef FORSYDE_TIMELINE
+        timeline_message(false, parent, tag);
+#endif
+        fwd.forward(buf.data(), bytes);
+        pos = buf.data();
+        end = pos + bytes;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,453 @@
+/**********************************************************************
+    * native_kernel.hpp -- A single scheduler for the whole model     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Running the untimed and the timed ForSyDe processes of *
+    *          all the MoCs by one scheduler instead of the kernel    *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef NATIVE_KERNEL_HPP
+#define NATIVE_KERNEL_HPP
+
+/*! \file native_kernel.hpp
+ * \brief Implements a scheduler of the processes of several MoCs
+ *
+ *  The per-MoC executors (sdf_scheduler, cyclic_executive,
+ * event_scheduler) each take over one region of a model, but the
+ * signals between the regions, e.g., through the MoC interfaces, still
+ * pass through the SystemC kernel. This file includes an opt-in
+ * executor which takes over all the ForSyDe processes below a module
+ * which it can drive, across the MoCs, and runs them in a single thread:
+ *
+ *     native_kernel nk("nk", &top);
+ *     sc_start();
+ *     nk.print_report();
+ *
+ *  The SystemC kernel is then only used for the elaboration, for the
+ * processes which are not taken over and for the other modules of the
+ * model, and for the timed waits of the timed processes.
+ */
+
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <iostream>
+
+#include "abssemantics.hpp"
+#ifndef FORSYDE_NO_DDE
+#include "dde_scheduler.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Runs the ForSyDe processes of several MoCs by a single scheduler
+/*! The executor takes over two kinds of processes:
+ *  - the untimed processes with a static firing rule (see
+ *    process::firing_rule()), e.g., the SY and SDF process constructors,
+ *    which are fired as soon as their inputs have the tokens and their
+ *    outputs the space of a firing, in the order they become ready;
+ *  - the DDE processes, except the filters and the processes of the
+ *    parallel simulation, which are fired in the order of the time tags
+ *    of their next events using a calendar queue, as in event_scheduler.
+ *
+ * The ready untimed processes are all fired before the next timed one.
+ * The kernel time is advanced to the time of a timed process before it
+ * fires if it is ahead of the kernel time by more than the quantum, or
+ * if it is connected to a process which is not taken over. The signals between the processes which are taken over are
+ * switched to plain ring buffers, with room for the tokens of a firing of
+ * both ends. When nothing can fire, the executor waits for the other
+ * signals to be written or read, and stops if there are none.
+ *
+ * The processes taken over should not be driven by other executors.
+ */
+class native_kernel : public sc_module
+{
+public:
+    //! The constructor requires the module name and the root of the model
+    /*! All the ForSyDe processes below the root module in the hierarchy
+     * are considered, unless some processes are added explicitly using
+     * add().
+     */
+    native_kernel(sc_module_name _name,                 ///< The module name
+                  sc_module* root=NULL,                 ///< The root of the model
+                  const sc_time& quantum=SC_ZERO_TIME   ///< The run-ahead of the kernel time
+                  ) : sc_module(_name), root(root), quantum(quantum),
+                      nuntimed(0), ntimed(0), nsyncs(0)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the considered processes
+    void add(ForSyDe::process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! The number of untimed firings executed by the executor
+    unsigned long long untimed_firings() const {return nuntimed;}
+
+    //! The number of timed firings executed by the executor
+    unsigned long long timed_firings() const {return ntimed;}
+
+    //! The number of timed waits of the executor for the kernel time
+    unsigned long long syncs() const {return nsyncs;}
+
+    //! Prints the processes taken over and the firings
+    void print_report(std::ostream& os=std::cout) const
+    {
+        size_t timed = 0;
+        for (auto& a : actors) if (a.timed) timed++;
+        os << "Native kernel " << name() << ": " << actors.size() << " of "
+           << procs.size() << " processes taken over (" << actors.size() - timed
+           << " untimed, " << timed << " timed), " << nuntimed << " untimed and "
+           << ntimed << " timed firings, " << nsyncs << " synchronizations, "
+           << boundary_events.size() << " boundary signals" << std::endl;
+        for (auto p : left) os << "  left to SystemC " << p->name() << std::endl;
+    }
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_native_kernel";}
+
+private:
+    SC_HAS_PROCESS(native_kernel);
+
+    //! A process taken over
+    struct actor
+    {
+        ForSyDe::process* proc;
+        bool timed;
+        // the channels of the firing rule of an untimed process
+        std::vector<std::pair<static_channel*,size_t>> ins, outs;
+#ifndef FORSYDE_NO_DDE
+        DDE::dde_process* dde;
+        std::vector<static_channel*> timed_outs;
+        std::vector<DDE::timed_channel*> timed_ins;
+#endif
+        std::vector<size_t> neighbors;  // writers of the inputs and readers of the outputs
+        bool boundary;                  // connected to the rest of the model
+        bool queued;
+    };
+
+    sc_module* root;
+    sc_time quantum;
+    std::vector<ForSyDe::process*> procs, left;
+    std::vector<actor> actors;
+    std::vector<const sc_event*> boundary_events;
+    // the boundary channels, and if the model writes to them
+    std::vector<std::pair<static_channel*,bool>> boundary_chans;
+    std::deque<size_t> untimed;
+#ifndef FORSYDE_NO_DDE
+    DDE::calendar_queue<size_t> timed;
+#endif
+    unsigned long long nuntimed, ntimed, nsyncs;
+
+    //! Collects the ForSyDe processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        for (auto c : obj->get_child_objects())
+        {
+            if (auto p = dynamic_cast<ForSyDe::process*>(c))
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(c) != NULL)
+                collect(c);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        for (auto c : p->get_child_objects())
+            if (c->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! Looks up the ForSyDe signals of the ports of a firing rule
+    static bool bind(std::vector<ForSyDe::process::firing_port>& ports,
+                     std::vector<std::pair<static_channel*,size_t>>& chans)
+    {
+        for (auto& p : ports)
+            for (auto ch : p.channels())
+            {
+                auto sc = dynamic_cast<static_channel*>(ch);
+                if (sc == NULL) return false;
+                chans.push_back({sc, p.toks});
+            }
+        return true;
+    }
+
+    //! Decides if and how a process is taken over
+    bool take_over(ForSyDe::process* p, actor& a)
+    {
+        if (p->is_ext_driven()) return false;
+#ifndef FORSYDE_NO_DDE
+        if (auto d = dynamic_cast<DDE::dde_process*>(p))
+        {
+            static const std::set<std::string> unsupported = {"DDE::filter",
+                "DDE::ss_filter", "DDE::filterf", "DDE::sender", "DDE::receiver"};
+            if (unsupported.count(p->forsyde_kind())) return false;
+            for (auto& chs : {channels(p, "sc_fifo_in"), channels(p, "sc_fifo_out")})
+                for (auto c : chs)
+                    if (dynamic_cast<static_channel*>(c) == NULL) return false;
+            a.timed = true;
+            a.dde = d;
+            return true;
+        }
+#endif
+        std::vector<ForSyDe::process::firing_port> ins, outs;
+        if (!p->firing_rule(ins, outs)) return false;
+        a.timed = false;
+        return bind(ins, a.ins) && bind(outs, a.outs);
+    }
+
+    //! Builds the graph of the processes taken over
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        for (auto p : procs)
+        {
+            actor a{p, false, {}, {},
+#ifndef FORSYDE_NO_DDE
+                    NULL, {}, {},
+#endif
+                    {}, false, false};
+            if (take_over(p, a)) actors.push_back(a);
+            else left.push_back(p);
+        }
+        // writers and readers of the channels among the processes taken over
+        std::map<sc_interface*,size_t> writer, reader;
+        std::vector<std::vector<sc_interface*>> ins(actors.size()), outs(actors.size());
+        for (size_t i=0; i<actors.size(); i++)
+        {
+            ins[i] = channels(actors[i].proc, "sc_fifo_in");
+            outs[i] = channels(actors[i].proc, "sc_fifo_out");
+            for (auto c : ins[i]) reader[c] = i;
+            for (auto c : outs[i]) writer[c] = i;
+        }
+        for (size_t i=0; i<actors.size(); i++)
+        {
+            actor& a = actors[i];
+#ifndef FORSYDE_NO_DDE
+            std::vector<static_channel*> in_chans;
+#endif
+            for (auto c : ins[i])
+            {
+                static_channel* sc = dynamic_cast<static_channel*>(c);
+                auto w = writer.find(c);
+#ifndef FORSYDE_NO_DDE
+                in_chans.push_back(sc);
+                if (a.timed && w != writer.end())
+                    a.timed_ins.push_back(dynamic_cast<DDE::timed_channel*>(c));
+#endif
+                if (w != writer.end())
+                    a.neighbors.push_back(w->second);
+                else
+                {
+                    a.boundary = true;
+                    boundary_events.push_back(&sc->data_written_event());
+                    boundary_chans.push_back({sc, false});
+                }
+            }
+            for (auto c : outs[i])
+            {
+                static_channel* sc = dynamic_cast<static_channel*>(c);
+#ifndef FORSYDE_NO_DDE
+                if (a.timed) a.timed_outs.push_back(sc);
+#endif
+                auto r = reader.find(c);
+                if (r != reader.end())
+                    a.neighbors.push_back(r->second);
+                else
+                {
+                    a.boundary = true;
+                    boundary_events.push_back(&sc->data_read_event());
+                    boundary_chans.push_back({sc, true});
+                }
+            }
+            std::sort(a.neighbors.begin(), a.neighbors.end());
+            a.neighbors.erase(std::unique(a.neighbors.begin(), a.neighbors.end()),
+                              a.neighbors.end());
+#ifndef FORSYDE_NO_DDE
+            if (a.timed) a.dde->set_event_driven(in_chans);
+            else
+#endif
+            a.proc->set_ext_driven();
+        }
+        // switch the internal channels to plain ring buffers with room for
+        // a firing of both ends
+        for (auto& w : writer)
+        {
+            auto r = reader.find(w.first);
+            if (r == reader.end()) continue;
+            static_channel* sc = dynamic_cast<static_channel*>(w.first);
+            size_t cap = sc->num_available() + sc->num_free();
+            cap = std::max(cap, rate(actors[w.second], sc, true) + rate(actors[r->second], sc, false));
+            sc->set_static_buffer(std::max<size_t>(cap, 1));
+        }
+    }
+
+    //! The tokens an untimed process writes or reads on a channel in a firing
+    static size_t rate(const actor& a, static_channel* ch, bool out)
+    {
+        for (auto& c : out ? a.outs : a.ins)
+            if (c.first == ch) return c.second;
+        return 1;
+    }
+
+    //! Checks if a process can fire without blocking
+    static bool ready(const actor& a)
+    {
+#ifndef FORSYDE_NO_DDE
+        if (a.timed)
+        {
+            if (a.dde->is_halted()) return false;
+            for (auto c : a.timed_outs)
+                if (c->num_free() == 0) return false;
+            return a.dde->inputs_ready();
+        }
+#endif
+        for (auto& c : a.ins)
+            if ((size_t)c.first->num_available() < c.second) return false;
+        for (auto& c : a.outs)
+            if ((size_t)c.first->num_free() < c.second) return false;
+        return true;
+    }
+
+#ifndef FORSYDE_NO_DDE
+    //! The time of the next firing of a timed process
+    static sc_time firing_time(const actor& a)
+    {
+        sc_time t = sc_max_time(), h;
+        bool found = false;
+        for (auto c : a.timed_ins)
+            if (c != NULL && c->head_time(h))
+            {
+                t = std::min(t, h);
+                found = true;
+            }
+        return found ? std::max(t, a.dde->local_time()) : a.dde->local_time();
+    }
+#endif
+
+    //! Queues a process if it can fire and is not queued yet
+    void schedule(size_t i)
+    {
+        actor& a = actors[i];
+        if (a.queued || !ready(a)) return;
+        a.queued = true;
+#ifndef FORSYDE_NO_DDE
+        if (a.timed)
+        {
+            timed.push(firing_time(a).value(), i);
+            return;
+        }
+#endif
+        untimed.push_back(i);
+    }
+
+    //! Queues the processes connected to the rest of the model
+    void schedule_boundaries()
+    {
+        for (size_t i=0; i<actors.size(); i++)
+            if (actors[i].boundary) schedule(i);
+    }
+
+    //! Fires a process and queues it and its neighbors again
+    void fire(size_t i)
+    {
+        actor& a = actors[i];
+        a.proc->ext_fire();
+        schedule(i);
+        for (auto n : a.neighbors) schedule(n);
+    }
+
+    //! Requests the notifications of the events of the boundary channels
+    /*! The SPSC signals only notify the waiters which asked for it (see
+     * signal::data_written_event()), hence it is called before each wait.
+     */
+    void arm_boundaries()
+    {
+        for (auto& b : boundary_chans)
+            if (b.second)
+                b.first->data_read_event();
+            else
+                b.first->data_written_event();
+    }
+
+    //! The main and only execution thread of the executor
+    void worker()
+    {
+        for (auto& a : actors) a.proc->ext_init();
+        if (actors.empty()) return;
+        sc_event_or_list boundary_changed;
+        for (auto e : boundary_events) boundary_changed |= *e;
+        for (size_t i=0; i<actors.size(); i++) schedule(i);
+        while (1)
+        {
+            // the untimed processes fire at the current time
+            while (!untimed.empty())
+            {
+                const size_t i = untimed.front();
+                untimed.pop_front();
+                actors[i].queued = false;
+                if (!ready(actors[i])) continue;
+                fire(i);
+                nuntimed++;
+            }
+#ifndef FORSYDE_NO_DDE
+            if (!timed.empty())
+            {
+                auto next = timed.pop();
+                actor& a = actors[next.second];
+                a.queued = false;
+                const sc_time t = sc_time::from_value(next.first);
+                if (t > model_time() && (a.boundary || t - model_time() > quantum))
+                {
+                    wait(t - model_time());
+                    nsyncs++;
+                    schedule_boundaries();
+                }
+                if (!ready(a)) continue;
+                fire(next.second);
+                ntimed++;
+                continue;
+            }
+#endif
+            // the model has finished, or waits for the rest of it
+            if (boundary_events.empty()) return;
+            arm_boundaries();
+            wait(boundary_changed);
+            schedule_boundaries();
+        }
+    }
+};
+
+//! Helper function to construct a native kernel for a model
+inline native_kernel* make_native_kernel(const std::string& pName,  ///< the executor name
+    sc_module* root,                                ///< the root of the model
+    const sc_time& quantum=SC_ZERO_TIME             ///< the run-ahead of the kernel time
+    )
+{
+    return new native_kernel(pName.c_str(), root, quantum);
+}
+
+}
+
+#endif
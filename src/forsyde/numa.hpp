@@ -0,0 +1,359 @@
+/**********************************************************************
+    * numa.hpp -- Placement of the memory on the NUMA nodes           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Allocating the buffers of the executors on the node of *
+    *          the threads using them, with optional huge pages       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_NUMA to enable it (Linux only)          *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef NUMA_HPP
+#define NUMA_HPP
+
+/*! \file numa.hpp
+ * \brief Implements the NUMA-aware allocation of the memory
+ *
+ *  On the hosts with several NUMA nodes (e.g., the dual-socket ones) the
+ * accesses of a thread to the memory of the other node are much slower
+ * than to the memory of its own. This file includes the primitives
+ * which discover the nodes from sysfs, bind threads to the cores of a
+ * node, and allocate and migrate memory on a node, using the system
+ * calls directly so that libnuma is not required.
+ *
+ *  While a numa_scope is active on a thread, the ring buffers which the
+ * executors allocate for the signals (see static_channel) are placed on
+ * its node, and the large ones are backed by huge pages. The arenas can
+ * also be bound to a node (see elab_arena::set_node), and the token
+ * pools keep a pool per node. The placement of the processes on the
+ * nodes is defined by numa_placement.
+ */
+
+#include <vector>
+#include <map>
+#include <mutex>
+#include <memory>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <new>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <sched.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+//! The smallest buffer in bytes which is backed by huge pages
+#ifndef FORSYDE_NUMA_HUGE_MIN
+#define FORSYDE_NUMA_HUGE_MIN (2 << 20)
+#endif
+
+namespace ForSyDe
+{
+
+//! How the memory allocated on a node is backed
+enum huge_pages
+{
+    NO_HUGE_PAGES,          ///< normal pages
+    TRANSPARENT_HUGE_PAGES, ///< transparent huge pages, if the kernel provides them
+    EXPLICIT_HUGE_PAGES     ///< reserved huge pages, or the transparent ones if none is free
+};
+
+//! The NUMA nodes of the host and their cores
+/*! The nodes are read once from /sys/devices/system/node and indexed
+ * from zero. A host without this information is treated as a single
+ * node with all the cores.
+ */
+class numa_topology
+{
+public:
+    //! Returns the single instance of the topology
+    static const numa_topology& get()
+    {
+        static numa_topology topo;
+        return topo;
+    }
+
+    //! The number of nodes
+    int nodes() const {return cpus.size();}
+
+    //! The cores of a node
+    const std::vector<int>& cores(int node) const {return cpus[node % nodes()];}
+
+    //! The identifier of a node in the kernel, which may differ from its index
+    int id(int node) const {return ids[node % nodes()];}
+
+    //! The node of a core, or -1 if it is unknown
+    int node_of_core(int cpu) const
+    {
+        auto it = core_node.find(cpu);
+        return it == core_node.end() ? -1 : it->second;
+    }
+
+private:
+    std::vector<std::vector<int>> cpus;
+    std::vector<int> ids;
+    std::map<int,int> core_node;
+
+    numa_topology()
+    {
+        if (DIR* d = opendir("/sys/devices/system/node"))
+        {
+            std::map<int,std::vector<int>> found;
+            while (dirent* e = readdir(d))
+            {
+                int n;
+                char rest;
+                if (std::sscanf(e->d_name, "node%d%c", &n, &rest) != 1) continue;
+                std::ifstream ifs("/sys/devices/system/node/" + std::string(e->d_name) + "/cpulist");
+                std::string list;
+                if (std::getline(ifs, list)) found[n] = parse_list(list);
+            }
+            closedir(d);
+            // the nodes without cores (e.g., memory expanders) are not used
+            for (auto& f : found)
+                if (!f.second.empty())
+                {
+                    ids.push_back(f.first);
+                    cpus.push_back(f.second);
+                }
+        }
+        if (cpus.empty())
+        {
+            cpus.emplace_back();
+            ids.push_back(0);
+            const long n = sysconf(_SC_NPROCESSORS_CONF);
+            for (long c=0; c<std::max(n, 1L); c++) cpus[0].push_back(c);
+        }
+        for (size_t n=0; n<cpus.size(); n++)
+            for (auto c : cpus[n]) core_node[c] = n;
+    }
+
+    //! Parses a list of cores such as 0-7,16-23
+    static std::vector<int> parse_list(const std::string& list)
+    {
+        std::vector<int> res;
+        std::stringstream ss(list);
+        for (std::string r; std::getline(ss, r, ',');)
+        {
+            int a, b;
+            const int k = std::sscanf(r.c_str(), "%d-%d", &a, &b);
+            if (k == 1) b = a;
+            if (k >= 1)
+                for (int c=a; c<=b; c++) res.push_back(c);
+        }
+        return res;
+    }
+};
+
+//! The node of the core running the calling thread, or -1 if it is unknown
+inline int numa_current_node()
+{
+    const int cpu = sched_getcpu();
+    return cpu < 0 ? -1 : numa_topology::get().node_of_core(cpu);
+}
+
+//! Restricts the calling thread, and the threads it starts later, to the cores of a node
+inline bool numa_bind_thread(int node)
+{
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (auto c : numa_topology::get().cores(node)) CPU_SET(c, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+//! Binds the calling thread to a node during its lifetime
+/*! The previous affinity of the thread is restored at the end. Memory
+ * first touched meanwhile (e.g., the buffers allocated by the init stage
+ * of a process) is hence placed on the node.
+ */
+class numa_thread_binding
+{
+public:
+    explicit numa_thread_binding(int node) : bound(false)
+    {
+        if (node < 0 || sched_getaffinity(0, sizeof(prev), &prev) != 0) return;
+        bound = numa_bind_thread(node);
+    }
+
+    ~numa_thread_binding()
+    {
+        if (bound) sched_setaffinity(0, sizeof(prev), &prev);
+    }
+
+    numa_thread_binding(const numa_thread_binding&) = delete;
+    numa_thread_binding& operator=(const numa_thread_binding&) = delete;
+
+private:
+    cpu_set_t prev;
+    bool bound;
+};
+
+//! The memory policies and flags of mbind and move_pages (see numaif.h)
+struct numa_syscalls
+{
+    static const int MPOL_PREFERRED_ = 1;
+    static const int MPOL_MF_MOVE_ = 1 << 1;
+
+    //! Prefers a node for the pages of a range
+    static bool prefer(void* addr, size_t len, int node)
+    {
+        unsigned long mask[16] = {0};
+        if (node < 0) return false;
+        node = numa_topology::get().id(node);
+        if (node < 0 || node >= int(sizeof(mask)*8)) return false;
+        mask[node / (8*sizeof(long))] |= 1UL << (node % (8*sizeof(long)));
+        return syscall(SYS_mbind, addr, len, MPOL_PREFERRED_, mask,
+                       sizeof(mask)*8, 0) == 0;
+    }
+};
+
+//! The lengths of the blocks mapped by numa_alloc
+inline std::map<void*,size_t>& numa_blocks()
+{
+    static std::map<void*,size_t> blocks;
+    return blocks;
+}
+
+inline std::mutex& numa_blocks_mutex()
+{
+    static std::mutex m;
+    return m;
+}
+
+//! Allocates a page-aligned block of memory on a node
+/*! The block is preferably placed on the node, and the blocks of at
+ * least FORSYDE_NUMA_HUGE_MIN bytes are backed by huge pages as
+ * requested. It returns NULL if the memory can not be mapped.
+ */
+inline void* numa_alloc(size_t bytes, int node, huge_pages huge=TRANSPARENT_HUGE_PAGES)
+{
+    if (bytes < FORSYDE_NUMA_HUGE_MIN) huge = NO_HUGE_PAGES;
+    const size_t page = sysconf(_SC_PAGESIZE);
+    size_t len = (std::max<size_t>(bytes, 1) + page - 1) / page * page;
+    void* p = MAP_FAILED;
+    if (huge == EXPLICIT_HUGE_PAGES)
+    {
+        // the default huge page size is assumed to be 2 MiB
+        const size_t hlen = (len + (2 << 20) - 1) / (2 << 20) * (2 << 20);
+        p = mmap(NULL, hlen, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB, -1, 0);
+        if (p != MAP_FAILED) len = hlen;
+    }
+    if (p == MAP_FAILED)
+    {
+        p = mmap(NULL, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (p == MAP_FAILED) return NULL;
+#ifdef MADV_HUGEPAGE
+        if (huge != NO_HUGE_PAGES) madvise(p, len, MADV_HUGEPAGE);
+#endif
+    }
+    // the pages are placed when they are first touched
+    numa_syscalls::prefer(p, len, node);
+    std::lock_guard<std::mutex> lock(numa_blocks_mutex());
+    numa_blocks()[p] = len;
+    return p;
+}
+
+//! Frees a block allocated by numa_alloc
+inline void numa_free(void* p)
+{
+    if (p == NULL) return;
+    size_t len = 0;
+    {
+        std::lock_guard<std::mutex> lock(numa_blocks_mutex());
+        auto it = numa_blocks().find(p);
+        if (it == numa_blocks().end()) return;
+        len = it->second;
+        numa_blocks().erase(it);
+    }
+    munmap(p, len);
+}
+
+//! Moves the pages of a range of memory to a node
+/*! The whole pages overlapping the range are moved, including the other
+ * objects on them. It returns the number of pages which are on the node
+ * afterwards.
+ */
+inline size_t numa_migrate(const void* addr, size_t bytes, int node)
+{
+    if (addr == NULL || bytes == 0 || node < 0) return 0;
+    const std::uintptr_t page = sysconf(_SC_PAGESIZE);
+    const std::uintptr_t from = reinterpret_cast<std::uintptr_t>(addr) / page * page;
+    const std::uintptr_t to = reinterpret_cast<std::uintptr_t>(addr) + bytes;
+    std::vector<void*> pages;
+    for (std::uintptr_t p=from; p<to; p+=page) pages.push_back(reinterpret_cast<void*>(p));
+    const int id = numa_topology::get().id(node);
+    std::vector<int> nodes(pages.size(), id), status(pages.size(), -1);
+    syscall(SYS_move_pages, 0, pages.size(), pages.data(), nodes.data(), status.data(),
+            numa_syscalls::MPOL_MF_MOVE_);
+    size_t res = 0;
+    for (auto s : status)
+        if (s == id) res++;
+    return res;
+}
+
+//! Allocates an array of value-initialized objects on a node
+/*! The array is freed, after destructing the objects, when the last
+ * copy of the returned pointer is destroyed.
+ */
+template <typename T>
+inline std::shared_ptr<T> numa_make_array(size_t n, int node,
+                                          huge_pages huge=TRANSPARENT_HUGE_PAGES)
+{
+    void* mem = numa_alloc(n * sizeof(T), node, huge);
+    if (mem == NULL) throw std::bad_alloc();
+    T* arr = static_cast<T*>(mem);
+    for (size_t i=0; i<n; i++) new (arr+i) T();
+    return std::shared_ptr<T>(arr, [n](T* a)
+    {
+        for (size_t i=n; i>0; i--) a[i-1].~T();
+        numa_free(a);
+    });
+}
+
+//! The node on which the buffers are allocated on the calling thread
+struct numa_target
+{
+    int node;           ///< the node, or -1 for the default allocation
+    huge_pages huge;    ///< the backing of the large buffers
+};
+
+//! Makes the buffers allocated on the calling thread be placed on a node
+/*! It applies to the ring buffers of the signals (see
+ * static_channel::set_static_buffer) during its lifetime. A negative
+ * node leaves the allocation to the default policy.
+ */
+class numa_scope
+{
+public:
+    explicit numa_scope(int node, huge_pages huge=TRANSPARENT_HUGE_PAGES)
+        : prev(current())
+    {
+        current() = numa_target{node, huge};
+    }
+
+    ~numa_scope() {current() = prev;}
+
+    numa_scope(const numa_scope&) = delete;
+    numa_scope& operator=(const numa_scope&) = delete;
+
+    //! The target of the calling thread
+    static numa_target& current()
+    {
+        thread_local numa_target target = {-1, NO_HUGE_PAGES};
+        return target;
+    }
+
+private:
+    numa_target prev;
+};
+
+}
+
+#endif
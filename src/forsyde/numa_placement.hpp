@@ -0,0 +1,160 @@
+/**********************************************************************
+    * numa_placement.hpp -- Placement of the processes on NUMA nodes  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Mapping the partitions of a model to the NUMA nodes    *
+    *          which run them and hold their memory                   *
+    *                                                                 *
+    * Usage:   Define FORSYDE_NUMA to enable it (Linux only)          *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef NUMA_PLACEMENT_HPP
+#define NUMA_PLACEMENT_HPP
+
+/*! \file numa_placement.hpp
+ * \brief Implements the placement of the processes on the NUMA nodes
+ *
+ *  The multi-threaded executors (SY::parallel_executor and
+ * SDF::hsdf_executor) accept a placement of their processes on the
+ * nodes of the host. Each process is then fired by the worker threads of
+ * its node, its init stage runs on that node so that the buffers it
+ * allocates are local, and the ring buffers of the signals it reads are
+ * allocated on its node. The placement is usually derived from the
+ * partitions computed by the graph partitioner for the exported
+ * process network:
+ *
+ *     partitioner part("gen/top.xml");
+ *     part.load_profile("forsyde_profile.csv", "top.");
+ *     auto pl = numa_placement::from_partitions(
+ *                   part.partition(numa_topology::get().nodes()), t);
+ *     exec->set_placement(pl);
+ */
+
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+
+#include "abssemantics.hpp"
+#include "numa.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A placement of the processes of a model on the NUMA nodes
+class numa_placement
+{
+public:
+    //! Places a process on a node
+    void assign(ForSyDe::process* p, int node) {nodes[p] = node;}
+
+    //! Places all the processes below a module (or a single process) on a node
+    void assign(sc_object* obj, int node)
+    {
+        if (auto p = dynamic_cast<ForSyDe::process*>(obj))
+        {
+            assign(p, node);
+            return;
+        }
+        for (auto c : obj->get_child_objects()) assign(c, node);
+    }
+
+    //! Derives the placement from a mapping of the vertices of a process network to partitions
+    /*! The vertices are the children of the top module, by their names,
+     * as in the mapping computed by partitioner::partition(). Partition k
+     * is placed on node k modulo the number of nodes, which is the one
+     * of the host if it is zero.
+     */
+    static numa_placement from_partitions(const std::map<std::string,int>& mapping,
+                                          sc_module* top, int num_nodes=0)
+    {
+        if (num_nodes <= 0) num_nodes = numa_topology::get().nodes();
+        numa_placement res;
+        for (auto& m : mapping)
+        {
+            sc_object* obj = sc_find_object((std::string(top->name()) + "." + m.first).c_str());
+            if (obj == NULL)
+            {
+                SC_REPORT_WARNING(top->name(), ("no process named " + m.first + " to place").c_str());
+                continue;
+            }
+            res.assign(obj, m.second % num_nodes);
+        }
+        return res;
+    }
+
+    //! The node of a process, or -1 if it is not placed
+    int node_of(const ForSyDe::process* p) const
+    {
+        auto it = nodes.find(const_cast<ForSyDe::process*>(p));
+        return it == nodes.end() ? -1 : it->second;
+    }
+
+    //! The node of the ring buffer of a channel, which is the one of its reader
+    /*! The node of the writer is used if the reader is not placed, and -1
+     * if neither of them is.
+     */
+    int node_of_channel(sc_interface* ch) const
+    {
+        int res = -1;
+        for (auto& n : nodes)
+            for (auto c : n.first->get_child_objects())
+            {
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                const bool in = c->kind() == std::string("sc_fifo_in");
+                if (!in && res >= 0) continue;
+                for (auto b : port->bound_channels())
+                    if (b == ch)
+                    {
+                        if (in) return n.second;
+                        res = n.second;
+                    }
+            }
+        return res;
+    }
+
+    //! The nodes used by the placement, in increasing order
+    std::vector<int> used_nodes() const
+    {
+        std::vector<int> res;
+        for (auto& n : nodes)
+            if (std::find(res.begin(), res.end(), n.second) == res.end())
+                res.push_back(n.second);
+        std::sort(res.begin(), res.end());
+        return res;
+    }
+
+    //! Checks if no process is placed
+    bool empty() const {return nodes.empty();}
+
+    //! Runs the init stage of an externally driven process on its node
+    /*! The calling thread is bound to the node meanwhile, so that the
+     * buffers allocated by the process are placed there by the first-touch
+     * policy of the kernel.
+     */
+    void init(ForSyDe::process* p) const
+    {
+        numa_thread_binding bind(node_of(p));
+        p->ext_init();
+    }
+
+    //! Sets the huge pages used for the large ring buffers
+    void set_huge_pages(huge_pages h) {huge = h;}
+
+    //! The huge pages used for the large ring buffers
+    huge_pages ring_pages() const {return huge;}
+
+private:
+    std::map<ForSyDe::process*,int> nodes;
+    huge_pages huge = TRANSPARENT_HUGE_PAGES;
+};
+
+}
+
+#endif
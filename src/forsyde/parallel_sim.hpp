@@ -21,11 +21,17 @@
  * facilities used for enabling parallel simulations.
  */
 
+#include <vector>
+#include <memory>
 #include <mpi.h>
 
+#include "mpi_transport.hpp"
+
 namespace ForSyDe
 {
 
+using namespace sc_core;
+
 namespace SY
 {
 
@@ -34,7 +40,16 @@ using namespace sc_core;
 
 //! Process constructor for a sender process with one input
 /*! This class is used to build a processes with one input. It transmits
- * the non-absent events it receives using an MPI_send command.
+ * the events it receives using MPI messages. The events are serialized
+ * using serializer<abst_ext<T1>>, hence the absent events cost only one
+ * byte.
+ *
+ * The events are sent in batches of a given size, which reduces the
+ * number of messages at the expense of latency. A partial last batch is
+ * sent at the end of the simulation. Up to depth batches can be in
+ * flight, hence the upstream rank can run ahead of the downstream one
+ * by depth batches. The batches can be compressed on the links with a
+ * limited bandwidth (see transport_compression).
  */
 template <typename T1>
 class sender : public sy_process
@@ -49,13 +64,20 @@ public:
      */
     sender(sc_module_name _name,     ///< process name
            int destination,          ///< MPI rank of the destination process
-           int tag                   ///< MPI tag of the message
+           int tag,                  ///< MPI tag of the message
+           unsigned batch=1,         ///< number of events sent in each message
+           unsigned depth=2,         ///< number of messages in flight
+           const transport_compression& comp=transport_compression() ///< compression of the batches
          ) : sy_process(_name), iport1("iport1"),
-             destination(destination), tag(tag)
+             destination(destination), tag(tag), batch(batch),
+             depth(depth), buf(destination, tag, batch, depth, comp)
     {
 #ifdef FORSYDE_INTROSPECTION
-        arg_vec.push_back(std::make_tuple("destination",std::to_string(destination)));
-        arg_vec.push_back(std::make_tuple("tag",std::to_string(tag)));
+        add_arg("destination", destination);
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+        add_arg("compression", comp.codec);
 #endif
     }
     
@@ -65,40 +87,31 @@ public:
 private:
     int destination;
     int tag;
+    unsigned batch;
+    unsigned depth;
     
     // Inputs and output variables
-    T1* ival1;
+    abst_ext<T1> ival1;
+    mpi_batch_sender<abst_ext<T1>> buf;
     
     //Implementing the abstract semantics
-    void init()
-    {
-        ival1 = new T1;
-    }
+    void init() {}
     
     void prep()
     {
-        abst_ext<T1> temp_val = iport1.read();
-        *ival1 = unsafe_from_abst_ext(temp_val);
+        ival1 = iport1.read();
     }
     
     void exec() {}
     
     void prod()
     {
-        MPI_Request request;
-        MPI_Status status;
-        MPI_Isend(ival1, sizeof(T1), MPI_BYTE, destination, tag, MPI_COMM_WORLD, &request);
-        int flag=0;
-        while (true)
-        {
-            MPI_Test(&request, &flag, &status);
-            if (flag) break; else wait(0,SC_NS);
-        }
+        buf.push(ival1);
     }
     
     void clean()
     {
-        delete ival1;
+        buf.finish();
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -112,8 +125,13 @@ private:
 
 //! Process constructor for a receiver process with one output
 /*! This class is used to build a processes with one output.
- * It receives non-absent events via MPI_recv command and writes them to
- * its output signal.
+ * It receives the events, including the absent ones, via MPI messages
+ * and writes them to its output signal.
+ *
+ * The batch size should match the one of the corresponding sender. For
+ * the token types with a bounded serialized size, the receives of the
+ * next depth-1 batches are overlapped with writing the current one.
+ * The compression should also match the one of the sender.
  */
 template <typename T0>
 class receiver : public sy_process
@@ -128,13 +146,20 @@ public:
      */
     receiver(sc_module_name _name,     ///< process name
            int source,                 ///< MPI rank of the source process
-           int tag                     ///< MPI tag of the message
+           int tag,                    ///< MPI tag of the message
+           unsigned batch=1,           ///< number of events received in each message
+           unsigned depth=2,           ///< number of messages queued
+           const transport_compression& comp=transport_compression() ///< compression of the batches
          ) : sy_process(_name), oport1("oport1"),
-             source(source), tag(tag)
+             source(source), tag(tag), batch(batch),
+             depth(depth), buf(source, tag, batch, depth, comp)
     {
 #ifdef FORSYDE_INTROSPECTION
-        arg_vec.push_back(std::make_tuple("source",std::to_string(source)));
-        arg_vec.push_back(std::make_tuple("tag",std::to_string(tag)));
+        add_arg("source", source);
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+        add_arg("compression", comp.codec);
 #endif
     }
     
@@ -144,41 +169,206 @@ public:
 private:
     int source;
     int tag;
+    unsigned batch;
+    unsigned depth;
     
     // Inputs and output variables
-    abst_ext<T0>* oval1;
+    abst_ext<T0> oval1;
+    mpi_batch_receiver<abst_ext<T0>> buf;
     
     //Implementing the abstract semantics
     void init()
     {
-        oval1 = new abst_ext<T0>;
+        buf.start();
     }
     
     void prep()
     {
-        T0 temp_val;
-        MPI_Status status;
-        MPI_Request request;
-        MPI_Irecv(&temp_val, sizeof(T0), MPI_BYTE, source, tag, MPI_COMM_WORLD, &request);
-        int flag=0;
-        while (true)
-        {
-            MPI_Test(&request, &flag, &status);
-            if (flag) break; else wait(0,SC_NS);
-        }
-        set_val(*oval1, temp_val);
+        buf.pop(oval1);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, oval1);
+    }
+    
+    void clean()
+    {
+        buf.finish();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a multicast sender process with one input
+/*! This class is used to build a processes with one input. It transmits
+ * the events it receives to several ranks, each of which runs a
+ * multicast_receiver with the same source, destinations and tag. The
+ * batches are sent along a binomial tree over the ranks (see
+ * multicast_tree), where each receiver forwards them to the next ones,
+ * hence the cost of the sender grows logarithmically with the number of
+ * destinations instead of linearly as with one sender per destination.
+ *
+ * The batch size and the depth are as for the sender.
+ */
+template <typename T1>
+class multicast_sender : public sy_process
+{
+public:
+    SY_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * sends it to the destination ranks.
+     */
+    multicast_sender(sc_module_name _name,     ///< process name
+           const std::vector<int>& destinations,  ///< MPI ranks of the destination processes
+           int tag,                  ///< MPI tag of the messages
+           unsigned batch=1,         ///< number of events sent in each message
+           unsigned depth=2          ///< number of messages in flight
+         ) : sy_process(_name), iport1("iport1"),
+             destinations(destinations), tag(tag), batch(batch), depth(depth)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("fanout", destinations.size());
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::multicast_sender";}
+
+private:
+    std::vector<int> destinations;
+    int tag;
+    unsigned batch;
+    unsigned depth;
+    
+    // Inputs and output variables
+    abst_ext<T1> ival1;
+    std::unique_ptr<mpi_batch_multicaster<abst_ext<T1>>> buf;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        multicast_tree tree(rank, destinations, rank);
+        buf.reset(new mpi_batch_multicaster<abst_ext<T1>>(tree.children, tag, batch, depth));
+    }
+    
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        buf->push(ival1);
+    }
+    
+    void clean()
+    {
+        buf->finish();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for a multicast receiver process with one output
+/*! This class is used to build a processes with one output. It receives
+ * the events of a multicast_sender, forwards them to the receivers
+ * below it in the multicast tree and writes them to its output signal.
+ * The source, the destinations and the tag should be the same in all the
+ * receivers of a multicast.
+ *
+ * The batches are forwarded when they are received, hence a receiver
+ * which stops reading also stops the receivers below it.
+ */
+template <typename T0>
+class multicast_receiver : public sy_process
+{
+public:
+    SY_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which receives data from the source rank
+     * and writes it to its output port.
+     */
+    multicast_receiver(sc_module_name _name,     ///< process name
+           int source,                 ///< MPI rank of the source process
+           const std::vector<int>& destinations,  ///< MPI ranks of all the destination processes
+           int tag,                    ///< MPI tag of the messages
+           unsigned batch=1,           ///< number of events received in each message
+           unsigned depth=2            ///< number of forwarded messages in flight
+         ) : sy_process(_name), oport1("oport1"), source(source),
+             destinations(destinations), tag(tag), batch(batch), depth(depth)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("source", source);
+        add_arg("fanout", destinations.size());
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::multicast_receiver";}
+
+private:
+    int source;
+    std::vector<int> destinations;
+    int tag;
+    unsigned batch;
+    unsigned depth;
+    
+    // Inputs and output variables
+    abst_ext<T0> oval1;
+    std::unique_ptr<mpi_multicast_receiver<abst_ext<T0>>> buf;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        multicast_tree tree(source, destinations, rank);
+        buf.reset(new mpi_multicast_receiver<abst_ext<T0>>(tree, tag, batch, depth));
+    }
+    
+    void prep()
+    {
+        buf->pop(oval1);
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *oval1)
+        write_multiport(oport1, oval1);
     }
     
     void clean()
     {
-        delete oval1;
+        buf->finish();
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -201,7 +391,16 @@ using namespace sc_core;
 
 //! Process constructor for a sender process with one input
 /*! This class is used to build a processes with one input. It transmits
- * the non-absent events it receives using an MPI_send command.
+ * the tokens it receives using MPI messages. The tokens are serialized
+ * using serializer<T1>, which supports the trivially copyable types,
+ * vectors, strings and arrays, and can be specialized for other types.
+ *
+ * The events are sent in batches of a given size, which reduces the
+ * number of messages at the expense of latency. A partial last batch is
+ * sent at the end of the simulation. Up to depth batches can be in
+ * flight, hence the upstream rank can run ahead of the downstream one
+ * by depth batches. The batches can be compressed on the links with a
+ * limited bandwidth (see transport_compression).
  */
 template <typename T1>
 class sender : public sdf_process
@@ -216,13 +415,20 @@ public:
      */
     sender(sc_module_name _name,     ///< process name
            int destination,          ///< MPI rank of the destination process
-           int tag                   ///< MPI tag of the message
+           int tag,                  ///< MPI tag of the message
+           unsigned batch=1,         ///< number of events sent in each message
+           unsigned depth=2,         ///< number of messages in flight
+           const transport_compression& comp=transport_compression() ///< compression of the batches
          ) : sdf_process(_name), iport1("iport1"),
-             destination(destination), tag(tag)
+             destination(destination), tag(tag), batch(batch),
+             depth(depth), buf(destination, tag, batch, depth, comp)
     {
 #ifdef FORSYDE_INTROSPECTION
-        arg_vec.push_back(std::make_tuple("destination",std::to_string(destination)));
-        arg_vec.push_back(std::make_tuple("tag",std::to_string(tag)));
+        add_arg("destination", destination);
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+        add_arg("compression", comp.codec);
 #endif
     }
     
@@ -232,40 +438,415 @@ public:
 private:
     int destination;
     int tag;
+    unsigned batch;
+    unsigned depth;
     
     // Inputs and output variables
-    T1* ival1;
+    T1 ival1;
+    mpi_batch_sender<T1> buf;
+    
+    //Implementing the abstract semantics
+    void init() {}
+    
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        buf.push(ival1);
+    }
+    
+    void clean()
+    {
+        buf.finish();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for a receiver process with one output
+/*! This class is used to build a processes with one output.
+ * It receives tokens via MPI messages and writes them to its output
+ * signal.
+ *
+ * The batch size should match the one of the corresponding sender. For
+ * the token types with a bounded serialized size, the receives of the
+ * next depth-1 batches are overlapped with writing the current one.
+ * The compression should also match the one of the sender.
+ */
+template <typename T0>
+class receiver : public sdf_process
+{
+public:
+    SDF_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    receiver(sc_module_name _name,     ///< process name
+           int source,                 ///< MPI rank of the source process
+           int tag,                    ///< MPI tag of the message
+           unsigned batch=1,           ///< number of events received in each message
+           unsigned depth=2,           ///< number of messages queued
+           const transport_compression& comp=transport_compression() ///< compression of the batches
+         ) : sdf_process(_name), oport1("oport1"),
+             source(source), tag(tag), batch(batch),
+             depth(depth), buf(source, tag, batch, depth, comp)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("source", source);
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+        add_arg("compression", comp.codec);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::receiver";}
+
+private:
+    int source;
+    int tag;
+    unsigned batch;
+    unsigned depth;
+    
+    // Inputs and output variables
+    T0 oval1;
+    mpi_batch_receiver<T0> buf;
     
     //Implementing the abstract semantics
     void init()
     {
-        ival1 = new T1;
+        buf.start();
     }
     
     void prep()
     {
-        T1 temp_val = iport1.read();
-        *ival1 = temp_val;
+        buf.pop(oval1);
     }
     
     void exec() {}
     
     void prod()
     {
-        MPI_Request request;
-        MPI_Status status;
-        MPI_Isend(ival1, sizeof(T1), MPI_BYTE, destination, tag, MPI_COMM_WORLD, &request);
-        int flag=0;
-        while (true)
+        write_multiport(oport1, oval1);
+    }
+    
+    void clean()
+    {
+        buf.finish();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a multicast sender process with one input
+/*! This class is used to build a processes with one input. It transmits
+ * the tokens it receives to several ranks, each of which runs a
+ * multicast_receiver with the same source, destinations and tag. The
+ * batches are sent along a binomial tree over the ranks (see
+ * multicast_tree), where each receiver forwards them to the next ones,
+ * hence the cost of the sender grows logarithmically with the number of
+ * destinations instead of linearly as with one sender per destination.
+ *
+ * The batch size and the depth are as for the sender.
+ */
+template <typename T1>
+class multicast_sender : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * sends it to the destination ranks.
+     */
+    multicast_sender(sc_module_name _name,     ///< process name
+           const std::vector<int>& destinations,  ///< MPI ranks of the destination processes
+           int tag,                  ///< MPI tag of the messages
+           unsigned batch=1,         ///< number of tokens sent in each message
+           unsigned depth=2          ///< number of messages in flight
+         ) : sdf_process(_name), iport1("iport1"),
+             destinations(destinations), tag(tag), batch(batch), depth(depth)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("fanout", destinations.size());
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::multicast_sender";}
+
+private:
+    std::vector<int> destinations;
+    int tag;
+    unsigned batch;
+    unsigned depth;
+    
+    // Inputs and output variables
+    T1 ival1;
+    std::unique_ptr<mpi_batch_multicaster<T1>> buf;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        multicast_tree tree(rank, destinations, rank);
+        buf.reset(new mpi_batch_multicaster<T1>(tree.children, tag, batch, depth));
+    }
+    
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        buf->push(ival1);
+    }
+    
+    void clean()
+    {
+        buf->finish();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for a multicast receiver process with one output
+/*! This class is used to build a processes with one output. It receives
+ * the tokens of a multicast_sender, forwards them to the receivers
+ * below it in the multicast tree and writes them to its output signal.
+ * The source, the destinations and the tag should be the same in all the
+ * receivers of a multicast.
+ *
+ * The batches are forwarded when they are received, hence a receiver
+ * which stops reading also stops the receivers below it.
+ */
+template <typename T0>
+class multicast_receiver : public sdf_process
+{
+public:
+    SDF_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which receives data from the source rank
+     * and writes it to its output port.
+     */
+    multicast_receiver(sc_module_name _name,     ///< process name
+           int source,                 ///< MPI rank of the source process
+           const std::vector<int>& destinations,  ///< MPI ranks of all the destination processes
+           int tag,                    ///< MPI tag of the messages
+           unsigned batch=1,           ///< number of tokens received in each message
+           unsigned depth=2            ///< number of forwarded messages in flight
+         ) : sdf_process(_name), oport1("oport1"), source(source),
+             destinations(destinations), tag(tag), batch(batch), depth(depth)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("source", source);
+        add_arg("fanout", destinations.size());
+        add_arg("tag", tag);
+        add_arg("batch", batch);
+        add_arg("depth", depth);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::multicast_receiver";}
+
+private:
+    int source;
+    std::vector<int> destinations;
+    int tag;
+    unsigned batch;
+    unsigned depth;
+    
+    // Inputs and output variables
+    T0 oval1;
+    std::unique_ptr<mpi_multicast_receiver<T0>> buf;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        int rank = 0;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        multicast_tree tree(source, destinations, rank);
+        buf.reset(new mpi_multicast_receiver<T0>(tree, tag, batch, depth));
+    }
+    
+    void prep()
+    {
+        buf->pop(oval1);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, oval1);
+    }
+    
+    void clean()
+    {
+        buf->finish();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+
+}
+
+namespace DDE
+{
+
+using namespace sc_core;
+
+//! The kinds of the messages exchanged by the DDE sender and receiver
+enum dde_message_kind : char {DDE_NULL_MSG=0, DDE_EVENT_MSG=1};
+
+//! Process constructor for a sender process with one input
+/*! This class is used to build a processes with one input. It transmits
+ * the time-tagged events it receives to a DDE receiver using MPI
+ * messages, as soon as they are available and regardless of their time
+ * tags.
+ *
+ * The ranks are synchronized conservatively using null messages. The
+ * lookahead is the guarantee that every event read by the sender after
+ * the current time t is tagged at t+lookahead or later. Whenever the
+ * input is empty, the sender promises this bound to the receiver using a
+ * null message, and it repeats it at least once per lookahead of
+ * simulated time. The lookahead should be positive.
+ *
+ * Since the null messages keep the simulated time advancing, the
+ * simulation of a rank with a sender should be started with a duration.
+ */
+template <typename T1>
+class sender : public dde_process
+{
+public:
+    DDE_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    sender(sc_module_name _name,     ///< process name
+           int destination,          ///< MPI rank of the destination process
+           int tag,                  ///< MPI tag of the message
+           const sc_time& lookahead  ///< the minimum time tag of the future events
+         ) : dde_process(_name), iport1("iport1"),
+             destination(destination), tag(tag), lookahead(lookahead)
+    {
+        if (lookahead == SC_ZERO_TIME)
+            SC_REPORT_ERROR(name(), "the lookahead of a DDE sender should be positive");
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("destination", destination);
+        add_arg("tag", tag);
+        add_arg("lookahead", lookahead);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::sender";}
+
+private:
+    int destination;
+    int tag;
+    sc_time lookahead;
+    
+    // Inputs and output variables
+    ttn_event<T1> ival1;
+    // The time before which the receiver knows there are no more events
+    sc_time promised;
+    std::vector<char> buf;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        promised = SC_ZERO_TIME;
+    }
+    
+    void prep()
+    {
+        // send null messages while waiting for the next event
+        while (iport1.num_available() == 0)
         {
-            MPI_Test(&request, &flag, &status);
-            if (flag) break; else wait(0,SC_NS);
+            if (model_time() + lookahead > promised)
+            {
+                promised = model_time() + lookahead;
+                send(DDE_NULL_MSG, promised);
+            }
+            // taking the event arms its notification on SPSC signals (see
+            // signal::data_written_event()), so that a write ends the wait
+            wait(lookahead, iport1.data_written_event());
         }
+        ival1 = iport1.read();
     }
     
-    void clean()
+    void exec() {}
+    
+    void prod()
     {
-        delete ival1;
+        send(DDE_EVENT_MSG, get_time(ival1));
+        if (get_time(ival1) > promised) promised = get_time(ival1);
+    }
+    
+    void clean() {}
+    
+    void send(dde_message_kind kind, const sc_time& t)
+    {
+        buf.clear();
+        buf.push_back(kind);
+        serializer<std::uint64_t>::write(buf, t.value());
+        if (kind == DDE_EVENT_MSG)
+            serializer<abst_ext<T1>>::write(buf, get_value(ival1));
+        MPI_Request request;
+        MPI_Status status;
+        MPI_Isend(buf.data(), buf.size(), MPI_BYTE, destination, tag,
+                  MPI_COMM_WORLD, &request);
+#ifdef FORSYDE_TIMELINE
+        timeline_message(true, destination, tag);
+#endif
+        mpi_wait(request, status);
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -279,14 +860,19 @@ private:
 
 //! Process constructor for a receiver process with one output
 /*! This class is used to build a processes with one output.
- * It receives non-absent events via MPI_recv command and writes them to
- * its output signal.
+ * It receives the time-tagged events from a DDE sender via MPI messages
+ * and writes them to its output signal.
+ *
+ * The null messages received from the sender determine a safe horizon
+ * before which no more events arrive. While it waits for an event, the
+ * receiver lets the local simulated time advance up to the horizon and
+ * it only blocks the rank when the current time has reached the horizon.
  */
 template <typename T0>
-class receiver : public sdf_process
+class receiver : public dde_process
 {
 public:
-    SDF_out<T0>  oport1;       ///< port for the output channel
+    DDE_out<T0>  oport1;       ///< port for the output channel
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -296,56 +882,91 @@ public:
     receiver(sc_module_name _name,     ///< process name
            int source,                 ///< MPI rank of the source process
            int tag                     ///< MPI tag of the message
-         ) : sdf_process(_name), oport1("oport1"),
+         ) : dde_process(_name), oport1("oport1"),
              source(source), tag(tag)
     {
 #ifdef FORSYDE_INTROSPECTION
-        arg_vec.push_back(std::make_tuple("source",std::to_string(source)));
-        arg_vec.push_back(std::make_tuple("tag",std::to_string(tag)));
+        add_arg("source", source);
+        add_arg("tag", tag);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
-    std::string forsyde_kind() const {return "SDF::receiver";}
+    std::string forsyde_kind() const {return "DDE::receiver";}
+
+    //! The safe horizon known from the received messages
+    const sc_time& horizon() const {return safe_time;}
 
 private:
     int source;
     int tag;
     
     // Inputs and output variables
-    T0* oval1;
+    ttn_event<T0> oval1;
+    sc_time safe_time;
+    std::vector<char> buf;
     
     //Implementing the abstract semantics
     void init()
     {
-        oval1 = new T0;
+        safe_time = SC_ZERO_TIME;
     }
     
     void prep()
     {
-        T0 temp_val;
-        MPI_Status status;
-        MPI_Request request;
-        MPI_Irecv(&temp_val, sizeof(T0), MPI_BYTE, source, tag, MPI_COMM_WORLD, &request);
-        int flag=0;
         while (true)
         {
-            MPI_Test(&request, &flag, &status);
-            if (flag) break; else wait(0,SC_NS);
+            MPI_Status status;
+            int flag = 0;
+            MPI_Iprobe(source, tag, MPI_COMM_WORLD, &flag, &status);
+            if (!flag)
+            {
+                if (safe_time > model_time())
+                {
+                    // no events can arrive before the horizon
+                    wait(safe_time - model_time());
+                    continue;
+                }
+                mpi_probe(source, tag, status);
+            }
+            if (receive(status)) break;
         }
-        *oval1 = temp_val;
+        if (get_time(oval1) < model_time())
+            SC_REPORT_ERROR(name(), "received an event in the past, the lookahead of the sender is violated");
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *oval1)
+        write_multiport(oport1, oval1);
+        wait(get_time(oval1) - model_time());
     }
     
-    void clean()
+    void clean() {}
+    
+    //! Receives a probed message and returns true if it is an event
+    bool receive(MPI_Status& status)
     {
-        delete oval1;
+        int bytes = 0;
+        MPI_Get_count(&status, MPI_BYTE, &bytes);
+        buf.resize(bytes);
+        MPI_Recv(buf.data(), bytes, MPI_BYTE, source, tag, MPI_COMM_WORLD,
+                 &status);
+#ifdef FORSYDE_TIMELINE
+        timeline_message(false, source, tag);
+#endif
+        const char* pos = buf.data();
+        const char kind = *pos++;
+        std::uint64_t t;
+        serializer<std::uint64_t>::read(pos, t);
+        const sc_time tt = sc_time::from_value(t);
+        if (tt > safe_time) safe_time = tt;
+        if (kind != DDE_EVENT_MSG) return false;
+        abst_ext<T0> val;
+        serializer<abst_ext<T0>>::read(pos, val);
+        oval1 = ttn_event<T0>(std::move(val), tt);
+        return true;
     }
     
 #ifdef FORSYDE_INTROSPECTION
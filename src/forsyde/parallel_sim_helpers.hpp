@@ -20,6 +20,7 @@
  * parallel sub-simulations.
  */
 
+#include <vector>
 #include <mpi.h>
 
 #include "parallel_sim.hpp"
@@ -44,10 +45,13 @@ template <class T0, template <class> class I0If>
 inline sender<T0>* make_sender(const std::string& pName,
     int destination,          ///< MPI rank of the destination process
     int tag,                  ///< MPI tag of the message
-    I0If<T0>& inp1S
+    I0If<T0>& inp1S,
+    unsigned batch=1,         ///< number of events sent in each message
+    unsigned depth=2,         ///< number of messages in flight
+    const transport_compression& comp=transport_compression() ///< compression of the batches
     )
 {
-    auto p = new sender<T0>(pName.c_str(), destination, tag);
+    auto p = new sender<T0>(pName.c_str(), destination, tag, batch, depth, comp);
     
     (*p).iport1(inp1S);
     
@@ -65,10 +69,62 @@ template <class T0, template <class> class OIf>
 inline receiver<T0>* make_receiver(const std::string& pName,
     int source,               ///< MPI rank of the source process
     int tag,                  ///< MPI tag of the message
-    OIf<T0>& outS
+    OIf<T0>& outS,
+    unsigned batch=1,         ///< number of events received in each message
+    unsigned depth=2,         ///< number of messages queued
+    const transport_compression& comp=transport_compression() ///< compression of the batches
     )
 {
-    auto p = new receiver<T0>(pName.c_str(), source, tag);
+    auto p = new receiver<T0>(pName.c_str(), source, tag, batch, depth, comp);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+
+//! Helper function to construct a multicast sender process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class I0If>
+inline multicast_sender<T0>* make_multicast_sender(const std::string& pName,
+    const std::vector<int>& destinations,  ///< MPI ranks of the destination processes
+    int tag,                  ///< MPI tag of the messages
+    I0If<T0>& inp1S,
+    unsigned batch=1,         ///< number of events sent in each message
+    unsigned depth=2          ///< number of messages in flight
+    )
+{
+    auto p = new multicast_sender<T0>(pName.c_str(), destinations, tag, batch, depth);
+    
+    (*p).iport1(inp1S);
+    
+    return p;
+}
+
+//! Helper function to construct a multicast receiver process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf>
+inline multicast_receiver<T0>* make_multicast_receiver(const std::string& pName,
+    int source,               ///< MPI rank of the source process
+    const std::vector<int>& destinations,  ///< MPI ranks of all the destination processes
+    int tag,                  ///< MPI tag of the messages
+    OIf<T0>& outS,
+    unsigned batch=1,         ///< number of events received in each message
+    unsigned depth=2          ///< number of forwarded messages in flight
+    )
+{
+    auto p = new multicast_receiver<T0>(pName.c_str(), source, destinations,
+                                        tag, batch, depth);
     
     (*p).oport1(outS);
     
@@ -94,10 +150,13 @@ template <class T0, template <class> class I0If>
 inline sender<T0>* make_sender(const std::string& pName,
     int destination,          ///< MPI rank of the destination process
     int tag,                  ///< MPI tag of the message
-    I0If<T0>& inp1S
+    I0If<T0>& inp1S,
+    unsigned batch=1,         ///< number of events sent in each message
+    unsigned depth=2,         ///< number of messages in flight
+    const transport_compression& comp=transport_compression() ///< compression of the batches
     )
 {
-    auto p = new sender<T0>(pName.c_str(), destination, tag);
+    auto p = new sender<T0>(pName.c_str(), destination, tag, batch, depth, comp);
     
     (*p).iport1(inp1S);
     
@@ -112,6 +171,109 @@ inline sender<T0>* make_sender(const std::string& pName,
  * C++ and automatic binding to the input and output FIFOs.
  */
 template <class T0, template <class> class OIf>
+inline receiver<T0>* make_receiver(const std::string& pName,
+    int source,               ///< MPI rank of the source process
+    int tag,                  ///< MPI tag of the message
+    OIf<T0>& outS,
+    unsigned batch=1,         ///< number of events received in each message
+    unsigned depth=2,         ///< number of messages queued
+    const transport_compression& comp=transport_compression() ///< compression of the batches
+    )
+{
+    auto p = new receiver<T0>(pName.c_str(), source, tag, batch, depth, comp);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+
+//! Helper function to construct a multicast sender process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class I0If>
+inline multicast_sender<T0>* make_multicast_sender(const std::string& pName,
+    const std::vector<int>& destinations,  ///< MPI ranks of the destination processes
+    int tag,                  ///< MPI tag of the messages
+    I0If<T0>& inp1S,
+    unsigned batch=1,         ///< number of tokens sent in each message
+    unsigned depth=2          ///< number of messages in flight
+    )
+{
+    auto p = new multicast_sender<T0>(pName.c_str(), destinations, tag, batch, depth);
+    
+    (*p).iport1(inp1S);
+    
+    return p;
+}
+
+//! Helper function to construct a multicast receiver process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf>
+inline multicast_receiver<T0>* make_multicast_receiver(const std::string& pName,
+    int source,               ///< MPI rank of the source process
+    const std::vector<int>& destinations,  ///< MPI ranks of all the destination processes
+    int tag,                  ///< MPI tag of the messages
+    OIf<T0>& outS,
+    unsigned batch=1,         ///< number of tokens received in each message
+    unsigned depth=2          ///< number of forwarded messages in flight
+    )
+{
+    auto p = new multicast_receiver<T0>(pName.c_str(), source, destinations,
+                                        tag, batch, depth);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+
+}
+
+namespace DDE
+{
+
+using namespace sc_core;
+
+//! Helper function to construct a sender process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class I0If>
+inline sender<T0>* make_sender(const std::string& pName,
+    int destination,          ///< MPI rank of the destination process
+    int tag,                  ///< MPI tag of the message
+    const sc_time& lookahead, ///< the minimum time tag of the future events
+    I0If<T0>& inp1S
+    )
+{
+    auto p = new sender<T0>(pName.c_str(), destination, tag, lookahead);
+    
+    (*p).iport1(inp1S);
+    
+    return p;
+}
+
+//! Helper function to construct a receiver process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf>
 inline receiver<T0>* make_receiver(const std::string& pName,
     int source,               ///< MPI rank of the source process
     int tag,                  ///< MPI tag of the message
@@ -0,0 +1,757 @@
+/**********************************************************************
+    * partitioner.hpp -- Automatic partitioning of process networks   *
+    *                    on MPI ranks                                 *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Mapping the processes of a model to the ranks of a     *
+    *          parallel simulation and connecting the split signals   *
+    *                                                                 *
+    * Usage:   Define FORSYDE_PARALLEL_SIM to enable it               *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PARTITIONER_HPP
+#define PARTITIONER_HPP
+
+/*! \file partitioner.hpp
+ * \brief Implements the automatic partitioning of process networks
+ *
+ *  This file includes a graph partitioner which reads the process
+ * network exported by XMLExport and the profile written by the
+ * profiler, the placement of the partitions on the ranks according to
+ * the topology of the nodes, and a module which applies the resulting
+ * mapping to the model elaborated on each MPI rank.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <mpi.h>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include "rapidxml.hpp"
+#include "abssemantics.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A balanced k-way min-cut partitioner for process networks
+/*! The vertices of the graph are the leaf and composite processes of the
+ * top level of a process network, as exported by XMLExport::traverse,
+ * and the edges are its signals. The weight of a vertex is the number of
+ * firings of its processes in a profile written by the profiler, or one
+ * if it is not profiled. The weight of an edge approximates the number
+ * of tokens passing through it by the smaller weight of its ends.
+ *
+ * The edges at the ends of the SY delay processes are discounted, so
+ * that the cuts are preferably placed next to the delays. The ranks on
+ * the two sides of such a cut do not need to run in lockstep, and the
+ * upstream rank can run ahead by the depth of the transport.
+ *
+ * The partitions are grown greedily from the vertices in the order of
+ * the XML file and refined by moving single vertices, or swapping pairs
+ * of them, while the cut weight decreases and the balance constraint
+ * holds. The result only
+ * depends on the inputs, hence all the ranks compute the same mapping.
+ */
+class partitioner
+{
+public:
+    //! The constructor loads the process network from an XML file
+    explicit partitioner(const std::string& xml_file)
+    {
+        std::ifstream ifs(xml_file);
+        if (!ifs.is_open())
+        {
+            SC_REPORT_ERROR(xml_file.c_str(), "file could not be opened to read the process network");
+            return;
+        }
+        std::vector<char> text((std::istreambuf_iterator<char>(ifs)),
+                               std::istreambuf_iterator<char>());
+        text.push_back('\0');
+        rapidxml::xml_document<> doc;
+        doc.parse<0>(text.data());
+        rapidxml::xml_node<>* pn = doc.first_node("process_network");
+        if (pn == NULL)
+        {
+            SC_REPORT_ERROR(xml_file.c_str(), "no process network found");
+            return;
+        }
+        for (auto n=pn->first_node(); n; n=n->next_sibling())
+        {
+            const std::string tag = n->name();
+            if (tag != "leaf_process" && tag != "composite_process") continue;
+            auto attr = n->first_attribute("name");
+            if (attr == NULL || index.count(attr->value())) continue;
+            index[attr->value()] = names.size();
+            names.push_back(attr->value());
+            weights.push_back(1);
+            delays.push_back(is_sy_delay(n));
+        }
+        for (auto n=pn->first_node("signal"); n; n=n->next_sibling("signal"))
+        {
+            auto src = n->first_attribute("source");
+            auto dst = n->first_attribute("target");
+            if (src == NULL || dst == NULL) continue;
+            auto s = index.find(src->value());
+            auto d = index.find(dst->value());
+            // signals connected to the ports of the network itself
+            if (s == index.end() || d == index.end()) continue;
+            edges.push_back(edge{s->second, d->second});
+        }
+    }
+
+    //! Loads the weights of the processes from a profile
+    /*! The profile is a CSV file written by the profiler. The firings of
+     * all the processes below a vertex are added up, where the name of a
+     * vertex in the profile is the given prefix (i.e., the name of the
+     * top module) followed by its name.
+     */
+    void load_profile(const std::string& csv_file, const std::string& prefix)
+    {
+        std::ifstream ifs(csv_file);
+        if (!ifs.is_open())
+        {
+            SC_REPORT_ERROR(csv_file.c_str(), "file could not be opened to read the profile");
+            return;
+        }
+        std::vector<double> sums(names.size(), 0);
+        std::string line;
+        std::getline(ifs, line);    // the header
+        while (std::getline(ifs, line))
+        {
+            std::stringstream ss(line);
+            std::string name, kind, firings;
+            if (!std::getline(ss, name, ',') || !std::getline(ss, kind, ',') ||
+                !std::getline(ss, firings, ','))
+                continue;
+            if (name.compare(0, prefix.size()+1, prefix + ".") != 0) continue;
+            std::string rest = name.substr(prefix.size()+1);
+            auto it = index.find(rest.substr(0, rest.find('.')));
+            if (it == index.end()) continue;
+            sums[it->second] += std::stod(firings);
+        }
+        for (size_t i=0; i<names.size(); i++)
+            if (sums[i] > 0) weights[i] = sums[i];
+    }
+
+#ifdef FORSYDE_PROFILE_DB
+    //! Loads the weights of the processes from the profile database
+    /*! The weight of a vertex is the exec time in a run of all the
+     * processes below it, as stored in the database (see profile_db),
+     * where the name of a vertex in the database is the given prefix
+     * followed by its name. The vertices without profiled processes keep
+     * their weights.
+     */
+    void load_profile_db(const std::string& prefix)
+    {
+        std::vector<double> sums(names.size(), 0);
+        for (auto& e : profile_db::get().processes())
+        {
+            if (e.first.compare(0, prefix.size()+1, prefix + ".") != 0) continue;
+            std::string rest = e.first.substr(prefix.size()+1);
+            auto it = index.find(rest.substr(0, rest.find('.')));
+            if (it != index.end()) sums[it->second] += e.second.exec_time;
+        }
+        for (size_t i=0; i<names.size(); i++)
+            if (sums[i] > 0) weights[i] = sums[i];
+    }
+#endif
+
+    //! Sets the weight of a vertex explicitly
+    void set_weight(const std::string& proc, double w)
+    {
+        auto it = index.find(proc);
+        if (it == index.end())
+            SC_REPORT_ERROR(proc.c_str(), "no such process in the process network");
+        else
+            weights[it->second] = w;
+    }
+
+    //! Sets the factor applied to the weight of the edges next to the delays
+    /*! A factor of one disables the preference for cutting at delays.
+     */
+    void set_delay_discount(double factor) {delay_discount = factor;}
+
+    //! The names of the vertices in the order of the XML file
+    const std::vector<std::string>& processes() const {return names;}
+
+    //! Computes a mapping of the vertices to k partitions
+    /*! The weight of each partition is kept below (1+imbalance) times the
+     * average, unless a single vertex is heavier than that.
+     */
+    std::map<std::string,int> partition(unsigned k, double imbalance=0.05) const
+    {
+        std::map<std::string,int> res;
+        if (k == 0 || names.empty()) return res;
+        const size_t n = names.size();
+        auto adj = adjacency();
+        double total = 0;
+        for (auto w : weights) total += w;
+        const double target = total / k;
+        const double maxw = target * (1 + imbalance);
+        std::vector<int> part(n, -1);
+        std::vector<double> load(k, 0);
+        std::vector<size_t> count(k, 0);
+        auto assign = [&](size_t v, int p)
+        {
+            if (part[v] >= 0) {load[part[v]] -= weights[v]; count[part[v]]--;}
+            part[v] = p;
+            load[p] += weights[v];
+            count[p]++;
+        };
+        // grow the first k-1 partitions greedily
+        for (unsigned p=0; p+1<k; p++)
+        {
+            while (load[p] < target)
+            {
+                // the unassigned vertex with the strongest connection to p
+                size_t best = n;
+                double best_conn = -1;
+                for (size_t v=0; v<n; v++)
+                {
+                    if (part[v] >= 0) continue;
+                    double conn = 0;
+                    for (auto& e : adj[v]) if (part[e.first] == (int)p) conn += e.second;
+                    if (conn > best_conn) {best = v; best_conn = conn;}
+                }
+                if (best == n) break;
+                if (count[p] > 0 && load[p] + weights[best] > maxw) break;
+                assign(best, p);
+            }
+        }
+        for (size_t v=0; v<n; v++)
+            if (part[v] < 0) assign(v, k-1);
+        // weight of the edges between a vertex and a partition
+        auto conn_to = [&](size_t v, int p)
+        {
+            double conn = 0;
+            for (auto& e : adj[v]) if (part[e.first] == p) conn += e.second;
+            return conn;
+        };
+        // refine by moving single vertices and, when no move improves the
+        // cut, by swapping pairs of vertices between two partitions
+        for (int pass=0; pass<16; pass++)
+        {
+            bool moved = false;
+            for (size_t v=0; v<n; v++)
+            {
+                const int own = part[v];
+                if (count[own] == 1) continue;
+                std::vector<double> conn(k, 0);
+                for (auto& e : adj[v]) conn[part[e.first]] += e.second;
+                int best = own;
+                double best_gain = 0;
+                for (unsigned q=0; q<k; q++)
+                {
+                    if ((int)q == own) continue;
+                    const double gain = conn[q] - conn[own];
+                    const bool fits = load[q] + weights[v] <= maxw;
+                    // moves which balance an overloaded partition
+                    const bool relieves = load[own] > maxw && load[q] + weights[v] < load[own];
+                    if ((gain > best_gain && fits) || (gain >= best_gain && best == own && relieves && gain >= 0))
+                    {
+                        best = q;
+                        best_gain = gain;
+                    }
+                }
+                if (best != own)
+                {
+                    assign(v, best);
+                    moved = true;
+                }
+            }
+            if (moved) continue;
+            double best_gain = 0;
+            size_t bu = n, bv = n;
+            for (size_t u=0; u<n; u++)
+                for (size_t v=u+1; v<n; v++)
+                {
+                    const int pu = part[u], pv = part[v];
+                    if (pu == pv) continue;
+                    if (load[pv] - weights[v] + weights[u] > maxw ||
+                        load[pu] - weights[u] + weights[v] > maxw) continue;
+                    double w_uv = 0;
+                    for (auto& e : adj[u]) if (e.first == v) w_uv += e.second;
+                    const double gain = conn_to(u, pv) - conn_to(u, pu) +
+                                        conn_to(v, pu) - conn_to(v, pv) - 2*w_uv;
+                    if (gain > best_gain) {best_gain = gain; bu = u; bv = v;}
+                }
+            if (bu == n) break;
+            const int pu = part[bu];
+            assign(bu, part[bv]);
+            assign(bv, pu);
+        }
+        for (size_t v=0; v<n; v++) res[names[v]] = part[v];
+        return res;
+    }
+
+    //! The total weight of the edges cut by a mapping
+    double cut_weight(const std::map<std::string,int>& mapping) const
+    {
+        double cut = 0;
+        for (auto& e : edges)
+            if (mapping.at(names[e.src]) != mapping.at(names[e.dst]))
+                cut += edge_weight(e);
+        return cut;
+    }
+
+    //! The weight of the edges between each pair of the k partitions
+    /*! It estimates the traffic between the partitions of a mapping, as
+     * used by place_partitions().
+     */
+    std::vector<std::vector<double>> traffic(const std::map<std::string,int>& mapping,
+                                             unsigned k) const
+    {
+        std::vector<std::vector<double>> res(k, std::vector<double>(k, 0));
+        for (auto& e : edges)
+        {
+            const int ps = mapping.at(names[e.src]), pd = mapping.at(names[e.dst]);
+            if (ps == pd) continue;
+            res[ps][pd] += edge_weight(e);
+            res[pd][ps] += edge_weight(e);
+        }
+        return res;
+    }
+
+private:
+    struct edge
+    {
+        size_t src, dst;
+    };
+
+    std::vector<std::string> names;
+    std::map<std::string,size_t> index;
+    std::vector<double> weights;
+    std::vector<bool> delays;
+    std::vector<edge> edges;
+    double delay_discount = 0.25;
+
+    //! Checks if a process node is an SY delay element
+    static bool is_sy_delay(rapidxml::xml_node<>* n)
+    {
+        auto pc = n->first_node("process_constructor");
+        if (pc == NULL) return false;
+        auto moc = pc->first_attribute("moc");
+        auto pcn = pc->first_attribute("name");
+        if (moc == NULL || pcn == NULL || std::string(moc->value()) != "sy")
+            return false;
+        const std::string k = pcn->value();
+        return k == "delay" || k == "delayn" || k == "sdelay" || k == "sdelayn";
+    }
+
+    double edge_weight(const edge& e) const
+    {
+        const double w = std::min(weights[e.src], weights[e.dst]);
+        return delays[e.src] || delays[e.dst] ? w * delay_discount : w;
+    }
+
+    //! The undirected weighted adjacency lists, without self loops
+    std::vector<std::vector<std::pair<size_t,double>>> adjacency() const
+    {
+        std::vector<std::vector<std::pair<size_t,double>>> adj(names.size());
+        for (auto& e : edges)
+        {
+            if (e.src == e.dst) continue;
+            adj[e.src].push_back(std::make_pair(e.dst, edge_weight(e)));
+            adj[e.dst].push_back(std::make_pair(e.src, edge_weight(e)));
+        }
+        return adj;
+    }
+};
+
+//! The placement of the MPI ranks on the nodes, sockets and cores
+/*! The topology is discovered collectively over MPI_COMM_WORLD: the ranks
+ * with the same processor name share a node, and the ranks of a node
+ * divide the cores they are allowed to run on into equal blocks, ordered
+ * by the sockets (physical packages) of the cores, in the order of their
+ * ranks. Hence the consecutive ranks of a node share a socket. On the
+ * systems without the Linux topology information, a node is assumed to
+ * have a single socket.
+ */
+class rank_topology
+{
+public:
+    std::vector<int> nodes;             ///< The node of each rank
+    std::vector<int> sockets;           ///< The socket of each rank in its node
+    std::vector<int> cores;             ///< The cores of this rank
+
+    //! The cost of a unit of traffic between ranks on the same socket
+    double socket_cost = 1;
+    //! The cost of a unit of traffic between sockets of the same node
+    double node_cost = 2;
+    //! The cost of a unit of traffic between nodes
+    double network_cost = 8;
+
+    //! Discovers the topology, all the ranks should call it
+    static rank_topology discover()
+    {
+        rank_topology t;
+        int rank = 0, size = 1;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+        // the nodes by their processor names, in the order of the ranks
+        std::vector<char> host(MPI_MAX_PROCESSOR_NAME, 0);
+        std::vector<char> hosts(host.size() * size);
+        int len = 0;
+        MPI_Get_processor_name(host.data(), &len);
+        MPI_Allgather(host.data(), host.size(), MPI_CHAR, hosts.data(),
+                      host.size(), MPI_CHAR, MPI_COMM_WORLD);
+        std::map<std::string,int> ids;
+        std::vector<int> local(size), count;
+        for (int r=0; r<size; r++)
+        {
+            const std::string h(hosts.data() + r*host.size());
+            auto it = ids.insert(std::make_pair(h, (int)ids.size())).first;
+            t.nodes.push_back(it->second);
+            if ((int)count.size() <= it->second) count.push_back(0);
+            local[r] = count[it->second]++;
+        }
+        // the block of cores of this rank
+        std::vector<std::pair<int,int>> cpus = available_cpus();
+        std::sort(cpus.begin(), cpus.end());
+        const int n = count[t.nodes[rank]];
+        const size_t block = std::max<size_t>(1, cpus.size() / n);
+        int socket = 0;
+        for (size_t i=0; i<block && !cpus.empty(); i++)
+        {
+            auto& c = cpus[(local[rank]*block + i) % cpus.size()];
+            if (i == 0) socket = c.first;
+            t.cores.push_back(c.second);
+        }
+        t.sockets.resize(size);
+        MPI_Allgather(&socket, 1, MPI_INT, t.sockets.data(), 1, MPI_INT,
+                      MPI_COMM_WORLD);
+        return t;
+    }
+
+    //! The cost of a unit of traffic between two ranks
+    double distance(int a, int b) const
+    {
+        if (a == b) return 0;
+        if (nodes[a] != nodes[b]) return network_cost;
+        return sockets[a] == sockets[b] ? socket_cost : node_cost;
+    }
+
+    //! Restricts this rank, and the threads it starts later, to its cores
+    /*! It returns false if the affinity could not be set.
+     */
+    bool pin() const
+    {
+#ifdef __linux__
+        if (cores.empty()) return false;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (auto c : cores) CPU_SET(c, &set);
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+private:
+    //! The (socket, core) pairs of the cores this rank may run on
+    static std::vector<std::pair<int,int>> available_cpus()
+    {
+        std::vector<std::pair<int,int>> res;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) != 0) return res;
+        for (int c=0; c<CPU_SETSIZE; c++)
+        {
+            if (!CPU_ISSET(c, &set)) continue;
+            int socket = 0;
+            std::ifstream ifs("/sys/devices/system/cpu/cpu" + std::to_string(c) +
+                              "/topology/physical_package_id");
+            if (ifs.is_open()) ifs >> socket;
+            res.push_back(std::make_pair(socket, c));
+        }
+#endif
+        return res;
+    }
+};
+
+//! Assigns the partitions to the ranks according to their traffic
+/*! It returns the rank of each partition, such that the traffic between
+ * the partitions weighted by the distance between their ranks is small,
+ * i.e., the heavy edges stay inside the sockets and the nodes. The
+ * partitions are placed greedily in the order of their total traffic,
+ * each one on the free rank closest to the placed ones, and the result is
+ * refined by swapping pairs of partitions while the cost decreases. The
+ * result only depends on the inputs, hence all the ranks compute the same
+ * placement.
+ */
+inline std::vector<int> place_partitions(const std::vector<std::vector<double>>& traffic,
+                                         const rank_topology& topo)
+{
+    const size_t k = traffic.size();
+    std::vector<int> rank_of(k, -1);
+    if (k == 0) return rank_of;
+    if (k > topo.nodes.size())
+    {
+        SC_REPORT_ERROR("place_partitions", "there are more partitions than ranks");
+        return rank_of;
+    }
+    std::vector<double> total(k, 0);
+    for (size_t p=0; p<k; p++)
+        for (size_t q=0; q<k; q++) total[p] += traffic[p][q];
+    std::vector<size_t> order(k);
+    for (size_t p=0; p<k; p++) order[p] = p;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b){return total[a] > total[b];});
+    // the cost of a partition on a rank against the placed ones
+    auto cost = [&](size_t p, int r)
+    {
+        double c = 0;
+        for (size_t q=0; q<k; q++)
+            if (q != p && rank_of[q] >= 0) c += traffic[p][q] * topo.distance(r, rank_of[q]);
+        return c;
+    };
+    std::vector<bool> used(topo.nodes.size(), false);
+    for (auto p : order)
+    {
+        int best = -1;
+        double best_cost = 0;
+        for (int r=0; r<(int)used.size(); r++)
+        {
+            if (used[r]) continue;
+            const double c = cost(p, r);
+            if (best < 0 || c < best_cost) {best = r; best_cost = c;}
+        }
+        rank_of[p] = best;
+        used[best] = true;
+    }
+    for (int pass=0; pass<16; pass++)
+    {
+        bool swapped = false;
+        for (size_t p=0; p<k; p++)
+            for (size_t q=p+1; q<k; q++)
+            {
+                const int rp = rank_of[p], rq = rank_of[q];
+                const double before = cost(p, rp) + cost(q, rq);
+                std::swap(rank_of[p], rank_of[q]);
+                if (cost(p, rq) + cost(q, rp) + 1e-12 < before)
+                    swapped = true;
+                else
+                    std::swap(rank_of[p], rank_of[q]);
+            }
+        if (!swapped) break;
+    }
+    return rank_of;
+}
+
+//! Applies a mapping of processes to MPI ranks on the elaborated model
+/*! Every rank elaborates the complete model and this module keeps only
+ * the processes mapped to the current rank. The processes below the
+ * children of the root module which are mapped to other ranks never
+ * start, and the signals between the processes of different ranks are
+ * forwarded using MPI, without any explicit sender and receiver. The
+ * tags of the messages are assigned to the split signals in the order of
+ * their names, starting from base_tag.
+ *
+ * The root should be the module exported to the XML file which was used
+ * to compute the mapping.
+ */
+class partition : public sc_module
+{
+public:
+    //! The constructor requires the module name, the root and the mapping
+    partition(sc_module_name _name,     ///< The module name
+              sc_module* root,          ///< The root of the partitioned model
+              const std::map<std::string,int>& mapping, ///< The rank of the children of the root
+              int rank,                 ///< The rank of this sub-simulation
+              unsigned batch=1,         ///< Number of tokens sent in each message
+              unsigned depth=2,         ///< Number of messages in flight per signal
+              int base_tag=0            ///< The tag of the first split signal
+              ) : sc_module(_name), root(root), mapping(mapping), rank(rank),
+                  batch(batch), depth(depth), base_tag(base_tag)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! The number of signals forwarded from or to this rank
+    size_t forwarded_signals() const {return outs.size() + ins.size();}
+
+    //! The partition is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_partition";}
+
+private:
+    SC_HAS_PROCESS(partition);
+
+    sc_module* root;
+    std::map<std::string,int> mapping;
+    int rank;
+    unsigned batch;
+    unsigned depth;
+    int base_tag;
+
+    //! A split signal and the peer rank and tag used for forwarding it
+    struct forward
+    {
+        remote_channel* chan;
+        int peer, tag;
+    };
+    std::vector<forward> outs, ins;
+
+    //! Collects the leaf processes below an object recursively
+    static void collect(sc_object* obj, std::vector<process*>& procs)
+    {
+        process* p = dynamic_cast<process*>(obj);
+        if (p != NULL)
+        {
+            procs.push_back(p);
+            return;
+        }
+        std::vector<sc_object*> children = obj->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+            if (dynamic_cast<sc_module*>(*it) != NULL) collect(*it, procs);
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        std::vector<sc_object*> children = p->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+            if ((*it)->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(*it);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! Disables the processes of the other ranks and finds the split signals
+    void end_of_elaboration()
+    {
+        // the ranks of the writer and the reader of each channel
+        std::map<sc_interface*, std::pair<int,int>> ends;
+        std::vector<sc_object*> children = root->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+        {
+            if ((*it)->kind() != std::string("sc_module")) continue;
+            auto m = mapping.find((*it)->basename());
+            if (m == mapping.end())
+            {
+                SC_REPORT_ERROR(name(), (std::string("no rank is given for ") + (*it)->name()).c_str());
+                continue;
+            }
+            std::vector<process*> procs;
+            collect(*it, procs);
+            for (auto p : procs)
+            {
+                if (m->second != rank) p->set_ext_driven();
+                for (auto c : channels(p, "sc_fifo_out"))
+                    ends.insert(std::make_pair(c, std::make_pair(-1,-1))).first->second.first = m->second;
+                for (auto c : channels(p, "sc_fifo_in"))
+                    ends.insert(std::make_pair(c, std::make_pair(-1,-1))).first->second.second = m->second;
+            }
+        }
+        // the split signals sorted by their names
+        std::map<std::string, std::pair<sc_interface*, std::pair<int,int>>> split;
+        for (auto& e : ends)
+        {
+            const int w = e.second.first, r = e.second.second;
+            if (w < 0 || r < 0 || w == r) continue;
+            sc_object* obj = dynamic_cast<sc_object*>(e.first);
+            if (obj == NULL) continue;
+            split[obj->name()] = e;
+        }
+        int tag = base_tag;
+        for (auto& s : split)
+        {
+            const int w = s.second.second.first, r = s.second.second.second;
+            if (w == rank || r == rank)
+            {
+                remote_channel* ch = dynamic_cast<remote_channel*>(s.second.first);
+                if (ch == NULL)
+                    SC_REPORT_ERROR(name(), ("only ForSyDe signals can be split between ranks: " + s.first).c_str());
+                else if (w == rank)
+                    outs.push_back(forward{ch, r, tag});
+                else
+                    ins.push_back(forward{ch, w, tag});
+            }
+            tag++;
+        }
+    }
+
+    //! Starts a thread for forwarding each split signal
+    void worker()
+    {
+        for (auto& f : outs)
+        {
+            forward fw = f;
+            unsigned b = batch, d = depth;
+            sc_spawn([fw,b,d]{fw.chan->forward_to(fw.peer, fw.tag, b, d);});
+        }
+        for (auto& f : ins)
+        {
+            forward fw = f;
+            unsigned b = batch, d = depth;
+            sc_spawn([fw,b,d]{fw.chan->forward_from(fw.peer, fw.tag, b, d);});
+        }
+    }
+
+    //! Flushes the forwarded signals
+    void end_of_simulation()
+    {
+        for (auto& f : outs) f.chan->finish_forwarding();
+        for (auto& f : ins) f.chan->finish_forwarding();
+    }
+};
+
+//! Helper function to partition a model on the ranks of MPI_COMM_WORLD
+/*! It reads the process network of the root module from an XML file
+ * written by XMLExport and, optionally, the firing counts from a profile
+ * written by the profiler. It then maps the children of the root to the
+ * ranks and constructs the partition module of the current rank.
+ * MPI should be initialized before calling it.
+ *
+ * If it is topology aware, all the ranks should call it. The partitions
+ * are then placed on the ranks so that the heavy edges stay inside the
+ * sockets and the nodes (see place_partitions), and the rank is pinned
+ * to its cores.
+ */
+inline partition* make_partition(const std::string& pName,  ///< the module name
+    sc_module* root,                     ///< the root of the model
+    const std::string& xml_file,         ///< the exported process network of the root
+    const std::string& profile_file="",  ///< the profile of a previous simulation
+    double imbalance=0.05,               ///< the allowed load imbalance
+    unsigned batch=1,                    ///< number of tokens sent in each message
+    unsigned depth=2,                    ///< number of messages in flight per signal
+    bool topology_aware=false            ///< place the partitions on the nodes and pin the ranks
+    )
+{
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    partitioner pt(xml_file);
+    if (!profile_file.empty()) pt.load_profile(profile_file, root->name());
+    auto mapping = pt.partition(size, imbalance);
+    if (topology_aware)
+    {
+        const rank_topology topo = rank_topology::discover();
+        const std::vector<int> rank_of = place_partitions(pt.traffic(mapping, size), topo);
+        for (auto& m : mapping) m.second = rank_of[m.second];
+        if (!topo.pin())
+            SC_REPORT_WARNING(pName.c_str(), "the rank could not be pinned to its cores");
+    }
+    return new partition(pName.c_str(), root, mapping, rank, batch, depth);
+}
+
+}
+
+#endif
@@ -0,0 +1,261 @@
+/**********************************************************************
+    * payload_codec.hpp -- Compression of the batches of tokens       *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Reducing the size of the messages exchanged between    *
+    *          the ranks over the links with limited bandwidth        *
+    *                                                                 *
+    * Usage:   Included by the parallel simulation primitives         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PAYLOAD_CODEC_HPP
+#define PAYLOAD_CODEC_HPP
+
+/*! \file payload_codec.hpp
+ * \brief Implements the compression of the batches of serialized tokens
+ *
+ *  The senders and receivers of the parallel simulation can compress
+ * their batches (see transport_compression). Two codecs are built in:
+ * a run-length code, which suits the SY streams with many absent events
+ * (each of which is a zero flag byte), and an XOR-delta code for the
+ * streams of floating-point samples, which XORs each sample with the
+ * previous one and drops the zero bytes, i.e., the sign, exponent and
+ * leading mantissa bits which the samples of a smooth signal share.
+ * LZ4 and Zstandard are available for generic payloads when
+ * FORSYDE_LZ4 and FORSYDE_ZSTD are defined (linking with -llz4 and
+ * -lzstd).
+ */
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#ifdef FORSYDE_LZ4
+#include <lz4.h>
+#endif
+#ifdef FORSYDE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace ForSyDe
+{
+
+//! The codecs of the batches of tokens
+enum payload_codec
+{
+    CODEC_NONE,         ///< the serialized tokens as they are
+    CODEC_RLE,          ///< runs of equal bytes, e.g., absent events
+    CODEC_XOR_DELTA,    ///< differences of consecutive samples without their zero bytes
+    CODEC_LZ4,          ///< LZ4 (requires FORSYDE_LZ4)
+    CODEC_ZSTD          ///< Zstandard (requires FORSYDE_ZSTD)
+};
+
+//! The compression of the batches of a sender and receiver pair
+/*! Both ends of a channel should use the same settings. The batches
+ * smaller than the threshold, and the ones which the codec does not
+ * shrink, are sent as they are, so that the cost of compressing is only
+ * paid where the link is the bottleneck.
+ */
+struct transport_compression
+{
+    payload_codec codec;    ///< the codec of the large batches
+    size_t threshold;       ///< the smallest batch in bytes which is compressed
+    unsigned word;          ///< the size of a sample for XOR_DELTA (0 for the token size)
+    int level;              ///< the level of ZSTD
+
+    transport_compression(payload_codec codec=CODEC_NONE, size_t threshold=4096,
+                          unsigned word=0, int level=1)
+        : codec(codec), threshold(threshold), word(word), level(level) {}
+
+    //! Checks if the batches carry the codec header
+    bool enabled() const {return codec != CODEC_NONE;}
+};
+
+//! The size of the header of a compressed batch (the codec and the original size)
+const size_t payload_header = 1 + sizeof(std::uint32_t);
+
+//! Appends the run-length code of a byte array to a buffer
+/*! A control byte c below 128 is followed by c+1 literal bytes, and one
+ * from 128 up by a byte repeated c-125 times.
+ */
+inline void rle_encode(const char* in, size_t n, std::vector<char>& out)
+{
+    size_t i = 0;
+    while (i < n)
+    {
+        size_t r = 1;
+        while (i+r < n && r < 130 && in[i+r] == in[i]) r++;
+        if (r >= 3)
+        {
+            out.push_back(char(r + 125));
+            out.push_back(in[i]);
+            i += r;
+            continue;
+        }
+        // the literals up to the next run
+        size_t j = i;
+        while (j < n && j-i < 128 &&
+               !(j+2 < n && in[j] == in[j+1] && in[j] == in[j+2]))
+            j++;
+        out.push_back(char(j - i - 1));
+        out.insert(out.end(), in+i, in+j);
+        i = j;
+    }
+}
+
+//! Decodes a run-length code into n bytes, returning false if it is malformed
+inline bool rle_decode(const char* in, size_t len, char* out, size_t n)
+{
+    const char* end = in + len;
+    size_t o = 0;
+    while (in < end)
+    {
+        const unsigned c = (unsigned char)*in++;
+        if (c < 128)
+        {
+            if (size_t(end - in) < c+1 || o + c+1 > n) return false;
+            std::memcpy(out+o, in, c+1);
+            in += c+1;
+            o += c+1;
+        }
+        else
+        {
+            if (in == end || o + c-125 > n) return false;
+            std::memset(out+o, *in++, c-125);
+            o += c-125;
+        }
+    }
+    return o == n;
+}
+
+//! Appends the XOR-delta code of a byte array of samples of word bytes
+/*! Each byte is XORed with the one of the previous sample, and the
+ * result is stored in groups of eight bytes as a mask of the non-zero
+ * bytes followed by them.
+ */
+inline void xor_delta_encode(const char* in, size_t n, size_t word, std::vector<char>& out)
+{
+    for (size_t g=0; g<n; g+=8)
+    {
+        const size_t mpos = out.size();
+        out.push_back(0);
+        unsigned char mask = 0;
+        for (size_t i=g; i<g+8 && i<n; i++)
+        {
+            const char d = i >= word ? char(in[i] ^ in[i-word]) : in[i];
+            if (d == 0) continue;
+            mask |= 1 << (i-g);
+            out.push_back(d);
+        }
+        out[mpos] = char(mask);
+    }
+}
+
+//! Decodes an XOR-delta code into n bytes, returning false if it is malformed
+inline bool xor_delta_decode(const char* in, size_t len, size_t word, char* out, size_t n)
+{
+    const char* end = in + len;
+    for (size_t g=0; g<n; g+=8)
+    {
+        if (in == end) return false;
+        const unsigned char mask = *in++;
+        for (size_t i=g; i<g+8 && i<n; i++)
+        {
+            char d = 0;
+            if (mask & (1 << (i-g)))
+            {
+                if (in == end) return false;
+                d = *in++;
+            }
+            out[i] = i >= word ? char(d ^ out[i-word]) : d;
+        }
+    }
+    return in == end;
+}
+
+//! Compresses a batch into a message with the header
+/*! It returns false, leaving the message in an unspecified state, if the
+ * batch should rather be sent as it is.
+ */
+inline bool encode_payload(const transport_compression& comp, size_t word,
+                           const char* raw, size_t n, std::vector<char>& msg)
+{
+    if (!comp.enabled() || n < comp.threshold || n > UINT32_MAX) return false;
+    msg.resize(payload_header);
+    msg[0] = char(comp.codec);
+    const std::uint32_t len = n;
+    std::memcpy(msg.data()+1, &len, sizeof(len));
+    switch (comp.codec)
+    {
+    case CODEC_RLE:
+        rle_encode(raw, n, msg);
+        break;
+    case CODEC_XOR_DELTA:
+        xor_delta_encode(raw, n, word ? word : 8, msg);
+        break;
+#ifdef FORSYDE_LZ4
+    case CODEC_LZ4:
+    {
+        msg.resize(payload_header + LZ4_compressBound(n));
+        const int res = LZ4_compress_default(raw, msg.data()+payload_header, n,
+                                             msg.size()-payload_header);
+        if (res <= 0) return false;
+        msg.resize(payload_header + res);
+        break;
+    }
+#endif
+#ifdef FORSYDE_ZSTD
+    case CODEC_ZSTD:
+    {
+        msg.resize(payload_header + ZSTD_compressBound(n));
+        const size_t res = ZSTD_compress(msg.data()+payload_header, msg.size()-payload_header,
+                                         raw, n, comp.level);
+        if (ZSTD_isError(res)) return false;
+        msg.resize(payload_header + res);
+        break;
+    }
+#endif
+    default:
+        return false;
+    }
+    // the raw batch costs one header byte
+    return msg.size() < n + 1;
+}
+
+//! Decompresses a message with the header of a compressed batch
+/*! It returns false if the message is malformed or its codec is not
+ * available.
+ */
+inline bool decode_payload(size_t word, const char* msg, size_t len, std::vector<char>& raw)
+{
+    if (len < payload_header) return false;
+    std::uint32_t n;
+    std::memcpy(&n, msg+1, sizeof(n));
+    raw.resize(n);
+    const char* in = msg + payload_header;
+    const size_t inlen = len - payload_header;
+    switch (payload_codec(msg[0]))
+    {
+    case CODEC_RLE:
+        return rle_decode(in, inlen, raw.data(), n);
+    case CODEC_XOR_DELTA:
+        return xor_delta_decode(in, inlen, word ? word : 8, raw.data(), n);
+#ifdef FORSYDE_LZ4
+    case CODEC_LZ4:
+        return LZ4_decompress_safe(in, raw.data(), inlen, n) == int(n);
+#endif
+#ifdef FORSYDE_ZSTD
+    case CODEC_ZSTD:
+        return ZSTD_decompress(raw.data(), n, in, inlen) == n;
+#endif
+    default:
+        return false;
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,179 @@
+/**********************************************************************
+    * perf_counters.hpp -- Hardware performance counters of processes *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Reading the hardware performance counters around the   *
+    *          execution stage of the processes                       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_PROFILE and FORSYDE_PERF_COUNTERS to    *
+    *          enable it (Linux only)                                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+/*! \file perf_counters.hpp
+ * \brief Implements the hardware performance counters of the processes
+ *
+ *  This file includes the counters which are read around the exec stage
+ * of the processes when FORSYDE_PERF_COUNTERS is defined, so that the
+ * cycles, instructions, cache misses and branch misses of the process
+ * functions are separated from the ones of the simulation kernel. They
+ * are accumulated in the profiling record of each process and written
+ * by the profiler together with the firing counts.
+ *
+ *  The counters are opened with perf_event_open for the user-space code
+ * of each thread, once per thread, since the processes may be fired by
+ * the threads of parallel executors. Reading them takes a system call,
+ * hence only one in FORSYDE_PERF_SAMPLE firings of a process is measured.
+ * If the counters can not be opened (e.g., due to
+ * /proc/sys/kernel/perf_event_paranoid) a warning is reported and they
+ * stay zero.
+ */
+
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+#endif
+
+//! Only one in FORSYDE_PERF_SAMPLE firings of a process is measured
+#ifndef FORSYDE_PERF_SAMPLE
+#define FORSYDE_PERF_SAMPLE 1
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The totals of the hardware counters of a process
+struct perf_totals
+{
+    unsigned long long samples = 0;         ///< the measured firings
+    unsigned long long cycles = 0;          ///< CPU cycles
+    unsigned long long instructions = 0;    ///< retired instructions
+    unsigned long long cache_misses = 0;    ///< last-level cache misses
+    unsigned long long branch_misses = 0;   ///< mispredicted branches
+
+    //! Instructions per cycle, zero if nothing is measured
+    double ipc() const {return cycles ? double(instructions)/cycles : 0;}
+};
+
+//! The group of counters of the calling thread
+class perf_group
+{
+public:
+    //! The number of counters in the group
+    static constexpr int N = 4;
+
+    //! Returns the group of the calling thread, opening it on the first call
+    static perf_group& get()
+    {
+        thread_local perf_group g;
+        return g;
+    }
+
+    //! Checks if the counters are open
+    bool valid() const {return fds[0] >= 0;}
+
+    //! Reads the current values of the counters
+    bool read(std::uint64_t (&vals)[N]) const
+    {
+#ifdef __linux__
+        struct {std::uint64_t nr; std::uint64_t v[N];} buf;
+        if (::read(fds[0], &buf, sizeof(buf)) != (ssize_t)sizeof(buf)) return false;
+        std::memcpy(vals, buf.v, sizeof(vals));
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    ~perf_group()
+    {
+#ifdef __linux__
+        for (int i=N-1; i>=0; i--)
+            if (fds[i] >= 0) close(fds[i]);
+#endif
+    }
+
+private:
+    int fds[N];
+
+    perf_group()
+    {
+        for (auto& fd : fds) fd = -1;
+#ifdef __linux__
+        static const std::uint64_t configs[N] = {PERF_COUNT_HW_CPU_CYCLES,
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES,
+            PERF_COUNT_HW_BRANCH_MISSES};
+        for (int i=0; i<N; i++)
+        {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[i];
+            attr.read_format = PERF_FORMAT_GROUP;
+            attr.disabled = i == 0;     // the leader enables the group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fds[i] = syscall(__NR_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds[0], 0);
+            if (fds[i] < 0)
+            {
+                for (int j=i-1; j>=0; j--) close(fds[j]);
+                for (auto& fd : fds) fd = -1;
+                break;
+            }
+        }
+        if (valid())
+            ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+        if (!valid())
+            SC_REPORT_WARNING("perf_counters", "the hardware performance counters could not be opened");
+    }
+};
+
+//! Measures a firing of a process from its construction to its destruction
+/*! Only the firings whose index is a multiple of FORSYDE_PERF_SAMPLE are
+ * measured.
+ */
+class perf_scope
+{
+public:
+    perf_scope(perf_totals& totals, unsigned long long firing)
+        : totals(totals), grp(NULL)
+    {
+        if (firing % FORSYDE_PERF_SAMPLE != 0) return;
+        perf_group& g = perf_group::get();
+        if (g.valid() && g.read(start)) grp = &g;
+    }
+
+    ~perf_scope()
+    {
+        std::uint64_t end[perf_group::N];
+        if (grp == NULL || !grp->read(end)) return;
+        totals.samples++;
+        totals.cycles += end[0] - start[0];
+        totals.instructions += end[1] - start[1];
+        totals.cache_misses += end[2] - start[2];
+        totals.branch_misses += end[3] - start[3];
+    }
+
+private:
+    perf_totals& totals;
+    perf_group* grp;
+    std::uint64_t start[perf_group::N];
+};
+
+}
+
+#endif
@@ -0,0 +1,203 @@
+/**********************************************************************
+    * pipe_link.hpp -- Framed communication over a pair of named pipes*
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Exchanging length-prefixed binary messages with an     *
+    *          external model through Unix FIFOs                      *
+    *                                                                 *
+    * Usage:   Used by the pipe wrappers of the SY MoC                *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PIPE_LINK_HPP
+#define PIPE_LINK_HPP
+
+/*! \file pipe_link.hpp
+ * \brief Implements framed messages over a pair of named pipes
+ *
+ *  This file includes the connection used by the pipe wrappers to talk
+ * to an external model using the binary protocol. Each message (frame)
+ * is a 32-bit unsigned length in the host byte order followed by that
+ * many bytes of payload. The pipes are non-blocking and the readiness is
+ * waited for using poll() with a short timeout, so that the caller can
+ * let the other processes of the simulation run if the model is slow.
+ */
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <errno.h>
+
+//! The time in milliseconds a pipe is polled before giving up the control
+#ifndef FORSYDE_PIPE_POLL_TIMEOUT
+#define FORSYDE_PIPE_POLL_TIMEOUT 10
+#endif
+
+namespace ForSyDe
+{
+
+//! The protocols of the pipe wrappers
+enum pipe_protocol
+{
+    PIPE_TEXT,      ///< one line per token, formatted by the stream operators
+    PIPE_BINARY     ///< one length-prefixed frame of serialized tokens per transaction
+};
+
+//! A connection to an external model through an input and an output pipe
+/*! The input pipe carries the frames to the model and the output pipe
+ * the frames from it. A frame is built in the buffer returned by
+ * frame() after begin_frame(), and sent using send(). Partially sent or
+ * received frames are kept, hence send() and receive() can be called
+ * again after they return PIPE_AGAIN.
+ */
+class pipe_link
+{
+public:
+    //! The result of a transfer
+    enum status
+    {
+        PIPE_OK,        ///< the frame is transferred completely
+        PIPE_AGAIN,     ///< the pipe is not ready yet
+        PIPE_EOF,       ///< the other side has closed the pipe
+        PIPE_ERROR      ///< the transfer has failed
+    };
+
+    pipe_link() : inp_fd(-1), out_fd(-1), sent(0), received(0),
+                  complete(false) {}
+
+    pipe_link(const pipe_link&) = delete;
+    pipe_link& operator=(const pipe_link&) = delete;
+
+    //! Tries to open the pipes which are not opened yet
+    /*! Opening the input pipe for writing fails until the model opens it
+     * for reading, hence this is retried until it returns true.
+     */
+    bool try_open(const std::string& inp_path, const std::string& out_path)
+    {
+        if (inp_fd < 0) inp_fd = open(inp_path.c_str(), O_WRONLY|O_NONBLOCK);
+        if (out_fd < 0) out_fd = open(out_path.c_str(), O_RDONLY|O_NONBLOCK);
+        return inp_fd >= 0 && out_fd >= 0;
+    }
+
+    //! The file descriptor of the pipe to the model
+    int input_fd() const {return inp_fd;}
+
+    //! The file descriptor of the pipe from the model
+    int output_fd() const {return out_fd;}
+
+    //! Starts a new outgoing frame
+    void begin_frame()
+    {
+        out_buf.assign(sizeof(std::uint32_t), 0);
+        sent = 0;
+    }
+
+    //! The buffer of the outgoing frame, to which the payload is appended
+    std::vector<char>& frame() {return out_buf;}
+
+    //! Sends (the rest of) the outgoing frame
+    status send()
+    {
+        if (sent == 0)
+        {
+            const std::uint32_t len = out_buf.size() - sizeof(std::uint32_t);
+            std::memcpy(out_buf.data(), &len, sizeof(len));
+        }
+        while (sent < out_buf.size())
+        {
+            const ssize_t n = write(inp_fd, out_buf.data()+sent, out_buf.size()-sent);
+            if (n > 0)
+                sent += n;
+            else if (n < 0 && errno == EAGAIN)
+            {
+                if (!ready(inp_fd, POLLOUT)) return PIPE_AGAIN;
+            }
+            else if (n < 0 && errno == EINTR)
+                continue;
+            else
+                return PIPE_ERROR;
+        }
+        return PIPE_OK;
+    }
+
+    //! Receives (the rest of) the next incoming frame
+    /*! When it returns PIPE_OK the payload is available until the next
+     * call.
+     */
+    status receive()
+    {
+        if (complete)
+        {
+            // the previous frame is consumed
+            received = 0;
+            complete = false;
+        }
+        while (true)
+        {
+            // the header first, then the payload
+            size_t need = sizeof(std::uint32_t);
+            if (received >= need)
+            {
+                std::uint32_t len;
+                std::memcpy(&len, in_buf.data(), sizeof(len));
+                need += len;
+            }
+            in_buf.resize(need);
+            if (received == need && received >= sizeof(std::uint32_t))
+            {
+                complete = true;
+                return PIPE_OK;
+            }
+            const ssize_t n = read(out_fd, in_buf.data()+received, need-received);
+            if (n > 0)
+                received += n;
+            else if (n == 0)
+                return PIPE_EOF;
+            else if (errno == EAGAIN)
+            {
+                if (!ready(out_fd, POLLIN)) return PIPE_AGAIN;
+            }
+            else if (errno != EINTR)
+                return PIPE_ERROR;
+        }
+    }
+
+    //! The payload of the received frame
+    const char* payload() const {return in_buf.data() + sizeof(std::uint32_t);}
+
+    //! The size of the payload of the received frame
+    size_t payload_size() const {return in_buf.size() - sizeof(std::uint32_t);}
+
+    //! Closes the pipes
+    void close()
+    {
+        if (inp_fd >= 0) ::close(inp_fd);
+        if (out_fd >= 0) ::close(out_fd);
+        inp_fd = out_fd = -1;
+    }
+
+    //! Waits for a pipe to become ready for the given events
+    /*! It returns false if the pipe is not ready within the timeout.
+     */
+    static bool ready(int fd, short events)
+    {
+        pollfd p = {fd, events, 0};
+        return poll(&p, 1, FORSYDE_PIPE_POLL_TIMEOUT) > 0;
+    }
+
+private:
+    int inp_fd, out_fd;
+    std::vector<char> out_buf, in_buf;
+    size_t sent, received;
+    bool complete;
+};
+
+}
+
+#endif
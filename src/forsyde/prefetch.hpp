@@ -0,0 +1,177 @@
+/**********************************************************************
+    * prefetch.hpp -- Generating the values of sources ahead of use   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Overlapping the computation of expensive sources with  *
+    *          the simulation of the rest of the model                *
+    *                                                                 *
+    * Usage:   Included by the process constructors of the sources    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PREFETCH_HPP
+#define PREFETCH_HPP
+
+/*! \file prefetch.hpp
+ * \brief Implements the background generation of the states of sources
+ *
+ *  The SY, SDF and DDE sources compute each output by applying their
+ * function to their current state on the simulation thread. When the
+ * function depends only on the state, the outputs can be computed ahead
+ * of time. After set_prefetch() is called on such a source, a worker
+ * thread applies the function in blocks of values into a ring buffer,
+ * and the source only takes the next value from it:
+ *
+ *     auto src = SY::make_source("stimuli", next_frame, frame0, 0, sig);
+ *     src->set_prefetch(256);
+ *
+ * The values are the same as without prefetching, and the state of the
+ * source (e.g., the one saved in a checkpoint) is still the last value
+ * it produced. The worker is restarted from that state when the source
+ * is reset or restored.
+ */
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <exception>
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Applies the function of a source to its state ahead of time in a worker thread
+/*! The worker fills a single-producer single-consumer ring buffer of two
+ * blocks, generating a whole block whenever one is free, and sleeps
+ * while the ring is full.
+ */
+template <typename S>
+class state_prefetcher
+{
+public:
+    //! The type of the function of the source, which computes the next state
+    typedef std::function<void(S&, const S&)> functype;
+
+    state_prefetcher(const functype& func,      ///< the function of the source
+                     const S& start,            ///< the current state
+                     size_t block,              ///< the number of values generated at once
+                     unsigned long long limit=0 ///< the number of values needed (0 for infinite)
+                    )
+        : func(func), state(start), limit(limit)
+    {
+        size_t cap = 2;
+        while (cap < 2*block) cap <<= 1;
+        blk = cap / 2;
+        buf.resize(cap);
+        mask = cap - 1;
+        worker = std::thread(&state_prefetcher::run, this);
+    }
+
+    //! Stops the worker, discarding the values not taken
+    ~state_prefetcher()
+    {
+        stop.store(true, std::memory_order_release);
+        wake();
+        worker.join();
+    }
+
+    state_prefetcher(const state_prefetcher&) = delete;
+    state_prefetcher& operator=(const state_prefetcher&) = delete;
+
+    //! Takes the next state, waiting for the worker if it is not ready yet
+    /*! An exception thrown by the function is reported, on the calling
+     * thread, when its value would be taken.
+     */
+    void next(S& out)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        while (h == tail.load(std::memory_order_acquire))
+        {
+            if (failed.load(std::memory_order_acquire))
+                SC_REPORT_ERROR("state_prefetcher", error.c_str());
+            std::this_thread::yield();
+        }
+        out = buf[h & mask];
+        head.store(h+1, std::memory_order_release);
+        // the worker is woken once a whole block is free
+        if (sleeping.load(std::memory_order_acquire) &&
+            tail.load(std::memory_order_relaxed) - (h+1) <= blk)
+            wake();
+    }
+
+private:
+    functype func;
+    S state;
+    unsigned long long limit;
+
+    std::vector<S> buf;
+    size_t blk, mask;
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) std::atomic<size_t> tail{0};
+    std::atomic<bool> sleeping{false}, stop{false}, failed{false};
+    std::string error;
+
+    std::thread worker;
+    std::mutex m;
+    std::condition_variable cv;
+
+    void wake()
+    {
+        std::lock_guard<std::mutex> lk(m);
+        cv.notify_one();
+    }
+
+    //! The main loop of the worker
+    void run()
+    {
+        unsigned long long made = 0;
+        while (!stop.load(std::memory_order_acquire))
+        {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if (limit && made == limit) return;
+            if (t - head.load(std::memory_order_acquire) > blk)
+            {
+                // the timeout bounds the delay of a missed wake-up
+                std::unique_lock<std::mutex> lk(m);
+                sleeping.store(true, std::memory_order_release);
+                if (tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) > blk &&
+                    !stop.load(std::memory_order_acquire))
+                    cv.wait_for(lk, std::chrono::milliseconds(1));
+                sleeping.store(false, std::memory_order_relaxed);
+                continue;
+            }
+            size_t n = blk;
+            if (limit && limit - made < n) n = limit - made;
+            try
+            {
+                for (size_t i=0; i<n; i++)
+                {
+                    func(state, state);
+                    buf[(t+i) & mask] = state;
+                    // the consumer sees each value as soon as it is ready
+                    tail.store(t+i+1, std::memory_order_release);
+                }
+            }
+            catch (const std::exception& e)
+            {
+                error = e.what();
+                failed.store(true, std::memory_order_release);
+                return;
+            }
+            made += n;
+        }
+    }
+};
+
+}
+
+#endif
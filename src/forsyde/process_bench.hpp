@@ -0,0 +1,371 @@
+/**********************************************************************
+    * process_bench.hpp -- Benchmarking a process in isolation        *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Recording the signals of a process in a model and      *
+    *          replaying them to time that process alone              *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SIGNAL_TRACE to use it                  *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PROCESS_BENCH_HPP
+#define PROCESS_BENCH_HPP
+
+/*! \file process_bench.hpp
+ * \brief Implements the micro-benchmark of a single process of a model
+ *
+ *  Optimizing a hot process deep in a large model is slow when each
+ * measurement simulates the whole model. This file includes a driver
+ * which records the input and output signals of a process in a normal
+ * run, and in the later runs executes only that process, with its
+ * inputs replayed from the trace, timing each of its execution stages
+ * and comparing its outputs with the recorded ones:
+ *
+ *     top t("top");
+ *     process_bench pb("pb", "top.filter1", "filter1.trc");
+ *     pb.track(t.s1, "s1");               // all the inputs and outputs
+ *     pb.track(t.s2, "s2");
+ *     if (measure) pb.bench();            // otherwise a recording run
+ *     sc_start();
+ *     pb.print_report();
+ *
+ *  The process is the same object as in the model (the same constructor,
+ * arguments and function), hence the model is still elaborated in the
+ * benchmark runs, but none of the other processes is executed. Every
+ * input and output signal of the process should be tracked.
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <iostream>
+
+#include "abssemantics.hpp"
+#include "trace_recorder.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Records the signals of a process or executes it alone on the recording
+/*! A run is a recording run unless bench() is called before the
+ * simulation starts. The benchmark run ends when the replayed inputs
+ * are exhausted and the process blocks.
+ */
+class process_bench : public sc_module
+{
+public:
+    //! The index of a token which is not found
+    static constexpr size_t npos = size_t(-1);
+
+    //! The constructor requires the module name, the process and the trace file
+    process_bench(sc_module_name _name,         ///< The module name
+                  const std::string& proc_name, ///< The hierarchical name of the process
+                  const std::string& trace      ///< The trace of the recording run
+                  ) : sc_module(_name), proc_name(proc_name), trace(trace),
+                      benchmark(false), proc(NULL), firings(0), exec_time(0),
+                      min_exec(std::numeric_limits<double>::infinity())
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Tracks a signal, which is recorded or replayed and compared
+    template <typename T, typename TokenType, template <class> class FifoType>
+    void track(ForSyDe::signal<T,TokenType,FifoType>& sig,  ///< the signal
+               const std::string& sig_name                  ///< its name in the trace
+               )
+    {
+        sigs.emplace_back(new tracked<T,TokenType,FifoType>(sig, sig_name));
+    }
+
+    //! Executes only the process, on the recorded inputs
+    void bench() {benchmark = true;}
+
+    //! Checks if the run records the signals
+    bool is_recording() const {return !benchmark;}
+
+    //! The firings of the process in a benchmark run
+    unsigned long long num_firings() const {return firings;}
+
+    //! The wall-clock time spent in the execution stages in seconds
+    double total_exec_time() const {return exec_time;}
+
+    //! The average wall-clock time of an execution stage in seconds
+    double mean_exec_time() const {return firings ? exec_time / firings : 0;}
+
+    //! The shortest wall-clock time of an execution stage in seconds
+    double min_exec_time() const {return firings ? min_exec : 0;}
+
+    //! The index of the first output token of a signal differing from the recording
+    /*! It returns npos if the tokens written so far are the same as in the
+     * recording.
+     */
+    size_t first_difference(const std::string& sig_name) const
+    {
+        for (auto& s : sigs)
+            if (s->name == sig_name) return s->first_diff;
+        SC_REPORT_ERROR(name(), ("no tracked signal named " + sig_name).c_str());
+        return npos;
+    }
+
+    //! Checks if all the outputs written in a benchmark run match the recording
+    bool outputs_match() const
+    {
+        for (auto& s : sigs)
+            if (s->role == tracked_base::COMPARED &&
+                (s->first_diff != npos || s->count != s->recorded()))
+                return false;
+        return true;
+    }
+
+    //! Prints the timing of the process and the compared outputs
+    void print_report(std::ostream& os=std::cout) const
+    {
+        if (is_recording())
+        {
+            os << "Process benchmark " << name() << ": " << sigs.size()
+               << " signals of " << proc_name << " recorded to " << trace << std::endl;
+            return;
+        }
+        os << "Process benchmark " << name() << ": " << proc_name << " fired "
+           << firings << " times, exec " << mean_exec_time() * 1e6 << " us on average, "
+           << min_exec_time() * 1e6 << " us at least" << std::endl;
+        for (auto& s : sigs)
+        {
+            if (s->role == tracked_base::REPLAYED)
+                os << "  replayed  " << s->name << " (" << s->count << " tokens)" << std::endl;
+            else if (s->role == tracked_base::COMPARED)
+            {
+                os << "  compared  " << s->name << " (" << s->count << " of "
+                   << s->recorded() << " tokens, ";
+                if (s->first_diff == npos) os << "same as the recording)";
+                else os << "differs from token " << s->first_diff << ")";
+                os << std::endl;
+            }
+        }
+    }
+
+    //! The driver is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_process_bench";}
+
+private:
+    SC_HAS_PROCESS(process_bench);
+
+    //! A tracked signal, independent of its token type
+    struct tracked_base
+    {
+        enum role_type {IDLE, REPLAYED, COMPARED};
+
+        tracked_base(const std::string& name, sc_interface* chan)
+            : name(name), chan(chan), role(IDLE), count(0), first_diff(npos) {}
+        virtual ~tracked_base() {}
+
+        //! Attaches the signal to the recorder
+        virtual void record(trace_recorder& rec) = 0;
+        //! Loads the recorded tokens of the signal
+        virtual void load(const trace_reader& rd) = 0;
+        //! The number of recorded tokens
+        virtual size_t recorded() const = 0;
+        //! Starts comparing the written tokens with the recording
+        virtual void compare() = 0;
+        //! Writes the recorded tokens to the signal
+        virtual void feed() = 0;
+        //! Reads and drops the tokens written to the signal
+        virtual void drain() = 0;
+
+        std::string name;
+        sc_interface* chan;
+        role_type role;
+        size_t count, first_diff;
+    };
+
+    template <typename T, typename TokenType, template <class> class FifoType>
+    struct tracked : public tracked_base, public signal_observer<TokenType>
+    {
+        typedef trace_token<TokenType> traits;
+        typedef typename traits::value_type V;
+
+        tracked(ForSyDe::signal<T,TokenType,FifoType>& sig, const std::string& name)
+            : tracked_base(name, &sig), sig(sig) {}
+
+        void record(trace_recorder& rec) {rec.record(sig, name);}
+
+        void load(const trace_reader& rd)
+        {
+            base = rd.values<V>(name);
+            if (traits::timed) times = rd.times(name);
+        }
+
+        size_t recorded() const {return base.size();}
+
+        void compare()
+        {
+            role = COMPARED;
+            sig.set_observer(this);
+        }
+
+        void feed()
+        {
+            for (size_t i=0; i<base.size(); i++)
+            {
+                sig.write(traits::make(base[i], traits::timed ? times[i] : 0));
+                count++;
+            }
+        }
+
+        void drain()
+        {
+            while (1) sig.read();
+        }
+
+        void observe(const TokenType& tok)
+        {
+            const size_t i = count++;
+            bool same = i < base.size() && traits::value(tok) == base[i];
+            if (same && traits::timed)
+            {
+                const double res = sc_get_time_resolution().to_seconds();
+                same = std::abs(traits::time(tok) * res - times[i]) < res / 2;
+            }
+            if (!same && first_diff == npos) first_diff = i;
+        }
+
+        ForSyDe::signal<T,TokenType,FifoType>& sig;
+        std::vector<V> base;
+        std::vector<double> times;
+    };
+
+    std::string proc_name, trace;
+    bool benchmark;
+    std::vector<std::unique_ptr<tracked_base>> sigs;
+
+    trace_recorder rec;
+    ForSyDe::process* proc;
+    unsigned long long firings;
+    double exec_time, min_exec;
+
+    //! Collects the ForSyDe processes below an object recursively
+    static void collect(sc_object* obj, std::vector<ForSyDe::process*>& procs)
+    {
+        for (auto c : obj->get_child_objects())
+        {
+            if (auto p = dynamic_cast<ForSyDe::process*>(c))
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(c) != NULL)
+                collect(c, procs);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        for (auto c : p->get_child_objects())
+            if (c->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! Returns the tracked signal of a channel, if any
+    tracked_base* find(sc_interface* ch) const
+    {
+        for (auto& s : sigs)
+            if (s->chan == ch) return s.get();
+        return NULL;
+    }
+
+    //! Finds the process, and opens the trace or stops the other processes
+    void end_of_elaboration()
+    {
+        proc = dynamic_cast<ForSyDe::process*>(sc_find_object(proc_name.c_str()));
+        if (proc == NULL)
+            SC_REPORT_ERROR(name(), ("no process named " + proc_name).c_str());
+        const auto ins = channels(proc, "sc_fifo_in");
+        const auto outs = channels(proc, "sc_fifo_out");
+        for (auto& chs : {ins, outs})
+            for (auto ch : chs)
+                if (find(ch) == NULL)
+                    SC_REPORT_ERROR(name(), ("a signal of " + proc_name + " is not tracked").c_str());
+        if (is_recording())
+        {
+            if (!rec.open(trace))
+                SC_REPORT_ERROR(name(), ("the trace file " + trace + " could not be written").c_str());
+            for (auto& s : sigs) s->record(rec);
+            return;
+        }
+        trace_reader rd;
+        if (!rd.open(trace))
+            SC_REPORT_ERROR(name(), ("the recorded trace " + trace + " could not be loaded").c_str());
+        for (auto& chs : {ins, outs})
+            for (auto ch : chs)
+            {
+                tracked_base* s = find(ch);
+                if (!rd.has_signal(s->name))
+                    SC_REPORT_ERROR(name(), ("the signal " + s->name + " is not in the recorded trace").c_str());
+                s->load(rd);
+            }
+        for (auto ch : ins) find(ch)->role = tracked_base::REPLAYED;
+        for (auto ch : outs) find(ch)->compare();
+        std::vector<ForSyDe::process*> procs;
+        for (auto top : sc_get_top_level_objects()) collect(top, procs);
+        for (auto p : procs) p->set_ext_driven();
+    }
+
+    //! Closes the trace of a recording run
+    void end_of_simulation()
+    {
+        if (is_recording()) rec.close();
+    }
+
+    //! Replays the inputs, drops the outputs and fires the process
+    void worker()
+    {
+        if (is_recording()) return;
+        for (auto& s : sigs)
+        {
+            tracked_base* t = s.get();
+            if (t->role == tracked_base::REPLAYED)
+                sc_spawn([t]{t->feed();});
+            else if (t->role == tracked_base::COMPARED)
+                sc_spawn([t]{t->drain();});
+        }
+        proc->ext_init();
+        while (1)
+        {
+            proc->ext_prep();
+            const auto t0 = std::chrono::steady_clock::now();
+            proc->ext_exec();
+            const double t = std::chrono::duration<double>(
+                                std::chrono::steady_clock::now() - t0).count();
+            proc->ext_prod();
+            firings++;
+            exec_time += t;
+            if (t < min_exec) min_exec = t;
+        }
+    }
+};
+
+//! Helper function to construct a process benchmark
+inline process_bench* make_process_bench(const std::string& pName,  ///< the driver name
+    const std::string& proc_name,                   ///< the process
+    const std::string& trace                        ///< the trace file
+    )
+{
+    return new process_bench(pName.c_str(), proc_name, trace);
+}
+
+}
+
+#endif
@@ -0,0 +1,267 @@
+/**********************************************************************
+    * process_graph.hpp -- An in-memory graph of the process network  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a queryable structural view of an elaborated *
+    *          model for the analyses and optimizations               *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION to use it                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PROCESS_GRAPH_HPP
+#define PROCESS_GRAPH_HPP
+
+/*! \file process_graph.hpp
+ * \brief Implements an in-memory graph of the elaborated process network
+ *
+ *  This file includes a flat graph of the leaf processes of a model and
+ * the signals connecting them, which is built from the introspection
+ * information after the elaboration phase. Unlike the XML files written
+ * by XMLExport, it can be queried directly by C++ code, e.g., by the
+ * analysis and optimization passes:
+ *
+ *     void start_of_simulation()
+ *     {
+ *         const process_graph& g = model_graph();
+ *         for (auto& n : g.nodes()) std::cout << n.kind << std::endl;
+ *     }
+ */
+
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+#include "abssemantics.hpp"
+#include "sdf_process.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A flat graph of the leaf processes of a model and their signals
+/*! The nodes are the ForSyDe leaf processes and the edges are the
+ * channels bound to their ports, where the hierarchical port bindings
+ * are resolved to the channels. The channels with only one end bound to
+ * a ForSyDe process are included with the other end set to npos.
+ */
+class process_graph
+{
+public:
+    //! The index of a missing node or edge
+    static constexpr size_t npos = size_t(-1);
+
+    //! A leaf process
+    struct node
+    {
+        ForSyDe::process* proc;     ///< the process
+        std::string name;           ///< the hierarchical name
+        std::string kind;           ///< the process constructor, e.g., "SY::comb"
+        std::vector<size_t> in_edges;   ///< the edges bound to the input ports
+        std::vector<size_t> out_edges;  ///< the edges bound to the output ports
+
+        //! The arguments passed to the process constructor
+        const std::vector<std::tuple<std::string,arg_value>>& args() const
+        {
+            return proc->arg_vec;
+        }
+    };
+
+    //! A signal between two processes
+    struct edge
+    {
+        sc_interface* chan;         ///< the channel
+        size_t src, dst;            ///< the producer and the consumer nodes
+        sc_object* src_port;        ///< the output port of the producer
+        sc_object* dst_port;        ///< the input port of the consumer
+        const char* token_type;     ///< the name of the token type
+        unsigned type_id;           ///< the interned ID of the token type
+        unsigned moc_id;            ///< the interned ID of the MoC
+        //! Tokens produced/consumed per firing, zero if they are not fixed
+        /*! They are the totals of a cycle for the cyclo-static ports.
+         */
+        size_t prod, cons;
+        size_t init_toks;           ///< initial tokens of an SDF producer
+        //! The tokens of each phase of a cyclo-static producer/consumer, empty otherwise
+        std::vector<unsigned int> prod_phases, cons_phases;
+
+#ifdef FORSYDE_SIGNAL_STATS
+        //! The occupancy statistics of the channel, zero if it collects none
+        signal_stats stats() const
+        {
+            auto sc = dynamic_cast<const stats_channel*>(chan);
+            return sc ? sc->stats() : signal_stats();
+        }
+#endif
+    };
+
+    //! Builds the graph of the leaf processes below the given objects
+    /*! It should be called after the elaboration phase, when the
+     * processes have collected their introspection information.
+     */
+    void build(const std::vector<sc_object*>& roots)
+    {
+        nodes_.clear();
+        edges_.clear();
+        node_index.clear();
+        edge_index.clear();
+        for (auto r : roots) collect(r);
+        for (size_t i=0; i<nodes_.size(); i++)
+        {
+            ForSyDe::process* p = nodes_[i].proc;
+            for (auto& pi : p->boundInChans) add_port(i, pi.port, false);
+            for (auto& pi : p->boundOutChans) add_port(i, pi.port, true);
+        }
+    }
+
+    //! The leaf processes
+    const std::vector<node>& nodes() const {return nodes_;}
+
+    //! The signals
+    const std::vector<edge>& edges() const {return edges_;}
+
+    //! Finds a process by its hierarchical name
+    size_t find(const std::string& name) const
+    {
+        auto it = node_index.find(name);
+        return it == node_index.end() ? npos : it->second;
+    }
+
+    //! Finds the node of a process
+    size_t find(const ForSyDe::process* p) const {return find(std::string(p->name()));}
+
+    //! Finds the edge of a channel
+    size_t find_edge(const sc_interface* chan) const
+    {
+        auto it = edge_index.find(chan);
+        return it == edge_index.end() ? npos : it->second;
+    }
+
+    //! The processes which write to the inputs of a process
+    std::vector<size_t> predecessors(size_t n) const
+    {
+        std::vector<size_t> res;
+        for (auto e : nodes_[n].in_edges)
+            if (edges_[e].src != npos) res.push_back(edges_[e].src);
+        return res;
+    }
+
+    //! The processes which read the outputs of a process
+    std::vector<size_t> successors(size_t n) const
+    {
+        std::vector<size_t> res;
+        for (auto e : nodes_[n].out_edges)
+            if (edges_[e].dst != npos) res.push_back(edges_[e].dst);
+        return res;
+    }
+
+private:
+    std::vector<node> nodes_;
+    std::vector<edge> edges_;
+    std::unordered_map<std::string,size_t> node_index;
+    std::unordered_map<const sc_interface*,size_t> edge_index;
+
+    //! Collects the leaf processes below an object recursively
+    void collect(sc_object* obj)
+    {
+        if (ForSyDe::process* p = dynamic_cast<ForSyDe::process*>(obj))
+        {
+            node_index[p->name()] = nodes_.size();
+            nodes_.push_back({p, p->name(), p->forsyde_kind(), {}, {}});
+            return;
+        }
+        for (auto c : obj->get_child_objects())
+            if (dynamic_cast<sc_module*>(c) != NULL) collect(c);
+    }
+
+    //! The rate and the initial tokens of a port, if they are fixed
+    static void port_rate(const ForSyDe::process* p, const sc_object* port,
+                          introspective_port* ip, bool out,
+                          size_t& rate, size_t& init_toks,
+                          std::vector<unsigned int>& phases)
+    {
+        rate = init_toks = 0;
+        phases.clear();
+        if (auto sp = dynamic_cast<const SDF::sdf_process*>(p))
+        {
+            for (auto& pr : out ? sp->out_rates : sp->in_rates)
+                if (pr.port == port)
+                {
+                    rate = pr.toks;
+                    init_toks = pr.init_toks;
+                    phases = pr.phases;
+                }
+        }
+        else if (ip->moc() == "SY")
+            rate = 1;
+    }
+
+    //! Adds the channels bound to a port of a node
+    void add_port(size_t n, sc_object* port, bool out)
+    {
+        channel_port* cp = dynamic_cast<channel_port*>(port);
+        introspective_port* ip = dynamic_cast<introspective_port*>(port);
+        if (cp == NULL || ip == NULL) return;
+        size_t rate, init_toks;
+        std::vector<unsigned int> phases;
+        port_rate(nodes_[n].proc, port, ip, out, rate, init_toks, phases);
+        for (auto ch : cp->bound_channels())
+        {
+            auto it = edge_index.find(ch);
+            size_t e;
+            if (it == edge_index.end())
+            {
+                e = edges_.size();
+                edge_index[ch] = e;
+                edges_.push_back({ch, npos, npos, NULL, NULL, ip->token_type(),
+                                  ip->token_type_id(), ip->moc_id(), 0, 0, 0});
+            }
+            else
+                e = it->second;
+            edge& ed = edges_[e];
+            if (out)
+            {
+                ed.src = n;
+                ed.src_port = port;
+                ed.prod = rate;
+                ed.init_toks = init_toks;
+                ed.prod_phases = phases;
+                nodes_[n].out_edges.push_back(e);
+            }
+            else
+            {
+                ed.dst = n;
+                ed.dst_port = port;
+                ed.cons = rate;
+                ed.cons_phases = phases;
+                nodes_[n].in_edges.push_back(e);
+            }
+        }
+    }
+};
+
+//! Returns the graph of the whole model
+/*! It is built from the top-level objects on the first call, which
+ * should happen after the elaboration phase (e.g., in
+ * start_of_simulation or later).
+ */
+inline const process_graph& model_graph()
+{
+    static process_graph g;
+    static bool built = false;
+    if (!built)
+    {
+        if (sc_get_status() < SC_START_OF_SIMULATION)
+            SC_REPORT_ERROR("process_graph", "the graph of the model is built after the elaboration");
+        g.build(sc_get_top_level_objects());
+        built = true;
+    }
+    return g;
+}
+
+}
+
+#endif
@@ -0,0 +1,234 @@
+/**********************************************************************
+    * profile_db.hpp -- A profile database kept across runs           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Remembering the costs of the processes and the traffic *
+    *          of the signals of a model to guide the next runs       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_PROFILE_DB (with FORSYDE_PROFILE)       *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PROFILE_DB_HPP
+#define PROFILE_DB_HPP
+
+/*! \file profile_db.hpp
+ * \brief Implements a persistent database of the profiles of a model
+ *
+ *  The optimizations of the library need the costs of the processes and
+ * the traffic of the signals, which are only known after the model has
+ * run. With FORSYDE_PROFILE_DB, the profiler also merges its records
+ * into a database file at the end of each simulation. The file is keyed
+ * by the names of the processes and signals, and holds the firings and
+ * the exec time of each process, and the tokens and the occupancy of
+ * each signal written by a profiled process (with FORSYDE_INTROSPECTION).
+ * The values are averaged over the last runs, so that the database
+ * follows the changes of the model and of its inputs.
+ *
+ *  The next runs of the model read the database after the elaboration:
+ * the partitioner weighs the processes by their exec times (see
+ * partitioner::load_profile_db), SY::parallel_executor clusters the
+ * processes using the stored costs instead of timing a sequential tick,
+ * SDF::hsdf_executor maps the actors using them, and apply_fifo_sizes()
+ * sizes the signals after their peak occupancy:
+ *
+ *     top t("top");
+ *     ForSyDe::apply_fifo_sizes(&t);
+ *     sc_start();
+ *
+ *  A process whose kind has changed since the last run (e.g., the model
+ * has been edited) starts with a new entry.
+ */
+
+#include <map>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+//! The default file of the profile database
+#ifndef FORSYDE_PROFILE_DB_FILE
+#define FORSYDE_PROFILE_DB_FILE "forsyde_profile.db"
+#endif
+
+//! The number of the last runs over which the values are averaged
+#ifndef FORSYDE_PROFILE_DB_WINDOW
+#define FORSYDE_PROFILE_DB_WINDOW 8
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A persistent database of the profiles of the processes and signals
+/*! The database is loaded from its file when it is first used, and
+ * saved by the profiler once all the processes have reported.
+ */
+class profile_db
+{
+public:
+    //! The profile of a process
+    struct process_entry
+    {
+        std::string kind;           ///< the process constructor
+        unsigned runs = 0;          ///< the runs merged into the entry
+        double firings = 0;         ///< the firings in a run
+        double exec_time = 0;       ///< the wall-clock time of the exec stages in a run
+
+        //! The exec time of a firing in seconds
+        double cost() const {return firings > 0 ? exec_time / firings : 0;}
+    };
+
+    //! The profile of a signal
+    struct channel_entry
+    {
+        unsigned runs = 0;          ///< the runs merged into the entry
+        double tokens = 0;          ///< the productions of the writer in a run
+        size_t peak = 0;            ///< the largest occupancy seen in any run
+        double occupancy = 0;       ///< the mean occupancy after the productions
+    };
+
+    //! Returns the single instance of the database
+    static profile_db& get()
+    {
+        static profile_db db;
+        return db;
+    }
+
+    //! Uses another file, loading it instead of the current one
+    void set_file(const std::string& file_name)
+    {
+        db_file = file_name;
+        procs.clear();
+        chans.clear();
+        load();
+    }
+
+    //! The profile of a process, or NULL if it has not been profiled
+    const process_entry* process_profile(const std::string& name) const
+    {
+        auto it = procs.find(name);
+        return it == procs.end() ? NULL : &it->second;
+    }
+
+    //! The profile of a signal, or NULL if it has not been profiled
+    const channel_entry* channel_profile(const std::string& name) const
+    {
+        auto it = chans.find(name);
+        return it == chans.end() ? NULL : &it->second;
+    }
+
+    //! The profiles of all the processes by their names
+    const std::map<std::string,process_entry>& processes() const {return procs;}
+
+    //! The exec time of a firing of a process in seconds, or -1 if it is unknown
+    double cost(const std::string& name) const
+    {
+        auto p = process_profile(name);
+        return p && p->firings > 0 ? p->cost() : -1;
+    }
+
+    //! Merges the profile of a process in the current run
+    void record_process(const std::string& name, const std::string& kind,
+                        double firings, double exec_time)
+    {
+        process_entry& e = procs[name];
+        if (e.kind != kind) e = process_entry{kind};
+        const double w = weight(e.runs);
+        e.firings += (firings - e.firings) * w;
+        e.exec_time += (exec_time - e.exec_time) * w;
+    }
+
+    //! Merges the profile of a signal in the current run
+    /*! The histogram counts the productions which left each occupancy in
+     * the signal.
+     */
+    void record_channel(const std::string& name, const std::vector<unsigned long long>& hist)
+    {
+        double tokens = 0, sum = 0;
+        size_t peak = 0;
+        for (size_t i=0; i<hist.size(); i++)
+        {
+            tokens += hist[i];
+            sum += double(hist[i]) * i;
+            if (hist[i] > 0) peak = i;
+        }
+        if (tokens == 0) return;
+        channel_entry& e = chans[name];
+        const double w = weight(e.runs);
+        e.tokens += (tokens - e.tokens) * w;
+        e.occupancy += (sum / tokens - e.occupancy) * w;
+        e.peak = std::max(e.peak, peak);
+    }
+
+    //! Writes the database to its file
+    void save() const
+    {
+        std::ofstream ofs(db_file);
+        if (!ofs.is_open())
+        {
+            SC_REPORT_WARNING(db_file.c_str(), "file could not be opened to write the profile database");
+            return;
+        }
+        ofs.precision(17);
+        ofs << "FSDPDB01" << std::endl;
+        for (auto& p : procs)
+            ofs << "P " << p.first << " " << p.second.kind << " " << p.second.runs << " "
+                << p.second.firings << " " << p.second.exec_time << std::endl;
+        for (auto& c : chans)
+            ofs << "C " << c.first << " " << c.second.runs << " " << c.second.tokens << " "
+                << c.second.peak << " " << c.second.occupancy << std::endl;
+    }
+
+private:
+    std::string db_file;
+    std::map<std::string,process_entry> procs;
+    std::map<std::string,channel_entry> chans;
+
+    profile_db() : db_file(FORSYDE_PROFILE_DB_FILE) {load();}
+
+    //! The weight of a new value in an entry, which counts the run
+    static double weight(unsigned& runs)
+    {
+        if (runs < FORSYDE_PROFILE_DB_WINDOW) runs++;
+        return 1.0 / runs;
+    }
+
+    //! Reads the database file, if it exists
+    void load()
+    {
+        std::ifstream ifs(db_file);
+        std::string line;
+        if (!std::getline(ifs, line)) return;
+        if (line != "FSDPDB01")
+        {
+            SC_REPORT_WARNING(db_file.c_str(), "not a profile database, it will be overwritten");
+            return;
+        }
+        while (std::getline(ifs, line))
+        {
+            std::istringstream ss(line);
+            std::string tag, name;
+            ss >> tag >> name;
+            if (tag == "P")
+            {
+                process_entry e;
+                if (ss >> e.kind >> e.runs >> e.firings >> e.exec_time) procs[name] = e;
+            }
+            else if (tag == "C")
+            {
+                channel_entry e;
+                if (ss >> e.runs >> e.tokens >> e.peak >> e.occupancy) chans[name] = e;
+            }
+        }
+    }
+};
+
+}
+
+#endif
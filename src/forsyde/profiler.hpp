@@ -0,0 +1,257 @@
+/**********************************************************************
+    * profiler.hpp -- Per-process profiling of ForSyDe models         *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Collecting firing counts and time accounting of the    *
+    *          processes and dumping them after the simulation        *
+    *                                                                 *
+    * Usage:   Define FORSYDE_PROFILE to enable it                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+/*! \file profiler.hpp
+ * \brief Implements the collection of profiling information
+ *
+ *  This file includes the profiling record kept by each process when
+ * FORSYDE_PROFILE is defined, and the profiler which writes the records
+ * of all the processes to a CSV or JSON file at the end of the
+ * simulation.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include "solver_stats.hpp"
+#ifdef FORSYDE_METRICS
+#include <atomic>
+#include <cstdint>
+#endif
+#ifdef FORSYDE_PERF_COUNTERS
+#include "perf_counters.hpp"
+#endif
+
+//! The default output file of the profiler
+/*! The output is written in JSON if the file name ends with ".json" and
+ * in CSV otherwise.
+ */
+#ifndef FORSYDE_PROFILE_FILE
+#define FORSYDE_PROFILE_FILE "forsyde_profile.csv"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+class static_channel;
+
+#ifdef FORSYDE_INTROSPECTION
+//! The profiling information of a port of a process
+/*! It is used by the bottleneck analysis to attribute the time a process
+ * is blocked to the signals, and to collect the occupancy of the signals.
+ */
+struct port_profile
+{
+    //! The channel bound to the port, if it is a ForSyDe signal
+    static_channel* chan = NULL;
+    //! Simulated time the process has been blocked on this port
+    sc_time blocked_time;
+    //! Delta cycles the process has been blocked on this port
+    unsigned long long blocked_deltas = 0;
+    //! Histogram of the occupancy of the channel after each production
+    std::vector<unsigned long long> occupancy;
+    //! Set if the port is suspected to block the current stage
+    bool blocking = false;
+};
+#endif
+
+//! The profiling information of a process
+/*! The time spent in the prep (prod) stage is reported as the time the
+ * process has been blocked on reading (writing), both in the simulated
+ * time and in delta cycles. The time spent in the exec stage is measured
+ * in wall-clock time.
+ */
+struct profile_info
+{
+    //! The number of completed evaluation cycles
+    unsigned long long firings = 0;
+    //! Simulated time spent in the prep stage
+    sc_time read_blocked_time;
+    //! Delta cycles spent in the prep stage
+    unsigned long long read_blocked_deltas = 0;
+    //! Simulated time spent in the prod stage
+    sc_time write_blocked_time;
+    //! Delta cycles spent in the prod stage
+    unsigned long long write_blocked_deltas = 0;
+    //! Wall-clock time spent in the exec stage in seconds
+    double exec_time = 0;
+    //! The lookups of the memoizing processes which found a cached result
+    unsigned long long memo_hits = 0;
+    //! The lookups of the memoizing processes which called the function
+    unsigned long long memo_misses = 0;
+    //! The statistics of the solver of the filters
+    solver_stats solver;
+#ifdef FORSYDE_PERF_COUNTERS
+    //! Hardware counters of the sampled exec stages
+    perf_totals perf;
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    //! Per-port information of the input ports, in the order of boundInChans
+    std::vector<port_profile> in_ports;
+    //! Per-port information of the output ports, in the order of boundOutChans
+    std::vector<port_profile> out_ports;
+#endif
+};
+
+#ifdef FORSYDE_METRICS
+//! The counters of a process which can be read by other threads
+/*! The process publishes its profiling record after each firing with
+ * relaxed stores, so that the metrics exporter can read them while the
+ * simulation is running, without any locks.
+ */
+struct live_counters
+{
+    std::atomic<unsigned long long> firings{0};     ///< the completed firings
+    std::atomic<std::uint64_t> exec_ns{0};          ///< the time spent in the exec stage
+    std::atomic<std::uint64_t> sim_time{0};         ///< the simulated time of the last firing
+
+    //! Publishes the profiling record after a firing
+    void publish(const profile_info& p)
+    {
+        firings.store(p.firings, std::memory_order_relaxed);
+        exec_ns.store(std::uint64_t(p.exec_time * 1e9), std::memory_order_relaxed);
+        sim_time.store(sc_time_stamp().value(), std::memory_order_relaxed);
+    }
+};
+#endif
+
+//! Collects the profiling information of all the processes
+/*! Each process enrolls in the constructor and reports its record at the
+ * end of the simulation. The output file is written once all the
+ * enrolled processes have reported.
+ */
+class profiler
+{
+public:
+    //! Returns the single instance of the profiler
+    static profiler& get()
+    {
+        static profiler prof;
+        return prof;
+    }
+
+    //! Sets the output file
+    void set_output(const std::string& file_name) {out_file = file_name;}
+
+    //! Registers a process which will report at the end of the simulation
+    void enroll() {enrolled++;}
+
+    //! Reports the record of a process
+    /*! It returns true if it was the last enrolled process, which writes
+     * the output file.
+     */
+    bool report(const std::string& name, const std::string& kind,
+                const profile_info& info)
+    {
+        rows.push_back(row{name, kind, info});
+        if (rows.size() != enrolled) return false;
+        write();
+        return true;
+    }
+
+private:
+    struct row
+    {
+        std::string name, kind;
+        profile_info info;
+    };
+
+    std::string out_file;
+    size_t enrolled;
+    std::vector<row> rows;
+
+    profiler() : out_file(FORSYDE_PROFILE_FILE), enrolled(0) {}
+
+    void write()
+    {
+        std::ofstream ofs(out_file);
+        if (!ofs.is_open())
+        {
+            SC_REPORT_ERROR(out_file.c_str(), "file could not be opened to write the profiling output");
+            return;
+        }
+        const bool json = out_file.size() >= 5 &&
+                          out_file.compare(out_file.size()-5, 5, ".json") == 0;
+        if (json)
+        {
+            ofs << "[" << std::endl;
+            for (size_t i=0; i<rows.size(); i++)
+            {
+                const profile_info& p = rows[i].info;
+                ofs << "  {\"process\": \"" << rows[i].name << "\", "
+                    << "\"kind\": \"" << rows[i].kind << "\", "
+                    << "\"firings\": " << p.firings << ", "
+                    << "\"read_blocked_time\": " << p.read_blocked_time.to_seconds() << ", "
+                    << "\"read_blocked_deltas\": " << p.read_blocked_deltas << ", "
+                    << "\"write_blocked_time\": " << p.write_blocked_time.to_seconds() << ", "
+                    << "\"write_blocked_deltas\": " << p.write_blocked_deltas << ", "
+                    << "\"exec_time\": " << p.exec_time << ", "
+                    << "\"memo_hits\": " << p.memo_hits << ", "
+                    << "\"memo_misses\": " << p.memo_misses << ", "
+                    << "\"accepted_steps\": " << p.solver.accepted << ", "
+                    << "\"rejected_steps\": " << p.solver.rejected << ", "
+                    << "\"min_step_hits\": " << p.solver.min_step_hits << ", "
+                    << "\"rhs_evals\": " << p.solver.rhs_evals << ", "
+                    << "\"step_histogram\": [" << p.solver.histogram(',') << "]"
+#ifdef FORSYDE_PERF_COUNTERS
+                    << ", \"perf_samples\": " << p.perf.samples << ", "
+                    << "\"cycles\": " << p.perf.cycles << ", "
+                    << "\"instructions\": " << p.perf.instructions << ", "
+                    << "\"ipc\": " << p.perf.ipc() << ", "
+                    << "\"cache_misses\": " << p.perf.cache_misses << ", "
+                    << "\"branch_misses\": " << p.perf.branch_misses
+#endif
+                    << "}"
+                    << (i+1<rows.size() ? "," : "") << std::endl;
+            }
+            ofs << "]" << std::endl;
+        }
+        else
+        {
+            ofs << "process,kind,firings,read_blocked_time,read_blocked_deltas,"
+                << "write_blocked_time,write_blocked_deltas,exec_time,memo_hits,memo_misses,"
+                << "accepted_steps,rejected_steps,min_step_hits,rhs_evals,step_histogram"
+#ifdef FORSYDE_PERF_COUNTERS
+                << ",perf_samples,cycles,instructions,ipc,cache_misses,branch_misses"
+#endif
+                << std::endl;
+            for (auto& r : rows)
+                ofs << r.name << "," << r.kind << "," << r.info.firings << ","
+                    << r.info.read_blocked_time.to_seconds() << ","
+                    << r.info.read_blocked_deltas << ","
+                    << r.info.write_blocked_time.to_seconds() << ","
+                    << r.info.write_blocked_deltas << ","
+                    << r.info.exec_time << "," << r.info.memo_hits
+                    << "," << r.info.memo_misses
+                    << "," << r.info.solver.accepted << "," << r.info.solver.rejected
+                    << "," << r.info.solver.min_step_hits << "," << r.info.solver.rhs_evals
+                    << "," << r.info.solver.histogram(' ')
+#ifdef FORSYDE_PERF_COUNTERS
+                    << "," << r.info.perf.samples << "," << r.info.perf.cycles
+                    << "," << r.info.perf.instructions << "," << r.info.perf.ipc()
+                    << "," << r.info.perf.cache_misses << "," << r.info.perf.branch_misses
+#endif
+                    << std::endl;
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,251 @@
+/**********************************************************************
+    * random.hpp -- Counter-based random number generation            *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing reproducible random streams and the          *
+    *          distributions used by the random source processes      *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef RANDOM_HPP
+#define RANDOM_HPP
+
+/*! \file random.hpp
+ * \brief Implements counter-based random number generation
+ *
+ *  This file includes a counter-based random number generator and the
+ * distributions which fill blocks of samples from it. They are used by
+ * the random source processes of the SY, SDF and CT libraries.
+ *
+ *  The Gaussian sources of the SY and CT libraries keep the LFSR
+ * generator they were built on, so that the existing models reproduce
+ * their traces, unless FORSYDE_COUNTER_RNG is defined, in which case
+ * they are random sources of this file as well.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <string>
+
+//! The seed of the random sources which are not given one explicitly
+/*! Changing it (e.g., to the index of a Monte-Carlo run) changes all the
+ * random streams of a model at once.
+ */
+#ifndef FORSYDE_RNG_SEED
+#define FORSYDE_RNG_SEED 0
+#endif
+
+//! The number of samples generated at once by the random sources
+#ifndef FORSYDE_RNG_BLOCK
+#define FORSYDE_RNG_BLOCK 256
+#endif
+
+namespace ForSyDe
+{
+
+//! A counter-based random number generator (Philox4x32-10)
+/*! The n-th output of a stream is a function of the seed, the stream
+ * number and n only. Hence the streams of different processes (e.g.,
+ * with the stream number derived from their names) are independent of
+ * the execution order, and jumping ahead in a stream is O(1).
+ */
+class counter_rng
+{
+public:
+    //! The constructor requires the seed and the stream number
+    counter_rng(std::uint64_t seed=FORSYDE_RNG_SEED, std::uint64_t stream=0)
+    {
+        set_seed(seed, stream);
+    }
+
+    //! Restarts the generator from the beginning of a stream
+    void set_seed(std::uint64_t seed, std::uint64_t stream=0)
+    {
+        key = seed;
+        this->stream = stream;
+        pos = 0;
+        cached = ~std::uint64_t(0);
+    }
+
+    //! Skips the next n outputs
+    void discard(std::uint64_t n) {pos += n;}
+
+    //! The number of outputs produced since the beginning of the stream
+    std::uint64_t position() const {return pos;}
+
+    //! Returns the next 64-bit output
+    std::uint64_t next()
+    {
+        const std::uint64_t blk = pos >> 1;
+        if (blk != cached)
+        {
+            philox(blk, out);
+            cached = blk;
+        }
+        return out[pos++ & 1];
+    }
+
+    //! Returns the next output as a double in [0,1)
+    double uniform() {return (next() >> 11) * 0x1.0p-53;}
+
+    //! Returns the next output as a double in (0,1]
+    double uniform_pos() {return ((next() >> 11) + 1) * 0x1.0p-53;}
+
+    //! Fills an array with doubles in [0,1)
+    void fill_uniform(double* res, size_t n)
+    {
+        size_t i = 0;
+        if (pos & 1 && n > 0) res[i++] = uniform();
+        std::uint64_t blk = pos >> 1;
+        for (; i+2<=n; i+=2, blk++)
+        {
+            std::uint64_t o[2];
+            philox(blk, o);
+            res[i] = (o[0] >> 11) * 0x1.0p-53;
+            res[i+1] = (o[1] >> 11) * 0x1.0p-53;
+        }
+        pos = blk << 1;
+        if (i < n) res[i] = uniform();
+    }
+
+    //! Derives a stream number from a name (e.g., of a process)
+    static std::uint64_t stream_of(const std::string& name)
+    {
+        std::uint64_t h = 14695981039346656037ULL;     // FNV-1a
+        for (unsigned char c : name)
+        {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h;
+    }
+
+private:
+    std::uint64_t key, stream, pos, cached;
+    std::uint64_t out[2];
+
+    //! Computes the two 64-bit outputs of a counter
+    void philox(std::uint64_t ctr, std::uint64_t* res) const
+    {
+        std::uint32_t c0 = (std::uint32_t)ctr, c1 = (std::uint32_t)(ctr >> 32),
+                      c2 = (std::uint32_t)stream, c3 = (std::uint32_t)(stream >> 32);
+        std::uint32_t k0 = (std::uint32_t)key, k1 = (std::uint32_t)(key >> 32);
+        for (int r=0; r<10; r++)
+        {
+            const std::uint64_t p0 = (std::uint64_t)0xD2511F53 * c0;
+            const std::uint64_t p1 = (std::uint64_t)0xCD9E8D57 * c2;
+            const std::uint32_t n0 = (std::uint32_t)(p1 >> 32) ^ c1 ^ k0;
+            const std::uint32_t n2 = (std::uint32_t)(p0 >> 32) ^ c3 ^ k1;
+            c1 = (std::uint32_t)p1;
+            c3 = (std::uint32_t)p0;
+            c0 = n0;
+            c2 = n2;
+            k0 += 0x9E3779B9;
+            k1 += 0xBB67AE85;
+        }
+        res[0] = (std::uint64_t)c1 << 32 | c0;
+        res[1] = (std::uint64_t)c3 << 32 | c2;
+    }
+};
+
+//! The uniform distribution in [lo,hi)
+struct uniform_dist
+{
+    typedef double value_type;
+    double lo, hi;
+
+    //! Fills a block of samples
+    void fill(counter_rng& rng, double* res, size_t n) const
+    {
+        rng.fill_uniform(res, n);
+        const double w = hi - lo;
+        for (size_t i=0; i<n; i++) res[i] = lo + w * res[i];
+    }
+};
+
+//! The normal distribution
+/*! The samples are generated in pairs by the Box-Muller transform, so
+ * that both variates of a pair are used.
+ */
+struct normal_dist
+{
+    typedef double value_type;
+    double mean, stddev;
+
+    //! Fills a block of samples
+    void fill(counter_rng& rng, double* res, size_t n) const
+    {
+        rng.fill_uniform(res, n);
+        size_t i = 0;
+        for (; i+2<=n; i+=2)
+        {
+            const double r = stddev * std::sqrt(-2.0 * std::log(1.0 - res[i]));
+            const double a = 2 * M_PI * res[i+1];
+            res[i] = mean + r * std::cos(a);
+            res[i+1] = mean + r * std::sin(a);
+        }
+        if (i < n)
+            res[i] = mean + stddev * std::sqrt(-2.0 * std::log(1.0 - res[i]))
+                          * std::cos(2 * M_PI * rng.uniform());
+    }
+};
+
+//! The Poisson distribution
+/*! The samples are generated by multiplying uniform numbers for small
+ * means, and by transformed rejection (PTRS) for the larger ones.
+ */
+struct poisson_dist
+{
+    typedef unsigned long value_type;
+    double lambda;
+
+    //! Fills a block of samples
+    void fill(counter_rng& rng, unsigned long* res, size_t n) const
+    {
+        if (lambda < 10)
+        {
+            const double l = std::exp(-lambda);
+            for (size_t i=0; i<n; i++)
+            {
+                unsigned long k = 0;
+                for (double p=rng.uniform(); p>l; p*=rng.uniform()) k++;
+                res[i] = k;
+            }
+            return;
+        }
+        const double slam = std::sqrt(lambda), loglam = std::log(lambda);
+        const double b = 0.931 + 2.53 * slam;
+        const double a = -0.059 + 0.02483 * b;
+        const double invalpha = 1.1239 + 1.1328 / (b - 3.4);
+        const double vr = 0.9277 - 3.6224 / (b - 2);
+        for (size_t i=0; i<n; i++)
+            while (1)
+            {
+                const double u = rng.uniform() - 0.5;
+                const double v = rng.uniform();
+                const double us = 0.5 - std::fabs(u);
+                const double k = std::floor((2 * a / us + b) * u + lambda + 0.43);
+                if (us >= 0.07 && v <= vr)
+                {
+                    res[i] = (unsigned long)k;
+                    break;
+                }
+                if (k < 0 || (us < 0.013 && v > us)) continue;
+                if (std::log(v) + std::log(invalpha) - std::log(a / (us * us) + b)
+                    <= -lambda + k * loglam - std::lgamma(k + 1))
+                {
+                    res[i] = (unsigned long)k;
+                    break;
+                }
+            }
+    }
+};
+
+}
+
+#endif
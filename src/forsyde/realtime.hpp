@@ -0,0 +1,226 @@
+/**********************************************************************
+    * realtime.hpp -- Pacing the simulated time to the wall clock     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Running a model in real time, e.g., when it is         *
+    *          connected to real equipment in the loop                *
+    *                                                                 *
+    * Usage:   Define FORSYDE_REALTIME to use it                      *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef REALTIME_HPP
+#define REALTIME_HPP
+
+/*! \file realtime.hpp
+ * \brief Implements a pacer which runs the simulation in real time
+ *
+ *  A simulation normally runs as fast as possible. A model which talks
+ * to real equipment (e.g., through the pipe or socket wrappers) needs its
+ * simulated time to follow the wall-clock time instead. The pacer
+ * advances the simulated time in quanta and, at the end of each quantum,
+ * holds the simulation until the wall-clock time of the quantum is due:
+ *
+ *     realtime_pacer pacer("pacer", sc_time(1, SC_MS));
+ *     pacer.set_priority(80);
+ *     pacer.set_cpus({3});
+ *     sc_start(sc_time(10, SC_SEC));
+ *     pacer.print_report();
+ *
+ *  The deadlines are kept on an absolute schedule on the monotonic
+ * clock, hence a late quantum does not shift the following ones. The
+ * pacer sleeps until shortly before a deadline and busy-waits for the
+ * rest of it, which trades a core for a low jitter. Each quantum which
+ * is resumed later than the tolerated lateness (e.g., because the model
+ * could not simulate it in time) is counted as a deadline miss.
+ *
+ *  On Linux the thread running the SystemC kernel can also be given a
+ * SCHED_FIFO priority, be pinned to a set of isolated cores and have its
+ * memory locked, which need the corresponding privileges (e.g.,
+ * CAP_SYS_NICE and CAP_IPC_LOCK). They are applied when the simulation
+ * starts, and a warning is reported if they can not be.
+ */
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#endif
+
+//! The default time before a deadline which is busy-waited, in microseconds
+#ifndef FORSYDE_RT_SPIN_US
+#define FORSYDE_RT_SPIN_US 200
+#endif
+
+//! The default lateness of a quantum not counted as a miss, in microseconds
+#ifndef FORSYDE_RT_TOLERANCE_US
+#define FORSYDE_RT_TOLERANCE_US 50
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Paces the simulated time to the wall-clock time
+class realtime_pacer : public sc_module
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    //! The constructor takes the quantum of the simulated time
+    /*! The simulated time runs speed times faster than the wall-clock
+     * time. Unless keep_alive is set, the pacer stops pacing when the
+     * rest of the model has no more activity, so that sc_start() still
+     * returns at the end of the simulation.
+     */
+    realtime_pacer(sc_module_name _name,    ///< The module name
+                   const sc_time& quantum,  ///< The simulated time of a quantum
+                   double speed=1.0,        ///< The ratio of the simulated to the wall-clock time
+                   bool keep_alive=false    ///< Keep pacing when the model is idle
+                  ) : sc_module(_name), quantum(quantum), speed(speed),
+                      keep_alive(keep_alive),
+                      spin(std::chrono::microseconds(FORSYDE_RT_SPIN_US)),
+                      tolerance(std::chrono::microseconds(FORSYDE_RT_TOLERANCE_US)),
+                      priority(0), lock_memory(false),
+                      quanta_n(0), misses_n(0), late_sum(0), late_sq_sum(0), late_max(0)
+    {
+        if (quantum == SC_ZERO_TIME || speed <= 0)
+            SC_REPORT_ERROR(name(), "the quantum and the speed should be positive");
+        SC_THREAD(worker);
+    }
+
+    //! Sets the time before each deadline which is busy-waited
+    void set_spin(const std::chrono::nanoseconds& t) {spin = t;}
+
+    //! Sets the lateness of a quantum which is not counted as a miss
+    void set_tolerance(const std::chrono::nanoseconds& t) {tolerance = t;}
+
+    //! Runs the kernel thread with a SCHED_FIFO priority (zero disables it)
+    void set_priority(int prio) {priority = prio;}
+
+    //! Pins the kernel thread to a set of cores
+    void set_cpus(const std::vector<int>& cpu_list) {cpus = cpu_list;}
+
+    //! Locks the current and future memory of the simulation in the RAM
+    void set_lock_memory(bool lock) {lock_memory = lock;}
+
+    //! The number of the paced quanta
+    unsigned long long quanta() const {return quanta_n;}
+
+    //! The number of the quanta resumed later than the tolerated lateness
+    unsigned long long misses() const {return misses_n;}
+
+    //! The largest lateness of a quantum in seconds
+    double max_lateness() const {return late_max;}
+
+    //! The mean lateness of the quanta in seconds
+    double mean_lateness() const {return quanta_n ? late_sum / quanta_n : 0;}
+
+    //! The standard deviation of the lateness of the quanta in seconds
+    double jitter() const
+    {
+        if (quanta_n == 0) return 0;
+        const double m = mean_lateness();
+        return std::sqrt(std::max(0.0, late_sq_sum / quanta_n - m*m));
+    }
+
+    //! Prints the deadline misses and the lateness of the quanta
+    void print_report(std::ostream& os=std::cout) const
+    {
+        os << name() << ": " << quanta() << " quanta of " << quantum << ", "
+           << misses() << " deadline misses" << std::endl;
+        os << "  lateness: " << mean_lateness()*1e6 << " us mean, "
+           << max_lateness()*1e6 << " us max, " << jitter()*1e6 << " us jitter"
+           << std::endl;
+    }
+
+    //! The pacer is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_realtime_pacer";}
+
+private:
+    SC_HAS_PROCESS(realtime_pacer);
+
+    sc_time quantum;
+    double speed;
+    bool keep_alive;
+    std::chrono::nanoseconds spin, tolerance;
+    int priority;
+    std::vector<int> cpus;
+    bool lock_memory;
+
+    // The statistics of the lateness of the quanta
+    unsigned long long quanta_n, misses_n;
+    double late_sum, late_sq_sum, late_max;
+
+    void start_of_simulation()
+    {
+#ifdef __linux__
+        if (lock_memory && mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+            SC_REPORT_WARNING(name(), "the memory could not be locked");
+        if (!cpus.empty())
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (auto c : cpus) CPU_SET(c, &set);
+            if (sched_setaffinity(0, sizeof(set), &set) != 0)
+                SC_REPORT_WARNING(name(), "the kernel thread could not be pinned to the cores");
+        }
+        if (priority > 0)
+        {
+            sched_param sp;
+            sp.sched_priority = priority;
+            if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) != 0)
+                SC_REPORT_WARNING(name(), "the real-time priority could not be set");
+        }
+#else
+        if (lock_memory || !cpus.empty() || priority > 0)
+            SC_REPORT_WARNING(name(), "the real-time scheduling is not supported");
+#endif
+    }
+
+    //! Holds the simulation until a deadline and records its lateness
+    void pace(const clock::time_point& deadline)
+    {
+        auto now = clock::now();
+        if (deadline - now > spin)
+        {
+            std::this_thread::sleep_until(deadline - spin);
+            now = clock::now();
+        }
+        while (now < deadline) now = clock::now();
+        const double late = std::chrono::duration<double>(now - deadline).count();
+        quanta_n++;
+        late_sum += late;
+        late_sq_sum += late * late;
+        late_max = std::max(late_max, late);
+        if (now - deadline > tolerance) misses_n++;
+    }
+
+    void worker()
+    {
+        const sc_time t0 = sc_time_stamp();
+        const clock::time_point origin = clock::now();
+        while (true)
+        {
+            if (!keep_alive && !sc_pending_activity()) return;
+            wait(quantum);
+            const double due = (sc_time_stamp() - t0).to_seconds() / speed;
+            pace(origin + std::chrono::duration_cast<clock::duration>(
+                              std::chrono::duration<double>(due)));
+        }
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,214 @@
+/**********************************************************************
+    * replay_log.hpp -- Record and replay of co-simulation wrappers   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Recording the values exchanged with external models    *
+    *          and replaying them without running the model           *
+    *                                                                 *
+    * Usage:   Define FORSYDE_WRAPPER_REPLAY to enable it in the      *
+    *          co-simulation wrappers                                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef REPLAY_LOG_HPP
+#define REPLAY_LOG_HPP
+
+/*! \file replay_log.hpp
+ * \brief Implements the record and replay logs of the wrappers
+ *
+ *  This file includes the binary log in which a co-simulation wrapper
+ * records the values sent to its external model and the ones received
+ * from it, in the same encoding as on the wrapper boundary (e.g., the
+ * lines of the text protocol or the frames of the binary protocol).
+ *
+ *  In the first run the log of each wrapper is recorded. In the later
+ * runs the external model is not started and its outputs are taken from
+ * the log instead, as long as the inputs of the wrapper are the same as
+ * the recorded ones. If they diverge, an error is reported, since the
+ * outputs of the model are not known. A log is only replayed if its
+ * recording has completed, i.e., the simulation of the recording has
+ * ended normally. To record the log again, it is removed, or the mode is
+ * set to REPLAY_RECORD.
+ *
+ *  The logs are stored in replay_log::directory() (FORSYDE_REPLAY_DIR
+ * by default) and named after the wrapper processes.
+ */
+
+#include <string>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+
+//! The default directory of the replay logs
+#ifndef FORSYDE_REPLAY_DIR
+#define FORSYDE_REPLAY_DIR "./"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The modes of the replay logs
+enum replay_mode
+{
+    REPLAY_OFF,     ///< the external models always run
+    REPLAY_RECORD,  ///< the logs are recorded
+    REPLAY_PLAY,    ///< the logs are replayed, an error is reported if one is missing
+    REPLAY_AUTO     ///< the existing logs are replayed and the missing ones recorded
+};
+
+//! The record and replay log of a wrapper
+/*! A log is a sequence of records, each of which holds the values sent
+ * to (inputs) or received from (outputs) the external model in one
+ * transaction, in the order they are exchanged.
+ */
+class replay_log
+{
+public:
+    //! The mode of all the logs
+    static replay_mode& mode()
+    {
+        static replay_mode m = REPLAY_AUTO;
+        return m;
+    }
+
+    //! The directory of all the logs, ending with a separator
+    static std::string& directory()
+    {
+        static std::string dir = FORSYDE_REPLAY_DIR;
+        return dir;
+    }
+
+    replay_log() : state(REPLAY_OFF), count(0) {}
+
+    ~replay_log() {close();}
+
+    //! Opens the log of a wrapper
+    /*! It returns true if the log is replayed, in which case the wrapper
+     * should not start its external model.
+     */
+    bool open(const std::string& pName)
+    {
+        file_name = directory() + pName + ".replay";
+        count = 0;
+        state = mode();
+        if (state == REPLAY_OFF) return false;
+        if (state != REPLAY_RECORD)
+        {
+            in.open(file_name, std::ios::binary);
+            char magic[sizeof(MAGIC)] = {};
+            if (in.is_open() && in.read(magic, sizeof(magic)) &&
+                std::string(magic, sizeof(magic)) == std::string(MAGIC, sizeof(MAGIC)))
+            {
+                state = REPLAY_PLAY;
+                return true;
+            }
+            if (state == REPLAY_PLAY)
+                SC_REPORT_ERROR(file_name.c_str(), "the replay log could not be opened");
+            in.close();
+        }
+        // the log is written to a temporary file until it is complete
+        state = REPLAY_RECORD;
+        out.open(file_name + ".tmp", std::ios::binary | std::ios::trunc);
+        if (!out.is_open())
+        {
+            SC_REPORT_WARNING(file_name.c_str(), "the replay log could not be created");
+            state = REPLAY_OFF;
+            return false;
+        }
+        out.write(MAGIC, sizeof(MAGIC));
+        return false;
+    }
+
+    //! Checks if the log is replayed
+    bool replaying() const {return state == REPLAY_PLAY;}
+
+    //! Records or checks the values sent to the model in a transaction
+    /*! It returns true if the values should be sent to the model, i.e.,
+     * the log is not replayed. If the replayed log has ended (the model
+     * had terminated at this point of the recording), the caller is
+     * suspended.
+     */
+    bool send(const std::string& vals)
+    {
+        if (state == REPLAY_RECORD) write_record('I', vals);
+        if (state != REPLAY_PLAY) return true;
+        std::string rec;
+        if (!read_record('I', rec)) wait();
+        if (rec != vals)
+            SC_REPORT_ERROR(file_name.c_str(), ("the inputs diverge from the recording in transaction "
+                + std::to_string(count) + "; remove the log to record it again").c_str());
+        return false;
+    }
+
+    //! Records the values received from the model in a transaction
+    void record(const std::string& vals)
+    {
+        if (state == REPLAY_RECORD) write_record('O', vals);
+    }
+
+    //! Returns the values received from the model in the recording
+    /*! If the log has ended, the caller is suspended.
+     */
+    std::string replay()
+    {
+        std::string vals;
+        if (!read_record('O', vals)) wait();
+        return vals;
+    }
+
+    //! Completes the recording of the log
+    void close()
+    {
+        if (state == REPLAY_RECORD && out.is_open())
+        {
+            out.close();
+            if (std::rename((file_name + ".tmp").c_str(), file_name.c_str()) != 0)
+                SC_REPORT_WARNING(file_name.c_str(), "the replay log could not be completed");
+        }
+        in.close();
+        state = REPLAY_OFF;
+    }
+
+private:
+    static constexpr char MAGIC[8] = {'F','S','D','R','P','L','Y','1'};
+
+    replay_mode state;
+    std::string file_name;
+    std::ifstream in;
+    std::ofstream out;
+    // the number of transactions so far
+    unsigned long long count;
+
+    void write_record(char kind, const std::string& vals)
+    {
+        const std::uint32_t len = vals.size();
+        out.put(kind);
+        out.write(reinterpret_cast<const char*>(&len), sizeof(len));
+        out.write(vals.data(), len);
+        if (kind == 'I') count++;
+    }
+
+    bool read_record(char kind, std::string& vals)
+    {
+        std::uint32_t len;
+        const int k = in.get();
+        if (k == std::char_traits<char>::eof() ||
+            !in.read(reinterpret_cast<char*>(&len), sizeof(len)))
+            return false;
+        if (k != kind)
+            SC_REPORT_ERROR(file_name.c_str(), "the replay log does not match the wrapper");
+        vals.resize(len);
+        if (!in.read(&vals[0], len))
+            SC_REPORT_ERROR(file_name.c_str(), "the replay log is truncated");
+        if (kind == 'I') count++;
+        return true;
+    }
+};
+
+}
+
+#endif
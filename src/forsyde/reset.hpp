@@ -0,0 +1,128 @@
+/**********************************************************************
+    * reset.hpp -- Resetting a model to simulate it again             *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Running several simulations of a model in the same     *
+    *          process without elaborating it again                   *
+    *                                                                 *
+    * Usage:   Define FORSYDE_RESET to use it                         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef RESET_HPP
+#define RESET_HPP
+
+/*! \file reset.hpp
+ * \brief Implements resetting the models between simulation runs
+ *
+ *  This file includes the functions which bring a model back to the
+ * state right after its init stages, so that it can be simulated again
+ * in the same process (e.g., for the runs of a Monte-Carlo experiment),
+ * since SystemC can not elaborate a model twice:
+ *
+ *     top t("top");
+ *     std::vector<double> res(runs);
+ *     ForSyDe::run_batch(runs,
+ *                        [&](size_t i){t.gain->set_value(draw());},
+ *                        [&](size_t i){res[i] = t.result();});
+ *
+ *  When the model is reset, the signals are emptied and each process is
+ * restarted with its reset stage (see process::reset()), which runs the
+ * clean and init stages again unless the process keeps its resources
+ * (e.g., the FMU wrappers reset their instances using fmi2Reset instead
+ * of loading them again). The kernel time can not be rewound, hence the
+ * timed processes count the time from the last reset (see model_time()).
+ * The profiling information and the statistics of the signals are
+ * accumulated over the runs, while the sinks which write to files (e.g.,
+ * the CT tracers) write them again in each run.
+ *
+ *  The processes driven by an executor (e.g., a static scheduler) can
+ * not be reset. A run which stops the simulation using sc_stop ends the
+ * batch, since the simulation can not continue after it.
+ */
+
+#include <vector>
+#include <functional>
+
+#include "abssemantics.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Helper functions of resetting the models
+namespace reset_detail
+{
+
+//! Calls a function for all the processes and resettable signals of the model
+template <typename PF, typename SF>
+void for_each_object(const std::vector<sc_object*>& objs, PF&& pf, SF&& sf)
+{
+    for (auto obj : objs)
+    {
+        if (auto p = dynamic_cast<process*>(obj))
+            pf(p);
+        else if (auto c = dynamic_cast<reset_channel*>(obj))
+            sf(c);
+        for_each_object(obj->get_child_objects(), pf, sf);
+    }
+}
+
+}
+
+//! Resets the model to the state right after its init stages
+/*! It should be called while the simulation is paused, i.e., after
+ * sc_start returns. The signals are emptied first and then the processes
+ * are restarted, which may run their reset stages right away. The
+ * parameters of the next run should therefore be set before.
+ */
+inline void reset_model()
+{
+    using namespace reset_detail;
+    std::vector<process*> procs;
+    for_each_object(sc_get_top_level_objects(),
+        [&](process* p) {procs.push_back(p);},
+        [](reset_channel* c) {c->clear_contents();}
+    );
+    model_epoch() = sc_time_stamp();
+    for (auto p : procs) p->restart();
+}
+
+//! Simulates a model a number of times back-to-back
+/*! Before each run the setup function is called with the index of the
+ * run (e.g., to set the parameters of the run), and the model is reset
+ * if it is not the first run. Each run simulates the given time, or
+ * until there are no more events if it is zero, and then the collect
+ * function is called with the index of the run. It returns the number of
+ * the completed runs.
+ */
+inline size_t run_batch(size_t runs,
+                        const std::function<void(size_t)>& setup,
+                        const std::function<void(size_t)>& collect,
+                        const sc_time& duration=SC_ZERO_TIME)
+{
+    for (size_t i=0; i<runs; i++)
+    {
+        if (setup) setup(i);
+        if (i > 0) reset_model();
+        if (duration == SC_ZERO_TIME)
+            sc_start();
+        else
+            sc_start(duration);
+        if (collect) collect(i);
+        if (sc_get_status() == SC_STOPPED)
+        {
+            if (i+1 < runs)
+                SC_REPORT_WARNING("run_batch", "the simulation is stopped, the rest of the runs are skipped");
+            return i+1;
+        }
+    }
+    return runs;
+}
+
+}
+
+#endif
@@ -69,12 +69,12 @@ inline kernel<T0,TC,T1>* make_kernel(const std::string& pName,
  * It also removes boilerplate code by using type-inference feature of
  * C++ and automatic binding to the input FIFOs.
  */
-template <typename... TOs, typename TC, typename... TIs,
+template <typename F, typename... TOs, typename TC, typename... TIs,
            template <class> class CIf,
            template <class> class... IIf,
            template <class> class... OIf>
 inline kernelMN<std::tuple<TOs...>,TC,std::tuple<TIs...>>* make_kernelMN(const std::string& pName,
-    const typename kernelMN<std::tuple<TOs...>,TC,std::tuple<TIs...>>::functype& _func,
+    const F& _func,
     const typename kernelMN<std::tuple<TOs...>,TC,std::tuple<TIs...>>::scenario_table_type& _scenario_table,
 #ifdef FORSYDE_SELF_REPORTING
     FILE** report_pipe,   ///< the report named pipe
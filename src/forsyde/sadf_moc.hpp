@@ -27,6 +27,7 @@
 #include "sadf_process.hpp"
 #include "sadf_process_constructors.hpp"
 #include "sadf_helpers.hpp"
+#include "sadf_scheduler.hpp"
 
 namespace ForSyDe
 {
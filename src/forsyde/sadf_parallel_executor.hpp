@@ -0,0 +1,302 @@
+/**********************************************************************
+    * sadf_parallel_executor.hpp -- Multi-threaded execution of SADF  *
+    *                               process networks                  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Firing the independent kernels of the scenarios of an  *
+    *          SADF process network on several cores                  *
+    *                                                                 *
+    * Usage:   Define FORSYDE_MULTITHREADED and link with the         *
+    *          threading library (e.g., -pthread)                     *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SADF_PARALLEL_EXECUTOR_HPP
+#define SADF_PARALLEL_EXECUTOR_HPP
+
+/*! \file sadf_parallel_executor.hpp
+ * \brief Implements a multi-threaded scenario-aware SADF executor
+ *
+ *  This file includes an opt-in executor which fires the kernels
+ * activated by the detector of an SADF process network in each
+ * iteration on a work-stealing thread pool, as far as the dependencies
+ * of their firings allow.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+
+#include "sadf_scheduler.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace ForSyDe
+{
+
+namespace SADF
+{
+
+using namespace sc_core;
+
+//! A multi-threaded scenario-aware SADF graph executor
+/*! It works as the scenario scheduler, except that the firings of the
+ * kernels in an iteration are not fired in the order of the schedule,
+ * but as a graph of dependencies built from the schedule the first time
+ * it occurs:
+ *  - the firings of a kernel follow each other, since they share its
+ *    state and its control tokens,
+ *  - a firing follows the producers of the tokens it consumes, and
+ *  - a firing follows the consumers which free the space it fills in a
+ *    buffer, which keeps the occupancies within the sizes of the buffers.
+ *
+ * The independent firings run on a work-stealing thread pool. Each
+ * internal channel has a single producer and a single consumer whose
+ * firings keep their order, hence the tokens are the same as with the
+ * scenario scheduler whatever the interleaving of the threads is.
+ *
+ *  The kernels bound to the channels connecting the graph to the rest of
+ * the model are fired in the SystemC thread of the executor, since
+ * these channels keep their sc_fifo semantics. Hence the firings of an
+ * iteration are run in phases: the firings on the pool which do not
+ * depend on a pending kernel of the boundary, and then the firings of
+ * the boundary kernels which became ready, in the order of the schedule.
+ * The kernels fired on the pool should not call the SystemC kernel.
+ */
+class parallel_scenario_scheduler : public scenario_scheduler
+{
+public:
+    //! The constructor requires the module name and the root of the subgraph
+    /*! All the SADF detectors and kernels below the root module in the
+     * hierarchy are scheduled, unless some processes are added
+     * explicitly using add().
+     */
+    parallel_scenario_scheduler(sc_module_name _name,  ///< The module name
+                                sc_module* root=NULL,  ///< The root of the subgraph
+                                unsigned nthreads=0    ///< The pool size (0 for the number of cores)
+                                ) : scenario_scheduler(_name, root), nthreads(nthreads) {}
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_parallel_scenario_scheduler";}
+
+private:
+    //! The dependencies of the firings of an iteration
+    struct plan
+    {
+        //! The process of each firing, in the order of the schedule
+        std::vector<ForSyDe::process*> procs;
+        //! The firings enabled by each firing
+        std::vector<std::vector<size_t>> succs;
+        //! The number of the firings each firing depends on
+        std::vector<size_t> npreds;
+        //! If a firing is fired in the SystemC thread
+        std::vector<char> serial;
+
+        //! A batch of firings on the pool followed by the ready serial ones
+        struct phase
+        {
+            std::vector<size_t> roots;      // the initially ready firings
+            size_t total;                   // the firings of the batch
+            std::vector<size_t> serial;     // then fired in the SystemC thread
+        };
+        std::vector<phase> phases;
+    };
+
+    unsigned nthreads;
+    std::unique_ptr<work_stealing_pool> pool;
+    // the plans of the schedules built so far
+    std::map<const std::vector<sched_entry>*, plan> plans;
+    // the index of each process and if it is fired in the SystemC thread
+    std::map<ForSyDe::process*, size_t> index;
+    std::vector<char> boundary;
+    std::unique_ptr<std::atomic<size_t>[]> pending;
+    size_t pending_size = 0;
+
+    //! Finds the kernels bound to the boundary channels
+    void classify()
+    {
+        std::set<sc_interface*> internal;
+        for (auto& e : edges) internal.insert(dynamic_cast<sc_interface*>(e.chan));
+        boundary.assign(actors.size(), 0);
+        for (size_t a=0; a<actors.size(); a++)
+        {
+            index[actors[a].proc] = a;
+            auto sa = actors[a].sa;
+            for (auto& p : sa->in_ports)
+                for (auto ch : p.port->bound_channels())
+                    boundary[a] |= !internal.count(ch);
+            for (auto& p : sa->out_ports)
+                for (auto ch : p.port->bound_channels())
+                    boundary[a] |= !internal.count(ch);
+        }
+    }
+
+    //! Builds the dependencies of the firings of the current iteration
+    plan build_plan(const std::vector<sched_entry>& sched)
+    {
+        plan pl;
+        const size_t none = size_t(-1);
+        std::vector<size_t> last(actors.size(), none), next(actors.size(), 0);
+        // the tokens produced and consumed in the iteration, and the
+        // firings which produced or consumed them (by the end indices)
+        std::vector<size_t> produced(edges.size(), 0), consumed(edges.size(), 0);
+        std::vector<std::vector<std::pair<size_t,size_t>>> prods(edges.size()), conss(edges.size());
+        std::vector<std::set<size_t>> preds;
+        for (auto& en : sched)
+        {
+            const size_t a = index[en.first];
+            auto sa = actors[a].sa;
+            for (size_t k=0; k<en.second; k++)
+            {
+                const size_t f = pl.procs.size();
+                const size_t s = scen[a][next[a]++];
+                pl.procs.push_back(en.first);
+                pl.serial.push_back(boundary[a]);
+                preds.emplace_back();
+                if (last[a] != none) preds[f].insert(last[a]);
+                last[a] = f;
+                for (auto e : ins[a])
+                {
+                    const size_t r = edges[e].dport == control ? 1 :
+                                     rate(sa->in_ports[edges[e].dport], s);
+                    if (r == 0) continue;
+                    consumed[e] += r;
+                    // the producer of the last consumed token, unless it is an initial one
+                    if (consumed[e] > key[e])
+                    {
+                        const size_t idx = consumed[e] - 1 - key[e];
+                        auto it = std::lower_bound(prods[e].begin(), prods[e].end(),
+                                    std::make_pair(idx, size_t(0)));
+                        if (it != prods[e].end()) preds[f].insert(it->second);
+                    }
+                    conss[e].push_back(std::make_pair(consumed[e], f));
+                }
+                for (auto e : outs[a])
+                {
+                    const size_t r = rate(sa->out_ports[edges[e].sport], s);
+                    if (r == 0) continue;
+                    // the consumer which leaves room for the last produced token
+                    const size_t end = key[e] + produced[e] + r;
+                    if (end > edges[e].cap)
+                    {
+                        auto it = std::lower_bound(conss[e].begin(), conss[e].end(),
+                                    std::make_pair(end - edges[e].cap, size_t(0)));
+                        if (it != conss[e].end()) preds[f].insert(it->second);
+                    }
+                    produced[e] += r;
+                    prods[e].push_back(std::make_pair(produced[e]-1, f));
+                }
+            }
+        }
+        const size_t n = pl.procs.size();
+        pl.succs.resize(n);
+        pl.npreds.assign(n, 0);
+        for (size_t f=0; f<n; f++)
+        {
+            preds[f].erase(f);
+            pl.npreds[f] = preds[f].size();
+            for (auto p : preds[f]) pl.succs[p].push_back(f);
+        }
+        // split the firings into phases; the dependencies point to the
+        // earlier firings, hence the order of the schedule is topological
+        std::vector<size_t> left(pl.npreds);
+        std::vector<char> done(n, 0), blocked(n);
+        size_t remaining = n;
+        while (remaining > 0)
+        {
+            plan::phase ph;
+            std::fill(blocked.begin(), blocked.end(), 0);
+            for (size_t f=0; f<n; f++)
+            {
+                if (!done[f] && pl.serial[f]) blocked[f] = 1;
+                if (blocked[f])
+                    for (auto s : pl.succs[f]) blocked[s] = 1;
+            }
+            std::vector<size_t> batch;
+            for (size_t f=0; f<n; f++)
+            {
+                if (done[f] || blocked[f]) continue;
+                if (left[f] == 0) ph.roots.push_back(f);
+                batch.push_back(f);
+            }
+            ph.total = batch.size();
+            for (auto f : batch)
+            {
+                done[f] = 1;
+                for (auto s : pl.succs[f]) left[s]--;
+            }
+            for (size_t f=0; f<n; f++)
+            {
+                if (done[f] || !pl.serial[f] || left[f] != 0) continue;
+                ph.serial.push_back(f);
+                done[f] = 1;
+                for (auto s : pl.succs[f]) left[s]--;
+            }
+            if (ph.total == 0 && ph.serial.empty())
+                SC_REPORT_ERROR(name(), "the firings of the SADF graph have cyclic dependencies");
+            remaining -= ph.total + ph.serial.size();
+            pl.phases.push_back(std::move(ph));
+        }
+        return pl;
+    }
+
+    //! Fires the kernels of an iteration on the thread pool
+    void run(const std::vector<sched_entry>& sched)
+    {
+        if (!pool)
+        {
+            pool.reset(new work_stealing_pool(nthreads));
+            classify();
+        }
+        auto it = plans.find(&sched);
+        if (it == plans.end()) it = plans.emplace(&sched, build_plan(sched)).first;
+        const plan& pl = it->second;
+        const size_t n = pl.procs.size();
+        if (n > pending_size)
+        {
+            pending.reset(new std::atomic<size_t>[n]);
+            pending_size = n;
+        }
+        for (size_t f=0; f<n; f++)
+            pending[f].store(pl.npreds[f], std::memory_order_relaxed);
+        auto body = [this, &pl](size_t f, unsigned w)
+        {
+            pl.procs[f]->ext_fire();
+            for (auto s : pl.succs[f])
+                if (pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1 && !pl.serial[s])
+                    pool->push(w, s);
+        };
+        for (auto& ph : pl.phases)
+        {
+            pool->run(ph.roots, ph.total, body);
+            for (auto f : ph.serial)
+            {
+                pl.procs[f]->ext_fire();
+                for (auto s : pl.succs[f])
+                    pending[s].fetch_sub(1, std::memory_order_acq_rel);
+            }
+        }
+    }
+};
+
+//! Helper function to construct a parallel scenario scheduler
+template <class... Ps>
+inline parallel_scenario_scheduler* make_parallel_scenario_scheduler(
+    const std::string& pName,                      ///< the executor name
+    unsigned nthreads,                             ///< the pool size (0 for the number of cores)
+    Ps*... procs                                   ///< the detector and the kernels
+    )
+{
+    auto e = new parallel_scenario_scheduler(pName.c_str(), NULL, nthreads);
+    (e->add(procs), ...);
+    return e;
+}
+
+}
+}
+
+#endif
@@ -20,6 +20,11 @@
  * abstract base process used in the SADF MoC.
  */
 
+#include <map>
+#include <vector>
+#include <type_traits>
+#include <algorithm>
+
 #include "abssemantics.hpp"
 
 namespace ForSyDe
@@ -93,6 +98,136 @@ using out_port = SADF_out<T>;
 //! Abstract semantics of a process in the SY MoC
 typedef ForSyDe::process SADF_process;
 
+//! A flat scenario table used by the detectors and kernels
+/*! The entries of a scenario table are remapped at elaboration to dense
+ * IDs, in the order of the scenarios, and stored in contiguous arrays.
+ * If the scenarios are integers or enumerations which span a small range,
+ * a scenario is looked up by indexing, otherwise by a binary search which
+ * first checks the last found scenario. Similar to std::map::operator[],
+ * an unknown scenario has an entry with all the rates zero, but it is not
+ * inserted into the table.
+ */
+template <typename TS, typename V>
+class scenario_lookup
+{
+public:
+    scenario_lookup(const std::map<TS,V>& table) : empty(), base(0), last(0)
+    {
+        keys.reserve(table.size());
+        vals.reserve(table.size());
+        for (auto& e : table)
+        {
+            keys.push_back(e.first);
+            vals.push_back(e.second);
+        }
+        if constexpr (std::is_integral<TS>::value || std::is_enum<TS>::value)
+        {
+            if (keys.empty()) return;
+            base = static_cast<long long>(keys.front());
+            const size_t span = static_cast<long long>(keys.back()) - base + 1;
+            if (span > 2*keys.size() + 16) return;
+            ids.assign(span, keys.size());
+            for (size_t i=0; i<keys.size(); i++)
+                ids[static_cast<long long>(keys[i]) - base] = i;
+        }
+    }
+
+    //! The dense ID of a scenario, or the number of scenarios if it is unknown
+    size_t id(const TS& sc) const
+    {
+        if constexpr (std::is_integral<TS>::value || std::is_enum<TS>::value)
+        {
+            if (!ids.empty())
+            {
+                const long long off = static_cast<long long>(sc) - base;
+                if (off < 0 || off >= (long long)ids.size()) return keys.size();
+                return ids[off];
+            }
+        }
+        if (last < keys.size() && !(keys[last] < sc) && !(sc < keys[last]))
+            return last;
+        auto it = std::lower_bound(keys.begin(), keys.end(), sc);
+        if (it == keys.end() || sc < *it) return keys.size();
+        return last = it - keys.begin();
+    }
+
+    //! The entry of a scenario
+    const V& operator[](const TS& sc) const
+    {
+        const size_t i = id(sc);
+        return i < vals.size() ? vals[i] : empty;
+    }
+
+    //! The entries of all the scenarios, indexed by their IDs
+    const std::vector<V>& entries() const {return vals;}
+
+private:
+    std::vector<TS> keys;
+    std::vector<V> vals;
+    V empty;
+    // the IDs indexed by the integer scenarios, if they are dense
+    std::vector<size_t> ids;
+    long long base;
+    mutable size_t last;
+};
+
+//! Rate information of an SADF process port
+/*! It is used by the scenario scheduler to build the schedules of the
+ * scenarios.
+ */
+struct scenario_port
+{
+    channel_port* port;         ///< the port
+    //! Tokens consumed/produced in each firing, indexed by the scenario IDs
+    std::vector<size_t> rates;
+};
+
+//! The interface of the SADF processes which register their port rates
+/*! The detectors and kernels register the rates of their data ports in
+ * all of their scenarios, so that they can be scheduled statically per
+ * scenario.
+ */
+class scenario_actor
+{
+public:
+    //! Rates of the data input ports
+    std::vector<scenario_port> in_ports;
+    //! Rates of the output ports (the control outputs of the detectors)
+    std::vector<scenario_port> out_ports;
+
+    //! The channel bound to the control port, or NULL for the detectors
+    virtual sc_interface* control_channel() = 0;
+
+    //! The scenario IDs of the next n tokens of the control channel
+    /*! It is only valid if the control channel is a static buffer.
+     */
+    virtual void peek_scenarios(size_t n, std::vector<size_t>& ids) = 0;
+
+protected:
+    //! Registers the rates of a port in all the scenarios
+    template <class PortType, class RateFunc>
+    static void add_scenario_port(std::vector<scenario_port>& ports,
+                                  PortType& port, size_t scenarios,
+                                  RateFunc rate)
+    {
+        scenario_port sp{&port, std::vector<size_t>(scenarios)};
+        for (size_t s=0; s<scenarios; s++) sp.rates[s] = rate(s);
+        ports.push_back(sp);
+    }
+
+    //! Looks up the scenario IDs of the tokens in a control channel
+    template <typename TC, typename V>
+    static void peek_control(sc_interface* chan,
+                             const scenario_lookup<TC,V>& table,
+                             size_t n, std::vector<size_t>& ids)
+    {
+        auto ch = dynamic_cast<ForSyDe::signal<TC,TC>*>(chan);
+        if (ch == NULL)
+            SC_REPORT_ERROR("SADF", "the control channel can not be peeked");
+        for (size_t k=0; k<n; k++) ids.push_back(table.id(ch->peek(k)));
+    }
+};
+
 }
 }
 
@@ -47,7 +47,7 @@ using namespace sc_core;
  * data-types.
  */
 template <typename T0, typename TC, typename T1>
-class kernel : public SADF_process
+class kernel : public SADF_process, public scenario_actor
 {
 public:
     SADF_in<TC>  cport1;       ///< port for the control channel
@@ -77,19 +77,27 @@ public:
          ) : SADF_process(_name), cport1("cport1"), iport1("iport1"), oport1("oport1"),
             _func(_func), scenario_table(scenario_table)
     {
+        const auto& rates = this->scenario_table.entries();
+        add_scenario_port(in_ports, iport1, rates.size(),
+            [&rates](size_t s){return std::get<0>(rates[s]);});
+        add_scenario_port(out_ports, oport1, rates.size(),
+            [&rates](size_t s){return std::get<1>(rates[s]);});
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << scenario_table;
-        arg_vec.push_back(std::make_tuple("scenario_table",ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("scenario_table", scenario_table);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SADF::kernel";}
 
+    sc_interface* control_channel() {return cport1[0];}
+
+    void peek_scenarios(size_t n, std::vector<size_t>& ids)
+    {
+        peek_control(cport1[0], scenario_table, n, ids);
+    }
+
 private:    
     // Control, input, and output variables
     std::vector<T0> o1vals;
@@ -100,12 +108,18 @@ private:
     functype _func;
 
     //! The table of kernel's scenarios to be passed to the process constructor
-    scenario_table_type scenario_table;
+    scenario_lookup<TC,typename scenario_table_type::mapped_type> scenario_table;
     
     //Implementing the abstract semantics
     void init()
     {
         cval1 = new TC;
+        // the buffers are allocated once for the maximum rates
+        for (auto& rates : scenario_table.entries())
+        {
+            i1vals.reserve(std::get<0>(rates));
+            o1vals.reserve(std::get<1>(rates));
+        }
     }
     
     void prep()
@@ -115,16 +129,22 @@ private:
         
         // Set the consumption and production rates from the kernel's scenario table
         // (consumption rate, production rate)
-        auto cons_rate = std::get<0>(scenario_table[*cval1]);
-        auto prod_rate = std::get<1>(scenario_table[*cval1]);
+        const auto& rates = scenario_table[*cval1];
+        auto cons_rate = std::get<0>(rates);
+        auto prod_rate = std::get<1>(rates);
 
         // Resizing the input and output vectors according to the consumption and production rates
+#ifdef FORSYDE_TOKEN_POOL
+        // the vector tokens take their buffers from the pools
+        resize_tokens(i1vals, cons_rate);
+        resize_tokens(o1vals, prod_rate);
+#else
         i1vals.resize(cons_rate);
         o1vals.resize(prod_rate);
+#endif
 
         // Reading the input port
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
+        iport1.read_n(i1vals, i1vals.size());
     }
     
     void exec()
@@ -136,8 +156,13 @@ private:
     void prod()
     {
         write_vec_multiport(oport1, o1vals);
+#ifdef FORSYDE_TOKEN_POOL
+        recycle_tokens(o1vals);
+        recycle_tokens(i1vals);
+#else
         o1vals.clear();
         i1vals.clear();
+#endif
     }
     
     void clean()
@@ -163,7 +188,7 @@ private:
  * data-types.
  */
 template <typename T0, typename TC, typename T1, typename T2>
-class kernel2 : public SADF_process
+class kernel2 : public SADF_process, public scenario_actor
 {
 public:
     SADF_in<TC>  cport1;       ///< port for the control channel
@@ -195,19 +220,29 @@ public:
          ) : SADF_process(_name), cport1("cport1"), iport1("iport1"), iport2("iport2"),
             oport1("oport1"), _func(_func), scenario_table(scenario_table)
     {
+        const auto& rates = this->scenario_table.entries();
+        add_scenario_port(in_ports, iport1, rates.size(),
+            [&rates](size_t s){return std::get<0>(rates[s])[0];});
+        add_scenario_port(in_ports, iport2, rates.size(),
+            [&rates](size_t s){return std::get<0>(rates[s])[1];});
+        add_scenario_port(out_ports, oport1, rates.size(),
+            [&rates](size_t s){return std::get<1>(rates[s]);});
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << scenario_table;
-        arg_vec.push_back(std::make_tuple("scenario_table",ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("scenario_table", scenario_table);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SADF::kernel2";}
 
+    sc_interface* control_channel() {return cport1[0];}
+
+    void peek_scenarios(size_t n, std::vector<size_t>& ids)
+    {
+        peek_control(cport1[0], scenario_table, n, ids);
+    }
+
 private:    
     // Control, input, and output variables
     std::vector<T0> o1vals;
@@ -219,12 +254,19 @@ private:
     functype _func;
 
     //! The table of kernel's scenarios to be passed to the process constructor
-    scenario_table_type scenario_table;
+    scenario_lookup<TC,typename scenario_table_type::mapped_type> scenario_table;
     
     //Implementing the abstract semantics
     void init()
     {
         cval1 = new TC;
+        // the buffers are allocated once for the maximum rates
+        for (auto& rates : scenario_table.entries())
+        {
+            i1vals.reserve(std::get<0>(rates)[0]);
+            i2vals.reserve(std::get<0>(rates)[1]);
+            o1vals.reserve(std::get<1>(rates));
+        }
     }
     
     void prep()
@@ -234,20 +276,26 @@ private:
         
         // Set the consumption and production rates from the kernel's scenario table
         // (consumption rate, production rate)
-        auto cons_rate1 = std::get<0>(scenario_table[*cval1])[0];
-        auto cons_rate2 = std::get<0>(scenario_table[*cval1])[1];
-        auto prod_rate = std::get<1>(scenario_table[*cval1]);
+        const auto& rates = scenario_table[*cval1];
+        auto cons_rate1 = std::get<0>(rates)[0];
+        auto cons_rate2 = std::get<0>(rates)[1];
+        auto prod_rate = std::get<1>(rates);
 
         // Resizing the input and output vectors according to the consumption and production rates
+#ifdef FORSYDE_TOKEN_POOL
+        // the vector tokens take their buffers from the pools
+        resize_tokens(i1vals, cons_rate1);
+        resize_tokens(i2vals, cons_rate2);
+        resize_tokens(o1vals, prod_rate);
+#else
         i1vals.resize(cons_rate1);
         i2vals.resize(cons_rate2);
         o1vals.resize(prod_rate);
+#endif
 
         // Reading the input ports
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
     }
     
     void exec()
@@ -259,9 +307,15 @@ private:
     void prod()
     {
         write_vec_multiport(oport1, o1vals);
+#ifdef FORSYDE_TOKEN_POOL
+        recycle_tokens(o1vals);
+        recycle_tokens(i1vals);
+        recycle_tokens(i2vals);
+#else
         o1vals.clear();
         i1vals.clear();
         i2vals.clear();
+#endif
     }
     
     void clean()
@@ -288,7 +342,7 @@ private:
 template<typename TO_tuple, typename TC, typename TI_tuple> class kernelMN;
 
 template <typename... TOs, typename TC, typename... TIs>
-class kernelMN<std::tuple<TOs...>,TC,std::tuple<TIs...>> : public SADF_process
+class kernelMN<std::tuple<TOs...>,TC,std::tuple<TIs...>> : public SADF_process, public scenario_actor
 {
 public:
     SADF_in<TC>                 cport1;///< port for the control channel
@@ -311,6 +365,10 @@ public:
                                 const std::tuple<std::vector<TIs>...>&
                             )> functype;
 
+    //! Type of the function which takes the outputs, the control value and the inputs as separate arguments
+    typedef std::function<void(std::vector<TOs>&..., const TC&,
+                               const std::vector<TIs>&...)> vfunctype;
+
     //! The constructor requires the module name, the kernel function, and the scenario table
     /*! It creates an SC_THREAD which according to the current scenario, reads data from its input ports,
      * applies the user-imlpemented function to them and writes the
@@ -327,29 +385,48 @@ public:
         , report_pipe(_report_pipe)
 #endif
     {
-#ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << scenario_table;
-        arg_vec.push_back(std::make_tuple("scenario_table",ss.str()));
+        add_rates(scenario_table);
+    }
+
+    //! The constructor with a kernel function taking separate arguments
+    /*! The token vectors are passed to the function directly from the
+     * in-object buffers of the process, without building the tuples.
+     */
+    kernelMN(sc_module_name _name,      ///< process name
+          const vfunctype& _vfunc,      ///< function to be passed
+          const scenario_table_type& scenario_table///< the kernel scenario table
+#ifdef FORSYDE_SELF_REPORTING
+        , FILE** _report_pipe   ///< the report named pipe
+#endif
+          ) : SADF_process(_name), _vfunc(_vfunc), scenario_table(scenario_table)
+#ifdef FORSYDE_SELF_REPORTING
+        , report_pipe(_report_pipe)
 #endif
+    {
+        add_rates(scenario_table);
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SADF::kernelMN";}
+
+    sc_interface* control_channel() {return cport1[0];}
+
+    void peek_scenarios(size_t n, std::vector<size_t>& ids)
+    {
+        peek_control(cport1[0], scenario_table, n, ids);
+    }
 private:
     // Control, input and output variables
     std::tuple<std::vector<TOs>...> ovals;
     std::tuple<std::vector<TIs>...> ivals;
-    TC* cval1;
+    TC cval1;
     
     //! The function passed to the process constructor
     functype _func;
+    vfunctype _vfunc;
 
     //! The table of kernel's scenarios to be passed to the process constructor
-    scenario_table_type scenario_table;
+    scenario_lookup<TC,typename scenario_table_type::mapped_type> scenario_table;
 
 #ifdef FORSYDE_SELF_REPORTING
     //! Self-report string
@@ -359,30 +436,64 @@ private:
     FILE** report_pipe;      // Report pipe
 #endif
 
+    //! Registers the scenario rates of the ports
+    void add_rates(const scenario_table_type& table)
+    {
+        const auto& rates = scenario_table.entries();
+        std::apply([&](auto&... ports) {
+            size_t n = 0;
+            ((add_scenario_port(in_ports, ports, rates.size(),
+                [&rates,n](size_t s){return std::get<0>(rates[s])[n];}), n++), ...);
+        }, iport);
+        std::apply([&](auto&... ports) {
+            size_t n = 0;
+            ((add_scenario_port(out_ports, ports, rates.size(),
+                [&rates,n](size_t s){return std::get<1>(rates[s])[n];}), n++), ...);
+        }, oport);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("scenario_table", table);
+#endif
+    }
+
     //Implementing the abstract semantics
     void init()
     {
-        cval1 = new TC;
+        // the buffers are allocated once for the maximum rates
+        for (auto& rates : scenario_table.entries())
+        {
+            std::apply([&](auto&... oval) {
+                std::apply([&](auto&... otok) {
+                    (oval.reserve(otok), ...);
+                }, std::get<1>(rates));
+            }, ovals);
+            std::apply([&](auto&... ival) {
+                std::apply([&](auto&... itok) {
+                    (ival.reserve(itok), ...);
+                }, std::get<0>(rates));
+            }, ivals);
+        }
     }
     
     void prep()
     {
         // Read the control port which is connected to the detector to determine the scenario for the kernel
-        *cval1 = cport1.read();
+        cval1 = cport1.read();
 
         // Resize the input and output vectors according to 
         // the consumption and production rates from the kernel's scenario table
         // (consumption rate, production rate)
+        const auto& rates = scenario_table[cval1];
         std::apply([&](auto&... oval) {
             std::apply([&](auto&... otok) {
                 (oval.resize(otok), ...);
-            }, std::get<1>(scenario_table[*cval1]));
+            }, std::get<1>(rates));
         }, ovals);
 
         std::apply([&](auto&... ival) {
             std::apply([&](auto&... itok) {
                 (ival.resize(itok), ...);
-            }, std::get<0>(scenario_table[*cval1]));
+            }, std::get<0>(rates));
         }, ivals);
 
         // Reading the input ports        
@@ -390,8 +501,7 @@ private:
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport](){
-                        for (auto it=ival.begin();it!=ival.end();it++)
-                            *it = inport.read();
+                        inport.read_n(ival, ival.size());
                     }()
                 , ...);
             }, ivals);
@@ -401,13 +511,20 @@ private:
     void exec()
     {
         // Call the user-imlpemented kernel function with input and output vectors and the control value
-        _func(ovals, *cval1, ivals);
+        if (_vfunc)
+            std::apply([&](auto&... oval) {
+                std::apply([&](const auto&... ival) {
+                    _vfunc(oval..., cval1, ival...);
+                }, ivals);
+            }, ovals);
+        else
+            _func(ovals, cval1, ivals);
 #ifdef FORSYDE_SELF_REPORTING
         // Write the report to the pipe
         report_str << "kernelMN" << "  " << basename() 
-                                << "  " << *cval1 
-                                << "  " << std::get<0>(scenario_table[*cval1]) 
-                                << "  " << std::get<1>(scenario_table[*cval1]) << std::endl;
+                                << "  " << cval1 
+                                << "  " << std::get<0>(scenario_table[cval1]) 
+                                << "  " << std::get<1>(scenario_table[cval1]) << std::endl;
         fputs(report_str.str().c_str(), *report_pipe);
         fflush(*report_pipe);
         report_str.str("");
@@ -423,10 +540,7 @@ private:
         }, oport);
     }
     
-    void clean()
-    {
-        delete cval1;
-    }
+    void clean() {}
     
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -459,7 +573,7 @@ private:
  * a current scenario detection function, and a kernel scenario selection function, it creates a detector process.
  */
 template <typename T0, typename T1, typename TS>
-class detector : public SADF_process
+class detector : public SADF_process, public scenario_actor
 {
 public:
     SADF_in<T1> iport1;     ///< port for the input channel
@@ -495,24 +609,26 @@ public:
           ) : SADF_process(_name), iport1("iport1"), oport1("oport1"), i1toks(i1toks),
                init_sc(init_sc), _cds_func(_cds_func), _kss_func(_kss_func), scenario_table(scenario_table)
     {
+        const auto& rates = this->scenario_table.entries();
+        add_scenario_port(in_ports, iport1, rates.size(),
+            [i1toks](size_t){return i1toks;});
+        add_scenario_port(out_ports, oport1, rates.size(),
+            [&rates](size_t s){return rates[s];});
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("cds_func",func_name+std::string("cds_func")));
-        arg_vec.push_back(std::make_tuple("kss_func",func_name+std::string("kss_func")));
-        std::stringstream ss;
-        ss << scenario_table;
-        arg_vec.push_back(std::make_tuple("scenario_table",ss.str()));
-        ss.clear();
-        ss.str(std::string());
-        ss << init_sc;
-        arg_vec.push_back(std::make_tuple("init_sc",ss.str()));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
+        add_func_arg("cds_func", "cds_func");
+        add_func_arg("kss_func", "kss_func");
+        add_arg("scenario_table", scenario_table);
+        add_arg("init_sc", init_sc);
+        add_arg("i1toks", i1toks);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SADF::detector";}
+
+    sc_interface* control_channel() {return NULL;}
+
+    void peek_scenarios(size_t, std::vector<size_t>&) {}
 private:
     // consumption and production rates
     size_t i1toks;
@@ -529,12 +645,14 @@ private:
     kss_functype _kss_func;
 
     //! The table of kernel's scenarios to be passed to the process constructor
-    scenario_table_type scenario_table;
+    scenario_lookup<TS,size_t> scenario_table;
 
     //Implementing the abstract semantics
     void init()
     {
         i1vals.resize(i1toks);
+        // the output buffer is allocated once for the maximum rate
+        for (auto& rate : scenario_table.entries()) o1vals.reserve(rate);
 
         sc_val = new TS;
         *sc_val = init_sc;
@@ -543,8 +661,7 @@ private:
     void prep()
     {
         // Reading the input port according to the input tokens consumption rate which is passed to the constructor
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
+        iport1.read_n(i1vals, i1vals.size());
     }
     
     void exec()
@@ -574,6 +691,11 @@ private:
         delete sc_val;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *sc_val);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *sc_val);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -591,7 +713,7 @@ private:
 template<typename TO_tuple, typename TI_tuple, typename TS> class detectorMN;
 
 template <typename... TOs, typename... TIs, typename TS>
-class detectorMN<std::tuple<TOs...>,std::tuple<TIs...>,TS> : public SADF_process
+class detectorMN<std::tuple<TOs...>,std::tuple<TIs...>,TS> : public SADF_process, public scenario_actor
 {
 public:
     std::tuple<SADF_in<TIs>...>  iport;///< tuple of ports for the input channels
@@ -633,27 +755,32 @@ public:
         , report_pipe(_report_pipe)
 #endif
     {
+        const auto& rates = this->scenario_table.entries();
+        std::apply([&](auto&... ports) {
+            size_t n = 0;
+            ((add_scenario_port(in_ports, ports, rates.size(),
+                [&itoks,n](size_t){return itoks[n];}), n++), ...);
+        }, iport);
+        std::apply([&](auto&... ports) {
+            size_t n = 0;
+            ((add_scenario_port(out_ports, ports, rates.size(),
+                [&rates,n](size_t s){return rates[s][n];}), n++), ...);
+        }, oport);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("cds_func",func_name+std::string("cds_func")));
-        arg_vec.push_back(std::make_tuple("kss_func",func_name+std::string("kss_func")));
-        std::stringstream ss;
-        ss << scenario_table;
-        arg_vec.push_back(std::make_tuple("scenario_table",ss.str()));
-        ss.clear();
-        ss.str(std::string());
-        ss << init_sc;
-        arg_vec.push_back(std::make_tuple("init_sc",ss.str()));
-        ss.clear();
-        ss.str(std::string());
-        ss << itoks;
-        arg_vec.push_back(std::make_tuple("itoks",ss.str()));
+        add_func_arg("cds_func", "cds_func");
+        add_func_arg("kss_func", "kss_func");
+        add_arg("scenario_table", scenario_table);
+        add_arg("init_sc", init_sc);
+        add_arg("itoks", itoks);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SADF::detectorMN";}
+
+    sc_interface* control_channel() {return NULL;}
+
+    void peek_scenarios(size_t, std::vector<size_t>&) {}
 private:
     // consumption and production rates
     std::array<size_t,sizeof...(TIs)> itoks;
@@ -670,7 +797,7 @@ private:
     kss_functype _kss_func;
 
     //! The table of kernel's scenarios to be passed to the process constructor
-    scenario_table_type scenario_table;
+    scenario_lookup<TS,std::array<size_t,sizeof...(TOs)>> scenario_table;
 
 #ifdef FORSYDE_SELF_REPORTING
     //! Self-report string
@@ -688,6 +815,13 @@ private:
                 (ival.resize(itok), ...);
             }, itoks);
         }, ivals);
+        // the output buffers are allocated once for the maximum rates
+        for (auto& rates : scenario_table.entries())
+            std::apply([&](auto&... oval) {
+                std::apply([&](auto&... otok) {
+                    (oval.reserve(otok), ...);
+                }, rates);
+            }, ovals);
 
         sc_val = new TS;
         *sc_val = init_sc;
@@ -700,8 +834,7 @@ private:
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport](){
-                        for (auto it=ival.begin();it!=ival.end();it++)
-                            *it = inport.read();
+                        inport.read_n(ival, ival.size());
                     }()
                 , ...);
             }, ivals);
@@ -750,6 +883,11 @@ private:
         delete sc_val;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *sc_val);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *sc_val);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -0,0 +1,362 @@
+/**********************************************************************
+    * sadf_scheduler.hpp -- Scenario-aware scheduling of SADF graphs  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a single-threaded executor which switches    *
+    *          between static schedules of the scenarios of an SADF   *
+    *          process network                                        *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SADF_SCHEDULER_HPP
+#define SADF_SCHEDULER_HPP
+
+/*! \file sadf_scheduler.hpp
+ * \brief Implements a scenario-aware scheduler for SADF process networks
+ *
+ *  This file includes an opt-in executor which runs the detector and the
+ * kernels of an SADF process network in a single thread, using a static
+ * schedule for the scenarios selected by the detector in each firing.
+ */
+
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <sstream>
+
+#include "sadf_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace SADF
+{
+
+using namespace sc_core;
+
+//! A scenario-aware SADF graph executor
+/*! This module collects the detector and the kernels below a given
+ * module in the hierarchy (or the ones explicitly added) and executes
+ * them in a single SC_THREAD. In each iteration the detector is fired
+ * once, and the kernels are fired once per control token it has
+ * produced, following a static schedule of the scenarios of these
+ * tokens. The schedules are built by symbolic execution the first time
+ * a combination of scenarios (and buffer occupancies) occurs and are
+ * reused afterwards. The threads of the scheduled processes are
+ * disabled and the channels whose both ends are scheduled are switched
+ * to plain ring buffers sized for the largest rates of the scenarios.
+ *
+ * Exactly one detector should be scheduled, and it should drive the
+ * control ports of all the scheduled kernels. Similar to the SDF static
+ * scheduler, the channels connecting the scheduled processes to the rest
+ * of the model keep their sc_fifo semantics, i.e., reading from an empty
+ * boundary channel blocks the scheduler thread.
+ */
+class scenario_scheduler : public sc_module
+{
+public:
+    //! An entry of a schedule: a process fired a number of times in a row
+    typedef std::pair<ForSyDe::process*, size_t> sched_entry;
+
+    //! The constructor requires the module name and the root of the subgraph
+    /*! All the SADF detectors and kernels below the root module in the
+     * hierarchy are scheduled, unless some processes are added
+     * explicitly using add().
+     */
+    scenario_scheduler(sc_module_name _name,  ///< The module name
+                       sc_module* root=NULL   ///< The root of the subgraph
+                       ) : sc_module(_name), root(root), last(NULL)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a detector or a kernel to the list of the scheduled processes
+    void add(ForSyDe::process* p)
+    {
+        scenario_actor* sa = dynamic_cast<scenario_actor*>(p);
+        if (sa == NULL)
+            SC_REPORT_ERROR(name(), "only the SADF detectors and kernels can be scheduled");
+        actors.push_back({p, sa});
+    }
+
+    //! The number of the distinct schedules built so far
+    size_t schedules() const {return cache.size();}
+
+    //! Returns the schedule of the last iteration in the looped notation
+    std::string schedule_str() const
+    {
+        std::stringstream ss;
+        if (last == NULL) return ss.str();
+        for (auto it=last->begin(); it!=last->end(); it++)
+            if (it->second==1)
+                ss << it->first->basename();
+            else
+                ss << "(" << it->second << " " << it->first->basename() << ")";
+        return ss.str();
+    }
+
+    //! The scheduler is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_scenario_scheduler";}
+
+protected:
+    SC_HAS_PROCESS(scenario_scheduler);
+
+    //! A scheduled process
+    struct actor
+    {
+        ForSyDe::process* proc;
+        scenario_actor* sa;
+    };
+
+    //! The port index used for the control ports of the kernels
+    static constexpr size_t control = size_t(-1);
+
+    //! A channel inter-connecting two scheduled processes
+    struct edge
+    {
+        size_t src, dst;        // indices of the producer and the consumer
+        size_t sport, dport;    // indices of their ports
+        size_t cap;             // the capacity of the buffer
+        static_channel* chan;
+    };
+
+    sc_module* root;
+    std::vector<actor> actors;
+    std::vector<edge> edges;
+    std::vector<std::vector<size_t>> ins, outs;
+    // the order in which the kernels are tried
+    std::vector<size_t> ord;
+
+    // the schedules built so far, indexed by the iterations they serve
+    std::map<std::vector<size_t>, std::vector<sched_entry>> cache;
+    const std::vector<sched_entry>* last;
+    // the key of the current iteration and the scenarios of its firings
+    std::vector<size_t> key;
+    std::vector<std::vector<size_t>> scen;
+
+    //! The rate of a port in a scenario; the unknown scenarios have zero rates
+    static size_t rate(const scenario_port& p, size_t s)
+    {
+        return s < p.rates.size() ? p.rates[s] : 0;
+    }
+
+    //! The largest rate of a port among the scenarios
+    static size_t max_rate(const scenario_port& p)
+    {
+        return p.rates.empty() ? 0 : *std::max_element(p.rates.begin(), p.rates.end());
+    }
+
+    //! Collects the SADF detectors and kernels below a module recursively
+    void collect(sc_object* obj)
+    {
+        std::vector<sc_object*> children = obj->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+        {
+            ForSyDe::process* p = dynamic_cast<ForSyDe::process*>(*it);
+            scenario_actor* sa = dynamic_cast<scenario_actor*>(*it);
+            if (p != NULL && sa != NULL)
+                actors.push_back({p, sa});
+            else if (p == NULL && dynamic_cast<sc_module*>(*it) != NULL)
+                collect(*it);
+        }
+    }
+
+    //! Builds the edges of the graph from the channels bound to the ports
+    void build_edges()
+    {
+        // channels read by the scheduled processes
+        std::map<sc_interface*, std::pair<size_t,size_t>> readers;
+        for (size_t i=0; i<actors.size(); i++)
+        {
+            auto& in_ports = actors[i].sa->in_ports;
+            for (size_t j=0; j<in_ports.size(); j++)
+                for (auto ch : in_ports[j].port->bound_channels())
+                    readers[ch] = std::make_pair(i, j);
+            if (i > 0) readers[actors[i].sa->control_channel()] = std::make_pair(i, control);
+        }
+        ins.assign(actors.size(), std::vector<size_t>());
+        outs.assign(actors.size(), std::vector<size_t>());
+        for (size_t i=0; i<actors.size(); i++)
+        {
+            auto& out_ports = actors[i].sa->out_ports;
+            for (size_t j=0; j<out_ports.size(); j++)
+                for (auto ch : out_ports[j].port->bound_channels())
+                {
+                    auto rit = readers.find(ch);
+                    if (rit == readers.end()) continue;     // a boundary channel
+                    static_channel* sch = dynamic_cast<static_channel*>(ch);
+                    if (sch == NULL)
+                        SC_REPORT_ERROR(name(), "the channels of the scheduled processes should be ForSyDe signals");
+                    ins[rit->second.first].push_back(edges.size());
+                    outs[i].push_back(edges.size());
+                    edges.push_back({i, rit->second.first, j, rit->second.second, 0, sch});
+                }
+        }
+        for (size_t i=1; i<actors.size(); i++)
+        {
+            bool driven = false;
+            for (auto e : ins[i])
+                driven |= edges[e].dport == control && edges[e].src == 0;
+            if (!driven)
+                SC_REPORT_ERROR(name(), "the control port of a scheduled kernel is not driven by the scheduled detector");
+        }
+    }
+
+    //! Sizes the buffers for the largest rates of the scenarios
+    /*! The detector fires once per iteration and each kernel at most as
+     * many times as the most control tokens the detector produces for
+     * it. A buffer holds what its producer and its consumer may move in
+     * one iteration.
+     */
+    void size_buffers()
+    {
+        std::vector<size_t> firings(actors.size(), 1);
+        for (auto& e : edges)
+            if (e.dport == control)
+                firings[e.dst] = max_rate(actors[0].sa->out_ports[e.sport]);
+        for (auto& e : edges)
+        {
+            const size_t cons = e.dport == control ? 1 :
+                                max_rate(actors[e.dst].sa->in_ports[e.dport]);
+            e.cap = firings[e.src] * max_rate(actors[e.src].sa->out_ports[e.sport])
+                  + firings[e.dst] * cons;
+            e.cap = std::max(e.cap, size_t(1));
+        }
+    }
+
+    //! Orders the kernels topologically, breaking the cycles at the first unordered one
+    void order()
+    {
+        const size_t n = actors.size();
+        std::vector<size_t> indeg(n, 0);
+        std::vector<bool> done(n, false);
+        for (auto& e : edges)
+            if (e.src > 0 && e.dst > 0) indeg[e.dst]++;
+        while (ord.size()+1 < n)
+        {
+            size_t pick = n;
+            for (size_t i=1; i<n && pick==n; i++)
+                if (!done[i] && indeg[i]==0) pick = i;
+            for (size_t i=1; i<n && pick==n; i++)
+                if (!done[i]) pick = i;
+            done[pick] = true;
+            ord.push_back(pick);
+            for (auto e : outs[pick])
+                if (edges[e].dst > 0 && !done[edges[e].dst] && indeg[edges[e].dst] > 0)
+                    indeg[edges[e].dst]--;
+        }
+    }
+
+    //! Builds the schedule of the current iteration by symbolic execution
+    std::vector<sched_entry> build_schedule()
+    {
+        std::vector<sched_entry> res;
+        std::vector<size_t> toks(key.begin(), key.begin()+edges.size());
+        std::vector<size_t> next(actors.size(), 0);
+        size_t left = 0;
+        for (auto& s : scen) left += s.size();
+        while (left > 0)
+        {
+            bool fired = false;
+            for (auto a : ord)
+            {
+                auto sa = actors[a].sa;
+                while (next[a] < scen[a].size())
+                {
+                    const size_t s = scen[a][next[a]];
+                    bool ready = true;
+                    for (auto e : ins[a])
+                        ready &= toks[e] >= (edges[e].dport == control ? 1 :
+                                             rate(sa->in_ports[edges[e].dport], s));
+                    if (!ready) break;
+                    for (auto e : ins[a])
+                        toks[e] -= edges[e].dport == control ? 1 :
+                                   rate(sa->in_ports[edges[e].dport], s);
+                    for (auto e : outs[a])
+                    {
+                        toks[e] += rate(sa->out_ports[edges[e].sport], s);
+                        if (toks[e] > edges[e].cap)
+                            SC_REPORT_ERROR(name(), "a buffer of the SADF graph overflows in the current scenarios");
+                    }
+                    if (!res.empty() && res.back().first==actors[a].proc)
+                        res.back().second++;
+                    else
+                        res.push_back(sched_entry(actors[a].proc, 1));
+                    next[a]++;
+                    left--;
+                    fired = true;
+                }
+            }
+            if (!fired)
+                SC_REPORT_ERROR(name(), "the SADF graph deadlocks in the current scenarios");
+        }
+        return res;
+    }
+
+    //! Fires the kernels of an iteration following its schedule
+    /*! It is overridden by the executors which fire the independent
+     * kernels of an iteration in parallel. The key and the scenarios of
+     * the iteration are still valid when it is called.
+     */
+    virtual void run(const std::vector<sched_entry>& sched)
+    {
+        for (auto& en : sched)
+            for (size_t k=0; k<en.second; k++)
+                en.first->ext_fire();
+    }
+
+    //! Analyzes the graph and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        if (actors.empty() && root != NULL) collect(root);
+        if (actors.empty()) return;
+        // the detector goes first
+        auto det = std::partition(actors.begin(), actors.end(),
+                        [](const actor& a){return a.sa->control_channel() == NULL;});
+        if (det - actors.begin() != 1)
+            SC_REPORT_ERROR(name(), "exactly one detector should be scheduled");
+        build_edges();
+        size_buffers();
+        order();
+        scen.resize(actors.size());
+        // switch the internal channels to plain ring buffers
+        for (auto& e : edges) e.chan->set_static_buffer(e.cap);
+        for (auto& a : actors) a.proc->set_ext_driven();
+    }
+
+    //! The main and only execution thread of the scheduler
+    void worker()
+    {
+        for (auto& a : actors) a.proc->ext_init();
+        if (actors.empty()) return;
+        while (1)
+        {
+            actors[0].proc->ext_fire();
+            // the iteration is identified by the occupancies of the
+            // buffers and the scenarios of the control tokens
+            key.clear();
+            for (auto& e : edges) key.push_back(e.chan->num_available());
+            for (size_t a=1; a<actors.size(); a++)
+            {
+                scen[a].clear();
+                for (auto e : ins[a])
+                    if (edges[e].dport == control)
+                        actors[a].sa->peek_scenarios(key[e], scen[a]);
+                key.insert(key.end(), scen[a].begin(), scen[a].end());
+            }
+            auto it = cache.find(key);
+            if (it == cache.end()) it = cache.emplace(key, build_schedule()).first;
+            last = &it->second;
+            run(it->second);
+        }
+    }
+};
+
+}
+}
+
+#endif
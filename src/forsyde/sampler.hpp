@@ -0,0 +1,223 @@
+/**********************************************************************
+    * sampler.hpp -- Statistical profiling of ForSyDe models          *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Sampling the process running at regular CPU time       *
+    *          intervals and writing the samples as folded stacks     *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SAMPLING_PROFILE to enable it           *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SAMPLER_HPP
+#define SAMPLER_HPP
+
+/*! \file sampler.hpp
+ * \brief Implements the sampling profiler of the processes
+ *
+ *  In contrast to the profiler of FORSYDE_PROFILE, which times every
+ * stage of every firing, this file includes a statistical profiler whose
+ * overhead does not grow with the number of firings. Each stage of a
+ * firing only stores the process and the stage it runs in a variable of
+ * the OS thread, and a SIGPROF timer counts, every period of CPU time,
+ * the stage running at that moment. The samples taken outside of the
+ * stages (e.g., in the SystemC scheduler) are counted as the kernel.
+ *
+ *  The counts are written at the end of the simulation in the folded
+ * stack format of the flame graph tools, one line per stage, with the
+ * module hierarchy of the process, its process constructor and the
+ * stage as the frames, e.g.:
+ *
+ *     top;filter1;mul1 [SY::comb];exec 1234
+ *
+ *  A blocked stage keeps its process as the running one until the next
+ * stage starts, hence the samples of the scheduler switching between the
+ * processes are partly counted in the prep and prod stages. The timer is
+ * shared by the whole program, hence no other code should use SIGPROF.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <memory>
+#include <atomic>
+#include <cstdint>
+#include <csignal>
+#include <sys/time.h>
+
+//! The output file of the sampling profiler
+#ifndef FORSYDE_SAMPLING_FILE
+#define FORSYDE_SAMPLING_FILE "forsyde_samples.folded"
+#endif
+
+//! The default sampling period in microseconds of CPU time
+#ifndef FORSYDE_SAMPLING_PERIOD_US
+#define FORSYDE_SAMPLING_PERIOD_US 1000
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The stage running on the calling OS thread
+/*! It is zero outside the stages, and 3 * process + stage + 1 inside
+ * them. A trivially initialized thread-local variable can be read by a
+ * signal handler.
+ */
+inline std::uint32_t& sampled_site()
+{
+    static thread_local std::uint32_t site = 0;
+    return site;
+}
+
+//! Collects the samples of all the processes
+/*! Each process enrolls in the constructor, starts the timer when it is
+ * initialized, and reports its name and kind at the end of the
+ * simulation. The output file is written once all the enrolled processes
+ * have reported, or when the program exits.
+ */
+class sampling_profiler
+{
+public:
+    //! Returns the single instance of the profiler
+    static sampling_profiler& get()
+    {
+        static sampling_profiler sp;
+        return sp;
+    }
+
+    //! Sets the output file
+    void set_output(const std::string& file_name) {out_file = file_name;}
+
+    //! Sets the sampling period in microseconds, before the simulation starts
+    void set_period(unsigned us) {period_us = us;}
+
+    //! Registers a process and returns its number
+    std::uint32_t enroll()
+    {
+        labels.emplace_back("[unreported " + std::to_string(labels.size()) + "]");
+        return labels.size()-1;
+    }
+
+    //! Starts the timer, once the number of processes is known
+    void start()
+    {
+        if (running || written) return;
+        sites = 3 * labels.size() + 1;
+        counts.reset(new std::atomic<std::uint64_t>[sites]);
+        for (size_t i=0; i<sites; i++) counts[i].store(0, std::memory_order_relaxed);
+        struct sigaction sa = {};
+        sa.sa_handler = &sampling_profiler::on_sample;
+        sa.sa_flags = SA_RESTART;
+        sigemptyset(&sa.sa_mask);
+        sigaction(SIGPROF, &sa, &old_action);
+        struct itimerval it = {};
+        it.it_interval.tv_sec = period_us / 1000000;
+        it.it_interval.tv_usec = period_us % 1000000;
+        it.it_value = it.it_interval;
+        if (setitimer(ITIMER_PROF, &it, NULL) != 0)
+            SC_REPORT_WARNING("sampling_profiler", "the profiling timer could not be started");
+        running = true;
+    }
+
+    //! Reports the hierarchical name and the kind of a process
+    void report(std::uint32_t id, const std::string& name, const std::string& kind)
+    {
+        stop();
+        labels[id] = label(name, kind);
+        if (++reported == labels.size()) write();
+    }
+
+    //! The number of samples taken so far
+    std::uint64_t samples() const
+    {
+        std::uint64_t n = 0;
+        for (size_t i=0; i<sites && counts; i++) n += counts[i].load(std::memory_order_relaxed);
+        return n;
+    }
+
+    ~sampling_profiler()
+    {
+        stop();
+        if (!written && counts) write();
+    }
+
+private:
+    std::string out_file;
+    unsigned period_us;
+    std::vector<std::string> labels;
+    // the counts of the kernel and of the stages of each process
+    std::unique_ptr<std::atomic<std::uint64_t>[]> counts;
+    size_t sites;
+    size_t reported;
+    bool running, written;
+    struct sigaction old_action;
+
+    sampling_profiler() : out_file(FORSYDE_SAMPLING_FILE),
+                          period_us(FORSYDE_SAMPLING_PERIOD_US), sites(0),
+                          reported(0), running(false), written(false) {}
+
+    //! Counts the stage running on the interrupted thread
+    static void on_sample(int)
+    {
+        sampling_profiler& sp = get();
+        const std::uint32_t site = sampled_site();
+        if (site < sp.sites) sp.counts[site].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! Stops the timer and restores the previous handler
+    void stop()
+    {
+        if (!running) return;
+        struct itimerval it = {};
+        setitimer(ITIMER_PROF, &it, NULL);
+        sigaction(SIGPROF, &old_action, NULL);
+        running = false;
+    }
+
+    //! The frames of a process: its module hierarchy and its kind
+    static std::string label(const std::string& name, const std::string& kind)
+    {
+        std::string res(name);
+        for (auto& c : res)
+            if (c == '.') c = ';';
+            else if (c == ' ') c = '_';
+        return res + " [" + kind + "]";
+    }
+
+    void write()
+    {
+        written = true;
+        std::ofstream ofs(out_file);
+        if (!ofs.is_open())
+        {
+            SC_REPORT_ERROR(out_file.c_str(), "file could not be opened to write the samples");
+            return;
+        }
+        static const char* stage_names[] = {"prep", "exec", "prod"};
+        if (const std::uint64_t n = counts[0].load(std::memory_order_relaxed))
+            ofs << "[kernel] " << n << std::endl;
+        for (size_t i=1; i<sites; i++)
+            if (const std::uint64_t n = counts[i].load(std::memory_order_relaxed))
+                ofs << labels[(i-1)/3] << ';' << stage_names[(i-1)%3] << ' ' << n << std::endl;
+    }
+};
+
+//! Marks a stage of a firing as running from its construction to its destruction
+class sampled_stage
+{
+public:
+    sampled_stage(std::uint32_t id, std::uint32_t stage)
+    {
+        sampled_site() = 3 * id + stage + 1;
+    }
+
+    ~sampled_stage() {sampled_site() = 0;}
+};
+
+}
+
+#endif
@@ -0,0 +1,350 @@
+/**********************************************************************
+    * sdf_buffers.hpp -- Buffer sizing of SDF graphs                  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Computing deadlock-free buffer sizes for the signals   *
+    *          of SDF process networks before the simulation starts   *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION to use it                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SDF_BUFFERS_HPP
+#define SDF_BUFFERS_HPP
+
+/*! \file sdf_buffers.hpp
+ * \brief Implements the buffer sizing of SDF process networks
+ *
+ *  This file includes an analysis of the SDF sub-graphs of a model,
+ * built on the process graph, which checks their consistency and
+ * deadlock-freedom and computes the buffer sizes of their signals. The
+ * sizes can be applied to the signals before the simulation starts, e.g.:
+ *
+ *     void start_of_simulation()
+ *     {
+ *         SDF::size_buffers();
+ *     }
+ */
+
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <string>
+
+#include "process_graph.hpp"
+#include "sdf_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! The buffer sizing policies
+enum buffer_policy
+{
+    //! Small buffers which are still deadlock-free
+    MIN_DEADLOCK_FREE,
+    //! Buffers which hold the tokens of a whole graph iteration, so that
+    //! the processes are not blocked by their outputs
+    ONE_ITERATION
+};
+
+//! Buffer analysis of the SDF signals of a process graph
+/*! The analyzed edges are the signals between two SDF processes which
+ * have registered their port rates. The repetition vector is computed
+ * from the balance equations. If they have no solution, the tokens of
+ * some signal accumulate without bound (or its reader starves), which
+ * is reported.
+ *
+ * The minimal sizes start from the lower bound of each edge on its own
+ * (p+c-gcd(p,c)+d mod gcd(p,c) for the rates p and c and d initial
+ * tokens), and are increased while a symbolic execution of one graph
+ * iteration, in which the firings are atomic, blocks on a full buffer.
+ * A complete iteration returns the buffers to their initial state,
+ * hence the sizes are deadlock-free for the whole simulation.
+ *
+ *  The cyclo-static processes (see ForSyDe::CSDF) are executed phase by
+ * phase, and the sizes of their edges start from the largest rate of a
+ * phase, so that the buffers do not hold the tokens of whole cycles.
+ */
+class buffer_analysis
+{
+public:
+    //! An analyzed edge and its computed size
+    struct buffer
+    {
+        size_t edge;            ///< the index of the edge in the graph
+        size_t size;            ///< the computed buffer size
+    };
+
+    //! The constructor analyzes the SDF edges of a graph
+    explicit buffer_analysis(const process_graph& g) : g(g), consistent(true)
+    {
+        auto is_sdf = [&](size_t n)
+        {
+            return n != process_graph::npos &&
+                   dynamic_cast<sdf_process*>(g.nodes()[n].proc) != NULL;
+        };
+        for (size_t e=0; e<g.edges().size(); e++)
+        {
+            auto& ed = g.edges()[e];
+            if (is_sdf(ed.src) && is_sdf(ed.dst) && ed.prod > 0 && ed.cons > 0)
+                bufs.push_back({e, 0});
+        }
+        solve_balance();
+    }
+
+    //! Checks if the balance equations of the SDF edges have a solution
+    bool is_consistent() const {return consistent;}
+
+    //! The repetitions of a node in a graph iteration, zero if it is not analyzed
+    /*! The repetitions of a cyclo-static process count the firings of
+     * its phases.
+     */
+    size_t repetitions(size_t node) const {return q[node] * phases(node);}
+
+    //! Computes the buffer sizes
+    /*! It returns false if the graph deadlocks regardless of the sizes,
+     * i.e., some cycle has too few initial tokens, or it is inconsistent.
+     */
+    bool compute(buffer_policy policy=MIN_DEADLOCK_FREE)
+    {
+        if (!consistent) return false;
+        for (auto& b : bufs)
+        {
+            auto& ed = g.edges()[b.edge];
+            const size_t p = ed.prod, c = ed.cons, d = ed.init_toks;
+            const size_t gc = std::gcd(p, c);
+            if (!ed.prod_phases.empty() || !ed.cons_phases.empty())
+                b.size = std::max({d, largest(ed.prod_phases, p), largest(ed.cons_phases, c)});
+            else
+                b.size = d <= p+c-gc ? p+c-gc + d%gc : d;
+            if (policy == ONE_ITERATION)
+                b.size = std::max(b.size, q[ed.src]*p + d);
+        }
+        return iterate();
+    }
+
+    //! The computed buffer sizes
+    const std::vector<buffer>& buffers() const {return bufs;}
+
+    //! Applies the computed sizes to the signals
+    /*! The signals which are already switched to static buffers (e.g.,
+     * by the static scheduler) are skipped. It returns the number of the
+     * resized signals.
+     */
+    size_t apply() const
+    {
+        size_t n = 0;
+        for (auto& b : bufs)
+        {
+            sc_interface* ch = g.edges()[b.edge].chan;
+            auto sc = dynamic_cast<static_channel*>(ch);
+            auto rc = dynamic_cast<resizable_channel*>(ch);
+            if (rc == NULL || (sc != NULL && sc->is_static_buffer())) continue;
+            rc->set_capacity(b.size);
+            n++;
+        }
+        return n;
+    }
+
+private:
+    const process_graph& g;
+    std::vector<buffer> bufs;
+    std::vector<size_t> q;
+    bool consistent;
+
+    //! The number of phases of a node, one if it is not cyclo-static
+    size_t phases(size_t n) const
+    {
+        auto sp = dynamic_cast<const sdf_process*>(g.nodes()[n].proc);
+        return sp ? sp->phases() : 1;
+    }
+
+    //! The tokens of a port in a phase, given its phases and its rate
+    static size_t at(const std::vector<unsigned int>& ph, size_t rate, size_t phase)
+    {
+        return ph.empty() ? rate : ph[phase % ph.size()];
+    }
+
+    //! The largest rate of a phase of a port
+    static size_t largest(const std::vector<unsigned int>& ph, size_t rate)
+    {
+        return ph.empty() ? rate : *std::max_element(ph.begin(), ph.end());
+    }
+
+    //! The name of an edge used in the reports
+    std::string edge_name(size_t e) const
+    {
+        auto obj = dynamic_cast<sc_object*>(g.edges()[e].chan);
+        return obj ? obj->name() : "?";
+    }
+
+    //! Solves the balance equations using rational arithmetic
+    void solve_balance()
+    {
+        const size_t n = g.nodes().size();
+        std::vector<size_t> num(n, 0), den(n, 1);
+        std::vector<std::vector<size_t>> adj(n);
+        for (size_t i=0; i<bufs.size(); i++)
+        {
+            adj[g.edges()[bufs[i].edge].src].push_back(i);
+            adj[g.edges()[bufs[i].edge].dst].push_back(i);
+        }
+        for (size_t s=0; s<n; s++)
+        {
+            if (num[s] != 0 || adj[s].empty()) continue;
+            std::vector<size_t> comp, stack(1, s);
+            num[s] = 1;
+            while (!stack.empty())
+            {
+                size_t a = stack.back(); stack.pop_back();
+                comp.push_back(a);
+                for (auto i : adj[a])
+                {
+                    auto& ed = g.edges()[bufs[i].edge];
+                    size_t b, bn, bd;
+                    if (ed.src == a)
+                    {
+                        b = ed.dst; bn = num[a]*ed.prod; bd = den[a]*ed.cons;
+                    }
+                    else
+                    {
+                        b = ed.src; bn = num[a]*ed.cons; bd = den[a]*ed.prod;
+                    }
+                    size_t gc = std::gcd(bn, bd);
+                    bn /= gc; bd /= gc;
+                    if (num[b] == 0)
+                    {
+                        num[b] = bn; den[b] = bd;
+                        stack.push_back(b);
+                    }
+                    else if (num[b] != bn || den[b] != bd)
+                    {
+                        if (consistent)
+                            SC_REPORT_WARNING(edge_name(bufs[i].edge).c_str(),
+                                "inconsistent SDF rates: the tokens of the signal are not bounded");
+                        consistent = false;
+                    }
+                }
+            }
+            size_t l = 1;
+            for (auto a : comp) l = std::lcm(l, den[a]);
+            size_t gc = 0;
+            for (auto a : comp)
+            {
+                num[a] = num[a] * (l / den[a]);
+                den[a] = 1;
+                gc = std::gcd(gc, num[a]);
+            }
+            for (auto a : comp) num[a] /= gc;
+        }
+        q = num;
+    }
+
+    //! The tokens consumed from an analyzed edge by a firing in a phase
+    size_t cons_at(size_t i, size_t phase) const
+    {
+        auto& ed = g.edges()[bufs[i].edge];
+        return at(ed.cons_phases, ed.cons, phase);
+    }
+
+    //! The tokens produced on an analyzed edge by a firing in a phase
+    size_t prod_at(size_t i, size_t phase) const
+    {
+        auto& ed = g.edges()[bufs[i].edge];
+        return at(ed.prod_phases, ed.prod, phase);
+    }
+
+    //! Executes one iteration symbolically, enlarging the blocking buffers
+    bool iterate()
+    {
+        const size_t n = g.nodes().size();
+        std::vector<size_t> rem(q), toks(bufs.size()), ph(n, 0);
+        for (size_t a=0; a<n; a++)
+            if (rem[a] > 0) rem[a] *= phases(a);
+        std::vector<std::vector<size_t>> ins(n), outs(n);
+        for (size_t i=0; i<bufs.size(); i++)
+        {
+            auto& ed = g.edges()[bufs[i].edge];
+            toks[i] = ed.init_toks;
+            outs[ed.src].push_back(i);
+            ins[ed.dst].push_back(i);
+        }
+        size_t left = std::accumulate(rem.begin(), rem.end(), size_t(0));
+        while (left > 0)
+        {
+            bool fired = false;
+            // the buffer which blocks a process with enough input tokens
+            size_t blocking = bufs.size(), need = 0;
+            for (size_t a=0; a<n; a++)
+            {
+                while (rem[a] > 0)
+                {
+                    bool ready = true;
+                    for (auto i : ins[a])
+                        ready &= toks[i] >= cons_at(i, ph[a]);
+                    if (!ready) break;
+                    size_t full = bufs.size(), missing = 0;
+                    for (auto i : outs[a])
+                    {
+                        const size_t p = prod_at(i, ph[a]);
+                        if (toks[i] + p > bufs[i].size)
+                        {
+                            full = i;
+                            missing = toks[i] + p - bufs[i].size;
+                            break;
+                        }
+                    }
+                    if (full < bufs.size())
+                    {
+                        if (blocking == bufs.size() || missing < need)
+                        {
+                            blocking = full;
+                            need = missing;
+                        }
+                        break;
+                    }
+                    for (auto i : ins[a]) toks[i] -= cons_at(i, ph[a]);
+                    for (auto i : outs[a]) toks[i] += prod_at(i, ph[a]);
+                    ph[a] = (ph[a] + 1) % phases(a);
+                    rem[a]--;
+                    left--;
+                    fired = true;
+                }
+            }
+            if (fired) continue;
+            if (blocking == bufs.size())
+            {
+                SC_REPORT_WARNING("SDF buffer analysis", "the SDF graph deadlocks: insufficient initial tokens in a cycle");
+                return false;
+            }
+            bufs[blocking].size += need;
+        }
+        return true;
+    }
+};
+
+//! Computes and applies the buffer sizes of the SDF signals of the model
+/*! It should be called after the elaboration phase and before the
+ * processes write their initial tokens, i.e., in start_of_simulation.
+ * It returns false, leaving the signals unchanged, if the SDF graph is
+ * inconsistent or deadlocks.
+ */
+inline bool size_buffers(buffer_policy policy=MIN_DEADLOCK_FREE)
+{
+    buffer_analysis ba(model_graph());
+    if (!ba.compute(policy)) return false;
+    ba.apply();
+    return true;
+}
+
+}
+}
+
+#endif
@@ -58,6 +58,83 @@ inline comb<T0,T1>* make_comb(std::string pName,    ///< process name
     return p;
 }
 
+//! Helper function to construct a span_comb process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline span_comb<T0,T1>* make_span_comb(std::string pName,    ///< process name
+    typename span_comb<T0,T1>::functype _func,     ///< function to be passed
+    unsigned int o1toks,                            ///< consumption rate for the first output
+    unsigned int i1toks,                            ///< consumption rate for the first input
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S                                  ///< the first input signal
+    )
+{
+    auto p = new span_comb<T0,T1>(pName.c_str(), _func, o1toks, i1toks);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a memo_comb process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline memo_comb<T0,T1>* make_memo_comb(std::string pName,    ///< process name
+    typename memo_comb<T0,T1>::functype _func,     ///< function to be passed
+    unsigned int o1toks,                            ///< consumption rate for the first output
+    unsigned int i1toks,                            ///< consumption rate for the first input
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S,                                 ///< the first input signal
+    size_t capacity=FORSYDE_MEMO_CAPACITY           ///< the number of cached results
+    )
+{
+    auto p = new memo_comb<T0,T1>(pName.c_str(), _func, o1toks, i1toks, capacity);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a farm process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline farm<T0,T1>* make_farm(std::string pName,    ///< process name
+    typename farm<T0,T1>::functype _func,          ///< the stateless function to be passed
+    unsigned int o1toks,                            ///< production rate of a firing
+    unsigned int i1toks,                            ///< consumption rate of a firing
+    unsigned int firings,                           ///< the number of firings in each cycle
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S                                  ///< the first input signal
+    )
+{
+    auto p = new farm<T0,T1>(pName.c_str(), _func, o1toks, i1toks, firings);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a comb2 process
 /*! This function is used to construct a process (SystemC module) and
  * connect its output and output signals.
@@ -160,6 +237,129 @@ inline comb4<T0,T1,T2,T3,T4>* make_comb4(std::string pName,///< process name
     return p;
 }
 
+//! Helper function to construct a comb process with an inlined function
+/*! Similar to make_comb, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class F>
+inline comb<T0,T1,F>* make_comb_inline(std::string pName,    ///< process name
+    const F& _func,                                ///< function to be passed
+    unsigned int o1toks,                            ///< consumption rate for the first output
+    unsigned int i1toks,                            ///< consumption rate for the first input
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S                                  ///< the first input signal
+    )
+{
+    auto p = new comb<T0,T1,F>(pName.c_str(), _func, o1toks, i1toks);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb2 process with an inlined function
+/*! Similar to make_comb2, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class F>
+inline comb2<T0,T1,T2,F>* make_comb2_inline(std::string pName,///< process name
+    const F& _func,                                ///< function to be passed
+    unsigned int o1toks,                            ///< consumption rate for the first output
+    unsigned int i1toks,                            ///< consumption rate for the first input
+    unsigned int i2toks,                            ///< consumption rate for the second input
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S,                                 ///< the first input signal
+    I2If<T2>& inp2S                                  ///< the second input signal
+    )
+{
+    auto p = new comb2<T0,T1,T2,F>(pName.c_str(), _func, o1toks, 
+                                  i1toks, i2toks);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb3 process with an inlined function
+/*! Similar to make_comb3, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class T3, template <class> class I3If,
+          class F>
+inline comb3<T0,T1,T2,T3,F>* make_comb3_inline(std::string pName,///< process name
+    const F& _func,                                ///< function to be passed
+    unsigned int o1toks,                            ///< consumption rate for the first output
+    unsigned int i1toks,                            ///< consumption rate for the first input
+    unsigned int i2toks,                            ///< consumption rate for the second input
+    unsigned int i3toks,                            ///< consumption rate for the third input
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S,                                 ///< the first input signal
+    I2If<T2>& inp2S,                                 ///< the second input signal
+    I3If<T3>& inp3S                                  ///< the third input signal
+    )
+{
+    auto p = new comb3<T0,T1,T2,T3,F>(pName.c_str(), _func, o1toks,
+                                     i1toks, i2toks, i3toks);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).iport3(inp3S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb4 process with an inlined function
+/*! Similar to make_comb4, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class T3, template <class> class I3If,
+          class T4, template <class> class I4If,
+          class F>
+inline comb4<T0,T1,T2,T3,T4,F>* make_comb4_inline(std::string pName,///< process name
+    const F& _func,                                ///< function to be passed
+    unsigned int o1toks,                            ///< consumption rate for the first output
+    unsigned int i1toks,                            ///< consumption rate for the first input
+    unsigned int i2toks,                            ///< consumption rate for the second input
+    unsigned int i3toks,                            ///< consumption rate for the third input
+    unsigned int i4toks,                            ///< consumption rate for the fourth input
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S,                                 ///< the first input signal
+    I2If<T2>& inp2S,                                 ///< the second input signal
+    I3If<T3>& inp3S,                                 ///< the third input signal
+    I4If<T4>& inp4S                                  ///< the fourth input signal
+    )
+{
+    auto p = new comb4<T0,T1,T2,T3,T4,F>(pName.c_str(), _func, o1toks,
+                                     i1toks, i2toks, i3toks, i4toks);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).iport3(inp3S);
+    (*p).iport4(inp4S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a combMN process
 /*! This function is used to construct a combMN (SystemC module) and
  * connect its input and output signals.
@@ -167,11 +367,11 @@ inline comb4<T0,T1,T2,T3,T4>* make_comb4(std::string pName,///< process name
  * It also removes boilerplate code by using type-inference feature of
  * C++ and automatic binding to the input FIFOs.
  */
-template <typename... TOs, typename... TIs,
+template <typename F, typename... TOs, typename... TIs,
            template <class> class... IIf,
            template <class> class... OIf>
 inline combMN<std::tuple<TOs...>,std::tuple<TIs...>>* make_combMN(const std::string& pName,
-    const typename combMN<std::tuple<TOs...>,std::tuple<TIs...>>::functype& _func,
+    const F& _func,
     std::array<size_t, sizeof...(TOs)> otoks,
     std::array<size_t, sizeof...(TIs)> itoks,
     std::tuple<OIf<TOs>&...> outS,
@@ -312,6 +512,27 @@ inline file_source<T>* make_file_source(std::string pName,
     return p;
 }
 
+//! Helper function to construct a binary_file_source process
+/*! This function is used to construct a binary_file_source (SystemC module) and
+ * connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <class T, template <class> class OIf>
+inline binary_file_source<T>* make_binary_file_source(const std::string& pName,
+    const std::string& file_name,
+    unsigned int o1toks,
+    OIf<T>& outS
+    )
+{
+    auto p = new binary_file_source<T>(pName.c_str(), file_name, o1toks);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a vector source process
 /*! This function is used to construct a vector source (SystemC module) and
  * connect its output signal.
@@ -332,6 +553,25 @@ inline vsource<T>* make_vsource(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a stream source process
+/*! This function is used to construct a source (SystemC module) which
+ * reads a token_stream and connect its output signal. It is used as
+ * make_vsource, with a stream (e.g., from make_generator_stream or
+ * make_file_stream) instead of a vector.
+ */
+template <class T, template <class> class OIf>
+inline stream_source<T>* make_vsource(const std::string& pName,
+    std::shared_ptr<token_stream<T>> stream,
+    OIf<T>& outS
+    )
+{
+    auto p = new stream_source<T>(pName.c_str(), stream);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a sink process
 /*! This function is used to construct a sink (SystemC module) and
  * connect its output and output signals.
@@ -373,6 +613,27 @@ inline file_sink<T>* make_file_sink(std::string pName,
     return p;
 }
 
+//! Helper function to construct a binary_file_sink process
+/*! This function is used to construct a binary_file_sink (SystemC module) and
+ * connect its input signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <class T, template <class> class IIf>
+inline binary_file_sink<T>* make_binary_file_sink(const std::string& pName,
+    const std::string& file_name,
+    unsigned int i1toks,
+    IIf<T>& inS
+    )
+{
+    auto p = new binary_file_sink<T>(pName.c_str(), file_name, i1toks);
+    
+    (*p).iport1(inS);
+    
+    return p;
+}
+
 //! Helper function to construct a zip process
 /*! This function is used to construct a zip process (SystemC module) and
  * connect its output and output signals.
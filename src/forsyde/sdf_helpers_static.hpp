@@ -0,0 +1,234 @@
+/**********************************************************************
+    * sdf_helpers_static.hpp -- Helper primitives for the SDF process *
+    *                           constructors with static rates        *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing helper primitives for modeling in the SDF MoC*
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SDF_HELPERS_STATIC_HPP
+#define SDF_HELPERS_STATIC_HPP
+
+/*! \file sdf_helpers_static.hpp
+ * \brief Implements helper primitives for the SDF process constructors with static rates
+ *
+ *  This file includes helper functions which facilliate construction of
+ * the processes in sdf_process_constructors_static.hpp. The rates are
+ * given as the first template arguments, e.g.,
+ *
+ *     SDF::make_comb_s<1,4>("avg", avg_func, out_sig, in_sig);
+ */
+
+#include <functional>
+#include <tuple>
+#include <array>
+
+#include "sdf_process_constructors_static.hpp"
+
+namespace ForSyDe
+{
+
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! Helper function to construct a comb_s process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <unsigned int O, unsigned int I,
+          class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline comb_s<T0,T1,O,I>* make_comb_s(std::string pName,    ///< process name
+    typename comb_s<T0,T1,O,I>::functype _func,   ///< function to be passed
+    OIf<T0>& outS,                                   ///< the first output signal
+    I1If<T1>& inp1S                                  ///< the first input signal
+    )
+{
+    auto p = new comb_s<T0,T1,O,I>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb2_s process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <unsigned int O, unsigned int I1, unsigned int I2,
+          class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If>
+inline comb2_s<T0,T1,T2,O,I1,I2>* make_comb2_s(std::string pName,
+    typename comb2_s<T0,T1,T2,O,I1,I2>::functype _func,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S
+    )
+{
+    auto p = new comb2_s<T0,T1,T2,O,I1,I2>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb3_s process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <unsigned int O, unsigned int I1, unsigned int I2, unsigned int I3,
+          class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class T3, template <class> class I3If>
+inline comb3_s<T0,T1,T2,T3,O,I1,I2,I3>* make_comb3_s(std::string pName,
+    typename comb3_s<T0,T1,T2,T3,O,I1,I2,I3>::functype _func,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S,
+    I3If<T3>& inp3S
+    )
+{
+    auto p = new comb3_s<T0,T1,T2,T3,O,I1,I2,I3>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).iport3(inp3S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb4_s process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <unsigned int O, unsigned int I1, unsigned int I2, unsigned int I3,
+          unsigned int I4,
+          class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class T3, template <class> class I3If,
+          class T4, template <class> class I4If>
+inline comb4_s<T0,T1,T2,T3,T4,O,I1,I2,I3,I4>* make_comb4_s(std::string pName,
+    typename comb4_s<T0,T1,T2,T3,T4,O,I1,I2,I3,I4>::functype _func,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S,
+    I3If<T3>& inp3S,
+    I4If<T4>& inp4S
+    )
+{
+    auto p = new comb4_s<T0,T1,T2,T3,T4,O,I1,I2,I3,I4>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).iport3(inp3S);
+    (*p).iport4(inp4S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a delayn_s process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <unsigned int N, class T, template <class> class IIf,
+          template <class> class OIf>
+inline delayn_s<T,N>* make_delayn_s(std::string pName,
+    T initval,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new delayn_s<T,N>(pName.c_str(), initval);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a zip_s process
+/*! This function is used to construct a zip process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <unsigned int I1, unsigned int I2,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          template <class> class OIf>
+inline zip_s<T1,T2,I1,I2>* make_zip_s(std::string pName,
+    OIf<std::tuple<std::array<T1,I1>,std::array<T2,I2>>>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S
+    )
+{
+    auto p = new zip_s<T1,T2,I1,I2>(pName.c_str());
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct an unzip_s process
+/*! This function is used to construct an unzip process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <class T1, unsigned int O1, class T2, unsigned int O2,
+          template <class> class IIf,
+          template <class> class O1If,
+          template <class> class O2If>
+inline unzip_s<T1,T2,O1,O2>* make_unzip_s(std::string pName,
+    IIf<std::tuple<std::array<T1,O1>,std::array<T2,O2>>>& inpS,
+    O1If<T1>& out1S,
+    O2If<T2>& out2S
+    )
+{
+    auto p = new unzip_s<T1,T2,O1,O2>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    (*p).oport1(out1S);
+    (*p).oport2(out2S);
+    
+    return p;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,556 @@
+/**********************************************************************
+    * sdf_hsdf_executor.hpp -- Multi-core self-timed execution of SDF *
+    *                          graphs                                 *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Running the actors of an SDF graph on several cores    *
+    *          with static orders derived from its HSDF expansion     *
+    *                                                                 *
+    * Usage:   Define FORSYDE_MULTITHREADED and link with the         *
+    *          threading library (e.g., -pthread)                     *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SDF_HSDF_EXECUTOR_HPP
+#define SDF_HSDF_EXECUTOR_HPP
+
+/*! \file sdf_hsdf_executor.hpp
+ * \brief Implements a multi-core self-timed executor for SDF graphs
+ *
+ *  This file includes an opt-in executor which expands an SDF graph into
+ * the precedence graph of the firings of one iteration (its HSDF
+ * expansion), list-schedules the firings on a number of cores and runs
+ * the iterations self-timed, with one OS thread per core.
+ */
+
+#include <vector>
+#include <map>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <algorithm>
+#include <iostream>
+
+#include "sdf_process.hpp"
+#include "sdf_scheduler.hpp"
+#ifdef FORSYDE_NUMA
+#include "numa_placement.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! A multi-core self-timed executor for a closed SDF graph
+/*! This module collects the SDF processes below a given module in the
+ * hierarchy (or the ones explicitly added) and takes over their
+ * execution:
+ *  - After the elaboration, it computes the repetition vector and
+ *    expands the graph into the precedence graph of the firings of one
+ *    iteration, where firing j of an actor depends on the firings of its
+ *    producers which produce the tokens it consumes in the same
+ *    iteration and on firing j-1 of the same actor.
+ *  - When the simulation starts, the first iteration is run in the
+ *    SystemC thread of the executor in a topological order of the
+ *    precedence graph, measuring the execution time of the firings.
+ *  - The firings are then list-scheduled on the cores by their bottom
+ *    levels, where all the firings of an actor are mapped to the same
+ *    core since the actors have state. This gives a static order of
+ *    firings per core.
+ *  - Each core runs its static order repeatedly in its own OS thread
+ *    (the first one in the SystemC thread), and fires an actor as soon
+ *    as its input channels have enough tokens and its output channels
+ *    enough space. The iterations overlap, as far as the buffers allow.
+ *
+ * The channels of the graph are switched to plain ring buffers whose
+ * indices are updated lock-free, with room for the initial tokens and
+ * two iterations of produced tokens. All the channels bound to the
+ * processes should therefore be inside the graph, and the processes
+ * should not call the SystemC kernel (e.g., wait() or a blocking read of
+ * an sc_fifo), since they run on OS threads. The SystemC kernel is
+ * blocked while the graph runs, which it does for the given number of
+ * iterations, or forever if it is zero.
+ *
+ * The achieved throughput is measured over the iterations after the
+ * first one. The analytical throughput is the bound of the mapping,
+ * i.e., one iteration per the total execution time of the firings of
+ * the most loaded core, as measured in the first iteration.
+ *
+ * The actors which are too small to be mapped individually can be
+ * grouped into atomic clusters (see add_cluster() and set_grain()), all
+ * of whose actors are mapped to the same core, hence they fire in its
+ * static order without synchronizing with the other cores.
+ *
+ * With FORSYDE_NUMA, a placement of the actors on the NUMA nodes can be
+ * set (see numa_placement). The cores are then assigned to the used
+ * nodes in turn, the actors are mapped only to the cores of their nodes,
+ * and the ring buffers of the channels are allocated on the nodes of
+ * their readers.
+ */
+class hsdf_executor : public sc_module, private sdf_graph
+{
+public:
+    //! The constructor requires the module name and the root of the graph
+    /*! All the SDF processes below the root module in the hierarchy
+     * which have registered their port rates are executed, unless some
+     * processes are added explicitly using add().
+     */
+    hsdf_executor(sc_module_name _name,          ///< The module name
+                  sc_module* root=NULL,          ///< The root of the graph
+                  unsigned nthreads=0,           ///< The number of cores (0 for all of them)
+                  unsigned long long iters=0     ///< The number of iterations (0 for no limit)
+                  ) : sc_module(_name), root(root), nthreads(nthreads), iters(iters)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the graph
+    void add(sdf_process* p)
+    {
+        actors.push_back(p);
+    }
+
+    //! Makes the processes of a composite module an atomic cluster
+    /*! The processes below the module in the hierarchy are mapped to the
+     * same core. It should be called before the simulation starts.
+     */
+    void add_cluster(sc_module* composite)
+    {
+        clusters.push_back(composite);
+    }
+
+    //! Sets the grain of the automatic clustering
+    /*! The actors whose firings take less than the grain (in seconds),
+     * as measured in the first iteration, are mapped to the core of
+     * their first producer instead of being balanced over the cores.
+     * Zero disables it. It should be called before the simulation
+     * starts.
+     */
+    void set_grain(double secs)
+    {
+        grain = secs;
+    }
+
+#ifdef FORSYDE_NUMA
+    //! Sets the placement of the actors on the NUMA nodes
+    /*! It should be called before the simulation starts.
+     */
+    void set_placement(const numa_placement& pl) {placement = pl;}
+#endif
+
+    //! The repetition vector, in the order of the processes
+    const std::vector<std::pair<sdf_process*, size_t>>& repetitions() const
+    {
+        return reps;
+    }
+
+    //! The number of firings in the precedence graph of one iteration
+    size_t hsdf_size() const {return nodes.size();}
+
+    //! The static orders of the firings of the cores (valid after the first iteration)
+    std::vector<std::vector<sdf_process*>> core_orders() const
+    {
+        std::vector<std::vector<sdf_process*>> res(orders.size());
+        for (size_t c=0; c<orders.size(); c++)
+            for (auto a : orders[c]) res[c].push_back(actors[a]);
+        return res;
+    }
+
+    //! The number of iterations completed by all the cores
+    unsigned long long iterations() const
+    {
+        if (orders.empty()) return calibrated ? 1 : 0;
+        unsigned long long res = core_iters[0].load(std::memory_order_relaxed);
+        for (size_t c=1; c<orders.size(); c++)
+            res = std::min(res, core_iters[c].load(std::memory_order_relaxed));
+        return res;
+    }
+
+    //! The measured iterations per second, after the first iteration
+    double achieved_throughput() const
+    {
+        const unsigned long long n = iterations();
+        if (n <= 1) return 0;
+        const auto end = finished ? stop_time : std::chrono::steady_clock::now();
+        const double secs = std::chrono::duration<double>(end - start_time).count();
+        return secs > 0 ? (n-1) / secs : 0;
+    }
+
+    //! The iterations per second bounded by the most loaded core
+    double analytical_throughput() const
+    {
+        const double load = core_loads.empty() ? 0 :
+                            *std::max_element(core_loads.begin(), core_loads.end());
+        return load > 0 ? 1 / load : 0;
+    }
+
+    //! Prints the mapping and the throughputs
+    void print_report(std::ostream& os=std::cout) const
+    {
+        os << name() << ": " << hsdf_size() << " firings per iteration on "
+           << orders.size() << " cores" << std::endl;
+        for (size_t c=0; c<orders.size(); c++)
+        {
+            os << "  core " << c << " (" << core_loads[c]*1e6 << " us):";
+            for (auto a : orders[c]) os << " " << actors[a]->basename();
+            os << std::endl;
+        }
+        os << "  throughput: " << achieved_throughput() << " iterations/s achieved, "
+           << analytical_throughput() << " iterations/s analytical" << std::endl;
+    }
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_hsdf_executor";}
+
+private:
+    SC_HAS_PROCESS(hsdf_executor);
+
+    //! A firing of an actor in the precedence graph
+    struct node
+    {
+        size_t actor;               // the index of the actor
+        std::vector<size_t> succs;  // the firings depending on it
+        size_t npreds;              // the number of firings it depends on
+    };
+
+    //! A channel read or written by a firing, with its rate
+    struct access
+    {
+        static_channel* chan;
+        size_t toks;
+    };
+
+    sc_module* root;
+    unsigned nthreads;
+    unsigned long long iters;
+    std::vector<std::pair<sdf_process*, size_t>> reps;
+
+    // the clusters marked by the user, the one of each actor (or -1) and
+    // the grain of the automatic clustering
+    std::vector<sc_module*> clusters;
+    std::vector<int> cluster_of;
+    double grain = 0;
+
+    // The precedence graph and a topological order of it
+    std::vector<node> nodes;
+    std::vector<size_t> topo;
+    // The channels read and written by each actor
+    std::vector<std::vector<access>> reads, writes;
+    // The mean measured execution time of the firings of each actor
+    std::vector<double> cost;
+
+    // The static order of the actor firings of each core, and its load
+    std::vector<std::vector<size_t>> orders;
+    std::vector<double> core_loads;
+    std::unique_ptr<std::atomic<unsigned long long>[]> core_iters;
+
+    bool calibrated = false, finished = false;
+    std::chrono::steady_clock::time_point start_time, stop_time;
+
+    //! Expands the graph into the precedence graph of one iteration
+    void expand(const std::vector<size_t>& q)
+    {
+        std::vector<size_t> base(actors.size()+1, 0);
+        for (size_t a=0; a<actors.size(); a++) base[a+1] = base[a] + q[a];
+        nodes.resize(base.back());
+        for (size_t a=0; a<actors.size(); a++)
+            for (size_t k=0; k<q[a]; k++)
+            {
+                nodes[base[a]+k].actor = a;
+                nodes[base[a]+k].npreds = 0;
+            }
+        auto depend = [&](size_t from, size_t to)
+        {
+            auto& s = nodes[from].succs;
+            if (!s.empty() && s.back() == to) return;
+            s.push_back(to);
+            nodes[to].npreds++;
+        };
+        // the firings of an actor are sequential
+        for (size_t a=0; a<actors.size(); a++)
+            for (size_t k=1; k<q[a]; k++)
+                depend(base[a]+k-1, base[a]+k);
+        // firing j of the consumer reads the tokens j*cons..(j+1)*cons-1,
+        // where the first init_toks ones come from the previous iteration
+        for (auto& e : edges)
+            for (size_t j=0; j<q[e.dst]; j++)
+            {
+                const size_t first = j*e.cons, last = (j+1)*e.cons - 1;
+                if (last < e.init_toks) continue;
+                const size_t from = first < e.init_toks ? 0 : (first-e.init_toks) / e.prod;
+                const size_t to = (last-e.init_toks) / e.prod;
+                for (size_t i=from; i<=to; i++)
+                    depend(base[e.src]+i, base[e.dst]+j);
+            }
+        // a topological order, which is also a sequential schedule
+        std::vector<size_t> indeg(nodes.size()), stack;
+        for (size_t n=0; n<nodes.size(); n++)
+            if ((indeg[n] = nodes[n].npreds) == 0) stack.push_back(n);
+        std::reverse(stack.begin(), stack.end());
+        while (!stack.empty())
+        {
+            const size_t n = stack.back(); stack.pop_back();
+            topo.push_back(n);
+            for (auto s : nodes[n].succs)
+                if (--indeg[s] == 0) stack.push_back(s);
+        }
+        if (topo.size() != nodes.size())
+            SC_REPORT_ERROR(name(), "the SDF graph deadlocks: insufficient initial tokens in a cycle");
+    }
+
+    //! Maps the firings to the cores and orders them by list scheduling
+    void list_schedule(unsigned cores)
+    {
+        // the bottom levels, in the reverse topological order
+        std::vector<double> blevel(nodes.size(), 0);
+        for (auto it=topo.rbegin(); it!=topo.rend(); it++)
+        {
+            double m = 0;
+            for (auto s : nodes[*it].succs) m = std::max(m, blevel[s]);
+            blevel[*it] = cost[nodes[*it].actor] + m;
+        }
+        std::vector<int> core_of(actors.size(), -1), cluster_core(clusters.size(), -1);
+        // the producers of each actor
+        std::vector<std::vector<size_t>> producers(actors.size());
+        for (auto& e : edges) producers[e.dst].push_back(e.src);
+        std::vector<double> core_free(cores, 0), ready_at(nodes.size(), 0);
+        std::vector<size_t> indeg(nodes.size()), ready;
+        for (size_t n=0; n<nodes.size(); n++)
+            if ((indeg[n] = nodes[n].npreds) == 0) ready.push_back(n);
+        orders.assign(cores, std::vector<size_t>());
+        core_loads.assign(cores, 0);
+        while (!ready.empty())
+        {
+            // the ready firing with the highest bottom level
+            auto best = std::max_element(ready.begin(), ready.end(),
+                [&](size_t x, size_t y) {return blevel[x] < blevel[y];});
+            const size_t n = *best;
+            ready.erase(best);
+            const size_t a = nodes[n].actor;
+            // the core of the actor, or the one where it starts first
+            size_t c = 0;
+            auto mapped = [&](size_t b)
+            {
+#ifdef FORSYDE_NUMA
+                return core_of[b] >= 0 && on_node(core_of[b], a);
+#else
+                return core_of[b] >= 0;
+#endif
+            };
+            if (core_of[a] >= 0)
+                c = core_of[a];
+            else if (cluster_of[a] >= 0 && cluster_core[cluster_of[a]] >= 0)
+                c = cluster_core[cluster_of[a]];
+            else if (cost[a] < grain && cluster_of[a] < 0 &&
+                     std::any_of(producers[a].begin(), producers[a].end(), mapped))
+                c = core_of[*std::find_if(producers[a].begin(), producers[a].end(), mapped)];
+            else
+            {
+#ifdef FORSYDE_NUMA
+                // among the cores of the node of the actor
+                while (c+1 < cores && !on_node(c, a)) c++;
+#endif
+                for (size_t i=c+1; i<cores; i++)
+                {
+#ifdef FORSYDE_NUMA
+                    if (!on_node(i, a)) continue;
+#endif
+                    if (std::max(core_free[i], ready_at[n]) <
+                        std::max(core_free[c], ready_at[n]))
+                        c = i;
+                }
+            }
+            core_of[a] = c;
+            if (cluster_of[a] >= 0) cluster_core[cluster_of[a]] = c;
+            const double finish = std::max(core_free[c], ready_at[n]) + cost[a];
+            core_free[c] = finish;
+            core_loads[c] += cost[a];
+            orders[c].push_back(a);
+            for (auto s : nodes[n].succs)
+            {
+                ready_at[s] = std::max(ready_at[s], finish);
+                if (--indeg[s] == 0) ready.push_back(s);
+            }
+        }
+        // the cores without firings are not used
+        while (!orders.empty() && orders.back().empty())
+        {
+            orders.pop_back();
+            core_loads.pop_back();
+        }
+    }
+
+#ifdef FORSYDE_NUMA
+    numa_placement placement;
+    // the node of each core, empty without a placement
+    std::vector<int> core_node;
+
+    //! Checks if an actor may be mapped to a core
+    bool on_node(size_t c, size_t a) const
+    {
+        const int n = placement.node_of(actors[a]);
+        return core_node.empty() || n < 0 || core_node[c] == n;
+    }
+#endif
+
+    //! Analyzes the graph and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        if (actors.empty() && root != NULL) collect(root);
+        if (actors.empty()) return;
+        for (auto p : actors)
+            if (p->phases() > 1)
+                SC_REPORT_ERROR(name(), "cyclo-static processes are not supported by the HSDF executor, use the static scheduler");
+        build_edges();
+        auto q = solve_balance(name());
+        for (size_t i=0; i<actors.size(); i++)
+            reps.push_back(std::make_pair(actors[i], q[i]));
+        // all the channels should be inside the graph
+        size_t bound = 0;
+        for (auto p : actors)
+        {
+            for (auto& r : p->in_rates) bound += r.channels().size();
+            for (auto& r : p->out_rates) bound += r.channels().size();
+        }
+        if (bound != 2*edges.size())
+            SC_REPORT_ERROR(name(), "the HSDF executor requires a closed SDF graph: a signal has no reader or writer in the graph");
+        // the actors below a marked module form its cluster
+        cluster_of.assign(actors.size(), -1);
+        for (size_t a=0; a<actors.size(); a++)
+            for (sc_object* o=actors[a]->get_parent_object(); o!=NULL; o=o->get_parent_object())
+            {
+                auto it = std::find(clusters.begin(), clusters.end(), o);
+                if (it != clusters.end()) cluster_of[a] = it - clusters.begin();
+            }
+        reads.resize(actors.size());
+        writes.resize(actors.size());
+        for (auto& e : edges)
+        {
+            static_channel* ch = dynamic_cast<static_channel*>(e.chan);
+            if (ch == NULL)
+                SC_REPORT_ERROR(name(), "only ForSyDe signals are supported by the HSDF executor");
+            reads[e.dst].push_back({ch, e.cons});
+            writes[e.src].push_back({ch, e.prod});
+        }
+        expand(q);
+        for (auto p : actors) p->set_ext_driven();
+    }
+
+    //! Blocks the calling thread until an actor can fire without blocking
+    void wait_ready(size_t a)
+    {
+        for (auto& r : reads[a])
+            for (unsigned spins=0; (size_t)r.chan->num_available() < r.toks; spins++)
+                if (spins > 64) std::this_thread::yield();
+        for (auto& w : writes[a])
+            for (unsigned spins=0; (size_t)w.chan->num_free() < w.toks; spins++)
+                if (spins > 64) std::this_thread::yield();
+    }
+
+    //! Runs the static order of a core for the remaining iterations
+    void run_core(size_t c)
+    {
+#ifdef FORSYDE_NUMA
+        numa_thread_binding bind(core_node.empty() ? -1 : core_node[c]);
+#endif
+        for (unsigned long long it=1; iters==0 || it<iters; it++)
+        {
+            for (auto a : orders[c])
+            {
+                wait_ready(a);
+                actors[a]->ext_fire();
+            }
+            core_iters[c].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //! The SystemC thread of the executor, which also runs the first core
+    void worker()
+    {
+        if (actors.empty()) return;
+#ifdef FORSYDE_NUMA
+        for (auto p : actors) placement.init(p);
+#else
+        for (auto p : actors) p->ext_init();
+#endif
+        // let the initial tokens arrive and move them into the ring buffers
+        wait(SC_ZERO_TIME);
+        for (auto& e : edges)
+        {
+            static_channel* ch = dynamic_cast<static_channel*>(e.chan);
+#ifdef FORSYDE_NUMA
+            // on the node of the reader
+            numa_scope scope(placement.node_of(actors[e.dst]), placement.ring_pages());
+#endif
+            ch->set_static_buffer(std::max<size_t>(ch->num_available(),
+                                  e.init_toks + 2*reps[e.src].second*e.prod));
+        }
+        // the first iteration, measuring the firings
+        cost.assign(actors.size(), 0);
+        for (auto n : topo)
+        {
+            const size_t a = nodes[n].actor;
+            const auto t0 = std::chrono::steady_clock::now();
+            actors[a]->ext_fire();
+            cost[a] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+        }
+        for (size_t a=0; a<actors.size(); a++) cost[a] /= reps[a].second;
+#ifdef FORSYDE_PROFILE_DB
+        // the costs averaged over the previous runs are steadier
+        for (size_t a=0; a<actors.size(); a++)
+        {
+            const double c = profile_db::get().cost(actors[a]->name());
+            if (c >= 0) cost[a] = c;
+        }
+#endif
+        calibrated = true;
+        // the rest of the iterations, self-timed on the cores
+        unsigned cores = nthreads ? nthreads : std::thread::hardware_concurrency();
+#ifdef FORSYDE_NUMA
+        if (!placement.empty())
+        {
+            const auto used = placement.used_nodes();
+            core_node.clear();
+            for (unsigned c=0; c<std::max(cores, 1u); c++)
+                core_node.push_back(used[c % used.size()]);
+        }
+#endif
+        list_schedule(std::max(cores, 1u));
+        core_iters.reset(new std::atomic<unsigned long long>[orders.size()]);
+        for (size_t c=0; c<orders.size(); c++) core_iters[c] = 1;
+        start_time = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t c=1; c<orders.size(); c++)
+            threads.emplace_back([this, c]{run_core(c);});
+        run_core(0);
+        for (auto& t : threads) t.join();
+        stop_time = std::chrono::steady_clock::now();
+        finished = true;
+    }
+};
+
+//! Helper function to construct an HSDF executor for a graph
+template <class... Ps>
+inline hsdf_executor* make_hsdf_executor(const std::string& pName,   ///< the executor name
+    unsigned nthreads,                             ///< the number of cores (0 for all of them)
+    unsigned long long iters,                      ///< the number of iterations (0 for no limit)
+    Ps*... procs                                   ///< the processes of the graph
+    )
+{
+    auto e = new hsdf_executor(pName.c_str(), NULL, nthreads, iters);
+    (e->add(procs), ...);
+    return e;
+}
+
+}
+}
+
+#endif
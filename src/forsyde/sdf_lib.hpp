@@ -0,0 +1,1052 @@
+/**********************************************************************
+    * sdf_lib.hpp -- a library of useful processes in the SDF MoC     *
+    *                                                                 *
+    * Authors:  agent (agent@local)                                   *
+    *                                                                 *
+    * Purpose: Enriching the SDF library.                             *
+    *                                                                 *
+    * Usage:                                                          *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SDFLIB_H
+#define SDFLIB_H
+
+/*! \file sdf_lib.hpp
+ * \brief Implements extra facilities on top of the SDF MoC
+ *
+ *  This file includes the basic process constructors and helper
+ * functions for creating advanced SDF processes.
+ */
+
+#include "sdf_moc.hpp"
+#include "fir_kernel.hpp"
+#include "fft_kernel.hpp"
+#include "matrix_kernel.hpp"
+#include "random.hpp"
+
+namespace ForSyDe
+{
+
+namespace SDF
+{
+
+//! Process constructor for a block FIR filter
+/*! This class is used to build a finite impulse response filter in a
+ * single actor which consumes and produces a block of tokens in each
+ * firing. Given the coefficients c, each output is the sum of c[k]
+ * times the input k tokens before, where the inputs before the first
+ * one are zero. The inner products are computed by a vectorizable
+ * kernel over a contiguous buffer holding the history followed by the
+ * current block.
+ */
+template <class T>
+class fir : public sdf_process
+{
+public:
+    SDF_in<T>  iport1;      ///< port for the input channel
+    SDF_out<T> oport1;      ///< port for the output channel
+
+    //! The constructor requires the module name, the coefficients and the block size
+    /*! It creates an SC_THREAD which reads a block from its input port,
+     * filters it and writes the results using the output port
+     */
+    fir(const sc_module_name& _name,        ///< process name
+        const std::vector<T>& coefs,        ///< the filter coefficients
+        unsigned int block=1                ///< tokens consumed and produced in each firing
+       ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+           block(block), state(coefs, block)
+    {
+        if (coefs.empty())
+            SC_REPORT_ERROR(name(), "an FIR filter requires at least one coefficient");
+        add_in_rate(iport1, block);
+        add_out_rate(oport1, block);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("taps", coefs.size());
+        add_arg("block", block);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::fir";}
+
+private:
+    unsigned int block;
+    fir_state<T> state;
+
+    // Output variables
+    std::vector<T> ovals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        state.reset();
+        ovals.resize(block);
+    }
+
+    void prep()
+    {
+        iport1.read_n(state.inputs(), block);
+    }
+
+    void exec()
+    {
+        state.filter(ovals.data());
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, ovals);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, state.history());}
+
+    void restore_state(const char*& pos)
+    {
+        std::vector<T> h;
+        restore_values(pos, h);
+        state.set_history(h);
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a block FIR filter
+/*! This function is used to construct an FIR filter (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline fir<T>* make_fir(const std::string& pName,
+    const std::vector<T>& coefs,
+    unsigned int block,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new fir<T>(pName.c_str(), coefs, block);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Process constructor for a block decimator
+/*! This class is used to build an actor which consumes factor tokens
+ * and produces one token in each firing. The input is first filtered by
+ * an anti-aliasing FIR filter with the given coefficients, and the
+ * output keeps the first of each factor filtered tokens. Without
+ * coefficients the first of each factor input tokens is kept.
+ */
+template <class T>
+class decimate : public sdf_process
+{
+public:
+    SDF_in<T>  iport1;      ///< port for the input channel
+    SDF_out<T> oport1;      ///< port for the output channel
+
+    //! The constructor requires the module name, the factor and the coefficients
+    /*! It creates an SC_THREAD which reads a block from its input port,
+     * filters and decimates it and writes the result using the output
+     * port
+     */
+    decimate(const sc_module_name& _name,       ///< process name
+             unsigned int factor,               ///< tokens consumed in each firing
+             const std::vector<T>& coefs=std::vector<T>() ///< the anti-aliasing filter
+            ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+                factor(factor),
+                state(coefs.empty() ? std::vector<T>(1, T(1)) : coefs, factor)
+    {
+        if (factor == 0)
+            SC_REPORT_ERROR(name(), "the decimation factor should be positive");
+        add_in_rate(iport1, factor);
+        add_out_rate(oport1, 1);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("factor", factor);
+        add_arg("taps", coefs.size());
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::decimate";}
+
+private:
+    unsigned int factor;
+    fir_state<T> state;
+
+    // Output variables
+    std::vector<T> ovals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        state.reset();
+        ovals.resize(1);
+    }
+
+    void prep()
+    {
+        iport1.read_n(state.inputs(), factor);
+    }
+
+    void exec()
+    {
+        state.decimate(ovals.data(), factor);
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, ovals);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, state.history());}
+
+    void restore_state(const char*& pos)
+    {
+        std::vector<T> h;
+        restore_values(pos, h);
+        state.set_history(h);
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a block decimator
+/*! This function is used to construct a decimator (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline decimate<T>* make_decimate(const std::string& pName,
+    unsigned int factor,
+    const std::vector<T>& coefs,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new decimate<T>(pName.c_str(), factor, coefs);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Process constructor for a polyphase rational resampler
+/*! This class is used to build an actor which converts the rate of its
+ * input by L/M. Conceptually, the input is upsampled by L (inserting
+ * zeros), filtered by an FIR filter with the given coefficients and
+ * downsampled by M. The filter is split into its L polyphase components,
+ * so that only the products which contribute to the kept outputs are
+ * computed, i.e., about taps/L multiplies per output instead of taps*L/M
+ * or taps. The rates are derived from the factors: each firing consumes
+ * M/g and produces L/g tokens, where g is their greatest common divisor.
+ *
+ * The coefficients are those of the filter at the upsampled rate,
+ * hence an interpolating filter is usually scaled by L. Without
+ * coefficients, each input token is held for L upsampled samples.
+ */
+template <class T>
+class resample : public sdf_process
+{
+public:
+    SDF_in<T>  iport1;      ///< port for the input channel
+    SDF_out<T> oport1;      ///< port for the output channel
+
+    //! The constructor requires the module name, the factors and the coefficients
+    /*! It creates an SC_THREAD which reads a block from its input port,
+     * resamples it and writes the results using the output port
+     */
+    resample(const sc_module_name& _name,       ///< process name
+             unsigned int L,                    ///< the upsampling factor
+             unsigned int M,                    ///< the downsampling factor
+             const std::vector<T>& coefs=std::vector<T>() ///< the filter coefficients
+            ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+                L(reduce(L, M)), M(reduce(M, L)),
+                state(coefs.empty() ? std::vector<T>(this->L, T(1)) : coefs,
+                      this->L, this->M)
+    {
+        if (L == 0 || M == 0)
+            SC_REPORT_ERROR(name(), "the resampling factors should be positive");
+        add_in_rate(iport1, this->M);
+        add_out_rate(oport1, this->L);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("L", L);
+        add_arg("M", M);
+        add_arg("taps", coefs.size());
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::resample";}
+
+private:
+    // the factors divided by their greatest common divisor
+    unsigned int L, M;
+    polyphase_state<T> state;
+
+    // Output variables
+    std::vector<T> ovals;
+
+    //! Divides a factor by its greatest common divisor with the other one
+    static unsigned int reduce(unsigned int a, unsigned int b)
+    {
+        return a == 0 || b == 0 ? std::max(a, 1u) : a / std::gcd(a, b);
+    }
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        state.reset();
+        ovals.resize(L);
+    }
+
+    void prep()
+    {
+        iport1.read_n(state.inputs(), M);
+    }
+
+    void exec()
+    {
+        state.resample(ovals.data());
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, ovals);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, state.history());}
+
+    void restore_state(const char*& pos)
+    {
+        std::vector<T> h;
+        restore_values(pos, h);
+        state.set_history(h);
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a polyphase resampler
+/*! This function is used to construct a resampler (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline resample<T>* make_resample(const std::string& pName,
+    unsigned int L,
+    unsigned int M,
+    const std::vector<T>& coefs,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new resample<T>(pName.c_str(), L, M, coefs);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Process constructor for a polyphase interpolator
+/*! It is a resampler which consumes one token and produces factor tokens
+ * in each firing, i.e., it upsamples its input by the factor and filters
+ * it with the given coefficients, computing only the products with the
+ * input samples. Without coefficients each input token is repeated
+ * factor times.
+ */
+template <class T>
+class interpolate : public resample<T>
+{
+public:
+    //! The constructor requires the module name, the factor and the coefficients
+    interpolate(const sc_module_name& _name,    ///< process name
+                unsigned int factor,            ///< tokens produced in each firing
+                const std::vector<T>& coefs=std::vector<T>() ///< the interpolation filter
+               ) : resample<T>(_name, factor, 1, coefs) {}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::interpolate";}
+};
+
+//! Helper function to construct a polyphase interpolator
+/*! This function is used to construct an interpolator (SystemC module)
+ * and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline interpolate<T>* make_interpolate(const std::string& pName,
+    unsigned int factor,
+    const std::vector<T>& coefs,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new interpolate<T>(pName.c_str(), factor, coefs);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Process constructor for a block discrete Fourier transform
+/*! This class is used to build an actor which consumes a block of n
+ * real or complex tokens and produces the n complex bins of its
+ * discrete Fourier transform in each firing, i.e., the block size is
+ * its consumption rate. The plan of the size is computed once, in the
+ * init stage, and shared by the actors of the same size (see fft_plan).
+ * The actors built by make_ifft compute the inverse transform, scaled
+ * by 1/n.
+ */
+template <class T>
+class fft : public sdf_process
+{
+public:
+    typedef typename fft_real<T>::type real_type;
+    typedef std::complex<real_type> complex_type;
+
+    SDF_in<T>  iport1;              ///< port for the input channel
+    SDF_out<complex_type> oport1;   ///< port for the output channel
+
+    //! The constructor requires the module name and the block size
+    /*! It creates an SC_THREAD which reads a block from its input port,
+     * transforms it and writes the bins using the output port
+     */
+    fft(const sc_module_name& _name,        ///< process name
+        unsigned int n,                     ///< tokens consumed and produced in each firing
+        bool inverse=false                  ///< computes the scaled inverse transform
+       ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+           n(n), inverse(inverse)
+    {
+        if (n == 0)
+            SC_REPORT_ERROR(name(), "the block size of a transform should be positive");
+        add_in_rate(iport1, n);
+        add_out_rate(oport1, n);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("n", n);
+        add_arg("inverse", inverse);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return inverse ? "SDF::ifft" : "SDF::fft";}
+
+private:
+    unsigned int n;
+    bool inverse;
+
+    std::shared_ptr<const fft_plan<real_type>> plan;
+    fft_buffer<real_type> buf;
+
+    // Input and output variables
+    std::vector<T> ivals;
+    std::vector<complex_type> ovals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!plan)
+        {
+            plan = fft_plan<real_type>::get(n);
+            buf = fft_alloc<real_type>(n);
+        }
+        ivals.resize(n);
+        ovals.resize(n);
+    }
+
+    void prep()
+    {
+        iport1.read_n(ivals, n);
+    }
+
+    void exec()
+    {
+        for (size_t i=0; i<n; i++) buf[i] = complex_type(ivals[i]);
+        plan->transform(buf.get(), inverse);
+        const real_type scale = inverse ? real_type(1) / n : real_type(1);
+        for (size_t i=0; i<n; i++) ovals[i] = buf[i] * scale;
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, ovals);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a block discrete Fourier transform
+/*! This function is used to construct an FFT actor (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline fft<T>* make_fft(const std::string& pName,
+    unsigned int n,
+    OIf<typename fft<T>::complex_type>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new fft<T>(pName.c_str(), n);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a block inverse discrete Fourier transform
+/*! This function is used to construct an inverse FFT actor (SystemC
+ * module) and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename R, template <class> class IIf,
+                        template <class> class OIf>
+inline fft<std::complex<R>>* make_ifft(const std::string& pName,
+    unsigned int n,
+    OIf<std::complex<R>>& outS,
+    IIf<std::complex<R>>& inpS
+    )
+{
+    auto p = new fft<std::complex<R>>(pName.c_str(), n, true);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! The number of lags below which the autocorrelation is computed directly
+#ifndef FORSYDE_AUTOCORR_DIRECT
+#define FORSYDE_AUTOCORR_DIRECT 32
+#endif
+
+//! Process constructor for a block autocorrelation
+/*! This class is used to build an actor which consumes a block of n real
+ * tokens x and produces the lags first values of their autocorrelation
+ * r[k] = sum x[i] x[i+k], for k < lags and i+k < n, in each firing. Up
+ * to FORSYDE_AUTOCORR_DIRECT lags the sums are computed by a
+ * vectorizable kernel, and otherwise from the power spectrum of the
+ * block padded to a power of two of at least n+lags-1 tokens.
+ */
+template <class T>
+class autocorr : public sdf_process
+{
+public:
+    SDF_in<T>  iport1;      ///< port for the input channel
+    SDF_out<T> oport1;      ///< port for the output channel
+
+    //! The constructor requires the module name, the block size and the number of lags
+    /*! It creates an SC_THREAD which reads a block from its input port,
+     * computes its autocorrelation and writes it using the output port
+     */
+    autocorr(const sc_module_name& _name,   ///< process name
+             unsigned int n,                ///< tokens consumed in each firing
+             unsigned int lags              ///< tokens produced in each firing
+            ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+                n(n), lags(lags)
+    {
+        static_assert(std::is_floating_point<T>::value,
+                      "the autocorrelation is computed for real floating-point tokens");
+        if (n == 0 || lags == 0 || lags > n)
+            SC_REPORT_ERROR(name(), "the number of lags should be between 1 and the block size");
+        add_in_rate(iport1, n);
+        add_out_rate(oport1, lags);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("n", n);
+        add_arg("lags", lags);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::autocorr";}
+
+private:
+    unsigned int n, lags;
+
+    std::shared_ptr<const fft_plan<T>> plan;
+    fft_buffer<T> buf;
+
+    // Input and output variables
+    std::vector<T> ivals;
+    std::vector<T> ovals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (lags > FORSYDE_AUTOCORR_DIRECT && !plan)
+        {
+            size_t m = 1;
+            while (m < size_t(n) + lags - 1) m <<= 1;
+            plan = fft_plan<T>::get(m);
+            buf = fft_alloc<T>(m);
+        }
+        ivals.resize(n);
+        ovals.resize(lags);
+    }
+
+    void prep()
+    {
+        iport1.read_n(ivals, n);
+    }
+
+    void exec()
+    {
+        if (!plan)
+        {
+            for (size_t k=0; k<lags; k++)
+                ovals[k] = fir_dot(ivals.data(), ivals.data()+k, n-k);
+            return;
+        }
+        const size_t m = plan->size();
+        for (size_t i=0; i<m; i++) buf[i] = i < n ? ivals[i] : T();
+        plan->transform(buf.get());
+        for (size_t i=0; i<m; i++) buf[i] = std::norm(buf[i]);
+        plan->transform(buf.get(), true);
+        for (size_t k=0; k<lags; k++) ovals[k] = buf[k].real() / m;
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, ovals);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a block autocorrelation
+/*! This function is used to construct an autocorrelation actor (SystemC
+ * module) and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline autocorr<T>* make_autocorr(const std::string& pName,
+    unsigned int n,
+    unsigned int lags,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new autocorr<T>(pName.c_str(), n, lags);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Process constructor for a batched matrix product
+/*! This class is used to build an actor which consumes batch matrices
+ * from each of its inputs and produces their batch pairwise products in
+ * each firing. The matrix type M is either a dense_matrix, whose
+ * products are computed by the gemm kernel (and by BLAS for large
+ * sizes), or a fixed_matrix, whose products have compile-time bounds
+ * and which suits batches of many small matrices. The outputs keep
+ * their storage across the firings, hence the products of dense
+ * matrices of a steady size do not allocate.
+ */
+template <class M>
+class matmul : public sdf_process
+{
+public:
+    SDF_in<M>  iport1;      ///< port for the left operands
+    SDF_in<M>  iport2;      ///< port for the right operands
+    SDF_out<M> oport1;      ///< port for the products
+
+    //! The constructor requires the module name and the batch size
+    /*! It creates an SC_THREAD which reads a batch from each of its
+     * input ports, multiplies them pairwise and writes the products
+     * using the output port
+     */
+    matmul(const sc_module_name& _name,     ///< process name
+           unsigned int batch=1             ///< products computed in each firing
+          ) : sdf_process(_name), iport1("iport1"), iport2("iport2"),
+              oport1("oport1"), batch(batch)
+    {
+        if (batch == 0)
+            SC_REPORT_ERROR(name(), "the batch size should be positive");
+        add_in_rate(iport1, batch);
+        add_in_rate(iport2, batch);
+        add_out_rate(oport1, batch);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("batch", batch);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::matmul";}
+
+private:
+    unsigned int batch;
+
+    // Input and output variables
+    std::vector<M> ivals1, ivals2, ovals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        ivals1.resize(batch);
+        ivals2.resize(batch);
+        ovals.resize(batch);
+    }
+
+    void prep()
+    {
+        iport1.read_n(ivals1, batch);
+        iport2.read_n(ivals2, batch);
+    }
+
+    void exec()
+    {
+        for (size_t i=0; i<batch; i++)
+            if (!ForSyDe::matmul(ovals[i], ivals1[i], ivals2[i]))
+                SC_REPORT_ERROR(name(), "the sizes of the operands do not match");
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, ovals);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a batched matrix product
+/*! This function is used to construct a matmul actor (SystemC module)
+ * and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename M, template <class> class I1If,
+                        template <class> class I2If,
+                        template <class> class OIf>
+inline matmul<M>* make_matmul(const std::string& pName,
+    unsigned int batch,
+    OIf<M>& outS,
+    I1If<M>& inp1S,
+    I2If<M>& inp2S
+    )
+{
+    auto p = new matmul<M>(pName.c_str(), batch);
+
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Abstract process constructor for a block random source
+/*! This class is used to build SDF actors which produce a block of
+ * independent samples of a distribution in each firing. The samples are
+ * generated by a counter-based generator whose stream is derived from
+ * the process name, hence each source has its own reproducible stream
+ * for a given seed.
+ */
+template <class Dist>
+class random_source : public sdf_process
+{
+public:
+    //! The type of the samples
+    typedef typename Dist::value_type value_type;
+
+    SDF_out<value_type> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name, the distribution, the rate and the seed
+    random_source(const sc_module_name& _name,  ///< process name
+                  const Dist& dist,             ///< the distribution
+                  unsigned int o1toks,          ///< tokens produced in each firing
+                  std::uint64_t seed            ///< the seed of the random stream
+                 ) : sdf_process(_name), oport1("oport1"), dist(dist),
+                     rng(seed, counter_rng::stream_of(name())), o1toks(o1toks)
+    {
+        add_out_rate(oport1, o1toks);
+    }
+
+    //! The generator of the random stream, e.g., to reseed it or jump ahead
+    counter_rng& generator() {return rng;}
+
+private:
+    Dist dist;
+    counter_rng rng;
+    unsigned int o1toks;
+
+    // Output variables
+    std::vector<value_type> o1vals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        o1vals.resize(o1toks);
+    }
+
+    void prep() {}
+
+    void exec()
+    {
+        dist.fill(rng, o1vals.data(), o1toks);
+    }
+
+    void prod()
+    {
+        write_vec_multiport(oport1, o1vals);
+    }
+
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, rng.position());}
+
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t n;
+        restore_values(pos, n);
+        rng.discard(n - rng.position());
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a block uniform random source
+/*! The samples are uniformly distributed in [lo,hi).
+ */
+class uniform : public random_source<uniform_dist>
+{
+public:
+    uniform(const sc_module_name& name_,    ///< The Process name
+            const double& lo,               ///< The lower bound
+            const double& hi,               ///< The upper bound (excluded)
+            unsigned int o1toks,            ///< tokens produced in each firing
+            std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+           ) : random_source(name_, uniform_dist{lo, hi}, o1toks, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lo", lo);
+        add_arg("hi", hi);
+        add_arg("o1toks", o1toks);
+        add_arg("seed", seed);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::uniform";}
+};
+
+//! Process constructor for a block Gaussian random source
+/*! The samples are normally distributed.
+ */
+class gaussian : public random_source<normal_dist>
+{
+public:
+    gaussian(const sc_module_name& name_,   ///< The Process name
+             const double& gaussVar,        ///< The variance
+             const double& gaussMean,       ///< The mean value
+             unsigned int o1toks,           ///< tokens produced in each firing
+             std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+            ) : random_source(name_, normal_dist{gaussMean, std::sqrt(gaussVar)},
+                              o1toks, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("gaussVar", gaussVar);
+        add_arg("gaussMean", gaussMean);
+        add_arg("o1toks", o1toks);
+        add_arg("seed", seed);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::gaussian";}
+};
+
+//! Process constructor for a block Poisson random source
+/*! The samples are counts based on the Poisson distribution.
+ */
+class poisson : public random_source<poisson_dist>
+{
+public:
+    poisson(const sc_module_name& name_,    ///< The Process name
+            const double& lambda,           ///< The mean value
+            unsigned int o1toks,            ///< tokens produced in each firing
+            std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+           ) : random_source(name_, poisson_dist{lambda}, o1toks, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lambda", lambda);
+        add_arg("o1toks", o1toks);
+        add_arg("seed", seed);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::poisson";}
+};
+
+//! Helper function to construct a block uniform random source
+/*! This function is used to construct a uniform source (SystemC module)
+ * and connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <template <class> class OIf>
+inline uniform* make_uniform(const std::string& pName,
+    const double& lo,           ///< The lower bound
+    const double& hi,           ///< The upper bound (excluded)
+    unsigned int o1toks,        ///< tokens produced in each firing
+    OIf<double>& outS
+    )
+{
+    auto p = new uniform(pName.c_str(), lo, hi, o1toks);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a block Gaussian random source
+/*! This function is used to construct a Gaussian source (SystemC module)
+ * and connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <template <class> class OIf>
+inline gaussian* make_gaussian(const std::string& pName,
+    const double& gaussVar,     ///< The variance
+    const double& gaussMean,    ///< The mean value
+    unsigned int o1toks,        ///< tokens produced in each firing
+    OIf<double>& outS
+    )
+{
+    auto p = new gaussian(pName.c_str(), gaussVar, gaussMean, o1toks);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a block Poisson random source
+/*! This function is used to construct a Poisson source (SystemC module)
+ * and connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <template <class> class OIf>
+inline poisson* make_poisson(const std::string& pName,
+    const double& lambda,       ///< The mean value
+    unsigned int o1toks,        ///< tokens produced in each firing
+    OIf<unsigned long>& outS
+    )
+{
+    auto p = new poisson(pName.c_str(), lambda, o1toks);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+}
+}
+#endif
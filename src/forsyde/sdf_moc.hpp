@@ -27,6 +27,9 @@
 #include "sdf_process.hpp"
 #include "sdf_process_constructors.hpp"
 #include "sdf_helpers.hpp"
+#include "sdf_process_constructors_static.hpp"
+#include "sdf_helpers_static.hpp"
+#include "sdf_scheduler.hpp"
 
 namespace ForSyDe
 {
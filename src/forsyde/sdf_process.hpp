@@ -20,7 +20,13 @@
  * abstract base process used in the SDF MoC.
  */
 
+#include <functional>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
 #include "abssemantics.hpp"
+#include "ut_process.hpp"
 
 namespace ForSyDe
 {
@@ -50,6 +56,98 @@ public:
 template <typename T>
 using signal = SDF2SDF<T>;
 
+//! A SDF signal based on the single-producer single-consumer ring buffer
+/*! It can be used instead of SDF::signal for signals with exactly one
+ * writer and one reader to avoid the sc_fifo overheads.
+ */
+template <typename T>
+class spsc_signal: public ForSyDe::signal<T,T,spsc_fifo>
+{
+public:
+    spsc_signal() : ForSyDe::signal<T,T,spsc_fifo>() {}
+    spsc_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,T,spsc_fifo>(name, size) {}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "SDF";
+    }
+#endif
+};
+
+#ifdef FORSYDE_SPILL_FIFO
+//! A SDF signal which spills its backlog to a file
+/*! It can be used instead of SDF::signal for the signals which may
+ * accumulate more tokens than fit in memory. The size is the number of
+ * tokens kept in each of its memory windows (see spill_fifo).
+ */
+template <typename T>
+class spill_signal: public ForSyDe::signal<T,T,spill_fifo>
+{
+public:
+    spill_signal() : ForSyDe::signal<T,T,spill_fifo>() {}
+    spill_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,T,spill_fifo>(name, size) {}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "SDF";
+    }
+#endif
+};
+#endif
+
+//! A SDF signal whose tokens can be accessed in place
+/*! It can be used instead of SDF::signal between the process
+ * constructors which work on views of their tokens (e.g., span_comb),
+ * so that their firings read and write the tokens in the storage of the
+ * channel instead of copying them. The other processes access it as a
+ * regular signal.
+ */
+template <typename T>
+class span_signal: public ForSyDe::signal<T,T,span_fifo>, public span_channel<T>
+{
+public:
+    span_signal() : ForSyDe::signal<T,T,span_fifo>() {}
+    span_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,T,span_fifo>(name, size) {}
+
+    token_span<const T> acquire_read(size_t n)
+    {
+        if (!this->fifo_direct()) return token_span<const T>();
+        return span_fifo<T>::acquire_read(n);
+    }
+
+    void release_read(size_t n)
+    {
+        span_fifo<T>::release_read(n);
+        for (size_t i=0; i<n; i++) this->note_taken();
+    }
+
+    token_span<T> reserve_write(size_t n)
+    {
+        if (!this->fifo_direct()) return token_span<T>();
+        return span_fifo<T>::reserve_write(n);
+    }
+
+    void commit_write(size_t n)
+    {
+        for (auto& tok : span_fifo<T>::commit_write(n)) this->note_written(tok);
+    }
+
+    //! Keeps the FIFO, which does not block the executor once it is large enough
+    void set_static_buffer(size_t capacity)
+    {
+        span_fifo<T>::set_capacity(std::max<size_t>(capacity, this->num_available()));
+    }
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "SDF";
+    }
+#endif
+};
+
 //! The SY_in port is used for input ports of SY processes
 template <typename T>
 class SDF_in: public ForSyDe::UT::UT_in<T>
@@ -90,8 +188,129 @@ public:
 template <typename T>
 using out_port = SDF_out<T>;
 
-//! Abstract semantics of a process in the SY MoC
-typedef ForSyDe::process sdf_process;
+//! Rate information of an SDF process port
+/*! It is used to perform static analyses (e.g., computing the
+ * repetition vector) and static scheduling of SDF graphs.
+ */
+/*! The ports of the cyclo-static processes (see ForSyDe::CSDF) have a
+ * rate per phase, and their toks is the total of a cycle of phases, so
+ * that the analyses which solve the balance equations count cycles for
+ * them.
+ */
+struct port_rate
+{
+    sc_object* port;            ///< the port
+    unsigned int toks;          ///< tokens consumed/produced in each firing (or cycle)
+    unsigned int init_toks;     ///< initial tokens produced in the init stage
+    //! Returns the channels bound to the port (valid after elaboration)
+    std::function<std::vector<sc_interface*>()> channels;
+    //! The tokens of each phase of a cyclo-static port, empty otherwise
+    std::vector<unsigned int> phases;
+    
+    //! The tokens consumed/produced in a firing of a phase
+    unsigned int at(size_t phase) const
+    {
+        return phases.empty() ? toks : phases[phase % phases.size()];
+    }
+};
+
+//! Abstract semantics of a process in the SDF MoC
+/*! In addition to the common abstract semantics, the SDF processes
+ * record the consumption and production rates of their ports.
+ */
+class sdf_process : public ForSyDe::process
+{
+public:
+    //! Rates of the input ports
+    std::vector<port_rate> in_rates;
+    //! Rates of the output ports
+    std::vector<port_rate> out_rates;
+    
+    //! The constructor only passes the name to the base process
+    sdf_process(sc_module_name _name) : ForSyDe::process(_name) {}
+    
+    //! Checks if the process has registered its port rates
+    bool has_rates() const {return !in_rates.empty() || !out_rates.empty();}
+    
+    //! The number of phases in a cycle of the process, one if it is not cyclo-static
+    size_t phases() const
+    {
+        size_t n = 1;
+        for (auto& r : in_rates) n = std::max(n, r.phases.size());
+        for (auto& r : out_rates) n = std::max(n, r.phases.size());
+        return n;
+    }
+    
+    //! Checks if the process can run several firings as a single block
+    /*! The static scheduler runs the blocked firings of such processes
+     * using fire_block() instead of firing them one by one.
+     */
+    virtual bool blockable() const {return false;}
+    
+    //! Runs n firings of the process as a single block
+    /*! The blockable processes read the tokens of all the firings at
+     * once, apply their function to them and write all of the results at
+     * once. By default, the process is simply fired n times.
+     */
+    virtual void fire_block(size_t n)
+    {
+        for (size_t k=0; k<n; k++) ext_fire();
+    }
+    
+protected:
+    //! The firing rule given by the rates of the ports
+    /*! It is used by the process constructors which can run in the
+     * method mode to implement firing_rule().
+     */
+    bool rate_firing_rule(std::vector<firing_port>& ins,
+                          std::vector<firing_port>& outs) const
+    {
+        for (auto& r : in_rates) ins.push_back({r.channels, r.toks});
+        for (auto& r : out_rates) outs.push_back({r.channels, r.toks});
+        return true;
+    }
+    
+    //! Registers the consumption rate of an input port
+    template <class PortType>
+    void add_in_rate(PortType& port, unsigned int toks)
+    {
+        in_rates.push_back({&port, toks, 0, [&port]()
+        {
+            std::vector<sc_interface*> chans;
+            for (int i=0; i<port.size(); i++) chans.push_back(port[i]);
+            return chans;
+        }});
+    }
+    
+    //! Registers the production rate and the initial tokens of an output port
+    template <class PortType>
+    void add_out_rate(PortType& port, unsigned int toks, unsigned int init_toks=0)
+    {
+        out_rates.push_back({&port, toks, init_toks, [&port]()
+        {
+            std::vector<sc_interface*> chans;
+            for (int i=0; i<port.size(); i++) chans.push_back(port[i]);
+            return chans;
+        }});
+    }
+    
+    //! Registers the consumption rates of the phases of a cyclo-static input port
+    template <class PortType>
+    void add_in_rate(PortType& port, const std::vector<unsigned int>& phases)
+    {
+        add_in_rate(port, std::accumulate(phases.begin(), phases.end(), 0u));
+        in_rates.back().phases = phases;
+    }
+    
+    //! Registers the production rates of the phases and the initial tokens of a cyclo-static output port
+    template <class PortType>
+    void add_out_rate(PortType& port, const std::vector<unsigned int>& phases,
+                      unsigned int init_toks=0)
+    {
+        add_out_rate(port, std::accumulate(phases.begin(), phases.end(), 0u), init_toks);
+        out_rates.back().phases = phases;
+    }
+};
 
 }
 }
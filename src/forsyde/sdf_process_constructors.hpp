@@ -23,10 +23,20 @@
  */
 
 #include <functional>
+#include <algorithm>
 #include <tuple>
 #include <vector>
 
 #include "sdf_process.hpp"
+#include "file_io.hpp"
+#include "token_stream.hpp"
+#include "memo_cache.hpp"
+#include "async_sink.hpp"
+#include "prefetch.hpp"
+
+#ifdef FORSYDE_MULTITHREADED
+#include "data_parallel_pool.hpp"
+#endif
 
 namespace ForSyDe
 {
@@ -39,9 +49,13 @@ using namespace sc_core;
 //! Process constructor for a combinational process (actor) with one input and one output
 /*! This class is used to build combinational processes with one input
  * and one output. The class is parameterized for input and output
- * data-types.
+ * data-types. The type of the function can also be given (e.g., the type
+ * of a lambda) so that it is called directly instead of through
+ * std::function.
  */
-template <typename T0, typename T1>
+template <typename T0, typename T1,
+          typename FuncType = std::function<void(std::vector<T0>&,
+                                                 const std::vector<T1>&)>>
 class comb : public sdf_process
 {
 public:
@@ -49,9 +63,7 @@ public:
     SDF_out<T0> oport1;       ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(std::vector<T0>&,
-                                const std::vector<T1>&
-                                )> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name ad the number of tokens to be produced
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -65,12 +77,49 @@ public:
          ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
              o1toks(o1toks), i1toks(i1toks), _func(_func)
     {
+        add_in_rate(iport1, i1toks);
+        add_out_rate(oport1, o1toks);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("o1toks",std::to_string(o1toks)));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+#endif
+    }
+    
+    //! Type of the function applied to a block of firings
+    /*! It gets the tokens of n firings in a row and produces the results
+     * of all of them.
+     */
+    typedef std::function<void(std::vector<T0>&, const std::vector<T1>&,
+                               size_t)> batchtype;
+    
+    //! Sets a function which is applied to a block of firings at once
+    /*! Without it, the blocked firings apply the function of the process
+     * to the tokens of each firing in turn.
+     */
+    void set_batch_func(const batchtype& _bfunc) {this->_bfunc = _bfunc;}
+    
+    //! The process is combinational, hence its firings can be blocked
+    bool blockable() const {return true;}
+    
+    //! Runs n firings, reading and writing the tokens of all of them at once
+    void fire_block(size_t n)
+    {
+        bi1vals.resize(n*i1toks);
+        bo1vals.resize(n*o1toks);
+        iport1.read_n(bi1vals, bi1vals.size());
+        if (_bfunc)
+            _bfunc(bo1vals, bi1vals, n);
+        else
+            for (size_t k=0; k<n; k++)
+            {
+                std::copy_n(bi1vals.begin()+k*i1toks, i1toks, i1vals.begin());
+                _func(o1vals, i1vals);
+                std::copy_n(o1vals.begin(), o1toks, bo1vals.begin()+k*o1toks);
+            }
+        write_vec_multiport(oport1, bo1vals);
+#ifdef FORSYDE_PROFILE
+        prof.firings += n;
 #endif
     }
     
@@ -85,9 +134,16 @@ private:
     std::vector<T0> o1vals;
     std::vector<T1> i1vals;
     
+    // Inputs and output variables of the blocked firings
+    std::vector<T0> bo1vals;
+    std::vector<T1> bi1vals;
+    
     //! The function passed to the process constructor
     functype _func;
     
+    //! The function applied to the blocked firings, if any
+    batchtype _bfunc;
+    
     //Implementing the abstract semantics
     void init()
     {
@@ -97,8 +153,7 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
+        iport1.read_n(i1vals, i1vals.size());
     }
     
     void exec()
@@ -113,6 +168,380 @@ private:
     
     void clean() {}
     
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const {return vector_bytes(o1vals, i1vals, bo1vals, bi1vals);}
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a combinational actor which works on its tokens in place
+/*! Similar to comb, but the function gets views of the slots of the
+ * output tokens and of the input tokens instead of vectors. When the
+ * signals are span_signals, the views point to the storage of the
+ * signals, so that the tokens are neither copied in nor out of the
+ * process. Otherwise, or when a signal can not give a view (e.g., it
+ * uses a static buffer or forwards its tokens), the process falls back
+ * to local vectors. With several output signals, the tokens are
+ * produced in place in the first one and copied to the others.
+ *
+ * The views are only valid during the call of the function.
+ */
+template <typename T0, typename T1>
+class span_comb : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+    SDF_out<T0> oport1;       ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(token_span<T0>, token_span<const T1>)> functype;
+
+    //! The constructor requires the module name ad the number of tokens to be produced
+    /*! It creates an SC_THREAD which acquires the input tokens,
+     * applies the user-imlpemented function to them and commits the
+     * results to the output
+     */
+    span_comb(sc_module_name _name,      ///< process name
+              functype _func,           ///< function to be passed
+              unsigned int o1toks,      ///< consumption rate for the first output
+              unsigned int i1toks       ///< consumption rate for the first input
+              ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+                  o1toks(o1toks), i1toks(i1toks), _func(_func)
+    {
+        add_in_rate(iport1, i1toks);
+        add_out_rate(oport1, o1toks);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::span_comb";}
+
+private:
+    // consumption rates
+    unsigned int o1toks, i1toks;
+    
+    // The local tokens used when a signal can not give a view
+    std::vector<T0> o1vals;
+    std::vector<T1> i1vals;
+    
+    // The signals which give views, if any
+    span_channel<T1>* i1chan;
+    span_channel<T0>* o1chan;
+    
+    // The views of the current firing
+    token_span<const T1> i1span;
+    token_span<T0> o1span;
+    bool i1direct, o1direct;
+    
+    //! The function passed to the process constructor
+    functype _func;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        i1chan = dynamic_cast<span_channel<T1>*>(iport1[0]);
+        o1chan = dynamic_cast<span_channel<T0>*>(oport1[0]);
+    }
+    
+    void prep()
+    {
+        i1span = i1chan ? i1chan->acquire_read(i1toks) : token_span<const T1>();
+        i1direct = i1span.data() != NULL;
+        if (!i1direct)
+        {
+            i1vals.resize(i1toks);
+            iport1.read_n(i1vals, i1vals.size());
+            i1span = i1vals;
+        }
+        o1span = o1chan ? o1chan->reserve_write(o1toks) : token_span<T0>();
+        o1direct = o1span.data() != NULL;
+        if (!o1direct)
+        {
+            o1vals.resize(o1toks);
+            o1span = o1vals;
+        }
+    }
+    
+    void exec()
+    {
+        _func(o1span, i1span);
+    }
+    
+    void prod()
+    {
+        if (i1direct) i1chan->release_read(i1toks);
+        if (o1direct)
+        {
+            for (int i=1; i<oport1.size(); i++)
+                for (auto& tok : o1span) oport1[i]->write(tok);
+            o1chan->commit_write(o1toks);
+        }
+        else
+            write_vec_multiport(oport1, o1vals);
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const {return vector_bytes(o1vals, i1vals);}
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a memoizing combinational actor with one input and one output
+/*! Similar to comb, but the output tokens of the function are cached for
+ * the recent sequences of input tokens, and the function is only called
+ * for the sequences which are not in the cache. Hence, it is only
+ * suitable for pure functions. The number of the cache hits and misses
+ * is reported in the profile of the process when FORSYDE_PROFILE is
+ * defined.
+ *
+ * The input type should be hashable with memo_hash and comparable.
+ */
+template <typename T0, typename T1>
+class memo_comb : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+    SDF_out<T0> oport1;       ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(std::vector<T0>&, const std::vector<T1>&)> functype;
+
+    //! The constructor requires the module name, the rates and the cache capacity
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it if its result is not
+     * cached and writes the results using the output port
+     */
+    memo_comb(sc_module_name _name,      ///< process name
+              functype _func,           ///< function to be passed
+              unsigned int o1toks,      ///< consumption rate for the first output
+              unsigned int i1toks,      ///< consumption rate for the first input
+              size_t capacity=FORSYDE_MEMO_CAPACITY ///< the number of cached results
+             ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+                 o1toks(o1toks), i1toks(i1toks), _func(_func), cache(capacity)
+    {
+        add_in_rate(iport1, i1toks);
+        add_out_rate(oport1, o1toks);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+        add_arg("capacity", capacity);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::memo_comb";}
+
+private:
+    // consumption rates
+    unsigned int o1toks, i1toks;
+    
+    // Inputs and output variables
+    std::vector<T0> o1vals;
+    std::vector<T1> i1vals;
+    
+    //! The function passed to the process constructor
+    functype _func;
+    
+    //! The cached results of the function
+    memo_cache<std::vector<T1>,std::vector<T0>> cache;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        o1vals.resize(o1toks);
+        i1vals.resize(i1toks);
+    }
+    
+    void prep()
+    {
+        iport1.read_n(i1vals, i1vals.size());
+    }
+    
+    void exec()
+    {
+        if (const std::vector<T0>* res = cache.find(i1vals))
+            std::copy(res->begin(), res->end(), o1vals.begin());
+        else
+        {
+            _func(o1vals, i1vals);
+            cache.insert(i1vals, o1vals);
+        }
+#ifdef FORSYDE_PROFILE
+        prof.memo_hits = cache.hits();
+        prof.memo_misses = cache.misses();
+#endif
+    }
+    
+    void prod()
+    {
+        write_vec_multiport(oport1, o1vals);
+    }
+    
+    void clean()
+    {
+        cache.clear();
+    }
+    
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const {return vector_bytes(o1vals, i1vals);}
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a farm of a stateless actor with one input and one output
+/*! This class is used to build an actor similar to comb, where each
+ * evaluation cycle performs a number of consecutive firings of the
+ * function. Since the function has no state, the firings are
+ * independent and are executed in parallel on the data_parallel_pool
+ * when FORSYDE_MULTITHREADED is defined. The outputs are written in the
+ * order of the firings, hence the produced stream is the same as that
+ * of the corresponding comb.
+ *
+ * The consumption and production rates of the whole cycle are the
+ * given rates multiplied by the number of firings, which should be
+ * taken into account in the feedback loops of the model.
+ */
+template <typename T0, typename T1>
+class farm : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+    SDF_out<T0> oport1;       ///< port for the output channel
+
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(std::vector<T0>&,
+                               const std::vector<T1>&)> functype;
+
+    //! The constructor requires the module name, the rates and the number of firings
+    /*! It creates an SC_THREAD which reads the data of several firings
+     * from its input port, applies the user-imlpemented function to the
+     * data of each firing and writes the results using the output port
+     */
+    farm(sc_module_name _name,      ///< process name
+         functype _func,           ///< the stateless function to be passed
+         unsigned int o1toks,      ///< production rate of a firing
+         unsigned int i1toks,      ///< consumption rate of a firing
+         unsigned int firings      ///< the number of firings in each cycle
+         ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+             o1toks(o1toks), i1toks(i1toks), firings(firings), _func(_func)
+    {
+        if (firings == 0)
+            SC_REPORT_ERROR(name(), "the number of firings of a farm should be positive");
+        add_in_rate(iport1, i1toks*firings);
+        add_out_rate(oport1, o1toks*firings);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+        add_arg("firings", firings);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::farm";}
+
+private:
+    // consumption rates
+    unsigned int o1toks, i1toks;
+
+    //! The number of firings in each evaluation cycle
+    unsigned int firings;
+
+    // Inputs and output variables of each firing
+    std::vector<std::vector<T0>> o1vals;
+    std::vector<std::vector<T1>> i1vals;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        o1vals.assign(firings, std::vector<T0>(o1toks));
+        i1vals.assign(firings, std::vector<T1>(i1toks));
+    }
+
+    void prep()
+    {
+        for (auto& v : i1vals)
+            iport1.read_n(v.data(), i1toks);
+    }
+
+    void exec()
+    {
+#ifdef FORSYDE_MULTITHREADED
+        data_parallel_pool::get().parallel_for(firings,
+            [this](size_t begin, size_t end, unsigned)
+            {
+                for (size_t k=begin; k<end; k++)
+                    _func(o1vals[k], i1vals[k]);
+            });
+#else
+        for (unsigned int k=0; k<firings; k++)
+            _func(o1vals[k], i1vals[k]);
+#endif
+    }
+
+    void prod()
+    {
+        for (auto& v : o1vals)
+            write_vec_multiport(oport1, v);
+    }
+
+    void clean() {}
+
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -127,7 +556,10 @@ private:
 //! Process constructor for a combinational process with two inputs and one output
 /*! similar to comb with two inputs
  */
-template <typename T0, typename T1, typename T2>
+template <typename T0, typename T1, typename T2,
+          typename FuncType = std::function<void(std::vector<T0>&,
+                                                 const std::vector<T1>&,
+                                                 const std::vector<T2>&)>>
 class comb2 : public sdf_process
 {
 public:
@@ -136,10 +568,7 @@ public:
     SDF_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(std::vector<T0>&,
-                                const std::vector<T1>&,
-                                const std::vector<T2>&
-                                )> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -154,13 +583,48 @@ public:
           ) : sdf_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1"),
               o1toks(o1toks), i1toks(i1toks), i2toks(i2toks), _func(_func)
     {
+        add_in_rate(iport1, i1toks);
+        add_in_rate(iport2, i2toks);
+        add_out_rate(oport1, o1toks);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("o1toks",std::to_string(o1toks)));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
+#endif
+    }
+    
+    //! Type of the function applied to a block of firings
+    typedef std::function<void(std::vector<T0>&, const std::vector<T1>&,
+                               const std::vector<T2>&, size_t)> batchtype;
+    
+    //! Sets a function which is applied to a block of firings at once
+    void set_batch_func(const batchtype& _bfunc) {this->_bfunc = _bfunc;}
+    
+    //! The process is combinational, hence its firings can be blocked
+    bool blockable() const {return true;}
+    
+    //! Runs n firings, reading and writing the tokens of all of them at once
+    void fire_block(size_t n)
+    {
+        bi1vals.resize(n*i1toks);
+        bi2vals.resize(n*i2toks);
+        bo1vals.resize(n*o1toks);
+        iport1.read_n(bi1vals, bi1vals.size());
+        iport2.read_n(bi2vals, bi2vals.size());
+        if (_bfunc)
+            _bfunc(bo1vals, bi1vals, bi2vals, n);
+        else
+            for (size_t k=0; k<n; k++)
+            {
+                std::copy_n(bi1vals.begin()+k*i1toks, i1toks, i1vals.begin());
+                std::copy_n(bi2vals.begin()+k*i2toks, i2toks, i2vals.begin());
+                _func(o1vals, i1vals, i2vals);
+                std::copy_n(o1vals.begin(), o1toks, bo1vals.begin()+k*o1toks);
+            }
+        write_vec_multiport(oport1, bo1vals);
+#ifdef FORSYDE_PROFILE
+        prof.firings += n;
 #endif
     }
     
@@ -175,8 +639,16 @@ private:
     std::vector<T1> i1vals;
     std::vector<T2> i2vals;
     
+    // Inputs and output variables of the blocked firings
+    std::vector<T0> bo1vals;
+    std::vector<T1> bi1vals;
+    std::vector<T2> bi2vals;
+    
     //! The function passed to the process constructor
     functype _func;
+    
+    //! The function applied to the blocked firings, if any
+    batchtype _bfunc;
 
     //Implementing the abstract semantics
     void init()
@@ -188,10 +660,8 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
     }
     
     void exec()
@@ -206,6 +676,16 @@ private:
     
     void clean() {}
     
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const {return vector_bytes(o1vals, i1vals, i2vals, bo1vals, bi1vals, bi2vals);}
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -221,7 +701,11 @@ private:
 //! Process constructor for a combinational process with two inputs and one output
 /*! similar to comb with two inputs
  */
-template <typename T0, typename T1, typename T2, typename T3>
+template <typename T0, typename T1, typename T2, typename T3,
+          typename FuncType = std::function<void(std::vector<T0>&,
+                                                 const std::vector<T1>&,
+                                                 const std::vector<T2>&,
+                                                 const std::vector<T3>&)>>
 class comb3 : public sdf_process
 {
 public:
@@ -231,11 +715,7 @@ public:
     SDF_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(std::vector<T0>&,
-                                const std::vector<T1>&,
-                                const std::vector<T2>&,
-                                const std::vector<T3>&
-                                )> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -252,14 +732,16 @@ public:
               oport1("oport1"),
               o1toks(o1toks), i1toks(i1toks), i2toks(i2toks), i3toks(i3toks), _func(_func)
     {
+        add_in_rate(iport1, i1toks);
+        add_in_rate(iport2, i2toks);
+        add_in_rate(iport3, i3toks);
+        add_out_rate(oport1, o1toks);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("o1toks",std::to_string(o1toks)));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
-        arg_vec.push_back(std::make_tuple("i3toks",std::to_string(i3toks)));
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
+        add_arg("i3toks", i3toks);
 #endif
     }
     
@@ -289,12 +771,9 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
-        for (auto it=i3vals.begin();it!=i3vals.end();it++)
-            *it = iport3.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
+        iport3.read_n(i3vals, i3vals.size());
     }
     
     void exec()
@@ -309,6 +788,16 @@ private:
     
     void clean() {}
     
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const {return vector_bytes(o1vals, i1vals, i2vals, i3vals);}
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -325,7 +814,12 @@ private:
 //! Process constructor for a combinational process with two inputs and one output
 /*! similar to comb with two inputs
  */
-template <typename T0, typename T1, typename T2, typename T3, typename T4>
+template <typename T0, typename T1, typename T2, typename T3, typename T4,
+          typename FuncType = std::function<void(std::vector<T0>&,
+                                                 const std::vector<T1>&,
+                                                 const std::vector<T2>&,
+                                                 const std::vector<T3>&,
+                                                 const std::vector<T4>&)>>
 class comb4 : public sdf_process
 {
 public:
@@ -336,12 +830,7 @@ public:
     SDF_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(std::vector<T0>&,
-                                const std::vector<T1>&,
-                                const std::vector<T2>&,
-                                const std::vector<T3>&,
-                                const std::vector<T4>&
-                                )> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -360,15 +849,18 @@ public:
               o1toks(o1toks), i1toks(i1toks), i2toks(i2toks), i3toks(i3toks),
               i4toks(i4toks), _func(_func)
     {
+        add_in_rate(iport1, i1toks);
+        add_in_rate(iport2, i2toks);
+        add_in_rate(iport3, i3toks);
+        add_in_rate(iport4, i4toks);
+        add_out_rate(oport1, o1toks);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("o1toks",std::to_string(o1toks)));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
-        arg_vec.push_back(std::make_tuple("i3toks",std::to_string(i3toks)));
-        arg_vec.push_back(std::make_tuple("i4toks",std::to_string(i4toks)));
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", o1toks);
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
+        add_arg("i3toks", i3toks);
+        add_arg("i4toks", i4toks);
 #endif
     }
     
@@ -400,14 +892,10 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
-        for (auto it=i3vals.begin();it!=i3vals.end();it++)
-            *it = iport3.read();
-        for (auto it=i4vals.begin();it!=i4vals.end();it++)
-            *it = iport4.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
+        iport3.read_n(i3vals, i3vals.size());
+        iport4.read_n(i4vals, i4vals.size());
     }
     
     void exec()
@@ -422,6 +910,16 @@ private:
     
     void clean() {}
     
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const {return vector_bytes(o1vals, i1vals, i2vals, i3vals, i4vals);}
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -452,6 +950,9 @@ public:
     typedef std::function<void(std::tuple<std::vector<TOs>...>&, 
                                 const std::tuple<std::vector<TIs>...>&)> functype;
 
+    //! Type of the function which takes the outputs and the inputs as separate arguments
+    typedef std::function<void(std::vector<TOs>&..., const std::vector<TIs>&...)> vfunctype;
+
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
      * applies the user-imlpemented function to them and writes the
@@ -463,18 +964,20 @@ public:
           std::array<size_t, sizeof...(TIs)> itoks  ///< consumption rates for the inputs
           ) : sdf_process(_name), otoks(otoks), itoks(itoks), _func(_func)
     {
-#ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << itoks;
-        arg_vec.push_back(std::make_tuple("otoks",ss.str()));
-        ss.clear();
-        ss.str(std::string());
-        ss << otoks;
-        arg_vec.push_back(std::make_tuple("itoks",ss.str()));
-#endif
+        add_rates();
+    }
+
+    //! The constructor with a function taking separate arguments
+    /*! The token vectors are passed to the function directly from the
+     * in-object buffers of the process, without building the tuples.
+     */
+    combMN(sc_module_name _name,      ///< process name
+          vfunctype _vfunc,          ///< function to be passed
+          std::array<size_t, sizeof...(TOs)> otoks, ///< consumption rate for the outputs
+          std::array<size_t, sizeof...(TIs)> itoks  ///< consumption rates for the inputs
+          ) : sdf_process(_name), otoks(otoks), itoks(itoks), _vfunc(_vfunc)
+    {
+        add_rates();
     }
     
     //! Specifying from which process constructor is the module built
@@ -490,6 +993,25 @@ private:
     
     //! The function passed to the process constructor
     functype _func;
+    vfunctype _vfunc;
+
+    //! Registers the rates of the ports
+    void add_rates()
+    {
+        std::apply([&](auto&... ports) {
+            std::size_t n{0};
+            (add_in_rate(ports, itoks[n++]), ...);
+        }, iport);
+        std::apply([&](auto&... ports) {
+            std::size_t n{0};
+            (add_out_rate(ports, otoks[n++]), ...);
+        }, oport);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("otoks", otoks);
+        add_arg("itoks", itoks);
+#endif
+    }
 
     //Implementing the abstract semantics
     void init()
@@ -513,8 +1035,7 @@ private:
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport](){
-                        for (auto it=ival.begin();it!=ival.end();it++)
-                            *it = inport.read();
+                        inport.read_n(ival, ival.size());
                     }()
                 , ...);
             }, ivals);
@@ -523,7 +1044,14 @@ private:
     
     void exec()
     {
-        _func(ovals, ivals);
+        if (_vfunc)
+            std::apply([&](auto&... oval) {
+                std::apply([&](const auto&... ival) {
+                    _vfunc(oval..., ival...);
+                }, ivals);
+            }, ovals);
+        else
+            _func(ovals, ivals);
     }
     
     void prod()
@@ -537,6 +1065,20 @@ private:
     
     void clean() {}
     
+#ifdef FORSYDE_MEMORY_REPORT
+    size_t buffer_bytes() const
+    {
+        return std::apply([](auto&... v) {return vector_bytes(v...);}, ovals) +
+               std::apply([](auto&... v) {return vector_bytes(v...);}, ivals);
+    }
+#endif
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -589,10 +1131,10 @@ public:
           ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
               init_val(init_val)
     {
+        add_in_rate(iport1, 1);
+        add_out_rate(oport1, 1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
+        add_arg("init_val", init_val);
 #endif
     }
     
@@ -610,7 +1152,8 @@ private:
     void init()
     {
         val = new T;
-        write_multiport(oport1, init_val);
+        // the initial token is restored with the signal
+        if (!is_restored()) write_multiport(oport1, init_val);
     }
     
     void prep()
@@ -629,6 +1172,13 @@ private:
     {
         delete val;
     }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -666,11 +1216,11 @@ public:
           ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
               init_val(init_val), ns(n)
     {
+        add_in_rate(iport1, 1);
+        add_out_rate(oport1, 1, n);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("n", std::to_string(n)));
+        add_arg("init_val", init_val);
+        add_arg("n", n);
 #endif
     }
     
@@ -689,6 +1239,7 @@ private:
     void init()
     {
         val = new T;
+        if (is_restored()) return;
         for (unsigned int i=0; i<ns; i++)
             write_multiport(oport1, init_val);
     }
@@ -709,6 +1260,13 @@ private:
     {
         delete val;
     }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -727,7 +1285,7 @@ private:
  * This class can directly be instantiated to build a process.
  */
 template <class T>
-class constant : public sdf_process
+class constant : public sdf_process, public constant_source
 {
 public:
     SDF_out<T> oport1;            ///< port for the output channel
@@ -743,16 +1301,18 @@ public:
                  init_val(init_val), take(take)
                  
     {
+        add_out_rate(oport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("take", std::to_string(take)));
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SDF::constant";}
+
+    //! Checks if the process produces its tokens forever
+    bool is_endless() const {return take == 0;}
     
 private:
     T init_val;
@@ -781,6 +1341,11 @@ private:
     
     void clean() {}
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -816,17 +1381,20 @@ public:
           ) : sdf_process(_name), oport1("oport1"),
               init_st(init_val), take(take), _func(_func)
     {
+        add_out_rate(oport1, 1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("take", std::to_string(take)));
+        add_func_arg("_func", "_func");
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
+    //! Computes the next states in blocks in a background thread
+    /*! The function should only depend on the state (see
+     * state_prefetcher). It should be called before the simulation starts.
+     */
+    void set_prefetch(size_t block=256) {pf_block = block;}
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SDF::source";}
     
@@ -840,13 +1408,17 @@ private:
     
     //! The function passed to the process constructor
     functype _func;
+
+    // the block size and the generator of the prefetched states, if any
+    size_t pf_block = 0;
+    std::unique_ptr<state_prefetcher<T>> pf;
     
     //Implementing the abstract semantics
     void init()
     {
         cur_st = new T;
         *cur_st = init_st;
-        write_multiport(oport1, *cur_st);
+        if (!is_restored()) write_multiport(oport1, *cur_st);
         if (take==0) infinite = true;
         tok_cnt = 1;
     }
@@ -855,7 +1427,15 @@ private:
     
     void exec()
     {
-        _func(*cur_st, *cur_st);
+        if (pf_block == 0)
+        {
+            _func(*cur_st, *cur_st);
+            return;
+        }
+        if (!pf)
+            pf.reset(new state_prefetcher<T>(_func, *cur_st, pf_block,
+                                             take == 0 ? 0 : take - tok_cnt + 1));
+        pf->next(*cur_st);
     }
     
     void prod()
@@ -867,9 +1447,15 @@ private:
     
     void clean()
     {
+        pf.reset();
         delete cur_st;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *cur_st, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *cur_st, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -905,12 +1491,11 @@ public:
           ) : sdf_process(_name), oport1("oport1"),
               file_name(file_name), _func(_func)
     {
+        add_out_rate(oport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
         arg_vec.push_back(std::make_tuple("file_name", file_name));
-        arg_vec.push_back(std::make_tuple("o1toks", std::to_string(1)));
+        add_arg("o1toks", 1);
 #endif
     }
     
@@ -922,6 +1507,7 @@ private:
     
     std::string cur_str;        // The current string read from the input
     std::ifstream ifs;
+    std::vector<char> ibuf;     // The stream buffer of the input
     T* cur_val;
     
     //! The function passed to the process constructor
@@ -931,6 +1517,9 @@ private:
     void init()
     {
         cur_val = new T;
+        // a large buffer, which must be set before opening
+        ibuf.resize(FORSYDE_FILE_BUFFER);
+        ifs.rdbuf()->pubsetbuf(ibuf.data(), ibuf.size());
         ifs.open(file_name);
         if (!ifs.is_open())
         {
@@ -962,6 +1551,114 @@ private:
         delete cur_val;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        serializer<std::int64_t>::write(buf, std::int64_t(ifs.tellg()));
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::int64_t off;
+        serializer<std::int64_t>::read(pos, off);
+        if (off < 0)
+            ifs.seekg(0, std::ios::end);
+        else
+            ifs.seekg(off);
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a binary file source process
+/*! This class is used to build a souce process which only has an output.
+ * The input file is an array of values of type T in the host
+ * representation, which should be trivially copyable. The file is mapped
+ * into the memory and each firing writes a slice of o1toks values to the
+ * output, directly from the file contents. The remaining values which
+ * do not fill a slice are dropped.
+ * It can be used in test-benches with large stimulus files.
+ */
+template <class T>
+class binary_file_source : public sdf_process
+{
+public:
+    SDF_out<T> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the values of the file using
+     * the output port
+     */
+    binary_file_source(sc_module_name _name,       ///< process name
+                       std::string file_name,      ///< the file name
+                       unsigned int o1toks=1       ///< values per firing
+                      ) : sdf_process(_name), oport1("oport1"),
+                          file_name(file_name), o1toks(o1toks)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "the values of a binary file should be trivially copyable");
+        add_out_rate(oport1, o1toks);
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("file_name", file_name));
+        add_arg("o1toks", o1toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::binary_file_source";}
+    
+private:
+    std::string file_name;
+    unsigned int o1toks;
+    
+    mapped_file mfile;
+    const T* vals;          // The values in the mapped file
+    size_t count, pos;      // The number of values and the current one
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!mfile.open(file_name))
+        {
+            SC_REPORT_ERROR(name(),"cannot open the file.");
+        }
+        vals = reinterpret_cast<const T*>(mfile.data());
+        count = mfile.size() / sizeof(T);
+        pos = 0;
+    }
+    
+    void prep()
+    {
+        if (count - pos < o1toks)
+        {
+            wait();
+        }
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        pos += o1toks;
+        oport1.write_n(vals+pos-o1toks, o1toks);
+    }
+    
+    void clean()
+    {
+        mfile.close();
+    }
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, this->pos);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, this->pos);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -990,10 +1687,9 @@ public:
             const std::vector<T>& in_vec  ///< Initial vector
             ) : sdf_process(_name), in_vec(in_vec)
     {
+        add_out_rate(oport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << in_vec;
-        arg_vec.push_back(std::make_tuple("in_vec", ss.str()));
+        add_arg("in_vec", in_vec);
 #endif
     }
     
@@ -1018,16 +1714,105 @@ private:
     void prod()
     {
         if (itr != in_vec.end())
-        {
-            write_multiport(oport1, *itr);
-            ++itr;
-        }
+            write_multiport(oport1, *itr++);
         else
             wait();
     }
     
     void clean() {}
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, std::uint64_t(itr - in_vec.begin()));
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t i;
+        restore_values(pos, i);
+        itr = in_vec.begin() + i;
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a source process with streamed input
+/*! This class is used to build a souce process which only has an output.
+ * It outputs the values of a token_stream, one token in each firing,
+ * like vsource does for the values of a vector. The values are pulled
+ * from the stream in chunks, hence the stimulus is never kept in the
+ * memory as a whole.
+ */
+template <class T>
+class stream_source : public sdf_process
+{
+public:
+    SDF_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the result using the output
+     * port.
+     */
+    stream_source(const sc_module_name& _name,              ///< process name
+                  std::shared_ptr<token_stream<T>> stream   ///< the stimulus stream
+                  ) : sdf_process(_name), reader(stream)
+    {
+        add_out_rate(oport1, 1);
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("stream", reader.describe()));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::stream_source";}
+    
+private:
+    stream_reader<T> reader;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!reader.good())
+            SC_REPORT_ERROR(name(),"cannot read the stream.");
+        if (!reader.seek(0))
+            SC_REPORT_ERROR(name(),"the stream can not be rewound.");
+    }
+    
+    void prep() {}
+    
+    void exec() {}
+    
+    void prod()
+    {
+        if (auto val = reader.next())
+            write_multiport(oport1, *val);
+        else
+            wait();
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, std::uint64_t(reader.position()));
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t i;
+        restore_values(pos, i);
+        if (!reader.seek(i))
+            SC_REPORT_ERROR(name(),"the stream can not be moved to the checkpoint.");
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1060,14 +1845,23 @@ public:
         ) : sdf_process(_name), iport1("iport1"), _func(_func)
             
     {
+        add_in_rate(iport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("i1toks", std::to_string(1)));
+        add_func_arg("_func", "_func");
+        add_arg("i1toks", 1);
 #endif
     }
     
+    //! Runs the function in a background thread instead of the simulation thread
+    /*! The tokens are passed to the thread through a bounded queue with
+     * the given capacity and policy (see async_consumer). It should be
+     * called before the simulation starts.
+     */
+    void set_async(size_t capacity=1024, async_backpressure policy=ASYNC_BLOCK)
+    {
+        async.reset(new async_consumer<T>(this->name(), _func, capacity, policy));
+    }
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SDF::sink";}
     
@@ -1076,6 +1870,9 @@ private:
 
     //! The function passed to the process constructor
     functype _func;
+
+    // the background consumer of the tokens, if any
+    std::unique_ptr<async_consumer<T>> async;
     
     //Implementing the abstract semantics
     void init()
@@ -1090,13 +1887,17 @@ private:
     
     void exec()
     {
-        _func(*val);
+        if (async)
+            async->push(*val);
+        else
+            _func(*val);
     }
     
     void prod() {}
     
     void clean()
     {
+        if (async) async->flush();
         delete val;
     }
     
@@ -1135,12 +1936,11 @@ public:
             _func(_func)
             
     {
+        add_in_rate(iport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
         arg_vec.push_back(std::make_tuple("file_name", file_name));
-        arg_vec.push_back(std::make_tuple("i1toks", std::to_string(1)));
+        add_arg("i1toks", 1);
 #endif
     }
     
@@ -1151,7 +1951,7 @@ private:
     std::string file_name;
     
     std::string ostr;        // The current string to be written to the output
-    std::ofstream ofs;
+    async_file_writer writer;
     T* cur_val;         // The current state of the process
 
     //! The function passed to the process constructor
@@ -1161,8 +1961,7 @@ private:
     void init()
     {
         cur_val = new T;
-        ofs.open(file_name);
-        if (!ofs.is_open())
+        if (!writer.open(file_name))
         {
             SC_REPORT_ERROR(name(),"cannot open the file.");
         }
@@ -1180,12 +1979,14 @@ private:
     
     void prod()
     {
-        ofs << ostr << std::endl;
+        writer.write_line(ostr);
     }
     
     void clean()
     {
-        ofs.close();
+        writer.close();
+        if (writer.has_failed())
+            SC_REPORT_WARNING(name(),"writing to the file has failed.");
         delete cur_val;
     }
     
@@ -1198,6 +1999,85 @@ private:
 #endif
 };
 
+//! Process constructor for a binary file sink process
+/*! This class is used to build a sink process which only has an input.
+ * Each firing appends a slice of i1toks input values to the output file
+ * in the host representation, hence it can be read by
+ * binary_file_source. The file is written by a separate thread using
+ * large blocks. T should be trivially copyable.
+ */
+template <class T>
+class binary_file_sink : public sdf_process
+{
+public:
+    SDF_in<T> iport1;         ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the input values to the
+     * file in each firing.
+     */
+    binary_file_sink(sc_module_name _name,      ///< process name
+                     std::string file_name,     ///< the file name
+                     unsigned int i1toks=1      ///< values per firing
+                    ) : sdf_process(_name), iport1("iport1"),
+                        file_name(file_name), i1toks(i1toks)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "the values of a binary file should be trivially copyable");
+        add_in_rate(iport1, i1toks);
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("file_name", file_name));
+        add_arg("i1toks", i1toks);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::binary_file_sink";}
+    
+private:
+    std::string file_name;
+    unsigned int i1toks;
+    
+    async_file_writer writer;
+    std::vector<T> ivals;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!writer.open(file_name))
+        {
+            SC_REPORT_ERROR(name(),"cannot open the file.");
+        }
+    }
+    
+    void prep()
+    {
+        iport1.read_n(ivals, i1toks);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        writer.write(ivals.data(), ivals.size()*sizeof(T));
+    }
+    
+    void clean()
+    {
+        writer.close();
+        if (writer.has_failed())
+            SC_REPORT_WARNING(name(),"writing to the file has failed.");
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);    // only one output port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
 //! Process constructor for a multi-input print process
 /*! This class is used to build a sink process which has a multi-port input.
  * Its main purpose is to be used in test-benches.
@@ -1266,9 +2146,12 @@ public:
     ) : sdf_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1"),
         i1toks(i1toks), i2toks(i2toks)
     {
+        add_in_rate(iport1, i1toks);
+        add_in_rate(iport2, i2toks);
+        add_out_rate(oport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
 #endif
     }
     
@@ -1291,10 +2174,8 @@ private:
     
     void prep()
     {
-        for (auto i=0; i<i1toks; i++)
-            ival1[i] = iport1.read();
-        for (auto i=0; i<i2toks; i++)
-            ival2[i] = iport2.read();    
+        iport1.read_n(ival1, i1toks);
+        iport2.read_n(ival2, i2toks);
     }
     
     void exec() {}
@@ -1336,10 +2217,13 @@ public:
          std::array<size_t, sizeof...(Ts)> in_toks)
           :sdf_process(_name), oport1("oport1"), in_toks(in_toks)
     {
+        std::apply([&](auto&... ports) {
+            std::size_t n{0};
+            (add_in_rate(ports, in_toks[n++]), ...);
+        }, iport);
+        add_out_rate(oport1, 1);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << in_toks;
-        arg_vec.push_back(std::make_tuple("itoks",ss.str()));
+        add_arg("itoks", in_toks);
 #endif
     }
     
@@ -1366,8 +2250,7 @@ private:
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport](){
-                        for (auto it=ival.begin();it!=ival.end();it++)
-                            *it = inport.read();
+                        inport.read_n(ival, ival.size());
                     }()
                 , ...);
             }, *in_val);
@@ -1427,9 +2310,12 @@ public:
          :sdf_process(_name), iport1("iport1"), oport1("oport1"), oport2("oport2"),
           o1toks(o1toks), o2toks(o2toks)
     {
+        add_in_rate(iport1, 1);
+        add_out_rate(oport1, o1toks);
+        add_out_rate(oport2, o2toks);
 #ifdef FORSYDE_INTROSPECTION
-        arg_vec.push_back(std::make_tuple("o1toks",std::to_string(o1toks)));
-        arg_vec.push_back(std::make_tuple("o2toks",std::to_string(o2toks)));
+        add_arg("o1toks", o1toks);
+        add_arg("o2toks", o2toks);
 #endif
     }
     
@@ -1496,10 +2382,13 @@ public:
             std::array<size_t, sizeof...(Ts)> out_toks)
           :sdf_process(_name), iport1("iport1"), out_toks(out_toks)
     {
+        add_in_rate(iport1, 1);
+        std::apply([&](auto&... ports) {
+            std::size_t n{0};
+            (add_out_rate(ports, out_toks[n++]), ...);
+        }, oport);
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << out_toks;
-        arg_vec.push_back(std::make_tuple("otoks",ss.str()));
+        add_arg("otoks", out_toks);
 #endif
     }
     
@@ -1581,11 +2470,20 @@ public:
      * applies and writes the results using the output port
      */
     fanout(sc_module_name _name)  // module name
-         : sdf_process(_name) { }
+         : sdf_process(_name)
+    {
+        add_in_rate(iport1, 1);
+        add_out_rate(oport1, 1);
+    }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SDF::fanout";}
     
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Passes the input tokens on to the outputs without running the process
+    void start_of_simulation() {bypass_fanout(iport1, oport1);}
+#endif
+    
 private:
     // Inputs and output variables
     T* val;
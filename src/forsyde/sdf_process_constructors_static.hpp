@@ -0,0 +1,854 @@
+/**********************************************************************
+    * sdf_process_constructors_static.hpp -- Process constructors     *
+    *                      with static rates in the SDF MoC           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing SDF process constructors whose rates are     *
+    *          known at compile time                                  *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SDF_PROCESS_CONSTRUCTORS_STATIC_HPP
+#define SDF_PROCESS_CONSTRUCTORS_STATIC_HPP
+
+/*! \file sdf_process_constructors_static.hpp
+ * \brief Implements the SDF process constructors with static rates
+ *
+ *  The rates of the process constructors in sdf_process_constructors.hpp
+ * are given to their constructors, hence their tokens are kept in
+ * vectors and the loops over them have a variable trip count. The
+ * process constructors in this file (suffixed with _s) take their rates
+ * as template parameters instead. Their tokens are kept in std::arrays
+ * inside the process objects, and the functions passed to them get the
+ * arrays, so that the loops over short rates can be fully unrolled and
+ * vectorized:
+ *
+ *     SDF::comb_s<float,float,1,4> avg("avg",
+ *         [](std::array<float,1>& out, const std::array<float,4>& inp)
+ *         {
+ *             out[0] = (inp[0]+inp[1]+inp[2]+inp[3]) / 4;
+ *         });
+ *
+ *  The rates are also available as static members of the classes, and
+ * the repetition vector of a chain of them can be computed at compile
+ * time with chain_repetitions. The rates are registered like those of
+ * the other SDF processes, so that the static scheduler and the analyses
+ * handle them as usual.
+ */
+
+#include <functional>
+#include <tuple>
+#include <array>
+#include <utility>
+
+#include "sdf_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! A list of static rates
+template <unsigned int... Rs>
+using rates = std::integer_sequence<unsigned int, Rs...>;
+
+//! The greatest common divisor, for the compile-time balance equations
+constexpr unsigned long long rate_gcd(unsigned long long a, unsigned long long b)
+{
+    return b == 0 ? a : rate_gcd(b, a % b);
+}
+
+//! The repetition vector of a chain of N actors
+/*! Actor i produces prod[i] tokens on the edge to actor i+1, which
+ * consumes cons[i] tokens from it in each firing. The result is the
+ * smallest number of firings of each actor which brings all the edges
+ * back to their initial state, e.g.,
+ *
+ *     typedef SDF::comb_s<float,float,2,3> A;
+ *     typedef SDF::comb_s<float,float,1,4> B;
+ *     constexpr auto q = SDF::chain_repetitions<3>({A::o1toks, B::o1toks},
+ *                                                  {B::i1toks, 1});
+ *     static_assert(q[0] == 2 && q[1] == 1 && q[2] == 1);
+ */
+template <std::size_t N>
+constexpr std::array<unsigned long long,N> chain_repetitions(
+    const std::array<unsigned long long,N-1>& prod,
+    const std::array<unsigned long long,N-1>& cons)
+{
+    // the firings relative to the first actor as fractions num/den
+    std::array<unsigned long long,N> num{}, den{};
+    num[0] = den[0] = 1;
+    unsigned long long lcm = 1;
+    for (std::size_t i=0; i+1<N; i++)
+    {
+        num[i+1] = num[i] * prod[i];
+        den[i+1] = den[i] * cons[i];
+        const unsigned long long g = rate_gcd(num[i+1], den[i+1]);
+        num[i+1] /= g;
+        den[i+1] /= g;
+        lcm = lcm / rate_gcd(lcm, den[i+1]) * den[i+1];
+    }
+    std::array<unsigned long long,N> res{};
+    unsigned long long g = 0;
+    for (std::size_t i=0; i<N; i++)
+    {
+        res[i] = num[i] * (lcm / den[i]);
+        g = rate_gcd(g, res[i]);
+    }
+    for (std::size_t i=0; i<N; i++) res[i] /= g;
+    return res;
+}
+
+//! Process constructor for a combinational actor with static rates
+/*! Similar to comb, but the rates are given as the template parameters
+ * O and I, and the tokens are passed to the function in std::arrays.
+ */
+template <typename T0, typename T1, unsigned int O, unsigned int I,
+          typename FuncType = std::function<void(std::array<T0,O>&,
+                                                 const std::array<T1,I>&)>>
+class comb_s : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+    SDF_out<T0> oport1;       ///< port for the output channel
+
+    //! The production rate of the output
+    static constexpr unsigned int o1toks = O;
+    //! The consumption rate of the input
+    static constexpr unsigned int i1toks = I;
+
+    //! Type of the function to be passed to the process constructor
+    typedef FuncType functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it and writes the
+     * results using the output port
+     */
+    comb_s(sc_module_name _name,      ///< process name
+           functype _func             ///< function to be passed
+           ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+               _func(_func)
+    {
+        add_in_rate(iport1, I);
+        add_out_rate(oport1, O);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", O);
+        add_arg("i1toks", I);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::comb_s";}
+
+private:
+    // Inputs and output variables
+    std::array<T0,O> o1vals;
+    std::array<T1,I> i1vals;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        iport1.read_n(i1vals.data(), I);
+    }
+
+    void exec()
+    {
+        _func(o1vals, i1vals);
+    }
+
+    void prod()
+    {
+        oport1.write_n(o1vals.data(), O);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a combinational actor with two inputs and static rates
+/*! similar to comb_s with two inputs
+ */
+template <typename T0, typename T1, typename T2,
+          unsigned int O, unsigned int I1, unsigned int I2,
+          typename FuncType = std::function<void(std::array<T0,O>&,
+                                                 const std::array<T1,I1>&,
+                                                 const std::array<T2,I2>&)>>
+class comb2_s : public sdf_process
+{
+public:
+    SDF_in<T1> iport1;        ///< port for the input channel 1
+    SDF_in<T2> iport2;        ///< port for the input channel 2
+    SDF_out<T0> oport1;       ///< port for the output channel
+
+    //! The production rate of the output
+    static constexpr unsigned int o1toks = O;
+    //! The consumption rates of the inputs
+    static constexpr unsigned int i1toks = I1, i2toks = I2;
+
+    //! Type of the function to be passed to the process constructor
+    typedef FuncType functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the user-imlpemented function to them and writes the
+     * results using the output port
+     */
+    comb2_s(sc_module_name _name,      ///< process name
+            functype _func             ///< function to be passed
+            ) : sdf_process(_name), iport1("iport1"), iport2("iport2"),
+                oport1("oport1"), _func(_func)
+    {
+        add_in_rate(iport1, I1);
+        add_in_rate(iport2, I2);
+        add_out_rate(oport1, O);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", O);
+        add_arg("i1toks", I1);
+        add_arg("i2toks", I2);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::comb2_s";}
+
+private:
+    // Inputs and output variables
+    std::array<T0,O> o1vals;
+    std::array<T1,I1> i1vals;
+    std::array<T2,I2> i2vals;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        iport1.read_n(i1vals.data(), I1);
+        iport2.read_n(i2vals.data(), I2);
+    }
+
+    void exec()
+    {
+        _func(o1vals, i1vals, i2vals);
+    }
+
+    void prod()
+    {
+        oport1.write_n(o1vals.data(), O);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a combinational actor with three inputs and static rates
+/*! similar to comb_s with three inputs
+ */
+template <typename T0, typename T1, typename T2, typename T3,
+          unsigned int O, unsigned int I1, unsigned int I2, unsigned int I3,
+          typename FuncType = std::function<void(std::array<T0,O>&,
+                                                 const std::array<T1,I1>&,
+                                                 const std::array<T2,I2>&,
+                                                 const std::array<T3,I3>&)>>
+class comb3_s : public sdf_process
+{
+public:
+    SDF_in<T1> iport1;        ///< port for the input channel 1
+    SDF_in<T2> iport2;        ///< port for the input channel 2
+    SDF_in<T3> iport3;        ///< port for the input channel 3
+    SDF_out<T0> oport1;       ///< port for the output channel
+
+    //! The production rate of the output
+    static constexpr unsigned int o1toks = O;
+    //! The consumption rates of the inputs
+    static constexpr unsigned int i1toks = I1, i2toks = I2, i3toks = I3;
+
+    //! Type of the function to be passed to the process constructor
+    typedef FuncType functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the user-imlpemented function to them and writes the
+     * results using the output port
+     */
+    comb3_s(sc_module_name _name,      ///< process name
+            functype _func             ///< function to be passed
+            ) : sdf_process(_name), iport1("iport1"), iport2("iport2"),
+                iport3("iport3"), oport1("oport1"), _func(_func)
+    {
+        add_in_rate(iport1, I1);
+        add_in_rate(iport2, I2);
+        add_in_rate(iport3, I3);
+        add_out_rate(oport1, O);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", O);
+        add_arg("i1toks", I1);
+        add_arg("i2toks", I2);
+        add_arg("i3toks", I3);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::comb3_s";}
+
+private:
+    // Inputs and output variables
+    std::array<T0,O> o1vals;
+    std::array<T1,I1> i1vals;
+    std::array<T2,I2> i2vals;
+    std::array<T3,I3> i3vals;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        iport1.read_n(i1vals.data(), I1);
+        iport2.read_n(i2vals.data(), I2);
+        iport3.read_n(i3vals.data(), I3);
+    }
+
+    void exec()
+    {
+        _func(o1vals, i1vals, i2vals, i3vals);
+    }
+
+    void prod()
+    {
+        oport1.write_n(o1vals.data(), O);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(3);     // three input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundInChans[2].port = &iport3;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a combinational actor with four inputs and static rates
+/*! similar to comb_s with four inputs
+ */
+template <typename T0, typename T1, typename T2, typename T3, typename T4,
+          unsigned int O, unsigned int I1, unsigned int I2, unsigned int I3,
+          unsigned int I4,
+          typename FuncType = std::function<void(std::array<T0,O>&,
+                                                 const std::array<T1,I1>&,
+                                                 const std::array<T2,I2>&,
+                                                 const std::array<T3,I3>&,
+                                                 const std::array<T4,I4>&)>>
+class comb4_s : public sdf_process
+{
+public:
+    SDF_in<T1> iport1;        ///< port for the input channel 1
+    SDF_in<T2> iport2;        ///< port for the input channel 2
+    SDF_in<T3> iport3;        ///< port for the input channel 3
+    SDF_in<T4> iport4;        ///< port for the input channel 4
+    SDF_out<T0> oport1;       ///< port for the output channel
+
+    //! The production rate of the output
+    static constexpr unsigned int o1toks = O;
+    //! The consumption rates of the inputs
+    static constexpr unsigned int i1toks = I1, i2toks = I2, i3toks = I3, i4toks = I4;
+
+    //! Type of the function to be passed to the process constructor
+    typedef FuncType functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the user-imlpemented function to them and writes the
+     * results using the output port
+     */
+    comb4_s(sc_module_name _name,      ///< process name
+            functype _func             ///< function to be passed
+            ) : sdf_process(_name), iport1("iport1"), iport2("iport2"),
+                iport3("iport3"), iport4("iport4"), oport1("oport1"), _func(_func)
+    {
+        add_in_rate(iport1, I1);
+        add_in_rate(iport2, I2);
+        add_in_rate(iport3, I3);
+        add_in_rate(iport4, I4);
+        add_out_rate(oport1, O);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("o1toks", O);
+        add_arg("i1toks", I1);
+        add_arg("i2toks", I2);
+        add_arg("i3toks", I3);
+        add_arg("i4toks", I4);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::comb4_s";}
+
+private:
+    // Inputs and output variables
+    std::array<T0,O> o1vals;
+    std::array<T1,I1> i1vals;
+    std::array<T2,I2> i2vals;
+    std::array<T3,I3> i3vals;
+    std::array<T4,I4> i4vals;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        iport1.read_n(i1vals.data(), I1);
+        iport2.read_n(i2vals.data(), I2);
+        iport3.read_n(i3vals.data(), I3);
+        iport4.read_n(i4vals.data(), I4);
+    }
+
+    void exec()
+    {
+        _func(o1vals, i1vals, i2vals, i3vals, i4vals);
+    }
+
+    void prod()
+    {
+        oport1.write_n(o1vals.data(), O);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(4);     // four input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundInChans[2].port = &iport3;
+        boundInChans[3].port = &iport4;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a combinational actor with M inputs, N outputs and static rates
+/*! similar to combMN, where the rates of the outputs and the inputs are
+ * given as rates<...> lists, e.g.,
+ *
+ *     SDF::combMN_s<std::tuple<int,int>, std::tuple<int>,
+ *                   SDF::rates<1,1>, SDF::rates<2>> split(...);
+ */
+template <typename TO_tuple, typename TI_tuple, typename O_rates, typename I_rates>
+class combMN_s;
+
+template <typename... TOs, typename... TIs, unsigned int... Os, unsigned int... Is>
+class combMN_s<std::tuple<TOs...>, std::tuple<TIs...>, rates<Os...>, rates<Is...>>
+    : public sdf_process
+{
+    static_assert(sizeof...(TOs) == sizeof...(Os), "one rate is needed for each output");
+    static_assert(sizeof...(TIs) == sizeof...(Is), "one rate is needed for each input");
+public:
+    std::tuple<SDF_in<TIs>...>  iport;///< tuple of ports for the input channels
+    std::tuple<SDF_out<TOs>...> oport;///< tuple of ports for the output channels
+
+    //! The production rates of the outputs
+    static constexpr std::array<unsigned int, sizeof...(TOs)> otoks = {Os...};
+    //! The consumption rates of the inputs
+    static constexpr std::array<unsigned int, sizeof...(TIs)> itoks = {Is...};
+
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(std::array<TOs,Os>&..., const std::array<TIs,Is>&...)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the user-imlpemented function to them and writes the
+     * results using the output ports
+     */
+    combMN_s(sc_module_name _name,      ///< process name
+             functype _func             ///< function to be passed
+             ) : sdf_process(_name), _func(_func)
+    {
+        std::apply([&](auto&... ports) {(add_in_rate(ports, Is), ...);}, iport);
+        std::apply([&](auto&... ports) {(add_out_rate(ports, Os), ...);}, oport);
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("otoks", otoks);
+        add_arg("itoks", itoks);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::combMN_s";}
+
+private:
+    // Inputs and output variables
+    std::tuple<std::array<TOs,Os>...> ovals;
+    std::tuple<std::array<TIs,Is>...> ivals;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        std::apply([&](auto&... inport) {
+            std::apply([&](auto&... ival) {
+                (inport.read_n(ival.data(), ival.size()), ...);
+            }, ivals);
+        }, iport);
+    }
+
+    void exec()
+    {
+        std::apply([&](auto&... oval) {
+            std::apply([&](const auto&... ival) {
+                _func(oval..., ival...);
+            }, ivals);
+        }, ovals);
+    }
+
+    void prod()
+    {
+        std::apply([&](auto&... port) {
+            std::apply([&](const auto&... oval) {
+                (port.write_n(oval.data(), oval.size()), ...);
+            }, ovals);
+        }, oport);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(sizeof...(TIs));     // input ports
+        std::apply
+        (
+            [&](auto&... ports)
+            {
+                std::size_t n{0};
+                ((boundInChans[n++].port = &ports),...);
+            }, iport
+        );
+        boundOutChans.resize(sizeof...(TOs));    // output ports
+        std::apply
+        (
+            [&](auto&... ports)
+            {
+                std::size_t n{0};
+                ((boundOutChans[n++].port = &ports),...);
+            }, oport
+        );
+    }
+#endif
+};
+
+//! Process constructor for a n-delay element with a static number of initial tokens
+/*! Similar to delayn, where the number of the initial tokens is given as
+ * the template parameter N.
+ */
+template <class T, unsigned int N>
+class delayn_s : public sdf_process
+{
+public:
+    SDF_in<T>  iport1;       ///< port for the input channel
+    SDF_out<T> oport1;       ///< port for the output channel
+
+    //! The number of the initial tokens
+    static constexpr unsigned int n = N;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which inserts the initial elements,
+     * reads data from its input port, and writes the results using the
+     * output port.
+     */
+    delayn_s(sc_module_name _name,    ///< process name
+             T init_val               ///< initial value
+             ) : sdf_process(_name), iport1("iport1"), oport1("oport1"),
+                 init_val(init_val)
+    {
+        add_in_rate(iport1, 1);
+        add_out_rate(oport1, 1, N);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("init_val", init_val);
+        add_arg("n", N);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::delayn_s";}
+
+private:
+    // Initial value
+    T init_val;
+
+    // Inputs and output variables
+    T val;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        // the initial tokens are restored with the signal
+        if (is_restored()) return;
+        std::array<T,N> init_vals;
+        init_vals.fill(init_val);
+        oport1.write_n(init_vals.data(), N);
+    }
+
+    void prep()
+    {
+        val = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, val);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The zip process with two inputs, one output and static rates
+/*! Similar to zip, where the tokens are zipped into a tuple of arrays.
+ */
+template <class T1, class T2, unsigned int I1, unsigned int I2>
+class zip_s : public sdf_process
+{
+public:
+    SDF_in<T1> iport1;        ///< port for the input channel 1
+    SDF_in<T2> iport2;        ///< port for the input channel 2
+    SDF_out<std::tuple<std::array<T1,I1>,std::array<T2,I2>>> oport1;///< port for the output channel
+
+    //! The consumption rates of the inputs
+    static constexpr unsigned int i1toks = I1, i2toks = I2;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * zips them together and writes the results using the output port
+     */
+    zip_s(sc_module_name _name      ///< process name
+    ) : sdf_process(_name), iport1("iport1"), iport2("iport2"), oport1("oport1")
+    {
+        add_in_rate(iport1, I1);
+        add_in_rate(iport2, I2);
+        add_out_rate(oport1, 1);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("i1toks", I1);
+        add_arg("i2toks", I2);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::zip_s";}
+
+private:
+    // intermediate values
+    std::tuple<std::array<T1,I1>,std::array<T2,I2>> oval;
+
+    void init() {}
+
+    void prep()
+    {
+        iport1.read_n(std::get<0>(oval).data(), I1);
+        iport2.read_n(std::get<1>(oval).data(), I2);
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, oval);  // write to the output
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! The unzip process with one input, two outputs and static rates
+/*! Similar to unzip, where the tokens are unzipped from a tuple of arrays.
+ */
+template <class T1, class T2, unsigned int O1, unsigned int O2>
+class unzip_s : public sdf_process
+{
+public:
+    SDF_in<std::tuple<std::array<T1,O1>,std::array<T2,O2>>> iport1;///< port for the input channel
+    SDF_out<T1> oport1;        ///< port for the output channel 1
+    SDF_out<T2> oport2;        ///< port for the output channel 2
+
+    //! The production rates of the outputs
+    static constexpr unsigned int o1toks = O1, o2toks = O2;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * unzips them and writes the results using the output ports
+     */
+    unzip_s(sc_module_name _name      ///< process name
+    ) : sdf_process(_name), iport1("iport1"), oport1("oport1"), oport2("oport2")
+    {
+        add_in_rate(iport1, 1);
+        add_out_rate(oport1, O1);
+        add_out_rate(oport2, O2);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("o1toks", O1);
+        add_arg("o2toks", O2);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::unzip_s";}
+
+private:
+    // intermediate values
+    std::tuple<std::array<T1,O1>,std::array<T2,O2>> in_val;
+
+    void init() {}
+
+    void prep()
+    {
+        in_val = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        oport1.write_n(std::get<0>(in_val).data(), O1);  // write to the output 1
+        oport2.write_n(std::get<1>(in_val).data(), O2);  // write to the output 2
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        return rate_firing_rule(ins, outs);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(2);    // two output ports
+        boundOutChans[0].port = &oport1;
+        boundOutChans[1].port = &oport2;
+    }
+#endif
+};
+
+}
+}
+
+#endif
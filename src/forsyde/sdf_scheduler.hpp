@@ -0,0 +1,669 @@
+/**********************************************************************
+    * sdf_scheduler.hpp -- Static scheduling of SDF graphs            *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a single-threaded static-schedule executor   *
+    *          for SDF process networks                               *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SDF_SCHEDULER_HPP
+#define SDF_SCHEDULER_HPP
+
+/*! \file sdf_scheduler.hpp
+ * \brief Implements a static scheduler for SDF process networks
+ *
+ *  This file includes an opt-in executor which computes the repetition
+ * vector and a static schedule of an SDF process network after the
+ * elaboration phase and runs all of its processes in a single thread.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <numeric>
+#include <algorithm>
+#include <sstream>
+#include <cstdint>
+#include <typeindex>
+
+#include "sdf_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! The graph of an SDF process network
+/*! It collects the SDF processes of a subgraph and the channels which
+ * inter-connect them, and solves the balance equations. It is shared by
+ * the executors which run SDF graphs with static schedules.
+ */
+class sdf_graph
+{
+public:
+    //! A channel inter-connecting two processes of the graph
+    struct edge
+    {
+        size_t src, dst;        // indices of the producer and the consumer
+        unsigned int prod, cons;// production and consumption rates
+        unsigned int init_toks; // initial tokens
+        size_t peak;            // maximum occupancy during one iteration
+        sc_interface* chan;
+        // the rates of the phases of a cyclo-static producer and consumer,
+        // whose prod and cons are then the totals of a cycle
+        std::vector<unsigned int> prod_ph, cons_ph;
+    };
+
+    //! The processes of the graph
+    std::vector<sdf_process*> actors;
+    //! The channels inter-connecting them
+    std::vector<edge> edges;
+
+    //! Collects the SDF processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        std::vector<sc_object*> children = obj->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+        {
+            sdf_process* p = dynamic_cast<sdf_process*>(*it);
+            if (p != NULL)
+            {
+                if (p->has_rates()) actors.push_back(p);
+            }
+            else if (dynamic_cast<sc_module*>(*it) != NULL)
+                collect(*it);
+        }
+    }
+
+    //! Builds the edges of the graph from the channels bound to the ports
+    void build_edges()
+    {
+        std::map<sdf_process*, size_t> idx;
+        for (size_t i=0; i<actors.size(); i++) idx[actors[i]] = i;
+        // channels read by the scheduled processes
+        std::map<sc_interface*, std::pair<size_t,const port_rate*>> readers;
+        for (size_t i=0; i<actors.size(); i++)
+            for (auto& pr : actors[i]->in_rates)
+            {
+                auto chans = pr.channels();
+                for (auto ch : chans) readers[ch] = std::make_pair(i, &pr);
+            }
+        for (size_t i=0; i<actors.size(); i++)
+            for (auto& pr : actors[i]->out_rates)
+            {
+                auto chans = pr.channels();
+                for (auto ch : chans)
+                {
+                    auto rit = readers.find(ch);
+                    if (rit == readers.end()) continue;     // a boundary channel
+                    edges.push_back({i, rit->second.first, pr.toks,
+                                     rit->second.second->toks, pr.init_toks, 0, ch,
+                                     pr.phases, rit->second.second->phases});
+                }
+            }
+    }
+
+    //! Solves the balance equations using rational arithmetic
+    /*! The errors are reported on behalf of the given executor.
+     */
+    std::vector<size_t> solve_balance(const char* owner)
+    {
+        const size_t n = actors.size();
+        std::vector<size_t> num(n, 0), den(n, 1);
+        std::vector<std::vector<size_t>> adj(n);
+        for (size_t e=0; e<edges.size(); e++)
+        {
+            adj[edges[e].src].push_back(e);
+            adj[edges[e].dst].push_back(e);
+        }
+        for (size_t s=0; s<n; s++)
+        {
+            if (num[s] != 0) continue;
+            // traverse the connected component starting from s
+            std::vector<size_t> comp, stack(1, s);
+            num[s] = 1; den[s] = 1;
+            while (!stack.empty())
+            {
+                size_t a = stack.back(); stack.pop_back();
+                comp.push_back(a);
+                for (auto e : adj[a])
+                {
+                    const edge& ed = edges[e];
+                    if (ed.prod==0 || ed.cons==0)
+                        SC_REPORT_ERROR(owner, "zero rates are not supported by the static scheduler");
+                    // q[dst] = q[src] * prod / cons
+                    size_t b, bn, bd;
+                    if (ed.src == a)
+                    {
+                        b = ed.dst; bn = num[a]*ed.prod; bd = den[a]*ed.cons;
+                    }
+                    else
+                    {
+                        b = ed.src; bn = num[a]*ed.cons; bd = den[a]*ed.prod;
+                    }
+                    size_t g = std::gcd(bn, bd);
+                    bn /= g; bd /= g;
+                    if (num[b] == 0)
+                    {
+                        num[b] = bn; den[b] = bd;
+                        stack.push_back(b);
+                    }
+                    else if (num[b] != bn || den[b] != bd)
+                        SC_REPORT_ERROR(owner, "inconsistent SDF graph: the balance equations have no solution");
+                }
+            }
+            // scale the component to the smallest integer solution
+            size_t l = 1;
+            for (auto a : comp) l = std::lcm(l, den[a]);
+            size_t g = 0;
+            for (auto a : comp)
+            {
+                num[a] = num[a] * (l / den[a]);
+                den[a] = 1;
+                g = std::gcd(g, num[a]);
+            }
+            for (auto a : comp) num[a] /= g;
+        }
+        return num;
+    }
+
+    //! Converts the repetitions of the cycles of the processes to their firings
+    /*! The balance equations count the cycles of the cyclo-static
+     * processes, each of which is a firing per phase.
+     */
+    void to_firings(std::vector<size_t>& q) const
+    {
+        for (size_t i=0; i<actors.size(); i++) q[i] *= actors[i]->phases();
+    }
+
+    //! The tokens consumed on an edge in an iteration of the given repetitions (in firings)
+    size_t iteration_cons(const edge& e, const std::vector<size_t>& q) const
+    {
+        return q[e.dst] / actors[e.dst]->phases() * e.cons;
+    }
+
+    //! The tokens produced on an edge by k firings of its producer from a phase
+    static size_t produced(const edge& e, size_t phase, size_t k)
+    {
+        if (e.prod_ph.empty()) return k * e.prod;
+        size_t n = 0;
+        for (size_t j=0; j<k; j++) n += e.prod_ph[(phase+j) % e.prod_ph.size()];
+        return n;
+    }
+
+    //! The tokens consumed from an edge by k firings of its consumer from a phase
+    static size_t consumed(const edge& e, size_t phase, size_t k)
+    {
+        if (e.cons_ph.empty()) return k * e.cons;
+        size_t n = 0;
+        for (size_t j=0; j<k; j++) n += e.cons_ph[(phase+j) % e.cons_ph.size()];
+        return n;
+    }
+};
+
+//! A statically scheduled SDF graph executor
+/*! This module collects the SDF processes below a given module in the
+ * hierarchy (or the ones explicitly added), computes the repetition
+ * vector from their port rates and builds a static schedule which is
+ * executed in a single SC_THREAD. The threads of the scheduled
+ * processes are disabled and the channels whose both ends are scheduled
+ * are switched to plain ring buffers sized according to the schedule.
+ *
+ * Channels connecting the scheduled processes to the rest of the model
+ * keep their sc_fifo semantics, i.e., a scheduled process reading from
+ * an empty boundary channel blocks the scheduler thread. Similarly, a
+ * process which stops (e.g., a source which has produced its last
+ * token) stops the whole scheduled graph.
+ *
+ * With a blocking factor, the schedule covers several iterations of the
+ * graph and the processes which support it (e.g., SDF::comb) run their
+ * consecutive firings as single blocks, which read and write the tokens
+ * of all the firings at once.
+ *
+ * With buffer sharing, the ring buffers of the channels whose tokens are
+ * never alive at the same time during an iteration are placed in the
+ * same slots of an arena per token type. *
+ * The cyclo-static processes (see ForSyDe::CSDF) can be scheduled
+ * together with the SDF ones. The schedule fires them phase by phase,
+ * hence the ring buffers are sized for the tokens of the individual
+ * phases rather than of whole cycles.
+ */
+class static_scheduler : public sc_module, private sdf_graph
+{
+public:
+    //! An entry of the schedule: a process fired a number of times in a row
+    typedef std::pair<sdf_process*, size_t> sched_entry;
+
+    //! The constructor requires the module name and the root of the subgraph
+    /*! All the SDF processes below the root module in the hierarchy
+     * which have registered their port rates are scheduled, unless some
+     * processes are added explicitly using add().
+     */
+    static_scheduler(sc_module_name _name,  ///< The module name
+                     sc_module* root=NULL   ///< The root of the subgraph
+                     ) : sc_module(_name), root(root)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the list of the scheduled processes
+    void add(sdf_process* p)
+    {
+        actors.push_back(p);
+    }
+
+    //! Sets the blocking factor of the schedule
+    /*! The schedule covers j iterations of the graph and the firings of
+     * each blockable process which are run in a row are run as a single
+     * block. It should be called before the simulation starts.
+     */
+    void set_blocking(size_t j)
+    {
+        iter_factor = std::max(j, size_t(1));
+    }
+    
+    //! Sets the blocking factor of a process
+    /*! The process is fired in blocks of j firings. The schedule covers
+     * enough iterations of the graph for the firings of the process to
+     * be a multiple of j, and the blocks are only made smaller where the
+     * initial tokens of a cycle do not allow j firings in a row. It
+     * should be called before the simulation starts.
+     */
+    void set_blocking(sdf_process* p, size_t j)
+    {
+        block_of[p] = std::max(j, size_t(1));
+    }
+    
+    //! Places the buffers of the internal channels in shared arenas
+    /*! The live ranges of the channels without initial tokens are
+     * computed over the schedule, and the channels whose ranges do not
+     * overlap share their slots. Moreover, an output of a process which
+     * has the same type and rate as one of its inputs is written in
+     * place of the tokens it has consumed from that input. It should be
+     * called before the simulation starts.
+     */
+    void set_buffer_sharing(bool sharing=true)
+    {
+        this->sharing = sharing;
+    }
+    
+    //! The number of slots allocated for the buffers of the internal channels
+    size_t buffer_slots() const
+    {
+        return slots;
+    }
+    
+    //! The repetition vector, in the order of the scheduled processes
+    /*! The repetitions of the cyclo-static processes count the firings
+     * of their phases.
+     */
+    const std::vector<std::pair<sdf_process*, size_t>>& repetitions() const
+    {
+        return reps;
+    }
+
+    //! The computed static schedule
+    const std::vector<sched_entry>& schedule() const
+    {
+        return sched;
+    }
+
+    //! Returns the schedule in the looped notation, e.g., (2 a)(3 b)c
+    std::string schedule_str() const
+    {
+        std::stringstream ss;
+        for (auto it=sched.begin(); it!=sched.end(); it++)
+            if (it->second==1)
+                ss << it->first->basename();
+            else
+                ss << "(" << it->second << " " << it->first->basename() << ")";
+        return ss.str();
+    }
+
+    //! The scheduler is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_static_scheduler";}
+
+private:
+    SC_HAS_PROCESS(static_scheduler);
+
+    sc_module* root;
+    std::vector<std::pair<sdf_process*, size_t>> reps;
+    std::vector<sched_entry> sched;
+    // the blocking factors of the schedule and of the processes
+    size_t iter_factor = 1;
+    std::map<sdf_process*, size_t> block_of;
+    // the firings run as one block by each entry of the schedule, or zero
+    std::vector<size_t> blocks;
+    
+    //! An entry of the schedule as it is run, packed in 16 bytes
+    struct firing
+    {
+        sdf_process* proc;
+        std::uint32_t count;    // the firings in a row
+        std::uint32_t block;    // the firings run as one block, or zero
+    };
+    // the schedule in one contiguous array, which is all the scheduler
+    // thread reads in each iteration
+    std::vector<firing> run_list;
+    bool sharing = false;
+    size_t slots = 0;
+
+    //! Orders the processes topologically, ignoring edges with enough initial tokens
+    std::vector<size_t> order(const std::vector<size_t>& q)
+    {
+        const size_t n = actors.size();
+        std::vector<size_t> indeg(n, 0), res;
+        std::vector<bool> done(n, false);
+        for (auto& e : edges)
+            if (e.init_toks < iteration_cons(e, q)) indeg[e.dst]++;
+        while (res.size() < n)
+        {
+            // pick a process without constraining predecessors, or break
+            // a remaining cycle at the first unordered process
+            size_t pick = n;
+            for (size_t i=0; i<n && pick==n; i++)
+                if (!done[i] && indeg[i]==0) pick = i;
+            for (size_t i=0; i<n && pick==n; i++)
+                if (!done[i]) pick = i;
+            done[pick] = true;
+            res.push_back(pick);
+            for (auto& e : edges)
+                if (e.src==pick && !done[e.dst] && indeg[e.dst]>0 &&
+                    e.init_toks < iteration_cons(e, q))
+                    indeg[e.dst]--;
+        }
+        return res;
+    }
+
+    //! Builds the schedule by symbolic execution of the graph iterations
+    /*! The processes with a block size are fired in multiples of it, as
+     * long as another process can fire meanwhile. The firings of the
+     * blocked processes are not merged into the previous entry, since
+     * they may depend on the tokens it produces. The cyclo-static
+     * processes are fired phase by phase, so that the buffers only hold
+     * the tokens of the phases which are not consumed yet.
+     */
+    void build_schedule(const std::vector<size_t>& q,
+                        const std::vector<size_t>& gran,
+                        const std::vector<size_t>& blk)
+    {
+        std::vector<size_t> rem(q), toks(edges.size()), ph(actors.size(), 0);
+        std::vector<std::vector<size_t>> ins(actors.size()), outs(actors.size());
+        for (size_t e=0; e<edges.size(); e++)
+        {
+            toks[e] = edges[e].peak = edges[e].init_toks;
+            outs[edges[e].src].push_back(e);
+            ins[edges[e].dst].push_back(e);
+        }
+        std::vector<size_t> ord = order(q);
+        size_t left = std::accumulate(rem.begin(), rem.end(), size_t(0));
+        bool relax = false;
+        while (left > 0)
+        {
+            bool fired = false;
+            for (auto a : ord)
+            {
+                size_t k = 0;
+                if (actors[a]->phases() > 1)
+                {
+                    // fire the phases one by one while their tokens are available
+                    while (k < rem[a])
+                    {
+                        bool ready = true;
+                        for (auto e : ins[a])
+                            ready &= toks[e] >= consumed(edges[e], ph[a], 1);
+                        if (!ready) break;
+                        for (auto e : ins[a]) toks[e] -= consumed(edges[e], ph[a], 1);
+                        for (auto e : outs[a])
+                        {
+                            toks[e] += produced(edges[e], ph[a], 1);
+                            edges[e].peak = std::max(edges[e].peak, toks[e]);
+                        }
+                        ph[a] = (ph[a] + 1) % actors[a]->phases();
+                        k++;
+                    }
+                    if (k == 0) continue;
+                }
+                else
+                {
+                    // fire the process as many times as possible
+                    k = rem[a];
+                    for (auto e : ins[a])
+                        k = std::min(k, toks[e] / edges[e].cons);
+                    if (k >= gran[a]) k -= k % gran[a];
+                    else if (!relax) k = 0;
+                    if (k == 0) continue;
+                    for (auto e : ins[a]) toks[e] -= k * edges[e].cons;
+                    for (auto e : outs[a])
+                    {
+                        toks[e] += k * edges[e].prod;
+                        edges[e].peak = std::max(edges[e].peak, toks[e]);
+                    }
+                }
+                if (blk[a]==0 && !sched.empty() && sched.back().first==actors[a])
+                    sched.back().second += k;
+                else
+                {
+                    sched.push_back(sched_entry(actors[a], k));
+                    blocks.push_back(std::min(blk[a], k));
+                }
+                rem[a] -= k;
+                left -= k;
+                fired = true;
+            }
+            if (!fired && relax)
+                SC_REPORT_ERROR(name(), "the SDF graph deadlocks: insufficient initial tokens in a cycle");
+            // let the blocked processes fire fewer times if nothing else can
+            relax = !fired;
+        }
+    }
+
+    //! Places the buffers of the channels without initial tokens in arenas
+    void share_buffers()
+    {
+        const size_t m = edges.size();
+        std::map<sdf_process*, size_t> idx;
+        for (size_t i=0; i<actors.size(); i++) idx[actors[i]] = i;
+        std::vector<static_channel*> chans(m);
+        std::vector<bool> shared(m);
+        for (size_t e=0; e<m; e++)
+        {
+            chans[e] = dynamic_cast<static_channel*>(edges[e].chan);
+            shared[e] = chans[e] != NULL && edges[e].init_toks == 0;
+        }
+        // an output is written in place of an input of the same rate,
+        // since the processes consume the tokens of a firing before
+        // producing its results; the buffer then holds both channels
+        std::vector<size_t> grp(m);
+        std::iota(grp.begin(), grp.end(), 0);
+        auto find = [&grp](size_t e)
+        {
+            while (grp[e] != e) e = grp[e] = grp[grp[e]];
+            return e;
+        };
+        std::vector<bool> aliased(m, false);
+        for (size_t b=0; b<m; b++)
+        {
+            const size_t x = edges[b].src;
+            if (!shared[b] || edges[b].dst == x) continue;
+            for (size_t a=0; a<m; a++)
+                if (shared[a] && !aliased[a] && edges[a].dst == x && edges[a].src != x &&
+                    edges[a].cons == edges[b].prod && edges[a].cons_ph == edges[b].prod_ph &&
+                    chans[a]->token_type() == chans[b]->token_type() &&
+                    find(a) != find(b))
+                {
+                    aliased[a] = true;
+                    grp[find(b)] = find(a);
+                    break;
+                }
+        }
+        // the occupancy of the buffers after each entry of the schedule,
+        // and the entries during which they hold tokens
+        std::vector<size_t> occ(m, 0), peak(m, 1), ph(actors.size(), 0);
+        std::vector<std::vector<bool>> live(m, std::vector<bool>(sched.size(), false));
+        for (size_t i=0; i<sched.size(); i++)
+        {
+            const size_t a = idx[sched[i].first], k = sched[i].second;
+            for (size_t e=0; e<m; e++)
+            {
+                if (!shared[e]) continue;
+                const size_t r = find(e);
+                if (occ[r] > 0 || edges[e].src == a || edges[e].dst == a) live[r][i] = true;
+                if (edges[e].dst == a) occ[r] -= consumed(edges[e], ph[a], k);
+            }
+            for (size_t e=0; e<m; e++)
+                if (shared[e] && edges[e].src == a) occ[find(e)] += produced(edges[e], ph[a], k);
+            ph[a] = (ph[a] + k) % actors[a]->phases();
+            for (size_t r=0; r<m; r++)
+                if (occ[r] > 0)
+                {
+                    live[r][i] = true;
+                    peak[r] = std::max(peak[r], occ[r]);
+                }
+        }
+        auto overlap = [&live](size_t r, size_t p)
+        {
+            for (size_t i=0; i<live[r].size(); i++)
+                if (live[r][i] && live[p][i]) return true;
+            return false;
+        };
+        // pack the buffers of each token type, the largest ones first
+        std::map<std::type_index, std::vector<size_t>> by_type;
+        for (size_t e=0; e<m; e++)
+            if (shared[e] && find(e) == e)
+                by_type[std::type_index(chans[e]->token_type())].push_back(e);
+        std::vector<size_t> offset(m, 0);
+        for (auto& t : by_type)
+        {
+            auto& bufs = t.second;
+            std::stable_sort(bufs.begin(), bufs.end(),
+                             [&peak](size_t r, size_t p) {return peak[r] > peak[p];});
+            size_t total = 0;
+            for (size_t j=0; j<bufs.size(); j++)
+            {
+                // move the buffer past the placed ones it overlaps with
+                const size_t r = bufs[j];
+                bool moved = true;
+                while (moved)
+                {
+                    moved = false;
+                    for (size_t l=0; l<j; l++)
+                    {
+                        const size_t p = bufs[l];
+                        if (offset[r] < offset[p] + peak[p] && offset[p] < offset[r] + peak[r] &&
+                            overlap(r, p))
+                        {
+                            offset[r] = offset[p] + peak[p];
+                            moved = true;
+                        }
+                    }
+                }
+                total = std::max(total, offset[r] + peak[r]);
+            }
+            auto arena = chans[bufs[0]]->make_arena(total);
+            for (size_t e=0; e<m; e++)
+                if (shared[e] && t.first == std::type_index(chans[e]->token_type()))
+                    chans[e]->set_shared_buffer(arena, offset[find(e)], peak[find(e)]);
+            slots += total;
+        }
+    }
+    
+    //! Analyzes the graph and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        if (actors.empty() && root != NULL) collect(root);
+        if (actors.empty()) return;
+        build_edges();
+        auto q = solve_balance(name());
+        to_firings(q);
+        for (size_t i=0; i<actors.size(); i++)
+            reps.push_back(std::make_pair(actors[i], q[i]));
+        // scale the iteration for the firings of the blocked processes
+        // to be multiples of their blocking factors
+        const size_t n = actors.size();
+        std::vector<size_t> gran(n, 1), blk(n, 0);
+        size_t f = iter_factor;
+        for (size_t i=0; i<n; i++)
+        {
+            const bool can = actors[i]->blockable();
+            auto it = block_of.find(actors[i]);
+            if (it != block_of.end() && actors[i]->phases() > 1)
+            {
+                SC_REPORT_WARNING(actors[i]->name(), "the phases of a cyclo-static process are fired one by one");
+                it = block_of.end();
+            }
+            if (it != block_of.end())
+            {
+                if (!can)
+                    SC_REPORT_WARNING(actors[i]->name(), "the process can not run its firings in blocks");
+                gran[i] = it->second;
+                f = std::lcm(f, it->second / std::gcd(it->second, q[i]));
+            }
+            if (can)
+            {
+                if (it != block_of.end()) blk[i] = it->second;
+                else if (iter_factor > 1) blk[i] = SIZE_MAX;
+            }
+        }
+        for (auto& r : q) r *= f;
+        build_schedule(q, gran, blk);
+        if (sharing) share_buffers();
+        // switch the other internal channels to plain ring buffers
+        for (auto& e : edges)
+        {
+            static_channel* ch = dynamic_cast<static_channel*>(e.chan);
+            if (ch != NULL && !ch->is_static_buffer())
+            {
+                ch->set_static_buffer(std::max(e.peak, size_t(1)));
+                slots += std::max(e.peak, size_t(1));
+            }
+        }
+        for (auto p : actors) p->set_ext_driven();
+        run_list.clear();
+        for (size_t i=0; i<sched.size(); i++)
+        {
+            if (sched[i].second > UINT32_MAX)
+                SC_REPORT_ERROR(name(), "too many firings in a row in the schedule");
+            run_list.push_back({sched[i].first, std::uint32_t(sched[i].second),
+                                std::uint32_t(blocks[i])});
+        }
+    }
+
+    //! The main and only execution thread of the scheduler
+    void worker()
+    {
+        // the init stages run in the order of the schedule, so that the
+        // buffers they allocate are laid out in the order they are used
+        std::set<sdf_process*> inited;
+        for (auto& f : run_list)
+            if (inited.insert(f.proc).second) f.proc->ext_init();
+        for (auto p : actors)
+            if (inited.insert(p).second) p->ext_init();
+        if (run_list.empty()) return;
+        const firing* first = run_list.data();
+        const firing* last = first + run_list.size();
+        while (1)
+            for (const firing* f=first; f!=last; f++)
+            {
+                sdf_process* p = f->proc;
+                const size_t k = f->count, b = f->block;
+                if (b == 0)
+                    for (size_t j=0; j<k; j++) p->ext_fire();
+                else
+                    for (size_t j=0; j<k; j+=b) p->fire_block(std::min(b, k-j));
+            }
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,357 @@
+/**********************************************************************
+    * serializer.hpp -- Serialization of tokens into byte buffers     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Converting the tokens transferred between parallel     *
+    *          sub-simulations to and from a compact binary format    *
+    *                                                                 *
+    * Usage:   Included by the parallel simulation primitives         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SERIALIZER_HPP
+#define SERIALIZER_HPP
+
+/*! \file serializer.hpp
+ * \brief Implements the serialization of tokens
+ *
+ *  This file includes the serializer trait used by the sender and
+ * receiver processes of the parallel simulation to pack the tokens into
+ * MPI messages. Trivially copyable types are copied as raw bytes, and
+ * specializations are provided for absent-extended values, vectors,
+ * strings, arrays, tuples, time values and time-tagged events. Other
+ * types can be supported by specializing the trait.
+ */
+
+#include <vector>
+#include <array>
+#include <tuple>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "abst_ext.hpp"
+#include "tt_event.hpp"
+
+namespace ForSyDe
+{
+
+//! The serializer of a token type
+/*! A serializer appends the binary representation of a value to a byte
+ * buffer using write() and reconstructs it using read(), which advances
+ * the read position past the value. The max_size member is an upper
+ * bound on the size of the representation in bytes, or zero if it is
+ * not bounded (e.g., for vectors).
+ *
+ * The default implementation copies the bytes of trivially copyable
+ * types. Other types need a specialization.
+ */
+template <typename T>
+struct serializer
+{
+    //! The default implementation only supports trivially copyable types
+    static constexpr bool supported = std::is_trivially_copyable<T>::value;
+
+    //! The upper bound on the size of a serialized value
+    static constexpr size_t max_size = sizeof(T);
+
+    //! Appends a value to the buffer
+    static void write(std::vector<char>& buf, const T& val)
+    {
+        static_assert(supported,
+                      "a ForSyDe::serializer specialization is required for types which are not trivially copyable");
+        const size_t pos = buf.size();
+        buf.resize(pos + sizeof(T));
+        std::memcpy(buf.data()+pos, &val, sizeof(T));
+    }
+
+    //! Reads a value and advances the read position
+    static void read(const char*& pos, T& val)
+    {
+        static_assert(supported,
+                      "a ForSyDe::serializer specialization is required for types which are not trivially copyable");
+        std::memcpy(&val, pos, sizeof(T));
+        pos += sizeof(T);
+    }
+};
+
+//! Checks if a type can be serialized
+/*! The specializations of serializer which do not define the supported
+ * member are assumed to support their type.
+ */
+template <typename T, typename = void>
+struct is_serializable : std::true_type {};
+
+template <typename T>
+struct is_serializable<T, std::void_t<decltype(serializer<T>::supported)>>
+    : std::integral_constant<bool, serializer<T>::supported> {};
+
+//! The type used for the length of the variable-length values
+typedef std::uint32_t serial_length;
+
+//! The serializer of absent-extended values
+/*! A flag byte precedes the value, and the absent values are encoded in
+ * the flag byte only. With FORSYDE_ABSENT_RLE, a run of absent values is
+ * encoded by a flag of 2 followed by its length.
+ */
+template <typename T>
+struct serializer<abst_ext<T>>
+{
+    static constexpr bool supported = is_serializable<T>::value;
+#ifdef FORSYDE_ABSENT_RLE
+    static constexpr size_t max_size = serializer<T>::max_size == 0 ? 0 :
+                                       1 + (serializer<T>::max_size > sizeof(serial_length) ?
+                                            serializer<T>::max_size : sizeof(serial_length));
+#else
+    static constexpr size_t max_size = serializer<T>::max_size == 0 ? 0 :
+                                       1 + serializer<T>::max_size;
+#endif
+
+    static void write(std::vector<char>& buf, const abst_ext<T>& val)
+    {
+#ifdef FORSYDE_ABSENT_RLE
+        if (val.run_length() > 1)
+        {
+            buf.push_back(2);
+            serializer<serial_length>::write(buf, val.run_length());
+            return;
+        }
+#endif
+        buf.push_back(val.is_present() ? 1 : 0);
+        if (val.is_present()) serializer<T>::write(buf, val.unsafe_from_abst_ext());
+    }
+
+    static void read(const char*& pos, abst_ext<T>& val)
+    {
+        const char flag = *pos++;
+#ifdef FORSYDE_ABSENT_RLE
+        if (flag == 2)
+        {
+            serial_length len;
+            serializer<serial_length>::read(pos, len);
+            val = abst_ext<T>::absent_run(len);
+            return;
+        }
+#endif
+        if (flag == 0)
+        {
+            val.set_abst();
+            return;
+        }
+        T temp;
+        serializer<T>::read(pos, temp);
+        val.set_val(std::move(temp));
+    }
+};
+
+//! The serializer of vectors
+/*! The number of elements precedes the elements. The elements of
+ * trivially copyable types are copied in one block.
+ */
+template <typename T, typename A>
+struct serializer<std::vector<T,A>>
+{
+    static constexpr bool supported = is_serializable<T>::value;
+    static constexpr size_t max_size = 0;
+
+    static void write(std::vector<char>& buf, const std::vector<T,A>& val)
+    {
+        serializer<serial_length>::write(buf, val.size());
+        write_elems(buf, val, std::is_trivially_copyable<T>());
+    }
+
+    static void read(const char*& pos, std::vector<T,A>& val)
+    {
+        serial_length len;
+        serializer<serial_length>::read(pos, len);
+        val.resize(len);
+        read_elems(pos, val, std::is_trivially_copyable<T>());
+    }
+
+private:
+    static void write_elems(std::vector<char>& buf, const std::vector<T,A>& val, std::true_type)
+    {
+        const size_t pos = buf.size();
+        buf.resize(pos + val.size()*sizeof(T));
+        if (!val.empty()) std::memcpy(buf.data()+pos, val.data(), val.size()*sizeof(T));
+    }
+
+    static void write_elems(std::vector<char>& buf, const std::vector<T,A>& val, std::false_type)
+    {
+        for (auto it=val.begin(); it!=val.end(); it++)
+            serializer<T>::write(buf, *it);
+    }
+
+    static void read_elems(const char*& pos, std::vector<T,A>& val, std::true_type)
+    {
+        if (!val.empty()) std::memcpy(val.data(), pos, val.size()*sizeof(T));
+        pos += val.size()*sizeof(T);
+    }
+
+    static void read_elems(const char*& pos, std::vector<T,A>& val, std::false_type)
+    {
+        for (auto it=val.begin(); it!=val.end(); it++)
+        {
+            T temp;
+            serializer<T>::read(pos, temp);
+            *it = std::move(temp);
+        }
+    }
+};
+
+//! The serializer of vectors of Booleans
+template <typename A>
+struct serializer<std::vector<bool,A>>
+{
+    static constexpr size_t max_size = 0;
+
+    static void write(std::vector<char>& buf, const std::vector<bool,A>& val)
+    {
+        serializer<serial_length>::write(buf, val.size());
+        for (auto b : val) buf.push_back(b ? 1 : 0);
+    }
+
+    static void read(const char*& pos, std::vector<bool,A>& val)
+    {
+        serial_length len;
+        serializer<serial_length>::read(pos, len);
+        val.resize(len);
+        for (size_t i=0; i<len; i++) val[i] = *pos++ != 0;
+    }
+};
+
+//! The serializer of strings
+template <>
+struct serializer<std::string>
+{
+    static constexpr size_t max_size = 0;
+
+    static void write(std::vector<char>& buf, const std::string& val)
+    {
+        serializer<serial_length>::write(buf, val.size());
+        buf.insert(buf.end(), val.begin(), val.end());
+    }
+
+    static void read(const char*& pos, std::string& val)
+    {
+        serial_length len;
+        serializer<serial_length>::read(pos, len);
+        val.assign(pos, len);
+        pos += len;
+    }
+};
+
+//! The serializer of arrays
+/*! The elements are serialized one after the other, without a length.
+ */
+template <typename T, size_t N>
+struct serializer<std::array<T,N>>
+{
+    static constexpr bool supported = is_serializable<T>::value;
+    static constexpr size_t max_size = serializer<T>::max_size * N;
+
+    static void write(std::vector<char>& buf, const std::array<T,N>& val)
+    {
+        for (auto it=val.begin(); it!=val.end(); it++)
+            serializer<T>::write(buf, *it);
+    }
+
+    static void read(const char*& pos, std::array<T,N>& val)
+    {
+        for (auto it=val.begin(); it!=val.end(); it++)
+            serializer<T>::read(pos, *it);
+    }
+};
+
+//! The serializer of tuples
+/*! The elements are serialized one after the other.
+ */
+template <typename... Ts>
+struct serializer<std::tuple<Ts...>>
+{
+    static constexpr bool supported = (is_serializable<Ts>::value && ...);
+    static constexpr size_t max_size = ((serializer<Ts>::max_size == 0) || ...) ? 0 :
+                                       (serializer<Ts>::max_size + ... + 0);
+
+    static void write(std::vector<char>& buf, const std::tuple<Ts...>& val)
+    {
+        write_elems(buf, val, std::index_sequence_for<Ts...>());
+    }
+
+    static void read(const char*& pos, std::tuple<Ts...>& val)
+    {
+        read_elems(pos, val, std::index_sequence_for<Ts...>());
+    }
+
+private:
+    template <size_t... Is>
+    static void write_elems(std::vector<char>& buf, const std::tuple<Ts...>& val,
+                            std::index_sequence<Is...>)
+    {
+        (serializer<Ts>::write(buf, std::get<Is>(val)), ...);
+    }
+
+    template <size_t... Is>
+    static void read_elems(const char*& pos, std::tuple<Ts...>& val,
+                           std::index_sequence<Is...>)
+    {
+        (serializer<Ts>::read(pos, std::get<Is>(val)), ...);
+    }
+};
+
+//! The serializer of time values
+/*! A time is stored as a multiple of the time resolution.
+ */
+template <>
+struct serializer<sc_time>
+{
+    static constexpr size_t max_size = sizeof(std::uint64_t);
+
+    static void write(std::vector<char>& buf, const sc_time& val)
+    {
+        serializer<std::uint64_t>::write(buf, val.value());
+    }
+
+    static void read(const char*& pos, sc_time& val)
+    {
+        std::uint64_t v;
+        serializer<std::uint64_t>::read(pos, v);
+        val = sc_time::from_value(v);
+    }
+};
+
+//! The serializer of time-tagged events
+/*! The time tag precedes the value.
+ */
+template <typename VT, typename TT>
+struct serializer<tt_event<VT,TT>>
+{
+    static constexpr bool supported = is_serializable<VT>::value &&
+                                      is_serializable<TT>::value;
+    static constexpr size_t max_size = serializer<VT>::max_size == 0 ||
+                                       serializer<TT>::max_size == 0 ? 0 :
+                                       serializer<VT>::max_size + serializer<TT>::max_size;
+
+    static void write(std::vector<char>& buf, const tt_event<VT,TT>& val)
+    {
+        serializer<TT>::write(buf, get_time(val));
+        serializer<VT>::write(buf, get_value(val));
+    }
+
+    static void read(const char*& pos, tt_event<VT,TT>& val)
+    {
+        TT t;
+        VT v;
+        serializer<TT>::read(pos, t);
+        serializer<VT>::read(pos, v);
+        val = tt_event<VT,TT>(std::move(v), t);
+    }
+};
+
+}
+
+#endif
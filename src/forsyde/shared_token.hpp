@@ -0,0 +1,111 @@
+/**********************************************************************
+    * shared_token.hpp -- Reference-counted immutable tokens          *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Avoid deep copies of large tokens which are fanned out *
+    *          to several consumers                                   *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SHARED_TOKEN_HPP
+#define SHARED_TOKEN_HPP
+
+/*! \file shared_token.hpp
+ * \brief Implements reference-counted immutable tokens
+ *
+ *  This file provides a wrapper which can be carried by signals of any
+ * MoC instead of large payloads (e.g., std::vector or std::array). Copying
+ * the wrapper only increments a reference count.
+ */
+
+#include <memory>
+#include <utility>
+#include <iostream>
+
+namespace ForSyDe
+{
+
+//! A reference-counted immutable token
+/*! Copies of a shared token refer to the same payload, so writing it to
+ * several channels (e.g., by write_multiport or a fanout process) does
+ * not copy the payload. A consumer which needs to modify the payload
+ * calls mutate(), which copies it only if it is shared with others
+ * (copy-on-write).
+ *
+ * A default-constructed token refers to no payload and reads as a
+ * default-constructed value of T.
+ */
+template <typename T>
+class shared_token
+{
+public:
+    //! The default constructor refers to no payload
+    shared_token() {}
+
+    //! The constructor with a payload
+    shared_token(const T& val) : ptr(std::make_shared<T>(val)) {}
+
+    //! The constructor taking over a payload
+    shared_token(T&& val) : ptr(std::make_shared<T>(std::move(val))) {}
+
+    //! Read-only access to the payload
+    const T& get() const
+    {
+        if (ptr) return *ptr;
+        static const T def_val = T();
+        return def_val;
+    }
+
+    //! Read-only access to the payload
+    operator const T&() const {return get();}
+
+    //! Read-only access to the payload
+    const T& operator*() const {return get();}
+
+    //! Read-only access to the members of the payload
+    const T* operator->() const {return &get();}
+
+    //! Write access to the payload, copying it first if it is shared
+    T& mutate()
+    {
+        if (!ptr)
+            ptr = std::make_shared<T>();
+        else if (ptr.use_count() > 1)
+            ptr = std::make_shared<T>(*ptr);
+        return *ptr;
+    }
+
+    //! The number of tokens sharing the payload
+    long use_count() const {return ptr.use_count();}
+
+    //! Checks for the equivalence of the payloads
+    bool operator== (const shared_token& rs) const
+    {
+        return ptr == rs.ptr || get() == rs.get();
+    }
+
+    //! Overload the streaming operator to enable SystemC communiation
+    friend std::ostream& operator<< (std::ostream& os, const shared_token& tok)
+    {
+        os << tok.get();
+        return os;
+    }
+
+private:
+    std::shared_ptr<T> ptr;
+};
+
+//! Helper function to construct a shared token in place
+template <typename T, typename... Args>
+inline shared_token<T> make_shared_token(Args&&... args)
+{
+    return shared_token<T>(T(std::forward<Args>(args)...));
+}
+
+}
+
+#endif
@@ -0,0 +1,292 @@
+/**********************************************************************
+    * shm_ring.hpp -- A ring buffer in POSIX shared memory            *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a single-producer single-consumer message    *
+    *          queue between the processes (or threads) of a host     *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SHM_TRANSPORT to use it in the parallel *
+    *          simulations                                            *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SHM_RING_HPP
+#define SHM_RING_HPP
+
+/*! \file shm_ring.hpp
+ * \brief Implements a message ring buffer in shared memory
+ *
+ *  This file includes a lock-free single-producer single-consumer queue
+ * of variable-length messages stored in a named POSIX shared memory
+ * segment. It is used as the transport between the ranks of a parallel
+ * simulation which run on the same host.
+ */
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+//! The default size of the data area of a shared memory ring in bytes
+#ifndef FORSYDE_SHM_RING_SIZE
+#define FORSYDE_SHM_RING_SIZE (1<<20)
+#endif
+
+//! The number of polls of a ring before the waiting thread sleeps
+#ifndef FORSYDE_SHM_SPIN
+#define FORSYDE_SHM_SPIN 4096
+#endif
+
+//! The longest time in microseconds a thread sleeps waiting for a ring
+#ifndef FORSYDE_SHM_SLEEP
+#define FORSYDE_SHM_SLEEP 1000
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A single-producer single-consumer message queue in shared memory
+/*! The segment is created by one side (usually the consumer) and opened
+ * by the other one, which should happen only after the creation is
+ * complete. Each message is stored as its length followed by its bytes,
+ * aligned to eight bytes. A message which does not fit before the end
+ * of the buffer starts from the beginning.
+ *
+ * The read and write positions are kept in separate cache lines and are
+ * accessed using acquire/release atomics, hence no locks or system calls
+ * are involved in the transfer of a message.
+ *
+ * A side which finds the ring empty (or full) can wait for the other one
+ * using wait_peer(), which polls the ring for a while (on multi-core
+ * hosts) and then sleeps on a futex (on Linux), which is only woken if
+ * there is a sleeper.
+ */
+class shm_ring
+{
+public:
+    //! The constructor creates or opens a named segment
+    shm_ring(const std::string& name,     ///< the POSIX name (starting with '/')
+             bool create,                 ///< create a new segment
+             size_t capacity=FORSYDE_SHM_RING_SIZE ///< the size of the data area
+             ) : name(name), owner(create), mem(NULL), size(0), hdr(NULL),
+                 data(NULL), cap(0)
+    {
+        if (create) shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), create ? O_CREAT|O_EXCL|O_RDWR : O_RDWR, 0600);
+        if (fd < 0)
+        {
+            SC_REPORT_ERROR(name.c_str(), "the shared memory segment could not be opened");
+            return;
+        }
+        if (create)
+        {
+            capacity = (capacity + 7) / 8 * 8;
+            if (ftruncate(fd, sizeof(header) + capacity) != 0)
+            {
+                close(fd);
+                SC_REPORT_ERROR(name.c_str(), "the shared memory segment could not be allocated");
+                return;
+            }
+        }
+        struct stat st;
+        fstat(fd, &st);
+        size = st.st_size;
+        void* m = mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (m == MAP_FAILED)
+        {
+            SC_REPORT_ERROR(name.c_str(), "the shared memory segment could not be mapped");
+            return;
+        }
+        // a new segment is zero-filled, i.e., an empty ring
+        mem = m;
+        hdr = static_cast<header*>(mem);
+        data = static_cast<char*>(mem) + sizeof(header);
+        cap = size - sizeof(header);
+    }
+
+    //! The destructor unmaps the segment and removes it if it is the owner
+    ~shm_ring()
+    {
+        if (mem != NULL) munmap(mem, size);
+        if (owner) shm_unlink(name.c_str());
+    }
+
+    shm_ring(const shm_ring&) = delete;
+    shm_ring& operator=(const shm_ring&) = delete;
+
+    //! Appends a message if there is enough space
+    bool try_write(const char* msg, size_t len)
+    {
+        const size_t need = sizeof(std::uint64_t) + align(len);
+        if (need > cap)
+        {
+            SC_REPORT_ERROR(name.c_str(), "the message is larger than the shared memory ring");
+            return false;
+        }
+        const std::uint64_t tail = hdr->tail.load(std::memory_order_relaxed);
+        const std::uint64_t head = hdr->head.load(std::memory_order_acquire);
+        const size_t off = tail % cap;
+        const size_t skip = off + need > cap ? cap - off : 0;
+        if (cap - (tail - head) < skip + need) return false;
+        if (skip > 0)
+        {
+            const std::uint64_t mark = wrap_mark;
+            std::memcpy(data+off, &mark, sizeof(mark));
+        }
+        const size_t pos = (tail + skip) % cap;
+        const std::uint64_t l = len;
+        std::memcpy(data+pos, &l, sizeof(l));
+        std::memcpy(data+pos+sizeof(l), msg, len);
+        hdr->tail.store(tail + skip + need, std::memory_order_release);
+        notify();
+        return true;
+    }
+
+    //! Takes the next message if any
+    bool try_read(std::vector<char>& msg)
+    {
+        std::uint64_t head = hdr->head.load(std::memory_order_relaxed);
+        const std::uint64_t tail = hdr->tail.load(std::memory_order_acquire);
+        if (head == tail) return false;
+        std::uint64_t l;
+        std::memcpy(&l, data + head%cap, sizeof(l));
+        if (l == wrap_mark)
+        {
+            head += cap - head%cap;
+            std::memcpy(&l, data + head%cap, sizeof(l));
+        }
+        msg.resize(l);
+        std::memcpy(msg.data(), data + head%cap + sizeof(l), l);
+        hdr->head.store(head + sizeof(l) + align(l), std::memory_order_release);
+        notify();
+        return true;
+    }
+
+    //! The number of accesses to the ring by both sides, used by wait_peer()
+    std::uint32_t version() const
+    {
+        return hdr->seq.load(std::memory_order_acquire);
+    }
+
+    //! Waits for the other side to access the ring after a given version
+    /*! The version should be taken before the failed attempt to access the
+     * ring, so that no access is missed. It returns false if nothing has
+     * happened within the timeout in microseconds. It only polls the ring
+     * if the timeout is zero.
+     */
+    bool wait_peer(std::uint32_t seen, long timeout=FORSYDE_SHM_SLEEP)
+    {
+        // polling is useless if the other side cannot run meanwhile
+        static const unsigned spins = sysconf(_SC_NPROCESSORS_ONLN) > 1 ?
+                                      FORSYDE_SHM_SPIN : 0;
+        for (unsigned k=0; k<spins; k++)
+            if (version() != seen) return true;
+        if (timeout <= 0) return false;
+        hdr->sleepers.fetch_add(1, std::memory_order_acq_rel);
+        if (version() == seen)
+        {
+#ifdef __linux__
+            const timespec ts = {timeout/1000000, (timeout%1000000)*1000};
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&hdr->seq),
+                    FUTEX_WAIT, seen, &ts, NULL, 0);
+#else
+            const timespec ts = {0, 10000};
+            nanosleep(&ts, NULL);
+#endif
+        }
+        hdr->sleepers.fetch_sub(1, std::memory_order_acq_rel);
+        return version() != seen;
+    }
+
+private:
+    //! The positions of the ring, in separate cache lines
+    struct header
+    {
+        std::atomic<std::uint64_t> head;
+        char pad1[64-sizeof(std::atomic<std::uint64_t>)];
+        std::atomic<std::uint64_t> tail;
+        char pad2[64-sizeof(std::atomic<std::uint64_t>)];
+        std::atomic<std::uint32_t> seq;     // incremented by every access
+        std::atomic<std::uint32_t> sleepers;// the threads sleeping on seq
+        char pad3[64-2*sizeof(std::atomic<std::uint32_t>)];
+    };
+
+    //! Wakes up the other side if it sleeps
+    void notify()
+    {
+        hdr->seq.fetch_add(1, std::memory_order_acq_rel);
+#ifdef __linux__
+        if (hdr->sleepers.load(std::memory_order_acquire) > 0)
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&hdr->seq),
+                    FUTEX_WAKE, 1, NULL, NULL, 0);
+#endif
+    }
+
+    static constexpr std::uint64_t wrap_mark = ~std::uint64_t(0);
+
+    static size_t align(size_t len) {return (len + 7) / 8 * 8;}
+
+    std::string name;
+    bool owner;
+    void* mem;
+    size_t size;
+    header* hdr;
+    char* data;
+    size_t cap;
+};
+
+//! Writes a message to a ring from a SystemC thread
+/*! While the ring is full, it polls the ring, and then either lets the
+ * other processes which can run at the current time execute or sleeps
+ * until the other side reads from the ring.
+ */
+inline void shm_write_wait(shm_ring& ring, const char* msg, size_t len)
+{
+    while (true)
+    {
+        const std::uint32_t v = ring.version();
+        if (ring.try_write(msg, len)) return;
+        if (ring.wait_peer(v, 0)) continue;
+        if (sc_pending_activity_at_current_time())
+            wait(SC_ZERO_TIME);
+        else
+            ring.wait_peer(v);
+    }
+}
+
+//! Reads a message from a ring from a SystemC thread
+/*! While the ring is empty, it waits as shm_write_wait().
+ */
+inline void shm_read_wait(shm_ring& ring, std::vector<char>& msg)
+{
+    while (true)
+    {
+        const std::uint32_t v = ring.version();
+        if (ring.try_read(msg)) return;
+        if (ring.wait_peer(v, 0)) continue;
+        if (sc_pending_activity_at_current_time())
+            wait(SC_ZERO_TIME);
+        else
+            ring.wait_peer(v);
+    }
+}
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+/**********************************************************************
+    * signal_stats.hpp -- Occupancy and back-pressure of the signals  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Reporting the occupancy statistics collected by the    *
+    *          signals of a model after a simulation                  *
+    *                                                                 *
+    * Usage:   Define FORSYDE_INTROSPECTION and FORSYDE_SIGNAL_STATS  *
+    *          to use it                                              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SIGNAL_STATS_HPP
+#define SIGNAL_STATS_HPP
+
+/*! \file signal_stats.hpp
+ * \brief Implements the report of the occupancy of the signals
+ *
+ *  When FORSYDE_SIGNAL_STATS is defined, each signal counts the records
+ * written to it, its maximum and time-weighted average occupancy and the
+ * reads (writes) which found it empty (full). They are available on the
+ * edges of the process graph, and the monitor in this file writes them
+ * in an XML file next to the introspection output, e.g.:
+ *
+ *     signal_stats_monitor monitor("monitor", "gen/");
+ *
+ *  The maximum occupancy of a signal is the smallest capacity with which
+ * its writer would never have blocked in the simulated run.
+ */
+
+#include <string>
+#include <fstream>
+
+#include "process_graph.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Writes the statistics of the signals of a graph to path + "signal_stats.xml"
+inline void write_signal_stats(const process_graph& g, const std::string& path)
+{
+    const std::string file_name = path + "signal_stats.xml";
+    std::ofstream out(file_name);
+    if (!out.is_open())
+    {
+        SC_REPORT_ERROR(file_name.c_str(), "file could not be opened to write the signal statistics. Does the path exists?");
+        return;
+    }
+    out << "<?xml version=\"1.0\" ?>\n<signal_stats>\n";
+    for (auto& ed : g.edges())
+    {
+        auto obj = dynamic_cast<sc_object*>(ed.chan);
+        const signal_stats s = ed.stats();
+        out << "\t<signal name=\"" << (obj ? obj->name() : "")
+            << "\" source=\"" << (ed.src != process_graph::npos ? g.nodes()[ed.src].name : "")
+            << "\" target=\"" << (ed.dst != process_graph::npos ? g.nodes()[ed.dst].name : "")
+            << "\" tokens=\"" << s.tokens
+            << "\" capacity=\"" << s.capacity
+            << "\" high_water=\"" << s.high_water
+            << "\" mean_occupancy=\"" << s.mean_occupancy
+            << "\" blocked_writes=\"" << s.blocked_writes
+            << "\" blocked_reads=\"" << s.blocked_reads << "\"/>\n";
+    }
+    out << "</signal_stats>\n";
+}
+
+//! Writes the statistics of the signals of the model at the end of the simulation
+/*! The report is written to path + "signal_stats.xml", e.g., next to the
+ * XML files of XMLExport.
+ */
+class signal_stats_monitor : public sc_module
+{
+public:
+    signal_stats_monitor(sc_module_name _name,    ///< The module name
+                         const std::string& path  ///< The output path
+                        ) : sc_module(_name), path(path) {}
+
+    void end_of_simulation()
+    {
+        write_signal_stats(model_graph(), path);
+    }
+
+private:
+    std::string path;
+};
+
+}
+
+#endif
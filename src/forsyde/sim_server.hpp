@@ -0,0 +1,390 @@
+/**********************************************************************
+    * sim_server.hpp -- A resident simulation server                  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Answering repeated queries on an elaborated model      *
+    *          without paying for the start-up of a new process       *
+    *                                                                 *
+    * Usage:   Define FORSYDE_RESET to use it                         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SIM_SERVER_HPP
+#define SIM_SERVER_HPP
+
+/*! \file sim_server.hpp
+ * \brief Implements a server which keeps a model resident between queries
+ *
+ *  Design-space exploration and interactive tools run the same model
+ * many times with different parameters, and for small models the
+ * start-up of a new simulation process (loading, elaboration and the
+ * init stages) costs more than the simulation itself. A simulation
+ * server keeps the elaborated model in memory and answers each query by
+ * setting the parameters, resetting the model (see reset_model()),
+ * simulating it for the requested time and returning the selected
+ * results and traces:
+ *
+ *     top t("top");
+ *     ForSyDe::sim_server srv;
+ *     srv.add_parameter("gain", &t.gain_value);
+ *     srv.add_result("energy", [&]{return std::to_string(t.energy());});
+ *     srv.add_trace(t.out_sig, "out");
+ *     srv.serve(5000);
+ *
+ *  The queries are answered by the thread calling serve() (or run()),
+ * one at a time and between the calls to sc_start, so that the model
+ * is never touched while it is simulated. The server accepts one client
+ * at a time on a TCP socket with a line-based protocol:
+ *
+ *     RUN <seconds> [name=value ...] [result ...] [+trace ...]
+ *     LIST
+ *     QUIT
+ *     SHUTDOWN
+ *
+ * A RUN request is answered by "OK <wall ms> <model seconds>", a line
+ * "R <name> <value>" per result, a line "T <name> <tokens ...>" per
+ * trace and "END", with the fields separated by tabs, or by a single
+ * line "ERR <message>". The same restrictions as for reset_model()
+ * apply, e.g., the processes driven by an executor can not be reset.
+ */
+
+#include <map>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <memory>
+#include <chrono>
+#include <functional>
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "abssemantics.hpp"
+#include "reset.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A query to the simulation server
+struct sim_query
+{
+    std::map<std::string,std::string> params;   ///< the values of the parameters to set
+    sc_time duration = SC_ZERO_TIME;            ///< the simulated time (zero until there are no events)
+    std::vector<std::string> results;           ///< the results to return (all if empty)
+    std::vector<std::string> traces;            ///< the traces to return
+};
+
+//! The answer of the simulation server to a query
+struct sim_answer
+{
+    bool ok = false;                                        ///< false if the query failed
+    std::string error;                                      ///< the reason of the failure
+    double wall_ms = 0;                                     ///< the wall-clock time of the run
+    std::vector<std::pair<std::string,std::string>> results;///< the results by name
+    std::map<std::string,std::vector<std::string>> traces;  ///< the tokens of the traces by name
+};
+
+//! A server answering repeated queries on a resident model
+/*! The parameters, results and traces are registered after the model is
+ * elaborated and before the first query. The first query simulates the
+ * model from its elaborated state, and the following ones reset it first.
+ */
+class sim_server
+{
+public:
+    //! Registers a parameter set from its textual value
+    void add_parameter(const std::string& name,
+                       const std::function<void(const std::string&)>& setter)
+    {
+        params[name] = setter;
+    }
+
+    //! Registers a variable of the model as a parameter
+    /*! The value is parsed using operator>> of its type.
+     */
+    template <typename T>
+    void add_parameter(const std::string& name, T* var)
+    {
+        params[name] = [var](const std::string& val)
+        {
+            std::istringstream is(val);
+            T v;
+            if (!(is >> v)) throw std::invalid_argument("malformed value " + val);
+            *var = v;
+        };
+    }
+
+    //! Registers a result computed after each run
+    void add_result(const std::string& name, const std::function<std::string()>& get)
+    {
+        results.emplace_back(name, get);
+    }
+
+#ifdef FORSYDE_SIGNAL_TRACE
+    //! Registers the tokens written to a signal as a trace
+    /*! The tokens are recorded, as written by operator<<, only in the runs
+     * which select the trace. The observer of the signal is replaced.
+     */
+    template <typename T, typename TokenType, template <class> class FifoType>
+    void add_trace(ForSyDe::signal<T,TokenType,FifoType>& sig, const std::string& name)
+    {
+        auto probe = new trace_probe<TokenType>;
+        traces[name].reset(probe);
+        sig.set_observer(probe);
+    }
+#endif
+
+    //! Runs a query on the model
+    /*! It should be called while the simulation is paused. Unknown
+     * parameters, results or traces and the errors reported during the run
+     * fail the query, and a stopped simulation fails all the following
+     * ones.
+     */
+    sim_answer run(const sim_query& q)
+    {
+        sim_answer ans;
+        if (sc_get_status() == SC_STOPPED)
+        {
+            ans.error = "the simulation is stopped";
+            return ans;
+        }
+        for (auto& p : q.params)
+            if (params.find(p.first) == params.end())
+            {
+                ans.error = "unknown parameter " + p.first;
+                return ans;
+            }
+        for (auto& n : q.results)
+            if (find_result(n) == NULL)
+            {
+                ans.error = "unknown result " + n;
+                return ans;
+            }
+        for (auto& n : q.traces)
+            if (traces.find(n) == traces.end())
+            {
+                ans.error = "unknown trace " + n;
+                return ans;
+            }
+        const auto start = std::chrono::steady_clock::now();
+        try
+        {
+            for (auto& p : q.params) params[p.first](p.second);
+            for (auto& t : traces) t.second->clear(false);
+            for (auto& n : q.traces) traces[n]->clear(true);
+            if (runs++ > 0) reset_model();
+            if (q.duration == SC_ZERO_TIME)
+                sc_start();
+            else
+                sc_start(q.duration);
+            if (q.results.empty())
+                for (auto& r : results) ans.results.emplace_back(r.first, r.second());
+            else
+                for (auto& n : q.results) ans.results.emplace_back(n, (*find_result(n))());
+        }
+        catch (const sc_report& e)
+        {
+            ans.error = e.what();
+            return ans;
+        }
+        catch (const std::exception& e)
+        {
+            ans.error = e.what();
+            return ans;
+        }
+        for (auto& n : q.traces) ans.traces[n] = traces[n]->tokens;
+        for (auto& t : traces) t.second->clear(false);
+        ans.wall_ms = std::chrono::duration<double,std::milli>(
+                          std::chrono::steady_clock::now() - start).count();
+        ans.ok = true;
+        return ans;
+    }
+
+    //! Parses and answers a request of the line-based protocol
+    /*! It returns the reply, ending with a new line, and sets quit or
+     * shutdown for the corresponding requests.
+     */
+    std::string handle(const std::string& line, bool& quit, bool& shutdown)
+    {
+        std::istringstream is(line);
+        std::string cmd;
+        is >> cmd;
+        std::ostringstream os;
+        if (cmd == "QUIT" || cmd == "SHUTDOWN")
+        {
+            quit = true;
+            shutdown = cmd == "SHUTDOWN";
+            return "OK\n";
+        }
+        if (cmd == "LIST")
+        {
+            for (auto& p : params) os << "P\t" << p.first << '\n';
+            for (auto& r : results) os << "R\t" << r.first << '\n';
+            for (auto& t : traces) os << "T\t" << t.first << '\n';
+            os << "END\n";
+            return os.str();
+        }
+        if (cmd != "RUN") return "ERR unknown request " + cmd + "\n";
+        double secs;
+        if (!(is >> secs) || secs < 0) return "ERR malformed duration\n";
+        sim_query q;
+        q.duration = sc_time(secs, SC_SEC);
+        for (std::string arg; is >> arg;)
+        {
+            const size_t eq = arg.find('=');
+            if (arg[0] == '+')
+                q.traces.push_back(arg.substr(1));
+            else if (eq != std::string::npos)
+                q.params[arg.substr(0, eq)] = arg.substr(eq+1);
+            else
+                q.results.push_back(arg);
+        }
+        const sim_answer ans = run(q);
+        if (!ans.ok) return "ERR " + ans.error + "\n";
+        os << "OK\t" << ans.wall_ms << '\t' << model_time().to_seconds() << '\n';
+        for (auto& r : ans.results) os << "R\t" << r.first << '\t' << r.second << '\n';
+        for (auto& t : ans.traces)
+        {
+            os << "T\t" << t.first;
+            for (auto& tok : t.second) os << '\t' << tok;
+            os << '\n';
+        }
+        os << "END\n";
+        return os.str();
+    }
+
+    //! Serves the clients on a TCP port until a SHUTDOWN request
+    /*! The socket is bound to the loopback interface unless any is set,
+     * since the protocol is not authenticated. It returns false if the
+     * socket can not be bound, and stops after max_queries RUN requests
+     * if it is not zero.
+     */
+    bool serve(unsigned short port, bool any=false, size_t max_queries=0)
+    {
+        const int lfd = socket(AF_INET, SOCK_STREAM, 0);
+        if (lfd < 0) return false;
+        const int one = 1;
+        setsockopt(lfd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(any ? INADDR_ANY : INADDR_LOOPBACK);
+        if (bind(lfd, (sockaddr*)&addr, sizeof(addr)) < 0 || listen(lfd, 4) < 0)
+        {
+            close(lfd);
+            SC_REPORT_WARNING("sim_server", ("the port " + std::to_string(port) +
+                                             " could not be bound").c_str());
+            return false;
+        }
+        bool shutdown = false;
+        size_t queries = 0;
+        while (!shutdown)
+        {
+            const int fd = accept(lfd, NULL, NULL);
+            if (fd < 0) continue;
+            std::string pending;
+            char chunk[4096];
+            bool quit = false;
+            while (!quit)
+            {
+                const size_t nl = pending.find('\n');
+                if (nl == std::string::npos)
+                {
+                    const ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+                    if (n <= 0) break;
+                    pending.append(chunk, n);
+                    continue;
+                }
+                std::string line = pending.substr(0, nl);
+                pending.erase(0, nl+1);
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty()) continue;
+                const std::string reply = handle(line, quit, shutdown);
+                if (!send_all(fd, reply)) break;
+                if (line.compare(0, 3, "RUN") == 0 && max_queries && ++queries >= max_queries)
+                    quit = shutdown = true;
+            }
+            close(fd);
+        }
+        close(lfd);
+        return true;
+    }
+
+    //! The number of runs simulated so far
+    size_t run_count() const {return runs;}
+
+private:
+#ifdef FORSYDE_SIGNAL_TRACE
+    //! The textual tokens of a trace
+    struct trace_base
+    {
+        virtual ~trace_base() {}
+        bool active = false;
+        std::vector<std::string> tokens;
+
+        void clear(bool act)
+        {
+            active = act;
+            tokens.clear();
+        }
+    };
+
+    //! Records the tokens of a signal while its trace is selected
+    template <typename TokenType>
+    struct trace_probe : public trace_base, public signal_observer<TokenType>
+    {
+        void observe(const TokenType& tok) override
+        {
+            if (!this->active) return;
+            std::ostringstream os;
+            os << tok;
+            this->tokens.push_back(os.str());
+        }
+    };
+#else
+    struct trace_base
+    {
+        std::vector<std::string> tokens;
+        void clear(bool) {tokens.clear();}
+    };
+#endif
+
+    std::map<std::string,std::function<void(const std::string&)>> params;
+    std::vector<std::pair<std::string,std::function<std::string()>>> results;
+    std::map<std::string,std::unique_ptr<trace_base>> traces;
+    size_t runs = 0;
+
+    const std::function<std::string()>* find_result(const std::string& name) const
+    {
+        for (auto& r : results)
+            if (r.first == name) return &r.second;
+        return NULL;
+    }
+
+    static bool send_all(int fd, const std::string& s)
+    {
+        size_t sent = 0;
+        while (sent < s.size())
+        {
+            const ssize_t n = send(fd, s.data()+sent, s.size()-sent, MSG_NOSIGNAL);
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,118 @@
+/**********************************************************************
+    * solver_stats.hpp -- Statistics of the solvers of the filters    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Accounting the work of the solvers of the linear       *
+    *          filters without printing in their step loops           *
+    *                                                                 *
+    * Usage:   Reported in the profile when FORSYDE_PROFILE is        *
+    *          defined, printed when FORSYDE_SOLVER_VERBOSE is        *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SOLVER_STATS_HPP
+#define SOLVER_STATS_HPP
+
+/*! \file solver_stats.hpp
+ * \brief Implements the statistics kept by the solvers of the filters
+ *
+ *  Each filter counts its accepted and rejected steps, the steps which
+ * are accepted only because they reached the minimum step size, and the
+ * evaluations of the derivative of its state, and keeps a histogram of
+ * its accepted step sizes. The statistics are written to the profile at
+ * the end of the simulation.
+ *
+ *  The filters do not print anything while they are stepping, unless
+ * FORSYDE_SOLVER_VERBOSE is defined, in which case the steps accepted at
+ * the minimum step size are reported with a rate limit: only the 1st,
+ * 2nd, 4th, 8th, ... occurrences in each filter.
+ */
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <sstream>
+
+//! The number of bins of the histogram of the step sizes
+#ifndef FORSYDE_SOLVER_HIST_BINS
+#define FORSYDE_SOLVER_HIST_BINS 16
+#endif
+
+namespace ForSyDe
+{
+
+//! The statistics of the solver of a filter
+struct solver_stats
+{
+    //! The accepted steps
+    unsigned long long accepted = 0;
+    //! The rejected steps, which are attempted again with a smaller step
+    unsigned long long rejected = 0;
+    //! The steps accepted at the minimum step size with a larger error
+    unsigned long long min_step_hits = 0;
+    //! The evaluations of the derivative of the state
+    unsigned long long rhs_evals = 0;
+    //! The histogram of the accepted step sizes
+    /*! Bin k counts the steps h with max_step/2^(k+1) < h <= max_step/2^k,
+     * and the last bin also the smaller ones.
+     */
+    std::array<unsigned long long,FORSYDE_SOLVER_HIST_BINS> step_hist{};
+
+    //! Records an accepted step of h seconds
+    void accept(double h, double max_step)
+    {
+        accepted++;
+        int k = 0;
+        if (h > 0 && h < max_step)
+            k = std::min(int(std::floor(std::log2(max_step / h))),
+                         FORSYDE_SOLVER_HIST_BINS-1);
+        step_hist[k]++;
+    }
+
+    //! Records a step accepted at the minimum step size
+    /*! It returns true if the occurrence should be reported, which are
+     * the ones whose count is a power of two.
+     */
+    bool hit_min_step()
+    {
+        min_step_hits++;
+        return (min_step_hits & (min_step_hits-1)) == 0;
+    }
+
+    //! Formats the histogram as a list of counts separated by sep
+    std::string histogram(char sep) const
+    {
+        std::ostringstream ss;
+        for (size_t k=0; k<step_hist.size(); k++)
+            ss << (k ? std::string(1, sep) : "") << step_hist[k];
+        return ss.str();
+    }
+};
+
+//! Records a step accepted at the minimum step size of a filter
+/*! It is reported if FORSYDE_SOLVER_VERBOSE is defined, with a rate
+ * limit.
+ */
+inline void report_min_step(solver_stats& stats, const char* name)
+{
+    const bool due = stats.hit_min_step();
+#ifdef FORSYDE_SOLVER_VERBOSE
+    if (due)
+    {
+        std::ostringstream msg;
+        msg << "step accepted at the minimum step size without meeting "
+            << "the tolerated error (" << stats.min_step_hits << " times)";
+        SC_REPORT_WARNING(name, msg.str().c_str());
+    }
+#else
+    (void)due;
+    (void)name;
+#endif
+}
+
+}
+
+#endif
@@ -0,0 +1,283 @@
+/**********************************************************************
+    * span_fifo.hpp -- A FIFO channel with contiguous token storage   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Letting the dataflow actors read and write the tokens  *
+    *          in place, inside the storage of the channel            *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SPAN_FIFO_HPP
+#define SPAN_FIFO_HPP
+
+/*! \file span_fifo.hpp
+ * \brief Implements a FIFO channel whose tokens can be accessed in place
+ *
+ *  A firing of a dataflow actor usually copies its input tokens from the
+ * channels into local vectors and its output tokens from local vectors
+ * into the channels. This file provides a primitive channel which keeps
+ * the tokens in a contiguous region of its storage, so that an actor can
+ * work directly on a view of the tokens it consumes and of the slots it
+ * produces into (see span_channel and SDF::span_comb).
+ */
+
+#include <vector>
+#include <algorithm>
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A view of a contiguous range of tokens
+/*! It is a minimal stand-in for std::span, which is not available in
+ * C++17.
+ */
+template <typename T>
+class token_span
+{
+public:
+    token_span() : ptr(NULL), len(0) {}
+    token_span(T* ptr, size_t len) : ptr(ptr), len(len) {}
+
+    //! Views a vector
+    template <typename V>
+    token_span(std::vector<V>& vec) : ptr(vec.data()), len(vec.size()) {}
+
+    //! Views a constant vector
+    template <typename V>
+    token_span(const std::vector<V>& vec) : ptr(vec.data()), len(vec.size()) {}
+
+    //! Converts a view of non-constant tokens to a view of constant ones
+    template <typename V>
+    token_span(const token_span<V>& other) : ptr(other.data()), len(other.size()) {}
+
+    T* data() const {return ptr;}
+    size_t size() const {return len;}
+    bool empty() const {return len == 0;}
+    T* begin() const {return ptr;}
+    T* end() const {return ptr + len;}
+    T& operator[](size_t i) const {return ptr[i];}
+
+private:
+    T* ptr;
+    size_t len;
+};
+
+//! The interface of the channels which give access to their tokens in place
+/*! A reader acquires a view of the next n tokens and releases them after
+ * it has used them, and a writer reserves a view of the next n free slots
+ * and commits them after it has filled them. The views stay valid until
+ * they are released or committed. A channel which can not give a view
+ * at the moment (e.g., because its tokens are forwarded to other
+ * channels) returns an empty one, and the actor should then fall back to
+ * the regular reads and writes.
+ */
+template <typename T>
+class span_channel
+{
+public:
+    //! Blocks until n tokens are available and returns a view of them
+    virtual token_span<const T> acquire_read(size_t n) = 0;
+
+    //! Consumes the n tokens at the front of the channel
+    virtual void release_read(size_t n) = 0;
+
+    //! Blocks until n slots are free and returns a view of them
+    virtual token_span<T> reserve_write(size_t n) = 0;
+
+    //! Appends the first n reserved slots to the tokens of the channel
+    virtual void commit_write(size_t n) = 0;
+};
+
+//! A FIFO channel which keeps its tokens in a contiguous region
+/*! The channel implements the same interfaces as sc_fifo, hence it can
+ * be bound to the ForSyDe ports. The tokens are stored in a buffer of
+ * twice the capacity of the channel, from a head index onward. Reading
+ * advances the head, which goes back to the start of the buffer whenever
+ * the channel is emptied, and a write which would run past the end of
+ * the buffer first moves the tokens to its start. In a dataflow graph
+ * the readers usually consume all the tokens, so that the tokens are
+ * rarely moved.
+ *
+ *  The tokens are not moved while a reader holds a view of them, and the
+ * head is not reset while a writer holds a reservation, so that the
+ * views stay valid while the actors wait on their other channels.
+ */
+template <typename T>
+class span_fifo : public sc_fifo_in_if<T>, public sc_fifo_out_if<T>,
+                  public sc_prim_channel
+{
+public:
+    //! The default constructor
+    explicit span_fifo(int size=16)
+        : sc_prim_channel(sc_gen_unique_name("fifo"))
+    {
+        init(size);
+    }
+
+    //! The constructor with a name and the buffer size
+    explicit span_fifo(const char* name, int size=16)
+        : sc_prim_channel(name)
+    {
+        init(size);
+    }
+
+    //! Blocking read
+    void read(T& val)
+    {
+        while (count == 0) sc_core::wait(written_event);
+        val = buf[head];
+        consume(1);
+    }
+
+    //! Blocking read
+    T read()
+    {
+        T tmp;
+        read(tmp);
+        return tmp;
+    }
+
+    //! Non-blocking read
+    bool nb_read(T& val)
+    {
+        if (count == 0) return false;
+        read(val);
+        return true;
+    }
+
+    //! Number of tokens available for reading
+    int num_available() const {return count;}
+
+    //! The event notified when tokens are written
+    const sc_event& data_written_event() const {return written_event;}
+
+    //! Blocking write
+    void write(const T& val)
+    {
+        make_room(1);
+        buf[head+count] = val;
+        produce(1);
+    }
+
+    //! Non-blocking write
+    bool nb_write(const T& val)
+    {
+        if (!fits(1)) return false;
+        write(val);
+        return true;
+    }
+
+    //! Number of free slots in the buffer
+    int num_free() const {return cap - count;}
+
+    //! The event notified when tokens are read
+    const sc_event& data_read_event() const {return read_event;}
+
+    //! Blocks until n tokens are available and returns a view of them
+    token_span<const T> acquire_read(size_t n)
+    {
+        if (n > cap)
+            SC_REPORT_ERROR(this->name(), "acquiring more tokens than the capacity");
+        while (count < n) sc_core::wait(written_event);
+        held = n;
+        return token_span<const T>(buf.data()+head, n);
+    }
+
+    //! Consumes the n tokens at the front of the channel
+    void release_read(size_t n)
+    {
+        held = 0;
+        consume(n);
+    }
+
+    //! Blocks until n slots are free and returns a view of them
+    token_span<T> reserve_write(size_t n)
+    {
+        if (n > cap)
+            SC_REPORT_ERROR(this->name(), "reserving more slots than the capacity");
+        make_room(n);
+        reserved = n;
+        return token_span<T>(buf.data()+head+count, n);
+    }
+
+    //! Appends the first n reserved slots to the tokens of the channel
+    /*! It returns a view of the appended tokens.
+     */
+    token_span<const T> commit_write(size_t n)
+    {
+        reserved = 0;
+        produce(n);
+        return token_span<const T>(buf.data()+head+count-n, n);
+    }
+
+    //! Changes the capacity of the buffer, keeping its tokens
+    /*! It should be called before the simulation starts.
+     */
+    void set_capacity(int size)
+    {
+        std::vector<T> toks(buf.begin()+head, buf.begin()+head+count);
+        init(std::max<int>(size, toks.size()));
+        std::copy(toks.begin(), toks.end(), buf.begin());
+        count = toks.size();
+    }
+
+    //! Reported as a FIFO to keep the introspection backends unchanged
+    virtual const char* kind() const {return "sc_fifo";}
+
+private:
+    std::vector<T> buf;
+    // the capacity, the first token and the number of tokens
+    size_t cap, head, count;
+    // the tokens viewed by the reader and the slots reserved by the writer
+    size_t held, reserved;
+    sc_event written_event, read_event;
+
+    void init(int size)
+    {
+        cap = std::max(size, 1);
+        buf.clear();
+        buf.resize(2*cap);
+        head = count = held = reserved = 0;
+    }
+
+    //! Checks if n tokens can be written without blocking
+    bool fits(size_t n) const
+    {
+        return cap - count >= n && (held == 0 || head+count+n <= buf.size());
+    }
+
+    //! Blocks until n tokens fit and makes room for them after the tokens
+    void make_room(size_t n)
+    {
+        while (!fits(n)) sc_core::wait(read_event);
+        if (head+count+n > buf.size())
+        {
+            std::move(buf.begin()+head, buf.begin()+head+count, buf.begin());
+            head = 0;
+        }
+    }
+
+    void consume(size_t n)
+    {
+        head += n;
+        count -= n;
+        if (count == 0 && reserved == 0) head = 0;
+        read_event.notify(SC_ZERO_TIME);
+    }
+
+    void produce(size_t n)
+    {
+        count += n;
+        written_event.notify(SC_ZERO_TIME);
+    }
+};
+
+}
+
+#endif
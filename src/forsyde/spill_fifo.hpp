@@ -0,0 +1,310 @@
+/**********************************************************************
+    * spill_fifo.hpp -- A FIFO channel spilling its backlog to disk   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Bounding the memory of the signals which accumulate    *
+    *          large backlogs without bounding their capacity         *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SPILL_FIFO to use it                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SPILL_FIFO_HPP
+#define SPILL_FIFO_HPP
+
+/*! \file spill_fifo.hpp
+ * \brief Implements a FIFO channel which spills its older tokens to disk
+ *
+ *  In some dataflow models a fast producer finishes long before a slow
+ * consumer, and the signal between them has to hold the whole stream.
+ * This file provides a primitive channel of unbounded capacity which
+ * keeps only a window of the oldest tokens (the next ones to be read)
+ * and a window of the newest ones in memory, and spills the tokens in
+ * between to a memory-mapped temporary file. It can be used as the base
+ * channel of ForSyDe signals (see SDF::spill_signal and UT::spill_signal).
+ *
+ *  The tokens are serialized using ForSyDe::serializer. The file is
+ * written and read sequentially, and the pages behind the read and write
+ * positions are dropped from the memory of the process, while the pages
+ * ahead of the read position are prefetched. The temporary file is
+ * created in FORSYDE_SPILL_DIR and removed as soon as it is opened.
+ */
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+
+#include "serializer.hpp"
+
+//! The folder of the temporary files of the spilling channels
+#ifndef FORSYDE_SPILL_DIR
+#define FORSYDE_SPILL_DIR "/tmp"
+#endif
+
+//! The bytes prefetched ahead of the read position of a spilled channel
+#ifndef FORSYDE_SPILL_PREFETCH
+#define FORSYDE_SPILL_PREFETCH (1<<20)
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A FIFO channel which spills the tokens beyond its memory window to disk
+/*! The channel implements the same interfaces as sc_fifo, hence it can
+ * be bound to the ForSyDe ports. Writes never block. The oldest tokens
+ * are kept in a read window and the newest ones in a write window, each
+ * holding up to the given number of tokens, and the write window is
+ * appended to the file whenever it fills up while older tokens are
+ * spilled. The read window is refilled from the file, and from the write
+ * window once the file is exhausted, which also rewinds the file.
+ *
+ * The channel is meant for a single reader and a single writer run by
+ * the simulation kernel. The capacity reported to the writer (num_free)
+ * is the largest int less the tokens in the channel.
+ */
+template <typename T>
+class spill_fifo : public sc_fifo_in_if<T>, public sc_fifo_out_if<T>,
+                   public sc_prim_channel
+{
+public:
+    static_assert(serializer<T>::supported, "the tokens of a spilling channel should be serializable");
+
+    //! The default constructor
+    explicit spill_fifo(int size=16)
+        : sc_prim_channel(sc_gen_unique_name("fifo"))
+    {
+        init(size);
+    }
+
+    //! The constructor with a name and the size of the windows
+    explicit spill_fifo(const char* name, int size=16)
+        : sc_prim_channel(name)
+    {
+        init(size);
+    }
+
+    ~spill_fifo()
+    {
+        if (map != MAP_FAILED) munmap(map, map_size);
+        if (fd >= 0) close(fd);
+    }
+
+    //! Blocking read
+    void read(T& val)
+    {
+        while (num_available() == 0) sc_core::wait(written_event);
+        if (rcount == 0) refill();
+        val = rbuf[rhead];
+        rhead = (rhead + 1) % rbuf.size();
+        rcount--;
+        if (rcount == 0) refill();
+        read_event.notify(SC_ZERO_TIME);
+    }
+
+    //! Blocking read
+    T read()
+    {
+        T tmp;
+        read(tmp);
+        return tmp;
+    }
+
+    //! Non-blocking read
+    bool nb_read(T& val)
+    {
+        if (num_available() == 0) return false;
+        read(val);
+        return true;
+    }
+
+    //! Number of tokens available for reading
+    int num_available() const
+    {
+        return rcount + fcount + wbuf.size();
+    }
+
+    //! The event notified when tokens are written
+    const sc_event& data_written_event() const {return written_event;}
+
+    //! Blocking write, which never blocks
+    void write(const T& val)
+    {
+        if (fcount == 0 && wbuf.empty() && rcount < rbuf.size())
+            rbuf[(rhead + rcount++) % rbuf.size()] = val;
+        else
+        {
+            wbuf.push_back(val);
+            if (wbuf.size() == rbuf.size()) spill();
+        }
+        written_event.notify(SC_ZERO_TIME);
+    }
+
+    //! Non-blocking write, which always succeeds
+    bool nb_write(const T& val)
+    {
+        write(val);
+        return true;
+    }
+
+    //! Number of free slots, which is not bounded by the memory
+    int num_free() const {return std::numeric_limits<int>::max() - num_available();}
+
+    //! The event notified when tokens are read
+    const sc_event& data_read_event() const {return read_event;}
+
+    //! Changes the number of tokens of each memory window, keeping the tokens
+    /*! It should be called before the simulation starts.
+     */
+    void set_capacity(int size)
+    {
+        std::vector<T> toks;
+        T tok;
+        while (nb_read(tok)) toks.push_back(tok);
+        init(size);
+        for (auto& t : toks) write(t);
+    }
+
+    //! The tokens currently in the file
+    size_t spilled_tokens() const {return fcount;}
+
+    //! The largest number of bytes the file has held
+    size_t spilled_peak_bytes() const {return peak_bytes;}
+
+    //! Reported as a FIFO to keep the introspection backends unchanged
+    virtual const char* kind() const {return "sc_fifo";}
+
+private:
+    // the read window as a ring buffer, and the write window
+    std::vector<T> rbuf;
+    size_t rhead, rcount;
+    std::vector<T> wbuf;
+    // the file, its mapping, and the read and write positions in it
+    int fd = -1;
+    char* map = static_cast<char*>(MAP_FAILED);
+    size_t map_size = 0;
+    size_t frd, fwr, fcount, fetched, peak_bytes;
+    std::vector<char> sbuf;
+    sc_event written_event, read_event;
+
+    void init(int size)
+    {
+        rbuf.assign(std::max(size, 1), T());
+        rhead = rcount = 0;
+        wbuf.clear();
+        wbuf.reserve(rbuf.size());
+        frd = fwr = fcount = fetched = 0;
+        if (fd < 0) peak_bytes = 0;
+    }
+
+    static size_t page_size()
+    {
+        static const size_t size = sysconf(_SC_PAGESIZE);
+        return size;
+    }
+
+    //! Drops the whole pages of a range of the file from the memory of the process
+    void drop(size_t from, size_t to)
+    {
+        const size_t p = page_size();
+        from = (from + p - 1) / p * p;
+        to = to / p * p;
+        if (to > from) madvise(map + from, to - from, MADV_DONTNEED);
+    }
+
+    //! Opens the temporary file and maps it
+    void open_file()
+    {
+        std::string path = std::string(FORSYDE_SPILL_DIR) + "/forsyde_spill_XXXXXX";
+        fd = mkstemp(&path[0]);
+        if (fd < 0)
+        {
+            SC_REPORT_ERROR(name(), "the spill file could not be created");
+            return;
+        }
+        unlink(path.c_str());
+    }
+
+    //! Grows the file and its mapping to hold at least the given bytes
+    void reserve(size_t bytes)
+    {
+        if (bytes <= map_size) return;
+        size_t size = std::max<size_t>(map_size ? map_size : 1 << 20, page_size());
+        while (size < bytes) size *= 2;
+        if (map != MAP_FAILED) munmap(map, map_size);
+        if (ftruncate(fd, size) != 0)
+            SC_REPORT_ERROR(name(), "the spill file could not be enlarged");
+        map = static_cast<char*>(mmap(NULL, size, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0));
+        if (map == MAP_FAILED)
+            SC_REPORT_ERROR(name(), "the spill file could not be mapped");
+        map_size = size;
+        madvise(map, map_size, MADV_SEQUENTIAL);
+        fetched = frd;
+    }
+
+    //! Appends the write window to the file
+    void spill()
+    {
+        if (fd < 0) open_file();
+        sbuf.clear();
+        for (auto& t : wbuf) serializer<T>::write(sbuf, t);
+        reserve(fwr + sbuf.size());
+        std::memcpy(map + fwr, sbuf.data(), sbuf.size());
+        // the written pages go to the page cache
+        drop(fwr, fwr + sbuf.size());
+        fwr += sbuf.size();
+        fcount += wbuf.size();
+        peak_bytes = std::max(peak_bytes, fwr);
+        wbuf.clear();
+    }
+
+    //! Refills the read window from the file, or from the write window
+    void refill()
+    {
+        if (fcount > 0)
+        {
+            // the file is read ahead of the consumed tokens
+            if (fetched < fwr && fetched < frd + FORSYDE_SPILL_PREFETCH / 2)
+            {
+                const size_t to = std::min(fwr, frd + FORSYDE_SPILL_PREFETCH);
+                const size_t p = page_size();
+                const size_t from = fetched / p * p;
+                madvise(map + from, to - from, MADV_WILLNEED);
+                fetched = to;
+            }
+            const char* pos = map + frd;
+            const size_t start = frd;
+            while (fcount > 0 && rcount < rbuf.size())
+            {
+                serializer<T>::read(pos, rbuf[(rhead + rcount++) % rbuf.size()]);
+                fcount--;
+            }
+            frd = pos - map;
+            drop(start, frd);
+            if (fcount == 0)
+            {
+                // the file is empty and is reused from its beginning
+                drop(0, fwr);
+                frd = fwr = fetched = 0;
+            }
+            return;
+        }
+        size_t i = 0;
+        for (; i < wbuf.size() && rcount < rbuf.size(); i++)
+            rbuf[(rhead + rcount++) % rbuf.size()] = wbuf[i];
+        wbuf.erase(wbuf.begin(), wbuf.begin() + i);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,234 @@
+/**********************************************************************
+    * spsc_fifo.hpp -- A single-producer single-consumer ring buffer  *
+    *                  channel                                        *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a lightweight alternative to sc_fifo for     *
+    *          signals with exactly one writer and one reader         *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SPSC_FIFO_HPP
+#define SPSC_FIFO_HPP
+
+/*! \file spsc_fifo.hpp
+ * \brief Implements a single-producer single-consumer ring buffer channel
+ *
+ *  This file provides a primitive channel which implements the sc_fifo
+ * interfaces on top of a fixed-capacity ring buffer. It can be used as
+ * the base channel of ForSyDe signals.
+ */
+
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+#ifdef FORSYDE_ARENA
+#include "arena.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A single-producer single-consumer ring buffer channel
+/*! The channel implements the same interfaces as sc_fifo, hence it can
+ * be bound to the ForSyDe ports. In contrast to sc_fifo, the written
+ * tokens are visible to the reader immediately and the kernel events
+ * are only notified when the other side is actually blocked on the
+ * channel, so that a burst of reads or writes results in at most one
+ * notification.
+ *
+ * The ring buffer indices are atomic, so the non-blocking accesses are
+ * also safe when the producer and the consumer run on different OS
+ * threads. The capacity is rounded up to the next power of two.
+ */
+template <typename T>
+class spsc_fifo : public sc_fifo_in_if<T>, public sc_fifo_out_if<T>,
+                  public sc_prim_channel
+{
+public:
+    //! The default constructor
+    explicit spsc_fifo(int size=16)
+        : sc_prim_channel(sc_gen_unique_name("fifo"))
+    {
+        init(size);
+    }
+
+    //! The constructor with a name and the buffer size
+    explicit spsc_fifo(const char* name, int size=16)
+        : sc_prim_channel(name)
+    {
+        init(size);
+    }
+
+    //! Blocking read
+    void read(T& val)
+    {
+        while (empty())
+        {
+            reader_waiting = true;
+            sc_core::wait(written_event);
+        }
+        const size_t h = head.load(std::memory_order_relaxed);
+        val = buf[h & mask];
+        head.store(h+1, std::memory_order_release);
+        if (writer_waiting)
+        {
+            writer_waiting = false;
+            read_event.notify(SC_ZERO_TIME);
+        }
+    }
+
+    //! Blocking read
+    T read()
+    {
+        T tmp;
+        read(tmp);
+        return tmp;
+    }
+
+    //! Non-blocking read
+    bool nb_read(T& val)
+    {
+        if (empty()) return false;
+        read(val);
+        return true;
+    }
+
+    //! Number of tokens available for reading
+    int num_available() const
+    {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+
+    //! The event notified when a blocked reader can proceed
+    const sc_event& data_written_event() const {return written_event;}
+
+    //! Requests the notification of data_written_event() on the next write
+    /*! The event is only notified for a blocked reader, hence the
+     * processes which wait for it otherwise (e.g., the methods using
+     * next_trigger) should call this first, after checking that there
+     * are not enough tokens yet.
+     */
+    void arm_data_written() {reader_waiting = true;}
+
+    //! Blocks until the next token is written
+    /*! It is used to wait for a number of tokens without reading them.
+     */
+    void wait_data_written()
+    {
+        reader_waiting = true;
+        sc_core::wait(written_event);
+    }
+
+    //! Blocking write
+    void write(const T& val)
+    {
+        while (full())
+        {
+            writer_waiting = true;
+            sc_core::wait(read_event);
+        }
+        const size_t t = tail.load(std::memory_order_relaxed);
+        buf[t & mask] = val;
+        tail.store(t+1, std::memory_order_release);
+        if (reader_waiting)
+        {
+            reader_waiting = false;
+            written_event.notify(SC_ZERO_TIME);
+        }
+    }
+
+    //! Non-blocking write
+    bool nb_write(const T& val)
+    {
+        if (full()) return false;
+        write(val);
+        return true;
+    }
+
+    //! Number of free slots in the buffer
+    int num_free() const {return buf.size() - num_available();}
+
+    //! Changes the capacity of the buffer, keeping its tokens
+    /*! It can also be called during the simulation by the writer or the
+     * reader, since the blocked side keeps waiting for the same event and
+     * a blocked writer is woken if the buffer is no longer full.
+     */
+    void set_capacity(int size)
+    {
+        std::vector<T> toks;
+        for (size_t h=head.load(); h!=tail.load(); h++) toks.push_back(buf[h & mask]);
+        const bool rw = reader_waiting, ww = writer_waiting;
+        buf.clear();
+        init(std::max<int>(size, toks.size()));
+        for (size_t k=0; k<toks.size(); k++) buf[k] = toks[k];
+        tail.store(toks.size(), std::memory_order_release);
+        reader_waiting = rw;
+        writer_waiting = ww;
+        if (writer_waiting && !full())
+        {
+            writer_waiting = false;
+            read_event.notify(SC_ZERO_TIME);
+        }
+    }
+
+    //! The event notified when a blocked writer can proceed
+    const sc_event& data_read_event() const {return read_event;}
+
+    //! Requests the notification of data_read_event() on the next read
+    /*! The counterpart of arm_data_written() for the processes waiting
+     * for free slots.
+     */
+    void arm_data_read() {writer_waiting = true;}
+
+    //! Reported as a FIFO to keep the introspection backends unchanged
+    virtual const char* kind() const {return "sc_fifo";}
+
+private:
+    // the ring buffer is placed in the elaboration arena, if any
+#ifdef FORSYDE_ARENA
+    std::vector<T, arena_allocator<T>> buf;
+#else
+    std::vector<T> buf;
+#endif
+    size_t mask;
+    // free-running indices; the ring position is index & mask
+    std::atomic<size_t> head, tail;
+    // set by a blocked reader (writer) to request a notification
+    bool reader_waiting, writer_waiting;
+    sc_event written_event, read_event;
+
+    void init(int size)
+    {
+        size_t cap = 1;
+        while (cap < (size_t)std::max(size,1)) cap <<= 1;
+        buf.resize(cap);
+        mask = cap - 1;
+        head = tail = 0;
+        reader_waiting = writer_waiting = false;
+    }
+
+    bool empty() const
+    {
+        return head.load(std::memory_order_relaxed) ==
+               tail.load(std::memory_order_acquire);
+    }
+
+    bool full() const
+    {
+        return tail.load(std::memory_order_relaxed) -
+               head.load(std::memory_order_acquire) == buf.size();
+    }
+};
+
+}
+
+#endif
@@ -18,14 +18,104 @@
  * \brief Implements the sub-components of a CT signal
  */
 
+#include <functional>
+#include <array>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <ostream>
+#include <initializer_list>
+#include <type_traits>
+#include <cmath>
+
+#include "time_ticks.hpp"
+
+//! The highest degree of the polynomial sub-signals
+/*! The results of operations with a higher degree (e.g., the product of
+ * two cubic sub-signals) are represented as generic functions.
+ */
+#ifndef FORSYDE_CT_MAX_DEGREE
+#define FORSYDE_CT_MAX_DEGREE 3
+#endif
+
 namespace ForSyDe
 {
 
 using namespace sc_core;
 
-//! Type of the values used in the CT MoC (currently fixed)
+//! Type of the values used in the CT MoC
 typedef double CTTYPE;
 
+//! A fixed-size vector of values used in the CT MoC
+/*! It is the value type of the vector-valued sub-signals, so that the N
+ * channels of a multi-dimensional signal (e.g., the state of a plant)
+ * are carried by a single signal. The arithmetic operators are applied
+ * element-wise, and a vector can be scaled by a scalar.
+ */
+template <std::size_t N>
+struct ct_vector : public std::array<CTTYPE,N>
+{
+    //! Constructs a zero vector
+    ct_vector() : std::array<CTTYPE,N>{} {}
+
+    //! Constructs a vector from an array
+    ct_vector(const std::array<CTTYPE,N>& a) : std::array<CTTYPE,N>(a) {}
+
+    //! Constructs a vector from a list of values, the rest are zero
+    ct_vector(std::initializer_list<CTTYPE> vals) : std::array<CTTYPE,N>{}
+    {
+        std::copy_n(vals.begin(), std::min(vals.size(), N), this->begin());
+    }
+
+    inline friend ct_vector operator+(ct_vector a, const ct_vector& b)
+    {
+        for (std::size_t i=0; i<N; i++) a[i] += b[i];
+        return a;
+    }
+
+    inline friend ct_vector operator-(ct_vector a, const ct_vector& b)
+    {
+        for (std::size_t i=0; i<N; i++) a[i] -= b[i];
+        return a;
+    }
+
+    //! Multiplies two vectors element-wise
+    inline friend ct_vector operator*(ct_vector a, const ct_vector& b)
+    {
+        for (std::size_t i=0; i<N; i++) a[i] *= b[i];
+        return a;
+    }
+
+    inline friend ct_vector operator*(ct_vector a, CTTYPE k)
+    {
+        for (auto& v : a) v *= k;
+        return a;
+    }
+
+    inline friend ct_vector operator*(CTTYPE k, const ct_vector& a)
+    {
+        return a * k;
+    }
+
+    inline friend bool operator==(const ct_vector& a, const ct_vector& b)
+    {
+        return std::equal(a.begin(), a.end(), b.begin());
+    }
+
+    inline friend bool operator!=(const ct_vector& a, const ct_vector& b)
+    {
+        return !(a == b);
+    }
+
+    friend std::ostream& operator<< (std::ostream& os, const ct_vector& a)
+    {
+        os << "[";
+        for (std::size_t i=0; i<N; i++) os << (i>0 ? " " : "") << a[i];
+        os << "]";
+        return os;
+    }
+};
+
 //! The sub-signal type used to construct a CT signal
 /*! This class is used to build a sub-signal which is a function that is
  * valid on a range. A consecutive stream of tokens of type sub_signal
@@ -34,64 +124,246 @@ typedef double CTTYPE;
  * The range is defined by a start time and and end time of type sc_time.
  * The supplied fuction can be a function pointer, a function object or
  * a C++11 lambda function.
+ *
+ * Besides arbitrary functions, a sub-signal can hold a closed-form
+ * segment: a constant, linear or polynomial function of the time, or a
+ * linearly interpolated table of samples. Shifting, scaling and adding
+ * such segments produce closed-form segments again, so that sampling
+ * the output of a chain of CT processes does not depend on the length
+ * of the chain. All the segments are defined relative to a time origin
+ * which makes shifting a sub-signal in time a constant-time operation.
+ *
+ * The values of a sub-signal are of type V, which is CTTYPE for the
+ * scalar signals (sub_signal) and ct_vector for the vector-valued ones
+ * (vsub_signal). Other value types should be value-initialized to zero
+ * and support addition, subtraction and scaling by CTTYPE, as well as
+ * element-wise multiplication if sub-signals are multiplied.
  */
-class sub_signal
+template <typename V>
+class basic_sub_signal
 {
 public:
     
-    typedef std::function<CTTYPE(const sc_time&)> functype;
+    typedef std::function<V(const sc_time&)> functype;
+
+    //! The representations of the function of a sub-signal
+    enum segment_kind {CONSTANT, LINEAR, POLYNOMIAL, TABLE, GENERIC};
     
     //! The constructor used for sub-signal definition
     /*! 
      */
-    sub_signal(const sc_time& st,         ///< Beginning of the range
+    basic_sub_signal(const sc_time& st,         ///< Beginning of the range
                const sc_time& et,         ///< End of the range
                const functype& f) ///< The function over the range
-        : start_time(st), end_time(et), _f(f) {}
+        : start_time(st), end_time(et), kind(GENERIC), degree(0), coefs{},
+          gain(1), bias{}, _f(f) {}
     
     //! A dummy constructor used for sub-signal definition without initialization
-    /*! 
+    /*! The function is constant zero.
      */
-    sub_signal() {}
-    
-    //! The copy constructor
-    /*! 
+    basic_sub_signal() : kind(CONSTANT), degree(0), coefs{}, gain(1), bias{} {}
+
+    //! Constructs a sub-signal with a constant value
+    static basic_sub_signal constant(const sc_time& st, const sc_time& et, const V& val)
+    {
+        basic_sub_signal ss(st, et);
+        ss.coefs[0] = val;
+        ss.normalize();
+        return ss;
+    }
+
+    //! Constructs a sub-signal with a linear function
+    /*! The value at the start time is given as well as the slope in
+     * units per second.
      */
-    sub_signal(const sub_signal& ss       ///< Object to be copied
-              )
-        : start_time(get_start_time(ss)), end_time(get_end_time(ss)), _f(get_function(ss)) {}
-    
-    //! The assignment operator
-    /*! 
+    static basic_sub_signal linear(const sc_time& st, const sc_time& et,
+                             const V& start_val, const V& slope)
+    {
+        basic_sub_signal ss(st, et);
+        ss.coefs[0] = start_val;
+        ss.coefs[1] = slope;
+        ss.degree = 1;
+        ss.normalize();
+        return ss;
+    }
+
+    //! Constructs a sub-signal with a polynomial function
+    /*! The coefficients are given in the increasing order of the powers
+     * of the time passed since the start time in seconds.
+     */
+    static basic_sub_signal polynomial(const sc_time& st, const sc_time& et,
+                                 const std::vector<V>& c)
+    {
+        if (c.size() > FORSYDE_CT_MAX_DEGREE+1)
+        {
+            std::vector<V> cc = c;
+            return basic_sub_signal(st, et, [cc,st](const sc_time& t)
+                {
+                    const double tau = offset(t, st);
+                    V res{};
+                    for (size_t k=cc.size(); k-->0;) res = res*tau + cc[k];
+                    return res;
+                });
+        }
+        basic_sub_signal ss(st, et);
+        std::copy(c.begin(), c.end(), ss.coefs.begin());
+        ss.degree = c.empty() ? 0 : c.size()-1;
+        ss.normalize();
+        return ss;
+    }
+
+    //! Constructs a sub-signal which interpolates a table of samples
+    /*! The samples are taken with the given period starting from the
+     * start time. The values between the samples are linearly
+     * interpolated, or each sample is held until the next one if hold is
+     * set, and the values after the last sample are held.
      */
-    sub_signal& operator=(const sub_signal& ss  ///< Object to be assigned
-                        ){
-        start_time = get_start_time(ss);
-        end_time = get_end_time(ss);
-        _f = get_function(ss);
-        return *this;
+    static basic_sub_signal table(const sc_time& st, const sc_time& et,
+                            const sc_time& period,
+                            std::vector<V> samples,
+                            bool hold=false)
+    {
+        basic_sub_signal ss(st, et);
+        if (samples.empty() || period == SC_ZERO_TIME)
+        {
+            SC_REPORT_ERROR("Using ForSyDe::CT","Invalid sub-signal table");
+            return ss;
+        }
+        ss.kind = TABLE;
+        ss.period = period;
+        ss.hold = hold;
+        ss.samples = std::make_shared<const std::vector<V>>(std::move(samples));
+        return ss;
     }
     
+    //! Constructs a sub-signal from consecutive sub-signals
+    /*! The pieces should be sorted and contiguous. The resulting
+     * sub-signal ranges from the start of the first piece to the end of
+     * the last one and evaluates the piece which contains the time.
+     */
+    static basic_sub_signal piecewise(const std::vector<basic_sub_signal>& pieces)
+    {
+        if (pieces.empty())
+        {
+            SC_REPORT_ERROR("Using ForSyDe::CT","Invalid piecewise sub-signal");
+            return basic_sub_signal();
+        }
+        if (pieces.size() == 1) return pieces.front();
+        auto ps = std::make_shared<const std::vector<basic_sub_signal>>(pieces);
+        return basic_sub_signal(pieces.front().start_time, pieces.back().end_time,
+            [ps](const sc_time& t)
+            {
+                auto it = std::upper_bound(ps->begin(), ps->end(), t,
+                    [](const sc_time& t, const basic_sub_signal& p)
+                    {
+                        return t < p.start_time;
+                    });
+                return (it == ps->begin() ? *it : *(it-1)).eval(t);
+            });
+    }
+
     //! The overloaded () operator makes the sub-signal a function object
     /*! It allows to sample the signal with a convinient syntax.
      * Additionally, it checks the sampling time validity with respect
      * to the range.
      */
-    CTTYPE operator() (const sc_time& valAt) const
+    V operator() (const sc_time& valAt) const
     {
         if ((valAt>=start_time) && (valAt<end_time))
-            return _f(valAt);
+            return eval(valAt);
         else
         {
             SC_REPORT_ERROR("Using ForSyDe::CT","Access out of sub-signal range");
-            return -1;
+            return V{};
+        }
+    }
+
+    //! Samples the sub-signal at several times
+    /*! All the times should be in the range, which is checked once for
+     * the whole batch. The constant and linear segments are evaluated
+     * in tight loops without calling a function object per sample.
+     */
+    void sample(const sc_time* ts, V* out, size_t n) const
+    {
+        for (size_t i=0; i<n; i++)
+            if (ts[i] < start_time || ts[i] >= end_time)
+            {
+                SC_REPORT_ERROR("Using ForSyDe::CT","Access out of sub-signal range");
+                return;
+            }
+        switch (kind)
+        {
+        case CONSTANT:
+            std::fill_n(out, n, coefs[0]);
+            return;
+        case LINEAR:
+            for (size_t i=0; i<n; i++)
+                out[i] = coefs[0] + coefs[1] * offset(ts[i], origin);
+            return;
+        default:
+            for (size_t i=0; i<n; i++) out[i] = eval(ts[i]);
         }
     }
+
+    //! Samples the sub-signal periodically
+    /*! The n samples are taken at t0, t0+dt, ..., which should all be in
+     * the range (see count_samples). The values are the same as the ones
+     * obtained by sampling the times one by one.
+     */
+    void sample_uniform(const sc_time& t0, const sc_time& dt, size_t n, V* out) const
+    {
+        if (n == 0) return;
+        if (t0 < start_time || t0 + scale_time(dt, n-1) >= end_time)
+        {
+            SC_REPORT_ERROR("Using ForSyDe::CT","Access out of sub-signal range");
+            return;
+        }
+        const std::int64_t d0 = to_ticks(t0) - to_ticks(origin);
+        const std::int64_t dd = to_ticks(dt);
+        const double res = tick_seconds();
+        switch (kind)
+        {
+        case CONSTANT:
+            std::fill_n(out, n, coefs[0]);
+            return;
+        case LINEAR:
+            for (size_t i=0; i<n; i++)
+                out[i] = coefs[0] + coefs[1] * (double(d0 + std::int64_t(i)*dd) * res);
+            return;
+        case POLYNOMIAL:
+            for (size_t i=0; i<n; i++)
+            {
+                const double tau = double(d0 + std::int64_t(i)*dd) * res;
+                V v = coefs[degree];
+                for (unsigned k=degree; k-->0;) v = v*tau + coefs[k];
+                out[i] = v;
+            }
+            return;
+        case TABLE:
+            for (size_t i=0; i<n; i++) out[i] = table_at(d0 + std::int64_t(i)*dd);
+            return;
+        default:
+        {
+            sc_time t = t0;
+            for (size_t i=0; i<n; i++, t+=dt) out[i] = eval(t);
+        }
+        }
+    }
+
+    //! The number of the periodic samples from a time until the end of the range
+    size_t count_samples(const sc_time& t0, const sc_time& dt) const
+    {
+        if (t0 >= end_time || dt == SC_ZERO_TIME) return 0;
+        return (to_ticks(end_time) - to_ticks(t0) - 1) / to_ticks(dt) + 1;
+    }
+
+    //! Returns the representation of the function of the sub-signal
+    segment_kind get_kind() const {return kind;}
     
     //! A helper function used to get the beginning of the range
     /*! 
      */
-    inline friend sc_time get_start_time(const sub_signal& ss)
+    inline friend sc_time get_start_time(const basic_sub_signal& ss)
     {
         return ss.start_time;
     }
@@ -99,23 +371,26 @@ public:
     //! A helper function used to get the end of the range
     /*! 
      */
-    inline friend sc_time get_end_time(const sub_signal& ss)
+    inline friend sc_time get_end_time(const basic_sub_signal& ss)
     {
         return ss.end_time;
     }
     
     //! A helper function used to get the functions in range
-    /*! 
+    /*! The closed-form segments are wrapped in a function object.
      */
-    inline friend std::function<CTTYPE(const sc_time&)> get_function(const sub_signal& ss)
+    inline friend functype get_function(const basic_sub_signal& ss)
     {
-        return ss._f;
+        if (ss.kind == GENERIC && ss.gain == 1 && ss.bias == V{} &&
+            ss.origin == SC_ZERO_TIME)
+            return ss._f;
+        return [ss](const sc_time& t){return ss.eval(t);};
     }
 
     //! A helper function used to set the start and end of the range
     /*! 
      */
-    inline friend void set_range(sub_signal& ss, sc_time st, sc_time et)
+    inline friend void set_range(basic_sub_signal& ss, sc_time st, sc_time et)
     {
         ss.start_time = st;
         ss.end_time = et;
@@ -124,12 +399,133 @@ public:
     //! A helper function used to set the function in the range
     /*! 
      */
-    inline friend void set_function(sub_signal& ss, const std::function<CTTYPE(const sc_time&)>& f)
+    inline friend void set_function(basic_sub_signal& ss, const functype& f)
     {
+        ss.kind = GENERIC;
+        ss.origin = SC_ZERO_TIME;
+        ss.gain = 1;
+        ss.bias = V{};
+        ss.samples.reset();
         ss._f = f;
     }
+
+    //! A helper function used to delay the sub-signal in time
+    /*! Both the range and the function are shifted.
+     */
+    inline friend void shift_time(basic_sub_signal& ss, const sc_time& d)
+    {
+        ss.start_time += d;
+        ss.end_time += d;
+        ss.origin += d;
+    }
+
+    //! Merges a sub-signal into the preceding one if they are compatible
+    /*! The sub-signals are compatible if the second one starts at the end
+     * of the first one and both are the same closed-form function, e.g.,
+     * two pieces of a ramp, or two pieces of the same table. Returns
+     * false and leaves the first sub-signal unchanged otherwise.
+     */
+    inline friend bool merge_segments(basic_sub_signal& a, const basic_sub_signal& b)
+    {
+        if (a.end_time != b.start_time) return false;
+        bool same = false;
+        if (a.is_polynomial() && b.is_polynomial())
+        {
+            if (a.degree != b.degree) return false;
+            const basic_sub_signal bb = b.reorigin(a.origin);
+            same = true;
+            for (unsigned i=0; i<=a.degree; i++)
+                same = same && near(a.coefs[i], bb.coefs[i]);
+        }
+        else if (a.kind == TABLE && b.kind == TABLE)
+            same = a.samples == b.samples && a.origin == b.origin &&
+                   a.period == b.period && a.hold == b.hold &&
+                   a.gain == b.gain && a.bias == b.bias;
+        if (same) a.end_time = b.end_time;
+        return same;
+    }
+
+    //! Scales a sub-signal
+    inline friend basic_sub_signal operator*(const basic_sub_signal& ss, CTTYPE k)
+    {
+        basic_sub_signal res = ss;
+        if (res.is_polynomial())
+        {
+            for (unsigned i=0; i<=res.degree; i++) res.coefs[i] = res.coefs[i] * k;
+            res.normalize();
+        }
+        else
+        {
+            res.gain *= k;
+            res.bias = res.bias * k;
+        }
+        return res;
+    }
+
+    //! Scales a sub-signal
+    inline friend basic_sub_signal operator*(CTTYPE k, const basic_sub_signal& ss)
+    {
+        return ss * k;
+    }
+
+    //! Adds a constant to a sub-signal
+    inline friend basic_sub_signal operator+(const basic_sub_signal& ss, const V& c)
+    {
+        basic_sub_signal res = ss;
+        if (res.is_polynomial())
+        {
+            res.coefs[0] = res.coefs[0] + c;
+            res.normalize();
+        }
+        else
+            res.bias = res.bias + c;
+        return res;
+    }
+
+    //! Adds two sub-signals over the intersection of their ranges
+    inline friend basic_sub_signal operator+(const basic_sub_signal& a, const basic_sub_signal& b)
+    {
+        return combine(a, b, 1);
+    }
+
+    //! Subtracts two sub-signals over the intersection of their ranges
+    inline friend basic_sub_signal operator-(const basic_sub_signal& a, const basic_sub_signal& b)
+    {
+        return combine(a, b, -1);
+    }
+
+    //! Multiplies two sub-signals over the intersection of their ranges
+    inline friend basic_sub_signal operator*(const basic_sub_signal& a, const basic_sub_signal& b)
+    {
+        const sc_time st = std::max(a.start_time, b.start_time);
+        const sc_time et = std::min(a.end_time, b.end_time);
+        if (b.kind == CONSTANT)
+        {
+            basic_sub_signal res = a.scaled(b.coefs[0]);
+            set_range(res, st, et);
+            return res;
+        }
+        if (a.kind == CONSTANT) return b * a;
+        if (a.is_polynomial() && b.is_polynomial() &&
+            a.degree + b.degree <= FORSYDE_CT_MAX_DEGREE)
+        {
+            basic_sub_signal res(st, et);
+            res.origin = a.origin;
+            const basic_sub_signal bb = b.reorigin(a.origin);
+            res.degree = a.degree + b.degree;
+            for (unsigned i=0; i<=a.degree; i++)
+                for (unsigned j=0; j<=bb.degree; j++)
+                    res.coefs[i+j] = res.coefs[i+j] + a.coefs[i] * bb.coefs[j];
+            res.normalize();
+            return res;
+        }
+        return basic_sub_signal(st, et, [a,b](const sc_time& t)
+            {
+                return a.eval(t) * b.eval(t);
+            });
+    }
     
-    friend std::ostream& operator<< (std::ostream& os, sub_signal &subSig)
+    friend std::ostream& operator<< (std::ostream& os, basic_sub_signal &subSig)
     {
         os << "(" << get_start_time(subSig) << ", " 
            << get_end_time(subSig) << ") -> f";
@@ -138,8 +534,220 @@ public:
 private:
     sc_time start_time;
     sc_time end_time;
+
+    //! The representation of the function
+    segment_kind kind;
+    //! The time at which the local time of the closed-form segment is zero
+    sc_time origin;
+    //! The degree and coefficients of the polynomial segments
+    unsigned degree;
+    std::array<V,FORSYDE_CT_MAX_DEGREE+1> coefs;
+    //! The sampling period and the samples of the table segments
+    sc_time period;
+    std::shared_ptr<const std::vector<V>> samples;
+    //! If the samples of the table segments are held instead of interpolated
+    bool hold = false;
+    //! The scale and offset applied to the table and generic segments
+    CTTYPE gain;
+    V bias;
     functype _f;
+
+    //! Constructs a constant zero sub-signal with its origin at the start
+    basic_sub_signal(const sc_time& st, const sc_time& et)
+        : start_time(st), end_time(et), kind(CONSTANT), origin(st),
+          degree(0), coefs{}, gain(1), bias{} {}
+
+    //! The signed difference of two times in seconds
+    static double offset(const sc_time& t, const sc_time& o)
+    {
+        return seconds_between(t, o);
+    }
+
+    bool is_polynomial() const {return kind <= POLYNOMIAL;}
+
+    //! Compares two coefficients up to the rounding of a change of origin
+    static bool near(const V& x, const V& y)
+    {
+        if constexpr (std::is_arithmetic<V>::value)
+            return std::abs(x - y) <=
+                   1e-12 * std::max({std::abs(x), std::abs(y), CTTYPE(1)});
+        else
+            return x == y;
+    }
+
+    //! Updates the kind of a polynomial segment after its degree changes
+    void normalize()
+    {
+        while (degree > 0 && coefs[degree] == V{}) degree--;
+        kind = degree == 0 ? CONSTANT : degree == 1 ? LINEAR : POLYNOMIAL;
+    }
+
+    //! Evaluates the function without checking the range
+    V eval(const sc_time& t) const
+    {
+        switch (kind)
+        {
+        case CONSTANT:
+            return coefs[0];
+        case LINEAR:
+            return coefs[0] + coefs[1] * offset(t, origin);
+        case POLYNOMIAL:
+        {
+            const double tau = offset(t, origin);
+            V res = coefs[degree];
+            for (unsigned k=degree; k-->0;) res = res*tau + coefs[k];
+            return res;
+        }
+        case TABLE:
+            return table_at(std::int64_t(to_ticks(t) - to_ticks(origin)));
+        default:
+            return gain * _f(t - origin) + bias;
+        }
+    }
+
+    //! Evaluates a table segment at an offset from its origin in ticks
+    /*! The position in the table is computed in integer ticks, so that
+     * the samples are hit exactly.
+     */
+    V table_at(std::int64_t d) const
+    {
+        const std::vector<V>& v = *samples;
+        if (d <= 0) return gain * v.front() + bias;
+        const std::int64_t p = to_ticks(period);
+        const size_t i = d / p;
+        if (i+1 >= v.size()) return gain * v.back() + bias;
+        const std::int64_t r = d - std::int64_t(i) * p;
+        if (hold || r == 0) return gain * v[i] + bias;
+        return gain * (v[i] + (v[i+1]-v[i]) * (double(r) / double(p))) + bias;
+    }
+
+    //! Expresses a polynomial segment relative to another origin
+    basic_sub_signal reorigin(const sc_time& o) const
+    {
+        basic_sub_signal res = *this;
+        if (kind == CONSTANT || o == origin) return res;
+        // Taylor shift of the coefficients using repeated synthetic division
+        const double d = offset(o, origin);
+        for (unsigned i=0; i<degree; i++)
+            for (unsigned j=degree-1; j+1>i; j--)
+                res.coefs[j] = res.coefs[j] + d * res.coefs[j+1];
+        res.origin = o;
+        return res;
+    }
+
+    //! Multiplies a sub-signal by a constant value
+    basic_sub_signal scaled(const V& k) const
+    {
+        if constexpr (std::is_arithmetic<V>::value)
+            return *this * k;
+        else if (is_polynomial())
+        {
+            basic_sub_signal res = *this;
+            for (unsigned i=0; i<=res.degree; i++) res.coefs[i] = res.coefs[i] * k;
+            res.normalize();
+            return res;
+        }
+        else
+        {
+            const basic_sub_signal a = *this;
+            return basic_sub_signal(start_time, end_time, [a,k](const sc_time& t)
+                {
+                    return a.eval(t) * k;
+                });
+        }
+    }
+
+    //! Adds or subtracts two sub-signals
+    static basic_sub_signal combine(const basic_sub_signal& a, const basic_sub_signal& b, CTTYPE sign)
+    {
+        const sc_time st = std::max(a.start_time, b.start_time);
+        const sc_time et = std::min(a.end_time, b.end_time);
+        basic_sub_signal res(st, et);
+        if (a.is_polynomial() && b.is_polynomial())
+        {
+            res = a.reorigin(b.kind == CONSTANT ? a.origin : b.origin);
+            if (a.kind == CONSTANT) res.origin = b.origin;
+            set_range(res, st, et);
+            res.degree = std::max(a.degree, b.degree);
+            for (unsigned i=0; i<=b.degree; i++) res.coefs[i] = res.coefs[i] + sign * b.coefs[i];
+            res.normalize();
+            return res;
+        }
+        if (b.kind == CONSTANT)
+        {
+            res = a + sign * b.coefs[0];
+            set_range(res, st, et);
+            return res;
+        }
+        if (a.kind == CONSTANT)
+        {
+            res = b * sign + a.coefs[0];
+            set_range(res, st, et);
+            return res;
+        }
+        return basic_sub_signal(st, et, [a,b,sign](const sc_time& t)
+            {
+                return a.eval(t) + sign * b.eval(t);
+            });
+    }
 };
 
+//! The sub-signals of the scalar CT signals
+typedef basic_sub_signal<CTTYPE> sub_signal;
+
+//! Aligns a stream of sub-signals to a grid of breakpoints
+/*! The sub-signals pushed to the aligner are gathered until the input
+ * passes a multiple of the grid period. Then a single sub-signal is
+ * produced up to the last passed grid point, the compatible adjacent
+ * pieces being merged and the rest being wrapped in a piecewise
+ * sub-signal. Hence the output sub-signals always end at the grid points
+ * and there are at most as many of them as there are grid periods, no
+ * matter how fragmented the input is, while long input sub-signals are
+ * not split. A zero grid passes the sub-signals through.
+ */
+template <typename V>
+class segment_aligner
+{
+public:
+    segment_aligner(const sc_time& grid=SC_ZERO_TIME) : grid(grid) {}
+
+    //! Appends the next sub-signal
+    /*! Returns true and sets the output if an aligned sub-signal is ready.
+     */
+    bool push(const basic_sub_signal<V>& ss, basic_sub_signal<V>& out)
+    {
+        if (grid == SC_ZERO_TIME)
+        {
+            out = ss;
+            return true;
+        }
+        if (pending.empty() || !merge_segments(pending.back(), ss))
+            pending.push_back(ss);
+        const sc_time end = get_end_time(ss);
+        const sc_time cut = from_ticks(to_ticks(end) / to_ticks(grid) * to_ticks(grid));
+        if (cut <= get_start_time(pending.front())) return false;
+        // the cut lies in the last piece, since no grid point is passed before
+        basic_sub_signal<V> rest = pending.back();
+        set_range(pending.back(), get_start_time(rest), cut);
+        out = basic_sub_signal<V>::piecewise(pending);
+        pending.clear();
+        if (cut < end)
+        {
+            set_range(rest, cut, end);
+            pending.push_back(rest);
+        }
+        return true;
+    }
+
+private:
+    sc_time grid;
+    // the pieces since the last grid point passed
+    std::vector<basic_sub_signal<V>> pending;
+};
+
+//! The sub-signals of the vector-valued CT signals with N channels
+template <std::size_t N>
+using vsub_signal = basic_sub_signal<ct_vector<N>>;
+
 }
 #endif
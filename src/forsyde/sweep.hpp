@@ -0,0 +1,163 @@
+/**********************************************************************
+    * sweep.hpp -- Parameter sweeps forked from a common simulation   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Exploring the variants of a model without simulating   *
+    *          their common prefix again                              *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SIGNAL_TRACE to use it                  *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SWEEP_HPP
+#define SWEEP_HPP
+
+/*! \file sweep.hpp
+ * \brief Implements the parameter sweeps forked from a simulation
+ *
+ *  This file includes a driver which elaborates and simulates a model
+ * once up to a branching time, and then forks the simulation into a
+ * child process for each variant of the parameters. Each child changes
+ * the parameters of the designated processes (e.g., using
+ * SY::constant::set_value or DDE::filter::set_coefficients) and
+ * simulates the rest, while its results are recorded into a trace file
+ * of its own, which starts with the trace of the common prefix:
+ *
+ *     top t("top");
+ *     trace_recorder rec;
+ *     rec.open("sweep.trc");
+ *     rec.record(t.out_sig, "out");
+ *     auto res = fork_sweep(gains.size(),
+ *                           [&](size_t i){t.gain->set_value(gains[i]);},
+ *                           sc_time(1,SC_MS), &rec, "sweep");
+ *
+ *  The traces are then compared using trace_reader. Only the calling
+ * thread is copied into the children, hence the models which use other
+ * threads (e.g., the asynchronous file sinks or the multi-threaded
+ * executors) should not be forked while these threads hold any data.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include <exception>
+#include <cstdio>
+#include <cstdlib>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "abssemantics.hpp"
+#include "trace_recorder.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The outcome of a variant of a parameter sweep
+struct sweep_result
+{
+    size_t variant;             ///< the index of the variant
+    std::string trace_file;     ///< the trace of the variant, if recorded
+    //! The exit status of the child
+    /*! It is zero if the simulation has completed, one if it is stopped
+     * by an error, two if the trace can not be written, and -1 if the
+     * child could not be started or is killed.
+     */
+    int status;
+};
+
+//! Simulates the variants of a model forked at a branching time
+/*! The model is simulated up to the branching time in the calling
+ * process. Then, for each variant, a child process is forked which calls
+ * the apply function with the index of the variant and simulates the
+ * given time, or until the end if it is zero. If a recorder is given,
+ * the trace of the i-th variant is written to "<prefix>_<i>.trc". At most
+ * the given number of children (by default one per core) run at once.
+ * It returns when all the children have terminated, with the simulation
+ * of the caller still paused at the branching time.
+ */
+inline std::vector<sweep_result> fork_sweep(
+        size_t variants,                            ///< number of the variants
+        const std::function<void(size_t)>& apply,   ///< applies the parameters of a variant
+        const sc_time& branch_time,                 ///< the end of the common prefix
+        trace_recorder* rec=NULL,                   ///< records the results
+        const std::string& trace_prefix="sweep",    ///< the prefix of the trace files
+        const sc_time& run_time=SC_ZERO_TIME,       ///< the simulated time after the branch
+        unsigned jobs=0                             ///< the number of concurrent children
+        )
+{
+    std::vector<sweep_result> res(variants);
+    if (sc_time_stamp() < branch_time) sc_start(branch_time - sc_time_stamp());
+    if (rec) rec->pause();
+    // otherwise the buffered output is written by all the children
+    std::fflush(NULL);
+    if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+
+    std::map<pid_t,size_t> running;
+    auto reap = [&]()
+    {
+        int st;
+        const pid_t pid = waitpid(-1, &st, 0);
+        if (pid < 0) return false;
+        auto it = running.find(pid);
+        if (it != running.end())
+        {
+            res[it->second].status = WIFEXITED(st) ? WEXITSTATUS(st) : -1;
+            running.erase(it);
+        }
+        return true;
+    };
+
+    for (size_t i=0; i<variants; i++)
+    {
+        res[i].variant = i;
+        res[i].status = -1;
+        if (rec) res[i].trace_file = trace_prefix + "_" + std::to_string(i) + ".trc";
+        while (running.size() >= jobs && reap()) {}
+        const pid_t pid = fork();
+        if (pid < 0)
+        {
+            SC_REPORT_WARNING("fork_sweep", "could not fork the simulation");
+            break;
+        }
+        if (pid == 0)
+        {
+            int code = 0;
+            try
+            {
+                if (rec && !rec->branch(res[i].trace_file)) std::_Exit(2);
+                apply(i);
+                if (run_time == SC_ZERO_TIME) sc_start(); else sc_start(run_time);
+                if (rec)
+                {
+                    rec->close();
+                    if (rec->has_failed()) code = 2;
+                }
+            }
+            catch (const std::exception& e)
+            {
+                std::fprintf(stderr, "%s\n", e.what());
+                code = 1;
+            }
+            std::fflush(NULL);
+            // the state of the model belongs to the parent
+            std::_Exit(code);
+        }
+        running[pid] = i;
+    }
+    while (!running.empty() && reap()) {}
+
+    if (rec) rec->resume();
+    return res;
+}
+
+}
+
+#endif
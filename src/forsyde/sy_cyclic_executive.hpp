@@ -0,0 +1,330 @@
+/**********************************************************************
+    * sy_cyclic_executive.hpp -- Single-threaded execution of SY      *
+    *                            process networks                     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Evaluating the processes of a synchronous region in a  *
+    *          static order, once per evaluation cycle                *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_CYCLIC_EXECUTIVE_HPP
+#define SY_CYCLIC_EXECUTIVE_HPP
+
+/*! \file sy_cyclic_executive.hpp
+ * \brief Implements a cyclic executive for SY process networks
+ *
+ *  This file includes the analysis of a closed SY region, which orders
+ * its processes within an evaluation cycle, and an opt-in executor which
+ * evaluates all of them in a single thread in that order.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+
+#include "sy_process.hpp"
+#ifdef FORSYDE_NUMA
+#include "numa_placement.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! A closed region of SY processes, ordered within an evaluation cycle
+/*! The processes of the region are classified by their roles in an
+ * evaluation cycle (tick):
+ *  - the sources (the processes without inputs) are fired first,
+ *  - the rest of the processes are fired after all of their producers
+ *    in the same tick, which gives a topological order,
+ *  - the delays, which break the feedback loops, are fired at the end of
+ *    the tick. The Moore machines are handled as delays, which are fired
+ *    once more before the first tick to produce their first output.
+ *
+ * Skipping the absent cycles is disabled for all the processes, so that
+ * each one reads and writes exactly one token per port and tick. The
+ * region is shared by the executors of SY process networks.
+ */
+class sy_region
+{
+public:
+    //! The processes of the region
+    std::vector<sy_process*> procs;
+
+    //! The processes of a tick by their roles
+    std::vector<sy_process*> sources, delays, combs;
+    //! The delays which are fired before the first tick
+    std::vector<sy_process*> primed;
+    //! The successors of each of the combs, by their indices in combs
+    std::vector<std::vector<size_t>> succs;
+    //! The number of producers of each of the combs in the same tick
+    std::vector<size_t> npreds;
+    //! The combs without producers in the same tick
+    std::vector<size_t> roots;
+    //! A topological order of the combs
+    std::vector<size_t> order;
+    //! The channels of the region
+    std::vector<static_channel*> chans;
+#ifdef FORSYDE_NUMA
+    //! The placement of the processes on the NUMA nodes, if any
+    numa_placement placement;
+#endif
+
+    //! Collects the SY processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        std::vector<sc_object*> children = obj->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+        {
+            sy_process* p = dynamic_cast<sy_process*>(*it);
+            if (p != NULL)
+            {
+                if (p->forsyde_kind().compare(0, 4, "SY::") == 0) procs.push_back(p);
+            }
+            else if (dynamic_cast<sc_module*>(*it) != NULL)
+                collect(*it);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        std::vector<sc_object*> children = p->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+            if ((*it)->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(*it);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! The kinds of the processes which can not be driven by the executors
+    /*! The domain interfaces are only supported by the executor of the
+     * multi-clock regions (see multiclock_executive).
+     */
+    static std::set<std::string> unsupported_kinds()
+    {
+        // (the senders and receivers can wait in the threads of a pool when
+        // MPI is progressed by the communication thread, see mpi_progress)
+#ifdef FORSYDE_MPI_PROGRESS_THREAD
+        return {"SY::group", "SY::sgroup", "SY::gdbwrap", "SY::pipewrap",
+                "SY::pipewrap2", "SY::upsample", "SY::downsample", "SY::udp_source",
+                "SY::multi_fidelity"};
+#else
+        return {"SY::group", "SY::sgroup", "SY::gdbwrap", "SY::pipewrap",
+                "SY::pipewrap2", "SY::sender", "SY::receiver",
+                "SY::upsample", "SY::downsample", "SY::udp_source",
+                "SY::multi_fidelity"};
+#endif
+    }
+    
+    //! Classifies the processes and orders the combs
+    /*! The errors are reported on behalf of the given executor, which is
+     * described as who in the messages.
+     */
+    void analyze(const char* owner, const std::string& who)
+    {
+        const std::set<std::string> delay_kinds = {"SY::delay", "SY::delayn",
+                                                   "SY::delayline",
+                                                   "SY::sdelay", "SY::sdelayn"};
+        const std::set<std::string> moore_kinds = {"SY::moore", "SY::smoore"};
+        const std::set<std::string> unsupported = unsupported_kinds();
+        // writers and readers of the channels
+        std::map<sc_interface*, sy_process*> writer, reader;
+        for (auto p : procs)
+        {
+            if (unsupported.count(p->forsyde_kind()))
+                SC_REPORT_ERROR(owner, (p->forsyde_kind() + " processes are not supported by " + who).c_str());
+            if (auto as = dynamic_cast<absent_skipping*>(p))
+                as->set_skip_absent(false);
+            auto ins = channels(p, "sc_fifo_in");
+            for (auto c : ins) reader[c] = p;
+            for (auto c : channels(p, "sc_fifo_out")) writer[c] = p;
+            if (delay_kinds.count(p->forsyde_kind()))
+                delays.push_back(p);
+            else if (moore_kinds.count(p->forsyde_kind()))
+            {
+                delays.push_back(p);
+                primed.push_back(p);
+            }
+            else if (ins.empty())
+                sources.push_back(p);
+            else
+                combs.push_back(p);
+        }
+        // all the channels should be inside the region
+        for (auto& w : writer)
+            if (reader.find(w.first) == reader.end())
+                SC_REPORT_ERROR(owner, (who + " requires a closed SY region: a signal has no reader in the region").c_str());
+        for (auto& r : reader)
+        {
+            if (writer.find(r.first) == writer.end())
+                SC_REPORT_ERROR(owner, (who + " requires a closed SY region: a signal has no writer in the region").c_str());
+            static_channel* ch = dynamic_cast<static_channel*>(r.first);
+            if (ch == NULL)
+                SC_REPORT_ERROR(owner, ("only ForSyDe signals are supported by " + who).c_str());
+            chans.push_back(ch);
+        }
+        // dependencies among the combs
+        std::map<sy_process*, size_t> idx;
+        for (size_t i=0; i<combs.size(); i++) idx[combs[i]] = i;
+        succs.resize(combs.size());
+        npreds.assign(combs.size(), 0);
+        for (auto& r : reader)
+        {
+            auto src = idx.find(writer[r.first]);
+            auto dst = idx.find(r.second);
+            if (src == idx.end() || dst == idx.end()) continue;
+            succs[src->second].push_back(dst->second);
+            npreds[dst->second]++;
+        }
+        for (size_t i=0; i<combs.size(); i++)
+            if (npreds[i] == 0) roots.push_back(i);
+        // order them, which also checks for the zero-delay loops
+        std::vector<size_t> indeg(npreds), stack(roots.rbegin(), roots.rend());
+        while (!stack.empty())
+        {
+            size_t a = stack.back(); stack.pop_back();
+            order.push_back(a);
+            for (auto b : succs[a])
+                if (--indeg[b] == 0) stack.push_back(b);
+        }
+        if (order.size() != combs.size())
+            SC_REPORT_ERROR(owner, "the SY region has a zero-delay feedback loop");
+    }
+
+    //! Starts the processes and sizes the channels for one tick
+    /*! It should be called from the SystemC thread of the executor, which
+     * is suspended for a delta cycle to let the initial tokens arrive.
+     */
+    void start()
+    {
+#ifdef FORSYDE_NUMA
+        for (auto p : procs) placement.init(p);
+#else
+        for (auto p : procs) p->ext_init();
+#endif
+        for (auto p : primed) p->ext_fire();
+        // let the initial tokens arrive and move them into the ring buffers
+        // which hold them plus the token of one tick
+        wait(SC_ZERO_TIME);
+        for (auto ch : chans)
+        {
+#ifdef FORSYDE_NUMA
+            // on the node of the reader
+            numa_scope scope(placement.node_of_channel(dynamic_cast<sc_interface*>(ch)),
+                             placement.ring_pages());
+#endif
+            ch->set_static_buffer(ch->num_available() + 1);
+        }
+    }
+};
+
+//! A single-threaded cyclic executive for a closed SY region
+/*! This module collects the SY processes below a given module in the
+ * hierarchy (or the ones explicitly added) and takes over their
+ * execution. In each evaluation cycle it fires the sources, the rest of
+ * the processes in a topological order and the delays at the end, all
+ * in its single SC_THREAD (see sy_region). The signals of the region are
+ * switched to plain ring buffers, so that the tokens are passed without
+ * the SystemC kernel and the evaluation order is deterministic.
+ *
+ * All the signals bound to the processes should be inside the region.
+ * A source which stops (e.g., after producing its last token) stops the
+ * whole region, as in the static scheduler of the SDF MoC.
+ */
+class cyclic_executive : public sc_module, private sy_region
+{
+public:
+    //! The constructor requires the module name and the root of the region
+    /*! All the SY processes below the root module in the hierarchy are
+     * executed, unless some processes are added explicitly using add().
+     */
+    cyclic_executive(sc_module_name _name,     ///< The module name
+                     sc_module* root=NULL      ///< The root of the region
+                     ) : sc_module(_name), root(root)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the region
+    void add(sy_process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! The processes in the order of their evaluation in a tick
+    std::vector<sy_process*> schedule() const
+    {
+        std::vector<sy_process*> res(sources);
+        for (auto i : order) res.push_back(combs[i]);
+        res.insert(res.end(), delays.begin(), delays.end());
+        return res;
+    }
+
+    //! The number of evaluation cycles completed so far
+    unsigned long long ticks() const {return tick_cnt;}
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_cyclic_executive";}
+
+private:
+    SC_HAS_PROCESS(cyclic_executive);
+
+    sc_module* root;
+    // The processes in the order of their evaluation
+    std::vector<sy_process*> sched;
+    unsigned long long tick_cnt = 0;
+
+    //! Classifies the processes and orders them
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        if (procs.empty()) return;
+        analyze(name(), "the cyclic executive");
+        sched = schedule();
+        for (auto p : procs) p->set_ext_driven();
+    }
+
+    //! The main and only execution thread of the region
+    void worker()
+    {
+        if (procs.empty()) return;
+        start();
+        while (1)
+        {
+            for (auto p : sched) p->ext_fire();
+            tick_cnt++;
+        }
+    }
+};
+
+//! Helper function to construct a cyclic executive for a region
+template <class... Ps>
+inline cyclic_executive* make_cyclic_executive(const std::string& pName,  ///< the executor name
+    Ps*... procs                                   ///< the processes of the region
+    )
+{
+    auto e = new cyclic_executive(pName.c_str(), NULL);
+    (e->add(procs), ...);
+    return e;
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,150 @@
+/**********************************************************************
+    * sy_fuse.hpp -- Fusion of chained SY combinational processes     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Executing a linear chain of SY combinational processes *
+    *          in a single thread                                     *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_FUSE_HPP
+#define SY_FUSE_HPP
+
+/*! \file sy_fuse.hpp
+ * \brief Implements the fusion of chained combinational processes in the SY MoC
+ *
+ *  This file includes an elaboration-time pass which collapses a linear
+ * chain of SY combinational processes into a single execution thread.
+ */
+
+#include <vector>
+#include <string>
+
+#include "sy_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! Fuses a linear chain of SY combinational processes
+/*! The processes added to a fuse, in the order of the data flow, are
+ * executed by a single SC_THREAD which fires them one after the other in
+ * each evaluation cycle. The threads of the fused processes are disabled
+ * and the signal between each two consecutive processes is switched to a
+ * plain one-token buffer, so that the intermediate values do not pass
+ * through the SystemC kernel.
+ *
+ * The processes and the signals are kept in the module hierarchy, hence
+ * the introspection backends still report the original structure.
+ *
+ * Only the combinational process constructors (comb, comb2, .., combX,
+ * combN and their strict versions) can be fused. The inputs of the chain
+ * which are not driven by the previous process, as well as all of its
+ * outputs, are normal signals.
+ */
+class fuse : public sc_module
+{
+public:
+    //! The constructor requires the module name
+    fuse(sc_module_name _name      ///< The module name
+        ) : sc_module(_name)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Appends a process to the end of the chain
+    void add(sy_process* p)
+    {
+        const std::string kind = p->forsyde_kind();
+        if (kind.compare(0, 8, "SY::comb") != 0 && kind.compare(0, 9, "SY::scomb") != 0)
+            SC_REPORT_ERROR(name(), "only combinational processes can be fused");
+        chain.push_back(p);
+    }
+
+    //! The fused processes in the order of their execution
+    const std::vector<sy_process*>& processes() const
+    {
+        return chain;
+    }
+
+    //! The fuse is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_fuse";}
+
+private:
+    SC_HAS_PROCESS(fuse);
+
+    std::vector<sy_process*> chain;
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        std::vector<sc_object*> children = p->get_child_objects();
+        for (auto it=children.begin(); it!=children.end(); it++)
+            if ((*it)->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(*it);
+                if (port == NULL) continue;
+                auto chans = port->bound_channels();
+                res.insert(res.end(), chans.begin(), chans.end());
+            }
+        return res;
+    }
+
+    //! Checks the chain and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        for (size_t i=1; i<chain.size(); i++)
+        {
+            // find the signal which connects the two consecutive processes
+            auto outs = channels(chain[i-1], "sc_fifo_out");
+            auto ins = channels(chain[i], "sc_fifo_in");
+            static_channel* link = NULL;
+            for (auto o : outs)
+                for (auto in : ins)
+                    if (o == in) link = dynamic_cast<static_channel*>(o);
+            if (link == NULL)
+                SC_REPORT_ERROR(name(), ("process " + std::string(chain[i]->name())
+                    + " is not driven by the previous process in the chain through a ForSyDe signal").c_str());
+            link->set_static_buffer(1);
+        }
+        for (auto p : chain) p->set_ext_driven();
+    }
+
+    //! The main and only execution thread of the fused chain
+    void worker()
+    {
+        for (auto p : chain) p->ext_init();
+        if (chain.empty()) return;
+        while (1)
+            for (auto p : chain) p->ext_fire();
+    }
+};
+
+//! Helper function to fuse a chain of SY combinational processes
+/*! This function is used to construct a fuse module and add the given
+ * processes to it in the order of the data flow, e.g.,
+ * make_fuse("fuse1", mul1, add1).
+ */
+template <class... Ps>
+inline fuse* make_fuse(const std::string& pName,  ///< the fuse name
+    Ps*... procs                                   ///< the chained processes
+    )
+{
+    auto f = new fuse(pName.c_str());
+    (f->add(procs), ...);
+    return f;
+}
+
+}
+}
+
+#endif
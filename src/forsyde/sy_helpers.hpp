@@ -57,6 +57,30 @@ inline comb<T0,T1>* make_comb(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a memo_comb process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline memo_comb<T0,T1>* make_memo_comb(const std::string& pName,
+    const typename memo_comb<T0,T1>::functype& _func,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    size_t capacity=FORSYDE_MEMO_CAPACITY
+    )
+{
+    auto p = new memo_comb<T0,T1>(pName.c_str(), _func, capacity);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a comb2 process
 /*! This function is used to construct a process (SystemC module) and
  * connect its output and output signals.
@@ -144,6 +168,112 @@ inline comb4<T0,T1,T2,T3,T4>* make_comb4(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a comb process with an inlined function
+/*! Similar to make_comb, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class F>
+inline comb<T0,T1,F>* make_comb_inline(const std::string& pName,
+    const F& _func,                             
+    OIf<T0>& outS,
+    I1If<T1>& inp1S
+    )
+{
+    auto p = new comb<T0,T1,F>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb2 process with an inlined function
+/*! Similar to make_comb2, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class F>
+inline comb2<T0,T1,T2,F>* make_comb2_inline(const std::string& pName,
+    const F& _func,                                 
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S
+    )
+{
+    auto p = new comb2<T0,T1,T2,F>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb3 process with an inlined function
+/*! Similar to make_comb3, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class T3, template <class> class I3If,
+          class F>
+inline comb3<T0,T1,T2,T3,F>* make_comb3_inline(const std::string& pName,
+    const F& _func,                                    
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S,
+    I3If<T3>& inp3S
+    )
+{
+    auto p = new comb3<T0,T1,T2,T3,F>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).iport3(inp3S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a comb4 process with an inlined function
+/*! Similar to make_comb4, but the process is specialized on the type of
+ * the passed callable (e.g., a lambda) instead of wrapping it in a
+ * std::function, so that the compiler can inline it in the process.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If,
+          class T2, template <class> class I2If,
+          class T3, template <class> class I3If,
+          class T4, template <class> class I4If,
+          class F>
+inline comb4<T0,T1,T2,T3,T4,F>* make_comb4_inline(const std::string& pName,
+    const F& _func,                                       
+    OIf<T0>& outS,
+    I1If<T1>& inp1S,
+    I2If<T2>& inp2S,
+    I3If<T3>& inp3S,
+    I4If<T4>& inp4S
+    )
+{
+    auto p = new comb4<T0,T1,T2,T3,T4,F>(pName.c_str(), _func);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).iport3(inp3S);
+    (*p).iport4(inp4S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a combX process
 /*! This function is used to construct a process (SystemC module) and
  * connect its input and output signals.
@@ -169,6 +299,55 @@ inline combX<T0,T1,N>* make_combX(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a combX process reading a vector signal
+/*! This function is used to construct a combXV process (SystemC module)
+ * and connect its input and output signals. Unlike the combX with an
+ * array of input signals, it registers only one input port.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t N>
+inline combXV<T0,T1,N>* make_combX(const std::string& pName,
+    const typename combXV<T0,T1,N>::functype& _func,
+    OIf<T0>& outS,
+    IIf<std::array<abst_ext<T1>,N>>& inpS
+    )
+{
+    auto p = new combXV<T0,T1,N>(pName.c_str(), _func);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a mapX process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t N>
+inline mapX<T0,T1,N>* make_mapX(const std::string& pName,
+    const typename mapX<T0,T1,N>::functype& _func,
+    OIf<std::array<abst_ext<T0>,N>>& outS,
+    IIf<std::array<abst_ext<T1>,N>>& inpS
+    )
+{
+    auto p = new mapX<T0,T1,N>(pName.c_str(), _func);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
 // //! Helper function to construct a combN process
 // /*! This function is used to construct a process (SystemC module) and
 //  * connect its input and output signals.
@@ -239,6 +418,28 @@ inline delayn<T>* make_delayn(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a delayline process
+/*! This function is used to construct a delayline process (SystemC
+ * module) and connect its input signal.
+ * The user binds the outputs manually.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <typename T, template <class> class IIf, std::size_t N>
+inline delayline<T,N>* make_delayline(const std::string& pName,
+    const abst_ext<T>& initval,
+    const std::array<unsigned int,N>& taps,
+    IIf<T>& inpS
+    )
+{
+    auto p = new delayline<T,N>(pName.c_str(), initval, taps);
+    
+    (*p).iport1(inpS);
+    
+    return p;
+}
+
 //! Helper function to construct a moore process
 /*! This function is used to construct a moore process (SystemC module) and
  * connect its output and output signals.
@@ -360,6 +561,48 @@ inline group<T>* make_group(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct an upsample domain interface
+/*! This function is used to construct an upsample process (SystemC
+ * module) and connect its input and output signals.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline upsample<T>* make_upsample(const std::string& pName,
+    unsigned int factor,
+    OIf<T>& outS,
+    IIf<T>& inpS,
+    bool hold=false
+    )
+{
+    auto p = new upsample<T>(pName.c_str(), factor, hold);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a downsample domain interface
+/*! This function is used to construct a downsample process (SystemC
+ * module) and connect its input and output signals.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline downsample<T>* make_downsample(const std::string& pName,
+    unsigned int factor,
+    OIf<T>& outS,
+    IIf<T>& inpS,
+    unsigned int phase=0
+    )
+{
+    auto p = new downsample<T>(pName.c_str(), factor, phase);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a constant source process
 /*! This function is used to construct a constant (SystemC module) and
  * connect its output signal.
@@ -424,6 +667,26 @@ inline file_source<T>* make_file_source(std::string pName,
     return p;
 }
 
+//! Helper function to construct a binary_file_source process
+/*! This function is used to construct a binary_file_source (SystemC module) and
+ * connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <class T, template <class> class OIf>
+inline binary_file_source<T>* make_binary_file_source(const std::string& pName,
+    const std::string& file_name,
+    OIf<T>& outS
+    )
+{
+    auto p = new binary_file_source<T>(pName.c_str(), file_name);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a vector source process
 /*! This function is used to construct a vector source (SystemC module) and
  * connect its output signal.
@@ -444,6 +707,25 @@ inline vsource<T>* make_vsource(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a stream source process
+/*! This function is used to construct a source (SystemC module) which
+ * reads a token_stream and connect its output signal. It is used as
+ * make_vsource, with a stream (e.g., from make_generator_stream or
+ * make_file_stream) instead of a vector.
+ */
+template <class T, template <class> class OIf>
+inline stream_source<T>* make_vsource(const std::string& pName,
+    std::shared_ptr<token_stream<T>> stream,
+    OIf<T>& outS
+    )
+{
+    auto p = new stream_source<T>(pName.c_str(), stream);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a sink process
 /*! This function is used to construct a sink (SystemC module) and
  * connect its output and output signals.
@@ -485,6 +767,26 @@ inline file_sink<T>* make_file_sink(std::string pName,
     return p;
 }
 
+//! Helper function to construct a binary_file_sink process
+/*! This function is used to construct a binary_file_sink (SystemC module) and
+ * connect its input signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <class T, template <class> class IIf>
+inline binary_file_sink<T>* make_binary_file_sink(const std::string& pName,
+    const std::string& file_name,
+    IIf<T>& inS
+    )
+{
+    auto p = new binary_file_sink<T>(pName.c_str(), file_name);
+    
+    (*p).iport1(inS);
+    
+    return p;
+}
+
 //! Helper function to construct a zip process
 /*! This function is used to construct a zip process (SystemC module) and
  * connect its output and output signals.
@@ -531,6 +833,23 @@ inline zipX<T1,N>* make_zipX(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a zipX process with an abst_array output
+/*! Similar to the make_zipX above, but the output signal carries the
+ * arrays as abst_array<T1,N>.
+ */
+template <class T1, std::size_t N,
+           template <class> class OIf>
+inline zipX<T1,N,abst_array<T1,N>>* make_zipX(const std::string& pName,
+    OIf<abst_array<T1,N>>& outS
+    )
+{
+    auto p = new zipX<T1,N,abst_array<T1,N>>(pName.c_str());
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct an unzip process
 /*! This function is used to construct an unzip process (SystemC module) and
  * connect its output and output signals.
@@ -577,6 +896,23 @@ inline unzipX<T1,N>* make_unzipX(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct an unzipX process with an abst_array input
+/*! Similar to the make_unzipX above, but the input signal carries the
+ * arrays as abst_array<T1,N>.
+ */
+template <template <class> class IIf,
+           class T1, std::size_t N>
+inline unzipX<T1,N,abst_array<T1,N>>* make_unzipX(const std::string& pName,
+    IIf<abst_array<T1,N>>& inpS
+    )
+{
+    auto p = new unzipX<T1,N,abst_array<T1,N>>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    
+    return p;
+}
+
 //! Helper function to construct a fanout process
 /*! This function is used to construct a fanout process (SystemC module) and
  * connect its output and output signals.
@@ -240,10 +240,11 @@ template <class T0, template <class> class OIf,
 inline sdpmap<T0,T1,N>* make_sdpmap(const std::string& pName,
     const typename sdpmap<T0,T1,N>::functype& _func,
     OIf<std::array<T0,N>>& outS,
-    IIf<std::array<T1,N>>& inpS
+    IIf<std::array<T1,N>>& inpS,
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
     )
 {
-    auto p = new sdpmap<T0,T1,N>(pName.c_str(), _func);
+    auto p = new sdpmap<T0,T1,N>(pName.c_str(), _func, parallel_threshold);
 
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -264,10 +265,11 @@ template <class T0, template <class> class OIf,
 inline sdpreduce<T0,N>* make_sdpreduce(const std::string& pName,
     const typename sdpreduce<T0,N>::functype& _func,
     OIf<T0>& outS,
-    IIf<std::array<T0,N>>& inpS
+    IIf<std::array<T0,N>>& inpS,
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
     )
 {
-    auto p = new sdpreduce<T0,N>(pName.c_str(), _func);
+    auto p = new sdpreduce<T0,N>(pName.c_str(), _func, parallel_threshold);
 
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -289,10 +291,153 @@ inline sdpscan<T0,T1,N>* make_sdpscan(const std::string& pName,
     const typename sdpscan<T0,T1,N>::functype& _func,
     const T0& init_res,
     OIf<std::array<T0,N>>& outS,
-    IIf<std::array<T1,N>>& inpS
+    IIf<std::array<T1,N>>& inpS,
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD,
+    bool associative=false
+    )
+{
+    auto p = new sdpscan<T0,T1,N>(pName.c_str(), _func, init_res,
+                                  parallel_threshold, associative);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a strict vectorized map process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t N>
+inline vmap<T0,T1,N>* make_vmap(const std::string& pName,
+    const typename vmap<T0,T1,N>::functype& _func,
+    OIf<std::array<T0,N>>& outS,
+    IIf<std::array<T1,N>>& inpS,
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
+    )
+{
+    auto p = new vmap<T0,T1,N>(pName.c_str(), _func, parallel_threshold);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a strict vectorized reduce process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          template <class> class IIf,
+          std::size_t N>
+inline vreduce<T0,N>* make_vreduce(const std::string& pName,
+    const typename vreduce<T0,N>::functype& _func,
+    OIf<T0>& outS,
+    IIf<std::array<T0,N>>& inpS,
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
     )
 {
-    auto p = new sdpscan<T0,T1,N>(pName.c_str(), _func, init_res);
+    auto p = new vreduce<T0,N>(pName.c_str(), _func, parallel_threshold);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a strict data parallel stencil process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals. The radius R is given
+ * explicitly, e.g., make_sdpstencil<1>("blur", f, outS, inpS).
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t R,
+          class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t N>
+inline sdpstencil<T0,T1,N,R>* make_sdpstencil(const std::string& pName,
+    const typename sdpstencil<T0,T1,N,R>::functype& _func,
+    OIf<std::array<T0,N>>& outS,
+    IIf<std::array<T1,N>>& inpS,
+    stencil_boundary boundary=STENCIL_CLAMP,
+    const T1& fill=T1(),
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
+    )
+{
+    auto p = new sdpstencil<T0,T1,N,R>(pName.c_str(), _func, boundary, fill,
+                                       parallel_threshold);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a strict vectorized stencil process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals. The radius R is given
+ * explicitly.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t R,
+          class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t N>
+inline vstencil<T0,T1,N,R>* make_vstencil(const std::string& pName,
+    const typename vstencil<T0,T1,N,R>::functype& _func,
+    OIf<std::array<T0,N>>& outS,
+    IIf<std::array<T1,N>>& inpS,
+    stencil_boundary boundary=STENCIL_CLAMP,
+    const T1& fill=T1(),
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
+    )
+{
+    auto p = new vstencil<T0,T1,N,R>(pName.c_str(), _func, boundary, fill,
+                                     parallel_threshold);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a strict data parallel 2D stencil process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals. The radius R is given
+ * explicitly.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t R,
+          class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t ROWS, std::size_t COLS>
+inline sdpstencil2d<T0,T1,ROWS,COLS,R>* make_sdpstencil2d(const std::string& pName,
+    const typename sdpstencil2d<T0,T1,ROWS,COLS,R>::functype& _func,
+    OIf<std::array<std::array<T0,COLS>,ROWS>>& outS,
+    IIf<std::array<std::array<T1,COLS>,ROWS>>& inpS,
+    stencil_boundary boundary=STENCIL_CLAMP,
+    const T1& fill=T1(),
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
+    )
+{
+    auto p = new sdpstencil2d<T0,T1,ROWS,COLS,R>(pName.c_str(), _func, boundary, fill,
+                                                 parallel_threshold);
 
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -399,6 +544,36 @@ inline smealy<IT,ST,OT>* make_smealy(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a strict data parallel mealy process
+/*! This function is used to construct a mealy process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf,
+           std::size_t N>
+inline sdpmealy<IT,ST,OT,N>* make_sdpmealy(const std::string& pName,
+    const typename sdpmealy<IT,ST,OT,N>::ns_functype& _ns_func,
+    const typename sdpmealy<IT,ST,OT,N>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<std::array<OT,N>>& outS,
+    IIf<std::array<IT,N>>& inpS,
+    const std::vector<ST>& states=std::vector<ST>(),
+    size_t parallel_threshold=FORSYDE_DP_THRESHOLD
+    )
+{
+    auto p = new sdpmealy<IT,ST,OT,N>(pName.c_str(), _ns_func, _od_func, init_st,
+                                      states, parallel_threshold);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
 //! Helper function to construct a strict group process
 /*! This function is used to construct a process (SystemC module) and
  * connect its output and output signals.
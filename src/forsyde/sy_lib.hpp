@@ -21,6 +21,11 @@
  */
 
 #include "sy_moc.hpp"
+#include "fir_kernel.hpp"
+#include "matrix_kernel.hpp"
+#include "bit_lanes.hpp"
+#include "random.hpp"
+#include "ensemble.hpp"
 
 namespace ForSyDe
 {
@@ -28,6 +33,135 @@ namespace ForSyDe
 namespace SY
 {
 
+//! Abstract process constructor for a random source
+/*! This class is used to build synchronous signal sources which produce
+ * independent samples of a distribution. The samples are generated in
+ * blocks of FORSYDE_RNG_BLOCK by a counter-based generator whose stream
+ * is derived from the process name, hence each source has its own
+ * reproducible stream for a given seed.
+ */
+template <class Dist>
+class random_source : public sy_process
+{
+public:
+    //! The type of the samples
+    typedef typename Dist::value_type value_type;
+    
+    SY_out<value_type> oport1;      ///< port for the output channel
+    
+    //! The constructor requires the module name, the distribution and the seed
+    random_source(const sc_module_name& _name,  ///< process name
+                  const Dist& dist,             ///< the distribution
+                  std::uint64_t seed            ///< the seed of the random stream
+                 ) : sy_process(_name), oport1("oport1"), dist(dist),
+                     rng(seed, counter_rng::stream_of(name())) {}
+    
+    //! The generator of the random stream, e.g., to reseed it or jump ahead
+    counter_rng& generator() {return rng;}
+    
+private:
+    Dist dist;
+    counter_rng rng;
+    
+    // the current block of samples and the next one to be produced
+    std::vector<value_type> blk;
+    size_t idx;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        blk.resize(FORSYDE_RNG_BLOCK);
+        idx = blk.size();
+    }
+    
+    void prep() {}
+    
+    void exec()
+    {
+        if (idx < blk.size()) return;
+        dist.fill(rng, blk.data(), blk.size());
+        idx = 0;
+    }
+    
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<value_type>(blk[idx++]));
+    }
+    
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, blk, idx, rng.position());
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t n;
+        restore_values(pos, blk, idx, n);
+        rng.discard(n - rng.position());
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a uniform random wave generator
+/*! This class is used to create a synchronous signal source which
+ * produces a random signal uniformly distributed in [lo,hi).
+ */
+class uniform : public random_source<uniform_dist>
+{
+public:
+    uniform(const sc_module_name& name_,    ///< The Process name
+            const double& lo,               ///< The lower bound
+            const double& hi,               ///< The upper bound (excluded)
+            std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+           ) : random_source(name_, uniform_dist{lo, hi}, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lo", lo);
+        add_arg("hi", hi);
+        add_arg("seed", seed);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::uniform";}
+};
+
+#ifdef FORSYDE_COUNTER_RNG
+//! Process constructor for a Gaussian randome wave generator
+/*! This class is used to create a synchronous signal source which 
+ * produces a random signal based on the Gaussian distribution. With
+ * FORSYDE_COUNTER_RNG, the samples are generated in blocks by the
+ * counter-based generator of random_source instead of the LFSR.
+ */
+class gaussian : public random_source<normal_dist>
+{
+public:
+    gaussian(const sc_module_name& name_,   ///< The Process name
+             const double& gaussVar,        ///< The variance
+             const double& gaussMean,       ///< The mean value
+             std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+            ) : random_source(name_, normal_dist{gaussMean, std::sqrt(gaussVar)}, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("gaussVar", gaussVar);
+        add_arg("gaussMean", gaussMean);
+        add_arg("seed", seed);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::gaussian";}
+};
+#else
 //! Process constructor for a Gaussian randome wave generator
 /*! This class is used to create a synchronous signal source which 
  * produces a random signal based on the Gaussian distribution
@@ -83,6 +217,29 @@ private:
     return((int)floor(val)); 
   }
 };
+#endif
+
+//! Process constructor for a Poisson random generator
+/*! This class is used to create a synchronous signal source which
+ * produces random counts based on the Poisson distribution.
+ */
+class poisson : public random_source<poisson_dist>
+{
+public:
+    poisson(const sc_module_name& name_,    ///< The Process name
+            const double& lambda,           ///< The mean value
+            std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed
+           ) : random_source(name_, poisson_dist{lambda}, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lambda", lambda);
+        add_arg("seed", seed);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::poisson";}
+};
 
 //! Helper function to construct a Gaussian randome wave generator
 /*! This function is used to construct a Gaussian (SystemC module) and
@@ -105,6 +262,1055 @@ inline gaussian* make_gaussian(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a uniform random wave generator
+/*! This function is used to construct a uniform source (SystemC module)
+ * and connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <template <class> class OIf>
+inline uniform* make_uniform(const std::string& pName,
+    const double& lo,           ///< The lower bound
+    const double& hi,           ///< The upper bound (excluded)
+    OIf<double>& outS
+    )
+{
+    auto p = new uniform(pName.c_str(), lo, hi);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a Poisson random generator
+/*! This function is used to construct a Poisson source (SystemC module)
+ * and connect its output signal.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <template <class> class OIf>
+inline poisson* make_poisson(const std::string& pName,
+    const double& lambda,       ///< The mean value
+    OIf<unsigned long>& outS
+    )
+{
+    auto p = new poisson(pName.c_str(), lambda);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Abstract process constructor for the random source of an ensemble
+/*! This class is used to build synchronous signal sources which produce
+ * independent samples of a distribution in each of the K lanes of an
+ * ensemble (see lanes). Lane k uses the stream of a random_source with
+ * the same name and the seed plus k, so that the lanes of an ensemble
+ * reproduce the single-instance runs of a seed sweep.
+ */
+template <class Dist, std::size_t K>
+class ensemble_source : public sy_process
+{
+public:
+    //! The type of the samples
+    typedef lanes<typename Dist::value_type,K> value_type;
+    
+    SY_out<value_type> oport1;      ///< port for the output channel
+    
+    //! The constructor requires the module name, the distribution and the seed
+    ensemble_source(const sc_module_name& _name,    ///< process name
+                    const Dist& dist,               ///< the distribution
+                    std::uint64_t seed              ///< the seed of the first lane
+                   ) : sy_process(_name), oport1("oport1"), dist(dist)
+    {
+        for (std::size_t k=0; k<K; k++)
+            rngs[k].set_seed(seed+k, counter_rng::stream_of(name()));
+    }
+    
+    //! The generator of the random stream of a lane
+    counter_rng& generator(std::size_t k) {return rngs[k];}
+    
+private:
+    Dist dist;
+    std::array<counter_rng,K> rngs;
+    
+    // the current blocks of samples of the lanes and the next one to be produced
+    std::vector<typename Dist::value_type> blk[K];
+    size_t idx;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        for (std::size_t k=0; k<K; k++) blk[k].resize(FORSYDE_RNG_BLOCK);
+        idx = FORSYDE_RNG_BLOCK;
+    }
+    
+    void prep() {}
+    
+    void exec()
+    {
+        if (idx < FORSYDE_RNG_BLOCK) return;
+        for (std::size_t k=0; k<K; k++)
+            dist.fill(rngs[k], blk[k].data(), FORSYDE_RNG_BLOCK);
+        idx = 0;
+    }
+    
+    void prod()
+    {
+        value_type val;
+        for (std::size_t k=0; k<K; k++) val.v[k] = blk[k][idx];
+        idx++;
+        write_multiport(oport1, abst_ext<value_type>(val));
+    }
+    
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        for (std::size_t k=0; k<K; k++) save_values(buf, blk[k], rngs[k].position());
+        save_values(buf, idx);
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        for (std::size_t k=0; k<K; k++)
+        {
+            std::uint64_t n;
+            restore_values(pos, blk[k], n);
+            rngs[k].discard(n - rngs[k].position());
+        }
+        restore_values(pos, idx);
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for the Gaussian random source of an ensemble
+/*! This class is used to create a synchronous signal source which
+ * produces K independent random signals based on the Gaussian
+ * distribution, one in each lane of its tokens.
+ */
+template <std::size_t K>
+class ensemble_gaussian : public ensemble_source<normal_dist,K>
+{
+public:
+    ensemble_gaussian(const sc_module_name& name_,  ///< The Process name
+                      const double& gaussVar,       ///< The variance
+                      const double& gaussMean,      ///< The mean value
+                      std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed of the first lane
+                     ) : ensemble_source<normal_dist,K>(name_,
+                             normal_dist{gaussMean, std::sqrt(gaussVar)}, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        this->add_arg("gaussVar", gaussVar);
+        this->add_arg("gaussMean", gaussMean);
+        this->add_arg("seed", seed);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::ensemble_gaussian";}
+};
+
+//! Process constructor for the uniform random source of an ensemble
+/*! This class is used to create a synchronous signal source which
+ * produces K independent random signals uniformly distributed in
+ * [lo,hi), one in each lane of its tokens.
+ */
+template <std::size_t K>
+class ensemble_uniform : public ensemble_source<uniform_dist,K>
+{
+public:
+    ensemble_uniform(const sc_module_name& name_,   ///< The Process name
+                     const double& lo,              ///< The lower bound
+                     const double& hi,              ///< The upper bound (excluded)
+                     std::uint64_t seed=FORSYDE_RNG_SEED ///< The seed of the first lane
+                    ) : ensemble_source<uniform_dist,K>(name_, uniform_dist{lo, hi}, seed)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        this->add_arg("lo", lo);
+        this->add_arg("hi", hi);
+        this->add_arg("seed", seed);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::ensemble_uniform";}
+};
+
+//! Helper function to construct the Gaussian random source of an ensemble
+/*! This function is used to construct an ensemble Gaussian source
+ * (SystemC module) and connect its output signal. The number of lanes is
+ * inferred from the type of the signal.
+ */
+template <std::size_t K, template <class> class OIf>
+inline ensemble_gaussian<K>* make_ensemble_gaussian(const std::string& pName,
+    const double& gaussVar,    ///< The variance
+    const double& gaussMean,   ///< The mean value
+    std::uint64_t seed,        ///< The seed of the first lane
+    OIf<lanes<double,K>>& outS
+    )
+{
+    auto p = new ensemble_gaussian<K>(pName.c_str(), gaussVar, gaussMean, seed);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct the uniform random source of an ensemble
+/*! This function is used to construct an ensemble uniform source
+ * (SystemC module) and connect its output signal. The number of lanes is
+ * inferred from the type of the signal.
+ */
+template <std::size_t K, template <class> class OIf>
+inline ensemble_uniform<K>* make_ensemble_uniform(const std::string& pName,
+    const double& lo,           ///< The lower bound
+    const double& hi,           ///< The upper bound (excluded)
+    std::uint64_t seed,         ///< The seed of the first lane
+    OIf<lanes<double,K>>& outS
+    )
+{
+    auto p = new ensemble_uniform<K>(pName.c_str(), lo, hi, seed);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Process constructor for an FIR filter
+/*! This class is used to build a finite impulse response filter in a
+ * single process, instead of a chain of delays, multipliers and adders.
+ * Given the coefficients c, the output in each cycle is the sum of
+ * c[k] times the input of k cycles ago, where the inputs before the
+ * first cycle are zero. The inner product is computed by a vectorizable
+ * kernel over a contiguous history of the inputs.
+ *
+ * An absent input produces an absent output and does not advance the
+ * history, i.e., the filter only samples the present values.
+ */
+template <class T>
+class fir : public sy_process
+{
+public:
+    SY_in<T>  iport1;       ///< port for the input channel
+    SY_out<T> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name and the coefficients
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * filters it and writes the results using the output port
+     */
+    fir(const sc_module_name& _name,        ///< process name
+        const std::vector<T>& coefs         ///< the filter coefficients
+       ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+           state(coefs, 1)
+    {
+        if (coefs.empty())
+            SC_REPORT_ERROR(name(), "an FIR filter requires at least one coefficient");
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("taps", coefs.size());
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::fir";}
+    
+private:
+    fir_state<T> state;
+    
+    // Inputs and output variables
+    abst_ext<T> ival;
+    T oval;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        state.reset();
+    }
+    
+    void prep()
+    {
+        ival = iport1.read();
+    }
+    
+    void exec()
+    {
+        if (is_absent(ival)) return;
+        *state.inputs() = unsafe_from_abst_ext(ival);
+        state.filter(&oval);
+    }
+    
+    void prod()
+    {
+        if (is_absent(ival))
+            write_multiport(oport1, abst_ext<T>());
+        else
+            write_multiport(oport1, abst_ext<T>(oval));
+    }
+    
+    void clean()
+    {
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, state.history());}
+    
+    void restore_state(const char*& pos)
+    {
+        std::vector<T> h;
+        restore_values(pos, h);
+        state.set_history(h);
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct an FIR filter
+/*! This function is used to construct an FIR filter (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename T, template <class> class IIf,
+                        template <class> class OIf>
+inline fir<T>* make_fir(const std::string& pName,
+    const std::vector<T>& coefs,
+    OIf<T>& outS,
+    IIf<T>& inpS
+    )
+{
+    auto p = new fir<T>(pName.c_str(), coefs);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Process constructor for a matrix-vector product
+/*! This class is used to build a process which multiplies a constant
+ * matrix A by the input vector x and adds a constant bias b in each
+ * cycle, i.e., y = A x + b. The matrix type M is either a dense_matrix,
+ * whose products with the std::vector inputs are computed by the gemv
+ * kernel (and by BLAS for large sizes), or a fixed_matrix, whose
+ * products with the std::array inputs have compile-time bounds.
+ *
+ * An absent input produces an absent output.
+ */
+template <class M>
+class gemv : public sy_process
+{
+public:
+    typedef typename M::value_type value_type;
+    typedef typename matrix_vectors<M>::in_type in_type;
+    typedef typename matrix_vectors<M>::out_type out_type;
+
+    SY_in<in_type>  iport1;     ///< port for the input channel
+    SY_out<out_type> oport1;    ///< port for the output channel
+
+    //! The constructor requires the module name, the matrix and the bias
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * multiplies it by the matrix and writes the results using the
+     * output port
+     */
+    gemv(const sc_module_name& _name,       ///< process name
+         const M& A,                        ///< the matrix
+         const out_type& b=out_type()       ///< the bias, none if empty
+        ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+            A(A), b(b)
+    {
+        if (!this->b.empty() && this->b.size() != A.rows())
+            SC_REPORT_ERROR(name(), "the bias should have one value per row of the matrix");
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("rows", A.rows());
+        add_arg("cols", A.cols());
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::gemv";}
+
+private:
+    M A;
+    out_type b;
+
+    // Inputs and output variables
+    abst_ext<in_type> ival;
+    out_type oval;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        ival = iport1.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(ival)) return;
+        if (!matvec(oval, A, unsafe_from_abst_ext(ival)))
+            SC_REPORT_ERROR(name(), "the input size does not match the matrix");
+        if (!b.empty())
+            for (size_t i=0; i<oval.size(); i++) oval[i] += b[i];
+    }
+
+    void prod()
+    {
+        if (is_absent(ival))
+            write_multiport(oport1, abst_ext<out_type>());
+        else
+            write_multiport(oport1, abst_ext<out_type>(oval));
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a matrix-vector product process
+/*! This function is used to construct a gemv process (SystemC module)
+ * and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <typename M, template <class> class IIf,
+                        template <class> class OIf>
+inline gemv<M>* make_gemv(const std::string& pName,
+    const M& A,
+    const typename gemv<M>::out_type& b,
+    OIf<typename gemv<M>::out_type>& outS,
+    IIf<typename gemv<M>::in_type>& inpS
+    )
+{
+    auto p = new gemv<M>(pName.c_str(), A, b);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Process constructor for a bit-parallel logic gate
+/*! This class is used to build a process which applies a two-input
+ * logic operation (see bit_op) to all the lanes of its bit-packed
+ * inputs in each cycle, 64 lanes per word operation. A lane of the
+ * output is present if it is present in both inputs, and an absent
+ * input produces an absent output.
+ */
+template <std::size_t N=64>
+class bit_gate : public sy_process
+{
+public:
+    SY_in<bit_lanes<N>>  iport1;        ///< port for the input channel 1
+    SY_in<bit_lanes<N>>  iport2;        ///< port for the input channel 2
+    SY_out<bit_lanes<N>> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name and the operation
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the operation and writes the results using the output port
+     */
+    bit_gate(const sc_module_name& _name,   ///< process name
+             bit_op op                      ///< the logic operation
+            ) : sy_process(_name), iport1("iport1"), iport2("iport2"),
+                oport1("oport1"), op(op)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("op", static_cast<int>(op));
+        add_arg("lanes", N);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::bit_gate";}
+
+private:
+    bit_op op;
+
+    // Inputs and output variables
+    abst_ext<bit_lanes<N>> ival1, ival2;
+    abst_ext<bit_lanes<N>> oval;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        ival1 = iport1.read();
+        ival2 = iport2.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(ival1) || is_absent(ival2))
+            oval = abst_ext<bit_lanes<N>>();
+        else
+            oval = bit_apply(op, unsafe_from_abst_ext(ival1),
+                             unsafe_from_abst_ext(ival2));
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, oval);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a bit-parallel inverter
+/*! This class is used to build a process which negates all the present
+ * lanes of its bit-packed input in each cycle.
+ */
+template <std::size_t N=64>
+class bit_inv : public sy_process
+{
+public:
+    SY_in<bit_lanes<N>>  iport1;        ///< port for the input channel
+    SY_out<bit_lanes<N>> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * negates it and writes the results using the output port
+     */
+    bit_inv(const sc_module_name& _name     ///< process name
+           ) : sy_process(_name), iport1("iport1"), oport1("oport1")
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lanes", N);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::bit_inv";}
+
+private:
+    // Inputs and output variables
+    abst_ext<bit_lanes<N>> ival, oval;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        ival = iport1.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(ival))
+            oval = abst_ext<bit_lanes<N>>();
+        else
+            oval = ~unsafe_from_abst_ext(ival);
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, oval);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a bit-parallel multiplexer
+/*! This class is used to build a process which selects, in each lane,
+ * the W-bit number of its first data input where the select input is
+ * true and of its second one where it is false. A lane of the output is
+ * present if the select lane and the selected number are present, and
+ * an absent input produces an absent output.
+ */
+template <std::size_t N=64, std::size_t W=1>
+class bit_select : public sy_process
+{
+public:
+    SY_in<bit_lanes<N>>     iport1;     ///< port for the select channel
+    SY_in<bit_planes<N,W>>  iport2;     ///< port for the data selected by true
+    SY_in<bit_planes<N,W>>  iport3;     ///< port for the data selected by false
+    SY_out<bit_planes<N,W>> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * multiplexes them and writes the results using the output port
+     */
+    bit_select(const sc_module_name& _name  ///< process name
+              ) : sy_process(_name), iport1("iport1"), iport2("iport2"),
+                  iport3("iport3"), oport1("oport1")
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lanes", N);
+        add_arg("width", W);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::bit_select";}
+
+private:
+    // Inputs and output variables
+    abst_ext<bit_lanes<N>> sel;
+    abst_ext<bit_planes<N,W>> ival1, ival2, oval;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        sel = iport1.read();
+        ival1 = iport2.read();
+        ival2 = iport3.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(sel) || is_absent(ival1) || is_absent(ival2))
+            oval = abst_ext<bit_planes<N,W>>();
+        else
+            oval = ForSyDe::bit_mux(unsafe_from_abst_ext(sel),
+                                    unsafe_from_abst_ext(ival1),
+                                    unsafe_from_abst_ext(ival2));
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, oval);
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(3);     // three input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundInChans[2].port = &iport3;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a bit-parallel comparator
+/*! This class is used to build a process which compares the W-bit
+ * unsigned numbers of its two inputs in all the lanes in each cycle.
+ * The lanes of its first output are true where the first input is
+ * greater than the second one, and the lanes of its second output where
+ * they are equal. An absent input produces absent outputs.
+ */
+template <std::size_t N=64, std::size_t W=1>
+class bit_comparator : public sy_process
+{
+public:
+    SY_in<bit_planes<N,W>> iport1;      ///< port for the input channel 1
+    SY_in<bit_planes<N,W>> iport2;      ///< port for the input channel 2
+    SY_out<bit_lanes<N>>   oport1;      ///< port for the greater-than channel
+    SY_out<bit_lanes<N>>   oport2;      ///< port for the equality channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * compares them and writes the results using the output ports
+     */
+    bit_comparator(const sc_module_name& _name  ///< process name
+                  ) : sy_process(_name), iport1("iport1"), iport2("iport2"),
+                      oport1("oport1"), oport2("oport2")
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lanes", N);
+        add_arg("width", W);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::bit_comparator";}
+
+private:
+    // Inputs and output variables
+    abst_ext<bit_planes<N,W>> ival1, ival2;
+    bit_lanes<N> gt, eq;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        ival1 = iport1.read();
+        ival2 = iport2.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(ival1) || is_absent(ival2)) return;
+        bit_compare(unsafe_from_abst_ext(ival1), unsafe_from_abst_ext(ival2), gt, eq);
+    }
+
+    void prod()
+    {
+        if (is_absent(ival1) || is_absent(ival2))
+        {
+            write_multiport(oport1, abst_ext<bit_lanes<N>>());
+            write_multiport(oport2, abst_ext<bit_lanes<N>>());
+        }
+        else
+        {
+            write_multiport(oport1, abst_ext<bit_lanes<N>>(gt));
+            write_multiport(oport2, abst_ext<bit_lanes<N>>(eq));
+        }
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(2);     // two input ports
+        boundInChans[0].port = &iport1;
+        boundInChans[1].port = &iport2;
+        boundOutChans.resize(2);    // two output ports
+        boundOutChans[0].port = &oport1;
+        boundOutChans[1].port = &oport2;
+    }
+#endif
+};
+
+//! Process constructor for packing boolean signals into lanes
+/*! This class is used to build a process which packs its N boolean
+ * input signals into the lanes of a bit-packed signal, where the absent
+ * inputs are absent lanes. The output is absent if all the inputs are.
+ */
+template <std::size_t N=64>
+class bit_pack : public sy_process
+{
+public:
+    std::array<SY_in<bool>,N> iport;    ///< port array for the input channels
+    SY_out<bit_lanes<N>> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * packs them and writes the result using the output port
+     */
+    bit_pack(const sc_module_name& _name    ///< process name
+            ) : sy_process(_name), oport1("oport1")
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lanes", N);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::bit_pack";}
+
+private:
+    // Inputs and output variables
+    bit_lanes<N> oval;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        for (size_t i=0; i<N; i++) oval.set(i, iport[i].read());
+    }
+
+    void exec()
+    {
+    }
+
+    void prod()
+    {
+        if (oval.all_absent())
+            write_multiport(oport1, abst_ext<bit_lanes<N>>());
+        else
+            write_multiport(oport1, abst_ext<bit_lanes<N>>(oval));
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(N);     // N input ports
+        for (size_t i=0;i<N;i++)
+            boundInChans[i].port = &iport[i];
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for unpacking lanes into boolean signals
+/*! This class is used to build a process which writes each lane of its
+ * bit-packed input to a separate boolean signal, where the absent lanes
+ * (or an absent input) are absent outputs.
+ */
+template <std::size_t N=64>
+class bit_unpack : public sy_process
+{
+public:
+    SY_in<bit_lanes<N>> iport1;         ///< port for the input channel
+    std::array<SY_out<bool>,N> oport;   ///< port array for the output channels
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * unpacks it and writes the results using the output ports
+     */
+    bit_unpack(const sc_module_name& _name  ///< process name
+              ) : sy_process(_name), iport1("iport1")
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("lanes", N);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::bit_unpack";}
+
+private:
+    // Inputs and output variables
+    abst_ext<bit_lanes<N>> ival;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        ival = iport1.read();
+    }
+
+    void exec()
+    {
+    }
+
+    void prod()
+    {
+        const bit_lanes<N> lanes = ival.from_abst_ext(bit_lanes<N>());
+        for (size_t i=0; i<N; i++)
+            write_multiport(oport[i], lanes.get(i));
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(N);    // N output ports
+        for (size_t i=0;i<N;i++)
+            boundOutChans[i].port = &oport[i];
+    }
+#endif
+};
+
+//! Helper function to construct a bit-parallel logic gate
+/*! This function is used to construct a bit_gate process (SystemC
+ * module) and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N, template <class> class I1If,
+                        template <class> class I2If,
+                        template <class> class OIf>
+inline bit_gate<N>* make_bit_gate(const std::string& pName,
+    bit_op op,
+    OIf<bit_lanes<N>>& outS,
+    I1If<bit_lanes<N>>& inp1S,
+    I2If<bit_lanes<N>>& inp2S
+    )
+{
+    auto p = new bit_gate<N>(pName.c_str(), op);
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a bit-parallel inverter
+/*! This function is used to construct a bit_inv process (SystemC
+ * module) and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N, template <class> class IIf,
+                        template <class> class OIf>
+inline bit_inv<N>* make_bit_inv(const std::string& pName,
+    OIf<bit_lanes<N>>& outS,
+    IIf<bit_lanes<N>>& inpS
+    )
+{
+    auto p = new bit_inv<N>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a bit-parallel multiplexer
+/*! This function is used to construct a bit_select process (SystemC
+ * module) and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N, std::size_t W, template <class> class I1If,
+                        template <class> class I2If,
+                        template <class> class I3If,
+                        template <class> class OIf>
+inline bit_select<N,W>* make_bit_select(const std::string& pName,
+    OIf<bit_planes<N,W>>& outS,
+    I1If<bit_lanes<N>>& selS,
+    I2If<bit_planes<N,W>>& inp1S,
+    I3If<bit_planes<N,W>>& inp2S
+    )
+{
+    auto p = new bit_select<N,W>(pName.c_str());
+    
+    (*p).iport1(selS);
+    (*p).iport2(inp1S);
+    (*p).iport3(inp2S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a bit-parallel comparator
+/*! This function is used to construct a bit_comparator process (SystemC
+ * module) and connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <std::size_t N, std::size_t W, template <class> class I1If,
+                        template <class> class I2If,
+                        template <class> class O1If,
+                        template <class> class O2If>
+inline bit_comparator<N,W>* make_bit_comparator(const std::string& pName,
+    O1If<bit_lanes<N>>& gtS,
+    O2If<bit_lanes<N>>& eqS,
+    I1If<bit_planes<N,W>>& inp1S,
+    I2If<bit_planes<N,W>>& inp2S
+    )
+{
+    auto p = new bit_comparator<N,W>(pName.c_str());
+    
+    (*p).iport1(inp1S);
+    (*p).iport2(inp2S);
+    (*p).oport1(gtS);
+    (*p).oport2(eqS);
+    
+    return p;
+}
+
+//! Helper function to construct a process packing boolean signals
+/*! This function is used to construct a bit_pack process (SystemC
+ * module) and connect its output signal.
+ * The user binds the inputs manually.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the output FIFOs.
+ */
+template <std::size_t N, template <class> class OIf>
+inline bit_pack<N>* make_bit_pack(const std::string& pName,
+    OIf<bit_lanes<N>>& outS
+    )
+{
+    auto p = new bit_pack<N>(pName.c_str());
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a process unpacking boolean lanes
+/*! This function is used to construct a bit_unpack process (SystemC
+ * module) and connect its input signal.
+ * The user binds the outputs manually.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input FIFOs.
+ */
+template <std::size_t N, template <class> class IIf>
+inline bit_unpack<N>* make_bit_unpack(const std::string& pName,
+    IIf<bit_lanes<N>>& inpS
+    )
+{
+    auto p = new bit_unpack<N>(pName.c_str());
+    
+    (*p).iport1(inpS);
+    
+    return p;
+}
+
 }
 }
 #endif
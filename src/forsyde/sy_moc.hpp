@@ -30,6 +30,10 @@
 #include "sy_helpers.hpp"
 #include "sy_process_constructors_strict.hpp"
 #include "sy_helpers_strict.hpp"
+#include "sy_fuse.hpp"
+#include "sy_cyclic_executive.hpp"
+#include "sy_multiclock.hpp"
+#include "sy_static_net.hpp"
 
 namespace ForSyDe
 {
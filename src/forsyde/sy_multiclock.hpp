@@ -0,0 +1,380 @@
+/**********************************************************************
+    * sy_multiclock.hpp -- Execution of SY regions with several clock *
+    *                      domains                                    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Activating the processes of the slow clock domains of  *
+    *          an SY region only on their own ticks                   *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_MULTICLOCK_HPP
+#define SY_MULTICLOCK_HPP
+
+/*! \file sy_multiclock.hpp
+ * \brief Implements an executor for SY regions with several clock domains
+ *
+ *  The clock domains of an SY region are connected by domain interfaces
+ * (SY::upsample and SY::downsample), which relate their rates. A slow
+ * subsystem is then modeled at its own rate instead of being fed with
+ * absent tokens on most ticks of the base clock:
+ *
+ *     SY::make_downsample("dn", 1000, slow_in, fast_out);
+ *     ...  // the supervisory logic, at 1/1000 of the base rate
+ *     SY::make_upsample("up", 1000, fast_in, slow_out, true);
+ *
+ * The multi-clock executive infers the rate of each process relative to
+ * the base clock, and fires each process only on the ticks of its domain.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <numeric>
+#include <sstream>
+#include <cstdint>
+
+#include "sy_cyclic_executive.hpp"
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! A single-threaded executive for an SY region with several clock domains
+/*! This module collects the SY processes below a given module in the
+ * hierarchy (or the ones explicitly added) and takes over their
+ * execution. The rate of each process relative to the base clock is
+ * inferred from the domain interfaces, whose sides tick at different
+ * rates, and from the declared rates of the regions (see set_rate()).
+ * Over a hyperperiod of the base clock, which contains a whole number of
+ * ticks of every domain, the processes are fired only on the ticks of
+ * their domains, in the order in which their tokens become available.
+ * A process whose inputs are not ready yet on its tick (e.g., behind an
+ * upsample whose input is produced later in the period) is fired as
+ * soon as they are.
+ *
+ * As in the cyclic executive, all the signals bound to the processes
+ * should be inside the region and are switched to plain ring buffers,
+ * which are sized for the hyperperiod.
+ */
+class multiclock_executive : public sc_module, private sy_region
+{
+public:
+    //! The constructor requires the module name and the root of the region
+    /*! All the SY processes below the root module in the hierarchy are
+     * executed, unless some processes are added explicitly using add().
+     */
+    multiclock_executive(sc_module_name _name,  ///< The module name
+                         sc_module* root=NULL   ///< The root of the region
+                         ) : sc_module(_name), root(root)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the region
+    void add(sy_process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! Declares the rate of the processes below a module (or of a process)
+    /*! They tick num times every den ticks of the base clock. The rates
+     * which follow from the domain interfaces should agree with it. In a
+     * part of the region connected by domain interfaces without any
+     * declared rate, the fastest domain ticks at the base rate.
+     */
+    void set_rate(sc_module* region, unsigned int num, unsigned int den)
+    {
+        if (num == 0 || den == 0)
+            SC_REPORT_ERROR(name(), "the rate of a clock domain should be positive");
+        declared.push_back({region, rate_t(num, den)});
+    }
+
+    //! The rate of a process relative to the base clock, as num/den
+    std::pair<size_t,size_t> rate_of(sy_process* p) const
+    {
+        auto it = rates.find(p);
+        return it == rates.end() ? std::make_pair(size_t(1),size_t(1)) : it->second;
+    }
+
+    //! The number of base ticks after which the schedule repeats
+    size_t hyperperiod() const {return period;}
+
+    //! The processes fired in each base tick of the hyperperiod
+    const std::vector<std::vector<sy_process*>>& schedule() const
+    {
+        return sched;
+    }
+
+    //! The number of base ticks completed so far
+    unsigned long long ticks() const {return tick_cnt;}
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_multiclock_executive";}
+
+private:
+    SC_HAS_PROCESS(multiclock_executive);
+
+    typedef std::pair<size_t,size_t> rate_t;
+
+    //! A channel of the region
+    struct edge
+    {
+        size_t src, dst;            // indices of the writer and the reader
+        unsigned int prod, cons;    // tokens written and read per firing
+        static_channel* chan;
+    };
+
+    sc_module* root;
+    std::vector<std::pair<sc_module*, rate_t>> declared;
+    std::map<sy_process*, rate_t> rates;
+    std::vector<edge> edges;
+    size_t period = 1;
+    std::vector<std::vector<sy_process*>> sched;
+    unsigned long long tick_cnt = 0;
+
+    static rate_t reduce(size_t num, size_t den)
+    {
+        const size_t g = std::gcd(num, den);
+        return rate_t(num / g, den / g);
+    }
+
+    //! Builds the channels of the region and checks that it is closed
+    void build_edges()
+    {
+        std::set<std::string> unsupported = unsupported_kinds();
+        unsupported.erase("SY::upsample");
+        unsupported.erase("SY::downsample");
+        const std::set<std::string> moore_kinds = {"SY::moore", "SY::smoore"};
+        std::map<sc_interface*, size_t> writer, reader;
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            sy_process* p = procs[i];
+            if (unsupported.count(p->forsyde_kind()))
+                SC_REPORT_ERROR(name(), (p->forsyde_kind() + " processes are not supported by the multi-clock executive").c_str());
+            if (auto as = dynamic_cast<absent_skipping*>(p))
+                as->set_skip_absent(false);
+            if (moore_kinds.count(p->forsyde_kind())) primed.push_back(p);
+            for (auto c : channels(p, "sc_fifo_in")) reader[c] = i;
+            for (auto c : channels(p, "sc_fifo_out")) writer[c] = i;
+        }
+        for (auto& w : writer)
+            if (reader.find(w.first) == reader.end())
+                SC_REPORT_ERROR(name(), "the multi-clock executive requires a closed SY region: a signal has no reader in the region");
+        for (auto& r : reader)
+        {
+            auto w = writer.find(r.first);
+            if (w == writer.end())
+                SC_REPORT_ERROR(name(), "the multi-clock executive requires a closed SY region: a signal has no writer in the region");
+            static_channel* ch = dynamic_cast<static_channel*>(r.first);
+            if (ch == NULL)
+                SC_REPORT_ERROR(name(), "only ForSyDe signals are supported by the multi-clock executive");
+            auto src = dynamic_cast<domain_interface*>(procs[w->second]);
+            auto dst = dynamic_cast<domain_interface*>(procs[r.second]);
+            edges.push_back({w->second, r.second, src ? src->out_toks() : 1u,
+                             dst ? dst->in_toks() : 1u, ch});
+        }
+    }
+
+    //! Infers the rates of the processes from the domain interfaces
+    void infer_rates()
+    {
+        const size_t n = procs.size();
+        std::vector<rate_t> rate(n, rate_t(0,1)), decl(n, rate_t(0,1));
+        // the declared rates, the innermost declaration taking precedence
+        for (size_t i=0; i<n; i++)
+        {
+            size_t depth = SIZE_MAX;
+            for (auto& d : declared)
+            {
+                size_t k = 0;
+                for (sc_object* o=procs[i]; o!=NULL; o=o->get_parent_object(), k++)
+                    if (o == d.first)
+                    {
+                        if (k < depth)
+                        {
+                            decl[i] = reduce(d.second.first, d.second.second);
+                            depth = k;
+                        }
+                        break;
+                    }
+            }
+        }
+        std::vector<std::vector<size_t>> adj(n);
+        for (size_t e=0; e<edges.size(); e++)
+        {
+            adj[edges[e].src].push_back(e);
+            adj[edges[e].dst].push_back(e);
+        }
+        for (size_t s=0; s<n; s++)
+        {
+            if (rate[s].first != 0) continue;
+            // start the connected part from a declared process, if any
+            std::vector<size_t> comp, stack(1, s);
+            std::vector<bool> seen(n, false);
+            seen[s] = true;
+            size_t start = s;
+            while (!stack.empty())
+            {
+                size_t a = stack.back(); stack.pop_back();
+                comp.push_back(a);
+                if (decl[a].first != 0 && decl[start].first == 0) start = a;
+                for (auto e : adj[a])
+                {
+                    size_t b = edges[e].src == a ? edges[e].dst : edges[e].src;
+                    if (!seen[b]) {seen[b] = true; stack.push_back(b);}
+                }
+            }
+            rate[start] = decl[start].first != 0 ? decl[start] : rate_t(1,1);
+            stack.assign(1, start);
+            while (!stack.empty())
+            {
+                size_t a = stack.back(); stack.pop_back();
+                for (auto e : adj[a])
+                {
+                    const edge& ed = edges[e];
+                    // rate[src] * prod == rate[dst] * cons
+                    size_t b;
+                    rate_t r;
+                    if (ed.src == a)
+                    {
+                        b = ed.dst;
+                        r = reduce(rate[a].first * ed.prod, rate[a].second * ed.cons);
+                    }
+                    else
+                    {
+                        b = ed.src;
+                        r = reduce(rate[a].first * ed.cons, rate[a].second * ed.prod);
+                    }
+                    if (rate[b].first == 0)
+                    {
+                        rate[b] = r;
+                        stack.push_back(b);
+                    }
+                    else if (rate[b] != r)
+                        SC_REPORT_ERROR(name(), "inconsistent clock domains: a signal connects processes of different rates");
+                }
+            }
+            // without a declaration, the fastest domain ticks at the base rate
+            if (decl[start].first == 0)
+            {
+                rate_t fastest = rate[start];
+                for (auto a : comp)
+                    if (rate[a].first * fastest.second > fastest.first * rate[a].second)
+                        fastest = rate[a];
+                for (auto a : comp)
+                    rate[a] = reduce(rate[a].first * fastest.second,
+                                     rate[a].second * fastest.first);
+            }
+            for (auto a : comp)
+                if (decl[a].first != 0 && decl[a] != rate[a])
+                {
+                    std::stringstream ss;
+                    ss << "the rate of " << procs[a]->name() << " is "
+                       << rate[a].first << "/" << rate[a].second
+                       << " of the base clock, unlike the declared rate";
+                    SC_REPORT_ERROR(name(), ss.str().c_str());
+                }
+        }
+        for (size_t i=0; i<n; i++)
+        {
+            period = std::lcm(period, rate[i].second);
+            rates[procs[i]] = rate[i];
+        }
+    }
+
+    //! Builds the schedule of a hyperperiod by symbolic execution
+    /*! It runs at the start of the simulation, when the initial tokens of
+     * the signals are known, and returns the peak occupancy of each
+     * channel.
+     */
+    std::vector<size_t> build_schedule()
+    {
+        const size_t n = procs.size();
+        std::vector<size_t> toks(edges.size()), peak(edges.size()), fired(n, 0);
+        std::vector<std::vector<size_t>> ins(n), outs(n);
+        for (size_t e=0; e<edges.size(); e++)
+        {
+            toks[e] = peak[e] = edges[e].chan->num_available();
+            outs[edges[e].src].push_back(e);
+            ins[edges[e].dst].push_back(e);
+        }
+        sched.assign(period, std::vector<sy_process*>());
+        for (size_t t=0; t<period; t++)
+        {
+            bool progress = true;
+            while (progress)
+            {
+                progress = false;
+                for (size_t i=0; i<n; i++)
+                {
+                    // the ticks of the domain of the process up to the current one
+                    const rate_t r = rates[procs[i]];
+                    if (fired[i] >= (t+1) * r.first / r.second) continue;
+                    bool ready = true;
+                    for (auto e : ins[i]) ready = ready && toks[e] >= edges[e].cons;
+                    if (!ready) continue;
+                    for (auto e : ins[i]) toks[e] -= edges[e].cons;
+                    for (auto e : outs[i])
+                    {
+                        toks[e] += edges[e].prod;
+                        peak[e] = std::max(peak[e], toks[e]);
+                    }
+                    fired[i]++;
+                    sched[t].push_back(procs[i]);
+                    progress = true;
+                }
+            }
+        }
+        for (size_t i=0; i<n; i++)
+        {
+            const rate_t r = rates[procs[i]];
+            if (fired[i] != period * r.first / r.second)
+                SC_REPORT_ERROR(name(), "the SY region deadlocks: a feedback loop across clock domains has too few delays");
+        }
+        return peak;
+    }
+
+    //! Analyzes the region and takes over the execution of its processes
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        if (procs.empty()) return;
+        build_edges();
+        infer_rates();
+        for (auto p : procs) p->set_ext_driven();
+    }
+
+    //! The main and only execution thread of the region
+    void worker()
+    {
+        if (procs.empty()) return;
+        for (auto p : procs) p->ext_init();
+        for (auto p : primed) p->ext_fire();
+        // let the initial tokens arrive before the schedule is built
+        wait(SC_ZERO_TIME);
+        auto peak = build_schedule();
+        for (size_t e=0; e<edges.size(); e++)
+            edges[e].chan->set_static_buffer(std::max(peak[e], size_t(1)));
+        while (1)
+            for (auto& tick : sched)
+            {
+                for (auto p : tick) p->ext_fire();
+                tick_cnt++;
+            }
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,628 @@
+/**********************************************************************
+    * sy_offload.hpp -- Offloading the data-parallel SY processes     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Executing the data-parallel process constructors on an *
+    *          accelerator with the OpenMP target offloading          *
+    *                                                                 *
+    * Usage:   Define FORSYDE_OFFLOAD and compile with the OpenMP     *
+    *          offloading enabled to use it                           *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_OFFLOAD_HPP
+#define SY_OFFLOAD_HPP
+
+/*! \file sy_offload.hpp
+ * \brief Implements the offloaded data-parallel process constructors
+ *
+ *  This file includes the device-resident arrays and the data-parallel
+ * process constructors which evaluate their functions on an OpenMP
+ * target device (e.g., a GPU). The arrays are communicated between the
+ * offloaded processes as handles to the device memory, hence a chain of
+ * them keeps its data on the device, e.g.:
+ *
+ *     make_to_device("up", dev_in, host_in);
+ *     make_sdpmap_device("layer1", relu(), dev_hidden, dev_in);
+ *     make_sdpmap_device("layer2", scale{0.5f}, dev_out, dev_hidden);
+ *     make_to_host("down", host_out, dev_out);
+ *
+ *  The data is only transferred by to_device and to_host, which are
+ * placed at the MoC boundaries and in front of the processes which are
+ * not offloaded, and by sdpreduce_device, whose result is a scalar.
+ *
+ *  The functions are passed as function objects rather than
+ * std::function, since they are copied to the device. They must be
+ * trivially copyable and callable in the target regions. Without an
+ * available device, OpenMP executes the regions on the host.
+ */
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <ostream>
+#include <algorithm>
+#include <type_traits>
+
+#include <omp.h>
+
+#include "abst_ext.hpp"
+#include "serializer.hpp"
+#include "sy_process.hpp"
+
+//! The device of the offloaded processes, the default one if negative
+#ifndef FORSYDE_OFFLOAD_DEVICE
+#define FORSYDE_OFFLOAD_DEVICE -1
+#endif
+
+//! The maximum number of chunks reduced in parallel by sdpreduce_device
+#ifndef FORSYDE_OFFLOAD_CHUNKS
+#define FORSYDE_OFFLOAD_CHUNKS 1024
+#endif
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+template <typename T, std::size_t N> class device_pool;
+
+//! An array which resides in the memory of an offloading device
+/*! It is a shared handle, hence copying it (e.g., writing it to a
+ * signal) does not copy the data. The arrays are not modified after they
+ * are written to a signal, since each process writes a new array of its
+ * pool in every evaluation cycle.
+ */
+template <typename T, std::size_t N>
+class device_array
+{
+public:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "the elements of a device array should be trivially copyable");
+
+    //! The default constructor creates a null handle
+    device_array() {}
+
+    //! The address of the data in the device memory
+    T* data() const {return buf ? buf->ptr : NULL;}
+
+    //! The device on which the data resides
+    int device() const {return buf ? buf->dev : omp_get_initial_device();}
+
+    //! Copies the data from the host memory to the array
+    void from_host(const std::array<T,N>& arr) const
+    {
+        omp_target_memcpy(data(), arr.data(), sizeof(T)*N, 0, 0,
+                          device(), omp_get_initial_device());
+    }
+
+    //! Copies the data from the array to the host memory
+    void to_host(std::array<T,N>& arr) const
+    {
+        omp_target_memcpy(arr.data(), data(), sizeof(T)*N, 0, 0,
+                          omp_get_initial_device(), device());
+    }
+
+    //! Allocates an array which is not shared with any other handle
+    static device_array allocate(int dev)
+    {
+        device_array res;
+        res.buf = std::make_shared<storage>(dev);
+        return res;
+    }
+
+    //! The handles are equal if they refer to the same array
+    bool operator==(const device_array& rs) const {return buf == rs.buf;}
+
+    friend std::ostream& operator<<(std::ostream& os, const device_array& arr)
+    {
+        os << "device_array<" << N << ">@" << arr.device();
+        return os;
+    }
+
+private:
+    //! The device memory, which is freed with its last handle
+    struct storage
+    {
+        T* ptr;
+        int dev;
+
+        storage(int dev) : dev(dev)
+        {
+            ptr = static_cast<T*>(omp_target_alloc(sizeof(T)*N, dev));
+            if (ptr == NULL)
+                SC_REPORT_ERROR("device_array", "the device memory could not be allocated");
+        }
+
+        ~storage() {omp_target_free(ptr, dev);}
+    };
+
+    std::shared_ptr<storage> buf;
+
+    friend class device_pool<T,N>;
+};
+
+//! The device arrays written by a process
+/*! An array is reused once all the other handles to it are released,
+ * i.e., all its readers have consumed it, hence the device memory is
+ * only allocated during the first evaluation cycles.
+ */
+template <typename T, std::size_t N>
+class device_pool
+{
+public:
+    //! Returns an array which is not referred to by any signal
+    device_array<T,N> acquire(int dev)
+    {
+        for (auto& arr : arrays)
+            if (arr.buf.use_count() == 1 && arr.device() == dev)
+                return arr;
+        arrays.push_back(device_array<T,N>::allocate(dev));
+        return arrays.back();
+    }
+
+    //! Releases the arrays
+    void clear() {arrays.clear();}
+
+private:
+    std::vector<device_array<T,N>> arrays;
+};
+
+//! Returns the device used by the offloaded processes
+inline int offload_device(int dev=FORSYDE_OFFLOAD_DEVICE)
+{
+    return dev < 0 ? omp_get_default_device() : dev;
+}
+
+//! Process constructor which copies arrays to the memory of a device
+/*! The absent values are passed through without a transfer.
+ */
+template <typename T, std::size_t N>
+class to_device : public sy_process
+{
+public:
+    SY_in<std::array<T,N>> iport1;          ///< port for the input channel
+    SY_out<device_array<T,N>> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name and the device
+    to_device(const sc_module_name& _name,  ///< process name
+              int dev=FORSYDE_OFFLOAD_DEVICE ///< the target device
+             ) : sy_process(_name), dev(offload_device(dev))
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("dev", this->dev);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::to_device";}
+
+private:
+    int dev;
+    abst_ext<std::array<T,N>> ival;
+    abst_ext<device_array<T,N>> oval;
+    device_pool<T,N> pool;
+
+    void init() {}
+
+    void prep()
+    {
+        ival = iport1.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(ival))
+        {
+            oval = abst_ext<device_array<T,N>>();
+            return;
+        }
+        auto arr = pool.acquire(dev);
+        arr.from_host(unsafe_from_abst_ext(ival));
+        oval = arr;
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, oval);
+        // the array is released for reuse once its readers consume it
+        oval = abst_ext<device_array<T,N>>();
+    }
+
+    void clean()
+    {
+        pool.clear();
+    }
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor which copies arrays from the memory of a device
+/*! The absent values are passed through without a transfer.
+ */
+template <typename T, std::size_t N>
+class to_host : public sy_process
+{
+public:
+    SY_in<device_array<T,N>> iport1;        ///< port for the input channel
+    SY_out<std::array<T,N>> oport1;         ///< port for the output channel
+
+    //! The constructor requires the module name
+    to_host(const sc_module_name& _name     ///< process name
+           ) : sy_process(_name) {}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::to_host";}
+
+private:
+    abst_ext<device_array<T,N>> ival;
+    abst_ext<std::array<T,N>> oval;
+
+    void init() {}
+
+    void prep()
+    {
+        ival = iport1.read();
+    }
+
+    void exec()
+    {
+        if (is_absent(ival))
+        {
+            oval = abst_ext<std::array<T,N>>();
+            return;
+        }
+        std::array<T,N> arr;
+        unsafe_from_abst_ext(ival).to_host(arr);
+        oval = arr;
+        ival = abst_ext<device_array<T,N>>();
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, oval);
+    }
+
+    void clean() {}
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! An offloaded data-parallel process constructor for a strict combinational process
+/*! Similar to sdpmap, but the function is applied to the elements of
+ * the device arrays on their device.
+ */
+template <typename T0, typename T1, std::size_t N, typename F>
+class sdpmap_device : public sy_process
+{
+public:
+    SY_in<device_array<T1,N>> iport1;       ///< port for the input channel
+    SY_out<device_array<T0,N>> oport1;      ///< port for the output channel
+
+    static_assert(std::is_trivially_copyable<F>::value,
+                  "the function object of an offloaded process should be trivially copyable");
+
+    //! The constructor requires the module name and the function object
+    sdpmap_device(const sc_module_name& _name,  ///< process name
+                  const F& _func                ///< function to be passed
+                 ) : sy_process(_name), _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::sdpmap_device";}
+
+private:
+    device_array<T1,N> ival;
+    device_array<T0,N> oval;
+    device_pool<T0,N> pool;
+
+    //! The function passed to the process constructor
+    F _func;
+
+    void init() {}
+
+    void prep()
+    {
+        auto ival_temp = iport1.read();
+        CHECK_PRESENCE(ival_temp);
+        ival = unsafe_from_abst_ext(ival_temp);
+    }
+
+    void exec()
+    {
+        const int dev = ival.device();
+        oval = pool.acquire(dev);
+        T0* out = oval.data();
+        const T1* in = ival.data();
+        const F f = _func;
+        #pragma omp target teams distribute parallel for device(dev) is_device_ptr(out, in) firstprivate(f)
+        for (size_t i=0; i<N; i++)
+            f(out[i], in[i]);
+        ival = device_array<T1,N>();
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<device_array<T0,N>>(oval));
+        oval = device_array<T0,N>();
+    }
+
+    void clean()
+    {
+        pool.clear();
+    }
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! An offloaded data-parallel process constructor for a strict reduce process
+/*! Similar to sdpreduce, but the chunks of the device array are reduced
+ * on its device and only their partial results are copied to the host,
+ * where they are combined in a balanced tree. The result equals the
+ * serial one for any associative function.
+ */
+template <typename T0, std::size_t N, typename F>
+class sdpreduce_device : public sy_process
+{
+public:
+    SY_in<device_array<T0,N>> iport1;       ///< port for the input channel
+    SY_out<T0> oport1;                      ///< port for the output channel
+
+    static_assert(std::is_trivially_copyable<F>::value,
+                  "the function object of an offloaded process should be trivially copyable");
+
+    //! The constructor requires the module name and the function object
+    sdpreduce_device(const sc_module_name& _name,   ///< process name
+                     const F& _func                 ///< function to be passed
+                    ) : sy_process(_name), _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::sdpreduce_device";}
+
+private:
+    //! The number of chunks reduced in parallel
+    static constexpr size_t chunks = N < FORSYDE_OFFLOAD_CHUNKS ? N : FORSYDE_OFFLOAD_CHUNKS;
+
+    device_array<T0,N> ival;
+    T0 oval;
+
+    //! The partial results of the chunks on the device and on the host
+    device_array<T0,chunks> dev_partial;
+    std::array<T0,chunks> partial;
+
+    //! The function passed to the process constructor
+    F _func;
+
+    void init() {}
+
+    void prep()
+    {
+        auto ival_temp = iport1.read();
+        CHECK_PRESENCE(ival_temp);
+        ival = unsafe_from_abst_ext(ival_temp);
+    }
+
+    void exec()
+    {
+        const int dev = ival.device();
+        if (dev_partial.data() == NULL || dev_partial.device() != dev)
+            dev_partial = device_array<T0,chunks>::allocate(dev);
+        T0* part = dev_partial.data();
+        const T0* in = ival.data();
+        const F f = _func;
+        // each chunk is folded from its first element, so no identity
+        // element of the function is needed
+        #pragma omp target teams distribute parallel for device(dev) is_device_ptr(part, in) firstprivate(f)
+        for (size_t c=0; c<chunks; c++)
+        {
+            const size_t begin = N*c/chunks, end = N*(c+1)/chunks;
+            T0 acc = in[begin];
+            for (size_t i=begin+1; i<end; i++)
+                f(acc, acc, in[i]);
+            part[c] = acc;
+        }
+        dev_partial.to_host(partial);
+        for (size_t stride=1; stride<chunks; stride*=2)
+            for (size_t i=0; i+stride<chunks; i+=2*stride)
+                _func(partial[i], partial[i], partial[i+stride]);
+        oval = partial[0];
+        ival = device_array<T0,N>();
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<T0>(oval));
+    }
+
+    void clean()
+    {
+        dev_partial = device_array<T0,chunks>();
+    }
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Helper function to construct a to_device process
+template <class T, std::size_t N,
+          template <class> class OIf,
+          template <class> class IIf>
+inline to_device<T,N>* make_to_device(const std::string& pName,
+    OIf<device_array<T,N>>& outS,
+    IIf<std::array<T,N>>& inpS,
+    int dev=FORSYDE_OFFLOAD_DEVICE
+    )
+{
+    auto p = new to_device<T,N>(pName.c_str(), dev);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a to_host process
+template <class T, std::size_t N,
+          template <class> class OIf,
+          template <class> class IIf>
+inline to_host<T,N>* make_to_host(const std::string& pName,
+    OIf<std::array<T,N>>& outS,
+    IIf<device_array<T,N>>& inpS
+    )
+{
+    auto p = new to_host<T,N>(pName.c_str());
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct an sdpmap_device process
+template <class T0, template <class> class OIf,
+          class T1, template <class> class IIf,
+          std::size_t N, class F>
+inline sdpmap_device<T0,T1,N,F>* make_sdpmap_device(const std::string& pName,
+    const F& _func,
+    OIf<device_array<T0,N>>& outS,
+    IIf<device_array<T1,N>>& inpS
+    )
+{
+    auto p = new sdpmap_device<T0,T1,N,F>(pName.c_str(), _func);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct an sdpreduce_device process
+template <class T0, template <class> class OIf,
+          template <class> class IIf,
+          std::size_t N, class F>
+inline sdpreduce_device<T0,N,F>* make_sdpreduce_device(const std::string& pName,
+    const F& _func,
+    OIf<T0>& outS,
+    IIf<device_array<T0,N>>& inpS
+    )
+{
+    auto p = new sdpreduce_device<T0,N,F>(pName.c_str(), _func);
+
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+
+    return p;
+}
+
+}
+
+//! The serializer of the device arrays
+/*! The data is copied through the host, and read into an array on the
+ * default offloading device.
+ */
+template <typename T, std::size_t N>
+struct serializer<SY::device_array<T,N>>
+{
+    static constexpr size_t max_size = 1 + sizeof(T)*N;
+
+    static void write(std::vector<char>& buf, const SY::device_array<T,N>& val)
+    {
+        buf.push_back(val.data() != NULL);
+        if (val.data() == NULL) return;
+        std::array<T,N> arr;
+        val.to_host(arr);
+        serializer<std::array<T,N>>::write(buf, arr);
+    }
+
+    static void read(const char*& pos, SY::device_array<T,N>& val)
+    {
+        const bool valid = *pos++;
+        val = SY::device_array<T,N>();
+        if (!valid) return;
+        std::array<T,N> arr;
+        serializer<std::array<T,N>>::read(pos, arr);
+        val = SY::device_array<T,N>::allocate(SY::offload_device());
+        val.from_host(arr);
+    }
+};
+
+}
+
+#endif
@@ -0,0 +1,353 @@
+/**********************************************************************
+    * sy_parallel_executor.hpp -- Multi-threaded execution of SY      *
+    *                             process networks                    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Evaluating the processes of a synchronous region on    *
+    *          several cores                                          *
+    *                                                                 *
+    * Usage:   Define FORSYDE_MULTITHREADED and link with the         *
+    *          threading library (e.g., -pthread)                     *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_PARALLEL_EXECUTOR_HPP
+#define SY_PARALLEL_EXECUTOR_HPP
+
+/*! \file sy_parallel_executor.hpp
+ * \brief Implements a multi-threaded executor for SY process networks
+ *
+ *  This file includes an opt-in executor which evaluates all the
+ * processes of a closed SY region in each evaluation cycle on a
+ * work-stealing thread pool.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+
+#include "sy_process.hpp"
+#include "sy_cyclic_executive.hpp"
+#include "work_stealing_pool.hpp"
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! A multi-threaded executor for a closed SY region
+/*! This module collects the SY processes below a given module in the
+ * hierarchy (or the ones explicitly added) and takes over their
+ * execution. In each evaluation cycle (tick):
+ *  - the source processes (the ones without inputs) are fired in the
+ *    SystemC thread of the executor,
+ *  - the rest of the processes are fired on a work-stealing thread pool,
+ *    each process as soon as all of its producers in the same tick have
+ *    been fired,
+ *  - the delay processes are fired at the end of the tick.
+ *
+ * This is the order of the cyclic executive (see sy_region), where the
+ * independent processes of a tick run in parallel. All the signals of
+ * the region are switched to plain ring buffers, hence all the
+ * processes bound to them should be scheduled by the same executor. The
+ * processes evaluated on the thread pool should not call the SystemC
+ * kernel (e.g., wait()). The sources may stop the whole region by
+ * waiting forever, as in the normal execution.
+ *
+ * The processes which do not produce exactly one token per input token
+ * and tick (group and the wrappers) are not supported. The senders and
+ * receivers of the parallel simulation are supported when MPI is
+ * progressed by a communication thread (see mpi_progress), which lets a
+ * rank run the partition of a whole node on the pool.
+ *
+ * The processes which are too small to be scheduled individually can be
+ * grouped into atomic clusters (see add_cluster() and set_grain()). A
+ * cluster is a single task of the pool, which fires its processes
+ * sequentially in a topological order.
+ *
+ * With FORSYDE_NUMA, a placement of the processes on the NUMA nodes can
+ * be set (see numa_placement). The workers of the pool are then spread
+ * over the used nodes, each process is fired by the workers of its node,
+ * and the ring buffers of the signals are allocated on the nodes of
+ * their readers.
+ */
+class parallel_executor : public sc_module, private sy_region
+{
+public:
+    //! The constructor requires the module name and the root of the region
+    /*! All the SY processes below the root module in the hierarchy are
+     * executed, unless some processes are added explicitly using add().
+     */
+    parallel_executor(sc_module_name _name,     ///< The module name
+                      sc_module* root=NULL,     ///< The root of the region
+                      unsigned nthreads=0       ///< The pool size (0 for the number of cores)
+                      ) : sc_module(_name), root(root), nthreads(nthreads)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the region
+    void add(sy_process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! Makes the processes of a composite module an atomic cluster
+    /*! The processes below the module in the hierarchy are fired as a
+     * single task. No path between two processes of a cluster should
+     * leave it in the same tick. It should be called before the
+     * simulation starts.
+     */
+    void add_cluster(sc_module* composite)
+    {
+        clusters.push_back(composite);
+    }
+
+    //! Sets the grain of the automatic clustering
+    /*! The firings of the processes are measured in the first tick, which
+     * runs sequentially, and the chains of processes whose firings take
+     * less than the grain (in seconds) in total are merged into
+     * clusters. Zero disables it. With FORSYDE_PROFILE_DB, the costs of
+     * the previous runs are used instead if all of them are known. It
+     * should be called before the simulation starts.
+     */
+    void set_grain(double secs)
+    {
+        grain = secs;
+    }
+
+    //! The number of tasks run on the pool in each tick
+    size_t tasks() const {return members.size();}
+
+#ifdef FORSYDE_NUMA
+    //! Sets the placement of the processes on the NUMA nodes
+    /*! It should be called before the simulation starts.
+     */
+    void set_placement(const numa_placement& pl) {placement = pl;}
+#endif
+
+    //! The number of evaluation cycles completed so far
+    unsigned long long ticks() const {return tick_cnt;}
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_parallel_executor";}
+
+private:
+    SC_HAS_PROCESS(parallel_executor);
+
+    sc_module* root;
+    unsigned nthreads;
+    std::unique_ptr<std::atomic<size_t>[]> pending;
+
+    // the clusters marked by the user, and the grain of the automatic ones
+    std::vector<sc_module*> clusters;
+    double grain = 0;
+    // the combs of each task in a topological order, the task of each
+    // comb and the dependencies among the tasks
+    std::vector<std::vector<size_t>> members, tsuccs;
+    std::vector<size_t> task_of, tnpreds, troots;
+
+    std::unique_ptr<work_stealing_pool> pool;
+    unsigned long long tick_cnt = 0;
+
+    //! Classifies the processes and builds the dependency graph
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        if (procs.empty()) return;
+        analyze(name(), "the parallel executor");
+        // the combs below a marked module form its cluster
+        std::vector<size_t> group(combs.size());
+        for (size_t i=0; i<combs.size(); i++)
+        {
+            group[i] = i;
+            for (sc_object* o=combs[i]->get_parent_object(); o!=NULL; o=o->get_parent_object())
+            {
+                auto it = std::find(clusters.begin(), clusters.end(), o);
+                if (it != clusters.end()) group[i] = combs.size() + (it - clusters.begin());
+            }
+        }
+        build_tasks(group);
+        for (auto p : procs) p->set_ext_driven();
+    }
+
+    //! Groups the combs into the tasks, given the group of each comb
+    void build_tasks(const std::vector<size_t>& group)
+    {
+        std::map<size_t, size_t> task_of_group;
+        members.clear();
+        task_of.assign(combs.size(), 0);
+        for (auto c : order)
+        {
+            auto it = task_of_group.find(group[c]);
+            if (it == task_of_group.end())
+            {
+                it = task_of_group.emplace(group[c], members.size()).first;
+                members.emplace_back();
+            }
+            members[it->second].push_back(c);
+            task_of[c] = it->second;
+        }
+        const size_t n = members.size();
+        std::vector<std::set<size_t>> next(n);
+        for (size_t c=0; c<combs.size(); c++)
+            for (auto s : succs[c])
+                if (task_of[s] != task_of[c]) next[task_of[c]].insert(task_of[s]);
+        tsuccs.assign(n, std::vector<size_t>());
+        tnpreds.assign(n, 0);
+        troots.clear();
+        for (size_t t=0; t<n; t++)
+            for (auto s : next[t])
+            {
+                tsuccs[t].push_back(s);
+                tnpreds[s]++;
+            }
+        for (size_t t=0; t<n; t++)
+            if (tnpreds[t] == 0) troots.push_back(t);
+        // a cluster which a path leaves and re-enters can not be atomic
+        std::vector<size_t> indeg(tnpreds), stack(troots);
+        size_t seen = 0;
+        while (!stack.empty())
+        {
+            const size_t t = stack.back(); stack.pop_back();
+            seen++;
+            for (auto s : tsuccs[t])
+                if (--indeg[s] == 0) stack.push_back(s);
+        }
+        if (seen != n)
+            SC_REPORT_ERROR(name(), "a path between the processes of a cluster leaves the cluster");
+        pending.reset(new std::atomic<size_t>[n]);
+    }
+
+    //! Merges the chains of short processes into clusters
+    /*! A comb joins the task of its predecessors if they are all in the
+     * same task and the firings of both take less than the grain. The
+     * contracted edge is then the only one entering the comb, hence the
+     * task graph stays acyclic.
+     */
+    void merge_chains(const std::vector<double>& cost)
+    {
+        std::vector<size_t> group(task_of);
+        std::vector<double> tcost(members.size(), 0);
+        for (size_t c=0; c<combs.size(); c++) tcost[task_of[c]] += cost[c];
+        std::vector<std::vector<size_t>> preds(combs.size());
+        for (size_t c=0; c<combs.size(); c++)
+            for (auto s : succs[c]) preds[s].push_back(c);
+        // the groups are the tasks, whose indices follow the order
+        for (auto c : order)
+        {
+            if (members[task_of[c]].size() > 1 || preds[c].empty()) continue;
+            const size_t g = group[preds[c][0]];
+            bool single = true;
+            for (auto p : preds[c]) single &= group[p] == g;
+            if (!single || tcost[g] + cost[c] >= grain) continue;
+            tcost[g] += cost[c];
+            group[c] = g;
+        }
+        build_tasks(group);
+    }
+
+    //! Fires the processes of a task on the thread pool and enables its successors
+    void fire(size_t task, unsigned w)
+    {
+        for (auto c : members[task]) combs[c]->ext_fire();
+        for (auto s : tsuccs[task])
+            if (pending[s].fetch_sub(1, std::memory_order_acq_rel) == 1)
+                pool->push(w, s);
+    }
+
+    //! Sets the home nodes of the tasks, which are the ones of their first processes
+    void place_tasks()
+    {
+#ifdef FORSYDE_NUMA
+        if (placement.empty()) return;
+        std::vector<int> tnodes;
+        for (auto& m : members) tnodes.push_back(placement.node_of(combs[m[0]]));
+        pool->set_task_nodes(tnodes);
+#endif
+    }
+
+    //! The SystemC thread of the executor
+    void worker()
+    {
+        if (procs.empty()) return;
+        start();
+#ifdef FORSYDE_NUMA
+        if (!placement.empty())
+        {
+            // the workers are spread over the used nodes in turn
+            const auto used = placement.used_nodes();
+            unsigned n = nthreads ? nthreads : std::thread::hardware_concurrency();
+            std::vector<int> wnodes;
+            for (unsigned i=0; i<std::max(n, 1u); i++)
+                wnodes.push_back(used[i % used.size()]);
+            pool.reset(new work_stealing_pool(wnodes));
+        }
+        else
+#endif
+        pool.reset(new work_stealing_pool(nthreads));
+        if (grain > 0)
+        {
+            std::vector<double> cost(combs.size(), 0);
+            bool known = false;
+#ifdef FORSYDE_PROFILE_DB
+            // the costs of the previous runs, if all of them are known
+            known = true;
+            for (size_t c=0; c<combs.size() && known; c++)
+                known = (cost[c] = profile_db::get().cost(combs[c]->name())) >= 0;
+#endif
+            if (!known)
+            {
+                // the first tick runs sequentially and measures the firings
+                for (auto p : sources) p->ext_fire();
+                for (auto c : order)
+                {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    combs[c]->ext_fire();
+                    cost[c] = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                }
+                for (auto p : delays) p->ext_fire();
+                tick_cnt++;
+            }
+            merge_chains(cost);
+        }
+        place_tasks();
+        auto body = [this](size_t task, unsigned w){fire(task, w);};
+        while (1)
+        {
+            for (auto p : sources) p->ext_fire();
+            for (size_t i=0; i<members.size(); i++)
+                pending[i].store(tnpreds[i], std::memory_order_relaxed);
+            pool->run(troots, members.size(), body);
+            for (auto p : delays) p->ext_fire();
+            tick_cnt++;
+        }
+    }
+};
+
+//! Helper function to construct a parallel executor for a region
+template <class... Ps>
+inline parallel_executor* make_parallel_executor(const std::string& pName,  ///< the executor name
+    unsigned nthreads,                             ///< the pool size (0 for the number of cores)
+    Ps*... procs                                   ///< the processes of the region
+    )
+{
+    auto e = new parallel_executor(pName.c_str(), NULL, nthreads);
+    (e->add(procs), ...);
+    return e;
+}
+
+}
+}
+
+#endif
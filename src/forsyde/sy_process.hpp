@@ -20,6 +20,10 @@
  * abstract base process used in the synchronous MoC.
  */
 
+#include <array>
+#include <algorithm>
+#include <cstdint>
+
 #include "abst_ext.hpp"
 #include "abssemantics.hpp"
 
@@ -51,6 +55,33 @@ public:
 template <typename T>
 using signal = SY2SY<T>;
 
+//! A vector signal carrying N lanes of type T in each token
+/*! It is the signal type written by zipX and read by unzipX. Using it
+ * directly between the vectorized process constructors (combXV, mapX)
+ * creates a single channel and a single port per process instead of N.
+ */
+template <typename T, std::size_t N>
+using vector_signal = SY2SY<std::array<abst_ext<T>,N>>;
+
+//! A SY signal based on the single-producer single-consumer ring buffer
+/*! It can be used instead of SY::signal for signals with exactly one
+ * writer and one reader to avoid the sc_fifo overheads.
+ */
+template <typename T>
+class spsc_signal: public ForSyDe::signal<T,abst_ext<T>,spsc_fifo>
+{
+public:
+    spsc_signal() : ForSyDe::signal<T,abst_ext<T>,spsc_fifo>() {}
+    spsc_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,abst_ext<T>,spsc_fifo>(name, size) {}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "SY";
+    }
+#endif
+};
+
 //! The SY_in port is used for input ports of SY processes
 template <typename T>
 class SY_in: public ForSyDe::in_port<T,abst_ext<T>,signal<T>>
@@ -94,6 +125,56 @@ using out_port = SY_out<T>;
 //! Abstract semantics of a process in the SY MoC
 typedef ForSyDe::process sy_process;
 
+//! The absent-skipping policy of some SY process constructors
+/*! When it is enabled, a process whose inputs are all absent in a cycle
+ * does not call its functions and produces an absent output, keeping
+ * its state. This is only equivalent to the normal behavior if the
+ * functions do so themselves, hence it is opt-in: per process using
+ * set_skip_absent(), or for all the processes by defining
+ * FORSYDE_SKIP_ABSENT.
+ *
+ * With FORSYDE_ABSENT_RLE, the rest of the absent runs common to all
+ * the inputs are consumed at once and forwarded as a single run, so that
+ * a chain of such processes skips long absent runs as a whole.
+ */
+class absent_skipping
+{
+public:
+    //! Enables or disables skipping the cycles with all inputs absent
+    void set_skip_absent(bool skip) {skip_absent = skip;}
+    
+    //! Checks if the cycles with all inputs absent are skipped
+    bool skips_absent() const {return skip_absent;}
+    
+protected:
+#ifdef FORSYDE_SKIP_ABSENT
+    bool skip_absent = true;
+#else
+    bool skip_absent = false;
+#endif
+    
+    //! Consumes the absent tokens following the current one on all the ports
+    /*! It returns their number, which is the length of the shortest
+     * absent run being read from the channels bound to the ports.
+     */
+    template <class... Ports>
+    static size_t skip_absent_runs(Ports&... ports)
+    {
+#ifdef FORSYDE_ABSENT_RLE
+        size_t k = SIZE_MAX;
+        absent_run_channel* runs[] = {dynamic_cast<absent_run_channel*>(ports[0])...};
+        for (auto r : runs)
+            k = r == NULL ? 0 : std::min(k, r->absent_run_left());
+        if (k == 0) return 0;
+        for (auto r : runs) r->skip_absent_run(k);
+        return k;
+#else
+        ((void)ports, ...);
+        return 0;
+#endif
+    }
+};
+
 }
 }
 
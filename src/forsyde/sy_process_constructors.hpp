@@ -28,7 +28,13 @@
 #include <algorithm>
 
 #include "abst_ext.hpp"
+#include "abst_array.hpp"
 #include "sy_process.hpp"
+#include "file_io.hpp"
+#include "token_stream.hpp"
+#include "memo_cache.hpp"
+#include "async_sink.hpp"
+#include "prefetch.hpp"
 
 namespace ForSyDe
 {
@@ -41,17 +47,21 @@ using namespace sc_core;
 //! Process constructor for a combinational process with one input and one output
 /*! This class is used to build combinational processes with one input
  * and one output. The class is parameterized for input and output
- * data-types.
+ * data-types. The type of the function can also be given (e.g., the type
+ * of a lambda) so that it is called directly instead of through
+ * std::function.
  */
-template <typename T0, typename T1>
-class comb : public sy_process
+template <typename T0, typename T1,
+          typename FuncType = std::function<void(abst_ext<T0>&,
+                                                 const abst_ext<T1>&)>>
+class comb : public sy_process, public absent_skipping
 {
 public:
     SY_in<T1>  iport1;       ///< port for the input channel
     SY_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(abst_ext<T0>&,const abst_ext<T1>&)> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -64,9 +74,7 @@ public:
              _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -75,8 +83,10 @@ public:
 
 private:
     // Inputs and output variables
-    abst_ext<T0>* oval;
-    abst_ext<T1>* ival1;
+    abst_ext<T0> oval;
+    abst_ext<T1> ival1;
+    // absent cycles skipped after the current one
+    size_t skipped = 0;
     
     //! The function passed to the process constructor
     functype _func;
@@ -84,29 +94,162 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new abst_ext<T0>;
-        ival1 = new abst_ext<T1>;
     }
     
     void prep()
     {
-        *ival1 = iport1.read();
+        iport1.read(ival1);
     }
     
     void exec()
     {
-        _func(*oval, *ival1);
+        if (skip_absent && is_absent(ival1))
+        {
+            set_abst(oval);
+            skipped = skip_absent_runs(iport1);
+        }
+        else
+            _func(oval, ival1);
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        if (skipped > 0)
+        {
+            write_absents_multiport<T0>(oport1, skipped+1);
+            skipped = 0;
+        }
+        else
+            write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival1;
-        delete oval;
+    }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a memoizing combinational process with one input and one output
+/*! Similar to comb, but the results of the function are cached for the
+ * recent input values, and the function is only called for the values
+ * which are not in the cache. Hence, it is only suitable for pure
+ * functions. The number of the cache hits and misses is reported in
+ * the profile of the process when FORSYDE_PROFILE is defined.
+ *
+ * The input type should be hashable with memo_hash and comparable.
+ */
+template <typename T0, typename T1>
+class memo_comb : public sy_process, public absent_skipping
+{
+public:
+    SY_in<T1>  iport1;       ///< port for the input channel
+    SY_out<T0> oport1;        ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(abst_ext<T0>&, const abst_ext<T1>&)> functype;
+
+    //! The constructor requires the module name, the function and the cache capacity
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to it if its result is not
+     * cached and writes the results using the output port
+     */
+    memo_comb(const sc_module_name& _name,      ///< process name
+              const functype& _func,            ///< function to be passed
+              size_t capacity=FORSYDE_MEMO_CAPACITY ///< the number of cached results
+             ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+                 _func(_func), cache(capacity)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("capacity", capacity);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::memo_comb";}
+
+private:
+    // Inputs and output variables
+    abst_ext<T0> oval;
+    abst_ext<T1> ival1;
+    // absent cycles skipped after the current one
+    size_t skipped = 0;
+    
+    //! The function passed to the process constructor
+    functype _func;
+    
+    //! The cached results of the function
+    memo_cache<abst_ext<T1>,abst_ext<T0>> cache;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+    
+    void prep()
+    {
+        iport1.read(ival1);
+    }
+    
+    void exec()
+    {
+        if (skip_absent && is_absent(ival1))
+        {
+            set_abst(oval);
+            skipped = skip_absent_runs(iport1);
+        }
+        else if (const abst_ext<T0>* res = cache.find(ival1))
+            oval = *res;
+        else
+        {
+            _func(oval, ival1);
+            cache.insert(ival1, oval);
+        }
+#ifdef FORSYDE_PROFILE
+        prof.memo_hits = cache.hits();
+        prof.memo_misses = cache.misses();
+#endif
+    }
+    
+    void prod()
+    {
+        if (skipped > 0)
+        {
+            write_absents_multiport<T0>(oport1, skipped+1);
+            skipped = 0;
+        }
+        else
+            write_multiport(oport1, oval);
+    }
+    
+    void clean()
+    {
+        cache.clear();
+    }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -123,8 +266,11 @@ private:
 //! Process constructor for a combinational process with two inputs and one output
 /*! similar to comb with two inputs
  */
-template <typename T0, typename T1, typename T2>
-class comb2 : public sy_process
+template <typename T0, typename T1, typename T2,
+          typename FuncType = std::function<void(abst_ext<T0>&,
+                                                 const abst_ext<T1>&,
+                                                 const abst_ext<T2>&)>>
+class comb2 : public sy_process, public absent_skipping
 {
 public:
     SY_in<T1> iport1;        ///< port for the input channel 1
@@ -132,8 +278,7 @@ public:
     SY_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(abst_ext<T0>&, const abst_ext<T1>&,
-                                              const abst_ext<T2>&)> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -146,9 +291,7 @@ public:
               _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -156,9 +299,11 @@ public:
     std::string forsyde_kind() const {return "SY::comb2";}
 private:
     // Inputs and output variables
-    abst_ext<T0>* oval;
-    abst_ext<T1>* ival1;
-    abst_ext<T2>* ival2;
+    abst_ext<T0> oval;
+    abst_ext<T1> ival1;
+    abst_ext<T2> ival2;
+    // absent cycles skipped after the current one
+    size_t skipped = 0;
     
     //! The function passed to the process constructor
     functype _func;
@@ -166,32 +311,46 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new abst_ext<T0>;
-        ival1 = new abst_ext<T1>;
-        ival2 = new abst_ext<T2>;
     }
     
     void prep()
     {
-        *ival1 = iport1.read();
-        *ival2 = iport2.read();
+        iport1.read(ival1);
+        iport2.read(ival2);
     }
     
     void exec()
     {
-        _func(*oval, *ival1, *ival2);
+        if (skip_absent && is_absent(ival1) && is_absent(ival2))
+        {
+            set_abst(oval);
+            skipped = skip_absent_runs(iport1, iport2);
+        }
+        else
+            _func(oval, ival1, ival2);
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        if (skipped > 0)
+        {
+            write_absents_multiport<T0>(oport1, skipped+1);
+            skipped = 0;
+        }
+        else
+            write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival2;
-        delete ival1;
-        delete oval;
+    }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1), rule_port(iport2, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -209,7 +368,11 @@ private:
 //! Process constructor for a combinational process with three inputs and one output
 /*! similar to comb with three inputs
  */
-template <typename T0, typename T1, typename T2, typename T3>
+template <typename T0, typename T1, typename T2, typename T3,
+          typename FuncType = std::function<void(abst_ext<T0>&,
+                                                 const abst_ext<T1>&,
+                                                 const abst_ext<T2>&,
+                                                 const abst_ext<T3>&)>>
 class comb3 : public sy_process
 {
 public:
@@ -219,9 +382,7 @@ public:
     SY_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(abst_ext<T0>&, const abst_ext<T1>&,
-                                              const abst_ext<T2>&,
-                                              const abst_ext<T3>&)> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -234,9 +395,7 @@ public:
               oport1("oport1"), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -245,10 +404,10 @@ public:
     
 private:
     // Inputs and output variables
-    abst_ext<T0>* oval;
-    abst_ext<T1>* ival1;
-    abst_ext<T2>* ival2;
-    abst_ext<T3>* ival3;
+    abst_ext<T0> oval;
+    abst_ext<T1> ival1;
+    abst_ext<T2> ival2;
+    abst_ext<T3> ival3;
 
     //! The function passed to the process constructor
     functype _func;
@@ -256,35 +415,35 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new abst_ext<T0>;
-        ival1 = new abst_ext<T1>;
-        ival2 = new abst_ext<T2>;
-        ival3 = new abst_ext<T3>;
     }
     
     void prep()
     {
-        *ival1 = iport1.read();
-        *ival2 = iport2.read();
-        *ival3 = iport3.read();
+        iport1.read(ival1);
+        iport2.read(ival2);
+        iport3.read(ival3);
     }
     
     void exec()
     {
-        _func(*oval, *ival1, *ival2, *ival3);
+        _func(oval, ival1, ival2, ival3);
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival3;
-        delete ival2;
-        delete ival1;
-        delete oval;
+    }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1), rule_port(iport2, 1), rule_port(iport3, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -303,7 +462,12 @@ private:
 //! Process constructor for a combinational process with four inputs and one output
 /*! similar to comb with four inputs
  */
-template <typename T0, typename T1, typename T2, typename T3, typename T4>
+template <typename T0, typename T1, typename T2, typename T3, typename T4,
+          typename FuncType = std::function<void(abst_ext<T0>&,
+                                                 const abst_ext<T1>&,
+                                                 const abst_ext<T2>&,
+                                                 const abst_ext<T3>&,
+                                                 const abst_ext<T4>&)>>
 class comb4 : public sy_process
 {
 public:
@@ -314,10 +478,7 @@ public:
     SY_out<T0> oport1;        ///< port for the output channel
     
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(abst_ext<T0>&, const abst_ext<T1>&,
-                                             const abst_ext<T2>&,
-                                             const abst_ext<T3>&,
-                                             const abst_ext<T4>&)> functype;
+    typedef FuncType functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -330,9 +491,7 @@ public:
               iport3("iport3"), iport4("iport4"), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -341,11 +500,11 @@ public:
     
 private:
     // Inputs and output variables
-    abst_ext<T0>* oval;
-    abst_ext<T1>* ival1;
-    abst_ext<T2>* ival2;
-    abst_ext<T3>* ival3;
-    abst_ext<T4>* ival4;
+    abst_ext<T0> oval;
+    abst_ext<T1> ival1;
+    abst_ext<T2> ival2;
+    abst_ext<T3> ival3;
+    abst_ext<T4> ival4;
     
     //! The function passed to the process constructor
     functype _func;
@@ -353,38 +512,37 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new abst_ext<T0>;
-        ival1 = new abst_ext<T1>;
-        ival2 = new abst_ext<T2>;
-        ival3 = new abst_ext<T3>;
-        ival4 = new abst_ext<T4>;
     }
     
     void prep()
     {
-        *ival1 = iport1.read();
-        *ival2 = iport2.read();
-        *ival3 = iport3.read();
-        *ival4 = iport4.read();
+        iport1.read(ival1);
+        iport2.read(ival2);
+        iport3.read(ival3);
+        iport4.read(ival4);
     }
     
     void exec()
     {
-        _func(*oval, *ival1, *ival2, *ival3, *ival4);
+        _func(oval, ival1, ival2, ival3, ival4);
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival4;
-        delete ival3;
-        delete ival2;
-        delete ival1;
-        delete oval;
+    }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1), rule_port(iport2, 1),
+               rule_port(iport3, 1), rule_port(iport4, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -402,9 +560,12 @@ private:
 };
 
 //! Process constructor for a combinational process with an array of inputs and one output
-/*! similar to comb with an array of inputs
+/*! similar to comb with an array of inputs. The inputs are passed to the
+ * function as an AT, which can also be an abst_array<T1,N> to keep the
+ * values contiguous for vectorized functions.
  */
-template <typename T0, typename T1, std::size_t N>
+template <typename T0, typename T1, std::size_t N,
+          typename AT = std::array<abst_ext<T1>,N>>
 class combX : public sy_process
 {
 public:
@@ -412,7 +573,7 @@ public:
     SY_out<T0> oport1;        ///< port for the output channel
 
     //! Type of the function to be passed to the process constructor
-    typedef std::function<void(abst_ext<T0>&, const std::array<abst_ext<T1>,N>&)> functype;
+    typedef std::function<void(abst_ext<T0>&, const AT&)> functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
@@ -424,9 +585,7 @@ public:
           ) : sy_process(_name), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
@@ -435,8 +594,8 @@ public:
 
 private:
     // Inputs and output variables
-    abst_ext<T0>* oval;
-    std::array<abst_ext<T1>,N> ival;
+    abst_ext<T0> oval;
+    AT ival;
 
     //! The function passed to the process constructor
     functype _func;
@@ -444,30 +603,36 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new abst_ext<T0>;
     }
 
     void prep()
     {
     	for (size_t i=0; i<N; i++)
-    		ival[i] = iport[i].read();
+    		iport[i].read(ival[i]);
     }
 
     void exec()
     {
-        _func(*oval, ival);
+        _func(oval, ival);
     }
 
     void prod()
     {
-        write_multiport(oport1, *oval);
+        write_multiport(oport1, oval);
     }
 
     void clean()
     {
-        delete oval;
     }
 
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        for (size_t i=0; i<N; i++) ins.push_back(rule_port(iport[i], 1));
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -480,6 +645,178 @@ private:
 #endif
 };
 
+//! Process constructor for a combinational process with a vector input and one output
+/*! similar to combX, but the N lanes are read from a single vector
+ * signal, hence only one input port is registered in the SystemC kernel
+ * regardless of N. The vector signal carries AT tokens, which can also
+ * be abst_array<T1,N> ones.
+ */
+template <typename T0, typename T1, std::size_t N,
+          typename AT = std::array<abst_ext<T1>,N>>
+class combXV : public sy_process
+{
+public:
+    SY_in<AT> iport1;   ///< port for the input vector channel
+    SY_out<T0> oport1;        ///< port for the output channel
+
+    //! Type of the function to be passed to the process constructor
+    typedef typename combX<T0,T1,N,AT>::functype functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to its lanes and writes the
+     * results using the output port
+     */
+    combXV(const sc_module_name& _name,      ///< process name
+           const functype& _func             ///< function to be passed
+          ) : sy_process(_name), iport1("iport1"), oport1("oport1"), _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::combXV";}
+
+private:
+    // Inputs and output variables
+    abst_ext<T0> oval;
+    AT ival;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        auto ival_temp = iport1.read();
+        if (ival_temp.is_absent())
+            ival.fill(abst_ext<T1>());
+        else
+            ival = unsafe_from_abst_ext(std::move(ival_temp));
+    }
+
+    void exec()
+    {
+        _func(oval, ival);
+    }
+
+    void prod()
+    {
+        write_multiport(oport1, oval);
+    }
+
+    void clean()
+    {
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a lane-wise map over a vector signal
+/*! It replaces an unzipX, N comb processes and a zipX, which apply the
+ * same function to each lane, by a single process with one input and
+ * one output port. The function is also given the index of the lane.
+ */
+template <typename T0, typename T1, std::size_t N>
+class mapX : public sy_process
+{
+public:
+    SY_in<std::array<abst_ext<T1>,N>> iport1;   ///< port for the input vector channel
+    SY_out<std::array<abst_ext<T0>,N>> oport1;  ///< port for the output vector channel
+
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(abst_ext<T0>&, const abst_ext<T1>&, std::size_t)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to each lane and writes the
+     * results using the output port
+     */
+    mapX(const sc_module_name& _name,      ///< process name
+         const functype& _func             ///< function to be passed
+        ) : sy_process(_name), iport1("iport1"), oport1("oport1"), _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::mapX";}
+
+private:
+    // Inputs and output variables
+    abst_ext<std::array<abst_ext<T1>,N>> ival;
+    std::array<abst_ext<T0>,N> oval;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+    }
+
+    void prep()
+    {
+        iport1.read(ival);
+    }
+
+    void exec()
+    {
+        if (ival.is_absent())
+        {
+            const abst_ext<T1> absent;
+            for (size_t i=0; i<N; i++)
+                _func(oval[i], absent, i);
+        }
+        else
+        {
+            const auto& lanes = ival.unsafe_from_abst_ext();
+            for (size_t i=0; i<N; i++)
+                _func(oval[i], lanes[i], i);
+        }
+    }
+
+    void prod()
+    {
+        // similar to zipX, an all-absent vector is written as absent
+        typedef std::array<abst_ext<T0>,N> TT;
+        if (std::all_of(oval.begin(), oval.end(), [](const abst_ext<T0>& o){return o.is_absent();}))
+            write_multiport(oport1, abst_ext<TT>());
+        else
+            write_multiport(oport1, abst_ext<TT>(oval));
+    }
+
+    void clean()
+    {
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
 //! Process constructor for a combinational process with N inputs and one output
 /*! similar to comb with N inputs
  */
@@ -503,9 +840,7 @@ public:
           ) : sy_process(_name), oport1("oport1"), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -514,8 +849,8 @@ public:
     
 private:
     // Inputs and output variables
-    abst_ext<T0>* oval;
-    std::tuple<abst_ext<Ts>...>* ivals;
+    abst_ext<T0> oval;
+    std::tuple<abst_ext<Ts>...> ivals;
     
     //! The function passed to the process constructor
     functype _func;
@@ -523,33 +858,29 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new abst_ext<T0>;
-        ivals = new std::tuple<abst_ext<Ts>...>;
     }
     
     void prep()
     {
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
-                ((val = port.read()), ...);
-            }, *ivals);
+                (port.read(val), ...);
+            }, ivals);
         }, iport);
     }
     
     void exec()
     {
-        _func(*oval, *ivals);
+        _func(oval, ivals);
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ivals;
-        delete oval;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -585,6 +916,9 @@ public:
     //! Type of the function to be passed to the process constructor
     typedef std::function<void(std::tuple<abst_ext<TOs>...>&, const std::tuple<abst_ext<TIs>...>&)> functype;
 
+    //! Type of the function which takes the outputs and the inputs as separate arguments
+    typedef std::function<void(abst_ext<TOs>&..., const abst_ext<TIs>&...)> vfunctype;
+
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
      * applies the user-imlpemented function to them and writes the
@@ -595,9 +929,20 @@ public:
           ) : sy_process(_name), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
+#endif
+    }
+
+    //! The constructor with a function taking separate arguments
+    /*! The values are passed to the function directly from the
+     * in-object buffers of the process, without building the tuples.
+     */
+    combMN(const sc_module_name& _name,      ///< process name
+           const vfunctype& _vfunc           ///< function to be passed
+          ) : sy_process(_name), _vfunc(_vfunc)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -606,31 +951,37 @@ public:
     
 private:
     // Input and output variables
-    std::tuple<abst_ext<TOs>...>* ovals;
-    std::tuple<abst_ext<TIs>...>* ivals;
+    std::tuple<abst_ext<TOs>...> ovals;
+    std::tuple<abst_ext<TIs>...> ivals;
     
     //! The function passed to the process constructor
     functype _func;
+    vfunctype _vfunc;
 
     //Implementing the abstract semantics
     void init()
     {
-        ovals = new std::tuple<abst_ext<TOs>...>;
-        ivals = new std::tuple<abst_ext<TIs>...>;
     }
     
     void prep()
     {
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
-                ((val = port.read()), ...);
-            }, *ivals);
+                (port.read(val), ...);
+            }, ivals);
         }, iport);
     }
     
     void exec()
     {
-        _func(*ovals, *ivals);
+        if (_vfunc)
+            std::apply([&](auto&... oval) {
+                std::apply([&](const auto&... ival) {
+                    _vfunc(oval..., ival...);
+                }, ivals);
+            }, ovals);
+        else
+            _func(ovals, ivals);
     }
     
     void prod()
@@ -638,14 +989,12 @@ private:
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
                 (write_multiport(port, val), ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
     }
     
     void clean()
     {
-        delete ivals;
-        delete ovals;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -701,9 +1050,7 @@ public:
               init_val(init_val)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
+        add_arg("init_val", init_val);
 #endif
     }
     
@@ -715,31 +1062,39 @@ private:
     abst_ext<T> init_val;
     
     // Inputs and output variables
-    abst_ext<T>* val;
+    abst_ext<T> val;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new abst_ext<T>;
-        write_multiport(oport1, init_val);
+        // the initial token is restored with the signal
+        if (!is_restored()) write_multiport(oport1, init_val);
     }
     
     void prep()
     {
-        *val = iport1.read();
+        iport1.read(val);
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        write_multiport(oport1, val);
     }
     
     void clean()
     {
-        delete val;
     }
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -758,6 +1113,10 @@ private:
  * initial value n times at the the beginning of output stream and
  * passes the rest of the inputs to its output untouched. The class is
  * parameterized for its input/output data-type.
+ *
+ * Only the first initial value is written to the output signal, the
+ * last n-1 inputs are kept in a ring buffer inside the process, hence
+ * the signal does not need to hold n tokens.
  */
 template <class T>
 class delayn : public sy_process
@@ -778,12 +1137,8 @@ public:
               init_val(init_val), ns(n)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << n;
-        arg_vec.push_back(std::make_tuple("n", ss.str()));
+        add_arg("init_val", init_val);
+        add_arg("n", n);
 #endif
     }
     
@@ -796,32 +1151,45 @@ private:
     unsigned int ns;
     
     // Inputs and output variables
-    abst_ext<T>* val;
+    abst_ext<T> val;
+    // the delayed values which are not in the output signal yet
+    std::vector<abst_ext<T>> ring;
+    size_t pos;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new abst_ext<T>;
-        for (int i=0; i<ns; i++)
-            write_multiport(oport1, init_val);
+        ring.assign(ns > 0 ? ns-1 : 0, init_val);
+        pos = 0;
+        if (is_restored() || ns == 0) return;
+        write_multiport(oport1, init_val);
     }
     
     void prep()
     {
-        *val = iport1.read();
+        iport1.read(val);
     }
     
-    void exec() {}
+    void exec()
+    {
+        if (ring.empty()) return;
+        std::swap(val, ring[pos]);
+        if (++pos == ring.size()) pos = 0;
+    }
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        write_multiport(oport1, val);
     }
     
     void clean()
     {
-        delete val;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, ring, pos);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, ring, this->pos);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -833,13 +1201,112 @@ private:
 #endif
 };
 
+//! Process constructor for a tapped delay line
+/*! This class is used to build a chain of delay elements with a number
+ * of taps in a single process. Each output port k produces the input
+ * delayed by taps[k] cycles, where the first taps[k] values are the
+ * initial value, i.e., the same stream as a chain of taps[k] delay
+ * elements. All the taps should be at least one, so that the process
+ * can break feedback loops like a delay.
+ *
+ * The inputs are kept in a ring buffer of the length of the longest
+ * tap, and each cycle only writes one value to it and reads one value
+ * per tap.
+ */
+template <class T, std::size_t N>
+class delayline : public sy_process
+{
+public:
+    SY_in<T>  iport1;               ///< port for the input channel
+    std::array<SY_out<T>,N> oport;  ///< port array for the taps
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which inserts the initial elements,
+     * reads data from its input port, and writes the delayed values
+     * using the output ports.
+     */
+    delayline(const sc_module_name& _name,      ///< process name
+              const abst_ext<T>& init_val,      ///< initial value
+              const std::array<unsigned int,N>& taps ///< delays of the output ports
+             ) : sy_process(_name), iport1("iport1"),
+                 init_val(init_val), taps(taps)
+    {
+        for (auto k : taps)
+            if (k == 0)
+                SC_REPORT_ERROR(name(), "the taps of a delay line should be at least one");
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("init_val", init_val);
+        for (size_t i=0; i<N; i++)
+            add_arg(("tap" + std::to_string(i)).c_str(), taps[i]);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::delayline";}
+    
+private:
+    // Initial value
+    abst_ext<T> init_val;
+    std::array<unsigned int,N> taps;
+    
+    // the last inputs, the next one is written at pos
+    std::vector<abst_ext<T>> ring;
+    size_t pos;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        ring.assign(*std::max_element(taps.begin(), taps.end()), init_val);
+        pos = 0;
+        if (is_restored()) return;
+        for (size_t i=0; i<N; i++)
+            write_multiport(oport[i], init_val);
+    }
+    
+    void prep()
+    {
+        iport1.read(ring[pos]);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        // the value of tap k in the next cycle is the input of k-1 cycles ago
+        const size_t next = pos + 1;
+        for (size_t i=0; i<N; i++)
+            write_multiport(oport[i], ring[next >= taps[i] ? next - taps[i]
+                                                           : next + ring.size() - taps[i]]);
+        pos = next == ring.size() ? 0 : next;
+    }
+    
+    void clean()
+    {
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, ring, pos);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, ring, this->pos);}
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(N);    // output ports
+        for (size_t i=0;i<N;i++)
+            boundOutChans[i].port = &oport[i];
+    }
+#endif
+};
+
 //! Process constructor for a Moore machine
 /*! This class is used to build a finite state machine of type Moore.
  * Given an initial state, a next-state function, and an output decoding
  * function it creates a Moore process.
  */
 template <class IT, class ST, class OT>
-class moore : public sy_process
+class moore : public sy_process, public absent_skipping
 {
 public:
     SY_in<IT>  iport1;        ///< port for the input channel
@@ -864,13 +1331,9 @@ public:
               init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -887,19 +1350,17 @@ private:
     bool first_run;
     
     // Input, output, current state, and next state variables
-    abst_ext<IT>* ival;
-    ST* stval;
-    ST* nsval;
-    abst_ext<OT>* oval;
+    abst_ext<IT> ival;
+    ST stval;
+    ST nsval;
+    abst_ext<OT> oval;
+    // absent cycles skipped after the current one
+    size_t skipped = 0;
 
     //Implementing the abstract semantics
     void init()
     {
-        ival = new abst_ext<IT>;
-        stval = new ST;
-        *stval = init_st;
-        nsval = new ST;
-        oval = new abst_ext<OT>;
+        stval = init_st;
         // First evaluation cycle
         first_run = true;
     }
@@ -907,33 +1368,46 @@ private:
     void prep()
     {
         if (!first_run)
-            *ival = iport1.read();
+            iport1.read(ival);
     }
     
     void exec()
     {
         if (first_run)
             first_run = false;
+        else if (skip_absent && is_absent(ival))
+        {
+            set_abst(oval);
+            skipped = skip_absent_runs(iport1);
+            return;
+        }
         else
         {
-            _ns_func(*nsval, *stval, *ival);
-            *stval = *nsval;
+            _ns_func(nsval, stval, ival);
+            stval = nsval;
         }
-        _od_func(*oval, *stval);
+        _od_func(oval, stval);
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        if (skipped > 0)
+        {
+            write_absents_multiport<OT>(oport1, skipped+1);
+            skipped = 0;
+        }
+        else
+            write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival;
-        delete stval;
-        delete nsval;
-        delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, stval, first_run);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, stval, first_run);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -951,7 +1425,7 @@ private:
  * function it creates a Mealy process.
  */
 template <class IT, class ST, class OT>
-class mealy : public sy_process
+class mealy : public sy_process, public absent_skipping
 {
 public:
     SY_in<IT>  iport1;        ///< port for the input channel
@@ -978,13 +1452,9 @@ public:
               init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -999,45 +1469,56 @@ private:
     ST init_st;
     
     // Input, output, current state, and next state variables
-    abst_ext<IT>* ival;
-    ST* stval;
-    ST* nsval;
-    abst_ext<OT>* oval;
+    abst_ext<IT> ival;
+    ST stval;
+    ST nsval;
+    abst_ext<OT> oval;
+    // absent cycles skipped after the current one
+    size_t skipped = 0;
 
     //Implementing the abstract semantics
     void init()
     {
-        ival = new abst_ext<IT>;
-        stval = new ST;
-        *stval = init_st;
-        nsval = new ST;
-        oval = new abst_ext<OT>;
+        stval = init_st;
     }
     
     void prep()
     {
-        *ival = iport1.read();
+        iport1.read(ival);
     }
     
     void exec()
     {
-        _od_func(*oval, *stval, *ival);
-        _ns_func(*nsval, *stval, *ival);
-        *stval = *nsval;
+        if (skip_absent && is_absent(ival))
+        {
+            set_abst(oval);
+            skipped = skip_absent_runs(iport1);
+            return;
+        }
+        _od_func(oval, stval, ival);
+        _ns_func(nsval, stval, ival);
+        stval = nsval;
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        if (skipped > 0)
+        {
+            write_absents_multiport<OT>(oport1, skipped+1);
+            skipped = 0;
+        }
+        else
+            write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival;
-        delete stval;
-        delete nsval;
-        delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, stval);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, stval);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1070,9 +1551,7 @@ public:
          ) : sy_process(_name), def_val(def_val)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << def_val;
-        arg_vec.push_back(std::make_tuple("def_val", ss.str()));
+        add_arg("def_val", def_val);
 #endif
     }
     
@@ -1084,35 +1563,31 @@ private:
     T def_val;
     
     // Inputs and output variables
-    abst_ext<T>* ival;
-    abst_ext<T>* oval;
+    abst_ext<T> ival;
+    abst_ext<T> oval;
 
     //Implementing the abstract semantics
     void init()
     {
-        ival = new abst_ext<T>;
-        oval = new abst_ext<T>;
     }
     
     void prep()
     {
-        *ival = iport1.read();
+        iport1.read(ival);
     }
     
     void exec()
     {
-        *oval = abst_ext<T>(ival->from_abst_ext(def_val));
+        oval = abst_ext<T>(ival.from_abst_ext(def_val));
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival;
-        delete oval;
     }
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -1147,9 +1622,7 @@ public:
          ) : sy_process(_name), def_val(def_val)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << def_val;
-        arg_vec.push_back(std::make_tuple("def_val", ss.str()));
+        add_arg("def_val", def_val);
 #endif
     }
     
@@ -1161,37 +1634,38 @@ private:
     T def_val;
     
     // Input and default output variables
-    abst_ext<T>* ival;
-    abst_ext<T>* oval;
+    abst_ext<T> ival;
+    abst_ext<T> oval;
 
     //Implementing the abstract semantics
     void init()
     {
-        ival = new abst_ext<T>;
-        oval = new abst_ext<T>;
-        *oval = abst_ext<T>(def_val);
+        oval = abst_ext<T>(def_val);
     }
     
     void prep()
     {
-        *ival = iport1.read();
+        iport1.read(ival);
     }
     
     void exec()
     {
-        *oval = ival->is_present() ? *ival : *oval;
+        oval = ival.is_present() ? ival : oval;
     }
     
     void prod()
     {
-        write_multiport(oport1, *oval);
+        write_multiport(oport1, oval);
     }
     
     void clean()
     {
-        delete ival;
-        delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, oval);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, oval);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1210,7 +1684,7 @@ private:
  * This class can directly be instantiated to build a process.
  */
 template <class T>
-class constant : public sy_process
+class constant : public sy_process, public constant_source
 {
 public:
     SY_out<T> oport1;            ///< port for the output channel
@@ -1227,17 +1701,22 @@ public:
                  
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SY::constant";}
+
+    //! Checks if the process produces its tokens forever
+    bool is_endless() const {return take == 0;}
+
+    //! Changes the output value
+    /*! It can be called while the simulation is paused, e.g., in a branch
+     * of a parameter sweep.
+     */
+    void set_value(const abst_ext<T>& val) {init_val = val;}
     
 private:
     abst_ext<T> init_val;
@@ -1266,6 +1745,11 @@ private:
     
     void clean() {}
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1302,18 +1786,18 @@ public:
               init_st(init_val), take(take), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
+    //! Computes the next states in blocks in a background thread
+    /*! The function should only depend on the state (see
+     * state_prefetcher). It should be called before the simulation starts.
+     */
+    void set_prefetch(size_t block=256) {pf_block = block;}
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SY::source";}
     
@@ -1321,19 +1805,22 @@ private:
     abst_ext<T> init_st;        // The current state
     unsigned long long take;    // Number of tokens produced
     
-    abst_ext<T>* cur_st;        // The current state of the process
+    abst_ext<T> cur_st;        // The current state of the process
     unsigned long long tok_cnt;
     bool infinite;
     
     //! The function passed to the process constructor
     functype _func;
+
+    // the block size and the generator of the prefetched states, if any
+    size_t pf_block = 0;
+    std::unique_ptr<state_prefetcher<abst_ext<T>>> pf;
     
     //Implementing the abstract semantics
     void init()
     {
-        cur_st = new abst_ext<T>;
-        *cur_st = init_st;
-        write_multiport(oport1, *cur_st);
+        cur_st = init_st;
+        if (!is_restored()) write_multiport(oport1, cur_st);
         infinite = take==0 ? true : false;
         tok_cnt = 1;
     }
@@ -1342,21 +1829,141 @@ private:
     
     void exec()
     {
-        _func(*cur_st, *cur_st);
+        if (pf_block == 0)
+        {
+            _func(cur_st, cur_st);
+            return;
+        }
+        if (!pf)
+            pf.reset(new state_prefetcher<abst_ext<T>>(_func, cur_st, pf_block,
+                                                       take == 0 ? 0 : take - tok_cnt + 1));
+        pf->next(cur_st);
     }
     
     void prod()
     {
         if (tok_cnt++ < take || infinite)
-            write_multiport(oport1, *cur_st);
+            write_multiport(oport1, cur_st);
         else wait();
     }
     
-    void clean()
+    void clean()
+    {
+        pf.reset();
+    }
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, cur_st, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, cur_st, tok_cnt);}
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a file_source process
+/*! This class is used to build a souce process which only has an output.
+ * Given a file name and a function, the process repeatedly reads lines
+ * from the text file and applies the function to convert it to a value
+ * which will be written to the output.
+ * It can be used in test-benches.
+ */
+template <class T>
+class file_source : public sy_process
+{
+public:
+    SY_out<T> oport1;        ///< port for the output channel
+    
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(abst_ext<T>&, const std::string&)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which runs the user-imlpemented function
+     * and writes the result using the output port
+     */
+    file_source(sc_module_name _name,   ///< process name
+           functype _func,              ///< function to be passed
+           std::string file_name        ///< the file name
+          ) : sy_process(_name), oport1("oport1"),
+              file_name(file_name), _func(_func)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        arg_vec.push_back(std::make_tuple("file_name", file_name));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::file_source";}
+    
+private:
+    std::string file_name;
+    
+    std::string cur_str;        // The current string read from the input
+    std::ifstream ifs;
+    std::vector<char> ibuf;     // The stream buffer of the input
+    abst_ext<T> cur_val;
+    
+    //! The function passed to the process constructor
+    functype _func;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        // a large buffer, which must be set before opening
+        ibuf.resize(FORSYDE_FILE_BUFFER);
+        ifs.rdbuf()->pubsetbuf(ibuf.data(), ibuf.size());
+        ifs.open(file_name);
+        if (!ifs.is_open())
+        {
+            SC_REPORT_ERROR(name(),"cannot open the file.");
+        }
+    }
+    
+    void prep()
+    {
+        if (!getline(ifs,cur_str))
+        {
+            wait();
+        }
+    }
+    
+    void exec()
+    {
+        _func(cur_val, cur_str);
+    }
+    
+    void prod()
+    {
+        write_multiport(oport1, cur_val);
+    }
+    
+    void clean()
+    {
+        ifs.close();
+    }
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
     {
-        delete cur_st;
+        serializer<std::int64_t>::write(buf, std::int64_t(ifs.tellg()));
     }
     
+    void restore_state(const char*& pos)
+    {
+        std::int64_t off;
+        serializer<std::int64_t>::read(pos, off);
+        if (off < 0)
+            ifs.seekg(0, std::ios::end);
+        else
+            ifs.seekg(off);
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1366,67 +1973,62 @@ private:
 #endif
 };
 
-//! Process constructor for a file_source process
+//! Process constructor for a binary file source process
 /*! This class is used to build a souce process which only has an output.
- * Given a file name and a function, the process repeatedly reads lines
- * from the text file and applies the function to convert it to a value
- * which will be written to the output.
- * It can be used in test-benches.
+ * The input file is an array of values of type T in the host
+ * representation, which should be trivially copyable. The file is mapped
+ * into the memory and one value is written to the output in each
+ * evaluation cycle, without parsing the file or copying it into buffers.
+ * It can be used in test-benches with large stimulus files.
  */
 template <class T>
-class file_source : public sy_process
+class binary_file_source : public sy_process
 {
 public:
     SY_out<T> oport1;        ///< port for the output channel
-    
-    //! Type of the function to be passed to the process constructor
-    typedef std::function<void(abst_ext<T>&, const std::string&)> functype;
 
     //! The constructor requires the module name
-    /*! It creates an SC_THREAD which runs the user-imlpemented function
-     * and writes the result using the output port
+    /*! It creates an SC_THREAD which writes the values of the file using
+     * the output port
      */
-    file_source(sc_module_name _name,   ///< process name
-           functype _func,              ///< function to be passed
-           std::string file_name        ///< the file name
-          ) : sy_process(_name), oport1("oport1"),
-              file_name(file_name), _func(_func)
+    binary_file_source(sc_module_name _name,   ///< process name
+                       std::string file_name   ///< the file name
+                      ) : sy_process(_name), oport1("oport1"),
+                          file_name(file_name)
     {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "the values of a binary file should be trivially copyable");
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
         arg_vec.push_back(std::make_tuple("file_name", file_name));
 #endif
     }
     
     //! Specifying from which process constructor is the module built
-    std::string forsyde_kind() const {return "SY::file_source";}
+    std::string forsyde_kind() const {return "SY::binary_file_source";}
     
 private:
     std::string file_name;
     
-    std::string cur_str;        // The current string read from the input
-    std::ifstream ifs;
-    abst_ext<T>* cur_val;
-    
-    //! The function passed to the process constructor
-    functype _func;
+    mapped_file mfile;
+    const T* vals;          // The values in the mapped file
+    size_t count, pos;      // The number of values and the current one
+    abst_ext<T> cur_val;
     
     //Implementing the abstract semantics
     void init()
     {
-        cur_val = new abst_ext<T>;
-        ifs.open(file_name);
-        if (!ifs.is_open())
+        if (!mfile.open(file_name))
         {
             SC_REPORT_ERROR(name(),"cannot open the file.");
         }
+        vals = reinterpret_cast<const T*>(mfile.data());
+        count = mfile.size() / sizeof(T);
+        pos = 0;
     }
     
     void prep()
     {
-        if (!getline(ifs,cur_str))
+        if (pos == count)
         {
             wait();
         }
@@ -1434,20 +2036,24 @@ private:
     
     void exec()
     {
-        _func(*cur_val, cur_str);
+        cur_val = vals[pos++];
     }
     
     void prod()
     {
-        write_multiport(oport1, *cur_val);
+        write_multiport(oport1, cur_val);
     }
     
     void clean()
     {
-        ifs.close();
-        delete cur_val;
+        mfile.close();
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, this->pos);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, this->pos);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1477,9 +2083,7 @@ public:
             ) : sy_process(_name), in_vec(in_vec)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << in_vec;
-        arg_vec.push_back(std::make_tuple("in_vec", ss.str()));
+        add_arg("in_vec", in_vec);
 #endif
     }
     
@@ -1504,16 +2108,96 @@ private:
     void prod()
     {
         if (tok_cnt < in_vec.size())
-        {
-            write_multiport(oport1, in_vec[tok_cnt]);
-            tok_cnt++;
-        }
+            write_multiport(oport1, in_vec[tok_cnt++]);
+        else
+            wait();
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a source process with streamed input
+/*! This class is used to build a souce process which only has an output.
+ * It outputs the values of a token_stream, one value on each evaluation
+ * cycle, like vsource does for the values of a vector. The values are
+ * pulled from the stream in chunks, hence the stimulus is never kept
+ * in the memory as a whole.
+ */
+template <class T>
+class stream_source : public sy_process
+{
+public:
+    SY_out<T> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the result using the output
+     * port.
+     */
+    stream_source(const sc_module_name& _name,              ///< process name
+                  std::shared_ptr<token_stream<T>> stream   ///< the stimulus stream
+                  ) : sy_process(_name), reader(stream)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("stream", reader.describe()));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::stream_source";}
+    
+private:
+    stream_reader<T> reader;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!reader.good())
+            SC_REPORT_ERROR(name(),"cannot read the stream.");
+        if (!reader.seek(0))
+            SC_REPORT_ERROR(name(),"the stream can not be rewound.");
+    }
+    
+    void prep() {}
+    
+    void exec() {}
+    
+    void prod()
+    {
+        if (auto val = reader.next())
+            write_multiport(oport1, abst_ext<T>(*val));
         else
             wait();
     }
     
     void clean() {}
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        save_values(buf, std::uint64_t(reader.position()));
+    }
+    
+    void restore_state(const char*& pos)
+    {
+        std::uint64_t i;
+        restore_values(pos, i);
+        if (!reader.seek(i))
+            SC_REPORT_ERROR(name(),"the stream can not be moved to the checkpoint.");
+    }
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1547,42 +2231,55 @@ public:
             
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
+    //! Runs the function in a background thread instead of the simulation thread
+    /*! The tokens are passed to the thread through a bounded queue with
+     * the given capacity and policy (see async_consumer). It should be
+     * called before the simulation starts.
+     */
+    void set_async(size_t capacity=1024, async_backpressure policy=ASYNC_BLOCK)
+    {
+        async.reset(new async_consumer<abst_ext<T>>(this->name(), _func, capacity, policy));
+    }
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SY::sink";}
     
 private:
-    abst_ext<T>* val;         // The current state of the process
+    abst_ext<T> val;         // The current state of the process
 
     //! The function passed to the process constructor
     functype _func;
+
+    // the background consumer of the tokens, if any
+    std::unique_ptr<async_consumer<abst_ext<T>>> async;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new abst_ext<T>;
     }
     
     void prep()
     {
-        *val = iport1.read();
+        iport1.read(val);
     }
     
     void exec()
     {
-        _func(*val);
+        if (async)
+            async->push(val);
+        else
+            _func(val);
     }
     
     void prod() {}
     
     void clean()
     {
-        delete val;
+        if (async) async->flush();
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1621,9 +2318,7 @@ public:
             
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
         arg_vec.push_back(std::make_tuple("file_name", file_name));
 #endif
     }
@@ -1635,8 +2330,8 @@ private:
     std::string file_name;
     
     std::string ostr;        // The current string to be written to the output
-    std::ofstream ofs;
-    abst_ext<T>* cur_val;         // The current state of the process
+    async_file_writer writer;
+    abst_ext<T> cur_val;         // The current state of the process
 
     //! The function passed to the process constructor
     functype _func;
@@ -1644,9 +2339,7 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        cur_val = new abst_ext<T>;
-        ofs.open(file_name);
-        if (!ofs.is_open())
+        if (!writer.open(file_name))
         {
             SC_REPORT_ERROR(name(),"cannot open the file.");
         }
@@ -1654,23 +2347,100 @@ private:
     
     void prep()
     {
-        *cur_val = iport1.read();
+        iport1.read(cur_val);
     }
     
     void exec()
     {
-        _func(ostr, *cur_val);
+        _func(ostr, cur_val);
+    }
+    
+    void prod()
+    {
+        writer.write_line(ostr);
+    }
+    
+    void clean()
+    {
+        writer.close();
+        if (writer.has_failed())
+            SC_REPORT_WARNING(name(),"writing to the file has failed.");
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);    // only one output port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for a binary file sink process
+/*! This class is used to build a sink process which only has an input.
+ * The present input values are appended to the output file in the host
+ * representation, hence it can be read by binary_file_source, and the
+ * absent ones are skipped. The file is written by a separate thread
+ * using large blocks. T should be trivially copyable.
+ */
+template <class T>
+class binary_file_sink : public sy_process
+{
+public:
+    SY_in<T> iport1;         ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the input values to the
+     * file in each cycle.
+     */
+    binary_file_sink(sc_module_name _name,  ///< process name
+                     std::string file_name  ///< the file name
+                    ) : sy_process(_name), iport1("iport1"),
+                        file_name(file_name)
+    {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "the values of a binary file should be trivially copyable");
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("file_name", file_name));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::binary_file_sink";}
+    
+private:
+    std::string file_name;
+    
+    async_file_writer writer;
+    abst_ext<T> cur_val;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!writer.open(file_name))
+        {
+            SC_REPORT_ERROR(name(),"cannot open the file.");
+        }
+    }
+    
+    void prep()
+    {
+        iport1.read(cur_val);
     }
     
+    void exec() {}
+    
     void prod()
     {
-        ofs << ostr << std::endl;
+        if (is_present(cur_val))
+            writer.write(&unsafe_from_abst_ext(cur_val), sizeof(T));
     }
     
     void clean()
     {
-        ofs.close();
-        delete cur_val;
+        writer.close();
+        if (writer.has_failed())
+            SC_REPORT_WARNING(name(),"writing to the file has failed.");
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1707,19 +2477,17 @@ public:
     
 private:
     // intermediate values
-    abst_ext<T1>* ival1;
-    abst_ext<T2>* ival2;
+    abst_ext<T1> ival1;
+    abst_ext<T2> ival2;
     
     void init()
     {
-        ival1 = new abst_ext<T1>;
-        ival2 = new abst_ext<T2>;
     }
     
     void prep()
     {
-        *ival1 = iport1.read();
-        *ival2 = iport2.read();
+        iport1.read(ival1);
+        iport2.read(ival2);
     }
     
     void exec() {}
@@ -1727,22 +2495,20 @@ private:
     void prod()
     {
         typedef std::tuple<abst_ext<T1>,abst_ext<T2>> TT;
-        if (ival1->is_absent() && ival2->is_absent())
+        if (ival1.is_absent() && ival2.is_absent())
         {
             
             write_multiport(oport1,abst_ext<TT>());  // write to the output 1
         }
         else
         {
-            abst_ext<TT> oval(std::make_tuple(*ival1,*ival2));
+            abst_ext<TT> oval(std::make_tuple(ival1,ival2));
             write_multiport(oport1,oval);  // write to the output
         }
     }
     
     void clean()
     {
-        delete ival1;
-        delete ival2;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1758,14 +2524,15 @@ private:
 };
 
 //! The zipX process with an array of inputs and one output
-/*! This process "zips" an array of incoming signals into one signal of arrays.
+/*! This process "zips" an array of incoming signals into one signal of
+ * arrays, which can also be abst_array<T1,N> ones.
  */
-template <class T1, std::size_t N>
+template <class T1, std::size_t N, class AT = std::array<abst_ext<T1>,N>>
 class zipX : public sy_process
 {
 public:
     std::array<SY_in<T1>,N> iport;              ///< port array for the input channels
-    SY_out<std::array<abst_ext<T1>,N>> oport1;  ///< port for the output channel
+    SY_out<AT> oport1;                          ///< port for the output channel
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -1781,28 +2548,30 @@ public:
     
 private:
     // intermediate values
-    std::array<abst_ext<T1>,N> ival;
+    AT ival;
     
     void init() {}
     
     void prep()
     {
         for (size_t i=0; i<N; i++)
-            ival[i] = iport[i].read();
+            iport[i].read(ival[i]);
     }
     
     void exec() {}
     
     void prod()
     {
-        typedef std::array<abst_ext<T1>,N> TT;
-        if (std::all_of(ival.begin(), ival.end(), [](abst_ext<T1> ivalx){return ivalx.is_absent();}))
+        bool all_absent = true;
+        for (size_t i=0; i<N && all_absent; i++)
+            all_absent = ival[i].is_absent();
+        if (all_absent)
         {
-            write_multiport(oport1,abst_ext<TT>());  // write to the output 1
+            write_multiport(oport1,abst_ext<AT>());  // write to the output 1
         }
         else
         {
-            write_multiport(oport1,abst_ext<TT>(ival));  // write to the output
+            write_multiport(oport1,abst_ext<AT>(ival));  // write to the output
         }
     }
     
@@ -1843,19 +2612,18 @@ public:
     std::string forsyde_kind() const {return "SY::zipN";}
 private:
     // intermediate values
-    std::tuple<abst_ext<Ts>...>* in_vals;
+    std::tuple<abst_ext<Ts>...> in_vals;
     
     void init()
     {
-        in_vals = new std::tuple<abst_ext<Ts>...>;
     }
     
     void prep()
     {
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
-                ((val = port.read()), ...);
-            }, *in_vals);
+                (port.read(val), ...);
+            }, in_vals);
         }, iport);
     }
     
@@ -1863,12 +2631,11 @@ private:
     
     void prod()
     {
-        write_multiport(oport1,abst_ext<std::tuple<abst_ext<Ts>...>>(*in_vals));    // write to the output
+        write_multiport(oport1,abst_ext<std::tuple<abst_ext<Ts>...>>(in_vals));    // write to the output
     }
     
     void clean()
     {
-        delete in_vals;
     }
 
  #ifdef FORSYDE_INTROSPECTION
@@ -1913,37 +2680,35 @@ public:
     std::string forsyde_kind() const {return "SY::unzip";}
 private:
     // intermediate values
-    abst_ext<std::tuple<abst_ext<T1>,abst_ext<T2>>>* in_val;
+    abst_ext<std::tuple<abst_ext<T1>,abst_ext<T2>>> in_val;
     
     void init()
     {
-        in_val = new abst_ext<std::tuple<abst_ext<T1>,abst_ext<T2>>>;
     }
     
     void prep()
     {
-        *in_val = iport1.read();
+        iport1.read(in_val);
     }
     
     void exec() {}
     
     void prod()
     {
-        if (in_val->is_absent())
+        if (in_val.is_absent())
         {
             write_multiport(oport1,abst_ext<T1>());  // write to the output 1
             write_multiport(oport2,abst_ext<T2>());  // write to the output 2
         }
         else
         {
-            write_multiport(oport1,abst_ext<T1>(std::get<0>(in_val->unsafe_from_abst_ext())));  // write to the output 1
-            write_multiport(oport2,abst_ext<T2>(std::get<1>(in_val->unsafe_from_abst_ext())));  // write to the output 2
+            write_multiport(oport1,abst_ext<T1>(std::get<0>(in_val.unsafe_from_abst_ext())));  // write to the output 1
+            write_multiport(oport2,abst_ext<T2>(std::get<1>(in_val.unsafe_from_abst_ext())));  // write to the output 2
         }
     }
     
     void clean()
     {
-        delete in_val;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1959,13 +2724,14 @@ private:
 };
 
 //! The unzipX process with one input and an array of outputs
-/*! This process "unzips" a signal of arrays into an array of separate signals
+/*! This process "unzips" a signal of arrays, which can also be
+ * abst_array<T1,N> ones, into an array of separate signals
  */
-template <class T1, std::size_t N>
+template <class T1, std::size_t N, class AT = std::array<abst_ext<T1>,N>>
 class unzipX : public sy_process
 {
 public:
-    SY_in<std::array<abst_ext<T1>,N>> iport1;///< port for the input channel
+    SY_in<AT> iport1;///< port for the input channel
     std::array<SY_out<T1>,N> oport;///< port array for the output channels
 
     //! The constructor requires the module name
@@ -1981,23 +2747,22 @@ public:
     std::string forsyde_kind() const {return "SY::unzipX";}
 private:
     // intermediate values
-    abst_ext<std::array<abst_ext<T1>,N>>* in_val;
+    abst_ext<AT> in_val;
     
     void init()
     {
-        in_val = new abst_ext<std::array<abst_ext<T1>,N>>;
     }
     
     void prep()
     {
-        *in_val = iport1.read();
+        iport1.read(in_val);
     }
     
     void exec() {}
     
     void prod()
     {
-        if (in_val->is_absent())
+        if (in_val.is_absent())
         {
             for (size_t i=0; i<N; i++)
                 write_multiport(oport[i],abst_ext<T1>());  // write to the output i
@@ -2005,13 +2770,12 @@ private:
         else
         {
             for (size_t i=0; i<N; i++)
-                write_multiport(oport[i],abst_ext<T1>(in_val->unsafe_from_abst_ext()[i]));  // write to the output i
+                write_multiport(oport[i],abst_ext<T1>(in_val.unsafe_from_abst_ext()[i]));  // write to the output i
         }
     }
     
     void clean()
     {
-        delete in_val;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -2049,36 +2813,34 @@ public:
     std::string forsyde_kind() const {return "SY::unzipN";}
 private:
     // intermediate values
-    abst_ext<std::tuple<abst_ext<Ts>...>>* in_val;
+    abst_ext<std::tuple<abst_ext<Ts>...>> in_val;
     
     void init()
     {
-        in_val = new abst_ext<std::tuple<abst_ext<Ts>...>>;
     }
     
     void prep()
     {
-        *in_val = iport1.read();
+        iport1.read(in_val);
     }
     
     void exec() {}
     
     void prod()
     {
-        if (in_val->is_absent())
+        if (in_val.is_absent())
         {
             std::tuple<abst_ext<Ts>...> all_abs;
             fifo_tuple_write<Ts...>(all_abs, oport);
         }
         else
         {
-            fifo_tuple_write<Ts...>(in_val->unsafe_from_abst_ext(), oport);
+            fifo_tuple_write<Ts...>(in_val.unsafe_from_abst_ext(), oport);
         }
     }
     
     void clean()
     {
-        delete in_val;
     }
     
     template<size_t N,class R,  class T>
@@ -2151,9 +2913,7 @@ public:
          :sy_process(_name), samples(samples)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << samples;
-        arg_vec.push_back(std::make_tuple("samples", ss.str()));
+        add_arg("samples", samples);
 #endif
     }
     
@@ -2167,19 +2927,20 @@ private:
     unsigned long samples_took;
     
     // The output vector
-    std::vector<abst_ext<T>>* oval;
+    std::vector<abst_ext<T>> oval;
+    // The output token, whose storage is reused by the next groups
+    abst_ext<std::vector<abst_ext<T>>> otok;
     
     //Implementing the abstract semantics
     void init()
     {
-        oval = new std::vector<abst_ext<T>>;
-        oval->resize(samples);
+        oval.resize(samples);
         samples_took = 0;
     }
     
     void prep()
     {
-        (*oval)[samples_took] = iport1.read();
+        iport1.read(oval[samples_took]);
         samples_took++;
     }
     
@@ -2189,7 +2950,8 @@ private:
     {
         if (samples_took==samples)
         {
-            write_multiport(oport1, abst_ext<std::vector<abst_ext<T>>>(*oval));
+            otok.set_val(oval);
+            write_multiport(oport1, otok);
             samples_took = 0;
         }
         else
@@ -2198,7 +2960,6 @@ private:
     
     void clean()
     {
-        delete oval;
     }
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -2211,6 +2972,184 @@ private:
 #endif
 };
 
+//! The interface of the SY processes which connect two clock domains
+/*! A domain interface reads and writes different numbers of tokens in
+ * each firing, which relates the rates of the processes on its two
+ * sides (see multiclock_executive).
+ */
+class domain_interface
+{
+public:
+    //! The tokens read from the input in each firing
+    virtual unsigned int in_toks() const = 0;
+    
+    //! The tokens written to the output in each firing
+    virtual unsigned int out_toks() const = 0;
+};
+
+//! Process constructor for a domain interface to a faster clock domain
+/*! This class is used to pass a signal to a clock domain which ticks
+ * factor times faster. Each input token is followed by factor-1 absent
+ * tokens at the output, or by factor-1 copies of it if it is held.
+ */
+template <class T>
+class upsample : public sy_process, public domain_interface
+{
+public:
+    SY_in<T>  iport1;       ///< port for the input channel
+    SY_out<T> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name and the rate factor
+    upsample(const sc_module_name& _name,   ///< process name
+             unsigned int factor,           ///< the rate factor
+             bool hold=false                ///< repeat the input instead of absents
+             ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+                 factor(factor), hold(hold)
+    {
+        if (factor == 0)
+            SC_REPORT_ERROR(name(), "the rate factor should be positive");
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("factor", factor);
+        add_arg("hold", hold);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::upsample";}
+    
+    unsigned int in_toks() const {return 1;}
+    
+    unsigned int out_toks() const {return factor;}
+    
+private:
+    // The rate factor
+    unsigned int factor;
+    // Whether the input is repeated
+    bool hold;
+    
+    // Inputs and output variables
+    abst_ext<T> val;
+    
+    //Implementing the abstract semantics
+    void init() {}
+    
+    void prep()
+    {
+        iport1.read(val);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, val);
+        const abst_ext<T> fill = hold ? val : abst_ext<T>();
+        for (unsigned int k=1; k<factor; k++) write_multiport(oport1, fill);
+    }
+    
+    void clean() {}
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, 1)};
+        outs = {rule_port(oport1, factor)};
+        return true;
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a domain interface to a slower clock domain
+/*! This class is used to pass a signal to a clock domain which ticks
+ * factor times slower. Of each factor input tokens, the one at the given
+ * phase is written to the output.
+ */
+template <class T>
+class downsample : public sy_process, public domain_interface
+{
+public:
+    SY_in<T>  iport1;       ///< port for the input channel
+    SY_out<T> oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name and the rate factor
+    downsample(const sc_module_name& _name, ///< process name
+               unsigned int factor,         ///< the rate factor
+               unsigned int phase=0         ///< the input token which is kept
+               ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+                   factor(factor), phase(phase)
+    {
+        if (phase >= factor)
+            SC_REPORT_ERROR(name(), "the phase should be less than the rate factor");
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("factor", factor);
+        add_arg("phase", phase);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::downsample";}
+    
+    unsigned int in_toks() const {return factor;}
+    
+    unsigned int out_toks() const {return 1;}
+    
+private:
+    // The rate factor
+    unsigned int factor;
+    // The index of the kept token in each group of inputs
+    unsigned int phase;
+    
+    // Inputs variables
+    std::vector<abst_ext<T>> vals;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        vals.resize(factor);
+    }
+    
+    void prep()
+    {
+        iport1.read_n(vals, factor);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, vals[phase]);
+    }
+    
+    void clean() {}
+    
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        ins = {rule_port(iport1, factor)};
+        outs = {rule_port(oport1, 1)};
+        return true;
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
 //! Process constructor for a fan-out process with one input and one output
 /*! This class is used to build a fanout processes with one input
  * and one output. The class is parameterized for input and output
@@ -2239,31 +3178,34 @@ public:
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SY::fanout";}
     
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Passes the input tokens on to the outputs without running the process
+    void start_of_simulation() {bypass_fanout(iport1, oport1);}
+#endif
+    
 private:
     // Inputs and output variables
-    abst_ext<T>* val;
+    abst_ext<T> val;
     
     //Implementing the abstract semantics
     void init()
     {
-        val = new abst_ext<T>;
     }
     
     void prep()
     {
-        *val = iport1.read();
+        iport1.read(val);
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1, *val);
+        write_multiport(oport1, val);
     }
     
     void clean()
     {
-        delete val;
     }
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -26,11 +26,29 @@
 #include <functional>
 #include <tuple>
 #include <array>
+#include <vector>
 #include <algorithm>
+#include <cstddef>
 
 #include "abst_ext.hpp"
 #include "sy_process.hpp"
 
+#ifdef FORSYDE_MULTITHREADED
+#include "data_parallel_pool.hpp"
+#elif defined(FORSYDE_OPENMP)
+#include <omp.h>
+#endif
+
+//! The default size below which the data-parallel loops run serially
+#ifndef FORSYDE_DP_THRESHOLD
+#define FORSYDE_DP_THRESHOLD 4096
+#endif
+
+//! The alignment of the arrays of the vectorized process constructors
+#ifndef FORSYDE_SIMD_ALIGN
+#define FORSYDE_SIMD_ALIGN 64
+#endif
+
 namespace ForSyDe
 {
 
@@ -65,9 +83,7 @@ public:
              _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -76,8 +92,8 @@ public:
 
 private:
     // Inputs and output variables
-    T0* oval;
-    T1* ival1;
+    T0 oval;
+    T1 ival1;
     
     //! The function passed to the process constructor
     functype _func;
@@ -85,31 +101,27 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
-        ival1 = new T1;
     }
     
     void prep()
     {
         auto ival1_temp = iport1.read();
         CHECK_PRESENCE(ival1_temp);
-        *ival1 = unsafe_from_abst_ext(ival1_temp);
+        ival1 = unsafe_from_abst_ext(std::move(ival1_temp));
     }
     
     void exec()
     {
-        _func(*oval, *ival1);
+        _func(oval, ival1);
     }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
     
     void clean()
     {
-        delete ival1;
-        delete oval;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -148,9 +160,7 @@ public:
               _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -158,9 +168,9 @@ public:
     std::string forsyde_kind() const {return "SY::scomb2";}
 private:
     // Inputs and output variables
-    T0* oval;
-    T1* ival1;
-    T2* ival2;
+    T0 oval;
+    T1 ival1;
+    T2 ival2;
     
     //! The function passed to the process constructor
     functype _func;
@@ -168,9 +178,6 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
-        ival1 = new T1;
-        ival2 = new T2;
     }
     
     void prep()
@@ -179,25 +186,22 @@ private:
         auto ival2_temp = iport2.read();
         CHECK_PRESENCE(ival1_temp);
         CHECK_PRESENCE(ival2_temp);
-        *ival1 = unsafe_from_abst_ext(ival1_temp);
-        *ival2 = unsafe_from_abst_ext(ival2_temp);
+        ival1 = unsafe_from_abst_ext(std::move(ival1_temp));
+        ival2 = unsafe_from_abst_ext(std::move(ival2_temp));
     }
     
     void exec()
     {
-        _func(*oval, *ival1, *ival2);
+        _func(oval, ival1, ival2);
     }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
     
     void clean()
     {
-        delete ival2;
-        delete ival1;
-        delete oval;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -239,9 +243,7 @@ public:
               oport1("oport1"), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -250,10 +252,10 @@ public:
     
 private:
     // Inputs and output variables
-    T0* oval;
-    T1* ival1;
-    T2* ival2;
-    T3* ival3;
+    T0 oval;
+    T1 ival1;
+    T2 ival2;
+    T3 ival3;
 
     //! The function passed to the process constructor
     functype _func;
@@ -261,10 +263,6 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
-        ival1 = new T1;
-        ival2 = new T2;
-        ival3 = new T3;
     }
     
     void prep()
@@ -275,27 +273,23 @@ private:
         CHECK_PRESENCE(ival1_temp);
         CHECK_PRESENCE(ival2_temp);
         CHECK_PRESENCE(ival3_temp);
-        *ival1 = unsafe_from_abst_ext(ival1_temp);
-        *ival2 = unsafe_from_abst_ext(ival2_temp);
-        *ival3 = unsafe_from_abst_ext(ival3_temp);
+        ival1 = unsafe_from_abst_ext(std::move(ival1_temp));
+        ival2 = unsafe_from_abst_ext(std::move(ival2_temp));
+        ival3 = unsafe_from_abst_ext(std::move(ival3_temp));
     }
     
     void exec()
     {
-        _func(*oval, *ival1, *ival2, *ival3);
+        _func(oval, ival1, ival2, ival3);
     }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
     
     void clean()
     {
-        delete ival3;
-        delete ival2;
-        delete ival1;
-        delete oval;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -339,9 +333,7 @@ public:
               iport3("iport3"), iport4("iport4"), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -350,11 +342,11 @@ public:
     
 private:
     // Inputs and output variables
-    T0* oval;
-    T1* ival1;
-    T2* ival2;
-    T3* ival3;
-    T4* ival4;
+    T0 oval;
+    T1 ival1;
+    T2 ival2;
+    T3 ival3;
+    T4 ival4;
     
     //! The function passed to the process constructor
     functype _func;
@@ -362,11 +354,6 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
-        ival1 = new T1;
-        ival2 = new T2;
-        ival3 = new T3;
-        ival4 = new T4;
     }
     
     void prep()
@@ -379,29 +366,24 @@ private:
         CHECK_PRESENCE(ival2_temp);
         CHECK_PRESENCE(ival3_temp);
         CHECK_PRESENCE(ival4_temp);
-        *ival1 = unsafe_from_abst_ext(ival1_temp);
-        *ival2 = unsafe_from_abst_ext(ival2_temp);
-        *ival3 = unsafe_from_abst_ext(ival3_temp);
-        *ival4 = unsafe_from_abst_ext(ival4_temp);
+        ival1 = unsafe_from_abst_ext(std::move(ival1_temp));
+        ival2 = unsafe_from_abst_ext(std::move(ival2_temp));
+        ival3 = unsafe_from_abst_ext(std::move(ival3_temp));
+        ival4 = unsafe_from_abst_ext(std::move(ival4_temp));
     }
     
     void exec()
     {
-        _func(*oval, *ival1, *ival2, *ival3, *ival4);
+        _func(oval, ival1, ival2, ival3, ival4);
     }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
     
     void clean()
     {
-        delete ival4;
-        delete ival3;
-        delete ival2;
-        delete ival1;
-        delete oval;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -441,9 +423,7 @@ public:
           ) : sy_process(_name), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
@@ -452,7 +432,7 @@ public:
 
 private:
     // Inputs and output variables
-    T0* oval;
+    T0 oval;
     std::array<T1,N> ival;
 
     //! The function passed to the process constructor
@@ -461,7 +441,6 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
     }
 
     void prep()
@@ -470,23 +449,22 @@ private:
         {
             auto ival_temp = iport.read();
             CHECK_PRESENCE(ival_temp);
-    		ival[i] = unsafe_from_abst_ext(ival_temp);
+    		ival[i] = unsafe_from_abst_ext(std::move(ival_temp));
         }
     }
 
     void exec()
     {
-        _func(*oval, ival);
+        _func(oval, ival);
     }
 
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
 
     void clean()
     {
-        delete oval;
     }
 
 #ifdef FORSYDE_INTROSPECTION
@@ -524,9 +502,7 @@ public:
           ) : sy_process(_name), oport1("oport1"), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
@@ -535,8 +511,8 @@ public:
 
 private:
     // Inputs and output variables
-    T0* oval;
-    std::tuple<Ts...>* ivals;
+    T0 oval;
+    std::tuple<Ts...> ivals;
 
     //! The function passed to the process constructor
     functype _func;
@@ -544,8 +520,6 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
-        ivals = new std::tuple<Ts...>;
     }
 
     void prep()
@@ -556,26 +530,25 @@ private:
                     [&](){
                         auto val_temp = port.read();
                         if (is_absent(val_temp)) SC_REPORT_ERROR("scombN","Unexpected absent value received in");
-                        val = unsafe_from_abst_ext(val_temp);
+                        val = unsafe_from_abst_ext(std::move(val_temp));
                     }()
                 , ...);
-            }, *ivals);
+            }, ivals);
         }, iport);
     }
 
     void exec()
     {
-        _func(*oval, *ivals);
+        _func(oval, ivals);
     }
 
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
 
     void clean()
     {
-        delete oval;
     }
 
 #ifdef FORSYDE_INTROSPECTION
@@ -621,9 +594,7 @@ public:
           ) : sy_process(_name), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
@@ -632,8 +603,8 @@ public:
     
 private:
     // Input and output variables
-    std::tuple<TOs...>* ovals;
-    std::tuple<TIs...>* ivals;
+    std::tuple<TOs...> ovals;
+    std::tuple<TIs...> ivals;
     
     //! The function passed to the process constructor
     functype _func;
@@ -641,8 +612,6 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        ovals = new std::tuple<TOs...>;
-        ivals = new std::tuple<TIs...>;
     }
     
     void prep()
@@ -653,16 +622,16 @@ private:
                     [&](){
                         auto val_temp = port.read();
                         if (is_absent(val_temp)) SC_REPORT_ERROR("scombMN","Unexpected absent value received in");
-                        val = unsafe_from_abst_ext(val_temp);
+                        val = unsafe_from_abst_ext(std::move(val_temp));
                     }()
                 , ...);
-            }, *ivals);
+            }, ivals);
         }, iport);
     }
     
     void exec()
     {
-        _func(*ovals, *ivals);
+        _func(ovals, ivals);
     }
     
     void prod()
@@ -670,14 +639,12 @@ private:
         std::apply([&](auto&&... port){
             std::apply([&](auto&&... val){
                 (write_multiport(port, val), ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
     }
     
     void clean()
     {
-        delete ivals;
-        delete ovals;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -724,13 +691,14 @@ public:
      * the results using the output port
      */
     sdpmap(const sc_module_name& _name,    ///< process name
-           const functype& _func            ///< function to be passed
-          ) : sy_process(_name), _func(_func)
+           const functype& _func,           ///< function to be passed
+           size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+          ) : sy_process(_name), _func(_func),
+              parallel_threshold(parallel_threshold)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
+        add_arg("parallel_threshold", parallel_threshold);
 #endif
     }
 
@@ -745,6 +713,9 @@ private:
     //! The function passed to the process constructor
     functype _func;
 
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
     //Implementing the abstract semantics
     void init() {}
 
@@ -752,18 +723,33 @@ private:
     {
         auto ival_temp = iport1.read();
         CHECK_PRESENCE(ival_temp);
-        ival = unsafe_from_abst_ext(ival_temp);
+        ival = unsafe_from_abst_ext(std::move(ival_temp));
     }
 
     void exec()
     {
+        if (N < parallel_threshold)
+        {
+            for (size_t i=0; i<N; i++)
+                _func(oval[i], ival[i]);
+            return;
+        }
+        #if defined(FORSYDE_MULTITHREADED)
+        data_parallel_pool::get().parallel_for(N,
+            [this](size_t begin, size_t end, unsigned)
+            {
+                for (size_t i=begin; i<end; i++)
+                    _func(oval[i], ival[i]);
+            });
+        #else
         #ifdef FORSYDE_OPENMP
-        #pragma omp parallel for
+        #pragma omp parallel for schedule(static)
         #endif
         for (size_t i=0; i<N; i++)
         {
             _func(oval[i], ival[i]);
         }
+        #endif
     }
 
     void prod()
@@ -805,13 +791,14 @@ public:
      * results using the output port
      */
     sdpreduce(const sc_module_name& _name,      ///< process name
-           const functype& _func             ///< function to be passed
-          ) : sy_process(_name), _func(_func)
+           const functype& _func,            ///< function to be passed
+           size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+          ) : sy_process(_name), _func(_func),
+              parallel_threshold(parallel_threshold)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
+        add_arg("parallel_threshold", parallel_threshold);
 #endif
     }
 
@@ -820,62 +807,98 @@ public:
 
 private:
     // Inputs and output variables
-    T0* oval;
+    T0 oval;
     std::array<T0,N> ival;
 
     //! The function passed to the process constructor
     functype _func;
 
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    //! The partial results of the chunks
+    std::vector<T0> partial;
+
+    //! Combines the partial results pairwise in a balanced tree
+    /*! The order of the operands is preserved, hence the result equals
+     * the serial one for any associative function.
+     */
+    void tree_reduce(size_t n)
+    {
+        for (size_t stride=1; stride<n; stride*=2)
+            for (size_t i=0; i+stride<n; i+=2*stride)
+                _func(partial[i], partial[i], partial[i+stride]);
+    }
+
     //Implementing the abstract semantics
     void init()
     {
-        oval = new T0;
     }
 
     void prep()
     {
         auto ival1_temp = iport1.read();
         CHECK_PRESENCE(ival1_temp);
-        ival = unsafe_from_abst_ext(ival1_temp);
+        ival = unsafe_from_abst_ext(std::move(ival1_temp));
     }
 
     void exec()
     {
-        T0 res = T0();
-        #ifdef FORSYDE_OPENMP  // this can be enhanced with the new delare reduction clause in OpenMP 4.0
-        
-        #pragma omp parallel shared(res) // Create omp threads
+        if (N < parallel_threshold || N < 2)
+        {
+            oval = ival[0];
+            for (size_t i=1;i<N;i++)
+                _func(oval, oval, ival[i]);
+            return;
+        }
+        // each chunk is folded from its first element, so no identity
+        // element of the function is needed
+        #if defined(FORSYDE_MULTITHREADED)
+        partial.resize(data_parallel_pool::get().size());
+        const size_t chunks = data_parallel_pool::get().parallel_for(N,
+            [this](size_t begin, size_t end, unsigned c)
+            {
+                T0 acc = ival[begin];
+                for (size_t i=begin+1; i<end; i++)
+                    _func(acc, acc, ival[i]);
+                partial[c] = acc;
+            });
+        #elif defined(FORSYDE_OPENMP)
+        size_t chunks = 1;
+        #pragma omp parallel
         {
-            T0 val = T0();  // val can be declared as local variable (for each thread) 
-            #pragma omp for nowait
-            for (int i = 0; i < N; ++i)
+            #pragma omp single
             {
-                _func(val, val, ival[i]);
+                chunks = std::min<size_t>(omp_get_num_threads(), N);
+                partial.resize(chunks);
             }
-            #pragma omp critical
+            const size_t c = omp_get_thread_num();
+            if (c < chunks)
             {
-                _func(res, res, val);
+                const size_t begin = N*c/chunks, end = N*(c+1)/chunks;
+                T0 acc = ival[begin];
+                for (size_t i=begin+1; i<end; i++)
+                    _func(acc, acc, ival[i]);
+                partial[c] = acc;
             }
         }
-        
         #else
-        
-        res = ival[0];
+        const size_t chunks = 1;
+        partial.assign(1, ival[0]);
         for (size_t i=1;i<N;i++)
-            _func(res, res, ival[i]);
-        
+            _func(partial[0], partial[0], ival[i]);
         #endif
-        *oval = res;
+        tree_reduce(chunks);
+        oval = partial[0];
     }
 
     void prod()
     {
-        write_multiport(oport1, abst_ext<T0>(*oval));
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
 
     void clean()
     {
-        delete oval;
     }
 
 #ifdef FORSYDE_INTROSPECTION
@@ -908,20 +931,25 @@ public:
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input ports,
      * applies the user-imlpemented function to them and writes the
-     * results using the output port
+     * results using the output port.
+     *
+     * If the function is declared associative and the input and output
+     * types are the same, the arrays of at least parallel_threshold
+     * elements are scanned in parallel. Otherwise the scan is sequential.
      */
     sdpscan(const sc_module_name& _name,      ///< process name
            const functype& _func,             ///< function to be passed
-           const T0& init_res                 ///< initial value for running result
-          ) : sy_process(_name), _func(_func), init_res(init_res)
+           const T0& init_res,                ///< initial value for running result
+           size_t parallel_threshold=FORSYDE_DP_THRESHOLD, ///< the smallest N evaluated in parallel
+           bool associative=false             ///< the function is associative
+          ) : sy_process(_name), _func(_func), init_res(init_res),
+              parallel_threshold(parallel_threshold), associative(associative)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_res;
-        arg_vec.push_back(std::make_tuple("init_res",ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("init_res", init_res);
+        add_arg("parallel_threshold", parallel_threshold);
+        arg_vec.push_back(std::make_tuple("associative",associative?"true":"false"));
 #endif
     }
 
@@ -938,6 +966,15 @@ private:
     
     T0 init_res;
 
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    //! The function is associative, which allows the parallel scan
+    bool associative;
+
+    //! The running results at the chunk boundaries
+    std::vector<T0> carry;
+
     //Implementing the abstract semantics
     void init() {}
 
@@ -945,16 +982,99 @@ private:
     {
         auto ival1_temp = iport1.read();
         CHECK_PRESENCE(ival1_temp);
-        ival = unsafe_from_abst_ext(ival1_temp);
+        ival = unsafe_from_abst_ext(std::move(ival1_temp));
     }
 
     void exec()
     {
+        #if defined(FORSYDE_MULTITHREADED) || defined(FORSYDE_OPENMP)
+        if constexpr (std::is_same<T0,T1>::value)
+            if (associative && N >= parallel_threshold && N >= 2)
+            {
+                parallel_scan();
+                return;
+            }
+        #endif
         _func(oval[0], init_res, ival[0]);
         for (size_t i=1;i<N;i++)
             _func(oval[i], oval[i-1], ival[i]);
     }
 
+#if defined(FORSYDE_MULTITHREADED) || defined(FORSYDE_OPENMP)
+    //! Scans chunk c of the array locally
+    /*! The first chunk starts from the initial result and the others
+     * from their first element.
+     */
+    void scan_chunk(size_t begin, size_t end, size_t c)
+    {
+        if (c == 0)
+            _func(oval[0], init_res, ival[0]);
+        else
+            oval[begin] = ival[begin];
+        for (size_t i=begin+1; i<end; i++)
+            _func(oval[i], oval[i-1], ival[i]);
+    }
+
+    //! Computes the running results at the boundaries of the chunks
+    void scan_carries(size_t chunks)
+    {
+        carry.resize(chunks);
+        carry[1] = oval[N/chunks-1];
+        for (size_t c=2; c<chunks; c++)
+            _func(carry[c], carry[c-1], oval[N*c/chunks-1]);
+    }
+
+    //! Combines the running result before chunk c with its elements
+    void fix_chunk(size_t begin, size_t end, size_t c)
+    {
+        T0 temp;
+        for (size_t i=begin; i<end; i++)
+        {
+            _func(temp, carry[c], oval[i]);
+            oval[i] = temp;
+        }
+    }
+
+    //! Evaluates the scan in three passes over the chunks of the array
+    /*! Each chunk is first scanned locally (the up-sweep), then the
+     * running results at the chunk boundaries are computed serially and
+     * finally they are combined with the local results of the following
+     * chunks (the down-sweep). With one chunk per thread it performs
+     * about 2N operations, i.e., it is work-efficient.
+     */
+    void parallel_scan()
+    {
+        #ifdef FORSYDE_MULTITHREADED
+        data_parallel_pool& pool = data_parallel_pool::get();
+        const unsigned chunks = pool.parallel_for(N,
+            [this](size_t begin, size_t end, unsigned c)
+            {
+                scan_chunk(begin, end, c);
+            });
+        if (chunks <= 1) return;
+        scan_carries(chunks);
+        // the last pass iterates over the chunks of the first one
+        pool.parallel_for(chunks-1,
+            [this,chunks](size_t begin, size_t end, unsigned)
+            {
+                for (size_t c=begin+1; c<end+1; c++)
+                    fix_chunk(N*c/chunks, N*(c+1)/chunks, c);
+            });
+        #else
+        #pragma omp parallel
+        {
+            const size_t chunks = std::min<size_t>(omp_get_num_threads(), N);
+            const size_t c = omp_get_thread_num();
+            if (c < chunks) scan_chunk(N*c/chunks, N*(c+1)/chunks, c);
+            #pragma omp barrier
+            #pragma omp single
+            if (chunks > 1) scan_carries(chunks);
+            if (c > 0 && c < chunks) fix_chunk(N*c/chunks, N*(c+1)/chunks, c);
+        }
+        #endif
+    }
+#endif
+
     void prod()
     {
         auto tempval = abst_ext<std::array<T0,N>>(oval);
@@ -974,75 +1094,88 @@ private:
 #endif
 };
 
-//! Process constructor for a strict delay element
-/*! This class is used to build the most basic sequential process which
- * is a delay element. Given an initial value, it inserts this value at
- * the beginning of output stream and passes the rest of the inputs to
- * its output untouched. The class is parameterized for its input/output
- * data-type.
- * 
- * It is mandatory to include at least one delay element in all feedback
- * loops since combinational loops are forbidden in ForSyDe.
+//! A data-parallel process constructor for a strict map with a batch kernel
+/*! Similar to sdpmap, but the function is called once per evaluation
+ * cycle with the whole array (or with a contiguous chunk of it when
+ * the array is evaluated in parallel) instead of once per element.
+ * This allows the compiler to vectorize the loop of the kernel. The
+ * arrays are aligned to FORSYDE_SIMD_ALIGN bytes.
  */
-template <class T>
-class sdelay : public sy_process
+template <typename T0, typename T1, std::size_t N>
+class vmap : public sy_process
 {
 public:
-    SY_in<T>  iport1;       ///< port for the input channel
-    SY_out<T> oport1;        ///< port for the output channel
+    SY_in<std::array<T1,N>> iport1;       ///< port for the input channel 1
+    SY_out<std::array<T0,N>> oport1;        ///< port for the output channel
+
+    //! Type of the batch kernel, called with the output, the input and the number of elements
+    typedef std::function<void(T0*, const T1*, size_t)> functype;
 
     //! The constructor requires the module name
-    /*! It creates an SC_THREAD which inserts the initial element, reads
-     * data from its input port, and writes the results using the output
-     * port.
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented kernel to the array and writes the
+     * results using the output port
      */
-    sdelay(const sc_module_name& _name,  ///< process name
-           const T& init_val            ///< initial value
-          ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
-              init_val(init_val)
+    vmap(const sc_module_name& _name,      ///< process name
+         const functype& _func,             ///< the batch kernel
+         size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+        ) : sy_process(_name), _func(_func),
+            parallel_threshold(parallel_threshold)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("parallel_threshold", parallel_threshold);
 #endif
     }
-    
+
     //! Specifying from which process constructor is the module built
-    std::string forsyde_kind() const {return "SY::sdelay";}
-    
+    std::string forsyde_kind() const{return "SY::vmap";}
+
 private:
-    // Initial value
-    T init_val;
-    
     // Inputs and output variables
-    T* val;
-    
+    alignas(FORSYDE_SIMD_ALIGN) std::array<T0,N> oval;
+    alignas(FORSYDE_SIMD_ALIGN) std::array<T1,N> ival;
+
+    //! The batch kernel passed to the process constructor
+    functype _func;
+
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
     //Implementing the abstract semantics
-    void init()
-    {
-        val = new T;
-        write_multiport(oport1, abst_ext<T>(init_val));
-    }
-    
+    void init() {}
+
     void prep()
     {
-        auto ival1_temp = iport1.read();
-        CHECK_PRESENCE(ival1_temp);
-        *val = unsafe_from_abst_ext(ival1_temp);
+        auto ival_temp = iport1.read();
+        CHECK_PRESENCE(ival_temp);
+        ival = unsafe_from_abst_ext(std::move(ival_temp));
     }
-    
-    void exec() {}
-    
-    void prod()
+
+    void exec()
     {
-        write_multiport(oport1, abst_ext<T>(*val));
+        #ifdef FORSYDE_MULTITHREADED
+        if (N >= parallel_threshold)
+        {
+            data_parallel_pool::get().parallel_for(N,
+                [this](size_t begin, size_t end, unsigned)
+                {
+                    _func(oval.data()+begin, ival.data()+begin, end-begin);
+                });
+            return;
+        }
+        #endif
+        _func(oval.data(), ival.data(), N);
     }
-    
-    void clean()
+
+    void prod()
     {
-        delete val;
+        auto tempval = abst_ext<std::array<T0,N>>(oval);
+        write_multiport(oport1, tempval);
     }
+
+    void clean() {}
+
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1054,79 +1187,96 @@ private:
 #endif
 };
 
-//! Process constructor for a strict n-delay element
-/*! This class is used to build a sequential process similar to dalay
- * but with an extra initial variable which sets the number of delay
- * elements (initial tokens). Given an initial value, it inserts the
- * initial value n times at the the beginning of output stream and
- * passes the rest of the inputs to its output untouched. The class is
- * parameterized for its input/output data-type.
+//! A data-parallel process constructor for a strict reduce with a batch kernel
+/*! Similar to sdpreduce, but the kernel reduces a range of (at least
+ * one) elements into a single value. When the array is evaluated in
+ * parallel, the kernel reduces each chunk and then the partial results
+ * of the chunks, hence it should be associative.
+ *
+ * The vadd, vmul, vmax and vmin kernels implement the common
+ * reductions of arithmetic types in a vectorizable way.
  */
-template <class T>
-class sdelayn : public sy_process
+template <typename T0, std::size_t N>
+class vreduce : public sy_process
 {
 public:
-    SY_in<T>  iport1;       ///< port for the input channel
-    SY_out<T> oport1;        ///< port for the output channel
+    SY_in<std::array<T0,N>> iport1;     ///< port for the input channel 1
+    SY_out<T0> oport1;                  ///< port for the output channel
+
+    //! Type of the batch kernel, called with the result, the input and the number of elements
+    typedef std::function<void(T0&, const T0*, size_t)> functype;
 
     //! The constructor requires the module name
-    /*! It creates an SC_THREAD which inserts the initial elements,
-     * reads data from its input port, and writes the results using the
-     * output port.
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * applies the user-imlpemented kernel to them and writes the
+     * results using the output port
      */
-    sdelayn(const sc_module_name& _name,    ///< process name
-            const T& init_val,              ///< initial value
-            const unsigned int& n           ///< number of delay elements
-          ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
-              init_val(init_val), ns(n)
+    vreduce(const sc_module_name& _name,      ///< process name
+            const functype& _func,             ///< the batch kernel
+            size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+           ) : sy_process(_name), _func(_func),
+               parallel_threshold(parallel_threshold)
     {
+        static_assert(N > 0, "vreduce requires a non-empty array");
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << n;
-        arg_vec.push_back(std::make_tuple("n", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("parallel_threshold", parallel_threshold);
 #endif
     }
-    
+
     //! Specifying from which process constructor is the module built
-    std::string forsyde_kind() const {return "SY::sdelayn";}
-    
+    std::string forsyde_kind() const{return "SY::vreduce";}
+
 private:
-    // Initial value
-    T init_val;
-    unsigned int ns;
-    
     // Inputs and output variables
-    T* val;
-    
+    T0 oval;
+    alignas(FORSYDE_SIMD_ALIGN) std::array<T0,N> ival;
+
+    //! The batch kernel passed to the process constructor
+    functype _func;
+
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    //! The partial results of the chunks
+    std::vector<T0> partial;
+
     //Implementing the abstract semantics
-    void init()
-    {
-        val = new T;
-        for (int i=0; i<ns; i++)
-            write_multiport(oport1, abst_ext<T>(init_val));
-    }
-    
+    void init() {}
+
     void prep()
     {
         auto ival1_temp = iport1.read();
         CHECK_PRESENCE(ival1_temp);
-        *val = unsafe_from_abst_ext(ival1_temp);
+        ival = unsafe_from_abst_ext(std::move(ival1_temp));
     }
-    
-    void exec() {}
-    
-    void prod()
+
+    void exec()
     {
-        write_multiport(oport1, abst_ext<T>(*val));
+        #ifdef FORSYDE_MULTITHREADED
+        if (N >= parallel_threshold)
+        {
+            data_parallel_pool& pool = data_parallel_pool::get();
+            partial.resize(pool.size());
+            const unsigned chunks = pool.parallel_for(N,
+                [this](size_t begin, size_t end, unsigned c)
+                {
+                    _func(partial[c], ival.data()+begin, end-begin);
+                });
+            _func(oval, partial.data(), chunks);
+            return;
+        }
+        #endif
+        _func(oval, ival.data(), N);
     }
-    
-    void clean()
+
+    void prod()
     {
-        delete val;
+        write_multiport(oport1, abst_ext<T0>(oval));
     }
+
+    void clean() {}
+
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1138,73 +1288,698 @@ private:
 #endif
 };
 
-//! Process constructor for a strict Moore machine
-/*! This class is used to build a finite state machine of type Moore.
- * Given an initial state, a next-state function, and an output decoding
- * function it creates a Moore process.
+//! The number of independent accumulators used by the reduction kernels
+/*! Splitting the accumulation into several lanes removes the loop
+ * carried dependency, which lets the compiler use vector instructions
+ * without reassociating floating-point operations itself.
  */
-template <class IT, class ST, class OT>
-class smoore : public sy_process
+#ifndef FORSYDE_SIMD_LANES
+#define FORSYDE_SIMD_LANES 16
+#endif
+
+//! A vectorizable reduction kernel, parameterized by the operation
+template <typename T, typename Op>
+struct vreduce_kernel
+{
+    void operator()(T& res, const T* in, size_t n) const
+    {
+        const size_t L = FORSYDE_SIMD_LANES;
+        if (n < 2*L)
+        {
+            res = in[0];
+            for (size_t i=1; i<n; i++) res = Op::apply(res, in[i]);
+            return;
+        }
+        T acc[L];
+        for (size_t k=0; k<L; k++) acc[k] = in[k];
+        size_t i = L;
+        for (; i+L<=n; i+=L)
+            for (size_t k=0; k<L; k++)
+                acc[k] = Op::apply(acc[k], in[i+k]);
+        for (size_t k=1; k<L; k++) acc[0] = Op::apply(acc[0], acc[k]);
+        for (; i<n; i++) acc[0] = Op::apply(acc[0], in[i]);
+        res = acc[0];
+    }
+};
+
+//! The operations of the built-in reduction kernels
+struct vadd_op {template <typename T> static T apply(T a, T b) {return a + b;}};
+struct vmul_op {template <typename T> static T apply(T a, T b) {return a * b;}};
+struct vmax_op {template <typename T> static T apply(T a, T b) {return b > a ? b : a;}};
+struct vmin_op {template <typename T> static T apply(T a, T b) {return b < a ? b : a;}};
+
+//! The vectorizable sum kernel of vreduce
+template <typename T> using vadd = vreduce_kernel<T,vadd_op>;
+//! The vectorizable product kernel of vreduce
+template <typename T> using vmul = vreduce_kernel<T,vmul_op>;
+//! The vectorizable maximum kernel of vreduce
+template <typename T> using vmax = vreduce_kernel<T,vmax_op>;
+//! The vectorizable minimum kernel of vreduce
+template <typename T> using vmin = vreduce_kernel<T,vmin_op>;
+
+//! The size of the square tiles of the 2D stencils
+/*! The outputs of a tile are computed together, so that the rows of the
+ * input windows they share stay in the cache.
+ */
+#ifndef FORSYDE_STENCIL_TILE
+#define FORSYDE_STENCIL_TILE 32
+#endif
+
+//! The boundary policies of the stencil processes
+/*! They define the elements beyond the edges of the array, which are
+ * read by the windows of the elements near the edges.
+ */
+enum stencil_boundary
+{
+    STENCIL_CLAMP,      ///< the edge element is repeated
+    STENCIL_WRAP,       ///< the array is periodic
+    STENCIL_MIRROR,     ///< the array is reflected at the edge element
+    STENCIL_CONSTANT    ///< a constant fill value
+};
+
+//! Maps an index beyond the edges of an array of n elements into it
+/*! It returns n for the constant boundary, whose elements are the fill
+ * value.
+ */
+inline size_t stencil_index(std::ptrdiff_t i, size_t n, stencil_boundary b)
+{
+    const std::ptrdiff_t sn = n;
+    if (i >= 0 && i < sn) return i;
+    switch (b)
+    {
+    case STENCIL_CLAMP:
+        return i < 0 ? 0 : n-1;
+    case STENCIL_WRAP:
+        return (i % sn + sn) % sn;
+    case STENCIL_MIRROR:
+    {
+        if (n == 1) return 0;
+        const std::ptrdiff_t p = 2*(sn-1);
+        const std::ptrdiff_t m = (i % p + p) % p;
+        return m < sn ? m : p - m;
+    }
+    default:
+        return n;
+    }
+}
+
+//! Copies an array of n elements with a halo of r elements on each side
+/*! The output has n+2r elements, the halo being filled according to the
+ * boundary policy.
+ */
+template <typename T>
+inline void stencil_pad(const T* in, size_t n, size_t r,
+                        stencil_boundary b, const T& fill, T* out)
+{
+    for (size_t k=0; k<r; k++)
+    {
+        const size_t lo = stencil_index(std::ptrdiff_t(k)-std::ptrdiff_t(r), n, b);
+        const size_t hi = stencil_index(std::ptrdiff_t(n+k), n, b);
+        out[k] = lo == n ? fill : in[lo];
+        out[n+r+k] = hi == n ? fill : in[hi];
+    }
+    std::copy(in, in+n, out+r);
+}
+
+//! A data-parallel process constructor for a strict stencil process with input and output array types
+/*! Each output element is computed from the window of the 2R+1 input
+ * elements centered on it. The function is called with a pointer to the
+ * first element of the window, i.e., w[R] is the corresponding input
+ * element. The elements beyond the edges of the array are defined by the
+ * boundary policy.
+ *
+ *  The input is copied once into a buffer with a halo of R elements on
+ * each side, so that all the windows are contiguous and no element
+ * needs a boundary check. Large arrays are evaluated in parallel chunks
+ * as in sdpmap.
+ */
+template <typename T0, typename T1, std::size_t N, std::size_t R>
+class sdpstencil : public sy_process
 {
 public:
-    SY_in<IT>  iport1;        ///< port for the input channel
-    SY_out<OT> oport1;        ///< port for the output channel
-    
-    //! Type of the next-state function to be passed to the process constructor
-    typedef std::function<void(ST&, const ST&, const IT&)> ns_functype;
-    
-    //! Type of the output-decoding function to be passed to the process constructor
-    typedef std::function<void(OT&, const ST&)> od_functype;
+    SY_in<std::array<T1,N>> iport1;       ///< port for the input channel 1
+    SY_out<std::array<T0,N>> oport1;        ///< port for the output channel
+
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(T0&, const T1*)> functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
-     * applies the user-imlpemented functions to the input and current
-     * state and writes the results using the output port
+     * applies the user-imlpemented function to the window of each element
+     * and writes the results using the output port
      */
-    smoore(const sc_module_name& _name,      ///< process name
-           const ns_functype& _ns_func, ///< The next_state function
-           const od_functype& _od_func, ///< The output-decoding function
-           const ST& init_st  ///< Initial state
-          ) : sy_process(_name), _ns_func(_ns_func), _od_func(_od_func),
-              init_st(init_st)
-    {
+    sdpstencil(const sc_module_name& _name,    ///< process name
+               const functype& _func,           ///< function to be passed
+               stencil_boundary boundary=STENCIL_CLAMP, ///< the boundary policy
+               const T1& fill=T1(),             ///< the fill value of STENCIL_CONSTANT
+               size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+              ) : sy_process(_name), _func(_func), boundary(boundary), fill(fill),
+                  parallel_threshold(parallel_threshold)
+    {
+        static_assert(N > 0, "sdpstencil requires a non-empty array");
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("radius", R);
+        add_arg("boundary", boundary);
+        add_arg("parallel_threshold", parallel_threshold);
 #endif
     }
-    
+
     //! Specifying from which process constructor is the module built
-    std::string forsyde_kind() const{return "SY::smoore";}
-    
+    std::string forsyde_kind() const{return "SY::sdpstencil";}
+
 private:
-    //! The functions passed to the process constructor
-    ns_functype _ns_func;
-    od_functype _od_func;
-    // Initial value
-    ST init_st;
-    
+    // Inputs and output variables
+    std::array<T0,N> oval;
+    std::array<T1,N+2*R> ival;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    stencil_boundary boundary;
+    T1 fill;
+
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        auto ival_temp = iport1.read();
+        CHECK_PRESENCE(ival_temp);
+        stencil_pad(unsafe_from_abst_ext(ival_temp).data(), N, R, boundary, fill, ival.data());
+    }
+
+    void exec()
+    {
+        if (N < parallel_threshold)
+        {
+            for (size_t i=0; i<N; i++)
+                _func(oval[i], ival.data()+i);
+            return;
+        }
+        #if defined(FORSYDE_MULTITHREADED)
+        data_parallel_pool::get().parallel_for(N,
+            [this](size_t begin, size_t end, unsigned)
+            {
+                for (size_t i=begin; i<end; i++)
+                    _func(oval[i], ival.data()+i);
+            });
+        #else
+        #ifdef FORSYDE_OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (size_t i=0; i<N; i++)
+        {
+            _func(oval[i], ival.data()+i);
+        }
+        #endif
+    }
+
+    void prod()
+    {
+        auto tempval = abst_ext<std::array<T0,N>>(oval);
+        write_multiport(oport1, tempval);
+    }
+
+    void clean() {}
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! A data-parallel process constructor for a strict stencil with a batch kernel
+/*! Similar to sdpstencil, but the kernel is called once per evaluation
+ * cycle (or once per chunk when the array is evaluated in parallel) as
+ * kernel(out, in, n) to compute n outputs, where the window of out[k] is
+ * in[k], ..., in[k+2R]. Hence the loop of the kernel over the outputs
+ * can be vectorized. The arrays are aligned to FORSYDE_SIMD_ALIGN bytes.
+ */
+template <typename T0, typename T1, std::size_t N, std::size_t R>
+class vstencil : public sy_process
+{
+public:
+    SY_in<std::array<T1,N>> iport1;       ///< port for the input channel 1
+    SY_out<std::array<T0,N>> oport1;        ///< port for the output channel
+
+    //! Type of the batch kernel, called with the output, the padded input and the number of elements
+    typedef std::function<void(T0*, const T1*, size_t)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented kernel to the array and writes the
+     * results using the output port
+     */
+    vstencil(const sc_module_name& _name,      ///< process name
+             const functype& _func,             ///< the batch kernel
+             stencil_boundary boundary=STENCIL_CLAMP, ///< the boundary policy
+             const T1& fill=T1(),               ///< the fill value of STENCIL_CONSTANT
+             size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+            ) : sy_process(_name), _func(_func), boundary(boundary), fill(fill),
+                parallel_threshold(parallel_threshold)
+    {
+        static_assert(N > 0, "vstencil requires a non-empty array");
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("radius", R);
+        add_arg("boundary", boundary);
+        add_arg("parallel_threshold", parallel_threshold);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::vstencil";}
+
+private:
+    // Inputs and output variables
+    alignas(FORSYDE_SIMD_ALIGN) std::array<T0,N> oval;
+    alignas(FORSYDE_SIMD_ALIGN) std::array<T1,N+2*R> ival;
+
+    //! The batch kernel passed to the process constructor
+    functype _func;
+
+    stencil_boundary boundary;
+    T1 fill;
+
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    //Implementing the abstract semantics
+    void init() {}
+
+    void prep()
+    {
+        auto ival_temp = iport1.read();
+        CHECK_PRESENCE(ival_temp);
+        stencil_pad(unsafe_from_abst_ext(ival_temp).data(), N, R, boundary, fill, ival.data());
+    }
+
+    void exec()
+    {
+        #ifdef FORSYDE_MULTITHREADED
+        if (N >= parallel_threshold)
+        {
+            data_parallel_pool::get().parallel_for(N,
+                [this](size_t begin, size_t end, unsigned)
+                {
+                    _func(oval.data()+begin, ival.data()+begin, end-begin);
+                });
+            return;
+        }
+        #endif
+        _func(oval.data(), ival.data(), N);
+    }
+
+    void prod()
+    {
+        auto tempval = abst_ext<std::array<T0,N>>(oval);
+        write_multiport(oport1, tempval);
+    }
+
+    void clean() {}
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! A data-parallel process constructor for a strict 2D stencil process
+/*! Each output element of a ROWS*COLS array (an array of rows) is
+ * computed from the (2R+1)*(2R+1) window of the input elements centered
+ * on it. The function is called with a pointer to the top-left element
+ * of the window and the row stride of the window, i.e., w[i*stride+j] is
+ * the element in the ith row and the jth column of the window. The
+ * boundary policy applies to both dimensions.
+ *
+ *  The input is copied once into a buffer with a halo of R rows and R
+ * columns, and the outputs are computed in square tiles of
+ * FORSYDE_STENCIL_TILE elements, which are distributed over the threads
+ * when the array is large.
+ */
+template <typename T0, typename T1, std::size_t ROWS, std::size_t COLS, std::size_t R>
+class sdpstencil2d : public sy_process
+{
+public:
+    typedef std::array<std::array<T1,COLS>,ROWS> itype;   ///< the input array type
+    typedef std::array<std::array<T0,COLS>,ROWS> otype;   ///< the output array type
+
+    SY_in<itype> iport1;                ///< port for the input channel 1
+    SY_out<otype> oport1;               ///< port for the output channel
+
+    //! Type of the function to be passed to the process constructor
+    typedef std::function<void(T0&, const T1*, size_t)> functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented function to the window of each element
+     * and writes the results using the output port
+     */
+    sdpstencil2d(const sc_module_name& _name,  ///< process name
+                 const functype& _func,         ///< function to be passed
+                 stencil_boundary boundary=STENCIL_CLAMP, ///< the boundary policy
+                 const T1& fill=T1(),           ///< the fill value of STENCIL_CONSTANT
+                 size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest ROWS*COLS evaluated in parallel
+                ) : sy_process(_name), _func(_func), boundary(boundary), fill(fill),
+                    parallel_threshold(parallel_threshold)
+    {
+        static_assert(ROWS > 0 && COLS > 0, "sdpstencil2d requires a non-empty array");
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_func", "_func");
+        add_arg("radius", R);
+        add_arg("boundary", boundary);
+        add_arg("parallel_threshold", parallel_threshold);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::sdpstencil2d";}
+
+private:
+    static constexpr size_t stride = COLS+2*R;
+    static constexpr size_t tile = FORSYDE_STENCIL_TILE;
+    static constexpr size_t tile_rows = (ROWS+tile-1)/tile;
+    static constexpr size_t tile_cols = (COLS+tile-1)/tile;
+
+    // Inputs and output variables
+    otype oval;
+    //! The input with its halo, row by row
+    std::vector<T1> ival;
+
+    //! The function passed to the process constructor
+    functype _func;
+
+    stencil_boundary boundary;
+    T1 fill;
+
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    //! Computes the outputs of a tile
+    void run_tile(size_t t)
+    {
+        const size_t r0 = t / tile_cols * tile, c0 = t % tile_cols * tile;
+        const size_t r1 = std::min(r0+tile, ROWS), c1 = std::min(c0+tile, COLS);
+        for (size_t i=r0; i<r1; i++)
+            for (size_t j=c0; j<c1; j++)
+                _func(oval[i][j], ival.data()+i*stride+j, stride);
+    }
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        ival.resize((ROWS+2*R)*stride);
+    }
+
+    void prep()
+    {
+        auto ival_temp = iport1.read();
+        CHECK_PRESENCE(ival_temp);
+        const itype& in = unsafe_from_abst_ext(ival_temp);
+        for (size_t k=0; k<ROWS+2*R; k++)
+        {
+            const size_t i = stencil_index(std::ptrdiff_t(k)-std::ptrdiff_t(R), ROWS, boundary);
+            T1* row = ival.data()+k*stride;
+            if (i == ROWS)
+                std::fill(row, row+stride, fill);
+            else
+                stencil_pad(in[i].data(), COLS, R, boundary, fill, row);
+        }
+    }
+
+    void exec()
+    {
+        const size_t tiles = tile_rows * tile_cols;
+        if (ROWS*COLS < parallel_threshold)
+        {
+            for (size_t t=0; t<tiles; t++) run_tile(t);
+            return;
+        }
+        #if defined(FORSYDE_MULTITHREADED)
+        data_parallel_pool::get().parallel_for(tiles,
+            [this](size_t begin, size_t end, unsigned)
+            {
+                for (size_t t=begin; t<end; t++) run_tile(t);
+            });
+        #else
+        #ifdef FORSYDE_OPENMP
+        #pragma omp parallel for schedule(static)
+        #endif
+        for (size_t t=0; t<tiles; t++)
+        {
+            run_tile(t);
+        }
+        #endif
+    }
+
+    void prod()
+    {
+        auto tempval = abst_ext<otype>(oval);
+        write_multiport(oport1, tempval);
+    }
+
+    void clean() {}
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a strict delay element
+/*! This class is used to build the most basic sequential process which
+ * is a delay element. Given an initial value, it inserts this value at
+ * the beginning of output stream and passes the rest of the inputs to
+ * its output untouched. The class is parameterized for its input/output
+ * data-type.
+ * 
+ * It is mandatory to include at least one delay element in all feedback
+ * loops since combinational loops are forbidden in ForSyDe.
+ */
+template <class T>
+class sdelay : public sy_process
+{
+public:
+    SY_in<T>  iport1;       ///< port for the input channel
+    SY_out<T> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which inserts the initial element, reads
+     * data from its input port, and writes the results using the output
+     * port.
+     */
+    sdelay(const sc_module_name& _name,  ///< process name
+           const T& init_val            ///< initial value
+          ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+              init_val(init_val)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("init_val", init_val);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::sdelay";}
+    
+private:
+    // Initial value
+    T init_val;
+    
+    // Inputs and output variables
+    T val;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        // the initial token is restored with the signal
+        if (!is_restored()) write_multiport(oport1, abst_ext<T>(init_val));
+    }
+    
+    void prep()
+    {
+        auto ival1_temp = iport1.read();
+        CHECK_PRESENCE(ival1_temp);
+        val = unsafe_from_abst_ext(std::move(ival1_temp));
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<T>(val));
+    }
+    
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a strict n-delay element
+/*! This class is used to build a sequential process similar to dalay
+ * but with an extra initial variable which sets the number of delay
+ * elements (initial tokens). Given an initial value, it inserts the
+ * initial value n times at the the beginning of output stream and
+ * passes the rest of the inputs to its output untouched. The class is
+ * parameterized for its input/output data-type.
+ */
+template <class T>
+class sdelayn : public sy_process
+{
+public:
+    SY_in<T>  iport1;       ///< port for the input channel
+    SY_out<T> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which inserts the initial elements,
+     * reads data from its input port, and writes the results using the
+     * output port.
+     */
+    sdelayn(const sc_module_name& _name,    ///< process name
+            const T& init_val,              ///< initial value
+            const unsigned int& n           ///< number of delay elements
+          ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+              init_val(init_val), ns(n)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("init_val", init_val);
+        add_arg("n", n);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::sdelayn";}
+    
+private:
+    // Initial value
+    T init_val;
+    unsigned int ns;
+    
+    // Inputs and output variables
+    T val;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (is_restored()) return;
+        for (int i=0; i<ns; i++)
+            write_multiport(oport1, abst_ext<T>(init_val));
+    }
+    
+    void prep()
+    {
+        auto ival1_temp = iport1.read();
+        CHECK_PRESENCE(ival1_temp);
+        val = unsafe_from_abst_ext(std::move(ival1_temp));
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<T>(val));
+    }
+    
+    void clean()
+    {
+    }
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a strict Moore machine
+/*! This class is used to build a finite state machine of type Moore.
+ * Given an initial state, a next-state function, and an output decoding
+ * function it creates a Moore process.
+ */
+template <class IT, class ST, class OT>
+class smoore : public sy_process
+{
+public:
+    SY_in<IT>  iport1;        ///< port for the input channel
+    SY_out<OT> oport1;        ///< port for the output channel
+    
+    //! Type of the next-state function to be passed to the process constructor
+    typedef std::function<void(ST&, const ST&, const IT&)> ns_functype;
+    
+    //! Type of the output-decoding function to be passed to the process constructor
+    typedef std::function<void(OT&, const ST&)> od_functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented functions to the input and current
+     * state and writes the results using the output port
+     */
+    smoore(const sc_module_name& _name,      ///< process name
+           const ns_functype& _ns_func, ///< The next_state function
+           const od_functype& _od_func, ///< The output-decoding function
+           const ST& init_st  ///< Initial state
+          ) : sy_process(_name), _ns_func(_ns_func), _od_func(_od_func),
+              init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::smoore";}
+    
+private:
+    //! The functions passed to the process constructor
+    ns_functype _ns_func;
+    od_functype _od_func;
+    // Initial value
+    ST init_st;
+    
     bool first_run;
     
     // Input, output, current state, and next state variables
-    IT* ival;
-    ST* stval;
-    ST* nsval;
-    OT* oval;
+    IT ival;
+    ST stval;
+    ST nsval;
+    OT oval;
 
     //Implementing the abstract semantics
     void init()
     {
-        ival = new IT;
-        stval = new ST;
-        *stval = init_st;
-        nsval = new ST;
-        oval = new OT;
+        stval = init_st;
         // First evaluation cycle
         first_run = true;
     }
@@ -1215,7 +1990,7 @@ private:
         {
             auto ival_temp = iport1.read();
             CHECK_PRESENCE(ival_temp);
-            *ival = unsafe_from_abst_ext(ival_temp);
+            ival = unsafe_from_abst_ext(std::move(ival_temp));
         }
     }
     
@@ -1225,24 +2000,25 @@ private:
             first_run = false;
         else
         {
-            _ns_func(*nsval, *stval, *ival);
-            *stval = *nsval;
+            _ns_func(nsval, stval, ival);
+            stval = nsval;
         }
-        _od_func(*oval, *stval);
+        _od_func(oval, stval);
     }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<OT>(*oval));
+        write_multiport(oport1, abst_ext<OT>(oval));
     }
     
     void clean()
     {
-        delete ival;
-        delete stval;
-        delete nsval;
-        delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, stval, first_run);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, stval, first_run);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1285,13 +2061,9 @@ public:
               init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -1306,47 +2078,276 @@ private:
     ST init_st;
     
     // Input, output, current state, and next state variables
-    IT* ival;
-    ST* stval;
-    ST* nsval;
-    OT* oval;
+    IT ival;
+    ST stval;
+    ST nsval;
+    OT oval;
 
     //Implementing the abstract semantics
     void init()
     {
-        ival = new IT;
-        stval = new ST;
-        *stval = init_st;
-        nsval = new ST;
-        oval = new OT;
+        stval = init_st;
     }
     
     void prep()
     {
         auto ival_temp = iport1.read();
         CHECK_PRESENCE(ival_temp);
-        *ival = unsafe_from_abst_ext(ival_temp);
+        ival = unsafe_from_abst_ext(std::move(ival_temp));
     }
     
     void exec()
     {
-        _ns_func(*nsval, *stval, *ival);
-        _od_func(*oval, *stval, *ival);
-        *stval = *nsval;
+        _ns_func(nsval, stval, ival);
+        _od_func(oval, stval, ival);
+        stval = nsval;
     }
     
     void prod()
     {
-        write_multiport(oport1, abst_ext<OT>(*oval));
+        write_multiport(oport1, abst_ext<OT>(oval));
     }
     
     void clean()
     {
-        delete ival;
-        delete stval;
-        delete nsval;
-        delete oval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, stval);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, stval);}
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! A data-parallel process constructor for a strict Mealy machine over batches of inputs
+/*! Similar to smealy, but each evaluation cycle consumes an array of N
+ * inputs and produces an array of the N corresponding outputs, while the
+ * state is carried from one element to the next and across the cycles.
+ *
+ * If the machine has a small finite set of states, given to the
+ * constructor, the arrays of at least parallel_threshold elements are
+ * evaluated speculatively: the array is split into one chunk per thread
+ * and each chunk except the first one is run from every state of the set,
+ * recording only its final state. The actual state at the start of each
+ * chunk is then found serially by following the recorded final states,
+ * and the outputs of the chunks are computed in parallel from them. It
+ * performs about (S+1)N evaluations of the next-state function for S
+ * states, hence it pays off when S is small compared to the number of
+ * threads. All the reachable states should be in the set, and ST should
+ * be equality comparable. Otherwise the evaluation is sequential.
+ */
+template <class IT, class ST, class OT, std::size_t N>
+class sdpmealy : public sy_process
+{
+public:
+    SY_in<std::array<IT,N>>  iport1;        ///< port for the input channel
+    SY_out<std::array<OT,N>> oport1;        ///< port for the output channel
+
+    //! Type of the next-state function to be passed to the process constructor
+    typedef std::function<void(ST&, const ST&, const IT&)> ns_functype;
+
+    //! Type of the output-decoding function to be passed to the process constructor
+    typedef std::function<void(OT&, const ST&, const IT&)> od_functype;
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * applies the user-imlpemented functions to the input and current
+     * state and writes the results using the output port
+     */
+    sdpmealy(const sc_module_name& _name,      ///< process name
+             const ns_functype& _ns_func, ///< The next_state function
+             const od_functype& _od_func, ///< The output-decoding function
+             const ST& init_st,           ///< Initial state
+             const std::vector<ST>& states=std::vector<ST>(), ///< The set of states
+             size_t parallel_threshold=FORSYDE_DP_THRESHOLD ///< the smallest N evaluated in parallel
+            ) : sy_process(_name), _ns_func(_ns_func), _od_func(_od_func),
+                init_st(init_st), states(states),
+                parallel_threshold(parallel_threshold)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+        add_arg("states", states.size());
+        add_arg("parallel_threshold", parallel_threshold);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::sdpmealy";}
+
+private:
+    //! The functions passed to the process constructor
+    ns_functype _ns_func;
+    od_functype _od_func;
+    // Initial value
+    ST init_st;
+
+    //! The finite set of states of the machine, if it is given
+    std::vector<ST> states;
+
+    //! The arrays smaller than this are evaluated serially
+    size_t parallel_threshold;
+
+    // Input, output and current state variables
+    std::array<IT,N> ival;
+    std::array<OT,N> oval;
+    ST stval;
+
+    //! The final states of the chunks run from each state of the set
+    /*! The entry c*S+s is the index of the final state of chunk c when
+     * it is started from the state s.
+     */
+    std::vector<size_t> ends;
+
+    //! The indices of the actual states at the start of the chunks
+    std::vector<size_t> starts;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        stval = init_st;
+    }
+
+    void prep()
+    {
+        auto ival1_temp = iport1.read();
+        CHECK_PRESENCE(ival1_temp);
+        ival = unsafe_from_abst_ext(std::move(ival1_temp));
+    }
+
+    void exec()
+    {
+        #if defined(FORSYDE_MULTITHREADED) || defined(FORSYDE_OPENMP)
+        if (!states.empty() && N >= parallel_threshold && N >= 2)
+        {
+            parallel_run();
+            return;
+        }
+        #endif
+        stval = run_chunk(0, N, stval, true);
+    }
+
+    //! Runs the machine over the elements [begin,end) from a state
+    /*! The outputs are only computed if requested. It returns the final
+     * state.
+     */
+    ST run_chunk(size_t begin, size_t end, ST st, bool outputs)
+    {
+        ST nsval;
+        for (size_t i=begin; i<end; i++)
+        {
+            _ns_func(nsval, st, ival[i]);
+            if (outputs) _od_func(oval[i], st, ival[i]);
+            std::swap(st, nsval);
+        }
+        return st;
+    }
+
+#if defined(FORSYDE_MULTITHREADED) || defined(FORSYDE_OPENMP)
+    //! The index of a state in the set of states
+    size_t state_index(const ST& st)
+    {
+        auto it = std::find(states.begin(), states.end(), st);
+        if (it == states.end())
+            SC_REPORT_ERROR(name(), "a reachable state is missing from the set of states");
+        return it - states.begin();
+    }
+
+    //! Runs chunk c of the array speculatively
+    /*! The first chunk starts from the current state, hence its outputs
+     * are final.
+     */
+    void speculate_chunk(size_t begin, size_t end, size_t c)
+    {
+        const size_t S = states.size();
+        if (c == 0)
+            ends[0] = state_index(run_chunk(begin, end, stval, true));
+        else
+            for (size_t s=0; s<S; s++)
+                ends[c*S+s] = state_index(run_chunk(begin, end, states[s], false));
+    }
+
+    //! Follows the final states of the chunks from the first one
+    void stitch_chunks(size_t chunks)
+    {
+        const size_t S = states.size();
+        starts.resize(chunks+1);
+        starts[1] = ends[0];
+        for (size_t c=1; c<chunks; c++)
+            starts[c+1] = ends[c*S+starts[c]];
+        stval = states[starts[chunks]];
+    }
+
+    //! Computes the outputs of chunk c from its actual start state
+    void output_chunk(size_t begin, size_t end, size_t c)
+    {
+        run_chunk(begin, end, states[starts[c]], true);
+    }
+
+    //! Evaluates the machine in two parallel passes over the chunks
+    void parallel_run()
+    {
+        const size_t S = states.size();
+        #ifdef FORSYDE_MULTITHREADED
+        data_parallel_pool& pool = data_parallel_pool::get();
+        ends.resize(pool.size()*S);
+        const unsigned chunks = pool.parallel_for(N,
+            [this](size_t begin, size_t end, unsigned c)
+            {
+                speculate_chunk(begin, end, c);
+            });
+        if (chunks <= 1)
+        {
+            stval = states[ends[0]];
+            return;
+        }
+        stitch_chunks(chunks);
+        // the last pass iterates over the chunks of the first one
+        pool.parallel_for(chunks-1,
+            [this,chunks](size_t begin, size_t end, unsigned)
+            {
+                for (size_t c=begin+1; c<end+1; c++)
+                    output_chunk(N*c/chunks, N*(c+1)/chunks, c);
+            });
+        #else
+        #pragma omp parallel
+        {
+            const size_t chunks = std::min<size_t>(omp_get_num_threads(), N);
+            const size_t c = omp_get_thread_num();
+            #pragma omp single
+            ends.resize(chunks*S);
+            if (c < chunks) speculate_chunk(N*c/chunks, N*(c+1)/chunks, c);
+            #pragma omp barrier
+            #pragma omp single
+            stitch_chunks(chunks);
+            if (c > 0 && c < chunks) output_chunk(N*c/chunks, N*(c+1)/chunks, c);
+        }
+        #endif
+    }
+#endif
+
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<std::array<OT,N>>(oval));
+    }
+
+    void clean()
+    {
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, stval);}
+
+    void restore_state(const char*& pos) {restore_values(pos, stval);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1365,7 +2366,7 @@ private:
  * This class can directly be instantiated to build a process.
  */
 template <class T>
-class sconstant : public sy_process
+class sconstant : public sy_process, public constant_source
 {
 public:
     SY_out<T> oport1;            ///< port for the output channel
@@ -1382,17 +2383,16 @@ public:
                  
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "SY::sconstant";}
+
+    //! Checks if the process produces its tokens forever
+    bool is_endless() const {return take == 0;}
     
 private:
     T init_val;
@@ -1421,6 +2421,11 @@ private:
     
     void clean() {}
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1457,15 +2462,9 @@ public:
               init_st(init_val), take(take), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        ss.str("");
-        ss << take;
-        arg_vec.push_back(std::make_tuple("take", ss.str()));
+        add_func_arg("_func", "_func");
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
@@ -1476,7 +2475,7 @@ private:
     T init_st;        // The current state
     unsigned long long take;    // Number of tokens produced
     
-    T* cur_st;        // The current state of the process
+    T cur_st;        // The current state of the process
     unsigned long long tok_cnt;
     bool infinite;
     
@@ -1486,9 +2485,8 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        cur_st = new T;
-        *cur_st = init_st;
-        write_multiport(oport1, abst_ext<T>(*cur_st));
+        cur_st = init_st;
+        if (!is_restored()) write_multiport(oport1, abst_ext<T>(cur_st));
         infinite = take==0 ? true : false;
         tok_cnt = 1;
     }
@@ -1497,21 +2495,25 @@ private:
     
     void exec()
     {
-        _func(*cur_st, *cur_st);
+        _func(cur_st, cur_st);
     }
     
     void prod()
     {
         if (tok_cnt++ < take || infinite)
-            write_multiport(oport1, abst_ext<T>(*cur_st));
+            write_multiport(oport1, abst_ext<T>(cur_st));
         else wait();
     }
     
     void clean()
     {
-        delete cur_st;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, cur_st, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, cur_st, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1541,9 +2543,7 @@ public:
             ) : sy_process(_name), in_vec(in_vec)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << in_vec;
-        arg_vec.push_back(std::make_tuple("in_vec", ss.str()));
+        add_arg("in_vec", in_vec);
 #endif
     }
     
@@ -1568,16 +2568,18 @@ private:
     void prod()
     {
         if (tok_cnt < in_vec.size())
-        {
-            write_multiport(oport1, abst_ext<T>(in_vec[tok_cnt]));
-            tok_cnt++;
-        }
+            write_multiport(oport1, abst_ext<T>(in_vec[tok_cnt++]));
         else
             wait();
     }
     
     void clean() {}
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1611,9 +2613,7 @@ public:
             
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
 
@@ -1621,7 +2621,7 @@ public:
     std::string forsyde_kind() const {return "SY::ssink";}
     
 private:
-    T* val;         // The current state of the process
+    T val;         // The current state of the process
 
     //! The function passed to the process constructor
     functype _func;
@@ -1629,26 +2629,24 @@ private:
     //Implementing the abstract semantics
     void init()
     {
-        val = new T;
     }
     
     void prep()
     {
         auto val_temp = iport1.read();
         CHECK_PRESENCE(val_temp);
-        *val = unsafe_from_abst_ext(val_temp);
+        val = unsafe_from_abst_ext(std::move(val_temp));
     }
     
     void exec()
     {
-        _func(*val);
+        _func(val);
     }
     
     void prod() {}
     
     void clean()
     {
-        delete val;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1685,13 +2683,11 @@ public:
     
 private:
     // intermediate values
-    T1* ival1;
-    T2* ival2;
+    T1 ival1;
+    T2 ival2;
     
     void init()
     {
-        ival1 = new T1;
-        ival2 = new T2;
     }
     
     void prep()
@@ -1700,22 +2696,20 @@ private:
         auto ival2_temp = iport2.read();
         CHECK_PRESENCE(ival1_temp);
         CHECK_PRESENCE(ival2_temp);
-        *ival1 = unsafe_from_abst_ext(ival1_temp);
-        *ival2 = unsafe_from_abst_ext(ival2_temp);
+        ival1 = unsafe_from_abst_ext(std::move(ival1_temp));
+        ival2 = unsafe_from_abst_ext(std::move(ival2_temp));
     }
     
     void exec() {}
     
     void prod()
     {
-        auto outval = abst_ext<std::tuple<T1,T2>>(std::make_tuple(*ival1,*ival2));
+        auto outval = abst_ext<std::tuple<T1,T2>>(std::make_tuple(ival1,ival2));
         write_multiport(oport1, outval);  // write to the output
     }
     
     void clean()
     {
-        delete ival1;
-        delete ival2;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1764,7 +2758,7 @@ private:
         {
             auto ival_temp = iport[i].read();
             CHECK_PRESENCE(ival_temp);
-            ival[i] = unsafe_from_abst_ext(ival_temp);
+            ival[i] = unsafe_from_abst_ext(std::move(ival_temp));
         }
     }
     
@@ -1813,11 +2807,10 @@ public:
     std::string forsyde_kind() const {return "SY::szipN";}
 private:
     // intermediate values
-    std::tuple<Ts...>* in_vals;
+    std::tuple<Ts...> in_vals;
     
     void init()
     {
-        in_vals = new std::tuple<Ts...>;
     }
     
     void prep()
@@ -1828,10 +2821,10 @@ private:
                     [&](){
                         auto val_temp = port.read();
                         if (is_absent(val_temp)) SC_REPORT_ERROR("szipN","Unexpected absent value received in");
-                        val = unsafe_from_abst_ext(val_temp);
+                        val = unsafe_from_abst_ext(std::move(val_temp));
                     }()
                 , ...);
-            }, *in_vals);
+            }, in_vals);
         }, iport);
     }
     
@@ -1839,12 +2832,11 @@ private:
     
     void prod()
     {
-        write_multiport(oport1,abst_ext<std::tuple<Ts...>>(*in_vals));    // write to the output
+        write_multiport(oport1,abst_ext<std::tuple<Ts...>>(in_vals));    // write to the output
     }
     
     void clean()
     {
-        delete in_vals;
     }
 
  #ifdef FORSYDE_INTROSPECTION
@@ -1889,30 +2881,28 @@ public:
     std::string forsyde_kind() const {return "SY::sunzip";}
 private:
     // intermediate values
-    abst_ext<std::tuple<T1,T2>>* in_val;
+    abst_ext<std::tuple<T1,T2>> in_val;
     
     void init()
     {
-        in_val = new abst_ext<std::tuple<T1,T2>>;
     }
     
     void prep()
     {
-        *in_val = iport1.read();
-        CHECK_PRESENCE(*in_val);
+        in_val = iport1.read();
+        CHECK_PRESENCE(in_val);
     }
     
     void exec() {}
     
     void prod()
     {
-        write_multiport(oport1,abst_ext<T1>(std::get<0>(*in_val)));  // write to the output 1
-        write_multiport(oport2,abst_ext<T2>(std::get<1>(*in_val)));  // write to the output 2
+        write_multiport(oport1,abst_ext<T1>(std::get<0>(in_val)));  // write to the output 1
+        write_multiport(oport2,abst_ext<T2>(std::get<1>(in_val)));  // write to the output 2
     }
     
     void clean()
     {
-        delete in_val;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -1950,17 +2940,16 @@ public:
     std::string forsyde_kind() const {return "SY::sunzipX";}
 private:
     // intermediate values
-    abst_ext<std::array<T1,N>>* in_val;
+    abst_ext<std::array<T1,N>> in_val;
     
     void init()
     {
-        in_val = new abst_ext<std::array<T1,N>>;
     }
     
     void prep()
     {
-        *in_val = iport1.read();
-        CHECK_PRESENCE(*in_val);
+        in_val = iport1.read();
+        CHECK_PRESENCE(in_val);
     }
     
     void exec() {}
@@ -1968,12 +2957,11 @@ private:
     void prod()
     {
         for (size_t i=0; i<N; i++)
-            write_multiport(oport[i],abst_ext<T1>(in_val->unsafe_from_abst_ext()[i]));  // write to the output i
+            write_multiport(oport[i],abst_ext<T1>(in_val.unsafe_from_abst_ext()[i]));  // write to the output i
     }
     
     void clean()
     {
-        delete in_val;
     }
     
 #ifdef FORSYDE_INTROSPECTION
@@ -2011,17 +2999,16 @@ public:
     std::string forsyde_kind() const {return "SY::sunzipN";}
 private:
     // intermediate values
-    abst_ext<std::tuple<Ts...>>* in_val;
+    abst_ext<std::tuple<Ts...>> in_val;
     
     void init()
     {
-        in_val = new abst_ext<std::tuple<Ts...>>;
     }
     
     void prep()
     {
-        *in_val = iport1.read();
-        CHECK_PRESENCE(*in_val);
+        in_val = iport1.read();
+        CHECK_PRESENCE(in_val);
     }
     
     void exec() {}
@@ -2029,13 +3016,12 @@ private:
     void prod()
     {
         std::apply([&](auto&&... port){
-            (write_multiport(port, in_val->unsafe_from_abst_ext()), ...);
+            (write_multiport(port, in_val.unsafe_from_abst_ext()), ...);
         }, oport);
     }
     
     void clean()
     {
-        delete in_val;
     }
  
 #ifdef FORSYDE_INTROSPECTION
@@ -2080,9 +3066,7 @@ public:
          :sy_process(_name), samples(samples)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << samples;
-        arg_vec.push_back(std::make_tuple("samples", ss.str()));
+        add_arg("samples", samples);
 #endif
     }
     
@@ -2096,13 +3080,12 @@ private:
     unsigned long samples_took;
     
     // The output vector
-    std::vector<T>* oval;
+    std::vector<T> oval;
     
     //Implementing the abstract semantics
     void init()
     {
-        oval = new std::vector<T>;
-        oval->resize(samples);
+        oval.resize(samples);
         samples_took = 0;
     }
     
@@ -2110,7 +3093,7 @@ private:
     {
         auto val_temp = iport1.read();
         CHECK_PRESENCE(val_temp);
-        (*oval)[samples_took] = unsafe_from_abst_ext(val_temp);
+        oval[samples_took] = unsafe_from_abst_ext(std::move(val_temp));
         samples_took++;
     }
     
@@ -2120,7 +3103,7 @@ private:
     {
         if (samples_took==samples)
         {
-            write_multiport(oport1, abst_ext<std::vector<T>>(*oval));
+            write_multiport(oport1, abst_ext<std::vector<T>>(oval));
             samples_took = 0;
         }
         else
@@ -2129,7 +3112,6 @@ private:
     
     void clean()
     {
-        delete oval;
     }
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
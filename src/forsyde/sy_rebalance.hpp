@@ -0,0 +1,358 @@
+/**********************************************************************
+    * sy_rebalance.hpp -- Distributed execution of SY process         *
+    *                     networks with dynamic load balancing        *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Moving the processes of a synchronous model between    *
+    *          the MPI ranks when the load of the ranks shifts        *
+    *                                                                 *
+    * Usage:   Define FORSYDE_PARALLEL_SIM and FORSYDE_CHECKPOINT to   *
+    *          use it                                                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_REBALANCE_HPP
+#define SY_REBALANCE_HPP
+
+/*! \file sy_rebalance.hpp
+ * \brief Implements an SY executor which rebalances the MPI ranks
+ *
+ *  A static partition of a model stays balanced only as long as the
+ * costs of its processes do not change. This file includes an executor
+ * for SY models partitioned on the MPI ranks, which measures the firing
+ * times of the processes and, at the boundaries of the evaluation cycles,
+ * moves processes from the overloaded ranks to the underloaded ones
+ * together with their states and the tokens of their inputs.
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <mpi.h>
+
+#include "sy_process.hpp"
+#include "sy_cyclic_executive.hpp"
+#include "mpi_transport.hpp"
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! An executor of SY models distributed on MPI ranks with process migration
+/*! Every rank elaborates the complete model and runs one such executor
+ * with the same parameters. The SY processes below the root form a
+ * closed region, which is executed in the order of the cyclic executive
+ * (see sy_region), where each rank only fires the processes it owns. The
+ * tokens of a signal whose ends are owned by different ranks are sent to
+ * the rank of the reader after the writer fires, and the tokens written
+ * by the delays are received at the end of the tick.
+ *
+ *  The initial owners are given by the same mapping of the children of
+ * the root to the ranks as for the partition module, or else the
+ * processes are divided into consecutive blocks. Every given number of
+ * ticks, the ranks add up the firing times of the processes. If the most
+ * loaded rank exceeds the average by more than the given threshold, the
+ * processes are moved greedily from the most to the least loaded rank,
+ * each time the one which lowers the maximum load the most, preferring
+ * the ones connected to the target rank. A moved process takes its state
+ * (see process::save_state()) and the tokens of its inputs to its new
+ * rank, hence the stateful processes should be checkpointable. All the
+ * ranks take the same decisions, since they are computed from the same
+ * statistics.
+ */
+class rebalancing_executor : public sc_module, private sy_region
+{
+public:
+    //! The constructor requires the module name and the root of the model
+    rebalancing_executor(sc_module_name _name,     ///< The module name
+        sc_module* root,                            ///< The root of the model
+        const std::map<std::string,int>& mapping={},///< The rank of the children of the root
+        unsigned period=1000,                       ///< The ticks between two rebalancings (0 disables them)
+        double threshold=0.1,                       ///< The tolerated excess of the maximum load over the average
+        unsigned max_moves=4,                       ///< The maximum number of processes moved at once
+        int base_tag=0                              ///< The tag of the first signal
+        ) : sc_module(_name), root(root), mapping(mapping), period(period),
+            threshold(threshold), max_moves(max_moves), base_tag(base_tag)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! The current rank of a process
+    int rank_of(const sy_process* p) const
+    {
+        for (size_t i=0; i<procs.size(); i++)
+            if (procs[i] == p) return owner[i];
+        return -1;
+    }
+
+    //! The number of evaluation cycles completed so far
+    unsigned long long ticks() const {return tick_cnt;}
+
+    //! The number of processes moved so far
+    unsigned long long migrations() const {return moved;}
+
+    //! The executor is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_rebalancing_executor";}
+
+private:
+    SC_HAS_PROCESS(rebalancing_executor);
+
+    //! A signal of the model, with its ends
+    struct link
+    {
+        static_channel* chan;
+        size_t writer, reader;
+        bool delayed;                   // written by a delay
+        std::vector<char> buf;          // the tokens being sent
+        MPI_Request request;
+    };
+
+    sc_module* root;
+    std::map<std::string,int> mapping;
+    unsigned period;
+    double threshold;
+    unsigned max_moves;
+    int base_tag;
+    int rank = 0, size = 1;
+
+    std::vector<size_t> sched;                  // the processes in the order of a tick
+    std::vector<int> owner;
+    std::vector<link> links;
+    std::vector<std::vector<size_t>> ins, outs; // the links of each process
+    std::vector<double> cost;                   // the firing times since the last rebalancing
+    std::vector<char> empty;                    // the contents of an empty signal
+    unsigned long long tick_cnt = 0, moved = 0;
+
+    //! Builds the links and the initial mapping
+    void end_of_elaboration()
+    {
+        if (root != NULL) collect(root);
+        if (procs.empty()) return;
+        analyze(name(), "the rebalancing executor");
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &size);
+        std::map<sy_process*,size_t> idx;
+        for (size_t i=0; i<procs.size(); i++) idx[procs[i]] = i;
+        for (auto p : sources) sched.push_back(idx[p]);
+        for (auto i : order) sched.push_back(idx[combs[i]]);
+        for (auto p : delays) sched.push_back(idx[p]);
+        // the signals in the order of their names, as the tags
+        std::map<sc_interface*,size_t> writer, reader;
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            for (auto c : channels(procs[i], "sc_fifo_out")) writer[c] = i;
+            for (auto c : channels(procs[i], "sc_fifo_in")) reader[c] = i;
+        }
+        std::map<std::string,sc_interface*> names;
+        for (auto& r : reader)
+            names[dynamic_cast<sc_object*>(r.first)->name()] = r.first;
+        ins.resize(procs.size());
+        outs.resize(procs.size());
+        std::set<sy_process*> delay_set(delays.begin(), delays.end());
+        for (auto& n : names)
+        {
+            const size_t w = writer[n.second], r = reader[n.second];
+            if (dynamic_cast<checkpoint_channel*>(n.second) == NULL)
+                SC_REPORT_ERROR(name(), "only ForSyDe signals are supported by the rebalancing executor");
+            ins[r].push_back(links.size());
+            outs[w].push_back(links.size());
+            links.push_back(link{dynamic_cast<static_channel*>(n.second), w, r,
+                                 delay_set.count(procs[w]) > 0, {}, MPI_REQUEST_NULL});
+        }
+        // the initial owners
+        owner.assign(procs.size(), -1);
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            sc_object* top = procs[i];
+            while (top->get_parent_object() != NULL && top->get_parent_object() != root)
+                top = top->get_parent_object();
+            auto m = mapping.find(top->basename());
+            if (m != mapping.end())
+                owner[i] = m->second;
+            else if (!mapping.empty())
+                SC_REPORT_ERROR(name(), (std::string("no rank is given for ") + top->name()).c_str());
+            else
+                owner[i] = i * size / procs.size();
+        }
+        cost.assign(procs.size(), 0);
+        serializer<std::uint64_t>::write(empty, 0);     // no absent run
+        serializer<std::uint64_t>::write(empty, 0);     // no tokens
+        for (auto p : procs) p->set_ext_driven();
+    }
+
+    checkpoint_channel* contents(const link& l) const
+    {
+        return dynamic_cast<checkpoint_channel*>(l.chan);
+    }
+
+    //! Empties the copy of a signal on this rank
+    void clear(link& l)
+    {
+        const char* pos = empty.data();
+        contents(l)->reload_contents(pos);
+    }
+
+    //! Sends the tokens of a signal to the rank of its reader
+    void send(size_t c)
+    {
+        link& l = links[c];
+        if (l.request != MPI_REQUEST_NULL)
+        {
+            MPI_Status status;
+            mpi_wait(l.request, status);
+        }
+        l.buf.clear();
+        contents(l)->save_contents(l.buf);
+        clear(l);
+        MPI_Isend(l.buf.data(), l.buf.size(), MPI_BYTE, owner[l.reader],
+                  base_tag + c, MPI_COMM_WORLD, &l.request);
+    }
+
+    //! Receives a message and returns its contents
+    std::vector<char> receive(int source, int tag)
+    {
+        MPI_Status status;
+        mpi_probe(source, tag, status);
+        int bytes = 0;
+        MPI_Get_count(&status, MPI_BYTE, &bytes);
+        std::vector<char> buf(bytes);
+        MPI_Recv(buf.data(), bytes, MPI_BYTE, source, tag, MPI_COMM_WORLD, &status);
+        return buf;
+    }
+
+    //! Receives the tokens of a signal from the rank of its writer
+    void receive(size_t c)
+    {
+        auto buf = receive(owner[links[c].writer], base_tag + c);
+        const char* pos = buf.data();
+        contents(links[c])->reload_contents(pos);
+    }
+
+    //! Measures the loads and moves the processes if the ranks are imbalanced
+    void rebalance()
+    {
+        std::vector<double> total(procs.size(), 0);
+        MPI_Allreduce(cost.data(), total.data(), procs.size(), MPI_DOUBLE,
+                      MPI_SUM, MPI_COMM_WORLD);
+        cost.assign(procs.size(), 0);
+        std::vector<double> load(size, 0);
+        double sum = 0;
+        for (size_t i=0; i<procs.size(); i++)
+        {
+            load[owner[i]] += total[i];
+            sum += total[i];
+        }
+        const double avg = sum / size;
+        // the moves, in the order they are applied
+        std::vector<std::pair<size_t,int>> moves;
+        for (unsigned k=0; k<max_moves; k++)
+        {
+            const int hi = std::max_element(load.begin(), load.end()) - load.begin();
+            const int lo = std::min_element(load.begin(), load.end()) - load.begin();
+            if (load[hi] <= avg * (1 + threshold)) break;
+            size_t best = procs.size();
+            double best_max = load[hi];
+            size_t best_conn = 0;
+            for (size_t i=0; i<procs.size(); i++)
+            {
+                if (owner[i] != hi || total[i] <= 0) continue;
+                const double new_max = std::max(load[hi] - total[i], load[lo] + total[i]);
+                size_t conn = 0;
+                for (auto c : ins[i]) conn += owner[links[c].writer] == lo;
+                for (auto c : outs[i]) conn += owner[links[c].reader] == lo;
+                if (new_max < best_max || (best < procs.size() && new_max == best_max && conn > best_conn))
+                {
+                    best = i;
+                    best_max = new_max;
+                    best_conn = conn;
+                }
+            }
+            if (best == procs.size()) break;
+            load[hi] -= total[best];
+            load[lo] += total[best];
+            owner[best] = lo;
+            moves.push_back(std::make_pair(best, hi));
+        }
+        // move the states and the tokens of the inputs
+        const int tag = base_tag + links.size();
+        std::vector<std::vector<char>> bufs(moves.size());
+        std::vector<MPI_Request> requests;
+        for (size_t k=0; k<moves.size(); k++)
+        {
+            const size_t i = moves[k].first;
+            const int from = moves[k].second, to = owner[i];
+            if (rank == from)
+            {
+                procs[i]->ext_save_state(bufs[k]);
+                for (auto c : ins[i])
+                {
+                    contents(links[c])->save_contents(bufs[k]);
+                    clear(links[c]);
+                }
+                requests.push_back(MPI_REQUEST_NULL);
+                MPI_Isend(bufs[k].data(), bufs[k].size(), MPI_BYTE, to, tag,
+                          MPI_COMM_WORLD, &requests.back());
+            }
+            else if (rank == to)
+            {
+                auto buf = receive(from, tag);
+                const char* pos = buf.data();
+                procs[i]->ext_restore_state(pos);
+                for (auto c : ins[i]) contents(links[c])->reload_contents(pos);
+            }
+        }
+        for (auto& request : requests)
+        {
+            MPI_Status status;
+            mpi_wait(request, status);
+        }
+        moved += moves.size();
+    }
+
+    //! The SystemC thread of the executor
+    void worker()
+    {
+        if (procs.empty()) return;
+        start();
+        // the tokens of a signal are kept by the rank of its reader
+        for (auto& l : links)
+            if (owner[l.reader] != rank) clear(l);
+        while (1)
+        {
+            for (auto i : sched)
+            {
+                if (owner[i] != rank) continue;
+                for (auto c : ins[i])
+                    if (owner[links[c].writer] != rank && links[c].chan->num_available() == 0)
+                        receive(c);
+                const auto t0 = std::chrono::steady_clock::now();
+                procs[i]->ext_fire();
+                cost[i] += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+                for (auto c : outs[i])
+                    if (owner[links[c].reader] != rank) send(c);
+            }
+            // the tokens of the next tick written by the delays of the other ranks
+            for (size_t c=0; c<links.size(); c++)
+                if (links[c].delayed && owner[links[c].reader] == rank &&
+                    owner[links[c].writer] != rank)
+                    receive(c);
+            tick_cnt++;
+            if (period > 0 && tick_cnt % period == 0) rebalance();
+        }
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,581 @@
+/**********************************************************************
+    * sy_static_net.hpp -- Statically composed SY networks            *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Describing a network of SY processes as C++ types and  *
+    *          executing it as a single flat step function            *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef SY_STATIC_NET_HPP
+#define SY_STATIC_NET_HPP
+
+/*! \file sy_static_net.hpp
+ * \brief Implements the statically composed networks in the SY MoC
+ *
+ *  This file includes a type-level description of a network of SY
+ * processes, which is compiled into one step function per evaluation
+ * cycle with all the signals as local variables, and a process which
+ * embeds such a network in a regular ForSyDe model, e.g.:
+ *
+ *     struct add1 {void operator()(abst_ext<int>& o, const abst_ext<int>& i) const
+ *                  {o = i + 1;}};
+ *
+ *     typedef SY::static_net<SY::sn::signals<int,int,int>,   // signals 0..2
+ *                            SY::sn::inputs<0>,              // read from the input ports
+ *                            SY::sn::outputs<2>,             // written to the output ports
+ *                            SY::sn::comb<add1, 1, 0>,       // 1 = add1(0)
+ *                            SY::sn::delay<SY::sn::init<0>, 2, 1>  // 2 = delay 0 1
+ *                           > counter;
+ *
+ *     auto p = SY::make_static_net<counter>("counter", std::tie(out), std::tie(inp));
+ *
+ *  A network can also be run directly, without SystemC, by calling its
+ * function operator once per cycle.
+ */
+
+#include <array>
+#include <tuple>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "sy_process.hpp"
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! The vocabulary used to describe the statically composed networks
+/*! A network is described by the types of its signals, which are
+ * numbered from zero, the signals connected to its input and output
+ * ports, and a list of nodes. Each node is named after the process
+ * constructor with the same semantics and takes the numbers of the
+ * signals it writes followed by the ones it reads, in the same order as
+ * the ports of the process constructor.
+ *
+ * The functions are given as types of function objects which are
+ * default-constructible and have the same signatures as the functions
+ * of the process constructors (e.g., void(abst_ext<T0>&, const
+ * abst_ext<T1>&) for comb), so that the calls are inlined. A free
+ * function is adapted by fn.
+ */
+namespace sn
+{
+
+//! The types of the signals of a network
+template <class... Ts> struct signals {};
+
+//! The signals of a network which are read from its input ports
+template <std::size_t... Is> struct inputs {};
+
+//! The signals of a network which are written to its output ports
+template <std::size_t... Is> struct outputs {};
+
+//! A list of signals of a node with several outputs or inputs
+template <std::size_t... Is> struct wires {};
+
+//! Adapts a free function to a function object type
+template <auto Fn>
+struct fn
+{
+    template <class... As>
+    void operator()(As&&... args) const {Fn(std::forward<As>(args)...);}
+};
+
+//! Initializes a state or the initial token of a delay with a constant value
+/*! The value is an integral or an enumeration constant. Other initial
+ * values are given by function objects with the same signature.
+ */
+template <auto V>
+struct init
+{
+    template <class T>
+    void operator()(abst_ext<T>& v) const {v = abst_ext<T>(V);}
+    template <class T>
+    void operator()(T& v) const {v = V;}
+};
+
+//! Initializes the initial token of a delay as absent
+struct absent
+{
+    template <class T>
+    void operator()(abst_ext<T>& v) const {v = abst_ext<T>();}
+};
+
+//! The value type of an absent-extended type
+template <class A> struct abst_value;
+
+template <class T> struct abst_value<abst_ext<T>> {typedef T type;};
+
+//! The value type of a signal in the tuple of the signals of a network
+template <std::size_t I, class Sigs>
+using value_t = typename abst_value<std::tuple_element_t<I,Sigs>>::type;
+
+//! A combinational node with one output and any number of inputs
+/*! Similar to comb, comb2, .. and combN with separate arguments.
+ */
+template <class F, std::size_t O, std::size_t... Is>
+struct comb
+{
+    static constexpr std::array<std::size_t,1> outs = {{O}};
+    static constexpr std::array<std::size_t,sizeof...(Is)> ins = {{Is...}};
+    static constexpr bool registered = false;
+
+    template <class Sigs>
+    struct impl
+    {
+        void init() {}
+        void pre(Sigs&) {}
+        void step(Sigs& s) {F()(std::get<O>(s), std::get<Is>(s)...);}
+        void post(Sigs&) {}
+        template <class V> void states(V&&) {}
+    };
+};
+
+//! A combinational node with several outputs and inputs
+/*! Similar to combMN, the function takes the tuples of the outputs and
+ * the inputs.
+ */
+template <class F, class Os, class Is> struct combMN;
+
+template <class F, std::size_t... Os, std::size_t... Is>
+struct combMN<F, wires<Os...>, wires<Is...>>
+{
+    static constexpr std::array<std::size_t,sizeof...(Os)> outs = {{Os...}};
+    static constexpr std::array<std::size_t,sizeof...(Is)> ins = {{Is...}};
+    static constexpr bool registered = false;
+
+    template <class Sigs>
+    struct impl
+    {
+        void init() {}
+        void pre(Sigs&) {}
+        void step(Sigs& s)
+        {
+            std::tuple<std::tuple_element_t<Os,Sigs>...> ovals;
+            F()(ovals, std::make_tuple(std::get<Is>(s)...));
+            std::tie(std::get<Os>(s)...) = ovals;
+        }
+        void post(Sigs&) {}
+        template <class V> void states(V&&) {}
+    };
+};
+
+//! A delay node
+/*! The initial token is set by the function object Init. The output is
+ * produced from the stored token at the beginning of each cycle, hence
+ * a delay may read a signal written by a later node and closes the
+ * feedback loops.
+ */
+template <class Init, std::size_t O, std::size_t I>
+struct delay
+{
+    static constexpr std::array<std::size_t,1> outs = {{O}};
+    static constexpr std::array<std::size_t,1> ins = {{I}};
+    static constexpr bool registered = true;
+
+    template <class Sigs>
+    struct impl
+    {
+        std::tuple_element_t<O,Sigs> state;
+
+        void init() {Init()(state);}
+        void pre(Sigs& s) {std::get<O>(s) = state;}
+        void step(Sigs&) {}
+        void post(Sigs& s) {state = std::get<I>(s);}
+        template <class V> void states(V&& v) {v(state);}
+    };
+};
+
+//! A Mealy machine node
+/*! Similar to mealy, with the state of type ST initialized by the
+ * function object Init.
+ */
+template <class ST, class NS, class OD, class Init, std::size_t O, std::size_t I>
+struct mealy
+{
+    static constexpr std::array<std::size_t,1> outs = {{O}};
+    static constexpr std::array<std::size_t,1> ins = {{I}};
+    static constexpr bool registered = false;
+
+    template <class Sigs>
+    struct impl
+    {
+        ST state, next;
+
+        void init() {Init()(state);}
+        void pre(Sigs&) {}
+        void step(Sigs& s)
+        {
+            OD()(std::get<O>(s), state, std::get<I>(s));
+            NS()(next, state, std::get<I>(s));
+            state = next;
+        }
+        void post(Sigs&) {}
+        template <class V> void states(V&& v) {v(state);}
+    };
+};
+
+//! A Moore machine node
+/*! Similar to moore, with the state of type ST initialized by the
+ * function object Init. As with a delay, the output is produced from
+ * the state at the beginning of each cycle.
+ */
+template <class ST, class NS, class OD, class Init, std::size_t O, std::size_t I>
+struct moore
+{
+    static constexpr std::array<std::size_t,1> outs = {{O}};
+    static constexpr std::array<std::size_t,1> ins = {{I}};
+    static constexpr bool registered = true;
+
+    template <class Sigs>
+    struct impl
+    {
+        ST state, next;
+
+        void init() {Init()(state);}
+        void pre(Sigs& s) {OD()(std::get<O>(s), state);}
+        void step(Sigs&) {}
+        void post(Sigs& s)
+        {
+            NS()(next, state, std::get<I>(s));
+            state = next;
+        }
+        template <class V> void states(V&& v) {v(state);}
+    };
+};
+
+//! A zip node
+/*! Similar to zip, the output signal is of type
+ * std::tuple<abst_ext<T1>,abst_ext<T2>>.
+ */
+template <std::size_t O, std::size_t I1, std::size_t I2>
+struct zip
+{
+    static constexpr std::array<std::size_t,1> outs = {{O}};
+    static constexpr std::array<std::size_t,2> ins = {{I1, I2}};
+    static constexpr bool registered = false;
+
+    template <class Sigs>
+    struct impl
+    {
+        void init() {}
+        void pre(Sigs&) {}
+        void step(Sigs& s)
+        {
+            if (std::get<I1>(s).is_absent() && std::get<I2>(s).is_absent())
+                std::get<O>(s) = std::tuple_element_t<O,Sigs>();
+            else
+                std::get<O>(s) = std::tuple_element_t<O,Sigs>(
+                    value_t<O,Sigs>(std::get<I1>(s), std::get<I2>(s)));
+        }
+        void post(Sigs&) {}
+        template <class V> void states(V&&) {}
+    };
+};
+
+//! An unzip node
+/*! Similar to unzip, the input signal is of type
+ * std::tuple<abst_ext<T1>,abst_ext<T2>>.
+ */
+template <std::size_t O1, std::size_t O2, std::size_t I>
+struct unzip
+{
+    static constexpr std::array<std::size_t,2> outs = {{O1, O2}};
+    static constexpr std::array<std::size_t,1> ins = {{I}};
+    static constexpr bool registered = false;
+
+    template <class Sigs>
+    struct impl
+    {
+        void init() {}
+        void pre(Sigs&) {}
+        void step(Sigs& s)
+        {
+            if (std::get<I>(s).is_absent())
+            {
+                std::get<O1>(s) = std::tuple_element_t<O1,Sigs>();
+                std::get<O2>(s) = std::tuple_element_t<O2,Sigs>();
+            }
+            else
+            {
+                std::get<O1>(s) = std::get<0>(std::get<I>(s).unsafe_from_abst_ext());
+                std::get<O2>(s) = std::get<1>(std::get<I>(s).unsafe_from_abst_ext());
+            }
+        }
+        void post(Sigs&) {}
+        template <class V> void states(V&&) {}
+    };
+};
+
+//! The errors found in the description of a network
+enum net_error {NET_OK, NET_RANGE, NET_ORDER, NET_DRIVERS, NET_UNDRIVEN};
+
+//! Marks the signals written by a node
+template <std::size_t N, std::size_t K>
+constexpr net_error drive_signals(std::array<bool,N>& driven, const std::array<std::size_t,K>& outs)
+{
+    for (std::size_t i=0; i<K; i++)
+    {
+        if (outs[i] >= N) return NET_RANGE;
+        if (driven[outs[i]]) return NET_DRIVERS;
+        driven[outs[i]] = true;
+    }
+    return NET_OK;
+}
+
+//! Checks that the signals read by a node are already written
+template <std::size_t N, std::size_t K>
+constexpr net_error read_signals(const std::array<bool,N>& driven, const std::array<std::size_t,K>& ins)
+{
+    for (std::size_t i=0; i<K; i++)
+    {
+        if (ins[i] >= N) return NET_RANGE;
+        if (!driven[ins[i]]) return NET_ORDER;
+    }
+    return NET_OK;
+}
+
+//! Checks a network in the order of its execution
+/*! The inputs and the outputs of the registered nodes (delay, moore)
+ * are written first, then the other nodes run in their order, and the
+ * registered nodes read their inputs at the end of the cycle.
+ */
+template <std::size_t N, class... Nodes, std::size_t NI, std::size_t NO>
+constexpr net_error check(const std::array<std::size_t,NI>& ins,
+                          const std::array<std::size_t,NO>& outs)
+{
+    std::array<bool,N> driven{};
+    net_error err = drive_signals(driven, ins);
+    ((err = err ? err : Nodes::registered ? drive_signals(driven, Nodes::outs) : NET_OK), ...);
+    ((err = err ? err : Nodes::registered ? NET_OK :
+            read_signals(driven, Nodes::ins) ? read_signals(driven, Nodes::ins) : drive_signals(driven, Nodes::outs)), ...);
+    ((err = err ? err : Nodes::registered ? read_signals(driven, Nodes::ins) : NET_OK), ...);
+    if (err) return err;
+    err = read_signals(driven, outs);
+    return err == NET_ORDER ? NET_UNDRIVEN : err;
+}
+
+}
+
+//! A statically composed network of SY processes
+/*! The network is checked at compile time: each signal should be
+ * written by exactly one node or input, and the nodes other than delay
+ * and moore should be listed in the order of the data flow.
+ *
+ * Each call of the function operator runs one evaluation cycle, i.e.,
+ * all the nodes, with the signals as local variables. Only the states of
+ * the nodes are kept between the cycles.
+ */
+template <class Signals, class Inputs, class Outputs, class... Nodes>
+class static_net;
+
+template <class... Ts, std::size_t... Is, std::size_t... Os, class... Nodes>
+class static_net<sn::signals<Ts...>, sn::inputs<Is...>, sn::outputs<Os...>, Nodes...>
+{
+public:
+    //! The tuple of the signals
+    typedef std::tuple<abst_ext<Ts>...> signals_type;
+    //! The value types of the inputs
+    typedef std::tuple<std::tuple_element_t<Is,std::tuple<Ts...>>...> input_types;
+    //! The value types of the outputs
+    typedef std::tuple<std::tuple_element_t<Os,std::tuple<Ts...>>...> output_types;
+    //! The tuple of the outputs of a cycle
+    typedef std::tuple<std::tuple_element_t<Os,signals_type>...> outputs_type;
+
+private:
+    static constexpr sn::net_error error = sn::check<sizeof...(Ts), Nodes...>(
+        std::array<std::size_t,sizeof...(Is)>{{Is...}},
+        std::array<std::size_t,sizeof...(Os)>{{Os...}});
+    static_assert(error != sn::NET_RANGE, "a node, an input or an output refers to an undefined signal");
+    static_assert(error != sn::NET_ORDER, "a signal is read before it is written; list the nodes in the order of the data flow");
+    static_assert(error != sn::NET_DRIVERS, "a signal is written by more than one node or input");
+    static_assert(error != sn::NET_UNDRIVEN, "an output is not written by any node or input");
+
+public:
+    static_net() {init();}
+
+    //! Resets the states of the nodes
+    void init()
+    {
+        std::apply([](auto&... n) {(n.init(), ...);}, nodes);
+    }
+
+    //! Runs one evaluation cycle and returns the outputs
+    outputs_type operator()(const std::tuple_element_t<Is,signals_type>&... vals)
+    {
+        signals_type s;
+        ((std::get<Is>(s) = vals), ...);
+        std::apply([&s](auto&... n)
+        {
+            (n.pre(s), ...);
+            (n.step(s), ...);
+            (n.post(s), ...);
+        }, nodes);
+        return outputs_type(std::get<Os>(s)...);
+    }
+
+    //! Calls a function on the state of each stateful node
+    template <class V>
+    void for_each_state(V&& v)
+    {
+        std::apply([&v](auto&... n) {(n.states(v), ...);}, nodes);
+    }
+
+private:
+    std::tuple<typename Nodes::template impl<signals_type>...> nodes;
+};
+
+//! Process constructor which embeds a statically composed network
+/*! The process has one port per input and output of the network and
+ * runs one cycle of it per evaluation cycle. It has a static firing
+ * rule, hence it can run in the method mode.
+ */
+template <class Net, class TIs = typename Net::input_types,
+          class TOs = typename Net::output_types>
+class static_net_process;
+
+template <class Net, typename... TIs, typename... TOs>
+class static_net_process<Net, std::tuple<TIs...>, std::tuple<TOs...>> : public sy_process
+{
+public:
+    std::tuple<SY_in<TIs>...>  iport;///< tuple of ports for the input channels
+    std::tuple<SY_out<TOs>...> oport;///< tuple of ports for the output channels
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input ports,
+     * runs a cycle of the network and writes the results using the
+     * output ports
+     */
+    static_net_process(const sc_module_name& _name      ///< process name
+                      ) : sy_process(_name) {}
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const{return "SY::static_net";}
+
+    //! The embedded network
+    Net& net() {return nw;}
+
+private:
+    Net nw;
+    // Input and output variables
+    std::tuple<abst_ext<TIs>...> ivals;
+    std::tuple<abst_ext<TOs>...> ovals;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        nw.init();
+    }
+
+    void prep()
+    {
+        std::apply([&](auto&&... port){
+            std::apply([&](auto&&... val){
+                ((val = port.read()), ...);
+            }, ivals);
+        }, iport);
+    }
+
+    void exec()
+    {
+        ovals = std::apply(nw, ivals);
+    }
+
+    void prod()
+    {
+        std::apply([&](auto&&... port){
+            std::apply([&](auto&&... val){
+                (write_multiport(port, val), ...);
+            }, ovals);
+        }, oport);
+    }
+
+    void clean()
+    {
+    }
+
+    bool firing_rule(std::vector<firing_port>& ins,
+                     std::vector<firing_port>& outs)
+    {
+        std::apply([&](auto&... port) {ins = {rule_port(port, 1)...};}, iport);
+        std::apply([&](auto&... port) {outs = {rule_port(port, 1)...};}, oport);
+        return true;
+    }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf)
+    {
+        nw.for_each_state([&](auto& st) {save_values(buf, st);});
+    }
+
+    void restore_state(const char*& pos)
+    {
+        nw.for_each_state([&](auto& st) {restore_values(pos, st);});
+    }
+#endif
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(sizeof...(TIs));     // input ports
+        std::apply
+        (
+            [&](auto&... ports)
+            {
+                std::size_t n{0};
+                ((boundInChans[n++].port = &ports),...);
+            }, iport
+        );
+        boundOutChans.resize(sizeof...(TOs));    // output ports
+        std::apply
+        (
+            [&](auto&... ports)
+            {
+                std::size_t n{0};
+                ((boundOutChans[n++].port = &ports),...);
+            }, oport
+        );
+    }
+#endif
+};
+
+//! Helper function to construct a process which embeds a static network
+/*! This function is used to construct a static_net_process and connect
+ * its output and input signals, given as tuples of references (e.g.,
+ * using std::tie) in the order of the outputs and the inputs of the
+ * network.
+ */
+template <class Net, class... OIfs, class... IIfs>
+inline static_net_process<Net>* make_static_net(const std::string& pName,
+    const std::tuple<OIfs&...>& outS,
+    const std::tuple<IIfs&...>& inpS
+    )
+{
+    auto p = new static_net_process<Net>(pName.c_str());
+
+    std::apply([&](auto&... port){
+        std::apply([&](auto&... sig){
+            (port(sig), ...);
+        }, inpS);
+    }, p->iport);
+    std::apply([&](auto&... port){
+        std::apply([&](auto&... sig){
+            (port(sig), ...);
+        }, outS);
+    }, p->oport);
+
+    return p;
+}
+
+}
+}
+
+#endif
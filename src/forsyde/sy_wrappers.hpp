@@ -24,6 +24,7 @@
 #include <functional>
 #include <tuple>
 #include <iostream>
+#include <memory>
 
 #include "mi_gdb.h"   //! Based on the GDB/Machine Interface library (libmigdb: http://libmigdb.sourceforge.net/)
 #include <stdio.h>
@@ -32,9 +33,17 @@
 #include <sys/uio.h>
 #include <unistd.h>
 #include <errno.h>
+#include <signal.h>
+#include <sys/wait.h>
 
 #include "abst_ext.hpp"
 #include "sy_process.hpp"
+#include "serializer.hpp"
+#include "pipe_link.hpp"
+#include "shm_ring.hpp"
+#ifdef FORSYDE_WRAPPER_REPLAY
+#include "replay_log.hpp"
+#endif
 
 namespace ForSyDe
 {
@@ -44,11 +53,33 @@ namespace SY
 
 using namespace sc_core;
 
+//! The modes of the GDB wrapper
+enum gdbwrap_mode
+{
+    GDBWRAP_DEBUG,  ///< the model runs under GDB, which exchanges the values
+    GDBWRAP_SHIM    ///< the model runs natively with gdbwrap_shim.h linked in
+};
+
 //! Process constructor for a GDB wrapper with one input and one output
 /*! This class is used to build GDB wrapper with one input and one
  * output. It uses the GDB machine interface (GDB/MI) to communicate
  * with an instance of GDB. The class is parameterized for input and
  * output data-types.
+ * 
+ * In the GDBWRAP_SHIM mode the model is not started under GDB. Instead,
+ * it is built with gdbwrap_shim.h, which implements the same
+ * forsyde_read_in1 and forsyde_write_out hook functions using two
+ * shared memory rings (see shm_ring) created by the wrapper. Hence a
+ * value is exchanged without any GDB round-trips. The values are copied
+ * as raw bytes, hence the input and output types should be trivially
+ * copyable and the same as FORSYDE_SHIM_IN_TYPE and FORSYDE_SHIM_OUT_TYPE
+ * of the shim. The wrapper starts the executable with the prefix of the
+ * rings in the FORSYDE_SHM_PREFIX environment variable and terminates it
+ * at the end of the simulation.
+ * 
+ * With FORSYDE_WRAPPER_REPLAY the exchanged values are recorded, and
+ * replayed in the later runs without starting the model (see
+ * replay_log).
  */
 template <typename T0, typename T1>
 class gdbwrap : public sy_process
@@ -64,12 +95,15 @@ public:
      * using the output port
      */
     gdbwrap(const sc_module_name& _name,      ///< process name
-         const std::string& exec_name         ///< name of the executable file
+         const std::string& exec_name,        ///< name of the executable file
+         gdbwrap_mode mode=GDBWRAP_DEBUG      ///< how the model is executed
          ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
-             exec_name(exec_name)
+             exec_name(exec_name), mode(mode), child(-1)
     {
 #ifdef FORSYDE_INTROSPECTION
         arg_vec.push_back(std::make_tuple("exec_name",exec_name));
+        arg_vec.push_back(std::make_tuple("mode",
+            mode==GDBWRAP_SHIM ? "shim" : "debug"));
 #endif
     }
     
@@ -85,16 +119,31 @@ private:
     
     //! The function passed to the process constructor
     std::string exec_name;
+    //! How the model is executed
+    gdbwrap_mode mode;
     
     // Debugger-specific definitions
     MIDebugger d;
     mi_bkpt *bk_in1, *bk_out;
     
+    // Shim-specific definitions
+    pid_t child;
+    std::unique_ptr<shm_ring> inp_ring, out_ring;
+    std::vector<char> buf;
+    
+#ifdef FORSYDE_WRAPPER_REPLAY
+    replay_log replay;
+#endif
+    
     //Implementing the abstract semantics
     void init()
     {
       oval = new T0;
       ival1 = new abst_ext<T1>;
+#ifdef FORSYDE_WRAPPER_REPLAY
+      if (replay.open(name())) return;
+#endif
+      if (mode == GDBWRAP_SHIM) return init_shim();
       // Connect to gdb child.
       if (!d.Connect())
         SC_REPORT_ERROR(name(),"Connection to child GDB instance failed.");
@@ -122,7 +171,24 @@ private:
     void prep()
     {
         *ival1 = iport1.read();
+        if (mode == GDBWRAP_SHIM)
+        {
+            buf.clear();
+            serializer<T1>::write(buf, unsafe_from_abst_ext(*ival1));
+#ifdef FORSYDE_WRAPPER_REPLAY
+            if (!replay.send(std::string(buf.begin(), buf.end()))) return;
+#endif
+            shm_write_wait(*inp_ring, buf.data(), buf.size());
+            return;
+        }
         ival1_str<<unsafe_from_abst_ext(*ival1);
+#ifdef FORSYDE_WRAPPER_REPLAY
+        if (!replay.send(ival1_str.str()))
+        {
+            ival1_str.str(std::string());
+            return;
+        }
+#endif
         async_run(d.StepOver());
         d.ModifyExpression("forsyde_in1",const_cast<char*>(ival1_str.str().c_str()));
         ival1_str.str(std::string());
@@ -130,14 +196,35 @@ private:
     
     void exec()
     {
+#ifdef FORSYDE_WRAPPER_REPLAY
+      if (replay.replaying()) return;
+#endif
       // Resume execution
-      async_run(d.Continue());
+      if (mode == GDBWRAP_DEBUG) async_run(d.Continue());
     }
     
     void prod()
     {
+#ifdef FORSYDE_WRAPPER_REPLAY
+      if (replay.replaying()) return replay_output();
+#endif
+      if (mode == GDBWRAP_SHIM)
+      {
+        shm_read_wait(*out_ring, buf);
+        if (buf.empty()) wait(); // The model has terminated
+#ifdef FORSYDE_WRAPPER_REPLAY
+        replay.record(std::string(buf.begin(), buf.end()));
+#endif
+        const char* pos = buf.data();
+        serializer<T0>::read(pos, *oval);
+        write_multiport(oport1, abst_ext<T0>(*oval))
+        return;
+      }
       async_run(d.StepOver());
       oval_str.str(d.EvalExpression("forsyde_out"));
+#ifdef FORSYDE_WRAPPER_REPLAY
+      replay.record(oval_str.str());
+#endif
       oval_str >> *oval;
       oval_str.clear();
       write_multiport(oport1, abst_ext<T0>(*oval))
@@ -148,12 +235,50 @@ private:
     
     void clean()
     {
-      d.TargetUnselect();
-      d.Disconnect();
+#ifdef FORSYDE_WRAPPER_REPLAY
+      // the model is not started while replaying
+      const bool started = !replay.replaying();
+      replay.close();
+#else
+      const bool started = true;
+#endif
+      if (mode == GDBWRAP_SHIM)
+      {
+        if (child > 0)
+        {
+          kill(child, SIGTERM);
+          waitpid(child, NULL, 0);
+        }
+        inp_ring.reset();
+        out_ring.reset();
+      }
+      else if (started)
+      {
+        d.TargetUnselect();
+        d.Disconnect();
+      }
       delete ival1;
       delete oval;
     }
     
+    //! Creates the rings and starts the model with the shim
+    void init_shim()
+    {
+      const std::string prefix = "/forsyde_" + std::to_string(getpid()) +
+                                 "_" + basename();
+      inp_ring.reset(new shm_ring(prefix + "_inp", true));
+      out_ring.reset(new shm_ring(prefix + "_out", true));
+      child = fork();
+      if (child == 0)
+      {
+        setenv("FORSYDE_SHM_PREFIX", prefix.c_str(), 1);
+        execl(exec_name.c_str(), exec_name.c_str(), (char*)NULL);
+        _exit(127);
+      }
+      if (child < 0)
+        SC_REPORT_ERROR(name(),"Error executing the external model");
+    }
+    
     inline void async_run(int res)
     {
       if (!res)
@@ -167,6 +292,26 @@ private:
         SC_REPORT_ERROR(name(),mi_error_from_gdb);
     }
     
+#ifdef FORSYDE_WRAPPER_REPLAY
+    //! Writes the output of the model from the recording
+    void replay_output()
+    {
+      const std::string vals = replay.replay();
+      if (mode == GDBWRAP_SHIM)
+      {
+        const char* pos = vals.data();
+        serializer<T0>::read(pos, *oval);
+      }
+      else
+      {
+        oval_str.str(vals);
+        oval_str >> *oval;
+        oval_str.clear();
+      }
+      write_multiport(oport1, abst_ext<T0>(*oval))
+    }
+#endif
+    
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -178,11 +323,116 @@ private:
 #endif
 };
 
+//! Writes the lines of a transaction to the input pipe of a text protocol
+/*! The pipe is polled while it is full, and the control is given to the
+ * other processes only if it does not become writable within the poll
+ * timeout.
+ */
+inline void pipe_write_text(const char* pName, FILE* inp_pipe, const std::string& lines)
+{
+    size_t sent = 0;
+    while (true)
+    {
+        sent += fwrite(lines.data()+sent, 1, lines.size()-sent, inp_pipe);
+        if (sent == lines.size() && fflush(inp_pipe) == 0) return;
+        if (ferror(inp_pipe) && errno==EAGAIN)
+        {
+            clearerr(inp_pipe);
+            if (!pipe_link::ready(fileno(inp_pipe), POLLOUT)) wait(SC_ZERO_TIME);
+        }
+        else
+            SC_REPORT_ERROR(pName,"Error writing to the input pipe.");
+    }
+}
+
+//! Reads a line from the output pipe of a text protocol
+/*! The line may be of any length. After the first line, the end of the
+ * file means the model has terminated, which suspends the caller.
+ */
+inline std::string pipe_read_text(const char* pName, FILE* out_pipe, bool& initiated)
+{
+    std::string line;
+    char buf[256];
+    while (line.empty() || line.back() != '\n')
+    {
+        if (fgets(buf,sizeof(buf),out_pipe) != NULL)
+        {
+            line += buf;
+            continue;
+        }
+        if (feof(out_pipe))
+        {
+            if (initiated) // Input exhausted!
+                wait();
+            else
+            {
+                clearerr(out_pipe);
+                wait(SC_ZERO_TIME);
+            }
+        }
+        else if (ferror(out_pipe) && errno==EAGAIN)
+        {
+            clearerr(out_pipe);
+            if (!pipe_link::ready(fileno(out_pipe), POLLIN)) wait(SC_ZERO_TIME);
+        }
+        else
+            SC_REPORT_ERROR(pName,"Error reading from the output pipe.");
+    }
+    initiated = true;
+    return line;
+}
+
+//! Sends a frame of the binary protocol
+inline void pipe_send_frame(const char* pName, pipe_link& link)
+{
+    pipe_link::status st;
+    while ((st=link.send()) == pipe_link::PIPE_AGAIN)
+        wait(SC_ZERO_TIME);
+    if (st != pipe_link::PIPE_OK)
+        SC_REPORT_ERROR(pName,"Error writing to the input pipe.");
+}
+
+//! Receives a frame of the binary protocol
+/*! After the first frame, the end of the file means the model has
+ * terminated, which suspends the caller.
+ */
+inline void pipe_receive_frame(const char* pName, pipe_link& link, bool& initiated)
+{
+    pipe_link::status st;
+    while ((st=link.receive()) != pipe_link::PIPE_OK)
+    {
+        if (st == pipe_link::PIPE_EOF && initiated) // Input exhausted!
+            wait();
+        else if (st == pipe_link::PIPE_EOF || st == pipe_link::PIPE_AGAIN)
+            wait(SC_ZERO_TIME);
+        else
+            SC_REPORT_ERROR(pName,"Error reading from the output pipe.");
+    }
+    initiated = true;
+}
+
 //! Process constructor for a pipe wrapper with one input and one output
 /*! This class is used to build pipe wrapper with one input and one
  * output. It uses the Unix pipe to communicate and synchronize with an
  * external simulator. The class is parameterized for input and output
  * data-types.
+ * 
+ * In the text protocol each token is written to the model as a line
+ * formatted by the output stream operator, and each output is read as
+ * a line parsed by the input stream operator. In the binary protocol
+ * the tokens of a transaction are serialized into a single frame (see
+ * pipe_link) and the outputs are deserialized from a single frame,
+ * using ForSyDe::serializer.
+ * 
+ * A transaction exchanges a batch of tokens, i.e., the wrapper reads
+ * the given number of tokens from its input, sends them to the model
+ * and then writes the same number of outputs received from the model.
+ * Batching reduces the number of round-trips but requires that the
+ * model does not depend on its outputs within a batch (e.g., through a
+ * feedback loop).
+ * 
+ * With FORSYDE_WRAPPER_REPLAY the exchanged values are recorded, and
+ * replayed in the later runs without opening the pipes (see replay_log).
  */
 template <typename T0, typename T1>
 class pipewrap : public sy_process
@@ -198,12 +448,18 @@ public:
      */
     pipewrap(const sc_module_name& _name,     ///< process name
          const int& offset,                   ///< The offset between the input and output. Positive: read from the model first. Negative: write to the model first.
-         const std::string& pipe_path         ///< name of the folder containing forsyde_in1 and forsyde_out pipes
+         const std::string& pipe_path,        ///< name of the folder containing forsyde_in1 and forsyde_out pipes
+         pipe_protocol protocol=PIPE_TEXT,    ///< the protocol used on the pipes
+         unsigned int batch=1                 ///< the number of tokens per transaction
          ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
-             offset(offset), pipe_path(pipe_path)
+             offset(offset), pipe_path(pipe_path), protocol(protocol),
+             batch(batch>0 ? batch : 1)
     {
 #ifdef FORSYDE_INTROSPECTION
         arg_vec.push_back(std::make_tuple("pipe_path",pipe_path));
+        arg_vec.push_back(std::make_tuple("protocol",
+            protocol==PIPE_BINARY ? "binary" : "text"));
+        add_arg("batch", this->batch);
 #endif
     }
     
@@ -221,13 +477,21 @@ private:
     int offset;
     //! The function passed to the process constructor
     std::string pipe_path;
+    //! The protocol used on the pipes
+    pipe_protocol protocol;
+    //! The number of tokens per transaction
+    unsigned int batch;
     
     // Communication pipes
+    pipe_link link;
     FILE* inp_pipe;      // Input (to the external model) pipe
     FILE* out_pipe;      // Output (from the external model) pipe
-    int inp_pipe_fd, out_pipe_fd;
     bool initiated;
     
+#ifdef FORSYDE_WRAPPER_REPLAY
+    replay_log replay;
+#endif
+    
     //Implementing the abstract semantics
     void init()
     {
@@ -235,48 +499,49 @@ private:
       ival1 = new abst_ext<T1>;
       
       initiated =false;
-      inp_pipe_fd = out_pipe_fd = 0;
       
+#ifdef FORSYDE_WRAPPER_REPLAY
+      if (replay.open(name())) return;
+#endif
       // Open the pipes. They might be opened in any order
-      ival_str.str(pipe_path + "/" + basename() + "_inp");
-      oval_str.str(pipe_path + "/" + basename() + "_out");
-      
       // TODO: improve error detection for openning the pipes
-      while (inp_pipe_fd<=0 || out_pipe_fd<=0) // both pipes are not open
-      {
-        if (inp_pipe_fd<=0)
-        {
-          inp_pipe_fd = open(ival_str.str().c_str(), O_WRONLY|O_NONBLOCK);
-          if (inp_pipe_fd > 0)
-            inp_pipe = fdopen(inp_pipe_fd, "w");
-        }
-        if (out_pipe_fd<=0)
-        {
-          out_pipe_fd = open(oval_str.str().c_str(), O_RDONLY|O_NONBLOCK);
-          if (out_pipe_fd > 0)
-            out_pipe = fdopen(out_pipe_fd, "r");
-        }
+      while (!link.try_open(pipe_path + "/" + basename() + "_inp",
+                            pipe_path + "/" + basename() + "_out"))
         wait(SC_ZERO_TIME);
+      if (protocol == PIPE_TEXT)
+      {
+        inp_pipe = fdopen(link.input_fd(), "w");
+        out_pipe = fdopen(link.output_fd(), "r");
       }
-      ival_str.str(std::string());
-      oval_str.str(std::string());
     }
     
     void prep()
     {
-        *ival1 = iport1.read();
-        ival_str<<unsafe_from_abst_ext(*ival1);
-        
-        while(fprintf(inp_pipe,"%s\n",ival_str.str().c_str())==0)
+        if (protocol == PIPE_BINARY)
         {
-            if (ferror(inp_pipe) && errno==EAGAIN)
+            link.begin_frame();
+            for (unsigned int i=0; i<batch; i++)
             {
-                clearerr(inp_pipe);
-                wait(SC_ZERO_TIME);
+                *ival1 = iport1.read();
+                serializer<T1>::write(link.frame(), unsafe_from_abst_ext(*ival1));
             }
-            else
-                SC_REPORT_ERROR(name(),"Error writing to the input pipe.");
+#ifdef FORSYDE_WRAPPER_REPLAY
+            if (!replay.send(std::string(link.frame().begin()+sizeof(std::uint32_t),
+                                         link.frame().end())))
+                return;
+#endif
+            pipe_send_frame(name(), link);
+            return;
         }
+        for (unsigned int i=0; i<batch; i++)
+        {
+            *ival1 = iport1.read();
+            ival_str<<unsafe_from_abst_ext(*ival1)<<"\n";
+        }
+#ifdef FORSYDE_WRAPPER_REPLAY
+        if (replay.send(ival_str.str()))
+#endif
+        pipe_write_text(name(), inp_pipe, ival_str.str());
         ival_str.str(std::string());
     }
     
@@ -284,41 +549,98 @@ private:
     
     void prod()
     {
-      // FIXME: generalize over the hard coded value 10
-      char buf[80];
-      while(fgets(buf,80,out_pipe)==NULL)
-      {
-          //if (errno==ENXIO) printf("ENXIO\n");
-          if (feof(out_pipe))
-          {
-              if (initiated) // Input exhausted!
-                  wait();
-              else
-              {
-                  clearerr(out_pipe);
-                  wait(SC_ZERO_TIME);
-              }
-          }
-          else if (ferror(out_pipe) && errno==EAGAIN)
-              wait(SC_ZERO_TIME);
-          else
-              SC_REPORT_ERROR(name(),"Error reading from the output pipe.");
-      }
-      initiated = true;
-      
-      oval_str.str(std::string(buf));
-      oval_str >> *oval;
-      oval_str.clear();
-      write_multiport(oport1, abst_ext<T0>(*oval))
+#ifdef FORSYDE_WRAPPER_REPLAY
+        if (replay.replaying()) return replay_outputs();
+#endif
+        if (protocol == PIPE_BINARY)
+        {
+            pipe_receive_frame(name(), link, initiated);
+#ifdef FORSYDE_WRAPPER_REPLAY
+            replay.record(std::string(link.payload(), link.payload_size()));
+#endif
+            const char* pos = link.payload();
+            for (unsigned int i=0; i<batch; i++)
+            {
+                serializer<T0>::read(pos, *oval);
+                write_multiport(oport1, abst_ext<T0>(*oval))
+            }
+            if (pos != link.payload() + link.payload_size())
+                SC_REPORT_ERROR(name(),"Malformed frame from the output pipe.");
+            return;
+        }
+        for (unsigned int i=0; i<batch; i++)
+        {
+            oval_str.str(pipe_read_text(name(), out_pipe, initiated));
+#ifdef FORSYDE_WRAPPER_REPLAY
+            replay.record(oval_str.str());
+#endif
+            oval_str >> *oval;
+            oval_str.clear();
+            write_multiport(oport1, abst_ext<T0>(*oval))
+        }
     }
     
     void clean()
     {
-      fclose(inp_pipe);
-      fclose(out_pipe);
+#ifdef FORSYDE_WRAPPER_REPLAY
+      // the pipes are not opened while replaying
+      const bool started = !replay.replaying();
+      replay.close();
+#else
+      const bool started = true;
+#endif
+      if (protocol == PIPE_TEXT && started)
+      {
+        fclose(inp_pipe);
+        fclose(out_pipe);
+      }
+      else
+        link.close();
       delete ival1;
       delete oval;
     }
+
+#ifdef FORSYDE_RESET
+    //! Keeps the pipes open for the next run
+    /*! The external model is not restarted, hence it should start a new
+     * run by itself (e.g., once it has read the inputs of a run).
+     */
+    void reset()
+    {
+#ifdef FORSYDE_WRAPPER_REPLAY
+        // each run is recorded or replayed from the beginning
+        process::reset();
+#else
+        initiated = false;
+        ival_str.str(std::string());
+#endif
+    }
+#endif
+    
+#ifdef FORSYDE_WRAPPER_REPLAY
+    //! Writes the outputs of a transaction from the recording
+    void replay_outputs()
+    {
+        if (protocol == PIPE_BINARY)
+        {
+            const std::string vals = replay.replay();
+            const char* pos = vals.data();
+            for (unsigned int i=0; i<batch; i++)
+            {
+                serializer<T0>::read(pos, *oval);
+                write_multiport(oport1, abst_ext<T0>(*oval))
+            }
+            return;
+        }
+        for (unsigned int i=0; i<batch; i++)
+        {
+            oval_str.str(replay.replay());
+            oval_str >> *oval;
+            oval_str.clear();
+            write_multiport(oport1, abst_ext<T0>(*oval))
+        }
+    }
+#endif
     
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -336,6 +658,11 @@ private:
  * output. It uses the Unix pipe to communicate and synchronize with an
  * external simulator. The class is parameterized for input and output
  * data-types.
+ * 
+ * The protocols, the batches and the replay are the same as pipewrap, where the
+ * two inputs of a token are written on the same line in the text
+ * protocol and one after the other in the binary protocol. The offset
+ * is counted in transactions.
  */
 template <typename T0, typename T1, typename T2>
 class pipewrap2 : public sy_process
@@ -352,12 +679,18 @@ public:
      */
     pipewrap2(const sc_module_name& _name,    ///< process name
          const int& offset,                   ///< The offset between the input and output. Positive: read from the model first. Negative: write to the model first.
-         const std::string& pipe_path         ///< name of the folder containing forsyde_in1 and forsyde_out pipes
+         const std::string& pipe_path,        ///< name of the folder containing forsyde_in1 and forsyde_out pipes
+         pipe_protocol protocol=PIPE_TEXT,    ///< the protocol used on the pipes
+         unsigned int batch=1                 ///< the number of tokens per transaction
          ) : sy_process(_name), iport1("iport1"), iport2("iport2"), 
-             oport1("oport1"), offset(offset), pipe_path(pipe_path)
+             oport1("oport1"), offset(offset), pipe_path(pipe_path),
+             protocol(protocol), batch(batch>0 ? batch : 1)
     {
 #ifdef FORSYDE_INTROSPECTION
         arg_vec.push_back(std::make_tuple("pipe_path",pipe_path));
+        arg_vec.push_back(std::make_tuple("protocol",
+            protocol==PIPE_BINARY ? "binary" : "text"));
+        add_arg("batch", this->batch);
 #endif
     }
     
@@ -376,13 +709,21 @@ private:
     int offset;
     //! The function passed to the process constructor
     std::string pipe_path;
+    //! The protocol used on the pipes
+    pipe_protocol protocol;
+    //! The number of tokens per transaction
+    unsigned int batch;
     
     // Communication pipes
+    pipe_link link;
     FILE* inp_pipe;      // Input (to the external model) pipe
     FILE* out_pipe;      // Output (from the external model) pipe
-    int inp_pipe_fd, out_pipe_fd;
     bool initiated;
     
+#ifdef FORSYDE_WRAPPER_REPLAY
+    replay_log replay;
+#endif
+    
     //Implementing the abstract semantics
     void init()
     {
@@ -391,52 +732,54 @@ private:
       ival2 = new abst_ext<T2>;
       
       initiated =false;
-      inp_pipe_fd = out_pipe_fd = 0;
       
+#ifdef FORSYDE_WRAPPER_REPLAY
+      if (replay.open(name())) return;
+#endif
       // Open the pipes. They might be opened in any order
-      ival_str.str(pipe_path + "/" + basename() + "_inp");
-      oval_str.str(pipe_path + "/" + basename() + "_out");
-      
       // TODO: improve error detection for openning the pipes
-      while (inp_pipe_fd<=0 || out_pipe_fd<=0) // both pipes are not open
-      {
-        if (inp_pipe_fd<=0)
-        {
-          inp_pipe_fd = open(ival_str.str().c_str(), O_WRONLY|O_NONBLOCK);
-          if (inp_pipe_fd > 0)
-            inp_pipe = fdopen(inp_pipe_fd, "w");
-        }
-        if (out_pipe_fd<=0)
-        {
-          out_pipe_fd = open(oval_str.str().c_str(), O_RDONLY|O_NONBLOCK);
-          if (out_pipe_fd > 0)
-            out_pipe = fdopen(out_pipe_fd, "r");
-        }
+      while (!link.try_open(pipe_path + "/" + basename() + "_inp",
+                            pipe_path + "/" + basename() + "_out"))
         wait(SC_ZERO_TIME);
+      if (protocol == PIPE_TEXT)
+      {
+        inp_pipe = fdopen(link.input_fd(), "w");
+        out_pipe = fdopen(link.output_fd(), "r");
       }
-      ival_str.str(std::string());
-      oval_str.str(std::string());
     }
     
     void prep()
     {
         if (offset<=0)
         {
-            *ival1 = iport1.read();
-            *ival2 = iport2.read();
-            ival_str<<unsafe_from_abst_ext(*ival1)<<" "<<unsafe_from_abst_ext(*ival2);
-            
-            while(fprintf(inp_pipe,"%s\n",ival_str.str().c_str())==0)
+            if (protocol == PIPE_BINARY)
             {
-                if (ferror(inp_pipe) && errno==EAGAIN)
+                link.begin_frame();
+                for (unsigned int i=0; i<batch; i++)
                 {
-                    clearerr(inp_pipe);
-                    wait(SC_ZERO_TIME);
+                    *ival1 = iport1.read();
+                    *ival2 = iport2.read();
+                    serializer<T1>::write(link.frame(), unsafe_from_abst_ext(*ival1));
+                    serializer<T2>::write(link.frame(), unsafe_from_abst_ext(*ival2));
                 }
-                else
-                    SC_REPORT_ERROR(name(),"Error writing to the input pipe.");
+#ifdef FORSYDE_WRAPPER_REPLAY
+                if (!replay.send(std::string(link.frame().begin()+sizeof(std::uint32_t),
+                                             link.frame().end())))
+                    return;
+#endif
+                pipe_send_frame(name(), link);
+                return;
+            }
+            for (unsigned int i=0; i<batch; i++)
+            {
+                *ival1 = iport1.read();
+                *ival2 = iport2.read();
+                ival_str<<unsafe_from_abst_ext(*ival1)<<" "<<unsafe_from_abst_ext(*ival2)<<"\n";
             }
-            fflush(inp_pipe);
+#ifdef FORSYDE_WRAPPER_REPLAY
+            if (replay.send(ival_str.str()))
+#endif
+            pipe_write_text(name(), inp_pipe, ival_str.str());
             ival_str.str(std::string());
         }
     }
@@ -447,32 +790,37 @@ private:
     {
         if (offset>=0)
         {
-            // FIXME: generalize over the hard coded value 80
-            char buf[80];
-            while(fgets(buf,80,out_pipe)==NULL)
+#ifdef FORSYDE_WRAPPER_REPLAY
+            if (replay.replaying())
+                replay_outputs();
+            else
+#endif
+            if (protocol == PIPE_BINARY)
             {
-                //if (errno==ENXIO) printf("ENXIO\n");
-                if (feof(out_pipe))
+                pipe_receive_frame(name(), link, initiated);
+#ifdef FORSYDE_WRAPPER_REPLAY
+                replay.record(std::string(link.payload(), link.payload_size()));
+#endif
+                const char* pos = link.payload();
+                for (unsigned int i=0; i<batch; i++)
                 {
-                    if (initiated) // Input exhausted!
-                        wait();
-                    else
-                    {
-                        clearerr(out_pipe);
-                        wait(SC_ZERO_TIME);
-                    }
+                    serializer<T0>::read(pos, *oval);
+                    write_multiport(oport1, abst_ext<T0>(*oval))
                 }
-                else if (ferror(out_pipe) && errno==EAGAIN)
-                    wait(SC_ZERO_TIME);
-                else
-                    SC_REPORT_ERROR(name(),"Error reading from the output pipe.");
+                if (pos != link.payload() + link.payload_size())
+                    SC_REPORT_ERROR(name(),"Malformed frame from the output pipe.");
             }
-            initiated = true;
-            
-            oval_str.str(std::string(buf));
-            oval_str >> *oval;
-            oval_str.clear();
-            write_multiport(oport1, abst_ext<T0>(*oval))
+            else
+                for (unsigned int i=0; i<batch; i++)
+                {
+                    oval_str.str(pipe_read_text(name(), out_pipe, initiated));
+#ifdef FORSYDE_WRAPPER_REPLAY
+                    replay.record(oval_str.str());
+#endif
+                    oval_str >> *oval;
+                    oval_str.clear();
+                    write_multiport(oport1, abst_ext<T0>(*oval))
+                }
         }
         if (offset<0) offset++;
         else if (offset>0) offset--;
@@ -480,12 +828,66 @@ private:
     
     void clean()
     {
-      fclose(inp_pipe);
-      fclose(out_pipe);
+#ifdef FORSYDE_WRAPPER_REPLAY
+      // the pipes are not opened while replaying
+      const bool started = !replay.replaying();
+      replay.close();
+#else
+      const bool started = true;
+#endif
+      if (protocol == PIPE_TEXT && started)
+      {
+        fclose(inp_pipe);
+        fclose(out_pipe);
+      }
+      else
+        link.close();
       delete ival1;
       delete ival2;
       delete oval;
     }
+
+#ifdef FORSYDE_RESET
+    //! Keeps the pipes open for the next run
+    /*! The external model is not restarted, hence it should start a new
+     * run by itself (e.g., once it has read the inputs of a run).
+     */
+    void reset()
+    {
+#ifdef FORSYDE_WRAPPER_REPLAY
+        // each run is recorded or replayed from the beginning
+        process::reset();
+#else
+        initiated = false;
+        ival_str.str(std::string());
+#endif
+    }
+#endif
+    
+#ifdef FORSYDE_WRAPPER_REPLAY
+    //! Writes the outputs of a transaction from the recording
+    void replay_outputs()
+    {
+        if (protocol == PIPE_BINARY)
+        {
+            const std::string vals = replay.replay();
+            const char* pos = vals.data();
+            for (unsigned int i=0; i<batch; i++)
+            {
+                serializer<T0>::read(pos, *oval);
+                write_multiport(oport1, abst_ext<T0>(*oval))
+            }
+            return;
+        }
+        for (unsigned int i=0; i<batch; i++)
+        {
+            oval_str.str(replay.replay());
+            oval_str >> *oval;
+            oval_str.clear();
+            write_multiport(oport1, abst_ext<T0>(*oval))
+        }
+    }
+#endif
     
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
@@ -500,6 +902,340 @@ private:
 };
 
 
+//! Process constructor for a shared memory wrapper with one input and one output
+/*! This class is used to build a wrapper with one input and one output
+ * which communicates and synchronizes with an external simulator using
+ * two shared memory rings (see shm_ring). The class is parameterized for
+ * input and output data-types.
+ * 
+ * The wrapper creates the rings named <prefix>_<name>_inp, carrying the
+ * inputs to the model, and <prefix>_<name>_out, carrying the outputs
+ * from the model, where <name> is the base name of the process. The
+ * model opens them when they exist. Each message is one token serialized
+ * using ForSyDe::serializer, and an empty message from the model means
+ * it has terminated. No system calls are involved in the exchange of
+ * the tokens as long as the model responds within the spinning period
+ * of the ring.
+ * 
+ * The offset has the same meaning as in pipewrap2.
+ */
+template <typename T0, typename T1>
+class shmwrap : public sy_process
+{
+public:
+    SY_in<T1>  iport1;       ///< port for the input channel
+    SY_out<T0> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port,
+     * provides it to the external model, collects the produced outputs
+     * and writes them using the output port
+     */
+    shmwrap(const sc_module_name& _name,      ///< process name
+         const int& offset,                   ///< The offset between the input and output. Positive: read from the model first. Negative: write to the model first.
+         const std::string& shm_prefix        ///< the prefix of the names of the shared memory segments (starting with '/')
+         ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+             offset(offset), shm_prefix(shm_prefix)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("shm_prefix",shm_prefix));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::shmwrap";}
+
+private:
+    // Inputs and output variables
+    T0 oval;
+    abst_ext<T1> ival1;
+    std::vector<char> ibuf, obuf;
+    
+    //! The offset between the input and output
+    int offset;
+    //! The prefix of the names of the segments
+    std::string shm_prefix;
+    
+    // Communication rings
+    std::unique_ptr<shm_ring> inp_ring;  // Input (to the external model) ring
+    std::unique_ptr<shm_ring> out_ring;  // Output (from the external model) ring
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        const std::string base = shm_prefix + "_" + basename();
+        inp_ring.reset(new shm_ring(base + "_inp", true));
+        out_ring.reset(new shm_ring(base + "_out", true));
+    }
+    
+    void prep()
+    {
+        if (offset<=0)
+        {
+            ival1 = iport1.read();
+            ibuf.clear();
+            serializer<T1>::write(ibuf, unsafe_from_abst_ext(ival1));
+            shm_write_wait(*inp_ring, ibuf.data(), ibuf.size());
+        }
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        if (offset>=0)
+        {
+            shm_read_wait(*out_ring, obuf);
+            if (obuf.empty()) wait(); // The model has terminated
+            const char* pos = obuf.data();
+            serializer<T0>::read(pos, oval);
+            write_multiport(oport1, abst_ext<T0>(oval))
+        }
+        if (offset<0) offset++;
+        else if (offset>0) offset--;
+    }
+    
+    void clean()
+    {
+        inp_ring.reset();
+        out_ring.reset();
+    }
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! A channel to one external simulator shared by several wrappers
+/*! A hub multiplexes the tokens of several muxwrap processes over one
+ * pair of named pipes, <path>/<name>_inp and <path>/<name>_out, using the
+ * frames of the binary protocol (see pipe_link). Once the pipes are
+ * open, the hub sends a frame listing the base names of its members, one
+ * per line, in the order they were attached. Then in each tick, after
+ * all the members have read their inputs, it sends one frame with the
+ * serialized inputs of all the members, and expects one frame back with
+ * their outputs. In both frames the part of each member, in the same
+ * order, is a 32-bit length followed by that many bytes.
+ * 
+ * The tick of the external simulator is hence a single round-trip for
+ * all the members. Since no member gets its output before all of them
+ * have sent their inputs, the inputs of a member should not depend on
+ * the outputs of another member in the same tick.
+ */
+class pipe_hub
+{
+public:
+    //! The constructor requires the name of the hub and the folder of the pipes
+    pipe_hub(const std::string& name, const std::string& pipe_path)
+        : hub_name(name), pipe_path(pipe_path) {}
+
+    //! Attaches a member, returning its index
+    /*! It is called by the constructors of the members.
+     */
+    size_t attach(const std::string& member)
+    {
+        members.push_back(member);
+        reqs.emplace_back();
+        reps.emplace_back(0, 0);
+        return members.size() - 1;
+    }
+
+    //! The name of the hub
+    const std::string& name() const {return hub_name;}
+
+    //! Opens the pipes and announces the members, waiting for the model
+    /*! It is called by the init stages of all the members and only the
+     * first call opens the pipes.
+     */
+    void open()
+    {
+        if (opened) return;
+        if (opening)
+        {
+            while (!opened) wait(open_ev);
+            return;
+        }
+        opening = true;
+        while (!link.try_open(pipe_path + "/" + hub_name + "_inp",
+                              pipe_path + "/" + hub_name + "_out"))
+            wait(SC_ZERO_TIME);
+        link.begin_frame();
+        for (auto& m : members)
+        {
+            link.frame().insert(link.frame().end(), m.begin(), m.end());
+            link.frame().push_back('\n');
+        }
+        pipe_send_frame(hub_name.c_str(), link);
+        opened = true;
+        open_ev.notify();
+    }
+
+    //! The buffer of the inputs of a member in the current tick
+    std::vector<char>& request(size_t id) {return reqs[id];}
+
+    //! Marks the inputs of a member ready, sending the frame once all of them are
+    void submit(size_t id)
+    {
+        if (++submitted < members.size()) return;
+        link.begin_frame();
+        for (auto& r : reqs)
+        {
+            const std::uint32_t len = r.size();
+            link.frame().insert(link.frame().end(), (const char*)&len, (const char*)&len+sizeof(len));
+            link.frame().insert(link.frame().end(), r.begin(), r.end());
+            r.clear();
+        }
+        pipe_send_frame(hub_name.c_str(), link);
+        submitted = 0;
+        sent++;
+        sent_ev.notify();
+    }
+
+    //! Waits for the outputs of a member in the given tick
+    /*! The first member which asks for a tick receives the frame, and the
+     * others wait for it. It returns the outputs of the member, which
+     * stay valid until the frame of the next tick is received.
+     */
+    const char* reply(size_t id, size_t tick, size_t& len)
+    {
+        while (received <= tick)
+        {
+            if (receiving)
+                wait(recv_ev);
+            else if (sent <= tick)
+                wait(sent_ev);
+            else
+            {
+                receiving = true;
+                pipe_receive_frame(hub_name.c_str(), link, initiated);
+                split();
+                receiving = false;
+                received++;
+                recv_ev.notify();
+            }
+        }
+        len = reps[id].second;
+        return link.payload() + reps[id].first;
+    }
+
+    //! Closes the pipes
+    ~pipe_hub() {link.close();}
+
+private:
+    std::string hub_name, pipe_path;
+    std::vector<std::string> members;
+
+    pipe_link link;
+    bool opening = false, opened = false, receiving = false, initiated = false;
+    sc_event open_ev, sent_ev, recv_ev;
+
+    // the inputs of the members in the current tick and the offsets and
+    // lengths of their outputs in the received frame
+    std::vector<std::vector<char>> reqs;
+    std::vector<std::pair<size_t,size_t>> reps;
+    size_t submitted = 0, sent = 0, received = 0;
+
+    //! Locates the outputs of the members in the received frame
+    void split()
+    {
+        size_t pos = 0;
+        const size_t size = link.payload_size();
+        for (auto& r : reps)
+        {
+            std::uint32_t len;
+            if (size - pos < sizeof(len))
+                SC_REPORT_ERROR(hub_name.c_str(), "Malformed frame from the output pipe.");
+            std::memcpy(&len, link.payload()+pos, sizeof(len));
+            pos += sizeof(len);
+            if (size - pos < len)
+                SC_REPORT_ERROR(hub_name.c_str(), "Malformed frame from the output pipe.");
+            r = std::make_pair(pos, size_t(len));
+            pos += len;
+        }
+        if (pos != size)
+            SC_REPORT_ERROR(hub_name.c_str(), "Malformed frame from the output pipe.");
+    }
+};
+
+//! Process constructor for a multiplexed wrapper with one input and one output
+/*! This class is used to build a wrapper which shares a pipe hub, and
+ * hence one external simulator, with the other members of the hub (see
+ * pipe_hub). In each cycle it reads one token, hands it to the hub
+ * serialized using ForSyDe::serializer, and writes the token which the
+ * model returns for it in the frame of the tick. Components with several
+ * inputs can be wrapped after zipping their inputs into a tuple.
+ */
+template <typename T0, typename T1>
+class muxwrap : public sy_process
+{
+public:
+    SY_in<T1>  iport1;       ///< port for the input channel
+    SY_out<T0> oport1;        ///< port for the output channel
+
+    //! The constructor requires the module name and the hub
+    muxwrap(const sc_module_name& _name,      ///< process name
+            pipe_hub& hub                     ///< the hub shared with the model
+            ) : sy_process(_name), iport1("iport1"), oport1("oport1"),
+                hub(hub), id(hub.attach(basename())), tick(0)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        arg_vec.push_back(std::make_tuple("hub", hub.name()));
+#endif
+    }
+    
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::muxwrap";}
+
+private:
+    pipe_hub& hub;
+    size_t id;
+    size_t tick;    // the ticks of the hub, which go on when the model is reset
+    T0 oval;
+    
+    //Implementing the abstract semantics
+    void init()
+    {
+        hub.open();
+    }
+    
+    void prep()
+    {
+        serializer<T1>::write(hub.request(id), unsafe_from_abst_ext(iport1.read()));
+        hub.submit(id);
+    }
+    
+    void exec() {}
+    
+    void prod()
+    {
+        size_t len;
+        const char* pos = hub.reply(id, tick++, len);
+        const char* end = pos + len;
+        serializer<T0>::read(pos, oval);
+        if (pos != end)
+            SC_REPORT_ERROR(name(),"Malformed output in the frame of the hub.");
+        write_multiport(oport1, abst_ext<T0>(oval))
+    }
+    
+    void clean() {}
+    
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
 //! Helper function to construct a gdbwrap process
 /*! This function is used to construct a GDB wrapper process (SystemC
  * module) and connect its output and output signals.
@@ -512,10 +1248,11 @@ template <class T0, template <class> class OIf,
 inline gdbwrap<T0,T1>* make_gdbwrap(const std::string& pName,
     const std::string& exec_name,
     OIf<T0>& outS,
-    I1If<T1>& inp1S
+    I1If<T1>& inp1S,
+    gdbwrap_mode mode=GDBWRAP_DEBUG
     )
 {
-    auto p = new gdbwrap<T0,T1>(pName.c_str(), exec_name);
+    auto p = new gdbwrap<T0,T1>(pName.c_str(), exec_name, mode);
     
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -536,10 +1273,13 @@ inline pipewrap<T0,T1>* make_pipewrap(const std::string& pName,
     const int& offset,
     const std::string& path_name,
     OIf<T0>& outS,
-    I1If<T1>& inp1S
+    I1If<T1>& inp1S,
+    pipe_protocol protocol=PIPE_TEXT,
+    unsigned int batch=1
     )
 {
-    auto p = new pipewrap<T0,T1>(pName.c_str(), offset, path_name);
+    auto p = new pipewrap<T0,T1>(pName.c_str(), offset, path_name,
+                                 protocol, batch);
     
     (*p).iport1(inp1S);
     (*p).oport1(outS);
@@ -562,10 +1302,13 @@ inline pipewrap2<T0,T1,T2>* make_pipewrap2(const std::string& pName,
     const std::string& path_name,
     OIf<T0>& outS,
     I1If<T1>& inp1S,
-    I2If<T2>& inp2S
+    I2If<T2>& inp2S,
+    pipe_protocol protocol=PIPE_TEXT,
+    unsigned int batch=1
     )
 {
-    auto p = new pipewrap2<T0,T1,T2>(pName.c_str(), offset, path_name);
+    auto p = new pipewrap2<T0,T1,T2>(pName.c_str(), offset, path_name,
+                                     protocol, batch);
     
     (*p).iport1(inp1S);
     (*p).iport2(inp2S);
@@ -574,6 +1317,53 @@ inline pipewrap2<T0,T1,T2>* make_pipewrap2(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a shmwrap process
+/*! This function is used to construct a shared memory wrapper process
+ * (SystemC module) and connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline shmwrap<T0,T1>* make_shmwrap(const std::string& pName,
+    const int& offset,
+    const std::string& shm_prefix,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S
+    )
+{
+    auto p = new shmwrap<T0,T1>(pName.c_str(), offset, shm_prefix);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a muxwrap process
+/*! This function is used to construct a multiplexed wrapper process
+ * (SystemC module) and connect its input and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf,
+          class T1, template <class> class I1If>
+inline muxwrap<T0,T1>* make_muxwrap(const std::string& pName,
+    pipe_hub& hub,
+    OIf<T0>& outS,
+    I1If<T1>& inp1S
+    )
+{
+    auto p = new muxwrap<T0,T1>(pName.c_str(), hub);
+    
+    (*p).iport1(inp1S);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 }
 }
 
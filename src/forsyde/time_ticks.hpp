@@ -0,0 +1,77 @@
+/**********************************************************************
+    * time_ticks.hpp -- Integer-tick arithmetic of the timed MoCs     *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Computing with the times of the timed MoCs as integer  *
+    *          ticks of the time resolution                           *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TIME_TICKS_HPP
+#define TIME_TICKS_HPP
+
+/*! \file time_ticks.hpp
+ * \brief Implements the integer-tick arithmetic of the times
+ *
+ *  An sc_time is a 64-bit count of the ticks of the kernel time
+ * resolution, but multiplying it by a number and converting it to
+ * seconds go through doubles and the global time parameters of the
+ * kernel. The timed MoCs (DDE, DT and CT) do so in every evaluation
+ * cycle, e.g., to compute the start of the n-th sampling period or to
+ * pass the step size to a solver. The functions in this file work on
+ * the ticks directly, and only the conversions to seconds read the
+ * resolution, which is a field of the current simulation context. It
+ * is not cached, since a function evaluated during elaboration would
+ * otherwise keep the default resolution if sc_set_time_resolution() is
+ * called afterwards, or keep that of a previous simulation context. The
+ * results are kept as sc_time values, which the kernel and the time
+ * tags of the events (see tt_event) use anyway.
+ */
+
+#include <cstdint>
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A time as a number of ticks of the kernel time resolution
+typedef std::uint64_t ticks;
+
+//! The length of a tick in seconds
+/*! The callers in the loops (e.g., the sampling of the sub-signals) read
+ * it once per call.
+ */
+inline double tick_seconds()
+{
+    return sc_get_time_resolution().to_seconds();
+}
+
+//! Converts a time to ticks
+inline ticks to_ticks(const sc_time& t) {return t.value();}
+
+//! Converts a number of ticks to a time
+inline sc_time from_ticks(ticks n) {return sc_time::from_value(n);}
+
+//! Converts a time to seconds
+inline double in_seconds(const sc_time& t) {return t.value() * tick_seconds();}
+
+//! The signed difference of two times in seconds
+inline double seconds_between(const sc_time& t, const sc_time& o)
+{
+    return double(std::int64_t(t.value() - o.value())) * tick_seconds();
+}
+
+//! Multiplies a time by an integer, without rounding
+inline sc_time scale_time(const sc_time& t, std::uint64_t n)
+{
+    return sc_time::from_value(t.value() * n);
+}
+
+}
+
+#endif
@@ -0,0 +1,355 @@
+/**********************************************************************
+    * timeline.hpp -- Timelines of the process stages                 *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Recording the beginning and the end of the stages of   *
+    *          each firing and writing them as a Chrome trace         *
+    *                                                                 *
+    * Usage:   Define FORSYDE_TIMELINE to enable it                   *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+/*! \file timeline.hpp
+ * \brief Implements the recording of the timelines of the processes
+ *
+ *  This file includes the timeline which records a span for each prep,
+ * exec and prod stage of the processes when FORSYDE_TIMELINE is defined,
+ * and writes them at the end of the simulation in the Chrome trace-event
+ * format, which can be opened by chrome://tracing or Perfetto.
+ *
+ *  Each process is a track (a thread in the trace) and the tracks are
+ * grouped by the composite process (module) containing them. The spans
+ * are placed on the wall-clock time, or on the simulated time when
+ * FORSYDE_TIMELINE_SIM_TIME is defined, and carry the other one in their
+ * arguments. A prep (prod) stage during which the simulated time or the
+ * delta cycle advanced is a blocking interval and is marked as
+ * "blocked".
+ *
+ *  The spans are appended to a buffer owned by the recording thread, so
+ * recording takes no lock even when the processes are fired by parallel
+ * executors. Each thread registers its buffer once.
+ *
+ *  In the parallel simulations, the MPI messages are recorded as flows
+ * from the stage which sent them to the one which received them, and the
+ * timelines of the ranks can be merged into one (see timeline_mpi.hpp).
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <chrono>
+#include <mutex>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+//! The output file of the timeline
+#ifndef FORSYDE_TIMELINE_FILE
+#define FORSYDE_TIMELINE_FILE "forsyde_timeline.json"
+#endif
+
+//! The number of spans in each block of the buffers
+#ifndef FORSYDE_TIMELINE_CHUNK
+#define FORSYDE_TIMELINE_CHUNK 4096
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! A recorded stage of a firing
+struct timeline_span
+{
+    //! The stages of a firing
+    enum stage_kind : std::uint8_t {PREP, EXEC, PROD};
+
+    std::uint32_t track;            ///< the process
+    stage_kind stage;               ///< the stage
+    std::uint32_t deltas;           ///< delta cycles passed during the stage
+    std::uint64_t sim_begin;        ///< simulated time at the beginning (in the time resolution)
+    std::uint64_t sim_end;          ///< simulated time at the end
+    double wall_begin;              ///< wall-clock time at the beginning (in us)
+    double wall_end;                ///< wall-clock time at the end
+};
+
+//! A message sent or received during a stage of a firing
+/*! The two ends of a message have the same identifier and are drawn as
+ * a flow arrow between the stages which sent and received it.
+ */
+struct timeline_flow
+{
+    std::uint32_t track;            ///< the process
+    bool start;                     ///< set for the sending end
+    std::string id;                 ///< the identifier of the message
+    std::uint64_t sim;              ///< simulated time (in the time resolution)
+    double wall;                    ///< wall-clock time (in us)
+};
+
+//! The buffer of the spans recorded by a thread
+/*! It is a list of fixed-size blocks, so that appending never moves the
+ * recorded spans.
+ */
+class timeline_buffer
+{
+public:
+    //! Appends a span
+    void push(const timeline_span& s)
+    {
+        if (chunks.empty() || chunks.back().size() == FORSYDE_TIMELINE_CHUNK)
+        {
+            chunks.emplace_back();
+            chunks.back().reserve(FORSYDE_TIMELINE_CHUNK);
+        }
+        chunks.back().push_back(s);
+    }
+
+    //! The recorded spans
+    const std::vector<std::vector<timeline_span>>& blocks() const {return chunks;}
+
+private:
+    std::vector<std::vector<timeline_span>> chunks;
+};
+
+//! The collector and writer of the timelines
+/*! Each process registers a track in the constructor and reports at the
+ * end of the simulation. The output file is written once all the
+ * registered processes have reported, or when the program exits.
+ */
+class timeline
+{
+public:
+    //! Returns the single instance of the timeline
+    static timeline& get()
+    {
+        static timeline tl;
+        return tl;
+    }
+
+    //! Sets the output file
+    void set_output(const std::string& file_name) {out_file = file_name;}
+
+    //! The output file
+    const std::string& output() const {return out_file;}
+
+    //! Shifts the wall-clock times written, e.g., to align the clocks of several programs
+    void set_offset(double us) {offset_us = us;}
+
+    //! The track running a stage on the calling thread, or npos outside the stages
+    static std::uint32_t& current_track()
+    {
+        static thread_local std::uint32_t track = npos;
+        return track;
+    }
+
+    //! The track of no process
+    static constexpr std::uint32_t npos = std::uint32_t(-1);
+
+    //! Registers a process and returns its track
+    std::uint32_t add_track(const sc_object* p)
+    {
+        const sc_object* parent = p->get_parent_object();
+        const std::string group = parent ? parent->name() : "";
+        auto it = groups.find(group);
+        if (it == groups.end())
+            it = groups.emplace(group, groups.size()+1).first;
+        tracks.push_back(track_info{it->second, p->basename()});
+        return tracks.size()-1;
+    }
+
+    //! Returns the wall-clock time since the start of the program in us
+    double now() const
+    {
+        return std::chrono::duration<double,std::micro>(
+                   std::chrono::steady_clock::now() - origin).count();
+    }
+
+    //! Records a span in the buffer of the calling thread
+    void record(const timeline_span& s)
+    {
+        thread_local timeline_buffer* buf = NULL;
+        if (buf == NULL)
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            res_us = sc_get_time_resolution().to_seconds() * 1e6;
+            buffers.emplace_back(new timeline_buffer);
+            buf = buffers.back().get();
+        }
+        buf->push(s);
+    }
+
+    //! Records an end of a message in the stage running on the calling thread
+    void flow(bool start, const std::string& id)
+    {
+        const std::uint32_t track = current_track();
+        if (track == npos) return;
+        std::lock_guard<std::mutex> lock(mtx);
+        flows.push_back(timeline_flow{track, start, id, sc_time_stamp().value(), now()});
+    }
+
+    //! Reports the end of the simulation for a process
+    void report()
+    {
+        if (++reported == tracks.size()) write();
+    }
+
+    //! Writes the trace events, separated by commas, to a stream
+    /*! The groups of the tracks are numbered from pid_base, and their
+     * names are prefixed, so that the events of several timelines can be
+     * written to one trace. It sets first once anything is written.
+     */
+    void write_events(std::ostream& ofs, bool& first, size_t pid_base=0,
+                      const std::string& prefix="")
+    {
+        auto sep = [&]() {if (!first) ofs << "," << std::endl; first = false;};
+        for (auto& g : groups)
+        {
+            sep();
+            ofs << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid_base + g.second
+                << ",\"args\":{\"name\":";
+            write_string(ofs, prefix + (g.first.empty() ? "(top)" : g.first));
+            ofs << "}}";
+        }
+        for (size_t t=0; t<tracks.size(); t++)
+        {
+            sep();
+            ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid_base + tracks[t].group
+                << ",\"tid\":" << t << ",\"args\":{\"name\":";
+            write_string(ofs, tracks[t].name);
+            ofs << "}}";
+        }
+        static const char* stage_names[] = {"prep", "exec", "prod"};
+        for (auto& b : buffers)
+            for (auto& c : b->blocks())
+                for (auto& s : c)
+                {
+                    const bool blocked = s.stage != timeline_span::EXEC &&
+                                         (s.deltas > 0 || s.sim_end > s.sim_begin);
+#ifdef FORSYDE_TIMELINE_SIM_TIME
+                    const double ts = s.sim_begin * res_us;
+                    const double dur = (s.sim_end - s.sim_begin) * res_us;
+#else
+                    const double ts = s.wall_begin + offset_us;
+                    const double dur = s.wall_end - s.wall_begin;
+#endif
+                    sep();
+                    ofs << "{\"name\":\"" << stage_names[s.stage]
+                        << "\",\"cat\":\"" << (blocked ? "blocked" : "stage")
+                        << "\",\"ph\":\"X\",\"pid\":" << pid_base + tracks[s.track].group
+                        << ",\"tid\":" << s.track << ",\"ts\":" << ts
+                        << ",\"dur\":" << dur << ",\"args\":{"
+#ifdef FORSYDE_TIMELINE_SIM_TIME
+                        << "\"wall_begin_us\":" << s.wall_begin + offset_us
+                        << ",\"wall_end_us\":" << s.wall_end + offset_us
+#else
+                        << "\"sim_begin_us\":" << s.sim_begin * res_us
+                        << ",\"sim_end_us\":" << s.sim_end * res_us
+#endif
+                        << ",\"deltas\":" << s.deltas << "}}";
+                }
+        // the flow events bind to the stages enclosing them
+        for (auto& f : flows)
+        {
+#ifdef FORSYDE_TIMELINE_SIM_TIME
+            const double ts = f.sim * res_us;
+#else
+            const double ts = f.wall + offset_us;
+#endif
+            sep();
+            ofs << "{\"name\":\"message\",\"cat\":\"message\",\"ph\":\""
+                << (f.start ? "s" : "f\",\"bp\":\"e") << "\",\"id\":";
+            write_string(ofs, f.id);
+            ofs << ",\"pid\":" << pid_base + tracks[f.track].group
+                << ",\"tid\":" << f.track << ",\"ts\":" << ts << "}";
+        }
+    }
+
+    ~timeline() {if (!written) write();}
+
+private:
+    struct track_info
+    {
+        size_t group;
+        std::string name;
+    };
+
+    std::string out_file;
+    std::chrono::steady_clock::time_point origin;
+    std::map<std::string,size_t> groups;
+    std::vector<track_info> tracks;
+    std::vector<std::unique_ptr<timeline_buffer>> buffers;
+    std::vector<timeline_flow> flows;
+    std::mutex mtx;
+    double res_us;      // the time resolution in us
+    double offset_us;   // added to the written wall-clock times
+    size_t reported;
+    bool written;
+
+    timeline() : out_file(FORSYDE_TIMELINE_FILE),
+                 origin(std::chrono::steady_clock::now()),
+                 res_us(0), offset_us(0), reported(0), written(false) {}
+
+    //! Writes a string as a JSON string
+    static void write_string(std::ostream& os, const std::string& s)
+    {
+        os << '"';
+        for (char c : s)
+            if (c == '"' || c == '\\') os << '\\' << c;
+            else os << c;
+        os << '"';
+    }
+
+    void write()
+    {
+        written = true;
+        std::ofstream ofs(out_file);
+        if (!ofs.is_open())
+        {
+            SC_REPORT_ERROR(out_file.c_str(), "file could not be opened to write the timeline");
+            return;
+        }
+        ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+        bool first = true;
+        write_events(ofs, first);
+        ofs << std::endl << "]}" << std::endl;
+    }
+};
+
+//! Records a stage of a firing from its construction to its destruction
+class timeline_stage
+{
+public:
+    timeline_stage(std::uint32_t track, timeline_span::stage_kind stage)
+        : deltas(sc_delta_count()), prev(timeline::current_track())
+    {
+        timeline::current_track() = track;
+        span.track = track;
+        span.stage = stage;
+        span.sim_begin = sc_time_stamp().value();
+        span.wall_begin = timeline::get().now();
+    }
+
+    ~timeline_stage()
+    {
+        timeline& tl = timeline::get();
+        span.wall_end = tl.now();
+        span.sim_end = sc_time_stamp().value();
+        span.deltas = sc_delta_count() - deltas;
+        tl.record(span);
+        timeline::current_track() = prev;
+    }
+
+private:
+    timeline_span span;
+    unsigned long long deltas;
+    std::uint32_t prev;
+};
+
+}
+
+#endif
@@ -0,0 +1,196 @@
+/**********************************************************************
+    * timeline_mpi.hpp -- Timelines of parallel simulations           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Aligning the clocks of the MPI ranks and merging their *
+    *          timelines with the messages between them               *
+    *                                                                 *
+    * Usage:   Included by the MPI transport with FORSYDE_TIMELINE    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TIMELINE_MPI_HPP
+#define TIMELINE_MPI_HPP
+
+/*! \file timeline_mpi.hpp
+ * \brief Implements the timelines of the parallel simulations
+ *
+ *  Each rank of a parallel simulation is a separate program with its own
+ * timeline and clock. This file includes the functions which align the
+ * clocks of the ranks to the one of rank 0 and merge the timelines of
+ * all the ranks into one trace, where each rank is a group of processes
+ * and the messages of the senders and receivers are drawn as arrows
+ * between the stages which sent and received them:
+ *
+ *     MPI_Init(&argc, &argv);
+ *     top top1("top1");
+ *     timeline_calibrate();               // collective
+ *     sc_start();
+ *     timeline_merge();                   // collective
+ *     MPI_Finalize();
+ *
+ *  After the calibration, each rank writes its own timeline to the
+ * output file with the rank inserted before the extension (e.g.,
+ * forsyde_timeline.rank1.json), and so does the profiler. The offsets of
+ * the clocks are estimated by the round trips of a few messages with rank
+ * 0, hence they are accurate to about half of the shortest round trip.
+ */
+
+#include <string>
+#include <vector>
+#include <map>
+#include <tuple>
+#include <sstream>
+#include <fstream>
+#include <mutex>
+#include <mpi.h>
+
+#include "timeline.hpp"
+
+//! The output file of the merged timeline
+#ifndef FORSYDE_TIMELINE_MERGED_FILE
+#define FORSYDE_TIMELINE_MERGED_FILE "forsyde_timeline.json"
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Inserts the rank of the calling program before the extension of a file name
+inline std::string rank_file_name(const std::string& file_name)
+{
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    const size_t dot = file_name.rfind('.');
+    const size_t slash = file_name.find_last_of("/\\");
+    const std::string tag = ".rank" + std::to_string(rank);
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return file_name + tag;
+    return file_name.substr(0, dot) + tag + file_name.substr(dot);
+}
+
+//! Aligns the clock of the timeline of each rank with the one of rank 0
+/*! It should be called by all the ranks after MPI_Init and before the
+ * simulation starts. The written times are the microseconds since the
+ * calibration on the clock of rank 0.
+ */
+inline void timeline_calibrate(int rounds=16)
+{
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    const int tag = 0x7f5d;
+    // the offset of MPI_Wtime of this rank from the one of rank 0
+    double offset = 0;
+    if (rank == 0)
+    {
+        for (int r=1; r<size; r++)
+            for (int i=0; i<rounds; i++)
+            {
+                char ping;
+                MPI_Recv(&ping, 1, MPI_BYTE, r, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+                const double t = MPI_Wtime();
+                MPI_Send(&t, 1, MPI_DOUBLE, r, tag, MPI_COMM_WORLD);
+            }
+    }
+    else
+    {
+        double best = -1;
+        for (int i=0; i<rounds; i++)
+        {
+            const char ping = 0;
+            double remote;
+            const double t1 = MPI_Wtime();
+            MPI_Send(&ping, 1, MPI_BYTE, 0, tag, MPI_COMM_WORLD);
+            MPI_Recv(&remote, 1, MPI_DOUBLE, 0, tag, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            const double t2 = MPI_Wtime();
+            // the reply is assumed to be taken half way through the round trip
+            if (best < 0 || t2 - t1 < best)
+            {
+                best = t2 - t1;
+                offset = remote - (t1 + t2) / 2;
+            }
+        }
+    }
+    double base = MPI_Wtime();
+    MPI_Bcast(&base, 1, MPI_DOUBLE, 0, MPI_COMM_WORLD);
+    timeline& tl = timeline::get();
+    tl.set_offset((MPI_Wtime() + offset - base) * 1e6 - tl.now());
+    tl.set_output(rank_file_name(tl.output()));
+#ifdef FORSYDE_PROFILE
+    profiler::get().set_output(rank_file_name(FORSYDE_PROFILE_FILE));
+#endif
+}
+
+//! Records an end of a message between two ranks in the timeline
+/*! The messages between a pair of ranks with the same tag arrive in the
+ * order they are sent, hence the n-th message sent on them is matched
+ * with the n-th one received.
+ */
+inline void timeline_message(bool send, int peer, int tag)
+{
+    static std::map<std::tuple<bool,int,int>,unsigned long long> counts;
+    static std::mutex mtx;
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    unsigned long long n;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        n = counts[std::make_tuple(send, peer, tag)]++;
+    }
+    const int src = send ? rank : peer;
+    const int dst = send ? peer : rank;
+    timeline::get().flow(send, std::to_string(src) + ">" + std::to_string(dst) + ":" +
+                               std::to_string(tag) + "#" + std::to_string(n));
+}
+
+//! Merges the timelines of all the ranks into one file written by rank 0
+/*! It should be called by all the ranks after the simulation ends. The
+ * groups of each rank are named after the rank.
+ */
+inline void timeline_merge(const std::string& file_name=FORSYDE_TIMELINE_MERGED_FILE)
+{
+    int rank = 0, size = 1;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    std::ostringstream oss;
+    bool first = true;
+    timeline::get().write_events(oss, first, size_t(rank) << 20,
+                                 "rank " + std::to_string(rank) + ": ");
+    const std::string events = oss.str();
+    int len = events.size();
+    std::vector<int> lens(size), displs(size);
+    MPI_Gather(&len, 1, MPI_INT, lens.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    std::vector<char> all;
+    if (rank == 0)
+    {
+        for (int r=1; r<size; r++) displs[r] = displs[r-1] + lens[r-1];
+        all.resize(displs[size-1] + lens[size-1]);
+    }
+    MPI_Gatherv(events.data(), len, MPI_CHAR, all.data(), lens.data(), displs.data(),
+                MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (rank != 0) return;
+    std::ofstream ofs(file_name);
+    if (!ofs.is_open())
+    {
+        SC_REPORT_ERROR(file_name.c_str(), "file could not be opened to write the merged timeline");
+        return;
+    }
+    ofs << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[" << std::endl;
+    bool any = false;
+    for (int r=0; r<size; r++)
+    {
+        if (lens[r] == 0) continue;
+        if (any) ofs << "," << std::endl;
+        ofs.write(all.data() + displs[r], lens[r]);
+        any = true;
+    }
+    ofs << std::endl << "]}" << std::endl;
+}
+
+}
+
+#endif
@@ -0,0 +1,721 @@
+/**********************************************************************
+    * tlm_bridge.hpp -- MoC interfaces to TLM-2.0 virtual platforms   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Connecting the SY and DDE signals to memory-mapped     *
+    *          regions of loosely-timed TLM-2.0 models                *
+    *                                                                 *
+    * Usage:   Define FORSYDE_TLM to use it                           *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TLM_BRIDGE_HPP
+#define TLM_BRIDGE_HPP
+
+/*! \file tlm_bridge.hpp
+ * \brief Implements the MoC interfaces between ForSyDe and TLM-2.0
+ *
+ *  This file includes the MoC interfaces which stream the tokens of a
+ * signal to (SY2TLM, DDE2TLM) or from (TLM2SY, TLM2DDE) a region of a
+ * TLM-2.0 target, e.g., a memory or the buffer of a peripheral. Each of
+ * them has a loosely-timed initiator socket which is bound to the bus
+ * of the platform:
+ *
+ *     auto stim = make_TLM2DDE<float>("stim", 0x80000000, 4096, 64,
+ *                                     sc_time(1, SC_US), samples);
+ *     stim->isock.bind(bus.tsock);
+ *
+ *  The region is a ring of slots, one token each, which the bridge reads
+ * or writes in order, wrapping around at its end. The tokens are moved
+ * in bursts of up to a given number of tokens, which are accessed with
+ * a single b_transport call. If the target grants a DMI pointer to the
+ * whole region, the tokens are copied directly instead. The outgoing
+ * bridges start a burst earlier when their input is empty, so that they
+ * do not hold tokens back.
+ *
+ *  The bridges use temporal decoupling: they keep the time of their
+ * tokens as an offset to the kernel time in a quantum keeper, and only
+ * synchronize with the kernel when it exceeds the global quantum (see
+ * tlm::tlm_global_quantum). The SY bridges, whose MoC is untimed, take
+ * the time of one evaluation cycle on the platform as a parameter. The
+ * tokens are copied as plain bytes, hence their type should be trivially
+ * copyable.
+ */
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#include <tlm>
+#include "tlm_utils/simple_initiator_socket.h"
+#include "tlm_utils/tlm_quantumkeeper.h"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Moves the tokens between a bridge and a ring of slots of a TLM-2.0 target
+/*! It is used by the TLM bridges to access the region through their
+ * initiator socket, by DMI if the target allows it, and by b_transport
+ * otherwise.
+ */
+class tlm_stream
+{
+public:
+    //! The constructor requires the region and the size of a token
+    tlm_stream(std::uint64_t base,  ///< the address of the first slot
+               size_t slots,        ///< the number of slots of the region
+               size_t token_bytes,  ///< the size of a slot in bytes
+               bool use_dmi         ///< try to access the region by DMI
+              ) : base(base), slots(slots), token_bytes(token_bytes),
+                  use_dmi(use_dmi), fw(NULL), next(0), dmi_valid(false),
+                  dmi_checked(false), transactions(0), dmi_accesses(0) {}
+
+    //! Sets the interface of the target, once the socket is bound
+    void bind(tlm::tlm_fw_transport_if<>* target) {fw = target;}
+
+    //! Reads or writes n tokens at the current slot, adding the latency to delay
+    void transfer(tlm::tlm_command cmd, unsigned char* data, size_t n, sc_time& delay)
+    {
+        while (n > 0)
+        {
+            // a burst does not wrap around the end of the region
+            const size_t k = std::min(n, slots - next);
+            const std::uint64_t addr = base + next * token_bytes;
+            const size_t bytes = k * token_bytes;
+            if (use_dmi && !dmi_checked) request_dmi(cmd);
+            if (dmi_valid && (cmd == tlm::TLM_READ_COMMAND ? dmi.is_read_allowed()
+                                                             : dmi.is_write_allowed()))
+            {
+                unsigned char* ptr = dmi.get_dmi_ptr() + (addr - dmi.get_start_address());
+                if (cmd == tlm::TLM_READ_COMMAND)
+                {
+                    std::memcpy(data, ptr, bytes);
+                    delay += dmi.get_read_latency() * double(k);
+                }
+                else
+                {
+                    std::memcpy(ptr, data, bytes);
+                    delay += dmi.get_write_latency() * double(k);
+                }
+                dmi_accesses++;
+            }
+            else
+            {
+                trans.set_command(cmd);
+                trans.set_address(addr);
+                trans.set_data_ptr(data);
+                trans.set_data_length(bytes);
+                trans.set_streaming_width(bytes);
+                trans.set_byte_enable_ptr(NULL);
+                trans.set_dmi_allowed(false);
+                trans.set_response_status(tlm::TLM_INCOMPLETE_RESPONSE);
+                fw->b_transport(trans, delay);
+                if (trans.is_response_error())
+                    SC_REPORT_ERROR("tlm_stream", ("the transaction failed: " +
+                                    trans.get_response_string()).c_str());
+                // a target may offer DMI after refusing it
+                if (use_dmi && trans.is_dmi_allowed()) dmi_checked = false;
+                transactions++;
+            }
+            data += bytes;
+            n -= k;
+            next = (next + k) % slots;
+        }
+    }
+
+    //! Drops the DMI pointer if it overlaps the invalidated range
+    void invalidate(std::uint64_t start, std::uint64_t end)
+    {
+        if (dmi_valid && start <= dmi.get_end_address() && end >= dmi.get_start_address())
+        {
+            dmi_valid = false;
+            dmi_checked = false;
+        }
+    }
+
+    //! The number of b_transport calls
+    unsigned long long transaction_count() const {return transactions;}
+
+    //! The number of bursts copied by DMI
+    unsigned long long dmi_count() const {return dmi_accesses;}
+
+private:
+    std::uint64_t base;
+    size_t slots, token_bytes;
+    bool use_dmi;
+    tlm::tlm_fw_transport_if<>* fw;
+    // the slot accessed next
+    size_t next;
+    tlm::tlm_generic_payload trans;
+    tlm::tlm_dmi dmi;
+    bool dmi_valid, dmi_checked;
+    unsigned long long transactions, dmi_accesses;
+
+    //! Asks the target for a DMI pointer covering the whole region
+    void request_dmi(tlm::tlm_command cmd)
+    {
+        dmi_checked = true;
+        trans.set_command(cmd);
+        trans.set_address(base);
+        trans.set_data_length(slots * token_bytes);
+        trans.set_byte_enable_ptr(NULL);
+        dmi_valid = fw->get_direct_mem_ptr(trans, dmi) &&
+                    dmi.get_start_address() <= base &&
+                    dmi.get_end_address() >= base + slots * token_bytes - 1;
+    }
+};
+
+//! Process constructor for a SY2TLM MoC interface
+/*! This class is used to build a MoC interface which writes the present
+ * tokens of an SY signal to a ring of slots of a TLM-2.0 target. Each
+ * evaluation cycle takes the given time on the platform.
+ */
+template <class T>
+class SY2TLM : public process
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "the tokens of a TLM bridge should be trivially copyable");
+public:
+    SY::SY_in<T> iport1;        ///< port for the input channel
+    tlm_utils::simple_initiator_socket<SY2TLM<T>> isock;  ///< socket to the platform
+
+    //! The constructor requires the module name and the region
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * writes them to the region in bursts
+     */
+    SY2TLM(sc_module_name _name,            ///< process name
+           std::uint64_t base,              ///< the address of the region
+           size_t slots,                    ///< the tokens which fit in the region
+           size_t burst,                    ///< the largest burst in tokens
+           const sc_time& cycle_time=SC_ZERO_TIME,  ///< the time of a cycle
+           bool use_dmi=true                ///< use DMI when it is granted
+          ) : process(_name), iport1("iport1"), isock("isock"),
+              burst(std::max<size_t>(burst, 1)), cycle_time(cycle_time),
+              stream(base, slots, sizeof(T), use_dmi)
+    {
+        isock.register_invalidate_direct_mem_ptr(this, &SY2TLM::invalidate_direct_mem_ptr);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("base", base);
+        add_arg("slots", slots);
+        add_arg("burst", burst);
+        add_arg("cycle_time", cycle_time);
+        add_arg("use_dmi", use_dmi);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::SY2TLM";}
+
+    //! The number of b_transport calls and bursts copied by DMI
+    unsigned long long transactions() const
+    {
+        return stream.transaction_count() + stream.dmi_count();
+    }
+
+private:
+    size_t burst;
+    sc_time cycle_time;
+    tlm_stream stream;
+
+    abst_ext<T> ival1;
+    std::vector<T> buf;
+    tlm_utils::tlm_quantumkeeper qk;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        stream.bind(isock.operator->());
+        buf.reserve(burst);
+        qk.reset();
+    }
+
+    void prep()
+    {
+        // the buffered tokens are not held back while the input is empty
+        if (!buf.empty() && iport1.num_available() == 0) flush();
+        ival1 = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        if (is_present(ival1))
+        {
+            buf.push_back(unsafe_from_abst_ext(ival1));
+            if (buf.size() == burst) flush();
+        }
+        qk.inc(cycle_time);
+        if (qk.need_sync()) qk.sync();
+    }
+
+    void clean() {}
+
+    //! Writes the buffered tokens to the region
+    void flush()
+    {
+        sc_time delay = qk.get_local_time();
+        stream.transfer(tlm::TLM_WRITE_COMMAND,
+                        reinterpret_cast<unsigned char*>(buf.data()), buf.size(), delay);
+        qk.set(delay);
+        buf.clear();
+        if (qk.need_sync()) qk.sync();
+    }
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end)
+    {
+        stream.invalidate(start, end);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for a TLM2SY MoC interface
+/*! This class is used to build a MoC interface which produces an SY
+ * signal from the tokens in a ring of slots of a TLM-2.0 target, e.g.,
+ * a stimulus placed in the memory of the platform. Each evaluation cycle
+ * takes the given time on the platform.
+ */
+template <class T>
+class TLM2SY : public process
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "the tokens of a TLM bridge should be trivially copyable");
+public:
+    SY::SY_out<T> oport1;       ///< port for the output channel
+    tlm_utils::simple_initiator_socket<TLM2SY<T>> isock;  ///< socket to the platform
+
+    //! The constructor requires the module name and the region
+    /*! It creates an SC_THREAD which reads the region in bursts and
+     * writes the tokens using the output port
+     */
+    TLM2SY(sc_module_name _name,            ///< process name
+           std::uint64_t base,              ///< the address of the region
+           size_t slots,                    ///< the tokens which fit in the region
+           size_t burst,                    ///< the largest burst in tokens
+           unsigned long long take=0,       ///< number of tokens produced (0 for infinite)
+           const sc_time& cycle_time=SC_ZERO_TIME,  ///< the time of a cycle
+           bool use_dmi=true                ///< use DMI when it is granted
+          ) : process(_name), oport1("oport1"), isock("isock"),
+              burst(std::max<size_t>(burst, 1)), take(take), cycle_time(cycle_time),
+              stream(base, slots, sizeof(T), use_dmi)
+    {
+        isock.register_invalidate_direct_mem_ptr(this, &TLM2SY::invalidate_direct_mem_ptr);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("base", base);
+        add_arg("slots", slots);
+        add_arg("burst", burst);
+        add_arg("take", take);
+        add_arg("cycle_time", cycle_time);
+        add_arg("use_dmi", use_dmi);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::TLM2SY";}
+
+    //! The number of b_transport calls and bursts copied by DMI
+    unsigned long long transactions() const
+    {
+        return stream.transaction_count() + stream.dmi_count();
+    }
+
+private:
+    size_t burst;
+    unsigned long long take;
+    sc_time cycle_time;
+    tlm_stream stream;
+
+    std::vector<T> buf;
+    size_t pos;
+    unsigned long long tok_cnt;
+    tlm_utils::tlm_quantumkeeper qk;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        stream.bind(isock.operator->());
+        buf.resize(burst);
+        pos = burst;
+        tok_cnt = 0;
+        qk.reset();
+    }
+
+    void prep()
+    {
+        if (take != 0 && tok_cnt++ >= take) wait();
+        if (pos < buf.size()) return;
+        // the last burst does not read beyond the taken tokens
+        const size_t n = take == 0 ? burst
+                       : std::min<unsigned long long>(burst, take - tok_cnt + 1);
+        buf.resize(n);
+        sc_time delay = qk.get_local_time();
+        stream.transfer(tlm::TLM_READ_COMMAND,
+                        reinterpret_cast<unsigned char*>(buf.data()), n, delay);
+        qk.set(delay);
+        pos = 0;
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, abst_ext<T>(buf[pos++]));
+        qk.inc(cycle_time);
+        if (qk.need_sync()) qk.sync();
+    }
+
+    void clean() {}
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end)
+    {
+        stream.invalidate(start, end);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+#ifndef FORSYDE_NO_DDE
+//! Process constructor for a DDE2TLM MoC interface
+/*! This class is used to build a MoC interface which writes the present
+ * events of a DDE signal to a ring of slots of a TLM-2.0 target. Each
+ * burst is written at the time tag of its last event, which is kept as
+ * the local time offset of the process until it exceeds the quantum.
+ */
+template <class T>
+class DDE2TLM : public DDE::dde_process
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "the tokens of a TLM bridge should be trivially copyable");
+public:
+    DDE::DDE_in<T> iport1;      ///< port for the input channel
+    tlm_utils::simple_initiator_socket<DDE2TLM<T>> isock;  ///< socket to the platform
+
+    //! The constructor requires the module name and the region
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * writes them to the region in bursts
+     */
+    DDE2TLM(sc_module_name _name,           ///< process name
+            std::uint64_t base,             ///< the address of the region
+            size_t slots,                   ///< the tokens which fit in the region
+            size_t burst,                   ///< the largest burst in tokens
+            bool use_dmi=true               ///< use DMI when it is granted
+           ) : dde_process(_name), iport1("iport1"), isock("isock"),
+               burst(std::max<size_t>(burst, 1)), stream(base, slots, sizeof(T), use_dmi)
+    {
+        isock.register_invalidate_direct_mem_ptr(this, &DDE2TLM::invalidate_direct_mem_ptr);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("base", base);
+        add_arg("slots", slots);
+        add_arg("burst", burst);
+        add_arg("use_dmi", use_dmi);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::DDE2TLM";}
+
+    //! The number of b_transport calls and bursts copied by DMI
+    unsigned long long transactions() const
+    {
+        return stream.transaction_count() + stream.dmi_count();
+    }
+
+private:
+    size_t burst;
+    tlm_stream stream;
+
+    ttn_event<T> ival1;
+    std::vector<T> buf;
+    sc_time last;
+    tlm_utils::tlm_quantumkeeper qk;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        stream.bind(isock.operator->());
+        buf.reserve(burst);
+        last = SC_ZERO_TIME;
+        qk.reset();
+    }
+
+    void prep()
+    {
+        if (!buf.empty() && iport1.num_available() == 0) flush();
+        ival1 = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        if (is_absent(get_value(ival1))) return;
+        buf.push_back(unsafe_from_abst_ext(get_value(ival1)));
+        last = get_time(ival1);
+        if (buf.size() == burst) flush();
+    }
+
+    void clean() {}
+
+    //! Writes the buffered events to the region at the time of the last one
+    void flush()
+    {
+        sc_time delay = last > model_time() ? last - model_time() : SC_ZERO_TIME;
+        stream.transfer(tlm::TLM_WRITE_COMMAND,
+                        reinterpret_cast<unsigned char*>(buf.data()), buf.size(), delay);
+        qk.set(delay);
+        buf.clear();
+        if (qk.need_sync())
+        {
+            sync(model_time() + qk.get_local_time());
+            qk.reset();
+        }
+    }
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end)
+    {
+        stream.invalidate(start, end);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+//! Process constructor for a TLM2DDE MoC interface
+/*! This class is used to build a MoC interface which produces a DDE
+ * signal from the tokens in a ring of slots of a TLM-2.0 target, one
+ * event every period. The events are written ahead of the kernel time,
+ * which only advances when the local time offset exceeds the quantum.
+ */
+template <class T>
+class TLM2DDE : public DDE::dde_process
+{
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "the tokens of a TLM bridge should be trivially copyable");
+public:
+    DDE::DDE_out<T> oport1;     ///< port for the output channel
+    tlm_utils::simple_initiator_socket<TLM2DDE<T>> isock;  ///< socket to the platform
+
+    //! The constructor requires the module name and the region
+    /*! It creates an SC_THREAD which reads the region in bursts and
+     * writes the events using the output port
+     */
+    TLM2DDE(sc_module_name _name,           ///< process name
+            std::uint64_t base,             ///< the address of the region
+            size_t slots,                   ///< the tokens which fit in the region
+            size_t burst,                   ///< the largest burst in tokens
+            const sc_time& period,          ///< the time between the events
+            unsigned long long take=0,      ///< number of events produced (0 for infinite)
+            bool use_dmi=true               ///< use DMI when it is granted
+           ) : dde_process(_name), oport1("oport1"), isock("isock"),
+               burst(std::max<size_t>(burst, 1)), period(period), take(take),
+               stream(base, slots, sizeof(T), use_dmi)
+    {
+        isock.register_invalidate_direct_mem_ptr(this, &TLM2DDE::invalidate_direct_mem_ptr);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("base", base);
+        add_arg("slots", slots);
+        add_arg("burst", burst);
+        add_arg("period", period);
+        add_arg("take", take);
+        add_arg("use_dmi", use_dmi);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "MI::TLM2DDE";}
+
+    //! The number of b_transport calls and bursts copied by DMI
+    unsigned long long transactions() const
+    {
+        return stream.transaction_count() + stream.dmi_count();
+    }
+
+private:
+    size_t burst;
+    sc_time period;
+    unsigned long long take;
+    tlm_stream stream;
+
+    std::vector<T> buf;
+    size_t pos;
+    unsigned long long tok_cnt;
+    sc_time cur_time;
+    tlm_utils::tlm_quantumkeeper qk;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        stream.bind(isock.operator->());
+        buf.resize(burst);
+        pos = burst;
+        tok_cnt = 0;
+        cur_time = model_time();
+        qk.reset();
+    }
+
+    void prep()
+    {
+        if (take != 0 && tok_cnt++ >= take) halt();
+        if (pos < buf.size()) return;
+        const size_t n = take == 0 ? burst
+                       : std::min<unsigned long long>(burst, take - tok_cnt + 1);
+        buf.resize(n);
+        // the transaction is issued at the time of its first event
+        sc_time delay = cur_time > model_time() ? cur_time - model_time() : SC_ZERO_TIME;
+        stream.transfer(tlm::TLM_READ_COMMAND,
+                        reinterpret_cast<unsigned char*>(buf.data()), n, delay);
+        // the events can not be earlier than the data they carry
+        if (model_time() + delay > cur_time) cur_time = model_time() + delay;
+        pos = 0;
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, ttn_event<T>(abst_ext<T>(buf[pos++]), cur_time));
+        qk.set(cur_time - model_time());
+        if (qk.need_sync())
+        {
+            sync(cur_time);
+            qk.reset();
+        }
+        cur_time += period;
+    }
+
+    void clean() {}
+
+    void invalidate_direct_mem_ptr(sc_dt::uint64 start, sc_dt::uint64 end)
+    {
+        stream.invalidate(start, end);
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+#endif
+
+//! Helper function to construct an SY2TLM MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the synchronous MoC to a TLM-2.0 target and connect its input
+ * signal. The socket is bound by the caller.
+ */
+template <class T, template <class> class IIf>
+inline SY2TLM<T>* make_SY2TLM(const std::string& pName,
+    std::uint64_t base,
+    size_t slots,
+    size_t burst,
+    IIf<T>& inpS,
+    const sc_time& cycle_time=SC_ZERO_TIME,
+    bool use_dmi=true
+    )
+{
+    auto p = new SY2TLM<T>(pName.c_str(), base, slots, burst, cycle_time, use_dmi);
+
+    (*p).iport1(inpS);
+
+    return p;
+}
+
+//! Helper function to construct a TLM2SY MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from a TLM-2.0 target to the synchronous MoC and connect its output
+ * signal. The socket is bound by the caller.
+ */
+template <class T, template <class> class OIf>
+inline TLM2SY<T>* make_TLM2SY(const std::string& pName,
+    std::uint64_t base,
+    size_t slots,
+    size_t burst,
+    OIf<T>& outS,
+    unsigned long long take=0,
+    const sc_time& cycle_time=SC_ZERO_TIME,
+    bool use_dmi=true
+    )
+{
+    auto p = new TLM2SY<T>(pName.c_str(), base, slots, burst, take, cycle_time, use_dmi);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+#ifndef FORSYDE_NO_DDE
+//! Helper function to construct a DDE2TLM MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from the discrete-event MoC to a TLM-2.0 target and connect its input
+ * signal. The socket is bound by the caller.
+ */
+template <class T, template <class> class IIf>
+inline DDE2TLM<T>* make_DDE2TLM(const std::string& pName,
+    std::uint64_t base,
+    size_t slots,
+    size_t burst,
+    IIf<T>& inpS,
+    bool use_dmi=true
+    )
+{
+    auto p = new DDE2TLM<T>(pName.c_str(), base, slots, burst, use_dmi);
+
+    (*p).iport1(inpS);
+
+    return p;
+}
+
+//! Helper function to construct a TLM2DDE MoC interface
+/*! This function is used to construct a MoC interface (SystemC module)
+ * from a TLM-2.0 target to the discrete-event MoC and connect its output
+ * signal. The socket is bound by the caller.
+ */
+template <class T, template <class> class OIf>
+inline TLM2DDE<T>* make_TLM2DDE(const std::string& pName,
+    std::uint64_t base,
+    size_t slots,
+    size_t burst,
+    const sc_time& period,
+    OIf<T>& outS,
+    unsigned long long take=0,
+    bool use_dmi=true
+    )
+{
+    auto p = new TLM2DDE<T>(pName.c_str(), base, slots, burst, period, take, use_dmi);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+#endif
+
+}
+
+#endif
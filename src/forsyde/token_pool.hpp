@@ -0,0 +1,264 @@
+/**********************************************************************
+    * token_pool.hpp -- Recycling the buffers of heap-backed tokens   *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Avoid a heap allocation and release for each token of  *
+    *          the signals carrying vectors                           *
+    *                                                                 *
+    * Usage:   Define FORSYDE_TOKEN_POOL to use it                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TOKEN_POOL_HPP
+#define TOKEN_POOL_HPP
+
+/*! \file token_pool.hpp
+ * \brief Implements the per-type pools of token buffers
+ *
+ *  The slots of the channels keep their tokens by value, and a slot
+ * which is overwritten by a token of the same type reuses the storage
+ * it already has. The heap traffic of the signals carrying vectors (e.g.,
+ * the output of SY::group or the vector tokens of SDF) comes from the
+ * temporary tokens: a token read by value is a new vector, and the one
+ * it replaces in the consumer is released.
+ *
+ *  With FORSYDE_TOKEN_POOL defined, the library reads such tokens into
+ * the storage of the consumer, the tokens read by value are taken from a
+ * per-type pool of buffers, and the buffers of the consumed tokens are
+ * returned to it, so that a model in its steady state does not allocate
+ * heap memory for its tokens. The user functions can take part in it
+ * using acquire_token() and recycle_token().
+ */
+
+#include <atomic>
+#include <array>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#ifdef FORSYDE_NUMA
+#include "numa.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+//! Checks if the tokens of a type keep their payload on the heap
+/*! Only the tokens whose moved-from objects give their storage away are
+ * pooled, which are the vectors, and the absent-extended values and the
+ * arrays of such tokens.
+ */
+template <typename T>
+struct is_pooled_token : std::false_type {};
+
+template <typename T, typename A>
+struct is_pooled_token<std::vector<T,A>> : std::true_type {};
+
+template <typename T>
+struct is_pooled_token<abst_ext<T>> : is_pooled_token<T> {};
+
+template <typename T, size_t N>
+struct is_pooled_token<std::array<T,N>> : is_pooled_token<T> {};
+
+//! Resets a recycled token to the value of a default-constructed one
+/*! The vectors are cleared rather than replaced, so that they keep the
+ * capacity of their buffers.
+ */
+template <typename T>
+inline void reset_token(T& tok) {tok = T();}
+
+template <typename T, typename A>
+inline void reset_token(std::vector<T,A>& tok) {tok.clear();}
+
+template <typename T, size_t N>
+inline void reset_token(std::array<T,N>& tok)
+{
+    for (auto& t : tok) reset_token(t);
+}
+
+template <typename T>
+inline void reset_token(abst_ext<T>& tok)
+{
+    if (!tok.is_present()) return;
+    T val = std::move(tok).unsafe_from_abst_ext();
+    reset_token(val);
+    tok.set_val(std::move(val));
+    tok.set_abst();
+}
+
+//! The number of buffers kept by each token pool
+/*! It should be set before the first token of a type is pooled.
+ */
+inline size_t& token_pool_capacity()
+{
+    static size_t capacity = 256;
+    return capacity;
+}
+
+//! A lock-free pool of the buffers of the tokens of a type
+/*! The pool holds up to token_pool_capacity() released tokens, which
+ * are handed out again by acquire() with the capacity they had. The
+ * tokens are kept in a fixed array of nodes linked into two stacks, of
+ * the full and the empty nodes, whose heads carry a tag against the ABA
+ * problem. Hence the tokens can be released and acquired by different
+ * threads (e.g., by the executors running the processes on a thread
+ * pool) without locking.
+ */
+template <typename T>
+class token_pool
+{
+public:
+    //! Returns the pool of the type
+    /*! With FORSYDE_NUMA, there is a pool per node and the one of the node
+     * running the calling thread is returned, so that the buffers are
+     * reused on the node where they were released.
+     */
+    static token_pool& instance()
+    {
+#ifdef FORSYDE_NUMA
+        static std::vector<std::unique_ptr<token_pool>> pools = []
+        {
+            std::vector<std::unique_ptr<token_pool>> res;
+            for (int n=0; n<numa_topology::get().nodes(); n++)
+                res.emplace_back(new token_pool(token_pool_capacity()));
+            return res;
+        }();
+        const int node = numa_current_node();
+        return *pools[node < 0 ? 0 : node];
+#else
+        static token_pool pool(token_pool_capacity());
+        return pool;
+#endif
+    }
+
+    //! Takes a token from the pool
+    /*! The token is reset before it is handed out, so that it compares
+     * equal to a default-constructed one and only its storage is reused.
+     * If the pool is empty a default-constructed token is returned.
+     */
+    T acquire()
+    {
+        const uint32_t i = pop(full);
+        if (i == nil)
+        {
+            missed.fetch_add(1, std::memory_order_relaxed);
+            return T();
+        }
+        T val = std::move(nodes[i].val);
+        push(empty, i);
+        reset_token(val);
+        return val;
+    }
+
+    //! Returns the storage of a token to the pool
+    /*! The token is destroyed if the pool is full.
+     */
+    void release(T&& val)
+    {
+        const uint32_t i = pop(empty);
+        if (i == nil) return;
+        nodes[i].val = std::move(val);
+        push(full, i);
+    }
+
+    //! The number of acquisitions which found the pool empty
+    size_t misses() const {return missed.load(std::memory_order_relaxed);}
+
+private:
+    static constexpr uint32_t nil = UINT32_MAX;
+
+    struct node
+    {
+        T val;
+        std::atomic<uint32_t> next;
+    };
+
+    std::unique_ptr<node[]> nodes;
+    // the heads of the stacks: a node index and a tag in the upper half
+    std::atomic<uint64_t> full, empty;
+    std::atomic<size_t> missed;
+
+    token_pool(size_t capacity)
+        : nodes(new node[capacity]), full(nil), empty(nil), missed(0)
+    {
+        for (size_t i=0; i<capacity; i++) push(empty, uint32_t(i));
+    }
+
+    uint32_t pop(std::atomic<uint64_t>& head)
+    {
+        uint64_t h = head.load(std::memory_order_acquire);
+        while (true)
+        {
+            const uint32_t i = uint32_t(h);
+            if (i == nil) return nil;
+            const uint64_t n = ((h >> 32) + 1) << 32 |
+                               nodes[i].next.load(std::memory_order_relaxed);
+            if (head.compare_exchange_weak(h, n, std::memory_order_acquire,
+                                           std::memory_order_acquire))
+                return i;
+        }
+    }
+
+    void push(std::atomic<uint64_t>& head, uint32_t i)
+    {
+        uint64_t h = head.load(std::memory_order_relaxed);
+        uint64_t n;
+        do
+        {
+            nodes[i].next.store(uint32_t(h), std::memory_order_relaxed);
+            n = ((h >> 32) + 1) << 32 | i;
+        } while (!head.compare_exchange_weak(h, n, std::memory_order_release,
+                                             std::memory_order_relaxed));
+    }
+};
+
+//! Takes a token with a recycled buffer, if its type is pooled
+template <typename T>
+inline T acquire_token()
+{
+    if constexpr (is_pooled_token<T>::value)
+        return token_pool<T>::instance().acquire();
+    else
+        return T();
+}
+
+//! Returns the buffer of a consumed token to its pool
+template <typename T>
+inline void recycle_token(T&& tok)
+{
+    typedef typename std::decay<T>::type V;
+    if constexpr (is_pooled_token<V>::value)
+        token_pool<V>::instance().release(std::move(tok));
+}
+
+//! Returns the buffers of a vector of consumed tokens and clears it
+template <typename T>
+inline void recycle_tokens(std::vector<T>& toks)
+{
+    if constexpr (is_pooled_token<T>::value)
+        for (auto& t : toks) token_pool<T>::instance().release(std::move(t));
+    toks.clear();
+}
+
+//! Resizes a vector of tokens, taking the new ones from the pool
+template <typename T>
+inline void resize_tokens(std::vector<T>& toks, size_t n)
+{
+    if constexpr (is_pooled_token<T>::value)
+    {
+        if (toks.size() > n)
+        {
+            for (size_t i=n; i<toks.size(); i++)
+                token_pool<T>::instance().release(std::move(toks[i]));
+            toks.resize(n);
+        }
+        while (toks.size() < n) toks.push_back(token_pool<T>::instance().acquire());
+    }
+    else
+        toks.resize(n);
+}
+
+}
+
+#endif
@@ -0,0 +1,298 @@
+/**********************************************************************
+    * token_stream.hpp -- Streams of stimulus tokens pulled in chunks *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Feeding large stimuli to the source processes without  *
+    *          materializing them in the memory                       *
+    *                                                                 *
+    * Usage:   Used by the stream sources of the MoCs                 *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TOKEN_STREAM_HPP
+#define TOKEN_STREAM_HPP
+
+/*! \file token_stream.hpp
+ * \brief Implements the streams read by the stream sources
+ *
+ *  The vector sources copy their whole stimulus into the process before
+ * the simulation starts. The stream sources instead pull the values from
+ * a token_stream in chunks of FORSYDE_STREAM_CHUNK values, hence only a
+ * chunk is kept in the memory. A stream is built from a generator
+ * function, from an iterator range, or from a file of values in the host
+ * representation which is mapped into the memory:
+ *
+ *     auto p = SY::make_vsource("stim",
+ *                  make_file_stream<float>("stim.bin"), src_sig);
+ */
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <iterator>
+#include <functional>
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+#include "file_io.hpp"
+
+//! The number of values pulled from a stream at once
+#ifndef FORSYDE_STREAM_CHUNK
+#define FORSYDE_STREAM_CHUNK 4096
+#endif
+
+namespace ForSyDe
+{
+
+//! The interface of a stream of values read by a stream source
+template <typename V>
+class token_stream
+{
+public:
+    virtual ~token_stream() {}
+
+    //! Copies up to n next values into a buffer, returning their number
+    /*! A stream which returns fewer values than asked for is finished.
+     */
+    virtual size_t pull(V* buf, size_t n) = 0;
+
+    //! Moves to the value with the given index, if the stream supports it
+    /*! It is used to rewind the stream when the model is reset, and to
+     * continue from a checkpoint.
+     */
+    virtual bool seek(size_t) {return false;}
+
+    //! Checks if the stream can be read (e.g., if its file exists)
+    virtual bool good() {return true;}
+
+    //! A short description of the stream for the introspection
+    virtual std::string describe() const = 0;
+};
+
+//! A stream which calls a generator function for each value
+/*! The function stores the next value in its argument and returns false
+ * when there are no more values. The stream can only be moved forward,
+ * by skipping the values.
+ */
+template <typename V>
+class generator_stream : public token_stream<V>
+{
+public:
+    typedef std::function<bool(V&)> functype;
+
+    generator_stream(const functype& _func) : _func(_func), pos(0), done(false) {}
+
+    size_t pull(V* buf, size_t n)
+    {
+        size_t k = 0;
+        while (k<n && !done)
+        {
+            if (_func(buf[k])) k++;
+            else done = true;
+        }
+        pos += k;
+        return k;
+    }
+
+    bool seek(size_t to)
+    {
+        if (to < pos) return false;
+        V skipped;
+        while (pos < to && !done)
+        {
+            if (_func(skipped)) pos++;
+            else done = true;
+        }
+        return true;
+    }
+
+    std::string describe() const {return "generator";}
+
+private:
+    functype _func;
+    size_t pos;
+    bool done;
+};
+
+//! A stream which reads the values of an iterator range
+/*! The range (e.g., of an istream_iterator) is read once, hence the
+ * stream can only be moved forward, unless the iterators are forward
+ * iterators which can be read again.
+ */
+template <typename It>
+class range_stream : public token_stream<typename std::iterator_traits<It>::value_type>
+{
+public:
+    typedef typename std::iterator_traits<It>::value_type V;
+
+    range_stream(It first, It last) : first(first), cur(first), last(last), pos(0) {}
+
+    size_t pull(V* buf, size_t n)
+    {
+        size_t k = 0;
+        for (; k<n && cur!=last; k++, ++cur) buf[k] = *cur;
+        pos += k;
+        return k;
+    }
+
+    bool seek(size_t to)
+    {
+        typedef typename std::iterator_traits<It>::iterator_category cat;
+        if (to < pos)
+        {
+            if (!std::is_base_of<std::forward_iterator_tag, cat>::value) return false;
+            cur = first;
+            pos = 0;
+        }
+        for (; pos<to && cur!=last; pos++) ++cur;
+        return true;
+    }
+
+    std::string describe() const {return "range";}
+
+private:
+    It first, cur, last;
+    size_t pos;
+};
+
+//! A stream which reads a file of values in the host representation
+/*! The file is mapped into the memory, and the pages which have been
+ * read are dropped from the memory, so that the resident part of the
+ * file stays within a few chunks.
+ */
+template <typename V>
+class mapped_file_stream : public token_stream<V>
+{
+public:
+    mapped_file_stream(const std::string& file_name)
+        : file_name(file_name), opened(false), count(0), pos(0), released(0)
+    {
+        static_assert(std::is_trivially_copyable<V>::value,
+                      "the values of a binary file should be trivially copyable");
+    }
+
+    size_t pull(V* buf, size_t n)
+    {
+        if (!open()) return 0;
+        const size_t k = std::min(n, count - pos);
+        std::memcpy(buf, mfile.data() + pos*sizeof(V), k*sizeof(V));
+        pos += k;
+        mfile.release(released, pos*sizeof(V));
+        released = pos*sizeof(V);
+        return k;
+    }
+
+    bool seek(size_t to)
+    {
+        if (!open()) return false;
+        pos = std::min(to, count);
+        released = pos*sizeof(V);
+        return true;
+    }
+
+    std::string describe() const {return file_name;}
+
+    bool good() {return open();}
+
+private:
+    std::string file_name;
+    mapped_file mfile;
+    bool opened;
+    size_t count, pos, released;
+
+    //! Maps the file when it is first read
+    bool open()
+    {
+        if (!opened)
+        {
+            if (!mfile.open(file_name)) return false;
+            count = mfile.size() / sizeof(V);
+            opened = true;
+        }
+        return true;
+    }
+};
+
+//! Reads a stream one value at a time, pulling it in chunks
+template <typename V>
+class stream_reader
+{
+public:
+    stream_reader(std::shared_ptr<token_stream<V>> stream)
+        : stream(stream), head(0), len(0), pos(0), done(false) {}
+
+    //! Returns the next value, or NULL at the end of the stream
+    const V* next()
+    {
+        if (head == len)
+        {
+            if (done) return NULL;
+            if (chunk.empty()) chunk.resize(FORSYDE_STREAM_CHUNK);
+            len = stream->pull(chunk.data(), chunk.size());
+            head = 0;
+            done = len < chunk.size();
+            if (len == 0) return NULL;
+        }
+        pos++;
+        return &chunk[head++];
+    }
+
+    //! The number of values read so far
+    size_t position() const {return pos;}
+
+    //! Continues from the value with the given index
+    /*! It returns false if the stream can not be moved there.
+     */
+    bool seek(size_t to)
+    {
+        if (to == pos) return true;
+        if (!stream->seek(to)) return false;
+        head = len = 0;
+        pos = to;
+        done = false;
+        return true;
+    }
+
+    //! Checks if the stream can be read
+    bool good() {return stream->good();}
+
+    //! The description of the stream
+    std::string describe() const {return stream->describe();}
+
+private:
+    std::shared_ptr<token_stream<V>> stream;
+    std::vector<V> chunk;
+    size_t head, len, pos;
+    bool done;
+};
+
+//! Helper function to build a stream from a generator function
+template <typename V>
+inline std::shared_ptr<token_stream<V>> make_generator_stream(
+    const typename generator_stream<V>::functype& _func
+    )
+{
+    return std::make_shared<generator_stream<V>>(_func);
+}
+
+//! Helper function to build a stream from an iterator range
+template <typename It>
+inline std::shared_ptr<token_stream<typename std::iterator_traits<It>::value_type>>
+make_range_stream(It first, It last)
+{
+    return std::make_shared<range_stream<It>>(first, last);
+}
+
+//! Helper function to build a stream from a binary file of values
+template <typename V>
+inline std::shared_ptr<token_stream<V>> make_file_stream(const std::string& file_name)
+{
+    return std::make_shared<mapped_file_stream<V>>(file_name);
+}
+
+}
+
+#endif
@@ -0,0 +1,667 @@
+/**********************************************************************
+    * trace_recorder.hpp -- Columnar binary traces of signals         *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Recording the tokens of arbitrary signals into a       *
+    *          compressed binary file and loading them back           *
+    *                                                                 *
+    * Usage:   Define FORSYDE_SIGNAL_TRACE to use it                  *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+/*! \file trace_recorder.hpp
+ * \brief Implements the recorder and the reader of signal traces
+ *
+ *  This file includes a recorder which observes the tokens written to
+ * a number of signals, without adding any process to the model, and
+ * stores them in a columnar binary file. A companion reader loads the
+ * traces back as arrays, e.g., to compare the results of a simulation
+ * with a reference trace in regression tests.
+ *
+ *  The file starts with the eight characters "FSDTRC01" and the time
+ * resolution in seconds as a float64. The rest of the file is a sequence
+ * of blocks, each starting with a one-character kind:
+ *
+ *     - 'S' declares a signal by a uint32 identifier, a uint8 flag which
+ *       is one for timed signals, and its name and token type, each as a
+ *       uint32 length followed by the characters.
+ *     - 'C' holds a chunk of the tokens of a signal as the uint32
+ *       identifier, token count and stride, the uint64 sizes of the raw
+ *       values, the encoded values and the encoded time tags, followed
+ *       by the encoded time tags and values.
+ *
+ *  All the numbers are in the host byte order. The values of a chunk
+ *  are serialized using ForSyDe::serializer. Each byte is XORed with the
+ *  byte one stride earlier, where the stride is the size of the first
+ *  value, and the result is run-length encoded as a sequence of a
+ *  literal length, the literal bytes and a number of zeros, all lengths
+ *  being unsigned LEB128 numbers. Constant or slowly changing signals
+ *  hence shrink to a few bytes per chunk. The time tags of the timed
+ *  signals (DDE) are stored in units of the time resolution, as the
+ *  zigzag LEB128 differences of consecutive tags.
+ */
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <typeinfo>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+
+#include "abssemantics.hpp"
+#include "tt_event.hpp"
+#include "serializer.hpp"
+
+//! The number of tokens of a signal in a chunk of the trace
+#ifndef FORSYDE_TRACE_CHUNK
+#define FORSYDE_TRACE_CHUNK 4096
+#endif
+
+//! The number of chunks waiting to be written before the simulation waits
+#ifndef FORSYDE_TRACE_QUEUE
+#define FORSYDE_TRACE_QUEUE 16
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! How the tokens of a signal are recorded
+/*! The tokens of the untimed MoCs are recorded as they are. The
+ * time-tagged events of the timed MoCs are split into the value and the
+ * time tag, and make() joins a recorded value and time (in seconds)
+ * back into a token.
+ */
+template <typename TokenType>
+struct trace_token
+{
+    static constexpr bool timed = false;
+    typedef TokenType value_type;
+    static const value_type& value(const TokenType& tok) {return tok;}
+    static std::uint64_t time(const TokenType&) {return 0;}
+    static TokenType make(const value_type& val, double) {return val;}
+};
+
+template <typename VT>
+struct trace_token<tt_event<VT>>
+{
+    static constexpr bool timed = true;
+    typedef VT value_type;
+    static const VT& value(const tt_event<VT>& tok) {return get_value(tok);}
+    static std::uint64_t time(const tt_event<VT>& tok) {return get_time(tok).value();}
+    static tt_event<VT> make(const VT& val, double t)
+    {
+        return tt_event<VT>(val, sc_time(t, SC_SEC));
+    }
+};
+
+//! The encoding of the chunks of the traces
+struct trace_codec
+{
+    static void put_varint(std::vector<char>& buf, std::uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            buf.push_back(char(v & 0x7f) | char(0x80));
+            v >>= 7;
+        }
+        buf.push_back(char(v));
+    }
+
+    static bool get_varint(const char*& pos, const char* end, std::uint64_t& v)
+    {
+        v = 0;
+        for (unsigned shift=0; pos<end && shift<64; shift+=7)
+        {
+            const unsigned char b = *pos++;
+            v |= std::uint64_t(b & 0x7f) << shift;
+            if (b < 0x80) return true;
+        }
+        return false;
+    }
+
+    //! Encodes the time tags as zigzag differences
+    static void encode_times(std::vector<char>& out, const std::vector<std::uint64_t>& times)
+    {
+        std::uint64_t prev = 0;
+        for (auto t : times)
+        {
+            const std::int64_t d = std::int64_t(t - prev);
+            put_varint(out, (std::uint64_t(d) << 1) ^ std::uint64_t(d >> 63));
+            prev = t;
+        }
+    }
+
+    static bool decode_times(const char* pos, const char* end, size_t count,
+                             std::vector<std::uint64_t>& times)
+    {
+        std::uint64_t prev = 0, z;
+        for (size_t i=0; i<count; i++)
+        {
+            if (!get_varint(pos, end, z)) return false;
+            prev += (z >> 1) ^ (~(z & 1) + 1);
+            times.push_back(prev);
+        }
+        return pos == end;
+    }
+
+    //! Encodes the serialized values of a chunk
+    static void encode_values(std::vector<char>& out, std::vector<char>& raw, size_t stride)
+    {
+        const size_t n = raw.size();
+        if (stride > 0)
+            for (size_t i=n; i-- > stride;) raw[i] ^= raw[i-stride];
+        size_t i = 0;
+        while (i < n)
+        {
+            // the literal [i,j) is followed by the zeros [j,z)
+            size_t j = i, z = i;
+            while (j < n)
+            {
+                if (raw[j] != 0)
+                {
+                    j++;
+                    continue;
+                }
+                z = j;
+                while (z < n && raw[z] == 0) z++;
+                if (z - j >= 3 || z == n) break;
+                j = z;
+            }
+            if (j == n) z = n;
+            put_varint(out, j - i);
+            out.insert(out.end(), raw.begin()+i, raw.begin()+j);
+            put_varint(out, z - j);
+            i = z;
+        }
+    }
+
+    static bool decode_values(const char* pos, const char* end, size_t raw_size,
+                              size_t stride, std::vector<char>& raw)
+    {
+        const size_t base = raw.size();
+        std::uint64_t lit, zeros;
+        while (raw.size() - base < raw_size)
+        {
+            if (!get_varint(pos, end, lit) || lit > size_t(end - pos)) return false;
+            raw.insert(raw.end(), pos, pos+lit);
+            pos += lit;
+            if (!get_varint(pos, end, zeros)) return false;
+            raw.resize(raw.size() + zeros, 0);
+        }
+        if (raw.size() - base != raw_size || pos != end) return false;
+        if (stride > 0)
+            for (size_t i=base+stride; i<raw.size(); i++) raw[i] ^= raw[i-stride];
+        return true;
+    }
+};
+
+//! Records the tokens of a number of signals into a trace file
+/*! The signals are attached using record() before the simulation
+ * starts. The tokens are collected in chunks per signal, which are
+ * encoded and written by a background thread. The simulation only waits
+ * for it if more than FORSYDE_TRACE_QUEUE chunks are pending.
+ *
+ * The recorder should be closed (or destroyed) after the simulation and
+ * before the recorded signals are destroyed.
+ */
+class trace_recorder
+{
+public:
+    trace_recorder() : file(NULL), chunk(FORSYDE_TRACE_CHUNK), stop(false),
+                       failed(false), closed(true) {}
+
+    ~trace_recorder() {close();}
+
+    trace_recorder(const trace_recorder&) = delete;
+    trace_recorder& operator=(const trace_recorder&) = delete;
+
+    //! Opens the trace file and starts the writer thread
+    bool open(const std::string& file_name,             ///< the trace file
+              size_t chunk_tokens=FORSYDE_TRACE_CHUNK   ///< tokens per chunk
+              )
+    {
+        close();
+        file = std::fopen(file_name.c_str(), "wb");
+        if (file == NULL) return false;
+        path = file_name;
+        chunk = std::max<size_t>(chunk_tokens, 1);
+        stop = failed = closed = false;
+        const double res = sc_get_time_resolution().to_seconds();
+        std::fwrite("FSDTRC01", 1, 8, file);
+        std::fwrite(&res, sizeof(res), 1, file);
+        writer = std::thread(&trace_recorder::run, this);
+        return true;
+    }
+
+    //! Starts recording the tokens written to a signal
+    template <typename T, typename TokenType, template <class> class FifoType>
+    void record(ForSyDe::signal<T,TokenType,FifoType>& sig,  ///< the signal
+                const std::string& sig_name                  ///< its name in the trace
+                )
+    {
+        typedef typename trace_token<TokenType>::value_type V;
+        static_assert(is_serializable<V>::value,
+                      "the tokens of a recorded signal should be serializable");
+        if (closed)
+            SC_REPORT_ERROR("trace_recorder", "the trace file is not open");
+        const std::uint32_t id = columns.size();
+        auto col = new column<TokenType>(this, id);
+        columns.emplace_back(col);
+        sig.set_observer(col);
+
+        job decl;
+        decl.kind = 'S';
+        decl.raw.push_back(trace_token<TokenType>::timed ? 1 : 0);
+        for (const std::string& s : {sig_name, std::string(typeid(T).name())})
+        {
+            const std::uint32_t len = s.size();
+            decl.raw.insert(decl.raw.end(), (const char*)&len, (const char*)&len+sizeof(len));
+            decl.raw.insert(decl.raw.end(), s.begin(), s.end());
+        }
+        decl.id = id;
+        submit(std::move(decl));
+    }
+
+    //! Checks if writing the trace has failed
+    bool has_failed() const
+    {
+        std::lock_guard<std::mutex> lk(m);
+        return failed;
+    }
+
+    //! Writes the remaining tokens and stops the writer thread
+    /*! It is called while the simulation is paused, e.g., before the
+     * process is forked, which only copies the calling thread. The
+     * writer is started again by resume() or branch().
+     */
+    void pause()
+    {
+        if (closed || !writer.joinable()) return;
+        for (auto& c : columns) c->flush();
+        stop_writer();
+        std::fflush(file);
+    }
+
+    //! Starts the writer thread of a paused recorder again
+    void resume()
+    {
+        if (closed || writer.joinable()) return;
+        stop = false;
+        writer = std::thread(&trace_recorder::run, this);
+    }
+
+    //! Continues the trace of a paused recorder in a new file
+    /*! The new file starts with a copy of the trace recorded so far,
+     * hence each branch of a forked simulation has a complete trace. It
+     * returns false if the file can not be written.
+     */
+    bool branch(const std::string& file_name)
+    {
+        pause();
+        if (closed) return false;
+        std::FILE* src = std::fopen(path.c_str(), "rb");
+        std::FILE* dst = std::fopen(file_name.c_str(), "wb");
+        bool ok = src != NULL && dst != NULL;
+        char buf[1<<16];
+        size_t n;
+        while (ok && (n = std::fread(buf, 1, sizeof(buf), src)) > 0)
+            ok = std::fwrite(buf, 1, n, dst) == n;
+        if (src) std::fclose(src);
+        if (!ok)
+        {
+            if (dst) std::fclose(dst);
+            return false;
+        }
+        // the inherited file is still used by the other branches
+        std::fclose(file);
+        file = dst;
+        path = file_name;
+        resume();
+        return true;
+    }
+
+    //! Writes the remaining tokens and closes the file
+    /*! The tokens written to the signals afterwards are ignored.
+     */
+    void close()
+    {
+        if (closed) return;
+        for (auto& c : columns) c->flush();
+        closed = true;
+        stop_writer();
+        std::fclose(file);
+        file = NULL;
+    }
+
+private:
+    //! A chunk of tokens, or a declaration, to be written
+    struct job
+    {
+        char kind;
+        std::uint32_t id, count, stride;
+        std::vector<char> raw;
+        std::vector<std::uint64_t> times;
+    };
+
+    struct column_base
+    {
+        virtual ~column_base() {}
+        virtual void flush() = 0;
+    };
+
+    //! The tokens of a recorded signal which are not written yet
+    template <typename TokenType>
+    struct column : public column_base, public signal_observer<TokenType>
+    {
+        typedef trace_token<TokenType> traits;
+
+        column(trace_recorder* rec, std::uint32_t id) : rec(rec), id(id),
+            count(0), stride(0) {}
+
+        void observe(const TokenType& tok)
+        {
+            if (rec->closed) return;
+            serializer<typename traits::value_type>::write(raw, traits::value(tok));
+            if (count == 0) stride = raw.size();
+            if (traits::timed) times.push_back(traits::time(tok));
+            if (++count == rec->chunk) flush();
+        }
+
+        void flush()
+        {
+            if (count == 0) return;
+            job j;
+            j.kind = 'C';
+            j.id = id;
+            j.count = count;
+            j.stride = stride;
+            j.raw.swap(raw);
+            j.times.swap(times);
+            rec->submit(std::move(j));
+            count = 0;
+        }
+
+        trace_recorder* rec;
+        std::uint32_t id, count, stride;
+        std::vector<char> raw;
+        std::vector<std::uint64_t> times;
+    };
+
+    std::FILE* file;
+    std::string path;
+    size_t chunk;
+    std::vector<std::unique_ptr<column_base>> columns;
+
+    std::deque<job> jobs;
+    std::thread writer;
+    mutable std::mutex m;
+    std::condition_variable cv;
+    bool stop, failed, closed;
+
+    //! Lets the writer thread write the queued jobs and waits for it
+    void stop_writer()
+    {
+        if (!writer.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        cv.notify_all();
+        writer.join();
+    }
+
+    //! Passes a job to the writer thread
+    void submit(job&& j)
+    {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [this]{return jobs.size() < FORSYDE_TRACE_QUEUE;});
+        jobs.push_back(std::move(j));
+        lk.unlock();
+        cv.notify_all();
+    }
+
+    //! The main loop of the writer thread
+    void run()
+    {
+        std::vector<char> out;
+        std::unique_lock<std::mutex> lk(m);
+        while (true)
+        {
+            cv.wait(lk, [this]{return stop || !jobs.empty();});
+            if (jobs.empty()) return;
+            job j = std::move(jobs.front());
+            jobs.pop_front();
+            lk.unlock();
+            cv.notify_all();
+            out.clear();
+            out.push_back(j.kind);
+            append(out, j.id);
+            if (j.kind == 'C')
+            {
+                std::vector<char> tbuf, vbuf;
+                trace_codec::encode_times(tbuf, j.times);
+                const std::uint64_t raw_size = j.raw.size();
+                trace_codec::encode_values(vbuf, j.raw, j.stride);
+                append(out, j.count);
+                append(out, j.stride);
+                append(out, raw_size);
+                append(out, std::uint64_t(vbuf.size()));
+                append(out, std::uint64_t(tbuf.size()));
+                out.insert(out.end(), tbuf.begin(), tbuf.end());
+                out.insert(out.end(), vbuf.begin(), vbuf.end());
+            }
+            else
+                out.insert(out.end(), j.raw.begin(), j.raw.end());
+            const bool ok = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+            lk.lock();
+            if (!ok) failed = true;
+        }
+    }
+
+    template <typename N>
+    static void append(std::vector<char>& out, N v)
+    {
+        out.insert(out.end(), (const char*)&v, (const char*)&v+sizeof(v));
+    }
+};
+
+//! Loads the signals of a trace file recorded by trace_recorder
+class trace_reader
+{
+public:
+    //! The position returned when no difference is found
+    static constexpr size_t npos = size_t(-1);
+
+    trace_reader() : resolution(0) {}
+
+    //! Loads a trace file, returning false if it is not a valid trace
+    bool open(const std::string& file_name)
+    {
+        sigs.clear();
+        std::FILE* f = std::fopen(file_name.c_str(), "rb");
+        if (f == NULL) return false;
+        std::vector<char> buf;
+        char tmp[1<<16];
+        size_t n;
+        while ((n = std::fread(tmp, 1, sizeof(tmp), f)) > 0)
+            buf.insert(buf.end(), tmp, tmp+n);
+        std::fclose(f);
+
+        const char* pos = buf.data();
+        const char* end = pos + buf.size();
+        if (buf.size() < 8+sizeof(double) || std::memcmp(pos, "FSDTRC01", 8) != 0)
+            return false;
+        pos += 8;
+        take(pos, resolution);
+        while (pos < end)
+        {
+            const char kind = *pos++;
+            std::uint32_t id;
+            if (!fits(pos, end, sizeof(id))) return false;
+            take(pos, id);
+            if (kind == 'S')
+            {
+                trace_signal s;
+                if (id != sigs.size() || !fits(pos, end, 1)) return false;
+                s.timed = *pos++ != 0;
+                if (!take_string(pos, end, s.name) || !take_string(pos, end, s.type))
+                    return false;
+                s.count = 0;
+                sigs.push_back(std::move(s));
+            }
+            else if (kind == 'C')
+            {
+                std::uint32_t count, stride;
+                std::uint64_t raw_size, vsize, tsize;
+                if (id >= sigs.size() || !fits(pos, end, 8+3*8)) return false;
+                take(pos, count);
+                take(pos, stride);
+                take(pos, raw_size);
+                take(pos, vsize);
+                take(pos, tsize);
+                if (!fits(pos, end, tsize) || !fits(pos+tsize, end, vsize)) return false;
+                trace_signal& s = sigs[id];
+                if (s.timed && !trace_codec::decode_times(pos, pos+tsize, count, s.times))
+                    return false;
+                pos += tsize;
+                if (!trace_codec::decode_values(pos, pos+vsize, raw_size, stride, s.raw))
+                    return false;
+                pos += vsize;
+                s.count += count;
+            }
+            else
+                return false;
+        }
+        return true;
+    }
+
+    //! The names of the recorded signals
+    std::vector<std::string> signals() const
+    {
+        std::vector<std::string> res;
+        for (auto& s : sigs) res.push_back(s.name);
+        return res;
+    }
+
+    //! Checks if a signal is recorded in the trace
+    bool has_signal(const std::string& name) const {return find(name) != NULL;}
+
+    //! The number of the recorded tokens of a signal
+    size_t size(const std::string& name) const {return get(name).count;}
+
+    //! The name of the token type of a signal, as given by typeid
+    const std::string& type(const std::string& name) const {return get(name).type;}
+
+    //! The serialized values of a signal
+    const std::vector<char>& raw(const std::string& name) const {return get(name).raw;}
+
+    //! The time tags of a timed signal in seconds
+    std::vector<double> times(const std::string& name) const
+    {
+        std::vector<double> res;
+        for (auto t : get(name).times) res.push_back(t * resolution);
+        return res;
+    }
+
+    //! The values of a signal
+    /*! V should be the value type of the recorded tokens, e.g.,
+     * abst_ext<T> for the SY, DT and DDE signals and T for the SDF ones.
+     * With FORSYDE_ABSENT_RLE, a run of absent tokens written as a single
+     * record is also recorded as one value.
+     */
+    template <typename V>
+    std::vector<V> values(const std::string& name) const
+    {
+        const trace_signal& s = get(name);
+        std::vector<V> res(s.count);
+        const char* pos = s.raw.data();
+        for (auto& v : res) serializer<V>::read(pos, v);
+        return res;
+    }
+
+    //! The index of the first token of a signal which differs in two traces
+    /*! It returns npos if both the values and the time tags of the two
+     * traces are the same. If one trace is a prefix of the other, the
+     * length of the shorter one is returned.
+     */
+    template <typename V>
+    size_t first_difference(const trace_reader& other, const std::string& name) const
+    {
+        const auto a = values<V>(name), b = other.values<V>(name);
+        const auto& ta = get(name).times;
+        const auto& tb = other.get(name).times;
+        const size_t n = std::min(a.size(), b.size());
+        for (size_t i=0; i<n; i++)
+            if (!(a[i] == b[i]) || (i<ta.size() && i<tb.size() &&
+                                    ta[i]*resolution != tb[i]*other.resolution))
+                return i;
+        return a.size()==b.size() ? npos : n;
+    }
+
+private:
+    struct trace_signal
+    {
+        std::string name, type;
+        bool timed;
+        size_t count;
+        std::vector<char> raw;
+        std::vector<std::uint64_t> times;
+    };
+
+    double resolution;
+    std::vector<trace_signal> sigs;
+
+    const trace_signal* find(const std::string& name) const
+    {
+        for (auto& s : sigs)
+            if (s.name == name) return &s;
+        return NULL;
+    }
+
+    const trace_signal& get(const std::string& name) const
+    {
+        const trace_signal* s = find(name);
+        if (s == NULL)
+            SC_REPORT_ERROR("trace_reader", ("no signal named " + name).c_str());
+        return *s;
+    }
+
+    static bool fits(const char* pos, const char* end, size_t n)
+    {
+        return size_t(end - pos) >= n;
+    }
+
+    template <typename N>
+    static void take(const char*& pos, N& v)
+    {
+        std::memcpy(&v, pos, sizeof(v));
+        pos += sizeof(v);
+    }
+
+    static bool take_string(const char*& pos, const char* end, std::string& s)
+    {
+        std::uint32_t len;
+        if (!fits(pos, end, sizeof(len))) return false;
+        take(pos, len);
+        if (!fits(pos, end, len)) return false;
+        s.assign(pos, len);
+        pos += len;
+        return true;
+    }
+};
+
+}
+
+#endif
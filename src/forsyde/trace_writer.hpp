@@ -0,0 +1,202 @@
+/**********************************************************************
+    * trace_writer.hpp -- Buffered writer of sampled signal traces    *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Recording the samples of one or more signals into a    *
+    *          text or binary trace file with a low overhead          *
+    *                                                                 *
+    * Usage:   Used by the trace processes of the CT MoC              *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef TRACE_WRITER_HPP
+#define TRACE_WRITER_HPP
+
+/*! \file trace_writer.hpp
+ * \brief Implements a buffered writer for signal traces
+ *
+ *  This file includes the writer used by the trace processes to record
+ * the sampled values of a number of signals as the columns of a single
+ * file. The output is accumulated in a memory block and written to the
+ * file only when the block is full, and optionally decimated by keeping
+ * the minimum and maximum of each signal in a number of samples.
+ */
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdio>
+#include <cstdint>
+#include <algorithm>
+
+//! The size of the memory block of a trace writer in bytes
+#ifndef FORSYDE_TRACE_BUFFER
+#define FORSYDE_TRACE_BUFFER (1<<16)
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! The file formats of the traces
+enum trace_format
+{
+    TRACE_TEXT,     ///< space-separated columns, readable by gaw or gnuplot
+    TRACE_BINARY    ///< a header followed by rows of raw float64 values
+};
+
+//! A buffered writer of the samples of several signals
+/*! Each row of the trace consists of the sample time followed by one
+ * column per signal. In the text format the first line is a comment
+ * with the names of the columns.
+ *
+ * The binary format starts with the eight characters "FSDTRACE", the
+ * number of columns (including the time) and the length of the names as
+ * 32-bit unsigned integers, and the names of the columns separated by
+ * spaces. The rows follow as float64 values in the host byte order.
+ *
+ * If the decimation factor is larger than one, each row summarizes that
+ * many samples by the time of the first one, and the minimum and maximum
+ * of each signal in two columns named <signal>_min and <signal>_max.
+ * Hence the extremes of the signals are visible in the plots.
+ */
+class trace_writer
+{
+public:
+    trace_writer() : format(TRACE_TEXT), decimation(1), nsigs(0), count(0) {}
+
+    ~trace_writer() {close();}
+
+    trace_writer(const trace_writer&) = delete;
+    trace_writer& operator=(const trace_writer&) = delete;
+
+    //! Opens the output file and writes the header
+    bool open(const std::string& file_name,         ///< the output file
+              const std::vector<std::string>& names,///< names of the signals
+              trace_format format=TRACE_TEXT,       ///< the file format
+              unsigned decimation=1                 ///< samples per row
+              )
+    {
+        this->format = format;
+        this->decimation = std::max(decimation, 1u);
+        nsigs = names.size();
+        count = 0;
+        row.assign(1 + nsigs*(this->decimation>1 ? 2 : 1), 0.0);
+        buf.clear();
+        buf.reserve(FORSYDE_TRACE_BUFFER + 64*row.size());
+        outFile.open(file_name, format==TRACE_BINARY ?
+                     std::ios::out|std::ios::binary : std::ios::out);
+        if (!outFile.is_open()) return false;
+
+        std::string header = "time";
+        for (auto& n : names)
+            if (this->decimation > 1)
+                header += " " + n + "_min " + n + "_max";
+            else
+                header += " " + n;
+        if (format == TRACE_BINARY)
+        {
+            const std::uint32_t cols = row.size(), len = header.size();
+            append("FSDTRACE", 8);
+            append(&cols, sizeof(cols));
+            append(&len, sizeof(len));
+            append(header.data(), len);
+        }
+        else
+        {
+            buf.push_back('#');
+            append(header.data(), header.size());
+            buf.push_back('\n');
+        }
+        return true;
+    }
+
+    //! Records one sample of all the signals
+    void sample(double t, const double* vals)
+    {
+        if (decimation == 1)
+        {
+            row[0] = t;
+            std::copy(vals, vals+nsigs, row.begin()+1);
+            emit();
+            return;
+        }
+        if (count == 0)
+        {
+            row[0] = t;
+            for (size_t i=0; i<nsigs; i++)
+                row[1+2*i] = row[2+2*i] = vals[i];
+        }
+        else
+            for (size_t i=0; i<nsigs; i++)
+            {
+                row[1+2*i] = std::min(row[1+2*i], vals[i]);
+                row[2+2*i] = std::max(row[2+2*i], vals[i]);
+            }
+        if (++count == decimation)
+        {
+            emit();
+            count = 0;
+        }
+    }
+
+    //! Writes the remaining samples and closes the file
+    void close()
+    {
+        if (!outFile.is_open()) return;
+        if (count > 0)
+        {
+            emit();
+            count = 0;
+        }
+        flush();
+        outFile.close();
+    }
+
+private:
+    std::ofstream outFile;
+    trace_format format;
+    unsigned decimation;
+    size_t nsigs;
+    unsigned count;
+    std::vector<double> row;
+    std::vector<char> buf;
+
+    void append(const void* data, size_t len)
+    {
+        const char* p = static_cast<const char*>(data);
+        buf.insert(buf.end(), p, p+len);
+    }
+
+    //! Appends the current row to the buffer
+    void emit()
+    {
+        if (format == TRACE_BINARY)
+            append(row.data(), row.size()*sizeof(double));
+        else
+        {
+            // the same representation as the default formatting of ostream
+            char num[32];
+            for (size_t i=0; i<row.size(); i++)
+            {
+                const int len = std::snprintf(num, sizeof(num), "%g", row[i]);
+                append(num, len);
+                buf.push_back(i+1<row.size() ? ' ' : '\n');
+            }
+        }
+        if (buf.size() >= FORSYDE_TRACE_BUFFER) flush();
+    }
+
+    void flush()
+    {
+        outFile.write(buf.data(), buf.size());
+        buf.clear();
+    }
+};
+
+}
+
+#endif
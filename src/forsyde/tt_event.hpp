@@ -17,6 +17,9 @@
  * \brief Implements the time-tagged events
  */
 
+#include <utility>
+#include <type_traits>
+
 #include "abst_ext.hpp"
 
 namespace ForSyDe
@@ -34,19 +37,27 @@ struct tt_event
     //! The constructor with time and value
     tt_event(const VT& value, const TT& time) : value(value), time(time) {}
     
+    //! The constructor with time and a value which is moved in
+    tt_event(VT&& value, const TT& time) : value(std::move(value)), time(time) {}
+    
     //! The default constructor
-    tt_event ()
-    {
-        value = VT();
-        time = TT();
-    }
+    tt_event () : value(), time() {}
     
     //! The copy constructor
-    tt_event (const tt_event& ev)
-    {
-        value = get_value(ev);
-        time = get_time(ev);
-    }
+    tt_event (const tt_event&) = default;
+    
+    //! The move constructor
+    tt_event (tt_event&&)
+        noexcept(std::is_nothrow_move_constructible<VT>::value &&
+                 std::is_nothrow_move_constructible<TT>::value) = default;
+    
+    //! The copy assignment operator
+    tt_event& operator= (const tt_event&) = default;
+    
+    //! The move assignment operator
+    tt_event& operator= (tt_event&&)
+        noexcept(std::is_nothrow_move_assignable<VT>::value &&
+                 std::is_nothrow_move_assignable<TT>::value) = default;
     
     //! Checks for the equivalence of two timed events
     /*! Returns true only if both the values and time tags match.
@@ -63,12 +74,17 @@ struct tt_event
         return os;
     }
     
-    inline friend VT get_value(const tt_event& ev) {return ev.value;}
+    inline friend const VT& get_value(const tt_event& ev) {return ev.value;}
     
-    inline friend TT get_time(const tt_event& ev) {return ev.time;}
+    //! Moves the value out of an expiring event
+    inline friend VT get_value(tt_event&& ev) {return std::move(ev.value);}
+    
+    inline friend const TT& get_time(const tt_event& ev) {return ev.time;}
     
     inline friend void set_value(tt_event& ev, const VT& v) {ev.value = v;}
     
+    inline friend void set_value(tt_event& ev, VT&& v) {ev.value = std::move(v);}
+    
     inline friend void set_time(tt_event& ev, const TT& t) {ev.time = t;}
     
 private:
@@ -27,6 +27,11 @@
 
 // The general case uses RTTI (if the type is not registered explicitly)
 #pragma once
+#include <string>
+#include <deque>
+#include <unordered_map>
+#include <typeinfo>
+
 template<typename T> const char* get_type_name() {return typeid(T).name();}
 
 // Specialization for each type
@@ -53,6 +58,50 @@ DEFINE_TYPE(double);
 DEFINE_TYPE(long double);
 DEFINE_TYPE(wchar_t);
 
+//! Interns names as dense numeric IDs
+/*! The names are stored once and can be compared by their IDs. It is
+ * used during the elaboration, which is single-threaded.
+ */
+class name_registry
+{
+public:
+    //! Returns the ID of a name, registering it if it is new
+    unsigned intern(const std::string& name)
+    {
+        auto it = ids.find(name);
+        if (it != ids.end()) return it->second;
+        const unsigned id = names.size();
+        names.push_back(name);
+        ids.emplace(name, id);
+        return id;
+    }
+    
+    //! Returns the name with an ID
+    const char* name(unsigned id) const {return names[id].c_str();}
+    
+    //! The number of the registered names
+    size_t size() const {return names.size();}
+    
+private:
+    std::unordered_map<std::string,unsigned> ids;
+    std::deque<std::string> names;
+};
+
+//! The registry of the token type names
+inline name_registry& type_names() {static name_registry r; return r;}
+
+//! The registry of the MoC names
+inline name_registry& moc_names() {static name_registry r; return r;}
+
+//! Returns the interned ID of the name of a type
+/*! The name is looked up only once per type.
+ */
+template<typename T> unsigned get_type_id()
+{
+    static const unsigned id = type_names().intern(get_type_name<T>());
+    return id;
+}
+
 
 //~ }
 
@@ -0,0 +1,1090 @@
+/**********************************************************************
+    * udp_io.hpp -- Network sources and sinks over UDP                *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Connecting ForSyDe models to live data without         *
+    *          blocking the SystemC kernel on the sockets             *
+    *                                                                 *
+    * Usage:   Define FORSYDE_UDP_IO to use it                        *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef UDP_IO_HPP
+#define UDP_IO_HPP
+
+/*! \file udp_io.hpp
+ * \brief Implements the UDP source and sink processes
+ *
+ *  This file includes the source and sink processes of the SY, SDF and
+ * DDE MoCs which receive and send their tokens as UDP datagrams, one
+ * token per datagram serialized using serializer<T>. The sockets are
+ * served by a dedicated I/O thread per process, which receives and sends
+ * the datagrams in batches (using recvmmsg and sendmmsg on Linux) and
+ * hands them over to the process through a lock-free ring. A source
+ * which waits for a datagram is woken up by an asynchronous update
+ * request, hence the rest of the model keeps running meanwhile.
+ *
+ *  When no datagram is available, an SY source writes an absent event,
+ * repeats its last value or waits, depending on its underrun policy. The
+ * DDE sink prefixes each datagram with the time tag of its event, and a
+ * DDE source either reads such time tags or tags each event with its
+ * arrival time, measured from the start of the simulation on the
+ * monotonic clock (e.g., to be used with a realtime_pacer):
+ *
+ *     auto src = SY::make_udp_source<float>("src", "0.0.0.0:5000", samples,
+ *                                           UNDERRUN_ABSENT, sc_time(1, SC_MS));
+ *     SY::make_udp_sink("snk", "10.0.0.2:5001", results);
+ *
+ *  A source which waits for the datagrams does not keep the simulation
+ * alive by itself, hence the model should have other activity (e.g., a
+ * realtime_pacer which keeps the simulation alive) or be started with a
+ * duration.
+ */
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <type_traits>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include "serializer.hpp"
+
+//! The largest number of datagrams received or sent by one system call
+#ifndef FORSYDE_UDP_BATCH
+#define FORSYDE_UDP_BATCH 32
+#endif
+
+//! The default number of datagrams buffered between a process and its I/O thread
+#ifndef FORSYDE_UDP_SLOTS
+#define FORSYDE_UDP_SLOTS 256
+#endif
+
+//! The largest datagram in bytes
+#ifndef FORSYDE_UDP_MAX_DATAGRAM
+#define FORSYDE_UDP_MAX_DATAGRAM 2048
+#endif
+
+//! The time in milliseconds the I/O threads wait before checking for the end
+#ifndef FORSYDE_UDP_POLL_TIMEOUT
+#define FORSYDE_UDP_POLL_TIMEOUT 100
+#endif
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! What the network sources do when no datagram is available
+enum underrun_policy
+{
+    UNDERRUN_ABSENT,    ///< write an absent event (or the fill value in SDF)
+    UNDERRUN_HOLD,      ///< repeat the last value
+    UNDERRUN_WAIT       ///< wait for the next datagram
+};
+
+//! A lock-free single-producer single-consumer ring of datagrams
+/*! The producer fills the free slots after the tail and publishes them,
+ * and the consumer reads the published slots after the head and
+ * releases them. The storage of the slots is allocated once.
+ */
+class datagram_ring
+{
+public:
+    typedef std::chrono::steady_clock clock;
+
+    //! A datagram in the ring
+    struct slot
+    {
+        std::vector<char> data;
+        size_t len;
+        clock::time_point stamp;    ///< the time it was received
+    };
+
+    datagram_ring(size_t n, size_t max_size) : slots(n), head(0), tail(0)
+    {
+        for (auto& s : slots) s.data.resize(max_size);
+    }
+
+    //! The number of slots the producer can fill
+    size_t free_slots() const
+    {
+        return slots.size() - (tail.load(std::memory_order_relaxed) -
+                               head.load(std::memory_order_acquire));
+    }
+
+    //! The k-th free slot
+    slot& free_slot(size_t k) {return slots[(tail.load(std::memory_order_relaxed)+k) % slots.size()];}
+
+    //! Makes the first n free slots available to the consumer
+    void publish(size_t n) {tail.fetch_add(n, std::memory_order_release);}
+
+    //! The number of slots the consumer can read
+    size_t available() const
+    {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_relaxed);
+    }
+
+    //! The k-th available slot
+    slot& used_slot(size_t k) {return slots[(head.load(std::memory_order_relaxed)+k) % slots.size()];}
+
+    //! Returns the first n available slots to the producer
+    void release(size_t n) {head.fetch_add(n, std::memory_order_release);}
+
+    //! The largest datagram a slot can hold
+    size_t max_size() const {return slots[0].data.size();}
+
+private:
+    std::vector<slot> slots;
+    alignas(64) std::atomic<size_t> head;
+    alignas(64) std::atomic<size_t> tail;
+};
+
+//! Resolves an IPv4 address of the form "host:port"
+inline bool udp_resolve(const std::string& addr, sockaddr_in& res)
+{
+    const size_t colon = addr.rfind(':');
+    if (colon == std::string::npos) return false;
+    const std::string host = addr.substr(0, colon);
+    const std::string port = addr.substr(colon+1);
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* ai = NULL;
+    if (getaddrinfo(host.empty() ? NULL : host.c_str(), port.c_str(), &hints, &ai) != 0)
+        return false;
+    std::memcpy(&res, ai->ai_addr, sizeof(res));
+    freeaddrinfo(ai);
+    return true;
+}
+
+//! Wakes up a process waiting for datagrams from another thread
+/*! The I/O thread requests an asynchronous update, which notifies the
+ * arrival event in the next delta cycle of the kernel.
+ */
+class udp_notifier : public sc_prim_channel
+{
+public:
+    udp_notifier() : sc_prim_channel(sc_gen_unique_name("udp_notifier")) {}
+
+    //! Requests the notification, it can be called from any thread
+    void notify_async() {async_request_update();}
+
+    //! The event notified after the datagrams have arrived
+    const sc_event& arrival_event() const {return arrival;}
+
+private:
+    sc_event arrival;
+
+    void update() {arrival.notify(SC_ZERO_TIME);}
+};
+
+//! The I/O thread which receives the datagrams of a source
+class udp_receiver
+{
+public:
+    udp_receiver(size_t slots) : ring(slots, FORSYDE_UDP_MAX_DATAGRAM), fd(-1),
+                                 stop(false), received(0), overruns(0) {}
+
+    ~udp_receiver() {finish();}
+
+    //! Binds the socket to the local address and starts the thread
+    bool start(const std::string& local, udp_notifier* notifier)
+    {
+        if (fd >= 0) return true;
+        sockaddr_in addr;
+        if (!udp_resolve(local, addr)) return false;
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        const int one = 1;
+        if (fd >= 0) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (fd < 0 || bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+        {
+            if (fd >= 0) close(fd);
+            fd = -1;
+            return false;
+        }
+        stop = false;
+        this->notifier = notifier;
+        worker = std::thread([this] {run();});
+        return true;
+    }
+
+    //! Stops the thread and closes the socket
+    void finish()
+    {
+        stop = true;
+        if (worker.joinable()) worker.join();
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+    //! The datagrams handed over to the process
+    datagram_ring ring;
+
+    //! The number of the received datagrams
+    unsigned long long received_count() const {return received.load(std::memory_order_relaxed);}
+
+    //! The number of the datagrams dropped because the ring was full
+    unsigned long long overrun_count() const {return overruns.load(std::memory_order_relaxed);}
+
+private:
+    int fd;
+    udp_notifier* notifier;
+    std::thread worker;
+    std::atomic<bool> stop;
+    std::atomic<unsigned long long> received, overruns;
+
+    void run()
+    {
+        std::vector<char> scratch(ring.max_size());
+        while (!stop)
+        {
+            pollfd pfd{fd, POLLIN, 0};
+            if (poll(&pfd, 1, FORSYDE_UDP_POLL_TIMEOUT) <= 0) continue;
+            const size_t n = std::min<size_t>(ring.free_slots(), FORSYDE_UDP_BATCH);
+            if (n == 0)
+            {
+                // the process is behind, the newest datagrams are dropped
+                while (recv(fd, scratch.data(), scratch.size(), MSG_DONTWAIT) >= 0)
+                    overruns.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            size_t k = 0;
+#ifdef __linux__
+            mmsghdr msgs[FORSYDE_UDP_BATCH];
+            iovec iov[FORSYDE_UDP_BATCH];
+            std::memset(msgs, 0, sizeof(mmsghdr)*n);
+            for (size_t i=0; i<n; i++)
+            {
+                iov[i].iov_base = ring.free_slot(i).data.data();
+                iov[i].iov_len = ring.max_size();
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            const int res = recvmmsg(fd, msgs, n, MSG_DONTWAIT, NULL);
+            if (res <= 0) continue;
+            k = res;
+            for (size_t i=0; i<k; i++) ring.free_slot(i).len = msgs[i].msg_len;
+#else
+            for (; k<n; k++)
+            {
+                const ssize_t len = recv(fd, ring.free_slot(k).data.data(),
+                                         ring.max_size(), MSG_DONTWAIT);
+                if (len < 0) break;
+                ring.free_slot(k).len = len;
+            }
+            if (k == 0) continue;
+#endif
+            const auto now = datagram_ring::clock::now();
+            for (size_t i=0; i<k; i++) ring.free_slot(i).stamp = now;
+            ring.publish(k);
+            received.fetch_add(k, std::memory_order_relaxed);
+            notifier->notify_async();
+        }
+    }
+};
+
+//! The I/O thread which sends the datagrams of a sink
+class udp_transmitter
+{
+public:
+    udp_transmitter(size_t slots) : ring(slots, FORSYDE_UDP_MAX_DATAGRAM), fd(-1),
+                                    stop(false), sleeping(false), sent(0), dropped(0) {}
+
+    ~udp_transmitter() {finish();}
+
+    //! Connects the socket to the remote address and starts the thread
+    bool start(const std::string& remote)
+    {
+        if (fd >= 0) return true;
+        sockaddr_in addr;
+        if (!udp_resolve(remote, addr)) return false;
+        fd = socket(AF_INET, SOCK_DGRAM, 0);
+        if (fd < 0 || connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+        {
+            if (fd >= 0) close(fd);
+            fd = -1;
+            return false;
+        }
+        stop = false;
+        worker = std::thread([this] {run();});
+        return true;
+    }
+
+    //! Queues a datagram, or drops it if the ring is full
+    /*! It is called by the process.
+     */
+    void send(const std::vector<char>& buf)
+    {
+        if (buf.size() > ring.max_size() || ring.free_slots() == 0)
+        {
+            dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        datagram_ring::slot& s = ring.free_slot(0);
+        std::memcpy(s.data.data(), buf.data(), buf.size());
+        s.len = buf.size();
+        ring.publish(1);
+        if (sleeping.load(std::memory_order_seq_cst))
+        {
+            std::lock_guard<std::mutex> lk(m);
+            cv.notify_one();
+        }
+    }
+
+    //! Sends the queued datagrams, stops the thread and closes the socket
+    void finish()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+            cv.notify_one();
+        }
+        if (worker.joinable()) worker.join();
+        if (fd >= 0) close(fd);
+        fd = -1;
+    }
+
+    //! The number of the sent datagrams
+    unsigned long long sent_count() const {return sent.load(std::memory_order_relaxed);}
+
+    //! The number of the datagrams dropped because the ring was full or they were too large
+    unsigned long long dropped_count() const {return dropped.load(std::memory_order_relaxed);}
+
+private:
+    datagram_ring ring;
+    int fd;
+    std::thread worker;
+    std::mutex m;
+    std::condition_variable cv;
+    std::atomic<bool> stop, sleeping;
+    std::atomic<unsigned long long> sent, dropped;
+
+    //! The number of polls of the ring before the thread goes to sleep
+    static const unsigned spin_count = 4096;
+
+    void run()
+    {
+        while (true)
+        {
+            size_t n = 0;
+            for (unsigned k=0; k<spin_count && (n = ring.available()) == 0; k++)
+                std::this_thread::yield();
+            if (n == 0)
+            {
+                std::unique_lock<std::mutex> lk(m);
+                sleeping = true;
+                cv.wait_for(lk, std::chrono::milliseconds(FORSYDE_UDP_POLL_TIMEOUT),
+                            [this] {return stop || ring.available() > 0;});
+                sleeping = false;
+                n = ring.available();
+                if (n == 0 && stop) return;
+                if (n == 0) continue;
+            }
+            n = std::min<size_t>(n, FORSYDE_UDP_BATCH);
+            size_t k = 0;
+#ifdef __linux__
+            mmsghdr msgs[FORSYDE_UDP_BATCH];
+            iovec iov[FORSYDE_UDP_BATCH];
+            std::memset(msgs, 0, sizeof(mmsghdr)*n);
+            for (size_t i=0; i<n; i++)
+            {
+                iov[i].iov_base = ring.used_slot(i).data.data();
+                iov[i].iov_len = ring.used_slot(i).len;
+                msgs[i].msg_hdr.msg_iov = &iov[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+            }
+            const int res = sendmmsg(fd, msgs, n, 0);
+            k = res > 0 ? res : 0;
+#else
+            for (; k<n; k++)
+                if (::send(fd, ring.used_slot(k).data.data(), ring.used_slot(k).len, 0) < 0)
+                    break;
+#endif
+            // the datagrams which could not be sent are dropped
+            if (k == 0)
+            {
+                k = 1;
+                dropped.fetch_add(1, std::memory_order_relaxed);
+            }
+            else
+                sent.fetch_add(k, std::memory_order_relaxed);
+            ring.release(k);
+        }
+    }
+};
+
+//! Checks the length of a datagram carrying a token from an offset
+/*! The tokens with a bounded serialized size should fit in it, and the
+ * ones serialized as their raw bytes should fill it. The datagrams with
+ * unbounded tokens (e.g., vectors) are trusted to be well-formed.
+ */
+template <typename T>
+inline bool udp_check(const datagram_ring::slot& s, size_t offset)
+{
+    constexpr size_t max = serializer<T>::max_size;
+    if (s.len <= offset) return false;
+    if (max != 0 && s.len - offset > max) return false;
+    if (std::is_trivially_copyable<T>::value && max == sizeof(T) && s.len - offset != max)
+        return false;
+    return true;
+}
+
+//! Reads a token from a received datagram
+/*! It returns false if the datagram is malformed.
+ */
+template <typename T>
+inline bool udp_decode(const datagram_ring::slot& s, size_t offset, T& val)
+{
+    if (!udp_check<T>(s, offset)) return false;
+    const char* pos = s.data.data() + offset;
+    serializer<T>::read(pos, val);
+    return true;
+}
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! Process constructor for a source process receiving UDP datagrams
+/*! This class is used to build a source process which writes the tokens
+ * received on a local UDP address, one token per datagram. In each
+ * evaluation cycle it writes the oldest received token, or follows the
+ * underrun policy if there is none. If a period is given, the process
+ * waits for it in each cycle, which paces the sampling of the socket in
+ * the simulated time.
+ */
+template <typename T0>
+class udp_source : public sy_process
+{
+public:
+    SY_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the received tokens using
+     * the output port
+     */
+    udp_source(sc_module_name _name,            ///< process name
+               const std::string& local,        ///< the local address, "host:port"
+               underrun_policy policy=UNDERRUN_ABSENT, ///< the action when no datagram is available
+               const sc_time& period=SC_ZERO_TIME,     ///< the simulated time of a cycle
+               unsigned long long take=0,       ///< number of tokens produced (0 for infinite)
+               size_t slots=FORSYDE_UDP_SLOTS   ///< the datagrams buffered
+              ) : sy_process(_name), oport1("oport1"), local(local),
+                  policy(policy), period(period), take(take), io(slots)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("local", local);
+        add_arg("policy", policy);
+        add_arg("period", period);
+        add_arg("take", take);
+        add_arg("slots", slots);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::udp_source";}
+
+    //! The number of the received datagrams
+    unsigned long long received() const {return io.received_count();}
+
+    //! The number of the datagrams dropped because the process was behind
+    unsigned long long overruns() const {return io.overrun_count();}
+
+    //! The number of the cycles without a received token
+    unsigned long long underruns() const {return underrun_n;}
+
+private:
+    std::string local;
+    underrun_policy policy;
+    sc_time period;
+    unsigned long long take;
+
+    abst_ext<T0> oval1;
+    unsigned long long tok_cnt, underrun_n;
+    udp_receiver io;
+    udp_notifier notifier;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!io.start(local, &notifier))
+            SC_REPORT_ERROR(name(), ("the socket could not be bound to " + local).c_str());
+        oval1 = abst_ext<T0>();
+        tok_cnt = underrun_n = 0;
+    }
+
+    void prep()
+    {
+        if (take != 0 && tok_cnt++ >= take) wait();
+        if (period != SC_ZERO_TIME) wait(period);
+        while (true)
+        {
+            if (io.ring.available() > 0)
+            {
+                T0 val;
+                const bool good = udp_decode(io.ring.used_slot(0), 0, val);
+                io.ring.release(1);
+                if (!good)
+                {
+                    SC_REPORT_WARNING(name(), "dropped a malformed datagram");
+                    continue;
+                }
+                oval1 = abst_ext<T0>(std::move(val));
+                return;
+            }
+            if (policy != UNDERRUN_WAIT) break;
+            wait(notifier.arrival_event());
+        }
+        underrun_n++;
+        if (policy == UNDERRUN_ABSENT) oval1 = abst_ext<T0>();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, oval1);
+    }
+
+    void clean()
+    {
+        io.finish();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a sink process sending UDP datagrams
+/*! This class is used to build a sink process which sends each present
+ * token it reads to a remote UDP address, one token per datagram. The
+ * absent events are not sent. The tokens which can not be queued
+ * because the I/O thread is behind are dropped.
+ */
+template <typename T1>
+class udp_sink : public sy_process
+{
+public:
+    SY_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * sends them to the remote address
+     */
+    udp_sink(sc_module_name _name,            ///< process name
+             const std::string& remote,       ///< the remote address, "host:port"
+             size_t slots=FORSYDE_UDP_SLOTS   ///< the datagrams buffered
+            ) : sy_process(_name), iport1("iport1"), remote(remote), io(slots)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("remote", remote);
+        add_arg("slots", slots);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SY::udp_sink";}
+
+    //! The number of the sent datagrams
+    unsigned long long sent() const {return io.sent_count();}
+
+    //! The number of the dropped tokens
+    unsigned long long dropped() const {return io.dropped_count();}
+
+private:
+    std::string remote;
+
+    abst_ext<T1> ival1;
+    std::vector<char> buf;
+    udp_transmitter io;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!io.start(remote))
+            SC_REPORT_ERROR(name(), ("the socket could not be connected to " + remote).c_str());
+    }
+
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        if (is_absent(ival1)) return;
+        buf.clear();
+        serializer<T1>::write(buf, unsafe_from_abst_ext(ival1));
+        io.send(buf);
+    }
+
+    void clean()
+    {
+        io.finish();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+}
+
+#ifndef FORSYDE_NO_SDF
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! Process constructor for a source process receiving UDP datagrams
+/*! This class is used to build a source process which writes the tokens
+ * received on a local UDP address, one token per datagram. When no
+ * datagram is available it waits for one by default; it can instead
+ * write a fill value (UNDERRUN_ABSENT) or repeat its last token
+ * (UNDERRUN_HOLD).
+ */
+template <typename T0>
+class udp_source : public sdf_process
+{
+public:
+    SDF_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the received tokens using
+     * the output port
+     */
+    udp_source(sc_module_name _name,            ///< process name
+               const std::string& local,        ///< the local address, "host:port"
+               underrun_policy policy=UNDERRUN_WAIT, ///< the action when no datagram is available
+               const T0& fill=T0(),             ///< the token written on an underrun
+               unsigned long long take=0,       ///< number of tokens produced (0 for infinite)
+               size_t slots=FORSYDE_UDP_SLOTS   ///< the datagrams buffered
+              ) : sdf_process(_name), oport1("oport1"), local(local),
+                  policy(policy), fill(fill), take(take), io(slots)
+    {
+        add_out_rate(oport1, 1);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("local", local);
+        add_arg("policy", policy);
+        add_arg("take", take);
+        add_arg("slots", slots);
+        add_arg("o1toks", 1);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::udp_source";}
+
+    //! The number of the received datagrams
+    unsigned long long received() const {return io.received_count();}
+
+    //! The number of the datagrams dropped because the process was behind
+    unsigned long long overruns() const {return io.overrun_count();}
+
+    //! The number of the firings without a received token
+    unsigned long long underruns() const {return underrun_n;}
+
+private:
+    std::string local;
+    underrun_policy policy;
+    T0 fill;
+    unsigned long long take;
+
+    T0 oval1;
+    unsigned long long tok_cnt, underrun_n;
+    udp_receiver io;
+    udp_notifier notifier;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!io.start(local, &notifier))
+            SC_REPORT_ERROR(name(), ("the socket could not be bound to " + local).c_str());
+        oval1 = fill;
+        tok_cnt = underrun_n = 0;
+    }
+
+    void prep()
+    {
+        if (take != 0 && tok_cnt++ >= take) wait();
+        while (true)
+        {
+            if (io.ring.available() > 0)
+            {
+                const bool good = udp_decode(io.ring.used_slot(0), 0, oval1);
+                io.ring.release(1);
+                if (good) return;
+                SC_REPORT_WARNING(name(), "dropped a malformed datagram");
+                continue;
+            }
+            if (policy != UNDERRUN_WAIT) break;
+            wait(notifier.arrival_event());
+        }
+        underrun_n++;
+        if (policy == UNDERRUN_ABSENT) oval1 = fill;
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, oval1);
+    }
+
+    void clean()
+    {
+        io.finish();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a sink process sending UDP datagrams
+/*! This class is used to build a sink process which sends each token it
+ * reads to a remote UDP address, one token per datagram. The tokens
+ * which can not be queued because the I/O thread is behind are dropped.
+ */
+template <typename T1>
+class udp_sink : public sdf_process
+{
+public:
+    SDF_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * sends them to the remote address
+     */
+    udp_sink(sc_module_name _name,            ///< process name
+             const std::string& remote,       ///< the remote address, "host:port"
+             size_t slots=FORSYDE_UDP_SLOTS   ///< the datagrams buffered
+            ) : sdf_process(_name), iport1("iport1"), remote(remote), io(slots)
+    {
+        add_in_rate(iport1, 1);
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("remote", remote);
+        add_arg("slots", slots);
+        add_arg("i1toks", 1);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "SDF::udp_sink";}
+
+    //! The number of the sent datagrams
+    unsigned long long sent() const {return io.sent_count();}
+
+    //! The number of the dropped tokens
+    unsigned long long dropped() const {return io.dropped_count();}
+
+private:
+    std::string remote;
+
+    T1 ival1;
+    std::vector<char> buf;
+    udp_transmitter io;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!io.start(remote))
+            SC_REPORT_ERROR(name(), ("the socket could not be connected to " + remote).c_str());
+    }
+
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        buf.clear();
+        serializer<T1>::write(buf, ival1);
+        io.send(buf);
+    }
+
+    void clean()
+    {
+        io.finish();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+}
+#endif
+
+#ifndef FORSYDE_NO_DDE
+namespace DDE
+{
+
+using namespace sc_core;
+
+//! Process constructor for a source process receiving UDP datagrams
+/*! This class is used to build a source process which writes the events
+ * received on a local UDP address, one event per datagram, and waits
+ * for the datagrams in between.
+ *
+ * If the datagrams are stamped (e.g., sent by a DDE::udp_sink), each of
+ * them carries the time tag of its event before the value. Otherwise
+ * the event is tagged with the arrival time of the datagram on the
+ * monotonic clock since the process started, multiplied by the speed.
+ * The time tags earlier than the current time of the process (e.g., of
+ * the datagrams which waited in the ring) are moved to the current time.
+ */
+template <typename T0>
+class udp_source : public dde_process
+{
+public:
+    DDE_out<T0>  oport1;       ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the received events using
+     * the output port
+     */
+    udp_source(sc_module_name _name,            ///< process name
+               const std::string& local,        ///< the local address, "host:port"
+               bool stamped=false,              ///< the datagrams carry the time tags
+               double speed=1.0,                ///< the ratio of the simulated to the wall-clock time
+               unsigned long long take=0,       ///< number of events produced (0 for infinite)
+               size_t slots=FORSYDE_UDP_SLOTS   ///< the datagrams buffered
+              ) : dde_process(_name), oport1("oport1"), local(local),
+                  stamped(stamped), speed(speed), take(take), io(slots)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("local", local);
+        add_arg("stamped", stamped);
+        add_arg("speed", speed);
+        add_arg("take", take);
+        add_arg("slots", slots);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::udp_source";}
+
+    //! The number of the received datagrams
+    unsigned long long received() const {return io.received_count();}
+
+    //! The number of the datagrams dropped because the process was behind
+    unsigned long long overruns() const {return io.overrun_count();}
+
+private:
+    std::string local;
+    bool stamped;
+    double speed;
+    unsigned long long take;
+
+    ttn_event<T0> oval1;
+    unsigned long long tok_cnt;
+    udp_receiver io;
+    udp_notifier notifier;
+    // The wall-clock and the simulated time when the process started
+    datagram_ring::clock::time_point origin;
+    sc_time origin_time;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!io.start(local, &notifier))
+            SC_REPORT_ERROR(name(), ("the socket could not be bound to " + local).c_str());
+        origin = datagram_ring::clock::now();
+        origin_time = model_time();
+        tok_cnt = 0;
+    }
+
+    void prep()
+    {
+        if (take != 0 && tok_cnt++ >= take) halt();
+        while (true)
+        {
+            if (io.ring.available() == 0)
+            {
+                wait(notifier.arrival_event());
+                continue;
+            }
+            const datagram_ring::slot& s = io.ring.used_slot(0);
+            sc_time t;
+            bool good;
+            if (stamped)
+            {
+                // the flag of an absent value fits in any datagram
+                good = s.len > sizeof(std::uint64_t) &&
+                       (serializer<abst_ext<T0>>::max_size == 0 ||
+                        s.len - sizeof(std::uint64_t) <= serializer<abst_ext<T0>>::max_size);
+                if (good)
+                {
+                    const char* pos = s.data.data();
+                    std::uint64_t tag;
+                    abst_ext<T0> val;
+                    serializer<std::uint64_t>::read(pos, tag);
+                    serializer<abst_ext<T0>>::read(pos, val);
+                    t = sc_time::from_value(tag);
+                    oval1 = ttn_event<T0>(std::move(val), t);
+                }
+            }
+            else
+            {
+                T0 val;
+                good = udp_decode(s, 0, val);
+                t = origin_time + sc_time(std::chrono::duration<double>(
+                                              s.stamp - origin).count() * speed, SC_SEC);
+                oval1 = ttn_event<T0>(abst_ext<T0>(std::move(val)), t);
+            }
+            io.ring.release(1);
+            if (good) break;
+            SC_REPORT_WARNING(name(), "dropped a malformed datagram");
+        }
+        if (get_time(oval1) < model_time())
+            oval1 = ttn_event<T0>(get_value(oval1), model_time());
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        write_multiport(oport1, oval1);
+        sync(get_time(oval1));
+    }
+
+    void clean()
+    {
+        io.finish();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundOutChans.resize(1);    // only one output port
+        boundOutChans[0].port = &oport1;
+    }
+#endif
+};
+
+//! Process constructor for a sink process sending UDP datagrams
+/*! This class is used to build a sink process which sends each event it
+ * reads to a remote UDP address, one event per datagram. Each datagram
+ * carries the time tag of the event as a 64-bit count of the time
+ * resolution followed by its absent-extended value, which is the format
+ * read by a stamped DDE::udp_source.
+ */
+template <typename T1>
+class udp_sink : public dde_process
+{
+public:
+    DDE_in<T1>  iport1;       ///< port for the input channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which reads data from its input port and
+     * sends them to the remote address
+     */
+    udp_sink(sc_module_name _name,            ///< process name
+             const std::string& remote,       ///< the remote address, "host:port"
+             size_t slots=FORSYDE_UDP_SLOTS   ///< the datagrams buffered
+            ) : dde_process(_name), iport1("iport1"), remote(remote), io(slots)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_arg("remote", remote);
+        add_arg("slots", slots);
+#endif
+    }
+
+    //! Specifying from which process constructor is the module built
+    std::string forsyde_kind() const {return "DDE::udp_sink";}
+
+    //! The number of the sent datagrams
+    unsigned long long sent() const {return io.sent_count();}
+
+    //! The number of the dropped events
+    unsigned long long dropped() const {return io.dropped_count();}
+
+private:
+    std::string remote;
+
+    ttn_event<T1> ival1;
+    std::vector<char> buf;
+    udp_transmitter io;
+
+    //Implementing the abstract semantics
+    void init()
+    {
+        if (!io.start(remote))
+            SC_REPORT_ERROR(name(), ("the socket could not be connected to " + remote).c_str());
+    }
+
+    void prep()
+    {
+        ival1 = iport1.read();
+    }
+
+    void exec() {}
+
+    void prod()
+    {
+        buf.clear();
+        serializer<std::uint64_t>::write(buf, get_time(ival1).value());
+        serializer<abst_ext<T1>>::write(buf, get_value(ival1));
+        io.send(buf);
+    }
+
+    void clean()
+    {
+        io.finish();
+    }
+
+#ifdef FORSYDE_INTROSPECTION
+    void bindInfo()
+    {
+        boundInChans.resize(1);     // only one input port
+        boundInChans[0].port = &iport1;
+    }
+#endif
+};
+
+}
+#endif
+
+}
+
+#endif
@@ -0,0 +1,193 @@
+/**********************************************************************
+    * udp_io_helpers.hpp -- Helpers of the UDP sources and sinks      *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing helper functions to build the network        *
+    *          processes                                              *
+    *                                                                 *
+    * Usage:   Define FORSYDE_UDP_IO to use it                        *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef UDP_IO_HELPERS_HPP
+#define UDP_IO_HELPERS_HPP
+
+/*! \file udp_io_helpers.hpp
+ * \brief Implements the helper functions of the UDP sources and sinks
+ *
+ *  This file includes helper functions which construct the UDP source
+ * and sink processes and bind their signals.
+ */
+
+#include <string>
+
+#include "udp_io.hpp"
+
+namespace ForSyDe
+{
+
+namespace SY
+{
+
+using namespace sc_core;
+
+//! Helper function to construct a UDP source process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf>
+inline udp_source<T0>* make_udp_source(const std::string& pName,
+    const std::string& local,
+    OIf<T0>& outS,
+    underrun_policy policy=UNDERRUN_ABSENT,
+    const sc_time& period=SC_ZERO_TIME,
+    unsigned long long take=0,
+    size_t slots=FORSYDE_UDP_SLOTS
+    )
+{
+    auto p = new udp_source<T0>(pName.c_str(), local, policy, period, take, slots);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a UDP sink process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T1, template <class> class IIf>
+inline udp_sink<T1>* make_udp_sink(const std::string& pName,
+    const std::string& remote,
+    IIf<T1>& inpS,
+    size_t slots=FORSYDE_UDP_SLOTS
+    )
+{
+    auto p = new udp_sink<T1>(pName.c_str(), remote, slots);
+
+    (*p).iport1(inpS);
+
+    return p;
+}
+
+}
+
+#ifndef FORSYDE_NO_SDF
+namespace SDF
+{
+
+using namespace sc_core;
+
+//! Helper function to construct a UDP source process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf>
+inline udp_source<T0>* make_udp_source(const std::string& pName,
+    const std::string& local,
+    OIf<T0>& outS,
+    underrun_policy policy=UNDERRUN_WAIT,
+    const T0& fill=T0(),
+    unsigned long long take=0,
+    size_t slots=FORSYDE_UDP_SLOTS
+    )
+{
+    auto p = new udp_source<T0>(pName.c_str(), local, policy, fill, take, slots);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a UDP sink process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T1, template <class> class IIf>
+inline udp_sink<T1>* make_udp_sink(const std::string& pName,
+    const std::string& remote,
+    IIf<T1>& inpS,
+    size_t slots=FORSYDE_UDP_SLOTS
+    )
+{
+    auto p = new udp_sink<T1>(pName.c_str(), remote, slots);
+
+    (*p).iport1(inpS);
+
+    return p;
+}
+
+}
+#endif
+
+#ifndef FORSYDE_NO_DDE
+namespace DDE
+{
+
+using namespace sc_core;
+
+//! Helper function to construct a UDP source process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T0, template <class> class OIf>
+inline udp_source<T0>* make_udp_source(const std::string& pName,
+    const std::string& local,
+    OIf<T0>& outS,
+    bool stamped=false,
+    double speed=1.0,
+    unsigned long long take=0,
+    size_t slots=FORSYDE_UDP_SLOTS
+    )
+{
+    auto p = new udp_source<T0>(pName.c_str(), local, stamped, speed, take, slots);
+
+    (*p).oport1(outS);
+
+    return p;
+}
+
+//! Helper function to construct a UDP sink process
+/*! This function is used to construct a process (SystemC module) and
+ * connect its output and output signals.
+ * It provides a more functional style definition of a ForSyDe process.
+ * It also removes bilerplate code by using type-inference feature of
+ * C++ and automatic binding to the input and output FIFOs.
+ */
+template <class T1, template <class> class IIf>
+inline udp_sink<T1>* make_udp_sink(const std::string& pName,
+    const std::string& remote,
+    IIf<T1>& inpS,
+    size_t slots=FORSYDE_UDP_SLOTS
+    )
+{
+    auto p = new udp_sink<T1>(pName.c_str(), remote, slots);
+
+    (*p).iport1(inpS);
+
+    return p;
+}
+
+}
+#endif
+
+}
+
+#endif
@@ -218,10 +218,35 @@ inline scan<IT,ST>* make_scan(const std::string& pName,
     const typename scan<IT,ST>::ns_functype& _ns_func,
     const ST& init_st,
     OIf<ST>& outS,
-    IIf<IT>& inpS
+    IIf<IT>& inpS,
+    bool const_rate=false
     )
 {
-    auto p = new scan<IT,ST>(pName.c_str(), _gamma_func, _ns_func, init_st);
+    auto p = new scan<IT,ST>(pName.c_str(), _gamma_func, _ns_func, init_st, const_rate);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a scan process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST,
+           template <class> class IIf,
+           template <class> class OIf>
+inline scan<IT,ST>* make_scan(const std::string& pName,
+    const typename scan<IT,ST>::gamma_functype& _gamma_func,
+    const typename scan<IT,ST>::ns_inplace_functype& _ns_inplace,
+    const ST& init_st,
+    OIf<ST>& outS,
+    IIf<IT>& inpS,
+    bool const_rate=false
+    )
+{
+    auto p = new scan<IT,ST>(pName.c_str(), _gamma_func, _ns_inplace, init_st, const_rate);
     
     (*p).iport1(inpS);
     (*p).oport1(outS);
@@ -255,6 +280,29 @@ inline scand<IT,ST>* make_scand(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a scand process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST,
+           template <class> class IIf,
+           template <class> class OIf>
+inline scand<IT,ST>* make_scand(const std::string& pName,
+    const typename scan<IT,ST>::gamma_functype& _gamma_func,
+    const typename scand<IT,ST>::ns_inplace_functype& _ns_inplace,
+    const ST& init_st,
+    OIf<ST>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new scand<IT,ST>(pName.c_str(), _gamma_func, _ns_inplace, init_st);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a moore process
 /*! This function is used to construct a moore process (SystemC module) and
  * connect its output and output signals.
@@ -282,6 +330,30 @@ inline moore<IT,ST,OT>* make_moore(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a moore process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline moore<IT,ST,OT>* make_moore(const std::string& pName,
+    const typename moore<IT,ST,OT>::gamma_functype& _gamma_func,
+    const typename moore<IT,ST,OT>::ns_inplace_functype& _ns_inplace,
+    const typename moore<IT,ST,OT>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new moore<IT,ST,OT>(pName.c_str(), _gamma_func, _ns_inplace, _od_func, init_st);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a mealy process
 /*! This function is used to construct a mealy process (SystemC module) and
  * connect its output and output signals.
@@ -309,6 +381,171 @@ inline mealy<IT,ST,OT>* make_mealy(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a mealy process with an in-place next-state function
+/*! It is the same as the above helper, but the next-state function
+ * updates the current state directly.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(const std::string& pName,
+    const typename moore<IT,ST,OT>::gamma_functype& _gamma_func,
+    const typename mealy<IT,ST,OT>::ns_inplace_functype& _ns_inplace,
+    const typename mealy<IT,ST,OT>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(), _gamma_func, _ns_inplace, _od_func, init_st);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a scan process with a constant rate
+/*! The process reads itoks tokens in each cycle instead of evaluating a
+ * partitioning function, hence it can be scheduled statically with the
+ * SDF processes (see SDF::static_scheduler).
+ */
+template <typename IT, typename ST,
+           template <class> class IIf,
+           template <class> class OIf>
+inline scan<IT,ST>* make_scan(const std::string& pName,
+    unsigned int itoks,
+    const typename scan<IT,ST>::ns_functype& _ns_func,
+    const ST& init_st,
+    OIf<ST>& outS,
+    IIf<IT>& inpS
+    )
+{
+    return make_scan(pName, [itoks](unsigned int& toks, const ST&) {toks = itoks;},
+                     _ns_func, init_st, outS, inpS, true);
+}
+
+//! Helper function to construct a scan process with a constant rate and an in-place next-state function
+template <typename IT, typename ST,
+           template <class> class IIf,
+           template <class> class OIf>
+inline scan<IT,ST>* make_scan(const std::string& pName,
+    unsigned int itoks,
+    const typename scan<IT,ST>::ns_inplace_functype& _ns_inplace,
+    const ST& init_st,
+    OIf<ST>& outS,
+    IIf<IT>& inpS
+    )
+{
+    return make_scan(pName, [itoks](unsigned int& toks, const ST&) {toks = itoks;},
+                     _ns_inplace, init_st, outS, inpS, true);
+}
+
+//! Helper function to construct a moore process with constant rates
+/*! The process reads itoks tokens in each cycle and its output-decoding
+ * function should produce otoks tokens, hence it can be scheduled
+ * statically with the SDF processes. The output of the first cycle is
+ * produced in the init stage.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline moore<IT,ST,OT>* make_moore(const std::string& pName,
+    unsigned int itoks,
+    unsigned int otoks,
+    const typename moore<IT,ST,OT>::ns_functype& _ns_func,
+    const typename moore<IT,ST,OT>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new moore<IT,ST,OT>(pName.c_str(),
+                                 [itoks](unsigned int& toks, const ST&) {toks = itoks;},
+                                 _ns_func, _od_func, init_st, true, otoks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a moore process with constant rates and an in-place next-state function
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline moore<IT,ST,OT>* make_moore(const std::string& pName,
+    unsigned int itoks,
+    unsigned int otoks,
+    const typename moore<IT,ST,OT>::ns_inplace_functype& _ns_inplace,
+    const typename moore<IT,ST,OT>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new moore<IT,ST,OT>(pName.c_str(),
+                                 [itoks](unsigned int& toks, const ST&) {toks = itoks;},
+                                 _ns_inplace, _od_func, init_st, true, otoks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a mealy process with constant rates
+/*! The process reads itoks tokens in each cycle and its output-decoding
+ * function should produce otoks tokens, hence it can be scheduled
+ * statically with the SDF processes.
+ */
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(const std::string& pName,
+    unsigned int itoks,
+    unsigned int otoks,
+    const typename mealy<IT,ST,OT>::ns_functype& _ns_func,
+    const typename mealy<IT,ST,OT>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(),
+                                 [itoks](unsigned int& toks, const ST&) {toks = itoks;},
+                                 _ns_func, _od_func, init_st, true, otoks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
+//! Helper function to construct a mealy process with constant rates and an in-place next-state function
+template <typename IT, typename ST, typename OT,
+           template <class> class IIf,
+           template <class> class OIf>
+inline mealy<IT,ST,OT>* make_mealy(const std::string& pName,
+    unsigned int itoks,
+    unsigned int otoks,
+    const typename mealy<IT,ST,OT>::ns_inplace_functype& _ns_inplace,
+    const typename mealy<IT,ST,OT>::od_functype& _od_func,
+    const ST& init_st,
+    OIf<OT>& outS,
+    IIf<IT>& inpS
+    )
+{
+    auto p = new mealy<IT,ST,OT>(pName.c_str(),
+                                 [itoks](unsigned int& toks, const ST&) {toks = itoks;},
+                                 _ns_inplace, _od_func, init_st, true, otoks);
+    
+    (*p).iport1(inpS);
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a constant source process
 /*! This function is used to construct a constant (SystemC module) and
  * connect its output signal.
@@ -372,6 +609,25 @@ inline vsource<T>* make_vsource(const std::string& pName,
     return p;
 }
 
+//! Helper function to construct a stream source process
+/*! This function is used to construct a source (SystemC module) which
+ * reads a token_stream and connect its output signal. It is used as
+ * make_vsource, with a stream (e.g., from make_generator_stream or
+ * make_file_stream) instead of a vector.
+ */
+template <class T, template <class> class OIf>
+inline stream_source<T>* make_vsource(const std::string& pName,
+    std::shared_ptr<token_stream<T>> stream,
+    OIf<T>& outS
+    )
+{
+    auto p = new stream_source<T>(pName.c_str(), stream);
+    
+    (*p).oport1(outS);
+    
+    return p;
+}
+
 //! Helper function to construct a sink process
 /*! This function is used to construct a sink (SystemC module) and
  * connect its output and output signals.
@@ -50,6 +50,47 @@ public:
 template <typename T>
 using signal = UT2UT<T>;
 
+//! A UT signal based on the single-producer single-consumer ring buffer
+/*! It can be used instead of UT::signal for signals with exactly one
+ * writer and one reader to avoid the sc_fifo overheads.
+ */
+template <typename T>
+class spsc_signal: public ForSyDe::signal<T,T,spsc_fifo>
+{
+public:
+    spsc_signal() : ForSyDe::signal<T,T,spsc_fifo>() {}
+    spsc_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,T,spsc_fifo>(name, size) {}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "UT";
+    }
+#endif
+};
+
+#ifdef FORSYDE_SPILL_FIFO
+//! A UT signal which spills its backlog to a file
+/*! It can be used instead of UT::signal for the signals which may
+ * accumulate more tokens than fit in memory. The size is the number of
+ * tokens kept in each of its memory windows (see spill_fifo).
+ */
+template <typename T>
+class spill_signal: public ForSyDe::signal<T,T,spill_fifo>
+{
+public:
+    spill_signal() : ForSyDe::signal<T,T,spill_fifo>() {}
+    spill_signal(sc_module_name name, unsigned size) : ForSyDe::signal<T,T,spill_fifo>(name, size) {}
+#ifdef FORSYDE_INTROSPECTION
+    
+    virtual std::string moc() const
+    {
+        return "UT";
+    }
+#endif
+};
+#endif
+
 //! The UT_in port is used for input ports of UT processes
 template <typename T>
 class UT_in: public ForSyDe::in_port<T,T,signal<T>>
@@ -24,9 +24,13 @@
 
 #include <functional>
 #include <tuple>
+#include <optional>
 #include <vector>
 
 #include "ut_process.hpp"
+#include "sdf_process.hpp"
+#include "token_stream.hpp"
+#include "async_sink.hpp"
 
 namespace ForSyDe
 {
@@ -36,6 +40,14 @@ namespace UT
 
 using namespace sc_core;
 
+//! The base of the UT processes which can declare constant rates
+/*! A state machine whose partitioning function always gives the same
+ * rate registers its rates like an SDF process, hence it is scheduled
+ * statically (e.g., by SDF::static_scheduler) with the SDF processes.
+ * Otherwise it is a plain UT process.
+ */
+typedef SDF::sdf_process rated_process;
+
 //! Process constructor for a combinational process (actor) with one input and one output
 /*! This class is used to build combinational processes with one input
  * and one output. The class is parameterized for input and output
@@ -65,10 +77,8 @@ public:
              i1toks(i1toks), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
+        add_func_arg("_func", "_func");
+        add_arg("i1toks", i1toks);
 #endif
     }
     
@@ -94,8 +104,7 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
+        iport1.read_n(i1vals, i1vals.size());
     }
     
     void exec()
@@ -152,11 +161,9 @@ public:
               i1toks(i1toks), i2toks(i2toks), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
+        add_func_arg("_func", "_func");
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
 #endif
     }
     
@@ -183,10 +190,8 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
     }
     
     void exec()
@@ -248,12 +253,10 @@ public:
               i1toks(i1toks), i2toks(i2toks), i3toks(i3toks), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
-        arg_vec.push_back(std::make_tuple("i3toks",std::to_string(i3toks)));
+        add_func_arg("_func", "_func");
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
+        add_arg("i3toks", i3toks);
 #endif
     }
     
@@ -282,12 +285,9 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
-        for (auto it=i3vals.begin();it!=i3vals.end();it++)
-            *it = iport3.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
+        iport3.read_n(i3vals, i3vals.size());
     }
     
     void exec()
@@ -354,13 +354,11 @@ public:
               i4toks(i4toks), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        arg_vec.push_back(std::make_tuple("i1toks",std::to_string(i1toks)));
-        arg_vec.push_back(std::make_tuple("i2toks",std::to_string(i2toks)));
-        arg_vec.push_back(std::make_tuple("i3toks",std::to_string(i3toks)));
-        arg_vec.push_back(std::make_tuple("i4toks",std::to_string(i4toks)));
+        add_func_arg("_func", "_func");
+        add_arg("i1toks", i1toks);
+        add_arg("i2toks", i2toks);
+        add_arg("i3toks", i3toks);
+        add_arg("i4toks", i4toks);
 #endif
     }
     
@@ -391,14 +389,10 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
-        for (auto it=i3vals.begin();it!=i3vals.end();it++)
-            *it = iport3.read();
-        for (auto it=i4vals.begin();it!=i4vals.end();it++)
-            *it = iport4.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
+        iport3.read_n(i3vals, i3vals.size());
+        iport4.read_n(i4vals, i4vals.size());
     }
     
     void exec()
@@ -456,9 +450,7 @@ public:
               init_val(init_val)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
+        add_arg("init_val", init_val);
 #endif
     }
     
@@ -476,7 +468,8 @@ private:
     void init()
     {
         val = new T;
-        write_multiport(oport1, init_val);
+        // the initial token is restored with the signal
+        if (!is_restored()) write_multiport(oport1, init_val);
     }
     
     void prep()
@@ -533,10 +526,8 @@ public:
               init_val(init_val), ns(n)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("n", std::to_string(n)));
+        add_arg("init_val", init_val);
+        add_arg("n", n);
 #endif
     }
     
@@ -555,6 +546,7 @@ private:
     void init()
     {
         val = new T;
+        if (is_restored()) return;
         for (unsigned int i=0; i<ns; i++)
             write_multiport(oport1, init_val);
     }
@@ -594,7 +586,7 @@ private:
  * to compute the next state.
  */
 template <class IT, class ST>
-class scan : public ut_process
+class scan : public rated_process
 {
 public:
     UT_in<IT>  iport1;        ///< port for the input channel
@@ -605,6 +597,9 @@ public:
     
     //! Type of the next-state function to be passed to the process constructor
     typedef std::function<void(ST&, const ST&, const std::vector<IT>&)> ns_functype;
+    
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&, const std::vector<IT>&)> ns_inplace_functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -614,18 +609,36 @@ public:
     scan(const sc_module_name& _name,   ///< The module name
          const gamma_functype& _gamma_func,///< The partitioning function
          const ns_functype& _ns_func, ///< The next_state function
-         const ST& init_st  ///< Initial state
-         ) : ut_process(_name), _gamma_func(_gamma_func), _ns_func(_ns_func),
-             init_st(init_st)
+         const ST& init_st, ///< Initial state
+         bool const_rate=false  ///< Whether gamma always gives the same rate
+         ) : rated_process(_name), _gamma_func(_gamma_func), _ns_func(_ns_func),
+             init_st(init_st), const_rate(const_rate)
+    {
+        if (const_rate) add_rates();
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept.
+     */
+    scan(const sc_module_name& _name,   ///< The module name
+         const gamma_functype& _gamma_func,///< The partitioning function
+         const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+         const ST& init_st, ///< Initial state
+         bool const_rate=false  ///< Whether gamma always gives the same rate
+         ) : rated_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+             init_st(init_st), const_rate(const_rate)
     {
+        if (const_rate) add_rates();
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -636,35 +649,65 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     // Initial state
     ST init_st;
+    // Whether the number of tokens to read is evaluated only once
+    bool const_rate;
+    unsigned int itoks;
+#ifdef FORSYDE_COROUTINES
+    // Whether the firing rule already evaluated the partitioning function
+    bool itoks_known = false;
+#endif
         
     // Input, output, current state, and next state variables
     std::vector<IT> ivals;
     ST* stval;
     ST* nsval;
+    
+    //! Registers the constant rates given by the initial state
+    void add_rates()
+    {
+        _gamma_func(itoks, init_st);
+        add_in_rate(iport1, itoks);
+        add_out_rate(oport1, 1);
+    }
 
     //Implementing the abstract semantics
     void init()
     {
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
+        // A constant partitioning is looked ahead once
+        if (const_rate) _gamma_func(itoks, *stval);
     }
     
     void prep()
     {
-        unsigned int itoks;
-        _gamma_func(itoks, *stval);    // determine how many tokens to read
+        // determine how many tokens to read
+#ifdef FORSYDE_COROUTINES
+        if (!const_rate && !itoks_known) _gamma_func(itoks, *stval);
+        itoks_known = false;
+#else
+        if (!const_rate) _gamma_func(itoks, *stval);
+#endif
         ivals.resize(itoks);
-        for (auto it=ivals.begin();it!=ivals.end();it++)
-            *it = iport1.read();
+        iport1.read_n(ivals, ivals.size());
     }
     
     void exec()
     {
-        _ns_func(*nsval, *stval, ivals);
-        *stval = *nsval;
+        if (_ns_inplace)
+        {
+            _ns_inplace(*stval, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsval, *stval, ivals);
+            std::swap(stval, nsval);
+        }
     }
     
     void prod()
@@ -677,6 +720,27 @@ private:
         delete stval;
         delete nsval;
     }
+    
+#ifdef FORSYDE_COROUTINES
+    bool has_dynamic_firing_rule() const {return true;}
+    
+    void dynamic_firing_rule(std::vector<firing_port>& ins,
+                             std::vector<firing_port>& outs)
+    {
+        if (!const_rate)
+        {
+            _gamma_func(itoks, *stval);
+            itoks_known = true;
+        }
+        ins = {rule_port(iport1, itoks)};
+        outs = {rule_port(oport1, 1)};
+    }
+#endif
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -706,6 +770,9 @@ public:
     
     //! Type of the next-state function to be passed to the process constructor
     typedef std::function<void(ST&, const ST&, const std::vector<IT>&)> ns_functype;
+    
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&, const std::vector<IT>&)> ns_inplace_functype;
 
     //! The constructor requires the module name
     /*! It creates an SC_THREAD which reads data from its input port,
@@ -720,13 +787,27 @@ public:
              init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept.
+     */
+    scand(const sc_module_name& _name,   ///< The module name
+           const gamma_functype& _gamma_func,///< The partitioning function
+           const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+           const ST& init_st  ///< Initial state
+           ) : ut_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+             init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -737,10 +818,16 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     // Initial state
     ST init_st;
     
     bool first_run;
+#ifdef FORSYDE_COROUTINES
+    // The tokens to read, if the firing rule already evaluated them
+    unsigned int rule_itoks;
+    bool itoks_known = false;
+#endif
     
     // Input, output, current state, and next state variables
     std::vector<IT> ivals;
@@ -752,7 +839,7 @@ private:
     {
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
         // First evaluation cycle
         first_run = true;
     }
@@ -763,10 +850,15 @@ private:
         if (!first_run)
         {
             unsigned int itoks;
+#ifdef FORSYDE_COROUTINES
+            if (itoks_known) itoks = rule_itoks;
+            else _gamma_func(itoks, *stval);
+            itoks_known = false;
+#else
             _gamma_func(itoks, *stval);    // determine how many tokens to read
+#endif
             ivals.resize(itoks);
-            for (auto it=ivals.begin();it!=ivals.end();it++)
-                *it = iport1.read();
+            iport1.read_n(ivals, ivals.size());
         }
     }
     
@@ -775,8 +867,16 @@ private:
         // Compute only the output in the first iteration.
         if (!first_run)
         {
-            _ns_func(*nsval, *stval, ivals);
-            *stval = *nsval;
+            if (_ns_inplace)
+            {
+                _ns_inplace(*stval, ivals);
+            }
+            else
+            {
+                // the next state becomes the current one without copying it
+                _ns_func(*nsval, *stval, ivals);
+                std::swap(stval, nsval);
+            }
         }
         else
         {
@@ -794,6 +894,28 @@ private:
         delete stval;
         delete nsval;
     }
+    
+#ifdef FORSYDE_COROUTINES
+    bool has_dynamic_firing_rule() const {return true;}
+    
+    void dynamic_firing_rule(std::vector<firing_port>& ins,
+                             std::vector<firing_port>& outs)
+    {
+        rule_itoks = 0;
+        if (!first_run)
+        {
+            _gamma_func(rule_itoks, *stval);
+            itoks_known = true;
+        }
+        ins = {rule_port(iport1, rule_itoks)};
+        outs = {rule_port(oport1, 1)};
+    }
+#endif
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval, first_run);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval, first_run);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -811,7 +933,7 @@ private:
  * function it creates a Moore process.
  */
 template <class IT, class ST, class OT>
-class moore : public ut_process
+class moore : public rated_process
 {
 public:
     UT_in<IT>  iport1;        ///< port for the input channel
@@ -823,6 +945,9 @@ public:
     //! Type of the next-state function to be passed to the process constructor
     typedef std::function<void(ST&, const ST&, const std::vector<IT>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&, const std::vector<IT>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::vector<OT>&, const ST&)> od_functype;
 
@@ -835,19 +960,44 @@ public:
            const gamma_functype& _gamma_func,///< The partitioning function
            const ns_functype& _ns_func, ///< The next_state function
            const od_functype& _od_func, ///< The output-decoding function
-           const ST& init_st  ///< Initial state
-          ) : ut_process(_name), _gamma_func(_gamma_func), _ns_func(_ns_func),
-              _od_func(_od_func), init_st(init_st)
-    {
+           const ST& init_st, ///< Initial state
+           bool const_rate=false,  ///< Whether gamma always gives the same rate
+           unsigned int otoks=1    ///< The constant production rate
+          ) : rated_process(_name), _gamma_func(_gamma_func), _ns_func(_ns_func),
+              _od_func(_od_func), init_st(init_st), const_rate(const_rate),
+              otoks(otoks)
+    {
+        if (const_rate) add_rates();
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding
+     * function is applied before the update.
+     */
+    moore(const sc_module_name& _name,   ///< The module name
+           const gamma_functype& _gamma_func,///< The partitioning function
+           const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+           const od_functype& _od_func, ///< The output-decoding function
+           const ST& init_st, ///< Initial state
+           bool const_rate=false,  ///< Whether gamma always gives the same rate
+           unsigned int otoks=1    ///< The constant production rate
+          ) : rated_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st), const_rate(const_rate),
+              otoks(otoks)
+    {
+        if (const_rate) add_rates();
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -858,9 +1008,13 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     // Initial state
     ST init_st;
+    // Whether the rates are constant, and the constant rates
+    bool const_rate;
+    unsigned int itoks, otoks;
     
     bool first_run;
     
@@ -870,14 +1024,32 @@ private:
     ST* nsval;
     std::vector<OT> ovals;
 
+    //! Registers the constant rates
+    /*! The output of the first cycle, which reads nothing, is produced in
+     * the init stage instead, as the initial tokens of the output.
+     */
+    void add_rates()
+    {
+        _gamma_func(itoks, init_st);
+        add_in_rate(iport1, itoks);
+        add_out_rate(oport1, otoks, otoks);
+    }
+    
     //Implementing the abstract semantics
     void init()
     {
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
         // First evaluation cycle
         first_run = true;
+        // the initial tokens are restored with the signal
+        if (const_rate && !is_restored())
+        {
+            _gamma_func(itoks, *stval);
+            exec();
+            prod();
+        }
     }
     
     void prep()
@@ -885,11 +1057,10 @@ private:
         // We do not read anything in the first cycle since we can produce the output.
         if (!first_run)
         {
-            unsigned int itoks;
-            _gamma_func(itoks, *stval);    // determine how many tokens to read
+            if (!const_rate)
+                _gamma_func(itoks, *stval);    // determine how many tokens to read
             ivals.resize(itoks);
-            for (auto it=ivals.begin();it!=ivals.end();it++)
-                *it = iport1.read();
+            iport1.read_n(ivals, ivals.size());
         }
     }
     
@@ -898,9 +1069,18 @@ private:
         // Compute only the output in the first iteration.
         if (!first_run)
         {
-            _ns_func(*nsval, *stval, ivals);
-            _od_func(ovals, *stval);
-            *stval = *nsval;
+            if (_ns_inplace)
+            {
+                _od_func(ovals, *stval);
+                _ns_inplace(*stval, ivals);
+            }
+            else
+            {
+                // the next state becomes the current one without copying it
+                _ns_func(*nsval, *stval, ivals);
+                _od_func(ovals, *stval);
+                std::swap(stval, nsval);
+            }
         }
         else
         {
@@ -911,6 +1091,8 @@ private:
     
     void prod()
     {
+        if (const_rate && ovals.size() != otoks)
+            SC_REPORT_ERROR(name(), "the output-decoding function should produce the declared number of tokens");
         write_vec_multiport(oport1, ovals);
         ovals.clear();
     }
@@ -920,6 +1102,11 @@ private:
         delete stval;
         delete nsval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval, first_run);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval, first_run);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -954,6 +1141,10 @@ public:
                                 const std::tuple<TSs...>&,
                                 const std::tuple<std::vector<TIs>...>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(std::tuple<TSs...>&,
+                                const std::tuple<std::vector<TIs>...>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::tuple<std::vector<TOs>...>&,
                                 const std::tuple<TSs...>&)> od_functype;
@@ -972,14 +1163,31 @@ public:
               _od_func(_od_func), init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding
+     * function is applied before the update.
+     */
+    mooreMN(const sc_module_name& _name,        ///< The module name
+            const gamma_functype& _gamma_func,  ///< The partitioning function
+            const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+            const od_functype& _od_func,        ///< The output-decoding function
+            const std::tuple<TSs...>& init_st   ///< Initial state
+            ) : ut_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -990,6 +1198,7 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     // Initial value
     std::tuple<TSs...> init_st;
@@ -1000,19 +1209,21 @@ private:
     bool first_run;
     
     // Input, output, current state, and next state variables
-    std::tuple<std::vector<TOs>...>* ovals;
+    std::tuple<std::vector<TOs>...> ovals;
     std::tuple<TSs...>* stvals;
     std::tuple<TSs...>* nsvals;
-    std::tuple<std::vector<TIs>...>* ivals;
+    std::tuple<std::vector<TIs>...> ivals;
+    // The storage of the states (the next state is only kept for a
+    // next-state function which is not in-place)
+    std::tuple<TSs...> stbuf;
+    std::optional<std::tuple<TSs...>> nsbuf;
 
     //Implementing the abstract semantics
     void init()
     {
-        ovals = new std::tuple<std::vector<TOs>...>;
-        stvals = new std::tuple<TSs...>;
+        stvals = &stbuf;
         *stvals = init_st;
-        nsvals = new std::tuple<TSs...>;
-        ivals = new std::tuple<std::vector<TIs>...>;
+        nsvals = _ns_inplace ? NULL : &nsbuf.emplace();
         // First evaluation cycle
         first_run = true;
     }
@@ -1027,17 +1238,16 @@ private:
                 std::apply([&](auto&... itok) {
                     (ival.resize(itok), ...);
                 }, itoks);
-            }, *ivals);
+            }, ivals);
             // Read the input tokens
             std::apply([&](auto&... inport) {
                 std::apply([&](auto&... ival) {
                     (
                         [&ival,&inport](){
-                            for (auto it=ival.begin();it!=ival.end();it++)
-                                *it = inport.read();
+                            inport.read_n(ival, ival.size());
                         }()
                     , ...);
-                }, *ivals);
+                }, ivals);
             }, iport);
         }
     }
@@ -1046,14 +1256,23 @@ private:
     {
         if (!first_run)
         {
-            _ns_func(*nsvals, *stvals, *ivals);
-            _od_func(*ovals, *stvals);
-            *stvals = *nsvals;
+            if (_ns_inplace)
+            {
+                _od_func(ovals, *stvals);
+                _ns_inplace(*stvals, ivals);
+            }
+            else
+            {
+                // the next state becomes the current one without copying it
+                _ns_func(*nsvals, *stvals, ivals);
+                _od_func(ovals, *stvals);
+                std::swap(stvals, nsvals);
+            }
         }
         else
         {
             first_run = false;
-            _od_func(*ovals, *stvals);
+            _od_func(ovals, *stvals);
         }
     }
     
@@ -1063,17 +1282,16 @@ private:
             std::apply([&](auto&&... val){
                 (write_vec_multiport(port, val), ...);
                 (val.clear(), ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
     }
     
-    void clean()
-    {
-        delete ivals;
-        delete ovals;
-        delete stvals;
-        delete nsvals;
-    }
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stvals, first_run);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stvals, first_run);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1105,7 +1323,7 @@ private:
  * function it creates a Mealy process.
  */
 template <class IT, class ST, class OT>
-class mealy : public ut_process
+class mealy : public rated_process
 {
 public:
     UT_in<IT>  iport1;        ///< port for the input channel
@@ -1117,6 +1335,9 @@ public:
     //! Type of the next-state function to be passed to the process constructor
     typedef std::function<void(ST&, const ST&, const std::vector<IT>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(ST&, const std::vector<IT>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::vector<OT>&, const ST&,
                                  const std::vector<IT>&)> od_functype;
@@ -1130,19 +1351,44 @@ public:
            const gamma_functype& _gamma_func,///< The partitioning function
            const ns_functype& _ns_func, ///< The next_state function
            const od_functype& _od_func, ///< The output-decoding function
-           const ST& init_st  ///< Initial state
-          ) : ut_process(_name), _gamma_func(_gamma_func), _ns_func(_ns_func),
-              _od_func(_od_func), init_st(init_st)
-    {
+           const ST& init_st, ///< Initial state
+           bool const_rate=false,  ///< Whether gamma always gives the same rate
+           unsigned int otoks=1    ///< The constant production rate
+          ) : rated_process(_name), _gamma_func(_gamma_func), _ns_func(_ns_func),
+              _od_func(_od_func), init_st(init_st), const_rate(const_rate),
+              otoks(otoks)
+    {
+        if (const_rate) add_rates();
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding
+     * function is applied before the update.
+     */
+    mealy(const sc_module_name& _name,   ///< The module name
+           const gamma_functype& _gamma_func,///< The partitioning function
+           const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+           const od_functype& _od_func, ///< The output-decoding function
+           const ST& init_st, ///< Initial state
+           bool const_rate=false,  ///< Whether gamma always gives the same rate
+           unsigned int otoks=1    ///< The constant production rate
+          ) : rated_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st), const_rate(const_rate),
+              otoks(otoks)
+    {
+        if (const_rate) add_rates();
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -1153,9 +1399,13 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     // Initial value
     ST init_st;
+    // Whether the rates are constant, and the constant rates
+    bool const_rate;
+    unsigned int itoks, otoks;
     
     // Input, output, current state, and next state variables
     std::vector<IT> ivals;
@@ -1163,32 +1413,52 @@ private:
     ST* nsval;
     std::vector<OT> ovals;
 
+    //! Registers the constant rates given by the initial state
+    void add_rates()
+    {
+        _gamma_func(itoks, init_st);
+        add_in_rate(iport1, itoks);
+        add_out_rate(oport1, otoks);
+    }
+    
     //Implementing the abstract semantics
     void init()
     {
         stval = new ST;
         *stval = init_st;
-        nsval = new ST;
+        nsval = _ns_inplace ? NULL : new ST;
+        // A constant partitioning is looked ahead once
+        if (const_rate) _gamma_func(itoks, *stval);
     }
     
     void prep()
     {
-        unsigned int itoks;
-        _gamma_func(itoks, *stval);    // determine how many tokens to read
+        if (!const_rate)
+            _gamma_func(itoks, *stval);    // determine how many tokens to read
         ivals.resize(itoks);
-        for (auto it=ivals.begin();it!=ivals.end();it++)
-            *it = iport1.read();
+        iport1.read_n(ivals, ivals.size());
     }
     
     void exec()
     {
-        _ns_func(*nsval, *stval, ivals);
-        _od_func(ovals, *stval, ivals);
-        *stval = *nsval;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stval, ivals);
+            _ns_inplace(*stval, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsval, *stval, ivals);
+            _od_func(ovals, *stval, ivals);
+            std::swap(stval, nsval);
+        }
     }
     
     void prod()
     {
+        if (const_rate && ovals.size() != otoks)
+            SC_REPORT_ERROR(name(), "the output-decoding function should produce the declared number of tokens");
         write_vec_multiport(oport1, ovals);
         ovals.clear();
     }
@@ -1198,6 +1468,11 @@ private:
         delete stval;
         delete nsval;
     }
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stval);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stval);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1232,6 +1507,10 @@ public:
                                 const std::tuple<TSs...>&,
                                 const std::tuple<std::vector<TIs>...>&)> ns_functype;
     
+    //! Type of the in-place next-state function, which updates the current state
+    typedef std::function<void(std::tuple<TSs...>&,
+                                const std::tuple<std::vector<TIs>...>&)> ns_inplace_functype;
+    
     //! Type of the output-decoding function to be passed to the process constructor
     typedef std::function<void(std::tuple<std::vector<TOs>...>&,
                                 const std::tuple<TSs...>&,
@@ -1251,14 +1530,31 @@ public:
               _od_func(_od_func), init_st(init_st)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_gamma_func",func_name+std::string("_gamma_func")));
-        arg_vec.push_back(std::make_tuple("_ns_func",func_name+std::string("_ns_func")));
-        arg_vec.push_back(std::make_tuple("_od_func",func_name+std::string("_od_func")));
-        std::stringstream ss;
-        ss << init_st;
-        arg_vec.push_back(std::make_tuple("init_st",ss.str()));
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
+#endif
+    }
+    
+    //! The constructor with an in-place next-state function
+    /*! The next-state function updates the current state directly, hence
+     * no second copy of the state is kept. The output-decoding
+     * function is applied before the update.
+     */
+    mealyMN(const sc_module_name& _name,        ///< The module name
+            const gamma_functype& _gamma_func,  ///< The partitioning function
+            const ns_inplace_functype& _ns_inplace,///< The in-place next_state function
+            const od_functype& _od_func,        ///< The output-decoding function
+            const std::tuple<TSs...>& init_st   ///< Initial state
+            ) : ut_process(_name), _gamma_func(_gamma_func), _ns_inplace(_ns_inplace),
+              _od_func(_od_func), init_st(init_st)
+    {
+#ifdef FORSYDE_INTROSPECTION
+        add_func_arg("_gamma_func", "_gamma_func");
+        add_func_arg("_ns_func", "_ns_func");
+        add_func_arg("_od_func", "_od_func");
+        add_arg("init_st", init_st);
 #endif
     }
     
@@ -1269,6 +1565,7 @@ private:
     //! The functions passed to the process constructor
     gamma_functype _gamma_func;
     ns_functype _ns_func;
+    ns_inplace_functype _ns_inplace;
     od_functype _od_func;
     // Initial value
     std::tuple<TSs...> init_st;
@@ -1277,19 +1574,21 @@ private:
     std::array<size_t, sizeof...(TIs)> itoks;
     
     // Input, output, current state, and next state variables
-    std::tuple<std::vector<TOs>...>* ovals;
+    std::tuple<std::vector<TOs>...> ovals;
     std::tuple<TSs...>* stvals;
     std::tuple<TSs...>* nsvals;
-    std::tuple<std::vector<TIs>...>* ivals;
+    std::tuple<std::vector<TIs>...> ivals;
+    // The storage of the states (the next state is only kept for a
+    // next-state function which is not in-place)
+    std::tuple<TSs...> stbuf;
+    std::optional<std::tuple<TSs...>> nsbuf;
 
     //Implementing the abstract semantics
     void init()
     {
-        ovals = new std::tuple<std::vector<TOs>...>;
-        stvals = new std::tuple<TSs...>;
+        stvals = &stbuf;
         *stvals = init_st;
-        nsvals = new std::tuple<TSs...>;
-        ivals = new std::tuple<std::vector<TIs>...>;
+        nsvals = _ns_inplace ? NULL : &nsbuf.emplace();
     }
     
     void prep()
@@ -1300,25 +1599,33 @@ private:
             std::apply([&](auto&... itok) {
                 (ival.resize(itok), ...);
             }, itoks);
-        }, *ivals);
+        }, ivals);
         // Read the input tokens
         std::apply([&](auto&... inport) {
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport](){
-                        for (auto it=ival.begin();it!=ival.end();it++)
-                            *it = inport.read();
+                        inport.read_n(ival, ival.size());
                     }()
                 , ...);
-            }, *ivals);
+            }, ivals);
         }, iport);
     }
     
     void exec()
     {
-        _ns_func(*nsvals, *stvals, *ivals);
-        _od_func(*ovals, *stvals, *ivals);
-        *stvals = *nsvals;
+        if (_ns_inplace)
+        {
+            _od_func(ovals, *stvals, ivals);
+            _ns_inplace(*stvals, ivals);
+        }
+        else
+        {
+            // the next state becomes the current one without copying it
+            _ns_func(*nsvals, *stvals, ivals);
+            _od_func(ovals, *stvals, ivals);
+            std::swap(stvals, nsvals);
+        }
     }
     
     void prod()
@@ -1327,17 +1634,16 @@ private:
             std::apply([&](auto&&... val){
                 (write_vec_multiport(port, val), ...);
                 (val.clear(), ...);
-            }, *ovals);
+            }, ovals);
         }, oport);
     }
     
-    void clean()
-    {
-        delete ivals;
-        delete ovals;
-        delete stvals;
-        delete nsvals;
-    }
+    void clean() {}
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *stvals);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *stvals);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1387,10 +1693,8 @@ public:
                  
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("take", std::to_string(take)));
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
@@ -1424,6 +1728,11 @@ private:
     
     void clean() {}
 
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1460,13 +1769,9 @@ public:
               init_st(init_val), take(take), _func(_func)
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
-        std::stringstream ss;
-        ss << init_val;
-        arg_vec.push_back(std::make_tuple("init_val", ss.str()));
-        arg_vec.push_back(std::make_tuple("take", std::to_string(take)));
+        add_func_arg("_func", "_func");
+        add_arg("init_val", init_val);
+        add_arg("take", take);
 #endif
     }
     
@@ -1489,7 +1794,7 @@ private:
     {
         cur_st = new T;
         *cur_st = init_st;
-        write_multiport(oport1, *cur_st);
+        if (!is_restored()) write_multiport(oport1, *cur_st);
         if (take==0) infinite = true;
         tok_cnt = 1;
     }
@@ -1513,6 +1818,11 @@ private:
         delete cur_st;
     }
     
+#ifdef FORSYDE_CHECKPOINT
+    void save_state(std::vector<char>& buf) {save_values(buf, *cur_st, tok_cnt);}
+    
+    void restore_state(const char*& pos) {restore_values(pos, *cur_st, tok_cnt);}
+#endif
 #ifdef FORSYDE_INTROSPECTION
     void bindInfo()
     {
@@ -1560,6 +1870,46 @@ private:
     }
 };
 
+//! Process constructor for a source process with streamed input
+/*! This class is used to build a souce process which only has an output.
+ * It outputs the values of a token_stream, like vsource does for the
+ * values of a vector. The values are pulled from the stream in chunks,
+ * hence the stimulus is never kept in the memory as a whole.
+ */
+template <class OTYP>
+class stream_source : public sc_module
+{
+public:
+    sc_fifo_out<OTYP> oport1;     ///< port for the output channel
+
+    //! The constructor requires the module name
+    /*! It creates an SC_THREAD which writes the result using the output
+     * port.
+     */
+    stream_source(const sc_module_name& _name,                 ///< The module name
+                  std::shared_ptr<token_stream<OTYP>> stream   ///< the stimulus stream
+                 )
+         :sc_module(_name), reader(stream)
+    {
+        SC_THREAD(worker);
+    }
+private:
+    stream_reader<OTYP> reader;
+    SC_HAS_PROCESS(stream_source);
+
+    //! The main and only execution thread of the module
+    void worker()
+    {
+        if (!reader.good())
+            SC_REPORT_ERROR(name(),"cannot read the stream.");
+        while (auto val = reader.next())
+        {
+            OTYP out_val = *val;
+            write_multiport(oport1,out_val);    // write to the output
+        }
+    }
+};
+
 //! Process constructor for a sink process
 /*! This class is used to build a sink process which only has an input.
  * Its main purpose is to be used in test-benches. The process repeatedly
@@ -1584,12 +1934,20 @@ public:
             
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::string func_name = std::string(basename());
-        func_name = func_name.substr(0, func_name.find_last_not_of("0123456789")+1);
-        arg_vec.push_back(std::make_tuple("_func",func_name+std::string("_func")));
+        add_func_arg("_func", "_func");
 #endif
     }
     
+    //! Runs the function in a background thread instead of the simulation thread
+    /*! The tokens are passed to the thread through a bounded queue with
+     * the given capacity and policy (see async_consumer). It should be
+     * called before the simulation starts.
+     */
+    void set_async(size_t capacity=1024, async_backpressure policy=ASYNC_BLOCK)
+    {
+        async.reset(new async_consumer<T>(this->name(), _func, capacity, policy));
+    }
+
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "UT::sink";}
     
@@ -1598,6 +1956,9 @@ private:
 
     //! The function passed to the process constructor
     functype _func;
+
+    // the background consumer of the tokens, if any
+    std::unique_ptr<async_consumer<T>> async;
     
     //Implementing the abstract semantics
     void init()
@@ -1612,13 +1973,17 @@ private:
     
     void exec()
     {
-        _func(*val);
+        if (async)
+            async->push(*val);
+        else
+            _func(*val);
     }
     
     void prod() {}
     
     void clean()
     {
+        if (async) async->flush();
         delete val;
     }
     
@@ -1670,10 +2035,8 @@ private:
     
     void prep()
     {
-        for (auto it=i1vals.begin();it!=i1vals.end();it++)
-            *it = iport1.read();
-        for (auto it=i2vals.begin();it!=i2vals.end();it++)
-            *it = iport2.read();
+        iport1.read_n(i1vals, i1vals.size());
+        iport2.read_n(i2vals, i2vals.size());
     }
     
     void exec() {}
@@ -1716,9 +2079,7 @@ public:
             ) : ut_process(_name), in_toks(in_toks), oport1("iport1")
     {
 #ifdef FORSYDE_INTROSPECTION
-        std::stringstream ss;
-        ss << in_toks;
-        arg_vec.push_back(std::make_tuple("itoks",ss.str()));
+        add_arg("itoks", in_toks);
 #endif
     }
     
@@ -1745,8 +2106,7 @@ private:
             std::apply([&](auto&... ival) {
                 (
                     [&ival,&inport](){
-                        for (auto it=ival.begin();it!=ival.end();it++)
-                            *it = inport.read();
+                        inport.read_n(ival, ival.size());
                     }()
                 , ...);
             }, *in_val);
@@ -1940,6 +2300,11 @@ public:
     //! Specifying from which process constructor is the module built
     std::string forsyde_kind() const {return "UT::fanout";}
     
+#ifdef FORSYDE_FANOUT_BYPASS
+    //! Passes the input tokens on to the outputs without running the process
+    void start_of_simulation() {bypass_fanout(iport1, oport1);}
+#endif
+    
 private:
     // Inputs and output variables
     T* val;
@@ -0,0 +1,256 @@
+/**********************************************************************
+    * work_stealing_pool.hpp -- A work-stealing thread pool           *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Providing a thread pool for executors which evaluate   *
+    *          independent processes on several cores                 *
+    *                                                                 *
+    * Usage:   Included by the multi-threaded executors               *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef WORK_STEALING_POOL_HPP
+#define WORK_STEALING_POOL_HPP
+
+/*! \file work_stealing_pool.hpp
+ * \brief Implements a work-stealing thread pool
+ *
+ *  This file includes a simple thread pool used by the multi-threaded
+ * executors. Tasks are identified by integer indices and the pool runs
+ * batches of tasks which can spawn other tasks of the same batch.
+ */
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+#ifdef FORSYDE_NUMA
+#include "numa.hpp"
+#endif
+
+namespace ForSyDe
+{
+
+//! A work-stealing thread pool
+/*! Each worker thread owns a task queue. A worker takes the most
+ * recently pushed task from its own queue and, when it runs empty,
+ * steals the oldest task from the queues of the other workers.
+ *
+ * The tasks are run in batches using run(), which returns when the
+ * given number of tasks have finished. A running task can add other
+ * tasks of the same batch using push(). The workers sleep between the
+ * batches.
+ *
+ * With FORSYDE_NUMA, the workers can be bound to NUMA nodes and the
+ * tasks given a home node. A task is then queued to a worker of its node
+ * and the workers steal from the other workers of their node before the
+ * ones of the other nodes.
+ */
+class work_stealing_pool
+{
+public:
+    //! The type of the task body, called with the task and the worker index
+    typedef std::function<void(size_t, unsigned)> task_body;
+
+    //! The constructor requires the number of worker threads
+    /*! The number of hardware threads is used if it is zero.
+     */
+    explicit work_stealing_pool(unsigned nthreads=0) : epoch(0), stop(false), remaining(0)
+    {
+        spawn(nthreads);
+    }
+
+#ifdef FORSYDE_NUMA
+    //! The constructor requires the NUMA node of each worker thread
+    explicit work_stealing_pool(const std::vector<int>& worker_nodes)
+        : epoch(0), stop(false), remaining(0), wnodes(worker_nodes)
+    {
+        spawn(wnodes.size());
+    }
+
+    //! Sets the home node of each task, or -1 for the tasks without one
+    /*! It should be called between the batches.
+     */
+    void set_task_nodes(const std::vector<int>& nodes) {tnodes = nodes;}
+#endif
+
+    //! The destructor stops and joins the worker threads
+    ~work_stealing_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lk(m);
+            stop = true;
+        }
+        start_cv.notify_all();
+        for (auto& t : threads) t.join();
+    }
+
+    //! The number of worker threads
+    unsigned size() const {return threads.size();}
+
+    //! Runs a batch of tasks and waits for all of them to finish
+    /*! The ready tasks are distributed among the workers and the batch
+     * ends when total tasks (including the ones added using push) have
+     * been executed.
+     */
+    void run(const std::vector<size_t>& ready,  ///< the initially ready tasks
+             size_t total,                      ///< the number of tasks in the batch
+             const task_body& _body             ///< the function executing a task
+             )
+    {
+        if (total == 0) return;
+        body = _body;
+        remaining.store(total, std::memory_order_relaxed);
+        for (size_t i=0; i<ready.size(); i++)
+            push(i % queues.size(), ready[i]);
+        {
+            std::lock_guard<std::mutex> lk(m);
+            epoch++;
+        }
+        start_cv.notify_all();
+        std::unique_lock<std::mutex> lk(m);
+        done_cv.wait(lk, [this]{return remaining.load(std::memory_order_acquire)==0;});
+    }
+
+    //! Adds a task to the queue of a worker
+    /*! It is called by a running task to add the tasks it enables to the
+     * queue of its own worker.
+     */
+    void push(unsigned w, size_t task)
+    {
+#ifdef FORSYDE_NUMA
+        w = home(w, task);
+#endif
+        std::lock_guard<std::mutex> lk(queues[w]->m);
+        queues[w]->tasks.push_back(task);
+    }
+
+private:
+    //! The task queue of a worker
+    struct task_queue
+    {
+        std::mutex m;
+        std::deque<size_t> tasks;
+    };
+
+    std::vector<std::unique_ptr<task_queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex m;
+    std::condition_variable start_cv, done_cv;
+    size_t epoch;
+    bool stop;
+
+    std::atomic<size_t> remaining;
+    task_body body;
+#ifdef FORSYDE_NUMA
+    // the nodes of the workers and the home nodes of the tasks
+    std::vector<int> wnodes, tnodes;
+
+    //! The worker a task is queued to, instead of the given one
+    unsigned home(unsigned w, size_t task) const
+    {
+        if (wnodes.empty() || task >= tnodes.size() || tnodes[task] < 0 ||
+            tnodes[task] == wnodes[w])
+            return w;
+        // the workers of the node take its tasks in turn
+        std::vector<unsigned> local;
+        for (unsigned i=0; i<wnodes.size(); i++)
+            if (wnodes[i] == tnodes[task]) local.push_back(i);
+        return local.empty() ? w : local[task % local.size()];
+    }
+
+    //! Checks if two workers are on the same node
+    bool same_node(unsigned a, unsigned b) const
+    {
+        return wnodes.empty() || wnodes[a] == wnodes[b];
+    }
+#endif
+
+    //! Creates the queues and starts the worker threads
+    void spawn(unsigned nthreads)
+    {
+        if (nthreads == 0) nthreads = std::thread::hardware_concurrency();
+        if (nthreads == 0) nthreads = 1;
+        for (unsigned i=0; i<nthreads; i++)
+            queues.emplace_back(new task_queue);
+        for (unsigned i=0; i<nthreads; i++)
+            threads.emplace_back(&work_stealing_pool::worker, this, i);
+    }
+
+    //! Takes a task from the own queue or steals one from the others
+    bool pop(unsigned w, size_t& task)
+    {
+        {
+            std::lock_guard<std::mutex> lk(queues[w]->m);
+            if (!queues[w]->tasks.empty())
+            {
+                task = queues[w]->tasks.back();
+                queues[w]->tasks.pop_back();
+                return true;
+            }
+        }
+#ifdef FORSYDE_NUMA
+        // the workers of the same node are robbed first
+        for (int local=1; local>=0; local--)
+#endif
+        for (size_t k=1; k<queues.size(); k++)
+        {
+#ifdef FORSYDE_NUMA
+            if (same_node(w, (w+k) % queues.size()) != bool(local)) continue;
+#endif
+            task_queue& q = *queues[(w+k) % queues.size()];
+            std::lock_guard<std::mutex> lk(q.m);
+            if (!q.tasks.empty())
+            {
+                task = q.tasks.front();
+                q.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //! The main loop of a worker thread
+    void worker(unsigned w)
+    {
+#ifdef FORSYDE_NUMA
+        if (!wnodes.empty()) numa_bind_thread(wnodes[w]);
+#endif
+        size_t seen = 0;
+        while (true)
+        {
+            {
+                std::unique_lock<std::mutex> lk(m);
+                start_cv.wait(lk, [&]{return stop || epoch!=seen;});
+                if (stop) return;
+                seen = epoch;
+            }
+            while (remaining.load(std::memory_order_acquire) > 0)
+            {
+                size_t task;
+                if (!pop(w, task))
+                {
+                    std::this_thread::yield();
+                    continue;
+                }
+                body(task, w);
+                if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    std::lock_guard<std::mutex> lk(m);
+                    done_cv.notify_all();
+                }
+            }
+        }
+    }
+};
+
+}
+
+#endif
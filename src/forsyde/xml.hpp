@@ -23,6 +23,8 @@
  */
 
 #include <algorithm>
+#include <fstream>
+#include <unordered_set>
 #include "rapidxml_print.hpp"
 
 #include "abssemantics.hpp"
@@ -375,6 +377,237 @@ private:
     
 };
 
+//! Exports a system as XML files in a single streaming pass
+/*! It produces the same files as XMLExport, but the elements are written
+ * to the files while the hierarchy is traversed, without building a DOM.
+ * Each composite process is exported once per component (i.e., its name
+ * without the trailing digits, which also names its file), hence the
+ * instances of a component after the first one are not traversed again.
+ * The hierarchy is traversed using a work list, so that deep hierarchies
+ * do not exhaust the stack, and the MoCs of the ports and signals are
+ * resolved by their interned IDs.
+ */
+class XMLStreamExport
+{
+public:
+    //! The constructor takes the generation path
+    XMLStreamExport(std::string path) : path(path) {}
+    
+    //! Exports the components of the hierarchy below the top module
+    void traverse(sc_module* top)
+    {
+        std::vector<sc_module*> pending(1, top);
+        exported.insert(component_name(top));
+        while (!pending.empty())
+        {
+            sc_module* m = pending.back();
+            pending.pop_back();
+            export_component(m, pending);
+        }
+    }
+
+private:
+    //! The Path for generating the output
+    std::string path;
+    
+    //! The components which are already exported or pending
+    std::unordered_set<std::string> exported;
+    
+    //! The XML names of the MoCs, indexed by their interned IDs
+    std::vector<const char*> moc_attrs;
+    
+    //! The component name of a module, following the "nameX" convention
+    static std::string component_name(const sc_object* m)
+    {
+        std::string name_str(m->basename());
+        return name_str.substr(0, name_str.find_last_not_of("0123456789")+1);
+    }
+    
+    //! The XML name of a MoC, or NULL if it is unknown
+    static const char* moc_attr(const std::string& moc)
+    {
+        static const char* mocs[][2] = {{"SDF","sdf"}, {"SADF","sadf"}, {"UT","ut"},
+            {"SY","sy"}, {"DDE","dde"}, {"DT","dt"}, {"CT","ct"}, {"MI","mi"}};
+        for (auto& m : mocs)
+            if (moc == m[0]) return m[1];
+        return NULL;
+    }
+    
+    //! The XML name of the MoC with an interned ID, or NULL if it is unknown
+    const char* moc_attr(unsigned id)
+    {
+        while (moc_attrs.size() <= id)
+            moc_attrs.push_back(moc_attr(std::string(moc_names().name(moc_attrs.size()))));
+        return moc_attrs[id];
+    }
+    
+    //! Writes a string escaped as an XML attribute value
+    static void escape(std::ostream& out, const char* str)
+    {
+        for (; *str; str++)
+            switch (*str)
+            {
+                case '<': out << "&lt;"; break;
+                case '>': out << "&gt;"; break;
+                case '&': out << "&amp;"; break;
+                case '"': out << "&quot;"; break;
+                default: out << *str;
+            }
+    }
+    
+    //! Writes an attribute of an element
+    static void attr(std::ostream& out, const char* name, const char* val)
+    {
+        out << ' ' << name << "=\"";
+        escape(out, val);
+        out << '"';
+    }
+    
+    //! Writes the XML file of a component and queues its new sub-components
+    void export_component(sc_module* top, std::vector<sc_module*>& pending)
+    {
+        const std::string comp = component_name(top);
+        const std::string file_name = path + comp + ".xml";
+        std::ofstream out(file_name);
+        if (!out.is_open())
+            SC_REPORT_ERROR(file_name.c_str(), "file could not be opened to write the introspection output. Does the path exists?");
+        out << "<?xml version=\"1.0\" ?>\n"
+            << "<!-- Automatically generated by ForSyDe -->\n"
+            << "<!DOCTYPE process_network SYSTEM \"forsyde.dtd\" >\n"
+            << "<process_network";
+        attr(out, "name", comp.c_str());
+        out << ">\n";
+        
+        std::vector<sc_object*> children = top->get_child_objects();
+        for (auto c : children)
+        {
+            if (c->kind() == std::string("sc_module"))
+            {
+                ForSyDe::process* p = dynamic_cast<ForSyDe::process*>(c);
+                if (p != NULL)
+                    write_leaf_process(out, p);
+                else
+                {
+                    sc_module* m = static_cast<sc_module*>(c);
+                    write_composite_process(out, m);
+                    if (exported.insert(component_name(m)).second)
+                        pending.push_back(m);
+                }
+            }
+            else if (introspective_port* port = dynamic_cast<introspective_port*>(c))
+            {
+                const char* dir = c->kind()==std::string("sc_fifo_in") ? "in" : "out";
+                write_port(out, 1, port, dir, port->bound_port->get_parent_object()->basename(),
+                           port->bound_port->basename());
+            }
+            else if (c->kind() == std::string("sc_fifo"))
+                write_signal(out, dynamic_cast<introspective_channel*>(c));
+        }
+        out << "</process_network>\n";
+    }
+    
+    //! Writes a leaf process
+    void write_leaf_process(std::ostream& out, const ForSyDe::process* p)
+    {
+        std::string moc, pc;
+        get_moc_and_pc(p->forsyde_kind(), moc, pc);
+        const char* moc_name = moc_attr(moc);
+        if (moc_name == NULL)
+        {
+            SC_REPORT_ERROR("XML Backend", "MoC could not be deduced from kind.");
+            return;
+        }
+        out << "\t<leaf_process";
+        attr(out, "name", p->basename());
+        out << ">\n";
+        for (auto& ch : p->boundInChans)
+            write_port(out, 2, dynamic_cast<introspective_port*>(ch.port), "in");
+        for (auto& ch : p->boundOutChans)
+            write_port(out, 2, dynamic_cast<introspective_port*>(ch.port), "out");
+        out << "\t\t<process_constructor";
+        attr(out, "name", pc.c_str());
+        attr(out, "moc", moc_name);
+        if (p->arg_vec.empty())
+            out << "/>\n";
+        else
+        {
+            out << ">\n";
+            for (auto& arg : p->arg_vec)
+            {
+                out << "\t\t\t<argument";
+                attr(out, "name", std::get<0>(arg).c_str());
+                attr(out, "value", std::get<1>(arg).c_str());
+                out << "/>\n";
+            }
+            out << "\t\t</process_constructor>\n";
+        }
+        out << "\t</leaf_process>\n";
+    }
+    
+    //! Writes a composite process with its ports
+    void write_composite_process(std::ostream& out, const sc_module* m)
+    {
+        out << "\t<composite_process";
+        attr(out, "name", m->basename());
+        attr(out, "component_name", component_name(m).c_str());
+        std::vector<sc_object*> children = m->get_child_objects();
+        bool has_ports = false;
+        for (auto c : children)
+            if (introspective_port* port = dynamic_cast<introspective_port*>(c))
+            {
+                if (!has_ports) out << ">\n";
+                has_ports = true;
+                write_port(out, 2, port, c->kind()==std::string("sc_fifo_in") ? "in" : "out");
+            }
+        out << (has_ports ? "\t</composite_process>\n" : "/>\n");
+    }
+    
+    //! Writes a port
+    void write_port(std::ostream& out, int indent, introspective_port* port, const char* dir,
+                    const char* bound_process=NULL, const char* bound_port=NULL)
+    {
+        out << std::string(indent, '\t') << "<port";
+        if (port != NULL)
+        {
+            const char* moc_name = moc_attr(port->moc_id());
+            if (moc_name == NULL)
+            {
+                SC_REPORT_ERROR("XML Backend", "MoC could not be deduced from kind.");
+                return;
+            }
+            attr(out, "name", dynamic_cast<sc_object*>(port)->basename());
+            attr(out, "moc", moc_name);
+            attr(out, "type", port->token_type());
+            attr(out, "direction", dir);
+        }
+        if (bound_process != NULL && bound_port != NULL)
+        {
+            attr(out, "bound_process", bound_process);
+            attr(out, "bound_port", bound_port);
+        }
+        out << "/>\n";
+    }
+    
+    //! Writes a ForSyDe signal
+    void write_signal(std::ostream& out, introspective_channel* sig)
+    {
+        const char* moc_name = moc_attr(sig->moc_id());
+        if (moc_name == NULL)
+        {
+            SC_REPORT_ERROR("XML Backend", "MoC could not be deduced from kind.");
+            return;
+        }
+        out << "\t<signal";
+        attr(out, "name", dynamic_cast<sc_object*>(sig)->basename());
+        attr(out, "moc", moc_name);
+        attr(out, "type", sig->token_type());
+        attr(out, "source", sig->oport->get_parent_object()->basename());
+        attr(out, "source_port", sig->oport->basename());
+        attr(out, "target", sig->iport->get_parent_object()->basename());
+        attr(out, "target_port", sig->iport->basename());
+        out << "/>\n";
+    }
+};
 
 
 }
@@ -0,0 +1,284 @@
+/**********************************************************************
+    * zip_fusion.hpp -- Fusing the zips and unzips with the           *
+    *                   combinational processes next to them          *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Removing the kernel FIFOs and the threads which only   *
+    *          adapt the arities of the combinational processes       *
+    *                                                                 *
+    * Usage:   This file is included automatically                    *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#ifndef ZIP_FUSION_HPP
+#define ZIP_FUSION_HPP
+
+/*! \file zip_fusion.hpp
+ * \brief Implements the fusion of the zips and unzips with their neighbors
+ *
+ *  The generated models often zip a few signals only to feed a
+ * combinational process with a tuple, or unzip the tuple produced by
+ * one. This file includes an opt-in elaboration pass which executes
+ * each such combinational process together with the zips feeding it and
+ * the unzips it feeds in a single thread:
+ *
+ *     zip_fusion zf("zf", &top);
+ *     ...
+ *     sc_start();
+ *     zf.print_report();
+ */
+
+#include <vector>
+#include <map>
+#include <set>
+#include <string>
+#include <algorithm>
+#include <iostream>
+
+#include "abssemantics.hpp"
+#include "sdf_process.hpp"
+
+namespace ForSyDe
+{
+
+using namespace sc_core;
+
+//! Fuses the zips and unzips with the combinational processes next to them
+/*! This module collects the ForSyDe processes below a given module in
+ * the hierarchy (or the ones explicitly added) and, at the end of the
+ * elaboration, groups each combinational process (comb, .., combMN and
+ * their strict versions) with the zips (zip, zipX, zipN) which only feed
+ * it and the unzips (unzip, unzipX, unzipN) which only it feeds, in the
+ * SY, SDF and DDE MoCs. A group is fired by a single thread, the zips
+ * first and the unzips last, and the signals inside it are switched to
+ * plain buffers of one firing, so that the tuples do not pass through
+ * the SystemC kernel.
+ *
+ * In SDF, a zip or unzip is only fused if the two ends of the signal
+ * have the same rate. The DT zips and unzips partition their inputs by
+ * a control signal, hence they have no fixed rate and are not fused.
+ *
+ * The processes and the signals are kept in the module hierarchy, hence
+ * the introspection backends still report the original structure. The
+ * tuples themselves are still built, since they are the arguments of the
+ * user functions. The fused processes should not be driven by other
+ * executors.
+ */
+class zip_fusion : public sc_module
+{
+public:
+    //! The constructor requires the module name and the root of the network
+    /*! All the ForSyDe processes below the root module in the hierarchy
+     * are considered, unless some processes are added explicitly using
+     * add().
+     */
+    zip_fusion(sc_module_name _name,       ///< The module name
+               sc_module* root=NULL        ///< The root of the network
+               ) : sc_module(_name), root(root)
+    {
+        SC_THREAD(worker);
+    }
+
+    //! Adds a process to the considered network
+    void add(ForSyDe::process* p)
+    {
+        procs.push_back(p);
+    }
+
+    //! The fused groups, each in the order of its firings
+    const std::vector<std::vector<ForSyDe::process*>>& groups() const {return fused;}
+
+    //! Prints the fused groups
+    void print_report(std::ostream& os=std::cout) const
+    {
+        size_t n = 0;
+        for (auto& g : fused) n += g.size();
+        os << "Zip fusion " << name() << ": " << procs.size() << " processes, "
+           << fused.size() << " groups of " << n << " processes" << std::endl;
+        for (auto& g : fused)
+        {
+            os << " ";
+            for (auto p : g) os << " " << p->name();
+            os << std::endl;
+        }
+    }
+
+    //! The fusion is not a ForSyDe process and should not be introspected
+    virtual const char* kind() const {return "forsyde_zip_fusion";}
+
+private:
+    SC_HAS_PROCESS(zip_fusion);
+
+    sc_module* root;
+    std::vector<ForSyDe::process*> procs;
+    std::vector<std::vector<ForSyDe::process*>> fused;
+
+    // The input and output channels of the processes and their ends
+    std::map<ForSyDe::process*,std::vector<sc_interface*>> ins, outs;
+    std::map<sc_interface*,ForSyDe::process*> writer;
+    std::map<sc_interface*,std::vector<ForSyDe::process*>> readers;
+
+    //! Collects the ForSyDe processes below a module recursively
+    void collect(sc_object* obj)
+    {
+        for (auto c : obj->get_child_objects())
+        {
+            if (auto p = dynamic_cast<ForSyDe::process*>(c))
+                procs.push_back(p);
+            else if (dynamic_cast<sc_module*>(c) != NULL)
+                collect(c);
+        }
+    }
+
+    //! Returns the channels bound to the input or output ports of a process
+    static std::vector<sc_interface*> channels(sc_object* p, const char* port_kind)
+    {
+        std::vector<sc_interface*> res;
+        for (auto c : p->get_child_objects())
+            if (c->kind() == std::string(port_kind))
+            {
+                channel_port* port = dynamic_cast<channel_port*>(c);
+                if (port == NULL) continue;
+                auto cs = port->bound_channels();
+                res.insert(res.end(), cs.begin(), cs.end());
+            }
+        return res;
+    }
+
+    //! The tokens read or written by a process on a channel in each firing
+    static size_t rate_of(ForSyDe::process* p, sc_interface* ch, bool out)
+    {
+        if (auto sp = dynamic_cast<SDF::sdf_process*>(p))
+            for (auto& r : out ? sp->out_rates : sp->in_rates)
+                for (auto c : r.channels())
+                    if (c == ch) return r.toks;
+        return 1;
+    }
+
+    //! The MoC of a process constructor, and the name of it without the MoC
+    static std::pair<std::string,std::string> split_kind(ForSyDe::process* p)
+    {
+        const std::string kind = p->forsyde_kind();
+        const size_t sep = kind.find("::");
+        if (sep == std::string::npos) return {"", kind};
+        return {kind.substr(0, sep), kind.substr(sep+2)};
+    }
+
+    //! Checks if a process is a combinational one of a fusable MoC
+    static bool is_comb(ForSyDe::process* p)
+    {
+        const auto k = split_kind(p);
+        if (k.first != "SY" && k.first != "SDF" && k.first != "DDE") return false;
+        return k.second.compare(0, 4, "comb") == 0 ||
+               (k.first == "SY" && k.second.compare(0, 5, "scomb") == 0);
+    }
+
+    //! Checks if a process is a zip (or an unzip) of a fusable MoC
+    static bool is_adapter(ForSyDe::process* p, bool zip)
+    {
+        static const std::set<std::string> zips = {"zip", "zipX", "zipN"};
+        static const std::set<std::string> unzips = {"unzip", "unzipX", "unzipN"};
+        const auto k = split_kind(p);
+        if (k.first != "SY" && k.first != "SDF" && k.first != "DDE") return false;
+        return (zip ? zips : unzips).count(k.second) > 0;
+    }
+
+    //! Checks if a channel only connects two processes of the same MoC at the same rate
+    bool fusable(ForSyDe::process* w, ForSyDe::process* r, sc_interface* ch) const
+    {
+        // the rates of the SDF processes are only known if they registered them
+        for (auto p : {w, r})
+            if (auto sp = dynamic_cast<SDF::sdf_process*>(p))
+                if (!sp->has_rates()) return false;
+        auto rs = readers.find(ch);
+        return rs != readers.end() && rs->second.size() == 1 &&
+               dynamic_cast<static_channel*>(ch) != NULL &&
+               split_kind(w).first == split_kind(r).first &&
+               rate_of(w, ch, true) == rate_of(r, ch, false);
+    }
+
+    //! Groups the combinational processes with their zips and unzips
+    void end_of_elaboration()
+    {
+        if (procs.empty() && root != NULL) collect(root);
+        for (auto p : procs)
+        {
+            ins[p] = channels(p, "sc_fifo_in");
+            outs[p] = channels(p, "sc_fifo_out");
+            for (auto ch : ins[p]) readers[ch].push_back(p);
+            for (auto ch : outs[p]) writer[ch] = p;
+        }
+        std::set<ForSyDe::process*> taken;
+        for (auto c : procs)
+        {
+            if (!is_comb(c) || c->is_ext_driven()) continue;
+            std::vector<ForSyDe::process*> zs, us;
+            std::vector<std::pair<sc_interface*,size_t>> links;
+            for (auto ch : ins[c])
+            {
+                auto w = writer.find(ch);
+                if (w == writer.end()) continue;
+                ForSyDe::process* z = w->second;
+                // a zip has a single output
+                if (is_adapter(z, true) && !z->is_ext_driven() && !taken.count(z) &&
+                    outs[z].size() == 1 && fusable(z, c, ch))
+                {
+                    zs.push_back(z);
+                    taken.insert(z);
+                    links.push_back({ch, rate_of(z, ch, true)});
+                }
+            }
+            for (auto ch : outs[c])
+            {
+                auto rs = readers.find(ch);
+                if (rs == readers.end() || rs->second.size() != 1) continue;
+                ForSyDe::process* u = rs->second[0];
+                // an unzip has a single input
+                if (is_adapter(u, false) && !u->is_ext_driven() && !taken.count(u) &&
+                    ins[u].size() == 1 && fusable(c, u, ch))
+                {
+                    us.push_back(u);
+                    taken.insert(u);
+                    links.push_back({ch, rate_of(c, ch, true)});
+                }
+            }
+            if (zs.empty() && us.empty()) continue;
+            for (auto& l : links)
+                dynamic_cast<static_channel*>(l.first)->set_static_buffer(std::max<size_t>(l.second, 1));
+            std::vector<ForSyDe::process*> g(zs);
+            g.push_back(c);
+            g.insert(g.end(), us.begin(), us.end());
+            for (auto p : g) p->set_ext_driven();
+            fused.push_back(g);
+        }
+    }
+
+    //! Fires each group by a thread of its own
+    void worker()
+    {
+        for (auto& g : fused)
+        {
+            const std::vector<ForSyDe::process*>* grp = &g;
+            sc_spawn([grp]
+            {
+                for (auto p : *grp) p->ext_init();
+                while (1)
+                    for (auto p : *grp) p->ext_fire();
+            });
+        }
+    }
+};
+
+//! Helper function to construct a zip fusion for a network
+inline zip_fusion* make_zip_fusion(const std::string& pName,  ///< the fusion name
+    sc_module* root                                 ///< the root of the network
+    )
+{
+    return new zip_fusion(pName.c_str(), root);
+}
+
+}
+
+#endif
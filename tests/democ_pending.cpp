@@ -0,0 +1,105 @@
+/**********************************************************************
+    * democ_pending.cpp -- tests of the pending events of DE outputs  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Checking the merging and dropping of the delayed       *
+    *          events of the DiscreteEvent outputs                    *
+    *                                                                 *
+    * Usage:   make check                                             *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#include <systemc>
+#include <string>
+#include <sstream>
+#include <iostream>
+
+#include "forsyde/democ.hpp"
+
+using namespace ForSyDe::DiscreteEvent;
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    if (!(cond)) \
+    { \
+        std::cerr << __FILE__ << ":" << __LINE__ << ": " #cond " failed" << std::endl; \
+        failures++; \
+    }
+
+static sc_time at(int ns) {return sc_time(ns, SC_NS);}
+
+static int sum(const int& a, const int& b) {return a + b;}
+
+//! Three same-time events, whose running sum passes through the previous value
+static void combine_through_previous()
+{
+    Pending<int> p;
+    p.setCombiner(sum);
+    CHECK(p.push(at(1), 5));
+    CHECK(!p.push(at(2), 3));
+    CHECK(!p.push(at(2), 2));   // the running sum is 5, as the previous event
+    CHECK(!p.push(at(2), 1));
+    CHECK(p.frontTime() == at(1));
+    CHECK(p.pop() == 5);
+    CHECK(!p.empty());
+    CHECK(p.frontTime() == at(2));
+    CHECK(p.pop() == 6);
+    CHECK(p.empty());
+}
+
+//! The same, with the running sum passing through the written value
+static void combine_through_written()
+{
+    Pending<int> p;
+    p.setCombiner(sum);
+    p.push(at(1), 5);
+    CHECK(p.pop() == 5);
+    CHECK(p.push(at(2), 5));    // equal to the written value
+    CHECK(!p.push(at(2), 1));
+    CHECK(!p.push(at(2), 1));
+    CHECK(p.frontTime() == at(2));
+    CHECK(p.pop() == 7);
+    CHECK(p.empty());
+}
+
+//! A merged event which ends equal to the previous one is dropped once its time is closed
+static void drop_unchanged_when_closed()
+{
+    Pending<int> p;
+    p.setCombiner(sum);
+    p.push(at(1), 5);
+    p.push(at(2), 3);
+    p.push(at(2), 2);
+    p.push(at(3), 7);
+    CHECK(p.pop() == 5);
+    CHECK(p.frontTime() == at(3));
+    CHECK(p.pop() == 7);
+    CHECK(p.empty());
+}
+
+//! Without a combiner the last same-time event wins
+static void last_wins()
+{
+    Pending<int> p;
+    p.push(at(1), 5);
+    p.push(at(2), 4);
+    p.push(at(2), 5);           // dropped once the time 3 is pushed
+    p.push(at(3), 6);
+    CHECK(p.pop() == 5);
+    CHECK(p.frontTime() == at(3));
+    CHECK(p.pop() == 6);
+    CHECK(p.empty());
+}
+
+int sc_main(int argc, char** argv)
+{
+    combine_through_previous();
+    combine_through_written();
+    drop_unchanged_when_closed();
+    last_wins();
+    if (failures == 0) std::cout << "democ_pending: passed" << std::endl;
+    return failures == 0 ? 0 : 1;
+}
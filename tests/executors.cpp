@@ -0,0 +1,134 @@
+/**********************************************************************
+    * executors.cpp -- tests of the executors against the SC threads  *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Checking that the SDF static scheduler, the DDE event  *
+    *          scheduler and the native kernel write the same tokens  *
+    *          as the default thread-based execution                  *
+    *                                                                 *
+    * Usage:   make check                                             *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#define FORSYDE_SIGNAL_TRACE
+#include "forsyde.hpp"
+
+#include <string>
+#include <iostream>
+
+using namespace ForSyDe;
+
+//! A multi-rate SDF graph with a feedback loop
+/*! The samples are duplicated, accumulated through a delay and averaged
+ * in groups of three.
+ */
+SC_MODULE(sdf_top)
+{
+    SDF::signal<int> src, up, acc, fb, fbd, avg;
+
+    SC_CTOR(sdf_top)
+    {
+        SDF::make_source("src1", [](int& out1, const int& st) {out1 = st + 1;},
+                         0, 30, src);
+
+        SDF::make_comb("up1",
+            [](std::vector<int>& out1, const std::vector<int>& inp1)
+            {
+                out1[0] = inp1[0];
+                out1[1] = -inp1[0];
+            }, 2, 1, up, src);
+
+        auto acc1 = SDF::make_comb2("acc1",
+            [](std::vector<int>& out1, const std::vector<int>& inp1,
+               const std::vector<int>& inp2)
+            {
+                out1[0] = inp1[0] + 2 * inp2[0];
+            }, 1, 1, 1, acc, up, fbd);
+        acc1->oport1(fb);
+
+        SDF::make_delay("delay1", 0, fbd, fb);
+
+        SDF::make_comb("avg1",
+            [](std::vector<int>& out1, const std::vector<int>& inp1)
+            {
+                out1[0] = (inp1[0] + inp1[1] + inp1[2]) / 3;
+            }, 1, 3, avg, acc);
+
+        SDF::make_sink("sink1", [](const int&){}, avg);
+    }
+};
+
+//! A DDE model with a never-ending feedback loop and a sparse source
+SC_MODULE(dde_top)
+{
+    DDE::signal<int> loop, inc, incp, ext, sum;
+
+    SC_CTOR(dde_top)
+    {
+        DDE::make_delay("delay1", abst_ext<int>(0), sc_time(10, SC_NS), loop, inc);
+
+        auto inc1 = DDE::make_comb("inc1",
+            [](abst_ext<int>& out1, const int& inp1) {out1 = inp1 + 1;},
+            inc, loop);
+        inc1->oport1(incp);
+
+        DDE::make_vsource("ext1", std::vector<int>{5, 7, 11},
+            std::vector<sc_time>{sc_time(25, SC_NS), sc_time(40, SC_NS),
+                                 sc_time(90, SC_NS)},
+            ext);
+
+        DDE::make_comb2("add1",
+            [](abst_ext<int>& out1, const abst_ext<int>& inp1, const abst_ext<int>& inp2)
+            {
+                out1 = abst_ext<int>(from_abst_ext(inp1,0) + from_abst_ext(inp2,0));
+            }, sum, incp, ext);
+
+        DDE::make_sink("sink1", [](const ttn_event<int>&){}, sum);
+    }
+};
+
+//! Checks the SDF graph with the static scheduler and the native kernel
+static int check_sdf()
+{
+    auto res = run_equivalence({"threads", "static", "native"},
+        [](const std::string& mode, equivalence_check& chk)
+        {
+            auto t = new sdf_top("top");
+            chk.track(t->up, "up");
+            chk.track(t->acc, "acc");
+            chk.track(t->fbd, "fbd");
+            chk.track(t->avg, "avg");
+            if (mode == "static") new SDF::static_scheduler("static", t);
+            if (mode == "native") new native_kernel("native", t);
+        }, "executors_sdf.trc");
+    std::cout << "sdf" << std::endl;
+    return print_equivalence(res);
+}
+
+//! Checks the DDE model with the event scheduler and the native kernel
+static int check_dde()
+{
+    auto res = run_equivalence({"threads", "calendar", "native"},
+        [](const std::string& mode, equivalence_check& chk)
+        {
+            auto t = new dde_top("top");
+            chk.track(t->loop, "loop");
+            chk.track(t->incp, "incp");
+            chk.track(t->sum, "sum");
+            if (mode == "calendar") new DDE::event_scheduler("calendar", t);
+            if (mode == "native") new native_kernel("native", t);
+        }, "executors_dde.trc", sc_time(200, SC_NS));
+    std::cout << "dde" << std::endl;
+    return print_equivalence(res);
+}
+
+int sc_main(int argc, char** argv)
+{
+    int failed = 0;
+    failed += check_sdf();
+    failed += check_dde();
+    if (failed == 0) std::cout << "executors: passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/**********************************************************************
+    * time_warp.cpp -- tests of the Time Warp executor                *
+    *                                                                 *
+    * Author:  agent (agent@local)                                    *
+    *                                                                 *
+    * Purpose: Checking that a DDE model split over two ranks and run *
+    *          by the Time Warp executor delivers the same events to  *
+    *          its sink as the thread-based execution on one rank     *
+    *                                                                 *
+    * Usage:   mpirun -np 1 time_warp reference time_warp.ref         *
+    *          mpirun -np 2 time_warp time_warp time_warp.ref         *
+    *                                                                 *
+    * License: BSD3                                                   *
+    *******************************************************************/
+
+#define FORSYDE_CHECKPOINT
+#define FORSYDE_PARALLEL_SIM
+#include "forsyde.hpp"
+#include <mpi.h>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <fstream>
+#include <iostream>
+
+using namespace ForSyDe;
+
+//! The events seen by the sink, as their times in ps and their values
+static std::vector<std::pair<unsigned long long,int>> seen;
+
+static std::vector<sc_time> times_ns(std::initializer_list<int> ns)
+{
+    std::vector<sc_time> res;
+    for (auto t : ns) res.push_back(sc_time(t, SC_NS));
+    return res;
+}
+
+static void add_func(abst_ext<int>& out1, const abst_ext<int>& inp1, const abst_ext<int>& inp2)
+{
+    out1 = abst_ext<int>(from_abst_ext(inp1,0) + 10 * from_abst_ext(inp2,0));
+}
+
+//! Two merged sources on rank 0 whose sum is merged with a third one on rank 1
+/*! In the reference mode all the processes are on the same rank and the
+ * remote signal connects the two merges directly.
+ */
+SC_MODULE(tw_top)
+{
+    DDE::signal<int> a, b, remote, c, sum;
+
+    tw_top(sc_module_name _name, bool split, int rank) : sc_module(_name)
+    {
+        if (!split || rank == 0)
+        {
+            DDE::make_vsource("srca", std::vector<int>{1, 2, 3, 4, 5, 6},
+                              times_ns({10, 30, 50, 70, 90, 110}), a);
+            DDE::make_vsource("srcb", std::vector<int>{7, 8, 9},
+                              times_ns({20, 50, 100}), b);
+            DDE::make_comb2("merge1", add_func, remote, a, b);
+            if (split) DDE::make_tw_sender("send1", 1, 0, remote);
+        }
+        if (!split || rank == 1)
+        {
+            if (split) DDE::make_tw_receiver("recv1", 0, 0, remote);
+            DDE::make_vsource("srcc", std::vector<int>{1, 1, 1, 1, 1, 1, 1, 1},
+                              times_ns({5, 15, 25, 35, 55, 75, 95, 115}), c);
+            DDE::make_comb2("merge2", add_func, sum, c, remote);
+            DDE::make_sink("sink1", [](const ttn_event<int>& e)
+            {
+                seen.push_back({get_time(e).value(), from_abst_ext(get_value(e), -1)});
+            }, sum);
+        }
+    }
+};
+
+int sc_main(int argc, char** argv)
+{
+    MPI_Init(&argc, &argv);
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    const std::string mode = argc > 1 ? argv[1] : "reference";
+    const std::string ref = argc > 2 ? argv[2] : "time_warp.ref";
+    const bool split = mode == "time_warp";
+
+    tw_top top("top", split, rank);
+    if (split) new DDE::time_warp("tw", &top, sc_time(1, SC_US), 4, 16);
+    sc_start();
+
+    int failures = 0;
+    if (!split)
+    {
+        std::ofstream ofs(ref);
+        for (auto& e : seen) ofs << e.first << " " << e.second << std::endl;
+    }
+    else if (rank == 1)
+    {
+        std::ifstream ifs(ref);
+        std::vector<std::pair<unsigned long long,int>> expected;
+        std::pair<unsigned long long,int> e;
+        while (ifs >> e.first >> e.second) expected.push_back(e);
+        if (expected.empty())
+        {
+            std::cerr << "time_warp: no reference events in " << ref << std::endl;
+            failures++;
+        }
+        else if (seen != expected)
+        {
+            if (seen.size() != expected.size())
+                std::cerr << "time_warp: the sink saw " << seen.size()
+                          << " events instead of the " << expected.size()
+                          << " of the reference" << std::endl;
+            for (size_t i=0; i<seen.size() && i<expected.size(); i++)
+                if (seen[i] != expected[i])
+                {
+                    std::cerr << "time_warp: event " << i << " is " << seen[i].second
+                              << " at " << seen[i].first << " ps instead of "
+                              << expected[i].second << " at " << expected[i].first
+                              << " ps" << std::endl;
+                    break;
+                }
+            failures++;
+        }
+        else
+            std::cout << "time_warp: passed" << std::endl;
+    }
+
+    MPI_Finalize();
+    return failures == 0 ? 0 : 1;
+}